@@ -16,6 +16,9 @@ layout(binding = 0) uniform UniformBufferObject {
     vec4 ambientColor;
     vec4 terrainBrushPosRadius;
     vec4 terrainBrushParams;
+    vec4 environmentParams; // x = 1 when environmentSH holds the skybox's baked irradiance,
+                            // y = 1 when the specular IBL below is baked, z = its last mip
+    vec4 environmentSH[9];
 } ubo;
 
 // Output color
@@ -83,6 +86,23 @@ layout(binding = 9) uniform ShadowUBO {
 
 layout(binding = 10) uniform sampler2D ssaoMap;
 
+// Per-cluster light lists built on the CPU (light_clustering.zig). Clusters are screen tiles times
+// exponential depth slices; indices hold the global lights first, then each cluster's range.
+const uint CLUSTER_COUNT = 16u * 9u * 24u;
+
+layout(std430, binding = 11) readonly buffer LightClusterBuffer {
+    uvec4 grid;      // xyz = cluster counts, w = 1 when the lists are valid
+    vec4 tileDepth;  // xy = tile size in pixels, z = slice scale, w = slice bias
+    uvec4 globals;   // x = offset, y = count of lights that reach every fragment
+    uvec2 ranges[CLUSTER_COUNT]; // x = offset, y = count
+    uint indices[];
+} clusters;
+
+// Split-sum specular IBL baked by ibl_cooker.zig: the skybox prefiltered for GGX (roughness
+// m / lastMip at mip m) and the BRDF scale/bias LUT (NdotV along u, roughness along v).
+layout(binding = 12) uniform samplerCube prefilteredEnvironment;
+layout(binding = 13) uniform sampler2D brdfLut;
+
 // Poisson Disk Sampling (16 samples)
 const vec2 poissonDisk[16] = vec2[](
    vec2( -0.94201624, -0.39906216 ), vec2( 0.94558609, -0.76890725 ),
@@ -216,6 +236,39 @@ vec2 applyTextureTransform(vec2 uv, uint texIndex) {
 
 const float PI = 3.14159265359;
 
+// Skybox irradiance from the baked SH (cosine-convolved radiance / PI, see ibl_cooker.zig), or the
+// flat ambient color when the skybox has not been baked.
+vec3 ambientIrradiance(vec3 n) {
+    if (ubo.environmentParams.x <= 0.0) {
+        return ubo.ambientColor.rgb;
+    }
+    vec3 e = ubo.environmentSH[0].rgb * 0.282095
+        + ubo.environmentSH[1].rgb * (0.488603 * n.y)
+        + ubo.environmentSH[2].rgb * (0.488603 * n.z)
+        + ubo.environmentSH[3].rgb * (0.488603 * n.x)
+        + ubo.environmentSH[4].rgb * (1.092548 * n.x * n.y)
+        + ubo.environmentSH[5].rgb * (1.092548 * n.y * n.z)
+        + ubo.environmentSH[6].rgb * (0.315392 * (3.0 * n.z * n.z - 1.0))
+        + ubo.environmentSH[7].rgb * (1.092548 * n.x * n.z)
+        + ubo.environmentSH[8].rgb * (0.546274 * (n.x * n.x - n.y * n.y));
+    return max(e, vec3(0.0));
+}
+
+vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness) {
+    return F0 + (max(vec3(1.0 - roughness), F0) - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
+}
+
+// Reflected skybox radiance weighted by the split-sum BRDF, or zero when the skybox is not baked.
+vec3 ambientSpecular(vec3 N, vec3 V, vec3 F, float roughness) {
+    if (ubo.environmentParams.y <= 0.0) {
+        return vec3(0.0);
+    }
+    float NdotV = max(dot(N, V), 0.0);
+    vec3 prefiltered = textureLod(prefilteredEnvironment, reflect(-V, N), roughness * ubo.environmentParams.z).rgb;
+    vec2 brdf = texture(brdfLut, vec2(NdotV, roughness)).rg;
+    return prefiltered * (F * brdf.x + brdf.y);
+}
+
 // Utility: checks if an index means "no texture"
 bool isNoTex(uint idx) {
     return idx == 0xFFFFFFFFu; // UINT32_MAX means no texture provided
@@ -366,6 +419,85 @@ vec3 fresnelSchlick(float cosTheta, vec3 F0) {
     return F0 + (1.0 - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
 }
 
+vec3 shadeLight(Light light, vec3 N, vec3 V, vec3 F0, vec3 albedo, float metallic, float roughness) {
+    // Light calculation
+    vec3 L;
+    float attenuation = 1.0;
+    int type = int(light.lightDirection.w);
+
+    if (type != 0) { // Point (1) or Spot (2)
+        vec3 L_unnormalized = light.lightPosition.xyz - fragWorldPos;
+        float dist = length(L_unnormalized);
+        L = normalize(L_unnormalized);
+        
+        float range = light.params.x;
+        if (range > 0.0) {
+            float distSq = dist * dist;
+            // Standard inverse square falloff
+            attenuation = 1.0 / max(distSq, 0.01);
+            
+            // Windowing function to zero out at range
+            float rangeSq = range * range;
+            float factor = clamp(1.0 - (distSq * distSq) / (rangeSq * rangeSq), 0.0, 1.0);
+            attenuation *= factor * factor;
+        } else {
+             // If range is 0 or infinite, just inverse square
+             attenuation = 1.0 / max(dist * dist, 0.01);
+        }
+
+        if (type == 2) { // Spot Light
+             float theta = dot(L, normalize(-light.lightDirection.xyz));
+             float innerCos = light.params.y;
+             float outerCos = light.params.z;
+             float epsilon = innerCos - outerCos;
+             float spotIntensity = clamp((theta - outerCos) / max(epsilon, 0.001), 0.0, 1.0);
+             attenuation *= spotIntensity;
+        }
+    } else { // Directional
+        L = normalize(-light.lightDirection.xyz);
+    }
+
+    float shadow = 1.0;
+    bool shadowsEnabled = (ubo.viewPosAndDebug.w < 0.5);
+    if (type == 0 && shadowsEnabled) { // Directional
+        // Pass geometry normal (fragNormal) instead of perturbed normal (N) for shadow bias calculation
+        // This prevents shadow acne on surfaces with strong normal maps
+        shadow = ShadowCalculation(fragWorldPos, normalize(fragNormal), L);
+    } else if (type == 0 && !shadowsEnabled) {
+        shadow = 0.0;
+    }
+
+    vec3 H = normalize(V + L);
+    vec3 radiance = light.lightColor.rgb * light.lightColor.w * attenuation;
+    
+    // Cook-Torrance BRDF
+    float NDF = DistributionGGX(N, H, roughness);
+    float G = GeometrySmith(N, V, L, roughness);
+    vec3 F = fresnelSchlick(max(dot(H, V), 0.0), F0);
+    
+    vec3 kS = F;
+    vec3 kD = vec3(1.0) - kS;
+    kD *= 1.0 - metallic;
+    
+    vec3 numerator = NDF * G * F;
+    float denominator = 4.0 * max(dot(N, V), 0.0) * max(dot(N, L), 0.0) + 0.0001;
+    vec3 specular = numerator / denominator;
+    
+    float NdotL = max(dot(N, L), 0.0);
+    return (kD * albedo / PI + specular) * radiance * NdotL * shadow;
+}
+
+// Must match Clusterer.cluster_at.
+uint clusterIndex() {
+    float viewDepth = max(-(ubo.view * vec4(fragWorldPos, 1.0)).z, 1e-4);
+    uvec3 cell = uvec3(
+        uint(max(gl_FragCoord.x / clusters.tileDepth.x, 0.0)),
+        uint(max(gl_FragCoord.y / clusters.tileDepth.y, 0.0)),
+        uint(max(log(viewDepth) * clusters.tileDepth.z + clusters.tileDepth.w, 0.0)));
+    cell = min(cell, clusters.grid.xyz - 1u);
+    return (cell.z * clusters.grid.y + cell.y) * clusters.grid.x + cell.x;
+}
+
 void main() {
     // Apply texture transforms to UV coordinates
     vec2 albedoUV = applyTextureTransform(getUV(getUVIndex(0)), 0);
@@ -545,78 +677,27 @@ void main() {
     // Reflectance equation
     vec3 Lo = vec3(0.0);
     
-    for (uint i = 0; i < lighting.lightCount; i++) {
-        Light light = lighting.lights[i];
-
-        // Light calculation
-        vec3 L;
-        float attenuation = 1.0;
-        int type = int(light.lightDirection.w);
-
-        if (type != 0) { // Point (1) or Spot (2)
-            vec3 L_unnormalized = light.lightPosition.xyz - fragWorldPos;
-            float dist = length(L_unnormalized);
-            L = normalize(L_unnormalized);
-            
-            float range = light.params.x;
-            if (range > 0.0) {
-                float distSq = dist * dist;
-                // Standard inverse square falloff
-                attenuation = 1.0 / max(distSq, 0.01);
-                
-                // Windowing function to zero out at range
-                float rangeSq = range * range;
-                float factor = clamp(1.0 - (distSq * distSq) / (rangeSq * rangeSq), 0.0, 1.0);
-                attenuation *= factor * factor;
-            } else {
-                 // If range is 0 or infinite, just inverse square
-                 attenuation = 1.0 / max(dist * dist, 0.01);
-            }
-
-            if (type == 2) { // Spot Light
-                 float theta = dot(L, normalize(-light.lightDirection.xyz));
-                 float innerCos = light.params.y;
-                 float outerCos = light.params.z;
-                 float epsilon = innerCos - outerCos;
-                 float spotIntensity = clamp((theta - outerCos) / max(epsilon, 0.001), 0.0, 1.0);
-                 attenuation *= spotIntensity;
-            }
-        } else { // Directional
-            L = normalize(-light.lightDirection.xyz);
+    if (clusters.grid.w == 0u) {
+        for (uint i = 0; i < lighting.lightCount; i++) {
+            Lo += shadeLight(lighting.lights[i], N, V, F0, albedo, metallic, roughness);
         }
-
-        float shadow = 1.0;
-        bool shadowsEnabled = (ubo.viewPosAndDebug.w < 0.5);
-        if (type == 0 && shadowsEnabled) { // Directional
-            // Pass geometry normal (fragNormal) instead of perturbed normal (N) for shadow bias calculation
-            // This prevents shadow acne on surfaces with strong normal maps
-            shadow = ShadowCalculation(fragWorldPos, normalize(fragNormal), L);
-        } else if (type == 0 && !shadowsEnabled) {
-            shadow = 0.0;
+    } else {
+        for (uint i = 0; i < clusters.globals.y; i++) {
+            Lo += shadeLight(lighting.lights[clusters.indices[clusters.globals.x + i]], N, V, F0, albedo, metallic, roughness);
+        }
+        uvec2 range = clusters.ranges[clusterIndex()];
+        for (uint i = 0; i < range.y; i++) {
+            Lo += shadeLight(lighting.lights[clusters.indices[range.x + i]], N, V, F0, albedo, metallic, roughness);
         }
-
-        vec3 H = normalize(V + L);
-        vec3 radiance = light.lightColor.rgb * light.lightColor.w * attenuation;
-        
-        // Cook-Torrance BRDF
-        float NDF = DistributionGGX(N, H, roughness);
-        float G = GeometrySmith(N, V, L, roughness);
-        vec3 F = fresnelSchlick(max(dot(H, V), 0.0), F0);
-        
-        vec3 kS = F;
-        vec3 kD = vec3(1.0) - kS;
-        kD *= 1.0 - metallic;
-        
-        vec3 numerator = NDF * G * F;
-        float denominator = 4.0 * max(dot(N, V), 0.0) * max(dot(N, L), 0.0) + 0.0001;
-        vec3 specular = numerator / denominator;
-        
-        float NdotL = max(dot(N, L), 0.0);
-        Lo += (kD * albedo / PI + specular) * radiance * NdotL * shadow;
     }
     
-    // Ambient lighting
-    vec3 ambient = ubo.ambientColor.rgb * albedo * ao;
+    // Ambient lighting; with a baked specular IBL, diffuse takes only the energy it leaves
+    vec3 ambient = ambientIrradiance(N) * albedo;
+    if (ubo.environmentParams.y > 0.0) {
+        vec3 F = fresnelSchlickRoughness(max(dot(N, V), 0.0), F0, roughness);
+        ambient = (1.0 - F) * (1.0 - metallic) * ambient + ambientSpecular(N, V, F, roughness);
+    }
+    ambient *= ao;
     
     // Combine lighting components
     vec3 color = ambient + Lo + emissive;
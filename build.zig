@@ -389,9 +389,115 @@ pub fn build(b: *std.Build) void {
 
     engine_tests.linkLibrary(glfw);
 
+    // =========================================================================
+    // SPIR-V Staleness Check (Executable)
+    // =========================================================================
+    const shader_check = b.addExecutable(.{
+        .name = "cardinal_shader_check",
+        .root_module = b.createModule(.{
+            .target = b.graph.host,
+            .optimize = .Debug,
+            .root_source_file = b.path("engine/tools/shader_check.zig"),
+        }),
+    });
+
+    const run_shader_check = b.addRunArtifact(shader_check);
+    run_shader_check.addDirectoryArg(b.path("assets/shaders"));
+    if (b.args) |args| {
+        run_shader_check.addArgs(args);
+    }
+    const check_shaders_step = b.step("check-shaders", "Fail if any SPIR-V binary is older than its GLSL source");
+    check_shaders_step.dependOn(&run_shader_check.step);
+
     const test_step = b.step("test", "Run engine tests");
     const run_engine_tests = b.addRunArtifact(engine_tests);
     test_step.dependOn(&run_engine_tests.step);
+    test_step.dependOn(&run_shader_check.step);
+
+    // =========================================================================
+    // Benchmarks (Executable)
+    // =========================================================================
+    const bench = b.addExecutable(.{
+        .name = "cardinal_engine_bench",
+        .root_module = b.createModule(.{
+            .target = target,
+            .optimize = if (optimize == .Debug) .ReleaseFast else optimize,
+            .root_source_file = b.path("engine/bench/main.zig"),
+        }),
+    });
+
+    bench.linkLibCpp();
+    bench.linkLibrary(tracy);
+    bench.linkLibrary(glfw);
+    if (vulkan_sdk) |sdk| {
+        bench.addLibraryPath(.{ .cwd_relative = b.fmt("{s}/Lib", .{sdk}) });
+    }
+    bench.root_module.addImport("cardinal_engine", engine.root_module);
+
+    const run_bench = b.addRunArtifact(bench);
+    if (b.args) |args| {
+        run_bench.addArgs(args);
+    }
+    const bench_step = b.step("bench", "Run headless engine benchmarks");
+    bench_step.dependOn(&run_bench.step);
+
+    // =========================================================================
+    // Asset Packer (Executable)
+    // =========================================================================
+    const packer = b.addExecutable(.{
+        .name = "cardinal_packer",
+        .root_module = b.createModule(.{
+            .target = target,
+            .optimize = optimize,
+            .root_source_file = b.path("engine/tools/packer.zig"),
+        }),
+    });
+
+    packer.linkLibCpp();
+    packer.linkLibrary(tracy);
+    packer.linkLibrary(glfw);
+    if (vulkan_sdk) |sdk| {
+        packer.addLibraryPath(.{ .cwd_relative = b.fmt("{s}/Lib", .{sdk}) });
+    }
+    packer.root_module.addImport("cardinal_engine", engine.root_module);
+
+    b.installArtifact(packer);
+
+    const run_packer = b.addRunArtifact(packer);
+    if (b.args) |args| {
+        run_packer.addArgs(args);
+    }
+    const pack_step = b.step("pack", "Build an asset pack, e.g. `zig build pack -- assets zig-out/paks/base.cpak`");
+    pack_step.dependOn(&run_packer.step);
+
+    // =========================================================================
+    // IBL Baker (Executable)
+    // =========================================================================
+    const ibl_baker = b.addExecutable(.{
+        .name = "cardinal_ibl_baker",
+        .root_module = b.createModule(.{
+            .target = target,
+            .optimize = if (optimize == .Debug) .ReleaseFast else optimize,
+            .root_source_file = b.path("engine/tools/ibl_baker.zig"),
+        }),
+    });
+
+    ibl_baker.linkLibCpp();
+    ibl_baker.linkLibrary(tracy);
+    ibl_baker.linkLibrary(glfw);
+    if (vulkan_sdk) |sdk| {
+        ibl_baker.addLibraryPath(.{ .cwd_relative = b.fmt("{s}/Lib", .{sdk}) });
+    }
+    ibl_baker.root_module.addImport("cardinal_engine", engine.root_module);
+
+    b.installArtifact(ibl_baker);
+
+    const run_ibl_baker = b.addRunArtifact(ibl_baker);
+    if (b.args) |args| {
+        run_ibl_baker.addArgs(args);
+    }
+    const bake_ibl_step = b.step("bake-ibl", "Bake IBL data for HDR skyboxes, e.g. `zig build bake-ibl -- assets/skyboxes/sky.exr`");
+    bake_ibl_step.dependOn(&run_ibl_baker.step);
 
     // =========================================================================
     // Client (Executable)
@@ -149,6 +149,7 @@ pub fn main() !u8 {
         window.cardinal_window_poll(win);
         vulkan_renderer_frame.cardinal_renderer_draw_frame(&renderer);
         engine.tracy.frameMark();
+        engine.profiler.frame_mark();
         frames += 1;
         // TODO: Replace this early-exit with a real game loop or CLI-controlled frame count.
         if (frames > 10) break;
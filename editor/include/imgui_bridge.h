@@ -353,6 +353,8 @@ void imgui_bridge_text(const char *fmt, ...);
 void imgui_bridge_text_disabled(const char *fmt, ...);
 void imgui_bridge_text_wrapped(const char *fmt, ...);
 void imgui_bridge_set_cursor_pos(const ImVec2 *pos);
+void imgui_bridge_get_cursor_screen_pos(ImVec2 *out_pos);
+void imgui_bridge_dummy(const ImVec2 *size);
 bool imgui_bridge_button(const char *label);
 void imgui_bridge_same_line(float offset_from_start_x, float spacing);
 bool imgui_bridge_checkbox(const char *label, bool *v);
@@ -486,6 +488,10 @@ void imgui_bridge_draw_circle_filled(const ImVec2 *center, float radius,
                                      unsigned int color);
 void imgui_bridge_draw_triangle_filled(const ImVec2 *p1, const ImVec2 *p2,
                                        const ImVec2 *p3, unsigned int color);
+void imgui_bridge_draw_rect_filled(const ImVec2 *p0, const ImVec2 *p1,
+                                   unsigned int color);
+void imgui_bridge_draw_text_clipped(const ImVec2 *p0, const ImVec2 *p1,
+                                    unsigned int color, const char *text);
 
 // IO
 float imgui_bridge_get_io_delta_time(void);
@@ -85,6 +85,7 @@ pub const EditorApp = struct {
 
             _ = vulkan_renderer_frame.cardinal_renderer_draw_frame(&self.engine.renderer);
             engine.tracy.frameMark();
+            engine.profiler.frame_mark();
 
             log.cardinal_log_debug("[EDITOR] Processing pending uploads after frame draw", .{});
             editor_layer.process_pending_uploads();
@@ -36,6 +36,7 @@ const input_system = @import("systems/input.zig");
 const camera_controller = @import("systems/camera_controller.zig");
 const scene_io = @import("systems/scene_io.zig");
 const scene_sync = @import("systems/editor_scene_sync.zig");
+const terrain_spatial = @import("systems/terrain_spatial.zig");
 const project_manager = @import("panels/project_manager.zig");
 
 const c = @import("c.zig").c;
@@ -101,7 +102,7 @@ fn ensure_globals_entity() void {
 
 fn apply_globals_to_state() void {
     ensure_globals_entity();
-    const g = state.runtime.registry.get(components.EditorGlobals, state.runtime.globals_entity) orelse return;
+    const g = state.runtime.registry.get_const(components.EditorGlobals, state.runtime.globals_entity) orelse return;
 
     state.runtime.camera.position = g.camera_position;
     state.runtime.camera.target = g.camera_target;
@@ -236,7 +237,7 @@ fn compute_entity_world_matrix(entity: engine.ecs_entity.Entity, depth: u32) mat
     if (depth > 2048) return math.Mat4.identity();
 
     var parent_world = math.Mat4.identity();
-    if (state.runtime.registry.get(components.Hierarchy, entity)) |h| {
+    if (state.runtime.registry.get_const(components.Hierarchy, entity)) |h| {
         if (h.parent) |p| {
             if (state.runtime.registry.entity_manager.is_alive(p)) {
                 parent_world = compute_entity_world_matrix(p, depth + 1);
@@ -244,7 +245,7 @@ fn compute_entity_world_matrix(entity: engine.ecs_entity.Entity, depth: u32) mat
         }
     }
 
-    const local = if (state.runtime.registry.get(components.Transform, entity)) |t|
+    const local = if (state.runtime.registry.get_const(components.Transform, entity)) |t|
         math.Mat4.fromTRS(t.position, t.rotation, t.scale)
     else
         math.Mat4.identity();
@@ -258,18 +259,18 @@ fn resolve_game_camera_entity() ?engine.ecs_entity.Entity {
 
     if (g.game_camera_entity_id != std.math.maxInt(u64)) {
         const ent = engine.ecs_entity.Entity{ .id = g.game_camera_entity_id };
-        if (state.runtime.registry.entity_manager.is_alive(ent) and state.runtime.registry.get(components.Camera, ent) != null) {
+        if (state.runtime.registry.entity_manager.is_alive(ent) and state.runtime.registry.get_const(components.Camera, ent) != null) {
             return ent;
         }
     }
 
     var fallback: ?engine.ecs_entity.Entity = null;
     var view = state.runtime.registry.view(components.Camera);
-    var it = view.iterator();
+    var it = view.const_iterator();
     while (it.next()) |entry| {
         const ent = entry.entity;
         if (!state.runtime.registry.entity_manager.is_alive(ent)) continue;
-        if (state.runtime.registry.get(components.Name, ent)) |n| {
+        if (state.runtime.registry.get_const(components.Name, ent)) |n| {
             const s = n.slice();
             if (std.mem.eql(u8, s, "MainCamera") or std.mem.eql(u8, s, "Main Camera")) return ent;
         }
@@ -280,7 +281,7 @@ fn resolve_game_camera_entity() ?engine.ecs_entity.Entity {
 
 fn resolve_game_view_camera() ?types.CardinalCamera {
     const ent = resolve_game_camera_entity() orelse return null;
-    const cam_comp = state.runtime.registry.get(components.Camera, ent) orelse return null;
+    const cam_comp = state.runtime.registry.get_const(components.Camera, ent) orelse return null;
 
     const world = compute_entity_world_matrix(ent, 0);
     const pos = math.Vec3{ .x = world.data[12], .y = world.data[13], .z = world.data[14] };
@@ -363,7 +364,7 @@ fn prune_terrain_runtime_data() void {
             continue;
         }
 
-        const terr = state.runtime.registry.get(components.Terrain, ent);
+        const terr = state.runtime.registry.get_const(components.Terrain, ent);
         if (terr == null) {
             free_terrain_runtime_data(entry.value_ptr);
             dead_ids.append(allocator, entity_id) catch {};
@@ -393,7 +394,7 @@ fn prune_terrain_runtime_data() void {
             continue;
         }
 
-        const vt = state.runtime.registry.get(components.VolumetricTerrain, ent);
+        const vt = state.runtime.registry.get_const(components.VolumetricTerrain, ent);
         if (vt == null) {
             free_volumetric_terrain_runtime_data(&state, entity_id, entry.value_ptr);
             dead_ids.append(allocator, entity_id) catch {};
@@ -436,7 +437,6 @@ fn prune_terrain_runtime_data() void {
                 _ = state.runtime.volumetric_dirty_brick_boxes.remove(k);
                 _ = state.runtime.volumetric_dirty_brick_lod_masks.remove(k);
                 _ = state.runtime.volumetric_brick_generation.remove(k);
-                _ = state.runtime.volumetric_brick_last_schedule_ms.remove(k);
 
                 var lod: u8 = 0;
                 while (lod < 3) : (lod += 1) {
@@ -677,6 +677,12 @@ pub fn init(win_ptr: *window.CardinalWindow, rnd_ptr: *types.CardinalRenderer, r
     state.ui.assets.search_filter = allocator.alloc(u8, 256) catch return false;
     @memset(state.ui.assets.search_filter, 0);
 
+    if (engine.asset_database.openShared(allocator, state.ui.assets.assets_dir)) |db| {
+        db.refresh() catch |err| log.cardinal_log_warn("Asset database refresh failed: {}", .{err});
+    } else |err| {
+        log.cardinal_log_warn("Failed to open asset database: {}", .{err});
+    }
+
     content_browser.scan_assets_dir(&state, allocator);
 
     c.imgui_bridge_create_context();
@@ -928,7 +934,6 @@ fn close_project() void {
     state.runtime.volumetric_dirty_brick_boxes.clearRetainingCapacity();
     state.runtime.volumetric_dirty_brick_lod_masks.clearRetainingCapacity();
     state.runtime.volumetric_brick_generation.clearRetainingCapacity();
-    state.runtime.volumetric_brick_last_schedule_ms.clearRetainingCapacity();
     {
         var it = state.runtime.volumetric_brick_tile_cache.iterator();
         while (it.next()) |entry| {
@@ -953,6 +958,7 @@ fn close_project() void {
         }
     }
     state.runtime.volumetric_brick_remesh_tasks.clearRetainingCapacity();
+    volumetric_terrain.reset_remesh_scheduler();
     {
         var it = state.runtime.volumetric_density_snapshots.iterator();
         while (it.next()) |entry| {
@@ -998,6 +1004,9 @@ pub fn shutdown() void {
     model_manager.cardinal_model_manager_destroy(&state.runtime.model_manager);
 
     selection_system.reset_picking_cache();
+    scene_sync.reset_scene_sync();
+    terrain_spatial.reset();
+    volumetric_terrain.reset_remesh_scheduler();
     state.runtime.transform_overrides.deinit(allocator);
     state.runtime.mesh_owner_by_mesh_index.deinit(allocator);
     state.runtime.mesh_entity_by_mesh_index.deinit(allocator);
@@ -1034,7 +1043,6 @@ pub fn shutdown() void {
     state.runtime.volumetric_dirty_boxes.deinit(allocator);
     state.runtime.volumetric_dirty_lod_masks.deinit(allocator);
     state.runtime.volumetric_lod_by_entity.deinit(allocator);
-    state.runtime.volumetric_brick_last_schedule_ms.deinit(allocator);
     {
         var it = state.runtime.volumetric_brick_tile_cache.iterator();
         while (it.next()) |entry| {
@@ -1086,6 +1094,7 @@ pub fn shutdown() void {
     }
     state.ui.assets.entries.deinit(allocator);
     state.ui.assets.filtered_entries.deinit(allocator);
+    engine.asset_database.closeShared();
     allocator.free(state.ui.assets.assets_dir[0 .. state.ui.assets.assets_dir.len + 1]);
     allocator.free(state.ui.assets.current_dir[0 .. state.ui.assets.current_dir.len + 1]);
     allocator.free(state.ui.assets.search_filter);
@@ -1125,11 +1134,15 @@ pub fn update() void {
     if (state.runtime.model_manager.scene_dirty) {
         if (model_manager.cardinal_model_manager_get_combined_scene(&state.runtime.model_manager)) |comb_ptr| {
             state.runtime.combined_scene = comb_ptr.*;
-            state.runtime.pending_scene = state.runtime.combined_scene;
-            state.runtime.scene_upload_pending = true;
+            if (!apply_scene_ranges_to_renderer()) {
+                state.runtime.pending_scene = state.runtime.combined_scene;
+                state.runtime.scene_upload_pending = true;
+            }
             state.runtime.scene_loaded = (state.runtime.combined_scene.mesh_count > 0);
             state.runtime.transform_overrides.clearRetainingCapacity();
             selection_system.reset_picking_cache();
+            scene_sync.reset_scene_sync();
+            terrain_spatial.reset();
             state.ui.undo.clear();
             prune_terrain_runtime_data();
             refresh_terrain_material_bindings();
@@ -1144,12 +1157,14 @@ pub fn update() void {
         if (model_manager.cardinal_model_manager_get_combined_scene(&state.runtime.model_manager)) |comb_ptr| {
             state.runtime.combined_scene = comb_ptr.*;
         }
+        selection_system.mark_picking_instances_dirty();
     }
 
     if (state.runtime.picking_cache_dirty) {
-        selection_system.reset_picking_cache();
+        selection_system.invalidate_picking_cache();
         state.runtime.picking_cache_dirty = false;
     }
+    selection_system.update_picking_cache(&state);
 
     c.imgui_bridge_impl_vulkan_new_frame();
     c.imgui_bridge_impl_glfw_new_frame();
@@ -1165,13 +1180,13 @@ pub fn update() void {
         animation.cardinal_animation_system_update(anim_sys, state.runtime.combined_scene.all_nodes, state.runtime.combined_scene.all_node_count, dt);
 
         if (state.runtime.model_manager.models) |models| {
-            var mesh_offset: u32 = 0;
             var m_idx: u32 = 0;
             while (m_idx < state.runtime.model_manager.model_count) : (m_idx += 1) {
                 const model = &models[m_idx];
-                if (!model.visible or model.is_loading) continue;
+                if (!model.visible or model.is_loading or !model.combined.resident) continue;
 
                 const scn = &model.scene;
+                const mesh_offset = model.combined.mesh_first;
 
                 if (scn.root_nodes) |roots| {
                     var r: u32 = 0;
@@ -1199,11 +1214,15 @@ pub fn update() void {
                         }
                     }
                 }
-
-                mesh_offset += scn.mesh_count;
             }
         }
 
+        // Morph weights re-deform only the vertices they move; upload just those ranges.
+        if (model_manager.cardinal_model_manager_update_morphs(&state.runtime.model_manager) > 0 and !apply_scene_ranges_to_renderer()) {
+            state.runtime.pending_scene = state.runtime.combined_scene;
+            state.runtime.scene_upload_pending = true;
+        }
+
         if (state.ui.selected_animation >= 0 and state.ui.selected_animation < anim_sys.animation_count) {
             var i: u32 = 0;
             while (i < anim_sys.state_count) : (i += 1) {
@@ -1315,14 +1334,16 @@ pub fn update() void {
         terrain_panel.flush_terrain_pending_uploads(&state);
         // volumetric_terrain.flush_volumetric_pending_uploads(&state);
 
-        // volumetric_terrain.update_lods_and_streaming(&state);
+        volumetric_terrain.update_lods_and_streaming(&state);
+        volumetric_terrain.pump_brick_remeshes(&state);
         {
             var view = state.runtime.registry.view(components.VolumetricTerrainBrick);
-            var it = view.iterator();
+            var it = view.const_iterator();
             while (it.next()) |entry| {
-                if (state.runtime.registry.get(components.MeshRenderer, entry.entity)) |mr| {
-                    mr.visible = false;
-                }
+                const mr = state.runtime.registry.get_untracked(components.MeshRenderer, entry.entity) orelse continue;
+                if (!mr.visible) continue;
+                mr.visible = false;
+                state.runtime.registry.mark_changed(components.MeshRenderer, entry.entity);
             }
         }
         scene_sync.sync_mesh_visibility_from_ecs(&state);
@@ -1372,11 +1393,31 @@ pub fn render() void {
     c.imgui_bridge_render();
 }
 
+/// Applies the model manager's changed scene ranges to the renderer.
+///
+/// Models appended past the resident data are uploaded range by range. Returns false when a change
+/// refills released slots or overflows the range list, and a full upload is required instead.
+fn apply_scene_ranges_to_renderer() bool {
+    if (!initialized or state.runtime.scene_upload_pending) return false;
+
+    const mgr = &state.runtime.model_manager;
+    if (model_manager.cardinal_model_manager_needs_full_upload(mgr)) return false;
+
+    var ranges: [64]scene.CardinalSceneDirtyRange = undefined;
+    const total = model_manager.cardinal_model_manager_get_dirty_ranges(mgr, &ranges, ranges.len);
+    if (total > ranges.len) return false;
+    if (!renderer.cardinal_renderer_update_scene_ranges(state.runtime.renderer, &state.runtime.combined_scene, &ranges, total)) return false;
+
+    model_manager.cardinal_model_manager_clear_dirty_ranges(mgr);
+    return true;
+}
+
 /// Uploads any pending scene changes to the renderer.
 pub fn process_pending_uploads() void {
     if (state.runtime.scene_upload_pending and initialized) {
         log.cardinal_log_info("[EDITOR] Pending upload detected", .{});
         renderer.cardinal_renderer_upload_scene(state.runtime.renderer, &state.runtime.pending_scene);
+        model_manager.cardinal_model_manager_clear_dirty_ranges(&state.runtime.model_manager);
 
         state.runtime.combined_scene = state.runtime.pending_scene;
         state.runtime.scene_upload_pending = false;
@@ -1411,7 +1452,10 @@ pub fn process_pending_uploads() void {
             renderer.cardinal_renderer_set_camera(state.runtime.renderer, &state.runtime.camera);
         }
 
-        var pbr_lights: [types.MAX_LIGHTS]types.PBRLight = undefined;
+        // MAX_LIGHTS entries is 256 KB; keep it in the thread's scratch arena, not on the stack.
+        const scratch = engine.memory.scratch_begin() orelse return;
+        defer scratch.end();
+        const pbr_lights = scratch.allocator().alloc(types.PBRLight, types.MAX_LIGHTS) catch return;
         var light_count: u32 = 0;
 
         if (state.runtime.combined_scene.light_count > 0 and state.runtime.combined_scene.lights != null) {
@@ -1456,7 +1500,7 @@ pub fn process_pending_uploads() void {
                     if (depth > 2048) return math.Mat4.identity();
 
                     var parent_world = math.Mat4.identity();
-                    if (st.runtime.registry.get(components.Hierarchy, ent)) |h| {
+                    if (st.runtime.registry.get_const(components.Hierarchy, ent)) |h| {
                         if (h.parent) |p| {
                             if (st.runtime.registry.entity_manager.is_alive(p)) {
                                 parent_world = f(st, a, cache, p, depth + 1);
@@ -1464,7 +1508,7 @@ pub fn process_pending_uploads() void {
                         }
                     }
 
-                    const local = if (st.runtime.registry.get(components.Transform, ent)) |t|
+                    const local = if (st.runtime.registry.get_const(components.Transform, ent)) |t|
                         math.Mat4.fromTRS(t.position, t.rotation, t.scale)
                     else
                         math.Mat4.identity();
@@ -1476,7 +1520,7 @@ pub fn process_pending_uploads() void {
             }.f;
 
             var view = state.runtime.registry.view(components.Light);
-            var it = view.iterator();
+            var it = view.const_iterator();
             while (it.next()) |entry| {
                 if (light_count >= types.MAX_LIGHTS) break;
                 const l = entry.component;
@@ -1498,7 +1542,7 @@ pub fn process_pending_uploads() void {
         }
 
         if (light_count > 0) {
-            renderer.cardinal_renderer_set_lights(state.runtime.renderer, &pbr_lights, light_count);
+            renderer.cardinal_renderer_set_lights(state.runtime.renderer, pbr_lights.ptr, light_count);
         } else {
             renderer.cardinal_renderer_set_lights(state.runtime.renderer, null, 0);
         }
@@ -20,12 +20,12 @@ const undo = @import("undo.zig");
 
 /// Finds the active `EditorGlobals` entity, preferring `preferred` when valid.
 pub fn resolveEditorGlobalsEntity(registry: *engine.ecs_registry.Registry, preferred: engine.ecs_entity.Entity) ?engine.ecs_entity.Entity {
-    if (registry.entity_manager.is_alive(preferred) and registry.get(components.EditorGlobals, preferred) != null) {
+    if (registry.entity_manager.is_alive(preferred) and registry.get_const(components.EditorGlobals, preferred) != null) {
         return preferred;
     }
 
     var view = registry.view(components.EditorGlobals);
-    var it = view.iterator();
+    var it = view.const_iterator();
     if (it.next()) |entry| {
         if (registry.entity_manager.is_alive(entry.entity)) {
             return entry.entity;
@@ -273,7 +273,6 @@ pub const EditorRuntimeState = struct {
     volumetric_dirty_brick_lod_masks: std.AutoHashMapUnmanaged(VolumetricBrickKey, u8) = .{},
     volumetric_brick_generation: std.AutoHashMapUnmanaged(VolumetricBrickKey, u32) = .{},
     volumetric_brick_remesh_tasks: std.AutoHashMapUnmanaged(VolumetricBrickKey, *async_loader.CardinalAsyncTask) = .{},
-    volumetric_brick_last_schedule_ms: std.AutoHashMapUnmanaged(VolumetricBrickKey, u64) = .{},
     volumetric_brick_tile_cache: std.AutoHashMapUnmanaged(VolumetricBrickLodKey, VolumetricBrickTileCache) = .{},
     volumetric_density_snapshots: std.AutoHashMapUnmanaged(VolumetricDensitySnapshotKey, VolumetricDensitySnapshot) = .{},
     asset_thumbnails: std.StringHashMapUnmanaged(AssetThumbnail) = .{},
@@ -330,7 +329,7 @@ pub const EditorRuntimeState = struct {
 
             self.transform_overrides.put(allocator, e.id, {}) catch {};
 
-            const h = self.registry.get(engine.ecs_components.Hierarchy, e) orelse continue;
+            const h = self.registry.get_const(engine.ecs_components.Hierarchy, e) orelse continue;
             var child = h.first_child;
             var guard: u32 = 0;
             while (child) |c_ent| {
@@ -339,7 +338,7 @@ pub const EditorRuntimeState = struct {
 
                 stack.append(allocator, c_ent) catch return;
 
-                const ch = self.registry.get(engine.ecs_components.Hierarchy, c_ent) orelse break;
+                const ch = self.registry.get_const(engine.ecs_components.Hierarchy, c_ent) orelse break;
                 child = ch.next_sibling;
             }
         }
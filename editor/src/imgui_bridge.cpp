@@ -414,6 +414,18 @@ void imgui_bridge_set_cursor_pos(const ImVec2 *pos) {
   ImGui::SetCursorPos(*pos);
 }
 
+void imgui_bridge_get_cursor_screen_pos(ImVec2 *out_pos) {
+  if (out_pos) {
+    *out_pos = ImGui::GetCursorScreenPos();
+  }
+}
+
+void imgui_bridge_dummy(const ImVec2 *size) {
+  if (size) {
+    ImGui::Dummy(*size);
+  }
+}
+
 bool imgui_bridge_button(const char *label) {
   return ImGui::Button(label);
 }
@@ -811,6 +823,35 @@ void imgui_bridge_draw_triangle_filled(const ImVec2 *p1, const ImVec2 *p2,
   draw_list->AddTriangleFilled(*p1, *p2, *p3, color);
 }
 
+void imgui_bridge_draw_rect_filled(const ImVec2 *p0, const ImVec2 *p1,
+                                   unsigned int color) {
+  if (!p0 || !p1) {
+    return;
+  }
+
+  ImDrawList *draw_list = ImGui::GetWindowDrawList();
+  if (!draw_list) {
+    return;
+  }
+
+  draw_list->AddRectFilled(*p0, *p1, color);
+}
+
+void imgui_bridge_draw_text_clipped(const ImVec2 *p0, const ImVec2 *p1,
+                                    unsigned int color, const char *text) {
+  if (!p0 || !p1 || !text) {
+    return;
+  }
+
+  ImDrawList *draw_list = ImGui::GetWindowDrawList();
+  if (!draw_list) {
+    return;
+  }
+
+  const ImVec4 clip(p0->x, p0->y, p1->x, p1->y);
+  draw_list->AddText(nullptr, 0.0f, *p0, color, text, nullptr, 0.0f, &clip);
+}
+
 float imgui_bridge_get_io_delta_time(void) { return ImGui::GetIO().DeltaTime; }
 
 bool imgui_bridge_begin_popup_context_item(void) {
@@ -553,14 +553,7 @@ pub fn scan_assets_dir(state: *EditorState, allocator: std.mem.Allocator) void {
     state.ui.assets.last_scan_dir_hash = dir_hash(state.ui.assets.current_dir);
     state.ui.assets.last_scan_dir_mtime_ns = dir_mtime_ns(state.ui.assets.current_dir);
 
-    var meta_db: engine.asset_database.AssetDatabase = undefined;
-    var meta_db_ready = false;
-    defer if (meta_db_ready) meta_db.deinit();
-
-    if (engine.asset_database.AssetDatabase.init(allocator, state.ui.assets.assets_dir)) |db| {
-        meta_db = db;
-        meta_db_ready = true;
-    } else |_| {}
+    const meta_db = engine.asset_database.openShared(allocator, state.ui.assets.assets_dir) catch null;
 
     const parent_path = std.fs.path.dirname(state.ui.assets.current_dir);
     if (parent_path) |parent| {
@@ -594,8 +587,8 @@ pub fn scan_assets_dir(state: *EditorState, allocator: std.mem.Allocator) void {
             asset_type = get_asset_type(entry.name);
         }
 
-        if (!is_dir and meta_db_ready) {
-            _ = meta_db.getOrCreateGuidForAsset(full_path) catch {};
+        if (!is_dir) {
+            if (meta_db) |db| _ = db.getOrCreateGuidForAsset(full_path) catch {};
         }
 
         const full_path_z = allocator.dupeZ(u8, full_path) catch continue;
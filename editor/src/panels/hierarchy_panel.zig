@@ -231,14 +231,14 @@ fn is_descendant_of(state: *EditorState, maybe_descendant: entity_module.Entity,
         if (guard > 2048) break;
         guard += 1;
         if (e.id == ancestor.id) return true;
-        const h = state.runtime.registry.get(components.Hierarchy, e) orelse break;
+        const h = state.runtime.registry.get_const(components.Hierarchy, e) orelse break;
         current = h.parent;
     }
     return false;
 }
 
 fn ensure_hierarchy(state: *EditorState, entity: entity_module.Entity) components.Hierarchy {
-    if (state.runtime.registry.get(components.Hierarchy, entity)) |h| return h.*;
+    if (state.runtime.registry.get_const(components.Hierarchy, entity)) |h| return h.*;
     state.runtime.registry.add(entity, components.Hierarchy{}) catch {};
     return components.Hierarchy{};
 }
@@ -390,10 +390,10 @@ fn selected_entity_list(state: *EditorState, alloc: std.mem.Allocator) std.Array
     while (it.next()) |entry| {
         const ent = entity_module.Entity{ .id = entry.key_ptr.* };
         if (!state.runtime.registry.entity_manager.is_alive(ent)) continue;
-        if (state.runtime.registry.get(components.EditorGlobals, ent) != null) continue;
+        if (state.runtime.registry.get_const(components.EditorGlobals, ent) != null) continue;
         out.append(alloc, ent) catch {};
     }
-    if (out.items.len == 0 and state.runtime.registry.entity_manager.is_alive(state.ui.selected_entity) and state.runtime.registry.get(components.EditorGlobals, state.ui.selected_entity) == null) {
+    if (out.items.len == 0 and state.runtime.registry.entity_manager.is_alive(state.ui.selected_entity) and state.runtime.registry.get_const(components.EditorGlobals, state.ui.selected_entity) == null) {
         out.append(alloc, state.ui.selected_entity) catch {};
     }
     return out;
@@ -465,7 +465,7 @@ fn delete_selected_entities(state: *EditorState) void {
 
 fn duplicate_entity_subtree_with_undo(state: *EditorState, root: entity_module.Entity) ?entity_module.Entity {
     if (!state.runtime.registry.entity_manager.is_alive(root)) return null;
-    if (state.runtime.registry.get(components.EditorGlobals, root) != null) return null;
+    if (state.runtime.registry.get_const(components.EditorGlobals, root) != null) return null;
 
     const alloc = engine.memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
     const snaps = state.ui.undo.capture_entity_subtree(state.runtime.registry, root) orelse return null;
@@ -606,14 +606,14 @@ fn set_visibility_for_selected(state: *EditorState, visible: bool) void {
                 }
             }
 
-            if (state.runtime.registry.get(components.Hierarchy, cur)) |h| {
+            if (state.runtime.registry.get_const(components.Hierarchy, cur)) |h| {
                 var child = h.first_child;
                 var guard: u32 = 0;
                 while (child) |c_ent| {
                     if (guard > 100000) break;
                     guard += 1;
                     stack.append(alloc, c_ent) catch {};
-                    child = if (state.runtime.registry.get(components.Hierarchy, c_ent)) |ch| ch.next_sibling else null;
+                    child = if (state.runtime.registry.get_const(components.Hierarchy, c_ent)) |ch| ch.next_sibling else null;
                 }
             }
         }
@@ -625,7 +625,7 @@ fn batch_add_component_camera(state: *EditorState) void {
     var selected = selected_entity_list(state, alloc);
     defer selected.deinit(alloc);
     for (selected.items) |ent| {
-        if (state.runtime.registry.get(components.Camera, ent) != null) continue;
+        if (state.runtime.registry.get_const(components.Camera, ent) != null) continue;
         const after = components.Camera{ .type = .Perspective };
         state.ui.undo.push(.{ .EntityCamera = .{
             .entity_id = ent.id,
@@ -662,7 +662,7 @@ fn batch_add_component_light(state: *EditorState) void {
     var selected = selected_entity_list(state, alloc);
     defer selected.deinit(alloc);
     for (selected.items) |ent| {
-        if (state.runtime.registry.get(components.Light, ent) != null) continue;
+        if (state.runtime.registry.get_const(components.Light, ent) != null) continue;
         const after = components.Light{ .type = .Directional, .cast_shadows = true };
         state.ui.undo.push(.{ .EntityLight = .{
             .entity_id = ent.id,
@@ -699,7 +699,7 @@ fn batch_add_component_mesh_renderer(state: *EditorState) void {
     var selected = selected_entity_list(state, alloc);
     defer selected.deinit(alloc);
     for (selected.items) |ent| {
-        if (state.runtime.registry.get(components.MeshRenderer, ent) != null) continue;
+        if (state.runtime.registry.get_const(components.MeshRenderer, ent) != null) continue;
         const after = components.MeshRenderer{
             .mesh = .{ .index = std.math.maxInt(u32), .generation = 0 },
             .material = .{ .index = std.math.maxInt(u32), .generation = 0 },
@@ -742,7 +742,7 @@ fn batch_add_component_script(state: *EditorState) void {
     var selected = selected_entity_list(state, alloc);
     defer selected.deinit(alloc);
     for (selected.items) |ent| {
-        if (state.runtime.registry.get(components.Script, ent) != null) continue;
+        if (state.runtime.registry.get_const(components.Script, ent) != null) continue;
         const after = components.Script{};
         state.ui.undo.push(.{ .EntityScript = .{
             .entity_id = ent.id,
@@ -845,7 +845,7 @@ fn build_focus_open_chain(state: *EditorState, entity: entity_module.Entity) voi
             state.ui.scene_graph_open_chain_len += 1;
         }
 
-        if (state.runtime.registry.get(components.Hierarchy, e)) |h| {
+        if (state.runtime.registry.get_const(components.Hierarchy, e)) |h| {
             current = h.parent;
         } else {
             current = null;
@@ -896,17 +896,17 @@ fn entity_matches_scene_graph_filter(state: *EditorState, entity: entity_module.
     var category_ok = true;
     if (state.ui.scene_graph_filter_meshes or state.ui.scene_graph_filter_lights or state.ui.scene_graph_filter_cameras) {
         category_ok = false;
-        if (state.ui.scene_graph_filter_meshes and state.runtime.registry.get(components.MeshRenderer, entity) != null) category_ok = true;
-        if (state.ui.scene_graph_filter_lights and state.runtime.registry.get(components.Light, entity) != null) category_ok = true;
-        if (state.ui.scene_graph_filter_cameras and state.runtime.registry.get(components.Camera, entity) != null) category_ok = true;
+        if (state.ui.scene_graph_filter_meshes and state.runtime.registry.get_const(components.MeshRenderer, entity) != null) category_ok = true;
+        if (state.ui.scene_graph_filter_lights and state.runtime.registry.get_const(components.Light, entity) != null) category_ok = true;
+        if (state.ui.scene_graph_filter_cameras and state.runtime.registry.get_const(components.Camera, entity) != null) category_ok = true;
     }
     if (!category_ok) return false;
     if (query.len == 0) return true;
 
-    if (state.runtime.registry.get(components.Name, entity)) |n| {
+    if (state.runtime.registry.get_const(components.Name, entity)) |n| {
         if (contains_insensitive(n.slice(), query)) return true;
     }
-    if (state.runtime.registry.get(components.Node, entity)) |node_comp| {
+    if (state.runtime.registry.get_const(components.Node, entity)) |node_comp| {
         if (contains_insensitive(@tagName(node_comp.type), query)) return true;
     }
     return false;
@@ -920,7 +920,7 @@ fn subtree_matches_filter(
     alloc: std.mem.Allocator,
 ) bool {
     if (cache.get(entity.id)) |v| return v;
-    const h_ptr = state.runtime.registry.get(components.Hierarchy, entity) orelse {
+    const h_ptr = state.runtime.registry.get_const(components.Hierarchy, entity) orelse {
         cache.put(alloc, entity.id, false) catch {};
         return false;
     };
@@ -936,7 +936,7 @@ fn subtree_matches_filter(
                 match = true;
                 break;
             }
-            child = if (state.runtime.registry.get(components.Hierarchy, c_ent)) |ch| ch.next_sibling else null;
+            child = if (state.runtime.registry.get_const(components.Hierarchy, c_ent)) |ch| ch.next_sibling else null;
         }
     }
 
@@ -946,7 +946,7 @@ fn subtree_matches_filter(
 
 fn flat_append_visible(state: *EditorState, alloc: std.mem.Allocator, entity: entity_module.Entity, depth: u32, parent_index: i32, out: *std.ArrayListUnmanaged(FlatNode)) void {
     if (depth > 2048) return;
-    if (state.runtime.registry.get(components.Hierarchy, entity) == null) return;
+    if (state.runtime.registry.get_const(components.Hierarchy, entity) == null) return;
 
     const idx: i32 = @intCast(out.items.len);
     out.append(alloc, .{ .entity = entity, .depth = depth, .parent_index = parent_index }) catch return;
@@ -954,7 +954,7 @@ fn flat_append_visible(state: *EditorState, alloc: std.mem.Allocator, entity: en
     const open = state.ui.scene_graph_open_state.get(entity.id) orelse false;
     if (!open) return;
 
-    const h_ptr = state.runtime.registry.get(components.Hierarchy, entity) orelse return;
+    const h_ptr = state.runtime.registry.get_const(components.Hierarchy, entity) orelse return;
     var child = h_ptr.first_child;
     var loop_guard: u32 = 0;
     while (child) |c_ent| {
@@ -962,7 +962,7 @@ fn flat_append_visible(state: *EditorState, alloc: std.mem.Allocator, entity: en
         loop_guard += 1;
 
         flat_append_visible(state, alloc, c_ent, depth + 1, idx, out);
-        child = if (state.runtime.registry.get(components.Hierarchy, c_ent)) |ch| ch.next_sibling else null;
+        child = if (state.runtime.registry.get_const(components.Hierarchy, c_ent)) |ch| ch.next_sibling else null;
     }
 }
 
@@ -978,12 +978,12 @@ fn flat_append_filtered(
 ) void {
     if (depth > 2048) return;
     if (!subtree_matches_filter(state, entity, query, cache, alloc)) return;
-    if (state.runtime.registry.get(components.Hierarchy, entity) == null) return;
+    if (state.runtime.registry.get_const(components.Hierarchy, entity) == null) return;
 
     const idx: i32 = @intCast(out.items.len);
     out.append(alloc, .{ .entity = entity, .depth = depth, .parent_index = parent_index }) catch return;
 
-    const h_ptr = state.runtime.registry.get(components.Hierarchy, entity) orelse return;
+    const h_ptr = state.runtime.registry.get_const(components.Hierarchy, entity) orelse return;
     var child = h_ptr.first_child;
     var loop_guard: u32 = 0;
     while (child) |c_ent| {
@@ -991,7 +991,7 @@ fn flat_append_filtered(
         loop_guard += 1;
 
         flat_append_filtered(state, alloc, c_ent, depth + 1, idx, query, cache, out);
-        child = if (state.runtime.registry.get(components.Hierarchy, c_ent)) |ch| ch.next_sibling else null;
+        child = if (state.runtime.registry.get_const(components.Hierarchy, c_ent)) |ch| ch.next_sibling else null;
     }
 }
 
@@ -1013,7 +1013,7 @@ fn build_scene_graph_flat(state: *EditorState, alloc: std.mem.Allocator, out: *s
 
     const globals_entity = scene_graph_globals_entity(state);
     if (globals_entity) |ge| {
-        if (state.runtime.registry.get(components.Hierarchy, ge)) |h| {
+        if (state.runtime.registry.get_const(components.Hierarchy, ge)) |h| {
             if (is_scene_graph_root(h)) {
                 if (filter_active) {
                     flat_append_filtered(state, alloc, ge, 0, -1, query, &cache, out);
@@ -1024,7 +1024,7 @@ fn build_scene_graph_flat(state: *EditorState, alloc: std.mem.Allocator, out: *s
         }
     }
 
-    var it = state.runtime.registry.view(components.Hierarchy).iterator();
+    var it = state.runtime.registry.view(components.Hierarchy).const_iterator();
     while (it.next()) |entry| {
         const entity = entry.entity;
         if (globals_entity) |ge| {
@@ -1044,8 +1044,8 @@ fn build_scene_graph_flat(state: *EditorState, alloc: std.mem.Allocator, out: *s
 fn draw_flat_node(state: *EditorState, node: FlatNode, indent_spacing: f32, rebuild_requested: *bool) void {
     if (!state.runtime.registry.entity_manager.is_alive(node.entity)) return;
 
-    const hierarchy = state.runtime.registry.get(components.Hierarchy, node.entity) orelse return;
-    const is_globals = state.runtime.registry.get(components.EditorGlobals, node.entity) != null;
+    const hierarchy = state.runtime.registry.get_const(components.Hierarchy, node.entity) orelse return;
+    const is_globals = state.runtime.registry.get_const(components.EditorGlobals, node.entity) != null;
 
     const filter_active = scene_graph_filter_active(state);
     const has_children = hierarchy.first_child != null and !filter_active;
@@ -1058,12 +1058,12 @@ fn draw_flat_node(state: *EditorState, node: FlatNode, indent_spacing: f32, rebu
 
     var name_buf: [256]u8 = undefined;
     var name: []const u8 = "Entity";
-    if (state.runtime.registry.get(components.Name, node.entity)) |n| {
+    if (state.runtime.registry.get_const(components.Name, node.entity)) |n| {
         name = n.slice();
     }
 
     var prefix: []const u8 = "";
-    if (state.runtime.registry.get(components.Node, node.entity)) |node_comp| {
+    if (state.runtime.registry.get_const(components.Node, node.entity)) |node_comp| {
         prefix = node_prefix(node_comp.type);
     }
 
@@ -1325,7 +1325,7 @@ fn mesh_entity_for_index(state: *EditorState, mesh_index: u32) ?entity_module.En
     if (state.runtime.mesh_entity_by_mesh_index.get(mesh_index)) |id| {
         const ent = entity_module.Entity{ .id = id };
         if (!state.runtime.registry.entity_manager.is_alive(ent)) return null;
-        if (state.runtime.registry.get(components.MeshRenderer, ent) == null) return null;
+        if (state.runtime.registry.get_const(components.MeshRenderer, ent) == null) return null;
         return ent;
     }
     return null;
@@ -1476,8 +1476,7 @@ pub fn draw_hierarchy_panel(state: *EditorState) void {
                 c.imgui_bridge_bullet_text("Directional Light");
 
                 var flat: std.ArrayListUnmanaged(FlatNode) = .{};
-                const alloc = engine.memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
-                defer flat.deinit(alloc);
+                const alloc = engine.memory.cardinal_get_frame_allocator().as_allocator();
                 var rebuild_requested = false;
                 build_scene_graph_flat(state, alloc, &flat);
 
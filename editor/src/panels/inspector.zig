@@ -49,7 +49,7 @@ fn scene_mesh_label(state: *EditorState, mesh_index: u32) [*:0]const u8 {
         if (state.runtime.mesh_entity_by_mesh_index.get(mesh_index)) |id| {
             const ent = engine.ecs_entity.Entity{ .id = id };
             if (state.runtime.registry.entity_manager.is_alive(ent)) {
-                if (state.runtime.registry.get(components.Name, ent)) |n| {
+                if (state.runtime.registry.get_const(components.Name, ent)) |n| {
                     break :blk std.fmt.bufPrintZ(&buf, "{s} (mesh {d})", .{ n.slice(), mesh_index }) catch "Mesh\x00";
                 }
             }
@@ -217,7 +217,7 @@ fn sync_entity_buffers(state: *EditorState, entity: engine.ecs_entity.Entity) vo
     @memset(&state.ui.inspector_add_component_search, 0);
 
     @memset(&state.ui.inspector_name_buffer, 0);
-    if (state.runtime.registry.get(components.Name, entity)) |n| {
+    if (state.runtime.registry.get_const(components.Name, entity)) |n| {
         const s = n.slice();
         const len = @min(s.len, state.ui.inspector_name_buffer.len - 1);
         @memcpy(state.ui.inspector_name_buffer[0..len], s[0..len]);
@@ -225,14 +225,14 @@ fn sync_entity_buffers(state: *EditorState, entity: engine.ecs_entity.Entity) vo
     }
 
     @memset(&state.ui.inspector_skybox_buffer, 0);
-    if (state.runtime.registry.get(components.Skybox, entity)) |sb| {
+    if (state.runtime.registry.get_const(components.Skybox, entity)) |sb| {
         const s = sb.slice();
         const len = @min(s.len, state.ui.inspector_skybox_buffer.len - 1);
         @memcpy(state.ui.inspector_skybox_buffer[0..len], s[0..len]);
         state.ui.inspector_skybox_buffer[len] = 0;
     }
 
-    if (state.runtime.registry.get(components.Transform, entity)) |t| {
+    if (state.runtime.registry.get_const(components.Transform, entity)) |t| {
         state.ui.inspector_rotation_euler_deg = quat_to_euler_xyz_deg(t.rotation);
     } else {
         state.ui.inspector_rotation_euler_deg = .{ 0.0, 0.0, 0.0 };
@@ -424,7 +424,7 @@ fn draw_editor_globals(state: *EditorState, entity: engine.ecs_entity.Entity, g:
         if (g.game_camera_entity_id != std.math.maxInt(u64)) {
             const ent = engine.ecs_entity.Entity{ .id = g.game_camera_entity_id };
             if (state.runtime.registry.entity_manager.is_alive(ent)) {
-                if (state.runtime.registry.get(components.Name, ent)) |n| {
+                if (state.runtime.registry.get_const(components.Name, ent)) |n| {
                     c.imgui_bridge_text("Camera: %s", @as([*:0]const u8, @ptrCast(&n.value)));
                 } else {
                     c.imgui_bridge_text("Camera Entity: %d", ent.index());
@@ -438,7 +438,7 @@ fn draw_editor_globals(state: *EditorState, entity: engine.ecs_entity.Entity, g:
 
         if (c.imgui_bridge_button("Use Selected Camera")) {
             const ent = state.ui.selected_entity;
-            if (state.runtime.registry.entity_manager.is_alive(ent) and state.runtime.registry.get(components.Camera, ent) != null) {
+            if (state.runtime.registry.entity_manager.is_alive(ent) and state.runtime.registry.get_const(components.Camera, ent) != null) {
                 g.game_camera_entity_id = ent.id;
                 changed = true;
             }
@@ -601,7 +601,7 @@ fn draw_entity_inspector_panel(state: *EditorState) void {
                 const label_z = std.fmt.bufPrintZ(&buf, "{s}", .{entry.label}) catch continue;
                 if (c.imgui_bridge_selectable(label_z.ptr, false, 0)) {
                     if (std.mem.eql(u8, entry.label, "Camera")) {
-                        if (state.runtime.registry.get(components.Camera, entity) == null) {
+                        if (state.runtime.registry.get_const(components.Camera, entity) == null) {
                             const after = components.Camera{ .type = .Perspective };
                             state.ui.undo.push(.{ .EntityCamera = .{
                                 .entity_id = entity.id,
@@ -614,7 +614,7 @@ fn draw_entity_inspector_panel(state: *EditorState) void {
                         }
                         if (state.runtime.registry.get(components.Node, entity)) |n| n.type = .Camera3D;
                     } else if (std.mem.eql(u8, entry.label, "Light")) {
-                        if (state.runtime.registry.get(components.Light, entity) == null) {
+                        if (state.runtime.registry.get_const(components.Light, entity) == null) {
                             const after = components.Light{ .type = .Directional, .cast_shadows = true };
                             state.ui.undo.push(.{ .EntityLight = .{
                                 .entity_id = entity.id,
@@ -627,7 +627,7 @@ fn draw_entity_inspector_panel(state: *EditorState) void {
                         }
                         if (state.runtime.registry.get(components.Node, entity)) |n| n.type = .DirectionalLight3D;
                     } else if (std.mem.eql(u8, entry.label, "MeshRenderer")) {
-                        if (state.runtime.registry.get(components.MeshRenderer, entity) == null) {
+                        if (state.runtime.registry.get_const(components.MeshRenderer, entity) == null) {
                             const after = components.MeshRenderer{
                                 .mesh = .{ .index = 0, .generation = 0 },
                                 .material = .{ .index = 0, .generation = 0 },
@@ -646,7 +646,7 @@ fn draw_entity_inspector_panel(state: *EditorState) void {
                         }
                         if (state.runtime.registry.get(components.Node, entity)) |n| n.type = .MeshInstance3D;
                     } else if (std.mem.eql(u8, entry.label, "Skybox")) {
-                        if (state.runtime.registry.get(components.Skybox, entity) == null) {
+                        if (state.runtime.registry.get_const(components.Skybox, entity) == null) {
                             const after = components.Skybox.init(buffer_slice(&state.ui.inspector_skybox_buffer));
                             state.ui.undo.push(.{ .EntitySkybox = .{
                                 .entity_id = entity.id,
@@ -659,7 +659,7 @@ fn draw_entity_inspector_panel(state: *EditorState) void {
                         }
                         if (state.runtime.registry.get(components.Node, entity)) |n| n.type = .Skybox;
                     } else if (std.mem.eql(u8, entry.label, "Script")) {
-                        if (state.runtime.registry.get(components.Script, entity) == null) {
+                        if (state.runtime.registry.get_const(components.Script, entity) == null) {
                             const after = components.Script{};
                             state.ui.undo.push(.{ .EntityScript = .{
                                 .entity_id = entity.id,
@@ -990,7 +990,7 @@ fn draw_entity_inspector_panel(state: *EditorState) void {
                     }
                 },
                 .Node => {
-                    if (st.runtime.registry.get(components.Node, ent) == null) return;
+                    if (st.runtime.registry.get_const(components.Node, ent) == null) return;
                     const section_open = c.imgui_bridge_collapsing_header("Node", 0);
                     if (c.imgui_bridge_begin_drag_drop_source(0)) {
                         set_payload(k);
@@ -1024,21 +1024,21 @@ fn draw_entity_inspector_panel(state: *EditorState) void {
                                 .before = before,
                                 .after = node.*,
                             } });
-                            if (tag == .Camera3D and st.runtime.registry.get(components.Camera, ent) == null) {
+                            if (tag == .Camera3D and st.runtime.registry.get_const(components.Camera, ent) == null) {
                                 st.runtime.registry.add(ent, components.Camera{ .type = .Perspective }) catch {};
-                            } else if (tag == .Camera2D and st.runtime.registry.get(components.Camera, ent) == null) {
+                            } else if (tag == .Camera2D and st.runtime.registry.get_const(components.Camera, ent) == null) {
                                 st.runtime.registry.add(ent, components.Camera{ .type = .Orthographic }) catch {};
-                            } else if ((tag == .DirectionalLight3D or tag == .PointLight3D or tag == .SpotLight3D) and st.runtime.registry.get(components.Light, ent) == null) {
+                            } else if ((tag == .DirectionalLight3D or tag == .PointLight3D or tag == .SpotLight3D) and st.runtime.registry.get_const(components.Light, ent) == null) {
                                 const lt: components.LightType = if (tag == .PointLight3D) .Point else if (tag == .SpotLight3D) .Spot else .Directional;
                                 st.runtime.registry.add(ent, components.Light{ .type = lt, .cast_shadows = (lt == .Directional) }) catch {};
-                            } else if (tag == .Skybox and st.runtime.registry.get(components.Skybox, ent) == null) {
+                            } else if (tag == .Skybox and st.runtime.registry.get_const(components.Skybox, ent) == null) {
                                 st.runtime.registry.add(ent, components.Skybox.init(buffer_slice(&st.ui.inspector_skybox_buffer))) catch {};
                             }
                         }
                     }
                 },
                 .Transform => {
-                    if (st.runtime.registry.get(components.Transform, ent) == null) return;
+                    if (st.runtime.registry.get_const(components.Transform, ent) == null) return;
                     const section_open = c.imgui_bridge_collapsing_header("Transform", 0);
                     if (c.imgui_bridge_begin_drag_drop_source(0)) {
                         set_payload(k);
@@ -1049,9 +1049,11 @@ fn draw_entity_inspector_panel(state: *EditorState) void {
 
                     if (!section_open) return;
 
-                    const t = st.runtime.registry.get(components.Transform, ent).?;
+                    // Drawn every frame; only an actual edit marks the transform changed.
+                    const t = st.runtime.registry.get_untracked(components.Transform, ent).?;
                     const any_active = c.imgui_bridge_is_any_item_active();
                     const before = t.*;
+                    defer if (!std.meta.eql(before, t.*)) st.runtime.registry.mark_changed(components.Transform, ent);
 
                     c.imgui_bridge_text("%s", if (st.ui.transform_space_world) "Space: World" else "Space: Local");
                     c.imgui_bridge_same_line(0, -1);
@@ -1259,7 +1261,7 @@ fn draw_entity_inspector_panel(state: *EditorState) void {
                     }
                 },
                 .MeshRenderer => {
-                    if (st.runtime.registry.get(components.MeshRenderer, ent) == null) return;
+                    if (st.runtime.registry.get_const(components.MeshRenderer, ent) == null) return;
                     const section_open = c.imgui_bridge_collapsing_header("MeshRenderer", 0);
                     if (c.imgui_bridge_begin_drag_drop_source(0)) {
                         set_payload(k);
@@ -1269,7 +1271,7 @@ fn draw_entity_inspector_panel(state: *EditorState) void {
                     draw_pin(st, k);
                     if (!section_open) return;
 
-                    const mr = st.runtime.registry.get(components.MeshRenderer, ent).?;
+                    const mr = st.runtime.registry.get_untracked(components.MeshRenderer, ent).?;
                     c.imgui_bridge_same_line(0, -1);
                     if (c.imgui_bridge_button("Remove##MeshRenderer")) {
                         const before = mr.*;
@@ -1288,6 +1290,7 @@ fn draw_entity_inspector_panel(state: *EditorState) void {
                     }
 
                     const before = mr.*;
+                    defer if (!std.meta.eql(before, mr.*)) st.runtime.registry.mark_changed(components.MeshRenderer, ent);
                     var changed = false;
                     if (st.runtime.combined_scene.mesh_count > 0) {
                         const mesh_count: usize = @intCast(st.runtime.combined_scene.mesh_count);
@@ -1368,7 +1371,7 @@ fn draw_entity_inspector_panel(state: *EditorState) void {
                     }
                 },
                 .Terrain => {
-                    if (st.runtime.registry.get(components.Terrain, ent) == null) return;
+                    if (st.runtime.registry.get_const(components.Terrain, ent) == null) return;
                     const section_open = c.imgui_bridge_collapsing_header("Terrain", 0);
                     if (c.imgui_bridge_begin_drag_drop_source(0)) {
                         set_payload(k);
@@ -1408,7 +1411,7 @@ fn draw_entity_inspector_panel(state: *EditorState) void {
                     }
                 },
                 .Light => {
-                    if (st.runtime.registry.get(components.Light, ent) == null) return;
+                    if (st.runtime.registry.get_const(components.Light, ent) == null) return;
                     const section_open = c.imgui_bridge_collapsing_header("Light", 0);
                     if (c.imgui_bridge_begin_drag_drop_source(0)) {
                         set_payload(k);
@@ -1456,7 +1459,7 @@ fn draw_entity_inspector_panel(state: *EditorState) void {
                     }
                 },
                 .Camera => {
-                    if (st.runtime.registry.get(components.Camera, ent) == null) return;
+                    if (st.runtime.registry.get_const(components.Camera, ent) == null) return;
                     const section_open = c.imgui_bridge_collapsing_header("Camera", 0);
                     if (c.imgui_bridge_begin_drag_drop_source(0)) {
                         set_payload(k);
@@ -1504,7 +1507,7 @@ fn draw_entity_inspector_panel(state: *EditorState) void {
                     }
                 },
                 .Skybox => {
-                    if (st.runtime.registry.get(components.Skybox, ent) == null) return;
+                    if (st.runtime.registry.get_const(components.Skybox, ent) == null) return;
                     const section_open = c.imgui_bridge_collapsing_header("Skybox", 0);
                     if (c.imgui_bridge_begin_drag_drop_source(0)) {
                         set_payload(k);
@@ -1566,7 +1569,7 @@ fn draw_entity_inspector_panel(state: *EditorState) void {
                     }
                 },
                 .Script => {
-                    if (st.runtime.registry.get(components.Script, ent) == null) return;
+                    if (st.runtime.registry.get_const(components.Script, ent) == null) return;
                     const section_open = c.imgui_bridge_collapsing_header("Script", 0);
                     if (c.imgui_bridge_begin_drag_drop_source(0)) {
                         set_payload(k);
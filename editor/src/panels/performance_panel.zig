@@ -1,21 +1,34 @@
 //! Performance panel.
 //!
-//! Displays basic frame timing and the engine's global memory statistics.
+//! Displays basic frame timing, per-frame allocation activity, the engine's global memory
+//! statistics, GPU upload, shadow caster and terrain remesh statistics, and the built-in profiler
+//! (frame history, a per-thread zone timeline of a captured frame, and capture export).
 //!
-//! TODO: Track per-frame allocation deltas instead of only absolute totals.
 //! TODO: Derive category names from the engine memory category enum to avoid drift.
 const std = @import("std");
 const engine = @import("cardinal_engine");
 const c = @import("../c.zig").c;
 const EditorState = @import("../editor_state.zig").EditorState;
+const volumetric_terrain = @import("../systems/volumetric_terrain.zig");
 const renderer = engine.vulkan_renderer;
 const memory = engine.memory;
+const profiler = engine.profiler;
+const log = engine.log;
 
 /// Number of samples stored in the frame-time history.
 const HISTORY_SIZE = 240;
 var frame_time_history: [HISTORY_SIZE]f32 = [_]f32{0} ** HISTORY_SIZE;
 var history_offset: usize = 0;
 
+/// Profiler UI state. The captured frame stays on screen until the next capture.
+var profiler_recording = false;
+var profiler_capture: ?profiler.Capture = null;
+var profiler_frame_times: [profiler.FRAME_HISTORY]f32 = [_]f32{0} ** profiler.FRAME_HISTORY;
+
+/// Timeline layout.
+const TIMELINE_ROW_HEIGHT: f32 = 16.0;
+const TIMELINE_MAX_DEPTH = 32;
+
 /// Display names for memory categories in `CardinalGlobalMemoryStats`.
 const memory_category_names = [_][:0]const u8{ "Unknown", "Engine", "Renderer", "Vulkan Buffers", "Vulkan Device", "Textures", "Meshes", "Assets", "Shaders", "Window", "Logging", "Temporary" };
 
@@ -34,7 +47,7 @@ pub fn draw_performance_panel(state: *EditorState) void {
 
             c.imgui_bridge_text("Frame Performance");
 
-            var buf: [64]u8 = undefined;
+            var buf: [128]u8 = undefined;
             const text = std.fmt.bufPrintZ(&buf, "FPS: {d:.1} | Frame Time: {d:.3} ms", .{ fps, dt }) catch "FPS: ???";
             c.imgui_bridge_text("%s", text.ptr);
 
@@ -56,6 +69,23 @@ pub fn draw_performance_panel(state: *EditorState) void {
                 const alloc_text = std.fmt.bufPrintZ(&buf, "Allocations: {d}", .{stats.total.allocation_count - stats.total.free_count}) catch "???";
                 c.imgui_bridge_text("%s", alloc_text.ptr);
 
+                var frame_stats: memory.CardinalFrameMemoryStats = undefined;
+                memory.cardinal_memory_get_frame_stats(&frame_stats);
+
+                const heap_text = std.fmt.bufPrintZ(&buf, "Last Frame Heap: {d} allocs / {d} frees, {d:.1} KB", .{
+                    frame_stats.heap_allocation_count,
+                    frame_stats.heap_free_count,
+                    @as(f64, @floatFromInt(frame_stats.heap_allocated_bytes)) / 1024.0,
+                }) catch "???";
+                c.imgui_bridge_text("%s", heap_text.ptr);
+
+                const arena_text = std.fmt.bufPrintZ(&buf, "Frame Arena: {d} allocs, {d:.1} / {d:.1} KB", .{
+                    frame_stats.frame_arena_allocation_count,
+                    @as(f64, @floatFromInt(frame_stats.frame_arena_bytes)) / 1024.0,
+                    @as(f64, @floatFromInt(frame_stats.frame_arena_capacity)) / 1024.0,
+                }) catch "???";
+                c.imgui_bridge_text("%s", arena_text.ptr);
+
                 if (c.imgui_bridge_begin_table("MemoryCategories", 4, c.ImGuiTableFlags_Borders | c.ImGuiTableFlags_RowBg | c.ImGuiTableFlags_Resizable, &c.ImVec2{ .x = 0, .y = 0 }, 0.0)) {
                     c.imgui_bridge_table_setup_column("Category", c.ImGuiTableColumnFlags_None, 0.0, 0);
                     c.imgui_bridge_table_setup_column("Usage (MB)", c.ImGuiTableColumnFlags_None, 0.0, 0);
@@ -94,11 +124,237 @@ pub fn draw_performance_panel(state: *EditorState) void {
 
             c.imgui_bridge_separator();
 
+            if (c.imgui_bridge_collapsing_header("GPU Uploads", c.ImGuiTreeNodeFlags_None)) {
+                if (engine.vulkan_staging_ring.active()) |ring| {
+                    const upload_stats = ring.get_stats();
+
+                    const rate_text = std.fmt.bufPrintZ(&buf, "Bandwidth: {d:.1} MB/s", .{upload_stats.bytes_per_second / (1024.0 * 1024.0)}) catch "???";
+                    c.imgui_bridge_text("%s", rate_text.ptr);
+
+                    const total_text = std.fmt.bufPrintZ(&buf, "Uploaded: {d:.2} MB in {d} copies / {d} submits", .{
+                        @as(f64, @floatFromInt(upload_stats.bytes)) / (1024.0 * 1024.0),
+                        upload_stats.copies,
+                        upload_stats.submits,
+                    }) catch "???";
+                    c.imgui_bridge_text("%s", total_text.ptr);
+
+                    const stall_text = std.fmt.bufPrintZ(&buf, "Ring stalls: {d}, oversized images: {d}", .{ upload_stats.stalls, upload_stats.oversized }) catch "???";
+                    c.imgui_bridge_text("%s", stall_text.ptr);
+                } else {
+                    c.imgui_bridge_text("Staging ring inactive; uploads use one-shot staging buffers.");
+                }
+            }
+
+            c.imgui_bridge_separator();
+
+            if (c.imgui_bridge_collapsing_header("Shadows", c.ImGuiTreeNodeFlags_None)) {
+                const shadow_stats = engine.vulkan_shadows.caster_stats();
+
+                const caster_text = std.fmt.bufPrintZ(&buf, "Casters: {d}, cascade draws: {d} of {d}", .{ shadow_stats.casters, shadow_stats.drawn, shadow_stats.unculled }) catch "???";
+                c.imgui_bridge_text("%s", caster_text.ptr);
+
+                const cached_text = std.fmt.bufPrintZ(&buf, "Cached cascades: {d}", .{shadow_stats.cached_cascades}) catch "???";
+                c.imgui_bridge_text("%s", cached_text.ptr);
+            }
+
+            c.imgui_bridge_separator();
+
+            if (c.imgui_bridge_collapsing_header("Terrain Remeshing", c.ImGuiTreeNodeFlags_None)) {
+                const remesh = volumetric_terrain.remesh_stats();
+
+                const queue_text = std.fmt.bufPrintZ(&buf, "Queued: {d} ({d} deferred), in flight: {d} ({d:.1} MB)", .{
+                    remesh.queue_depth,
+                    remesh.deferred,
+                    remesh.in_flight,
+                    @as(f64, @floatFromInt(remesh.in_flight_bytes)) / (1024.0 * 1024.0),
+                }) catch "???";
+                c.imgui_bridge_text("%s", queue_text.ptr);
+
+                const latency_text = std.fmt.bufPrintZ(&buf, "Latency p50 {d:.1} / p95 {d:.1} / p99 {d:.1} ms", .{ remesh.latency_p50_ms, remesh.latency_p95_ms, remesh.latency_p99_ms }) catch "???";
+                c.imgui_bridge_text("%s", latency_text.ptr);
+
+                const count_text = std.fmt.bufPrintZ(&buf, "Dispatched: {d}, completed: {d}, superseded: {d}", .{ remesh.dispatched, remesh.completed, remesh.superseded }) catch "???";
+                c.imgui_bridge_text("%s", count_text.ptr);
+            }
+
+            c.imgui_bridge_separator();
+
+            if (c.imgui_bridge_collapsing_header("Profiler", c.ImGuiTreeNodeFlags_None)) {
+                draw_profiler_section();
+            }
+
+            c.imgui_bridge_separator();
+
             if (c.imgui_bridge_collapsing_header("External Profiling", c.ImGuiTreeNodeFlags_None)) {
-                c.imgui_bridge_text("Tracy Profiler is enabled.");
-                c.imgui_bridge_text("Run the Tracy Server application to connect and view detailed timeline.");
-                c.imgui_bridge_text("This panel shows live aggregate stats.");
+                if (engine.tracy.enabled) {
+                    c.imgui_bridge_text("Tracy Profiler is enabled.");
+                    c.imgui_bridge_text("Run the Tracy Server application to connect and view detailed timeline.");
+                } else {
+                    c.imgui_bridge_text("Tracy Profiler is disabled in this build.");
+                }
+                c.imgui_bridge_text("Profiler captures export to Chrome trace JSON for chrome://tracing or Perfetto.");
             }
         }
     }
 }
+
+fn draw_profiler_section() void {
+    if (c.imgui_bridge_checkbox("Record", &profiler_recording)) {
+        profiler.set_recording(profiler_recording);
+    }
+
+    var history_buf: [profiler.FRAME_HISTORY]profiler.FrameStats = undefined;
+    const history = profiler.frame_history(&history_buf);
+    if (history.len == 0) {
+        c.imgui_bridge_text_disabled("No frames recorded yet.");
+    } else {
+        var slowest: usize = 0;
+        for (history, 0..) |frame, i| {
+            profiler_frame_times[i] = @floatCast(frame.duration_ms());
+            if (frame.end_ns -| frame.start_ns > history[slowest].end_ns -| history[slowest].start_ns) slowest = i;
+        }
+
+        var buf: [160]u8 = undefined;
+        const last = history[history.len - 1];
+        const last_text = std.fmt.bufPrintZ(&buf, "Last frame: {d:.3} ms | {d} jobs | {d} loader tasks | {d} uploads ({d:.1} KB) | {d} allocs", .{
+            last.duration_ms(),
+            last.jobs,
+            last.loader_tasks,
+            last.uploads,
+            @as(f64, @floatFromInt(last.upload_bytes)) / 1024.0,
+            last.allocations,
+        }) catch "???";
+        c.imgui_bridge_text("%s", last_text.ptr);
+
+        const graph_size = c.ImVec2{ .x = 0, .y = 60 };
+        c.imgui_bridge_plot_lines("##ProfilerFrames", &profiler_frame_times[0], @intCast(history.len), 0, "Recorded Frames (ms)", 0.0, 33.3, &graph_size, @as(c_int, @intCast(@sizeOf(f32))));
+
+        if (c.imgui_bridge_button("Capture Last Frame")) capture_range(last.start_ns, last.end_ns);
+        c.imgui_bridge_same_line(0.0, -1.0);
+        if (c.imgui_bridge_button("Capture Slowest Frame")) capture_range(history[slowest].start_ns, history[slowest].end_ns);
+        c.imgui_bridge_same_line(0.0, -1.0);
+        if (c.imgui_bridge_button("Capture History")) capture_range(history[0].start_ns, last.end_ns);
+    }
+
+    if (profiler_capture) |*cap| {
+        var buf: [128]u8 = undefined;
+        const info = std.fmt.bufPrintZ(&buf, "Capture: {d:.3} ms, {d} threads, {d} events", .{
+            @as(f64, @floatFromInt(cap.end_ns -| cap.start_ns)) / 1e6,
+            cap.threads.len,
+            cap.event_count(),
+        }) catch "???";
+        c.imgui_bridge_text("%s", info.ptr);
+
+        const allocator = memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
+        if (c.imgui_bridge_button("Save .cprof")) {
+            if (cap.save(allocator, "profile.cprof")) {
+                log.cardinal_log_info("Saved profiler capture to profile.cprof", .{});
+            } else |err| {
+                log.cardinal_log_error("Failed to save profiler capture: {}", .{err});
+            }
+        }
+        c.imgui_bridge_same_line(0.0, -1.0);
+        if (c.imgui_bridge_button("Export Chrome Trace")) {
+            if (cap.export_chrome_trace(allocator, "profile.json")) {
+                log.cardinal_log_info("Exported Chrome trace to profile.json", .{});
+            } else |err| {
+                log.cardinal_log_error("Failed to export Chrome trace: {}", .{err});
+            }
+        }
+
+        draw_timeline(cap);
+    }
+}
+
+fn capture_range(start_ns: u64, end_ns: u64) void {
+    if (profiler_capture) |*cap| cap.deinit();
+    profiler_capture = null;
+    const allocator = memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
+    profiler_capture = profiler.capture(allocator, start_ns, end_ns) catch |err| blk: {
+        log.cardinal_log_error("Profiler capture failed: {}", .{err});
+        break :blk null;
+    };
+}
+
+/// Stable, readable colour for a zone name (ImGui packs colours as ABGR).
+fn zone_color(name: []const u8) u32 {
+    const h: u32 = @truncate(std.hash.Wyhash.hash(0, name));
+    const r = 80 + (h & 0x7f);
+    const g = 80 + ((h >> 8) & 0x7f);
+    const b = 80 + ((h >> 16) & 0x7f);
+    return 0xFF000000 | (b << 16) | (g << 8) | r;
+}
+
+/// Draws one lane per thread with zones stacked by nesting depth.
+fn draw_timeline(cap: *const profiler.Capture) void {
+    const width = @max(c.imgui_bridge_get_content_region_avail_x(), 1.0);
+    const span: f32 = @floatFromInt(@max(cap.end_ns -| cap.start_ns, 1));
+    var mouse: c.ImVec2 = undefined;
+    c.imgui_bridge_get_mouse_pos(&mouse);
+
+    for (cap.threads) |track| {
+        var max_depth: usize = 0;
+        var depth: usize = 0;
+        for (track.events) |event| {
+            switch (event.kind) {
+                .begin => {
+                    depth += 1;
+                    max_depth = @max(max_depth, depth);
+                },
+                .end => depth -|= 1,
+                else => {},
+            }
+        }
+        if (max_depth == 0) continue;
+        max_depth = @min(max_depth, TIMELINE_MAX_DEPTH);
+
+        var label_buf: [64]u8 = undefined;
+        const label = std.fmt.bufPrintZ(&label_buf, "{s} ({d})", .{ if (track.name.len > 0) track.name else "Thread", track.thread_id }) catch "Thread";
+        c.imgui_bridge_text("%s", label.ptr);
+
+        var origin: c.ImVec2 = undefined;
+        c.imgui_bridge_get_cursor_screen_pos(&origin);
+        const lane_height = TIMELINE_ROW_HEIGHT * @as(f32, @floatFromInt(max_depth));
+        const lane_end = c.ImVec2{ .x = origin.x + width, .y = origin.y + lane_height };
+        c.imgui_bridge_draw_rect_filled(&origin, &lane_end, 0x40202020);
+
+        var stack: [TIMELINE_MAX_DEPTH]u64 = undefined;
+        var open: usize = 0;
+        var open_total: usize = 0;
+        for (track.events) |event| {
+            switch (event.kind) {
+                .begin => {
+                    if (open_total < TIMELINE_MAX_DEPTH) {
+                        stack[open] = event.timestamp_ns;
+                        open += 1;
+                    }
+                    open_total += 1;
+                },
+                .end => {
+                    // Zones opened before the capture started have no begin.
+                    if (open_total == 0) continue;
+                    open_total -= 1;
+                    if (open_total >= TIMELINE_MAX_DEPTH) continue;
+                    open -= 1;
+                    const begin_ns = stack[open];
+                    const x0 = origin.x + @as(f32, @floatFromInt(begin_ns -| cap.start_ns)) / span * width;
+                    const x1 = origin.x + @as(f32, @floatFromInt(event.timestamp_ns -| cap.start_ns)) / span * width;
+                    const y0 = origin.y + TIMELINE_ROW_HEIGHT * @as(f32, @floatFromInt(open));
+                    const p0 = c.ImVec2{ .x = x0, .y = y0 };
+                    const p1 = c.ImVec2{ .x = @max(x1, x0 + 1.0), .y = y0 + TIMELINE_ROW_HEIGHT - 1.0 };
+                    const name = std.mem.span(event.name);
+                    c.imgui_bridge_draw_rect_filled(&p0, &p1, zone_color(name));
+                    if (p1.x - p0.x > 24.0) c.imgui_bridge_draw_text_clipped(&p0, &p1, 0xFF000000, event.name);
+
+                    if (mouse.x >= p0.x and mouse.x < p1.x and mouse.y >= p0.y and mouse.y < p1.y) {
+                        const ms = @as(f64, @floatFromInt(event.timestamp_ns -| begin_ns)) / 1e6;
+                        c.imgui_bridge_set_tooltip("%s: %.3f ms", event.name, ms);
+                    }
+                },
+                else => {},
+            }
+        }
+
+        c.imgui_bridge_dummy(&c.ImVec2{ .x = width, .y = lane_height });
+    }
+}
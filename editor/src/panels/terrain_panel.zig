@@ -64,16 +64,6 @@ const VolumetricStrokeState = struct {
 
 var active_volumetric_stroke: ?VolumetricStrokeState = null;
 
-fn sphere_intersects_aabb(center: math.Vec3, radius: f32, aabb_min: math.Vec3, aabb_max: math.Vec3) bool {
-    const cx = std.math.clamp(center.x, aabb_min.x, aabb_max.x);
-    const cy = std.math.clamp(center.y, aabb_min.y, aabb_max.y);
-    const cz = std.math.clamp(center.z, aabb_min.z, aabb_max.z);
-    const dx = center.x - cx;
-    const dy = center.y - cy;
-    const dz = center.z - cz;
-    return (dx * dx + dy * dy + dz * dz) <= radius * radius;
-}
-
 fn brush_can_stamp(state: *EditorState, hit_world: math.Vec3) bool {
     const spacing = state.ui.terrain_brush_spacing;
     if (spacing <= 0.0001) return true;
@@ -222,18 +212,8 @@ fn volumetric_stroke_end_and_push_undo(state: *EditorState) void {
 
 /// Resolves the mesh index range for a model inside the combined scene.
 fn get_model_combined_mesh_range(state: *EditorState, model_id: u32) ?struct { start: u32, count: u32 } {
-    if (state.runtime.model_manager.models == null) return null;
-    const models = state.runtime.model_manager.models.?;
-
-    var offset: u32 = 0;
-    var i: u32 = 0;
-    while (i < state.runtime.model_manager.model_count) : (i += 1) {
-        const m = &models[i];
-        if (!m.visible or m.is_loading) continue;
-        if (m.id == model_id) return .{ .start = offset, .count = m.scene.mesh_count };
-        offset += m.scene.mesh_count;
-    }
-    return null;
+    const range = model_manager.cardinal_model_manager_get_combined_range(&state.runtime.model_manager, model_id) orelse return null;
+    return .{ .start = range.mesh_first, .count = range.mesh_count };
 }
 
 fn build_flat_terrain_scene(grid_resolution: u32, world_size: f32, thickness: f32) ?scene.CardinalScene {
@@ -947,8 +927,8 @@ fn stitch_pair_bottom_height(state: *EditorState, a_ent: engine.ecs_entity.Entit
 
     const terr_a = state.runtime.registry.get(components.Terrain, a_ent) orelse return;
     const terr_b = state.runtime.registry.get(components.Terrain, b_ent) orelse return;
-    const tr_a = state.runtime.registry.get(components.Transform, a_ent) orelse return;
-    const tr_b = state.runtime.registry.get(components.Transform, b_ent) orelse return;
+    const tr_a = state.runtime.registry.get_const(components.Transform, a_ent) orelse return;
+    const tr_b = state.runtime.registry.get_const(components.Transform, b_ent) orelse return;
     const td_a = state.runtime.terrain_data_by_entity.getPtr(a_ent.id) orelse return;
     const td_b = state.runtime.terrain_data_by_entity.getPtr(b_ent.id) orelse return;
 
@@ -1058,8 +1038,8 @@ fn stitch_pair(state: *EditorState, a_ent: engine.ecs_entity.Entity, b_ent: engi
 
     const terr_a = state.runtime.registry.get(components.Terrain, a_ent) orelse return;
     const terr_b = state.runtime.registry.get(components.Terrain, b_ent) orelse return;
-    const tr_a = state.runtime.registry.get(components.Transform, a_ent) orelse return;
-    const tr_b = state.runtime.registry.get(components.Transform, b_ent) orelse return;
+    const tr_a = state.runtime.registry.get_const(components.Transform, a_ent) orelse return;
+    const tr_b = state.runtime.registry.get_const(components.Transform, b_ent) orelse return;
     const td_a = state.runtime.terrain_data_by_entity.getPtr(a_ent.id) orelse return;
     const td_b = state.runtime.terrain_data_by_entity.getPtr(b_ent.id) orelse return;
 
@@ -1318,7 +1298,7 @@ fn stitch_seams_for_active_stroke(state: *EditorState) void {
         const ent = engine.ecs_entity.Entity{ .id = cap.entity_id };
         if (!state.runtime.registry.entity_manager.is_alive(ent)) continue;
         const terr = state.runtime.registry.get(components.Terrain, ent) orelse continue;
-        const tr = state.runtime.registry.get(components.Transform, ent) orelse continue;
+        const tr = state.runtime.registry.get_const(components.Transform, ent) orelse continue;
         const td = state.runtime.terrain_data_by_entity.getPtr(cap.entity_id) orelse continue;
         if (td.dims < 2) continue;
         const vps: u32 = td.dims;
@@ -2669,29 +2649,29 @@ pub fn draw_terrain_panel(state: *EditorState) void {
                 var best_t: f32 = std.math.floatMax(f32);
                 var best_hit: ?math.Vec3 = null;
 
-                const selected_hier = state.runtime.registry.get(components.Hierarchy, selected);
+                const selected_hier = state.runtime.registry.get_const(components.Hierarchy, selected);
                 const selected_parent = if (selected_hier) |h| h.parent else null;
 
                 var bview = state.runtime.registry.view(components.VolumetricTerrainBrick);
-                var bit = bview.iterator();
+                var bit = bview.const_iterator();
                 while (bit.next()) |bentry| {
                     const brick = bentry.component;
                     const parent_ent = engine.ecs_entity.Entity{ .id = brick.parent_id };
                     if (!state.runtime.registry.entity_manager.is_alive(parent_ent)) continue;
-                    const other = state.runtime.registry.get(components.VolumetricTerrain, parent_ent) orelse continue;
+                    const other = state.runtime.registry.get_const(components.VolumetricTerrain, parent_ent) orelse continue;
                     if (other.resolution != vt.resolution) continue;
                     if (@abs(other.size.x - vt.size.x) > 0.001) continue;
                     if (@abs(other.size.y - vt.size.y) > 0.001) continue;
                     if (@abs(other.size.z - vt.size.z) > 0.001) continue;
 
                     if (selected_parent) |p| {
-                        const other_hier = state.runtime.registry.get(components.Hierarchy, parent_ent) orelse continue;
+                        const other_hier = state.runtime.registry.get_const(components.Hierarchy, parent_ent) orelse continue;
                         if (other_hier.parent == null or other_hier.parent.?.id != p.id) continue;
                     } else {
                         if (parent_ent.id != selected.id) continue;
                     }
 
-                    const mr = state.runtime.registry.get(components.MeshRenderer, bentry.entity) orelse continue;
+                    const mr = state.runtime.registry.get_const(components.MeshRenderer, bentry.entity) orelse continue;
                     if (!mr.visible) continue;
                     if (mr.mesh.index >= state.runtime.combined_scene.mesh_count) continue;
                     if (selection_raycast.raycast_combined_mesh_point_allow_invisible(state, mr.mesh.index, ray)) |hit| {
@@ -2741,32 +2721,9 @@ pub fn draw_terrain_panel(state: *EditorState) void {
                 brush_record_stamp(state, preview_hit);
                 volumetric_stroke_begin(state.ui.terrain_tool, state.ui.terrain_sculpt_mode);
 
-                const selected_hier = state.runtime.registry.get(components.Hierarchy, selected);
-                const selected_parent = if (selected_hier) |h| h.parent else null;
-                var vview = state.runtime.registry.view(components.VolumetricTerrain);
-                var vit = vview.iterator();
-                while (vit.next()) |entry| {
-                    const ent = entry.entity;
-                    const other = entry.component;
-                    if (other.resolution != vt.resolution) continue;
-                    if (@abs(other.size.x - vt.size.x) > 0.001) continue;
-                    if (@abs(other.size.y - vt.size.y) > 0.001) continue;
-                    if (@abs(other.size.z - vt.size.z) > 0.001) continue;
-
-                    if (selected_parent) |p| {
-                        const other_hier = state.runtime.registry.get(components.Hierarchy, ent) orelse continue;
-                        if (other_hier.parent == null or other_hier.parent.?.id != p.id) continue;
-                    } else {
-                        if (ent.id != selected.id) continue;
-                    }
-
-                    const tr = state.runtime.registry.get(components.Transform, ent) orelse continue;
-                    const half = other.size.mul(0.5);
-                    const aabb_min = tr.position.sub(half);
-                    const aabb_max = tr.position.add(half);
-                    if (!sphere_intersects_aabb(preview_hit, state.ui.terrain_brush_radius, aabb_min, aabb_max)) continue;
-                    volumetric_stroke_capture_before(state, ent.id);
-                }
+                var group: std.ArrayListUnmanaged(engine.ecs_entity.Entity) = .{};
+                volumetric_terrain.collect_brush_group(state, selected, preview_hit, @max(0.001, state.ui.terrain_brush_radius), state.runtime.arena_allocator, &group);
+                for (group.items) |ent| volumetric_stroke_capture_before(state, ent.id);
 
                 volumetric_terrain.apply_sculpt_group(state, selected.id, preview_hit, state.ui.terrain_brush_radius, state.ui.terrain_brush_strength, state.ui.terrain_sculpt_mode);
                 state.ui.terrain_brush_last_mouse_down = true;
@@ -2780,32 +2737,9 @@ pub fn draw_terrain_panel(state: *EditorState) void {
                 brush_record_stamp(state, preview_hit);
                 volumetric_stroke_begin(state.ui.terrain_tool, state.ui.terrain_paint_layer);
 
-                const selected_hier = state.runtime.registry.get(components.Hierarchy, selected);
-                const selected_parent = if (selected_hier) |h| h.parent else null;
-                var vview = state.runtime.registry.view(components.VolumetricTerrain);
-                var vit = vview.iterator();
-                while (vit.next()) |entry| {
-                    const ent = entry.entity;
-                    const other = entry.component;
-                    if (other.resolution != vt.resolution) continue;
-                    if (@abs(other.size.x - vt.size.x) > 0.001) continue;
-                    if (@abs(other.size.y - vt.size.y) > 0.001) continue;
-                    if (@abs(other.size.z - vt.size.z) > 0.001) continue;
-
-                    if (selected_parent) |p| {
-                        const other_hier = state.runtime.registry.get(components.Hierarchy, ent) orelse continue;
-                        if (other_hier.parent == null or other_hier.parent.?.id != p.id) continue;
-                    } else {
-                        if (ent.id != selected.id) continue;
-                    }
-
-                    const tr = state.runtime.registry.get(components.Transform, ent) orelse continue;
-                    const half = other.size.mul(0.5);
-                    const aabb_min = tr.position.sub(half);
-                    const aabb_max = tr.position.add(half);
-                    if (!sphere_intersects_aabb(preview_hit, state.ui.terrain_brush_radius, aabb_min, aabb_max)) continue;
-                    volumetric_stroke_capture_before(state, ent.id);
-                }
+                var group: std.ArrayListUnmanaged(engine.ecs_entity.Entity) = .{};
+                volumetric_terrain.collect_brush_group(state, selected, preview_hit, @max(0.001, state.ui.terrain_brush_radius), state.runtime.arena_allocator, &group);
+                for (group.items) |ent| volumetric_stroke_capture_before(state, ent.id);
 
                 volumetric_terrain.apply_paint_group(state, selected.id, preview_hit, state.ui.terrain_brush_radius, std.math.clamp(state.ui.terrain_brush_strength, 0.0, 1.0), @intCast(state.ui.terrain_paint_layer), paint_erase);
                 state.ui.terrain_brush_last_mouse_down = true;
@@ -2826,11 +2760,11 @@ pub fn draw_terrain_panel(state: *EditorState) void {
         }
     }
 
-    if (state.runtime.registry.get(components.Transform, selected)) |tr| {
+    if (state.runtime.registry.get_const(components.Transform, selected)) |tr| {
         c.imgui_bridge_separator();
         c.imgui_bridge_text_wrapped("Extend terrain by adding adjacent chunks.");
 
-        const hier = state.runtime.registry.get(components.Hierarchy, selected);
+        const hier = state.runtime.registry.get_const(components.Hierarchy, selected);
         const parent = if (hier) |h| if (h.parent) |p| p else null else null;
 
         const res: u32 = terr_ptr.?.resolution;
@@ -3163,7 +3097,12 @@ pub fn draw_terrain_panel(state: *EditorState) void {
                     }
                 }
                 state.ui.terrain_brush_last_mouse_down = true;
-                state.runtime.picking_cache_dirty = true;
+                if (state.ui.terrain_tool == 0) {
+                    refit_picking_under_brush(state, terrain_group.items, hit);
+                } else if (state.ui.terrain_tool == 2) {
+                    // Carving rewrites index buffers, which a refit cannot follow.
+                    state.runtime.picking_cache_dirty = true;
+                }
             }
         }
     } else if (state.ui.terrain_brush_last_mouse_down) {
@@ -3171,11 +3110,38 @@ pub fn draw_terrain_panel(state: *EditorState) void {
         state.ui.terrain_brush_stamp_valid = false;
         state.runtime.pending_scene = state.runtime.combined_scene;
         state.runtime.scene_upload_pending = true;
-        state.runtime.picking_cache_dirty = true;
         state.ui.terrain_brush_last_mouse_down = false;
     }
 }
 
+/// Refits picking for the terrain meshes a sculpt stamp at `center` may have moved: the brush
+/// footprint plus one grid cell for edge stitching, at any height.
+fn refit_picking_under_brush(state: *EditorState, terrain_group: []const engine.ecs_entity.Entity, center: math.Vec3) void {
+    const radius = state.ui.terrain_brush_radius;
+    for (terrain_group) |e| {
+        const terr = state.runtime.registry.get_const(components.Terrain, e) orelse continue;
+        const tr = state.runtime.registry.get_const(components.Transform, e) orelse continue;
+        const td = state.runtime.terrain_data_by_entity.getPtr(e.id) orelse continue;
+        if (td.dims < 2) continue;
+
+        const grid: f32 = @floatFromInt(td.dims - 1);
+        const pad_x = radius + terr.size.x / grid;
+        const pad_z = radius + terr.size.y / grid;
+        const local_x = center.x - tr.position.x;
+        const local_z = center.z - tr.position.z;
+        const region = math.AABB{
+            .min = math.Vec3{ .x = local_x - pad_x, .y = -std.math.floatMax(f32), .z = local_z - pad_z },
+            .max = math.Vec3{ .x = local_x + pad_x, .y = std.math.floatMax(f32), .z = local_z + pad_z },
+        };
+
+        selection_raycast.refit_picking_region(state, terr.mesh_index, region);
+        if (terr.thickness > 0.01) {
+            selection_raycast.refit_picking_region(state, terr.mesh_index + 1, region);
+            selection_raycast.refit_picking_region(state, terr.mesh_index + 2, region);
+        }
+    }
+}
+
 /// Uploads any accumulated dirty terrain rectangles to the renderer.
 pub fn flush_terrain_pending_uploads(state: *EditorState) void {
     if (state.runtime.terrain_dirty_rects.count() == 0) return;
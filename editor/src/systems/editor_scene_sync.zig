@@ -2,18 +2,65 @@
 //!
 //! Bridges live ECS state into renderer-facing runtime structures (combined scene), and maintains
 //! small caches used during per-frame synchronization.
+//!
+//! The per-frame syncs read only what changed since their last run (registry change ticks) and
+//! fall back to a full pass when the combined scene was replaced, a `MeshRenderer` was removed or
+//! the registry was re-initialized.
 const std = @import("std");
 const engine = @import("cardinal_engine");
 const math = engine.math;
 const renderer = engine.vulkan_renderer;
 const scene = engine.scene;
 const animation = engine.animation;
+const components = engine.ecs_components;
+const ChangeCursor = engine.ecs_registry.ChangeCursor;
 const EditorState = @import("../editor_state.zig").EditorState;
 
+/// Combined-scene mesh array a sync last wrote into; a different one needs a full pass.
+const SyncTarget = struct {
+    meshes: ?[*]scene.CardinalMesh = null,
+    mesh_count: u32 = 0,
+
+    fn matches(self: SyncTarget, state: *const EditorState) bool {
+        return self.meshes == state.runtime.combined_scene.meshes and self.mesh_count == state.runtime.combined_scene.mesh_count;
+    }
+
+    fn of(state: *const EditorState) SyncTarget {
+        return .{ .meshes = state.runtime.combined_scene.meshes, .mesh_count = state.runtime.combined_scene.mesh_count };
+    }
+};
+
+var visibility_cursor: ChangeCursor = .{};
+var visibility_target: SyncTarget = .{};
+/// Mesh index each renderer last made visible or hidden, so a renderer switched to another mesh
+/// can hide the old one.
+var visibility_mesh_by_entity: std.AutoHashMapUnmanaged(u64, u32) = .{};
+
+var transforms_cursor: ChangeCursor = .{};
+var transforms_target: SyncTarget = .{};
+var transforms_override_count: u32 = 0;
+
+var index_maps_cursor: ChangeCursor = .{};
+
+fn sync_allocator() std.mem.Allocator {
+    return engine.memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
+}
+
+/// Frees the sync bookkeeping; the next syncs do full passes.
+pub fn reset_scene_sync() void {
+    visibility_mesh_by_entity.deinit(sync_allocator());
+    visibility_mesh_by_entity = .{};
+    visibility_cursor = .{};
+    visibility_target = .{};
+    transforms_cursor = .{};
+    transforms_target = .{};
+    index_maps_cursor = .{};
+}
+
 /// Syncs the active skybox asset from ECS into runtime state.
 pub fn sync_skybox_from_ecs(state: *EditorState, allocator: std.mem.Allocator) void {
     var view = state.runtime.registry.view(engine.ecs_components.Skybox);
-    var it = view.iterator();
+    var it = view.const_iterator();
     const entry = it.next() orelse return;
     const sky = entry.component;
     const path = sky.slice();
@@ -37,14 +84,14 @@ fn compute_entity_world_matrix_cached(state: *EditorState, allocator: std.mem.Al
     if (depth > 2048) return math.Mat4.identity();
 
     var parent_world = math.Mat4.identity();
-    if (state.runtime.registry.get(engine.ecs_components.Hierarchy, entity)) |h| {
+    if (state.runtime.registry.get_const(engine.ecs_components.Hierarchy, entity)) |h| {
         if (h.parent) |p| {
             parent_world = compute_entity_world_matrix_cached(state, allocator, cache, p, depth + 1);
         }
     }
 
     var world = parent_world;
-    if (state.runtime.registry.get(engine.ecs_components.Transform, entity)) |t| {
+    if (state.runtime.registry.get_const(engine.ecs_components.Transform, entity)) |t| {
         const local = math.Mat4.fromTRS(t.position, t.rotation, t.scale);
         world = parent_world.mul(local);
     }
@@ -83,22 +130,14 @@ fn model_node_range_for_mesh_index(state: *EditorState, mesh_index: u32) ?struct
     if (state.runtime.model_manager.models == null) return null;
     const models = state.runtime.model_manager.models.?;
 
-    var mesh_offset: u32 = 0;
-    var node_offset: u32 = 0;
     var i: u32 = 0;
     while (i < state.runtime.model_manager.model_count) : (i += 1) {
-        const model = &models[i];
-        if (!model.visible or model.is_loading) continue;
-
-        const mesh_count = model.scene.mesh_count;
-        const node_count = model.scene.all_node_count;
+        const range = &models[i].combined;
+        if (!range.resident) continue;
 
-        if (mesh_index >= mesh_offset and mesh_index < mesh_offset + mesh_count) {
-            return .{ .start = node_offset, .count = node_count };
+        if (mesh_index >= range.mesh_first and mesh_index < range.mesh_first + range.mesh_count) {
+            return .{ .start = range.node_first, .count = range.node_count };
         }
-
-        mesh_offset += mesh_count;
-        node_offset += node_count;
     }
 
     return null;
@@ -159,16 +198,36 @@ fn apply_mesh_world_override_to_scene_nodes(state: *EditorState, mesh_index: u32
 }
 
 /// Pushes ECS-driven transforms into the combined scene for renderer consumption.
+///
+/// Skipped while no `Transform`, `Hierarchy` or `MeshRenderer` changed, the override set and mesh
+/// array are the same and no animation rewrites the scene nodes underneath the overrides.
 pub fn sync_mesh_transforms_from_ecs(state: *EditorState, allocator: std.mem.Allocator, world_matrix_cache: *std.AutoHashMapUnmanaged(u64, math.Mat4)) void {
     if (!state.runtime.scene_loaded) return;
     if (state.runtime.scene_upload_pending) return;
     if (state.runtime.combined_scene.meshes == null or state.runtime.combined_scene.mesh_count == 0) return;
     const meshes = state.runtime.combined_scene.meshes.?;
+    const registry = state.runtime.registry;
+
+    const since = transforms_cursor.begin(registry);
+    const override_count = state.runtime.transform_overrides.count();
+    const unchanged = since != 0 and
+        transforms_target.matches(state) and
+        transforms_override_count == override_count and
+        state.runtime.combined_scene.animation_system == null and
+        !registry.any_changed(components.Transform, since) and
+        !registry.any_changed(components.Hierarchy, since) and
+        !registry.any_removed(components.Hierarchy, since) and
+        !registry.any_changed(components.MeshRenderer, since) and
+        !registry.any_removed(components.MeshRenderer, since);
+    transforms_cursor.end(registry);
+    transforms_target = SyncTarget.of(state);
+    transforms_override_count = override_count;
+    if (unchanged) return;
 
     world_matrix_cache.clearRetainingCapacity();
 
     var view = state.runtime.registry.view(engine.ecs_components.MeshRenderer);
-    var it = view.iterator();
+    var it = view.const_iterator();
     while (it.next()) |entry| {
         if (state.runtime.transform_overrides.get(entry.entity.id) == null) continue;
         const mr = entry.component;
@@ -183,40 +242,68 @@ pub fn sync_mesh_transforms_from_ecs(state: *EditorState, allocator: std.mem.All
 }
 
 /// Syncs per-mesh visibility flags from ECS into the combined scene.
+///
+/// Only renderers added or changed since the last call are visited; a full pass clears every
+/// flag first.
 pub fn sync_mesh_visibility_from_ecs(state: *EditorState) void {
     if (!state.runtime.scene_loaded) return;
     if (state.runtime.scene_upload_pending) return;
     if (state.runtime.combined_scene.meshes == null or state.runtime.combined_scene.mesh_count == 0) return;
     const meshes = state.runtime.combined_scene.meshes.?;
+    const mesh_count = state.runtime.combined_scene.mesh_count;
+    const registry = state.runtime.registry;
+    const allocator = sync_allocator();
 
-    var i: u32 = 0;
-    while (i < state.runtime.combined_scene.mesh_count) : (i += 1) {
-        meshes[i].visible = false;
+    var since = visibility_cursor.begin(registry);
+    if (!visibility_target.matches(state) or registry.any_removed(components.MeshRenderer, since)) since = 0;
+
+    if (since == 0) {
+        var i: u32 = 0;
+        while (i < mesh_count) : (i += 1) {
+            meshes[i].visible = false;
+        }
+        visibility_mesh_by_entity.clearRetainingCapacity();
     }
 
-    var view = state.runtime.registry.view(engine.ecs_components.MeshRenderer);
-    var it = view.iterator();
+    var it = registry.view_changed(components.MeshRenderer, since).iterator();
     while (it.next()) |entry| {
         const mr = entry.component;
         const mesh_index = mr.mesh.index;
-        if (mesh_index >= state.runtime.combined_scene.mesh_count) continue;
+        if (visibility_mesh_by_entity.fetchPut(allocator, entry.entity.id, mesh_index) catch null) |previous| {
+            if (previous.value != mesh_index and previous.value < mesh_count) meshes[previous.value].visible = false;
+        }
+        if (mesh_index >= mesh_count) continue;
         meshes[mesh_index].visible = mr.visible;
     }
+
+    visibility_cursor.end(registry);
+    visibility_target = SyncTarget.of(state);
 }
 
-/// Rebuilds mesh-index -> entity maps from ECS `MeshRenderer` components.
+/// Rebuilds mesh-index -> entity maps from ECS `MeshRenderer` components. Skipped while no
+/// renderer or brick was added, changed or removed.
 pub fn sync_mesh_index_maps_from_ecs(state: *EditorState, allocator: std.mem.Allocator) void {
     if (!state.runtime.scene_loaded) return;
+    const registry = state.runtime.registry;
+
+    const since = index_maps_cursor.begin(registry);
+    const unchanged = since != 0 and
+        !registry.any_changed(components.MeshRenderer, since) and
+        !registry.any_removed(components.MeshRenderer, since) and
+        !registry.any_changed(components.VolumetricTerrainBrick, since) and
+        !registry.any_removed(components.VolumetricTerrainBrick, since);
+    index_maps_cursor.end(registry);
+    if (unchanged) return;
 
     state.runtime.mesh_entity_by_mesh_index.clearRetainingCapacity();
     state.runtime.mesh_owner_by_mesh_index.clearRetainingCapacity();
 
     var view = state.runtime.registry.view(engine.ecs_components.MeshRenderer);
-    var it = view.iterator();
+    var it = view.const_iterator();
     while (it.next()) |entry| {
         const mr = entry.component;
         var owner_id = entry.entity.id;
-        if (state.runtime.registry.get(engine.ecs_components.VolumetricTerrainBrick, entry.entity)) |b| {
+        if (state.runtime.registry.get_const(engine.ecs_components.VolumetricTerrainBrick, entry.entity)) |b| {
             if (b.parent_id != 0) owner_id = b.parent_id;
         }
         state.runtime.mesh_entity_by_mesh_index.put(allocator, mr.mesh.index, entry.entity.id) catch {};
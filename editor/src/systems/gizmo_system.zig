@@ -53,14 +53,14 @@ fn compute_entity_world_matrix(state: *EditorState, entity: engine.ecs_entity.En
     if (depth > 2048) return math.Mat4.identity();
 
     var parent_world = math.Mat4.identity();
-    if (state.runtime.registry.get(components.Hierarchy, entity)) |h| {
+    if (state.runtime.registry.get_const(components.Hierarchy, entity)) |h| {
         if (h.parent) |p| {
             parent_world = compute_entity_world_matrix(state, p, depth + 1);
         }
     }
 
     var local = math.Mat4.identity();
-    if (state.runtime.registry.get(components.Transform, entity)) |t| {
+    if (state.runtime.registry.get_const(components.Transform, entity)) |t| {
         local = math.Mat4.fromTRS(t.position, t.rotation, t.scale);
     }
 
@@ -68,7 +68,7 @@ fn compute_entity_world_matrix(state: *EditorState, entity: engine.ecs_entity.En
 }
 
 fn get_parent_world_and_inv(state: *EditorState, entity: engine.ecs_entity.Entity) struct { world: math.Mat4, inv: ?math.Mat4 } {
-    if (state.runtime.registry.get(components.Hierarchy, entity)) |h| {
+    if (state.runtime.registry.get_const(components.Hierarchy, entity)) |h| {
         if (h.parent) |p| {
             const world = compute_entity_world_matrix(state, p, 0);
             return .{ .world = world, .inv = world.invert() };
@@ -385,6 +385,7 @@ pub fn draw_entity_gizmo(state: *EditorState, t: *components.Transform) void {
                 t.rotation = decomposed.r;
                 t.scale = decomposed.s;
                 t.dirty = true;
+                state.runtime.registry.mark_changed(components.Transform, state.ui.selected_entity);
                 state.runtime.mark_transform_override_tree(state.ui.selected_entity);
             } else {
                 if (selection_raycast.get_ray_from_mouse(state)) |ray| {
@@ -419,6 +420,7 @@ pub fn draw_entity_gizmo(state: *EditorState, t: *components.Transform) void {
                             t.rotation = decomposed.r;
                             t.scale = decomposed.s;
                             t.dirty = true;
+                            state.runtime.registry.mark_changed(components.Transform, state.ui.selected_entity);
                             state.runtime.mark_transform_override_tree(state.ui.selected_entity);
                         } else if (selection_state.gizmo_mode == .Scale) {
                             const scale_delta = 1.0 + (dt_world / scale_factor);
@@ -441,6 +443,7 @@ pub fn draw_entity_gizmo(state: *EditorState, t: *components.Transform) void {
                             if (@abs(sc.z) < 0.001) sc.z = 0.001;
                             t.scale = sc;
                             t.dirty = true;
+                            state.runtime.registry.mark_changed(components.Transform, state.ui.selected_entity);
                             state.runtime.mark_transform_override_tree(state.ui.selected_entity);
                         }
                     }
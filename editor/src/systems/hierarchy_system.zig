@@ -8,7 +8,7 @@ const components = engine.ecs_components;
 const EditorState = @import("../editor_state.zig").EditorState;
 
 fn ensure_hierarchy(state: *EditorState, entity: engine.ecs_entity.Entity) components.Hierarchy {
-    if (state.runtime.registry.get(components.Hierarchy, entity)) |h| return h.*;
+    if (state.runtime.registry.get_const(components.Hierarchy, entity)) |h| return h.*;
     state.runtime.registry.add(entity, components.Hierarchy{}) catch {};
     return components.Hierarchy{};
 }
@@ -20,7 +20,7 @@ fn is_descendant_of(state: *EditorState, maybe_descendant: engine.ecs_entity.Ent
         if (guard > 2048) break;
         guard += 1;
         if (e.id == ancestor.id) return true;
-        const h = state.runtime.registry.get(components.Hierarchy, e) orelse break;
+        const h = state.runtime.registry.get_const(components.Hierarchy, e) orelse break;
         current = h.parent;
     }
     return false;
@@ -37,7 +37,7 @@ fn repair_parent_links(state: *EditorState, parent: engine.ecs_entity.Entity) vo
     defer child_set.deinit(alloc);
 
     var view = state.runtime.registry.view(components.Hierarchy);
-    var it = view.iterator();
+    var it = view.const_iterator();
     while (it.next()) |entry| {
         const ent = entry.entity;
         const h = entry.component.*;
@@ -325,7 +325,7 @@ pub fn cleanup_deleted_entities(state: *EditorState, root: engine.ecs_entity.Ent
         if (deleted.contains(e.id)) continue;
         deleted.put(alloc, e.id, {}) catch {};
 
-        if (state.runtime.registry.get(components.Hierarchy, e)) |h_ptr| {
+        if (state.runtime.registry.get_const(components.Hierarchy, e)) |h_ptr| {
             const h = h_ptr.*;
             var child = h.first_child;
             var loop_guard: u32 = 0;
@@ -334,7 +334,7 @@ pub fn cleanup_deleted_entities(state: *EditorState, root: engine.ecs_entity.Ent
                 loop_guard += 1;
 
                 stack.append(alloc, c_ent) catch {};
-                child = if (state.runtime.registry.get(components.Hierarchy, c_ent)) |ch| ch.next_sibling else null;
+                child = if (state.runtime.registry.get_const(components.Hierarchy, c_ent)) |ch| ch.next_sibling else null;
             }
         }
     }
@@ -389,7 +389,7 @@ pub fn cleanup_deleted_entities(state: *EditorState, root: engine.ecs_entity.Ent
 pub fn destroy_entity_recursive(state: *EditorState, entity: engine.ecs_entity.Entity, depth: u32) void {
     if (depth > 2048) return;
 
-    if (state.runtime.registry.get(components.Hierarchy, entity)) |h_ptr| {
+    if (state.runtime.registry.get_const(components.Hierarchy, entity)) |h_ptr| {
         const h = h_ptr.*;
         var child = h.first_child;
         var loop_guard: u32 = 0;
@@ -397,7 +397,7 @@ pub fn destroy_entity_recursive(state: *EditorState, entity: engine.ecs_entity.E
             if (loop_guard > 100000) break;
             loop_guard += 1;
 
-            const next = if (state.runtime.registry.get(components.Hierarchy, c_ent)) |ch| ch.next_sibling else null;
+            const next = if (state.runtime.registry.get_const(components.Hierarchy, c_ent)) |ch| ch.next_sibling else null;
             destroy_entity_recursive(state, c_ent, depth + 1);
             child = next;
         }
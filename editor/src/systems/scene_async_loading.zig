@@ -110,13 +110,7 @@ pub fn instantiate_model(state: *EditorState, model_id: u32, parent_entity: engi
 
     state.runtime.model_root_by_id.put(map_alloc, model_id, root_entity.id) catch {};
 
-    var mesh_offset: u32 = 0;
-    var m_i: u32 = 0;
-    while (m_i < state.runtime.model_manager.model_count) : (m_i += 1) {
-        const m = &state.runtime.model_manager.models.?[m_i];
-        if (m.id == model_id) break;
-        if (m.visible and !m.is_loading) mesh_offset += m.scene.mesh_count;
-    }
+    const mesh_offset: u32 = if (model.combined.resident) model.combined.mesh_first else 0;
 
     var node_to_entity = state.runtime.arena_allocator.alloc(u64, scene.all_node_count) catch return;
     @memset(node_to_entity, std.math.maxInt(u64));
@@ -8,7 +8,11 @@ const std = @import("std");
 const engine = @import("cardinal_engine");
 const log = engine.log;
 const scene_serializer = engine.scene_serializer;
-const EditorState = @import("../editor_state.zig").EditorState;
+const terrain_sidecar = engine.terrain_sidecar;
+const editor_state = @import("../editor_state.zig");
+const EditorState = editor_state.EditorState;
+const TerrainData = editor_state.TerrainData;
+const VolumetricTerrainData = editor_state.VolumetricTerrainData;
 const math = engine.math;
 const components = engine.ecs_components;
 const node_factory = engine.ecs_node_factory;
@@ -18,6 +22,7 @@ const terrain_panel = @import("../panels/terrain_panel.zig");
 const terrain_volume = @import("terrain_volume.zig");
 const volumetric_terrain = @import("volumetric_terrain.zig");
 
+/// Header of the pre-sidecar `terrain_<id>.bin` files; still read when no `.cts` exists.
 const TerrainFileHeader = extern struct {
     magic: [4]u8,
     version: u32,
@@ -25,6 +30,7 @@ const TerrainFileHeader = extern struct {
     reserved: u32,
 };
 
+/// Header of the pre-sidecar `vterrain_<id>.bin` files.
 const VolumetricTerrainFileHeader = extern struct {
     magic: [4]u8,
     version: u32,
@@ -32,143 +38,6 @@ const VolumetricTerrainFileHeader = extern struct {
     reserved: u32,
 };
 
-fn rle_encode_u32(allocator: std.mem.Allocator, words: []const u32) ?[]u8 {
-    var out: std.ArrayListUnmanaged(u8) = .{};
-    errdefer out.deinit(allocator);
-
-    var i: usize = 0;
-    while (i < words.len) {
-        const v = words[i];
-        var run_len: usize = 1;
-        while (i + run_len < words.len and words[i + run_len] == v) : (run_len += 1) {}
-
-        if (run_len >= 4) {
-            out.append(allocator, 1) catch return null;
-            var buf4: [4]u8 = undefined;
-            std.mem.writeInt(u32, &buf4, @intCast(run_len), .little);
-            out.appendSlice(allocator, &buf4) catch return null;
-            std.mem.writeInt(u32, &buf4, v, .little);
-            out.appendSlice(allocator, &buf4) catch return null;
-            i += run_len;
-            continue;
-        }
-
-        const raw_start = i;
-        i += 1;
-        while (i < words.len) : (i += 1) {
-            const vv = words[i];
-            var next_run: usize = 1;
-            while (i + next_run < words.len and words[i + next_run] == vv) : (next_run += 1) {}
-            if (next_run >= 4) break;
-        }
-        const raw_count: usize = i - raw_start;
-        out.append(allocator, 0) catch return null;
-        var buf4: [4]u8 = undefined;
-        std.mem.writeInt(u32, &buf4, @intCast(raw_count), .little);
-        out.appendSlice(allocator, &buf4) catch return null;
-        const raw_bytes = std.mem.sliceAsBytes(words[raw_start .. raw_start + raw_count]);
-        out.appendSlice(allocator, raw_bytes) catch return null;
-    }
-
-    return out.toOwnedSlice(allocator) catch null;
-}
-
-fn rle_decode_u32(encoded: []const u8, out_words: []u32) bool {
-    var off: usize = 0;
-    var out_i: usize = 0;
-    while (off < encoded.len and out_i < out_words.len) {
-        const tag = encoded[off];
-        off += 1;
-        if (off + 4 > encoded.len) return false;
-        const count = std.mem.readInt(u32, encoded[off .. off + 4][0..4], .little);
-        off += 4;
-        if (count == 0) continue;
-        if (tag == 1) {
-            if (off + 4 > encoded.len) return false;
-            const v = std.mem.readInt(u32, encoded[off .. off + 4][0..4], .little);
-            off += 4;
-            if (out_i + count > out_words.len) return false;
-            @memset(out_words[out_i .. out_i + count], v);
-            out_i += count;
-        } else {
-            const bytes_need: usize = @as(usize, count) * 4;
-            if (off + bytes_need > encoded.len) return false;
-            if (out_i + count > out_words.len) return false;
-            @memcpy(std.mem.sliceAsBytes(out_words[out_i .. out_i + count]), encoded[off .. off + bytes_need]);
-            off += bytes_need;
-            out_i += count;
-        }
-    }
-    return out_i == out_words.len;
-}
-
-fn rle_encode_u8(allocator: std.mem.Allocator, bytes: []const u8) ?[]u8 {
-    var out: std.ArrayListUnmanaged(u8) = .{};
-    errdefer out.deinit(allocator);
-
-    var i: usize = 0;
-    while (i < bytes.len) {
-        const v = bytes[i];
-        var run_len: usize = 1;
-        while (i + run_len < bytes.len and bytes[i + run_len] == v) : (run_len += 1) {}
-
-        if (run_len >= 8) {
-            out.append(allocator, 1) catch return null;
-            var buf4: [4]u8 = undefined;
-            std.mem.writeInt(u32, &buf4, @intCast(run_len), .little);
-            out.appendSlice(allocator, &buf4) catch return null;
-            out.append(allocator, v) catch return null;
-            i += run_len;
-            continue;
-        }
-
-        const raw_start = i;
-        i += 1;
-        while (i < bytes.len) : (i += 1) {
-            const vv = bytes[i];
-            var next_run: usize = 1;
-            while (i + next_run < bytes.len and bytes[i + next_run] == vv) : (next_run += 1) {}
-            if (next_run >= 8) break;
-        }
-        const raw_count: usize = i - raw_start;
-        out.append(allocator, 0) catch return null;
-        var buf4: [4]u8 = undefined;
-        std.mem.writeInt(u32, &buf4, @intCast(raw_count), .little);
-        out.appendSlice(allocator, &buf4) catch return null;
-        out.appendSlice(allocator, bytes[raw_start .. raw_start + raw_count]) catch return null;
-    }
-
-    return out.toOwnedSlice(allocator) catch null;
-}
-
-fn rle_decode_u8(encoded: []const u8, out_bytes: []u8) bool {
-    var off: usize = 0;
-    var out_i: usize = 0;
-    while (off < encoded.len and out_i < out_bytes.len) {
-        const tag = encoded[off];
-        off += 1;
-        if (off + 4 > encoded.len) return false;
-        const count = std.mem.readInt(u32, encoded[off .. off + 4][0..4], .little);
-        off += 4;
-        if (count == 0) continue;
-        if (tag == 1) {
-            if (off >= encoded.len) return false;
-            const v = encoded[off];
-            off += 1;
-            if (out_i + count > out_bytes.len) return false;
-            @memset(out_bytes[out_i .. out_i + count], v);
-            out_i += count;
-        } else {
-            if (off + count > encoded.len) return false;
-            if (out_i + count > out_bytes.len) return false;
-            @memcpy(out_bytes[out_i .. out_i + count], encoded[off .. off + count]);
-            off += count;
-            out_i += count;
-        }
-    }
-    return out_i == out_bytes.len;
-}
-
 fn terrain_data_dir_path(allocator: std.mem.Allocator, scene_path: []const u8) ?[]u8 {
     const dir = std.fmt.allocPrint(allocator, "{s}.terrain", .{scene_path}) catch return null;
     return dir;
@@ -186,6 +55,48 @@ fn ensure_volumetric_terrain_data_id(vt: *components.VolumetricTerrain) void {
     if (vt.data_id == 0) vt.data_id = 1;
 }
 
+/// Samples per heightfield sidecar chunk along x and z.
+const heightfield_chunk_extent = [3]u32{ 64, 64, 1 };
+
+fn terrain_file_path(allocator: std.mem.Allocator, dir_path: []const u8, prefix: []const u8, data_id: u64, ext: []const u8) ?[]u8 {
+    const file_name = std.fmt.allocPrint(allocator, "{s}_{d}{s}", .{ prefix, data_id, ext }) catch return null;
+    defer allocator.free(file_name);
+    return std.fs.path.join(allocator, &[_][]const u8{ dir_path, file_name }) catch null;
+}
+
+/// Writes a chunked sidecar and removes the pre-sidecar `.bin` file for the same terrain, so a
+/// stale legacy file can never shadow newer data.
+fn write_terrain_sidecar(
+    allocator: std.mem.Allocator,
+    dir_path: []const u8,
+    prefix: []const u8,
+    data_id: u64,
+    extent: [3]u32,
+    channels: []const terrain_sidecar.ChannelSource,
+    options: terrain_sidecar.WriteOptions,
+) void {
+    const file_path = terrain_file_path(allocator, dir_path, prefix, data_id, terrain_sidecar.SIDECAR_EXTENSION) orelse return;
+    defer allocator.free(file_path);
+    _ = terrain_sidecar.write_file(allocator, file_path, extent, channels, options) catch |err| {
+        log.cardinal_log_error("Failed to write terrain data {s}: {}", .{ file_path, err });
+        return;
+    };
+
+    const legacy_path = terrain_file_path(allocator, dir_path, prefix, data_id, ".bin") orelse return;
+    defer allocator.free(legacy_path);
+    std.fs.cwd().deleteFile(legacy_path) catch {};
+}
+
+/// Opens the chunked sidecar for a terrain if one exists.
+fn open_terrain_sidecar(allocator: std.mem.Allocator, dir_path: []const u8, prefix: []const u8, data_id: u64) ?terrain_sidecar.SidecarFile {
+    const file_path = terrain_file_path(allocator, dir_path, prefix, data_id, terrain_sidecar.SIDECAR_EXTENSION) orelse return null;
+    defer allocator.free(file_path);
+    return terrain_sidecar.SidecarFile.open(allocator, file_path) catch |err| {
+        if (err != error.FileNotFound) log.cardinal_log_error("Failed to open terrain data {s}: {}", .{ file_path, err });
+        return null;
+    };
+}
+
 fn get_model_mesh_for_terrain(state: *EditorState, terr: *components.Terrain) ?*engine.scene.CardinalMesh {
     const model = engine.model_manager.cardinal_model_manager_get_model(&state.runtime.model_manager, terr.model_id) orelse return null;
     if (model.scene.meshes == null or model.scene.mesh_count == 0) return null;
@@ -229,6 +140,7 @@ fn save_terrain_runtime_data(state: *EditorState, allocator: std.mem.Allocator,
         const dims: u32 = td.dims;
         const pix: usize = @as(usize, dims) * @as(usize, dims);
         if (pix == 0) continue;
+        if (td.height.len != pix or td.bottom_height.len != pix or td.splat.len != pix * 4) continue;
 
         const alpha = allocator.alloc(u8, pix) catch continue;
         defer allocator.free(alpha);
@@ -243,25 +155,13 @@ fn save_terrain_runtime_data(state: *EditorState, allocator: std.mem.Allocator,
             }
         }
 
-        const file_name = std.fmt.allocPrint(allocator, "terrain_{d}.bin", .{terr.data_id}) catch continue;
-        defer allocator.free(file_name);
-        const file_path = std.fs.path.join(allocator, &[_][]const u8{ dir_path, file_name }) catch continue;
-        defer allocator.free(file_path);
-
-        const file = std.fs.cwd().createFile(file_path, .{}) catch continue;
-        defer file.close();
-
-        const hdr = TerrainFileHeader{
-            .magic = .{ 'T', 'R', 'N', '1' },
-            .version = 2,
-            .dims = dims,
-            .reserved = 0,
+        const channels = [_]terrain_sidecar.ChannelSource{
+            .{ .kind = .f32, .data = std.mem.sliceAsBytes(td.height) },
+            .{ .kind = .f32, .data = std.mem.sliceAsBytes(td.bottom_height) },
+            .{ .kind = .rgba8, .data = td.splat },
+            .{ .kind = .u8, .data = alpha },
         };
-        file.writeAll(std.mem.asBytes(&hdr)) catch continue;
-        file.writeAll(std.mem.sliceAsBytes(td.height)) catch continue;
-        file.writeAll(std.mem.sliceAsBytes(td.bottom_height)) catch continue;
-        file.writeAll(td.splat) catch continue;
-        file.writeAll(alpha) catch continue;
+        write_terrain_sidecar(allocator, dir_path, "terrain", terr.data_id, .{ dims, dims, 1 }, &channels, .{ .chunk_extent = heightfield_chunk_extent });
     }
 }
 
@@ -283,41 +183,63 @@ fn save_volumetric_terrain_runtime_data(state: *EditorState, allocator: std.mem.
         const vox: usize = @as(usize, td.dims) * @as(usize, td.dims) * @as(usize, td.dims);
         if (vox == 0) continue;
 
-        const file_name = std.fmt.allocPrint(allocator, "vterrain_{d}.bin", .{vt.data_id}) catch continue;
-        defer allocator.free(file_name);
-        const file_path = std.fs.path.join(allocator, &[_][]const u8{ dir_path, file_name }) catch continue;
-        defer allocator.free(file_path);
+        if (td.density.len != vox or td.splat.len != vox * 4) continue;
+        const channels = [_]terrain_sidecar.ChannelSource{
+            .{ .kind = .f32, .data = std.mem.sliceAsBytes(td.density) },
+            .{ .kind = .rgba8, .data = td.splat },
+        };
+        const chunk = volumetric_terrain.brick_cells_base;
+        write_terrain_sidecar(allocator, dir_path, "vterrain", vt.data_id, .{ td.dims, td.dims, td.dims }, &channels, .{ .chunk_extent = .{ chunk, chunk, chunk } });
+    }
+}
 
-        const file = std.fs.cwd().createFile(file_path, .{}) catch continue;
-        defer file.close();
+fn read_legacy_terrain_file(allocator: std.mem.Allocator, dir_path: []const u8, prefix: []const u8, data_id: u64) ?[]u8 {
+    const file_path = terrain_file_path(allocator, dir_path, prefix, data_id, ".bin") orelse return null;
+    defer allocator.free(file_path);
+    const file = std.fs.cwd().openFile(file_path, .{}) catch return null;
+    defer file.close();
+    return file.readToEndAlloc(allocator, std.math.maxInt(usize)) catch null;
+}
 
-        const hdr = VolumetricTerrainFileHeader{
-            .magic = .{ 'V', 'T', 'R', 'N' },
-            .version = 3,
-            .dims = td.dims,
-            .reserved = 0,
-        };
-        file.writeAll(std.mem.asBytes(&hdr)) catch continue;
-
-        const density_bytes = std.mem.sliceAsBytes(td.density);
-        const density_words = std.mem.bytesAsSlice(u32, density_bytes);
-        const density_enc = rle_encode_u32(allocator, density_words) orelse continue;
-        defer allocator.free(density_enc);
-        const splat_enc = rle_encode_u8(allocator, td.splat) orelse continue;
-        defer allocator.free(splat_enc);
-
-        var buf4: [4]u8 = undefined;
-        std.mem.writeInt(u32, &buf4, @intCast(density_bytes.len), .little);
-        file.writeAll(&buf4) catch continue;
-        std.mem.writeInt(u32, &buf4, @intCast(density_enc.len), .little);
-        file.writeAll(&buf4) catch continue;
-        std.mem.writeInt(u32, &buf4, @intCast(td.splat.len), .little);
-        file.writeAll(&buf4) catch continue;
-        std.mem.writeInt(u32, &buf4, @intCast(splat_enc.len), .little);
-        file.writeAll(&buf4) catch continue;
-        file.writeAll(density_enc) catch continue;
-        file.writeAll(splat_enc) catch continue;
+/// Applies a pre-sidecar `terrain_<id>.bin` (versions 1-3) to `td` and `alpha_out`.
+fn apply_legacy_terrain_file(content: []const u8, td: *TerrainData, thickness: f32, alpha_out: []u8) bool {
+    if (content.len < @sizeOf(TerrainFileHeader)) return false;
+    const hdr = std.mem.bytesToValue(TerrainFileHeader, content[0..@sizeOf(TerrainFileHeader)]);
+    if (!std.mem.eql(u8, hdr.magic[0..], "TRN1")) return false;
+    if (hdr.version != 1 and hdr.version != 2 and hdr.version != 3) return false;
+    if (hdr.dims < 2 or td.dims != hdr.dims) return false;
+
+    const pix: usize = @as(usize, hdr.dims) * @as(usize, hdr.dims);
+    const layer_count: usize = if (hdr.version == 2) @as(usize, 2) else @as(usize, 1);
+    const need = @sizeOf(TerrainFileHeader) + pix * @sizeOf(f32) * layer_count + pix * 4 + pix;
+    if (content.len < need) return false;
+
+    const off_h = @sizeOf(TerrainFileHeader);
+    const off_b = off_h + pix * @sizeOf(f32);
+    const has_bottom: usize = if (hdr.version == 2) @as(usize, 1) else @as(usize, 0);
+    const off_s = off_b + pix * @sizeOf(f32) * has_bottom;
+    const off_a = off_s + pix * 4;
+
+    const height_bytes = content[off_h..off_b];
+    const bottom_bytes = if (hdr.version == 2) content[off_b..off_s] else &[_]u8{};
+    const splat_bytes = content[off_s..off_a];
+    @memcpy(alpha_out, content[off_a .. off_a + pix]);
+
+    if (height_bytes.len == td.height.len * @sizeOf(f32)) {
+        @memcpy(std.mem.sliceAsBytes(td.height), height_bytes);
+    }
+    if (hdr.version == 2 and bottom_bytes.len == td.bottom_height.len * @sizeOf(f32)) {
+        @memcpy(std.mem.sliceAsBytes(td.bottom_height), bottom_bytes);
+    } else {
+        var i_pix: usize = 0;
+        while (i_pix < pix and i_pix < td.height.len and i_pix < td.bottom_height.len) : (i_pix += 1) {
+            td.bottom_height[i_pix] = td.height[i_pix] - thickness;
+        }
+    }
+    if (splat_bytes.len == td.splat.len) {
+        @memcpy(td.splat, splat_bytes);
     }
+    return true;
 }
 
 fn load_terrain_runtime_data(state: *EditorState, allocator: std.mem.Allocator, scene_path: []const u8) void {
@@ -331,54 +253,31 @@ fn load_terrain_runtime_data(state: *EditorState, allocator: std.mem.Allocator,
         const terr = entry.component;
         if (terr.data_id == 0) continue;
 
-        const file_name = std.fmt.allocPrint(allocator, "terrain_{d}.bin", .{terr.data_id}) catch continue;
-        defer allocator.free(file_name);
-        const file_path = std.fs.path.join(allocator, &[_][]const u8{ dir_path, file_name }) catch continue;
-        defer allocator.free(file_path);
-
-        const file = std.fs.cwd().openFile(file_path, .{}) catch continue;
-        defer file.close();
-
-        const content = file.readToEndAlloc(allocator, std.math.maxInt(usize)) catch continue;
-        defer allocator.free(content);
-        if (content.len < @sizeOf(TerrainFileHeader)) continue;
-        const hdr = std.mem.bytesToValue(TerrainFileHeader, content[0..@sizeOf(TerrainFileHeader)]);
-        if (!std.mem.eql(u8, hdr.magic[0..], "TRN1")) continue;
-        if (hdr.version != 1 and hdr.version != 2 and hdr.version != 3) continue;
-        if (hdr.dims < 2) continue;
+        var sidecar = open_terrain_sidecar(allocator, dir_path, "terrain", terr.data_id);
+        defer if (sidecar) |*f| f.close();
+        const legacy = if (sidecar == null) read_legacy_terrain_file(allocator, dir_path, "terrain", terr.data_id) else null;
+        defer if (legacy) |content| allocator.free(content);
+        if (sidecar == null and legacy == null) continue;
 
         const td = terrain_panel.ensure_terrain_data_for_entity(state, ent) orelse continue;
-        if (td.dims != hdr.dims) continue;
-
-        const pix: usize = @as(usize, hdr.dims) * @as(usize, hdr.dims);
-        const layer_count: usize = if (hdr.version == 2) @as(usize, 2) else @as(usize, 1);
-        const need = @sizeOf(TerrainFileHeader) + pix * @sizeOf(f32) * layer_count + pix * 4 + pix;
-        if (content.len < need) continue;
-
-        const off_h = @sizeOf(TerrainFileHeader);
-        const off_b = off_h + pix * @sizeOf(f32);
-        const has_bottom: usize = if (hdr.version == 2) @as(usize, 1) else @as(usize, 0);
-        const off_s = off_b + pix * @sizeOf(f32) * has_bottom;
-        const off_a = off_s + pix * 4;
-
-        const height_bytes = content[off_h..off_b];
-        const bottom_bytes = if (hdr.version == 2) content[off_b..off_s] else &[_]u8{};
-        const splat_bytes = content[off_s..off_a];
-        const alpha_bytes = content[off_a .. off_a + pix];
-
-        if (height_bytes.len == td.height.len * @sizeOf(f32)) {
-            @memcpy(std.mem.sliceAsBytes(td.height), height_bytes);
-        }
-        if (hdr.version == 2 and bottom_bytes.len == td.bottom_height.len * @sizeOf(f32)) {
-            @memcpy(std.mem.sliceAsBytes(td.bottom_height), bottom_bytes);
-        } else {
-            var i_pix: usize = 0;
-            while (i_pix < pix and i_pix < td.height.len and i_pix < td.bottom_height.len) : (i_pix += 1) {
-                td.bottom_height[i_pix] = td.height[i_pix] - terr.thickness;
-            }
-        }
-        if (splat_bytes.len == td.splat.len) {
-            @memcpy(td.splat, splat_bytes);
+        const pix: usize = @as(usize, td.dims) * @as(usize, td.dims);
+        const alpha_bytes = allocator.alloc(u8, pix) catch continue;
+        defer allocator.free(alpha_bytes);
+
+        if (sidecar) |*f| {
+            if (!std.mem.eql(u32, &f.header.extent, &[3]u32{ td.dims, td.dims, 1 })) continue;
+            const targets = [_]terrain_sidecar.ChannelTarget{
+                .{ .kind = .f32, .data = std.mem.sliceAsBytes(td.height) },
+                .{ .kind = .f32, .data = std.mem.sliceAsBytes(td.bottom_height) },
+                .{ .kind = .rgba8, .data = td.splat },
+                .{ .kind = .u8, .data = alpha_bytes },
+            };
+            _ = f.read_all(allocator, &targets) catch |err| {
+                log.cardinal_log_error("Failed to load terrain data {d}: {}", .{ terr.data_id, err });
+                continue;
+            };
+        } else if (!apply_legacy_terrain_file(legacy.?, td, terr.thickness, alpha_bytes)) {
+            continue;
         }
 
         const mesh = get_model_mesh_for_terrain(state, terr) orelse continue;
@@ -422,6 +321,54 @@ fn load_terrain_runtime_data(state: *EditorState, allocator: std.mem.Allocator,
     }
 }
 
+/// Applies a pre-sidecar `vterrain_<id>.bin` (versions 1-3) to `td`.
+fn apply_legacy_volumetric_terrain_file(content: []const u8, td: *VolumetricTerrainData) bool {
+    if (content.len < @sizeOf(VolumetricTerrainFileHeader)) return false;
+
+    const hdr = std.mem.bytesToValue(VolumetricTerrainFileHeader, content[0..@sizeOf(VolumetricTerrainFileHeader)]);
+    if (!std.mem.eql(u8, hdr.magic[0..], "VTRN")) return false;
+    if (hdr.version != 1 and hdr.version != 2 and hdr.version != 3) return false;
+    if (hdr.dims < 2 or td.dims != hdr.dims) return false;
+
+    const vox: usize = @as(usize, hdr.dims) * @as(usize, hdr.dims) * @as(usize, hdr.dims);
+    if (hdr.version == 3) {
+        const off = @sizeOf(VolumetricTerrainFileHeader);
+        if (content.len < off + 16) return false;
+        const density_un = std.mem.readInt(u32, content[off .. off + 4][0..4], .little);
+        const density_enc_len = std.mem.readInt(u32, content[off + 4 .. off + 8][0..4], .little);
+        const splat_un = std.mem.readInt(u32, content[off + 8 .. off + 12][0..4], .little);
+        const splat_enc_len = std.mem.readInt(u32, content[off + 12 .. off + 16][0..4], .little);
+        if (density_un != vox * @sizeOf(f32)) return false;
+        if (splat_un != vox * 4) return false;
+
+        const payload_off = off + 16;
+        const need = payload_off + @as(usize, density_enc_len) + @as(usize, splat_enc_len);
+        if (content.len < need) return false;
+        const density_enc = content[payload_off .. payload_off + @as(usize, density_enc_len)];
+        const splat_enc = content[payload_off + @as(usize, density_enc_len) .. need];
+
+        const out_words = std.mem.bytesAsSlice(u32, std.mem.sliceAsBytes(td.density));
+        if (!terrain_sidecar.rle_decode_u32(density_enc, out_words)) return false;
+        if (!terrain_sidecar.rle_decode_u8(splat_enc, td.splat)) return false;
+    } else {
+        const need = @sizeOf(VolumetricTerrainFileHeader) + vox * @sizeOf(f32) + if (hdr.version == 2) vox * 4 else 0;
+        if (content.len < need) return false;
+        const off = @sizeOf(VolumetricTerrainFileHeader);
+        const density_bytes = content[off .. off + vox * @sizeOf(f32)];
+        if (density_bytes.len == td.density.len * @sizeOf(f32)) {
+            @memcpy(std.mem.sliceAsBytes(td.density), density_bytes);
+        }
+        if (hdr.version == 2) {
+            const splat_off = off + vox * @sizeOf(f32);
+            const splat_bytes = content[splat_off .. splat_off + vox * 4];
+            if (splat_bytes.len == td.splat.len) {
+                @memcpy(td.splat, splat_bytes);
+            }
+        }
+    }
+    return true;
+}
+
 fn load_volumetric_terrain_runtime_data(state: *EditorState, allocator: std.mem.Allocator, scene_path: []const u8) void {
     const dir_path = terrain_data_dir_path(allocator, scene_path) orelse return;
     defer allocator.free(dir_path);
@@ -433,60 +380,26 @@ fn load_volumetric_terrain_runtime_data(state: *EditorState, allocator: std.mem.
         const vt = entry.component;
         if (vt.data_id == 0) continue;
 
-        const file_name = std.fmt.allocPrint(allocator, "vterrain_{d}.bin", .{vt.data_id}) catch continue;
-        defer allocator.free(file_name);
-        const file_path = std.fs.path.join(allocator, &[_][]const u8{ dir_path, file_name }) catch continue;
-        defer allocator.free(file_path);
-
-        const file = std.fs.cwd().openFile(file_path, .{}) catch continue;
-        defer file.close();
-
-        const content = file.readToEndAlloc(allocator, std.math.maxInt(usize)) catch continue;
-        defer allocator.free(content);
-        if (content.len < @sizeOf(VolumetricTerrainFileHeader)) continue;
-
-        const hdr = std.mem.bytesToValue(VolumetricTerrainFileHeader, content[0..@sizeOf(VolumetricTerrainFileHeader)]);
-        if (!std.mem.eql(u8, hdr.magic[0..], "VTRN")) continue;
-        if (hdr.version != 1 and hdr.version != 2) continue;
-        if (hdr.dims < 2) continue;
+        var sidecar = open_terrain_sidecar(allocator, dir_path, "vterrain", vt.data_id);
+        defer if (sidecar) |*f| f.close();
+        const legacy = if (sidecar == null) read_legacy_terrain_file(allocator, dir_path, "vterrain", vt.data_id) else null;
+        defer if (legacy) |content| allocator.free(content);
+        if (sidecar == null and legacy == null) continue;
 
         const td = volumetric_terrain.ensure_volumetric_terrain_data_for_entity(state, ent) orelse continue;
-        if (td.dims != hdr.dims) continue;
-        const vox: usize = @as(usize, hdr.dims) * @as(usize, hdr.dims) * @as(usize, hdr.dims);
-        if (hdr.version == 3) {
-            const off = @sizeOf(VolumetricTerrainFileHeader);
-            if (content.len < off + 16) continue;
-            const density_un = std.mem.readInt(u32, content[off .. off + 4][0..4], .little);
-            const density_enc_len = std.mem.readInt(u32, content[off + 4 .. off + 8][0..4], .little);
-            const splat_un = std.mem.readInt(u32, content[off + 8 .. off + 12][0..4], .little);
-            const splat_enc_len = std.mem.readInt(u32, content[off + 12 .. off + 16][0..4], .little);
-            if (density_un != vox * @sizeOf(f32)) continue;
-            if (splat_un != vox * 4) continue;
-
-            const payload_off = off + 16;
-            const need = payload_off + @as(usize, density_enc_len) + @as(usize, splat_enc_len);
-            if (content.len < need) continue;
-            const density_enc = content[payload_off .. payload_off + @as(usize, density_enc_len)];
-            const splat_enc = content[payload_off + @as(usize, density_enc_len) .. need];
-
-            const out_words = std.mem.bytesAsSlice(u32, std.mem.sliceAsBytes(td.density));
-            if (!rle_decode_u32(density_enc, out_words)) continue;
-            if (!rle_decode_u8(splat_enc, td.splat)) continue;
-        } else {
-            const need = @sizeOf(VolumetricTerrainFileHeader) + vox * @sizeOf(f32) + if (hdr.version == 2) vox * 4 else 0;
-            if (content.len < need) continue;
-            const off = @sizeOf(VolumetricTerrainFileHeader);
-            const density_bytes = content[off .. off + vox * @sizeOf(f32)];
-            if (density_bytes.len == td.density.len * @sizeOf(f32)) {
-                @memcpy(std.mem.sliceAsBytes(td.density), density_bytes);
-            }
-            if (hdr.version == 2) {
-                const splat_off = off + vox * @sizeOf(f32);
-                const splat_bytes = content[splat_off .. splat_off + vox * 4];
-                if (splat_bytes.len == td.splat.len) {
-                    @memcpy(td.splat, splat_bytes);
-                }
-            }
+        if (sidecar) |*f| {
+            if (!std.mem.eql(u32, &f.header.extent, &[3]u32{ td.dims, td.dims, td.dims })) continue;
+            // Chunks decode on the job system straight into the brick-addressed density grid.
+            const targets = [_]terrain_sidecar.ChannelTarget{
+                .{ .kind = .f32, .data = std.mem.sliceAsBytes(td.density) },
+                .{ .kind = .rgba8, .data = td.splat },
+            };
+            _ = f.read_all(allocator, &targets) catch |err| {
+                log.cardinal_log_error("Failed to load volumetric terrain data {d}: {}", .{ vt.data_id, err });
+                continue;
+            };
+        } else if (!apply_legacy_volumetric_terrain_file(legacy.?, td)) {
+            continue;
         }
         // volumetric_terrain.remesh_volumetric_terrain(state, ent.id);
     }
@@ -511,28 +424,18 @@ pub fn import_scene_graph(state: *EditorState) void {
     @memset(node_model_indices, 0xFFFFFFFF);
 
     if (state.runtime.model_manager.models) |models| {
-        var node_cursor: u32 = 0;
-        var mesh_cursor: u32 = 0;
         var m_i: u32 = 0;
         while (m_i < state.runtime.model_manager.model_count) : (m_i += 1) {
-            const model = &models[m_i];
-            if (!model.visible or model.is_loading) continue;
+            const range = &models[m_i].combined;
+            if (!range.resident) continue;
+            if (range.node_first + range.node_count > scene.all_node_count) continue;
 
             var n_i: u32 = 0;
-            while (n_i < model.scene.all_node_count and node_cursor + n_i < scene.all_node_count) : (n_i += 1) {
-                node_base_offsets[node_cursor + n_i] = node_cursor;
-                node_mesh_offsets[node_cursor + n_i] = mesh_cursor;
-                node_model_indices[node_cursor + n_i] = m_i;
+            while (n_i < range.node_count) : (n_i += 1) {
+                node_base_offsets[range.node_first + n_i] = range.node_first;
+                node_mesh_offsets[range.node_first + n_i] = range.mesh_first;
+                node_model_indices[range.node_first + n_i] = m_i;
             }
-
-            node_cursor += model.scene.all_node_count;
-            mesh_cursor += model.scene.mesh_count;
-        }
-
-        if (node_cursor != scene.all_node_count or mesh_cursor != scene.mesh_count) {
-            @memset(node_base_offsets, 0);
-            @memset(node_mesh_offsets, 0);
-            @memset(node_model_indices, 0xFFFFFFFF);
         }
     }
 
@@ -730,18 +633,8 @@ pub fn save_scene(state: *EditorState, allocator: std.mem.Allocator, path: []con
 }
 
 fn get_model_combined_mesh_range(state: *EditorState, model_id: u32) ?struct { start: u32, count: u32 } {
-    if (state.runtime.model_manager.models == null) return null;
-    const models = state.runtime.model_manager.models.?;
-
-    var offset: u32 = 0;
-    var i: u32 = 0;
-    while (i < state.runtime.model_manager.model_count) : (i += 1) {
-        const m = &models[i];
-        if (!m.visible or m.is_loading) continue;
-        if (m.id == model_id) return .{ .start = offset, .count = m.scene.mesh_count };
-        offset += m.scene.mesh_count;
-    }
-    return null;
+    const range = engine.model_manager.cardinal_model_manager_get_combined_range(&state.runtime.model_manager, model_id) orelse return null;
+    return .{ .start = range.mesh_first, .count = range.mesh_count };
 }
 
 fn remove_entity_subtree(state: *EditorState, root: engine.ecs_entity.Entity) void {
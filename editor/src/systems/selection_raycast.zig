@@ -7,6 +7,7 @@ const math = engine.math;
 const renderer = engine.vulkan_renderer;
 const scene = engine.scene;
 const components = engine.ecs_components;
+const pick_bvh = engine.pick_bvh;
 const EditorState = @import("../editor_state.zig").EditorState;
 const c = @import("../c.zig").c;
 
@@ -21,7 +22,7 @@ fn compute_entity_world_matrix_cached(
     if (depth > 2048) return math.Mat4.identity();
 
     var parent_world = math.Mat4.identity();
-    if (state.runtime.registry.get(components.Hierarchy, entity)) |h| {
+    if (state.runtime.registry.get_const(components.Hierarchy, entity)) |h| {
         if (h.parent) |p| {
             if (state.runtime.registry.entity_manager.is_alive(p)) {
                 parent_world = compute_entity_world_matrix_cached(state, allocator, cache, p, depth + 1);
@@ -29,7 +30,7 @@ fn compute_entity_world_matrix_cached(
         }
     }
 
-    const local = if (state.runtime.registry.get(components.Transform, entity)) |t|
+    const local = if (state.runtime.registry.get_const(components.Transform, entity)) |t|
         math.Mat4.fromTRS(t.position, t.rotation, t.scale)
     else
         math.Mat4.identity();
@@ -62,9 +63,10 @@ fn mesh_world_matrix(state: *EditorState, allocator: std.mem.Allocator, cache: *
 fn compute_selection_world_aabb(state: *EditorState, root: engine.ecs_entity.Entity) ?math.AABB {
     if (state.runtime.combined_scene.meshes == null or state.runtime.combined_scene.mesh_count == 0) return null;
 
-    const alloc = engine.memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
+    const scratch = engine.memory.scratch_begin() orelse return null;
+    defer scratch.end();
+    const alloc = scratch.allocator();
     var world_cache: std.AutoHashMapUnmanaged(u64, math.Mat4) = .{};
-    defer world_cache.deinit(alloc);
 
     var found_any = false;
     var out = math.AABB{ .min = math.Vec3.zero(), .max = math.Vec3.zero() };
@@ -79,7 +81,7 @@ fn compute_selection_world_aabb(state: *EditorState, root: engine.ecs_entity.Ent
         const e = stack.items[last];
         stack.items.len = last;
 
-        if (state.runtime.registry.get(components.MeshRenderer, e)) |mr| {
+        if (state.runtime.registry.get_const(components.MeshRenderer, e)) |mr| {
             const mesh_index = mr.mesh.index;
             if (mesh_index < state.runtime.combined_scene.mesh_count and state.runtime.combined_scene.meshes != null) {
                 const mesh = &state.runtime.combined_scene.meshes.?[mesh_index];
@@ -102,14 +104,14 @@ fn compute_selection_world_aabb(state: *EditorState, root: engine.ecs_entity.Ent
             }
         }
 
-        const h = state.runtime.registry.get(components.Hierarchy, e) orelse continue;
+        const h = state.runtime.registry.get_const(components.Hierarchy, e) orelse continue;
         var child = h.first_child;
         var guard: u32 = 0;
         while (child) |c_ent| {
             if (guard > 100000) break;
             guard += 1;
             stack.append(alloc, c_ent) catch break;
-            const ch = state.runtime.registry.get(components.Hierarchy, c_ent) orelse break;
+            const ch = state.runtime.registry.get_const(components.Hierarchy, c_ent) orelse break;
             child = ch.next_sibling;
         }
     }
@@ -236,9 +238,10 @@ fn draw_obb_xray(state: *EditorState, view_proj: math.Mat4, local: math.AABB, wo
 pub fn draw_selection_xray(state: *EditorState, root: engine.ecs_entity.Entity) void {
     if (state.runtime.combined_scene.meshes == null or state.runtime.combined_scene.mesh_count == 0) return;
 
-    const alloc = engine.memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
+    const scratch = engine.memory.scratch_begin() orelse return;
+    defer scratch.end();
+    const alloc = scratch.allocator();
     var world_cache: std.AutoHashMapUnmanaged(u64, math.Mat4) = .{};
-    defer world_cache.deinit(alloc);
 
     const view = math.Mat4.lookAt(state.runtime.camera.position, state.runtime.camera.target, state.runtime.camera.up);
     const proj = math.Mat4.perspective(math.toRadians(state.runtime.camera.fov), state.runtime.camera.aspect, state.runtime.camera.near_plane, state.runtime.camera.far_plane);
@@ -253,7 +256,7 @@ pub fn draw_selection_xray(state: *EditorState, root: engine.ecs_entity.Entity)
         const e = stack.items[last];
         stack.items.len = last;
 
-        if (state.runtime.registry.get(components.MeshRenderer, e)) |mr| {
+        if (state.runtime.registry.get_const(components.MeshRenderer, e)) |mr| {
             const mesh_index = mr.mesh.index;
             if (mesh_index < state.runtime.combined_scene.mesh_count and state.runtime.combined_scene.meshes != null) {
                 const mesh = &state.runtime.combined_scene.meshes.?[mesh_index];
@@ -270,14 +273,14 @@ pub fn draw_selection_xray(state: *EditorState, root: engine.ecs_entity.Entity)
             }
         }
 
-        const h = state.runtime.registry.get(components.Hierarchy, e) orelse continue;
+        const h = state.runtime.registry.get_const(components.Hierarchy, e) orelse continue;
         var child = h.first_child;
         var guard: u32 = 0;
         while (child) |c_ent| {
             if (guard > 100000) break;
             guard += 1;
             stack.append(alloc, c_ent) catch break;
-            const ch = state.runtime.registry.get(components.Hierarchy, c_ent) orelse break;
+            const ch = state.runtime.registry.get_const(components.Hierarchy, c_ent) orelse break;
             child = ch.next_sibling;
         }
     }
@@ -286,9 +289,10 @@ pub fn draw_selection_xray(state: *EditorState, root: engine.ecs_entity.Entity)
 fn draw_selection_xray_subtree(state: *EditorState, root: engine.ecs_entity.Entity, view_proj: math.Mat4, color: u32, thickness: f32) void {
     if (state.runtime.combined_scene.meshes == null or state.runtime.combined_scene.mesh_count == 0) return;
 
-    const alloc = engine.memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
+    const scratch = engine.memory.scratch_begin() orelse return;
+    defer scratch.end();
+    const alloc = scratch.allocator();
     var world_cache: std.AutoHashMapUnmanaged(u64, math.Mat4) = .{};
-    defer world_cache.deinit(alloc);
 
     var stack: std.ArrayListUnmanaged(engine.ecs_entity.Entity) = .{};
     defer stack.deinit(alloc);
@@ -299,7 +303,7 @@ fn draw_selection_xray_subtree(state: *EditorState, root: engine.ecs_entity.Enti
         const e = stack.items[last];
         stack.items.len = last;
 
-        if (state.runtime.registry.get(components.MeshRenderer, e)) |mr| {
+        if (state.runtime.registry.get_const(components.MeshRenderer, e)) |mr| {
             const mesh_index = mr.mesh.index;
             if (mesh_index < state.runtime.combined_scene.mesh_count and state.runtime.combined_scene.meshes != null) {
                 const mesh = &state.runtime.combined_scene.meshes.?[mesh_index];
@@ -309,14 +313,14 @@ fn draw_selection_xray_subtree(state: *EditorState, root: engine.ecs_entity.Enti
             }
         }
 
-        const h = state.runtime.registry.get(components.Hierarchy, e) orelse continue;
+        const h = state.runtime.registry.get_const(components.Hierarchy, e) orelse continue;
         var child = h.first_child;
         var guard: u32 = 0;
         while (child) |c_ent| {
             if (guard > 100000) break;
             guard += 1;
             stack.append(alloc, c_ent) catch break;
-            const ch = state.runtime.registry.get(components.Hierarchy, c_ent) orelse break;
+            const ch = state.runtime.registry.get_const(components.Hierarchy, c_ent) orelse break;
             child = ch.next_sibling;
         }
     }
@@ -355,40 +359,99 @@ pub fn draw_selection_xray_group(state: *EditorState, roots: []const engine.ecs_
     }
 }
 
-const BVHNode = struct {
-    aabb: math.AABB,
-    left: u32,
-    right: u32,
-    first: u32,
-    count: u32,
-};
+var pick_scene: pick_bvh.PickScene = .{};
+/// Instance transforms must be re-read before the next query.
+var pick_instances_dirty: bool = true;
+/// Registry changes already folded into the instance transforms.
+var pick_transform_cursor: engine.ecs_registry.ChangeCursor = .{};
 
-const MeshPickBvh = struct {
-    nodes: []BVHNode,
-    tri_offsets: []u32,
-    root: u32,
-    vertices_ptr: usize,
-    indices_ptr: usize,
-    vertex_count: u32,
-    index_count: u32,
-
-    fn deinit(self: *MeshPickBvh, allocator: std.mem.Allocator) void {
-        allocator.free(self.nodes);
-        allocator.free(self.tri_offsets);
-    }
-};
+fn pick_allocator() std.mem.Allocator {
+    return engine.memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
+}
 
-var pick_bvh_cache: std.AutoHashMapUnmanaged(u32, MeshPickBvh) = .{};
+fn scene_meshes(state: *EditorState) []const scene.CardinalMesh {
+    const meshes = state.runtime.combined_scene.meshes orelse return &.{};
+    return meshes[0..state.runtime.combined_scene.mesh_count];
+}
 
-/// Clears cached BVHs used for triangle-accurate mesh picking.
+/// Frees all picking acceleration data, waiting for background builds. Use when the combined
+/// scene is replaced.
 pub fn reset_picking_cache() void {
-    const allocator = engine.memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
-    var it = pick_bvh_cache.iterator();
-    while (it.next()) |entry| {
-        entry.value_ptr.deinit(allocator);
+    pick_scene.deinit(pick_allocator());
+    pick_instances_dirty = true;
+}
+
+/// Invalidates picking after an edit that did not say what changed. Mesh BVHs are refit rather
+/// than rebuilt; meshes whose buffers were replaced are rebuilt in the background.
+pub fn invalidate_picking_cache() void {
+    pick_scene.invalidate();
+    pick_instances_dirty = true;
+}
+
+/// Re-reads instance transforms before the next pick, for transforms that live outside the ECS.
+pub fn mark_picking_instances_dirty() void {
+    pick_instances_dirty = true;
+}
+
+/// Refits picking for mesh `mesh_index` after its vertices moved inside the mesh-local `region`,
+/// which must contain their old positions.
+pub fn refit_picking_region(state: *EditorState, mesh_index: u32, region: math.AABB) void {
+    const meshes = scene_meshes(state);
+    if (mesh_index >= meshes.len) return;
+    pick_scene.refit_region(mesh_index, &meshes[mesh_index], region);
+}
+
+/// Whether a transform, parent link or mesh assignment changed since the last check; gizmo drags
+/// and inspector edits write these directly.
+fn transforms_moved(state: *EditorState) bool {
+    const registry = state.runtime.registry;
+    const since = pick_transform_cursor.begin(registry);
+    defer pick_transform_cursor.end(registry);
+    if (since == 0) return true;
+    inline for (.{ components.Transform, components.Hierarchy, components.MeshRenderer }) |T| {
+        if (registry.any_changed(T, since) or registry.any_removed(T, since)) return true;
+    }
+    return false;
+}
+
+/// Per-frame picking upkeep: notices moved transforms, adopts finished mesh BVH builds and starts
+/// new ones, so a pick rarely has to build anything itself.
+pub fn update_picking_cache(state: *EditorState) void {
+    const allocator = pick_allocator();
+    const meshes = scene_meshes(state);
+    if (pick_scene.instances.items.len != meshes.len) {
+        pick_scene.resize(allocator, meshes.len) catch return;
+        pick_instances_dirty = true;
+    }
+
+    if (transforms_moved(state)) pick_instances_dirty = true;
+
+    pick_scene.poll(allocator, meshes);
+    pick_scene.prefetch(allocator, meshes, pick_bvh.DEFAULT_MAX_BUILDS_IN_FLIGHT);
+}
+
+/// Brings instance transforms up to date if anything moved and returns the scene's meshes. The
+/// top-level BVH is rebuilt lazily by the query that follows.
+fn sync_pick_instances(state: *EditorState) []const scene.CardinalMesh {
+    const meshes = scene_meshes(state);
+    if (pick_scene.instances.items.len != meshes.len) {
+        pick_scene.resize(pick_allocator(), meshes.len) catch return &.{};
+        pick_instances_dirty = true;
     }
-    pick_bvh_cache.deinit(allocator);
-    pick_bvh_cache = .{};
+    if (!pick_instances_dirty) return meshes;
+
+    const scratch = engine.memory.scratch_begin() orelse return meshes;
+    defer scratch.end();
+    const alloc = scratch.allocator();
+    var world_cache: std.AutoHashMapUnmanaged(u64, math.Mat4) = .{};
+
+    pick_scene.invalidate_tlas();
+    for (meshes, 0..) |*mesh, i| {
+        const mesh_index: u32 = @intCast(i);
+        pick_scene.update_instance(mesh_index, mesh, mesh_world_matrix(state, alloc, &world_cache, mesh_index, mesh));
+    }
+    pick_instances_dirty = false;
+    return meshes;
 }
 
 /// Computes a world-space ray from the current mouse position.
@@ -429,505 +492,55 @@ pub fn get_ray_from_mouse(state: *EditorState) ?math.Ray {
     return math.Ray{ .origin = state.runtime.camera.position, .direction = ray_world };
 }
 
-fn build_mesh_bvh(mesh: *const scene.CardinalMesh) ?MeshPickBvh {
-    const allocator = engine.memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
-    const verts: [*]const scene.CardinalVertex = @ptrCast(mesh.vertices.?);
-    const idxs: [*]const u32 = @ptrCast(mesh.indices.?);
-
-    const tri_count: u32 = mesh.index_count / 3;
-    if (tri_count == 0) return null;
-
-    const TriBuild = struct {
-        tri_offset: u32,
-        centroid: math.Vec3,
-        aabb: math.AABB,
-    };
-
-    var tri_build = allocator.alloc(TriBuild, tri_count) catch return null;
-    defer allocator.free(tri_build);
-
-    var ti: u32 = 0;
-    while (ti < tri_count) : (ti += 1) {
-        const tri_offset: u32 = ti * 3;
-        const idx0 = idxs[tri_offset + 0];
-        const idx1 = idxs[tri_offset + 1];
-        const idx2 = idxs[tri_offset + 2];
-        if (idx0 >= mesh.vertex_count or idx1 >= mesh.vertex_count or idx2 >= mesh.vertex_count) {
-            tri_build[ti] = .{
-                .tri_offset = tri_offset,
-                .centroid = math.Vec3.zero(),
-                .aabb = .{ .min = math.Vec3.zero(), .max = math.Vec3.zero() },
-            };
-            continue;
-        }
-
-        const p0 = math.Vec3{ .x = verts[idx0].px, .y = verts[idx0].py, .z = verts[idx0].pz };
-        const p1 = math.Vec3{ .x = verts[idx1].px, .y = verts[idx1].py, .z = verts[idx1].pz };
-        const p2 = math.Vec3{ .x = verts[idx2].px, .y = verts[idx2].py, .z = verts[idx2].pz };
-
-        const min = math.Vec3{
-            .x = @min(p0.x, @min(p1.x, p2.x)),
-            .y = @min(p0.y, @min(p1.y, p2.y)),
-            .z = @min(p0.z, @min(p1.z, p2.z)),
-        };
-        const max = math.Vec3{
-            .x = @max(p0.x, @max(p1.x, p2.x)),
-            .y = @max(p0.y, @max(p1.y, p2.y)),
-            .z = @max(p0.z, @max(p1.z, p2.z)),
-        };
-
-        tri_build[ti] = .{
-            .tri_offset = tri_offset,
-            .centroid = p0.add(p1).add(p2).mul(1.0 / 3.0),
-            .aabb = .{ .min = min, .max = max },
-        };
-    }
-
-    var tri_offsets = allocator.alloc(u32, tri_count) catch return null;
-    errdefer allocator.free(tri_offsets);
-    for (tri_build, 0..) |t, i| tri_offsets[i] = t.tri_offset;
-
-    var nodes_list = std.ArrayListUnmanaged(BVHNode){};
-    errdefer {
-        allocator.free(tri_offsets);
-        nodes_list.deinit(allocator);
-    }
-
-    const BuildCtx = struct {
-        tris: []TriBuild,
-        offsets: []u32,
-        nodes: *std.ArrayListUnmanaged(BVHNode),
-        allocator: std.mem.Allocator,
-
-        fn build(self: *@This(), start: u32, count: u32) !u32 {
-            const node_index: u32 = @intCast(self.nodes.items.len);
-            try self.nodes.append(self.allocator, undefined);
-
-            var bounds_min = math.Vec3{ .x = std.math.floatMax(f32), .y = std.math.floatMax(f32), .z = std.math.floatMax(f32) };
-            var bounds_max = math.Vec3{ .x = -std.math.floatMax(f32), .y = -std.math.floatMax(f32), .z = -std.math.floatMax(f32) };
-
-            var i: u32 = 0;
-            while (i < count) : (i += 1) {
-                const t = self.tris[start + i];
-                bounds_min.x = @min(bounds_min.x, t.aabb.min.x);
-                bounds_min.y = @min(bounds_min.y, t.aabb.min.y);
-                bounds_min.z = @min(bounds_min.z, t.aabb.min.z);
-                bounds_max.x = @max(bounds_max.x, t.aabb.max.x);
-                bounds_max.y = @max(bounds_max.y, t.aabb.max.y);
-                bounds_max.z = @max(bounds_max.z, t.aabb.max.z);
-            }
-
-            if (count <= 8) {
-                self.nodes.items[node_index] = .{
-                    .aabb = .{ .min = bounds_min, .max = bounds_max },
-                    .left = 0,
-                    .right = 0,
-                    .first = start,
-                    .count = count,
-                };
-                return node_index;
-            }
-
-            var cmin = math.Vec3{ .x = std.math.floatMax(f32), .y = std.math.floatMax(f32), .z = std.math.floatMax(f32) };
-            var cmax = math.Vec3{ .x = -std.math.floatMax(f32), .y = -std.math.floatMax(f32), .z = -std.math.floatMax(f32) };
-            i = 0;
-            while (i < count) : (i += 1) {
-                const cent = self.tris[start + i].centroid;
-                cmin.x = @min(cmin.x, cent.x);
-                cmin.y = @min(cmin.y, cent.y);
-                cmin.z = @min(cmin.z, cent.z);
-                cmax.x = @max(cmax.x, cent.x);
-                cmax.y = @max(cmax.y, cent.y);
-                cmax.z = @max(cmax.z, cent.z);
-            }
-
-            const ext = cmax.sub(cmin);
-            const axis: u32 = if (ext.x >= ext.y and ext.x >= ext.z) 0 else if (ext.y >= ext.z) 1 else 2;
-
-            const slice = self.tris[start .. start + count];
-            const Cmp = struct {
-                axis: u32,
-                fn less_than(ctx: @This(), a: TriBuild, b: TriBuild) bool {
-                    return switch (ctx.axis) {
-                        0 => a.centroid.x < b.centroid.x,
-                        1 => a.centroid.y < b.centroid.y,
-                        else => a.centroid.z < b.centroid.z,
-                    };
-                }
-            };
-            std.sort.pdq(TriBuild, slice, Cmp{ .axis = axis }, Cmp.less_than);
-
-            const mid = start + count / 2;
-            const left = try self.build(start, mid - start);
-            const right = try self.build(mid, start + count - mid);
-
-            self.nodes.items[node_index] = .{
-                .aabb = .{ .min = bounds_min, .max = bounds_max },
-                .left = left,
-                .right = right,
-                .first = 0,
-                .count = 0,
-            };
-            return node_index;
-        }
-    };
-
-    var ctx = BuildCtx{ .tris = tri_build, .offsets = tri_offsets, .nodes = &nodes_list, .allocator = allocator };
-    const root = ctx.build(0, tri_count) catch return null;
-
-    for (ctx.tris, 0..) |t, i| ctx.offsets[i] = t.tri_offset;
-
-    const nodes = nodes_list.toOwnedSlice(allocator) catch return null;
-    return .{
-        .nodes = nodes,
-        .tri_offsets = tri_offsets,
-        .root = root,
-        .vertices_ptr = @intFromPtr(mesh.vertices.?),
-        .indices_ptr = @intFromPtr(mesh.indices.?),
-        .vertex_count = mesh.vertex_count,
-        .index_count = mesh.index_count,
-    };
-}
-
-fn get_mesh_bvh(mesh_index: u32, mesh: *const scene.CardinalMesh) ?*const MeshPickBvh {
-    const allocator = engine.memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
-
-    if (pick_bvh_cache.getPtr(mesh_index)) |bvh| {
-        if (bvh.vertices_ptr == @intFromPtr(mesh.vertices.?) and
-            bvh.indices_ptr == @intFromPtr(mesh.indices.?) and
-            bvh.vertex_count == mesh.vertex_count and
-            bvh.index_count == mesh.index_count)
-        {
-            return bvh;
-        }
-        bvh.deinit(allocator);
-        _ = pick_bvh_cache.remove(mesh_index);
-    }
-
-    const built = build_mesh_bvh(mesh) orelse return null;
-    pick_bvh_cache.put(allocator, mesh_index, built) catch {
-        var tmp = built;
-        tmp.deinit(allocator);
-        return null;
-    };
-    return pick_bvh_cache.getPtr(mesh_index);
-}
-
 /// Raycasts against a combined-scene mesh and returns the closest hit point in world space.
 ///
-/// Uses the per-mesh BVH cache for performance. Intended for editor tools that need
-/// accurate surface hits (e.g. terrain sculpting from the side).
+/// Uses the mesh's picking BVH. Intended for editor tools that need accurate surface hits
+/// (e.g. terrain sculpting from the side).
 pub fn raycast_combined_mesh_point(state: *EditorState, mesh_index: u32, ray: math.Ray) ?math.Vec3 {
-    if (state.runtime.combined_scene.meshes == null or state.runtime.combined_scene.mesh_count == 0) return null;
-    if (mesh_index >= state.runtime.combined_scene.mesh_count) return null;
-
-    const mesh = &state.runtime.combined_scene.meshes.?[mesh_index];
-    if (!mesh.visible) return null;
-    if (mesh.vertices == null or mesh.indices == null or mesh.index_count < 3) return null;
-
-    const alloc = engine.memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
-    var world_cache: std.AutoHashMapUnmanaged(u64, math.Mat4) = .{};
-    defer world_cache.deinit(alloc);
-
-    const min_arr = mesh.bounding_box_min;
-    const max_arr = mesh.bounding_box_max;
-    const min = math.Vec3{ .x = min_arr[0], .y = min_arr[1], .z = min_arr[2] };
-    const max = math.Vec3{ .x = max_arr[0], .y = max_arr[1], .z = max_arr[2] };
-    const aabb = math.AABB{ .min = min, .max = max };
-
-    const world_mat = mesh_world_matrix(state, alloc, &world_cache, mesh_index, mesh);
-    const world_aabb = aabb.transform(world_mat);
-    _ = math.intersectRayAABB(ray, world_aabb, 0.001, 10000.0) orelse return null;
-
-    const inv_world = world_mat.invert() orelse return null;
-    const local_origin = inv_world.transformPoint(ray.origin);
-    const local_dir = inv_world.transformVector(ray.direction);
-    const local_ray = math.Ray{ .origin = local_origin, .direction = local_dir };
-
-    const bvh = get_mesh_bvh(mesh_index, mesh) orelse return null;
-    const verts: [*]const scene.CardinalVertex = @ptrCast(mesh.vertices.?);
-    const idxs: [*]const u32 = @ptrCast(mesh.indices.?);
-
-    var closest_t: f32 = std.math.floatMax(f32);
-    var closest_world: ?math.Vec3 = null;
-
-    var stack: [128]u32 = undefined;
-    var sp: usize = 0;
-    stack[sp] = bvh.root;
-    sp += 1;
-
-    while (sp > 0) {
-        sp -= 1;
-        const node_index = stack[sp];
-        const node = bvh.nodes[node_index];
-
-        const t_local = math.intersectRayAABB(local_ray, node.aabb, 0.0, std.math.floatMax(f32)) orelse continue;
-        const local_p = local_ray.origin.add(local_ray.direction.mul(t_local));
-        const world_p = world_mat.transformPoint(local_p);
-        const t_world = world_p.sub(ray.origin).dot(ray.direction);
-        if (t_world <= 0.0 or t_world >= closest_t) continue;
-
-        if (node.count == 0) {
-            if (sp + 2 <= stack.len) {
-                stack[sp] = node.left;
-                stack[sp + 1] = node.right;
-                sp += 2;
-            }
-            continue;
-        }
-
-        var j: u32 = 0;
-        while (j < node.count) : (j += 1) {
-            const tri_off = bvh.tri_offsets[node.first + j];
-            if (tri_off + 2 >= mesh.index_count) continue;
-
-            const idx0 = idxs[tri_off + 0];
-            const idx1 = idxs[tri_off + 1];
-            const idx2 = idxs[tri_off + 2];
-            if (idx0 >= mesh.vertex_count or idx1 >= mesh.vertex_count or idx2 >= mesh.vertex_count) continue;
-            if (idx0 == idx1 or idx1 == idx2 or idx0 == idx2) continue;
-
-            const p0 = math.Vec3{ .x = verts[idx0].px, .y = verts[idx0].py, .z = verts[idx0].pz };
-            const p1 = math.Vec3{ .x = verts[idx1].px, .y = verts[idx1].py, .z = verts[idx1].pz };
-            const p2 = math.Vec3{ .x = verts[idx2].px, .y = verts[idx2].py, .z = verts[idx2].pz };
-
-            if (intersect_ray_triangle(local_ray, p0, p1, p2, 0.0, std.math.floatMax(f32))) |hit| {
-                const local_hit = local_ray.origin.add(local_ray.direction.mul(hit.t));
-                const world_hit = world_mat.transformPoint(local_hit);
-                const hit_t_world = world_hit.sub(ray.origin).dot(ray.direction);
-                if (hit_t_world <= 0.0 or hit_t_world >= closest_t) continue;
-
-                closest_t = hit_t_world;
-                closest_world = world_hit;
-            }
-        }
-    }
-
-    return closest_world;
+    return raycast_single_mesh(state, mesh_index, ray, false);
 }
 
 pub fn raycast_combined_mesh_point_allow_invisible(state: *EditorState, mesh_index: u32, ray: math.Ray) ?math.Vec3 {
-    if (state.runtime.combined_scene.meshes == null or state.runtime.combined_scene.mesh_count == 0) return null;
-    if (mesh_index >= state.runtime.combined_scene.mesh_count) return null;
+    return raycast_single_mesh(state, mesh_index, ray, true);
+}
 
-    const mesh = &state.runtime.combined_scene.meshes.?[mesh_index];
-    if (mesh.vertices == null or mesh.indices == null or mesh.index_count < 3) return null;
+fn raycast_single_mesh(state: *EditorState, mesh_index: u32, ray: math.Ray, include_invisible: bool) ?math.Vec3 {
+    const meshes = scene_meshes(state);
+    if (mesh_index >= meshes.len) return null;
+    const mesh = &meshes[mesh_index];
 
-    const alloc = engine.memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
+    const scratch = engine.memory.scratch_begin() orelse return null;
+    defer scratch.end();
     var world_cache: std.AutoHashMapUnmanaged(u64, math.Mat4) = .{};
-    defer world_cache.deinit(alloc);
-
-    const min_arr = mesh.bounding_box_min;
-    const max_arr = mesh.bounding_box_max;
-    const min = math.Vec3{ .x = min_arr[0], .y = min_arr[1], .z = min_arr[2] };
-    const max = math.Vec3{ .x = max_arr[0], .y = max_arr[1], .z = max_arr[2] };
-    const aabb = math.AABB{ .min = min, .max = max };
-
-    const world_mat = mesh_world_matrix(state, alloc, &world_cache, mesh_index, mesh);
-    const world_aabb = aabb.transform(world_mat);
-    _ = math.intersectRayAABB(ray, world_aabb, 0.001, 10000.0) orelse return null;
-
-    const inv_world = world_mat.invert() orelse return null;
-    const local_origin = inv_world.transformPoint(ray.origin);
-    const local_dir = inv_world.transformVector(ray.direction);
-    const local_ray = math.Ray{ .origin = local_origin, .direction = local_dir };
-
-    const bvh = get_mesh_bvh(mesh_index, mesh) orelse return null;
-    const verts: [*]const scene.CardinalVertex = @ptrCast(mesh.vertices.?);
-    const idxs: [*]const u32 = @ptrCast(mesh.indices.?);
-
-    var closest_t: f32 = std.math.floatMax(f32);
-    var closest_world: ?math.Vec3 = null;
-
-    var stack: [128]u32 = undefined;
-    var sp: usize = 0;
-    stack[sp] = bvh.root;
-    sp += 1;
-
-    while (sp > 0) {
-        sp -= 1;
-        const node_index = stack[sp];
-        const node = bvh.nodes[node_index];
-
-        const t_local = math.intersectRayAABB(local_ray, node.aabb, 0.0, std.math.floatMax(f32)) orelse continue;
-        const local_p = local_ray.origin.add(local_ray.direction.mul(t_local));
-        const world_p = world_mat.transformPoint(local_p);
-        const t_world = world_p.sub(ray.origin).dot(ray.direction);
-        if (t_world <= 0.0 or t_world >= closest_t) continue;
-
-        if (node.count == 0) {
-            if (sp + 2 <= stack.len) {
-                stack[sp] = node.left;
-                stack[sp + 1] = node.right;
-                sp += 2;
-            }
-            continue;
-        }
-
-        var j: u32 = 0;
-        while (j < node.count) : (j += 1) {
-            const tri_off = bvh.tri_offsets[node.first + j];
-            if (tri_off + 2 >= mesh.index_count) continue;
-
-            const idx0 = idxs[tri_off + 0];
-            const idx1 = idxs[tri_off + 1];
-            const idx2 = idxs[tri_off + 2];
-            if (idx0 >= mesh.vertex_count or idx1 >= mesh.vertex_count or idx2 >= mesh.vertex_count) continue;
-            if (idx0 == idx1 or idx1 == idx2 or idx0 == idx2) continue;
-
-            const p0 = math.Vec3{ .x = verts[idx0].px, .y = verts[idx0].py, .z = verts[idx0].pz };
-            const p1 = math.Vec3{ .x = verts[idx1].px, .y = verts[idx1].py, .z = verts[idx1].pz };
-            const p2 = math.Vec3{ .x = verts[idx2].px, .y = verts[idx2].py, .z = verts[idx2].pz };
-
-            if (intersect_ray_triangle(local_ray, p0, p1, p2, 0.0, std.math.floatMax(f32))) |hit| {
-                const local_hit = local_ray.origin.add(local_ray.direction.mul(hit.t));
-                const world_hit = world_mat.transformPoint(local_hit);
-                const hit_t_world = world_hit.sub(ray.origin).dot(ray.direction);
-                if (hit_t_world <= 0.0 or hit_t_world >= closest_t) continue;
-
-                closest_t = hit_t_world;
-                closest_world = world_hit;
-            }
-        }
-    }
+    const world_mat = mesh_world_matrix(state, scratch.allocator(), &world_cache, mesh_index, mesh);
 
-    return closest_world;
+    const hit = pick_scene.raycast_mesh(pick_allocator(), mesh_index, mesh, world_mat, ray, .{ .include_invisible = include_invisible }, pick_bvh.AcceptAll{}) orelse return null;
+    return hit.point;
 }
 
-fn pick_combined_mesh(state: *EditorState, ray: math.Ray) ?u32 {
-    if (state.runtime.combined_scene.meshes == null or state.runtime.combined_scene.mesh_count == 0) return null;
-    const meshes = state.runtime.combined_scene.meshes.?;
-
-    var closest_t_alpha: f32 = std.math.floatMax(f32);
-    var hit_mesh_alpha: ?u32 = null;
-    var closest_t_any: f32 = std.math.floatMax(f32);
-    var hit_mesh_any: ?u32 = null;
+/// Accepts hits whose surface passes the material's alpha test.
+const AlphaFilter = struct {
+    scn: *const scene.CardinalScene,
 
-    const alloc = engine.memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
-    var world_cache: std.AutoHashMapUnmanaged(u64, math.Mat4) = .{};
-    defer world_cache.deinit(alloc);
-
-    const t_min: f32 = 0.001;
-    const t_max: f32 = 10000.0;
-
-    var i: u32 = 0;
-    while (i < state.runtime.combined_scene.mesh_count) : (i += 1) {
-        const mesh = &meshes[i];
-        if (!mesh.visible) continue;
-        if (mesh.vertices == null or mesh.indices == null or mesh.index_count < 3) continue;
-
-        const min_arr = mesh.bounding_box_min;
-        const max_arr = mesh.bounding_box_max;
-        const min = math.Vec3{ .x = min_arr[0], .y = min_arr[1], .z = min_arr[2] };
-        const max = math.Vec3{ .x = max_arr[0], .y = max_arr[1], .z = max_arr[2] };
-
-        const aabb = math.AABB{ .min = min, .max = max };
-        const world_mat = mesh_world_matrix(state, alloc, &world_cache, i, mesh);
-        const world_aabb = aabb.transform(world_mat);
-
-        const aabb_t = math.intersectRayAABB(ray, world_aabb, t_min, t_max) orelse continue;
-        if (aabb_t >= closest_t_any) continue;
-
-        const inv_world = world_mat.invert() orelse continue;
-        const local_origin = inv_world.transformPoint(ray.origin);
-        const local_dir = inv_world.transformVector(ray.direction);
-        const local_ray = math.Ray{ .origin = local_origin, .direction = local_dir };
-
-        const bvh = get_mesh_bvh(i, mesh) orelse continue;
-
-        const verts: [*]const scene.CardinalVertex = @ptrCast(mesh.vertices.?);
-        const idxs: [*]const u32 = @ptrCast(mesh.indices.?);
-
-        var stack: [128]u32 = undefined;
-        var sp: usize = 0;
-        stack[sp] = bvh.root;
-        sp += 1;
-
-        while (sp > 0) {
-            sp -= 1;
-            const node_index = stack[sp];
-            const node = bvh.nodes[node_index];
-
-            const t_local = math.intersectRayAABB(local_ray, node.aabb, 0.0, std.math.floatMax(f32)) orelse continue;
-            const local_p = local_ray.origin.add(local_ray.direction.mul(t_local));
-            const world_p = world_mat.transformPoint(local_p);
-            const t_world = world_p.sub(ray.origin).dot(ray.direction);
-            if (t_world <= 0.0 or t_world >= closest_t_any) continue;
-
-            if (node.count == 0) {
-                if (sp + 2 <= stack.len) {
-                    stack[sp] = node.left;
-                    stack[sp + 1] = node.right;
-                    sp += 2;
-                }
-                continue;
-            }
-
-            var j: u32 = 0;
-            while (j < node.count) : (j += 1) {
-                const tri_off = bvh.tri_offsets[node.first + j];
-                if (tri_off + 2 >= mesh.index_count) continue;
-
-                const idx0 = idxs[tri_off + 0];
-                const idx1 = idxs[tri_off + 1];
-                const idx2 = idxs[tri_off + 2];
-                if (idx0 >= mesh.vertex_count or idx1 >= mesh.vertex_count or idx2 >= mesh.vertex_count) continue;
-
-                const p0 = math.Vec3{ .x = verts[idx0].px, .y = verts[idx0].py, .z = verts[idx0].pz };
-                const p1 = math.Vec3{ .x = verts[idx1].px, .y = verts[idx1].py, .z = verts[idx1].pz };
-                const p2 = math.Vec3{ .x = verts[idx2].px, .y = verts[idx2].py, .z = verts[idx2].pz };
-
-                if (intersect_ray_triangle(local_ray, p0, p1, p2, 0.0, std.math.floatMax(f32))) |hit| {
-                    const local_hit = local_ray.origin.add(local_ray.direction.mul(hit.t));
-                    const world_hit = world_mat.transformPoint(local_hit);
-                    const hit_t_world = world_hit.sub(ray.origin).dot(ray.direction);
-                    if (hit_t_world <= 0.0 or hit_t_world >= closest_t_any) continue;
-
-                    closest_t_any = hit_t_world;
-                    hit_mesh_any = i;
-
-                    if (hit_passes_alpha_test(&state.runtime.combined_scene, mesh, verts, idx0, idx1, idx2, hit.u, hit.v)) {
-                        if (hit_t_world < closest_t_alpha) {
-                            closest_t_alpha = hit_t_world;
-                            hit_mesh_alpha = i;
-                        }
-                    }
-                }
-            }
-        }
+    pub fn accept(self: AlphaFilter, mesh_index: u32, tri_offset: u32, u: f32, v: f32) bool {
+        const mesh = &self.scn.meshes.?[mesh_index];
+        const idxs = mesh.indices.?;
+        return hit_passes_alpha_test(self.scn, mesh, mesh.vertices.?, idxs[tri_offset], idxs[tri_offset + 1], idxs[tri_offset + 2], u, v);
     }
-
-    return hit_mesh_alpha orelse hit_mesh_any;
-}
-
-const TriHit = struct {
-    t: f32,
-    u: f32,
-    v: f32,
 };
 
-fn intersect_ray_triangle(ray: math.Ray, v0: math.Vec3, v1: math.Vec3, v2: math.Vec3, t_min: f32, t_max: f32) ?TriHit {
-    const eps: f32 = 0.000001;
-
-    const edge1 = v1.sub(v0);
-    const edge2 = v2.sub(v0);
-
-    const h = ray.direction.cross(edge2);
-    const a = edge1.dot(h);
-    if (@abs(a) < eps) return null;
-
-    const f = 1.0 / a;
-    const s = ray.origin.sub(v0);
-    const u = f * s.dot(h);
-    if (u < 0.0 or u > 1.0) return null;
-
-    const q = s.cross(edge1);
-    const v = f * ray.direction.dot(q);
-    if (v < 0.0 or (u + v) > 1.0) return null;
-
-    const t = f * edge2.dot(q);
-    if (t < t_min or t > t_max) return null;
-    return .{ .t = t, .u = u, .v = v };
+fn pick_combined_mesh(state: *EditorState, ray: math.Ray) ?u32 {
+    const meshes = sync_pick_instances(state);
+    if (meshes.len == 0) return null;
+    const allocator = pick_allocator();
+
+    // Prefer the closest surface that survives its alpha test, but still pick a fully cut-out
+    // mesh when nothing else is under the cursor.
+    if (pick_scene.raycast(allocator, meshes, ray, .{}, AlphaFilter{ .scn = &state.runtime.combined_scene })) |hit| {
+        return hit.mesh_index;
+    }
+    const hit = pick_scene.raycast(allocator, meshes, ray, .{}, pick_bvh.AcceptAll{}) orelse return null;
+    return hit.mesh_index;
 }
 
 fn hit_passes_alpha_test(scn: *const scene.CardinalScene, mesh: *const scene.CardinalMesh, verts: [*]const scene.CardinalVertex, idx0: u32, idx1: u32, idx2: u32, bc_u: f32, bc_v: f32) bool {
@@ -1024,17 +637,17 @@ fn mesh_index_to_entity(state: *EditorState, mesh_index: u32, owner: bool) ?engi
     return null;
 }
 
+/// Entity a click on `mesh_index` selects: the owning node, or the mesh's own entity with alt.
+fn picked_entity(state: *EditorState, mesh_index: u32) ?engine.ecs_entity.Entity {
+    if (c.imgui_bridge_is_alt_down()) return mesh_index_to_entity(state, mesh_index, false);
+    return mesh_index_to_entity(state, mesh_index, true) orelse mesh_index_to_entity(state, mesh_index, false);
+}
+
 /// Picks the closest mesh under the cursor and updates UI selection.
 pub fn pick_under_mouse(state: *EditorState) void {
     if (get_ray_from_mouse(state)) |ray| {
         if (pick_combined_mesh(state, ray)) |mesh_index| {
-            const pick_single_mesh = c.imgui_bridge_is_alt_down();
-            const ent = if (pick_single_mesh)
-                mesh_index_to_entity(state, mesh_index, false)
-            else
-                mesh_index_to_entity(state, mesh_index, true) orelse mesh_index_to_entity(state, mesh_index, false);
-
-            if (ent) |e| {
+            if (picked_entity(state, mesh_index)) |e| {
                 const alloc = engine.memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
                 state.ui.selected_entity = e;
                 state.ui.selected_model_id = 0;
@@ -1061,3 +674,47 @@ pub fn pick_under_mouse(state: *EditorState) void {
         }
     }
 }
+
+/// Selects every visible mesh whose bounds reach into the screen rectangle spanned by `a` and `b`
+/// (window pixels). Adds to the selection while ctrl is held.
+pub fn select_in_screen_rect(state: *EditorState, a: c.ImVec2, b: c.ImVec2) void {
+    const win_width: f32 = @floatFromInt(state.runtime.window.width);
+    const win_height: f32 = @floatFromInt(state.runtime.window.height);
+    if (win_width <= 0.0 or win_height <= 0.0) return;
+
+    // Same pixel-to-NDC mapping as `get_ray_from_mouse`.
+    const x0 = 2.0 * @min(a.x, b.x) / win_width - 1.0;
+    const x1 = 2.0 * @max(a.x, b.x) / win_width - 1.0;
+    const y0 = 2.0 * @min(a.y, b.y) / win_height - 1.0;
+    const y1 = 2.0 * @max(a.y, b.y) / win_height - 1.0;
+    if (x1 - x0 < 0.0001 or y1 - y0 < 0.0001) return;
+
+    // Stretching the rectangle over all of clip space turns the view frustum into the part of it
+    // behind the rectangle.
+    var crop = math.Mat4.identity();
+    crop.data[0] = 2.0 / (x1 - x0);
+    crop.data[5] = 2.0 / (y1 - y0);
+    crop.data[12] = -(x1 + x0) / (x1 - x0);
+    crop.data[13] = -(y1 + y0) / (y1 - y0);
+
+    const view = math.Mat4.lookAt(state.runtime.camera.position, state.runtime.camera.target, state.runtime.camera.up);
+    const proj = math.Mat4.perspective(math.toRadians(state.runtime.camera.fov), state.runtime.camera.aspect, state.runtime.camera.near_plane, state.runtime.camera.far_plane);
+    const frustum = math.Frustum.fromMatrix(crop.mul(proj.mul(view)));
+
+    const alloc = pick_allocator();
+    const meshes = sync_pick_instances(state);
+    var found: std.ArrayListUnmanaged(u32) = .{};
+    defer found.deinit(alloc);
+    pick_scene.query_frustum(alloc, meshes, frustum, false, &found);
+
+    if (!c.imgui_bridge_is_ctrl_down()) {
+        state.ui.selected_entities.clearRetainingCapacity();
+        state.ui.selected_entity = .{ .id = std.math.maxInt(u64) };
+    }
+    state.ui.selected_model_id = 0;
+    for (found.items) |mesh_index| {
+        const e = picked_entity(state, mesh_index) orelse continue;
+        state.ui.selected_entities.put(alloc, e.id, {}) catch continue;
+        state.ui.selected_entity = e;
+    }
+}
@@ -22,6 +22,60 @@ pub fn reset_picking_cache() void {
     selection_raycast.reset_picking_cache();
 }
 
+/// Marks picking data out of date after scene edits; mesh BVHs are refit rather than rebuilt.
+pub fn invalidate_picking_cache() void {
+    selection_raycast.invalidate_picking_cache();
+}
+
+/// Re-reads instance transforms before the next pick.
+pub fn mark_picking_instances_dirty() void {
+    selection_raycast.mark_picking_instances_dirty();
+}
+
+/// Per-frame picking upkeep (background mesh BVH builds, moved instances).
+pub fn update_picking_cache(state: *EditorState) void {
+    selection_raycast.update_picking_cache(state);
+}
+
+/// Drags shorter than this (pixels) count as clicks.
+const MARQUEE_MIN_SIZE: f32 = 4.0;
+
+/// Screen position where the current shift-drag marquee started.
+var marquee_start: ?c.ImVec2 = null;
+
+/// Shift-drag selects everything inside a screen rectangle. Runs after the click pick, which
+/// a large enough rectangle overrides on release.
+fn update_marquee(state: *EditorState, clicked: bool) void {
+    if (clicked and c.imgui_bridge_is_shift_down() and !state.ui.terrain_sculpt_enabled) {
+        var start: c.ImVec2 = undefined;
+        c.imgui_bridge_get_mouse_pos(&start);
+        marquee_start = start;
+    }
+    const start = marquee_start orelse return;
+
+    var current: c.ImVec2 = undefined;
+    c.imgui_bridge_get_mouse_pos(&current);
+    const large = @abs(current.x - start.x) >= MARQUEE_MIN_SIZE or @abs(current.y - start.y) >= MARQUEE_MIN_SIZE;
+
+    if (c.imgui_bridge_is_mouse_down(0)) {
+        if (!large) return;
+        const p0 = c.ImVec2{ .x = @min(start.x, current.x), .y = @min(start.y, current.y) };
+        const p1 = c.ImVec2{ .x = @max(start.x, current.x), .y = @max(start.y, current.y) };
+        const p2 = c.ImVec2{ .x = p1.x, .y = p0.y };
+        const p3 = c.ImVec2{ .x = p0.x, .y = p1.y };
+        const border: u32 = 0xFFFFAA33;
+        c.imgui_bridge_draw_rect_filled(&p0, &p1, 0x30FFAA33);
+        c.imgui_bridge_draw_line(&p0, &p2, border, 1.0);
+        c.imgui_bridge_draw_line(&p2, &p1, border, 1.0);
+        c.imgui_bridge_draw_line(&p1, &p3, border, 1.0);
+        c.imgui_bridge_draw_line(&p3, &p0, border, 1.0);
+        return;
+    }
+
+    marquee_start = null;
+    if (large and !state.runtime.mouse_captured) selection_raycast.select_in_screen_rect(state, start, current);
+}
+
 /// Frames `root` in the scene view based on its computed bounds.
 pub fn frame_entity_in_scene_view(state: *EditorState, root: engine.ecs_entity.Entity) void {
     selection_raycast.frame_entity_in_scene_view(state, root);
@@ -31,7 +85,7 @@ fn lerp(a: f32, b: f32, t: f32) f32 {
     return a + (b - a) * t;
 }
 
-fn sample_height_bilinear(td: *editor_state.TerrainData, terr: *components.Terrain, local_x: f32, local_z: f32, use_bottom: bool) f32 {
+fn sample_height_bilinear(td: *editor_state.TerrainData, terr: *const components.Terrain, local_x: f32, local_z: f32, use_bottom: bool) f32 {
     if (td.dims < 2) return 0.0;
     const grid: u32 = td.dims - 1;
     const half_x = terr.size.x * 0.5;
@@ -81,10 +135,10 @@ fn find_terrain_height_at_world_xz(
     terrain_group: []const engine.ecs_entity.Entity,
     world_x: f32,
     world_z: f32,
-) ?struct { terr: *components.Terrain, tr: *components.Transform, td: *editor_state.TerrainData, local_x: f32, local_z: f32, base_h: f32 } {
+) ?struct { terr: *const components.Terrain, tr: *const components.Transform, td: *editor_state.TerrainData, local_x: f32, local_z: f32, base_h: f32 } {
     for (terrain_group) |e| {
-        const terr = state.runtime.registry.get(components.Terrain, e) orelse continue;
-        const tr = state.runtime.registry.get(components.Transform, e) orelse continue;
+        const terr = state.runtime.registry.get_const(components.Terrain, e) orelse continue;
+        const tr = state.runtime.registry.get_const(components.Transform, e) orelse continue;
         const td = state.runtime.terrain_data_by_entity.getPtr(e.id) orelse continue;
 
         const local_x = world_x - tr.position.x;
@@ -103,13 +157,13 @@ fn find_terrain_height_at_world_xz(
 }
 
 fn predicted_height_delta(
-    terr: *components.Terrain,
+    terr: *const components.Terrain,
     td: *editor_state.TerrainData,
     base_h: f32,
     local_x: f32,
     local_z: f32,
     center_world: math.Vec3,
-    tr: *components.Transform,
+    tr: *const components.Transform,
     tool: i32,
     mode: i32,
     radius: f32,
@@ -221,16 +275,18 @@ pub fn update(state: *EditorState) void {
     }
 
     const want_capture = c.imgui_bridge_want_capture_mouse();
-    if (!state.runtime.mouse_captured and c.imgui_bridge_is_mouse_clicked(0) and !want_capture and gizmo_system.allow_scene_pick()) {
+    const scene_click = !state.runtime.mouse_captured and c.imgui_bridge_is_mouse_clicked(0) and !want_capture and gizmo_system.allow_scene_pick();
+    if (scene_click) {
         selection_raycast.pick_under_mouse(state);
     }
+    update_marquee(state, scene_click);
 
     if (state.ui.selected_entity.id != std.math.maxInt(u64)) {
-        if (state.runtime.registry.get(components.EditorGlobals, state.ui.selected_entity) != null) {
+        if (state.runtime.registry.get_const(components.EditorGlobals, state.ui.selected_entity) != null) {
             state.ui.selected_model_id = 0;
             return;
         }
-        if (state.runtime.registry.get(components.Terrain, state.ui.selected_entity)) |_| {
+        if (state.runtime.registry.get_const(components.Terrain, state.ui.selected_entity)) |_| {
             var group: std.ArrayListUnmanaged(engine.ecs_entity.Entity) = .{};
             defer group.deinit(state.runtime.arena_allocator);
             terrain_volume.collect_connected_terrain(&state.runtime, state.ui.selected_entity, state.runtime.arena_allocator, &group);
@@ -239,7 +295,8 @@ pub fn update(state: *EditorState) void {
         } else {
             selection_raycast.draw_selection_xray(state, state.ui.selected_entity);
         }
-        if (state.runtime.registry.get(components.Transform, state.ui.selected_entity)) |t| {
+        // The gizmo marks the transform changed when it actually moves it.
+        if (state.runtime.registry.get_untracked(components.Transform, state.ui.selected_entity)) |t| {
             gizmo_system.draw_entity_gizmo(state, t);
             return;
         }
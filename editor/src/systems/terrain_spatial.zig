@@ -0,0 +1,98 @@
+//! Spatial indexes over terrain chunks for neighbour lookups and brush queries.
+//!
+//! Heightfield `Terrain` chunks are indexed by their footprint (down to the bottom surface) and
+//! `VolumetricTerrain` chunks by their box, both around `Transform.position` exactly as the
+//! terrain code places them. The indexes sync from the registry's change ticks on access, so a
+//! lookup after an edit only re-inserts the chunks that changed.
+const std = @import("std");
+const engine = @import("cardinal_engine");
+
+const log = engine.log;
+const math = engine.math;
+const components = engine.ecs_components;
+const Entity = engine.ecs_entity.Entity;
+const Registry = engine.ecs_registry.Registry;
+const SpatialIndex = engine.ecs_spatial_index.SpatialIndex;
+
+var terrain_chunks: ?SpatialIndex = null;
+var volumetric_chunks: ?SpatialIndex = null;
+/// Query results handed out by the helpers below, one list per index.
+var terrain_hits: std.ArrayListUnmanaged(Entity) = .{};
+var volumetric_hits: std.ArrayListUnmanaged(Entity) = .{};
+
+fn index_allocator() std.mem.Allocator {
+    return engine.memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
+}
+
+fn terrain_bounds(terr: *const components.Terrain, tr: *const components.Transform) ?math.AABB {
+    const p = tr.position;
+    const half_x = terr.size.x * 0.5;
+    const half_z = terr.size.y * 0.5;
+    return .{
+        .min = .{ .x = p.x - half_x, .y = p.y - @max(terr.thickness, 0.0), .z = p.z - half_z },
+        .max = .{ .x = p.x + half_x, .y = p.y, .z = p.z + half_z },
+    };
+}
+
+fn volumetric_bounds(vt: *const components.VolumetricTerrain, tr: *const components.Transform) ?math.AABB {
+    const half = vt.size.mul(0.5);
+    return .{ .min = tr.position.sub(half), .max = tr.position.add(half) };
+}
+
+fn synced(
+    slot: *?SpatialIndex,
+    registry: *Registry,
+    comptime T: type,
+    comptime bounds_fn: fn (*const T, *const components.Transform) ?math.AABB,
+) ?*SpatialIndex {
+    if (slot.* == null) {
+        // Cell size follows the chunk size, picked on each rebuild.
+        slot.* = SpatialIndex.init(index_allocator(), 0.0);
+    }
+    const index = &slot.*.?;
+    index.sync(registry, T, bounds_fn) catch |err| {
+        log.cardinal_log_warn("Terrain spatial index sync failed: {}", .{err});
+        return null;
+    };
+    return index;
+}
+
+/// Index of heightfield terrain chunks, synced with `registry`; null if it could not be built.
+pub fn terrain_index(registry: *Registry) ?*SpatialIndex {
+    return synced(&terrain_chunks, registry, components.Terrain, terrain_bounds);
+}
+
+/// Index of volumetric terrain chunks, synced with `registry`; null if it could not be built.
+pub fn volumetric_index(registry: *Registry) ?*SpatialIndex {
+    return synced(&volumetric_chunks, registry, components.VolumetricTerrain, volumetric_bounds);
+}
+
+/// Heightfield chunks whose footprint reaches within `tolerance` of `point`. The slice is valid
+/// until the next call; null if the index is unavailable and the caller should scan instead.
+pub fn terrain_chunks_near(registry: *Registry, point: math.Vec3, tolerance: f32) ?[]const Entity {
+    const index = terrain_index(registry) orelse return null;
+    const t = math.Vec3{ .x = tolerance, .y = tolerance, .z = tolerance };
+    index.query_box(.{ .min = point.sub(t), .max = point.add(t) }, index_allocator(), &terrain_hits) catch return null;
+    return terrain_hits.items;
+}
+
+/// Volumetric chunks whose box overlaps the sphere. The slice is valid until the next call; null
+/// if the index is unavailable and the caller should scan instead.
+pub fn volumetric_chunks_in_sphere(registry: *Registry, center: math.Vec3, radius: f32) ?[]const Entity {
+    const index = volumetric_index(registry) orelse return null;
+    index.query_sphere(center, radius, index_allocator(), &volumetric_hits) catch return null;
+    return volumetric_hits.items;
+}
+
+/// Frees both indexes; they rebuild on next use.
+pub fn reset() void {
+    const allocator = index_allocator();
+    if (terrain_chunks) |*index| index.deinit();
+    if (volumetric_chunks) |*index| index.deinit();
+    terrain_chunks = null;
+    volumetric_chunks = null;
+    terrain_hits.deinit(allocator);
+    volumetric_hits.deinit(allocator);
+    terrain_hits = .{};
+    volumetric_hits = .{};
+}
@@ -9,6 +9,7 @@ const engine = @import("cardinal_engine");
 
 const editor_state = @import("../editor_state.zig");
 const EditorRuntimeState = editor_state.EditorRuntimeState;
+const terrain_spatial = @import("terrain_spatial.zig");
 
 const math = engine.math;
 const components = engine.ecs_components;
@@ -71,50 +72,44 @@ const NeighborMask = struct {
 ///
 /// This is used to suppress duplicate walls on shared borders.
 pub fn compute_neighbor_mask(runtime: *EditorRuntimeState, self_ent: engine.ecs_entity.Entity) NeighborMask {
-    const self_tr = runtime.registry.get(components.Transform, self_ent) orelse return .{};
-    const self_terr = runtime.registry.get(components.Terrain, self_ent) orelse return .{};
-
-    const want_left = math.Vec3{ .x = self_tr.position.x - self_terr.size.x, .y = self_tr.position.y, .z = self_tr.position.z };
-    const want_right = math.Vec3{ .x = self_tr.position.x + self_terr.size.x, .y = self_tr.position.y, .z = self_tr.position.z };
-    const want_up = math.Vec3{ .x = self_tr.position.x, .y = self_tr.position.y, .z = self_tr.position.z - self_terr.size.y };
-    const want_down = math.Vec3{ .x = self_tr.position.x, .y = self_tr.position.y, .z = self_tr.position.z + self_terr.size.y };
-
-    var mask: NeighborMask = .{};
-
-    var view = runtime.registry.view(components.Terrain);
-    var it = view.iterator();
-    while (it.next()) |entry| {
-        if (entry.entity.id == self_ent.id) continue;
-        const other_terr = entry.component;
-        if (@abs(other_terr.size.x - self_terr.size.x) > 0.001) continue;
-        if (@abs(other_terr.size.y - self_terr.size.y) > 0.001) continue;
-        const tr = runtime.registry.get(components.Transform, entry.entity) orelse continue;
-
-        if (!mask.left and @abs(tr.position.x - want_left.x) <= 0.01 and @abs(tr.position.y - want_left.y) <= 0.01 and @abs(tr.position.z - want_left.z) <= 0.01) mask.left = true;
-        if (!mask.right and @abs(tr.position.x - want_right.x) <= 0.01 and @abs(tr.position.y - want_right.y) <= 0.01 and @abs(tr.position.z - want_right.z) <= 0.01) mask.right = true;
-        if (!mask.up and @abs(tr.position.x - want_up.x) <= 0.01 and @abs(tr.position.y - want_up.y) <= 0.01 and @abs(tr.position.z - want_up.z) <= 0.01) mask.up = true;
-        if (!mask.down and @abs(tr.position.x - want_down.x) <= 0.01 and @abs(tr.position.y - want_down.y) <= 0.01 and @abs(tr.position.z - want_down.z) <= 0.01) mask.down = true;
-
-        if (mask.left and mask.right and mask.up and mask.down) break;
-    }
+    const self_tr = runtime.registry.get_const(components.Transform, self_ent) orelse return .{};
+    const self_terr = runtime.registry.get_const(components.Terrain, self_ent) orelse return .{};
+    const p = self_tr.position;
+
+    return .{
+        .left = find_adjacent_terrain(runtime, self_ent, .{ .x = p.x - self_terr.size.x, .y = p.y, .z = p.z }) != null,
+        .right = find_adjacent_terrain(runtime, self_ent, .{ .x = p.x + self_terr.size.x, .y = p.y, .z = p.z }) != null,
+        .up = find_adjacent_terrain(runtime, self_ent, .{ .x = p.x, .y = p.y, .z = p.z - self_terr.size.y }) != null,
+        .down = find_adjacent_terrain(runtime, self_ent, .{ .x = p.x, .y = p.y, .z = p.z + self_terr.size.y }) != null,
+    };
+}
 
-    return mask;
+/// True if `other` is a chunk of the same size as `self_terr` placed at `want_pos`.
+fn is_adjacent_chunk(runtime: *EditorRuntimeState, self_terr: *const components.Terrain, other: engine.ecs_entity.Entity, want_pos: math.Vec3) bool {
+    const other_terr = runtime.registry.get_const(components.Terrain, other) orelse return false;
+    if (@abs(other_terr.size.x - self_terr.size.x) > 0.001) return false;
+    if (@abs(other_terr.size.y - self_terr.size.y) > 0.001) return false;
+    const tr = runtime.registry.get_const(components.Transform, other) orelse return false;
+    return @abs(tr.position.x - want_pos.x) <= 0.01 and @abs(tr.position.y - want_pos.y) <= 0.01 and @abs(tr.position.z - want_pos.z) <= 0.01;
 }
 
+/// Finds the terrain chunk of the same size as `self_ent` positioned at `want_pos`.
 pub fn find_adjacent_terrain(runtime: *EditorRuntimeState, self_ent: engine.ecs_entity.Entity, want_pos: math.Vec3) ?engine.ecs_entity.Entity {
-    const self_terr = runtime.registry.get(components.Terrain, self_ent) orelse return null;
+    const self_terr = runtime.registry.get_const(components.Terrain, self_ent) orelse return null;
+
+    if (terrain_spatial.terrain_chunks_near(runtime.registry, want_pos, 0.01)) |candidates| {
+        for (candidates) |other| {
+            if (other.id == self_ent.id) continue;
+            if (is_adjacent_chunk(runtime, self_terr, other, want_pos)) return other;
+        }
+        return null;
+    }
 
     var view = runtime.registry.view(components.Terrain);
-    var it = view.iterator();
+    var it = view.const_iterator();
     while (it.next()) |entry| {
         if (entry.entity.id == self_ent.id) continue;
-        const other_terr = entry.component;
-        if (@abs(other_terr.size.x - self_terr.size.x) > 0.001) continue;
-        if (@abs(other_terr.size.y - self_terr.size.y) > 0.001) continue;
-        const tr = runtime.registry.get(components.Transform, entry.entity) orelse continue;
-        if (@abs(tr.position.x - want_pos.x) <= 0.01 and @abs(tr.position.y - want_pos.y) <= 0.01 and @abs(tr.position.z - want_pos.z) <= 0.01) {
-            return entry.entity;
-        }
+        if (is_adjacent_chunk(runtime, self_terr, entry.entity, want_pos)) return entry.entity;
     }
 
     return null;
@@ -124,8 +119,8 @@ pub fn collect_connected_terrain(runtime: *EditorRuntimeState, start: engine.ecs
     out.clearRetainingCapacity();
 
     if (!runtime.registry.entity_manager.is_alive(start)) return;
-    const start_tr = runtime.registry.get(components.Transform, start) orelse return;
-    const start_terr = runtime.registry.get(components.Terrain, start) orelse return;
+    const start_tr = runtime.registry.get_const(components.Transform, start) orelse return;
+    const start_terr = runtime.registry.get_const(components.Terrain, start) orelse return;
 
     var visited: std.AutoHashMapUnmanaged(u64, void) = .{};
     defer visited.deinit(alloc);
@@ -142,8 +137,8 @@ pub fn collect_connected_terrain(runtime: *EditorRuntimeState, start: engine.ecs
         stack.items.len = idx;
 
         if (!runtime.registry.entity_manager.is_alive(e)) continue;
-        const terr = runtime.registry.get(components.Terrain, e) orelse continue;
-        const tr = runtime.registry.get(components.Transform, e) orelse continue;
+        const terr = runtime.registry.get_const(components.Terrain, e) orelse continue;
+        const tr = runtime.registry.get_const(components.Transform, e) orelse continue;
 
         if (@abs(terr.size.x - start_terr.size.x) > 0.001) continue;
         if (@abs(terr.size.y - start_terr.size.y) > 0.001) continue;
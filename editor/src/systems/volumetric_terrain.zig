@@ -8,12 +8,14 @@ const math = C.math;
 
 const lod_level_count = C.lod_level_count;
 const brick_axis_count = C.brick_axis_count;
+pub const brick_cells_base = C.brick_cells_base;
 
 const Data = @import("volumetric_terrain/data.zig");
 const Gpu = @import("volumetric_terrain/gpu.zig");
 const Bricks = @import("volumetric_terrain/bricks.zig");
 const Streaming = @import("volumetric_terrain/streaming.zig");
 const Tasks = @import("volumetric_terrain/tasks.zig");
+const Scheduler = @import("volumetric_terrain/scheduler.zig");
 const Editing = @import("volumetric_terrain/editing.zig");
 
 pub const ensure_volumetric_terrain_data_for_entity = Data.ensure_volumetric_terrain_data_for_entity;
@@ -31,15 +33,22 @@ pub fn set_streaming_hooks(hooks: StreamingHooks) void {
 pub const apply_sculpt_group = Editing.apply_sculpt_group;
 pub const apply_paint = Editing.apply_paint;
 pub const apply_paint_group = Editing.apply_paint_group;
+pub const collect_brush_group = Editing.collect_brush_group;
 
 pub const remesh_volumetric_terrain_initial = Tasks.remesh_volumetric_terrain_initial;
 pub const remesh_volumetric_terrain = Tasks.remesh_volumetric_terrain;
+/// Brick remesh queue depth, jobs in flight and request-to-mesh latency percentiles.
+pub const remesh_stats = Scheduler.stats;
+pub const reset_remesh_scheduler = Scheduler.reset;
 
-fn schedule_brick_remeshes(state: *EditorState) void {
-    Tasks.schedule_brick_remeshes(state, ensure_volumetric_terrain_data_for_entity);
+/// Runs once per frame so deferred remeshes and camera-path prefetches keep flowing without edits.
+pub fn pump_brick_remeshes(state: *EditorState) void {
+    Tasks.pump_brick_remeshes(state, ensure_volumetric_terrain_data_for_entity);
 }
 
 
+/// Picks each chunk's LOD and streaming visibility and points brick renderers at the chosen mesh.
+/// Remeshes are not scheduled here; `pump_brick_remeshes` runs right after with the new LODs.
 pub fn update_lods_and_streaming(state: *EditorState) void {
     if (!state.runtime.scene_loaded) return;
     Streaming.streaming_config = streaming_config;
@@ -69,7 +78,7 @@ pub fn update_lods_and_streaming(state: *EditorState) void {
     while (it.next()) |entry| {
         const ent = entry.entity;
         const vt = entry.component;
-        const tr = state.runtime.registry.get(components.Transform, ent) orelse continue;
+        const tr = state.runtime.registry.get_const(components.Transform, ent) orelse continue;
         ensure_brick_entities(state, ent);
 
         const dist = tr.position.sub(cam_pos).length();
@@ -86,7 +95,7 @@ pub fn update_lods_and_streaming(state: *EditorState) void {
 
         const lod: u32 = Streaming.compute_desired_lod_hysteresis(state, ent, vt, tr);
 
-        const hier = state.runtime.registry.get(components.Hierarchy, ent);
+        const hier = state.runtime.registry.get_const(components.Hierarchy, ent);
         const parent_id: u64 = if (hier) |h| if (h.parent) |p| p.id else 0 else 0;
 
         const key = Key{ .parent_id = parent_id, .x = vt.chunk_x, .y = vt.chunk_y, .z = vt.chunk_z };
@@ -168,11 +177,14 @@ pub fn update_lods_and_streaming(state: *EditorState) void {
     const meshes = state.runtime.combined_scene.meshes.?;
 
     var bview = state.runtime.registry.view(components.VolumetricTerrainBrick);
-    var bit = bview.iterator();
+    var bit = bview.const_iterator();
     while (bit.next()) |bentry| {
         const brick = bentry.component;
         const ent = bentry.entity;
-        const mr = state.runtime.registry.get(components.MeshRenderer, ent) orelse continue;
+        // Runs every frame; only a real LOD or visibility switch marks the renderer changed.
+        const mr = state.runtime.registry.get_untracked(components.MeshRenderer, ent) orelse continue;
+        const mr_before = mr.*;
+        defer if (!std.meta.eql(mr_before, mr.*)) state.runtime.registry.mark_changed(components.MeshRenderer, ent);
         const parent_ent = engine.ecs_entity.Entity{ .id = brick.parent_id };
         if (!state.runtime.registry.entity_manager.is_alive(parent_ent)) {
             mr.visible = false;
@@ -182,7 +194,7 @@ pub fn update_lods_and_streaming(state: *EditorState) void {
             mr.visible = false;
             continue;
         };
-        const tr = state.runtime.registry.get(components.Transform, parent_ent) orelse {
+        const tr = state.runtime.registry.get_const(components.Transform, parent_ent) orelse {
             mr.visible = false;
             continue;
         };
@@ -235,6 +247,4 @@ pub fn update_lods_and_streaming(state: *EditorState) void {
         }
         meshes[mr.mesh.index].visible = mr.visible;
     }
-
-    schedule_brick_remeshes(state);
 }
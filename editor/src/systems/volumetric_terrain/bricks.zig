@@ -16,18 +16,8 @@ const lod_level_count = C.lod_level_count;
 const lod_resolution = C.lod_resolution;
 
 pub fn get_model_combined_mesh_range(state: *EditorState, model_id: u32) ?struct { start: u32, count: u32 } {
-    if (state.runtime.model_manager.models == null) return null;
-    const models = state.runtime.model_manager.models.?;
-
-    var offset: u32 = 0;
-    var i: u32 = 0;
-    while (i < state.runtime.model_manager.model_count) : (i += 1) {
-        const m = &models[i];
-        if (!m.visible or m.is_loading) continue;
-        if (m.id == model_id) return .{ .start = offset, .count = m.scene.mesh_count };
-        offset += m.scene.mesh_count;
-    }
-    return null;
+    const range = C.model_manager.cardinal_model_manager_get_combined_range(&state.runtime.model_manager, model_id) orelse return null;
+    return .{ .start = range.mesh_first, .count = range.mesh_count };
 }
 
 fn get_model_mesh_for_volumetric(state: *EditorState, vt: *components.VolumetricTerrain) ?*scene.CardinalMesh {
@@ -27,7 +27,6 @@ pub const all_lods_mask: u8 = (@as(u8, 1) << @intCast(lod_level_count)) - 1;
 pub const iso_epsilon: f32 = 1e-6;
 pub const brick_cells_base: u32 = 32;
 pub const max_brick_tasks_in_flight: u32 = 8;
-pub const max_brick_tasks_to_schedule_per_update: u32 = 4;
 
 pub const CellRange = struct {
     min: u32,
@@ -5,7 +5,6 @@ const EditorState = C.EditorState;
 const VolumetricDirtyBox = C.VolumetricDirtyBox;
 const VolumetricBrickKey = C.VolumetricBrickKey;
 const memory = C.memory;
-const async_loader = C.async_loader;
 
 pub fn empty_dirty_box() VolumetricDirtyBox {
     return .{
@@ -85,20 +84,12 @@ pub fn mark_dirty_bricks_masked(state: *EditorState, entity_id: u64, box: Volume
                     state.runtime.volumetric_dirty_brick_lod_masks.put(alloc, key, lod_mask) catch {};
                 }
 
+                // A job in flight on the old generation is cancelled by the next scheduling pass.
                 if (state.runtime.volumetric_brick_generation.getPtr(key)) |g| {
                     g.* +%= 1;
                 } else {
                     state.runtime.volumetric_brick_generation.put(alloc, key, 1) catch {};
                 }
-
-                if (state.runtime.volumetric_brick_remesh_tasks.get(key)) |t| {
-                    const status = async_loader.cardinal_async_get_task_status(t);
-                    if (status == .PENDING) {
-                        _ = async_loader.cardinal_async_cancel_task(t);
-                        async_loader.cardinal_async_free_task(t);
-                        _ = state.runtime.volumetric_brick_remesh_tasks.remove(key);
-                    }
-                }
             }
         }
     }
@@ -2,7 +2,7 @@ const C = @import("common.zig");
 const Data = @import("data.zig");
 const Dirty = @import("dirty.zig");
 const Tasks = @import("tasks.zig");
-const Streaming = @import("streaming.zig");
+const terrain_spatial = @import("../terrain_spatial.zig");
 
 const std = C.std;
 const engine = C.engine;
@@ -30,8 +30,8 @@ fn brush_falloff_weight(d2: f32, r: f32, kind: i32) f32 {
 fn apply_sculpt_chunk_no_remesh(state: *EditorState, entity_id: u64, hit_world: math.Vec3, radius: f32, strength: f32, mode: i32) bool {
     const ent = engine.ecs_entity.Entity{ .id = entity_id };
     if (!state.runtime.registry.entity_manager.is_alive(ent)) return false;
-    const vt = state.runtime.registry.get(components.VolumetricTerrain, ent) orelse return false;
-    const tr = state.runtime.registry.get(components.Transform, ent) orelse return false;
+    const vt = state.runtime.registry.get_const(components.VolumetricTerrain, ent) orelse return false;
+    const tr = state.runtime.registry.get_const(components.Transform, ent) orelse return false;
     const td = Data.ensure_volumetric_terrain_data_for_entity(state, ent) orelse return false;
     if (td.dims < 2) return false;
 
@@ -222,42 +222,62 @@ fn apply_sculpt_chunk_no_remesh(state: *EditorState, entity_id: u64, hit_world:
     return touched;
 }
 
+/// True if `ent` is edited together with the seed chunk: same resolution and size, and the same
+/// parent (or the seed itself when it has none).
+fn in_brush_group(state: *EditorState, seed_ent: engine.ecs_entity.Entity, seed_vt: *const components.VolumetricTerrain, seed_parent: ?engine.ecs_entity.Entity, ent: engine.ecs_entity.Entity) bool {
+    const vt = state.runtime.registry.get_const(components.VolumetricTerrain, ent) orelse return false;
+    if (vt.resolution != seed_vt.resolution) return false;
+    if (@abs(vt.size.x - seed_vt.size.x) > 0.001) return false;
+    if (@abs(vt.size.y - seed_vt.size.y) > 0.001) return false;
+    if (@abs(vt.size.z - seed_vt.size.z) > 0.001) return false;
+
+    if (seed_parent) |p| {
+        const h = state.runtime.registry.get_const(components.Hierarchy, ent) orelse return false;
+        return h.parent != null and h.parent.?.id == p.id;
+    }
+    return ent.id == seed_ent.id;
+}
+
+/// Collects the chunks of `seed_ent`'s brush group that a brush sphere at `center` touches.
+/// Candidates come from the volumetric chunk index; a linear scan is the fallback.
+pub fn collect_brush_group(state: *EditorState, seed_ent: engine.ecs_entity.Entity, center: math.Vec3, radius: f32, alloc: std.mem.Allocator, out: *std.ArrayListUnmanaged(engine.ecs_entity.Entity)) void {
+    out.clearRetainingCapacity();
+    const seed_vt = state.runtime.registry.get_const(components.VolumetricTerrain, seed_ent) orelse return;
+    const seed_hier = state.runtime.registry.get_const(components.Hierarchy, seed_ent);
+    const seed_parent = if (seed_hier) |h| h.parent else null;
+
+    if (terrain_spatial.volumetric_chunks_in_sphere(state.runtime.registry, center, radius)) |candidates| {
+        for (candidates) |ent| {
+            if (in_brush_group(state, seed_ent, seed_vt, seed_parent, ent)) out.append(alloc, ent) catch {};
+        }
+        return;
+    }
+
+    var view = state.runtime.registry.view(components.VolumetricTerrain);
+    var it = view.const_iterator();
+    while (it.next()) |entry| {
+        if (!in_brush_group(state, seed_ent, seed_vt, seed_parent, entry.entity)) continue;
+        const tr = state.runtime.registry.get_const(components.Transform, entry.entity) orelse continue;
+        const half = entry.component.size.mul(0.5);
+        const box = math.AABB{ .min = tr.position.sub(half), .max = tr.position.add(half) };
+        if (!engine.ecs_spatial_index.sphere_intersects_aabb(center, radius, box)) continue;
+        out.append(alloc, entry.entity) catch {};
+    }
+}
+
 pub fn apply_sculpt_group(state: *EditorState, seed_entity_id: u64, hit_world: math.Vec3, radius: f32, strength: f32, mode: i32) void {
     const seed_ent = engine.ecs_entity.Entity{ .id = seed_entity_id };
     if (!state.runtime.registry.entity_manager.is_alive(seed_ent)) return;
-    const seed_vt = state.runtime.registry.get(components.VolumetricTerrain, seed_ent) orelse return;
-    const seed_hier = state.runtime.registry.get(components.Hierarchy, seed_ent);
-    const seed_parent = if (seed_hier) |h| h.parent else null;
 
     const alloc = memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
     var touched = std.ArrayListUnmanaged(u64){};
     defer touched.deinit(alloc);
 
     const r = @max(0.001, radius);
-    var view = state.runtime.registry.view(components.VolumetricTerrain);
-    var it = view.iterator();
-    while (it.next()) |entry| {
-        const ent = entry.entity;
-        const vt = entry.component;
-        if (vt.resolution != seed_vt.resolution) continue;
-        if (@abs(vt.size.x - seed_vt.size.x) > 0.001) continue;
-        if (@abs(vt.size.y - seed_vt.size.y) > 0.001) continue;
-        if (@abs(vt.size.z - seed_vt.size.z) > 0.001) continue;
-
-        if (seed_parent) |p| {
-            const h = state.runtime.registry.get(components.Hierarchy, ent) orelse continue;
-            if (h.parent == null or h.parent.?.id != p.id) continue;
-        } else {
-            if (ent.id != seed_ent.id) continue;
-        }
-
-        const tr = state.runtime.registry.get(components.Transform, ent) orelse continue;
-
-        const half = vt.size.mul(0.5);
-        const aabb_min = tr.position.sub(half);
-        const aabb_max = tr.position.add(half);
-        if (!Streaming.sphere_intersects_aabb(hit_world, r, aabb_min, aabb_max)) continue;
-
+    var group = std.ArrayListUnmanaged(engine.ecs_entity.Entity){};
+    defer group.deinit(alloc);
+    collect_brush_group(state, seed_ent, hit_world, r, alloc, &group);
+    for (group.items) |ent| {
         if (apply_sculpt_chunk_no_remesh(state, ent.id, hit_world, r, strength, mode)) {
             touched.append(alloc, ent.id) catch {};
         }
@@ -275,8 +295,8 @@ pub fn apply_sculpt_group(state: *EditorState, seed_entity_id: u64, hit_world: m
 fn apply_paint_chunk_no_remesh(state: *EditorState, entity_id: u64, hit_world: math.Vec3, radius: f32, strength: f32, layer: u32, erase: bool) bool {
     const ent = engine.ecs_entity.Entity{ .id = entity_id };
     if (!state.runtime.registry.entity_manager.is_alive(ent)) return false;
-    const vt = state.runtime.registry.get(components.VolumetricTerrain, ent) orelse return false;
-    const tr = state.runtime.registry.get(components.Transform, ent) orelse return false;
+    const vt = state.runtime.registry.get_const(components.VolumetricTerrain, ent) orelse return false;
+    const tr = state.runtime.registry.get_const(components.Transform, ent) orelse return false;
     const td = Data.ensure_volumetric_terrain_data_for_entity(state, ent) orelse return false;
     if (td.dims < 2) return false;
 
@@ -411,39 +431,16 @@ pub fn apply_paint(state: *EditorState, entity_id: u64, hit_world: math.Vec3, ra
 pub fn apply_paint_group(state: *EditorState, seed_entity_id: u64, hit_world: math.Vec3, radius: f32, strength: f32, layer: u32, erase: bool) void {
     const seed_ent = engine.ecs_entity.Entity{ .id = seed_entity_id };
     if (!state.runtime.registry.entity_manager.is_alive(seed_ent)) return;
-    const seed_vt = state.runtime.registry.get(components.VolumetricTerrain, seed_ent) orelse return;
-    const seed_hier = state.runtime.registry.get(components.Hierarchy, seed_ent);
-    const seed_parent = if (seed_hier) |h| h.parent else null;
 
     const alloc = memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
     var touched = std.ArrayListUnmanaged(u64){};
     defer touched.deinit(alloc);
 
     const r = @max(0.001, radius);
-    var view = state.runtime.registry.view(components.VolumetricTerrain);
-    var it = view.iterator();
-    while (it.next()) |entry| {
-        const ent = entry.entity;
-        const vt = entry.component;
-        if (vt.resolution != seed_vt.resolution) continue;
-        if (@abs(vt.size.x - seed_vt.size.x) > 0.001) continue;
-        if (@abs(vt.size.y - seed_vt.size.y) > 0.001) continue;
-        if (@abs(vt.size.z - seed_vt.size.z) > 0.001) continue;
-
-        if (seed_parent) |p| {
-            const h = state.runtime.registry.get(components.Hierarchy, ent) orelse continue;
-            if (h.parent == null or h.parent.?.id != p.id) continue;
-        } else {
-            if (ent.id != seed_ent.id) continue;
-        }
-
-        const tr = state.runtime.registry.get(components.Transform, ent) orelse continue;
-
-        const half = vt.size.mul(0.5);
-        const aabb_min = tr.position.sub(half);
-        const aabb_max = tr.position.add(half);
-        if (!Streaming.sphere_intersects_aabb(hit_world, r, aabb_min, aabb_max)) continue;
-
+    var group = std.ArrayListUnmanaged(engine.ecs_entity.Entity){};
+    defer group.deinit(alloc);
+    collect_brush_group(state, seed_ent, hit_world, r, alloc, &group);
+    for (group.items) |ent| {
         if (apply_paint_chunk_no_remesh(state, ent.id, hit_world, r, strength, layer, erase)) {
             touched.append(alloc, ent.id) catch {};
         }
@@ -0,0 +1,64 @@
+//! Remesh queue and camera prediction for volumetric terrain bricks.
+//!
+//! `tasks.zig` feeds dirty bricks into the queue on every scheduling pass and submits what the
+//! per-frame budget allows; the camera predictor is sampled on the same passes.
+const C = @import("common.zig");
+
+const std = C.std;
+const math = C.math;
+const EditorState = C.EditorState;
+const remesh = C.engine.remesh_scheduler;
+
+pub const BrickQueue = remesh.RemeshQueue(C.VolumetricBrickKey);
+pub const Request = remesh.Request;
+pub const Stats = remesh.Stats;
+
+pub var budget: remesh.Budget = .{
+    .frame_time_ns = 2 * std.time.ns_per_ms,
+    .memory_bytes = 256 * 1024 * 1024,
+    .max_in_flight = C.max_brick_tasks_in_flight,
+};
+/// How far ahead (seconds) bricks are prefetched along the camera's motion.
+pub var prefetch_horizon_s: f32 = 0.75;
+/// Viewport height the screen-space error is measured against.
+pub var reference_viewport_height: f32 = 1080.0;
+
+var queue: ?BrickQueue = null;
+var camera: remesh.CameraPredictor = .{};
+var clock: ?std.time.Timer = null;
+
+/// Monotonic nanoseconds for queue timestamps and latencies.
+pub fn now_ns() u64 {
+    if (clock == null) clock = std.time.Timer.start() catch return 0;
+    return clock.?.read();
+}
+
+pub fn brick_queue() *BrickQueue {
+    if (queue == null) {
+        queue = BrickQueue.init(C.memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator(), budget);
+    }
+    queue.?.budget = budget;
+    return &queue.?;
+}
+
+/// Samples the editor camera and returns the view requests are ranked against this pass.
+pub fn update_view(state: *const EditorState) remesh.View {
+    const cam = &state.runtime.camera;
+    camera.update(cam.position, now_ns());
+    return .{
+        .position = cam.position,
+        .predicted = camera.predict(prefetch_horizon_s),
+        .projection_scale = remesh.projection_scale(math.toRadians(cam.fov), reference_viewport_height),
+    };
+}
+
+pub fn stats() Stats {
+    return if (queue) |*q| q.stats() else .{};
+}
+
+/// Drops queued requests and camera history, e.g. when the project closes.
+pub fn reset() void {
+    if (queue) |*q| q.deinit();
+    queue = null;
+    camera = .{};
+}
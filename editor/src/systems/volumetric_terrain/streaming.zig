@@ -25,23 +25,14 @@ pub fn set_streaming_hooks(hooks: StreamingHooks) void {
     g_streaming_hooks = hooks;
 }
 
-pub fn sphere_intersects_aabb(center: math.Vec3, radius: f32, aabb_min: math.Vec3, aabb_max: math.Vec3) bool {
-    var d2: f32 = 0.0;
-    const c = [3]f32{ center.x, center.y, center.z };
-    const mn = [3]f32{ aabb_min.x, aabb_min.y, aabb_min.z };
-    const mx = [3]f32{ aabb_max.x, aabb_max.y, aabb_max.z };
-    var i: usize = 0;
-    while (i < 3) : (i += 1) {
-        const v = c[i];
-        if (v < mn[i]) {
-            const diff = mn[i] - v;
-            d2 += diff * diff;
-        } else if (v > mx[i]) {
-            const diff = v - mx[i];
-            d2 += diff * diff;
-        }
-    }
-    return d2 <= radius * radius;
+/// LOD a chunk calls for with the camera at `camera_pos`, without hysteresis. Used to prefetch
+/// bricks for where the camera is heading.
+pub fn lod_for_camera_position(vt: *const C.components.VolumetricTerrain, tr: *const C.components.Transform, camera_pos: math.Vec3) u32 {
+    const dist = tr.position.sub(camera_pos).length();
+    const base_size = @max(vt.size.x, @max(vt.size.y, vt.size.z));
+    if (dist <= base_size * streaming_config.lod0_distance_multiplier) return 0;
+    if (dist <= base_size * streaming_config.lod1_distance_multiplier) return @min(1, C.lod_level_count - 1);
+    return C.lod_level_count - 1;
 }
 
 pub fn compute_desired_lod_hysteresis(state: *EditorState, ent: C.engine.ecs_entity.Entity, vt: *const C.components.VolumetricTerrain, tr: *const C.components.Transform) u32 {
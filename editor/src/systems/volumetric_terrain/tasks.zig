@@ -3,6 +3,8 @@ const Dirty = @import("dirty.zig");
 const Data = @import("data.zig");
 const Bricks = @import("bricks.zig");
 const Meshing = @import("meshing.zig");
+const Streaming = @import("streaming.zig");
+const Scheduler = @import("scheduler.zig");
 
 const std = C.std;
 const engine = C.engine;
@@ -127,7 +129,7 @@ fn release_density_snapshot(state: *EditorState, key: VolumetricDensitySnapshotK
 
     const ent = engine.ecs_entity.Entity{ .id = key.entity_id };
     if (state.runtime.registry.entity_manager.is_alive(ent)) {
-        if (state.runtime.registry.get(components.VolumetricTerrain, ent)) |vt| {
+        if (state.runtime.registry.get_const(components.VolumetricTerrain, ent)) |vt| {
             if (vt.data_id == key.data_id) return;
         }
     }
@@ -274,11 +276,12 @@ fn brick_task_callback(task_opt: ?*async_loader.CardinalAsyncTask, user_data: ?*
         }
     }.f;
 
-    if (cur_gen != job.generation) {
+    const current = cur_gen == job.generation;
+    if (!current) {
         free_tile_outputs(alloc, job.tile_outputs);
         job.tile_outputs = @constCast(&[_]BrickTileOutput{});
     } else if (ok and state.ui.project_loaded and state.runtime.registry.entity_manager.is_alive(ent)) {
-        if (state.runtime.registry.get(components.VolumetricTerrain, ent)) |vt| {
+        if (state.runtime.registry.get_const(components.VolumetricTerrain, ent)) |vt| {
             const bcount = C.brick_count(job.base_res);
             const mesh_index = vt.mesh_index + job.lod * bcount + job.key.brick_id;
             const model = model_manager.cardinal_model_manager_get_model(&state.runtime.model_manager, job.model_id) orelse null;
@@ -312,6 +315,8 @@ fn brick_task_callback(task_opt: ?*async_loader.CardinalAsyncTask, user_data: ?*
                         }
 
                         const cache = state.runtime.volumetric_brick_tile_cache.getPtr(key_lod) orelse {
+                            requeue_brick_lod(state, job.key, job.dirty_box, job.lod);
+                            Scheduler.brick_queue().cancelled(job.key);
                             free_tile_outputs(alloc, job.tile_outputs);
                             release_density_snapshot(state, job.snapshot_key);
                             alloc.destroy(job);
@@ -408,7 +413,7 @@ fn brick_task_callback(task_opt: ?*async_loader.CardinalAsyncTask, user_data: ?*
                 }
             }
         }
-    } else if (!ok) {
+    } else if (!ok and task.status != .CANCELLED) {
         const dirty_ptr = state.runtime.volumetric_dirty_brick_boxes.getPtr(job.key) orelse null;
         if (dirty_ptr != null) {
             const mask_ptr = state.runtime.volumetric_dirty_brick_lod_masks.getPtr(job.key) orelse null;
@@ -416,6 +421,16 @@ fn brick_task_callback(task_opt: ?*async_loader.CardinalAsyncTask, user_data: ?*
         }
     }
 
+    const queue = Scheduler.brick_queue();
+    if (current and ok) {
+        queue.complete(job.key, Scheduler.now_ns());
+    } else {
+        if ((!current or task.status == .CANCELLED) and state.ui.project_loaded and state.runtime.registry.entity_manager.is_alive(ent)) {
+            requeue_brick_lod(state, job.key, job.dirty_box, job.lod);
+        }
+        queue.cancelled(job.key);
+    }
+
     if (job.tile_outputs.len != 0) {
         free_tile_outputs(alloc, job.tile_outputs);
     }
@@ -425,157 +440,252 @@ fn brick_task_callback(task_opt: ?*async_loader.CardinalAsyncTask, user_data: ?*
     async_loader.cardinal_async_free_task(task);
 }
 
-pub fn schedule_brick_remeshes(state: *EditorState, ensure_vt_data: *const fn (*EditorState, engine.ecs_entity.Entity) ?*VolumetricTerrainData) void {
-    if (!state.ui.project_loaded) return;
-    if (!async_loader.cardinal_async_loader_is_initialized()) return;
+/// Memory a brick job is charged against the remesh budget: a new density/splat snapshot if the
+/// chunk has none yet, plus a rough surface-sized mesh output.
+fn brick_job_bytes(state: *const EditorState, entity_id: u64, vt: *const components.VolumetricTerrain, lod: u32) u64 {
+    const cells: u64 = C.brick_cells_for_lod(lod);
+    var bytes: u64 = 2 * cells * cells * (@sizeOf(scene.CardinalVertex) + 6 * @sizeOf(u32));
+    const snapshot_key = VolumetricDensitySnapshotKey{ .entity_id = entity_id, .data_id = vt.data_id };
+    if (!state.runtime.volumetric_density_snapshots.contains(snapshot_key)) {
+        const dims: u64 = @as(u64, @max(vt.resolution, 1)) + 1;
+        bytes += dims * dims * dims * (@sizeOf(f32) + 4);
+    }
+    return bytes;
+}
+
+/// Remesh request for a brick at `lod`. Edits are weighted by the edited extent, prefetches by the
+/// detail the mesh on screen (at `shown_lod`) is missing.
+fn brick_request(state: *const EditorState, key: VolumetricBrickKey, vt: *const components.VolumetricTerrain, tr: *const components.Transform, lod: u32, shown_lod: u32, prefetch: bool) Scheduler.Request {
+    const res: u32 = @max(vt.resolution, 1);
+    const res_f: f32 = @floatFromInt(res);
+    const coords = C.brick_id_to_coords(C.brick_axis_count(res), key.brick_id);
+    const brick_size = vt.size.mul(@as(f32, @floatFromInt(C.brick_cells_base)) / res_f);
+    const origin = tr.position.sub(vt.size.mul(0.5));
+    const center = C.math.Vec3{
+        .x = origin.x + (@as(f32, @floatFromInt(coords.bx)) + 0.5) * brick_size.x,
+        .y = origin.y + (@as(f32, @floatFromInt(coords.by)) + 0.5) * brick_size.y,
+        .z = origin.z + (@as(f32, @floatFromInt(coords.bz)) + 0.5) * brick_size.z,
+    };
+    const cell = @max(vt.size.x, @max(vt.size.y, vt.size.z)) / res_f;
+    const brick_extent = @max(brick_size.x, @max(brick_size.y, brick_size.z));
+
+    var geometric_error = cell * @as(f32, @floatFromInt(@as(u32, 1) << @intCast(@min(shown_lod, 30))));
+    if (!prefetch) {
+        geometric_error = brick_extent;
+        if (state.runtime.volumetric_dirty_brick_boxes.get(key)) |b| {
+            if (Dirty.dirty_box_is_valid(b)) {
+                const span = @max(b.max_x - b.min_x, @max(b.max_y - b.min_y, b.max_z - b.min_z)) + 1;
+                geometric_error = @min(brick_extent, @as(f32, @floatFromInt(span)) * cell);
+            }
+        }
+    }
+
+    const selected = state.ui.selected_entity;
+    const is_selected = state.runtime.registry.entity_manager.is_alive(selected) and selected.id == key.entity_id;
+    return .{
+        .center = center,
+        .radius = brick_size.length() * 0.5,
+        .geometric_error = geometric_error,
+        .bytes = brick_job_bytes(state, key.entity_id, vt, lod),
+        .prefetch = prefetch,
+        .bias = if (is_selected) 100000.0 else 0.0,
+        .generation = state.runtime.volumetric_brick_generation.get(key) orelse 0,
+        .lod = @intCast(lod),
+    };
+}
 
+/// Puts a brick LOD back on the dirty list after its job was cancelled or made stale, so the
+/// region it covered is meshed again from the newest data.
+fn requeue_brick_lod(state: *EditorState, key: VolumetricBrickKey, box: VolumetricDirtyBox, lod: u32) void {
     const alloc = memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
-    const now_ms_i64: i64 = std.time.milliTimestamp();
-    const now_ms: u64 = if (now_ms_i64 <= 0) 0 else @intCast(now_ms_i64);
-    if (state.runtime.volumetric_brick_remesh_tasks.count() >= C.max_brick_tasks_in_flight) return;
+    if (state.runtime.volumetric_dirty_brick_boxes.getPtr(key)) |existing| {
+        existing.* = Dirty.dirty_union(existing.*, box);
+    } else {
+        state.runtime.volumetric_dirty_brick_boxes.put(alloc, key, box) catch {};
+    }
+    if (state.runtime.volumetric_dirty_brick_lod_masks.getPtr(key)) |m| {
+        m.* |= C.lod_bit(lod);
+    } else {
+        state.runtime.volumetric_dirty_brick_lod_masks.put(alloc, key, C.lod_bit(lod)) catch {};
+    }
+}
 
-    const Candidate = struct { key: VolumetricBrickKey, score: f32 };
-    var candidates: std.ArrayListUnmanaged(Candidate) = .{};
-    defer candidates.deinit(state.runtime.arena_allocator);
+/// Cancels brick jobs that have not started but would mesh an outdated density snapshot: the
+/// brick was edited again or the chunk's data was replaced. Cancelled jobs come back through
+/// `brick_task_callback`. Jobs that are already running finish and are dropped there.
+fn cancel_stale_brick_tasks(state: *EditorState, queue: *Scheduler.BrickQueue) void {
+    while (queue.pop_stale()) |key| {
+        if (state.runtime.volumetric_brick_remesh_tasks.get(key)) |task| {
+            _ = async_loader.cardinal_async_cancel_task(task);
+        }
+    }
+
+    var it = state.runtime.volumetric_brick_remesh_tasks.iterator();
+    while (it.next()) |entry| {
+        const task = entry.value_ptr.*;
+        if (async_loader.cardinal_async_get_task_status(task) != .PENDING) continue;
+        const job: *const BrickRemeshJobData = @ptrCast(@alignCast(task.custom_data orelse continue));
+        const ent = engine.ecs_entity.Entity{ .id = job.key.entity_id };
+        const current = if (state.runtime.registry.get_const(components.VolumetricTerrain, ent)) |vt| vt.data_id == job.data_id else false;
+        if (!current) _ = async_loader.cardinal_async_cancel_task(task);
+    }
+
+    // Jobs cancelled and freed elsewhere (e.g. with their chunk) never reach the callback.
+    var gone: std.ArrayListUnmanaged(VolumetricBrickKey) = .{};
+    defer gone.deinit(state.runtime.arena_allocator);
+    var keys = queue.in_flight_keys();
+    while (keys.next()) |key| {
+        if (!state.runtime.volumetric_brick_remesh_tasks.contains(key.*)) gone.append(state.runtime.arena_allocator, key.*) catch {};
+    }
+    for (gone.items) |key| queue.cancelled(key);
+}
+
+/// Snapshots the chunk's density and submits a job meshing `key` at `lod`. False if the brick no
+/// longer needs it or the job could not be started.
+fn submit_brick_remesh(state: *EditorState, ensure_vt_data: *const fn (*EditorState, engine.ecs_entity.Entity) ?*VolumetricTerrainData, key: VolumetricBrickKey, lod: u32) bool {
+    const alloc = memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
+    const mask = state.runtime.volumetric_dirty_brick_lod_masks.get(key) orelse return false;
+    if (mask & C.lod_bit(lod) == 0) return false;
+    if (state.runtime.volumetric_brick_remesh_tasks.get(key) != null) return false;
+
+    const ent = engine.ecs_entity.Entity{ .id = key.entity_id };
+    if (!state.runtime.registry.entity_manager.is_alive(ent)) return false;
+    const vt = state.runtime.registry.get_const(components.VolumetricTerrain, ent) orelse return false;
 
-    var per_entity_scheduled: std.AutoHashMapUnmanaged(u64, u32) = .{};
-    defer per_entity_scheduled.deinit(state.runtime.arena_allocator);
+    const td = ensure_vt_data(state, ent) orelse return false;
+    if (td.dims < 2) return false;
+    const base_res: u32 = td.dims - 1;
+    if (base_res < 1) return false;
+
+    const dirty_box: VolumetricDirtyBox = state.runtime.volumetric_dirty_brick_boxes.get(key) orelse VolumetricDirtyBox{
+        .min_x = 0,
+        .min_y = 0,
+        .min_z = 0,
+        .max_x = base_res - 1,
+        .max_y = base_res - 1,
+        .max_z = base_res - 1,
+    };
+
+    const snapshot = acquire_density_snapshot(state, ent, vt, td) orelse return false;
+
+    const key_lod = VolumetricBrickLodKey{ .entity_id = key.entity_id, .brick_id = key.brick_id, .lod = @intCast(lod) };
+    const full_rebuild = state.runtime.volumetric_brick_tile_cache.get(key_lod) == null;
+
+    const job = alloc.create(BrickRemeshJobData) catch {
+        release_density_snapshot(state, snapshot.key);
+        return false;
+    };
+    job.* = .{
+        .key = key,
+        .generation = state.runtime.volumetric_brick_generation.get(key) orelse 0,
+        .dirty_box = dirty_box,
+        .model_id = vt.model_id,
+        .base_mesh_index = vt.mesh_index,
+        .size = vt.size,
+        .base_res = base_res,
+        .base_dims = td.dims,
+        .axis = C.brick_axis_count(base_res),
+        .lod = lod,
+        .full_rebuild = full_rebuild,
+        .data_id = vt.data_id,
+        .density = snapshot.density,
+        .splat = snapshot.splat,
+        .snapshot_key = snapshot.key,
+        .tile_outputs = @constCast(&[_]BrickTileOutput{}),
+    };
+
+    const task = async_loader.cardinal_async_submit_custom_task(
+        brick_task_func,
+        job,
+        .NORMAL,
+        brick_task_callback,
+        state,
+    ) orelse {
+        alloc.destroy(job);
+        release_density_snapshot(state, snapshot.key);
+        return false;
+    };
+
+    state.runtime.volumetric_brick_remesh_tasks.put(alloc, key, task) catch {};
+    if (state.runtime.volumetric_dirty_brick_lod_masks.getPtr(key)) |m| {
+        m.* &= ~C.lod_bit(lod);
+        if (m.* == 0) _ = state.runtime.volumetric_dirty_brick_lod_masks.remove(key);
+    }
+    _ = state.runtime.volumetric_dirty_brick_boxes.remove(key);
+    return true;
+}
+
+/// Feeds dirty bricks into the remesh queue and submits as many jobs as what is left of this
+/// frame's budget allows. A brick is meshed at its chunk's current LOD, or prefetched at the LOD its chunk will
+/// want once the camera reaches its predicted position.
+pub fn schedule_brick_remeshes(state: *EditorState, ensure_vt_data: *const fn (*EditorState, engine.ecs_entity.Entity) ?*VolumetricTerrainData) void {
+    if (!state.ui.project_loaded) return;
+    if (!async_loader.cardinal_async_loader_is_initialized()) return;
+
+    const queue = Scheduler.brick_queue();
+    const view = Scheduler.update_view(state);
+    const now = Scheduler.now_ns();
 
     {
         var it = state.runtime.volumetric_dirty_brick_lod_masks.iterator();
         while (it.next()) |entry| {
             const key = entry.key_ptr.*;
             const mask = entry.value_ptr.*;
-            if (mask == 0) continue;
-            if (state.runtime.volumetric_brick_remesh_tasks.get(key) != null) continue;
-
             const ent = engine.ecs_entity.Entity{ .id = key.entity_id };
-            if (!state.runtime.registry.entity_manager.is_alive(ent)) continue;
-            const tr = state.runtime.registry.get(components.Transform, ent) orelse continue;
-
             const visible = state.runtime.volumetric_visible_by_entity.get(ent.id) orelse true;
-            if (!visible) continue;
-
-            const desired_lod_u8 = state.runtime.volumetric_lod_by_entity.get(ent.id) orelse 0;
-            const desired_lod: u32 = desired_lod_u8;
-            const lod_mask = mask & C.lod_bit(desired_lod);
-            if (lod_mask == 0) continue;
-
-            const dist = tr.position.sub(state.runtime.camera.position).length();
-            var score: f32 = 1000.0 / (dist + 1.0);
-            score += @as(f32, @floatFromInt(C.lod_level_count - 1 - desired_lod)) * 5.0;
-            if (state.runtime.registry.entity_manager.is_alive(state.ui.selected_entity) and state.ui.selected_entity.id == ent.id) {
-                score += 100000.0;
+            if (mask == 0 or !visible or !state.runtime.registry.entity_manager.is_alive(ent)) {
+                queue.cancel(key);
+                continue;
+            }
+            const vt = state.runtime.registry.get_const(components.VolumetricTerrain, ent) orelse {
+                queue.cancel(key);
+                continue;
+            };
+            const tr = state.runtime.registry.get_const(components.Transform, ent) orelse {
+                queue.cancel(key);
+                continue;
+            };
+
+            const desired_lod: u32 = state.runtime.volumetric_lod_by_entity.get(ent.id) orelse 0;
+            var lod = desired_lod;
+            var prefetch = false;
+            if (mask & C.lod_bit(desired_lod) == 0) {
+                const ahead = Streaming.lod_for_camera_position(vt, tr, view.predicted);
+                if (ahead == desired_lod or mask & C.lod_bit(ahead) == 0) {
+                    queue.cancel(key);
+                    continue;
+                }
+                lod = ahead;
+                prefetch = true;
             }
-            candidates.append(state.runtime.arena_allocator, .{ .key = key, .score = score }) catch {};
+            queue.request(key, brick_request(state, key, vt, tr, lod, desired_lod, prefetch), now) catch continue;
         }
     }
 
-    if (candidates.items.len == 0) return;
+    cancel_stale_brick_tasks(state, queue);
 
-    std.sort.pdq(Candidate, candidates.items, {}, struct {
-        fn lessThan(_: void, a: Candidate, b: Candidate) bool {
-            return a.score > b.score;
+    queue.begin_pass(view, now) catch return;
+    while (queue.next(Scheduler.now_ns())) |ticket| {
+        if (submit_brick_remesh(state, ensure_vt_data, ticket.key, ticket.request.lod)) {
+            queue.dispatched(ticket.key) catch {
+                // Untracked jobs would slip past the budget; the cancelled job requeues the brick.
+                if (state.runtime.volumetric_brick_remesh_tasks.get(ticket.key)) |task| {
+                    _ = async_loader.cardinal_async_cancel_task(task);
+                }
+            };
+        } else {
+            queue.cancel(ticket.key);
         }
-    }.lessThan);
-
-    var scheduled: u32 = 0;
-    var idx: usize = 0;
-    while (idx < candidates.items.len) : (idx += 1) {
-        if (scheduled >= C.max_brick_tasks_to_schedule_per_update) break;
-        if (state.runtime.volumetric_brick_remesh_tasks.count() >= C.max_brick_tasks_in_flight) break;
-
-        const key = candidates.items[idx].key;
-        const mask_ptr = state.runtime.volumetric_dirty_brick_lod_masks.getPtr(key) orelse continue;
-        const mask = mask_ptr.*;
-        if (mask == 0) continue;
-        if (state.runtime.volumetric_brick_remesh_tasks.get(key) != null) continue;
-
-        const ent = engine.ecs_entity.Entity{ .id = key.entity_id };
-        if (!state.runtime.registry.entity_manager.is_alive(ent)) continue;
-        const vt = state.runtime.registry.get(components.VolumetricTerrain, ent) orelse continue;
-
-        const visible = state.runtime.volumetric_visible_by_entity.get(ent.id) orelse true;
-        if (!visible) continue;
-
-        const selected = state.ui.selected_entity;
-        const is_selected = state.runtime.registry.entity_manager.is_alive(selected) and selected.id == ent.id;
-        const per_entity_count: u32 = per_entity_scheduled.get(ent.id) orelse 0;
-        if (!is_selected and per_entity_count >= 2) continue;
-
-        const last_ms = state.runtime.volumetric_brick_last_schedule_ms.get(key) orelse 0;
-        if (!is_selected and last_ms != 0 and now_ms > last_ms and (now_ms - last_ms) < 50) continue;
-
-        const desired_lod_u8 = state.runtime.volumetric_lod_by_entity.get(ent.id) orelse 0;
-        const desired_lod: u32 = desired_lod_u8;
-        const lod_mask = mask & C.lod_bit(desired_lod);
-        if (lod_mask == 0) continue;
-
-        const td = ensure_vt_data(state, ent) orelse continue;
-        if (td.dims < 2) continue;
-        const base_res: u32 = td.dims - 1;
-        if (base_res < 1) continue;
-
-        const dirty_box: VolumetricDirtyBox = state.runtime.volumetric_dirty_brick_boxes.get(key) orelse VolumetricDirtyBox{
-            .min_x = 0,
-            .min_y = 0,
-            .min_z = 0,
-            .max_x = base_res - 1,
-            .max_y = base_res - 1,
-            .max_z = base_res - 1,
-        };
-
-        const snapshot = acquire_density_snapshot(state, ent, vt, td) orelse continue;
-
-        const key_lod = VolumetricBrickLodKey{ .entity_id = key.entity_id, .brick_id = key.brick_id, .lod = @intCast(desired_lod) };
-        const full_rebuild = state.runtime.volumetric_brick_tile_cache.get(key_lod) == null;
-
-        const job = alloc.create(BrickRemeshJobData) catch {
-            release_density_snapshot(state, snapshot.key);
-            continue;
-        };
-        job.* = .{
-            .key = key,
-            .generation = state.runtime.volumetric_brick_generation.get(key) orelse 0,
-            .dirty_box = dirty_box,
-            .model_id = vt.model_id,
-            .base_mesh_index = vt.mesh_index,
-            .size = vt.size,
-            .base_res = base_res,
-            .base_dims = td.dims,
-            .axis = C.brick_axis_count(base_res),
-            .lod = desired_lod,
-            .full_rebuild = full_rebuild,
-            .data_id = vt.data_id,
-            .density = snapshot.density,
-            .splat = snapshot.splat,
-            .snapshot_key = snapshot.key,
-            .tile_outputs = @constCast(&[_]BrickTileOutput{}),
-        };
-
-        const task = async_loader.cardinal_async_submit_custom_task(
-            brick_task_func,
-            job,
-            .NORMAL,
-            brick_task_callback,
-            state,
-        ) orelse {
-            alloc.destroy(job);
-            release_density_snapshot(state, snapshot.key);
-            continue;
-        };
-
-        state.runtime.volumetric_brick_remesh_tasks.put(alloc, key, task) catch {};
-        state.runtime.volumetric_brick_last_schedule_ms.put(alloc, key, now_ms) catch {};
-        per_entity_scheduled.put(state.runtime.arena_allocator, ent.id, per_entity_count + 1) catch {};
-
-        mask_ptr.* &= ~C.lod_bit(desired_lod);
-        if (mask_ptr.* == 0) _ = state.runtime.volumetric_dirty_brick_lod_masks.remove(key);
-        _ = state.runtime.volumetric_dirty_brick_boxes.remove(key);
-        scheduled += 1;
     }
 }
 
+/// Per-frame entry point: starts the frame's remesh budget and schedules deferred and prefetch
+/// requests even on frames without edits. Edits later in the frame share the same budget.
+pub fn pump_brick_remeshes(state: *EditorState, ensure_vt_data: *const fn (*EditorState, engine.ecs_entity.Entity) ?*VolumetricTerrainData) void {
+    Scheduler.brick_queue().start_frame();
+    schedule_brick_remeshes(state, ensure_vt_data);
+}
+
 pub fn remesh_volumetric_terrain_initial(state: *EditorState, entity_id: u64) void {
     const ent = engine.ecs_entity.Entity{ .id = entity_id };
     if (!state.runtime.registry.entity_manager.is_alive(ent)) return;
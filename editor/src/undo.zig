@@ -1031,17 +1031,8 @@ fn apply_terrain_tex_rect_edit(runtime: anytype, p: *TerrainTexRectEditCommand,
 }
 
 fn get_model_combined_mesh_range(runtime: anytype, model_id: u32) ?struct { start: u32, count: u32 } {
-    if (runtime.model_manager.models == null) return null;
-    const models = runtime.model_manager.models.?;
-    var offset: u32 = 0;
-    var i: u32 = 0;
-    while (i < runtime.model_manager.model_count) : (i += 1) {
-        const m = &models[i];
-        if (!m.visible or m.is_loading) continue;
-        if (m.id == model_id) return .{ .start = offset, .count = m.scene.mesh_count };
-        offset += m.scene.mesh_count;
-    }
-    return null;
+    const range = model_manager.cardinal_model_manager_get_combined_range(&runtime.model_manager, model_id) orelse return null;
+    return .{ .start = range.mesh_first, .count = range.mesh_count };
 }
 
 fn apply_entity_component(runtime: anytype, comptime T: type, c: EntityComponentCommand(T), forward: bool) void {
@@ -0,0 +1,172 @@
+//! Animation state machine evaluation for many controllers.
+//!
+//! Builds 1000 characters, each with its own animation system and a controller running a
+//! locomotion graph (nested 1D blends), a jump state and an aiming state. Parameters change every
+//! frame so transitions fire regularly. Compares a plain loop over
+//! `cardinal_anim_controller_update` with `cardinal_anim_controller_update_batch` on the job
+//! system. Clips carry no channels, so this measures graph evaluation rather than pose sampling.
+const std = @import("std");
+const engine = @import("cardinal_engine");
+const animation = engine.animation;
+const ctrl_pkg = engine.animation_controller;
+const job_system = engine.job_system;
+const name_hash = engine.name_hash;
+
+const CONTROLLER_COUNT: usize = 1000;
+const FRAMES: usize = 240;
+const WORKER_THREADS: u32 = 4;
+
+const clip_names = [_][:0]const u8{
+    "idle",      "walk_left", "walk_fwd", "walk_right", "run",   "sprint",
+    "jump_up",   "jump_fall", "aim_down", "aim_mid",    "aim_up", "aim_idle",
+};
+
+fn hash(name: []const u8) u32 {
+    return name_hash.hash_u32_fnv1a(name);
+}
+
+fn clip(name: []const u8, loop: bool) ctrl_pkg.AnimNode {
+    return .{ .type = .Clip, .animation_name_hash = hash(name), .loop = loop, .speed = 1.0, .param_hash = 0, .child_count = 0, .children = null, .thresholds = null };
+}
+
+fn blend(param: []const u8, children: []ctrl_pkg.AnimNode, thresholds: []f32) ctrl_pkg.AnimNode {
+    return .{ .type = .Blend1D, .animation_name_hash = 0, .loop = true, .speed = 1.0, .param_hash = hash(param), .child_count = @intCast(children.len), .children = children.ptr, .thresholds = thresholds.ptr };
+}
+
+/// Graph storage; the definition points into it, so it must stay put while controllers are created.
+const Graph = struct {
+    walk: [3]ctrl_pkg.AnimNode = undefined,
+    walk_thresholds: [3]f32 = .{ -1.0, 0.0, 1.0 },
+    locomotion: [4]ctrl_pkg.AnimNode = undefined,
+    locomotion_thresholds: [4]f32 = .{ 0.0, 1.5, 4.0, 7.0 },
+    jump: [2]ctrl_pkg.AnimNode = undefined,
+    jump_thresholds: [2]f32 = .{ -1.0, 1.0 },
+    aim: [4]ctrl_pkg.AnimNode = undefined,
+    aim_thresholds: [4]f32 = .{ -1.0, 0.0, 1.0, 2.0 },
+    roots: [3]ctrl_pkg.AnimNode = undefined,
+
+    to_jump: [1]ctrl_pkg.AnimCondition = undefined,
+    to_aim: [1]ctrl_pkg.AnimCondition = undefined,
+    from_jump: [1]ctrl_pkg.AnimCondition = undefined,
+    from_aim: [1]ctrl_pkg.AnimCondition = undefined,
+    locomotion_transitions: [2]ctrl_pkg.AnimTransition = undefined,
+    jump_transitions: [1]ctrl_pkg.AnimTransition = undefined,
+    aim_transitions: [1]ctrl_pkg.AnimTransition = undefined,
+    states: [3]ctrl_pkg.AnimState = undefined,
+
+    fn build(g: *Graph) ctrl_pkg.AnimStateMachineDef {
+        g.walk = .{ clip("walk_left", true), clip("walk_fwd", true), clip("walk_right", true) };
+        g.locomotion = .{ clip("idle", true), blend("direction", &g.walk, &g.walk_thresholds), clip("run", true), clip("sprint", true) };
+        g.jump = .{ clip("jump_up", false), clip("jump_fall", false) };
+        g.aim = .{ clip("aim_down", true), clip("aim_mid", true), clip("aim_up", true), clip("aim_idle", true) };
+        g.roots = .{
+            blend("speed", &g.locomotion, &g.locomotion_thresholds),
+            blend("vertical", &g.jump, &g.jump_thresholds),
+            blend("pitch", &g.aim, &g.aim_thresholds),
+        };
+
+        g.to_jump = .{.{ .param_hash = hash("jump"), .operator = .Greater, .threshold = 0.5 }};
+        g.to_aim = .{.{ .param_hash = hash("aim"), .operator = .Greater, .threshold = 0.5 }};
+        g.from_jump = .{.{ .param_hash = hash("jump"), .operator = .Less, .threshold = 0.5 }};
+        g.from_aim = .{.{ .param_hash = hash("aim"), .operator = .Less, .threshold = 0.5 }};
+        g.locomotion_transitions = .{
+            .{ .target_state_hash = hash("Jump"), .duration = 0.1, .conditions = &g.to_jump, .condition_count = 1 },
+            .{ .target_state_hash = hash("Aim"), .duration = 0.25, .conditions = &g.to_aim, .condition_count = 1 },
+        };
+        g.jump_transitions = .{.{ .target_state_hash = hash("Locomotion"), .duration = 0.2, .conditions = &g.from_jump, .condition_count = 1 }};
+        g.aim_transitions = .{.{ .target_state_hash = hash("Locomotion"), .duration = 0.25, .conditions = &g.from_aim, .condition_count = 1 }};
+        g.states = .{
+            .{ .name_hash = hash("Locomotion"), .root_node = &g.roots[0], .transitions = &g.locomotion_transitions, .transition_count = 2 },
+            .{ .name_hash = hash("Jump"), .root_node = &g.roots[1], .transitions = &g.jump_transitions, .transition_count = 1 },
+            .{ .name_hash = hash("Aim"), .root_node = &g.roots[2], .transitions = &g.aim_transitions, .transition_count = 1 },
+        };
+        return .{ .states = &g.states, .state_count = g.states.len, .start_state_hash = hash("Locomotion") };
+    }
+};
+
+fn drive_params(controllers: []?*ctrl_pkg.AnimController, frame: usize) void {
+    const t = @as(f32, @floatFromInt(frame)) / 60.0;
+    for (controllers, 0..) |ctrl, i| {
+        const phase = @as(f32, @floatFromInt(i)) * 0.37;
+        ctrl_pkg.cardinal_anim_controller_set_param(ctrl, "speed", 3.5 + 3.5 * @sin(t + phase));
+        ctrl_pkg.cardinal_anim_controller_set_param(ctrl, "direction", @sin(t * 0.7 + phase));
+        ctrl_pkg.cardinal_anim_controller_set_param(ctrl, "vertical", @cos(t * 3.0 + phase));
+        ctrl_pkg.cardinal_anim_controller_set_param(ctrl, "pitch", @sin(t * 0.5 + phase) * 1.5);
+        ctrl_pkg.cardinal_anim_controller_set_param(ctrl, "jump", if ((frame + i) % 97 < 20) 1.0 else 0.0);
+        ctrl_pkg.cardinal_anim_controller_set_param(ctrl, "aim", if ((frame + i * 7) % 211 < 60) 1.0 else 0.0);
+    }
+}
+
+fn run_frames(controllers: []?*ctrl_pkg.AnimController, batched: bool) u64 {
+    var update_ns: u64 = 0;
+    for (0..FRAMES) |frame| {
+        drive_params(controllers, frame);
+        var timer = std.time.Timer.start() catch unreachable;
+        if (batched) {
+            ctrl_pkg.cardinal_anim_controller_update_batch(controllers.ptr, @intCast(controllers.len), 1.0 / 60.0);
+        } else {
+            for (controllers) |ctrl| ctrl_pkg.cardinal_anim_controller_update(ctrl, 1.0 / 60.0);
+        }
+        update_ns += timer.read();
+    }
+    return update_ns;
+}
+
+pub fn run(allocator: std.mem.Allocator) !void {
+    const job_config = job_system.JobSystemConfig{
+        .worker_thread_count = WORKER_THREADS,
+        .max_queue_size = 256,
+        .enable_priority_queue = true,
+    };
+    if (!job_system.init(&job_config)) return error.JobSystemInitFailed;
+    defer job_system.shutdown();
+
+    const graph = try allocator.create(Graph);
+    defer allocator.destroy(graph);
+    graph.* = .{};
+    const def = graph.build();
+
+    const systems = try allocator.alloc(*animation.CardinalAnimationSystem, CONTROLLER_COUNT);
+    defer allocator.free(systems);
+    const controllers = try allocator.alloc(?*ctrl_pkg.AnimController, CONTROLLER_COUNT);
+    defer allocator.free(controllers);
+
+    for (systems, controllers, 0..) |*system, *ctrl, i| {
+        system.* = animation.cardinal_animation_system_create(clip_names.len, 0) orelse return error.OutOfMemory;
+        for (clip_names) |name| {
+            const anim = std.mem.zeroInit(animation.CardinalAnimation, .{ .name = @constCast(name.ptr), .duration = 1.0 + @as(f32, @floatFromInt(i % 5)) * 0.1 });
+            _ = animation.cardinal_animation_system_add_animation(system.*, &anim);
+        }
+        ctrl.* = ctrl_pkg.cardinal_anim_controller_create(&def, system.*) orelse return error.OutOfMemory;
+    }
+    defer {
+        for (systems, controllers) |system, ctrl| {
+            ctrl_pkg.cardinal_anim_controller_destroy(ctrl);
+            animation.cardinal_animation_system_destroy(system);
+        }
+    }
+
+    // Warm up: creates the animation states every clip plays into.
+    _ = run_frames(controllers, false);
+
+    const serial_ns = run_frames(controllers, false);
+    const batched_ns = run_frames(controllers, true);
+
+    for ([_]struct { name: []const u8, ns: u64 }{
+        .{ .name = "serial", .ns = serial_ns },
+        .{ .name = "batched", .ns = batched_ns },
+    }) |result| {
+        const per_frame_ms = @as(f64, @floatFromInt(result.ns)) / 1e6 / @as(f64, @floatFromInt(FRAMES));
+        std.debug.print("  {s:<8} {d:>7.3} ms/frame  {d:>7.1} ns/controller\n", .{
+            result.name,
+            per_frame_ms,
+            per_frame_ms * 1e6 / @as(f64, @floatFromInt(CONTROLLER_COUNT)),
+        });
+    }
+    std.debug.print("  {d} controllers, {d} frames, {d} workers, speedup {d:.2}x\n", .{
+        CONTROLLER_COUNT,
+        FRAMES,
+        WORKER_THREADS,
+        @as(f64, @floatFromInt(serial_ns)) / @as(f64, @floatFromInt(@max(batched_ns, 1))),
+    });
+}
@@ -0,0 +1,175 @@
+//! Asset cache lookups under concurrent streaming load.
+//!
+//! Reader threads repeatedly resolve mesh identifiers while a streaming thread keeps inserting new
+//! meshes and the byte budget forces evictions. The asset manager's wait-free slot map is measured
+//! against a mutex-guarded string hash map doing the same work, which is the shape of the old
+//! per-loader caches.
+const std = @import("std");
+const engine = @import("cardinal_engine");
+const asset_manager = engine.asset_manager;
+const ref_counting = engine.ref_counting;
+const scene = engine.scene;
+
+const RESIDENT_ENTRIES: u32 = 2048;
+const LOOKUPS_PER_THREAD: usize = 200_000;
+const THREAD_COUNTS = [_]usize{ 1, 2, 4, 8 };
+
+const Mode = enum { slot_map, mutex_map };
+
+/// Baseline: one lock and one string hash per lookup.
+const MutexMap = struct {
+    lock: std.Thread.Mutex = .{},
+    map: std.StringHashMapUnmanaged(*ref_counting.CardinalRefCountedResource) = .{},
+};
+
+const Shared = struct {
+    mode: Mode,
+    manager: *asset_manager.AssetManager,
+    baseline: *MutexMap,
+    /// Highest identifier the streaming thread has published.
+    newest: std.atomic.Value(u32) = .init(0),
+    stop: std.atomic.Value(bool) = .init(false),
+    hits: std.atomic.Value(u64) = .init(0),
+};
+
+fn format_id(buf: []u8, id: u32) [:0]const u8 {
+    return std.fmt.bufPrintZ(buf, "bench_mesh_{d}", .{id}) catch unreachable;
+}
+
+fn destroy_mesh(ptr: ?*anyopaque) callconv(.c) void {
+    std.heap.c_allocator.destroy(@as(*scene.CardinalMesh, @ptrCast(@alignCast(ptr.?))));
+}
+
+fn create_resource(id: [:0]const u8) ?*ref_counting.CardinalRefCountedResource {
+    const mesh = std.heap.c_allocator.create(scene.CardinalMesh) catch return null;
+    mesh.* = std.mem.zeroes(scene.CardinalMesh);
+    return ref_counting.cardinal_ref_create(id.ptr, mesh, @sizeOf(scene.CardinalMesh), destroy_mesh);
+}
+
+/// Publishes mesh `id` in the structure under test; old entries fall out through eviction (slot
+/// map) or explicit removal (baseline).
+fn publish(shared: *Shared, id: u32) void {
+    var buf: [64]u8 = undefined;
+    const name = format_id(&buf, id);
+    const res = create_resource(name) orelse return;
+    defer ref_counting.cardinal_ref_release(res);
+
+    switch (shared.mode) {
+        .slot_map => _ = shared.manager.cacheMesh(name, res),
+        .mutex_map => {
+            const key = std.heap.c_allocator.dupe(u8, name) catch return;
+            shared.baseline.lock.lock();
+            defer shared.baseline.lock.unlock();
+            shared.baseline.map.put(std.heap.c_allocator, key, res) catch {
+                std.heap.c_allocator.free(key);
+                return;
+            };
+            _ = @atomicRmw(u32, &res.ref_count, .Add, 1, .seq_cst);
+
+            if (id >= RESIDENT_ENTRIES) {
+                var old_buf: [64]u8 = undefined;
+                const old_name = format_id(&old_buf, id - RESIDENT_ENTRIES);
+                if (shared.baseline.map.fetchRemove(old_name)) |kv| {
+                    std.heap.c_allocator.free(kv.key);
+                    ref_counting.cardinal_ref_release(kv.value);
+                }
+            }
+        },
+    }
+    shared.newest.store(id, .release);
+}
+
+fn streamer(shared: *Shared) void {
+    var id = shared.newest.load(.acquire) + 1;
+    while (!shared.stop.load(.acquire)) : (id += 1) {
+        publish(shared, id);
+    }
+}
+
+fn reader(shared: *Shared, seed: u64) void {
+    var prng = std.Random.DefaultPrng.init(seed);
+    const random = prng.random();
+    var buf: [64]u8 = undefined;
+    var hits: u64 = 0;
+
+    var i: usize = 0;
+    while (i < LOOKUPS_PER_THREAD) : (i += 1) {
+        // Mostly recent assets, with some requests for ones that were already streamed out.
+        const newest = shared.newest.load(.acquire);
+        const back = random.uintLessThan(u32, RESIDENT_ENTRIES + RESIDENT_ENTRIES / 4);
+        const id = newest -| back;
+        const name = format_id(&buf, id);
+
+        const found: ?*ref_counting.CardinalRefCountedResource = switch (shared.mode) {
+            .slot_map => shared.manager.acquireMeshResource(name),
+            .mutex_map => blk: {
+                shared.baseline.lock.lock();
+                defer shared.baseline.lock.unlock();
+                const res = shared.baseline.map.get(name) orelse break :blk null;
+                _ = @atomicRmw(u32, &res.ref_count, .Add, 1, .seq_cst);
+                break :blk res;
+            },
+        };
+        if (found) |res| {
+            hits += 1;
+            ref_counting.cardinal_ref_release(res);
+        }
+    }
+    _ = shared.hits.fetchAdd(hits, .monotonic);
+}
+
+fn run_case(allocator: std.mem.Allocator, mode: Mode, thread_count: usize) !void {
+    var manager = try asset_manager.AssetManager.init(allocator, RESIDENT_ENTRIES * 2);
+    defer manager.deinit();
+    manager.budget_bytes.store(@as(u64, RESIDENT_ENTRIES) * @sizeOf(scene.CardinalMesh), .monotonic);
+
+    var baseline = MutexMap{};
+    defer {
+        var it = baseline.map.iterator();
+        while (it.next()) |kv| {
+            std.heap.c_allocator.free(kv.key_ptr.*);
+            ref_counting.cardinal_ref_release(kv.value_ptr.*);
+        }
+        baseline.map.deinit(std.heap.c_allocator);
+    }
+
+    var shared = Shared{ .mode = mode, .manager = &manager, .baseline = &baseline };
+    var id: u32 = 1;
+    while (id <= RESIDENT_ENTRIES) : (id += 1) publish(&shared, id);
+
+    const stream_thread = try std.Thread.spawn(.{}, streamer, .{&shared});
+    const threads = try allocator.alloc(std.Thread, thread_count);
+    defer allocator.free(threads);
+
+    var timer = try std.time.Timer.start();
+    for (threads, 0..) |*t, i| {
+        t.* = try std.Thread.spawn(.{}, reader, .{ &shared, @as(u64, i) + 1 });
+    }
+    for (threads) |t| t.join();
+    const elapsed_ns = timer.read();
+
+    shared.stop.store(true, .release);
+    stream_thread.join();
+
+    const lookups = thread_count * LOOKUPS_PER_THREAD;
+    const ns_per_lookup = @as(f64, @floatFromInt(elapsed_ns)) / @as(f64, @floatFromInt(lookups)) * @as(f64, @floatFromInt(thread_count));
+    const hit_rate = @as(f64, @floatFromInt(shared.hits.load(.monotonic))) / @as(f64, @floatFromInt(lookups)) * 100.0;
+    std.debug.print("  {s:<9} readers={d}: {d:>8.2} ms, {d:>7.1} ns/lookup/thread, hit rate {d:>5.1}%, streamed {d}\n", .{
+        @tagName(mode),
+        thread_count,
+        @as(f64, @floatFromInt(elapsed_ns)) / 1e6,
+        ns_per_lookup,
+        hit_rate,
+        shared.newest.load(.monotonic) - RESIDENT_ENTRIES,
+    });
+}
+
+pub fn run(allocator: std.mem.Allocator) !void {
+    if (!ref_counting.cardinal_ref_counting_init(4096)) return error.RefCountingInitFailed;
+    defer ref_counting.cardinal_ref_counting_shutdown();
+
+    for (THREAD_COUNTS) |thread_count| {
+        try run_case(allocator, .slot_map, thread_count);
+        try run_case(allocator, .mutex_map, thread_count);
+    }
+}
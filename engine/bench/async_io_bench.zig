@@ -0,0 +1,246 @@
+//! Reads on job workers versus the I/O service.
+//!
+//! Loads 10k small files and a few large ones three ways. "blocking" reads each file with
+//! `vfs.read_file` inside its job, the way load tasks used to; "io_uring" and "threads" read
+//! through `io_service` and queue the job once the bytes are in memory. Every job then "decodes"
+//! its file with a hash pass. Busy is the share of worker time spent inside jobs and decode the
+//! share spent decoding; the difference is time workers sat blocked on reads. Files written
+//! moments earlier are still in the OS page cache, so without dropping caches this measures
+//! syscall and scheduling overhead rather than disk latency.
+const std = @import("std");
+const engine = @import("cardinal_engine");
+const job_system = engine.job_system;
+const io_service = engine.io_service;
+const vfs = engine.vfs;
+
+const SMALL_FILES: usize = 10_000;
+const SMALL_MAX_SIZE: usize = 16 * 1024;
+const LARGE_FILES: usize = 6;
+const LARGE_SIZE: usize = 16 * 1024 * 1024;
+const DIR_COUNT: usize = 64;
+const WORKER_THREADS: u32 = 4;
+const WORK_DIR = ".zig-cache/bench/async_io";
+
+const Mode = enum { blocking, io_uring, threads };
+
+const FileLoad = struct {
+    path: []const u8,
+    job: ?*job_system.Job = null,
+    request: ?*io_service.Request = null,
+    digest: u64 = 0,
+};
+
+var g_done = std.atomic.Value(usize).init(0);
+var g_failed = std.atomic.Value(usize).init(0);
+var g_bytes = std.atomic.Value(u64).init(0);
+var g_decode_ns = std.atomic.Value(u64).init(0);
+
+fn decode(load: *FileLoad, bytes: []const u8) void {
+    const start_ns = std.time.nanoTimestamp();
+    load.digest = std.hash.Wyhash.hash(0, bytes);
+    _ = g_decode_ns.fetchAdd(@intCast(@max(std.time.nanoTimestamp() - start_ns, 0)), .monotonic);
+    _ = g_bytes.fetchAdd(bytes.len, .monotonic);
+}
+
+fn blocking_job(data: ?*anyopaque) callconv(.c) i32 {
+    const load: *FileLoad = @ptrCast(@alignCast(data.?));
+    defer _ = g_done.fetchAdd(1, .release);
+    var contents = vfs.read_file(std.heap.c_allocator, load.path) catch {
+        _ = g_failed.fetchAdd(1, .monotonic);
+        return -1;
+    };
+    defer contents.deinit();
+    decode(load, contents.bytes);
+    return 0;
+}
+
+fn decode_job(data: ?*anyopaque) callconv(.c) i32 {
+    const load: *FileLoad = @ptrCast(@alignCast(data.?));
+    defer _ = g_done.fetchAdd(1, .release);
+    const request = load.request.?;
+    defer {
+        io_service.release(request);
+        load.request = null;
+    }
+    if (request.err != null) {
+        _ = g_failed.fetchAdd(1, .monotonic);
+        return -1;
+    }
+    decode(load, request.data.bytes);
+    return 0;
+}
+
+/// Runs on the I/O thread: hands the bytes to a worker.
+fn on_read(request: *io_service.Request) void {
+    const load: *FileLoad = @ptrCast(@alignCast(request.user_data.?));
+    load.request = request;
+    submit(load, decode_job);
+}
+
+fn submit(load: *FileLoad, func: job_system.JobFunc) void {
+    const job = job_system.create_job(func, load, .NORMAL) orelse {
+        _ = func.?(load);
+        return;
+    };
+    job.push_to_completed_queue = false;
+    load.job = job;
+    while (!job_system.submit_job(job)) std.Thread.yield() catch {};
+}
+
+const Result = struct {
+    ns: u64,
+    bytes: u64,
+    failed: usize,
+    busy_ns: u64,
+    decode_ns: u64,
+    submissions: u64 = 0,
+    fixed_reads: u64 = 0,
+};
+
+/// Returns null when the mode's backend is unavailable here.
+fn run_mode(allocator: std.mem.Allocator, mode: Mode, loads: []FileLoad) !?Result {
+    for (loads) |*load| {
+        const path = load.path;
+        load.* = .{ .path = path };
+    }
+    g_done.store(0, .monotonic);
+    g_failed.store(0, .monotonic);
+    g_bytes.store(0, .monotonic);
+    g_decode_ns.store(0, .monotonic);
+
+    if (mode != .blocking) {
+        const backend: io_service.Backend = if (mode == .io_uring) .io_uring else .thread_pool;
+        if (!io_service.init(.{ .backend = backend, .allocator = std.heap.c_allocator })) return error.IoServiceInitFailed;
+        if (io_service.get_backend() != backend) {
+            io_service.shutdown();
+            return null;
+        }
+    }
+    defer if (mode != .blocking) io_service.shutdown();
+
+    const busy_start = job_system.get_busy_time_ns();
+    var timer = try std.time.Timer.start();
+    for (loads) |*load| {
+        if (mode == .blocking) {
+            submit(load, blocking_job);
+        } else if (!io_service.submit(load.path, on_read, load)) {
+            _ = g_failed.fetchAdd(1, .monotonic);
+            _ = g_done.fetchAdd(1, .release);
+        }
+    }
+    while (g_done.load(.acquire) < loads.len) std.Thread.sleep(50 * std.time.ns_per_us);
+    const ns = timer.read();
+
+    // Workers finish their bookkeeping after the job function returns.
+    var jobs = std.ArrayListUnmanaged(*job_system.Job){};
+    defer jobs.deinit(allocator);
+    for (loads) |load| {
+        if (load.job) |job| try jobs.append(allocator, job);
+    }
+    job_system.wait_for_jobs(jobs.items);
+    const busy_ns = job_system.get_busy_time_ns() - busy_start;
+    for (jobs.items) |job| job_system.free_job(job);
+
+    const stats = io_service.get_stats();
+    return .{
+        .ns = ns,
+        .bytes = g_bytes.load(.monotonic),
+        .failed = g_failed.load(.monotonic),
+        .busy_ns = busy_ns,
+        .decode_ns = g_decode_ns.load(.monotonic),
+        .submissions = stats.submissions,
+        .fixed_reads = stats.fixed_reads,
+    };
+}
+
+fn print_row(mode: Mode, result: Result, file_count: usize, baseline_ns: u64) void {
+    const seconds = @as(f64, @floatFromInt(result.ns)) / 1e9;
+    const worker_ns = @as(f64, @floatFromInt(result.ns)) * @as(f64, @floatFromInt(WORKER_THREADS));
+    std.debug.print("  {s:<9} {d:>8.1} ms  {d:>8.0} files/s  {d:>7.1} MB/s  busy {d:>5.1}%  decode {d:>5.1}%  {d:>5.2}x", .{
+        @tagName(mode),
+        @as(f64, @floatFromInt(result.ns)) / 1e6,
+        @as(f64, @floatFromInt(file_count)) / seconds,
+        @as(f64, @floatFromInt(result.bytes)) / 1e6 / seconds,
+        @as(f64, @floatFromInt(result.busy_ns)) / worker_ns * 100.0,
+        @as(f64, @floatFromInt(result.decode_ns)) / worker_ns * 100.0,
+        @as(f64, @floatFromInt(baseline_ns)) / @as(f64, @floatFromInt(@max(result.ns, 1))),
+    });
+    if (mode == .io_uring) std.debug.print("  ({d} submissions, {d} fixed-buffer reads)", .{ result.submissions, result.fixed_reads });
+    if (result.failed > 0) std.debug.print("  {d} FAILED", .{result.failed});
+    std.debug.print("\n", .{});
+}
+
+fn write_files(allocator: std.mem.Allocator, paths: *std.ArrayListUnmanaged([]u8)) !u64 {
+    var dir = try std.fs.cwd().makeOpenPath(WORK_DIR, .{});
+    defer dir.close();
+
+    var prng = std.Random.DefaultPrng.init(45);
+    const random = prng.random();
+    const data = try allocator.alloc(u8, LARGE_SIZE);
+    defer allocator.free(data);
+    random.bytes(data);
+
+    var total: u64 = 0;
+    var name_buf: [128]u8 = undefined;
+    const stride = SMALL_FILES / LARGE_FILES;
+    for (0..SMALL_FILES + LARGE_FILES) |i| {
+        // Large files are spread through the list so they overlap the small ones.
+        const large = i % stride == 0 and i / stride < LARGE_FILES;
+        const name = if (large)
+            try std.fmt.bufPrint(&name_buf, "large_{d}.bin", .{i})
+        else
+            try std.fmt.bufPrint(&name_buf, "small_{d}/file_{d}.bin", .{ i % DIR_COUNT, i });
+        const size = if (large) LARGE_SIZE else random.intRangeAtMost(usize, 512, SMALL_MAX_SIZE);
+
+        if (std.fs.path.dirname(name)) |parent| try dir.makePath(parent);
+        try dir.writeFile(.{ .sub_path = name, .data = data[0..size] });
+        total += size;
+
+        const path = try std.fs.path.join(allocator, &[_][]const u8{ WORK_DIR, name });
+        paths.append(allocator, path) catch |err| {
+            allocator.free(path);
+            return err;
+        };
+    }
+    return total;
+}
+
+pub fn run(allocator: std.mem.Allocator) !void {
+    var paths = std.ArrayListUnmanaged([]u8){};
+    defer {
+        for (paths.items) |path| allocator.free(path);
+        paths.deinit(allocator);
+    }
+    const total_bytes = try write_files(allocator, &paths);
+    defer std.fs.cwd().deleteTree(WORK_DIR) catch {};
+
+    const loads = try allocator.alloc(FileLoad, paths.items.len);
+    defer allocator.free(loads);
+    for (loads, paths.items) |*load, path| load.* = .{ .path = path };
+
+    const job_config = job_system.JobSystemConfig{
+        .worker_thread_count = WORKER_THREADS,
+        .max_queue_size = @intCast(loads.len),
+        .enable_priority_queue = true,
+    };
+    if (!job_system.init(&job_config)) return error.JobSystemInitFailed;
+    defer job_system.shutdown();
+
+    std.debug.print("  {d} files ({d} large x {d} MiB), {d:.1} MiB total, {d} workers\n", .{
+        loads.len,
+        LARGE_FILES,
+        LARGE_SIZE / (1024 * 1024),
+        @as(f64, @floatFromInt(total_bytes)) / (1024.0 * 1024.0),
+        WORKER_THREADS,
+    });
+
+    var baseline_ns: u64 = 0;
+    for ([_]Mode{ .blocking, .io_uring, .threads }) |mode| {
+        const result = try run_mode(allocator, mode, loads) orelse {
+            std.debug.print("  {s:<9} unavailable\n", .{@tagName(mode)});
+            continue;
+        };
+        if (mode == .blocking) baseline_ns = result.ns;
+        print_row(mode, result, loads.len, baseline_ns);
+    }
+}
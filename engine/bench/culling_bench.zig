@@ -0,0 +1,89 @@
+//! Visibility culling throughput on a synthetic city.
+//!
+//! Builds `visibility_culling.SyntheticCity` (buildings on a grid, small props between them) and
+//! culls it from a street-level camera that sweeps around the centre. "scalar" tests every box
+//! with `math.aabbIntersectsFrustum`; "simd" is `Culler.cull` on one thread; "jobs" splits it
+//! across the job system; "occlusion" adds the software depth buffer with buildings as occluders.
+//! All variants include producing the sorted visible-draw list except "scalar", which only counts.
+const std = @import("std");
+const engine = @import("cardinal_engine");
+const job_system = engine.job_system;
+const math = engine.math;
+const culling = engine.visibility_culling;
+
+const BLOCKS: usize = 128;
+const PROPS_PER_BLOCK: usize = 6;
+const FRAMES: usize = 100;
+const WORKER_THREADS: u32 = 4;
+
+fn camera(frame: usize) math.Mat4 {
+    const angle = @as(f32, @floatFromInt(frame)) / @as(f32, @floatFromInt(FRAMES)) * std.math.tau;
+    const eye = math.Vec3{ .x = @cos(angle) * 150.0, .y = 1.7, .z = @sin(angle) * 150.0 };
+    const view = math.Mat4.lookAt(eye, .{ .x = 0.0, .y = 1.7, .z = 0.0 }, .{ .x = 0.0, .y = 1.0, .z = 0.0 });
+    const proj = math.Mat4.perspective(std.math.degreesToRadians(70.0), 16.0 / 9.0, 0.1, 1000.0);
+    return proj.mul(view);
+}
+
+const Result = struct {
+    ns: u64 = 0,
+    visible: usize = 0,
+};
+
+fn run_scalar(set: *const culling.CullSet) Result {
+    var result = Result{};
+    var timer = std.time.Timer.start() catch return result;
+    for (0..FRAMES) |frame| {
+        const frustum = math.Frustum.fromMatrix(camera(frame));
+        for (0..set.len()) |i| {
+            if (math.aabbIntersectsFrustum(set.bounds(@intCast(i)), frustum)) result.visible += 1;
+        }
+    }
+    result.ns = timer.read();
+    return result;
+}
+
+fn run_culler(allocator: std.mem.Allocator, set: *const culling.CullSet, options: culling.Options) !Result {
+    var culler = culling.Culler{};
+    defer culler.deinit(allocator);
+    var result = Result{};
+    var timer = try std.time.Timer.start();
+    for (0..FRAMES) |frame| {
+        result.visible += (try culler.cull(allocator, set, camera(frame), options)).len;
+    }
+    result.ns = timer.read();
+    return result;
+}
+
+fn print_row(name: []const u8, result: Result, baseline_ns: u64) void {
+    const frames_f: f64 = @floatFromInt(FRAMES);
+    std.debug.print("  {s:<10} {d:>8.3} ms/frame  {d:>7.0} visible  {d:>5.1}x\n", .{
+        name,
+        @as(f64, @floatFromInt(result.ns)) / 1e6 / frames_f,
+        @as(f64, @floatFromInt(result.visible)) / frames_f,
+        @as(f64, @floatFromInt(baseline_ns)) / @as(f64, @floatFromInt(@max(result.ns, 1))),
+    });
+}
+
+pub fn run(allocator: std.mem.Allocator) !void {
+    var city = try culling.SyntheticCity.init(allocator, BLOCKS, PROPS_PER_BLOCK, 0xc17);
+    defer city.deinit(allocator);
+
+    const job_config = job_system.JobSystemConfig{
+        .worker_thread_count = WORKER_THREADS,
+        .max_queue_size = 256,
+        .enable_priority_queue = true,
+    };
+    if (!job_system.init(&job_config)) return error.JobSystemInitFailed;
+    defer job_system.shutdown();
+
+    const scalar = run_scalar(&city.set);
+    const simd = try run_culler(allocator, &city.set, .{ .use_jobs = false });
+    const jobs = try run_culler(allocator, &city.set, .{});
+    const occlusion = try run_culler(allocator, &city.set, .{ .occlusion = true });
+
+    std.debug.print("  {d} objects ({d} buildings as occluders), {d} frames, {d} workers\n", .{ city.set.len(), city.buildings, FRAMES, WORKER_THREADS });
+    print_row("scalar", scalar, scalar.ns);
+    print_row("simd", simd, scalar.ns);
+    print_row("jobs", jobs, scalar.ns);
+    print_row("occlusion", occlusion, scalar.ns);
+}
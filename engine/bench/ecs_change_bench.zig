@@ -0,0 +1,164 @@
+//! Mirroring ECS state into another structure: full scans versus changed-only queries.
+//!
+//! Keeps a renderer-style mirror (one world matrix and visibility flag per mesh slot) in sync with
+//! `ENTITIES` entities that carry a `Transform` and a `MeshRenderer`. Each frame a few entities
+//! are edited through `Registry.get`, then the mirror is refreshed. "full" walks every renderer
+//! like the old editor sync did; "changed" visits only `view_changed` results since the last
+//! frame's `ChangeCursor`. "scattered" edits random entities, so most change chunks contain a
+//! touched entry; "clustered" edits a contiguous run, like a terrain group or a multi-selection
+//! dragged with the gizmo.
+const std = @import("std");
+const engine = @import("cardinal_engine");
+const math = engine.math;
+const components = engine.ecs_components;
+const ecs = engine.ecs_registry;
+
+const ENTITIES: usize = 100_000;
+const FRAMES: usize = 200;
+
+const Mirror = struct {
+    world: []math.Mat4,
+    visible: []bool,
+
+    fn init(allocator: std.mem.Allocator) !Mirror {
+        const world = try allocator.alloc(math.Mat4, ENTITIES);
+        errdefer allocator.free(world);
+        const visible = try allocator.alloc(bool, ENTITIES);
+        @memset(world, math.Mat4.identity());
+        @memset(visible, false);
+        return .{ .world = world, .visible = visible };
+    }
+
+    fn deinit(self: *Mirror, allocator: std.mem.Allocator) void {
+        allocator.free(self.world);
+        allocator.free(self.visible);
+    }
+
+    fn write(self: *Mirror, registry: *const ecs.Registry, entity: ecs.Entity, mr: *const components.MeshRenderer) void {
+        const slot = mr.mesh.index;
+        self.visible[slot] = mr.visible;
+        if (registry.get_const(components.Transform, entity)) |t| {
+            self.world[slot] = math.Mat4.fromTRS(t.position, t.rotation, t.scale);
+        }
+    }
+};
+
+const Pattern = enum { scattered, clustered };
+
+const Result = struct {
+    ns: u64 = 0,
+    visited: usize = 0,
+    checksum: f64 = 0.0,
+};
+
+fn populate(registry: *ecs.Registry, entities: []ecs.Entity) !void {
+    for (entities, 0..) |*e, i| {
+        e.* = try registry.create();
+        const f: f32 = @floatFromInt(i);
+        try registry.add(e.*, components.Transform{ .position = .{ .x = f, .y = 0.0, .z = -f } });
+        try registry.add(e.*, components.MeshRenderer{
+            .mesh = .{ .index = @intCast(i), .generation = 1 },
+            .material = .{ .index = 0, .generation = 1 },
+        });
+    }
+}
+
+/// Edits `count` entities the way an editor frame would: a moved transform and a toggled flag.
+fn edit(registry: *ecs.Registry, entities: []const ecs.Entity, pattern: Pattern, count: usize, frame: usize, rng: std.Random) void {
+    const run_start = (frame * 7919) % (entities.len - count);
+    for (0..count) |k| {
+        const e = switch (pattern) {
+            .scattered => entities[rng.uintLessThan(usize, entities.len)],
+            .clustered => entities[run_start + k],
+        };
+        if (registry.get(components.Transform, e)) |t| t.position.y += 0.01;
+        if (k % 8 == 0) {
+            if (registry.get(components.MeshRenderer, e)) |mr| mr.visible = !mr.visible;
+        }
+    }
+}
+
+fn run_sync(allocator: std.mem.Allocator, changed_only: bool, pattern: Pattern, per_frame: usize) !Result {
+    var registry = ecs.Registry.init(allocator);
+    defer registry.deinit();
+    const entities = try allocator.alloc(ecs.Entity, ENTITIES);
+    defer allocator.free(entities);
+    try populate(&registry, entities);
+
+    var mirror = try Mirror.init(allocator);
+    defer mirror.deinit(allocator);
+
+    var prng = std.Random.DefaultPrng.init(48);
+    var transform_cursor = ecs.ChangeCursor{};
+    var renderer_cursor = ecs.ChangeCursor{};
+    var result = Result{};
+
+    for (0..FRAMES + 1) |frame| {
+        // Frame 0 is the initial full sync for both strategies and is not timed.
+        if (frame > 0) edit(&registry, entities, pattern, per_frame, frame, prng.random());
+        var timer = try std.time.Timer.start();
+
+        if (changed_only) {
+            var t_it = registry.view_changed(components.Transform, transform_cursor.begin(&registry)).iterator();
+            while (t_it.next()) |entry| {
+                const mr = registry.get_const(components.MeshRenderer, entry.entity) orelse continue;
+                mirror.write(&registry, entry.entity, mr);
+                result.visited += 1;
+            }
+            var r_it = registry.view_changed(components.MeshRenderer, renderer_cursor.begin(&registry)).iterator();
+            while (r_it.next()) |entry| {
+                mirror.write(&registry, entry.entity, entry.component);
+                result.visited += 1;
+            }
+            transform_cursor.end(&registry);
+            renderer_cursor.end(&registry);
+        } else {
+            var it = registry.view(components.MeshRenderer).const_iterator();
+            while (it.next()) |entry| {
+                mirror.write(&registry, entry.entity, entry.component);
+                result.visited += 1;
+            }
+        }
+
+        if (frame > 0) result.ns += timer.read();
+    }
+
+    for (mirror.world, mirror.visible) |m, v| {
+        result.checksum += m.data[13];
+        if (v) result.checksum += 1.0;
+    }
+    return result;
+}
+
+fn print_row(name: []const u8, result: Result, baseline_ns: u64) void {
+    const frames_f: f64 = @floatFromInt(FRAMES);
+    std.debug.print("  {s:<8} {d:>9.3} ms/frame  {d:>8.0} visited/frame", .{
+        name,
+        @as(f64, @floatFromInt(result.ns)) / frames_f / 1e6,
+        @as(f64, @floatFromInt(result.visited)) / (frames_f + 1.0),
+    });
+    if (baseline_ns > 0) {
+        std.debug.print("  {d:>6.1}x", .{@as(f64, @floatFromInt(baseline_ns)) / @as(f64, @floatFromInt(@max(result.ns, 1)))});
+    }
+    std.debug.print("\n", .{});
+}
+
+pub fn run(allocator: std.mem.Allocator) !void {
+    std.debug.print("  {d} entities, {d} frames, change chunks of {d}\n", .{ ENTITIES, FRAMES, engine.ecs_component.change_chunk_size });
+
+    const cases = [_]struct { pattern: Pattern, per_frame: usize }{
+        .{ .pattern = .scattered, .per_frame = ENTITIES / 1000 },
+        .{ .pattern = .scattered, .per_frame = ENTITIES / 100 },
+        .{ .pattern = .clustered, .per_frame = ENTITIES / 100 },
+    };
+    for (cases) |case| {
+        std.debug.print("  {s}, {d} edits per frame\n", .{ @tagName(case.pattern), case.per_frame });
+        const full = try run_sync(allocator, false, case.pattern, case.per_frame);
+        print_row("full", full, 0);
+        const changed = try run_sync(allocator, true, case.pattern, case.per_frame);
+        print_row("changed", changed, full.ns);
+        if (@abs(changed.checksum - full.checksum) > 1e-3 * @abs(full.checksum) + 1e-3) {
+            std.debug.print("  checksum MISMATCH\n", .{});
+        }
+    }
+}
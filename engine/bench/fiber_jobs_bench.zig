@@ -0,0 +1,162 @@
+//! Nested job waits: blocking workers versus fibers.
+//!
+//! Each level of the workload is a job that submits the next level plus a batch of leaf jobs,
+//! waits for all of them, then folds their results, like a loader waiting on its sub-loads or
+//! `Scheduler.run` inside the frame pipeline's simulation job. Without fibers every waiting level
+//! holds a worker, so the deeper the nesting the fewer workers are left for the leaves, and with
+//! as many levels as workers nothing is left at all. With fibers the waits suspend and every
+//! worker keeps running leaves. "Parallelism" is leaf work time over wall time: how many workers
+//! were doing useful work on average.
+const std = @import("std");
+const engine = @import("cardinal_engine");
+const job_system = engine.job_system;
+
+const WORKER_THREADS: u32 = 4;
+/// Nesting the blocking model can still finish on `WORKER_THREADS` workers.
+const SHALLOW_DEPTH: u32 = WORKER_THREADS - 1;
+/// Nesting the blocking model would deadlock on.
+const DEEP_DEPTH: u32 = 16;
+const LEAVES_PER_LEVEL: usize = 128;
+/// Iterations of busy work per leaf (a few microseconds).
+const WORK_ITERS: usize = 4000;
+const RUNS: usize = 5;
+
+var g_work_ns = std.atomic.Value(u64).init(0);
+
+fn busy_work(seed: u64) u64 {
+    var x = seed | 1;
+    for (0..WORK_ITERS) |_| {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+    }
+    return x;
+}
+
+const Leaf = struct {
+    seed: u64,
+    result: u64 = 0,
+
+    fn run(data: ?*anyopaque) callconv(.c) i32 {
+        const leaf: *Leaf = @ptrCast(@alignCast(data.?));
+        const start_ns = std.time.nanoTimestamp();
+        leaf.result = busy_work(leaf.seed);
+        _ = g_work_ns.fetchAdd(@intCast(@max(std.time.nanoTimestamp() - start_ns, 0)), .monotonic);
+        return 0;
+    }
+};
+
+const Level = struct {
+    depth: u32,
+    seed: u64,
+    result: u64 = 0,
+
+    fn run(data: ?*anyopaque) callconv(.c) i32 {
+        const level: *Level = @ptrCast(@alignCast(data.?));
+        var leaves: [LEAVES_PER_LEVEL]Leaf = undefined;
+        var jobs: [LEAVES_PER_LEVEL + 1]*job_system.Job = undefined;
+        var count: usize = 0;
+        defer for (jobs[0..count]) |job| job_system.free_job(job);
+
+        var next = Level{ .depth = level.depth -| 1, .seed = level.seed *% 31 +% 7 };
+        if (level.depth > 1) {
+            jobs[count] = submit(Level.run, &next) orelse return -1;
+            count += 1;
+        }
+        for (&leaves, 0..) |*leaf, i| {
+            leaf.* = .{ .seed = level.seed +% i };
+            jobs[count] = submit(Leaf.run, leaf) orelse return -1;
+            count += 1;
+        }
+        job_system.wait_for_jobs(jobs[0..count]);
+
+        var sum: u64 = if (level.depth > 1) next.result else 0;
+        for (leaves) |leaf| sum +%= leaf.result;
+        level.result = sum;
+        return 0;
+    }
+};
+
+fn submit(func: job_system.JobFunc, data: *anyopaque) ?*job_system.Job {
+    const job = job_system.create_job(func, data, .NORMAL) orelse return null;
+    job.push_to_completed_queue = false;
+    while (!job_system.submit_job(job)) std.Thread.yield() catch {};
+    return job;
+}
+
+const Result = struct {
+    ns: u64,
+    work_ns: u64,
+    checksum: u64,
+};
+
+fn run_tree(depth: u32) !Result {
+    g_work_ns.store(0, .monotonic);
+    var root = Level{ .depth = depth, .seed = 46 };
+    var timer = try std.time.Timer.start();
+    const job = submit(Level.run, &root) orelse return error.JobCreateFailed;
+    job_system.wait_for_jobs(&.{job});
+    const ns = timer.read();
+    const status = job_system.get_status(job);
+    job_system.free_job(job);
+    if (status != .COMPLETED) return error.JobFailed;
+    return .{ .ns = ns, .work_ns = g_work_ns.load(.monotonic), .checksum = root.result };
+}
+
+/// Best of `RUNS` trees.
+fn run_mode(fibers: bool, depth: u32) !Result {
+    const config = job_system.JobSystemConfig{
+        .worker_thread_count = WORKER_THREADS,
+        .max_queue_size = 4096,
+        .enable_priority_queue = false,
+        .enable_fibers = fibers,
+    };
+    if (!job_system.init(&config)) return error.JobSystemInitFailed;
+    defer job_system.shutdown();
+    if (fibers and !job_system.fibers_enabled()) return error.FibersUnavailable;
+
+    var best: ?Result = null;
+    for (0..RUNS) |_| {
+        const result = try run_tree(depth);
+        if (best == null or result.ns < best.?.ns) best = result;
+    }
+    return best.?;
+}
+
+fn print_row(name: []const u8, depth: u32, result: Result, baseline_ns: u64) void {
+    std.debug.print("  {s:<8} depth {d:>2}  {d:>8.2} ms  parallelism {d:>4.2} / {d}", .{
+        name,
+        depth,
+        @as(f64, @floatFromInt(result.ns)) / 1e6,
+        @as(f64, @floatFromInt(result.work_ns)) / @as(f64, @floatFromInt(@max(result.ns, 1))),
+        WORKER_THREADS,
+    });
+    if (baseline_ns > 0) {
+        std.debug.print("  {d:>5.2}x", .{@as(f64, @floatFromInt(baseline_ns)) / @as(f64, @floatFromInt(@max(result.ns, 1)))});
+    }
+    std.debug.print("\n", .{});
+}
+
+pub fn run(allocator: std.mem.Allocator) !void {
+    _ = allocator;
+    if (!engine.fiber.supported) {
+        std.debug.print("  fibers are not supported on this target\n", .{});
+        return;
+    }
+    std.debug.print("  {d} workers, {d} leaves of {d} iterations per level, best of {d}\n", .{
+        WORKER_THREADS,
+        LEAVES_PER_LEVEL,
+        WORK_ITERS,
+        RUNS,
+    });
+
+    const blocking = try run_mode(false, SHALLOW_DEPTH);
+    print_row("blocking", SHALLOW_DEPTH, blocking, 0);
+    const fibers = try run_mode(true, SHALLOW_DEPTH);
+    print_row("fibers", SHALLOW_DEPTH, fibers, blocking.ns);
+    if (fibers.checksum != blocking.checksum) std.debug.print("  checksum MISMATCH\n", .{});
+
+    std.debug.print("  blocking depth {d:>2}  skipped: {d} nested waits deadlock {d} workers\n", .{ DEEP_DEPTH, DEEP_DEPTH, WORKER_THREADS });
+    const deep = try run_mode(true, DEEP_DEPTH);
+    print_row("fibers", DEEP_DEPTH, deep, 0);
+}
@@ -0,0 +1,154 @@
+//! Serial versus pipelined frames with a headless renderer.
+//!
+//! Animates a grid of mesh entities through the ECS scheduler (a mover system plus
+//! `TransformSystem`), extracts render snapshots, and records them with
+//! `frame_pipeline.HeadlessRenderer`, which frustum-culls every instance on the CPU. Serial
+//! frames pay simulate + extract + render; pipelined frames overlap simulation of frame N+1 with
+//! rendering of frame N, trading one frame of latency for throughput.
+const std = @import("std");
+const engine = @import("cardinal_engine");
+const job_system = engine.job_system;
+const frame_pipeline = engine.frame_pipeline;
+const components = engine.ecs_components;
+const registry_pkg = engine.ecs_registry;
+const command_buffer_pkg = engine.ecs_command_buffer;
+const math = engine.math;
+
+const GRID: usize = 160;
+const WARMUP_FRAMES: usize = 20;
+const MEASURED_FRAMES: usize = 300;
+const WORKER_THREADS: u32 = 4;
+
+const MoverSystem = struct {
+    var time: f32 = 0.0;
+
+    fn update(registry: *registry_pkg.Registry, ecb: *command_buffer_pkg.CommandBuffer, delta_time: f32) void {
+        _ = ecb;
+        time += delta_time;
+        var view = registry.view(components.Transform);
+        var it = view.iterator();
+        while (it.next()) |entry| {
+            const t = entry.component;
+            const phase = t.position.x * 0.05 + t.position.z * 0.03;
+            t.position.y = @sin(time + phase) * 2.0;
+            t.rotation = math.Quat.fromAxisAngle(.{ .x = 0, .y = 1, .z = 0 }, time + phase);
+            t.dirty = true;
+        }
+    }
+};
+
+const mover_desc = engine.ecs_system.System{
+    .name = "BenchMover",
+    .update = MoverSystem.update,
+    .priority = -10,
+    .reads = &.{registry_pkg.Registry.get_type_id(components.Transform)},
+    .writes = &.{registry_pkg.Registry.get_type_id(components.Transform)},
+};
+
+fn populate(registry: *registry_pkg.Registry) !void {
+    const cam = try registry.create();
+    try registry.add(cam, components.Name.init("MainCamera"));
+    try registry.add(cam, components.Transform{ .position = .{ .x = 0, .y = 30, .z = 120 } });
+    try registry.add(cam, components.Camera{ .type = .Perspective, .fov = 60.0, .far_plane = 500.0 });
+
+    for (0..8) |i| {
+        const light = try registry.create();
+        try registry.add(light, components.Transform{ .position = .{ .x = @floatFromInt(i * 20), .y = 10, .z = 0 } });
+        try registry.add(light, components.Light{ .type = .Point, .range = 30.0 });
+    }
+
+    for (0..GRID) |z| {
+        for (0..GRID) |x| {
+            const e = try registry.create();
+            try registry.add(e, components.Transform{ .position = .{
+                .x = @as(f32, @floatFromInt(x)) * 2.0 - @as(f32, @floatFromInt(GRID)),
+                .y = 0,
+                .z = -@as(f32, @floatFromInt(z)) * 2.0,
+            } });
+            try registry.add(e, components.MeshRenderer{
+                .mesh = .{ .index = @intCast(x % 32), .generation = 1 },
+                .material = .{ .index = @intCast(z % 8), .generation = 1 },
+            });
+        }
+    }
+}
+
+fn simulate(ctx: ?*anyopaque, delta_time: f32) anyerror!void {
+    const scheduler: *engine.ecs_scheduler.Scheduler = @ptrCast(@alignCast(ctx));
+    try scheduler.run(delta_time);
+}
+
+const Totals = struct {
+    frame_ns: u64 = 0,
+    simulate_ns: u64 = 0,
+    extract_ns: u64 = 0,
+    render_ns: u64 = 0,
+    latency_ns: u64 = 0,
+    rendered: u64 = 0,
+
+    fn add(self: *Totals, s: frame_pipeline.FrameStats) void {
+        self.frame_ns += s.frame_ns;
+        self.simulate_ns += s.simulate_ns;
+        self.extract_ns += s.extract_ns;
+        self.render_ns += s.render_ns;
+        if (s.rendered_frame != 0) {
+            self.latency_ns += s.latency_ns;
+            self.rendered += 1;
+        }
+    }
+
+    fn ms(total: u64, count: u64) f64 {
+        return @as(f64, @floatFromInt(total)) / 1e6 / @as(f64, @floatFromInt(@max(count, 1)));
+    }
+};
+
+fn run_mode(allocator: std.mem.Allocator, mode: frame_pipeline.Mode) !void {
+    var registry = registry_pkg.Registry.init(allocator);
+    defer registry.deinit();
+    try populate(&registry);
+
+    var scheduler = engine.ecs_scheduler.Scheduler.init(allocator, &registry);
+    defer scheduler.deinit();
+    try scheduler.add(mover_desc);
+    try scheduler.add(engine.ecs_systems.TransformSystemDesc);
+
+    var pipeline = frame_pipeline.FramePipeline.init(allocator, &registry, mode);
+    defer pipeline.deinit();
+
+    var headless = frame_pipeline.HeadlessRenderer{};
+    const sim_stage = frame_pipeline.SimulateStage{ .ctx = &scheduler, .func = simulate };
+
+    for (0..WARMUP_FRAMES) |_| try pipeline.run_frame(1.0 / 60.0, sim_stage, headless.stage());
+
+    var totals = Totals{};
+    for (0..MEASURED_FRAMES) |_| {
+        try pipeline.run_frame(1.0 / 60.0, sim_stage, headless.stage());
+        totals.add(pipeline.stats);
+    }
+
+    std.debug.print("  {s:<9} frame {d:>6.3} ms ({d:>6.1} fps)  sim {d:>6.3}  extract {d:>6.3}  render {d:>6.3}  latency {d:>6.3} ms  [{d} visible, {d} lights]\n", .{
+        @tagName(mode),
+        Totals.ms(totals.frame_ns, MEASURED_FRAMES),
+        1000.0 / Totals.ms(totals.frame_ns, MEASURED_FRAMES),
+        Totals.ms(totals.simulate_ns, MEASURED_FRAMES),
+        Totals.ms(totals.extract_ns, MEASURED_FRAMES),
+        Totals.ms(totals.render_ns, MEASURED_FRAMES),
+        Totals.ms(totals.latency_ns, totals.rendered),
+        headless.visible_count,
+        headless.light_count,
+    });
+}
+
+pub fn run(allocator: std.mem.Allocator) !void {
+    const job_config = job_system.JobSystemConfig{
+        .worker_thread_count = WORKER_THREADS,
+        .max_queue_size = 256,
+        .enable_priority_queue = true,
+    };
+    if (!job_system.init(&job_config)) return error.JobSystemInitFailed;
+    defer job_system.shutdown();
+
+    std.debug.print("  {d} mesh entities, {d} workers\n", .{ GRID * GRID, WORKER_THREADS });
+    try run_mode(allocator, .serial);
+    try run_mode(allocator, .pipelined);
+}
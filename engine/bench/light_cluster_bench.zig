@@ -0,0 +1,98 @@
+//! Clustered light binning with 4096 lights.
+//!
+//! Scatters `light_clustering.synthetic_lights` through the scene volume and bins them from a camera
+//! that circles it. "simd" is `Clusterer.build` on one thread, "jobs" bins slices on the job
+//! system; both include writing the GPU buffer. The "lights/cluster" column is what a fragment
+//! walks on average (non-empty clusters), against every light without clustering.
+const std = @import("std");
+const engine = @import("cardinal_engine");
+const job_system = engine.job_system;
+const math = engine.math;
+const clustering = engine.light_clustering;
+const pbr = engine.vulkan_types;
+
+const LIGHTS: usize = 4096;
+const FRAMES: usize = 100;
+const WORKER_THREADS: u32 = 4;
+const WIDTH: u32 = 1920;
+const HEIGHT: u32 = 1080;
+
+fn camera(frame: usize) clustering.View {
+    const angle = @as(f32, @floatFromInt(frame)) / @as(f32, @floatFromInt(FRAMES)) * std.math.tau;
+    const eye = math.Vec3{ .x = @cos(angle) * 80.0, .y = 6.0, .z = @sin(angle) * 80.0 };
+    return .{
+        .view = math.Mat4.lookAt(eye, .{ .x = 0.0, .y = 4.0, .z = 0.0 }, .{ .x = 0.0, .y = 1.0, .z = 0.0 }),
+        .proj = math.Mat4.perspective(std.math.degreesToRadians(70.0), @as(f32, @floatFromInt(WIDTH)) / @as(f32, @floatFromInt(HEIGHT)), 0.1, 500.0),
+        .width = WIDTH,
+        .height = HEIGHT,
+    };
+}
+
+const Result = struct {
+    ns: u64 = 0,
+    indices: usize = 0,
+    occupied: usize = 0,
+    max_per_cluster: u32 = 0,
+    dropped: usize = 0,
+};
+
+fn run_clusterer(allocator: std.mem.Allocator, lights: []const pbr.PBRLight, buffer: []u8, options: clustering.Options) !Result {
+    const clusterer = try allocator.create(clustering.Clusterer);
+    defer allocator.destroy(clusterer);
+    clusterer.* = .{};
+    defer clusterer.deinit(allocator);
+
+    var result = Result{};
+    var timer = try std.time.Timer.start();
+    for (0..FRAMES) |frame| {
+        timer.reset();
+        try clusterer.build(allocator, lights, camera(frame), options);
+        clusterer.write(buffer);
+        result.ns += timer.read();
+
+        result.indices += clusterer.stats.indices;
+        result.dropped += clusterer.stats.dropped;
+        result.max_per_cluster = @max(result.max_per_cluster, clusterer.stats.max_per_cluster);
+        for (0..clustering.CLUSTER_COUNT) |i| {
+            if (clusterer.cluster_lights(@intCast(i)).len > 0) result.occupied += 1;
+        }
+    }
+    return result;
+}
+
+fn print_row(name: []const u8, result: Result, baseline_ns: u64) void {
+    const frames_f: f64 = @floatFromInt(FRAMES);
+    std.debug.print("  {s:<6} {d:>8.3} ms/frame  {d:>6.1} lights/cluster (max {d}, flat {d})  {d} dropped  {d:>5.1}x\n", .{
+        name,
+        @as(f64, @floatFromInt(result.ns)) / 1e6 / frames_f,
+        @as(f64, @floatFromInt(result.indices)) / @as(f64, @floatFromInt(@max(result.occupied, 1))),
+        result.max_per_cluster,
+        LIGHTS,
+        result.dropped,
+        @as(f64, @floatFromInt(baseline_ns)) / @as(f64, @floatFromInt(@max(result.ns, 1))),
+    });
+}
+
+pub fn run(allocator: std.mem.Allocator) !void {
+    const lights = try allocator.alloc(pbr.PBRLight, LIGHTS);
+    defer allocator.free(lights);
+    clustering.synthetic_lights(lights, 0x4096);
+
+    const buffer = try allocator.alloc(u32, clustering.BUFFER_SIZE / @sizeOf(u32));
+    defer allocator.free(buffer);
+
+    const job_config = job_system.JobSystemConfig{
+        .worker_thread_count = WORKER_THREADS,
+        .max_queue_size = 256,
+        .enable_priority_queue = true,
+    };
+    if (!job_system.init(&job_config)) return error.JobSystemInitFailed;
+    defer job_system.shutdown();
+
+    const simd = try run_clusterer(allocator, lights, std.mem.sliceAsBytes(buffer), .{ .use_jobs = false });
+    const jobs = try run_clusterer(allocator, lights, std.mem.sliceAsBytes(buffer), .{});
+
+    std.debug.print("  {d} lights, {d}x{d}x{d} clusters at {d}x{d}, {d} frames, {d} workers\n", .{ LIGHTS, clustering.GRID_X, clustering.GRID_Y, clustering.GRID_Z, WIDTH, HEIGHT, FRAMES, WORKER_THREADS });
+    print_row("simd", simd, simd.ns);
+    print_row("jobs", jobs, simd.ns);
+}
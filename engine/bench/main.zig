@@ -0,0 +1,79 @@
+//! Engine benchmark runner.
+//!
+//! Runs headless benchmarks against the engine module (no window required; only `upload` needs a
+//! Vulkan device and skips itself without one). Pass one or more benchmark names to run a subset,
+//! e.g. `zig build bench -- memory`.
+const std = @import("std");
+const engine = @import("cardinal_engine");
+const memory_bench = @import("memory_bench.zig");
+const asset_lookup_bench = @import("asset_lookup_bench.zig");
+const pack_bench = @import("pack_bench.zig");
+const texture_cook_bench = @import("texture_cook_bench.zig");
+const terrain_sidecar_bench = @import("terrain_sidecar_bench.zig");
+const frame_pipeline_bench = @import("frame_pipeline_bench.zig");
+const anim_controller_bench = @import("anim_controller_bench.zig");
+const morph_bench = @import("morph_bench.zig");
+const pipeline_cache_bench = @import("pipeline_cache_bench.zig");
+const profiler_bench = @import("profiler_bench.zig");
+const culling_bench = @import("culling_bench.zig");
+const upload_bench = @import("upload_bench.zig");
+const light_cluster_bench = @import("light_cluster_bench.zig");
+const async_io_bench = @import("async_io_bench.zig");
+const fiber_jobs_bench = @import("fiber_jobs_bench.zig");
+const pick_bench = @import("pick_bench.zig");
+const ecs_change_bench = @import("ecs_change_bench.zig");
+const spatial_index_bench = @import("spatial_index_bench.zig");
+const remesh_scheduler_bench = @import("remesh_scheduler_bench.zig");
+
+const Benchmark = struct {
+    name: []const u8,
+    run: *const fn (allocator: std.mem.Allocator) anyerror!void,
+};
+
+/// Registered benchmarks, run in declaration order.
+const benchmarks = [_]Benchmark{
+    .{ .name = "memory", .run = memory_bench.run },
+    .{ .name = "asset_lookup", .run = asset_lookup_bench.run },
+    .{ .name = "pack", .run = pack_bench.run },
+    .{ .name = "texture_cook", .run = texture_cook_bench.run },
+    .{ .name = "terrain_sidecar", .run = terrain_sidecar_bench.run },
+    .{ .name = "frame_pipeline", .run = frame_pipeline_bench.run },
+    .{ .name = "anim_controller", .run = anim_controller_bench.run },
+    .{ .name = "morph", .run = morph_bench.run },
+    .{ .name = "pipeline_cache", .run = pipeline_cache_bench.run },
+    .{ .name = "profiler", .run = profiler_bench.run },
+    .{ .name = "culling", .run = culling_bench.run },
+    .{ .name = "upload", .run = upload_bench.run },
+    .{ .name = "light_cluster", .run = light_cluster_bench.run },
+    .{ .name = "async_io", .run = async_io_bench.run },
+    .{ .name = "fiber_jobs", .run = fiber_jobs_bench.run },
+    .{ .name = "picking", .run = pick_bench.run },
+    .{ .name = "ecs_changes", .run = ecs_change_bench.run },
+    .{ .name = "spatial_index", .run = spatial_index_bench.run },
+    .{ .name = "remesh_scheduler", .run = remesh_scheduler_bench.run },
+};
+
+pub fn main() !void {
+    var gpa = std.heap.GeneralPurposeAllocator(.{}){};
+    defer _ = gpa.deinit();
+    const allocator = gpa.allocator();
+
+    const args = try std.process.argsAlloc(allocator);
+    defer std.process.argsFree(allocator, args);
+
+    engine.memory.cardinal_memory_init(16 * 1024 * 1024);
+    defer engine.memory.cardinal_memory_shutdown();
+
+    for (benchmarks) |bench| {
+        if (args.len > 1) {
+            var selected = false;
+            for (args[1..]) |arg| {
+                if (std.mem.eql(u8, arg, bench.name)) selected = true;
+            }
+            if (!selected) continue;
+        }
+
+        std.debug.print("== {s} ==\n", .{bench.name});
+        try bench.run(allocator);
+    }
+}
@@ -0,0 +1,78 @@
+//! Multi-threaded alloc/free throughput of the tracked category allocators.
+//!
+//! Each thread repeatedly allocates a batch of mixed-size blocks and frees them again, which is
+//! the pattern asset loaders produce. `c_allocator` is measured alongside as a baseline.
+const std = @import("std");
+const engine = @import("cardinal_engine");
+const memory = engine.memory;
+
+const ITERATIONS_PER_THREAD: usize = 4096;
+const BATCH_SIZE: usize = 64;
+const SIZES = [_]usize{ 24, 64, 200, 512, 1024, 3000, 16 * 1024 };
+const THREAD_COUNTS = [_]usize{ 1, 2, 4, 8 };
+
+const Mode = enum { tracked, c_heap };
+
+fn worker(mode: Mode) void {
+    const tracked = memory.cardinal_get_allocator_for_category(.ASSETS);
+    memory.cardinal_memory_enable_thread_cache();
+    defer memory.cardinal_memory_flush_thread_cache();
+
+    var ptrs: [BATCH_SIZE]?*anyopaque = undefined;
+    var iter: usize = 0;
+    while (iter < ITERATIONS_PER_THREAD) : (iter += 1) {
+        for (&ptrs, 0..) |*p, i| {
+            const size = SIZES[(iter + i) % SIZES.len];
+            p.* = switch (mode) {
+                .tracked => memory.cardinal_alloc(tracked, size),
+                .c_heap => std.c.malloc(size),
+            };
+        }
+        for (ptrs) |p| {
+            switch (mode) {
+                .tracked => memory.cardinal_free(tracked, p),
+                .c_heap => std.c.free(p),
+            }
+        }
+    }
+}
+
+fn run_case(allocator: std.mem.Allocator, mode: Mode, thread_count: usize) !void {
+    const threads = try allocator.alloc(std.Thread, thread_count);
+    defer allocator.free(threads);
+
+    var timer = try std.time.Timer.start();
+    for (threads) |*t| {
+        t.* = try std.Thread.spawn(.{}, worker, .{mode});
+    }
+    for (threads) |t| t.join();
+    const elapsed_ns = timer.read();
+
+    const ops = thread_count * ITERATIONS_PER_THREAD * BATCH_SIZE * 2;
+    const ns_per_op = @as(f64, @floatFromInt(elapsed_ns)) / @as(f64, @floatFromInt(ops));
+    const mops = @as(f64, @floatFromInt(ops)) / (@as(f64, @floatFromInt(elapsed_ns)) / 1e9) / 1e6;
+    std.debug.print("  {s:<8} threads={d}: {d:>8.2} ms, {d:>7.1} ns/op, {d:>7.2} Mops/s\n", .{
+        @tagName(mode),
+        thread_count,
+        @as(f64, @floatFromInt(elapsed_ns)) / 1e6,
+        ns_per_op,
+        mops,
+    });
+}
+
+pub fn run(allocator: std.mem.Allocator) !void {
+    for (THREAD_COUNTS) |thread_count| {
+        try run_case(allocator, .tracked, thread_count);
+        try run_case(allocator, .c_heap, thread_count);
+    }
+
+    var stats: memory.CardinalGlobalMemoryStats = undefined;
+    memory.cardinal_memory_get_stats(&stats);
+    const cat = @as(usize, @intCast(@intFromEnum(memory.CardinalMemoryCategory.ASSETS)));
+    std.debug.print("  assets: allocs={d} frees={d} current={d} peak={d}\n", .{
+        stats.categories[cat].allocation_count,
+        stats.categories[cat].free_count,
+        stats.categories[cat].current_usage,
+        stats.categories[cat].peak_usage,
+    });
+}
@@ -0,0 +1,182 @@
+//! Morph-target deformation: dense blending versus sparse streams.
+//!
+//! Builds a 20k-vertex head with 64 localized targets (each moves a patch of ~3% of the
+//! vertices, like facial blend shapes) and animates 8 of them per frame while the rest sit at
+//! zero weight. The dense path blends every target's full position and normal arrays into the
+//! whole vertex buffer, which is what evaluating glTF targets directly costs; the sparse path is
+//! `morph_targets.MorphDeformer`. Also reports storage and the bytes each path would upload.
+const std = @import("std");
+const engine = @import("cardinal_engine");
+const scene = engine.scene;
+const morph_targets = engine.morph_targets;
+
+const VERTEX_COUNT: usize = 20_000;
+const TARGET_COUNT: usize = 64;
+const PATCH_SIZE: usize = 600;
+const ACTIVE_TARGETS: usize = 8;
+const FRAMES: usize = 300;
+
+const Head = struct {
+    vertices: []scene.CardinalVertex,
+    positions: []f32,
+    normals: []f32,
+    targets: []scene.CardinalMorphTarget,
+    mesh: scene.CardinalMesh,
+
+    fn init(allocator: std.mem.Allocator) !Head {
+        const vertices = try allocator.alloc(scene.CardinalVertex, VERTEX_COUNT);
+        errdefer allocator.free(vertices);
+        const positions = try allocator.alloc(f32, TARGET_COUNT * VERTEX_COUNT * 3);
+        errdefer allocator.free(positions);
+        const normals = try allocator.alloc(f32, TARGET_COUNT * VERTEX_COUNT * 3);
+        errdefer allocator.free(normals);
+        const targets = try allocator.alloc(scene.CardinalMorphTarget, TARGET_COUNT);
+
+        for (vertices, 0..) |*v, i| {
+            const f: f32 = @floatFromInt(i);
+            v.* = std.mem.zeroes(scene.CardinalVertex);
+            v.px = @sin(f * 0.01);
+            v.py = @cos(f * 0.013);
+            v.pz = f * 1e-4;
+            v.nz = 1.0;
+        }
+
+        @memset(positions, 0.0);
+        @memset(normals, 0.0);
+        var prng = std.Random.DefaultPrng.init(0x5eed);
+        const random = prng.random();
+        for (targets, 0..) |*t, ti| {
+            const pos = positions[ti * VERTEX_COUNT * 3 ..][0 .. VERTEX_COUNT * 3];
+            const nrm = normals[ti * VERTEX_COUNT * 3 ..][0 .. VERTEX_COUNT * 3];
+            const start = random.uintLessThan(usize, VERTEX_COUNT - PATCH_SIZE);
+            for (start..start + PATCH_SIZE) |v| {
+                // Smooth falloff towards the patch edges.
+                const x = @as(f32, @floatFromInt(v - start)) / @as(f32, @floatFromInt(PATCH_SIZE));
+                const falloff = @sin(x * std.math.pi);
+                pos[v * 3 + 0] = (random.float(f32) - 0.5) * 0.02 * falloff;
+                pos[v * 3 + 1] = (random.float(f32) - 0.5) * 0.02 * falloff;
+                pos[v * 3 + 2] = random.float(f32) * 0.01 * falloff;
+                nrm[v * 3 + 0] = (random.float(f32) - 0.5) * 0.2 * falloff;
+                nrm[v * 3 + 1] = (random.float(f32) - 0.5) * 0.2 * falloff;
+            }
+            t.* = .{ .positions = pos.ptr, .normals = nrm.ptr, .tangents = null };
+        }
+
+        var mesh = std.mem.zeroes(scene.CardinalMesh);
+        mesh.vertices = vertices.ptr;
+        mesh.vertex_count = VERTEX_COUNT;
+        mesh.morph_targets = targets.ptr;
+        mesh.morph_target_count = TARGET_COUNT;
+        return .{ .vertices = vertices, .positions = positions, .normals = normals, .targets = targets, .mesh = mesh };
+    }
+
+    fn deinit(self: *Head, allocator: std.mem.Allocator) void {
+        allocator.free(self.vertices);
+        allocator.free(self.positions);
+        allocator.free(self.normals);
+        allocator.free(self.targets);
+    }
+};
+
+/// Weights for `frame`: a sliding window of targets is active, the rest are zero.
+fn frame_weights(frame: usize, weights: []f32) void {
+    @memset(weights, 0.0);
+    const t = @as(f32, @floatFromInt(frame)) / 60.0;
+    const first = (frame / 30) % TARGET_COUNT;
+    for (0..ACTIVE_TARGETS) |i| {
+        const target = (first + i * 7) % TARGET_COUNT;
+        weights[target] = 0.5 + 0.5 * @sin(t * 3.0 + @as(f32, @floatFromInt(i)));
+    }
+}
+
+fn dense_evaluate(head: *const Head, weights: []const f32, out: []scene.CardinalVertex) void {
+    @memcpy(out, head.vertices);
+    for (head.targets, weights) |t, w| {
+        const pos = t.positions.?;
+        const nrm = t.normals.?;
+        for (out, 0..) |*o, v| {
+            o.px += pos[v * 3 + 0] * w;
+            o.py += pos[v * 3 + 1] * w;
+            o.pz += pos[v * 3 + 2] * w;
+            o.nx += nrm[v * 3 + 0] * w;
+            o.ny += nrm[v * 3 + 1] * w;
+            o.nz += nrm[v * 3 + 2] * w;
+        }
+    }
+}
+
+pub fn run(allocator: std.mem.Allocator) !void {
+    var head = try Head.init(allocator);
+    defer head.deinit(allocator);
+
+    var build_timer = try std.time.Timer.start();
+    var set = try morph_targets.MorphSet.build(allocator, &head.mesh, .{});
+    defer set.deinit(allocator);
+    const build_ns = build_timer.read();
+
+    var deformer = try morph_targets.MorphDeformer.init(allocator, &set, head.vertices);
+    defer deformer.deinit(allocator);
+
+    const dense_out = try allocator.alloc(scene.CardinalVertex, VERTEX_COUNT);
+    defer allocator.free(dense_out);
+    const weights = try allocator.alloc(f32, TARGET_COUNT);
+    defer allocator.free(weights);
+
+    var dense_ns: u64 = 0;
+    var sparse_ns: u64 = 0;
+    var dirty_vertices: u64 = 0;
+    var max_error: f32 = 0.0;
+    for (0..FRAMES) |frame| {
+        frame_weights(frame, weights);
+
+        var timer = try std.time.Timer.start();
+        dense_evaluate(&head, weights, dense_out);
+        dense_ns += timer.lap();
+
+        @memcpy(deformer.weights, weights);
+        deformer.evaluate();
+        sparse_ns += timer.read();
+        dirty_vertices += deformer.dirty.count();
+
+        for (dense_out, deformer.output) |a, b| {
+            max_error = @max(max_error, @max(@abs(a.px - b.px), @max(@abs(a.py - b.py), @abs(a.pz - b.pz))));
+        }
+    }
+
+    var quantized: usize = 0;
+    var streams: usize = 0;
+    for (set.targets) |t| {
+        for ([_]morph_targets.DeltaStream{ t.positions, t.normals }) |s| {
+            if (s.indices.len == 0) continue;
+            streams += 1;
+            if (s.is_quantized()) quantized += 1;
+        }
+    }
+
+    const frames_f: f64 = @floatFromInt(FRAMES);
+    const dense_ms = @as(f64, @floatFromInt(dense_ns)) / 1e6 / frames_f;
+    const sparse_ms = @as(f64, @floatFromInt(sparse_ns)) / 1e6 / frames_f;
+    const dense_bytes = TARGET_COUNT * VERTEX_COUNT * 6 * @sizeOf(f32);
+    const vertex_bytes = VERTEX_COUNT * @sizeOf(scene.CardinalVertex);
+    const avg_dirty = @as(f64, @floatFromInt(dirty_vertices)) / frames_f;
+
+    std.debug.print("  {d} vertices, {d} targets ({d} active), {d} frames\n", .{ VERTEX_COUNT, TARGET_COUNT, ACTIVE_TARGETS, FRAMES });
+    std.debug.print("  dense    {d:>7.3} ms/frame  storage {d:>7.2} MB  upload {d:>7.1} KB/frame\n", .{
+        dense_ms,
+        @as(f64, @floatFromInt(dense_bytes)) / (1024.0 * 1024.0),
+        @as(f64, @floatFromInt(vertex_bytes)) / 1024.0,
+    });
+    std.debug.print("  sparse   {d:>7.3} ms/frame  storage {d:>7.2} MB  upload {d:>7.1} KB/frame ({d:.0} dirty vertices)\n", .{
+        sparse_ms,
+        @as(f64, @floatFromInt(set.byte_size())) / (1024.0 * 1024.0),
+        avg_dirty * @sizeOf(scene.CardinalVertex) / 1024.0,
+        avg_dirty,
+    });
+    std.debug.print("  speedup {d:.2}x, {d}/{d} streams quantized, max position error {e:.2}, build {d:.2} ms\n", .{
+        dense_ms / @max(sparse_ms, 1e-9),
+        quantized,
+        streams,
+        max_error,
+        @as(f64, @floatFromInt(build_ns)) / 1e6,
+    });
+}
@@ -0,0 +1,116 @@
+//! Loose files versus packs through the VFS.
+//!
+//! Writes a tree of small assets, packs it twice (stored and deflated) and reads every file
+//! through `vfs.read_file` from each source. The cold pass includes mounting and first touch of
+//! every page; files written moments earlier are still in the OS page cache, so it measures
+//! syscall and mapping overhead rather than disk latency. The warm pass repeats the reads.
+const std = @import("std");
+const engine = @import("cardinal_engine");
+const vfs = engine.vfs;
+const pack_file = engine.pack_file;
+
+const FILE_COUNT: usize = 8000;
+const DIR_COUNT: usize = 64;
+const WORK_DIR = ".zig-cache/bench/pack";
+const MOUNT_POINT = "bench";
+
+const Source = enum { loose, pack_stored, pack_deflate };
+
+fn file_name(buf: []u8, i: usize) []const u8 {
+    return std.fmt.bufPrint(buf, "dir_{d}/asset_{d}.bin", .{ i % DIR_COUNT, i }) catch unreachable;
+}
+
+fn write_tree(allocator: std.mem.Allocator, root: []const u8) !u64 {
+    var dir = try std.fs.cwd().makeOpenPath(root, .{});
+    defer dir.close();
+
+    var prng = std.Random.DefaultPrng.init(42);
+    const random = prng.random();
+    const data = try allocator.alloc(u8, 16 * 1024);
+    defer allocator.free(data);
+
+    var total: u64 = 0;
+    var buf: [128]u8 = undefined;
+    for (0..FILE_COUNT) |i| {
+        // Half noise, half repetitive, like a mix of compressed textures and text/mesh data.
+        const size = random.intRangeAtMost(usize, 1024, data.len);
+        if (i % 2 == 0) {
+            random.bytes(data[0..size]);
+        } else {
+            for (data[0..size], 0..) |*b, j| b.* = @truncate(j / 7);
+        }
+        const name = file_name(&buf, i);
+        if (std.fs.path.dirname(name)) |parent| try dir.makePath(parent);
+        try dir.writeFile(.{ .sub_path = name, .data = data[0..size] });
+        total += size;
+    }
+    return total;
+}
+
+fn read_all() !u64 {
+    var bytes: u64 = 0;
+    var buf: [128]u8 = undefined;
+    var path_buf: [160]u8 = undefined;
+    for (0..FILE_COUNT) |i| {
+        const path = try std.fmt.bufPrint(&path_buf, "{s}/{s}", .{ MOUNT_POINT, file_name(&buf, i) });
+        var data = try vfs.read_file(std.heap.c_allocator, path);
+        bytes += data.bytes[0];
+        bytes += data.bytes.len;
+        data.deinit();
+    }
+    return bytes;
+}
+
+fn mount(allocator: std.mem.Allocator, source: Source, loose_dir: []const u8, stored: []const u8, deflated: []const u8) !void {
+    switch (source) {
+        .loose => try vfs.mount_directory(allocator, loose_dir, MOUNT_POINT),
+        .pack_stored => try vfs.mount_pack(allocator, stored, MOUNT_POINT),
+        .pack_deflate => try vfs.mount_pack(allocator, deflated, MOUNT_POINT),
+    }
+}
+
+pub fn run(allocator: std.mem.Allocator) !void {
+    std.fs.cwd().deleteTree(WORK_DIR) catch {};
+    defer std.fs.cwd().deleteTree(WORK_DIR) catch {};
+
+    const loose_dir = WORK_DIR ++ "/loose";
+    const stored_path = WORK_DIR ++ "/stored.cpak";
+    const deflated_path = WORK_DIR ++ "/deflated.cpak";
+
+    const total = try write_tree(allocator, loose_dir);
+
+    var builder = pack_file.PackBuilder.init(allocator);
+    defer builder.deinit();
+    try builder.add_directory(loose_dir);
+    const stored_stats = try builder.write(stored_path, .{ .compress = false });
+    const deflated_stats = try builder.write(deflated_path, .{});
+
+    std.debug.print("  {d} files, {d:.1} MiB loose; stored pack {d:.1} MiB, deflated pack {d:.1} MiB ({d} entries compressed)\n", .{
+        FILE_COUNT,
+        @as(f64, @floatFromInt(total)) / (1024.0 * 1024.0),
+        @as(f64, @floatFromInt(stored_stats.pack_bytes)) / (1024.0 * 1024.0),
+        @as(f64, @floatFromInt(deflated_stats.pack_bytes)) / (1024.0 * 1024.0),
+        deflated_stats.compressed_count,
+    });
+
+    for ([_]Source{ .loose, .pack_stored, .pack_deflate }) |source| {
+        var timer = try std.time.Timer.start();
+        try mount(allocator, source, loose_dir, stored_path, deflated_path);
+        var checksum = try read_all();
+        const cold_ns = timer.read();
+
+        timer.reset();
+        checksum +%= try read_all();
+        const warm_ns = timer.read();
+        vfs.unmount_all();
+
+        std.debug.print("  {s:<12} cold {d:>8.2} ms ({d:>6.2} us/file), warm {d:>8.2} ms ({d:>6.2} us/file) [{x}]\n", .{
+            @tagName(source),
+            @as(f64, @floatFromInt(cold_ns)) / 1e6,
+            @as(f64, @floatFromInt(cold_ns)) / 1e3 / @as(f64, @floatFromInt(FILE_COUNT)),
+            @as(f64, @floatFromInt(warm_ns)) / 1e6,
+            @as(f64, @floatFromInt(warm_ns)) / 1e3 / @as(f64, @floatFromInt(FILE_COUNT)),
+            checksum,
+        });
+    }
+}
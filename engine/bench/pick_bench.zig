@@ -0,0 +1,310 @@
+//! Editor picking: a linear walk over every mesh versus the two-level `pick_bvh.PickScene`.
+//!
+//! The scene is a field of grid meshes sharing a few vertex buffers, each placed with its own
+//! transform. "linear" is how picking used to work: test every instance's bounds, then raycast
+//! its triangle BVH, building the BVHs synchronously on the first pick ("cold"). "two-level" builds
+//! the bottom levels on job workers ahead of time and walks the instance BVH nearest-first. The
+//! last rows compare a brush-sized region refit on a large terrain grid with rebuilding its BVH.
+const std = @import("std");
+const engine = @import("cardinal_engine");
+const math = engine.math;
+const scene = engine.scene;
+const job_system = engine.job_system;
+const pick_bvh = engine.pick_bvh;
+
+const MESH_COUNT: usize = 1024;
+/// Distinct vertex buffers shared by the meshes.
+const SHAPE_COUNT: usize = 16;
+/// Vertices per side of each shape grid.
+const SHAPE_SIDE: u32 = 33;
+const SPACING: f32 = 40.0;
+const RAY_COUNT: usize = 1000;
+const WORKER_THREADS: u32 = 4;
+/// Vertices per side of the terrain used for the refit rows.
+const TERRAIN_SIDE: u32 = 256;
+/// Brush radius in terrain cells.
+const BRUSH_CELLS: u32 = 8;
+const RUNS: usize = 5;
+
+const Grid = struct {
+    verts: []scene.CardinalVertex,
+    indices: []u32,
+
+    fn init(allocator: std.mem.Allocator, n: u32, seed: f32) !Grid {
+        const verts = try allocator.alloc(scene.CardinalVertex, n * n);
+        errdefer allocator.free(verts);
+        for (0..n) |z| {
+            for (0..n) |x| {
+                const fx: f32 = @floatFromInt(x);
+                const fz: f32 = @floatFromInt(z);
+                var v = std.mem.zeroes(scene.CardinalVertex);
+                v.px = fx;
+                v.py = 2.0 * @sin(fx * 0.3 + seed) * @cos(fz * 0.2 - seed);
+                v.pz = fz;
+                verts[z * n + x] = v;
+            }
+        }
+        const indices = try allocator.alloc(u32, (n - 1) * (n - 1) * 6);
+        var i: usize = 0;
+        for (0..n - 1) |z| {
+            for (0..n - 1) |x| {
+                const a: u32 = @intCast(z * n + x);
+                for ([_]u32{ a, a + n, a + 1, a + 1, a + n, a + n + 1 }) |vi| {
+                    indices[i] = vi;
+                    i += 1;
+                }
+            }
+        }
+        return .{ .verts = verts, .indices = indices };
+    }
+
+    fn deinit(self: Grid, allocator: std.mem.Allocator) void {
+        allocator.free(self.verts);
+        allocator.free(self.indices);
+    }
+
+    fn mesh(self: Grid) scene.CardinalMesh {
+        var min = [3]f32{ std.math.floatMax(f32), std.math.floatMax(f32), std.math.floatMax(f32) };
+        var max = [3]f32{ -std.math.floatMax(f32), -std.math.floatMax(f32), -std.math.floatMax(f32) };
+        for (self.verts) |v| {
+            for ([3]f32{ v.px, v.py, v.pz }, 0..) |p, axis| {
+                min[axis] = @min(min[axis], p);
+                max[axis] = @max(max[axis], p);
+            }
+        }
+        return .{
+            .vertices = self.verts.ptr,
+            .vertex_count = @intCast(self.verts.len),
+            .indices = self.indices.ptr,
+            .index_count = @intCast(self.indices.len),
+            .material_index = 0,
+            .transform = math.Mat4.identity().data,
+            .visible = true,
+            .morph_targets = null,
+            .morph_target_count = 0,
+            .bounding_box_min = min,
+            .bounding_box_max = max,
+        };
+    }
+
+    fn positions(self: Grid, allocator: std.mem.Allocator) ![]math.Vec3 {
+        const out = try allocator.alloc(math.Vec3, self.verts.len);
+        for (self.verts, out) |v, *p| p.* = .{ .x = v.px, .y = v.py, .z = v.pz };
+        return out;
+    }
+};
+
+const AcceptTriangle = struct {
+    pub fn accept(_: AcceptTriangle, _: u32, _: f32, _: f32) bool {
+        return true;
+    }
+};
+
+fn instance_world(i: usize) math.Mat4 {
+    const side = std.math.sqrt(MESH_COUNT);
+    const x: f32 = @floatFromInt(i % side);
+    const z: f32 = @floatFromInt(i / side);
+    const yaw = @as(f32, @floatFromInt(i % 7)) * 0.4;
+    return math.Mat4.fromTRS(
+        .{ .x = x * SPACING, .y = @as(f32, @floatFromInt(i % 5)), .z = z * SPACING },
+        math.Quat.fromAxisAngle(.{ .x = 0, .y = 1, .z = 0 }, yaw),
+        math.Vec3.one(),
+    );
+}
+
+/// Rays from above the field aimed at random points on it.
+fn make_rays(rays: []math.Ray) void {
+    var prng = std.Random.DefaultPrng.init(47);
+    const random = prng.random();
+    const extent = SPACING * @as(f32, @floatFromInt(std.math.sqrt(MESH_COUNT)));
+    for (rays) |*ray| {
+        const origin = math.Vec3{ .x = random.float(f32) * extent, .y = 150.0, .z = random.float(f32) * extent };
+        const target = math.Vec3{ .x = random.float(f32) * extent, .y = 0.0, .z = random.float(f32) * extent };
+        ray.* = .{ .origin = origin, .direction = target.sub(origin).normalize() };
+    }
+}
+
+/// The old picking loop: every instance's bounds, then its mesh BVH, built on first use.
+const Linear = struct {
+    bvhs: []?pick_bvh.MeshBvh,
+    inv_worlds: []math.Mat4,
+
+    fn pick(self: *Linear, allocator: std.mem.Allocator, meshes: []const scene.CardinalMesh, shapes: []const Grid, ray: math.Ray) !?f32 {
+        var closest: f32 = 10000.0;
+        var found = false;
+        for (meshes, 0..) |*mesh, i| {
+            const inv = self.inv_worlds[i];
+            const local = math.Ray{ .origin = inv.transformPoint(ray.origin), .direction = inv.transformVector(ray.direction) };
+            const bounds = math.AABB{ .min = math.Vec3.fromArray(mesh.bounding_box_min), .max = math.Vec3.fromArray(mesh.bounding_box_max) };
+            _ = math.intersectRayAABB(local, bounds, 0.001, closest) orelse continue;
+
+            if (self.bvhs[i] == null) {
+                const shape = shapes[i % SHAPE_COUNT];
+                const positions = try shape.positions(allocator);
+                defer allocator.free(positions);
+                self.bvhs[i] = try pick_bvh.MeshBvh.build(allocator, positions, shape.indices, pick_bvh.MeshKey.of(mesh));
+            }
+            const hit = self.bvhs[i].?.raycast(mesh, local, 0.001, closest, AcceptTriangle{}) orelse continue;
+            closest = hit.t;
+            found = true;
+        }
+        return if (found) closest else null;
+    }
+
+    fn deinit(self: *Linear, allocator: std.mem.Allocator) void {
+        for (self.bvhs) |*bvh| {
+            if (bvh.*) |*b| b.deinit(allocator);
+        }
+        allocator.free(self.bvhs);
+        allocator.free(self.inv_worlds);
+    }
+};
+
+fn print_row(name: []const u8, ns: u64, count: usize, baseline_ns: u64) void {
+    std.debug.print("  {s:<22} {d:>9.3} ms  {d:>8.2} us/op", .{
+        name,
+        @as(f64, @floatFromInt(ns)) / 1e6,
+        @as(f64, @floatFromInt(ns)) / 1e3 / @as(f64, @floatFromInt(@max(count, 1))),
+    });
+    if (baseline_ns > 0) {
+        std.debug.print("  {d:>7.2}x", .{@as(f64, @floatFromInt(baseline_ns)) / @as(f64, @floatFromInt(@max(ns, 1)))});
+    }
+    std.debug.print("\n", .{});
+}
+
+fn run_picking(allocator: std.mem.Allocator) !void {
+    var shapes: [SHAPE_COUNT]Grid = undefined;
+    var shape_count: usize = 0;
+    defer for (shapes[0..shape_count]) |shape| shape.deinit(allocator);
+    for (&shapes, 0..) |*shape, i| {
+        shape.* = try Grid.init(allocator, SHAPE_SIDE, @floatFromInt(i));
+        shape_count += 1;
+    }
+
+    const meshes = try allocator.alloc(scene.CardinalMesh, MESH_COUNT);
+    defer allocator.free(meshes);
+    for (meshes, 0..) |*mesh, i| mesh.* = shapes[i % SHAPE_COUNT].mesh();
+
+    var rays: [RAY_COUNT]math.Ray = undefined;
+    make_rays(&rays);
+
+    std.debug.print("  {d} meshes x {d} triangles, {d} rays, {d} workers\n", .{
+        MESH_COUNT,
+        (SHAPE_SIDE - 1) * (SHAPE_SIDE - 1) * 2,
+        RAY_COUNT,
+        WORKER_THREADS,
+    });
+
+    // Linear: the first ray builds whatever it touches, the rest reuse it.
+    var linear = Linear{
+        .bvhs = try allocator.alloc(?pick_bvh.MeshBvh, MESH_COUNT),
+        .inv_worlds = try allocator.alloc(math.Mat4, MESH_COUNT),
+    };
+    defer linear.deinit(allocator);
+    @memset(linear.bvhs, null);
+    for (linear.inv_worlds, 0..) |*inv, i| inv.* = instance_world(i).invert().?;
+
+    var timer = try std.time.Timer.start();
+    var linear_hits: usize = 0;
+    for (rays) |ray| {
+        if (try linear.pick(allocator, meshes, &shapes, ray) != null) linear_hits += 1;
+    }
+    const linear_cold_ns = timer.read();
+
+    var linear_warm_ns: u64 = std.math.maxInt(u64);
+    for (0..RUNS) |_| {
+        timer.reset();
+        for (rays) |ray| _ = try linear.pick(allocator, meshes, &shapes, ray);
+        linear_warm_ns = @min(linear_warm_ns, timer.read());
+    }
+
+    // Two-level: bottom levels built on workers, then the instance BVH on the first pick.
+    const config = job_system.JobSystemConfig{
+        .worker_thread_count = WORKER_THREADS,
+        .max_queue_size = 4096,
+        .enable_priority_queue = true,
+    };
+    if (!job_system.init(&config)) return error.JobSystemInitFailed;
+    defer job_system.shutdown();
+
+    var picks = pick_bvh.PickScene{};
+    defer picks.deinit(allocator);
+    try picks.resize(allocator, MESH_COUNT);
+    for (meshes, 0..) |*mesh, i| picks.update_instance(@intCast(i), mesh, instance_world(i));
+
+    timer.reset();
+    picks.prefetch(allocator, meshes, MESH_COUNT);
+    picks.finish_builds(allocator, meshes);
+    const build_ns = timer.read();
+    if (picks.stats.async_builds < MESH_COUNT) std.debug.print("  only {d} builds started on workers\n", .{picks.stats.async_builds});
+
+    var two_level_warm_ns: u64 = std.math.maxInt(u64);
+    var two_level_hits: usize = 0;
+    for (0..RUNS) |_| {
+        two_level_hits = 0;
+        timer.reset();
+        for (rays) |ray| {
+            if (picks.raycast(allocator, meshes, ray, .{}, pick_bvh.AcceptAll{}) != null) two_level_hits += 1;
+        }
+        two_level_warm_ns = @min(two_level_warm_ns, timer.read());
+    }
+
+    print_row("linear, cold", linear_cold_ns, RAY_COUNT, 0);
+    print_row("linear, warm", linear_warm_ns, RAY_COUNT, 0);
+    print_row("two-level, async build", build_ns, MESH_COUNT, 0);
+    print_row("two-level, warm", two_level_warm_ns, RAY_COUNT, linear_warm_ns);
+    if (linear_hits != two_level_hits) std.debug.print("  hit count MISMATCH ({d} vs {d})\n", .{ linear_hits, two_level_hits });
+}
+
+fn run_refit(allocator: std.mem.Allocator) !void {
+    const terrain = try Grid.init(allocator, TERRAIN_SIDE, 0.5);
+    defer terrain.deinit(allocator);
+    const meshes = [_]scene.CardinalMesh{terrain.mesh()};
+
+    var picks = pick_bvh.PickScene{};
+    defer picks.deinit(allocator);
+    try picks.resize(allocator, 1);
+    picks.update_instance(0, &meshes[0], math.Mat4.identity());
+    const probe = math.Ray{ .origin = .{ .x = 100.3, .y = 50, .z = 100.7 }, .direction = .{ .x = 0, .y = -1, .z = 0 } };
+    _ = picks.raycast(allocator, &meshes, probe, .{}, pick_bvh.AcceptAll{});
+
+    // A brush stamp in the middle of the terrain: raise the vertices under it, then refit.
+    const center: u32 = TERRAIN_SIDE / 2;
+    const lo = center - BRUSH_CELLS;
+    const hi = center + BRUSH_CELLS;
+    var region = pick_bvh.everywhere;
+    region.min.x = @floatFromInt(lo - 1);
+    region.max.x = @floatFromInt(hi + 1);
+    region.min.z = region.min.x;
+    region.max.z = region.max.x;
+
+    var refit_ns: u64 = std.math.maxInt(u64);
+    var timer = try std.time.Timer.start();
+    for (0..RUNS) |_| {
+        for (lo..hi + 1) |z| {
+            for (lo..hi + 1) |x| terrain.verts[z * TERRAIN_SIDE + x].py += 0.1;
+        }
+        timer.reset();
+        picks.refit_region(0, &meshes[0], region);
+        refit_ns = @min(refit_ns, timer.read());
+    }
+
+    var rebuild_ns: u64 = std.math.maxInt(u64);
+    for (0..RUNS) |_| {
+        timer.reset();
+        const positions = try terrain.positions(allocator);
+        defer allocator.free(positions);
+        var bvh = try pick_bvh.MeshBvh.build(allocator, positions, terrain.indices, pick_bvh.MeshKey.of(&meshes[0]));
+        bvh.deinit(allocator);
+        rebuild_ns = @min(rebuild_ns, timer.read());
+    }
+
+    std.debug.print("  {d}x{d} terrain, {d}x{d} vertex brush\n", .{ TERRAIN_SIDE, TERRAIN_SIDE, 2 * BRUSH_CELLS + 1, 2 * BRUSH_CELLS + 1 });
+    print_row("full rebuild", rebuild_ns, 1, 0);
+    print_row("region refit", refit_ns, 1, rebuild_ns);
+}
+
+pub fn run(allocator: std.mem.Allocator) !void {
+    try run_picking(allocator);
+    try run_refit(allocator);
+}
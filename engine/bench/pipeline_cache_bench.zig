@@ -0,0 +1,159 @@
+//! Pipeline start-up CPU cost with and without the reflection cache.
+//!
+//! Reflects every SPIR-V module in `assets/shaders` and parses every descriptor in
+//! `assets/pipelines`, which is the CPU work `init_pipelines` does before creating Vulkan
+//! objects. "uncached" calls the reflector and the JSON parser directly; "cold" and "warm" go
+//! through `vulkan_reflection_cache` with an empty cache and with one loaded from a saved blob;
+//! "prewarm" runs `vulkan_reflection_cache.prewarm` on the job system (file reads included).
+//! Must be run from the repository root.
+const std = @import("std");
+const engine = @import("cardinal_engine");
+const job_system = engine.job_system;
+const cache = engine.vulkan_reflection_cache;
+const shader_reflection = engine.vulkan_shader_utils.reflection;
+const vk_pso = engine.vulkan_pso;
+
+const SHADER_DIR = "assets/shaders";
+const PIPELINE_DIR = "assets/pipelines";
+const ROUNDS: usize = 50;
+const WORKER_THREADS: u32 = 4;
+/// VK_SHADER_STAGE_FRAGMENT_BIT; the stage only tags the reflection result.
+const STAGE: u32 = 0x10;
+
+const Assets = struct {
+    shaders: std.ArrayListUnmanaged([]u32) = .{},
+    pipelines: std.ArrayListUnmanaged([]u8) = .{},
+
+    fn load(allocator: std.mem.Allocator) !Assets {
+        var assets = Assets{};
+        errdefer assets.deinit(allocator);
+        var shader_dir = try std.fs.cwd().openDir(SHADER_DIR, .{ .iterate = true });
+        defer shader_dir.close();
+        var it = shader_dir.iterate();
+        while (try it.next()) |entry| {
+            if (entry.kind != .file or !std.mem.endsWith(u8, entry.name, ".spv")) continue;
+            const bytes = try shader_dir.readFileAlloc(allocator, entry.name, 16 * 1024 * 1024);
+            defer allocator.free(bytes);
+            const words = try allocator.alloc(u32, bytes.len / 4);
+            @memcpy(std.mem.sliceAsBytes(words), bytes[0 .. words.len * 4]);
+            try assets.shaders.append(allocator, words);
+        }
+
+        var pipeline_dir = try std.fs.cwd().openDir(PIPELINE_DIR, .{ .iterate = true });
+        defer pipeline_dir.close();
+        it = pipeline_dir.iterate();
+        while (try it.next()) |entry| {
+            if (entry.kind != .file or !std.mem.endsWith(u8, entry.name, ".json")) continue;
+            try assets.pipelines.append(allocator, try pipeline_dir.readFileAlloc(allocator, entry.name, 1024 * 1024));
+        }
+        return assets;
+    }
+
+    fn deinit(self: *Assets, allocator: std.mem.Allocator) void {
+        for (self.shaders.items) |words| allocator.free(words);
+        for (self.pipelines.items) |json| allocator.free(json);
+        self.shaders.deinit(allocator);
+        self.pipelines.deinit(allocator);
+    }
+};
+
+fn run_uncached(allocator: std.mem.Allocator, assets: *const Assets) !void {
+    for (assets.shaders.items) |words| {
+        var result = try shader_reflection.reflect_shader(allocator, words, STAGE);
+        result.deinit();
+    }
+    for (assets.pipelines.items) |json| {
+        const parsed = try std.json.parseFromSlice(vk_pso.PipelineDescriptor, allocator, json, .{ .ignore_unknown_fields = true });
+        parsed.deinit();
+    }
+}
+
+fn run_cached(allocator: std.mem.Allocator, assets: *const Assets) !void {
+    for (assets.shaders.items) |words| {
+        var result = try cache.reflect(allocator, words, STAGE, .{});
+        result.deinit();
+    }
+    for (assets.pipelines.items) |json| {
+        const parsed = try cache.parse_pipeline_descriptor(allocator, json);
+        parsed.deinit();
+    }
+}
+
+fn print_row(name: []const u8, total_ns: u64) void {
+    const per_round_ms = @as(f64, @floatFromInt(total_ns)) / 1e6 / @as(f64, @floatFromInt(ROUNDS));
+    std.debug.print("  {s:<9} {d:>8.3} ms/startup\n", .{ name, per_round_ms });
+}
+
+pub fn run(allocator: std.mem.Allocator) !void {
+    var assets = Assets.load(allocator) catch |err| {
+        std.debug.print("  skipped: cannot read {s} / {s} ({s}); run from the repository root\n", .{ SHADER_DIR, PIPELINE_DIR, @errorName(err) });
+        return;
+    };
+    defer assets.deinit(allocator);
+
+    const job_config = job_system.JobSystemConfig{
+        .worker_thread_count = WORKER_THREADS,
+        .max_queue_size = 256,
+        .enable_priority_queue = true,
+    };
+    if (!job_system.init(&job_config)) return error.JobSystemInitFailed;
+    defer job_system.shutdown();
+    defer cache.clear();
+
+    var uncached_ns: u64 = 0;
+    var cold_ns: u64 = 0;
+    for (0..ROUNDS) |_| {
+        cache.clear();
+        var timer = try std.time.Timer.start();
+        try run_uncached(allocator, &assets);
+        uncached_ns += timer.lap();
+        try run_cached(allocator, &assets);
+        cold_ns += timer.read();
+    }
+
+    const blob = try cache.save_bytes(allocator);
+    defer allocator.free(blob);
+
+    var load_ns: u64 = 0;
+    var warm_ns: u64 = 0;
+    for (0..ROUNDS) |_| {
+        cache.clear();
+        var timer = try std.time.Timer.start();
+        _ = cache.load_bytes(blob);
+        load_ns += timer.lap();
+        try run_cached(allocator, &assets);
+        warm_ns += timer.read();
+    }
+
+    var prewarm_cold_ns: u64 = 0;
+    var prewarm_warm_ns: u64 = 0;
+    var prewarmed = cache.PrewarmResult{};
+    for (0..ROUNDS) |_| {
+        cache.clear();
+        var timer = try std.time.Timer.start();
+        prewarmed = try cache.prewarm(allocator, SHADER_DIR, PIPELINE_DIR);
+        prewarm_cold_ns += timer.lap();
+        cache.clear();
+        _ = cache.load_bytes(blob);
+        _ = timer.lap();
+        _ = try cache.prewarm(allocator, SHADER_DIR, PIPELINE_DIR);
+        prewarm_warm_ns += timer.read();
+    }
+
+    std.debug.print("  {d} shaders, {d} pipeline descriptors, cache blob {d} bytes, {d} workers\n", .{
+        assets.shaders.items.len,
+        assets.pipelines.items.len,
+        blob.len,
+        WORKER_THREADS,
+    });
+    print_row("uncached", uncached_ns);
+    print_row("cold", cold_ns);
+    print_row("warm", warm_ns);
+    print_row("prewarm", prewarm_cold_ns);
+    print_row("prewarm*", prewarm_warm_ns);
+    std.debug.print("  blob load {d:.1} us, warm speedup {d:.1}x, prewarm* = prewarm with a loaded cache ({d} failed)\n", .{
+        @as(f64, @floatFromInt(load_ns)) / 1e3 / @as(f64, @floatFromInt(ROUNDS)),
+        @as(f64, @floatFromInt(uncached_ns)) / @as(f64, @floatFromInt(@max(warm_ns, 1))),
+        prewarmed.failed,
+    });
+}
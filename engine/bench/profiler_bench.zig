@@ -0,0 +1,153 @@
+//! Built-in profiler overhead.
+//!
+//! Runs a synthetic frame (jobs on the job system, each with nested zones around a few
+//! microseconds of work, plus zones on the main thread) with recording off and on, alternating
+//! blocks of frames so clock and thermal drift affect both equally. Reports the frame-time
+//! overhead of recording (the target is under 1%) and the raw cost of a begin/end pair.
+const std = @import("std");
+const engine = @import("cardinal_engine");
+const job_system = engine.job_system;
+const profiler = engine.profiler;
+
+const WORKER_THREADS: u32 = 4;
+const JOBS_PER_FRAME: usize = 32;
+const ZONES_PER_JOB: usize = 8;
+const MAIN_ZONES: usize = 16;
+/// Iterations of busy work inside each zone (a few microseconds).
+const WORK_ITERS: usize = 2000;
+const FRAMES_PER_BLOCK: usize = 20;
+const BLOCKS: usize = 10;
+const PAIR_ITERS: usize = 1_000_000;
+
+fn busy_work(seed: u64) u64 {
+    var x = seed | 1;
+    for (0..WORK_ITERS) |_| {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+    }
+    return x;
+}
+
+const JobData = struct {
+    seed: u64,
+    result: u64 = 0,
+};
+
+fn frame_job(data: ?*anyopaque) callconv(.c) i32 {
+    const job_data: *JobData = @ptrCast(@alignCast(data.?));
+    const outer = profiler.zone("Bench Job");
+    defer outer.end();
+    var acc: u64 = job_data.seed;
+    for (0..ZONES_PER_JOB) |i| {
+        const inner = profiler.zone("Bench Work");
+        acc +%= busy_work(acc +% i);
+        inner.end();
+    }
+    job_data.result = acc;
+    return 0;
+}
+
+fn run_frame(frame: usize, data: *[JOBS_PER_FRAME]JobData, jobs: *std.ArrayListUnmanaged(*job_system.Job)) u64 {
+    const frame_zone = profiler.zone("Bench Frame");
+    defer frame_zone.end();
+
+    jobs.clearRetainingCapacity();
+    for (data, 0..) |*d, i| {
+        d.* = .{ .seed = frame * JOBS_PER_FRAME + i };
+        const job = job_system.create_job(frame_job, d, .NORMAL) orelse {
+            _ = frame_job(d);
+            continue;
+        };
+        job.push_to_completed_queue = false;
+        while (!job_system.submit_job(job)) {
+            std.Thread.yield() catch {};
+        }
+        jobs.appendAssumeCapacity(job);
+    }
+
+    var acc: u64 = 0;
+    for (0..MAIN_ZONES) |i| {
+        const z = profiler.zone("Bench Main");
+        acc +%= busy_work(frame +% i);
+        z.end();
+    }
+
+    job_system.wait_for_jobs(jobs.items);
+    for (jobs.items) |job| job_system.free_job(job);
+    for (data) |d| acc +%= d.result;
+    return acc;
+}
+
+fn pair_cost_ns() u64 {
+    var timer = std.time.Timer.start() catch return 0;
+    for (0..PAIR_ITERS) |_| {
+        const z = profiler.zone("Bench Pair");
+        z.end();
+    }
+    return timer.read();
+}
+
+pub fn run(allocator: std.mem.Allocator) !void {
+    const job_config = job_system.JobSystemConfig{
+        .worker_thread_count = WORKER_THREADS,
+        .max_queue_size = 256,
+        .enable_priority_queue = true,
+    };
+    if (!job_system.init(&job_config)) return error.JobSystemInitFailed;
+    defer job_system.shutdown();
+    defer profiler.set_recording(false);
+
+    var data: [JOBS_PER_FRAME]JobData = undefined;
+    var jobs = std.ArrayListUnmanaged(*job_system.Job){};
+    defer jobs.deinit(allocator);
+    try jobs.ensureTotalCapacity(allocator, JOBS_PER_FRAME);
+
+    // Warm up the workers and register their rings.
+    profiler.set_recording(true);
+    for (0..FRAMES_PER_BLOCK) |frame| {
+        std.mem.doNotOptimizeAway(run_frame(frame, &data, &jobs));
+        profiler.frame_mark();
+    }
+
+    var off_ns: u64 = 0;
+    var on_ns: u64 = 0;
+    var frame: usize = 0;
+    for (0..BLOCKS) |_| {
+        for ([_]bool{ false, true }) |recording| {
+            profiler.set_recording(recording);
+            var timer = try std.time.Timer.start();
+            for (0..FRAMES_PER_BLOCK) |_| {
+                std.mem.doNotOptimizeAway(run_frame(frame, &data, &jobs));
+                profiler.frame_mark();
+                frame += 1;
+            }
+            if (recording) on_ns += timer.read() else off_ns += timer.read();
+        }
+    }
+
+    profiler.set_recording(false);
+    const pair_off_ns = pair_cost_ns();
+    profiler.set_recording(true);
+    const pair_on_ns = pair_cost_ns();
+    profiler.set_recording(false);
+
+    const frames_f: f64 = @floatFromInt(BLOCKS * FRAMES_PER_BLOCK);
+    const off_ms = @as(f64, @floatFromInt(off_ns)) / 1e6 / frames_f;
+    const on_ms = @as(f64, @floatFromInt(on_ns)) / 1e6 / frames_f;
+    const zones_per_frame = 1 + JOBS_PER_FRAME * (ZONES_PER_JOB + 2) + MAIN_ZONES;
+
+    std.debug.print("  {d} jobs x {d} zones + {d} main zones per frame ({d} zones incl. job zones), {d} workers\n", .{
+        JOBS_PER_FRAME,
+        ZONES_PER_JOB,
+        MAIN_ZONES,
+        zones_per_frame,
+        WORKER_THREADS,
+    });
+    std.debug.print("  recording off {d:>7.3} ms/frame\n", .{off_ms});
+    std.debug.print("  recording on  {d:>7.3} ms/frame  overhead {d:.2}%\n", .{ on_ms, (on_ms - off_ms) / @max(off_ms, 1e-9) * 100.0 });
+    std.debug.print("  zone begin/end: {d:.1} ns off, {d:.1} ns recording\n", .{
+        @as(f64, @floatFromInt(pair_off_ns)) / @as(f64, @floatFromInt(PAIR_ITERS)),
+        @as(f64, @floatFromInt(pair_on_ns)) / @as(f64, @floatFromInt(PAIR_ITERS)),
+    });
+}
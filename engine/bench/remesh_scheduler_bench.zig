@@ -0,0 +1,408 @@
+//! Terrain brick remeshing along a scripted camera path: a fixed-cap scheduler versus `RemeshQueue`.
+//!
+//! A `GRID` x `GRID` field of terrain bricks, each with three LODs picked by camera distance. The
+//! camera flies a figure-eight over the field at up to about 160 m/s, and every `SCULPT_EVERY`
+//! frames a sculpt just ahead of it invalidates the bricks it touches. `WORKERS` simulated workers
+//! mesh bricks at a fixed cost per LOD, and submitting a job costs `SUBMIT_NS` of main-thread time.
+//! Time is simulated, so runs are deterministic.
+//!
+//! "fixed" is the editor's previous policy: nearest first among the bricks missing their current
+//! LOD, at most `FIXED_PER_FRAME` submissions per frame. "budgeted" feeds the same bricks into a
+//! `RemeshQueue` with a main-thread time and memory budget, and also prefetches the LOD each brick
+//! will need at the predicted camera position. Both cancel queued jobs a sculpt made stale and keep
+//! at most `MAX_IN_FLIGHT` jobs queued or running. "late" counts brick-frames where a brick in view
+//! lacks the mesh for its current LOD. Latency runs from a brick first needing a LOD to that mesh
+//! landing.
+const std = @import("std");
+const engine = @import("cardinal_engine");
+const math = engine.math;
+const remesh = engine.remesh_scheduler;
+
+const GRID: usize = 64;
+const BRICK: f32 = 32.0;
+const BRICK_CELLS: f32 = 32.0;
+const LODS: usize = 3;
+const LOD0_DIST: f32 = 96.0;
+const LOD1_DIST: f32 = 256.0;
+const VIEW_DIST: f32 = 512.0;
+const FRAMES: usize = 2400;
+const FRAME_NS: u64 = 16_666_667;
+const WORKERS: usize = 4;
+const MAX_IN_FLIGHT: u32 = 8;
+const FIXED_PER_FRAME: usize = 4;
+const SUBMIT_NS: u64 = 150_000;
+const MESH_NS = [LODS]u64{ 6_000_000, 1_000_000, 200_000 };
+const JOB_BYTES = [LODS]u64{ 4 << 20, 1 << 20, 256 << 10 };
+const SCULPT_EVERY: usize = 300;
+const SCULPT_RADIUS: f32 = 64.0;
+const PREFETCH_S: f32 = 0.75;
+
+const NONE = std.math.maxInt(u64);
+
+const Policy = enum { fixed, budgeted };
+
+const Job = struct {
+    brick: u32,
+    lod: u8,
+    generation: u32,
+    submitted_ns: u64,
+};
+
+const Running = struct {
+    job: Job,
+    finish_ns: u64,
+};
+
+const Result = struct {
+    late: u64 = 0,
+    completed: u64 = 0,
+    wasted: u64 = 0,
+    max_submit_ns: u64 = 0,
+    queue_sum: u64 = 0,
+    queue_peak: usize = 0,
+    peak_bytes: u64 = 0,
+    p50_ms: f64 = 0.0,
+    p95_ms: f64 = 0.0,
+    p99_ms: f64 = 0.0,
+};
+
+fn brick_center(b: usize) math.Vec3 {
+    const x: f32 = @floatFromInt(b % GRID);
+    const z: f32 = @floatFromInt(b / GRID);
+    return .{ .x = (x + 0.5) * BRICK, .y = 0.0, .z = (z + 0.5) * BRICK };
+}
+
+fn lod_at(dist: f32) ?usize {
+    if (dist <= LOD0_DIST) return 0;
+    if (dist <= LOD1_DIST) return 1;
+    if (dist <= VIEW_DIST) return 2;
+    return null;
+}
+
+fn camera_at(frame: usize) math.Vec3 {
+    const t = @as(f32, @floatFromInt(frame)) / 60.0;
+    const w = 2.0 * std.math.pi / 40.0;
+    const c = @as(f32, @floatFromInt(GRID)) * BRICK * 0.5;
+    const r = c * 0.7;
+    return .{ .x = c + r * @sin(w * t), .y = 24.0, .z = c + r * 0.5 * @sin(2.0 * w * t) };
+}
+
+const Sim = struct {
+    allocator: std.mem.Allocator,
+    ready: [][LODS]bool,
+    need_since: [][LODS]u64,
+    generation: []u32,
+    in_flight: []bool,
+    fifo: std.ArrayListUnmanaged(Job) = .{},
+    running: std.ArrayListUnmanaged(Running) = .{},
+    worker_free: [WORKERS]u64 = [_]u64{0} ** WORKERS,
+    latencies: std.ArrayListUnmanaged(u64) = .{},
+    result: Result = .{},
+
+    fn init(allocator: std.mem.Allocator) !Sim {
+        const n = GRID * GRID;
+        const ready = try allocator.alloc([LODS]bool, n);
+        errdefer allocator.free(ready);
+        const need_since = try allocator.alloc([LODS]u64, n);
+        errdefer allocator.free(need_since);
+        const generation = try allocator.alloc(u32, n);
+        errdefer allocator.free(generation);
+        const in_flight = try allocator.alloc(bool, n);
+        @memset(ready, [_]bool{false} ** LODS);
+        @memset(need_since, [_]u64{NONE} ** LODS);
+        @memset(generation, 0);
+        @memset(in_flight, false);
+        return .{ .allocator = allocator, .ready = ready, .need_since = need_since, .generation = generation, .in_flight = in_flight };
+    }
+
+    fn deinit(self: *Sim) void {
+        self.allocator.free(self.ready);
+        self.allocator.free(self.need_since);
+        self.allocator.free(self.generation);
+        self.allocator.free(self.in_flight);
+        self.fifo.deinit(self.allocator);
+        self.running.deinit(self.allocator);
+        self.latencies.deinit(self.allocator);
+    }
+
+    fn in_flight_count(self: *const Sim) usize {
+        return self.fifo.items.len + self.running.items.len;
+    }
+
+    fn submit(self: *Sim, brick: usize, lod: usize, now_ns: u64) !void {
+        try self.fifo.append(self.allocator, .{
+            .brick = @intCast(brick),
+            .lod = @intCast(lod),
+            .generation = self.generation[brick],
+            .submitted_ns = now_ns,
+        });
+        self.in_flight[brick] = true;
+    }
+
+    /// Removes the queued job for `brick` if no worker has picked it up yet.
+    fn cancel_queued(self: *Sim, brick: usize) bool {
+        for (self.fifo.items, 0..) |job, i| {
+            if (job.brick != brick) continue;
+            _ = self.fifo.orderedRemove(i);
+            self.in_flight[brick] = false;
+            self.result.wasted += 1;
+            return true;
+        }
+        return false;
+    }
+
+    /// Applies a finished job's mesh; false if a sculpt made it stale and it was dropped.
+    fn land(self: *Sim, job: Job, now_ns: u64) !bool {
+        self.in_flight[job.brick] = false;
+        if (job.generation != self.generation[job.brick]) {
+            self.result.wasted += 1;
+            return false;
+        }
+        self.ready[job.brick][job.lod] = true;
+        self.result.completed += 1;
+        const since = self.need_since[job.brick][job.lod];
+        if (since != NONE) {
+            try self.latencies.append(self.allocator, now_ns - since);
+            self.need_since[job.brick][job.lod] = NONE;
+        }
+        return true;
+    }
+
+    fn sculpt(self: *Sim, point: math.Vec3) void {
+        for (0..GRID * GRID) |b| {
+            if (brick_center(b).sub(point).length() > SCULPT_RADIUS + BRICK) continue;
+            self.generation[b] +%= 1;
+            self.ready[b] = [_]bool{false} ** LODS;
+        }
+    }
+
+    /// Counts bricks in view missing their current LOD and starts their wait.
+    fn track_needs(self: *Sim, cam: math.Vec3, now_ns: u64) void {
+        for (0..GRID * GRID) |b| {
+            const need = lod_at(brick_center(b).sub(cam).length());
+            for (0..LODS) |l| {
+                if (need != null and need.? == l and !self.ready[b][l]) {
+                    self.result.late += 1;
+                    if (self.need_since[b][l] == NONE) self.need_since[b][l] = now_ns;
+                } else {
+                    self.need_since[b][l] = NONE;
+                }
+            }
+        }
+    }
+
+    /// Hands queued jobs to workers that free up before the frame ends.
+    fn run_workers(self: *Sim, frame_end_ns: u64) !void {
+        while (self.fifo.items.len > 0) {
+            var w: usize = 0;
+            for (self.worker_free, 0..) |t, i| {
+                if (t < self.worker_free[w]) w = i;
+            }
+            if (self.worker_free[w] >= frame_end_ns) break;
+            const job = self.fifo.orderedRemove(0);
+            const finish = @max(self.worker_free[w], job.submitted_ns) + MESH_NS[job.lod];
+            self.worker_free[w] = finish;
+            try self.running.append(self.allocator, .{ .job = job, .finish_ns = finish });
+        }
+    }
+
+    fn bytes_in_flight(self: *const Sim) u64 {
+        var total: u64 = 0;
+        for (self.fifo.items) |job| total += JOB_BYTES[job.lod];
+        for (self.running.items) |r| total += JOB_BYTES[r.job.lod];
+        return total;
+    }
+};
+
+const Candidate = struct {
+    brick: usize,
+    lod: usize,
+    score: f32,
+};
+
+fn higher_score(_: void, a: Candidate, b: Candidate) bool {
+    return a.score > b.score;
+}
+
+fn schedule_fixed(sim: *Sim, cam: math.Vec3, now_ns: u64, candidates: *std.ArrayListUnmanaged(Candidate)) !u64 {
+    for (0..GRID * GRID) |b| {
+        if (sim.in_flight[b] and sim.fifo.items.len > 0) {
+            for (sim.fifo.items) |job| {
+                if (job.brick == b and job.generation != sim.generation[b]) {
+                    _ = sim.cancel_queued(b);
+                    break;
+                }
+            }
+        }
+    }
+
+    candidates.clearRetainingCapacity();
+    for (0..GRID * GRID) |b| {
+        if (sim.in_flight[b]) continue;
+        const dist = brick_center(b).sub(cam).length();
+        const lod = lod_at(dist) orelse continue;
+        if (sim.ready[b][lod]) continue;
+        const bonus = @as(f32, @floatFromInt(LODS - 1 - lod)) * 5.0;
+        try candidates.append(sim.allocator, .{ .brick = b, .lod = lod, .score = 1000.0 / (dist + 1.0) + bonus });
+    }
+    sim.result.queue_sum += candidates.items.len;
+    sim.result.queue_peak = @max(sim.result.queue_peak, candidates.items.len);
+    std.sort.pdq(Candidate, candidates.items, {}, higher_score);
+
+    var spent: u64 = 0;
+    var submitted: usize = 0;
+    for (candidates.items) |cand| {
+        if (submitted >= FIXED_PER_FRAME or sim.in_flight_count() >= MAX_IN_FLIGHT) break;
+        try sim.submit(cand.brick, cand.lod, now_ns + spent);
+        spent += SUBMIT_NS;
+        submitted += 1;
+    }
+    return spent;
+}
+
+fn schedule_budgeted(sim: *Sim, queue: *remesh.RemeshQueue(u32), camera: *remesh.CameraPredictor, cam: math.Vec3, now_ns: u64) !u64 {
+    camera.update(cam, now_ns);
+    const view = remesh.View{
+        .position = cam,
+        .predicted = camera.predict(PREFETCH_S),
+        .projection_scale = remesh.projection_scale(std.math.pi / 3.0, 1080.0),
+    };
+
+    for (0..GRID * GRID) |b| {
+        const key: u32 = @intCast(b);
+        const center = brick_center(b);
+        const shown = lod_at(center.sub(cam).length());
+        var lod: ?usize = null;
+        var prefetch = false;
+        if (shown != null and !sim.ready[b][shown.?]) {
+            lod = shown;
+        } else if (lod_at(center.sub(view.predicted).length())) |ahead| {
+            if (!sim.ready[b][ahead]) {
+                lod = ahead;
+                prefetch = true;
+            }
+        }
+        const l = lod orelse {
+            queue.cancel(key);
+            continue;
+        };
+        // Missing meshes count as wrong across the whole brick; prefetches as the coarser cell size.
+        const shown_lod = shown orelse LODS - 1;
+        const cell = BRICK / BRICK_CELLS * @as(f32, @floatFromInt(@as(u32, 1) << @intCast(shown_lod)));
+        try queue.request(key, .{
+            .center = center,
+            .radius = BRICK * 0.87,
+            .geometric_error = if (prefetch) cell else BRICK,
+            .bytes = JOB_BYTES[l],
+            .prefetch = prefetch,
+            .generation = sim.generation[b],
+            .lod = @intCast(l),
+        }, now_ns);
+    }
+
+    while (queue.pop_stale()) |key| {
+        if (sim.cancel_queued(key)) queue.cancelled(key);
+    }
+
+    const s = queue.stats();
+    sim.result.queue_sum += s.queue_depth;
+    sim.result.queue_peak = @max(sim.result.queue_peak, s.queue_depth);
+
+    queue.start_frame();
+    try queue.begin_pass(view, now_ns);
+    var spent: u64 = 0;
+    while (queue.next(now_ns + spent)) |ticket| {
+        try sim.submit(ticket.key, ticket.request.lod, now_ns + spent);
+        try queue.dispatched(ticket.key);
+        spent += SUBMIT_NS;
+    }
+    return spent;
+}
+
+fn run_policy(allocator: std.mem.Allocator, policy: Policy) !Result {
+    var sim = try Sim.init(allocator);
+    defer sim.deinit();
+    var candidates: std.ArrayListUnmanaged(Candidate) = .{};
+    defer candidates.deinit(allocator);
+    var queue = remesh.RemeshQueue(u32).init(allocator, .{
+        .frame_time_ns = 1_000_000,
+        .memory_bytes = 32 << 20,
+        .max_in_flight = MAX_IN_FLIGHT,
+    });
+    defer queue.deinit();
+    var camera = remesh.CameraPredictor{};
+
+    for (0..FRAMES) |frame| {
+        const now: u64 = @as(u64, frame) * FRAME_NS;
+        const cam = camera_at(frame);
+
+        var i: usize = 0;
+        while (i < sim.running.items.len) {
+            const r = sim.running.items[i];
+            if (r.finish_ns > now) {
+                i += 1;
+                continue;
+            }
+            _ = sim.running.swapRemove(i);
+            const landed = try sim.land(r.job, now);
+            if (policy == .budgeted) {
+                if (landed) queue.complete(r.job.brick, now) else queue.cancelled(r.job.brick);
+            }
+        }
+
+        if (frame > 0 and frame % SCULPT_EVERY == 0) {
+            const ahead = camera_at(frame + 30);
+            sim.sculpt(ahead);
+        }
+
+        sim.track_needs(cam, now);
+
+        const spent = switch (policy) {
+            .fixed => try schedule_fixed(&sim, cam, now, &candidates),
+            .budgeted => try schedule_budgeted(&sim, &queue, &camera, cam, now),
+        };
+        sim.result.max_submit_ns = @max(sim.result.max_submit_ns, spent);
+        sim.result.peak_bytes = @max(sim.result.peak_bytes, sim.bytes_in_flight());
+
+        try sim.run_workers(now + FRAME_NS);
+    }
+
+    const lat = sim.latencies.items;
+    if (lat.len > 0) {
+        std.mem.sort(u64, lat, {}, std.sort.asc(u64));
+        sim.result.p50_ms = percentile_ms(lat, 0.50);
+        sim.result.p95_ms = percentile_ms(lat, 0.95);
+        sim.result.p99_ms = percentile_ms(lat, 0.99);
+    }
+    return sim.result;
+}
+
+fn percentile_ms(sorted: []const u64, q: f64) f64 {
+    const i: usize = @intFromFloat(@round(q * @as(f64, @floatFromInt(sorted.len - 1))));
+    return @as(f64, @floatFromInt(sorted[i])) / 1e6;
+}
+
+fn print_row(name: []const u8, r: Result, baseline_late: u64) void {
+    const frames_f: f64 = @floatFromInt(FRAMES);
+    std.debug.print("  {s:<9} late {d:>7} brick-frames  latency p50 {d:>7.1} p95 {d:>7.1} p99 {d:>7.1} ms", .{ name, r.late, r.p50_ms, r.p95_ms, r.p99_ms });
+    if (baseline_late > 0) {
+        std.debug.print("  {d:>5.1}x fewer late", .{@as(f64, @floatFromInt(baseline_late)) / @as(f64, @floatFromInt(@max(r.late, 1)))});
+    }
+    std.debug.print("\n", .{});
+    std.debug.print("            queue avg {d:>6.1} peak {d:>5}  submit max {d:.2} ms/frame  in flight peak {d:.1} MB  meshed {d}  wasted {d}\n", .{
+        @as(f64, @floatFromInt(r.queue_sum)) / frames_f,
+        r.queue_peak,
+        @as(f64, @floatFromInt(r.max_submit_ns)) / 1e6,
+        @as(f64, @floatFromInt(r.peak_bytes)) / (1024.0 * 1024.0),
+        r.completed,
+        r.wasted,
+    });
+}
+
+pub fn run(allocator: std.mem.Allocator) !void {
+    std.debug.print("  {d} bricks, {d} frames, {d} workers, {d} jobs in flight, sculpt every {d} frames\n", .{ GRID * GRID, FRAMES, WORKERS, MAX_IN_FLIGHT, SCULPT_EVERY });
+    const fixed = try run_policy(allocator, .fixed);
+    print_row("fixed", fixed, 0);
+    const budgeted = try run_policy(allocator, .budgeted);
+    print_row("budgeted", budgeted, fixed.late);
+}
@@ -0,0 +1,251 @@
+//! Spatial queries over terrain chunks: linear scans versus `SpatialIndex`.
+//!
+//! A `GRID` x `GRID` field of heightfield chunks, each a `Terrain` + `Transform` entity, like a
+//! large streamed terrain in the editor. "stitch" finds the four edge neighbours of every chunk,
+//! as the terrain wall builder does; the scan looks at every chunk per neighbour, so the linear
+//! stitch is timed on `STITCH_SAMPLE` chunks and scaled up. "brush" gathers the chunks a sculpt
+//! sphere touches, "ray" finds the first chunk box along a ray and "nearest" the `K` closest
+//! chunks. "sync" is the cost of bringing the index up to date after `MOVED` chunks moved,
+//! against rebuilding it.
+const std = @import("std");
+const engine = @import("cardinal_engine");
+const math = engine.math;
+const components = engine.ecs_components;
+const ecs = engine.ecs_registry;
+const spatial = engine.ecs_spatial_index;
+
+const GRID: usize = 100;
+const CHUNK: f32 = 64.0;
+const QUERIES: usize = 1000;
+const STITCH_SAMPLE: usize = 200;
+const BRUSH_RADIUS: f32 = 96.0;
+const K: usize = 8;
+const MOVED: usize = 10;
+const SYNC_ROUNDS: usize = 50;
+
+const Entity = engine.ecs_entity.Entity;
+
+fn terrain_bounds(terr: *const components.Terrain, tr: *const components.Transform) ?math.AABB {
+    const p = tr.position;
+    return .{
+        .min = .{ .x = p.x - terr.size.x * 0.5, .y = p.y - terr.thickness, .z = p.z - terr.size.y * 0.5 },
+        .max = .{ .x = p.x + terr.size.x * 0.5, .y = p.y, .z = p.z + terr.size.y * 0.5 },
+    };
+}
+
+fn is_neighbor(registry: *const ecs.Registry, self_terr: *const components.Terrain, other: Entity, want: math.Vec3) bool {
+    const terr = registry.get_const(components.Terrain, other) orelse return false;
+    if (@abs(terr.size.x - self_terr.size.x) > 0.001 or @abs(terr.size.y - self_terr.size.y) > 0.001) return false;
+    const tr = registry.get_const(components.Transform, other) orelse return false;
+    return @abs(tr.position.x - want.x) <= 0.01 and @abs(tr.position.y - want.y) <= 0.01 and @abs(tr.position.z - want.z) <= 0.01;
+}
+
+fn neighbor_wants(registry: *const ecs.Registry, e: Entity) [4]math.Vec3 {
+    const p = registry.get_const(components.Transform, e).?.position;
+    return .{
+        .{ .x = p.x - CHUNK, .y = p.y, .z = p.z },
+        .{ .x = p.x + CHUNK, .y = p.y, .z = p.z },
+        .{ .x = p.x, .y = p.y, .z = p.z - CHUNK },
+        .{ .x = p.x, .y = p.y, .z = p.z + CHUNK },
+    };
+}
+
+fn stitch_scan(registry: *ecs.Registry, e: Entity) u32 {
+    const self_terr = registry.get_const(components.Terrain, e).?;
+    var found: u32 = 0;
+    for (neighbor_wants(registry, e)) |want| {
+        var it = registry.view(components.Terrain).const_iterator();
+        while (it.next()) |entry| {
+            if (entry.entity.id == e.id) continue;
+            if (is_neighbor(registry, self_terr, entry.entity, want)) {
+                found += 1;
+                break;
+            }
+        }
+    }
+    return found;
+}
+
+fn stitch_index(registry: *ecs.Registry, index: *spatial.SpatialIndex, allocator: std.mem.Allocator, hits: *std.ArrayListUnmanaged(Entity), e: Entity) !u32 {
+    const self_terr = registry.get_const(components.Terrain, e).?;
+    const tol = math.Vec3{ .x = 0.01, .y = 0.01, .z = 0.01 };
+    var found: u32 = 0;
+    for (neighbor_wants(registry, e)) |want| {
+        try index.query_box(.{ .min = want.sub(tol), .max = want.add(tol) }, allocator, hits);
+        for (hits.items) |other| {
+            if (other.id == e.id) continue;
+            if (is_neighbor(registry, self_terr, other, want)) {
+                found += 1;
+                break;
+            }
+        }
+    }
+    return found;
+}
+
+fn elapsed_ms(timer: *std.time.Timer) f64 {
+    return @as(f64, @floatFromInt(timer.read())) / 1e6;
+}
+
+fn print_row(name: []const u8, scan_ms: f64, index_ms: f64, check_scan: u64, check_index: u64) void {
+    std.debug.print("  {s:<8} scan {d:>10.3} ms  index {d:>8.3} ms  {d:>8.1}x", .{ name, scan_ms, index_ms, scan_ms / @max(index_ms, 1e-6) });
+    if (check_scan != check_index) std.debug.print("  MISMATCH ({d} vs {d})", .{ check_scan, check_index });
+    std.debug.print("\n", .{});
+}
+
+pub fn run(allocator: std.mem.Allocator) !void {
+    var registry = ecs.Registry.init(allocator);
+    defer registry.deinit();
+    const entities = try allocator.alloc(Entity, GRID * GRID);
+    defer allocator.free(entities);
+    for (entities, 0..) |*e, i| {
+        e.* = try registry.create();
+        const x: f32 = @floatFromInt(i % GRID);
+        const z: f32 = @floatFromInt(i / GRID);
+        try registry.add(e.*, components.Transform{ .position = .{ .x = x * CHUNK, .y = 0.0, .z = z * CHUNK } });
+        try registry.add(e.*, components.Terrain{ .size = .{ .x = CHUNK, .y = CHUNK } });
+    }
+
+    var index = spatial.SpatialIndex.init(allocator, 0.0);
+    defer index.deinit();
+    var timer = try std.time.Timer.start();
+    try index.sync(&registry, components.Terrain, terrain_bounds);
+    const build_ms = elapsed_ms(&timer);
+    std.debug.print("  {d} chunks, cell size {d:.1}, build {d:.3} ms\n", .{ index.count(), index.cell_size, build_ms });
+
+    var hits: std.ArrayListUnmanaged(Entity) = .{};
+    defer hits.deinit(allocator);
+    var neighbors: std.ArrayListUnmanaged(spatial.Neighbor) = .{};
+    defer neighbors.deinit(allocator);
+    var prng = std.Random.DefaultPrng.init(49);
+    const rng = prng.random();
+    const extent = @as(f32, @floatFromInt(GRID)) * CHUNK;
+
+    // Stitch: the scan is sampled, the index does every chunk; both report the same per-chunk rate.
+    {
+        var check_scan: u64 = 0;
+        var check_index: u64 = 0;
+        const stride = entities.len / STITCH_SAMPLE;
+        timer.reset();
+        for (0..STITCH_SAMPLE) |i| check_scan += stitch_scan(&registry, entities[i * stride]);
+        const scan_ms = elapsed_ms(&timer) * @as(f64, @floatFromInt(entities.len)) / @as(f64, @floatFromInt(STITCH_SAMPLE));
+        for (0..STITCH_SAMPLE) |i| check_index += try stitch_index(&registry, &index, allocator, &hits, entities[i * stride]);
+        timer.reset();
+        var total: u64 = 0;
+        for (entities) |e| total += try stitch_index(&registry, &index, allocator, &hits, e);
+        const index_ms = elapsed_ms(&timer);
+        print_row("stitch", scan_ms, index_ms, check_scan, check_index);
+        std.debug.print("           {d} shared edges over the whole field (scan time extrapolated from {d} chunks)\n", .{ total, STITCH_SAMPLE });
+    }
+
+    const points = try allocator.alloc(math.Vec3, QUERIES);
+    defer allocator.free(points);
+    for (points) |*p| p.* = .{ .x = rng.float(f32) * extent, .y = 0.0, .z = rng.float(f32) * extent };
+
+    // Brush spheres.
+    {
+        var check_scan: u64 = 0;
+        var check_index: u64 = 0;
+        timer.reset();
+        for (points) |p| {
+            var it = registry.view(components.Terrain).const_iterator();
+            while (it.next()) |entry| {
+                const tr = registry.get_const(components.Transform, entry.entity) orelse continue;
+                const b = terrain_bounds(entry.component, tr).?;
+                if (spatial.sphere_intersects_aabb(p, BRUSH_RADIUS, b)) check_scan += 1;
+            }
+        }
+        const scan_ms = elapsed_ms(&timer);
+        timer.reset();
+        for (points) |p| {
+            try index.query_sphere(p, BRUSH_RADIUS, allocator, &hits);
+            check_index += hits.items.len;
+        }
+        print_row("brush", scan_ms, elapsed_ms(&timer), check_scan, check_index);
+    }
+
+    // Rays from above the field, angled down across it.
+    {
+        var rays: [QUERIES]math.Ray = undefined;
+        for (&rays, points) |*r, p| {
+            const target = math.Vec3{ .x = rng.float(f32) * extent, .y = -8.0, .z = rng.float(f32) * extent };
+            const origin = math.Vec3{ .x = p.x, .y = 200.0, .z = p.z };
+            r.* = .{ .origin = origin, .direction = target.sub(origin).normalize() };
+        }
+        var check_scan: u64 = 0;
+        var check_index: u64 = 0;
+        timer.reset();
+        for (rays) |ray| {
+            var best_t: f32 = std.math.floatMax(f32);
+            var it = registry.view(components.Terrain).const_iterator();
+            while (it.next()) |entry| {
+                const tr = registry.get_const(components.Transform, entry.entity) orelse continue;
+                const b = terrain_bounds(entry.component, tr).?;
+                if (math.intersectRayAABB(ray, b, 0.0, best_t)) |t| best_t = @min(best_t, t);
+            }
+            if (best_t < std.math.floatMax(f32)) check_scan += 1;
+        }
+        const scan_ms = elapsed_ms(&timer);
+        timer.reset();
+        for (rays) |ray| {
+            if (index.raycast(ray, std.math.floatMax(f32)) != null) check_index += 1;
+        }
+        print_row("ray", scan_ms, elapsed_ms(&timer), check_scan, check_index);
+    }
+
+    // K nearest chunks.
+    {
+        const dists = try allocator.alloc(f32, entities.len);
+        defer allocator.free(dists);
+        var check_scan: u64 = 0;
+        var check_index: u64 = 0;
+        timer.reset();
+        for (points) |p| {
+            var n: usize = 0;
+            var it = registry.view(components.Terrain).const_iterator();
+            while (it.next()) |entry| {
+                const tr = registry.get_const(components.Transform, entry.entity) orelse continue;
+                const b = terrain_bounds(entry.component, tr).?;
+                const q = math.Vec3{
+                    .x = std.math.clamp(p.x, b.min.x, b.max.x),
+                    .y = std.math.clamp(p.y, b.min.y, b.max.y),
+                    .z = std.math.clamp(p.z, b.min.z, b.max.z),
+                };
+                dists[n] = p.sub(q).length();
+                n += 1;
+            }
+            std.mem.sort(f32, dists[0..n], {}, std.sort.asc(f32));
+            check_scan += @intFromFloat(dists[K - 1]);
+        }
+        const scan_ms = elapsed_ms(&timer);
+        timer.reset();
+        for (points) |p| {
+            try index.nearest(p, K, allocator, &neighbors);
+            check_index += @intFromFloat(neighbors.items[K - 1].distance);
+        }
+        print_row("nearest", scan_ms, elapsed_ms(&timer), check_scan, check_index);
+    }
+
+    // Keeping the index current: move a few chunks up and back, then sync.
+    {
+        var incremental_ns: u64 = 0;
+        for (0..SYNC_ROUNDS) |round| {
+            const dy: f32 = if (round % 2 == 0) 4.0 else -4.0;
+            for (0..MOVED) |_| {
+                const e = entities[rng.uintLessThan(usize, entities.len)];
+                registry.get(components.Transform, e).?.position.y += dy;
+            }
+            timer.reset();
+            try index.sync(&registry, components.Terrain, terrain_bounds);
+            incremental_ns += timer.read();
+        }
+        timer.reset();
+        for (0..SYNC_ROUNDS) |_| {
+            index.clear();
+            try index.sync(&registry, components.Terrain, terrain_bounds);
+        }
+        const rebuild_ms = elapsed_ms(&timer) / @as(f64, @floatFromInt(SYNC_ROUNDS));
+        const incremental_ms = @as(f64, @floatFromInt(incremental_ns)) / 1e6 / @as(f64, @floatFromInt(SYNC_ROUNDS));
+        std.debug.print("  sync     rebuild {d:>7.3} ms  {d} moved {d:>8.3} ms  {d:>8.1}x\n", .{ rebuild_ms, MOVED, incremental_ms, rebuild_ms / @max(incremental_ms, 1e-6) });
+    }
+}
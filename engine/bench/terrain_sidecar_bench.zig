@@ -0,0 +1,264 @@
+//! Terrain sidecars versus the run-length terrain files.
+//!
+//! Builds a 1025x1025 heightfield (height, bottom height, splat, carve alpha) and a 129^3
+//! volume (density with a carved cave, splat) and stores each as run-length-encoded arrays, the
+//! way the editor wrote version 3 volumes, and as a chunked sidecar. Reports file sizes, then
+//! load times for the run-length file, the whole sidecar on one thread and on the job system,
+//! and a partial load of the chunks near one corner. Files written moments earlier are still in
+//! the OS page cache, so load times are decode cost rather than disk latency.
+const std = @import("std");
+const engine = @import("cardinal_engine");
+const terrain_sidecar = engine.terrain_sidecar;
+const job_system = engine.job_system;
+
+const WORK_DIR = ".zig-cache/bench/terrain_sidecar";
+const HEIGHTFIELD_DIMS: u32 = 1025;
+const VOLUME_DIMS: u32 = 129;
+/// Radius of the partial load, in samples.
+const NEAR_RADIUS: f32 = 96.0;
+const LOAD_ITERATIONS: usize = 5;
+
+const Grid = struct {
+    name: []const u8,
+    extent: [3]u32,
+    chunk_extent: [3]u32,
+    sources: []const terrain_sidecar.ChannelSource,
+    targets: []const terrain_sidecar.ChannelTarget,
+
+    fn raw_bytes(self: *const Grid) usize {
+        var total: usize = 0;
+        for (self.sources) |source| total += source.data.len;
+        return total;
+    }
+};
+
+fn ms(ns: u64) f64 {
+    return @as(f64, @floatFromInt(ns)) / 1e6;
+}
+
+fn mib(bytes: u64) f64 {
+    return @as(f64, @floatFromInt(bytes)) / (1024.0 * 1024.0);
+}
+
+/// Writes every channel run-length encoded, prefixed by its encoded length. Floats use the word
+/// coder and byte channels the byte coder, as in the old volumetric files.
+fn write_rle(allocator: std.mem.Allocator, path: []const u8, grid: *const Grid) !u64 {
+    const file = try std.fs.cwd().createFile(path, .{});
+    defer file.close();
+    var total: u64 = 0;
+    for (grid.sources) |source| {
+        const maybe_encoded = if (source.kind == .f32)
+            terrain_sidecar.rle_encode_u32(allocator, std.mem.bytesAsSlice(u32, @as([]align(4) const u8, @alignCast(source.data))))
+        else
+            terrain_sidecar.rle_encode_u8(allocator, source.data);
+        const encoded = maybe_encoded orelse return error.OutOfMemory;
+        defer allocator.free(encoded);
+        var len: [4]u8 = undefined;
+        std.mem.writeInt(u32, &len, @intCast(encoded.len), .little);
+        try file.writeAll(&len);
+        try file.writeAll(encoded);
+        total += 4 + encoded.len;
+    }
+    return total;
+}
+
+fn read_rle(allocator: std.mem.Allocator, path: []const u8, grid: *const Grid) !void {
+    const content = try std.fs.cwd().readFileAlloc(allocator, path, std.math.maxInt(usize));
+    defer allocator.free(content);
+    var off: usize = 0;
+    for (grid.targets) |target| {
+        const len = std.mem.readInt(u32, content[off..][0..4], .little);
+        off += 4;
+        const encoded = content[off .. off + len];
+        off += len;
+        const ok = if (target.kind == .f32)
+            terrain_sidecar.rle_decode_u32(encoded, std.mem.bytesAsSlice(u32, @as([]align(4) u8, @alignCast(target.data))))
+        else
+            terrain_sidecar.rle_decode_u8(encoded, target.data);
+        if (!ok) return error.CorruptRleFile;
+    }
+}
+
+fn time_loads(comptime load: anytype, args: anytype) !u64 {
+    var best: u64 = std.math.maxInt(u64);
+    for (0..LOAD_ITERATIONS) |_| {
+        var timer = try std.time.Timer.start();
+        try @call(.auto, load, args);
+        best = @min(best, timer.read());
+    }
+    return best;
+}
+
+fn load_sidecar(allocator: std.mem.Allocator, path: []const u8, grid: *const Grid) !void {
+    var file = try terrain_sidecar.SidecarFile.open(allocator, path);
+    defer file.close();
+    _ = try file.read_all(allocator, grid.targets);
+}
+
+fn load_sidecar_near(allocator: std.mem.Allocator, path: []const u8, grid: *const Grid, chunk_count: *usize) !void {
+    var file = try terrain_sidecar.SidecarFile.open(allocator, path);
+    defer file.close();
+    const near = try file.chunks_near(allocator, .{ 0.0, 0.0, 0.0 }, NEAR_RADIUS);
+    defer allocator.free(near);
+    _ = try file.read_chunks(allocator, near, grid.targets);
+    chunk_count.* = near.len;
+}
+
+fn verify(grid: *const Grid) !void {
+    for (grid.sources, grid.targets) |source, target| {
+        if (!std.mem.eql(u8, source.data, target.data)) return error.RoundTripMismatch;
+    }
+}
+
+fn run_grid(allocator: std.mem.Allocator, grid: *const Grid) !void {
+    var path_buf: [128]u8 = undefined;
+    const rle_path = try std.fmt.bufPrint(&path_buf, WORK_DIR ++ "/{s}.rle", .{grid.name});
+    var sidecar_buf: [128]u8 = undefined;
+    const sidecar_path = try std.fmt.bufPrint(&sidecar_buf, WORK_DIR ++ "/{s}" ++ terrain_sidecar.SIDECAR_EXTENSION, .{grid.name});
+
+    var timer = try std.time.Timer.start();
+    const rle_bytes = try write_rle(allocator, rle_path, grid);
+    const rle_write_ns = timer.read();
+    timer.reset();
+    const stats = try terrain_sidecar.write_file(allocator, sidecar_path, grid.extent, grid.sources, .{ .chunk_extent = grid.chunk_extent });
+    const sidecar_write_ns = timer.read();
+
+    std.debug.print("  {s}: raw {d:.2} MiB, rle {d:.2} MiB ({d:.1} ms), sidecar {d:.2} MiB in {d} chunks ({d:.1} ms, 1 thread)\n", .{
+        grid.name,
+        mib(grid.raw_bytes()),
+        mib(rle_bytes),
+        ms(rle_write_ns),
+        mib(stats.file_bytes),
+        stats.chunk_count,
+        ms(sidecar_write_ns),
+    });
+
+    const rle_ns = try time_loads(read_rle, .{ allocator, rle_path, grid });
+    try verify(grid);
+    std.debug.print("    load rle            {d:>8.2} ms\n", .{ms(rle_ns)});
+
+    const single_ns = try time_loads(load_sidecar, .{ allocator, sidecar_path, grid });
+    try verify(grid);
+    std.debug.print("    load sidecar 1 thr  {d:>8.2} ms\n", .{ms(single_ns)});
+
+    const workers: u32 = @intCast(@max(std.Thread.getCpuCount() catch 4, 1));
+    const config = job_system.JobSystemConfig{ .worker_thread_count = workers, .max_queue_size = 4096, .enable_priority_queue = false };
+    if (!job_system.init(&config)) return error.JobSystemInitFailed;
+    defer job_system.shutdown();
+
+    const jobs_ns = try time_loads(load_sidecar, .{ allocator, sidecar_path, grid });
+    try verify(grid);
+    std.debug.print("    load sidecar {d:>2} job {d:>8.2} ms\n", .{ workers, ms(jobs_ns) });
+
+    var near_chunks: usize = 0;
+    const near_ns = try time_loads(load_sidecar_near, .{ allocator, sidecar_path, grid, &near_chunks });
+    std.debug.print("    load near corner    {d:>8.2} ms ({d} of {d} chunks within {d:.0} samples)\n", .{ ms(near_ns), near_chunks, stats.chunk_count, NEAR_RADIUS });
+}
+
+fn run_heightfield(allocator: std.mem.Allocator) !void {
+    const dims = HEIGHTFIELD_DIMS;
+    const pix: usize = @as(usize, dims) * dims;
+    const height = try allocator.alloc(f32, pix);
+    defer allocator.free(height);
+    const bottom = try allocator.alloc(f32, pix);
+    defer allocator.free(bottom);
+    const splat = try allocator.alloc(u8, pix * 4);
+    defer allocator.free(splat);
+    const alpha = try allocator.alloc(u8, pix);
+    defer allocator.free(alpha);
+
+    for (0..dims) |y| {
+        for (0..dims) |x| {
+            const i = y * dims + x;
+            const h = terrain_sidecar.synthetic_height(@floatFromInt(x), @floatFromInt(y));
+            height[i] = h;
+            bottom[i] = h - 2.0;
+            // Painted layers follow height bands; a carved hole sits near the middle.
+            const rock: u8 = if (h > 8.0) 255 else if (h > 6.0) 128 else 0;
+            const sand: u8 = if (h < -10.0) 255 else 0;
+            splat[i * 4 ..][0..4].* = .{ 255 - rock, rock, sand, 0 };
+            const dx = @as(f32, @floatFromInt(x)) - 512.0;
+            const dy = @as(f32, @floatFromInt(y)) - 512.0;
+            alpha[i] = if (dx * dx + dy * dy < 40.0 * 40.0) 0 else 255;
+        }
+    }
+
+    const height_out = try allocator.alloc(f32, pix);
+    defer allocator.free(height_out);
+    const bottom_out = try allocator.alloc(f32, pix);
+    defer allocator.free(bottom_out);
+    const splat_out = try allocator.alloc(u8, pix * 4);
+    defer allocator.free(splat_out);
+    const alpha_out = try allocator.alloc(u8, pix);
+    defer allocator.free(alpha_out);
+
+    const sources = [_]terrain_sidecar.ChannelSource{
+        .{ .kind = .f32, .data = std.mem.sliceAsBytes(height) },
+        .{ .kind = .f32, .data = std.mem.sliceAsBytes(bottom) },
+        .{ .kind = .rgba8, .data = splat },
+        .{ .kind = .u8, .data = alpha },
+    };
+    const targets = [_]terrain_sidecar.ChannelTarget{
+        .{ .kind = .f32, .data = std.mem.sliceAsBytes(height_out) },
+        .{ .kind = .f32, .data = std.mem.sliceAsBytes(bottom_out) },
+        .{ .kind = .rgba8, .data = splat_out },
+        .{ .kind = .u8, .data = alpha_out },
+    };
+    const grid = Grid{ .name = "heightfield", .extent = .{ dims, dims, 1 }, .chunk_extent = .{ 64, 64, 1 }, .sources = &sources, .targets = &targets };
+    try run_grid(allocator, &grid);
+}
+
+fn run_volume(allocator: std.mem.Allocator) !void {
+    const dims = VOLUME_DIMS;
+    const vox: usize = @as(usize, dims) * dims * dims;
+    const density = try allocator.alloc(f32, vox);
+    defer allocator.free(density);
+    const splat = try allocator.alloc(u8, vox * 4);
+    defer allocator.free(splat);
+
+    const cave = [3]f32{ 70.0, 40.0, 60.0 };
+    for (0..dims) |z| {
+        for (0..dims) |y| {
+            for (0..dims) |x| {
+                const i = (z * dims + y) * dims + x;
+                const p = [3]f32{ @floatFromInt(x), @floatFromInt(y), @floatFromInt(z) };
+                const surface = 64.0 + 0.5 * terrain_sidecar.synthetic_height(p[0], p[2]);
+                var d = (p[1] - surface) / @as(f32, @floatFromInt(dims));
+                // Carve a spherical cave: union of the air inside the sphere with the terrain air.
+                const dx = p[0] - cave[0];
+                const dy = p[1] - cave[1];
+                const dz = p[2] - cave[2];
+                const sphere = (18.0 - @sqrt(dx * dx + dy * dy + dz * dz)) / @as(f32, @floatFromInt(dims));
+                d = @max(d, sphere);
+                density[i] = d;
+                const layer: u8 = if (p[1] < 50.0) 1 else 0;
+                splat[i * 4 ..][0..4].* = if (layer == 1) .{ 0, 255, 0, 0 } else .{ 255, 0, 0, 0 };
+            }
+        }
+    }
+
+    const density_out = try allocator.alloc(f32, vox);
+    defer allocator.free(density_out);
+    const splat_out = try allocator.alloc(u8, vox * 4);
+    defer allocator.free(splat_out);
+
+    const sources = [_]terrain_sidecar.ChannelSource{
+        .{ .kind = .f32, .data = std.mem.sliceAsBytes(density) },
+        .{ .kind = .rgba8, .data = splat },
+    };
+    const targets = [_]terrain_sidecar.ChannelTarget{
+        .{ .kind = .f32, .data = std.mem.sliceAsBytes(density_out) },
+        .{ .kind = .rgba8, .data = splat_out },
+    };
+    const grid = Grid{ .name = "volume", .extent = .{ dims, dims, dims }, .chunk_extent = .{ 32, 32, 32 }, .sources = &sources, .targets = &targets };
+    try run_grid(allocator, &grid);
+}
+
+pub fn run(allocator: std.mem.Allocator) !void {
+    std.fs.cwd().deleteTree(WORK_DIR) catch {};
+    try std.fs.cwd().makePath(WORK_DIR);
+    defer std.fs.cwd().deleteTree(WORK_DIR) catch {};
+
+    try run_heightfield(allocator);
+    try run_volume(allocator);
+}
@@ -0,0 +1,77 @@
+//! Texture cooker throughput and quality.
+//!
+//! Cooks a synthetic 2048x2048 image (smooth gradients, hard edges and noise) to each block
+//! format, with and without the job system, and reports encode throughput in megapixels per
+//! second over the whole mip chain plus the PSNR of the top level.
+const std = @import("std");
+const engine = @import("cardinal_engine");
+const texture_cooker = engine.texture_cooker;
+const job_system = engine.job_system;
+
+const SIZE: u32 = 2048;
+
+fn make_image(allocator: std.mem.Allocator) ![]u8 {
+    const pixels = try allocator.alloc(u8, @as(usize, SIZE) * SIZE * 4);
+    var prng = std.Random.DefaultPrng.init(1234);
+    const random = prng.random();
+    for (0..SIZE) |y| {
+        for (0..SIZE) |x| {
+            const p = pixels[(y * SIZE + x) * 4 ..][0..4];
+            const edge: u8 = if (((x / 64) + (y / 64)) % 2 == 0) 0 else 48;
+            p[0] = @truncate(x / 8 + edge);
+            p[1] = @truncate(y / 8);
+            p[2] = @truncate((x + y) / 16 + random.uintLessThan(u8, 12));
+            p[3] = 255;
+        }
+    }
+    return pixels;
+}
+
+fn run_pass(allocator: std.mem.Allocator, pixels: []const u8, format: texture_cooker.CookFormat, label: []const u8) !void {
+    const settings = texture_cooker.CookSettings{ .format = format, .srgb = format != .bc5 };
+
+    var timer = try std.time.Timer.start();
+    var cooked = try texture_cooker.cook(allocator, pixels, SIZE, SIZE, settings);
+    defer cooked.deinit();
+    const elapsed_ns = timer.read();
+
+    // A full chain is 4/3 the texels of the top level.
+    const texels = @as(f64, @floatFromInt(SIZE)) * @as(f64, @floatFromInt(SIZE)) * 4.0 / 3.0;
+    const mpix_per_s = texels / 1e6 / (@as(f64, @floatFromInt(elapsed_ns)) / 1e9);
+
+    const decoded = try allocator.alloc(u8, pixels.len);
+    defer allocator.free(decoded);
+    try texture_cooker.decode_level(format, cooked.data, SIZE, SIZE, decoded);
+    const channels: u32 = switch (format) {
+        .bc1 => 3,
+        .bc5 => 2,
+        .bc7 => 4,
+    };
+
+    std.debug.print("  {s:<4} {s:<8} {d:>8.1} ms  {d:>7.2} MPix/s  {d} levels, {d:.2} MiB, top level {d:.2} dB\n", .{
+        @tagName(format),
+        label,
+        @as(f64, @floatFromInt(elapsed_ns)) / 1e6,
+        mpix_per_s,
+        cooked.mip_count,
+        @as(f64, @floatFromInt(cooked.data.len)) / (1024.0 * 1024.0),
+        texture_cooker.psnr(pixels, decoded, channels),
+    });
+}
+
+pub fn run(allocator: std.mem.Allocator) !void {
+    const pixels = try make_image(allocator);
+    defer allocator.free(pixels);
+
+    const formats = [_]texture_cooker.CookFormat{ .bc1, .bc5, .bc7 };
+    for (formats) |format| try run_pass(allocator, pixels, format, "1 thread");
+
+    const workers: u32 = @intCast(@max(std.Thread.getCpuCount() catch 4, 1));
+    const config = job_system.JobSystemConfig{ .worker_thread_count = workers, .max_queue_size = 4096, .enable_priority_queue = false };
+    if (!job_system.init(&config)) return error.JobSystemInitFailed;
+    defer job_system.shutdown();
+
+    var label_buf: [16]u8 = undefined;
+    const label = try std.fmt.bufPrint(&label_buf, "{d} jobs", .{workers});
+    for (formats) |format| try run_pass(allocator, pixels, format, label);
+}
@@ -0,0 +1,96 @@
+//! Device-local buffer upload throughput.
+//!
+//! Creates a headless renderer and uploads many small buffers through
+//! `vk_buffer_create_device_local` three ways: "one-shot" with no staging ring (a staging buffer,
+//! command buffer and fence wait per upload), "ring" with the ring active but no batch (one submit
+//! and wait per upload, no allocations), and "batched" with all uploads in one ring batch. Needs a
+//! Vulkan device; on machines without one the benchmark reports itself skipped (a software ICD
+//! such as lavapipe, selected with `VK_ICD_FILENAMES`, is enough).
+const std = @import("std");
+const engine = @import("cardinal_engine");
+const types = engine.vulkan_types;
+const buffer_mgr = engine.vulkan_buffer_manager;
+const staging_ring = engine.vulkan_staging_ring;
+
+const UPLOADS: usize = 1024;
+const UPLOAD_SIZE: usize = 16 * 1024;
+const RING_CAPACITY: u64 = 16 * 1024 * 1024;
+
+const Mode = enum { one_shot, ring, batched };
+
+const Result = struct {
+    ns: u64 = 0,
+    submits: u64 = 0,
+    failed: usize = 0,
+};
+
+fn run_mode(s: *types.VulkanState, ring: *staging_ring.StagingRing, mode: Mode, data: []const u8, buffers: []types.VulkanBuffer) !Result {
+    _ = staging_ring.set_active(if (mode == .one_shot) null else ring);
+    defer _ = staging_ring.set_active(null);
+
+    const submits_before = ring.get_stats().submits;
+    var result = Result{};
+    var timer = try std.time.Timer.start();
+    if (mode == .batched) ring.begin_batch();
+    for (buffers) |*buffer| {
+        if (!buffer_mgr.vk_buffer_create_device_local(buffer, s.context.device, &s.allocator, s.commands.pools.?[0], s.context.graphics_queue, @ptrCast(data.ptr), data.len, 0, s)) {
+            buffer.* = std.mem.zeroes(types.VulkanBuffer);
+            result.failed += 1;
+        }
+    }
+    if (mode == .batched) ring.end_batch();
+    result.ns = timer.read();
+    result.submits = if (mode == .one_shot) UPLOADS - result.failed else ring.get_stats().submits - submits_before;
+
+    for (buffers) |*buffer| {
+        if (buffer.handle != null) buffer_mgr.vk_buffer_destroy_immediate(buffer, s.context.device, &s.allocator);
+    }
+    return result;
+}
+
+fn print_row(name: []const u8, result: Result, baseline_ns: u64) void {
+    const seconds = @as(f64, @floatFromInt(@max(result.ns, 1))) / 1e9;
+    const megabytes = @as(f64, @floatFromInt(UPLOADS * UPLOAD_SIZE)) / (1024.0 * 1024.0);
+    std.debug.print("  {s:<9} {d:>8.2} ms  {d:>8.1} MB/s  {d:>5} submits  {d:>5.1}x", .{
+        name,
+        @as(f64, @floatFromInt(result.ns)) / 1e6,
+        megabytes / seconds,
+        result.submits,
+        @as(f64, @floatFromInt(baseline_ns)) / @as(f64, @floatFromInt(@max(result.ns, 1))),
+    });
+    if (result.failed > 0) std.debug.print("  ({d} failed)", .{result.failed});
+    std.debug.print("\n", .{});
+}
+
+pub fn run(allocator: std.mem.Allocator) !void {
+    var renderer = types.CardinalRenderer{ ._opaque = null };
+    if (!engine.vulkan_renderer.cardinal_renderer_create_headless(&renderer, 64, 64)) {
+        std.debug.print("  skipped: no Vulkan device (try a software ICD via VK_ICD_FILENAMES)\n", .{});
+        return;
+    }
+    defer engine.vulkan_renderer.cardinal_renderer_destroy(&renderer);
+    const s: *types.VulkanState = @ptrCast(@alignCast(renderer._opaque.?));
+
+    if (!engine.vulkan_allocator.init(&s.allocator, s.context.instance, s.context.physical_device, s.context.device, null, null, null, null, null, false)) {
+        return error.AllocatorInitFailed;
+    }
+
+    const ring = try staging_ring.StagingRing.create(allocator, s, RING_CAPACITY);
+    defer ring.destroy(allocator);
+
+    const data = try allocator.alloc(u8, UPLOAD_SIZE);
+    defer allocator.free(data);
+    for (data, 0..) |*byte, i| byte.* = @truncate(i *% 31);
+
+    const buffers = try allocator.alloc(types.VulkanBuffer, UPLOADS);
+    defer allocator.free(buffers);
+
+    const one_shot = try run_mode(s, ring, .one_shot, data, buffers);
+    const ring_immediate = try run_mode(s, ring, .ring, data, buffers);
+    const batched = try run_mode(s, ring, .batched, data, buffers);
+
+    std.debug.print("  {d} uploads x {d} KB, {d} MB ring\n", .{ UPLOADS, UPLOAD_SIZE / 1024, RING_CAPACITY / (1024 * 1024) });
+    print_row("one-shot", one_shot, one_shot.ns);
+    print_row("ring", ring_immediate, one_shot.ns);
+    print_row("batched", batched, one_shot.ns);
+}
@@ -790,6 +790,8 @@ pub export fn cardinal_animation_system_update(system: ?*CardinalAnimationSystem
             const channel = &animation.channels.?[c_idx];
             const sampler = &animation.samplers.?[channel.sampler_index];
 
+            // Morph weights have one component per target; the model manager samples them per mesh.
+            if (channel.target.path == .WEIGHTS) continue;
             if (all_nodes == null or channel.target.node_index >= all_node_count) continue;
             if (all_nodes.?[channel.target.node_index] == null) continue;
 
@@ -797,10 +799,7 @@ pub export fn cardinal_animation_system_update(system: ?*CardinalAnimationSystem
             const blend_state = &sys.blend_states.?[node_idx];
 
             var result: [4]f32 = undefined;
-            var component_count: u32 = 3;
-            if (channel.target.path == .ROTATION or channel.target.path == .WEIGHTS) {
-                component_count = 4;
-            }
+            const component_count: u32 = if (channel.target.path == .ROTATION) 4 else 3;
 
             if (!sampler_interpolate_cached(sampler, state.current_time, component_count, &result)) continue;
 
@@ -1,12 +1,15 @@
 //! Animation state machine controller.
 //!
 //! Evaluates a simple animation graph (clips and 1D blends) with transitions driven by named
-//! float parameters hashed to u32.
+//! float parameters hashed to u32. Each controller compiles its definition once into a flat
+//! `CompiledGraph`, and per-frame evaluation is a linear pass over pre-resolved indices.
+//! `cardinal_anim_controller_update_batch` updates many controllers on the job system.
 //!
 const std = @import("std");
 const memory = @import("../core/memory.zig");
 const animation = @import("animation.zig");
 const name_hash = @import("../core/name_hash.zig");
+const job_system = @import("../core/job_system.zig");
 const c = @cImport({
     @cInclude("string.h");
     @cInclude("math.h");
@@ -214,6 +217,14 @@ pub const AnimStateMachineDef = extern struct {
 
 const MAX_PARAMS = 32;
 
+/// Sentinel for unresolved animation, state and transition-target indices.
+const NO_INDEX: u32 = std.math.maxInt(u32);
+/// Sentinel for parameters that did not fit in `MAX_PARAMS`; they always read as 0.
+const NO_SLOT: u8 = std.math.maxInt(u8);
+
+/// Controllers per job in `cardinal_anim_controller_update_batch`.
+const CONTROLLERS_PER_JOB = 32;
+
 /// Runtime controller state for an `AnimStateMachineDef`.
 pub const AnimController = extern struct {
     definition: ?*const AnimStateMachineDef,
@@ -236,6 +247,64 @@ pub const AnimController = extern struct {
     /// State-local time used for sampling.
     current_state_time: f32,
     next_state_time: f32,
+
+    /// `definition` compiled against `system`; owned by the controller.
+    graph: ?*CompiledGraph,
+};
+
+const CompiledState = struct {
+    first_node: u32,
+    /// 0 when the state has no root node.
+    node_count: u32,
+    first_transition: u32,
+    transition_count: u32,
+};
+
+const CompiledTransition = struct {
+    target_state: u32,
+    duration: f32,
+    first_condition: u32,
+    condition_count: u32,
+};
+
+const CompiledCondition = struct {
+    param_slot: u8,
+    operator: AnimConditionOp,
+    threshold: f32,
+};
+
+const CompiledNode = struct {
+    type: AnimNodeType,
+    loop: bool = false,
+    speed: f32 = 1.0,
+    /// Index into `system.animations` for clips.
+    animation_index: u32 = NO_INDEX,
+    /// Cached index into `system.states`. The animation system owns and may grow that array, so
+    /// the cache is revalidated on every use.
+    state_index: u32 = NO_INDEX,
+    /// Parameter slot for `Blend1D` nodes.
+    param_slot: u8 = NO_SLOT,
+    /// Range of this blend node's entries in `children`/`thresholds`.
+    first_child: u32 = 0,
+    child_count: u32 = 0,
+};
+
+/// Flat form of a state machine definition bound to one animation system.
+///
+/// Each state's node tree is stored in pre-order, so parents precede their children and a single
+/// forward pass over `nodes` propagates blend weights. Animation names, transition targets and
+/// parameter names are resolved to indices and slots once, when the controller is created.
+pub const CompiledGraph = struct {
+    states: []CompiledState,
+    transitions: []CompiledTransition,
+    conditions: []CompiledCondition,
+    nodes: []CompiledNode,
+    /// Node indices of blend children, sorted by threshold per blend node.
+    children: []u32,
+    /// Blend thresholds, parallel to `children`.
+    thresholds: []f32,
+    /// Per-node weights of the pass in progress.
+    weights: []f32,
 };
 
 /// Hashes a string to u32 for parameter and animation name lookup.
@@ -243,23 +312,165 @@ fn hash_string(str: []const u8) u32 {
     return name_hash.hash_u32_fnv1a(str);
 }
 
-/// Finds an animation index by hashed name.
-fn find_animation_index(system: *animation.CardinalAnimationSystem, name_hash_value: u32) ?u32 {
+/// Returns the slot for `hash`, registering the parameter with value 0 if it is new.
+fn param_slot(ctrl: *AnimController, hash: u32) u8 {
     var i: u32 = 0;
-    while (i < system.animation_count) : (i += 1) {
-        const anim = &system.animations.?[i];
-        if (anim.name) |name_ptr| {
-            const len = c.strlen(name_ptr);
-            const name = name_ptr[0..len];
-            if (hash_string(name) == name_hash_value) {
-                return i;
+    while (i < ctrl.param_count) : (i += 1) {
+        if (ctrl.param_hashes[i] == hash) return @intCast(i);
+    }
+    if (ctrl.param_count >= MAX_PARAMS) return NO_SLOT;
+
+    const slot = ctrl.param_count;
+    ctrl.param_hashes[slot] = hash;
+    ctrl.param_values[slot] = 0.0;
+    ctrl.param_count += 1;
+    return @intCast(slot);
+}
+
+fn param_value(ctrl: *const AnimController, slot: u8) f32 {
+    if (slot >= ctrl.param_count) return 0.0;
+    return ctrl.param_values[slot];
+}
+
+const GraphCompiler = struct {
+    a: std.mem.Allocator,
+    ctrl: *AnimController,
+    /// Name hash per animation in the bound system (0 for unnamed clips).
+    animation_hashes: []u32,
+    has_name: []bool,
+
+    states: std.ArrayListUnmanaged(CompiledState) = .{},
+    transitions: std.ArrayListUnmanaged(CompiledTransition) = .{},
+    conditions: std.ArrayListUnmanaged(CompiledCondition) = .{},
+    nodes: std.ArrayListUnmanaged(CompiledNode) = .{},
+    children: std.ArrayListUnmanaged(u32) = .{},
+    thresholds: std.ArrayListUnmanaged(f32) = .{},
+
+    fn animation_index(self: *const GraphCompiler, hash: u32) u32 {
+        for (self.animation_hashes, self.has_name, 0..) |h, named, i| {
+            if (named and h == hash) return @intCast(i);
+        }
+        return NO_INDEX;
+    }
+
+    fn state_index(def: *const AnimStateMachineDef, hash: u32) u32 {
+        var i: u32 = 0;
+        while (i < def.state_count) : (i += 1) {
+            if (def.states.?[i].name_hash == hash) return i;
+        }
+        return NO_INDEX;
+    }
+
+    fn emit_node(self: *GraphCompiler, node: *const AnimNode) !void {
+        const index = self.nodes.items.len;
+        try self.nodes.append(self.a, .{ .type = node.type });
+
+        switch (node.type) {
+            .Clip => {
+                const compiled = &self.nodes.items[index];
+                compiled.animation_index = self.animation_index(node.animation_name_hash);
+                compiled.loop = node.loop;
+                compiled.speed = node.speed;
+            },
+            .Blend1D => {
+                if (node.child_count == 0 or node.children == null or node.thresholds == null) return;
+                const count: usize = node.child_count;
+                const first = self.children.items.len;
+                try self.children.appendNTimes(self.a, 0, count);
+                try self.thresholds.appendSlice(self.a, node.thresholds.?[0..count]);
+
+                const compiled = &self.nodes.items[index];
+                compiled.param_slot = param_slot(self.ctrl, node.param_hash);
+                compiled.first_child = @intCast(first);
+                compiled.child_count = node.child_count;
+
+                for (node.children.?[0..count], 0..) |*child, i| {
+                    self.children.items[first + i] = @intCast(self.nodes.items.len);
+                    try self.emit_node(child);
+                }
+            },
+        }
+    }
+
+    fn compile(self: *GraphCompiler, def: *const AnimStateMachineDef) !*CompiledGraph {
+        const state_count: usize = if (def.states != null) def.state_count else 0;
+        for (0..state_count) |s| {
+            const state = &def.states.?[s];
+            var compiled = CompiledState{
+                .first_node = @intCast(self.nodes.items.len),
+                .node_count = 0,
+                .first_transition = @intCast(self.transitions.items.len),
+                .transition_count = 0,
+            };
+
+            if (state.root_node) |root| {
+                try self.emit_node(root);
+                compiled.node_count = @intCast(self.nodes.items.len - compiled.first_node);
+            }
+
+            if (state.transitions) |transitions| {
+                for (transitions[0..state.transition_count]) |*trans| {
+                    const first_condition = self.conditions.items.len;
+                    if (trans.conditions) |conditions| {
+                        for (conditions[0..trans.condition_count]) |cond| {
+                            try self.conditions.append(self.a, .{
+                                .param_slot = param_slot(self.ctrl, cond.param_hash),
+                                .operator = cond.operator,
+                                .threshold = cond.threshold,
+                            });
+                        }
+                    }
+                    try self.transitions.append(self.a, .{
+                        .target_state = state_index(def, trans.target_state_hash),
+                        .duration = trans.duration,
+                        .first_condition = @intCast(first_condition),
+                        .condition_count = @intCast(self.conditions.items.len - first_condition),
+                    });
+                }
+                compiled.transition_count = @intCast(self.transitions.items.len - compiled.first_transition);
             }
+
+            try self.states.append(self.a, compiled);
         }
+
+        const graph = try self.a.create(CompiledGraph);
+        graph.* = .{
+            .states = try self.states.toOwnedSlice(self.a),
+            .transitions = try self.transitions.toOwnedSlice(self.a),
+            .conditions = try self.conditions.toOwnedSlice(self.a),
+            .nodes = try self.nodes.toOwnedSlice(self.a),
+            .children = try self.children.toOwnedSlice(self.a),
+            .thresholds = try self.thresholds.toOwnedSlice(self.a),
+            .weights = undefined,
+        };
+        graph.weights = try self.a.alloc(f32, graph.nodes.len);
+        return graph;
     }
-    return null;
+};
+
+/// Compiles a normalized definition for `ctrl.system`. Allocations live in `a`.
+fn compile_graph(a: std.mem.Allocator, ctrl: *AnimController, def: *const AnimStateMachineDef) !*CompiledGraph {
+    const system = ctrl.system.?;
+    const animation_count: usize = if (system.animations != null) system.animation_count else 0;
+
+    var compiler = GraphCompiler{
+        .a = a,
+        .ctrl = ctrl,
+        .animation_hashes = try a.alloc(u32, animation_count),
+        .has_name = try a.alloc(bool, animation_count),
+    };
+    for (0..animation_count) |i| {
+        const name_ptr = system.animations.?[i].name;
+        compiler.has_name[i] = name_ptr != null;
+        compiler.animation_hashes[i] = if (name_ptr) |n| hash_string(std.mem.span(n)) else 0;
+    }
+    return compiler.compile(def);
 }
 
 /// Allocates a controller for `def` and binds it to an animation system.
+///
+/// The definition is copied, normalized and compiled against `system`'s current animations, so
+/// clips added to the system afterwards are not picked up by this controller.
 pub export fn cardinal_anim_controller_create(def: ?*const AnimStateMachineDef, system: ?*animation.CardinalAnimationSystem) callconv(.c) ?*AnimController {
     if (def == null or system == null) return null;
 
@@ -271,30 +482,30 @@ pub export fn cardinal_anim_controller_create(def: ?*const AnimStateMachineDef,
     controller.system = system;
 
     const zig_alloc = allocator.as_allocator();
-    var owned_data: ?OwnedControllerData = null;
-    {
-        var arena = std.heap.ArenaAllocator.init(zig_alloc);
+    var arena = std.heap.ArenaAllocator.init(zig_alloc);
+    const owned_def = blk: {
         const a = arena.allocator();
-        const copied = clone_definition(a, def.?) catch null;
-        if (copied) |d| {
-            normalize_definition(d);
-            owned_data = .{ .arena = arena, .def = d };
-            controller.definition = d;
-        } else {
-            arena.deinit();
-            controller.definition = def;
-        }
-    }
+        const copied = clone_definition(a, def.?) catch break :blk null;
+        normalize_definition(copied);
+        controller.graph = compile_graph(a, controller, copied) catch break :blk null;
+        break :blk copied;
+    };
 
-    if (owned_data) |data| {
+    const registered = if (owned_def != null) blk: {
         g_owned_mutex.lock();
         defer g_owned_mutex.unlock();
-        _ = g_owned.put(zig_alloc, controller, data) catch {
-            data.arena.deinit();
-            controller.definition = def;
-        };
+        g_owned.put(zig_alloc, controller, .{ .arena = arena, .def = owned_def.? }) catch break :blk false;
+        break :blk true;
+    } else false;
+
+    if (!registered) {
+        arena.deinit();
+        memory.cardinal_free(allocator, controller);
+        return null;
     }
 
+    controller.definition = owned_def;
+
     var i: u32 = 0;
     const resolved_def = controller.definition.?;
     while (i < resolved_def.state_count) : (i += 1) {
@@ -326,143 +537,125 @@ pub export fn cardinal_anim_controller_set_param(controller: ?*AnimController, n
     if (controller == null or name == null) return;
     const ctrl = controller.?;
     const len = c.strlen(name);
-    const hash = hash_string(name.?[0..len]);
+    const slot = param_slot(ctrl, hash_string(name.?[0..len]));
+    if (slot != NO_SLOT) ctrl.param_values[slot] = value;
+}
 
+fn find_animation_state(system: *animation.CardinalAnimationSystem, animation_index: u32) ?u32 {
     var i: u32 = 0;
-    while (i < ctrl.param_count) : (i += 1) {
-        if (ctrl.param_hashes[i] == hash) {
-            ctrl.param_values[i] = value;
-            return;
-        }
+    while (i < system.state_count) : (i += 1) {
+        if (system.states.?[i].animation_index == animation_index) return i;
     }
+    return null;
+}
 
-    if (ctrl.param_count < MAX_PARAMS) {
-        ctrl.param_hashes[ctrl.param_count] = hash;
-        ctrl.param_values[ctrl.param_count] = value;
-        ctrl.param_count += 1;
+/// Returns the playback state for a clip node, starting playback if the clip has none yet.
+fn resolve_animation_state(system: *animation.CardinalAnimationSystem, node: *CompiledNode, weight: f32) ?*animation.CardinalAnimationState {
+    if (node.state_index < system.state_count) {
+        const cached = &system.states.?[node.state_index];
+        if (cached.animation_index == node.animation_index) return cached;
     }
-}
 
-fn get_param_value(ctrl: *AnimController, hash: u32) f32 {
-    var i: u32 = 0;
-    while (i < ctrl.param_count) : (i += 1) {
-        if (ctrl.param_hashes[i] == hash) {
-            return ctrl.param_values[i];
-        }
+    var found = find_animation_state(system, node.animation_index);
+    if (found == null and animation.cardinal_animation_play(system, node.animation_index, node.loop, weight)) {
+        found = find_animation_state(system, node.animation_index);
     }
-    return 0.0;
+    const index = found orelse return null;
+    node.state_index = index;
+    return &system.states.?[index];
 }
 
-fn evaluate_node(ctrl: *AnimController, node: *const AnimNode, time: f32, weight: f32) void {
-    if (weight <= 0.001) return;
-
-    switch (node.type) {
-        .Clip => {
-            const anim_idx = find_animation_index(ctrl.system.?, node.animation_name_hash);
-            if (anim_idx) |idx| {
-                var found_state: ?*animation.CardinalAnimationState = null;
-                var i: u32 = 0;
-                while (i < ctrl.system.?.state_count) : (i += 1) {
-                    if (ctrl.system.?.states.?[i].animation_index == idx) {
-                        found_state = &ctrl.system.?.states.?[i];
-                        break;
-                    }
-                }
+fn apply_clip(system: *animation.CardinalAnimationSystem, node: *CompiledNode, time: f32, weight: f32) void {
+    if (node.animation_index == NO_INDEX) return;
+    const state = resolve_animation_state(system, node, weight) orelse return;
 
-                if (found_state == null) {
-                    if (animation.cardinal_animation_play(ctrl.system, idx, node.loop, weight)) {
-                        var j: u32 = 0;
-                        while (j < ctrl.system.?.state_count) : (j += 1) {
-                            if (ctrl.system.?.states.?[j].animation_index == idx) {
-                                found_state = &ctrl.system.?.states.?[j];
-                                break;
-                            }
-                        }
-                    }
-                }
+    const anim = &system.animations.?[node.animation_index];
+    if (anim.duration > 0) {
+        var t = time * node.speed;
+        if (node.loop) {
+            t = @mod(t, anim.duration);
+        } else {
+            if (t > anim.duration) t = anim.duration;
+        }
+        state.current_time = t;
+    }
 
-                if (found_state) |state| {
-                    const anim = &ctrl.system.?.animations.?[idx];
-                    if (anim.duration > 0) {
-                        var t = time * node.speed;
-                        if (node.loop) {
-                            t = @mod(t, anim.duration);
-                        } else {
-                            if (t > anim.duration) t = anim.duration;
-                        }
-                        state.current_time = t;
-                    }
+    state.blend_weight = weight;
+    state.is_playing = true;
+    state.playback_speed = 0.0;
+}
 
-                    state.blend_weight = weight;
-                    state.is_playing = true;
-                    state.playback_speed = 0.0;
-                }
-            }
-        },
-        .Blend1D => {
-            if (node.child_count == 0 or node.children == null or node.thresholds == null) return;
-            const param_val = get_param_value(ctrl, node.param_hash);
-
-            if (node.child_count == 1) {
-                evaluate_node(ctrl, &node.children.?[0], time, weight);
-                return;
-            }
+/// Splits `weight` between the two children whose thresholds bracket the blend parameter.
+fn apply_blend(ctrl: *const AnimController, graph: *CompiledGraph, node: *const CompiledNode, weight: f32) void {
+    if (node.child_count == 0) return;
+    const children = graph.children[node.first_child..][0..node.child_count];
+    if (node.child_count == 1) {
+        graph.weights[children[0]] = weight;
+        return;
+    }
 
-            const count: u32 = node.child_count;
-            var low_idx: ?u32 = null;
-            var high_idx: ?u32 = null;
-            var low_thr: f32 = -std.math.inf(f32);
-            var high_thr: f32 = std.math.inf(f32);
+    const value = param_value(ctrl, node.param_slot);
+    if (std.math.isNan(value)) return;
 
-            var i: u32 = 0;
-            while (i < count) : (i += 1) {
-                var thr = node.thresholds.?[i];
-                if (std.math.isNan(thr)) thr = 0.0;
+    // Thresholds are strictly increasing after normalization.
+    const thresholds = graph.thresholds[node.first_child..][0..node.child_count];
+    var high: usize = 0;
+    while (high < thresholds.len and thresholds[high] < value) : (high += 1) {}
 
-                if (thr <= param_val and thr > low_thr) {
-                    low_thr = thr;
-                    low_idx = i;
-                }
-                if (thr >= param_val and thr < high_thr) {
-                    high_thr = thr;
-                    high_idx = i;
-                }
-            }
+    if (high == thresholds.len) {
+        graph.weights[children[high - 1]] = weight;
+    } else if (high == 0 or thresholds[high] == value) {
+        graph.weights[children[high]] = weight;
+    } else {
+        const low = high - 1;
+        const denom = thresholds[high] - thresholds[low];
+        var t: f32 = 0.0;
+        if (denom > 0.0001) t = std.math.clamp((value - thresholds[low]) / denom, 0.0, 1.0);
+        graph.weights[children[low]] = weight * (1.0 - t);
+        graph.weights[children[high]] = weight * t;
+    }
+}
 
-            if (low_idx == null and high_idx == null) return;
-
-            var idx_a: u32 = undefined;
-            var idx_b: u32 = undefined;
-            var t: f32 = 0.0;
-
-            if (low_idx == null) {
-                idx_a = high_idx.?;
-                idx_b = high_idx.?;
-            } else if (high_idx == null) {
-                idx_a = low_idx.?;
-                idx_b = low_idx.?;
-            } else {
-                idx_a = low_idx.?;
-                idx_b = high_idx.?;
-                const denom = high_thr - low_thr;
-                if (idx_a != idx_b and denom > 0.0001) {
-                    t = (param_val - low_thr) / denom;
-                    if (t < 0.0) t = 0.0;
-                    if (t > 1.0) t = 1.0;
-                }
-            }
+/// Evaluates one state's node range in a single forward pass.
+fn evaluate_state(ctrl: *AnimController, graph: *CompiledGraph, state_index: u32, time: f32, weight: f32) void {
+    const state = graph.states[state_index];
+    if (state.node_count == 0) return;
+
+    const first = state.first_node;
+    const end = first + state.node_count;
+    @memset(graph.weights[first..end], 0.0);
+    graph.weights[first] = weight;
+
+    const system = ctrl.system.?;
+    var i = first;
+    while (i < end) : (i += 1) {
+        const w = graph.weights[i];
+        if (w <= 0.001) continue;
+        const node = &graph.nodes[i];
+        switch (node.type) {
+            .Clip => apply_clip(system, node, time, w),
+            .Blend1D => apply_blend(ctrl, graph, node, w),
+        }
+    }
+}
 
-            evaluate_node(ctrl, &node.children.?[idx_a], time, weight * (1.0 - t));
-            evaluate_node(ctrl, &node.children.?[idx_b], time, weight * t);
-        },
+fn transition_ready(ctrl: *const AnimController, graph: *const CompiledGraph, trans: CompiledTransition) bool {
+    for (graph.conditions[trans.first_condition..][0..trans.condition_count]) |cond| {
+        const val = param_value(ctrl, cond.param_slot);
+        const met = switch (cond.operator) {
+            .Greater => val > cond.threshold,
+            .Less => val < cond.threshold,
+            .Equal => @abs(val - cond.threshold) < 0.001,
+            .NotEqual => @abs(val - cond.threshold) >= 0.001,
+        };
+        if (!met) return false;
     }
+    return true;
 }
 
-/// Advances controller time, resolves transitions, and updates animation blend weights.
-pub export fn cardinal_anim_controller_update(controller: ?*AnimController, delta_time: f32) callconv(.c) void {
-    if (controller == null) return;
-    const ctrl = controller.?;
-    const def = ctrl.definition.?;
+fn update_controller(ctrl: *AnimController, delta_time: f32) void {
+    const graph = ctrl.graph orelse return;
+    if (ctrl.current_state_index >= graph.states.len) return;
 
     if (ctrl.system) |sys| {
         var i: u32 = 0;
@@ -472,44 +665,15 @@ pub export fn cardinal_anim_controller_update(controller: ?*AnimController, delt
     }
 
     if (!ctrl.is_transitioning) {
-        const current_state = &def.states.?[ctrl.current_state_index];
-        var i: u32 = 0;
-        while (i < current_state.transition_count) : (i += 1) {
-            const trans = &current_state.transitions.?[i];
-
-            var all_met = true;
-            var c_idx: u32 = 0;
-            while (c_idx < trans.condition_count) : (c_idx += 1) {
-                const cond = &trans.conditions.?[c_idx];
-                const val = get_param_value(ctrl, cond.param_hash);
-
-                const met = switch (cond.operator) {
-                    .Greater => val > cond.threshold,
-                    .Less => val < cond.threshold,
-                    .Equal => @abs(val - cond.threshold) < 0.001,
-                    .NotEqual => @abs(val - cond.threshold) >= 0.001,
-                };
-
-                if (!met) {
-                    all_met = false;
-                    break;
-                }
-            }
-
-            if (all_met) {
-                var next_idx: u32 = 0;
-                while (next_idx < def.state_count) : (next_idx += 1) {
-                    if (def.states.?[next_idx].name_hash == trans.target_state_hash) {
-                        ctrl.is_transitioning = true;
-                        ctrl.next_state_index = next_idx;
-                        ctrl.transition_time = 0.0;
-                        ctrl.transition_duration = trans.duration;
-                        ctrl.next_state_time = 0.0;
-                        break;
-                    }
-                }
-                if (ctrl.is_transitioning) break;
-            }
+        const current_state = graph.states[ctrl.current_state_index];
+        for (graph.transitions[current_state.first_transition..][0..current_state.transition_count]) |trans| {
+            if (trans.target_state == NO_INDEX or !transition_ready(ctrl, graph, trans)) continue;
+            ctrl.is_transitioning = true;
+            ctrl.next_state_index = trans.target_state;
+            ctrl.transition_time = 0.0;
+            ctrl.transition_duration = trans.duration;
+            ctrl.next_state_time = 0.0;
+            break;
         }
     }
 
@@ -528,23 +692,249 @@ pub export fn cardinal_anim_controller_update(controller: ?*AnimController, delt
             ctrl.current_state_time = ctrl.next_state_time;
             ctrl.is_transitioning = false;
 
-            if (def.states.?[ctrl.current_state_index].root_node) |node| {
-                evaluate_node(ctrl, node, ctrl.current_state_time, 1.0);
-            }
+            evaluate_state(ctrl, graph, ctrl.current_state_index, ctrl.current_state_time, 1.0);
         } else {
-            const w_next = t;
-            const w_curr = 1.0 - t;
-
-            if (def.states.?[ctrl.current_state_index].root_node) |node| {
-                evaluate_node(ctrl, node, ctrl.current_state_time, w_curr);
-            }
-            if (def.states.?[ctrl.next_state_index].root_node) |node| {
-                evaluate_node(ctrl, node, ctrl.next_state_time, w_next);
-            }
+            evaluate_state(ctrl, graph, ctrl.current_state_index, ctrl.current_state_time, 1.0 - t);
+            evaluate_state(ctrl, graph, ctrl.next_state_index, ctrl.next_state_time, t);
         }
     } else {
-        if (def.states.?[ctrl.current_state_index].root_node) |node| {
-            evaluate_node(ctrl, node, ctrl.current_state_time, 1.0);
+        evaluate_state(ctrl, graph, ctrl.current_state_index, ctrl.current_state_time, 1.0);
+    }
+}
+
+/// Advances controller time, resolves transitions, and updates animation blend weights.
+pub export fn cardinal_anim_controller_update(controller: ?*AnimController, delta_time: f32) callconv(.c) void {
+    if (controller == null) return;
+    update_controller(controller.?, delta_time);
+}
+
+const UpdateBatch = struct {
+    controllers: []const *AnimController,
+    delta_time: f32,
+
+    fn run(self: *const UpdateBatch) void {
+        for (self.controllers) |ctrl| update_controller(ctrl, self.delta_time);
+    }
+
+    fn job(data: ?*anyopaque) callconv(.c) i32 {
+        const self: *const UpdateBatch = @ptrCast(@alignCast(data));
+        self.run();
+        return 0;
+    }
+};
+
+fn system_address(ctrl: *const AnimController) usize {
+    return if (ctrl.system) |s| @intFromPtr(s) else 0;
+}
+
+fn update_batched(a: std.mem.Allocator, controllers: []const ?*AnimController, delta_time: f32) !void {
+    var order = std.ArrayListUnmanaged(*AnimController){};
+    defer order.deinit(a);
+    try order.ensureTotalCapacity(a, controllers.len);
+    for (controllers) |ctrl| {
+        if (ctrl) |p| order.appendAssumeCapacity(p);
+    }
+
+    // Controllers sharing an animation system write the same states; group them so each group
+    // runs on one thread. The sort is stable, so a group still updates in caller order.
+    std.mem.sort(*AnimController, order.items, {}, struct {
+        fn less_than(_: void, lhs: *AnimController, rhs: *AnimController) bool {
+            return system_address(lhs) < system_address(rhs);
+        }
+    }.less_than);
+
+    var batches = std.ArrayListUnmanaged(UpdateBatch){};
+    defer batches.deinit(a);
+    var start: usize = 0;
+    while (start < order.items.len) {
+        var end = @min(start + CONTROLLERS_PER_JOB, order.items.len);
+        while (end < order.items.len and system_address(order.items[end]) == system_address(order.items[end - 1])) end += 1;
+        try batches.append(a, .{ .controllers = order.items[start..end], .delta_time = delta_time });
+        start = end;
+    }
+
+    var jobs = std.ArrayListUnmanaged(*job_system.Job){};
+    defer jobs.deinit(a);
+    try jobs.ensureTotalCapacity(a, batches.items.len);
+
+    for (batches.items) |*batch| {
+        const job = job_system.create_job(UpdateBatch.job, batch, .NORMAL) orelse {
+            batch.run();
+            continue;
+        };
+        job.push_to_completed_queue = false;
+        while (!job_system.submit_job(job)) {
+            std.Thread.yield() catch {};
+        }
+        jobs.appendAssumeCapacity(job);
+    }
+
+    job_system.wait_for_jobs(jobs.items);
+    for (jobs.items) |job| job_system.free_job(job);
+}
+
+/// Updates `count` controllers, spread over the job system when it is running.
+///
+/// Controllers bound to the same animation system are updated on one thread, in array order.
+/// Null entries are skipped. Equivalent to calling `cardinal_anim_controller_update` on each.
+pub export fn cardinal_anim_controller_update_batch(controllers: ?[*]const ?*AnimController, count: u32, delta_time: f32) callconv(.c) void {
+    if (controllers == null or count == 0) return;
+    const list = controllers.?[0..count];
+
+    if (count > CONTROLLERS_PER_JOB and job_system.get_worker_count() > 0) {
+        const allocator = memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
+        if (update_batched(allocator, list, delta_time)) |_| {
+            return;
+        } else |_| {}
+    }
+
+    for (list) |ctrl| {
+        if (ctrl) |p| update_controller(p, delta_time);
+    }
+}
+
+const TestClips = struct {
+    const names = [_][:0]const u8{ "idle", "walk", "run", "jump" };
+
+    fn create_system() !*animation.CardinalAnimationSystem {
+        const system = animation.cardinal_animation_system_create(names.len, 0) orelse return error.OutOfMemory;
+        for (names) |name| {
+            const anim = std.mem.zeroInit(animation.CardinalAnimation, .{ .name = @constCast(name.ptr), .duration = 2.0 });
+            _ = animation.cardinal_animation_system_add_animation(system, &anim);
+        }
+        return system;
+    }
+
+    fn weight(system: *animation.CardinalAnimationSystem, name: []const u8) f32 {
+        for (names, 0..) |n, i| {
+            if (!std.mem.eql(u8, n, name)) continue;
+            const state = find_animation_state(system, @intCast(i)) orelse return 0.0;
+            return system.states.?[state].blend_weight;
+        }
+        return 0.0;
+    }
+
+    fn clip(name: []const u8) AnimNode {
+        return .{ .type = .Clip, .animation_name_hash = hash_string(name), .loop = true, .speed = 1.0, .param_hash = 0, .child_count = 0, .children = null, .thresholds = null };
+    }
+};
+
+/// Locomotion blend (thresholds given out of order) with a conditional transition to Jump.
+fn test_definition(children: *[3]AnimNode, thresholds: *[3]f32, root: *AnimNode, conditions: *[1]AnimCondition, transitions: *[1]AnimTransition, jump_root: *AnimNode, states: *[2]AnimState) AnimStateMachineDef {
+    children.* = .{ TestClips.clip("run"), TestClips.clip("idle"), TestClips.clip("walk") };
+    thresholds.* = .{ 4.0, 0.0, 1.0 };
+    root.* = .{ .type = .Blend1D, .animation_name_hash = 0, .loop = true, .speed = 1.0, .param_hash = hash_string("speed"), .child_count = 3, .children = children, .thresholds = thresholds };
+    conditions.* = .{.{ .param_hash = hash_string("jump"), .operator = .Greater, .threshold = 0.5 }};
+    transitions.* = .{.{ .target_state_hash = hash_string("Jump"), .duration = 0.5, .conditions = conditions, .condition_count = 1 }};
+    jump_root.* = TestClips.clip("jump");
+    states.* = .{
+        .{ .name_hash = hash_string("Locomotion"), .root_node = root, .transitions = transitions, .transition_count = 1 },
+        .{ .name_hash = hash_string("Jump"), .root_node = jump_root, .transitions = null, .transition_count = 0 },
+    };
+    return .{ .states = states, .state_count = 2, .start_state_hash = hash_string("Locomotion") };
+}
+
+test "compiled controller blends by parameter and cross-fades transitions" {
+    memory.cardinal_memory_init(1024 * 1024);
+    defer memory.cardinal_memory_shutdown();
+
+    var children: [3]AnimNode = undefined;
+    var thresholds: [3]f32 = undefined;
+    var root: AnimNode = undefined;
+    var conditions: [1]AnimCondition = undefined;
+    var transitions: [1]AnimTransition = undefined;
+    var jump_root: AnimNode = undefined;
+    var states: [2]AnimState = undefined;
+    const def = test_definition(&children, &thresholds, &root, &conditions, &transitions, &jump_root, &states);
+
+    const system = try TestClips.create_system();
+    defer animation.cardinal_animation_system_destroy(system);
+    const ctrl = cardinal_anim_controller_create(&def, system) orelse return error.OutOfMemory;
+    defer cardinal_anim_controller_destroy(ctrl);
+
+    // Both referenced parameters are pre-registered so evaluation indexes slots directly.
+    try std.testing.expectEqual(@as(u32, 2), ctrl.param_count);
+
+    cardinal_anim_controller_set_param(ctrl, "speed", 2.5);
+    cardinal_anim_controller_update(ctrl, 0.1);
+    try std.testing.expectApproxEqAbs(@as(f32, 0.0), TestClips.weight(system, "idle"), 1e-5);
+    try std.testing.expectApproxEqAbs(@as(f32, 0.5), TestClips.weight(system, "walk"), 1e-5);
+    try std.testing.expectApproxEqAbs(@as(f32, 0.5), TestClips.weight(system, "run"), 1e-5);
+
+    cardinal_anim_controller_set_param(ctrl, "speed", -1.0);
+    cardinal_anim_controller_update(ctrl, 0.1);
+    try std.testing.expectApproxEqAbs(@as(f32, 1.0), TestClips.weight(system, "idle"), 1e-5);
+    try std.testing.expectApproxEqAbs(@as(f32, 0.0), TestClips.weight(system, "walk"), 1e-5);
+
+    cardinal_anim_controller_set_param(ctrl, "jump", 1.0);
+    cardinal_anim_controller_update(ctrl, 0.25);
+    try std.testing.expect(ctrl.is_transitioning);
+    try std.testing.expectApproxEqAbs(@as(f32, 0.5), TestClips.weight(system, "idle"), 1e-5);
+    try std.testing.expectApproxEqAbs(@as(f32, 0.5), TestClips.weight(system, "jump"), 1e-5);
+
+    cardinal_anim_controller_update(ctrl, 0.25);
+    try std.testing.expect(!ctrl.is_transitioning);
+    try std.testing.expectEqual(@as(u32, 1), ctrl.current_state_index);
+    try std.testing.expectApproxEqAbs(@as(f32, 1.0), TestClips.weight(system, "jump"), 1e-5);
+    try std.testing.expectApproxEqAbs(@as(f32, 0.0), TestClips.weight(system, "idle"), 1e-5);
+}
+
+test "batched controller update matches per-controller updates" {
+    memory.cardinal_memory_init(4 * 1024 * 1024);
+    defer memory.cardinal_memory_shutdown();
+
+    const job_config = job_system.JobSystemConfig{
+        .worker_thread_count = 2,
+        .max_queue_size = 100,
+        .enable_priority_queue = true,
+    };
+    if (!job_system.init(&job_config)) return error.JobSystemInitFailed;
+    defer job_system.shutdown();
+
+    var children: [3]AnimNode = undefined;
+    var thresholds: [3]f32 = undefined;
+    var root: AnimNode = undefined;
+    var conditions: [1]AnimCondition = undefined;
+    var transitions: [1]AnimTransition = undefined;
+    var jump_root: AnimNode = undefined;
+    var states: [2]AnimState = undefined;
+    const def = test_definition(&children, &thresholds, &root, &conditions, &transitions, &jump_root, &states);
+
+    const count = 3 * CONTROLLERS_PER_JOB;
+    var batched: [count]?*AnimController = undefined;
+    var serial: [count]?*AnimController = undefined;
+    var systems: [2 * count]*animation.CardinalAnimationSystem = undefined;
+    for (0..count) |i| {
+        systems[2 * i] = try TestClips.create_system();
+        systems[2 * i + 1] = try TestClips.create_system();
+        batched[i] = cardinal_anim_controller_create(&def, systems[2 * i]);
+        serial[i] = cardinal_anim_controller_create(&def, systems[2 * i + 1]);
+        const speed = @as(f32, @floatFromInt(i)) * 0.05;
+        cardinal_anim_controller_set_param(batched[i], "speed", speed);
+        cardinal_anim_controller_set_param(serial[i], "speed", speed);
+        if (i % 3 == 0) {
+            cardinal_anim_controller_set_param(batched[i], "jump", 1.0);
+            cardinal_anim_controller_set_param(serial[i], "jump", 1.0);
+        }
+    }
+    defer {
+        for (0..count) |i| {
+            cardinal_anim_controller_destroy(batched[i]);
+            cardinal_anim_controller_destroy(serial[i]);
+            animation.cardinal_animation_system_destroy(systems[2 * i]);
+            animation.cardinal_animation_system_destroy(systems[2 * i + 1]);
+        }
+    }
+
+    for (0..3) |_| {
+        cardinal_anim_controller_update_batch(&batched, count, 0.2);
+        for (serial) |ctrl| cardinal_anim_controller_update(ctrl, 0.2);
+    }
+
+    for (0..count) |i| {
+        try std.testing.expectEqual(serial[i].?.current_state_index, batched[i].?.current_state_index);
+        for (TestClips.names) |name| {
+            try std.testing.expectApproxEqAbs(TestClips.weight(systems[2 * i + 1], name), TestClips.weight(systems[2 * i], name), 1e-6);
         }
     }
 }
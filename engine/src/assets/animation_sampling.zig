@@ -146,7 +146,7 @@ fn slerp_quaternion(a: [*]const f32, b: [*]const f32, t: f32, result: [*]f32) vo
     }
 }
 
-fn cubic_spline_interpolate(values: [*]const f32, prev_index: u32, next_index: u32, factor: f32, time_diff: f32, component_count: u32, result: [*]f32) void {
+fn cubic_spline_interpolate(values: [*]const f32, prev_index: u32, next_index: u32, factor: f32, time_diff: f32, component_count: u32, is_quaternion: bool, result: [*]f32) void {
     const prev_base = prev_index * component_count * 3;
     const prev_value = values + prev_base + component_count;
 
@@ -172,7 +172,7 @@ fn cubic_spline_interpolate(values: [*]const f32, prev_index: u32, next_index: u
     const tangent_scale = time_diff;
 
     var p1_sign: f32 = 1.0;
-    if (component_count == 4) {
+    if (is_quaternion) {
         const dot = prev_value[0] * next_value[0] +
             prev_value[1] * next_value[1] +
             prev_value[2] * next_value[2] +
@@ -190,7 +190,7 @@ fn cubic_spline_interpolate(values: [*]const f32, prev_index: u32, next_index: u
         result[i] = h00 * p0 + h10 * m0 + h01 * p1 + h11 * m1;
     }
 
-    if (component_count == 4) {
+    if (is_quaternion) {
         const len = std.math.sqrt(result[0] * result[0] + result[1] * result[1] + result[2] * result[2] + result[3] * result[3]);
         if (len > 0.0) {
             result[0] /= len;
@@ -230,7 +230,7 @@ pub fn interpolate(interpolation: u32, time: f32, input: [*]const f32, output: [
         },
         2 => {
             const time_diff = input[next_index] - input[prev_index];
-            cubic_spline_interpolate(output, prev_index, next_index, factor, time_diff, component_count, result);
+            cubic_spline_interpolate(output, prev_index, next_index, factor, time_diff, component_count, component_count == 4, result);
         },
         else => return false,
     }
@@ -241,6 +241,16 @@ pub fn interpolate(interpolation: u32, time: f32, input: [*]const f32, output: [
 ///
 /// This improves performance when sampling forward in time.
 pub fn interpolate_cached(interpolation: u32, time: f32, input: [*]const f32, output: [*]const f32, input_count: u32, component_count: u32, last_index: *u32, result: [*]f32) bool {
+    return interpolate_cached_impl(interpolation, time, input, output, input_count, component_count, component_count == 4, last_index, result);
+}
+
+/// Like `interpolate_cached`, but treats every component as an independent scalar, so 4-wide
+/// outputs are never slerped or normalized. Used for morph-target weight curves.
+pub fn interpolate_scalars_cached(interpolation: u32, time: f32, input: [*]const f32, output: [*]const f32, input_count: u32, component_count: u32, last_index: *u32, result: [*]f32) bool {
+    return interpolate_cached_impl(interpolation, time, input, output, input_count, component_count, false, last_index, result);
+}
+
+fn interpolate_cached_impl(interpolation: u32, time: f32, input: [*]const f32, output: [*]const f32, input_count: u32, component_count: u32, is_quaternion: bool, last_index: *u32, result: [*]f32) bool {
     if (input_count == 0 or component_count == 0) return false;
 
     var prev_index: u32 = 0;
@@ -260,7 +270,7 @@ pub fn interpolate_cached(interpolation: u32, time: f32, input: [*]const f32, ou
             @memcpy(result[0..component_count], output[prev_offset .. prev_offset + component_count]);
         },
         0 => {
-            if (component_count == 4) {
+            if (is_quaternion) {
                 slerp_quaternion(prev_ptr, next_ptr, factor, result);
             } else {
                 lerp_vector(prev_ptr, next_ptr, factor, component_count, result);
@@ -268,7 +278,7 @@ pub fn interpolate_cached(interpolation: u32, time: f32, input: [*]const f32, ou
         },
         2 => {
             const time_diff = input[next_index] - input[prev_index];
-            cubic_spline_interpolate(output, prev_index, next_index, factor, time_diff, component_count, result);
+            cubic_spline_interpolate(output, prev_index, next_index, factor, time_diff, component_count, is_quaternion, result);
         },
         else => return false,
     }
@@ -3,7 +3,18 @@
 //! Scans an asset root directory for `*.meta` files and maintains maps for resolving GUIDs to
 //! absolute asset paths (and vice versa). When a `.meta` file is missing, it can be created on
 //! demand with a freshly generated GUID.
+//!
+//! The mapping is persisted as a binary index (`.cache/asset_index.bin` under the root) holding
+//! guid, path, `.meta` mtime and importer for every asset plus the mtime of every scanned
+//! directory. The index is memory-mapped and its path strings are used in place. `refresh` only
+//! re-lists directories whose mtime changed, and scans new subtrees in parallel on the job system.
 const std = @import("std");
+const builtin = @import("builtin");
+const job_system = @import("../core/job_system.zig");
+const name_hash = @import("../core/name_hash.zig");
+const log = @import("../core/log.zig");
+
+const db_log = log.ScopedLogger("ASSET_DB");
 
 /// 128-bit stable identifier stored in `.meta` files.
 pub const AssetGuid = u128;
@@ -30,62 +41,131 @@ pub const ModelImportSettings = struct {
     scale: f32 = 1.0,
 };
 
+/// Indexed state of one asset.
+pub const AssetRecord = struct {
+    guid: AssetGuid,
+    importer: Importer,
+    /// Modification time of the `.meta` file in nanoseconds.
+    meta_mtime: i64,
+};
+
+/// Directory holding the index, relative to the asset root. Scans skip it.
+pub const CACHE_DIR_NAME = ".cache";
+const INDEX_FILE_NAME = "asset_index.bin";
+const INDEX_MAGIC = [4]u8{ 'C', 'A', 'D', 'B' };
+const INDEX_VERSION: u32 = 1;
+
+const IndexHeader = extern struct {
+    magic: [4]u8,
+    version: u32,
+    record_count: u32,
+    dir_count: u32,
+    strings_size: u64,
+    /// Hash of the root the index was written for; a moved project rebuilds its index.
+    root_hash: u64,
+};
+
+const IndexRecord = extern struct {
+    guid_lo: u64,
+    guid_hi: u64,
+    meta_mtime: i64,
+    path_offset: u32,
+    path_len: u32,
+    importer: u32,
+    _pad: u32 = 0,
+};
+
+const IndexDir = extern struct {
+    mtime: i64,
+    path_offset: u32,
+    path_len: u32,
+};
+
+const IndexBytes = []align(std.heap.page_size_min) const u8;
+
 /// Tracks GUID/path mappings and performs `.meta` discovery under `root_dir`.
 pub const AssetDatabase = struct {
     allocator: std.mem.Allocator,
     root_dir: []const u8,
+    /// Absolute asset path -> record. Keys are owned, or borrowed from `index_bytes`.
+    records: std.StringHashMapUnmanaged(AssetRecord) = .{},
+    /// GUID -> path; values borrow the `records` keys.
     guid_to_path: std.AutoHashMapUnmanaged(AssetGuid, []const u8) = .{},
-    path_to_guid: std.StringHashMapUnmanaged(AssetGuid) = .{},
+    /// Absolute directory path -> mtime (ns) at the last scan. Keys as for `records`.
+    dirs: std.StringHashMapUnmanaged(i64) = .{},
+    /// Mapped index file whose strings back loaded keys; kept for the database lifetime.
+    index_bytes: ?IndexBytes = null,
+    index_loaded: bool = false,
+    index_dirty: bool = false,
 
     /// Creates a database rooted at `root_dir` (must be an absolute path).
     pub fn init(allocator: std.mem.Allocator, root_dir: []const u8) !AssetDatabase {
         return .{
             .allocator = allocator,
             .root_dir = try allocator.dupe(u8, root_dir),
-            .guid_to_path = .{},
-            .path_to_guid = .{},
         };
     }
 
-    /// Frees all stored path strings and releases internal maps.
+    /// Frees all stored path strings, releases internal maps and unmaps the index.
     pub fn deinit(self: *AssetDatabase) void {
-        var it = self.guid_to_path.iterator();
-        while (it.next()) |entry| {
-            self.allocator.free(entry.value_ptr.*);
-        }
+        self.clearRetainingCapacity();
+        self.records.deinit(self.allocator);
         self.guid_to_path.deinit(self.allocator);
+        self.dirs.deinit(self.allocator);
+        self.unmapIndex();
+        self.allocator.free(self.root_dir);
+    }
+
+    /// Brings the mappings up to date with the files under `root_dir`.
+    ///
+    /// The first call loads the persisted index. Later work is proportional to the number of
+    /// directories (one stat each) plus the contents of directories that changed. Edits that
+    /// rewrite a `.meta` file in place without touching its directory are picked up by `rebuild`.
+    pub fn refresh(self: *AssetDatabase) !void {
+        if (!self.index_loaded) {
+            self.index_loaded = true;
+            self.loadIndex() catch |err| switch (err) {
+                error.FileNotFound, error.NoIndexLocation => {},
+                else => db_log.warn("Ignoring asset index: {s}", .{@errorName(err)}),
+            };
+        }
 
-        var it2 = self.path_to_guid.iterator();
-        while (it2.next()) |entry| {
-            self.allocator.free(entry.key_ptr.*);
+        if (self.dirs.count() == 0) {
+            try self.fullScan();
+        } else {
+            try self.incrementalScan();
         }
-        self.path_to_guid.deinit(self.allocator);
 
-        self.allocator.free(self.root_dir);
+        if (self.index_dirty) {
+            self.saveIndex() catch |err| db_log.warn("Failed to write asset index: {s}", .{@errorName(err)});
+        }
     }
 
-    /// Clears current mappings and rescans `root_dir` for `*.meta` files.
-    pub fn refresh(self: *AssetDatabase) !void {
+    /// Discards all mappings and rescans `root_dir` from scratch.
+    pub fn rebuild(self: *AssetDatabase) !void {
         self.clearRetainingCapacity();
-        var path_buf = std.ArrayListUnmanaged(u8){};
-        defer path_buf.deinit(self.allocator);
-        try path_buf.appendSlice(self.allocator, self.root_dir);
-        try self.scanForMetaFiles(&path_buf);
+        self.index_loaded = true;
+        try self.fullScan();
+        self.index_dirty = true;
+        self.saveIndex() catch |err| db_log.warn("Failed to write asset index: {s}", .{@errorName(err)});
+    }
+
+    /// Writes the index if mappings changed since it was last saved or loaded.
+    pub fn flush(self: *AssetDatabase) void {
+        if (!self.index_dirty) return;
+        self.saveIndex() catch |err| db_log.warn("Failed to write asset index: {s}", .{@errorName(err)});
     }
 
-    /// Clears both maps without freeing their backing capacity.
+    /// Clears all maps without freeing their backing capacity.
     pub fn clearRetainingCapacity(self: *AssetDatabase) void {
-        var it = self.guid_to_path.iterator();
-        while (it.next()) |entry| {
-            self.allocator.free(entry.value_ptr.*);
-        }
+        var it = self.records.keyIterator();
+        while (it.next()) |key| self.freeKey(key.*);
+        self.records.clearRetainingCapacity();
         self.guid_to_path.clearRetainingCapacity();
 
-        var it2 = self.path_to_guid.iterator();
-        while (it2.next()) |entry| {
-            self.allocator.free(entry.key_ptr.*);
-        }
-        self.path_to_guid.clearRetainingCapacity();
+        var dir_it = self.dirs.keyIterator();
+        while (dir_it.next()) |key| self.freeKey(key.*);
+        self.dirs.clearRetainingCapacity();
     }
 
     /// Returns the absolute asset path for `guid` if known.
@@ -95,92 +175,549 @@ pub const AssetDatabase = struct {
 
     /// Returns the GUID for `asset_path_abs` if known.
     pub fn getGuidForPath(self: *const AssetDatabase, asset_path_abs: []const u8) ?AssetGuid {
-        return self.path_to_guid.get(asset_path_abs);
+        const record = self.records.get(asset_path_abs) orelse return null;
+        return record.guid;
+    }
+
+    /// Returns the indexed record for `asset_path_abs` if known.
+    pub fn getRecord(self: *const AssetDatabase, asset_path_abs: []const u8) ?AssetRecord {
+        return self.records.get(asset_path_abs);
     }
 
     /// Returns the GUID for `asset_path_abs`, creating a `.meta` file when missing.
     pub fn getOrCreateGuidForAsset(self: *AssetDatabase, asset_path_abs: []const u8) !AssetGuid {
-        if (self.path_to_guid.get(asset_path_abs)) |g| return g;
+        if (self.records.get(asset_path_abs)) |record| return record.guid;
 
-        const importer = inferImporter(asset_path_abs);
         const meta_path = try metaPathForAsset(self.allocator, asset_path_abs);
         defer self.allocator.free(meta_path);
 
-        const guid = (readGuidFromMetaFile(self.allocator, meta_path) catch null) orelse blk: {
+        var importer = inferImporter(asset_path_abs);
+        const guid = if (readMetaFile(self.allocator, meta_path) catch null) |meta| blk: {
+            if (meta.importer) |imp| importer = imp;
+            break :blk meta.guid;
+        } else blk: {
             const g = generateGuid();
             try writeMetaFile(self.allocator, meta_path, g, importer);
             break :blk g;
         };
 
-        const stored_path = try self.allocator.dupe(u8, asset_path_abs);
-        errdefer self.allocator.free(stored_path);
+        const meta_mtime: i64 = if (statPath(meta_path)) |st| settledMtime(st.mtime, std.time.nanoTimestamp()) else 0;
+        try self.putRecord(asset_path_abs, .{ .guid = guid, .importer = importer, .meta_mtime = meta_mtime });
+        return guid;
+    }
 
-        if (self.guid_to_path.getPtr(guid)) |existing| {
-            self.allocator.free(existing.*);
-            existing.* = stored_path;
+    fn freeKey(self: *AssetDatabase, key: []const u8) void {
+        if (self.index_bytes) |bytes| {
+            const start = @intFromPtr(bytes.ptr);
+            const addr = @intFromPtr(key.ptr);
+            if (addr >= start and addr < start + bytes.len) return;
+        }
+        self.allocator.free(key);
+    }
+
+    fn putRecord(self: *AssetDatabase, path: []const u8, record: AssetRecord) !void {
+        const gop = try self.records.getOrPut(self.allocator, path);
+        if (gop.found_existing) {
+            const old = gop.value_ptr.*;
+            if (old.guid == record.guid and old.importer == record.importer and old.meta_mtime == record.meta_mtime) return;
+            if (old.guid != record.guid) self.unlinkGuid(old.guid, gop.key_ptr.*);
         } else {
-            try self.guid_to_path.put(self.allocator, guid, stored_path);
+            gop.key_ptr.* = self.allocator.dupe(u8, path) catch |err| {
+                self.records.removeByPtr(gop.key_ptr);
+                return err;
+            };
+        }
+        gop.value_ptr.* = record;
+        try self.guid_to_path.put(self.allocator, record.guid, gop.key_ptr.*);
+        self.index_dirty = true;
+    }
+
+    fn removeRecord(self: *AssetDatabase, path: []const u8) void {
+        const kv = self.records.fetchRemove(path) orelse return;
+        self.unlinkGuid(kv.value.guid, kv.key);
+        self.freeKey(kv.key);
+        self.index_dirty = true;
+    }
+
+    fn unlinkGuid(self: *AssetDatabase, guid: AssetGuid, path: []const u8) void {
+        if (self.guid_to_path.get(guid)) |mapped| {
+            if (mapped.ptr == path.ptr) _ = self.guid_to_path.remove(guid);
         }
+    }
 
-        if (self.path_to_guid.getPtr(asset_path_abs)) |existing_guid| {
-            existing_guid.* = guid;
+    fn putDir(self: *AssetDatabase, path: []const u8, mtime: i64) !void {
+        const gop = try self.dirs.getOrPut(self.allocator, path);
+        if (gop.found_existing) {
+            if (gop.value_ptr.* == mtime) return;
         } else {
-            const key_copy = try self.allocator.dupe(u8, asset_path_abs);
-            errdefer self.allocator.free(key_copy);
-            try self.path_to_guid.put(self.allocator, key_copy, guid);
+            gop.key_ptr.* = self.allocator.dupe(u8, path) catch |err| {
+                self.dirs.removeByPtr(gop.key_ptr);
+                return err;
+            };
         }
+        gop.value_ptr.* = mtime;
+        self.index_dirty = true;
+    }
 
-        return guid;
+    fn mergeScan(self: *AssetDatabase, scan: *const ScanOutput) !void {
+        for (scan.dirs.items) |dir| try self.putDir(dir.path, dir.mtime);
+        for (scan.assets.items) |asset| try self.putRecord(asset.path, asset.record);
+    }
+
+    /// Scans the root's own entries inline and every top-level subtree as a parallel job.
+    fn fullScan(self: *AssetDatabase) !void {
+        var arena = std.heap.ArenaAllocator.init(self.allocator);
+        defer arena.deinit();
+
+        var scan = ScanOutput{};
+        try scanDirectory(arena.allocator(), self.root_dir, false, &self.records, &scan);
+        try self.mergeScan(&scan);
+        try self.scanSubtrees(scan.subdirs.items);
     }
 
-    fn scanForMetaFiles(self: *AssetDatabase, path_buf: *std.ArrayListUnmanaged(u8)) !void {
-        const dir_path = path_buf.items;
-        var dir = std.fs.openDirAbsolute(dir_path, .{ .iterate = true }) catch return;
-        defer dir.close();
+    fn incrementalScan(self: *AssetDatabase) !void {
+        var arena = std.heap.ArenaAllocator.init(self.allocator);
+        defer arena.deinit();
+        const scratch = arena.allocator();
+
+        // Snapshot the directory list; keys may be replaced while merging.
+        var known = std.ArrayListUnmanaged([]const u8){};
+        try known.ensureTotalCapacity(scratch, self.dirs.count());
+        var dir_it = self.dirs.keyIterator();
+        while (dir_it.next()) |key| known.appendAssumeCapacity(try scratch.dupe(u8, key.*));
 
-        var it = dir.iterate();
-        while (try it.next()) |entry| {
-            const base_len = path_buf.items.len;
-            defer path_buf.items.len = base_len;
+        var new_subtrees = std.ArrayListUnmanaged([]const u8){};
+        var removed = std.ArrayListUnmanaged([]const u8){};
+        var changed: usize = 0;
 
-            if (path_buf.items.len > 0 and path_buf.items[path_buf.items.len - 1] != std.fs.path.sep) {
-                try path_buf.appendSlice(self.allocator, std.fs.path.sep_str);
+        for (known.items) |dir_path| {
+            const st = statDirPath(dir_path) orelse {
+                try removed.append(scratch, dir_path);
+                continue;
+            };
+            if (self.dirs.get(dir_path)) |mtime| {
+                if (mtime != 0 and mtime == clampMtime(st.mtime)) continue;
+            }
+            changed += 1;
+
+            var scan = ScanOutput{};
+            try scanDirectory(scratch, dir_path, false, &self.records, &scan);
+            try self.dropMissingAssets(scratch, dir_path, &scan);
+            try self.mergeScan(&scan);
+            for (scan.subdirs.items) |sub| {
+                if (!self.dirs.contains(sub)) try new_subtrees.append(scratch, sub);
             }
-            try path_buf.appendSlice(self.allocator, entry.name);
-            const child_path = path_buf.items;
+        }
+
+        for (removed.items) |dir_path| try self.removeSubtree(scratch, dir_path);
+        try self.scanSubtrees(new_subtrees.items);
+
+        if (changed > 0 or removed.items.len > 0 or new_subtrees.items.len > 0) {
+            db_log.info("Refreshed {d} changed, {d} removed and {d} new directories", .{ changed, removed.items.len, new_subtrees.items.len });
+        }
+    }
+
+    /// Removes records directly inside `dir_path` that a fresh listing no longer reports.
+    fn dropMissingAssets(self: *AssetDatabase, scratch: std.mem.Allocator, dir_path: []const u8, scan: *const ScanOutput) !void {
+        var present = std.StringHashMapUnmanaged(void){};
+        for (scan.assets.items) |asset| try present.put(scratch, asset.path, {});
+
+        var stale = std.ArrayListUnmanaged([]const u8){};
+        var it = self.records.keyIterator();
+        while (it.next()) |key| {
+            const parent = std.fs.path.dirname(key.*) orelse continue;
+            if (!std.mem.eql(u8, parent, dir_path)) continue;
+            if (!present.contains(key.*)) try stale.append(scratch, key.*);
+        }
+        for (stale.items) |path| self.removeRecord(path);
+    }
+
+    fn removeSubtree(self: *AssetDatabase, scratch: std.mem.Allocator, dir_path: []const u8) !void {
+        var stale = std.ArrayListUnmanaged([]const u8){};
+        var it = self.records.keyIterator();
+        while (it.next()) |key| {
+            if (isInside(key.*, dir_path)) try stale.append(scratch, key.*);
+        }
+        for (stale.items) |path| self.removeRecord(path);
+
+        stale.clearRetainingCapacity();
+        var dir_it = self.dirs.keyIterator();
+        while (dir_it.next()) |key| {
+            if (std.mem.eql(u8, key.*, dir_path) or isInside(key.*, dir_path)) try stale.append(scratch, key.*);
+        }
+        for (stale.items) |path| {
+            const kv = self.dirs.fetchRemove(path) orelse continue;
+            self.freeKey(kv.key);
+            self.index_dirty = true;
+        }
+    }
+
+    /// Scans each root recursively, one job-system job per root when workers are available.
+    fn scanSubtrees(self: *AssetDatabase, roots: []const []const u8) !void {
+        if (roots.len == 0) return;
+
+        const scans = try self.allocator.alloc(SubtreeScan, roots.len);
+        defer self.allocator.free(scans);
+        for (scans, roots) |*scan, root| {
+            scan.* = .{ .arena = std.heap.ArenaAllocator.init(self.allocator), .root = root, .known = &self.records };
+        }
+        defer for (scans) |*scan| scan.arena.deinit();
+
+        var jobs = std.ArrayListUnmanaged(*job_system.Job){};
+        defer jobs.deinit(self.allocator);
+        try jobs.ensureTotalCapacity(self.allocator, roots.len);
 
-            if (entry.kind == .directory) {
-                try self.scanForMetaFiles(path_buf);
+        for (scans) |*scan| {
+            const job = job_system.create_job(subtreeScanJob, scan, .NORMAL) orelse {
+                scan.run();
                 continue;
+            };
+            job.push_to_completed_queue = false;
+            while (!job_system.submit_job(job)) {
+                std.Thread.yield() catch {};
             }
+            jobs.appendAssumeCapacity(job);
+        }
 
-            if (!std.mem.endsWith(u8, entry.name, ".meta")) continue;
+        job_system.wait_for_jobs(jobs.items);
+        for (jobs.items) |job| job_system.free_job(job);
+
+        for (scans) |*scan| {
+            if (scan.failed) db_log.warn("Asset scan of {s} was incomplete", .{scan.root});
+            try self.mergeScan(&scan.output);
+        }
+    }
 
-            const guid = readGuidFromMetaFile(self.allocator, child_path) catch continue;
-            const asset_path = child_path[0 .. child_path.len - ".meta".len];
+    fn indexPath(self: *const AssetDatabase, allocator: std.mem.Allocator) ![]u8 {
+        if (!std.fs.path.isAbsolute(self.root_dir)) return error.NoIndexLocation;
+        return std.fs.path.join(allocator, &[_][]const u8{ self.root_dir, CACHE_DIR_NAME, INDEX_FILE_NAME });
+    }
+
+    /// Maps the persisted index and adopts its records. Path keys point into the mapping.
+    fn loadIndex(self: *AssetDatabase) !void {
+        const index_path = try self.indexPath(self.allocator);
+        defer self.allocator.free(index_path);
+
+        const file = try std.fs.openFileAbsolute(index_path, .{});
+        defer file.close();
+        const size: usize = @intCast((try file.stat()).size);
+        if (size < @sizeOf(IndexHeader)) return error.InvalidIndex;
+
+        const bytes = try mapIndexFile(self.allocator, file, size);
+        self.clearRetainingCapacity();
+        self.unmapIndex();
+        self.index_bytes = bytes;
+        errdefer {
+            self.clearRetainingCapacity();
+            self.unmapIndex();
+        }
+
+        const header = std.mem.bytesToValue(IndexHeader, bytes[0..@sizeOf(IndexHeader)]);
+        if (!std.mem.eql(u8, &header.magic, &INDEX_MAGIC) or header.version != INDEX_VERSION) return error.InvalidIndex;
+        if (header.root_hash != name_hash.hash_u64_wyhash(self.root_dir)) return error.IndexRootMismatch;
+
+        const records_offset: usize = @sizeOf(IndexHeader);
+        const dirs_offset = records_offset + @as(usize, header.record_count) * @sizeOf(IndexRecord);
+        const strings_offset = dirs_offset + @as(usize, header.dir_count) * @sizeOf(IndexDir);
+        if (strings_offset + header.strings_size != size) return error.InvalidIndex;
+
+        const records = std.mem.bytesAsSlice(IndexRecord, @as([]align(8) const u8, @alignCast(bytes[records_offset..dirs_offset])));
+        const dirs = std.mem.bytesAsSlice(IndexDir, @as([]align(8) const u8, @alignCast(bytes[dirs_offset..strings_offset])));
+        const strings = bytes[strings_offset..];
+
+        try self.records.ensureTotalCapacity(self.allocator, header.record_count);
+        try self.guid_to_path.ensureTotalCapacity(self.allocator, header.record_count);
+        try self.dirs.ensureTotalCapacity(self.allocator, header.dir_count);
+
+        for (records) |rec| {
+            const path = try indexString(strings, rec.path_offset, rec.path_len);
+            const guid = (@as(AssetGuid, rec.guid_hi) << 64) | rec.guid_lo;
+            const importer = std.meta.intToEnum(Importer, rec.importer) catch Importer.Unknown;
+            self.records.putAssumeCapacity(path, .{ .guid = guid, .importer = importer, .meta_mtime = rec.meta_mtime });
+            self.guid_to_path.putAssumeCapacity(guid, path);
+        }
+        for (dirs) |dir| {
+            self.dirs.putAssumeCapacity(try indexString(strings, dir.path_offset, dir.path_len), dir.mtime);
+        }
+
+        self.index_dirty = false;
+        db_log.info("Loaded asset index: {d} assets, {d} directories", .{ header.record_count, header.dir_count });
+    }
+
+    fn unmapIndex(self: *AssetDatabase) void {
+        const bytes = self.index_bytes orelse return;
+        if (builtin.os.tag == .windows) {
+            self.allocator.free(bytes);
+        } else {
+            std.posix.munmap(bytes);
+        }
+        self.index_bytes = null;
+    }
 
-            const asset_file = std.fs.openFileAbsolute(asset_path, .{}) catch continue;
-            asset_file.close();
+    /// Writes the index to a temporary file and renames it over the previous one.
+    pub fn saveIndex(self: *AssetDatabase) !void {
+        const index_path = try self.indexPath(self.allocator);
+        defer self.allocator.free(index_path);
 
-            const stored_path = try self.allocator.dupe(u8, asset_path);
-            errdefer self.allocator.free(stored_path);
-            if (self.guid_to_path.getPtr(guid)) |existing| {
-                self.allocator.free(existing.*);
-                existing.* = stored_path;
+        const cache_dir = std.fs.path.dirname(index_path).?;
+        std.fs.makeDirAbsolute(cache_dir) catch |err| switch (err) {
+            error.PathAlreadyExists => {},
+            else => return err,
+        };
+
+        var strings_size: usize = 0;
+        var key_it = self.records.keyIterator();
+        while (key_it.next()) |key| strings_size += key.len;
+        var dir_key_it = self.dirs.keyIterator();
+        while (dir_key_it.next()) |key| strings_size += key.len;
+
+        var out = std.ArrayListUnmanaged(u8){};
+        defer out.deinit(self.allocator);
+        try out.ensureTotalCapacity(self.allocator, @sizeOf(IndexHeader) +
+            self.records.count() * @sizeOf(IndexRecord) +
+            self.dirs.count() * @sizeOf(IndexDir) + strings_size);
+
+        const header = IndexHeader{
+            .magic = INDEX_MAGIC,
+            .version = INDEX_VERSION,
+            .record_count = self.records.count(),
+            .dir_count = self.dirs.count(),
+            .strings_size = strings_size,
+            .root_hash = name_hash.hash_u64_wyhash(self.root_dir),
+        };
+        out.appendSliceAssumeCapacity(std.mem.asBytes(&header));
+
+        var string_offset: u32 = 0;
+        var rec_it = self.records.iterator();
+        while (rec_it.next()) |entry| {
+            const rec = IndexRecord{
+                .guid_lo = @truncate(entry.value_ptr.guid),
+                .guid_hi = @truncate(entry.value_ptr.guid >> 64),
+                .meta_mtime = entry.value_ptr.meta_mtime,
+                .path_offset = string_offset,
+                .path_len = @intCast(entry.key_ptr.len),
+                .importer = @intFromEnum(entry.value_ptr.importer),
+            };
+            out.appendSliceAssumeCapacity(std.mem.asBytes(&rec));
+            string_offset += @intCast(entry.key_ptr.len);
+        }
+        var dir_it = self.dirs.iterator();
+        while (dir_it.next()) |entry| {
+            const dir = IndexDir{
+                .mtime = entry.value_ptr.*,
+                .path_offset = string_offset,
+                .path_len = @intCast(entry.key_ptr.len),
+            };
+            out.appendSliceAssumeCapacity(std.mem.asBytes(&dir));
+            string_offset += @intCast(entry.key_ptr.len);
+        }
+
+        // Same iteration order as above, so offsets line up.
+        key_it = self.records.keyIterator();
+        while (key_it.next()) |key| out.appendSliceAssumeCapacity(key.*);
+        dir_key_it = self.dirs.keyIterator();
+        while (dir_key_it.next()) |key| out.appendSliceAssumeCapacity(key.*);
+
+        const tmp_path = try std.mem.concat(self.allocator, u8, &[_][]const u8{ index_path, ".tmp" });
+        defer self.allocator.free(tmp_path);
+        {
+            const file = try std.fs.createFileAbsolute(tmp_path, .{ .truncate = true });
+            defer file.close();
+            try file.writeAll(out.items);
+        }
+        try std.fs.renameAbsolute(tmp_path, index_path);
+        self.index_dirty = false;
+    }
+};
+
+const ScannedAsset = struct {
+    path: []const u8,
+    record: AssetRecord,
+};
+
+const ScannedDir = struct {
+    path: []const u8,
+    mtime: i64,
+};
+
+/// Results of listing one or more directories; strings live in the scanning arena.
+const ScanOutput = struct {
+    assets: std.ArrayListUnmanaged(ScannedAsset) = .{},
+    dirs: std.ArrayListUnmanaged(ScannedDir) = .{},
+    /// Subdirectories found by a non-recursive scan.
+    subdirs: std.ArrayListUnmanaged([]const u8) = .{},
+};
+
+/// One recursive subtree scan, run as a job. The arena's backing allocator must be thread-safe.
+const SubtreeScan = struct {
+    arena: std.heap.ArenaAllocator,
+    root: []const u8,
+    /// Existing records, read-only while jobs run, used to skip re-parsing unchanged `.meta` files.
+    known: *const std.StringHashMapUnmanaged(AssetRecord),
+    output: ScanOutput = .{},
+    failed: bool = false,
+
+    fn run(self: *SubtreeScan) void {
+        scanDirectory(self.arena.allocator(), self.root, true, self.known, &self.output) catch {
+            self.failed = true;
+        };
+    }
+};
+
+fn subtreeScanJob(data: ?*anyopaque) callconv(.c) i32 {
+    const scan: *SubtreeScan = @ptrCast(@alignCast(data.?));
+    scan.run();
+    return if (scan.failed) 1 else 0;
+}
+
+/// Lists `dir_path`, recording its mtime and every asset that has a readable `.meta` file.
+/// Subdirectories are scanned recursively when `recursive` is set and collected otherwise.
+fn scanDirectory(
+    allocator: std.mem.Allocator,
+    dir_path: []const u8,
+    recursive: bool,
+    known: *const std.StringHashMapUnmanaged(AssetRecord),
+    out: *ScanOutput,
+) !void {
+    var dir = std.fs.cwd().openDir(dir_path, .{ .iterate = true }) catch return;
+    defer dir.close();
+    const dir_stat = dir.stat() catch return;
+    const now = std.time.nanoTimestamp();
+    try out.dirs.append(allocator, .{ .path = try allocator.dupe(u8, dir_path), .mtime = settledMtime(dir_stat.mtime, now) });
+
+    var it = dir.iterate();
+    while (try it.next()) |entry| {
+        if (entry.kind == .directory) {
+            if (std.mem.eql(u8, entry.name, CACHE_DIR_NAME)) continue;
+            const child = try std.fs.path.join(allocator, &[_][]const u8{ dir_path, entry.name });
+            if (recursive) {
+                try scanDirectory(allocator, child, true, known, out);
             } else {
-                try self.guid_to_path.put(self.allocator, guid, stored_path);
+                try out.subdirs.append(allocator, child);
             }
+            continue;
+        }
 
-            if (self.path_to_guid.getPtr(asset_path)) |existing_guid| {
-                existing_guid.* = guid;
-            } else {
-                const key_copy = try self.allocator.dupe(u8, asset_path);
-                errdefer self.allocator.free(key_copy);
-                try self.path_to_guid.put(self.allocator, key_copy, guid);
+        if (!std.mem.endsWith(u8, entry.name, ".meta")) continue;
+        const asset_name = entry.name[0 .. entry.name.len - ".meta".len];
+        dir.access(asset_name, .{}) catch continue;
+
+        const meta_stat = dir.statFile(entry.name) catch continue;
+        const meta_mtime = settledMtime(meta_stat.mtime, now);
+        const asset_path = try std.fs.path.join(allocator, &[_][]const u8{ dir_path, asset_name });
+
+        if (known.get(asset_path)) |record| {
+            if (meta_mtime != 0 and record.meta_mtime == meta_mtime) {
+                try out.assets.append(allocator, .{ .path = asset_path, .record = record });
+                continue;
             }
         }
+
+        const meta_file = dir.openFile(entry.name, .{}) catch continue;
+        defer meta_file.close();
+        const content = meta_file.readToEndAlloc(allocator, 1024 * 1024) catch continue;
+        const meta = parseMeta(allocator, content) catch continue;
+        try out.assets.append(allocator, .{
+            .path = asset_path,
+            .record = .{
+                .guid = meta.guid,
+                .importer = meta.importer orelse inferImporter(asset_name),
+                .meta_mtime = meta_mtime,
+            },
+        });
     }
-};
+}
+
+fn mapIndexFile(allocator: std.mem.Allocator, file: std.fs.File, size: usize) !IndexBytes {
+    if (builtin.os.tag == .windows) {
+        const buf = try allocator.alignedAlloc(u8, .fromByteUnits(std.heap.page_size_min), size);
+        errdefer allocator.free(buf);
+        if (try file.readAll(buf) != size) return error.InvalidIndex;
+        return buf;
+    }
+    return std.posix.mmap(null, size, std.posix.PROT.READ, .{ .TYPE = .PRIVATE }, file.handle, 0);
+}
+
+fn indexString(strings: []const u8, offset: u32, len: u32) ![]const u8 {
+    const end = @as(usize, offset) + len;
+    if (end > strings.len) return error.InvalidIndex;
+    return strings[offset..end];
+}
+
+/// Returns true when `path` lies below `dir_path`.
+fn isInside(path: []const u8, dir_path: []const u8) bool {
+    return path.len > dir_path.len and std.mem.startsWith(u8, path, dir_path) and std.fs.path.isSep(path[dir_path.len]);
+}
+
+fn clampMtime(mtime: i128) i64 {
+    return @intCast(std.math.clamp(mtime, 0, std.math.maxInt(i64)));
+}
+
+/// Filesystem timestamps are coarse, so a change made right after a scan can keep the mtime that
+/// scan recorded. Recent mtimes are stored as 0, which never matches and forces a rescan.
+const RACY_MTIME_WINDOW_NS: i128 = 2 * std.time.ns_per_s;
+
+fn settledMtime(mtime: i128, now: i128) i64 {
+    if (now - mtime < RACY_MTIME_WINDOW_NS) return 0;
+    return clampMtime(mtime);
+}
+
+fn statPath(path: []const u8) ?std.fs.File.Stat {
+    const file = std.fs.cwd().openFile(path, .{}) catch return null;
+    defer file.close();
+    return file.stat() catch null;
+}
+
+fn statDirPath(path: []const u8) ?std.fs.File.Stat {
+    var dir = std.fs.cwd().openDir(path, .{}) catch return null;
+    defer dir.close();
+    return dir.stat() catch null;
+}
+
+var g_shared: ?*AssetDatabase = null;
+var g_shared_mutex: std.Thread.Mutex = .{};
+
+/// Returns the long-lived database for `root_dir`, creating it on first use. Opening a different
+/// root flushes and replaces the previous instance, invalidating paths borrowed from it.
+pub fn openShared(allocator: std.mem.Allocator, root_dir: []const u8) !*AssetDatabase {
+    g_shared_mutex.lock();
+    defer g_shared_mutex.unlock();
+
+    if (g_shared) |db| {
+        if (std.mem.eql(u8, db.root_dir, root_dir)) return db;
+        destroyShared(db);
+        g_shared = null;
+    }
+
+    const db = try allocator.create(AssetDatabase);
+    errdefer allocator.destroy(db);
+    db.* = try AssetDatabase.init(allocator, root_dir);
+    g_shared = db;
+    return db;
+}
+
+/// Returns the shared database if one is open.
+pub fn getShared() ?*AssetDatabase {
+    g_shared_mutex.lock();
+    defer g_shared_mutex.unlock();
+    return g_shared;
+}
+
+/// Flushes and destroys the shared database.
+pub fn closeShared() void {
+    g_shared_mutex.lock();
+    defer g_shared_mutex.unlock();
+
+    if (g_shared) |db| destroyShared(db);
+    g_shared = null;
+}
+
+fn destroyShared(db: *AssetDatabase) void {
+    const allocator = db.allocator;
+    db.flush();
+    db.deinit();
+    allocator.destroy(db);
+}
 
 /// Returns `asset_path_abs ++ ".meta"`.
 pub fn metaPathForAsset(allocator: std.mem.Allocator, asset_path_abs: []const u8) ![]u8 {
@@ -260,25 +797,34 @@ pub fn generateGuid() AssetGuid {
     return std.mem.readInt(u128, &bytes, .big);
 }
 
-fn readGuidFromMetaFile(allocator: std.mem.Allocator, meta_path_abs: []const u8) !AssetGuid {
-    const file = std.fs.openFileAbsolute(meta_path_abs, .{}) catch |err| {
-        if (err == error.FileNotFound) return error.FileNotFound;
-        return err;
-    };
-    defer file.close();
-
-    const content = try file.readToEndAlloc(allocator, std.math.maxInt(usize));
-    defer allocator.free(content);
+const MetaInfo = struct {
+    guid: AssetGuid,
+    importer: ?Importer,
+};
 
+fn parseMeta(allocator: std.mem.Allocator, content: []const u8) !MetaInfo {
     const Parsed = struct {
         guid: ?[]const u8 = null,
+        importer: ?[]const u8 = null,
     };
 
     const parsed = try std.json.parseFromSlice(Parsed, allocator, content, .{ .ignore_unknown_fields = true });
     defer parsed.deinit();
 
     const guid_str = parsed.value.guid orelse return error.InvalidGuid;
-    return parseGuidHex(guid_str);
+    return .{
+        .guid = try parseGuidHex(guid_str),
+        .importer = if (parsed.value.importer) |name| std.meta.stringToEnum(Importer, name) else null,
+    };
+}
+
+fn readMetaFile(allocator: std.mem.Allocator, meta_path_abs: []const u8) !MetaInfo {
+    const file = try std.fs.openFileAbsolute(meta_path_abs, .{});
+    defer file.close();
+
+    const content = try file.readToEndAlloc(allocator, std.math.maxInt(usize));
+    defer allocator.free(content);
+    return parseMeta(allocator, content);
 }
 
 fn writeMetaFile(allocator: std.mem.Allocator, meta_path_abs: []const u8, guid: AssetGuid, importer: Importer) !void {
@@ -316,3 +862,66 @@ fn writeMetaFile(allocator: std.mem.Allocator, meta_path_abs: []const u8, guid:
 
     try file.writeAll(out.items);
 }
+
+fn writeTestAsset(dir: std.fs.Dir, sub_path: []const u8, guid: AssetGuid) !void {
+    if (std.fs.path.dirname(sub_path)) |parent| try dir.makePath(parent);
+    try dir.writeFile(.{ .sub_path = sub_path, .data = "x" });
+
+    var guid_hex: [32]u8 = undefined;
+    guidToHex(guid, &guid_hex);
+    var meta_buf: [128]u8 = undefined;
+    const meta = try std.fmt.bufPrint(&meta_buf, "{{\"guid\": \"{s}\", \"importer\": \"Texture\"}}", .{guid_hex[0..]});
+    var meta_path_buf: [256]u8 = undefined;
+    const meta_path = try std.fmt.bufPrint(&meta_path_buf, "{s}.meta", .{sub_path});
+    try dir.writeFile(.{ .sub_path = meta_path, .data = meta });
+}
+
+test "asset database persists its index and refreshes incrementally" {
+    const allocator = std.testing.allocator;
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+
+    const root = try tmp.dir.realpathAlloc(allocator, ".");
+    defer allocator.free(root);
+
+    try writeTestAsset(tmp.dir, "a.png", 1);
+    try writeTestAsset(tmp.dir, "textures/b.png", 2);
+    try writeTestAsset(tmp.dir, "textures/deep/c.png", 3);
+
+    {
+        var db = try AssetDatabase.init(allocator, root);
+        defer db.deinit();
+        try db.refresh();
+        try std.testing.expectEqual(@as(u32, 3), db.records.count());
+        const c_path = db.resolvePathByGuid(3).?;
+        try std.testing.expect(std.mem.endsWith(u8, c_path, "c.png"));
+        try std.testing.expectEqual(Importer.Texture, db.getRecord(c_path).?.importer);
+        try std.testing.expect(!db.index_dirty);
+    }
+
+    // A new database adopts the mapped index; records borrow their paths from the mapping.
+    try tmp.dir.deleteFile("textures/b.png");
+    try tmp.dir.deleteFile("textures/b.png.meta");
+    try writeTestAsset(tmp.dir, "models/d.png", 4);
+
+    var db = try AssetDatabase.init(allocator, root);
+    defer db.deinit();
+    try db.loadIndex();
+    try std.testing.expectEqual(@as(u32, 3), db.records.count());
+    try std.testing.expect(db.index_bytes != null);
+    try std.testing.expect(db.resolvePathByGuid(2) != null);
+
+    try db.refresh();
+    try std.testing.expect(db.resolvePathByGuid(2) == null);
+    try std.testing.expect(db.resolvePathByGuid(1) != null);
+    try std.testing.expect(db.resolvePathByGuid(3) != null);
+    const d_path = db.resolvePathByGuid(4).?;
+    try std.testing.expect(std.mem.endsWith(u8, d_path, "d.png"));
+    try std.testing.expectEqual(@as(AssetGuid, 4), db.getGuidForPath(d_path).?);
+
+    // Removing a whole subtree drops its records and directories.
+    try tmp.dir.deleteTree("textures");
+    try db.refresh();
+    try std.testing.expect(db.resolvePathByGuid(3) == null);
+    try std.testing.expectEqual(@as(u32, 2), db.records.count());
+}
@@ -1,19 +1,32 @@
-//! Asset handle registry.
+//! Asset handle registry and cache.
 //!
-//! Stores assets in typed arenas addressed by stable handles (index + generation). This module
-//! complements the ref-counting registry by providing lightweight handle-based lookup for engine
-//! systems that prefer POD handles over string keys.
+//! Stores assets in generational slot maps addressed by stable handles (index + generation) and
+//! keyed by a 64-bit hash of their path or identifier. Lookups by handle or key are wait-free; the
+//! texture and mesh loader caches are entries in these maps rather than separate LRU lists.
+//!
+//! Released textures and meshes stay cached until a single byte budget shared by both types forces
+//! eviction of the least recently used unreferenced entries.
 const std = @import("std");
 const handles = @import("../core/handles.zig");
-const handle_manager = @import("../core/handle_manager.zig");
+const name_hash = @import("../core/name_hash.zig");
 const scene = @import("scene.zig");
 const texture_loader = @import("texture_loader.zig");
 const memory = @import("../core/memory.zig");
 const log = @import("../core/log.zig");
 const ref_counting = @import("../core/ref_counting.zig");
+const asset_slot_map = @import("asset_slot_map.zig");
 
 const asset_log = log.ScopedLogger("ASSET_MGR");
 
+const SlotHandle = asset_slot_map.SlotHandle;
+
+/// Maximum live entries per asset type.
+pub const DEFAULT_MAX_ASSETS: u32 = 16 * 1024;
+/// Default byte budget shared by cached textures and meshes.
+pub const DEFAULT_BUDGET_BYTES: u64 = 512 * 1024 * 1024;
+/// Cache inserts between opportunistic budget checks.
+const EVICT_CHECK_INTERVAL: u32 = 32;
+
 pub const AssetType = enum {
     /// Image data loaded from disk and uploaded by the renderer.
     Texture,
@@ -27,144 +40,249 @@ pub const AssetType = enum {
     Sound,
 };
 
-/// Generic typed storage indexed by a handle manager.
+/// Returns the lookup key for an asset path or identifier.
+pub fn path_key(path: []const u8) u64 {
+    return name_hash.hash_u64_wyhash(path);
+}
+
+/// Folds an `AssetGuid` into a lookup key.
+pub fn guid_key(guid: u128) u64 {
+    return @as(u64, @truncate(guid)) ^ @as(u64, @truncate(guid >> 64));
+}
+
+/// Unreferenced entry considered for eviction.
+const EvictionCandidate = struct {
+    kind: AssetType,
+    handle: SlotHandle,
+    last_use: u64,
+    bytes: u64,
+
+    fn older(_: void, a: EvictionCandidate, b: EvictionCandidate) bool {
+        return a.last_use < b.last_use;
+    }
+};
+
+/// Generic typed storage backed by a generational slot map.
 fn AssetStorage(comptime T: type, comptime Handle: type) type {
     return struct {
         const Self = @This();
-        const has_ref_resource = @hasField(T, "ref_resource");
 
-        const Entry = struct {
+        /// Stored entry. The entry owns one reference on `resource` while it stays in the map.
+        pub const Stored = struct {
             data: T,
-            ref_count: u32,
-            path: ?[]const u8,
+            path: ?[:0]u8,
+            resource: ?*ref_counting.CardinalRefCountedResource,
         };
 
-        entries: std.ArrayListUnmanaged(Entry),
-        handle_manager: handle_manager.HandleManager,
+        pub const Map = asset_slot_map.SlotMap(Stored);
+
+        map: Map,
         allocator: std.mem.Allocator,
+        cache_hits: std.atomic.Value(u32) = .init(0),
+        cache_misses: std.atomic.Value(u32) = .init(0),
+        evictions: std.atomic.Value(u32) = .init(0),
 
-        /// Initializes storage for `T` using `allocator`.
-        pub fn init(allocator: std.mem.Allocator) Self {
+        /// Initializes storage for up to `max_entries` live assets.
+        pub fn init(allocator: std.mem.Allocator, max_entries: u32) !Self {
             return .{
-                .entries = .{},
-                .handle_manager = handle_manager.HandleManager.init(allocator),
+                .map = try Map.init(allocator, max_entries),
                 .allocator = allocator,
             };
         }
 
-        /// Frees stored path strings and releases internal storage.
+        /// Releases every entry, including referenced ones, and frees the map.
         pub fn deinit(self: *Self) void {
-            for (self.entries.items) |*entry| {
-                if (has_ref_resource) {
-                    if (entry.data.ref_resource) |ref| {
-                        var i: u32 = 0;
-                        while (i < entry.ref_count) : (i += 1) {
-                            ref_counting.cardinal_ref_release(ref);
-                        }
-                        entry.data.ref_resource = null;
-                    }
-                }
-                if (entry.path) |p| {
-                    self.allocator.free(p);
-                }
-            }
-            self.entries.deinit(self.allocator);
-            self.handle_manager.deinit();
+            var it = self.map.iterator();
+            while (it.next()) |entry| self.destroy(entry.slot.data);
+            self.map.deinit();
         }
 
-        pub const AddResult = struct {
-            handle: Handle,
-            stored_path: ?[]const u8,
-        };
+        fn destroy(self: *Self, stored: Stored) void {
+            if (stored.resource) |ref| ref_counting.cardinal_ref_release(ref);
+            if (stored.path) |p| self.allocator.free(p);
+        }
 
-        /// Adds an entry and returns its new handle.
-        pub fn add(self: *Self, data: T, path: ?[]const u8) !AddResult {
-            var stored_path: ?[]const u8 = null;
+        fn to_slot(handle: Handle) SlotHandle {
+            return .{ .index = handle.index, .generation = handle.generation };
+        }
 
-            if (path) |p| {
-                stored_path = try self.allocator.dupe(u8, p);
-            }
+        fn from_slot(handle: SlotHandle) Handle {
+            return .{ .index = handle.index, .generation = handle.generation };
+        }
 
-            const allocation = try self.handle_manager.allocate();
-            const index = allocation.index;
-            const generation = allocation.generation;
+        /// Returns the stored entry for `handle` if valid. Wait-free.
+        pub fn get_stored(self: *const Self, handle: Handle) ?*Stored {
+            return self.map.get(to_slot(handle));
+        }
 
-            const new_entry: Entry = .{ .data = data, .ref_count = 1, .path = stored_path };
+        /// Returns a mutable pointer to the asset for `handle` if valid. Wait-free. The pointer
+        /// stays valid only while the caller holds a reference on `handle`; unreferenced entries
+        /// can be evicted at any time.
+        pub fn get(self: *const Self, handle: Handle) ?*T {
+            const stored = self.get_stored(handle) orelse return null;
+            std.debug.assert(self.map.ref_count(to_slot(handle)) != 0);
+            return &stored.data;
+        }
 
-            if (index < self.entries.items.len) {
-                self.entries.items[index] = new_entry;
-            } else {
-                try self.entries.append(self.allocator, new_entry);
+        /// Looks up `path` without locking. The stored path is compared so hash collisions miss.
+        pub fn find(self: *const Self, path: []const u8) ?Handle {
+            const slot_handle = self.map.find(path_key(path)) orelse return null;
+            const stored = self.map.get(slot_handle) orelse return null;
+            if (stored.path) |p| {
+                if (!std.mem.eql(u8, p, path)) return null;
             }
+            return from_slot(slot_handle);
+        }
 
-            return AddResult{
-                .handle = Handle{ .index = index, .generation = generation },
-                .stored_path = stored_path,
-            };
+        /// Looks up `path` and returns a handle holding a new reference, without touching the
+        /// cache statistics. The caller releases it.
+        pub fn pin_path(self: *Self, path: []const u8) ?Handle {
+            const handle = self.find(path) orelse return null;
+            return if (self.map.acquire(to_slot(handle))) handle else null;
         }
 
-        /// Returns a mutable pointer to the entry for `handle` if valid.
-        pub fn get(self: *Self, handle: Handle) ?*T {
-            if (!self.handle_manager.is_valid(handle.index, handle.generation)) return null;
-            if (handle.index >= self.entries.items.len) return null;
-            return &self.entries.items[handle.index].data;
+        /// Looks up a raw key (for example a folded `AssetGuid`) without locking.
+        pub fn find_key(self: *const Self, key: u64) ?Handle {
+            const slot_handle = self.map.find(key) orelse return null;
+            return from_slot(slot_handle);
         }
 
-        pub const ReleaseResult = struct {
-            destroyed: bool,
-            path: ?[]const u8,
-            data: ?T,
-        };
+        /// Looks up `path` and returns a handle holding a new reference, counting cache hits.
+        pub fn acquire_path(self: *Self, path: []const u8) ?Handle {
+            if (self.find(path)) |handle| {
+                if (self.map.acquire(to_slot(handle))) {
+                    _ = self.cache_hits.fetchAdd(1, .monotonic);
+                    return handle;
+                }
+            }
+            _ = self.cache_misses.fetchAdd(1, .monotonic);
+            return null;
+        }
+
+        /// Acquires a new reference to `handle` if valid.
+        pub fn acquire(self: *Self, handle: Handle) bool {
+            return self.map.acquire(to_slot(handle));
+        }
 
-        /// Releases a reference to `handle` and returns whether it was destroyed.
-        pub fn release(self: *Self, handle: Handle) ReleaseResult {
-            if (!self.handle_manager.is_valid(handle.index, handle.generation)) return .{ .destroyed = false, .path = null, .data = null };
-            if (handle.index >= self.entries.items.len) return .{ .destroyed = false, .path = null, .data = null };
+        /// Releases a reference to `handle`. Entries without a backing resource are removed when
+        /// their last reference goes away; resource-backed entries stay cached for eviction.
+        pub fn release(self: *Self, handle: Handle) void {
+            const remaining = self.map.release(to_slot(handle)) orelse return;
+            if (remaining != 0) return;
+            const stored = self.get_stored(handle) orelse return;
+            if (stored.resource == null) _ = self.remove_unreferenced(handle);
+        }
+
+        /// Registers `data` under `owned_path` (or unkeyed when null) and takes ownership of the
+        /// path. If the path is already registered the existing handle is returned instead. With
+        /// `acquire_ref` the returned handle carries a new reference.
+        pub fn add(
+            self: *Self,
+            owned_path: ?[:0]u8,
+            data: T,
+            resource: ?*ref_counting.CardinalRefCountedResource,
+            bytes: u64,
+            acquire_ref: bool,
+        ) !Handle {
+            const key: ?u64 = if (owned_path) |p| path_key(p) else null;
+
+            self.map.write_lock.lock();
+            defer self.map.write_lock.unlock();
+
+            const result = self.map.get_or_insert_locked(key, .{ .data = data, .path = owned_path, .resource = resource }, bytes, acquire_ref) catch |err| {
+                if (owned_path) |p| self.allocator.free(p);
+                return err;
+            };
 
-            var entry = &self.entries.items[handle.index];
-            if (entry.ref_count > 0) {
-                entry.ref_count -= 1;
+            if (result.inserted) {
+                if (resource) |ref| _ = @atomicRmw(u32, &ref.ref_count, .Add, 1, .seq_cst);
+                return from_slot(result.handle);
             }
 
-            if (has_ref_resource) {
-                if (entry.data.ref_resource) |ref| {
-                    ref_counting.cardinal_ref_release(ref);
+            if (owned_path) |p| {
+                defer self.allocator.free(p);
+                const existing = self.map.resolve(result.handle).?;
+                if (existing.data.path) |existing_path| {
+                    if (!std.mem.eql(u8, existing_path, p)) {
+                        if (acquire_ref) _ = self.map.release(result.handle);
+                        asset_log.err("Asset key collision: '{s}' vs '{s}'", .{ p, existing_path });
+                        return error.AssetKeyCollision;
+                    }
                 }
             }
+            return from_slot(result.handle);
+        }
 
-            if (entry.ref_count == 0) {
-                const p = entry.path;
-                var d = entry.data;
-                entry.path = null;
+        /// Removes `handle` if nothing references it. Returns true if it was destroyed.
+        pub fn remove_unreferenced(self: *Self, handle: Handle) bool {
+            const stored = self.map.remove(to_slot(handle), false) orelse return false;
+            self.destroy(stored);
+            return true;
+        }
 
-                _ = self.handle_manager.free(handle.index, handle.generation);
+        /// Evicts an unreferenced entry; the caller holds `map.write_lock`.
+        fn evict_locked(self: *Self, handle: SlotHandle) bool {
+            const stored = self.map.remove_locked(handle, false) orelse return false;
+            self.destroy(stored);
+            _ = self.evictions.fetchAdd(1, .monotonic);
+            return true;
+        }
 
-                if (has_ref_resource) {
-                    if (d.ref_resource != null) {
-                        d.ref_resource = null;
-                    }
-                }
+        /// Drops every unreferenced entry and returns how many were removed.
+        pub fn clear_unreferenced(self: *Self) u32 {
+            self.map.write_lock.lock();
+            defer self.map.write_lock.unlock();
 
-                return .{ .destroyed = true, .path = p, .data = d };
+            var removed: u32 = 0;
+            var it = self.map.iterator();
+            while (it.next()) |entry| {
+                if (self.evict_locked(entry.handle)) removed += 1;
             }
-            return .{ .destroyed = false, .path = null, .data = null };
+            return removed;
         }
 
-        /// Acquires a new reference to `handle` if valid.
-        pub fn acquire(self: *Self, handle: Handle) void {
-            if (!self.handle_manager.is_valid(handle.index, handle.generation)) return;
-            if (handle.index >= self.entries.items.len) return;
-            var entry = &self.entries.items[handle.index];
-            entry.ref_count += 1;
-            if (has_ref_resource) {
-                if (entry.data.ref_resource) |ref| {
-                    _ = @atomicRmw(u32, &ref.ref_count, .Add, 1, .seq_cst);
-                }
+        /// Appends unreferenced entries to `out`; the caller holds `map.write_lock`.
+        fn collect_candidates_locked(self: *Self, allocator: std.mem.Allocator, kind: AssetType, out: *std.ArrayListUnmanaged(EvictionCandidate)) !void {
+            var it = self.map.iterator();
+            while (it.next()) |entry| {
+                if (entry.slot.refs.load(.acquire) != 0) continue;
+                try out.append(allocator, .{
+                    .kind = kind,
+                    .handle = entry.handle,
+                    .last_use = entry.slot.last_use.load(.monotonic),
+                    .bytes = entry.slot.bytes.load(.monotonic),
+                });
             }
         }
+
+        /// Number of live entries.
+        pub fn count(self: *const Self) u32 {
+            return self.map.live_count.load(.monotonic);
+        }
     };
 }
 
+/// Resident size of a texture entry, read from its backing resource when it has one so that
+/// async loads replacing the placeholder are accounted for.
+fn texture_bytes(texture: *const scene.CardinalTexture) u64 {
+    if (texture.ref_resource) |ref| {
+        if (ref.resource) |res| {
+            const data: *const texture_loader.TextureData = @ptrCast(@alignCast(res));
+            if (data.data_size != 0) return data.data_size;
+            return @as(u64, data.width) * data.height * data.channels;
+        }
+    }
+    if (texture.data_size != 0) return texture.data_size;
+    return @as(u64, texture.width) * texture.height * texture.channels;
+}
+
+fn mesh_bytes(mesh: *const scene.CardinalMesh) u64 {
+    var bytes: u64 = @sizeOf(scene.CardinalMesh);
+    if (mesh.vertices != null) bytes += @as(u64, mesh.vertex_count) * @sizeOf(scene.CardinalVertex);
+    if (mesh.indices != null) bytes += @as(u64, mesh.index_count) * @sizeOf(u32);
+    return bytes;
+}
+
 pub const AssetManager = struct {
     allocator: std.mem.Allocator,
 
@@ -172,20 +290,24 @@ pub const AssetManager = struct {
     meshes: AssetStorage(scene.CardinalMesh, handles.MeshHandle),
     materials: AssetStorage(scene.CardinalMaterial, handles.MaterialHandle),
 
-    texture_path_map: std.StringHashMapUnmanaged(handles.TextureHandle),
-    mesh_path_map: std.StringHashMapUnmanaged(handles.MeshHandle),
-    material_path_map: std.StringHashMapUnmanaged(handles.MaterialHandle),
+    /// Byte budget shared by cached textures and meshes.
+    budget_bytes: std.atomic.Value(u64) = .init(DEFAULT_BUDGET_BYTES),
+    cache_inserts: std.atomic.Value(u32) = .init(0),
+    /// Serializes eviction passes (which lock both texture and mesh maps).
+    evict_lock: std.Thread.Mutex = .{},
 
     /// Creates a new manager using `allocator` for all internal allocations.
-    pub fn init(allocator: std.mem.Allocator) AssetManager {
+    pub fn init(allocator: std.mem.Allocator, max_entries: u32) !AssetManager {
+        var textures = try AssetStorage(scene.CardinalTexture, handles.TextureHandle).init(allocator, max_entries);
+        errdefer textures.deinit();
+        var meshes = try AssetStorage(scene.CardinalMesh, handles.MeshHandle).init(allocator, max_entries);
+        errdefer meshes.deinit();
+        const materials = try AssetStorage(scene.CardinalMaterial, handles.MaterialHandle).init(allocator, max_entries);
         return .{
             .allocator = allocator,
-            .textures = AssetStorage(scene.CardinalTexture, handles.TextureHandle).init(allocator),
-            .meshes = AssetStorage(scene.CardinalMesh, handles.MeshHandle).init(allocator),
-            .materials = AssetStorage(scene.CardinalMaterial, handles.MaterialHandle).init(allocator),
-            .texture_path_map = .{},
-            .mesh_path_map = .{},
-            .material_path_map = .{},
+            .textures = textures,
+            .meshes = meshes,
+            .materials = materials,
         };
     }
 
@@ -194,168 +316,256 @@ pub const AssetManager = struct {
         self.textures.deinit();
         self.meshes.deinit();
         self.materials.deinit();
-        self.texture_path_map.deinit(self.allocator);
-        self.mesh_path_map.deinit(self.allocator);
-        self.material_path_map.deinit(self.allocator);
     }
 
     /// Loads a texture from `path`, returning a stable handle.
     pub fn loadTexture(self: *AssetManager, path: []const u8) !handles.TextureHandle {
-        if (self.texture_path_map.get(path)) |handle| {
-            self.textures.acquire(handle);
-            return handle;
-        }
+        if (self.textures.acquire_path(path)) |handle| return handle;
 
-        var texture = std.mem.zeroes(scene.CardinalTexture);
         const path_z = try self.allocator.dupeZ(u8, path);
 
         var temp_data = std.mem.zeroes(texture_loader.TextureData);
-        const res = texture_loader.texture_load_with_ref_counting(@ptrCast(path_z), &temp_data);
-
-        if (res == null) {
+        const res = texture_loader.texture_load_with_ref_counting(path_z.ptr, &temp_data) orelse {
             self.allocator.free(path_z);
             return error.FailedToLoadTexture;
-        }
+        };
+        // The stored entry takes its own reference on insert.
+        defer ref_counting.cardinal_ref_release(res);
 
+        var texture = std.mem.zeroes(scene.CardinalTexture);
         texture.data = temp_data.data;
         texture.width = temp_data.width;
         texture.height = temp_data.height;
         texture.channels = temp_data.channels;
         texture.is_hdr = temp_data.is_hdr;
+        texture.format = temp_data.format;
+        texture.data_size = temp_data.data_size;
         texture.ref_resource = res;
-        texture.path = path_z;
+        texture.path = path_z.ptr;
 
-        const add_res = try self.textures.add(texture, path);
-        if (add_res.stored_path) |p| {
-            try self.texture_path_map.put(self.allocator, p, add_res.handle);
-        } else {
-            try self.texture_path_map.put(self.allocator, path, add_res.handle);
-        }
+        // `add` takes ownership of `path_z`, including on failure.
+        const handle = try self.textures.add(path_z, texture, res, texture_bytes(&texture), true);
+        self.after_cache_insert();
 
-        asset_log.info("Loaded texture: {s} -> Handle({d}, {d})", .{ path, add_res.handle.index, add_res.handle.generation });
-        return add_res.handle;
+        asset_log.info("Loaded texture: {s} -> Handle({d}, {d})", .{ path, handle.index, handle.generation });
+        return handle;
     }
 
-    /// Returns a mutable texture pointer for `handle` if still valid.
+    /// Returns a mutable texture pointer for `handle` if still valid. The caller must hold a
+    /// reference on `handle` for as long as it uses the pointer.
     pub fn getTexture(self: *AssetManager, handle: handles.TextureHandle) ?*scene.CardinalTexture {
         return self.textures.get(handle);
     }
 
-    /// Returns a texture by path if it has been loaded and not destroyed.
-    pub fn findTexture(self: *AssetManager, path: []const u8) ?*scene.CardinalTexture {
-        if (self.texture_path_map.get(path)) |handle| {
-            return self.textures.get(handle);
-        }
-        return null;
+    /// Returns a referenced handle to the texture at `path` if it is resident, pinning it against
+    /// eviction. Release it with `releaseTexture`.
+    pub fn findTexture(self: *AssetManager, path: []const u8) ?handles.TextureHandle {
+        return self.textures.pin_path(path);
     }
 
-    /// Releases a texture handle reference and unloads it when the count hits zero.
+    /// Releases a texture handle reference. The texture stays cached until evicted by budget.
     pub fn releaseTexture(self: *AssetManager, handle: handles.TextureHandle) void {
-        const res = self.textures.release(handle);
-        if (res.destroyed) {
-            if (res.data) |tex| {
-                if (tex.path) |p| {
-                    self.allocator.free(std.mem.span(p));
-                }
-            }
+        self.textures.release(handle);
+    }
 
-            if (res.path) |p| {
-                if (self.texture_path_map.fetchRemove(p)) |kv| {
-                    self.allocator.free(kv.key);
-                } else {
-                    self.allocator.free(p);
-                }
-            }
+    /// Returns a retained texture resource for `path` if it is cached. Wait-free on hits.
+    pub fn acquireTextureResource(self: *AssetManager, path: []const u8) ?*ref_counting.CardinalRefCountedResource {
+        const handle = self.textures.find(path) orelse {
+            _ = self.textures.cache_misses.fetchAdd(1, .monotonic);
+            return null;
+        };
+        // Pin the entry while taking a reference on its resource so eviction cannot race us.
+        if (!self.textures.acquire(handle)) {
+            _ = self.textures.cache_misses.fetchAdd(1, .monotonic);
+            return null;
         }
+        defer _ = self.textures.map.release(.{ .index = handle.index, .generation = handle.generation });
+
+        const stored = self.textures.get_stored(handle) orelse return null;
+        const res = stored.resource orelse return null;
+        _ = @atomicRmw(u32, &res.ref_count, .Add, 1, .seq_cst);
+        _ = self.textures.cache_hits.fetchAdd(1, .monotonic);
+        return res;
+    }
+
+    /// Caches a loader-created texture resource under `path` without adding a handle reference.
+    pub fn cacheTexture(self: *AssetManager, path: []const u8, resource: *ref_counting.CardinalRefCountedResource) bool {
+        const path_z = self.allocator.dupeZ(u8, path) catch return false;
+        const data: *const texture_loader.TextureData = @ptrCast(@alignCast(resource.resource.?));
+
+        var texture = std.mem.zeroes(scene.CardinalTexture);
+        texture.data = data.data;
+        texture.width = data.width;
+        texture.height = data.height;
+        texture.channels = data.channels;
+        texture.is_hdr = data.is_hdr;
+        texture.format = data.format;
+        texture.data_size = data.data_size;
+        texture.ref_resource = resource;
+        texture.path = path_z.ptr;
+
+        _ = self.textures.add(path_z, texture, resource, texture_bytes(&texture), false) catch |err| {
+            asset_log.warn("Failed to cache texture {s}: {s}", .{ path, @errorName(err) });
+            return false;
+        };
+        self.after_cache_insert();
+        return true;
+    }
+
+    /// Drops the cached entry for `path` if nothing references it (e.g. after a failed load).
+    pub fn forgetTexture(self: *AssetManager, path: []const u8) void {
+        const handle = self.textures.find(path) orelse return;
+        _ = self.textures.remove_unreferenced(handle);
     }
 
     /// Adds a mesh and optionally registers it under `path` for handle reuse.
     pub fn addMesh(self: *AssetManager, mesh: scene.CardinalMesh, path: ?[]const u8) !handles.MeshHandle {
         if (path) |p| {
-            if (self.mesh_path_map.get(p)) |handle| {
-                self.meshes.acquire(handle);
-                return handle;
+            if (self.meshes.find(p)) |handle| {
+                if (self.meshes.acquire(handle)) return handle;
             }
         }
-
-        const add_res = try self.meshes.add(mesh, path);
-        if (add_res.stored_path) |p| {
-            try self.mesh_path_map.put(self.allocator, p, add_res.handle);
-        } else if (path) |p| {
-            try self.mesh_path_map.put(self.allocator, p, add_res.handle);
-        }
-        return add_res.handle;
+        const owned_path: ?[:0]u8 = if (path) |p| try self.allocator.dupeZ(u8, p) else null;
+        return self.meshes.add(owned_path, mesh, null, 0, true);
     }
 
-    /// Returns a mutable mesh pointer for `handle` if still valid.
+    /// Returns a mutable mesh pointer for `handle` if still valid. The caller must hold a
+    /// reference on `handle` for as long as it uses the pointer.
     pub fn getMesh(self: *AssetManager, handle: handles.MeshHandle) ?*scene.CardinalMesh {
         return self.meshes.get(handle);
     }
 
-    /// Returns a mesh by path if it has been added and not destroyed.
-    pub fn findMesh(self: *AssetManager, path: []const u8) ?*scene.CardinalMesh {
-        if (self.mesh_path_map.get(path)) |handle| {
-            return self.meshes.get(handle);
-        }
-        return null;
+    /// Returns a referenced handle to the mesh at `path` if it has been added and not destroyed.
+    /// Release it with `releaseMesh`.
+    pub fn findMesh(self: *AssetManager, path: []const u8) ?handles.MeshHandle {
+        return self.meshes.pin_path(path);
     }
 
-    /// Releases a mesh handle reference and removes its path mapping when destroyed.
+    /// Releases a mesh handle reference. Caller-owned meshes are dropped at zero references.
     pub fn releaseMesh(self: *AssetManager, handle: handles.MeshHandle) void {
-        const res = self.meshes.release(handle);
-        if (res.destroyed) {
-            if (res.path) |p| {
-                if (self.mesh_path_map.fetchRemove(p)) |kv| {
-                    self.allocator.free(kv.key);
-                } else {
-                    self.allocator.free(p);
-                }
-            }
+        self.meshes.release(handle);
+    }
+
+    /// Returns a retained mesh resource cached under `mesh_id`. Wait-free on hits.
+    pub fn acquireMeshResource(self: *AssetManager, mesh_id: []const u8) ?*ref_counting.CardinalRefCountedResource {
+        const handle = self.meshes.find(mesh_id) orelse {
+            _ = self.meshes.cache_misses.fetchAdd(1, .monotonic);
+            return null;
+        };
+        if (!self.meshes.acquire(handle)) {
+            _ = self.meshes.cache_misses.fetchAdd(1, .monotonic);
+            return null;
         }
+        defer _ = self.meshes.map.release(.{ .index = handle.index, .generation = handle.generation });
+
+        const stored = self.meshes.get_stored(handle) orelse return null;
+        const res = stored.resource orelse return null;
+        _ = @atomicRmw(u32, &res.ref_count, .Add, 1, .seq_cst);
+        _ = self.meshes.cache_hits.fetchAdd(1, .monotonic);
+        return res;
+    }
+
+    /// Caches a loader-created mesh resource under `mesh_id` without adding a handle reference.
+    pub fn cacheMesh(self: *AssetManager, mesh_id: []const u8, resource: *ref_counting.CardinalRefCountedResource) bool {
+        const mesh: *const scene.CardinalMesh = @ptrCast(@alignCast(resource.resource.?));
+        const id_z = self.allocator.dupeZ(u8, mesh_id) catch return false;
+        _ = self.meshes.add(id_z, mesh.*, resource, mesh_bytes(mesh), false) catch |err| {
+            asset_log.warn("Failed to cache mesh {s}: {s}", .{ mesh_id, @errorName(err) });
+            return false;
+        };
+        self.after_cache_insert();
+        return true;
     }
 
     /// Adds a material and optionally registers it under `path` for handle reuse.
     pub fn addMaterial(self: *AssetManager, material: scene.CardinalMaterial, path: ?[]const u8) !handles.MaterialHandle {
         if (path) |p| {
-            if (self.material_path_map.get(p)) |handle| {
-                self.materials.acquire(handle);
-                return handle;
+            if (self.materials.find(p)) |handle| {
+                if (self.materials.acquire(handle)) return handle;
             }
         }
-
-        const add_res = try self.materials.add(material, path);
-        if (add_res.stored_path) |p| {
-            try self.material_path_map.put(self.allocator, p, add_res.handle);
-        } else if (path) |p| {
-            try self.material_path_map.put(self.allocator, p, add_res.handle);
-        }
-        return add_res.handle;
+        const owned_path: ?[:0]u8 = if (path) |p| try self.allocator.dupeZ(u8, p) else null;
+        return self.materials.add(owned_path, material, null, 0, true);
     }
 
-    /// Returns a mutable material pointer for `handle` if still valid.
+    /// Returns a mutable material pointer for `handle` if still valid. The caller must hold a
+    /// reference on `handle` for as long as it uses the pointer.
     pub fn getMaterial(self: *AssetManager, handle: handles.MaterialHandle) ?*scene.CardinalMaterial {
         return self.materials.get(handle);
     }
 
-    /// Returns a material by path if it has been added and not destroyed.
-    pub fn findMaterial(self: *AssetManager, path: []const u8) ?*scene.CardinalMaterial {
-        if (self.material_path_map.get(path)) |handle| {
-            return self.materials.get(handle);
-        }
-        return null;
+    /// Returns a referenced handle to the material at `path` if it has been added and not
+    /// destroyed. Release it with `releaseMaterial`.
+    pub fn findMaterial(self: *AssetManager, path: []const u8) ?handles.MaterialHandle {
+        return self.materials.pin_path(path);
     }
 
-    /// Releases a material handle reference and removes its path mapping when destroyed.
+    /// Releases a material handle reference and removes it when the count hits zero.
     pub fn releaseMaterial(self: *AssetManager, handle: handles.MaterialHandle) void {
-        const res = self.materials.release(handle);
-        if (res.destroyed) {
-            if (res.path) |p| {
-                if (self.material_path_map.fetchRemove(p)) |kv| {
-                    self.allocator.free(kv.key);
-                } else {
-                    self.allocator.free(p);
-                }
-            }
+        self.materials.release(handle);
+    }
+
+    /// Sets the byte budget shared by cached textures and meshes and evicts down to it.
+    pub fn setBudget(self: *AssetManager, bytes: u64) void {
+        self.budget_bytes.store(bytes, .monotonic);
+        _ = self.evictToBudget();
+    }
+
+    /// Bytes currently held by cached textures and meshes.
+    pub fn residentBytes(self: *const AssetManager) u64 {
+        return self.textures.map.resident_bytes.load(.monotonic) + self.meshes.map.resident_bytes.load(.monotonic);
+    }
+
+    /// Evicts least recently used unreferenced textures and meshes until the resident size fits
+    /// the budget. Returns the number of bytes evicted.
+    pub fn evictToBudget(self: *AssetManager) u64 {
+        self.evict_lock.lock();
+        defer self.evict_lock.unlock();
+
+        self.textures.map.write_lock.lock();
+        defer self.textures.map.write_lock.unlock();
+        self.meshes.map.write_lock.lock();
+        defer self.meshes.map.write_lock.unlock();
+
+        // Textures are usually cached as 1x1 placeholders and filled in by async loads, so their
+        // sizes are refreshed before comparing against the budget.
+        var it = self.textures.map.iterator();
+        while (it.next()) |entry| {
+            self.textures.map.set_bytes(entry.handle, texture_bytes(&entry.slot.data.data));
+        }
+
+        const budget = self.budget_bytes.load(.monotonic);
+        if (self.residentBytes() <= budget) return 0;
+
+        var candidates: std.ArrayListUnmanaged(EvictionCandidate) = .{};
+        defer candidates.deinit(self.allocator);
+        self.textures.collect_candidates_locked(self.allocator, .Texture, &candidates) catch return 0;
+        self.meshes.collect_candidates_locked(self.allocator, .Mesh, &candidates) catch return 0;
+        std.mem.sort(EvictionCandidate, candidates.items, {}, EvictionCandidate.older);
+
+        var evicted: u64 = 0;
+        for (candidates.items) |candidate| {
+            if (self.residentBytes() <= budget) break;
+            const removed = switch (candidate.kind) {
+                .Texture => self.textures.evict_locked(candidate.handle),
+                .Mesh => self.meshes.evict_locked(candidate.handle),
+                else => false,
+            };
+            if (removed) evicted += candidate.bytes;
+        }
+
+        if (evicted > 0) {
+            asset_log.debug("Evicted {d} bytes (resident {d}/{d})", .{ evicted, self.residentBytes(), budget });
+        }
+        return evicted;
+    }
+
+    /// Runs a budget check every few cache inserts, or immediately when over budget.
+    fn after_cache_insert(self: *AssetManager) void {
+        _ = asset_slot_map.advance_clock();
+        const inserts = self.cache_inserts.fetchAdd(1, .monotonic) + 1;
+        if (inserts % EVICT_CHECK_INTERVAL == 0 or self.residentBytes() > self.budget_bytes.load(.monotonic)) {
+            _ = self.evictToBudget();
         }
     }
 };
@@ -415,26 +625,132 @@ pub fn toStdAllocator(allocator: *memory.CardinalAllocator) Allocator {
 
 /// Global singleton instance used by the engine-facing convenience API.
 var g_asset_manager: AssetManager = undefined;
-var g_initialized: bool = false;
+var g_initialized = std.atomic.Value(bool).init(false);
+var g_init_mutex: std.Thread.Mutex = .{};
 
-/// Initializes the global asset manager using the `.ASSETS` allocator category.
+/// Initializes the global asset manager using the `.ASSETS` allocator category (idempotent).
 pub fn init() !void {
-    if (g_initialized) return;
+    g_init_mutex.lock();
+    defer g_init_mutex.unlock();
+
+    if (g_initialized.load(.acquire)) return;
     const allocator_ptr = memory.cardinal_get_allocator_for_category(.ASSETS);
     const allocator = toStdAllocator(allocator_ptr);
-    g_asset_manager = AssetManager.init(allocator);
-    g_initialized = true;
+    g_asset_manager = try AssetManager.init(allocator, DEFAULT_MAX_ASSETS);
+    g_initialized.store(true, .release);
     asset_log.info("Asset Manager initialized", .{});
 }
 
 /// Shuts down and frees the global asset manager.
 pub fn shutdown() void {
-    if (!g_initialized) return;
+    g_init_mutex.lock();
+    defer g_init_mutex.unlock();
+
+    if (!g_initialized.load(.acquire)) return;
+    g_initialized.store(false, .release);
     g_asset_manager.deinit();
-    g_initialized = false;
+}
+
+/// Returns true once `init` has completed.
+pub fn is_initialized() bool {
+    return g_initialized.load(.acquire);
 }
 
 /// Returns a pointer to the global asset manager (must be initialized first).
 pub fn get() *AssetManager {
     return &g_asset_manager;
 }
+
+/// Sets the byte budget shared by cached textures and meshes.
+pub export fn cardinal_asset_manager_set_budget(bytes: u64) callconv(.c) void {
+    if (!is_initialized()) return;
+    g_asset_manager.setBudget(bytes);
+}
+
+/// Returns the bytes currently held by cached textures and meshes.
+pub export fn cardinal_asset_manager_get_resident_bytes() callconv(.c) u64 {
+    if (!is_initialized()) return 0;
+    return g_asset_manager.residentBytes();
+}
+
+/// Evicts unreferenced textures and meshes down to the budget; returns the bytes evicted.
+pub export fn cardinal_asset_manager_evict_to_budget() callconv(.c) u64 {
+    if (!is_initialized()) return 0;
+    return g_asset_manager.evictToBudget();
+}
+
+fn make_test_mesh_resource(id: [*:0]const u8, vertex_count: u32) !*ref_counting.CardinalRefCountedResource {
+    const allocator = std.testing.allocator;
+    const mesh = try allocator.create(scene.CardinalMesh);
+    mesh.* = std.mem.zeroes(scene.CardinalMesh);
+    mesh.vertex_count = vertex_count;
+    const Destructor = struct {
+        fn destroy(ptr: ?*anyopaque) callconv(.c) void {
+            std.testing.allocator.destroy(@as(*scene.CardinalMesh, @ptrCast(@alignCast(ptr.?))));
+        }
+    };
+    return ref_counting.cardinal_ref_create(id, mesh, @sizeOf(scene.CardinalMesh), Destructor.destroy) orelse error.OutOfMemory;
+}
+
+test "asset manager caches released meshes and evicts least recently used by budget" {
+    memory.cardinal_memory_init(4 * 1024 * 1024);
+    defer memory.cardinal_memory_shutdown();
+    try std.testing.expect(ref_counting.cardinal_ref_counting_init(64));
+    defer ref_counting.cardinal_ref_counting_shutdown();
+
+    var manager = try AssetManager.init(std.testing.allocator, 256);
+    defer manager.deinit();
+
+    const a = try make_test_mesh_resource("mesh_a", 0);
+    const b = try make_test_mesh_resource("mesh_b", 0);
+    const c = try make_test_mesh_resource("mesh_c", 0);
+
+    try std.testing.expect(manager.cacheMesh("mesh_a", a));
+    try std.testing.expect(manager.cacheMesh("mesh_b", b));
+    try std.testing.expect(manager.cacheMesh("mesh_c", c));
+    // The cache now owns the only references.
+    ref_counting.cardinal_ref_release(a);
+    ref_counting.cardinal_ref_release(b);
+    ref_counting.cardinal_ref_release(c);
+
+    const entry_bytes = mesh_bytes(&std.mem.zeroes(scene.CardinalMesh));
+    try std.testing.expectEqual(3 * entry_bytes, manager.residentBytes());
+
+    // Touch `a` so `b` becomes the least recently used entry, and pin `c` with a handle.
+    _ = asset_slot_map.advance_clock();
+    const res_a = manager.acquireMeshResource("mesh_a").?;
+    ref_counting.cardinal_ref_release(res_a);
+    const pinned = manager.meshes.acquire_path("mesh_c").?;
+
+    manager.setBudget(2 * entry_bytes);
+    try std.testing.expect(manager.meshes.find("mesh_b") == null);
+    try std.testing.expect(manager.meshes.find("mesh_a") != null);
+    try std.testing.expect(manager.meshes.find("mesh_c") != null);
+
+    // Referenced entries are never evicted, even over budget.
+    manager.setBudget(0);
+    try std.testing.expect(manager.meshes.find("mesh_a") == null);
+    try std.testing.expect(manager.meshes.find("mesh_c") != null);
+    try std.testing.expect(manager.acquireMeshResource("mesh_b") == null);
+
+    manager.releaseMesh(pinned);
+    _ = manager.evictToBudget();
+    try std.testing.expect(manager.meshes.find("mesh_c") == null);
+    try std.testing.expectEqual(@as(u64, 0), manager.residentBytes());
+}
+
+test "asset manager drops caller-owned entries at zero references" {
+    var manager = try AssetManager.init(std.testing.allocator, 64);
+    defer manager.deinit();
+
+    const material = std.mem.zeroes(scene.CardinalMaterial);
+    const first = try manager.addMaterial(material, "materials/rock");
+    const second = try manager.addMaterial(material, "materials/rock");
+    try std.testing.expectEqual(first, second);
+
+    manager.releaseMaterial(first);
+    try std.testing.expect(manager.materials.find("materials/rock") != null);
+    manager.releaseMaterial(second);
+    try std.testing.expect(manager.materials.find("materials/rock") == null);
+    try std.testing.expect(manager.materials.get_stored(first) == null);
+}
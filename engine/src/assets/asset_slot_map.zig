@@ -0,0 +1,586 @@
+//! Generational slot map used for asset storage.
+//!
+//! Slots live in fixed-size pages that are allocated on demand and never moved or freed before
+//! `deinit`, so readers can resolve a handle or a 64-bit key with a few atomic operations and no
+//! lock.
+//! Structural changes (insert, remove, eviction) are serialized by `write_lock`.
+//!
+//! A slot's generation is odd while it is live and even while it is free; handles carry the odd
+//! generation they were issued with. Entries that still hold references are never removed unless
+//! forced, so a reader that keeps data beyond the current frame should `acquire` it first.
+//!
+//! The key index is double-buffered. Removed keys leave tombstones; once they pile up the writer
+//! rebuilds the live keys into the idle table and swaps it in, after waiting out any lookup that
+//! still probes the idle table from before the previous swap.
+const std = @import("std");
+
+/// Raw handle layout shared with `handles.TextureHandle`, `handles.MeshHandle`, etc.
+pub const SlotHandle = struct {
+    index: u32,
+    generation: u32,
+};
+
+/// Monotonic use clock shared by every slot map, so eviction can compare entries across asset
+/// types.
+var g_use_clock = std.atomic.Value(u64).init(1);
+
+/// Advances the shared use clock and returns the new tick.
+pub fn advance_clock() u64 {
+    return g_use_clock.fetchAdd(1, .monotonic) + 1;
+}
+
+/// Returns the current use clock tick.
+pub fn current_clock() u64 {
+    return g_use_clock.load(.monotonic);
+}
+
+pub fn SlotMap(comptime T: type) type {
+    return struct {
+        const Self = @This();
+
+        pub const PAGE_SHIFT = 8;
+        pub const PAGE_SIZE: u32 = 1 << PAGE_SHIFT;
+
+        const EMPTY_KEY: u64 = 0;
+        const TOMBSTONE_KEY: u64 = std.math.maxInt(u64);
+        const NO_FREE: u32 = std.math.maxInt(u32);
+        /// Reference count of a slot that is being torn down; `acquire` fails while it is set.
+        const DEAD: u32 = std.math.maxInt(u32);
+
+        pub const Slot = struct {
+            generation: std.atomic.Value(u32) = .init(0),
+            refs: std.atomic.Value(u32) = .init(0),
+            key: std.atomic.Value(u64) = .init(EMPTY_KEY),
+            bytes: std.atomic.Value(u64) = .init(0),
+            last_use: std.atomic.Value(u64) = .init(0),
+            next_free: u32 = NO_FREE,
+            data: T = undefined,
+        };
+
+        const Page = [PAGE_SIZE]Slot;
+
+        /// One open-addressing key table. Keys are published after their value, and removed keys
+        /// become tombstones rather than empty cells, so lock-free probes cannot stop early.
+        const IndexTable = struct {
+            keys: []std.atomic.Value(u64) = &.{},
+            values: []std.atomic.Value(u64) = &.{},
+            /// Lookups currently probing this table.
+            readers: std.atomic.Value(u32) = .init(0),
+        };
+
+        pub const InsertResult = struct {
+            handle: SlotHandle,
+            inserted: bool,
+        };
+
+        allocator: std.mem.Allocator,
+        pages: []std.atomic.Value(?*Page),
+        /// Key index tables; the idle one is allocated on the first rebuild.
+        tables: *[2]IndexTable,
+        active_table: std.atomic.Value(u32) = .init(0),
+        index_mask: usize,
+
+        write_lock: std.Thread.Mutex = .{},
+        slot_high_water: u32 = 0,
+        free_head: u32 = NO_FREE,
+        /// Tombstones in the active table; guarded by `write_lock`.
+        tombstones: usize = 0,
+
+        live_count: std.atomic.Value(u32) = .init(0),
+        resident_bytes: std.atomic.Value(u64) = .init(0),
+        peak_bytes: std.atomic.Value(u64) = .init(0),
+
+        /// Creates a map that can hold up to `max_entries` live entries (rounded up to a page).
+        pub fn init(allocator: std.mem.Allocator, max_entries: u32) !Self {
+            const page_count = std.math.divCeil(u32, @max(max_entries, 1), PAGE_SIZE) catch unreachable;
+            const pages = try allocator.alloc(std.atomic.Value(?*Page), page_count);
+            errdefer allocator.free(pages);
+            for (pages) |*page| page.* = .init(null);
+
+            const index_capacity = try std.math.ceilPowerOfTwo(usize, @as(usize, page_count) * PAGE_SIZE * 2);
+            const tables = try allocator.create([2]IndexTable);
+            errdefer allocator.destroy(tables);
+            tables.* = .{ .{}, .{} };
+            try alloc_table(allocator, &tables[0], index_capacity);
+
+            return .{
+                .allocator = allocator,
+                .pages = pages,
+                .tables = tables,
+                .index_mask = index_capacity - 1,
+            };
+        }
+
+        fn alloc_table(allocator: std.mem.Allocator, table: *IndexTable, index_capacity: usize) !void {
+            const keys = try allocator.alloc(std.atomic.Value(u64), index_capacity);
+            errdefer allocator.free(keys);
+            const values = try allocator.alloc(std.atomic.Value(u64), index_capacity);
+            for (keys) |*k| k.* = .init(EMPTY_KEY);
+            for (values) |*v| v.* = .init(0);
+            table.keys = keys;
+            table.values = values;
+        }
+
+        /// Frees all pages. Live entries are dropped without running any cleanup; drain them first.
+        pub fn deinit(self: *Self) void {
+            for (self.pages) |*page| {
+                if (page.load(.monotonic)) |p| self.allocator.destroy(p);
+            }
+            self.allocator.free(self.pages);
+            for (self.tables) |*table| {
+                self.allocator.free(table.keys);
+                self.allocator.free(table.values);
+            }
+            self.allocator.destroy(self.tables);
+            self.* = undefined;
+        }
+
+        /// Maximum number of live entries.
+        pub fn capacity(self: *const Self) u32 {
+            return @intCast(self.pages.len * PAGE_SIZE);
+        }
+
+        /// Maps reserved key values onto valid ones.
+        pub fn normalize_key(key: u64) u64 {
+            return switch (key) {
+                EMPTY_KEY => 1,
+                TOMBSTONE_KEY => TOMBSTONE_KEY - 1,
+                else => key,
+            };
+        }
+
+        fn pack(handle: SlotHandle) u64 {
+            return (@as(u64, handle.index) << 32) | handle.generation;
+        }
+
+        fn unpack(value: u64) SlotHandle {
+            return .{ .index = @truncate(value >> 32), .generation = @truncate(value) };
+        }
+
+        fn home(self: *const Self, key: u64) usize {
+            return @as(usize, @truncate(key ^ (key >> 29))) & self.index_mask;
+        }
+
+        fn slot_ptr(self: *const Self, index: u32) ?*Slot {
+            const page_index = index >> PAGE_SHIFT;
+            if (page_index >= self.pages.len) return null;
+            const page = self.pages[page_index].load(.acquire) orelse return null;
+            return &page[index & (PAGE_SIZE - 1)];
+        }
+
+        /// Returns the live slot for `handle`, or null if it is stale or invalid. Wait-free.
+        pub fn resolve(self: *const Self, handle: SlotHandle) ?*Slot {
+            if (handle.generation & 1 == 0) return null;
+            const slot = self.slot_ptr(handle.index) orelse return null;
+            if (slot.generation.load(.acquire) != handle.generation) return null;
+            return slot;
+        }
+
+        fn touch(slot: *Slot) void {
+            const now = current_clock();
+            if (slot.last_use.load(.monotonic) != now) slot.last_use.store(now, .monotonic);
+        }
+
+        /// Returns the payload for `handle` and marks it as used. Wait-free.
+        pub fn get(self: *const Self, handle: SlotHandle) ?*T {
+            const slot = self.resolve(handle) orelse return null;
+            touch(slot);
+            return &slot.data;
+        }
+
+        /// Registers a lookup on the active table. Sequentially consistent so a rebuild that waits
+        /// for a table's readers to drain cannot miss one that is about to start probing it.
+        fn pin_table(self: *const Self) *IndexTable {
+            while (true) {
+                const which = self.active_table.load(.seq_cst);
+                const table = &self.tables[which];
+                _ = table.readers.fetchAdd(1, .seq_cst);
+                if (self.active_table.load(.seq_cst) == which) return table;
+                _ = table.readers.fetchSub(1, .release);
+            }
+        }
+
+        /// The table writers update; caller holds `write_lock`.
+        fn active_table_locked(self: *const Self) *IndexTable {
+            return &self.tables[self.active_table.load(.monotonic)];
+        }
+
+        /// Returns the live handle registered under `key`. Lock-free.
+        pub fn find(self: *const Self, key: u64) ?SlotHandle {
+            const table = self.pin_table();
+            defer _ = table.readers.fetchSub(1, .release);
+
+            const k = normalize_key(key);
+            var i = self.home(k);
+            var probes: usize = 0;
+            while (probes <= self.index_mask) : (probes += 1) {
+                const stored = table.keys[i].load(.acquire);
+                if (stored == EMPTY_KEY) return null;
+                if (stored == k) {
+                    const value = table.values[i].load(.acquire);
+                    if (value == 0) return null;
+                    const handle = unpack(value);
+                    const slot = self.resolve(handle) orelse return null;
+                    // The index cell may have been recycled between the two loads; the slot's own
+                    // key is authoritative for its current generation.
+                    if (slot.key.load(.acquire) != k) return null;
+                    if (slot.generation.load(.acquire) != handle.generation) return null;
+                    return handle;
+                }
+                i = (i + 1) & self.index_mask;
+            }
+            return null;
+        }
+
+        /// Adds a reference to `handle`. Fails if the entry is stale or being removed.
+        pub fn acquire(self: *const Self, handle: SlotHandle) bool {
+            const slot = self.resolve(handle) orelse return false;
+            var current = slot.refs.load(.monotonic);
+            while (true) {
+                if (current == DEAD) return false;
+                current = slot.refs.cmpxchgWeak(current, current + 1, .acquire, .monotonic) orelse break;
+            }
+            if (slot.generation.load(.acquire) != handle.generation) {
+                // The slot was recycled under us; undo without disturbing the new owner's count.
+                var refs = slot.refs.load(.monotonic);
+                while (refs != 0 and refs != DEAD) {
+                    refs = slot.refs.cmpxchgWeak(refs, refs - 1, .release, .monotonic) orelse break;
+                }
+                return false;
+            }
+            touch(slot);
+            return true;
+        }
+
+        /// Drops a reference to `handle` and returns the remaining count, or null if stale.
+        pub fn release(self: *const Self, handle: SlotHandle) ?u32 {
+            const slot = self.resolve(handle) orelse return null;
+            var current = slot.refs.load(.monotonic);
+            while (true) {
+                if (current == 0 or current == DEAD) return 0;
+                current = slot.refs.cmpxchgWeak(current, current - 1, .release, .monotonic) orelse return current - 1;
+            }
+        }
+
+        /// Returns the reference count of `handle`, or null if stale.
+        pub fn ref_count(self: *const Self, handle: SlotHandle) ?u32 {
+            const slot = self.resolve(handle) orelse return null;
+            const refs = slot.refs.load(.acquire);
+            return if (refs == DEAD) 0 else refs;
+        }
+
+        /// Updates the resident size of `handle`.
+        pub fn set_bytes(self: *Self, handle: SlotHandle, bytes: u64) void {
+            const slot = self.resolve(handle) orelse return;
+            const old = slot.bytes.swap(bytes, .monotonic);
+            if (bytes >= old) {
+                self.add_resident(bytes - old);
+            } else {
+                _ = self.resident_bytes.fetchSub(old - bytes, .monotonic);
+            }
+        }
+
+        fn add_resident(self: *Self, bytes: u64) void {
+            const total = self.resident_bytes.fetchAdd(bytes, .monotonic) + bytes;
+            _ = self.peak_bytes.fetchMax(total, .monotonic);
+        }
+
+        /// Returns the entry for `key` or inserts `data` under it. When `acquire_ref` is set the
+        /// returned entry gains a reference either way. A null key inserts an unindexed entry.
+        pub fn get_or_insert(self: *Self, key: ?u64, data: T, bytes: u64, acquire_ref: bool) !InsertResult {
+            self.write_lock.lock();
+            defer self.write_lock.unlock();
+            return self.get_or_insert_locked(key, data, bytes, acquire_ref);
+        }
+
+        /// `get_or_insert` for callers that already hold `write_lock`.
+        pub fn get_or_insert_locked(self: *Self, key: ?u64, data: T, bytes: u64, acquire_ref: bool) !InsertResult {
+            const k: u64 = if (key) |value| normalize_key(value) else EMPTY_KEY;
+            if (k != EMPTY_KEY) {
+                if (self.find(k)) |existing| {
+                    // Removal needs the write lock, so the entry cannot be DEAD here.
+                    if (acquire_ref) _ = self.resolve(existing).?.refs.fetchAdd(1, .acquire);
+                    touch(self.resolve(existing).?);
+                    return .{ .handle = existing, .inserted = false };
+                }
+            }
+
+            const index = try self.alloc_slot_locked();
+            const slot = self.slot_ptr(index).?;
+            slot.data = data;
+            slot.key.store(k, .monotonic);
+            // Refs are already zero for a free slot (apart from transient increments by racing
+            // `acquire` calls, which undo themselves), so only add ours.
+            if (acquire_ref) _ = slot.refs.fetchAdd(1, .acquire);
+            slot.bytes.store(bytes, .monotonic);
+            slot.last_use.store(advance_clock(), .monotonic);
+            const generation = slot.generation.load(.monotonic) +% 1;
+            slot.generation.store(generation, .release);
+
+            const handle = SlotHandle{ .index = index, .generation = generation };
+            if (k != EMPTY_KEY) {
+                self.index_insert_locked(k, handle) catch |err| {
+                    slot.generation.store(generation +% 1, .release);
+                    slot.key.store(EMPTY_KEY, .monotonic);
+                    slot.next_free = self.free_head;
+                    self.free_head = index;
+                    return err;
+                };
+            }
+
+            _ = self.live_count.fetchAdd(1, .monotonic);
+            self.add_resident(bytes);
+            return .{ .handle = handle, .inserted = true };
+        }
+
+        fn alloc_slot_locked(self: *Self) !u32 {
+            if (self.free_head != NO_FREE) {
+                const index = self.free_head;
+                self.free_head = self.slot_ptr(index).?.next_free;
+                return index;
+            }
+            if (self.slot_high_water >= self.capacity()) return error.OutOfSlots;
+
+            const index = self.slot_high_water;
+            const page_index = index >> PAGE_SHIFT;
+            if (self.pages[page_index].load(.monotonic) == null) {
+                const page = try self.allocator.create(Page);
+                for (page) |*slot| slot.* = .{};
+                self.pages[page_index].store(page, .release);
+            }
+            self.slot_high_water += 1;
+            return index;
+        }
+
+        fn index_insert_locked(self: *Self, key: u64, handle: SlotHandle) !void {
+            const table = self.active_table_locked();
+            var i = self.home(key);
+            var probes: usize = 0;
+            while (probes <= self.index_mask) : (probes += 1) {
+                const stored = table.keys[i].load(.monotonic);
+                if (stored == TOMBSTONE_KEY or stored == EMPTY_KEY) {
+                    if (stored == TOMBSTONE_KEY) self.tombstones -= 1;
+                    table.values[i].store(pack(handle), .release);
+                    table.keys[i].store(key, .release);
+                    return;
+                }
+                i = (i + 1) & self.index_mask;
+            }
+            return error.IndexFull;
+        }
+
+        fn index_remove_locked(self: *Self, key: u64, handle: SlotHandle) void {
+            const table = self.active_table_locked();
+            const value = pack(handle);
+            var i = self.home(key);
+            var probes: usize = 0;
+            while (probes <= self.index_mask) : (probes += 1) {
+                const stored = table.keys[i].load(.monotonic);
+                if (stored == EMPTY_KEY) return;
+                if (stored == key and table.values[i].load(.monotonic) == value) {
+                    table.values[i].store(0, .release);
+                    table.keys[i].store(TOMBSTONE_KEY, .release);
+                    self.tombstones += 1;
+                    return;
+                }
+                i = (i + 1) & self.index_mask;
+            }
+        }
+
+        /// Rebuilds the live keys into the idle table and makes it active, dropping every
+        /// tombstone. Lookups keep probing whichever table they pinned; the old table is only
+        /// rewritten by the next rebuild, once its readers have drained. Leaves the index as is
+        /// if the idle table cannot be allocated.
+        fn rebuild_index_locked(self: *Self) void {
+            const from = self.active_table.load(.monotonic);
+            const to = &self.tables[from ^ 1];
+            if (to.keys.len == 0) {
+                alloc_table(self.allocator, to, self.index_mask + 1) catch return;
+            }
+            while (to.readers.load(.seq_cst) != 0) std.atomic.spinLoopHint();
+
+            for (to.keys) |*k| k.store(EMPTY_KEY, .monotonic);
+            for (to.values) |*v| v.store(0, .monotonic);
+            var index: u32 = 0;
+            while (index < self.slot_high_water) : (index += 1) {
+                const slot = self.slot_ptr(index) orelse continue;
+                const generation = slot.generation.load(.monotonic);
+                const key = slot.key.load(.monotonic);
+                if (generation & 1 == 0 or key == EMPTY_KEY) continue;
+                var i = self.home(key);
+                while (to.keys[i].load(.monotonic) != EMPTY_KEY) i = (i + 1) & self.index_mask;
+                to.values[i].store(pack(.{ .index = index, .generation = generation }), .monotonic);
+                to.keys[i].store(key, .monotonic);
+            }
+            self.active_table.store(from ^ 1, .seq_cst);
+            self.tombstones = 0;
+        }
+
+        /// Removes `handle` and returns its payload. Referenced entries are kept unless `force`.
+        pub fn remove(self: *Self, handle: SlotHandle, force: bool) ?T {
+            self.write_lock.lock();
+            defer self.write_lock.unlock();
+            return self.remove_locked(handle, force);
+        }
+
+        /// `remove` for callers that already hold `write_lock`.
+        pub fn remove_locked(self: *Self, handle: SlotHandle, force: bool) ?T {
+            const slot = self.resolve(handle) orelse return null;
+            if (force) {
+                slot.refs.store(DEAD, .release);
+            } else if (slot.refs.cmpxchgStrong(0, DEAD, .acq_rel, .monotonic) != null) {
+                return null;
+            }
+
+            const key = slot.key.load(.monotonic);
+            if (key != EMPTY_KEY) self.index_remove_locked(key, handle);
+            slot.generation.store(handle.generation +% 1, .release);
+
+            const data = slot.data;
+            _ = self.resident_bytes.fetchSub(slot.bytes.swap(0, .monotonic), .monotonic);
+            _ = self.live_count.fetchSub(1, .monotonic);
+            slot.key.store(EMPTY_KEY, .monotonic);
+            slot.refs.store(0, .release);
+            slot.next_free = self.free_head;
+            self.free_head = handle.index;
+            // Misses probe until an empty cell, so rebuild before tombstones fill the table.
+            if (self.tombstones >= (self.index_mask + 1) / 4) self.rebuild_index_locked();
+            return data;
+        }
+
+        pub const Entry = struct {
+            handle: SlotHandle,
+            slot: *Slot,
+        };
+
+        /// Walks live entries. Callers must hold `write_lock` or otherwise exclude writers.
+        pub const Iterator = struct {
+            map: *Self,
+            index: u32 = 0,
+
+            pub fn next(it: *Iterator) ?Entry {
+                while (it.index < it.map.slot_high_water) {
+                    const index = it.index;
+                    it.index += 1;
+                    const slot = it.map.slot_ptr(index) orelse continue;
+                    const generation = slot.generation.load(.acquire);
+                    if (generation & 1 == 0) continue;
+                    return .{ .handle = .{ .index = index, .generation = generation }, .slot = slot };
+                }
+                return null;
+            }
+        };
+
+        pub fn iterator(self: *Self) Iterator {
+            return .{ .map = self };
+        }
+    };
+}
+
+test "slot map resolves keys and invalidates stale handles" {
+    var map = try SlotMap(u64).init(std.testing.allocator, 300);
+    defer map.deinit();
+
+    const a = try map.get_or_insert(10, 100, 64, true);
+    try std.testing.expect(a.inserted);
+    const again = try map.get_or_insert(10, 999, 64, false);
+    try std.testing.expect(!again.inserted);
+    try std.testing.expectEqual(a.handle, again.handle);
+    try std.testing.expectEqual(@as(u64, 100), map.get(a.handle).?.*);
+    try std.testing.expectEqual(a.handle, map.find(10).?);
+    try std.testing.expectEqual(@as(u64, 64), map.resident_bytes.load(.monotonic));
+
+    // Referenced entries survive a non-forced removal.
+    try std.testing.expect(map.remove(a.handle, false) == null);
+    try std.testing.expectEqual(@as(?u32, 0), map.release(a.handle));
+    try std.testing.expectEqual(@as(?u64, 100), map.remove(a.handle, false));
+
+    try std.testing.expect(map.get(a.handle) == null);
+    try std.testing.expect(map.find(10) == null);
+    try std.testing.expect(!map.acquire(a.handle));
+    try std.testing.expectEqual(@as(u64, 0), map.resident_bytes.load(.monotonic));
+
+    // The freed slot is reused with a new generation.
+    const b = try map.get_or_insert(11, 200, 0, false);
+    try std.testing.expectEqual(a.handle.index, b.handle.index);
+    try std.testing.expect(a.handle.generation != b.handle.generation);
+    try std.testing.expect(map.get(a.handle) == null);
+    try std.testing.expectEqual(@as(u64, 200), map.get(b.handle).?.*);
+
+    // Fill past the first page and check every key still resolves.
+    var key: u64 = 100;
+    while (key < 400) : (key += 1) _ = try map.get_or_insert(key, key, 0, false);
+    key = 100;
+    while (key < 400) : (key += 1) try std.testing.expectEqual(key, map.get(map.find(key).?).?.*);
+    try std.testing.expectError(error.OutOfSlots, map.get_or_insert(5000, 0, 0, false));
+}
+
+test "slot map lookups stay consistent while a writer churns entries" {
+    const Map = SlotMap(u64);
+    var map = try Map.init(std.testing.allocator, 1024);
+    defer map.deinit();
+
+    const KEY_SPACE: u64 = 512;
+    var stop = std.atomic.Value(bool).init(false);
+    var mismatches = std.atomic.Value(u32).init(0);
+
+    const Reader = struct {
+        fn run(m: *Map, done: *std.atomic.Value(bool), bad: *std.atomic.Value(u32)) void {
+            var key: u64 = 1;
+            while (!done.load(.acquire)) {
+                if (m.find(key)) |handle| {
+                    if (m.acquire(handle)) {
+                        if (m.get(handle)) |value| {
+                            if (value.* != key) _ = bad.fetchAdd(1, .monotonic);
+                        }
+                        _ = m.release(handle);
+                    }
+                }
+                key = key % KEY_SPACE + 1;
+            }
+        }
+    };
+
+    var readers: [3]std.Thread = undefined;
+    for (&readers) |*t| t.* = try std.Thread.spawn(.{}, Reader.run, .{ &map, &stop, &mismatches });
+
+    var round: u64 = 0;
+    while (round < 20000) : (round += 1) {
+        const key = round % KEY_SPACE + 1;
+        if (map.find(key)) |handle| {
+            _ = map.remove(handle, false);
+        } else {
+            _ = try map.get_or_insert(key, key, 16, false);
+        }
+    }
+    stop.store(true, .release);
+    for (readers) |t| t.join();
+
+    try std.testing.expectEqual(@as(u32, 0), mismatches.load(.monotonic));
+}
+
+test "slot map reclaims index tombstones under key churn" {
+    const Map = SlotMap(u64);
+    var map = try Map.init(std.testing.allocator, 256);
+    defer map.deinit();
+
+    // A few long-lived keys, then many short-lived distinct ones.
+    var key: u64 = 1;
+    while (key <= 64) : (key += 1) _ = try map.get_or_insert(key, key, 0, false);
+    const table_size = map.index_mask + 1;
+    while (key < 64 + 20 * table_size) : (key += 1) {
+        const entry = try map.get_or_insert(key, key, 0, false);
+        try std.testing.expect(map.remove(entry.handle, false) != null);
+        try std.testing.expect(map.tombstones < table_size / 4);
+    }
+
+    // Misses still end at an empty cell, and the long-lived keys survived every rebuild.
+    var empty: usize = 0;
+    for (map.tables[map.active_table.load(.monotonic)].keys) |*k| {
+        if (k.load(.monotonic) == Map.EMPTY_KEY) empty += 1;
+    }
+    try std.testing.expect(empty >= table_size / 2);
+    try std.testing.expect(map.find(key + 1) == null);
+    key = 1;
+    while (key <= 64) : (key += 1) try std.testing.expectEqual(key, map.get(map.find(key).?).?.*);
+}
@@ -7,6 +7,7 @@
 const std = @import("std");
 const scene = @import("scene.zig");
 const texture_loader = @import("texture_loader.zig");
+const texture_types = @import("texture_types.zig");
 const material_loader = @import("material_loader.zig");
 const ref_counting = @import("../core/ref_counting.zig");
 const resource_state = @import("../core/resource_state.zig");
@@ -1046,6 +1047,16 @@ fn contains_ignore_case(haystack: []const u8, needle: []const u8) bool {
 }
 
 pub export fn cardinal_gltf_load_scene(path: [*:0]const u8, out_scene: *scene.CardinalScene) callconv(.c) bool {
+    return load_scene(path, null, out_scene);
+}
+
+/// Loads a glTF/GLB scene whose file contents were already read into `data`. `path` still locates
+/// external buffers and images; a GLB's binary chunk is used in place.
+pub export fn cardinal_gltf_load_scene_from_memory(path: [*:0]const u8, data: [*]const u8, size: usize, out_scene: *scene.CardinalScene) callconv(.c) bool {
+    return load_scene(path, data[0..size], out_scene);
+}
+
+fn load_scene(path: [*:0]const u8, file_data: ?[]const u8, out_scene: *scene.CardinalScene) bool {
     if (path[0] == 0) {
         gltf_log.err("Empty path passed to GLTF loader", .{});
         return false;
@@ -1068,7 +1079,10 @@ pub export fn cardinal_gltf_load_scene(path: [*:0]const u8, out_scene: *scene.Ca
     var data: ?*c.cgltf_data = null;
 
     gltf_log.debug("Calling cgltf_parse_file...", .{});
-    const result = c.cgltf_parse_file(&options, local_path, &data);
+    const result = if (file_data) |bytes|
+        c.cgltf_parse(&options, bytes.ptr, bytes.len, &data)
+    else
+        c.cgltf_parse_file(&options, local_path, &data);
     if (result != c.cgltf_result_success) {
         gltf_log.err("cgltf_parse_file failed: {d}", .{result});
         return false;
@@ -1250,11 +1264,9 @@ pub export fn cardinal_gltf_load_scene(path: [*:0]const u8, out_scene: *scene.Ca
                     if (tex_idx < texture_count) {
                         card_mat.metallic_roughness_texture = .{ .index = tex_idx, .generation = 1 };
                         // Force UNORM format for metallic/roughness maps (data, not color)
-                        // Only override if it's currently SRGB (default) or Undefined, don't break HDR
+                        // Only swap sRGB variants (including block-compressed ones) to UNORM, don't break HDR
                         if (textures) |texs| {
-                            if (texs[tex_idx].format == c.VK_FORMAT_R8G8B8A8_SRGB or texs[tex_idx].format == 0) {
-                                texs[tex_idx].format = c.VK_FORMAT_R8G8B8A8_UNORM;
-                            }
+                            texs[tex_idx].format = if (texs[tex_idx].format == 0) @as(u32, c.VK_FORMAT_R8G8B8A8_UNORM) else texture_types.linear_format(texs[tex_idx].format);
                         }
                     }
                     card_mat.uv_indices[2] = @intCast(pbr.metallic_roughness_texture.texcoord);
@@ -1280,9 +1292,7 @@ pub export fn cardinal_gltf_load_scene(path: [*:0]const u8, out_scene: *scene.Ca
                     card_mat.normal_texture = .{ .index = tex_idx, .generation = 1 };
                     // Force UNORM format for normal maps (data, not color)
                     if (textures) |texs| {
-                        if (texs[tex_idx].format == c.VK_FORMAT_R8G8B8A8_SRGB or texs[tex_idx].format == 0) {
-                            texs[tex_idx].format = c.VK_FORMAT_R8G8B8A8_UNORM;
-                        }
+                        texs[tex_idx].format = if (texs[tex_idx].format == 0) @as(u32, c.VK_FORMAT_R8G8B8A8_UNORM) else texture_types.linear_format(texs[tex_idx].format);
                     }
                 }
                 card_mat.uv_indices[1] = @intCast(mat.normal_texture.texcoord);
@@ -1301,9 +1311,7 @@ pub export fn cardinal_gltf_load_scene(path: [*:0]const u8, out_scene: *scene.Ca
                     card_mat.ao_texture = .{ .index = tex_idx, .generation = 1 };
                     // Force UNORM format for occlusion maps (data, not color)
                     if (textures) |texs| {
-                        if (texs[tex_idx].format == c.VK_FORMAT_R8G8B8A8_SRGB or texs[tex_idx].format == 0) {
-                            texs[tex_idx].format = c.VK_FORMAT_R8G8B8A8_UNORM;
-                        }
+                        texs[tex_idx].format = if (texs[tex_idx].format == 0) @as(u32, c.VK_FORMAT_R8G8B8A8_UNORM) else texture_types.linear_format(texs[tex_idx].format);
                     }
                 }
                 card_mat.uv_indices[3] = @intCast(mat.occlusion_texture.texcoord);
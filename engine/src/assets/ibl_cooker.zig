@@ -0,0 +1,944 @@
+//! Offline image-based lighting precompute for HDR skyboxes.
+//!
+//! Turns an equirectangular RGBA32F environment into the inputs of split-sum IBL: the environment
+//! resampled to a cubemap (with a box-filtered mip chain), 9-coefficient spherical harmonics of
+//! the diffuse irradiance, a GGX-prefiltered specular cube whose mips run from mirror to fully
+//! rough, and the BRDF scale/bias LUT. Texel math is done on `@Vector(4, f32)` (one RGBA texel,
+//! or four LUT texels per vector), and every stage is split into per-face or per-row-band jobs on
+//! the job system, running inline when it is not up.
+//!
+//! Cooking takes seconds for large maps, so it never runs at load time: `zig build bake-ibl`
+//! writes results to a cache keyed by the source file's path and modification time, and the
+//! renderer only reads them back (`load_cached`).
+const std = @import("std");
+const log = @import("../core/log.zig");
+const job_system = @import("../core/job_system.zig");
+
+const ibl_log = log.ScopedLogger("IBL_COOK");
+
+/// Bump when cooked output changes so stale cache entries are not reused.
+pub const COOKER_VERSION: u32 = 1;
+
+pub const SH_COEFFICIENTS = 9;
+
+/// Cubemap faces in Vulkan layer order: +X, -X, +Y, -Y, +Z, -Z.
+pub const FACE_COUNT = 6;
+
+pub const Settings = struct {
+    /// Face size the equirect map is resampled to; the specular chain is filtered from it.
+    source_face_size: u32 = 256,
+    /// Face size of specular mip 0 (roughness 0).
+    specular_face_size: u32 = 128,
+    /// Specular mips; mip m is prefiltered for roughness m / (specular_mips - 1).
+    specular_mips: u32 = 6,
+    /// GGX samples per prefiltered texel.
+    specular_samples: u32 = 128,
+    /// BRDF LUT resolution (NdotV along x, roughness along y); a multiple of 4.
+    lut_size: u32 = 128,
+    lut_samples: u32 = 256,
+
+    fn validate(self: Settings) !void {
+        if (self.source_face_size == 0 or self.specular_face_size == 0) return error.InvalidSettings;
+        if (self.specular_mips == 0 or self.specular_mips > 13 or self.specular_face_size >> @intCast(self.specular_mips - 1) == 0) return error.InvalidSettings;
+        if (self.specular_samples == 0 or self.lut_samples == 0) return error.InvalidSettings;
+        if (self.lut_size == 0 or self.lut_size % 4 != 0) return error.InvalidSettings;
+    }
+};
+
+/// Cooked IBL data.
+///
+/// `sh` holds the cosine-convolved radiance divided by pi, so `eval_sh(sh, n)` is the radiance a
+/// white Lambertian surface facing `n` reflects. `specular` is RGBA16F, mips largest first with
+/// the six faces of a mip contiguous (the layout of one `vkCmdCopyBufferToImage` per mip with six
+/// layers). `lut` is RG16F (scale, bias), rows by roughness.
+pub const Cooked = struct {
+    allocator: std.mem.Allocator,
+    face_size: u32,
+    mip_count: u32,
+    lut_size: u32,
+    sh: [SH_COEFFICIENTS][4]f32,
+    specular: []f16,
+    lut: []f16,
+
+    pub fn deinit(self: *Cooked) void {
+        self.allocator.free(self.specular);
+        self.allocator.free(self.lut);
+        self.* = undefined;
+    }
+
+    /// Texels of specular `mip`, all six faces.
+    pub fn specular_level(self: *const Cooked, mip: u32) []const f16 {
+        const offset = specular_offset(self.face_size, mip);
+        return self.specular[offset..specular_offset(self.face_size, mip + 1)];
+    }
+};
+
+/// Offset in f16 elements of specular `mip` in a chain whose mip 0 is `face_size`.
+fn specular_offset(face_size: u32, mip: u32) usize {
+    var offset: usize = 0;
+    for (0..mip) |m| {
+        const size: usize = @max(face_size >> @intCast(m), 1);
+        offset += FACE_COUNT * size * size * 4;
+    }
+    return offset;
+}
+
+/// Cooks `width` x `height` RGBA32F equirectangular `pixels` (row 0 at the top, as the skybox
+/// samples them).
+pub fn cook(allocator: std.mem.Allocator, pixels: []const f32, width: u32, height: u32, settings: Settings) !Cooked {
+    try settings.validate();
+    if (width == 0 or height == 0 or pixels.len < @as(usize, width) * height * 4) return error.InvalidImage;
+    const source = Equirect{ .pixels = pixels[0 .. @as(usize, width) * height * 4], .width = width, .height = height };
+
+    var chain = try CubeChain.from_equirect(allocator, source, settings.source_face_size);
+    defer chain.deinit(allocator);
+
+    var timer = std.time.Timer.start() catch null;
+    const sh = try project_sh(allocator, &chain);
+
+    const specular = try allocator.alloc(f16, specular_offset(settings.specular_face_size, settings.specular_mips));
+    errdefer allocator.free(specular);
+    try prefilter_specular(allocator, &chain, settings, specular);
+
+    const lut = try allocator.alloc(f16, @as(usize, settings.lut_size) * settings.lut_size * 2);
+    errdefer allocator.free(lut);
+    try build_brdf_lut(allocator, settings.lut_size, settings.lut_samples, lut);
+
+    if (timer) |*t| ibl_log.debug("Cooked {d}x{d} environment in {d:.1} ms", .{ width, height, @as(f64, @floatFromInt(t.read())) / 1e6 });
+    return .{
+        .allocator = allocator,
+        .face_size = settings.specular_face_size,
+        .mip_count = settings.specular_mips,
+        .lut_size = settings.lut_size,
+        .sh = sh,
+        .specular = specular,
+        .lut = lut,
+    };
+}
+
+// ---------------------------------------------------------------------------------------------
+// Vector helpers
+// ---------------------------------------------------------------------------------------------
+
+const Vec4 = @Vector(4, f32);
+
+inline fn splat(v: f32) Vec4 {
+    return @splat(v);
+}
+
+inline fn dot3(a: Vec4, b: Vec4) f32 {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+inline fn cross3(a: Vec4, b: Vec4) Vec4 {
+    return .{ a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0], 0.0 };
+}
+
+inline fn normalize3(v: Vec4) Vec4 {
+    return v / splat(@sqrt(dot3(v, v)));
+}
+
+// ---------------------------------------------------------------------------------------------
+// Equirect and cubemap sampling
+// ---------------------------------------------------------------------------------------------
+
+const Equirect = struct {
+    /// RGBA32F, only f32-aligned.
+    pixels: []const f32,
+    width: u32,
+    height: u32,
+
+    inline fn texel(self: Equirect, x: usize, y: usize) Vec4 {
+        return self.pixels[(y * self.width + x) * 4 ..][0..4].*;
+    }
+
+    /// Bilinear lookup in the skybox shader's mapping: u from atan(z, x), v from asin(y) with
+    /// +Y at the top row; wraps horizontally and clamps at the poles.
+    fn sample(self: Equirect, dir: Vec4) Vec4 {
+        const u = std.math.atan2(dir[2], dir[0]) / std.math.tau + 0.5;
+        const v = 0.5 - std.math.asin(std.math.clamp(dir[1], -1.0, 1.0)) / std.math.pi;
+        const x = u * @as(f32, @floatFromInt(self.width)) - 0.5;
+        const y = std.math.clamp(v * @as(f32, @floatFromInt(self.height)) - 0.5, 0.0, @as(f32, @floatFromInt(self.height - 1)));
+
+        const x_floor = @floor(x);
+        const y_floor = @floor(y);
+        const fx = x - x_floor;
+        const fy = y - y_floor;
+        const w: i64 = self.width;
+        const x0: usize = @intCast(@mod(@as(i64, @intFromFloat(x_floor)), w));
+        const x1: usize = @intCast(@mod(@as(i64, @intFromFloat(x_floor)) + 1, w));
+        const y0: usize = @intFromFloat(y_floor);
+        const y1: usize = @min(y0 + 1, self.height - 1);
+
+        const top = self.texel(x0, y0) + (self.texel(x1, y0) - self.texel(x0, y0)) * splat(fx);
+        const bottom = self.texel(x0, y1) + (self.texel(x1, y1) - self.texel(x0, y1)) * splat(fx);
+        return top + (bottom - top) * splat(fy);
+    }
+};
+
+/// Direction through face coordinates `u`, `v` in [-1, 1] (v down), unnormalized.
+pub fn face_direction(face: usize, u: f32, v: f32) [3]f32 {
+    return switch (face) {
+        0 => .{ 1.0, -v, -u },
+        1 => .{ -1.0, -v, u },
+        2 => .{ u, 1.0, v },
+        3 => .{ u, -1.0, -v },
+        4 => .{ u, -v, 1.0 },
+        else => .{ -u, -v, -1.0 },
+    };
+}
+
+inline fn texel_direction(face: usize, size: u32, x: usize, y: usize) Vec4 {
+    const inv = 2.0 / @as(f32, @floatFromInt(size));
+    const d = face_direction(face, (@as(f32, @floatFromInt(x)) + 0.5) * inv - 1.0, (@as(f32, @floatFromInt(y)) + 0.5) * inv - 1.0);
+    return normalize3(.{ d[0], d[1], d[2], 0.0 });
+}
+
+const FaceCoord = struct { face: usize, u: f32, v: f32 };
+
+/// Inverse of `face_direction`.
+fn direction_face(dir: Vec4) FaceCoord {
+    const a = @abs(dir);
+    if (a[0] >= a[1] and a[0] >= a[2]) {
+        return if (dir[0] > 0) .{ .face = 0, .u = -dir[2] / a[0], .v = -dir[1] / a[0] } else .{ .face = 1, .u = dir[2] / a[0], .v = -dir[1] / a[0] };
+    }
+    if (a[1] >= a[2]) {
+        return if (dir[1] > 0) .{ .face = 2, .u = dir[0] / a[1], .v = dir[2] / a[1] } else .{ .face = 3, .u = dir[0] / a[1], .v = -dir[2] / a[1] };
+    }
+    return if (dir[2] > 0) .{ .face = 4, .u = dir[0] / a[2], .v = -dir[1] / a[2] } else .{ .face = 5, .u = -dir[0] / a[2], .v = -dir[1] / a[2] };
+}
+
+/// Solid angle of a cube texel (Driscoll's formula on the unit cube face).
+fn texel_solid_angle(size: u32, x: usize, y: usize) f32 {
+    const inv = 1.0 / @as(f32, @floatFromInt(size));
+    const u = (2.0 * @as(f32, @floatFromInt(x)) + 1.0) * inv - 1.0;
+    const v = (2.0 * @as(f32, @floatFromInt(y)) + 1.0) * inv - 1.0;
+    const area = struct {
+        fn f(a: f32, b: f32) f32 {
+            return std.math.atan2(a * b, @sqrt(a * a + b * b + 1.0));
+        }
+    }.f;
+    return area(u - inv, v - inv) - area(u - inv, v + inv) - area(u + inv, v - inv) + area(u + inv, v + inv);
+}
+
+/// Cubemap with a full box-filtered mip chain; each level stores its six faces contiguously.
+const CubeChain = struct {
+    levels: [][]Vec4,
+    size: u32,
+
+    fn from_equirect(allocator: std.mem.Allocator, source: Equirect, size: u32) !CubeChain {
+        const level_count = std.math.log2_int(u32, size) + 1;
+        const levels = try allocator.alloc([]Vec4, level_count);
+        var built: usize = 0;
+        errdefer {
+            for (levels[0..built]) |level| allocator.free(level);
+            allocator.free(levels);
+        }
+
+        var face_size = size;
+        for (levels, 0..) |*level, l| {
+            level.* = try allocator.alloc(Vec4, FACE_COUNT * @as(usize, face_size) * face_size);
+            built += 1;
+            var tasks: [FACE_COUNT]ResampleTask = undefined;
+            for (&tasks, 0..) |*task, face| {
+                task.* = .{ .face = face, .size = face_size, .out = level.*, .source = source, .parent = if (l == 0) null else levels[l - 1] };
+            }
+            try run_tasks(ResampleTask, allocator, &tasks);
+            face_size = @max(face_size / 2, 1);
+        }
+        return .{ .levels = levels, .size = size };
+    }
+
+    fn deinit(self: *CubeChain, allocator: std.mem.Allocator) void {
+        for (self.levels) |level| allocator.free(level);
+        allocator.free(self.levels);
+        self.* = undefined;
+    }
+
+    fn level_size(self: *const CubeChain, level: usize) u32 {
+        return @max(self.size >> @intCast(level), 1);
+    }
+
+    /// Bilinear within one face, clamped at its edges.
+    fn sample_level(self: *const CubeChain, level: usize, coord: FaceCoord) Vec4 {
+        const size = self.level_size(level);
+        const size_f: f32 = @floatFromInt(size);
+        const face = self.levels[level][coord.face * size * size ..][0 .. size * size];
+        const x = std.math.clamp((coord.u + 1.0) * 0.5 * size_f - 0.5, 0.0, size_f - 1.0);
+        const y = std.math.clamp((coord.v + 1.0) * 0.5 * size_f - 0.5, 0.0, size_f - 1.0);
+        const x0: usize = @intFromFloat(x);
+        const y0: usize = @intFromFloat(y);
+        const x1 = @min(x0 + 1, size - 1);
+        const y1 = @min(y0 + 1, size - 1);
+        const fx = x - @as(f32, @floatFromInt(x0));
+        const fy = y - @as(f32, @floatFromInt(y0));
+        const top = face[y0 * size + x0] + (face[y0 * size + x1] - face[y0 * size + x0]) * splat(fx);
+        const bottom = face[y1 * size + x0] + (face[y1 * size + x1] - face[y1 * size + x0]) * splat(fx);
+        return top + (bottom - top) * splat(fy);
+    }
+
+    /// Trilinear lookup at fractional mip `lod`.
+    fn sample(self: *const CubeChain, dir: Vec4, lod: f32) Vec4 {
+        const coord = direction_face(dir);
+        const max_lod: f32 = @floatFromInt(self.levels.len - 1);
+        const l = std.math.clamp(lod, 0.0, max_lod);
+        const l0: usize = @intFromFloat(l);
+        const frac = l - @as(f32, @floatFromInt(l0));
+        const a = self.sample_level(l0, coord);
+        if (frac == 0.0 or l0 + 1 >= self.levels.len) return a;
+        return a + (self.sample_level(l0 + 1, coord) - a) * splat(frac);
+    }
+};
+
+/// Fills one face of a chain level: level 0 from the equirect map, lower levels by 2x2 box
+/// filtering the level above.
+const ResampleTask = struct {
+    face: usize,
+    size: u32,
+    out: []Vec4,
+    source: Equirect,
+    parent: ?[]const Vec4,
+
+    fn run(self: *const ResampleTask) void {
+        const size: usize = self.size;
+        const out = self.out[self.face * size * size ..][0 .. size * size];
+        if (self.parent) |parent| {
+            const parent_size = size * 2;
+            const src = parent[self.face * parent_size * parent_size ..][0 .. parent_size * parent_size];
+            for (0..size) |y| {
+                const row0 = src[y * 2 * parent_size ..][0..parent_size];
+                const row1 = src[(y * 2 + 1) * parent_size ..][0..parent_size];
+                for (0..size) |x| {
+                    out[y * size + x] = (row0[x * 2] + row0[x * 2 + 1] + row1[x * 2] + row1[x * 2 + 1]) * splat(0.25);
+                }
+            }
+            return;
+        }
+        for (0..size) |y| {
+            for (0..size) |x| out[y * size + x] = self.source.sample(texel_direction(self.face, self.size, x, y));
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------------------------
+// Spherical harmonics
+// ---------------------------------------------------------------------------------------------
+
+/// Real SH basis up to band 2, in the usual (l, m) order.
+pub fn sh_basis(dir: [3]f32) [SH_COEFFICIENTS]f32 {
+    const x = dir[0];
+    const y = dir[1];
+    const z = dir[2];
+    return .{
+        0.282095,
+        0.488603 * y,
+        0.488603 * z,
+        0.488603 * x,
+        1.092548 * x * y,
+        1.092548 * y * z,
+        0.315392 * (3.0 * z * z - 1.0),
+        1.092548 * x * z,
+        0.546274 * (x * x - y * y),
+    };
+}
+
+/// Evaluates cooked SH (RGB in xyz) in direction `dir`; pbr.frag mirrors this.
+pub fn eval_sh(sh: *const [SH_COEFFICIENTS][4]f32, dir: [3]f32) [3]f32 {
+    const basis = sh_basis(dir);
+    var sum = splat(0.0);
+    for (sh, basis) |coefficient, b| sum += @as(Vec4, coefficient) * splat(b);
+    return .{ sum[0], sum[1], sum[2] };
+}
+
+/// Projects one face of a cube level onto the SH basis, weighting texels by solid angle.
+const ShTask = struct {
+    face: usize,
+    size: u32,
+    texels: []const Vec4,
+    sum: [SH_COEFFICIENTS]Vec4 = [_]Vec4{splat(0.0)} ** SH_COEFFICIENTS,
+
+    fn run(self: *ShTask) void {
+        const size: usize = self.size;
+        const face = self.texels[self.face * size * size ..][0 .. size * size];
+        for (0..size) |y| {
+            for (0..size) |x| {
+                const dir = texel_direction(self.face, self.size, x, y);
+                const basis = sh_basis(.{ dir[0], dir[1], dir[2] });
+                const radiance = face[y * size + x] * splat(texel_solid_angle(self.size, x, y));
+                inline for (0..SH_COEFFICIENTS) |i| self.sum[i] += radiance * splat(basis[i]);
+            }
+        }
+    }
+};
+
+/// Level of the chain SH is projected from; irradiance is band-limited, so 64^2 faces suffice.
+const SH_MAX_FACE_SIZE: u32 = 64;
+
+fn project_sh(allocator: std.mem.Allocator, chain: *const CubeChain) ![SH_COEFFICIENTS][4]f32 {
+    var level: usize = 0;
+    while (chain.level_size(level) > SH_MAX_FACE_SIZE and level + 1 < chain.levels.len) level += 1;
+
+    var tasks: [FACE_COUNT]ShTask = undefined;
+    for (&tasks, 0..) |*task, face| task.* = .{ .face = face, .size = chain.level_size(level), .texels = chain.levels[level] };
+    try run_tasks(ShTask, allocator, &tasks);
+
+    // Convolve with the clamped cosine lobe (pi, 2pi/3, pi/4 per band) and divide by pi.
+    const band_scale = [SH_COEFFICIENTS]f32{ 1.0, 2.0 / 3.0, 2.0 / 3.0, 2.0 / 3.0, 0.25, 0.25, 0.25, 0.25, 0.25 };
+    var sh: [SH_COEFFICIENTS][4]f32 = undefined;
+    for (&sh, 0..) |*coefficient, i| {
+        var sum = splat(0.0);
+        for (tasks) |task| sum += task.sum[i];
+        sum *= splat(band_scale[i]);
+        sum[3] = 0.0;
+        coefficient.* = sum;
+    }
+    return sh;
+}
+
+// ---------------------------------------------------------------------------------------------
+// GGX prefiltering
+// ---------------------------------------------------------------------------------------------
+
+fn radical_inverse(i: u32) f32 {
+    return @as(f32, @floatFromInt(@bitReverse(i))) * 2.3283064365386963e-10;
+}
+
+/// GGX half vector around +Z for the Hammersley point (`i` of `n`), `a` = roughness^2.
+fn ggx_half_vector(i: u32, n: u32, a: f32) Vec4 {
+    const xi0 = @as(f32, @floatFromInt(i)) / @as(f32, @floatFromInt(n));
+    const xi1 = radical_inverse(i);
+    const phi = std.math.tau * xi0;
+    const cos_theta = @sqrt((1.0 - xi1) / (1.0 + (a * a - 1.0) * xi1));
+    const sin_theta = @sqrt(@max(1.0 - cos_theta * cos_theta, 0.0));
+    return .{ sin_theta * @cos(phi), sin_theta * @sin(phi), cos_theta, 0.0 };
+}
+
+/// A light direction in tangent space (N = V = +Z) with its weight and source mip.
+const SpecularSample = struct {
+    l: Vec4,
+    n_dot_l: f32,
+    lod: f32,
+};
+
+/// Importance samples for one roughness. With N = V the sample set is the same for every texel up
+/// to rotation, so lods (filtered importance sampling: the source mip whose texel covers the
+/// sample's solid angle) are computed once.
+fn specular_samples(allocator: std.mem.Allocator, roughness: f32, count: u32, source_size: u32, min_lod: f32) ![]SpecularSample {
+    const a = roughness * roughness;
+    const texel_solid = 4.0 * std.math.pi / (FACE_COUNT * @as(f32, @floatFromInt(source_size)) * @as(f32, @floatFromInt(source_size)));
+    var samples = std.ArrayListUnmanaged(SpecularSample){};
+    errdefer samples.deinit(allocator);
+    try samples.ensureTotalCapacity(allocator, count);
+    for (0..count) |i| {
+        const h = ggx_half_vector(@intCast(i), count, a);
+        const n_dot_h = h[2];
+        const l = Vec4{ 2.0 * n_dot_h * h[0], 2.0 * n_dot_h * h[1], 2.0 * n_dot_h * n_dot_h - 1.0, 0.0 };
+        if (l[2] <= 0.0) continue;
+
+        // pdf = D * NdotH / (4 * VdotH), and VdotH = NdotH here.
+        const a2 = a * a;
+        const denom = n_dot_h * n_dot_h * (a2 - 1.0) + 1.0;
+        const d = a2 / (std.math.pi * denom * denom);
+        const sample_solid = 4.0 / (@as(f32, @floatFromInt(count)) * @max(d, 1e-6));
+        const lod = @max(0.5 * std.math.log2(sample_solid / texel_solid) + 1.0, min_lod);
+        samples.appendAssumeCapacity(.{ .l = l, .n_dot_l = l[2], .lod = lod });
+    }
+    return samples.toOwnedSlice(allocator);
+}
+
+const PrefilterTask = struct {
+    chain: *const CubeChain,
+    samples: []const SpecularSample,
+    face: usize,
+    size: u32,
+    /// Lod matching the output texel footprint; roughness 0 reads the chain there directly.
+    base_lod: f32,
+    mirror: bool,
+    out: []f16,
+
+    fn run(self: *const PrefilterTask) void {
+        const size: usize = self.size;
+        const out = self.out[self.face * size * size * 4 ..][0 .. size * size * 4];
+        for (0..size) |y| {
+            for (0..size) |x| {
+                const n = texel_direction(self.face, self.size, x, y);
+                var color: Vec4 = undefined;
+                if (self.mirror) {
+                    color = self.chain.sample(n, self.base_lod);
+                } else {
+                    const up: Vec4 = if (@abs(n[2]) < 0.999) .{ 0.0, 0.0, 1.0, 0.0 } else .{ 1.0, 0.0, 0.0, 0.0 };
+                    const t = normalize3(cross3(up, n));
+                    const b = cross3(n, t);
+                    var sum = splat(0.0);
+                    var weight: f32 = 0.0;
+                    for (self.samples) |s| {
+                        const l = t * splat(s.l[0]) + b * splat(s.l[1]) + n * splat(s.l[2]);
+                        sum += self.chain.sample(l, s.lod) * splat(s.n_dot_l);
+                        weight += s.n_dot_l;
+                    }
+                    color = if (weight > 0.0) sum / splat(weight) else self.chain.sample(n, self.base_lod);
+                }
+                const dst = out[(y * size + x) * 4 ..][0..4];
+                inline for (0..3) |ch| dst[ch] = @floatCast(@min(color[ch], std.math.floatMax(f16)));
+                dst[3] = 1.0;
+            }
+        }
+    }
+};
+
+fn prefilter_specular(allocator: std.mem.Allocator, chain: *const CubeChain, settings: Settings, out: []f16) !void {
+    var tasks: [FACE_COUNT]PrefilterTask = undefined;
+    for (0..settings.specular_mips) |m| {
+        const size = @max(settings.specular_face_size >> @intCast(m), 1);
+        const roughness = if (settings.specular_mips > 1) @as(f32, @floatFromInt(m)) / @as(f32, @floatFromInt(settings.specular_mips - 1)) else 0.0;
+        const base_lod = @max(std.math.log2(@as(f32, @floatFromInt(chain.size)) / @as(f32, @floatFromInt(size))), 0.0);
+        const samples = try specular_samples(allocator, roughness, settings.specular_samples, chain.size, base_lod);
+        defer allocator.free(samples);
+
+        const level = out[specular_offset(settings.specular_face_size, @intCast(m))..specular_offset(settings.specular_face_size, @intCast(m + 1))];
+        for (&tasks, 0..) |*task, face| {
+            task.* = .{ .chain = chain, .samples = samples, .face = face, .size = size, .base_lod = base_lod, .mirror = m == 0, .out = level };
+        }
+        try run_tasks(PrefilterTask, allocator, &tasks);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// BRDF LUT
+// ---------------------------------------------------------------------------------------------
+
+const Lanes = @Vector(4, f32);
+
+/// Split-sum scale and bias for four NdotV values at one roughness (F0 multiplies the first,
+/// the second is added), with Smith-Schlick visibility at k = roughness^2 / 2.
+fn integrate_brdf_lanes(n_dot_v: Lanes, roughness: f32, samples: u32) [2]Lanes {
+    const a = roughness * roughness;
+    const k: Lanes = @splat(a * 0.5);
+    const zero: Lanes = @splat(0.0);
+    const one: Lanes = @splat(1.0);
+    const v_x = @sqrt(one - n_dot_v * n_dot_v);
+
+    var scale = zero;
+    var bias = zero;
+    for (0..samples) |i| {
+        const h = ggx_half_vector(@intCast(i), samples, a);
+        const v_dot_h = v_x * @as(Lanes, @splat(h[0])) + n_dot_v * @as(Lanes, @splat(h[2]));
+        const n_dot_l = v_dot_h * @as(Lanes, @splat(2.0 * h[2])) - n_dot_v;
+        const valid = n_dot_l > zero;
+
+        const g_v = n_dot_v / (n_dot_v * (one - k) + k);
+        const g_l = n_dot_l / (n_dot_l * (one - k) + k);
+        const g_vis = g_v * g_l * @max(v_dot_h, zero) / (@as(Lanes, @splat(@max(h[2], 1e-6))) * n_dot_v);
+        const t = one - @max(v_dot_h, zero);
+        const t2 = t * t;
+        const fc = t2 * t2 * t;
+        scale += @select(f32, valid, (one - fc) * g_vis, zero);
+        bias += @select(f32, valid, fc * g_vis, zero);
+    }
+    const inv: Lanes = @splat(1.0 / @as(f32, @floatFromInt(samples)));
+    return .{ scale * inv, bias * inv };
+}
+
+/// Split-sum scale and bias for one NdotV and roughness.
+pub fn integrate_brdf(n_dot_v: f32, roughness: f32, samples: u32) [2]f32 {
+    const r = integrate_brdf_lanes(@splat(@max(n_dot_v, 1e-4)), roughness, samples);
+    return .{ r[0][0], r[1][0] };
+}
+
+const LutTask = struct {
+    size: u32,
+    samples: u32,
+    row: u32,
+    out: []f16,
+
+    fn run(self: *const LutTask) void {
+        const size_f: f32 = @floatFromInt(self.size);
+        const roughness = (@as(f32, @floatFromInt(self.row)) + 0.5) / size_f;
+        const row = self.out[@as(usize, self.row) * self.size * 2 ..][0 .. @as(usize, self.size) * 2];
+        var x: u32 = 0;
+        while (x < self.size) : (x += 4) {
+            const xs = Lanes{ 0.5, 1.5, 2.5, 3.5 } + @as(Lanes, @splat(@floatFromInt(x)));
+            const r = integrate_brdf_lanes(xs / @as(Lanes, @splat(size_f)), roughness, self.samples);
+            inline for (0..4) |lane| {
+                row[(x + lane) * 2] = @floatCast(r[0][lane]);
+                row[(x + lane) * 2 + 1] = @floatCast(r[1][lane]);
+            }
+        }
+    }
+};
+
+fn build_brdf_lut(allocator: std.mem.Allocator, size: u32, samples: u32, out: []f16) !void {
+    const tasks = try allocator.alloc(LutTask, size);
+    defer allocator.free(tasks);
+    for (tasks, 0..) |*task, row| task.* = .{ .size = size, .samples = samples, .row = @intCast(row), .out = out };
+    try run_tasks(LutTask, allocator, tasks);
+}
+
+// ---------------------------------------------------------------------------------------------
+// Jobs
+// ---------------------------------------------------------------------------------------------
+
+fn task_job(comptime Task: type) job_system.JobFunc {
+    return struct {
+        fn run(data: ?*anyopaque) callconv(.c) i32 {
+            const task: *Task = @ptrCast(@alignCast(data.?));
+            task.run();
+            return 0;
+        }
+    }.run;
+}
+
+/// Runs every task on the job system when it is up, inline otherwise.
+fn run_tasks(comptime Task: type, allocator: std.mem.Allocator, tasks: []Task) !void {
+    var jobs = std.ArrayListUnmanaged(*job_system.Job){};
+    defer jobs.deinit(allocator);
+    try jobs.ensureTotalCapacity(allocator, tasks.len);
+
+    for (tasks) |*task| {
+        const job = job_system.create_job(task_job(Task), task, .NORMAL) orelse {
+            task.run();
+            continue;
+        };
+        job.push_to_completed_queue = false;
+        while (!job_system.submit_job(job)) {
+            std.Thread.yield() catch {};
+        }
+        jobs.appendAssumeCapacity(job);
+    }
+
+    job_system.wait_for_jobs(jobs.items);
+    for (jobs.items) |job| job_system.free_job(job);
+}
+
+// ---------------------------------------------------------------------------------------------
+// Cache file
+// ---------------------------------------------------------------------------------------------
+
+const FILE_MAGIC = [4]u8{ 'C', 'I', 'B', 'L' };
+
+/// Followed by the specular chain, then the LUT, both tightly packed f16.
+const FileHeader = extern struct {
+    magic: [4]u8,
+    version: u32,
+    face_size: u32,
+    mip_count: u32,
+    lut_size: u32,
+    reserved: u32 = 0,
+    sh: [SH_COEFFICIENTS][4]f32,
+};
+
+fn payload_sizes(header: *const FileHeader) ?[2]usize {
+    if (header.face_size == 0 or header.face_size > 4096 or header.mip_count == 0 or header.mip_count > 13) return null;
+    if (header.lut_size == 0 or header.lut_size > 1024) return null;
+    return .{ specular_offset(header.face_size, header.mip_count) * @sizeOf(f16), @as(usize, header.lut_size) * header.lut_size * 2 * @sizeOf(f16) };
+}
+
+/// Serializes `cooked` as a cache file.
+pub fn write_file(allocator: std.mem.Allocator, cooked: *const Cooked) ![]u8 {
+    const header = FileHeader{
+        .magic = FILE_MAGIC,
+        .version = COOKER_VERSION,
+        .face_size = cooked.face_size,
+        .mip_count = cooked.mip_count,
+        .lut_size = cooked.lut_size,
+        .sh = cooked.sh,
+    };
+    const specular = std.mem.sliceAsBytes(cooked.specular);
+    const lut = std.mem.sliceAsBytes(cooked.lut);
+    const buf = try allocator.alloc(u8, @sizeOf(FileHeader) + specular.len + lut.len);
+    @memcpy(buf[0..@sizeOf(FileHeader)], std.mem.asBytes(&header));
+    @memcpy(buf[@sizeOf(FileHeader)..][0..specular.len], specular);
+    @memcpy(buf[@sizeOf(FileHeader) + specular.len ..], lut);
+    return buf;
+}
+
+fn read_header(bytes: []const u8) ?FileHeader {
+    if (bytes.len < @sizeOf(FileHeader)) return null;
+    var header: FileHeader = undefined;
+    @memcpy(std.mem.asBytes(&header), bytes[0..@sizeOf(FileHeader)]);
+    if (!std.mem.eql(u8, &header.magic, &FILE_MAGIC) or header.version != COOKER_VERSION) return null;
+    return header;
+}
+
+/// Parses a cache file written by `write_file`.
+pub fn read_file(allocator: std.mem.Allocator, bytes: []const u8) !Cooked {
+    const header = read_header(bytes) orelse return error.InvalidIblFile;
+    const sizes = payload_sizes(&header) orelse return error.InvalidIblFile;
+    if (bytes.len != @sizeOf(FileHeader) + sizes[0] + sizes[1]) return error.InvalidIblFile;
+
+    const specular = try allocator.alloc(f16, sizes[0] / @sizeOf(f16));
+    errdefer allocator.free(specular);
+    const lut = try allocator.alloc(f16, sizes[1] / @sizeOf(f16));
+    @memcpy(std.mem.sliceAsBytes(specular), bytes[@sizeOf(FileHeader)..][0..sizes[0]]);
+    @memcpy(std.mem.sliceAsBytes(lut), bytes[@sizeOf(FileHeader) + sizes[0] ..]);
+    return .{
+        .allocator = allocator,
+        .face_size = header.face_size,
+        .mip_count = header.mip_count,
+        .lut_size = header.lut_size,
+        .sh = header.sh,
+        .specular = specular,
+        .lut = lut,
+    };
+}
+
+// ---------------------------------------------------------------------------------------------
+// Cache
+// ---------------------------------------------------------------------------------------------
+
+var g_cache_allocator: std.mem.Allocator = undefined;
+var g_cache_dir: ?[]u8 = null;
+
+/// Enables cache lookups under `cache_dir`. Call before skyboxes start loading; the directory is
+/// not guarded against concurrent reconfiguration.
+pub fn configure(allocator: std.mem.Allocator, cache_dir: []const u8) !void {
+    shutdown();
+    try std.fs.cwd().makePath(cache_dir);
+    g_cache_dir = try allocator.dupe(u8, cache_dir);
+    g_cache_allocator = allocator;
+}
+
+pub fn shutdown() void {
+    if (g_cache_dir) |dir| g_cache_allocator.free(dir);
+    g_cache_dir = null;
+}
+
+pub fn is_enabled() bool {
+    return g_cache_dir != null;
+}
+
+/// Cache key for a skybox file: its absolute host path and modification time, so a lookup costs
+/// a stat rather than hashing the decoded texels. Editing or moving the file needs a re-bake.
+pub fn source_key(path: []const u8, mtime_ns: u64) u64 {
+    var hasher = std.hash.Wyhash.init(COOKER_VERSION);
+    hasher.update(path);
+    hasher.update(std.mem.asBytes(&mtime_ns));
+    return hasher.final();
+}
+
+/// `source_key` of the host file at `path`, resolved to an absolute path so the bake tool and
+/// the engine agree whatever their working directories.
+pub fn file_key(path: []const u8) !u64 {
+    var path_buf: [std.fs.max_path_bytes]u8 = undefined;
+    const real = try std.fs.cwd().realpath(path, &path_buf);
+    const stat = try std.fs.cwd().statFile(real);
+    return source_key(real, @intCast(@max(stat.mtime, 0)));
+}
+
+/// File name of the cache entry for `key`.
+pub fn cache_name(buf: *[32]u8, key: u64) []const u8 {
+    return std.fmt.bufPrint(buf, "{x:0>16}.cibl", .{key}) catch unreachable;
+}
+
+/// Writes `cooked` to `cache_dir` under `key`; used by the bake tool.
+pub fn store(allocator: std.mem.Allocator, cache_dir: []const u8, key: u64, cooked: *const Cooked) !void {
+    const bytes = try write_file(allocator, cooked);
+    defer allocator.free(bytes);
+
+    var dir = try std.fs.cwd().makeOpenPath(cache_dir, .{});
+    defer dir.close();
+    var name_buf: [32]u8 = undefined;
+    const name = cache_name(&name_buf, key);
+    var tmp_buf: [64]u8 = undefined;
+    const tmp_name = try std.fmt.bufPrint(&tmp_buf, "{s}.{x}.tmp", .{ name, std.crypto.random.int(u32) });
+    try dir.writeFile(.{ .sub_path = tmp_name, .data = bytes });
+    errdefer dir.deleteFile(tmp_name) catch {};
+    try dir.rename(tmp_name, name);
+}
+
+/// Reads the whole cache entry for `key` from the configured directory.
+pub fn load_cached(allocator: std.mem.Allocator, key: u64) ?Cooked {
+    const cache_dir = g_cache_dir orelse return null;
+    var dir = std.fs.cwd().openDir(cache_dir, .{}) catch return null;
+    defer dir.close();
+    var name_buf: [32]u8 = undefined;
+    const bytes = dir.readFileAlloc(allocator, cache_name(&name_buf, key), 1 << 30) catch return null;
+    defer allocator.free(bytes);
+    return read_file(allocator, bytes) catch |err| {
+        ibl_log.warn("Discarding unreadable IBL cache entry {x:0>16}: {s}", .{ key, @errorName(err) });
+        return null;
+    };
+}
+
+/// Reads only the irradiance SH of the cache entry for `key`.
+pub fn load_cached_sh(key: u64) ?[SH_COEFFICIENTS][4]f32 {
+    const cache_dir = g_cache_dir orelse return null;
+    var dir = std.fs.cwd().openDir(cache_dir, .{}) catch return null;
+    defer dir.close();
+    var name_buf: [32]u8 = undefined;
+    const file = dir.openFile(cache_name(&name_buf, key), .{}) catch return null;
+    defer file.close();
+
+    var bytes: [@sizeOf(FileHeader)]u8 = undefined;
+    const read = file.preadAll(&bytes, 0) catch return null;
+    if (read != bytes.len) return null;
+    const header = read_header(&bytes) orelse return null;
+    return header.sh;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------------------------
+
+/// Equirect map of `1 + y` (a sky twice as bright overhead as at the horizon, dark below).
+fn make_gradient_sky(allocator: std.mem.Allocator, width: u32, height: u32) ![]f32 {
+    const pixels = try allocator.alloc(f32, @as(usize, width) * height * 4);
+    for (0..height) |y| {
+        const v = (@as(f32, @floatFromInt(y)) + 0.5) / @as(f32, @floatFromInt(height));
+        const up = @sin((0.5 - v) * std.math.pi);
+        for (0..width) |x| pixels[(y * width + x) * 4 ..][0..4].* = .{ 1.0 + up, 1.0 + up, 1.0 + up, 1.0 };
+    }
+    return pixels;
+}
+
+const test_settings = Settings{
+    .source_face_size = 32,
+    .specular_face_size = 16,
+    .specular_mips = 4,
+    .specular_samples = 64,
+    .lut_size = 16,
+    .lut_samples = 128,
+};
+
+test "ibl cooker SH irradiance matches analytic references" {
+    const allocator = std.testing.allocator;
+    const width = 128;
+    const height = 64;
+
+    // Constant radiance L: irradiance / pi is L in every direction.
+    const flat = try allocator.alloc(f32, width * height * 4);
+    defer allocator.free(flat);
+    for (0..width * height) |i| flat[i * 4 ..][0..4].* = .{ 0.5, 1.0, 2.0, 1.0 };
+    var cooked_flat = try cook(allocator, flat, width, height, test_settings);
+    defer cooked_flat.deinit();
+    for ([_][3]f32{ .{ 1, 0, 0 }, .{ 0, -1, 0 }, .{ 0, 0.6, 0.8 } }) |n| {
+        const e = eval_sh(&cooked_flat.sh, n);
+        try std.testing.expectApproxEqAbs(@as(f32, 0.5), e[0], 5e-3);
+        try std.testing.expectApproxEqAbs(@as(f32, 1.0), e[1], 5e-3);
+        try std.testing.expectApproxEqAbs(@as(f32, 2.0), e[2], 5e-3);
+    }
+
+    // L = 1 + y lies in bands 0 and 1, so E(n) / pi = 1 + 2/3 n.y exactly.
+    const sky = try make_gradient_sky(allocator, width, height);
+    defer allocator.free(sky);
+    var cooked_sky = try cook(allocator, sky, width, height, test_settings);
+    defer cooked_sky.deinit();
+    const cases = [_]struct { n: [3]f32, expected: f32 }{
+        .{ .n = .{ 0, 1, 0 }, .expected = 5.0 / 3.0 },
+        .{ .n = .{ 0, -1, 0 }, .expected = 1.0 / 3.0 },
+        .{ .n = .{ 1, 0, 0 }, .expected = 1.0 },
+        .{ .n = .{ 0, 0.6, -0.8 }, .expected = 1.4 },
+    };
+    for (cases) |case| {
+        try std.testing.expectApproxEqAbs(case.expected, eval_sh(&cooked_sky.sh, case.n)[0], 2e-2);
+    }
+    // Band 2 carries nothing for a linear gradient.
+    for (cooked_sky.sh[4..]) |coefficient| try std.testing.expect(@abs(coefficient[0]) < 1e-2);
+}
+
+test "ibl cooker prefiltered specular preserves flat environments and follows gradients" {
+    const allocator = std.testing.allocator;
+    const width = 128;
+    const height = 64;
+
+    const flat = try allocator.alloc(f32, width * height * 4);
+    defer allocator.free(flat);
+    for (0..width * height) |i| flat[i * 4 ..][0..4].* = .{ 3.0, 3.0, 3.0, 1.0 };
+    var cooked = try cook(allocator, flat, width, height, test_settings);
+    defer cooked.deinit();
+
+    try std.testing.expectEqual(specular_offset(16, 4), cooked.specular.len);
+    for (0..cooked.mip_count) |m| {
+        const level = cooked.specular_level(@intCast(m));
+        const size: usize = @as(usize, 16) >> @intCast(m);
+        try std.testing.expectEqual(FACE_COUNT * size * size * 4, level.len);
+        for (0..level.len / 4) |i| {
+            try std.testing.expectApproxEqAbs(@as(f32, 3.0), @as(f32, level[i * 4]), 1e-2);
+        }
+    }
+
+    // Blurrier mips of the gradient sky pull the zenith toward the hemisphere average
+    // (1 + cos for a mirror, less for rough), while the mirror mip keeps the source value.
+    const sky = try make_gradient_sky(allocator, width, height);
+    defer allocator.free(sky);
+    var cooked_sky = try cook(allocator, sky, width, height, test_settings);
+    defer cooked_sky.deinit();
+    const face_up = 2;
+    var zenith: [4]f32 = undefined;
+    for (0..cooked_sky.mip_count) |m| {
+        const size: usize = @as(usize, 16) >> @intCast(m);
+        const level = cooked_sky.specular_level(@intCast(m));
+        const center = face_up * size * size + (size / 2) * size + size / 2;
+        zenith[m] = level[center * 4];
+    }
+    try std.testing.expectApproxEqAbs(@as(f32, 2.0), zenith[0], 2e-2);
+    try std.testing.expect(zenith[1] < zenith[0] and zenith[2] < zenith[1] and zenith[3] < zenith[2]);
+    try std.testing.expect(zenith[3] > 1.0);
+}
+
+test "ibl cooker BRDF LUT matches the closed form at zero roughness" {
+    // A smooth mirror reflects everything (scale + bias = 1), split by Schlick's Fresnel.
+    for ([_]f32{ 0.1, 0.35, 0.7, 1.0 }) |v| {
+        const r = integrate_brdf(v, 0.0, 64);
+        const fc = std.math.pow(f32, 1.0 - v, 5.0);
+        try std.testing.expectApproxEqAbs(1.0 - fc, r[0], 1e-3);
+        try std.testing.expectApproxEqAbs(fc, r[1], 1e-3);
+    }
+
+    // Rougher surfaces lose energy to masking, most at grazing angles.
+    const smooth = integrate_brdf(0.5, 0.2, 1024);
+    const rough = integrate_brdf(0.5, 0.9, 1024);
+    try std.testing.expect(rough[0] + rough[1] < smooth[0] + smooth[1]);
+    try std.testing.expect(integrate_brdf(0.1, 0.9, 1024)[0] < integrate_brdf(0.9, 0.9, 1024)[0]);
+
+    // The LUT's SIMD rows agree with the scalar integration.
+    const allocator = std.testing.allocator;
+    const size = 8;
+    var lut: [size * size * 2]f16 = undefined;
+    try build_brdf_lut(allocator, size, 128, &lut);
+    const r = integrate_brdf(5.5 / 8.0, 2.5 / 8.0, 128);
+    try std.testing.expectApproxEqAbs(r[0], @as(f32, lut[(2 * size + 5) * 2]), 2e-3);
+    try std.testing.expectApproxEqAbs(r[1], @as(f32, lut[(2 * size + 5) * 2 + 1]), 2e-3);
+}
+
+test "ibl cooker cache files round-trip" {
+    const allocator = std.testing.allocator;
+    const sky = try make_gradient_sky(allocator, 64, 32);
+    defer allocator.free(sky);
+    var cooked = try cook(allocator, sky, 64, 32, test_settings);
+    defer cooked.deinit();
+
+    const bytes = try write_file(allocator, &cooked);
+    defer allocator.free(bytes);
+    var loaded = try read_file(allocator, bytes);
+    defer loaded.deinit();
+    try std.testing.expectEqual(cooked.face_size, loaded.face_size);
+    try std.testing.expectEqual(cooked.sh, loaded.sh);
+    try std.testing.expectEqualSlices(f16, cooked.specular, loaded.specular);
+    try std.testing.expectEqualSlices(f16, cooked.lut, loaded.lut);
+
+    try std.testing.expectError(error.InvalidIblFile, read_file(allocator, bytes[0 .. bytes.len - 2]));
+}
+
+test "ibl cooker keys files by resolved path and modification time" {
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+    try tmp.dir.writeFile(.{ .sub_path = "sky.exr", .data = "not really an exr" });
+
+    var path_buf: [std.fs.max_path_bytes]u8 = undefined;
+    const dir_path = try tmp.dir.realpath(".", &path_buf);
+    var file_buf: [std.fs.max_path_bytes]u8 = undefined;
+    const direct = try std.fmt.bufPrint(&file_buf, "{s}/sky.exr", .{dir_path});
+    var dotted_buf: [std.fs.max_path_bytes]u8 = undefined;
+    const dotted = try std.fmt.bufPrint(&dotted_buf, "{s}/./sky.exr", .{dir_path});
+
+    const key = try file_key(direct);
+    try std.testing.expectEqual(key, try file_key(dotted));
+
+    const file = try tmp.dir.openFile("sky.exr", .{ .mode = .read_write });
+    defer file.close();
+    const stat = try file.stat();
+    try file.updateTimes(stat.atime, stat.mtime + std.time.ns_per_s);
+    try std.testing.expect(key != try file_key(direct));
+    try std.testing.expect(source_key("a.exr", 1) != source_key("b.exr", 1));
+}
@@ -9,6 +9,7 @@ const scene = @import("scene.zig");
 const log = @import("../core/log.zig");
 const memory = @import("../core/memory.zig");
 const nif_loader = @import("nif_loader.zig");
+const vfs = @import("../core/vfs.zig");
 
 const kfm_log = log.ScopedLogger("KFM");
 
@@ -16,22 +17,15 @@ const kfm_log = log.ScopedLogger("KFM");
 pub export fn cardinal_kfm_load_scene(path: [*:0]const u8, out_scene: *scene.CardinalScene) callconv(.c) bool {
     kfm_log.warn("Loading KFM scene: {s}", .{path});
 
-    const file = std.fs.cwd().openFileZ(path, .{}) catch |err| {
+    const allocator = memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
+    var file_data = vfs.read_file(allocator, std.mem.span(path)) catch |err| {
         kfm_log.err("Failed to open KFM file: {s}", .{@errorName(err)});
         return false;
     };
-    defer file.close();
-
-    const size = file.getEndPos() catch 0;
-    if (size == 0) return false;
-
-    const allocator = memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator();
-    const buffer = allocator.alloc(u8, size) catch return false;
-    defer allocator.free(buffer);
-
-    _ = file.readAll(buffer) catch return false;
+    defer file_data.deinit();
+    if (file_data.bytes.len == 0) return false;
 
-    var reader = nif_loader.NifReader.init(allocator, buffer);
+    var reader = nif_loader.NifReader.init(allocator, file_data.bytes);
     defer reader.deinit();
 
     const header_str = reader.read_string_lf() catch return false;
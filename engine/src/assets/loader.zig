@@ -9,6 +9,7 @@ const log = @import("../core/log.zig");
 const scene_serializer = @import("scene_serializer.zig");
 const memory = @import("../core/memory.zig");
 const nif_loader = @import("nif_loader.zig");
+const vfs = @import("../core/vfs.zig");
 const kfm_loader = @import("kfm_loader.zig");
 const asset_utils = @import("asset_utils.zig");
 
@@ -16,6 +17,7 @@ const loader_log = log.ScopedLogger("LOADER");
 
 /// glTF scene loader implemented in the C translation unit.
 extern fn cardinal_gltf_load_scene(path: [*:0]const u8, scene: *scene.CardinalScene) callconv(.c) bool;
+extern fn cardinal_gltf_load_scene_from_memory(path: [*:0]const u8, data: [*]const u8, size: usize, scene: *scene.CardinalScene) callconv(.c) bool;
 
 fn normalize_extension(ext: [*:0]const u8, buf: []u8) ?[]const u8 {
     const ext_len = std.mem.len(ext);
@@ -86,6 +88,21 @@ pub export fn cardinal_scene_load(path: ?[*:0]const u8, out_scene: ?*scene.Cardi
     return false;
 }
 
+/// Loads a scene from the contents of `path`, already read into `data` by the I/O service. glTF
+/// parses `data` in place; formats without an in-memory loader read `path` again, which the
+/// read-ahead has left in the OS page cache.
+pub export fn cardinal_scene_load_from_memory(path: ?[*:0]const u8, data: [*]const u8, size: usize, out_scene: ?*scene.CardinalScene) callconv(.c) bool {
+    if (path == null or out_scene == null) return cardinal_scene_load(path, out_scene);
+
+    var ext_buf: [16]u8 = undefined;
+    const ext = asset_utils.find_extension(path) orelse return cardinal_scene_load(path, out_scene);
+    const ext_slice = normalize_extension(ext, &ext_buf) orelse return cardinal_scene_load(path, out_scene);
+    if (std.mem.eql(u8, ext_slice, "gltf") or std.mem.eql(u8, ext_slice, "glb")) {
+        return cardinal_gltf_load_scene_from_memory(path.?, data, size, out_scene.?);
+    }
+    return cardinal_scene_load(path, out_scene);
+}
+
 /// Schedules a scene load using the async loader and returns the created task.
 pub export fn cardinal_scene_load_async(path: ?[*:0]const u8, priority: async_loader.CardinalAsyncPriority, callback: async_loader.CardinalAsyncCallback, user_data: ?*anyopaque) callconv(.c) ?*async_loader.CardinalAsyncTask {
     if (path == null) {
@@ -127,16 +144,25 @@ fn ecs_scene_loader_impl(file_path: ?[*:0]const u8) callconv(.c) ?*anyopaque {
     const allocator = allocator_handle.as_allocator();
 
     const path_slice = std.mem.span(file_path.?);
-    const file = std.fs.cwd().openFile(path_slice, .{}) catch {
-        loader_log.err("Failed to open file: {s}", .{path_slice});
+    // The parsed scene keeps `content`, so it must be an owned copy.
+    const content = vfs.read_file_alloc(allocator, path_slice) catch |err| {
+        loader_log.err("Failed to read file {s}: {}", .{ path_slice, err });
         return null;
     };
-    defer file.close();
+    return parse_ecs_scene(allocator, content, path_slice);
+}
 
-    const content = file.readToEndAlloc(allocator, std.math.maxInt(usize)) catch |err| {
-        loader_log.err("Failed to read file: {}", .{err});
-        return null;
-    };
+fn ecs_scene_memory_loader_impl(file_path: ?[*:0]const u8, data: [*]const u8, size: usize) callconv(.c) ?*anyopaque {
+    if (file_path == null) return null;
+
+    const allocator = memory.cardinal_get_allocator_for_category(.ASSETS).as_allocator();
+    // The read-ahead buffer is released after the task; the parsed scene needs its own copy.
+    const content = allocator.dupe(u8, data[0..size]) catch return null;
+    return parse_ecs_scene(allocator, content, std.mem.span(file_path.?));
+}
+
+/// Parses an ECS scene; takes ownership of `content`, which the parsed scene keeps.
+fn parse_ecs_scene(allocator: std.mem.Allocator, content: []u8, path_slice: []const u8) ?*anyopaque {
     const parsed = scene_serializer.SceneSerializer.loadSceneData(allocator, content, path_slice) catch |err| {
         loader_log.err("Failed to parse scene: {}", .{err});
         allocator.free(content);
@@ -152,6 +178,7 @@ fn ecs_scene_loader_impl(file_path: ?[*:0]const u8) callconv(.c) ?*anyopaque {
 pub export fn cardinal_ecs_scene_load_async(path: ?[*:0]const u8, priority: async_loader.CardinalAsyncPriority, callback: async_loader.CardinalAsyncCallback, user_data: ?*anyopaque) callconv(.c) ?*async_loader.CardinalAsyncTask {
     if (async_loader.Loaders.ecs_scene_load_fn == null) {
         async_loader.cardinal_async_register_ecs_scene_loader(ecs_scene_loader_impl);
+        async_loader.cardinal_async_register_ecs_scene_memory_loader(ecs_scene_memory_loader_impl);
     }
     return async_loader.cardinal_async_load_ecs_scene(path, priority, callback, user_data);
 }
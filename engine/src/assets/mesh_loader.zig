@@ -1,7 +1,7 @@
 //! Mesh caching and load helpers.
 //!
-//! Provides a small thread-safe cache of meshes keyed by identifier, backed by the ref-counting
-//! registry. Mesh decoding is currently delegated to scene loaders (glTF/NIF) that populate
+//! Caches meshes keyed by a content-derived identifier in the asset manager, backed by the
+//! ref-counting registry. Mesh decoding is currently delegated to scene loaders (glTF/NIF) that populate
 //! `scene.CardinalMesh` data.
 const std = @import("std");
 const scene = @import("scene.zig");
@@ -9,200 +9,31 @@ const ref_counting = @import("../core/ref_counting.zig");
 const async_loader = @import("../core/async_loader.zig");
 const log = @import("../core/log.zig");
 const memory = @import("../core/memory.zig");
+const asset_manager = @import("asset_manager.zig");
 
 /// Module logger.
 const mesh_log = log.ScopedLogger("MESH");
 
-/// Single-linked cache entry.
-const MeshCacheEntry = struct {
-    mesh_id: [:0]const u8,
-    resource: *ref_counting.CardinalRefCountedResource,
-    mesh_bytes: usize,
-    prev: ?*MeshCacheEntry,
-    next: ?*MeshCacheEntry,
-};
-
-/// Mesh cache protected by a mutex.
-const MeshCache = struct {
-    head: ?*MeshCacheEntry,
-    tail: ?*MeshCacheEntry,
-    entry_count: u32,
-    max_entries: u32,
-    cache_hits: u32,
-    cache_misses: u32,
-    total_bytes: usize,
-    peak_bytes: usize,
-    initialized: bool,
-    mutex: std.Thread.Mutex,
-};
-
-var g_mesh_cache: MeshCache = .{
-    .head = null,
-    .tail = null,
-    .entry_count = 0,
-    .max_entries = 0,
-    .cache_hits = 0,
-    .cache_misses = 0,
-    .total_bytes = 0,
-    .peak_bytes = 0,
-    .initialized = false,
-    .mutex = .{},
-};
-
-/// Initializes the cache (idempotent).
+/// Initializes mesh caching (idempotent). Cached meshes live in the asset manager.
 fn mesh_cache_init(max_entries: u32) bool {
-    g_mesh_cache.mutex.lock();
-    defer g_mesh_cache.mutex.unlock();
-
-    if (g_mesh_cache.initialized) {
-        return true;
-    }
-
-    g_mesh_cache.head = null;
-    g_mesh_cache.tail = null;
-    g_mesh_cache.entry_count = 0;
-    g_mesh_cache.max_entries = max_entries;
-    g_mesh_cache.cache_hits = 0;
-    g_mesh_cache.cache_misses = 0;
-    g_mesh_cache.total_bytes = 0;
-    g_mesh_cache.peak_bytes = 0;
-    g_mesh_cache.initialized = true;
-
+    asset_manager.init() catch |err| {
+        mesh_log.err("Failed to initialize asset manager for mesh caching: {s}", .{@errorName(err)});
+        return false;
+    };
     mesh_log.info_s(.{ .max_entries = max_entries }, "Cache initialized", .{});
     return true;
 }
 
-fn entry_detach(entry: *MeshCacheEntry) void {
-    if (entry.prev) |p| {
-        p.next = entry.next;
-    } else {
-        g_mesh_cache.head = entry.next;
-    }
-    if (entry.next) |n| {
-        n.prev = entry.prev;
-    } else {
-        g_mesh_cache.tail = entry.prev;
-    }
-    entry.prev = null;
-    entry.next = null;
-}
-
-fn entry_push_front(entry: *MeshCacheEntry) void {
-    entry.prev = null;
-    entry.next = g_mesh_cache.head;
-    if (g_mesh_cache.head) |h| {
-        h.prev = entry;
-    } else {
-        g_mesh_cache.tail = entry;
-    }
-    g_mesh_cache.head = entry;
-}
-
-fn entry_mesh_bytes(resource: *ref_counting.CardinalRefCountedResource) usize {
-    const mesh: *scene.CardinalMesh = @ptrCast(@alignCast(resource.resource.?));
-    var bytes: usize = @sizeOf(scene.CardinalMesh);
-    if (mesh.vertices != null and mesh.vertex_count > 0) {
-        bytes += @as(usize, @intCast(mesh.vertex_count)) * @sizeOf(scene.CardinalVertex);
-    }
-    if (mesh.indices != null and mesh.index_count > 0) {
-        bytes += @as(usize, @intCast(mesh.index_count)) * @sizeOf(u32);
-    }
-    return bytes;
-}
-
-fn evict_tail_if_needed(allocator: *memory.CardinalAllocator) void {
-    if (g_mesh_cache.max_entries == 0) return;
-    while (g_mesh_cache.entry_count >= g_mesh_cache.max_entries) {
-        const to_remove = g_mesh_cache.tail orelse return;
-        entry_detach(to_remove);
-
-        memory.cardinal_free(allocator, @ptrCast(@constCast(to_remove.mesh_id.ptr)));
-        ref_counting.cardinal_ref_release(to_remove.resource);
-        g_mesh_cache.total_bytes -|= to_remove.mesh_bytes;
-        memory.cardinal_free(allocator, to_remove);
-
-        if (g_mesh_cache.entry_count > 0) g_mesh_cache.entry_count -= 1;
-    }
-}
-
-/// Returns a retained mesh resource if present in cache.
+/// Returns a retained mesh resource if present in cache. Wait-free on hits.
 fn mesh_cache_get(mesh_id: []const u8) ?*ref_counting.CardinalRefCountedResource {
-    g_mesh_cache.mutex.lock();
-    defer g_mesh_cache.mutex.unlock();
-
-    if (!g_mesh_cache.initialized) {
-        return null;
-    }
-
-    var entry = g_mesh_cache.head;
-    while (entry) |e| {
-        if (std.mem.eql(u8, e.mesh_id, mesh_id)) {
-            if (ref_counting.cardinal_ref_acquire(e.resource.identifier)) |res| {
-                g_mesh_cache.cache_hits += 1;
-                if (g_mesh_cache.head == null or g_mesh_cache.head.?.mesh_id.ptr != e.mesh_id.ptr) {
-                    entry_detach(e);
-                    entry_push_front(e);
-                }
-                return res;
-            }
-        }
-        entry = e.next;
-    }
-
-    g_mesh_cache.cache_misses += 1;
-    return null;
+    if (!asset_manager.is_initialized()) return null;
+    return asset_manager.get().acquireMeshResource(mesh_id);
 }
 
-/// Inserts a mesh resource into the cache and retains it.
+/// Inserts a mesh resource into the cache, which takes its own reference.
 fn mesh_cache_put(mesh_id: [:0]const u8, resource: *ref_counting.CardinalRefCountedResource) void {
-    g_mesh_cache.mutex.lock();
-    defer g_mesh_cache.mutex.unlock();
-
-    if (!g_mesh_cache.initialized) {
-        return;
-    }
-
-    const allocator = memory.cardinal_get_allocator_for_category(.ASSETS);
-
-    var it = g_mesh_cache.head;
-    while (it) |e| {
-        if (std.mem.eql(u8, e.mesh_id, mesh_id)) {
-            if (g_mesh_cache.head == null or g_mesh_cache.head.?.mesh_id.ptr != e.mesh_id.ptr) {
-                entry_detach(e);
-                entry_push_front(e);
-            }
-            return;
-        }
-        it = e.next;
-    }
-
-    evict_tail_if_needed(allocator);
-
-    const new_entry_ptr = memory.cardinal_alloc(allocator, @sizeOf(MeshCacheEntry));
-    if (new_entry_ptr == null) return;
-    const new_entry: *MeshCacheEntry = @ptrCast(@alignCast(new_entry_ptr));
-
-    const id_len = mesh_id.len;
-    const id_copy_ptr = memory.cardinal_alloc(allocator, id_len + 1);
-    if (id_copy_ptr == null) {
-        memory.cardinal_free(allocator, new_entry);
-        return;
-    }
-
-    @memcpy(@as([*]u8, @ptrCast(id_copy_ptr))[0..id_len], mesh_id);
-    @as([*]u8, @ptrCast(id_copy_ptr))[id_len] = 0;
-    new_entry.mesh_id = @as([*:0]const u8, @ptrCast(id_copy_ptr))[0..id_len :0];
-
-    new_entry.resource = resource;
-    _ = ref_counting.cardinal_ref_acquire(resource.identifier);
-    new_entry.mesh_bytes = entry_mesh_bytes(resource);
-    g_mesh_cache.total_bytes += new_entry.mesh_bytes;
-    if (g_mesh_cache.total_bytes > g_mesh_cache.peak_bytes) g_mesh_cache.peak_bytes = g_mesh_cache.total_bytes;
-
-    new_entry.prev = null;
-    new_entry.next = null;
-    entry_push_front(new_entry);
-    g_mesh_cache.entry_count += 1;
+    if (!asset_manager.is_initialized()) return;
+    _ = asset_manager.get().cacheMesh(mesh_id, resource);
 }
 
 /// Produces a stable identifier for a mesh based on a small content hash.
@@ -298,7 +129,7 @@ pub export fn mesh_load_with_ref_counting(mesh_data: ?*const scene.CardinalMesh,
         return null;
     }
 
-    if (!g_mesh_cache.initialized) {
+    if (!asset_manager.is_initialized()) {
         _ = mesh_cache_init(128);
     }
 
@@ -417,27 +248,9 @@ pub export fn mesh_cache_initialize(max_entries: u32) callconv(.c) bool {
 }
 
 pub export fn mesh_cache_shutdown_system() callconv(.c) void {
-    g_mesh_cache.mutex.lock();
-    defer g_mesh_cache.mutex.unlock();
-
-    if (!g_mesh_cache.initialized) return;
-
-    const allocator = memory.cardinal_get_allocator_for_category(.ASSETS);
-    var entry = g_mesh_cache.head;
-    while (entry) |e| {
-        const next = e.next;
-        memory.cardinal_free(allocator, @ptrCast(@constCast(e.mesh_id.ptr)));
-        ref_counting.cardinal_ref_release(e.resource);
-        g_mesh_cache.total_bytes -|= e.mesh_bytes;
-        memory.cardinal_free(allocator, e);
-        entry = next;
-    }
-
-    g_mesh_cache.head = null;
-    g_mesh_cache.tail = null;
-    g_mesh_cache.entry_count = 0;
-    g_mesh_cache.initialized = false;
-    mesh_log.info("Cache shutdown complete", .{});
+    if (!asset_manager.is_initialized()) return;
+    const removed = asset_manager.get().meshes.clear_unreferenced();
+    mesh_log.info("Cache shutdown complete ({d} entries released)", .{removed});
 }
 
 pub const MeshCacheStats = extern struct {
@@ -448,46 +261,25 @@ pub const MeshCacheStats = extern struct {
 };
 
 pub export fn mesh_cache_get_stats() callconv(.c) MeshCacheStats {
-    g_mesh_cache.mutex.lock();
-    defer g_mesh_cache.mutex.unlock();
-
-    if (!g_mesh_cache.initialized) return std.mem.zeroes(MeshCacheStats);
-
+    if (!asset_manager.is_initialized()) return std.mem.zeroes(MeshCacheStats);
+    const meshes = &asset_manager.get().meshes;
     return .{
-        .entry_count = g_mesh_cache.entry_count,
-        .max_entries = g_mesh_cache.max_entries,
-        .cache_hits = g_mesh_cache.cache_hits,
-        .cache_misses = g_mesh_cache.cache_misses,
+        .entry_count = meshes.count(),
+        .max_entries = meshes.map.capacity(),
+        .cache_hits = meshes.cache_hits.load(.monotonic),
+        .cache_misses = meshes.cache_misses.load(.monotonic),
     };
 }
 
 pub export fn mesh_cache_clear() callconv(.c) void {
-    g_mesh_cache.mutex.lock();
-    defer g_mesh_cache.mutex.unlock();
-
-    if (!g_mesh_cache.initialized) return;
-
-    const allocator = memory.cardinal_get_allocator_for_category(.ASSETS);
-    var entry = g_mesh_cache.head;
-    while (entry) |e| {
-        const next = e.next;
-        memory.cardinal_free(allocator, @ptrCast(@constCast(e.mesh_id.ptr)));
-        ref_counting.cardinal_ref_release(e.resource);
-        g_mesh_cache.total_bytes -|= e.mesh_bytes;
-        memory.cardinal_free(allocator, e);
-        entry = next;
-    }
-
-    g_mesh_cache.head = null;
-    g_mesh_cache.tail = null;
-    g_mesh_cache.entry_count = 0;
+    if (!asset_manager.is_initialized()) return;
+    _ = asset_manager.get().meshes.clear_unreferenced();
     mesh_log.info("Cache cleared", .{});
 }
 
 pub export fn mesh_cache_get_memory_stats(total_bytes: ?*u64, peak_bytes: ?*u64) callconv(.c) void {
-    g_mesh_cache.mutex.lock();
-    defer g_mesh_cache.mutex.unlock();
-
-    if (total_bytes) |t| t.* = @intCast(g_mesh_cache.total_bytes);
-    if (peak_bytes) |p| p.* = @intCast(g_mesh_cache.peak_bytes);
+    const initialized = asset_manager.is_initialized();
+    const map = &asset_manager.get().meshes.map;
+    if (total_bytes) |t| t.* = if (initialized) map.resident_bytes.load(.monotonic) else 0;
+    if (peak_bytes) |p| p.* = if (initialized) map.peak_bytes.load(.monotonic) else 0;
 }
@@ -1,8 +1,10 @@
 //! High-level manager for loaded model scenes.
 //!
-//! The model manager owns per-model `CardinalScene` instances and can build a combined scene
-//! used for rendering/editor selection. The combined scene deep-copies materials/textures/skins
-//! but shares node pointers with per-model scenes.
+//! The model manager owns per-model `CardinalScene` instances and maintains a combined scene
+//! used for rendering/editor selection. Each model owns stable slot ranges in the combined arrays,
+//! handed out by free-list allocators, so adding, removing or hiding a model only touches that
+//! model's slots. The combined scene deep-copies materials/textures/skins but shares node pointers
+//! with per-model scenes.
 const std = @import("std");
 const scene = @import("scene.zig");
 const transform_math = @import("../core/transform.zig");
@@ -12,6 +14,7 @@ const ref_counting = @import("../core/ref_counting.zig");
 const async_loader = @import("../core/async_loader.zig");
 const texture_loader = @import("texture_loader.zig");
 const animation = @import("animation.zig");
+const morph_targets = @import("morph_targets.zig");
 
 const model_log = log.ScopedLogger("MODEL");
 
@@ -23,6 +26,23 @@ extern fn cardinal_scene_load(file_path: [*:0]const u8, out_scene: *scene.Cardin
 /// Default initial capacity for the model array.
 const INITIAL_MODEL_CAPACITY = 8;
 
+/// Slot ranges a model occupies inside the combined scene arrays.
+///
+/// Ranges are assigned when the model first enters the combined scene and stay fixed until it is
+/// removed, so combined mesh indices held by the editor/ECS survive unrelated adds and removes.
+pub const CardinalCombinedRange = extern struct {
+    mesh_first: u32,
+    mesh_count: u32,
+    material_first: u32,
+    material_count: u32,
+    texture_first: u32,
+    texture_count: u32,
+    node_first: u32,
+    node_count: u32,
+    resident: bool,
+    applied_visible: bool,
+};
+
 /// A loaded model instance and its per-model scene data.
 pub const CardinalModelInstance = extern struct {
     name: ?[*:0]u8,
@@ -36,6 +56,7 @@ pub const CardinalModelInstance = extern struct {
     bbox_max: [3]f32,
     is_loading: bool,
     load_task: ?*async_loader.CardinalAsyncTask,
+    combined: CardinalCombinedRange,
 };
 
 /// Stateful container for loaded models and an optional combined scene snapshot.
@@ -48,6 +69,7 @@ pub const CardinalModelManager = extern struct {
     scene_dirty: bool,
     transform_dirty: bool,
     selected_model_id: u32,
+    combined_state: ?*anyopaque,
 };
 
 /// Generates a display name derived from the file name.
@@ -188,39 +210,268 @@ pub fn find_model_index(manager: *const CardinalModelManager, model_id: u32) i32
     return -1;
 }
 
-/// Releases heap-owned allocations inside `manager.combined_scene`.
+/// Minimum slot capacity reserved when a combined-scene array is first allocated.
+const MIN_SLOT_CAPACITY = 16;
+
+/// Maximum number of changed ranges retained before falling back to a full upload request.
+const MAX_DIRTY_RANGES = 256;
+
+const SlotRange = struct {
+    first: u32,
+    count: u32,
+};
+
+/// First-fit range allocator over one combined-scene array.
 ///
-/// The combined scene intentionally shares mesh vertex/index pointers and node pointers with
-/// per-model scenes, so this only frees the combined arrays and deep-copied resources.
-fn cleanup_combined_scene(manager: *CardinalModelManager) void {
-    const s = &manager.combined_scene;
+/// Freed ranges are kept sorted and coalesced. `high_water` only grows between full rebuilds so the
+/// published element counts (and therefore combined indices) stay stable while models come and go.
+const SlotAllocator = struct {
+    high_water: u32 = 0,
+    capacity: u32 = 0,
+    free_ranges: std.ArrayListUnmanaged(SlotRange) = .{},
+
+    fn deinit(self: *SlotAllocator, allocator: std.mem.Allocator) void {
+        self.free_ranges.deinit(allocator);
+        self.* = .{};
+    }
+
+    fn reset(self: *SlotAllocator) void {
+        self.free_ranges.clearRetainingCapacity();
+        self.high_water = 0;
+        self.capacity = 0;
+    }
+
+    /// Takes `count` contiguous slots from the free list, or from the tail if capacity allows.
+    fn take(self: *SlotAllocator, count: u32) ?u32 {
+        for (self.free_ranges.items, 0..) |*r, idx| {
+            if (r.count < count) continue;
+            const first = r.first;
+            if (r.count == count) {
+                _ = self.free_ranges.orderedRemove(idx);
+            } else {
+                r.first += count;
+                r.count -= count;
+            }
+            return first;
+        }
+
+        if (self.capacity - self.high_water < count) return null;
+        const first = self.high_water;
+        self.high_water += count;
+        return first;
+    }
+
+    /// Returns a range to the free list, merging it with adjacent free ranges.
+    fn release(self: *SlotAllocator, allocator: std.mem.Allocator, first: u32, count: u32) void {
+        if (count == 0) return;
+
+        const items = self.free_ranges.items;
+        var idx: usize = 0;
+        while (idx < items.len and items[idx].first < first) : (idx += 1) {}
+
+        if (idx > 0 and items[idx - 1].first + items[idx - 1].count == first) {
+            items[idx - 1].count += count;
+            if (idx < items.len and items[idx - 1].first + items[idx - 1].count == items[idx].first) {
+                items[idx - 1].count += items[idx].count;
+                _ = self.free_ranges.orderedRemove(idx);
+            }
+            return;
+        }
+
+        if (idx < items.len and first + count == items[idx].first) {
+            items[idx].first = first;
+            items[idx].count += count;
+            return;
+        }
+
+        self.free_ranges.insert(allocator, idx, .{ .first = first, .count = count }) catch {
+            model_log.warn("Failed to record free combined slots {d}+{d}; reclaimed on next full rebuild", .{ first, count });
+        };
+    }
+};
+
+/// Bookkeeping for the incrementally maintained combined scene.
+const CombinedSceneState = struct {
+    meshes: SlotAllocator = .{},
+    materials: SlotAllocator = .{},
+    textures: SlotAllocator = .{},
+    nodes: SlotAllocator = .{},
+    dirty_ranges: std.ArrayListUnmanaged(scene.CardinalSceneDirtyRange) = .{},
+    /// Set when pending changes cannot be applied as range patches (range overflow, full rebuild).
+    full_upload: bool = false,
+    /// Set when a model with animations or skins enters or leaves the combined scene. The combined
+    /// skins are rebuilt and every animated model's meshes are reported as a `SKINNING` range.
+    animation_dirty: bool = false,
+    /// Set by `cardinal_model_manager_mark_dirty` to drop all ranges and re-place every model.
+    rebuild_all: bool = false,
+    /// CPU deformers for resident morph-target meshes, one per combined mesh slot.
+    morphs: std.ArrayListUnmanaged(*MorphInstance) = .{},
+};
+
+/// Morph-target state of one combined mesh, driven by the WEIGHTS channels of the node that
+/// references it. The combined mesh's `vertices` point at `deformer.output`.
+const MorphInstance = struct {
+    mesh_slot: u32,
+    node_slot: u32,
+    set: morph_targets.MorphSet,
+    deformer: morph_targets.MorphDeformer,
+};
+
+fn combined_list_allocator() std.mem.Allocator {
+    return memory.cardinal_get_allocator_for_category(.ASSETS).as_allocator();
+}
+
+fn get_combined_state(manager: *CardinalModelManager) ?*CombinedSceneState {
+    if (manager.combined_state) |p| return @ptrCast(@alignCast(p));
+
     const allocator = memory.cardinal_get_allocator_for_category(.ASSETS);
+    const ptr = memory.cardinal_alloc(allocator, @sizeOf(CombinedSceneState)) orelse {
+        model_log.err("Failed to allocate combined scene state", .{});
+        return null;
+    };
+    const state: *CombinedSceneState = @ptrCast(@alignCast(ptr));
+    state.* = .{};
+    manager.combined_state = ptr;
+    return state;
+}
 
-    if (s.meshes) |meshes| {
-        memory.cardinal_free(allocator, @ptrCast(meshes));
+fn destroy_combined_state(manager: *CardinalModelManager) void {
+    const ptr = manager.combined_state orelse return;
+    const state: *CombinedSceneState = @ptrCast(@alignCast(ptr));
+    const list_alloc = combined_list_allocator();
+
+    state.meshes.deinit(list_alloc);
+    state.materials.deinit(list_alloc);
+    state.textures.deinit(list_alloc);
+    state.nodes.deinit(list_alloc);
+    state.dirty_ranges.deinit(list_alloc);
+    release_morphs(state, 0, std.math.maxInt(u32));
+    state.morphs.deinit(list_alloc);
+
+    memory.cardinal_free(memory.cardinal_get_allocator_for_category(.ASSETS), ptr);
+    manager.combined_state = null;
+}
+
+fn record_dirty_range(state: *CombinedSceneState, range: scene.CardinalSceneDirtyRange) void {
+    if (range.mesh_count == 0 and range.material_count == 0 and range.texture_count == 0) return;
+
+    if (state.dirty_ranges.items.len >= MAX_DIRTY_RANGES) {
+        state.full_upload = true;
+        return;
     }
+    state.dirty_ranges.append(combined_list_allocator(), range) catch {
+        state.full_upload = true;
+    };
+}
 
-    if (s.materials) |mats| {
-        memory.cardinal_free(allocator, @ptrCast(mats));
+/// Reserves `count` contiguous slots in a combined-scene array, growing it geometrically when
+/// neither a free range nor the remaining tail capacity can hold them. New slots are zeroed.
+fn reserve_slots(comptime T: type, slots: *SlotAllocator, array: *?[*]T, count: u32) !u32 {
+    if (count == 0) return 0;
+    if (slots.take(count)) |first| return first;
+
+    const required = slots.high_water + count;
+    var new_capacity: u32 = @max(slots.capacity * 2, MIN_SLOT_CAPACITY);
+    while (new_capacity < required) new_capacity *= 2;
+
+    const allocator = memory.cardinal_get_allocator_for_category(.ASSETS);
+    const new_bytes = std.math.mul(usize, new_capacity, @sizeOf(T)) catch return error.OutOfMemory;
+    const old_bytes = @as(usize, slots.capacity) * @sizeOf(T);
+    const ptr = memory.cardinal_realloc(allocator, @ptrCast(array.*), new_bytes) orelse {
+        model_log.err("Failed to grow combined scene array to {d} slots", .{new_capacity});
+        return error.OutOfMemory;
+    };
+    @memset(@as([*]u8, @ptrCast(ptr))[old_bytes..new_bytes], 0);
+
+    array.* = @ptrCast(@alignCast(ptr));
+    slots.capacity = new_capacity;
+    return slots.take(count) orelse error.OutOfMemory;
+}
+
+/// Copies a texture into a combined-scene slot, taking a reference or a private data copy.
+fn copy_combined_texture(allocator: *memory.CardinalAllocator, src_texture: *const scene.CardinalTexture, dst_texture: *scene.CardinalTexture) void {
+    dst_texture.* = src_texture.*;
+
+    var used_ref_counting = false;
+    if (src_texture.ref_resource) |res| {
+        _ = @atomicRmw(u32, &res.ref_count, .Add, 1, .seq_cst);
+        dst_texture.ref_resource = res;
+
+        if (res.resource) |r| {
+            const tex_data = @as(*texture_loader.TextureData, @ptrCast(@alignCast(r)));
+            dst_texture.data = tex_data.data;
+            dst_texture.width = tex_data.width;
+            dst_texture.height = tex_data.height;
+            dst_texture.channels = tex_data.channels;
+            dst_texture.is_hdr = tex_data.is_hdr;
+            dst_texture.format = tex_data.format;
+            dst_texture.data_size = tex_data.data_size;
+        } else {
+            dst_texture.data = src_texture.data;
+        }
+        used_ref_counting = true;
     }
 
-    if (s.textures) |texs| {
-        var i: u32 = 0;
-        while (i < s.texture_count) : (i += 1) {
-            if (texs[i].ref_resource) |r| ref_counting.cardinal_ref_release(r);
-            if (texs[i].path) |p| memory.cardinal_free(allocator, @ptrCast(p));
+    if (!used_ref_counting) {
+        dst_texture.ref_resource = null;
+        if (src_texture.data != null and src_texture.width > 0 and src_texture.height > 0) {
+            const data_size = src_texture.width * src_texture.height * src_texture.channels;
+            const data_ptr = memory.cardinal_alloc(allocator, data_size);
+            if (data_ptr) |dp| {
+                @memcpy(@as([*]u8, @ptrCast(dp))[0..data_size], @as([*]u8, @ptrCast(src_texture.data.?))[0..data_size]);
+                dst_texture.data = @ptrCast(dp);
+            } else {
+                dst_texture.data = null;
+            }
+        } else {
+            dst_texture.data = null;
+        }
+    }
 
-            if (texs[i].ref_resource == null and texs[i].data != null) {
-                memory.cardinal_free(allocator, @ptrCast(texs[i].data));
+    if (src_texture.path) |p| {
+        const path_len = std.mem.len(p);
+        const path_ptr = memory.cardinal_alloc(allocator, path_len + 1);
+        if (path_ptr) |pp| {
+            @memcpy(@as([*]u8, @ptrCast(pp))[0..path_len], @as([*]const u8, @ptrCast(p))[0..path_len]);
+            @as([*]u8, @ptrCast(pp))[path_len] = 0;
+            dst_texture.path = @ptrCast(pp);
+        } else {
+            dst_texture.path = null;
+        }
+    } else {
+        dst_texture.path = null;
+    }
+
+    if (dst_texture.ref_resource == null and src_texture.ref_resource != null) {
+        if (src_texture.width == 2 and src_texture.height == 2) {
+            if (src_texture.ref_resource.?.identifier) |id| {
+                if (ref_counting.cardinal_ref_acquire(id)) |acquired_res| {
+                    dst_texture.ref_resource = acquired_res;
+                    dst_texture.data = src_texture.data;
+                }
             }
         }
-        memory.cardinal_free(allocator, @ptrCast(texs));
     }
 
-    if (s.root_nodes) |nodes| memory.cardinal_free(allocator, @ptrCast(nodes));
-    if (s.all_nodes) |nodes| memory.cardinal_free(allocator, @ptrCast(nodes));
+    if (dst_texture.ref_resource == null and src_texture.ref_resource != null) {
+        model_log.warn("Texture copy failed to preserve ref_resource! Src: {*}, Dst: {*}", .{ src_texture.ref_resource, dst_texture.ref_resource });
+    }
+}
 
-    if (s.lights) |lights| memory.cardinal_free(allocator, @ptrCast(lights));
+/// Releases the reference, path and private data owned by a combined-scene texture slot.
+fn release_combined_texture(allocator: *memory.CardinalAllocator, tex: *scene.CardinalTexture) void {
+    if (tex.ref_resource) |r| ref_counting.cardinal_ref_release(r);
+    if (tex.path) |p| memory.cardinal_free(allocator, @ptrCast(p));
+
+    if (tex.ref_resource == null and tex.data != null) {
+        memory.cardinal_free(allocator, @ptrCast(tex.data));
+    }
+}
+
+/// Releases the combined animation system and deep-copied skins.
+fn cleanup_combined_animation(manager: *CardinalModelManager) void {
+    const s = &manager.combined_scene;
+    const allocator = memory.cardinal_get_allocator_for_category(.ASSETS);
 
     if (s.skins) |skins_opaque| {
         const skins: [*]animation.CardinalSkin = @ptrCast(@alignCast(skins_opaque));
@@ -235,635 +486,530 @@ fn cleanup_combined_scene(manager: *CardinalModelManager) void {
         animation.cardinal_animation_system_destroy(@ptrCast(@alignCast(sys)));
     }
 
-    @memset(@as([*]u8, @ptrCast(s))[0..@sizeOf(scene.CardinalScene)], 0);
+    s.skins = null;
+    s.skin_count = 0;
+    s.animation_system = null;
 }
 
-/// Rebuilds `manager.combined_scene` by concatenating all visible model scenes.
+/// Releases heap-owned allocations inside `manager.combined_scene` and forgets every model range.
 ///
-/// Mesh vertex/index data is shared, while materials/textures/skins are copied so their indices
-/// can be re-based into a single scene namespace.
-fn rebuild_combined_scene(manager: *CardinalModelManager) void {
-    var total_meshes: u32 = 0;
-    var total_materials: u32 = 0;
-    var total_textures: u32 = 0;
-    var total_nodes: u32 = 0;
-    var total_animations: u32 = 0;
-    var total_skins: u32 = 0;
+/// The combined scene intentionally shares mesh vertex/index pointers and node pointers with
+/// per-model scenes, so this only frees the combined arrays and deep-copied resources.
+fn cleanup_combined_scene(manager: *CardinalModelManager) void {
+    const s = &manager.combined_scene;
+    const allocator = memory.cardinal_get_allocator_for_category(.ASSETS);
 
-    const models = if (manager.models) |m| m else {
-        manager.scene_dirty = false;
-        return;
-    };
+    cleanup_combined_animation(manager);
 
-    var visible_indices = std.ArrayListUnmanaged(u32){};
-    defer visible_indices.deinit(memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator());
+    if (s.meshes) |meshes| {
+        memory.cardinal_free(allocator, @ptrCast(meshes));
+    }
 
-    var i: u32 = 0;
-    while (i < manager.model_count) : (i += 1) {
-        const model = &models[i];
-        if (model.visible and !model.is_loading) {
-            visible_indices.append(memory.cardinal_get_allocator_for_category(.ENGINE).as_allocator(), i) catch return;
-
-            total_meshes += model.scene.mesh_count;
-            total_materials += model.scene.material_count;
-            total_textures += model.scene.texture_count;
-            total_nodes += model.scene.all_node_count;
-
-            if (model.scene.animation_system) |sys_opaque| {
-                const sys = @as(*animation.CardinalAnimationSystem, @ptrCast(@alignCast(sys_opaque)));
-                total_animations += sys.animation_count;
-                total_skins += sys.skin_count;
-            }
-        }
+    if (s.materials) |mats| {
+        memory.cardinal_free(allocator, @ptrCast(mats));
     }
 
-    if (total_meshes == 0) {
-        manager.scene_dirty = false;
-        return;
+    if (s.textures) |texs| {
+        var i: u32 = 0;
+        while (i < s.texture_count) : (i += 1) {
+            release_combined_texture(allocator, &texs[i]);
+        }
+        memory.cardinal_free(allocator, @ptrCast(texs));
     }
 
-    const allocator = memory.cardinal_get_allocator_for_category(.ASSETS);
+    if (s.root_nodes) |nodes| memory.cardinal_free(allocator, @ptrCast(nodes));
+    if (s.all_nodes) |nodes| memory.cardinal_free(allocator, @ptrCast(nodes));
 
-    const existing_meshes: u32 = manager.combined_scene.mesh_count;
-    const existing_materials: u32 = manager.combined_scene.material_count;
-    const existing_textures: u32 = manager.combined_scene.texture_count;
-    const existing_nodes: u32 = manager.combined_scene.all_node_count;
-
-    if (manager.combined_scene.meshes != null and
-        manager.combined_scene.materials != null and
-        manager.combined_scene.textures != null and
-        manager.combined_scene.all_nodes != null and
-        existing_meshes > 0 and
-        total_animations == 0 and
-        total_skins == 0)
-    {
-        var prefix_meshes: u32 = 0;
-        var prefix_materials: u32 = 0;
-        var prefix_textures: u32 = 0;
-        var prefix_nodes: u32 = 0;
-        var prefix_visible_count: u32 = 0;
-
-        for (visible_indices.items) |model_idx| {
-            if (prefix_meshes == existing_meshes and
-                prefix_materials == existing_materials and
-                prefix_textures == existing_textures and
-                prefix_nodes == existing_nodes)
-            {
-                break;
-            }
+    if (s.lights) |lights| memory.cardinal_free(allocator, @ptrCast(lights));
 
-            const m = &models[model_idx];
-            prefix_meshes += m.scene.mesh_count;
-            prefix_materials += m.scene.material_count;
-            prefix_textures += m.scene.texture_count;
-            prefix_nodes += m.scene.all_node_count;
-            prefix_visible_count += 1;
-        }
+    @memset(@as([*]u8, @ptrCast(s))[0..@sizeOf(scene.CardinalScene)], 0);
 
-        if (prefix_meshes == existing_meshes and
-            prefix_materials == existing_materials and
-            prefix_textures == existing_textures and
-            prefix_nodes == existing_nodes and
-            prefix_visible_count < visible_indices.items.len)
-        {
-            const new_meshes = total_meshes;
-            const new_materials = total_materials;
-            const new_textures = total_textures;
-            const new_nodes = total_nodes;
-
-            const meshes_bytes = std.math.mul(usize, @as(usize, new_meshes), @sizeOf(scene.CardinalMesh)) catch 0;
-            const materials_bytes = std.math.mul(usize, @as(usize, new_materials), @sizeOf(scene.CardinalMaterial)) catch 0;
-            const textures_bytes = std.math.mul(usize, @as(usize, new_textures), @sizeOf(scene.CardinalTexture)) catch 0;
-            const nodes_bytes = std.math.mul(usize, @as(usize, new_nodes), @sizeOf(?*scene.CardinalSceneNode)) catch 0;
-
-            const meshes_ptr = if (meshes_bytes > 0)
-                memory.cardinal_realloc(allocator, @ptrCast(manager.combined_scene.meshes), meshes_bytes)
-            else
-                null;
-            const materials_ptr = if (materials_bytes > 0)
-                memory.cardinal_realloc(allocator, @ptrCast(manager.combined_scene.materials), materials_bytes)
-            else
-                null;
-            const textures_ptr = if (textures_bytes > 0)
-                memory.cardinal_realloc(allocator, @ptrCast(manager.combined_scene.textures), textures_bytes)
-            else
-                null;
-            const nodes_ptr = if (nodes_bytes > 0)
-                memory.cardinal_realloc(allocator, @ptrCast(manager.combined_scene.all_nodes), nodes_bytes)
-            else
-                null;
-
-            if ((new_meshes == 0 or meshes_ptr != null) and
-                (new_materials == 0 or materials_ptr != null) and
-                (new_textures == 0 or textures_ptr != null) and
-                (new_nodes == 0 or nodes_ptr != null))
-            {
-                manager.combined_scene.meshes = if (meshes_ptr) |p| @ptrCast(@alignCast(p)) else null;
-                manager.combined_scene.materials = if (materials_ptr) |p| @ptrCast(@alignCast(p)) else null;
-                manager.combined_scene.textures = if (textures_ptr) |p| @ptrCast(@alignCast(p)) else null;
-                manager.combined_scene.all_nodes = if (nodes_ptr) |p| @ptrCast(@alignCast(p)) else null;
-
-                var mesh_offset: u32 = existing_meshes;
-                var material_offset: u32 = existing_materials;
-                var texture_offset: u32 = existing_textures;
-                var node_offset: u32 = existing_nodes;
-
-                var append_i: usize = prefix_visible_count;
-                while (append_i < visible_indices.items.len) : (append_i += 1) {
-                    const model = &models[visible_indices.items[append_i]];
-                    const scn = &model.scene;
-
-                    if (scn.meshes) |src_meshes| {
-                        var m: u32 = 0;
-                        while (m < scn.mesh_count) : (m += 1) {
-                            const src_mesh = &src_meshes[m];
-                            const dst_mesh = &manager.combined_scene.meshes.?[mesh_offset + m];
-
-                            if (src_mesh.vertices == null or src_mesh.vertex_count == 0 or
-                                src_mesh.indices == null or src_mesh.index_count == 0)
-                            {
-                                @memset(@as([*]u8, @ptrCast(dst_mesh))[0..@sizeOf(scene.CardinalMesh)], 0);
-                                dst_mesh.visible = false;
-                                continue;
-                            }
-
-                            dst_mesh.* = src_mesh.*;
-                            dst_mesh.material_index += material_offset;
-                            transform_math.cardinal_matrix_multiply(&model.transform, &src_mesh.transform, &dst_mesh.transform);
-                        }
-                    }
+    if (manager.combined_state) |p| {
+        const state: *CombinedSceneState = @ptrCast(@alignCast(p));
+        state.meshes.reset();
+        state.materials.reset();
+        state.textures.reset();
+        state.nodes.reset();
+        state.dirty_ranges.clearRetainingCapacity();
+        release_morphs(state, 0, std.math.maxInt(u32));
+        state.full_upload = true;
+        state.animation_dirty = false;
+    }
 
-                    if (scn.materials) |src_materials| {
-                        var mat: u32 = 0;
-                        while (mat < scn.material_count) : (mat += 1) {
-                            const src_material = &src_materials[mat];
-                            const dst_material = &manager.combined_scene.materials.?[material_offset + mat];
-
-                            dst_material.* = src_material.*;
-                            if (dst_material.albedo_texture.is_valid()) dst_material.albedo_texture.index += texture_offset;
-                            if (dst_material.normal_texture.is_valid()) dst_material.normal_texture.index += texture_offset;
-                            if (dst_material.metallic_roughness_texture.is_valid()) dst_material.metallic_roughness_texture.index += texture_offset;
-                            if (dst_material.ao_texture.is_valid()) dst_material.ao_texture.index += texture_offset;
-                            if (dst_material.emissive_texture.is_valid()) dst_material.emissive_texture.index += texture_offset;
-                        }
-                    }
+    if (manager.models) |models| {
+        var i: u32 = 0;
+        while (i < manager.model_count) : (i += 1) {
+            models[i].combined = std.mem.zeroes(CardinalCombinedRange);
+        }
+    }
+}
 
-                    if (scn.textures) |src_textures| {
-                        var tex: u32 = 0;
-                        while (tex < scn.texture_count) : (tex += 1) {
-                            const src_texture = &src_textures[tex];
-                            const dst_texture = &manager.combined_scene.textures.?[texture_offset + tex];
-
-                            dst_texture.* = src_texture.*;
-
-                            var used_ref_counting = false;
-                            if (src_texture.ref_resource) |res| {
-                                _ = @atomicRmw(u32, &res.ref_count, .Add, 1, .seq_cst);
-                                dst_texture.ref_resource = res;
-
-                                if (res.resource) |r| {
-                                    const tex_data = @as(*texture_loader.TextureData, @ptrCast(@alignCast(r)));
-                                    dst_texture.data = tex_data.data;
-                                    dst_texture.width = tex_data.width;
-                                    dst_texture.height = tex_data.height;
-                                    dst_texture.channels = tex_data.channels;
-                                    dst_texture.is_hdr = tex_data.is_hdr;
-                                    dst_texture.format = tex_data.format;
-                                    dst_texture.data_size = tex_data.data_size;
-                                } else {
-                                    dst_texture.data = src_texture.data;
-                                }
-                                used_ref_counting = true;
-                            }
-
-                            if (!used_ref_counting) {
-                                dst_texture.ref_resource = null;
-                                if (src_texture.data != null and src_texture.width > 0 and src_texture.height > 0) {
-                                    const data_size = src_texture.width * src_texture.height * src_texture.channels;
-                                    const data_ptr = memory.cardinal_alloc(allocator, data_size);
-                                    if (data_ptr) |dp| {
-                                        @memcpy(@as([*]u8, @ptrCast(dp))[0..data_size], @as([*]u8, @ptrCast(src_texture.data.?))[0..data_size]);
-                                        dst_texture.data = @ptrCast(dp);
-                                    } else {
-                                        dst_texture.data = null;
-                                    }
-                                } else {
-                                    dst_texture.data = null;
-                                }
-                            }
-
-                            if (src_texture.path) |p| {
-                                const path_len = std.mem.len(p);
-                                const path_ptr = memory.cardinal_alloc(allocator, path_len + 1);
-                                if (path_ptr) |pp| {
-                                    @memcpy(@as([*]u8, @ptrCast(pp))[0..path_len], @as([*]const u8, @ptrCast(p))[0..path_len]);
-                                    @as([*]u8, @ptrCast(pp))[path_len] = 0;
-                                    dst_texture.path = @ptrCast(pp);
-                                } else {
-                                    dst_texture.path = null;
-                                }
-                            } else {
-                                dst_texture.path = null;
-                            }
-
-                            if (dst_texture.ref_resource == null and src_texture.ref_resource != null) {
-                                if (src_texture.width == 2 and src_texture.height == 2) {
-                                    if (src_texture.ref_resource.?.identifier) |id| {
-                                        if (ref_counting.cardinal_ref_acquire(id)) |acquired_res| {
-                                            dst_texture.ref_resource = acquired_res;
-                                            dst_texture.data = src_texture.data;
-                                        }
-                                    }
-                                }
-                            }
-
-                            if (dst_texture.ref_resource == null and src_texture.ref_resource != null) {
-                                model_log.warn("Texture copy failed to preserve ref_resource! Src: {*}, Dst: {*}", .{ src_texture.ref_resource, dst_texture.ref_resource });
-                            }
-                        }
-                    }
+/// Assigns stable slot ranges to `model` and copies its scene data into the combined arrays.
+///
+/// Mesh vertex/index data is shared, while materials/textures are copied so their indices can be
+/// re-based into the combined namespace.
+fn place_model(manager: *CardinalModelManager, state: *CombinedSceneState, model: *CardinalModelInstance) !void {
+    const out = &manager.combined_scene;
+    const scn = &model.scene;
+    const list_alloc = combined_list_allocator();
+
+    var range = std.mem.zeroes(CardinalCombinedRange);
+    range.mesh_count = if (scn.meshes != null) scn.mesh_count else 0;
+    range.material_count = if (scn.materials != null) scn.material_count else 0;
+    range.texture_count = if (scn.textures != null) scn.texture_count else 0;
+    range.node_count = if (scn.all_nodes != null) scn.all_node_count else 0;
+
+    range.mesh_first = try reserve_slots(scene.CardinalMesh, &state.meshes, &out.meshes, range.mesh_count);
+    errdefer state.meshes.release(list_alloc, range.mesh_first, range.mesh_count);
+    range.material_first = try reserve_slots(scene.CardinalMaterial, &state.materials, &out.materials, range.material_count);
+    errdefer state.materials.release(list_alloc, range.material_first, range.material_count);
+    range.texture_first = try reserve_slots(scene.CardinalTexture, &state.textures, &out.textures, range.texture_count);
+    errdefer state.textures.release(list_alloc, range.texture_first, range.texture_count);
+    range.node_first = try reserve_slots(?*scene.CardinalSceneNode, &state.nodes, &out.all_nodes, range.node_count);
 
-                    if (scn.all_nodes) |src_nodes| {
-                        @memcpy(manager.combined_scene.all_nodes.?[node_offset .. node_offset + scn.all_node_count], src_nodes[0..scn.all_node_count]);
-                    }
+    const allocator = memory.cardinal_get_allocator_for_category(.ASSETS);
 
-                    mesh_offset += scn.mesh_count;
-                    material_offset += scn.material_count;
-                    texture_offset += scn.texture_count;
-                    node_offset += scn.all_node_count;
-                }
+    var m: u32 = 0;
+    while (m < range.mesh_count) : (m += 1) {
+        const src_mesh = &scn.meshes.?[m];
+        const dst_mesh = &out.meshes.?[range.mesh_first + m];
 
-                manager.combined_scene.mesh_count = new_meshes;
-                manager.combined_scene.material_count = new_materials;
-                manager.combined_scene.texture_count = new_textures;
-                manager.combined_scene.all_node_count = new_nodes;
-                manager.scene_dirty = false;
-                return;
-            }
+        if (src_mesh.vertices == null or src_mesh.vertex_count == 0 or
+            src_mesh.indices == null or src_mesh.index_count == 0)
+        {
+            @memset(@as([*]u8, @ptrCast(dst_mesh))[0..@sizeOf(scene.CardinalMesh)], 0);
+            dst_mesh.visible = false;
+            continue;
         }
+
+        dst_mesh.* = src_mesh.*;
+        dst_mesh.material_index += range.material_first;
+        dst_mesh.visible = src_mesh.visible and model.visible;
+        transform_math.cardinal_matrix_multiply(&model.transform, &src_mesh.transform, &dst_mesh.transform);
     }
 
-    cleanup_combined_scene(manager);
+    var mat: u32 = 0;
+    while (mat < range.material_count) : (mat += 1) {
+        const dst_material = &out.materials.?[range.material_first + mat];
+        dst_material.* = scn.materials.?[mat];
 
-    const meshes_ptr = memory.cardinal_calloc(allocator, total_meshes, @sizeOf(scene.CardinalMesh));
-    if (meshes_ptr) |ptr| {
-        model_log.debug("Allocated combined meshes: {any} size {d}", .{ ptr, total_meshes * @sizeOf(scene.CardinalMesh) });
+        if (dst_material.albedo_texture.is_valid()) dst_material.albedo_texture.index += range.texture_first;
+        if (dst_material.normal_texture.is_valid()) dst_material.normal_texture.index += range.texture_first;
+        if (dst_material.metallic_roughness_texture.is_valid()) dst_material.metallic_roughness_texture.index += range.texture_first;
+        if (dst_material.ao_texture.is_valid()) dst_material.ao_texture.index += range.texture_first;
+        if (dst_material.emissive_texture.is_valid()) dst_material.emissive_texture.index += range.texture_first;
     }
-    const materials_ptr = memory.cardinal_calloc(allocator, total_materials, @sizeOf(scene.CardinalMaterial));
-    const textures_ptr = memory.cardinal_calloc(allocator, total_textures, @sizeOf(scene.CardinalTexture));
-    const nodes_ptr = memory.cardinal_calloc(allocator, total_nodes, @sizeOf(?*scene.CardinalSceneNode));
 
-    if (meshes_ptr == null or materials_ptr == null or textures_ptr == null or (total_nodes > 0 and nodes_ptr == null)) {
-        model_log.err("Failed to allocate memory for combined scene", .{});
-        if (meshes_ptr) |p| memory.cardinal_free(allocator, p);
-        if (materials_ptr) |p| memory.cardinal_free(allocator, p);
-        if (textures_ptr) |p| memory.cardinal_free(allocator, p);
-        if (nodes_ptr) |p| memory.cardinal_free(allocator, p);
-        return;
+    var tex: u32 = 0;
+    while (tex < range.texture_count) : (tex += 1) {
+        copy_combined_texture(allocator, &scn.textures.?[tex], &out.textures.?[range.texture_first + tex]);
     }
 
-    manager.combined_scene.meshes = @ptrCast(@alignCast(meshes_ptr));
-    manager.combined_scene.materials = @ptrCast(@alignCast(materials_ptr));
-    manager.combined_scene.textures = @ptrCast(@alignCast(textures_ptr));
-    manager.combined_scene.all_nodes = @ptrCast(@alignCast(nodes_ptr));
-    manager.combined_scene.all_node_count = total_nodes;
+    if (range.node_count > 0) {
+        @memcpy(out.all_nodes.?[range.node_first .. range.node_first + range.node_count], scn.all_nodes.?[0..range.node_count]);
+    }
+
+    range.resident = true;
+    range.applied_visible = model.visible;
+    model.combined = range;
+    create_model_morphs(manager, state, model);
+
+    record_dirty_range(state, .{
+        .first_mesh = range.mesh_first,
+        .mesh_count = range.mesh_count,
+        .change = .ADDED,
+        .first_material = range.material_first,
+        .material_count = range.material_count,
+        .first_texture = range.texture_first,
+        .texture_count = range.texture_count,
+    });
+    if (has_animation_data(scn)) state.animation_dirty = true;
+}
+
+fn create_morph_instance(allocator: std.mem.Allocator, mesh: *const scene.CardinalMesh, mesh_slot: u32, node_slot: u32) !*MorphInstance {
+    const instance = try allocator.create(MorphInstance);
+    errdefer allocator.destroy(instance);
+    instance.mesh_slot = mesh_slot;
+    instance.node_slot = node_slot;
+    instance.set = try morph_targets.MorphSet.build(allocator, mesh, .{});
+    errdefer instance.set.deinit(allocator);
+    instance.deformer = try morph_targets.MorphDeformer.init(allocator, &instance.set, mesh.vertices.?[0..mesh.vertex_count]);
+    return instance;
+}
+
+fn destroy_morph_instance(allocator: std.mem.Allocator, instance: *MorphInstance) void {
+    instance.deformer.deinit(allocator);
+    instance.set.deinit(allocator);
+    allocator.destroy(instance);
+}
+
+/// Creates a deformer for every morph-target mesh of a newly placed model and points its combined
+/// mesh at the deformed vertices, so full uploads and vertex range uploads see the same pose.
+///
+/// A mesh referenced by several nodes follows the first one.
+fn create_model_morphs(manager: *CardinalModelManager, state: *CombinedSceneState, model: *const CardinalModelInstance) void {
+    const scn = &model.scene;
+    const meshes = scn.meshes orelse return;
+    const nodes = scn.all_nodes orelse return;
+    const list_alloc = combined_list_allocator();
+
+    var n: u32 = 0;
+    while (n < @min(scn.all_node_count, model.combined.node_count)) : (n += 1) {
+        const node = nodes[n] orelse continue;
+        const mesh_indices = node.mesh_indices orelse continue;
+        for (mesh_indices[0..node.mesh_count]) |mesh_idx| {
+            if (mesh_idx >= model.combined.mesh_count) continue;
+            const mesh = &meshes[mesh_idx];
+            if (mesh.morph_targets == null or mesh.morph_target_count == 0) continue;
+
+            const mesh_slot = model.combined.mesh_first + mesh_idx;
+            const combined_mesh = &manager.combined_scene.meshes.?[mesh_slot];
+            if (combined_mesh.vertices == null or combined_mesh.vertices != mesh.vertices) continue;
+
+            const instance = create_morph_instance(list_alloc, mesh, mesh_slot, model.combined.node_first + n) catch {
+                model_log.warn("Failed to create morph deformer for mesh slot {d}; it stays in its base pose", .{mesh_slot});
+                continue;
+            };
+            state.morphs.append(list_alloc, instance) catch {
+                destroy_morph_instance(list_alloc, instance);
+                continue;
+            };
+            combined_mesh.vertices = instance.deformer.output.ptr;
+        }
+    }
+}
 
-    if (total_animations > 0 or total_skins > 0) {
-        manager.combined_scene.animation_system = @ptrCast(animation.cardinal_animation_system_create(total_animations, total_skins));
+/// Destroys the deformers of combined mesh slots in `[first, first + count)`.
+fn release_morphs(state: *CombinedSceneState, first: u32, count: u32) void {
+    const list_alloc = combined_list_allocator();
+    var i: usize = 0;
+    while (i < state.morphs.items.len) {
+        const instance = state.morphs.items[i];
+        if (instance.mesh_slot >= first and instance.mesh_slot - first < count) {
+            destroy_morph_instance(list_alloc, instance);
+            _ = state.morphs.swapRemove(i);
+        } else {
+            i += 1;
+        }
     }
+}
 
-    var mesh_offset: u32 = 0;
-    var material_offset: u32 = 0;
-    var texture_offset: u32 = 0;
-    var node_offset: u32 = 0;
+fn has_animation_data(scn: *const scene.CardinalScene) bool {
+    return scn.animation_system != null or scn.skin_count > 0;
+}
 
-    i = 0;
+/// Reports the mesh range of every resident animated model after the combined skins were rebuilt,
+/// so the renderer refreshes its skin bindings without re-uploading unrelated models.
+fn record_skinning_ranges(manager: *CardinalModelManager, state: *CombinedSceneState) void {
+    const models = manager.models orelse return;
+    var i: u32 = 0;
     while (i < manager.model_count) : (i += 1) {
         const model = &models[i];
-        if (!model.visible or model.is_loading) continue;
-
-        const scn = &model.scene;
+        if (!model.combined.resident or !has_animation_data(&model.scene)) continue;
+        record_dirty_range(state, .{ .first_mesh = model.combined.mesh_first, .mesh_count = model.combined.mesh_count, .change = .SKINNING });
+    }
+}
 
-        if (scn.meshes) |src_meshes| {
-            var m: u32 = 0;
-            while (m < scn.mesh_count) : (m += 1) {
-                const src_mesh = &src_meshes[m];
-                const dst_mesh = &manager.combined_scene.meshes.?[mesh_offset + m];
-
-                if (src_mesh.vertices == null or src_mesh.vertex_count == 0 or
-                    src_mesh.indices == null or src_mesh.index_count == 0)
-                {
-                    @memset(@as([*]u8, @ptrCast(dst_mesh))[0..@sizeOf(scene.CardinalMesh)], 0);
-                    dst_mesh.visible = false;
-                    continue;
-                }
+/// Clears a model's slots in the combined arrays and returns them to the free lists.
+fn release_model(manager: *CardinalModelManager, state: *CombinedSceneState, model: *CardinalModelInstance) void {
+    const range = model.combined;
+    if (!range.resident) return;
 
-                dst_mesh.* = src_mesh.*;
-                dst_mesh.material_index += material_offset;
+    const out = &manager.combined_scene;
+    const allocator = memory.cardinal_get_allocator_for_category(.ASSETS);
+    const list_alloc = combined_list_allocator();
 
-                transform_math.cardinal_matrix_multiply(&model.transform, &src_mesh.transform, &dst_mesh.transform);
-            }
-        }
+    if (range.mesh_count > 0) {
+        @memset(std.mem.sliceAsBytes(out.meshes.?[range.mesh_first .. range.mesh_first + range.mesh_count]), 0);
+    }
+    if (range.material_count > 0) {
+        @memset(std.mem.sliceAsBytes(out.materials.?[range.material_first .. range.material_first + range.material_count]), 0);
+    }
+    if (range.texture_count > 0) {
+        const texs = out.textures.?[range.texture_first .. range.texture_first + range.texture_count];
+        for (texs) |*t| release_combined_texture(allocator, t);
+        @memset(std.mem.sliceAsBytes(texs), 0);
+    }
+    if (range.node_count > 0) {
+        @memset(out.all_nodes.?[range.node_first .. range.node_first + range.node_count], null);
+    }
 
-        if (scn.materials) |src_materials| {
-            var mat: u32 = 0;
-            while (mat < scn.material_count) : (mat += 1) {
-                const src_material = &src_materials[mat];
-                const dst_material = &manager.combined_scene.materials.?[material_offset + mat];
+    release_morphs(state, range.mesh_first, range.mesh_count);
+    state.meshes.release(list_alloc, range.mesh_first, range.mesh_count);
+    state.materials.release(list_alloc, range.material_first, range.material_count);
+    state.textures.release(list_alloc, range.texture_first, range.texture_count);
+    state.nodes.release(list_alloc, range.node_first, range.node_count);
 
-                dst_material.* = src_material.*;
+    record_dirty_range(state, .{ .first_mesh = range.mesh_first, .mesh_count = range.mesh_count, .change = .REMOVED });
+    if (has_animation_data(&model.scene)) state.animation_dirty = true;
 
-                if (dst_material.albedo_texture.is_valid()) dst_material.albedo_texture.index += texture_offset;
-                if (dst_material.normal_texture.is_valid()) dst_material.normal_texture.index += texture_offset;
-                if (dst_material.metallic_roughness_texture.is_valid()) dst_material.metallic_roughness_texture.index += texture_offset;
-                if (dst_material.ao_texture.is_valid()) dst_material.ao_texture.index += texture_offset;
-                if (dst_material.emissive_texture.is_valid()) dst_material.emissive_texture.index += texture_offset;
-            }
-        }
+    model.combined = std.mem.zeroes(CardinalCombinedRange);
+}
 
-        if (scn.textures) |src_textures| {
-            var tex: u32 = 0;
-            while (tex < scn.texture_count) : (tex += 1) {
-                const src_texture = &src_textures[tex];
-                const dst_texture = &manager.combined_scene.textures.?[texture_offset + tex];
-
-                dst_texture.* = src_texture.*;
-
-                var used_ref_counting = false;
-                if (src_texture.ref_resource) |res| {
-                    _ = @atomicRmw(u32, &res.ref_count, .Add, 1, .seq_cst);
-                    dst_texture.ref_resource = res;
-
-                    if (res.resource) |r| {
-                        const tex_data = @as(*texture_loader.TextureData, @ptrCast(@alignCast(r)));
-                        dst_texture.data = tex_data.data;
-                        dst_texture.width = tex_data.width;
-                        dst_texture.height = tex_data.height;
-                        dst_texture.channels = tex_data.channels;
-                        dst_texture.is_hdr = tex_data.is_hdr;
-                        dst_texture.format = tex_data.format;
-                        dst_texture.data_size = tex_data.data_size;
-                    } else {
-                        dst_texture.data = src_texture.data;
-                    }
-                    used_ref_counting = true;
-                }
+/// Re-applies model visibility to the model's combined meshes.
+fn apply_model_visibility(manager: *CardinalModelManager, state: *CombinedSceneState, model: *CardinalModelInstance) void {
+    const range = model.combined;
+    model.combined.applied_visible = model.visible;
 
-                if (!used_ref_counting) {
-                    dst_texture.ref_resource = null;
-                    if (src_texture.data != null and src_texture.width > 0 and src_texture.height > 0) {
-                        const data_size = src_texture.width * src_texture.height * src_texture.channels;
-                        const data_ptr = memory.cardinal_alloc(allocator, data_size);
-                        if (data_ptr) |dp| {
-                            @memcpy(@as([*]u8, @ptrCast(dp))[0..data_size], @as([*]u8, @ptrCast(src_texture.data.?))[0..data_size]);
-                            dst_texture.data = @ptrCast(dp);
-                        } else {
-                            dst_texture.data = null;
-                        }
-                    } else {
-                        dst_texture.data = null;
-                    }
-                }
+    const src_meshes = model.scene.meshes orelse return;
+    const count = @min(range.mesh_count, model.scene.mesh_count);
 
-                if (src_texture.path) |p| {
-                    const path_len = std.mem.len(p);
-                    const path_ptr = memory.cardinal_alloc(allocator, path_len + 1);
-                    if (path_ptr) |pp| {
-                        @memcpy(@as([*]u8, @ptrCast(pp))[0..path_len], @as([*]const u8, @ptrCast(p))[0..path_len]);
-                        @as([*]u8, @ptrCast(pp))[path_len] = 0;
-                        dst_texture.path = @ptrCast(pp);
-                    } else {
-                        dst_texture.path = null;
-                    }
-                } else {
-                    dst_texture.path = null;
-                }
+    var m: u32 = 0;
+    while (m < count) : (m += 1) {
+        const src_mesh = &src_meshes[m];
+        const dst_mesh = &manager.combined_scene.meshes.?[range.mesh_first + m];
+        const valid = src_mesh.vertices != null and src_mesh.vertex_count > 0 and
+            src_mesh.indices != null and src_mesh.index_count > 0;
+        dst_mesh.visible = valid and src_mesh.visible and model.visible;
+    }
 
-                if (dst_texture.ref_resource == null and src_texture.ref_resource != null) {
-                    if (src_texture.width == 2 and src_texture.height == 2) {
-                        if (src_texture.ref_resource.?.identifier) |id| {
-                            if (ref_counting.cardinal_ref_acquire(id)) |acquired_res| {
-                                dst_texture.ref_resource = acquired_res;
-                                dst_texture.data = src_texture.data;
-                            }
-                        }
-                    }
-                }
+    record_dirty_range(state, .{ .first_mesh = range.mesh_first, .mesh_count = range.mesh_count, .change = .VISIBILITY });
+}
 
-                if (dst_texture.ref_resource == null and src_texture.ref_resource != null) {
-                    model_log.warn("Texture copy failed to preserve ref_resource! Src: {*}, Dst: {*}", .{ src_texture.ref_resource, dst_texture.ref_resource });
-                }
-            }
-        }
+/// Rebuilds the combined animation system and skins from every resident model.
+///
+/// Channel node indices and skin mesh/bone indices are re-based with each model's stable ranges,
+/// so mesh, material and texture slots are left untouched.
+fn rebuild_combined_animation(manager: *CardinalModelManager) void {
+    cleanup_combined_animation(manager);
 
-        if (scn.all_nodes) |src_nodes| {
-            @memcpy(manager.combined_scene.all_nodes.?[node_offset .. node_offset + scn.all_node_count], src_nodes[0..scn.all_node_count]);
-        }
+    const models = manager.models orelse return;
+    const allocator = memory.cardinal_get_allocator_for_category(.ASSETS);
 
-        if (scn.root_nodes) |src_roots| {
-            if (manager.combined_scene.root_nodes) |dst_roots| {
-                @memcpy(dst_roots[manager.combined_scene.root_node_count .. manager.combined_scene.root_node_count + scn.root_node_count], src_roots[0..scn.root_node_count]);
-                manager.combined_scene.root_node_count += scn.root_node_count;
-            }
+    var total_animations: u32 = 0;
+    var total_skins: u32 = 0;
+    var i: u32 = 0;
+    while (i < manager.model_count) : (i += 1) {
+        const model = &models[i];
+        if (!model.combined.resident) continue;
+        if (model.scene.animation_system) |sys_opaque| {
+            const sys = @as(*animation.CardinalAnimationSystem, @ptrCast(@alignCast(sys_opaque)));
+            total_animations += sys.animation_count;
+            total_skins += sys.skin_count;
         }
+    }
 
-        if (scn.animation_system != null and manager.combined_scene.animation_system != null) {
-            const src_sys = @as(*animation.CardinalAnimationSystem, @ptrCast(@alignCast(scn.animation_system.?)));
-            const dst_sys = @as(*animation.CardinalAnimationSystem, @ptrCast(@alignCast(manager.combined_scene.animation_system.?)));
-
-            var anim_idx: u32 = 0;
-            while (anim_idx < src_sys.animation_count) : (anim_idx += 1) {
-                var anim = src_sys.animations.?[anim_idx];
-
-                if (anim.channel_count > 0) {
-                    const channels_ptr = memory.cardinal_alloc(allocator, anim.channel_count * @sizeOf(animation.CardinalAnimationChannel));
-                    if (channels_ptr) |cp| {
-                        const channels = @as([*]animation.CardinalAnimationChannel, @ptrCast(@alignCast(cp)));
-                        @memcpy(channels[0..anim.channel_count], anim.channels.?[0..anim.channel_count]);
+    if (total_animations == 0 and total_skins == 0) return;
 
-                        var c_idx: u32 = 0;
-                        while (c_idx < anim.channel_count) : (c_idx += 1) {
-                            channels[c_idx].target.node_index += node_offset;
-                        }
+    const dst_sys = animation.cardinal_animation_system_create(total_animations, total_skins) orelse {
+        model_log.err("Failed to create combined animation system", .{});
+        return;
+    };
+    manager.combined_scene.animation_system = @ptrCast(dst_sys);
 
-                        anim.channels = channels;
-                        _ = animation.cardinal_animation_system_add_animation(dst_sys, &anim);
-                        memory.cardinal_free(allocator, cp);
-                    } else {
-                        _ = animation.cardinal_animation_system_add_animation(dst_sys, &anim);
+    i = 0;
+    while (i < manager.model_count) : (i += 1) {
+        const model = &models[i];
+        if (!model.combined.resident) continue;
+        const src_opaque = model.scene.animation_system orelse continue;
+        const src_sys = @as(*animation.CardinalAnimationSystem, @ptrCast(@alignCast(src_opaque)));
+        const node_offset = model.combined.node_first;
+        const mesh_offset = model.combined.mesh_first;
+
+        var anim_idx: u32 = 0;
+        while (anim_idx < src_sys.animation_count) : (anim_idx += 1) {
+            var anim = src_sys.animations.?[anim_idx];
+
+            if (anim.channel_count > 0) {
+                const channels_ptr = memory.cardinal_alloc(allocator, anim.channel_count * @sizeOf(animation.CardinalAnimationChannel));
+                if (channels_ptr) |cp| {
+                    const channels = @as([*]animation.CardinalAnimationChannel, @ptrCast(@alignCast(cp)));
+                    @memcpy(channels[0..anim.channel_count], anim.channels.?[0..anim.channel_count]);
+
+                    var c_idx: u32 = 0;
+                    while (c_idx < anim.channel_count) : (c_idx += 1) {
+                        channels[c_idx].target.node_index += node_offset;
                     }
+
+                    anim.channels = channels;
+                    _ = animation.cardinal_animation_system_add_animation(dst_sys, &anim);
+                    memory.cardinal_free(allocator, cp);
                 } else {
                     _ = animation.cardinal_animation_system_add_animation(dst_sys, &anim);
                 }
+            } else {
+                _ = animation.cardinal_animation_system_add_animation(dst_sys, &anim);
             }
+        }
 
-            var skin_idx: u32 = 0;
-            while (skin_idx < src_sys.skin_count) : (skin_idx += 1) {
-                var skin = src_sys.skins.?[skin_idx];
+        var skin_idx: u32 = 0;
+        while (skin_idx < src_sys.skin_count) : (skin_idx += 1) {
+            var skin = src_sys.skins.?[skin_idx];
 
-                var new_mesh_indices: ?[*]u32 = null;
-                var new_bones: ?[*]animation.CardinalBone = null;
+            var new_mesh_indices: ?[*]u32 = null;
+            var new_bones: ?[*]animation.CardinalBone = null;
 
-                if (skin.mesh_count > 0 and skin.mesh_indices != null) {
-                    const mi_ptr = memory.cardinal_alloc(allocator, skin.mesh_count * @sizeOf(u32));
-                    if (mi_ptr) |mip| {
-                        new_mesh_indices = @ptrCast(@alignCast(mip));
-                        @memcpy(new_mesh_indices.?[0..skin.mesh_count], skin.mesh_indices.?[0..skin.mesh_count]);
+            if (skin.mesh_count > 0 and skin.mesh_indices != null) {
+                const mi_ptr = memory.cardinal_alloc(allocator, skin.mesh_count * @sizeOf(u32));
+                if (mi_ptr) |mip| {
+                    new_mesh_indices = @ptrCast(@alignCast(mip));
+                    @memcpy(new_mesh_indices.?[0..skin.mesh_count], skin.mesh_indices.?[0..skin.mesh_count]);
 
-                        var m: u32 = 0;
-                        while (m < skin.mesh_count) : (m += 1) {
-                            new_mesh_indices.?[m] += mesh_offset;
-                        }
-                        skin.mesh_indices = new_mesh_indices;
+                    var m: u32 = 0;
+                    while (m < skin.mesh_count) : (m += 1) {
+                        new_mesh_indices.?[m] += mesh_offset;
                     }
+                    skin.mesh_indices = new_mesh_indices;
                 }
+            }
 
-                if (skin.bone_count > 0 and skin.bones != null) {
-                    const b_ptr = memory.cardinal_alloc(allocator, skin.bone_count * @sizeOf(animation.CardinalBone));
-                    if (b_ptr) |bp| {
-                        new_bones = @ptrCast(@alignCast(bp));
-                        @memcpy(new_bones.?[0..skin.bone_count], skin.bones.?[0..skin.bone_count]);
+            if (skin.bone_count > 0 and skin.bones != null) {
+                const b_ptr = memory.cardinal_alloc(allocator, skin.bone_count * @sizeOf(animation.CardinalBone));
+                if (b_ptr) |bp| {
+                    new_bones = @ptrCast(@alignCast(bp));
+                    @memcpy(new_bones.?[0..skin.bone_count], skin.bones.?[0..skin.bone_count]);
 
-                        var b: u32 = 0;
-                        while (b < skin.bone_count) : (b += 1) {
-                            new_bones.?[b].node_index += node_offset;
-                        }
-                        skin.bones = new_bones;
+                    var b: u32 = 0;
+                    while (b < skin.bone_count) : (b += 1) {
+                        new_bones.?[b].node_index += node_offset;
                     }
+                    skin.bones = new_bones;
                 }
+            }
 
-                _ = animation.cardinal_animation_system_add_skin(dst_sys, &skin);
+            _ = animation.cardinal_animation_system_add_skin(dst_sys, &skin);
 
-                if (new_mesh_indices) |ptr| memory.cardinal_free(allocator, ptr);
-                if (new_bones) |ptr| memory.cardinal_free(allocator, ptr);
-            }
+            if (new_mesh_indices) |ptr| memory.cardinal_free(allocator, ptr);
+            if (new_bones) |ptr| memory.cardinal_free(allocator, ptr);
         }
-
-        mesh_offset += scn.mesh_count;
-        material_offset += scn.material_count;
-        texture_offset += scn.texture_count;
-        node_offset += scn.all_node_count;
     }
 
-    manager.combined_scene.mesh_count = total_meshes;
-    manager.combined_scene.material_count = total_materials;
-    manager.combined_scene.texture_count = total_textures;
-    manager.combined_scene.skin_count = total_skins;
-    if (manager.combined_scene.animation_system) |sys_opaque| {
-        const sys = @as(*animation.CardinalAnimationSystem, @ptrCast(@alignCast(sys_opaque)));
-        if (sys.skin_count > 0) {
-            const skins_ptr = memory.cardinal_calloc(allocator, sys.skin_count, @sizeOf(animation.CardinalSkin));
-            if (skins_ptr) |sp| {
-                const dst_skins = @as([*]animation.CardinalSkin, @ptrCast(@alignCast(sp)));
-
-                var skin_copy_idx: u32 = 0;
-                while (skin_copy_idx < sys.skin_count) : (skin_copy_idx += 1) {
-                    const src_skin = &sys.skins.?[skin_copy_idx];
-                    const dst_skin = &dst_skins[skin_copy_idx];
-
-                    dst_skin.* = src_skin.*;
-
-                    if (src_skin.name) |n| {
-                        const len = std.mem.len(n);
-                        const n_ptr = memory.cardinal_alloc(allocator, len + 1);
-                        if (n_ptr) |np| {
-                            @memcpy(@as([*]u8, @ptrCast(np))[0..len], @as([*]const u8, @ptrCast(n))[0..len]);
-                            @as([*]u8, @ptrCast(np))[len] = 0;
-                            dst_skin.name = @ptrCast(np);
-                        } else {
-                            dst_skin.name = null;
-                        }
-                    } else {
-                        dst_skin.name = null;
-                    }
+    if (dst_sys.skin_count == 0) return;
 
-                    if (src_skin.bone_count > 0 and src_skin.bones != null) {
-                        const bones_ptr = memory.cardinal_alloc(allocator, src_skin.bone_count * @sizeOf(animation.CardinalBone));
-                        if (bones_ptr) |bp| {
-                            dst_skin.bones = @ptrCast(@alignCast(bp));
-                            @memcpy(dst_skin.bones.?[0..src_skin.bone_count], src_skin.bones.?[0..src_skin.bone_count]);
-
-                            var b: u32 = 0;
-                            while (b < src_skin.bone_count) : (b += 1) {
-                                const src_bone = &src_skin.bones.?[b];
-                                const dst_bone = &dst_skin.bones.?[b];
-
-                                if (src_bone.name) |bn| {
-                                    const blen = std.mem.len(bn);
-                                    const bn_ptr = memory.cardinal_alloc(allocator, blen + 1);
-                                    if (bn_ptr) |bnp| {
-                                        @memcpy(@as([*]u8, @ptrCast(bnp))[0..blen], @as([*]const u8, @ptrCast(bn))[0..blen]);
-                                        @as([*]u8, @ptrCast(bnp))[blen] = 0;
-                                        dst_bone.name = @ptrCast(bnp);
-                                    } else {
-                                        dst_bone.name = null;
-                                    }
-                                } else {
-                                    dst_bone.name = null;
-                                }
-                            }
-                        } else {
-                            dst_skin.bones = null;
-                            dst_skin.bone_count = 0;
-                        }
-                    } else {
-                        dst_skin.bones = null;
-                        dst_skin.bone_count = 0;
-                    }
+    const skins_ptr = memory.cardinal_calloc(allocator, dst_sys.skin_count, @sizeOf(animation.CardinalSkin)) orelse return;
+    const dst_skins = @as([*]animation.CardinalSkin, @ptrCast(@alignCast(skins_ptr)));
 
-                    if (src_skin.mesh_count > 0 and src_skin.mesh_indices != null) {
-                        const mi_ptr = memory.cardinal_alloc(allocator, src_skin.mesh_count * @sizeOf(u32));
-                        if (mi_ptr) |mip| {
-                            dst_skin.mesh_indices = @ptrCast(@alignCast(mip));
-                            @memcpy(dst_skin.mesh_indices.?[0..src_skin.mesh_count], src_skin.mesh_indices.?[0..src_skin.mesh_count]);
+    var skin_copy_idx: u32 = 0;
+    while (skin_copy_idx < dst_sys.skin_count) : (skin_copy_idx += 1) {
+        const src_skin = &dst_sys.skins.?[skin_copy_idx];
+        const dst_skin = &dst_skins[skin_copy_idx];
+
+        dst_skin.* = src_skin.*;
+
+        if (src_skin.name) |n| {
+            const len = std.mem.len(n);
+            const n_ptr = memory.cardinal_alloc(allocator, len + 1);
+            if (n_ptr) |np| {
+                @memcpy(@as([*]u8, @ptrCast(np))[0..len], @as([*]const u8, @ptrCast(n))[0..len]);
+                @as([*]u8, @ptrCast(np))[len] = 0;
+                dst_skin.name = @ptrCast(np);
+            } else {
+                dst_skin.name = null;
+            }
+        } else {
+            dst_skin.name = null;
+        }
+
+        dst_skin.bones = null;
+        if (src_skin.bone_count > 0 and src_skin.bones != null) {
+            const bones_ptr = memory.cardinal_alloc(allocator, src_skin.bone_count * @sizeOf(animation.CardinalBone));
+            if (bones_ptr) |bp| {
+                dst_skin.bones = @ptrCast(@alignCast(bp));
+                @memcpy(dst_skin.bones.?[0..src_skin.bone_count], src_skin.bones.?[0..src_skin.bone_count]);
+
+                var b: u32 = 0;
+                while (b < src_skin.bone_count) : (b += 1) {
+                    const src_bone = &src_skin.bones.?[b];
+                    const dst_bone = &dst_skin.bones.?[b];
+
+                    if (src_bone.name) |bn| {
+                        const blen = std.mem.len(bn);
+                        const bn_ptr = memory.cardinal_alloc(allocator, blen + 1);
+                        if (bn_ptr) |bnp| {
+                            @memcpy(@as([*]u8, @ptrCast(bnp))[0..blen], @as([*]const u8, @ptrCast(bn))[0..blen]);
+                            @as([*]u8, @ptrCast(bnp))[blen] = 0;
+                            dst_bone.name = @ptrCast(bnp);
                         } else {
-                            dst_skin.mesh_indices = null;
-                            dst_skin.mesh_count = 0;
+                            dst_bone.name = null;
                         }
                     } else {
-                        dst_skin.mesh_indices = null;
-                        dst_skin.mesh_count = 0;
+                        dst_bone.name = null;
                     }
                 }
+            }
+        }
+        if (dst_skin.bones == null) dst_skin.bone_count = 0;
+
+        dst_skin.mesh_indices = null;
+        if (src_skin.mesh_count > 0 and src_skin.mesh_indices != null) {
+            const mi_ptr = memory.cardinal_alloc(allocator, src_skin.mesh_count * @sizeOf(u32));
+            if (mi_ptr) |mip| {
+                dst_skin.mesh_indices = @ptrCast(@alignCast(mip));
+                @memcpy(dst_skin.mesh_indices.?[0..src_skin.mesh_count], src_skin.mesh_indices.?[0..src_skin.mesh_count]);
+            }
+        }
+        if (dst_skin.mesh_indices == null) dst_skin.mesh_count = 0;
+    }
 
-                manager.combined_scene.skins = @ptrCast(dst_skins);
-                manager.combined_scene.skin_count = sys.skin_count;
-            } else {
-                manager.combined_scene.skins = null;
-                manager.combined_scene.skin_count = 0;
+    manager.combined_scene.skins = @ptrCast(dst_skins);
+    manager.combined_scene.skin_count = dst_sys.skin_count;
+}
+
+/// Brings `manager.combined_scene` up to date with the model list.
+///
+/// Every model owns stable slot ranges in the combined arrays. Newly loaded models are placed into
+/// free ranges and visibility changes only touch the model's own meshes, so both cost O(model size);
+/// removal releases its ranges eagerly in `cardinal_model_manager_remove_model`. Animation data is
+/// the only part re-concatenated, and only when an animated model enters or leaves; the animated
+/// models' ranges are then reported as `SKINNING` rather than forcing a full upload.
+fn sync_combined_scene(manager: *CardinalModelManager) void {
+    const state = get_combined_state(manager) orelse return;
+
+    if (state.rebuild_all) {
+        cleanup_combined_scene(manager);
+        state.rebuild_all = false;
+    }
+
+    if (manager.models) |models| {
+        var i: u32 = 0;
+        while (i < manager.model_count) : (i += 1) {
+            const model = &models[i];
+            if (model.is_loading) continue;
+
+            if (!model.combined.resident) {
+                place_model(manager, state, model) catch {
+                    model_log.err("Failed to place model {d} into the combined scene", .{model.id});
+                };
+            } else if (model.combined.applied_visible != model.visible) {
+                apply_model_visibility(manager, state, model);
             }
-        } else {
-            manager.combined_scene.skins = null;
-            manager.combined_scene.skin_count = 0;
         }
     }
 
+    if (state.animation_dirty) {
+        rebuild_combined_animation(manager);
+        state.animation_dirty = false;
+        record_skinning_ranges(manager, state);
+    }
+
+    manager.combined_scene.mesh_count = state.meshes.high_water;
+    manager.combined_scene.material_count = state.materials.high_water;
+    manager.combined_scene.texture_count = state.textures.high_water;
+    manager.combined_scene.all_node_count = state.nodes.high_water;
     manager.scene_dirty = false;
 
-    model_log.debug("Rebuilt combined scene: {d} meshes, {d} materials, {d} textures, {d} nodes, {d} anims", .{ total_meshes, total_materials, total_textures, total_nodes, total_animations });
+    model_log.debug("Synced combined scene: {d} mesh slots, {d} material slots, {d} texture slots, {d} node slots, {d} changed ranges", .{ state.meshes.high_water, state.materials.high_water, state.textures.high_water, state.nodes.high_water, state.dirty_ranges.items.len });
 }
 
 fn update_combined_mesh_transforms(manager: *CardinalModelManager) void {
     if (manager.combined_scene.meshes == null) return;
     const models = manager.models orelse return;
 
-    var mesh_offset: u32 = 0;
     var i: u32 = 0;
     while (i < manager.model_count) : (i += 1) {
         const model = &models[i];
-        if (!model.visible or model.is_loading) continue;
+        if (!model.combined.resident) continue;
 
         const scn = &model.scene;
-        if (scn.mesh_count == 0 or scn.meshes == null) continue;
+        if (scn.meshes == null) continue;
 
+        const count = @min(model.combined.mesh_count, scn.mesh_count);
         var m: u32 = 0;
-        while (m < scn.mesh_count) : (m += 1) {
+        while (m < count) : (m += 1) {
             const src_mesh = &scn.meshes.?[m];
-            const dst_mesh = &manager.combined_scene.meshes.?[mesh_offset + m];
+            const dst_mesh = &manager.combined_scene.meshes.?[model.combined.mesh_first + m];
             transform_math.cardinal_matrix_multiply(&model.transform, &src_mesh.transform, &dst_mesh.transform);
         }
-
-        mesh_offset += scn.mesh_count;
     }
 }
 
@@ -910,7 +1056,9 @@ pub export fn cardinal_model_manager_destroy(manager: ?*CardinalModelManager) ca
         memory.cardinal_free(allocator, models);
     }
 
+    mgr.model_count = 0;
     cleanup_combined_scene(mgr);
+    destroy_combined_state(mgr);
 
     @memset(@as([*]u8, @ptrCast(mgr))[0..@sizeOf(CardinalModelManager)], 0);
     model_log.debug("Model manager destroyed", .{});
@@ -1112,6 +1260,10 @@ pub export fn cardinal_model_manager_remove_model(manager: ?*CardinalModelManage
     const model_name_str = if (model.name) |n| n else "Unnamed";
     model_log.info("Removing model '{s}' (ID: {d})", .{ model_name_str, model_id });
 
+    if (model.combined.resident) {
+        if (get_combined_state(mgr)) |state| release_model(mgr, state, model);
+    }
+
     const allocator = memory.cardinal_get_allocator_for_category(.ASSETS);
     if (model.name) |n| memory.cardinal_free(allocator, @ptrCast(n));
     if (model.file_path) |p| memory.cardinal_free(allocator, @ptrCast(p));
@@ -1178,6 +1330,8 @@ pub export fn cardinal_model_manager_get_transform(manager: ?*CardinalModelManag
 }
 
 /// Sets the model visibility and marks the combined scene dirty when changed.
+///
+/// The next combined-scene query only rewrites this model's mesh visibility flags.
 pub export fn cardinal_model_manager_set_visible(manager: ?*CardinalModelManager, model_id: u32, visible: bool) callconv(.c) bool {
     if (manager == null) return false;
     const model = cardinal_model_manager_get_model(manager, model_id);
@@ -1213,9 +1367,10 @@ pub export fn cardinal_model_manager_get_combined_scene(manager: ?*CardinalModel
     const mgr = manager.?;
 
     if (mgr.scene_dirty) {
-        rebuild_combined_scene(mgr);
+        sync_combined_scene(mgr);
         mgr.scene_dirty = false;
-    } else if (mgr.transform_dirty) {
+    }
+    if (mgr.transform_dirty) {
         update_combined_mesh_transforms(mgr);
         mgr.transform_dirty = false;
     }
@@ -1223,9 +1378,86 @@ pub export fn cardinal_model_manager_get_combined_scene(manager: ?*CardinalModel
     return &mgr.combined_scene;
 }
 
-/// Forces the combined scene to be rebuilt on the next query.
+/// Forces the combined scene to be rebuilt from scratch on the next query.
+///
+/// All slot ranges are discarded and reassigned, so previously reported mesh indices become invalid.
 pub export fn cardinal_model_manager_mark_dirty(manager: ?*CardinalModelManager) callconv(.c) void {
-    if (manager) |mgr| mgr.scene_dirty = true;
+    const mgr = manager orelse return;
+    mgr.scene_dirty = true;
+    if (get_combined_state(mgr)) |state| state.rebuild_all = true;
+}
+
+/// Returns the combined-scene slot ranges of a model, or null if it is not resident yet.
+pub export fn cardinal_model_manager_get_combined_range(manager: ?*CardinalModelManager, model_id: u32) callconv(.c) ?*const CardinalCombinedRange {
+    const model = cardinal_model_manager_get_model(manager, model_id) orelse return null;
+    if (!model.combined.resident) return null;
+    return &model.combined;
+}
+
+/// Copies up to `max_ranges` changed mesh ranges into `out_ranges`.
+///
+/// Returns the total number of ranges recorded since the last
+/// `cardinal_model_manager_clear_dirty_ranges`, which may exceed `max_ranges`.
+pub export fn cardinal_model_manager_get_dirty_ranges(manager: ?*CardinalModelManager, out_ranges: ?[*]scene.CardinalSceneDirtyRange, max_ranges: u32) callconv(.c) u32 {
+    const mgr = manager orelse return 0;
+    const ptr = mgr.combined_state orelse return 0;
+    const state: *const CombinedSceneState = @ptrCast(@alignCast(ptr));
+
+    const total: u32 = @intCast(state.dirty_ranges.items.len);
+    if (out_ranges) |out| {
+        const n = @min(total, max_ranges);
+        @memcpy(out[0..n], state.dirty_ranges.items[0..n]);
+    }
+    return total;
+}
+
+/// Returns true when recorded changes include new GPU data and need a full scene upload.
+pub export fn cardinal_model_manager_needs_full_upload(manager: ?*const CardinalModelManager) callconv(.c) bool {
+    const mgr = manager orelse return false;
+    const ptr = mgr.combined_state orelse return mgr.combined_scene.mesh_count > 0;
+    const state: *const CombinedSceneState = @ptrCast(@alignCast(ptr));
+    return state.full_upload;
+}
+
+/// Forgets recorded changes once the renderer has consumed them.
+pub export fn cardinal_model_manager_clear_dirty_ranges(manager: ?*CardinalModelManager) callconv(.c) void {
+    const mgr = manager orelse return;
+    const ptr = mgr.combined_state orelse return;
+    const state: *CombinedSceneState = @ptrCast(@alignCast(ptr));
+    state.dirty_ranges.clearRetainingCapacity();
+    state.full_upload = false;
+}
+
+/// Samples morph weights from the combined animation system and re-deforms the morph-target
+/// meshes whose weights changed.
+///
+/// Each changed mesh is recorded as a `VERTICES` dirty range covering only the rewritten vertices,
+/// so the renderer uploads that slice instead of the scene. Call after
+/// `cardinal_animation_system_update`; returns the number of ranges recorded.
+pub export fn cardinal_model_manager_update_morphs(manager: ?*CardinalModelManager) callconv(.c) u32 {
+    const mgr = manager orelse return 0;
+    const ptr = mgr.combined_state orelse return 0;
+    const state: *CombinedSceneState = @ptrCast(@alignCast(ptr));
+    const sys_opaque = mgr.combined_scene.animation_system orelse return 0;
+    const sys = @as(*animation.CardinalAnimationSystem, @ptrCast(@alignCast(sys_opaque)));
+
+    var recorded: u32 = 0;
+    for (state.morphs.items) |instance| {
+        if (!instance.deformer.sample_weights(sys, instance.node_slot)) continue;
+        instance.deformer.evaluate();
+        const dirty = instance.deformer.dirty;
+        if (dirty.is_empty()) continue;
+
+        record_dirty_range(state, .{
+            .first_mesh = instance.mesh_slot,
+            .mesh_count = 1,
+            .change = .VERTICES,
+            .first_vertex = dirty.first,
+            .vertex_count = dirty.count(),
+        });
+        recorded += 1;
+    }
+    return recorded;
 }
 
 /// Advances async load tasks and finalizes completed loads.
@@ -1339,3 +1571,199 @@ pub export fn cardinal_model_manager_clear(manager: ?*CardinalModelManager) call
 
     cleanup_combined_scene(mgr);
 }
+
+fn make_test_scene(mesh_count: u32) !scene.CardinalScene {
+    const allocator = memory.cardinal_get_allocator_for_category(.ASSETS);
+    var scn = std.mem.zeroes(scene.CardinalScene);
+
+    const meshes: [*]scene.CardinalMesh = @ptrCast(@alignCast(memory.cardinal_calloc(allocator, mesh_count, @sizeOf(scene.CardinalMesh)) orelse return error.OutOfMemory));
+    var m: u32 = 0;
+    while (m < mesh_count) : (m += 1) {
+        const verts: [*]scene.CardinalVertex = @ptrCast(@alignCast(memory.cardinal_calloc(allocator, 3, @sizeOf(scene.CardinalVertex)) orelse return error.OutOfMemory));
+        const indices: [*]u32 = @ptrCast(@alignCast(memory.cardinal_calloc(allocator, 3, @sizeOf(u32)) orelse return error.OutOfMemory));
+        indices[1] = 1;
+        indices[2] = 2;
+        meshes[m].vertices = verts;
+        meshes[m].vertex_count = 3;
+        meshes[m].indices = indices;
+        meshes[m].index_count = 3;
+        meshes[m].visible = true;
+        transform_math.cardinal_matrix_identity(&meshes[m].transform);
+    }
+
+    scn.meshes = meshes;
+    scn.mesh_count = mesh_count;
+    return scn;
+}
+
+test "combined scene keeps stable model ranges and reports changed ranges" {
+    memory.cardinal_memory_init(64 * 1024);
+    defer memory.cardinal_memory_shutdown();
+
+    var mgr: CardinalModelManager = undefined;
+    try std.testing.expect(cardinal_model_manager_init(&mgr));
+    defer cardinal_model_manager_destroy(&mgr);
+
+    var ids: [3]u32 = undefined;
+    for (&ids, [_]u32{ 2, 3, 4 }) |*id, count| {
+        var scn = try make_test_scene(count);
+        id.* = cardinal_model_manager_add_scene(&mgr, &scn, null, null);
+        try std.testing.expect(id.* != 0);
+    }
+
+    const combined = cardinal_model_manager_get_combined_scene(&mgr) orelse return error.TestUnexpectedResult;
+    try std.testing.expectEqual(@as(u32, 9), combined.mesh_count);
+    try std.testing.expect(cardinal_model_manager_needs_full_upload(&mgr));
+
+    const middle = cardinal_model_manager_get_combined_range(&mgr, ids[1]) orelse return error.TestUnexpectedResult;
+    const middle_first = middle.mesh_first;
+    const last_first = cardinal_model_manager_get_combined_range(&mgr, ids[2]).?.mesh_first;
+    cardinal_model_manager_clear_dirty_ranges(&mgr);
+
+    // Removing a model releases only its own slots; later models keep their indices.
+    try std.testing.expect(cardinal_model_manager_remove_model(&mgr, ids[1]));
+    _ = cardinal_model_manager_get_combined_scene(&mgr);
+    try std.testing.expectEqual(@as(u32, 9), mgr.combined_scene.mesh_count);
+    try std.testing.expectEqual(last_first, cardinal_model_manager_get_combined_range(&mgr, ids[2]).?.mesh_first);
+    try std.testing.expect(!mgr.combined_scene.meshes.?[middle_first].visible);
+    try std.testing.expect(!cardinal_model_manager_needs_full_upload(&mgr));
+
+    var ranges: [4]scene.CardinalSceneDirtyRange = undefined;
+    try std.testing.expectEqual(@as(u32, 1), cardinal_model_manager_get_dirty_ranges(&mgr, &ranges, ranges.len));
+    try std.testing.expectEqual(scene.CardinalSceneChange.REMOVED, ranges[0].change);
+    try std.testing.expectEqual(middle_first, ranges[0].first_mesh);
+    cardinal_model_manager_clear_dirty_ranges(&mgr);
+
+    // Hiding a model only patches its mesh visibility.
+    try std.testing.expect(cardinal_model_manager_set_visible(&mgr, ids[0], false));
+    _ = cardinal_model_manager_get_combined_scene(&mgr);
+    try std.testing.expectEqual(@as(u32, 1), cardinal_model_manager_get_dirty_ranges(&mgr, &ranges, ranges.len));
+    try std.testing.expectEqual(scene.CardinalSceneChange.VISIBILITY, ranges[0].change);
+    try std.testing.expect(!cardinal_model_manager_needs_full_upload(&mgr));
+    cardinal_model_manager_clear_dirty_ranges(&mgr);
+
+    // A smaller model reuses the freed range instead of growing the arrays.
+    var small = try make_test_scene(2);
+    const small_id = cardinal_model_manager_add_scene(&mgr, &small, null, null);
+    _ = cardinal_model_manager_get_combined_scene(&mgr);
+    const small_range = cardinal_model_manager_get_combined_range(&mgr, small_id).?;
+    try std.testing.expectEqual(middle_first, small_range.mesh_first);
+    try std.testing.expectEqual(@as(u32, 9), mgr.combined_scene.mesh_count);
+
+    // Only the new model's slots are reported; nothing else needs uploading.
+    try std.testing.expect(!cardinal_model_manager_needs_full_upload(&mgr));
+    try std.testing.expectEqual(@as(u32, 1), cardinal_model_manager_get_dirty_ranges(&mgr, &ranges, ranges.len));
+    try std.testing.expectEqual(scene.CardinalSceneChange.ADDED, ranges[0].change);
+    try std.testing.expectEqual(middle_first, ranges[0].first_mesh);
+    try std.testing.expectEqual(@as(u32, 2), ranges[0].mesh_count);
+    try std.testing.expectEqual(small_range.material_first, ranges[0].first_material);
+    try std.testing.expectEqual(small_range.material_count, ranges[0].material_count);
+}
+
+test "animated models entering or leaving report skinning ranges" {
+    memory.cardinal_memory_init(64 * 1024);
+    defer memory.cardinal_memory_shutdown();
+
+    var mgr: CardinalModelManager = undefined;
+    try std.testing.expect(cardinal_model_manager_init(&mgr));
+    defer cardinal_model_manager_destroy(&mgr);
+
+    var plain = try make_test_scene(2);
+    const plain_id = cardinal_model_manager_add_scene(&mgr, &plain, null, null);
+    var animated = try make_test_scene(2);
+    animated.animation_system = @ptrCast(animation.cardinal_animation_system_create(0, 0) orelse return error.OutOfMemory);
+    const animated_id = cardinal_model_manager_add_scene(&mgr, &animated, null, null);
+    var kept = try make_test_scene(3);
+    kept.animation_system = @ptrCast(animation.cardinal_animation_system_create(0, 0) orelse return error.OutOfMemory);
+    const kept_id = cardinal_model_manager_add_scene(&mgr, &kept, null, null);
+    _ = cardinal_model_manager_get_combined_scene(&mgr);
+    cardinal_model_manager_clear_dirty_ranges(&mgr);
+
+    // A plain model leaves through a range patch and leaves the skins alone.
+    var ranges: [4]scene.CardinalSceneDirtyRange = undefined;
+    try std.testing.expect(cardinal_model_manager_remove_model(&mgr, plain_id));
+    _ = cardinal_model_manager_get_combined_scene(&mgr);
+    try std.testing.expect(!cardinal_model_manager_needs_full_upload(&mgr));
+    try std.testing.expectEqual(@as(u32, 1), cardinal_model_manager_get_dirty_ranges(&mgr, &ranges, ranges.len));
+    cardinal_model_manager_clear_dirty_ranges(&mgr);
+
+    // An animated model leaving marks only the remaining animated model's meshes for a skin refresh.
+    try std.testing.expect(cardinal_model_manager_remove_model(&mgr, animated_id));
+    _ = cardinal_model_manager_get_combined_scene(&mgr);
+    try std.testing.expect(!cardinal_model_manager_needs_full_upload(&mgr));
+    try std.testing.expectEqual(@as(u32, 2), cardinal_model_manager_get_dirty_ranges(&mgr, &ranges, ranges.len));
+    try std.testing.expectEqual(scene.CardinalSceneChange.REMOVED, ranges[0].change);
+    try std.testing.expectEqual(scene.CardinalSceneChange.SKINNING, ranges[1].change);
+    const kept_range = cardinal_model_manager_get_combined_range(&mgr, kept_id).?;
+    try std.testing.expectEqual(kept_range.mesh_first, ranges[1].first_mesh);
+    try std.testing.expectEqual(kept_range.mesh_count, ranges[1].mesh_count);
+}
+
+test "morph weights are uploaded as vertex ranges of the deformed mesh" {
+    memory.cardinal_memory_init(1024 * 1024);
+    defer memory.cardinal_memory_shutdown();
+    const allocator = memory.cardinal_get_allocator_for_category(.ASSETS);
+
+    var mgr: CardinalModelManager = undefined;
+    try std.testing.expect(cardinal_model_manager_init(&mgr));
+    defer cardinal_model_manager_destroy(&mgr);
+
+    // One target that only moves the last vertex of the model's second mesh.
+    var deltas = [_]f32{ 0, 0, 0, 0, 0, 0, 0, 2, 0 };
+    var target = scene.CardinalMorphTarget{ .positions = &deltas, .normals = null, .tangents = null };
+    var scn = try make_test_scene(2);
+    scn.meshes.?[1].morph_targets = @ptrCast(&target);
+    scn.meshes.?[1].morph_target_count = 1;
+
+    // The node is not a root, so destroying the scene frees `all_nodes` but leaves the node alone.
+    var mesh_indices = [_]u32{1};
+    var node = std.mem.zeroes(scene.CardinalSceneNode);
+    node.mesh_indices = &mesh_indices;
+    node.mesh_count = 1;
+    const all_nodes: [*]?*scene.CardinalSceneNode = @ptrCast(@alignCast(memory.cardinal_alloc(allocator, @sizeOf(?*scene.CardinalSceneNode)) orelse return error.OutOfMemory));
+    all_nodes[0] = &node;
+    scn.all_nodes = all_nodes;
+    scn.all_node_count = 1;
+    const base_vertices = scn.meshes.?[1].vertices.?;
+
+    const system = animation.cardinal_animation_system_create(1, 0) orelse return error.OutOfMemory;
+    var times = [_]f32{ 0.0, 1.0 };
+    var values = [_]f32{ 0.0, 1.0 };
+    var sampler = animation.CardinalAnimationSampler{ .input = &times, .output = &values, .input_count = 2, .output_count = values.len, .interpolation = .LINEAR, .last_index = 0 };
+    var channel = animation.CardinalAnimationChannel{ .sampler_index = 0, .target = .{ .node_index = 0, .path = .WEIGHTS } };
+    const anim = std.mem.zeroInit(animation.CardinalAnimation, .{ .samplers = @as(?[*]animation.CardinalAnimationSampler, @ptrCast(&sampler)), .sampler_count = 1, .channels = @as(?[*]animation.CardinalAnimationChannel, @ptrCast(&channel)), .channel_count = 1, .duration = 1.0 });
+    _ = animation.cardinal_animation_system_add_animation(system, &anim);
+    scn.animation_system = @ptrCast(system);
+
+    var plain = try make_test_scene(3);
+    _ = cardinal_model_manager_add_scene(&mgr, &plain, null, null);
+    const id = cardinal_model_manager_add_scene(&mgr, &scn, null, null);
+    const combined = cardinal_model_manager_get_combined_scene(&mgr) orelse return error.TestUnexpectedResult;
+    const range = cardinal_model_manager_get_combined_range(&mgr, id).?;
+    const mesh_slot = range.mesh_first + 1;
+    cardinal_model_manager_clear_dirty_ranges(&mgr);
+
+    // Nothing plays yet, so nothing is deformed or reported.
+    try std.testing.expectEqual(@as(u32, 0), cardinal_model_manager_update_morphs(&mgr));
+
+    const combined_sys: *animation.CardinalAnimationSystem = @ptrCast(@alignCast(combined.animation_system.?));
+    try std.testing.expect(animation.cardinal_animation_play(combined_sys, 0, false, 1.0));
+    combined_sys.states.?[0].current_time = 0.5;
+
+    try std.testing.expectEqual(@as(u32, 1), cardinal_model_manager_update_morphs(&mgr));
+    var ranges: [4]scene.CardinalSceneDirtyRange = undefined;
+    try std.testing.expectEqual(@as(u32, 1), cardinal_model_manager_get_dirty_ranges(&mgr, &ranges, ranges.len));
+    try std.testing.expectEqual(scene.CardinalSceneChange.VERTICES, ranges[0].change);
+    try std.testing.expectEqual(mesh_slot, ranges[0].first_mesh);
+    try std.testing.expectEqual(@as(u32, 2), ranges[0].first_vertex);
+    try std.testing.expectEqual(@as(u32, 1), ranges[0].vertex_count);
+    try std.testing.expect(!cardinal_model_manager_needs_full_upload(&mgr));
+
+    // The combined mesh carries the deformed pose; the model's own vertices stay untouched.
+    try std.testing.expectApproxEqAbs(@as(f32, 1.0), combined.meshes.?[mesh_slot].vertices.?[2].py, 1e-4);
+    try std.testing.expectEqual(@as(f32, 0.0), base_vertices[2].py);
+    cardinal_model_manager_clear_dirty_ranges(&mgr);
+
+    // Unchanged weights record nothing.
+    try std.testing.expectEqual(@as(u32, 0), cardinal_model_manager_update_morphs(&mgr));
+}
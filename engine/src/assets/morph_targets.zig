@@ -0,0 +1,475 @@
+//! CPU morph-target (blend shape) deformation.
+//!
+//! glTF stores every morph target as dense per-vertex delta arrays, but facial rigs usually move
+//! a small, localized set of vertices per target. `MorphSet.build` converts a mesh's targets once
+//! into sparse streams of (vertex index, delta) pairs, quantizing a stream to 16-bit integers
+//! when the rounding error stays within tolerance. Each frame `MorphDeformer.evaluate` skips
+//! targets whose weight is zero, accumulates the active ones four lanes at a time, and rewrites
+//! only the vertex range touched this frame or the previous one; that range is reported in
+//! `dirty` so uploads can be limited to the changed vertices.
+//!
+//! Weights come from the caller or from the animation system's WEIGHTS channels through
+//! `sample_animation_weights`. The model manager keeps one deformer per resident morph-target
+//! mesh and reports its `dirty` range for upload. Tangent deltas are ignored because
+//! `CardinalVertex` carries no tangent, and deformed normals are not renormalized.
+const std = @import("std");
+const scene = @import("scene.zig");
+const animation = @import("animation.zig");
+const sampling = @import("animation_sampling.zig");
+
+const Vec4 = @Vector(4, f32);
+const QVec4 = @Vector(4, i16);
+
+/// Largest number of targets a single WEIGHTS channel may drive.
+pub const MAX_SAMPLED_TARGETS: usize = 256;
+
+pub const BuildOptions = struct {
+    /// Deltas whose components are all at or below this magnitude are dropped.
+    zero_epsilon: f32 = 1e-6,
+    /// Maximum quantization error accepted for position deltas, in object units.
+    position_tolerance: f32 = 1e-4,
+    /// Maximum quantization error accepted for normal deltas.
+    normal_tolerance: f32 = 1e-3,
+};
+
+/// Half-open range of vertices.
+pub const VertexRange = struct {
+    first: u32 = 0,
+    end: u32 = 0,
+
+    pub fn is_empty(self: VertexRange) bool {
+        return self.end <= self.first;
+    }
+
+    pub fn count(self: VertexRange) u32 {
+        return if (self.is_empty()) 0 else self.end - self.first;
+    }
+
+    pub fn merge(self: VertexRange, other: VertexRange) VertexRange {
+        if (self.is_empty()) return other;
+        if (other.is_empty()) return self;
+        return .{ .first = @min(self.first, other.first), .end = @max(self.end, other.end) };
+    }
+
+    /// Byte offset of the range inside a `CardinalVertex` buffer.
+    pub fn byte_offset(self: VertexRange) usize {
+        return @as(usize, self.first) * @sizeOf(scene.CardinalVertex);
+    }
+
+    /// Byte size of the range inside a `CardinalVertex` buffer.
+    pub fn byte_size(self: VertexRange) usize {
+        return @as(usize, self.count()) * @sizeOf(scene.CardinalVertex);
+    }
+};
+
+/// Sparse deltas of one attribute of one target.
+pub const DeltaStream = struct {
+    /// Ascending indices of vertices with a non-zero delta.
+    indices: []const u32 = &.{},
+    /// Full-precision deltas (xyz, w = 0); used when quantization would exceed tolerance.
+    deltas: []const Vec4 = &.{},
+    /// Quantized deltas; multiply by `scale` to recover object units.
+    quantized: []const QVec4 = &.{},
+    scale: f32 = 0.0,
+    /// Vertices covered by `indices`.
+    range: VertexRange = .{},
+
+    pub fn is_quantized(self: *const DeltaStream) bool {
+        return self.quantized.len > 0;
+    }
+
+    fn deinit(self: *const DeltaStream, allocator: std.mem.Allocator) void {
+        allocator.free(self.indices);
+        allocator.free(self.deltas);
+        allocator.free(self.quantized);
+    }
+
+    fn build(allocator: std.mem.Allocator, dense: ?[*]const f32, vertex_count: u32, zero_epsilon: f32, tolerance: f32) !DeltaStream {
+        const src = (dense orelse return .{})[0 .. @as(usize, vertex_count) * 3];
+
+        var nonzero: usize = 0;
+        var max_abs: f32 = 0.0;
+        for (0..vertex_count) |v| {
+            const m = @max(@abs(src[v * 3]), @max(@abs(src[v * 3 + 1]), @abs(src[v * 3 + 2])));
+            if (m <= zero_epsilon) continue;
+            nonzero += 1;
+            max_abs = @max(max_abs, m);
+        }
+        if (nonzero == 0) return .{};
+
+        var stream = DeltaStream{};
+        errdefer stream.deinit(allocator);
+
+        const indices = try allocator.alloc(u32, nonzero);
+        stream.indices = indices;
+
+        // Rounding to the nearest step is off by at most half a step.
+        const step = max_abs / 32767.0;
+        const quantize = step * 0.5 <= tolerance;
+        var qdeltas: []QVec4 = undefined;
+        var fdeltas: []Vec4 = undefined;
+        if (quantize) {
+            qdeltas = try allocator.alloc(QVec4, nonzero);
+            stream.quantized = qdeltas;
+            stream.scale = step;
+        } else {
+            fdeltas = try allocator.alloc(Vec4, nonzero);
+            stream.deltas = fdeltas;
+        }
+
+        var n: usize = 0;
+        for (0..vertex_count) |v| {
+            const d = Vec4{ src[v * 3], src[v * 3 + 1], src[v * 3 + 2], 0.0 };
+            if (@reduce(.Max, @abs(d)) <= zero_epsilon) continue;
+            indices[n] = @intCast(v);
+            if (quantize) {
+                const q = @round(d / @as(Vec4, @splat(step)));
+                qdeltas[n] = @intFromFloat(@max(@as(Vec4, @splat(-32767.0)), @min(q, @as(Vec4, @splat(32767.0)))));
+            } else {
+                fdeltas[n] = d;
+            }
+            n += 1;
+        }
+
+        stream.range = .{ .first = indices[0], .end = indices[nonzero - 1] + 1 };
+        return stream;
+    }
+
+    /// Adds `weight * delta` for every stored vertex into `accum`.
+    fn accumulate(self: *const DeltaStream, weight: f32, accum: []Vec4) void {
+        if (self.is_quantized()) {
+            const w: Vec4 = @splat(weight * self.scale);
+            for (self.indices, self.quantized) |v, q| {
+                accum[v] += @as(Vec4, @floatFromInt(q)) * w;
+            }
+        } else {
+            const w: Vec4 = @splat(weight);
+            for (self.indices, self.deltas) |v, d| {
+                accum[v] += d * w;
+            }
+        }
+    }
+
+    fn byte_size(self: *const DeltaStream) usize {
+        return self.indices.len * @sizeOf(u32) + self.deltas.len * @sizeOf(Vec4) + self.quantized.len * @sizeOf(QVec4);
+    }
+};
+
+/// Sparse form of one morph target.
+pub const SparseTarget = struct {
+    positions: DeltaStream = .{},
+    normals: DeltaStream = .{},
+
+    /// Vertices this target moves.
+    pub fn range(self: *const SparseTarget) VertexRange {
+        return self.positions.range.merge(self.normals.range);
+    }
+};
+
+/// Sparse morph targets of one mesh; shared by every instance of that mesh.
+pub const MorphSet = struct {
+    targets: []const SparseTarget = &.{},
+    vertex_count: u32 = 0,
+
+    /// Converts the dense targets of `mesh` into sparse streams.
+    pub fn build(allocator: std.mem.Allocator, mesh: *const scene.CardinalMesh, options: BuildOptions) !MorphSet {
+        if (mesh.morph_targets == null or mesh.morph_target_count == 0) return .{ .vertex_count = mesh.vertex_count };
+
+        const targets = try allocator.alloc(SparseTarget, mesh.morph_target_count);
+        for (targets) |*t| t.* = .{};
+        var set = MorphSet{ .targets = targets, .vertex_count = mesh.vertex_count };
+        errdefer set.deinit(allocator);
+
+        for (targets, mesh.morph_targets.?[0..mesh.morph_target_count]) |*dst, src| {
+            dst.positions = try DeltaStream.build(allocator, src.positions, mesh.vertex_count, options.zero_epsilon, options.position_tolerance);
+            dst.normals = try DeltaStream.build(allocator, src.normals, mesh.vertex_count, options.zero_epsilon, options.normal_tolerance);
+        }
+        return set;
+    }
+
+    pub fn deinit(self: *MorphSet, allocator: std.mem.Allocator) void {
+        for (self.targets) |*t| {
+            t.positions.deinit(allocator);
+            t.normals.deinit(allocator);
+        }
+        allocator.free(self.targets);
+        self.* = .{};
+    }
+
+    /// Bytes held by the sparse streams.
+    pub fn byte_size(self: *const MorphSet) usize {
+        var total: usize = 0;
+        for (self.targets) |*t| total += t.positions.byte_size() + t.normals.byte_size();
+        return total;
+    }
+};
+
+/// Per-instance deformation state: current weights and the deformed vertex buffer.
+pub const MorphDeformer = struct {
+    set: *const MorphSet,
+    base: []const scene.CardinalVertex,
+    /// Deformed vertices. Only `dirty` changed during the last `evaluate`.
+    output: []scene.CardinalVertex,
+    /// Target weights; write these (or call `sample_weights`) before `evaluate`.
+    weights: []f32,
+    /// Vertices rewritten by the last `evaluate`; empty when nothing changed.
+    dirty: VertexRange = .{},
+
+    applied_weights: []f32,
+    /// Vertices moved by the previous evaluation; they must be restored even if no target
+    /// touches them any more.
+    deformed: VertexRange = .{},
+    accum_positions: []Vec4,
+    accum_normals: []Vec4,
+
+    /// Creates a deformer whose output starts as a copy of `base` with all weights at zero.
+    pub fn init(allocator: std.mem.Allocator, set: *const MorphSet, base: []const scene.CardinalVertex) !MorphDeformer {
+        std.debug.assert(base.len == set.vertex_count);
+
+        const output = try allocator.dupe(scene.CardinalVertex, base);
+        errdefer allocator.free(output);
+        const weights = try allocator.alloc(f32, set.targets.len);
+        errdefer allocator.free(weights);
+        const applied = try allocator.alloc(f32, set.targets.len);
+        errdefer allocator.free(applied);
+        const accum_positions = try allocator.alloc(Vec4, base.len);
+        errdefer allocator.free(accum_positions);
+        const accum_normals = try allocator.alloc(Vec4, base.len);
+
+        @memset(weights, 0.0);
+        @memset(applied, 0.0);
+        return .{
+            .set = set,
+            .base = base,
+            .output = output,
+            .weights = weights,
+            .applied_weights = applied,
+            .accum_positions = accum_positions,
+            .accum_normals = accum_normals,
+        };
+    }
+
+    pub fn deinit(self: *MorphDeformer, allocator: std.mem.Allocator) void {
+        allocator.free(self.output);
+        allocator.free(self.weights);
+        allocator.free(self.applied_weights);
+        allocator.free(self.accum_positions);
+        allocator.free(self.accum_normals);
+    }
+
+    /// Pulls `weights` from the WEIGHTS channels targeting `node_index`. Returns false and
+    /// leaves the weights unchanged when no playing clip animates that node.
+    pub fn sample_weights(self: *MorphDeformer, system: *animation.CardinalAnimationSystem, node_index: u32) bool {
+        return sample_animation_weights(system, node_index, self.weights);
+    }
+
+    /// Applies the current weights to `output` and updates `dirty`.
+    pub fn evaluate(self: *MorphDeformer) void {
+        if (std.mem.eql(f32, self.weights, self.applied_weights)) {
+            self.dirty = .{};
+            return;
+        }
+
+        var active = VertexRange{};
+        for (self.set.targets, self.weights) |*t, w| {
+            if (w != 0.0) active = active.merge(t.range());
+        }
+        const write = active.merge(self.deformed);
+
+        if (!write.is_empty()) {
+            @memset(self.accum_positions[write.first..write.end], @splat(0.0));
+            @memset(self.accum_normals[write.first..write.end], @splat(0.0));
+
+            for (self.set.targets, self.weights) |*t, w| {
+                if (w == 0.0) continue;
+                t.positions.accumulate(w, self.accum_positions);
+                t.normals.accumulate(w, self.accum_normals);
+            }
+
+            for (self.base[write.first..write.end], self.output[write.first..write.end], self.accum_positions[write.first..write.end], self.accum_normals[write.first..write.end]) |b, *o, dp, dn| {
+                o.px = b.px + dp[0];
+                o.py = b.py + dp[1];
+                o.pz = b.pz + dp[2];
+                o.nx = b.nx + dn[0];
+                o.ny = b.ny + dn[1];
+                o.nz = b.nz + dn[2];
+            }
+        }
+
+        @memcpy(self.applied_weights, self.weights);
+        self.deformed = active;
+        self.dirty = write;
+    }
+};
+
+/// Blends the WEIGHTS channels of every playing clip that targets `node_index` into `out`,
+/// weighting each clip by its blend weight and bone mask like the pose blend does.
+///
+/// Returns false (leaving `out` untouched) when no channel contributed. Extra targets in the
+/// curve beyond `out.len` are ignored; targets the curve does not cover keep their value.
+pub fn sample_animation_weights(system: *animation.CardinalAnimationSystem, node_index: u32, out: []f32) bool {
+    const states = system.states orelse return false;
+    const animations = system.animations orelse return false;
+
+    var sum: [MAX_SAMPLED_TARGETS]f32 = undefined;
+    var total_weight: f32 = 0.0;
+    var covered: usize = 0;
+    const limit = @min(out.len, MAX_SAMPLED_TARGETS);
+    @memset(sum[0..limit], 0.0);
+
+    for (states[0..system.state_count]) |*state| {
+        if (!state.is_playing or state.animation_index >= system.animation_count) continue;
+        var weight = state.blend_weight;
+        if (state.mask_weights != null and node_index < state.mask_count) weight *= state.mask_weights.?[node_index];
+        if (weight <= 0.001) continue;
+
+        const anim = &animations[state.animation_index];
+        const channels = anim.channels orelse continue;
+        const samplers = anim.samplers orelse continue;
+        for (channels[0..anim.channel_count]) |channel| {
+            if (channel.target.path != .WEIGHTS or channel.target.node_index != node_index) continue;
+            if (channel.sampler_index >= anim.sampler_count) continue;
+            const sampler = &samplers[channel.sampler_index];
+            if (sampler.input == null or sampler.output == null or sampler.input_count == 0) continue;
+
+            // Cubic-spline outputs store an in-tangent, value and out-tangent per key.
+            const values_per_key: u32 = if (sampler.interpolation == .CUBICSPLINE) sampler.input_count * 3 else sampler.input_count;
+            const target_count = sampler.output_count / values_per_key;
+            if (target_count == 0 or target_count > MAX_SAMPLED_TARGETS) continue;
+
+            var values: [MAX_SAMPLED_TARGETS]f32 = undefined;
+            const interp: u32 = @intCast(@intFromEnum(sampler.interpolation));
+            if (!sampling.interpolate_scalars_cached(interp, state.current_time, sampler.input.?, sampler.output.?, sampler.input_count, target_count, &sampler.last_index, &values)) continue;
+
+            const n = @min(target_count, limit);
+            for (sum[0..n], values[0..n]) |*s, v| s.* += v * weight;
+            covered = @max(covered, n);
+            total_weight += weight;
+        }
+    }
+
+    if (total_weight <= 0.0) return false;
+    const inv = 1.0 / total_weight;
+    for (out[0..covered], sum[0..covered]) |*o, s| o.* = s * inv;
+    return true;
+}
+
+const TestMesh = struct {
+    const VERTEX_COUNT = 64;
+    const TARGET_COUNT = 4;
+
+    vertices: [VERTEX_COUNT]scene.CardinalVertex = undefined,
+    positions: [TARGET_COUNT][VERTEX_COUNT * 3]f32 = undefined,
+    normals: [TARGET_COUNT][VERTEX_COUNT * 3]f32 = undefined,
+    targets: [TARGET_COUNT]scene.CardinalMorphTarget = undefined,
+    mesh: scene.CardinalMesh = undefined,
+
+    /// Target t moves vertices [t * 12, t * 12 + 10); target 3 has large deltas so its
+    /// positions stay unquantized.
+    fn init(self: *TestMesh) void {
+        for (&self.vertices, 0..) |*v, i| {
+            v.* = std.mem.zeroes(scene.CardinalVertex);
+            v.px = @floatFromInt(i);
+            v.ny = 1.0;
+        }
+        for (0..TARGET_COUNT) |t| {
+            @memset(&self.positions[t], 0.0);
+            @memset(&self.normals[t], 0.0);
+            const magnitude: f32 = if (t == 3) 100.0 else 0.5;
+            for (t * 12..t * 12 + 10) |v| {
+                const f: f32 = @floatFromInt(v);
+                self.positions[t][v * 3 + 0] = @sin(f) * magnitude;
+                self.positions[t][v * 3 + 1] = @cos(f * 0.7) * magnitude;
+                self.positions[t][v * 3 + 2] = 0.25 * magnitude;
+                self.normals[t][v * 3 + 0] = 0.1 * @cos(f);
+            }
+            self.targets[t] = .{ .positions = &self.positions[t], .normals = &self.normals[t], .tangents = null };
+        }
+        self.mesh = std.mem.zeroes(scene.CardinalMesh);
+        self.mesh.vertices = &self.vertices;
+        self.mesh.vertex_count = VERTEX_COUNT;
+        self.mesh.morph_targets = &self.targets;
+        self.mesh.morph_target_count = TARGET_COUNT;
+    }
+
+    fn expect_matches_dense(self: *const TestMesh, deformer: *const MorphDeformer) !void {
+        for (0..VERTEX_COUNT) |v| {
+            var p = [3]f32{ self.vertices[v].px, self.vertices[v].py, self.vertices[v].pz };
+            var nx = self.vertices[v].nx;
+            for (0..TARGET_COUNT) |t| {
+                const w = deformer.weights[t];
+                for (0..3) |k| p[k] += self.positions[t][v * 3 + k] * w;
+                nx += self.normals[t][v * 3] * w;
+            }
+            const o = deformer.output[v];
+            try std.testing.expectApproxEqAbs(p[0], o.px, 1e-3);
+            try std.testing.expectApproxEqAbs(p[1], o.py, 1e-3);
+            try std.testing.expectApproxEqAbs(p[2], o.pz, 1e-3);
+            try std.testing.expectApproxEqAbs(nx, o.nx, 1e-3);
+        }
+    }
+};
+
+test "sparse morph evaluation matches the dense reference and tracks dirty ranges" {
+    const allocator = std.testing.allocator;
+    var data: TestMesh = undefined;
+    data.init();
+
+    var set = try MorphSet.build(allocator, &data.mesh, .{});
+    defer set.deinit(allocator);
+    try std.testing.expectEqual(@as(usize, 10), set.targets[0].positions.indices.len);
+    try std.testing.expect(set.targets[0].positions.is_quantized());
+    try std.testing.expect(!set.targets[3].positions.is_quantized());
+
+    var deformer = try MorphDeformer.init(allocator, &set, &data.vertices);
+    defer deformer.deinit(allocator);
+
+    deformer.weights[0] = 0.75;
+    deformer.weights[3] = -0.3;
+    deformer.evaluate();
+    try data.expect_matches_dense(&deformer);
+    try std.testing.expectEqual(@as(u32, 0), deformer.dirty.first);
+    try std.testing.expectEqual(@as(u32, 46), deformer.dirty.end);
+
+    // Unchanged weights leave nothing to upload.
+    deformer.evaluate();
+    try std.testing.expect(deformer.dirty.is_empty());
+
+    // Dropping target 3 must still rewrite its vertices back to the base pose.
+    deformer.weights[0] = 0.2;
+    deformer.weights[1] = 1.0;
+    deformer.weights[3] = 0.0;
+    deformer.evaluate();
+    try data.expect_matches_dense(&deformer);
+    try std.testing.expectEqual(@as(u32, 46), deformer.dirty.end);
+    try std.testing.expectEqual(@as(u32, 22), deformer.deformed.end);
+    try std.testing.expectEqual(@as(usize, 46 * @sizeOf(scene.CardinalVertex)), deformer.dirty.byte_size());
+}
+
+test "morph weights are sampled from animation WEIGHTS channels" {
+    const memory = @import("../core/memory.zig");
+    memory.cardinal_memory_init(1024 * 1024);
+    defer memory.cardinal_memory_shutdown();
+
+    const system = animation.cardinal_animation_system_create(1, 0) orelse return error.OutOfMemory;
+    defer animation.cardinal_animation_system_destroy(system);
+
+    var times = [_]f32{ 0.0, 1.0 };
+    var values = [_]f32{ 0.0, 0.0, 0.0, 0.0, 1.0, 0.5, 0.0, 0.25 };
+    var sampler = animation.CardinalAnimationSampler{ .input = &times, .output = &values, .input_count = 2, .output_count = values.len, .interpolation = .LINEAR, .last_index = 0 };
+    var channel = animation.CardinalAnimationChannel{ .sampler_index = 0, .target = .{ .node_index = 2, .path = .WEIGHTS } };
+    const anim = std.mem.zeroInit(animation.CardinalAnimation, .{ .samplers = @as(?[*]animation.CardinalAnimationSampler, @ptrCast(&sampler)), .sampler_count = 1, .channels = @as(?[*]animation.CardinalAnimationChannel, @ptrCast(&channel)), .channel_count = 1, .duration = 1.0 });
+    _ = animation.cardinal_animation_system_add_animation(system, &anim);
+    try std.testing.expect(animation.cardinal_animation_play(system, 0, false, 1.0));
+    system.states.?[0].current_time = 0.5;
+
+    var weights = [_]f32{ 9.0, 9.0, 9.0, 9.0, 9.0 };
+    try std.testing.expect(!sample_animation_weights(system, 1, &weights));
+    try std.testing.expect(sample_animation_weights(system, 2, &weights));
+    // Four weights form a valid quaternion-sized output but must be lerped, not slerped.
+    try std.testing.expectApproxEqAbs(@as(f32, 0.5), weights[0], 1e-5);
+    try std.testing.expectApproxEqAbs(@as(f32, 0.25), weights[1], 1e-5);
+    try std.testing.expectApproxEqAbs(@as(f32, 0.0), weights[2], 1e-5);
+    try std.testing.expectApproxEqAbs(@as(f32, 0.125), weights[3], 1e-5);
+    try std.testing.expectEqual(@as(f32, 9.0), weights[4]);
+}
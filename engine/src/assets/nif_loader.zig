@@ -14,6 +14,7 @@ const asset_manager = @import("asset_manager.zig");
 const resource_state = @import("../core/resource_state.zig");
 const handles = @import("../core/handles.zig");
 const ref_counting = @import("../core/ref_counting.zig");
+const vfs = @import("../core/vfs.zig");
 const builtin = @import("builtin");
 const nif_schema = @import("nif_schema.zig");
 const nif_paths = @import("nif_paths.zig");
@@ -1662,18 +1663,13 @@ pub export fn cardinal_nif_merge_kf(path: [*:0]const u8, out_scene: *scene.Cardi
     const assets_allocator = memory.cardinal_get_allocator_for_category(.ASSETS);
     const assets_alloc = memory.cardinal_get_allocator_for_category(.ASSETS).as_allocator();
 
-    var file = std.fs.cwd().openFile(file_path, .{}) catch |err| {
+    var file_data = vfs.read_file(assets_alloc, file_path) catch |err| {
         nif_log.err("Failed to open KF file: {s} ({})", .{ file_path, err });
         return false;
     };
-    defer file.close();
+    defer file_data.deinit();
 
-    const file_size = file.getEndPos() catch 0;
-    const buffer = assets_alloc.alloc(u8, file_size) catch return false;
-    defer assets_alloc.free(buffer);
-    _ = file.readAll(buffer) catch return false;
-
-    var reader = NifReader.init(assets_alloc, buffer);
+    var reader = NifReader.init(assets_alloc, file_data.bytes);
     defer reader.deinit();
 
     reader.parse_header() catch |err| {
@@ -1708,18 +1704,13 @@ pub export fn cardinal_nif_load_scene(path: [*:0]const u8, out_scene: *scene.Car
     var success = false;
     errdefer if (!success) scene.cardinal_scene_destroy(out_scene);
 
-    var file = std.fs.cwd().openFile(file_path, .{}) catch |err| {
+    var file_data = vfs.read_file(assets_alloc, file_path) catch |err| {
         nif_log.err("Failed to open file: {s} ({})", .{ file_path, err });
         return false;
     };
-    defer file.close();
-
-    const file_size = file.getEndPos() catch 0;
-    const buffer = assets_alloc.alloc(u8, file_size) catch return false;
-    defer assets_alloc.free(buffer);
-    _ = file.readAll(buffer) catch return false;
+    defer file_data.deinit();
 
-    var reader = NifReader.init(assets_alloc, buffer);
+    var reader = NifReader.init(assets_alloc, file_data.bytes);
     defer reader.deinit();
 
     reader.parse_header() catch |err| {
@@ -0,0 +1,1022 @@
+//! Two-level acceleration structure for picking meshes.
+//!
+//! The bottom level is a triangle BVH per mesh (`MeshBvh`) in mesh-local space. Builds run on
+//! job-system workers from a snapshot of the mesh's positions and indices, so `PickScene.prefetch`
+//! can start them long before the first pick without racing edits to the live mesh. Traversal
+//! reads the live vertices, and after an edit only the nodes overlapping the edited region are
+//! refit (`PickScene.refit_region`); nothing is rebuilt.
+//!
+//! The top level is a `math.BVH` over instance world bounds. Rays and frustums walk it first and
+//! only visit the meshes whose bounds they reach, nearest first. When one instance's bounds change,
+//! its leaf and the path to the root are refit in place. Instances are indexed by mesh index, as in
+//! the combined scene, where every mesh has exactly one world transform.
+const std = @import("std");
+const math = @import("../core/math.zig");
+const scene = @import("scene.zig");
+const job_system = @import("../core/job_system.zig");
+
+/// Triangles per bottom-level leaf.
+pub const LEAF_TRIANGLES: u32 = 8;
+/// Background builds `PickScene.prefetch` keeps in flight by default.
+pub const DEFAULT_MAX_BUILDS_IN_FLIGHT: u32 = 16;
+
+/// A refit region covering every point, for refitting a whole mesh.
+pub const everywhere = math.AABB{
+    .min = .{ .x = -std.math.floatMax(f32), .y = -std.math.floatMax(f32), .z = -std.math.floatMax(f32) },
+    .max = .{ .x = std.math.floatMax(f32), .y = std.math.floatMax(f32), .z = std.math.floatMax(f32) },
+};
+
+const NONE = std.math.maxInt(u32);
+const TRAVERSAL_STACK = 64;
+
+fn empty_aabb() math.AABB {
+    return .{ .min = everywhere.max, .max = everywhere.min };
+}
+
+fn merge(a: math.AABB, b: math.AABB) math.AABB {
+    return .{
+        .min = .{ .x = @min(a.min.x, b.min.x), .y = @min(a.min.y, b.min.y), .z = @min(a.min.z, b.min.z) },
+        .max = .{ .x = @max(a.max.x, b.max.x), .y = @max(a.max.y, b.max.y), .z = @max(a.max.z, b.max.z) },
+    };
+}
+
+fn grow(box: *math.AABB, p: math.Vec3) void {
+    box.min = .{ .x = @min(box.min.x, p.x), .y = @min(box.min.y, p.y), .z = @min(box.min.z, p.z) };
+    box.max = .{ .x = @max(box.max.x, p.x), .y = @max(box.max.y, p.y), .z = @max(box.max.z, p.z) };
+}
+
+fn overlaps(a: math.AABB, b: math.AABB) bool {
+    return a.min.x <= b.max.x and a.max.x >= b.min.x and
+        a.min.y <= b.max.y and a.max.y >= b.min.y and
+        a.min.z <= b.max.z and a.max.z >= b.min.z;
+}
+
+fn vertex_position(verts: [*]const scene.CardinalVertex, index: u32) math.Vec3 {
+    return .{ .x = verts[index].px, .y = verts[index].py, .z = verts[index].pz };
+}
+
+fn has_geometry(mesh: *const scene.CardinalMesh) bool {
+    return mesh.vertices != null and mesh.indices != null and mesh.index_count >= 3;
+}
+
+/// Ray with its reciprocal direction, for slab tests against many boxes.
+const RayBox = struct {
+    origin: math.Vec3,
+    inv_dir: math.Vec3,
+
+    fn init(ray: math.Ray) RayBox {
+        return .{
+            .origin = ray.origin,
+            .inv_dir = .{ .x = 1.0 / ray.direction.x, .y = 1.0 / ray.direction.y, .z = 1.0 / ray.direction.z },
+        };
+    }
+
+    /// Where the ray enters `box`, clamped to `t_min`; null if it misses within [`t_min`, `t_max`].
+    /// Unlike `math.intersectRayAABB` a ray starting inside the box enters at `t_min`, which is
+    /// what nearest-first traversal needs to prune against.
+    fn entry(self: RayBox, box: math.AABB, t_min: f32, t_max: f32) ?f32 {
+        var t0 = t_min;
+        var t1 = t_max;
+        inline for (.{ "x", "y", "z" }) |axis| {
+            const inv = @field(self.inv_dir, axis);
+            var near = (@field(box.min, axis) - @field(self.origin, axis)) * inv;
+            var far = (@field(box.max, axis) - @field(self.origin, axis)) * inv;
+            if (inv < 0.0) std.mem.swap(f32, &near, &far);
+            // NaN (axis-parallel ray on a slab face) fails both comparisons and leaves the range as is.
+            if (near > t0) t0 = near;
+            if (far < t1) t1 = far;
+        }
+        return if (t0 <= t1) t0 else null;
+    }
+};
+
+const StackEntry = struct {
+    node: u32,
+    /// Where the ray enters the node; it is skipped once a closer hit is known.
+    t: f32,
+};
+
+/// Pushes the children the ray reaches before `t_max`, nearer one on top. Returns the new depth.
+fn push_children(stack: *[TRAVERSAL_STACK]StackEntry, sp: usize, ray_box: RayBox, left: u32, left_box: math.AABB, right: u32, right_box: math.AABB, t_min: f32, t_max: f32) usize {
+    if (sp + 2 > stack.len) return sp;
+    const t_left = ray_box.entry(left_box, t_min, t_max);
+    const t_right = ray_box.entry(right_box, t_min, t_max);
+    var n = sp;
+    if (t_left != null and t_right != null) {
+        const left_first = t_left.? <= t_right.?;
+        stack[n] = if (left_first) .{ .node = right, .t = t_right.? } else .{ .node = left, .t = t_left.? };
+        stack[n + 1] = if (left_first) .{ .node = left, .t = t_left.? } else .{ .node = right, .t = t_right.? };
+        n += 2;
+    } else if (t_left) |t| {
+        stack[n] = .{ .node = left, .t = t };
+        n += 1;
+    } else if (t_right) |t| {
+        stack[n] = .{ .node = right, .t = t };
+        n += 1;
+    }
+    return n;
+}
+
+pub const TriangleHit = struct {
+    t: f32,
+    /// Offset of the triangle's first index in the mesh's index buffer.
+    tri_offset: u32 = 0,
+    /// Barycentric weights of the triangle's second and third vertex at the hit.
+    u: f32,
+    v: f32,
+};
+
+/// Moller-Trumbore; `t` is in units of `ray.direction`, which need not be normalized.
+pub fn intersect_ray_triangle(ray: math.Ray, v0: math.Vec3, v1: math.Vec3, v2: math.Vec3, t_min: f32, t_max: f32) ?TriangleHit {
+    const eps: f32 = 0.000001;
+
+    const edge1 = v1.sub(v0);
+    const edge2 = v2.sub(v0);
+
+    const h = ray.direction.cross(edge2);
+    const a = edge1.dot(h);
+    if (@abs(a) < eps) return null;
+
+    const f = 1.0 / a;
+    const s = ray.origin.sub(v0);
+    const u = f * s.dot(h);
+    if (u < 0.0 or u > 1.0) return null;
+
+    const q = s.cross(edge1);
+    const v = f * ray.direction.dot(q);
+    if (v < 0.0 or (u + v) > 1.0) return null;
+
+    const t = f * edge2.dot(q);
+    if (t < t_min or t > t_max) return null;
+    return .{ .t = t, .u = u, .v = v };
+}
+
+/// Identifies the buffers a `MeshBvh` was built from, to notice when a mesh's geometry is replaced.
+pub const MeshKey = struct {
+    vertices: usize = 0,
+    indices: usize = 0,
+    vertex_count: u32 = 0,
+    index_count: u32 = 0,
+
+    pub fn of(mesh: *const scene.CardinalMesh) MeshKey {
+        return .{
+            .vertices = if (mesh.vertices) |v| @intFromPtr(v) else 0,
+            .indices = if (mesh.indices) |i| @intFromPtr(i) else 0,
+            .vertex_count = mesh.vertex_count,
+            .index_count = mesh.index_count,
+        };
+    }
+
+    pub fn eql(a: MeshKey, b: MeshKey) bool {
+        return std.meta.eql(a, b);
+    }
+};
+
+/// Bottom-level triangle BVH of one mesh, in mesh-local space. The root is node 0.
+pub const MeshBvh = struct {
+    pub const Node = struct {
+        aabb: math.AABB,
+        /// Children of inner nodes.
+        left: u32 = 0,
+        right: u32 = 0,
+        /// Leaves: range in `tri_offsets`. Inner nodes have `count == 0`.
+        first: u32 = 0,
+        count: u32 = 0,
+    };
+
+    nodes: []Node = &.{},
+    /// Index-buffer offset of each triangle, in leaf order.
+    tri_offsets: []u32 = &.{},
+    key: MeshKey = .{},
+
+    const BuildTri = struct {
+        offset: u32,
+        bounds: math.AABB,
+        centroid: math.Vec3,
+
+        fn less_on_axis(axis: u2, a: BuildTri, b: BuildTri) bool {
+            return switch (axis) {
+                0 => a.centroid.x < b.centroid.x,
+                1 => a.centroid.y < b.centroid.y,
+                else => a.centroid.z < b.centroid.z,
+            };
+        }
+    };
+
+    pub fn deinit(self: *MeshBvh, allocator: std.mem.Allocator) void {
+        allocator.free(self.nodes);
+        allocator.free(self.tri_offsets);
+        self.* = .{};
+    }
+
+    /// Builds over the triangles of `indices`, whose entries index `positions`. Triangles with
+    /// out-of-range indices are left out, and a mesh without any yields a BVH without nodes.
+    pub fn build(allocator: std.mem.Allocator, positions: []const math.Vec3, indices: []const u32, key: MeshKey) !MeshBvh {
+        var tris = std.ArrayListUnmanaged(BuildTri){};
+        defer tris.deinit(allocator);
+        try tris.ensureTotalCapacity(allocator, indices.len / 3);
+
+        var offset: usize = 0;
+        while (offset + 3 <= indices.len) : (offset += 3) {
+            const tri = indices[offset..][0..3];
+            if (tri[0] >= positions.len or tri[1] >= positions.len or tri[2] >= positions.len) continue;
+            var bounds = empty_aabb();
+            for (tri) |vi| grow(&bounds, positions[vi]);
+            tris.appendAssumeCapacity(.{ .offset = @intCast(offset), .bounds = bounds, .centroid = bounds.center() });
+        }
+
+        var out = MeshBvh{ .key = key };
+        if (tris.items.len == 0) return out;
+
+        var nodes = std.ArrayListUnmanaged(Node){};
+        errdefer nodes.deinit(allocator);
+        try nodes.ensureTotalCapacity(allocator, 2 * (tris.items.len / LEAF_TRIANGLES) + 1);
+        _ = try build_node(allocator, &nodes, tris.items, 0);
+
+        const offsets = try allocator.alloc(u32, tris.items.len);
+        errdefer allocator.free(offsets);
+        for (offsets, tris.items) |*dst, tri| dst.* = tri.offset;
+
+        out.nodes = try nodes.toOwnedSlice(allocator);
+        out.tri_offsets = offsets;
+        return out;
+    }
+
+    /// Median split on the longest centroid axis.
+    fn build_node(allocator: std.mem.Allocator, nodes: *std.ArrayListUnmanaged(Node), tris: []BuildTri, first: u32) !u32 {
+        const index: u32 = @intCast(nodes.items.len);
+        try nodes.append(allocator, .{ .aabb = empty_aabb() });
+
+        var bounds = empty_aabb();
+        var centroids = empty_aabb();
+        for (tris) |tri| {
+            bounds = merge(bounds, tri.bounds);
+            grow(&centroids, tri.centroid);
+        }
+
+        if (tris.len <= LEAF_TRIANGLES) {
+            nodes.items[index] = .{ .aabb = bounds, .first = first, .count = @intCast(tris.len) };
+            return index;
+        }
+
+        const extent = centroids.size();
+        const axis: u2 = if (extent.x >= extent.y and extent.x >= extent.z) 0 else if (extent.y >= extent.z) 1 else 2;
+        std.sort.pdq(BuildTri, tris, axis, BuildTri.less_on_axis);
+
+        const mid = tris.len / 2;
+        const left = try build_node(allocator, nodes, tris[0..mid], first);
+        const right = try build_node(allocator, nodes, tris[mid..], first + @as(u32, @intCast(mid)));
+        nodes.items[index] = .{ .aabb = bounds, .left = left, .right = right };
+        return index;
+    }
+
+    /// Closest hit of the mesh-local `ray` within [`t_min`, `t_max`] on a triangle that
+    /// `filter.accept(tri_offset, u, v)` accepts. `mesh` must match `key`.
+    pub fn raycast(self: *const MeshBvh, mesh: *const scene.CardinalMesh, ray: math.Ray, t_min: f32, t_max: f32, filter: anytype) ?TriangleHit {
+        if (self.nodes.len == 0) return null;
+        const verts = mesh.vertices orelse return null;
+        const idxs = mesh.indices orelse return null;
+
+        const ray_box = RayBox.init(ray);
+        var closest = t_max;
+        var best: ?TriangleHit = null;
+
+        var stack: [TRAVERSAL_STACK]StackEntry = undefined;
+        stack[0] = .{ .node = 0, .t = ray_box.entry(self.nodes[0].aabb, t_min, closest) orelse return null };
+        var sp: usize = 1;
+
+        while (sp > 0) {
+            sp -= 1;
+            const top = stack[sp];
+            if (top.t > closest) continue;
+            const node = self.nodes[top.node];
+
+            if (node.count == 0) {
+                sp = push_children(&stack, sp, ray_box, node.left, self.nodes[node.left].aabb, node.right, self.nodes[node.right].aabb, t_min, closest);
+                continue;
+            }
+
+            for (self.tri_offsets[node.first..][0..node.count]) |offset| {
+                if (offset + 3 > mesh.index_count) continue;
+                const i0 = idxs[offset];
+                const i1 = idxs[offset + 1];
+                const i2 = idxs[offset + 2];
+                if (i0 >= mesh.vertex_count or i1 >= mesh.vertex_count or i2 >= mesh.vertex_count) continue;
+
+                var hit = intersect_ray_triangle(ray, vertex_position(verts, i0), vertex_position(verts, i1), vertex_position(verts, i2), t_min, closest) orelse continue;
+                if (!filter.accept(offset, hit.u, hit.v)) continue;
+                hit.tri_offset = offset;
+                closest = hit.t;
+                best = hit;
+            }
+        }
+        return best;
+    }
+
+    /// Recomputes the bounds of every node overlapping `region` from the mesh's current vertices
+    /// and returns the new root bounds. `region` is mesh-local and must contain the old position
+    /// of every vertex that moved; nodes outside it cannot hold those triangles and are skipped.
+    pub fn refit_region(self: *MeshBvh, mesh: *const scene.CardinalMesh, region: math.AABB) ?math.AABB {
+        if (self.nodes.len == 0) return null;
+        const verts = mesh.vertices orelse return null;
+        const idxs = mesh.indices orelse return null;
+        self.refit_node(verts, idxs, mesh.vertex_count, mesh.index_count, 0, region);
+        return self.nodes[0].aabb;
+    }
+
+    fn refit_node(self: *MeshBvh, verts: [*]const scene.CardinalVertex, idxs: [*]const u32, vertex_count: u32, index_count: u32, index: u32, region: math.AABB) void {
+        const node = &self.nodes[index];
+        if (!overlaps(node.aabb, region)) return;
+
+        if (node.count == 0) {
+            self.refit_node(verts, idxs, vertex_count, index_count, node.left, region);
+            self.refit_node(verts, idxs, vertex_count, index_count, node.right, region);
+            node.aabb = merge(self.nodes[node.left].aabb, self.nodes[node.right].aabb);
+            return;
+        }
+
+        var bounds = empty_aabb();
+        for (self.tri_offsets[node.first..][0..node.count]) |offset| {
+            if (offset + 3 > index_count) continue;
+            for (idxs[offset..][0..3]) |vi| {
+                if (vi < vertex_count) grow(&bounds, vertex_position(verts, vi));
+            }
+        }
+        node.aabb = bounds;
+    }
+};
+
+/// Snapshot of a mesh's geometry and the BVH built from it, shared with a build job.
+const BuildTask = struct {
+    allocator: std.mem.Allocator,
+    positions: []math.Vec3,
+    indices: []u32,
+    key: MeshKey,
+    job: ?*job_system.Job = null,
+    result: ?MeshBvh = null,
+
+    fn create(allocator: std.mem.Allocator, mesh: *const scene.CardinalMesh) !*BuildTask {
+        const task = try allocator.create(BuildTask);
+        errdefer allocator.destroy(task);
+        const positions = try allocator.alloc(math.Vec3, mesh.vertex_count);
+        errdefer allocator.free(positions);
+        const verts = mesh.vertices.?;
+        for (positions, 0..) |*p, i| p.* = vertex_position(verts, @intCast(i));
+        const indices = try allocator.dupe(u32, mesh.indices.?[0..mesh.index_count]);
+
+        task.* = .{ .allocator = allocator, .positions = positions, .indices = indices, .key = MeshKey.of(mesh) };
+        return task;
+    }
+
+    fn run(self: *BuildTask) void {
+        self.result = MeshBvh.build(self.allocator, self.positions, self.indices, self.key) catch null;
+    }
+
+    fn job_main(data: ?*anyopaque) callconv(.c) i32 {
+        const task: *BuildTask = @ptrCast(@alignCast(data.?));
+        task.run();
+        return if (task.result != null) 0 else -1;
+    }
+
+    fn is_done(self: *const BuildTask) bool {
+        const job = self.job orelse return true;
+        return switch (job_system.get_status(job)) {
+            .PENDING, .RUNNING => false,
+            else => true,
+        };
+    }
+
+    /// Waits for the job if it is still running, then frees the task and returns its result.
+    fn finish(self: *BuildTask) ?MeshBvh {
+        if (self.job) |job| {
+            job_system.wait_for_jobs(&.{job});
+            job_system.free_job(job);
+        }
+        const result = self.result;
+        self.destroy();
+        return result;
+    }
+
+    fn destroy(self: *BuildTask) void {
+        const allocator = self.allocator;
+        allocator.free(self.positions);
+        allocator.free(self.indices);
+        allocator.destroy(self);
+    }
+};
+
+const Blas = struct {
+    bvh: ?MeshBvh = null,
+    task: ?*BuildTask = null,
+    /// Vertices may have moved since `bvh` was last fitted; refit it whole before its next use.
+    stale: bool = false,
+};
+
+pub const Instance = struct {
+    world: math.Mat4 = math.Mat4.identity(),
+    inv_world: math.Mat4 = math.Mat4.identity(),
+    /// World-space bounds the top level is built over.
+    bounds: math.AABB = empty_aabb(),
+    /// Has triangles and an invertible transform. Inactive instances are left out of the top level.
+    active: bool = false,
+};
+
+pub const Hit = struct {
+    mesh_index: u32,
+    /// Distance along the ray, in units of its direction.
+    t: f32,
+    point: math.Vec3,
+    tri_offset: u32,
+    u: f32,
+    v: f32,
+};
+
+pub const RayOptions = struct {
+    t_min: f32 = 0.001,
+    t_max: f32 = 10000.0,
+    /// Also hit meshes whose `visible` flag is off.
+    include_invisible: bool = false,
+};
+
+/// Ray filter accepting every triangle. Filters implement
+/// `accept(self, mesh_index: u32, tri_offset: u32, u: f32, v: f32) bool`.
+pub const AcceptAll = struct {
+    pub fn accept(_: AcceptAll, _: u32, _: u32, _: f32, _: f32) bool {
+        return true;
+    }
+};
+
+fn MeshFilter(comptime Inner: type) type {
+    return struct {
+        inner: Inner,
+        mesh_index: u32,
+
+        pub fn accept(self: @This(), tri_offset: u32, u: f32, v: f32) bool {
+            return self.inner.accept(self.mesh_index, tri_offset, u, v);
+        }
+    };
+}
+
+pub const Stats = struct {
+    /// Bottom levels built on job workers.
+    async_builds: u64 = 0,
+    /// Bottom levels a query had to build on the calling thread.
+    sync_builds: u64 = 0,
+    tlas_builds: u64 = 0,
+    /// Region refits of bottom levels.
+    refits: u64 = 0,
+};
+
+/// Bottom levels per mesh plus the top level over their instances.
+pub const PickScene = struct {
+    instances: std.ArrayListUnmanaged(Instance) = .{},
+    blas: std.ArrayListUnmanaged(Blas) = .{},
+    tlas: math.BVH = .{},
+    /// Top-level item -> mesh index, and the bounds the top level was fitted to.
+    tlas_items: std.ArrayListUnmanaged(u32) = .{},
+    tlas_bounds: std.ArrayListUnmanaged(math.AABB) = .{},
+    /// Mesh index -> top-level item, or NONE.
+    tlas_item_of: std.ArrayListUnmanaged(u32) = .{},
+    /// Top-level item -> leaf node holding it.
+    tlas_leaf_of: std.ArrayListUnmanaged(u32) = .{},
+    /// Top-level node -> parent node, NONE at the root.
+    tlas_parents: std.ArrayListUnmanaged(u32) = .{},
+    tlas_dirty: bool = true,
+    /// Leaf refits since the last top-level build; past one per item the tree is rebuilt.
+    tlas_refits: usize = 0,
+    builds_in_flight: u32 = 0,
+    stats: Stats = .{},
+
+    /// Waits for in-flight builds and frees everything.
+    pub fn deinit(self: *PickScene, allocator: std.mem.Allocator) void {
+        for (self.blas.items) |*entry| self.drop_blas(allocator, entry);
+        self.instances.deinit(allocator);
+        self.blas.deinit(allocator);
+        self.tlas.deinit(allocator);
+        self.tlas_items.deinit(allocator);
+        self.tlas_bounds.deinit(allocator);
+        self.tlas_item_of.deinit(allocator);
+        self.tlas_leaf_of.deinit(allocator);
+        self.tlas_parents.deinit(allocator);
+        self.* = .{};
+    }
+
+    fn drop_blas(self: *PickScene, allocator: std.mem.Allocator, entry: *Blas) void {
+        if (entry.task) |task| {
+            var result = task.finish();
+            if (result) |*bvh| bvh.deinit(allocator);
+            self.builds_in_flight -= 1;
+        }
+        if (entry.bvh) |*bvh| bvh.deinit(allocator);
+        entry.* = .{};
+    }
+
+    /// Sets the number of meshes. New instances start inactive until `update_instance`.
+    pub fn resize(self: *PickScene, allocator: std.mem.Allocator, mesh_count: usize) !void {
+        try self.blas.ensureTotalCapacity(allocator, mesh_count);
+        try self.instances.ensureTotalCapacity(allocator, mesh_count);
+
+        const old_len = self.blas.items.len;
+        if (mesh_count < old_len) {
+            for (self.blas.items[mesh_count..]) |*entry| self.drop_blas(allocator, entry);
+        }
+        self.blas.items.len = mesh_count;
+        self.instances.items.len = mesh_count;
+        if (mesh_count > old_len) {
+            @memset(self.blas.items[old_len..], .{});
+            @memset(self.instances.items[old_len..], .{});
+        }
+        self.tlas_dirty = true;
+    }
+
+    /// Marks every bottom level for a whole refit before its next use and rebuilds the top level
+    /// on the next query, for edits that did not report what moved.
+    pub fn invalidate(self: *PickScene) void {
+        for (self.blas.items) |*entry| entry.stale = true;
+        self.tlas_dirty = true;
+    }
+
+    /// Rebuilds the top level on the next query. Use before updating many instances at once.
+    pub fn invalidate_tlas(self: *PickScene) void {
+        self.tlas_dirty = true;
+    }
+
+    /// Sets the world transform of mesh `index`'s instance. Unless the top level is waiting for a
+    /// rebuild anyway, the instance's leaf and the path above it are refit in place.
+    pub fn update_instance(self: *PickScene, index: u32, mesh: *const scene.CardinalMesh, world: math.Mat4) void {
+        if (index >= self.instances.items.len) return;
+        const instance = &self.instances.items[index];
+        const was_active = instance.active;
+        const inv_world = world.invert();
+
+        instance.world = world;
+        instance.inv_world = inv_world orelse math.Mat4.identity();
+        instance.active = has_geometry(mesh) and inv_world != null;
+        instance.bounds = if (instance.active) self.local_bounds(index, mesh).transform(world) else empty_aabb();
+
+        if (instance.active != was_active) {
+            self.tlas_dirty = true;
+        } else if (instance.active) {
+            self.refit_tlas_item(index);
+        }
+    }
+
+    fn local_bounds(self: *const PickScene, index: u32, mesh: *const scene.CardinalMesh) math.AABB {
+        var bounds = math.AABB{ .min = math.Vec3.fromArray(mesh.bounding_box_min), .max = math.Vec3.fromArray(mesh.bounding_box_max) };
+        // The mesh's own bounds may lag behind edits; a fitted bottom level does not.
+        const entry = &self.blas.items[index];
+        if (entry.bvh) |bvh| {
+            if (!entry.stale and bvh.nodes.len > 0 and bvh.key.eql(MeshKey.of(mesh))) bounds = merge(bounds, bvh.nodes[0].aabb);
+        }
+        return bounds;
+    }
+
+    fn refresh_bounds(self: *PickScene, index: u32, mesh: *const scene.CardinalMesh) void {
+        const instance = &self.instances.items[index];
+        if (!instance.active) return;
+        instance.bounds = self.local_bounds(index, mesh).transform(instance.world);
+        self.refit_tlas_item(index);
+    }
+
+    fn refit_tlas_item(self: *PickScene, index: u32) void {
+        if (self.tlas_dirty) return;
+        const item = self.tlas_item_of.items[index];
+        if (item == NONE or self.tlas_refits >= self.tlas_items.items.len) {
+            self.tlas_dirty = true;
+            return;
+        }
+        self.tlas_refits += 1;
+        self.tlas_bounds.items[item] = self.instances.items[index].bounds;
+
+        var node_index = self.tlas_leaf_of.items[item];
+        const leaf = &self.tlas.nodes[node_index];
+        var bounds = empty_aabb();
+        for (self.tlas.indices[leaf.start..][0..leaf.count]) |i| bounds = merge(bounds, self.tlas_bounds.items[i]);
+        leaf.aabb = bounds;
+
+        while (self.tlas_parents.items[node_index] != NONE) {
+            node_index = self.tlas_parents.items[node_index];
+            const node = &self.tlas.nodes[node_index];
+            node.aabb = merge(self.tlas.nodes[@intCast(node.left)].aabb, self.tlas.nodes[@intCast(node.right)].aabb);
+        }
+    }
+
+    /// Rebuilds the top level if anything invalidated it.
+    pub fn update_tlas(self: *PickScene, allocator: std.mem.Allocator) void {
+        if (!self.tlas_dirty) return;
+        self.rebuild_tlas(allocator) catch {
+            self.tlas.node_count = 0;
+        };
+    }
+
+    fn rebuild_tlas(self: *PickScene, allocator: std.mem.Allocator) !void {
+        self.tlas.node_count = 0;
+        self.tlas_items.clearRetainingCapacity();
+        self.tlas_bounds.clearRetainingCapacity();
+        try self.tlas_item_of.resize(allocator, self.instances.items.len);
+        @memset(self.tlas_item_of.items, NONE);
+
+        for (self.instances.items, 0..) |instance, i| {
+            if (!instance.active) continue;
+            self.tlas_item_of.items[i] = @intCast(self.tlas_items.items.len);
+            try self.tlas_items.append(allocator, @intCast(i));
+            try self.tlas_bounds.append(allocator, instance.bounds);
+        }
+        try self.tlas.build(allocator, self.tlas_bounds.items);
+
+        const nodes = self.tlas.nodes[0..self.tlas.node_count];
+        try self.tlas_parents.resize(allocator, nodes.len);
+        @memset(self.tlas_parents.items, NONE);
+        try self.tlas_leaf_of.resize(allocator, self.tlas_items.items.len);
+        for (nodes, 0..) |node, ni| {
+            if (node.count > 0) {
+                for (self.tlas.indices[node.start..][0..node.count]) |item| self.tlas_leaf_of.items[item] = @intCast(ni);
+            } else {
+                self.tlas_parents.items[@intCast(node.left)] = @intCast(ni);
+                self.tlas_parents.items[@intCast(node.right)] = @intCast(ni);
+            }
+        }
+
+        self.tlas_dirty = false;
+        self.tlas_refits = 0;
+        self.stats.tlas_builds += 1;
+    }
+
+    /// Starts background builds for meshes without an up-to-date bottom level, keeping at most
+    /// `max_in_flight` running. Does nothing while the job system is not running.
+    pub fn prefetch(self: *PickScene, allocator: std.mem.Allocator, meshes: []const scene.CardinalMesh, max_in_flight: u32) void {
+        if (self.blas.items.len < meshes.len) self.resize(allocator, meshes.len) catch return;
+
+        for (meshes, 0..) |*mesh, i| {
+            if (self.builds_in_flight >= max_in_flight) return;
+            if (!has_geometry(mesh)) continue;
+            const entry = &self.blas.items[i];
+            if (entry.task != null) continue;
+            if (entry.bvh) |bvh| {
+                if (bvh.key.eql(MeshKey.of(mesh))) continue;
+            }
+            if (!self.start_build(allocator, entry, mesh)) return;
+        }
+    }
+
+    fn start_build(self: *PickScene, allocator: std.mem.Allocator, entry: *Blas, mesh: *const scene.CardinalMesh) bool {
+        const task = BuildTask.create(allocator, mesh) catch return false;
+        const job = job_system.create_job(BuildTask.job_main, task, .LOW) orelse {
+            task.destroy();
+            return false;
+        };
+        job.push_to_completed_queue = false;
+        task.job = job;
+        if (!job_system.submit_job(job)) {
+            job_system.free_job(job);
+            task.destroy();
+            return false;
+        }
+
+        entry.task = task;
+        // The snapshot already includes every earlier edit.
+        entry.stale = false;
+        self.builds_in_flight += 1;
+        self.stats.async_builds += 1;
+        return true;
+    }
+
+    fn finish_build(self: *PickScene, allocator: std.mem.Allocator, entry: *Blas) void {
+        const task = entry.task orelse return;
+        entry.task = null;
+        self.builds_in_flight -= 1;
+        const result = task.finish();
+        if (entry.bvh) |*old| old.deinit(allocator);
+        entry.bvh = result;
+    }
+
+    /// Adopts finished background builds. Call once per frame.
+    pub fn poll(self: *PickScene, allocator: std.mem.Allocator, meshes: []const scene.CardinalMesh) void {
+        if (self.builds_in_flight == 0) return;
+        for (self.blas.items, 0..) |*entry, i| {
+            const task = entry.task orelse continue;
+            if (!task.is_done()) continue;
+            self.finish_build(allocator, entry);
+            if (i < meshes.len) self.refresh_bounds(@intCast(i), &meshes[i]);
+        }
+    }
+
+    /// Waits for every background build and adopts it.
+    pub fn finish_builds(self: *PickScene, allocator: std.mem.Allocator, meshes: []const scene.CardinalMesh) void {
+        for (self.blas.items, 0..) |*entry, i| {
+            if (entry.task == null) continue;
+            self.finish_build(allocator, entry);
+            if (i < meshes.len) self.refresh_bounds(@intCast(i), &meshes[i]);
+        }
+    }
+
+    /// Returns mesh `index`'s bottom level, waiting for its build or building it here if needed.
+    fn ensure_blas(self: *PickScene, allocator: std.mem.Allocator, index: u32, mesh: *const scene.CardinalMesh) ?*MeshBvh {
+        if (!has_geometry(mesh)) return null;
+        const entry = &self.blas.items[index];
+        if (entry.task != null) self.finish_build(allocator, entry);
+
+        const key = MeshKey.of(mesh);
+        if (entry.bvh) |*bvh| {
+            if (bvh.key.eql(key)) {
+                if (entry.stale) {
+                    _ = bvh.refit_region(mesh, everywhere);
+                    entry.stale = false;
+                }
+                return bvh;
+            }
+            bvh.deinit(allocator);
+            entry.bvh = null;
+        }
+
+        const task = BuildTask.create(allocator, mesh) catch return null;
+        task.run();
+        entry.bvh = task.finish();
+        entry.stale = false;
+        self.stats.sync_builds += 1;
+        if (entry.bvh) |*bvh| return bvh;
+        return null;
+    }
+
+    /// Refits mesh `index` after vertices moved inside `region`, then its instance bounds and the
+    /// top-level path above it. `region` is mesh-local and must contain the moved vertices' old
+    /// positions (see `MeshBvh.refit_region`).
+    pub fn refit_region(self: *PickScene, index: u32, mesh: *const scene.CardinalMesh, region: math.AABB) void {
+        if (index >= self.blas.items.len) return;
+        const entry = &self.blas.items[index];
+        if (entry.task != null) {
+            // The build's snapshot predates this edit.
+            entry.stale = true;
+        } else if (entry.bvh) |*bvh| {
+            if (!entry.stale and bvh.key.eql(MeshKey.of(mesh))) {
+                _ = bvh.refit_region(mesh, region);
+                self.stats.refits += 1;
+            }
+        }
+        self.refresh_bounds(index, mesh);
+    }
+
+    fn raycast_instance(self: *PickScene, allocator: std.mem.Allocator, index: u32, mesh: *const scene.CardinalMesh, inv_world: math.Mat4, ray: math.Ray, t_min: f32, t_max: f32, filter: anytype) ?Hit {
+        const bvh = self.ensure_blas(allocator, index, mesh) orelse return null;
+        // The inverse of an affine transform maps the ray's point at `t` to the local ray's point
+        // at the same `t`, so hits need no conversion back.
+        const local_ray = math.Ray{ .origin = inv_world.transformPoint(ray.origin), .direction = inv_world.transformVector(ray.direction) };
+        const hit = bvh.raycast(mesh, local_ray, t_min, t_max, MeshFilter(@TypeOf(filter)){ .inner = filter, .mesh_index = index }) orelse return null;
+        return .{
+            .mesh_index = index,
+            .t = hit.t,
+            .point = ray.origin.add(ray.direction.mul(hit.t)),
+            .tri_offset = hit.tri_offset,
+            .u = hit.u,
+            .v = hit.v,
+        };
+    }
+
+    /// Closest hit over all instances, nearest instances first.
+    pub fn raycast(self: *PickScene, allocator: std.mem.Allocator, meshes: []const scene.CardinalMesh, ray: math.Ray, options: RayOptions, filter: anytype) ?Hit {
+        self.update_tlas(allocator);
+        if (self.tlas.node_count == 0) return null;
+
+        const ray_box = RayBox.init(ray);
+        const nodes = self.tlas.nodes;
+        var closest = options.t_max;
+        var best: ?Hit = null;
+
+        var stack: [TRAVERSAL_STACK]StackEntry = undefined;
+        stack[0] = .{ .node = 0, .t = ray_box.entry(nodes[0].aabb, options.t_min, closest) orelse return null };
+        var sp: usize = 1;
+
+        while (sp > 0) {
+            sp -= 1;
+            const top = stack[sp];
+            if (top.t > closest) continue;
+            const node = nodes[top.node];
+
+            if (node.count == 0) {
+                const left: u32 = @intCast(node.left);
+                const right: u32 = @intCast(node.right);
+                sp = push_children(&stack, sp, ray_box, left, nodes[left].aabb, right, nodes[right].aabb, options.t_min, closest);
+                continue;
+            }
+
+            for (self.tlas.indices[node.start..][0..node.count]) |item| {
+                const index = self.tlas_items.items[item];
+                if (index >= meshes.len) continue;
+                const mesh = &meshes[index];
+                if (!mesh.visible and !options.include_invisible) continue;
+                _ = ray_box.entry(self.tlas_bounds.items[item], options.t_min, closest) orelse continue;
+
+                const hit = self.raycast_instance(allocator, index, mesh, self.instances.items[index].inv_world, ray, options.t_min, closest, filter) orelse continue;
+                closest = hit.t;
+                best = hit;
+            }
+        }
+        return best;
+    }
+
+    /// Raycasts one mesh with the given world transform, without the top level. For tools that
+    /// already know which mesh they want, such as terrain sculpting.
+    pub fn raycast_mesh(self: *PickScene, allocator: std.mem.Allocator, index: u32, mesh: *const scene.CardinalMesh, world: math.Mat4, ray: math.Ray, options: RayOptions, filter: anytype) ?Hit {
+        if (index >= self.blas.items.len) self.resize(allocator, @as(usize, index) + 1) catch return null;
+        if (!mesh.visible and !options.include_invisible) return null;
+        const inv_world = world.invert() orelse return null;
+        return self.raycast_instance(allocator, index, mesh, inv_world, ray, options.t_min, options.t_max, filter);
+    }
+
+    /// Appends the mesh index of every instance whose world bounds intersect `frustum`. `out`
+    /// grows with `allocator`, which must also be the one the scene is kept with.
+    pub fn query_frustum(self: *PickScene, allocator: std.mem.Allocator, meshes: []const scene.CardinalMesh, frustum: math.Frustum, include_invisible: bool, out: *std.ArrayListUnmanaged(u32)) void {
+        self.update_tlas(allocator);
+        const start = out.items.len;
+        self.tlas.queryFrustum(frustum, self.tlas_bounds.items, out, allocator);
+
+        var write = start;
+        for (out.items[start..]) |item| {
+            const index = self.tlas_items.items[item];
+            if (index >= meshes.len) continue;
+            if (!meshes[index].visible and !include_invisible) continue;
+            out.items[write] = index;
+            write += 1;
+        }
+        out.items.len = write;
+    }
+};
+
+fn test_mesh(verts: []scene.CardinalVertex, indices: []u32) scene.CardinalMesh {
+    var bounds = empty_aabb();
+    for (verts) |v| grow(&bounds, .{ .x = v.px, .y = v.py, .z = v.pz });
+    return .{
+        .vertices = verts.ptr,
+        .vertex_count = @intCast(verts.len),
+        .indices = indices.ptr,
+        .index_count = @intCast(indices.len),
+        .material_index = 0,
+        .transform = math.Mat4.identity().data,
+        .visible = true,
+        .morph_targets = null,
+        .morph_target_count = 0,
+        .bounding_box_min = bounds.min.toArray(),
+        .bounding_box_max = bounds.max.toArray(),
+    };
+}
+
+fn test_vertex(x: f32, y: f32, z: f32) scene.CardinalVertex {
+    var v = std.mem.zeroes(scene.CardinalVertex);
+    v.px = x;
+    v.py = y;
+    v.pz = z;
+    return v;
+}
+
+/// Flat `n` x `n` vertex grid on y = 0 spanning [0, n - 1] in x and z.
+fn test_grid(allocator: std.mem.Allocator, n: u32) !struct { verts: []scene.CardinalVertex, indices: []u32 } {
+    const verts = try allocator.alloc(scene.CardinalVertex, n * n);
+    errdefer allocator.free(verts);
+    for (0..n) |z| {
+        for (0..n) |x| verts[z * n + x] = test_vertex(@floatFromInt(x), 0.0, @floatFromInt(z));
+    }
+    const indices = try allocator.alloc(u32, (n - 1) * (n - 1) * 6);
+    var i: usize = 0;
+    for (0..n - 1) |z| {
+        for (0..n - 1) |x| {
+            const a: u32 = @intCast(z * n + x);
+            for ([_]u32{ a, a + n, a + 1, a + 1, a + n, a + n + 1 }) |vi| {
+                indices[i] = vi;
+                i += 1;
+            }
+        }
+    }
+    return .{ .verts = verts, .indices = indices };
+}
+
+const RejectMesh = struct {
+    rejected: u32,
+
+    pub fn accept(self: RejectMesh, mesh_index: u32, _: u32, _: f32, _: f32) bool {
+        return mesh_index != self.rejected;
+    }
+};
+
+fn translation(x: f32, y: f32, z: f32) math.Mat4 {
+    return math.Mat4.fromTRS(.{ .x = x, .y = y, .z = z }, math.Quat.identity(), math.Vec3.one());
+}
+
+test "pick scene returns the nearest accepted hit through the top level" {
+    const allocator = std.testing.allocator;
+
+    var verts = [_]scene.CardinalVertex{ test_vertex(-1, -1, 0), test_vertex(1, -1, 0), test_vertex(1, 1, 0), test_vertex(-1, 1, 0) };
+    var indices = [_]u32{ 0, 1, 2, 0, 2, 3 };
+    var meshes = [_]scene.CardinalMesh{ test_mesh(&verts, &indices), test_mesh(&verts, &indices) };
+
+    var picks = PickScene{};
+    defer picks.deinit(allocator);
+    try picks.resize(allocator, meshes.len);
+    picks.update_instance(0, &meshes[0], translation(0, 0, 5));
+    picks.update_instance(1, &meshes[1], translation(0, 0, 10));
+
+    const ray = math.Ray{ .origin = .{ .x = 0.2, .y = 0.3, .z = 0 }, .direction = .{ .x = 0, .y = 0, .z = 1 } };
+    const near = picks.raycast(allocator, &meshes, ray, .{}, AcceptAll{}).?;
+    try std.testing.expectEqual(@as(u32, 0), near.mesh_index);
+    try std.testing.expectApproxEqAbs(@as(f32, 5), near.t, 1e-4);
+
+    const far = picks.raycast(allocator, &meshes, ray, .{}, RejectMesh{ .rejected = 0 }).?;
+    try std.testing.expectEqual(@as(u32, 1), far.mesh_index);
+    try std.testing.expectApproxEqAbs(@as(f32, 10), far.point.z, 1e-4);
+
+    const miss = math.Ray{ .origin = .{ .x = 3, .y = 0, .z = 0 }, .direction = .{ .x = 0, .y = 0, .z = 1 } };
+    try std.testing.expect(picks.raycast(allocator, &meshes, miss, .{}, AcceptAll{}) == null);
+
+    meshes[1].visible = false;
+    try std.testing.expect(picks.raycast(allocator, &meshes, ray, .{}, RejectMesh{ .rejected = 0 }) == null);
+    try std.testing.expect(picks.raycast(allocator, &meshes, ray, .{ .include_invisible = true }, RejectMesh{ .rejected = 0 }) != null);
+}
+
+test "region refit follows moved vertices into the instance bounds" {
+    const allocator = std.testing.allocator;
+    const grid = try test_grid(allocator, 17);
+    defer allocator.free(grid.verts);
+    defer allocator.free(grid.indices);
+    var meshes = [_]scene.CardinalMesh{test_mesh(grid.verts, grid.indices)};
+
+    var picks = PickScene{};
+    defer picks.deinit(allocator);
+    try picks.resize(allocator, 1);
+    picks.update_instance(0, &meshes[0], math.Mat4.identity());
+
+    const down = math.Ray{ .origin = .{ .x = 8.01, .y = 20, .z = 8.02 }, .direction = .{ .x = 0, .y = -1, .z = 0 } };
+    try std.testing.expectApproxEqAbs(@as(f32, 20), picks.raycast(allocator, &meshes, down, .{}, AcceptAll{}).?.t, 1e-4);
+    try std.testing.expectEqual(@as(u64, 1), picks.stats.sync_builds);
+
+    // Raise the centre vertex; the edit's region holds its old position.
+    grid.verts[8 * 17 + 8].py = 5;
+    var region = everywhere;
+    region.min.x = 7.5;
+    region.max.x = 8.5;
+    region.min.z = 7.5;
+    region.max.z = 8.5;
+    picks.refit_region(0, &meshes[0], region);
+
+    try std.testing.expectApproxEqAbs(@as(f32, 15), picks.raycast(allocator, &meshes, down, .{}, AcceptAll{}).?.t, 0.2);
+    const elsewhere = math.Ray{ .origin = .{ .x = 2.3, .y = 20, .z = 2.6 }, .direction = .{ .x = 0, .y = -1, .z = 0 } };
+    try std.testing.expectApproxEqAbs(@as(f32, 20), picks.raycast(allocator, &meshes, elsewhere, .{}, AcceptAll{}).?.t, 1e-4);
+
+    // Above the mesh's stale bounding box: only reachable if the top level was refit too.
+    const side = math.Ray{ .origin = .{ .x = 8.1, .y = 4, .z = -5 }, .direction = .{ .x = 0, .y = 0, .z = 1 } };
+    const hit = picks.raycast(allocator, &meshes, side, .{}, AcceptAll{}).?;
+    try std.testing.expect(hit.point.z > 7 and hit.point.z < 8);
+    try std.testing.expectEqual(@as(u64, 1), picks.stats.sync_builds);
+    try std.testing.expectEqual(@as(u64, 1), picks.stats.tlas_builds);
+}
+
+test "frustum queries return the visible instances inside" {
+    const allocator = std.testing.allocator;
+
+    var verts = [_]scene.CardinalVertex{ test_vertex(-0.5, -0.5, 0), test_vertex(0.5, -0.5, 0), test_vertex(0, 0.5, 0) };
+    var indices = [_]u32{ 0, 1, 2 };
+    var meshes = [_]scene.CardinalMesh{ test_mesh(&verts, &indices), test_mesh(&verts, &indices), test_mesh(&verts, &indices) };
+
+    var picks = PickScene{};
+    defer picks.deinit(allocator);
+    try picks.resize(allocator, meshes.len);
+    picks.update_instance(0, &meshes[0], translation(5, 0, 0));
+    picks.update_instance(1, &meshes[1], translation(0, 0, 0.2));
+    picks.update_instance(2, &meshes[2], translation(-5, 0, 0));
+
+    var found: std.ArrayListUnmanaged(u32) = .{};
+    defer found.deinit(allocator);
+    picks.query_frustum(allocator, &meshes, math.Frustum.fromMatrix(math.Mat4.identity()), false, &found);
+    try std.testing.expectEqualSlices(u32, &.{1}, found.items);
+
+    meshes[1].visible = false;
+    found.clearRetainingCapacity();
+    picks.query_frustum(allocator, &meshes, math.Frustum.fromMatrix(math.Mat4.identity()), false, &found);
+    try std.testing.expectEqual(@as(usize, 0), found.items.len);
+}
+
+test "prefetch builds bottom levels on job workers" {
+    const allocator = std.testing.allocator;
+    const config = job_system.JobSystemConfig{ .worker_thread_count = 2, .max_queue_size = 64, .enable_priority_queue = false };
+    try std.testing.expect(job_system.init(&config));
+    defer job_system.shutdown();
+
+    const grid = try test_grid(allocator, 9);
+    defer allocator.free(grid.verts);
+    defer allocator.free(grid.indices);
+    var meshes: [6]scene.CardinalMesh = undefined;
+    for (&meshes) |*mesh| mesh.* = test_mesh(grid.verts, grid.indices);
+
+    var picks = PickScene{};
+    defer picks.deinit(allocator);
+    picks.prefetch(allocator, &meshes, 4);
+    try std.testing.expectEqual(@as(u32, 4), picks.builds_in_flight);
+    picks.finish_builds(allocator, &meshes);
+    picks.prefetch(allocator, &meshes, 4);
+    picks.finish_builds(allocator, &meshes);
+    try std.testing.expectEqual(@as(u64, 6), picks.stats.async_builds);
+
+    for (&meshes, 0..) |*mesh, i| picks.update_instance(@intCast(i), mesh, translation(@as(f32, @floatFromInt(i)) * 10, 0, 0));
+    const down = math.Ray{ .origin = .{ .x = 34, .y = 5, .z = 4 }, .direction = .{ .x = 0, .y = -1, .z = 0 } };
+    const hit = picks.raycast(allocator, &meshes, down, .{}, AcceptAll{}).?;
+    try std.testing.expectEqual(@as(u32, 3), hit.mesh_index);
+    try std.testing.expectEqual(@as(u64, 0), picks.stats.sync_builds);
+}
@@ -0,0 +1,497 @@
+//! Budgeted, priority-ordered scheduling of background mesh rebuilds.
+//!
+//! Terrain sculpting and streaming produce rebuild requests faster than the workers turn them
+//! around. `RemeshQueue` keeps at most one pending request per key and, on each scheduling pass,
+//! hands out the most useful ones until a budget runs out: main-thread time for preparing and
+//! submitting jobs (shared by every pass between two `start_frame` calls), bytes held by jobs in
+//! flight, and the number of jobs in flight. Requests are ranked by the screen-space error (in
+//! pixels) the rebuild removes, and they gain priority as they wait, so nothing starves behind a
+//! busy area.
+//!
+//! `CameraPredictor` smooths the camera velocity so callers can rank requests by where the camera
+//! is heading and ask for meshes at the LOD it will need shortly (prefetch requests). A request
+//! with a newer generation than the job in flight for the same key marks that job stale;
+//! `pop_stale` hands those keys back so the caller can cancel jobs that have not started.
+//! Completions record request-to-ready latency, which `stats` reports as percentiles.
+const std = @import("std");
+const math = @import("../core/math.zig");
+
+/// Latency samples kept for the percentiles in `Stats`.
+pub const LATENCY_SAMPLES: usize = 512;
+
+/// Per-frame limits for `RemeshQueue.next`.
+pub const Budget = struct {
+    /// Main-thread time per frame for preparing and submitting rebuilds.
+    frame_time_ns: u64 = 2 * std.time.ns_per_ms,
+    /// Bytes the jobs in flight may hold; one job is always let through so large ones never stall.
+    memory_bytes: u64 = 256 * 1024 * 1024,
+    /// Jobs in flight at once.
+    max_in_flight: u32 = 8,
+};
+
+/// Camera state requests are ranked against.
+pub const View = struct {
+    position: math.Vec3,
+    /// Where the camera is expected to be a short time from now.
+    predicted: math.Vec3,
+    /// Pixels per world unit at distance 1 (see `projection_scale`).
+    projection_scale: f32,
+};
+
+/// Pixels covered by one world unit at distance 1 for a vertical field of view and viewport height.
+pub fn projection_scale(fov_y_radians: f32, viewport_height: f32) f32 {
+    return viewport_height / (2.0 * @tan(fov_y_radians * 0.5));
+}
+
+/// Exponentially smoothed camera velocity for short-range position prediction.
+pub const CameraPredictor = struct {
+    position: math.Vec3 = math.Vec3.zero(),
+    velocity: math.Vec3 = math.Vec3.zero(),
+    last_ns: ?u64 = null,
+    /// Weight of the newest velocity sample.
+    smoothing: f32 = 0.35,
+    /// Updates closer together than this are ignored; several calls in one frame add only noise.
+    min_interval_s: f32 = 0.004,
+    /// A longer gap (a teleport, a stalled frame) resets the velocity.
+    max_interval_s: f32 = 0.5,
+
+    pub fn update(self: *CameraPredictor, position: math.Vec3, now_ns: u64) void {
+        if (self.last_ns) |last| {
+            const dt = @as(f32, @floatFromInt(now_ns -| last)) / 1e9;
+            if (dt < self.min_interval_s) return;
+            if (dt > self.max_interval_s) {
+                self.velocity = math.Vec3.zero();
+            } else {
+                const sample = position.sub(self.position).mul(1.0 / dt);
+                self.velocity = self.velocity.add(sample.sub(self.velocity).mul(self.smoothing));
+            }
+        }
+        self.position = position;
+        self.last_ns = now_ns;
+    }
+
+    /// Position `seconds` ahead along the smoothed velocity.
+    pub fn predict(self: *const CameraPredictor, seconds: f32) math.Vec3 {
+        return self.position.add(self.velocity.mul(seconds));
+    }
+};
+
+/// One rebuild the caller wants done.
+pub const Request = struct {
+    /// Bounding sphere of the geometry being rebuilt.
+    center: math.Vec3,
+    radius: f32,
+    /// World-space error on screen until the rebuild lands.
+    geometric_error: f32,
+    /// Bytes the job holds while in flight; an estimate is fine.
+    bytes: u64 = 0,
+    /// Ranked from the predicted camera position only and scaled by `prefetch_weight`.
+    prefetch: bool = false,
+    /// Added to the pixel error, e.g. for the selected object.
+    bias: f32 = 0.0,
+    /// Version of the source data; a newer one supersedes the job in flight.
+    generation: u32 = 0,
+    /// Caller's LOD for the rebuild.
+    lod: u8 = 0,
+};
+
+pub const Stats = struct {
+    /// Requests waiting for a job.
+    queue_depth: u32 = 0,
+    in_flight: u32 = 0,
+    in_flight_bytes: u64 = 0,
+    /// Requests still waiting when the last scheduling pass's budget ran out.
+    deferred: u32 = 0,
+    dispatched: u64 = 0,
+    completed: u64 = 0,
+    /// Jobs made stale by newer data before they finished.
+    superseded: u64 = 0,
+    latency_p50_ms: f32 = 0.0,
+    latency_p95_ms: f32 = 0.0,
+    latency_p99_ms: f32 = 0.0,
+};
+
+pub fn RemeshQueue(comptime Key: type) type {
+    return struct {
+        const Self = @This();
+
+        pub const Ticket = struct {
+            key: Key,
+            request: Request,
+        };
+
+        const Pending = struct {
+            request: Request,
+            since_ns: u64,
+        };
+
+        const InFlight = struct {
+            generation: u32,
+            bytes: u64,
+            since_ns: u64,
+            stale: bool = false,
+        };
+
+        const Ranked = struct {
+            key: Key,
+            priority: f32,
+        };
+
+        allocator: std.mem.Allocator,
+        budget: Budget,
+        /// Multiplier for prefetch priorities, below 1 so real edits win.
+        prefetch_weight: f32 = 0.5,
+        /// Relative priority gained per second of waiting.
+        age_weight: f32 = 1.0,
+        /// Distance below which screen-space error stops growing.
+        near_distance: f32 = 1.0,
+
+        pending: std.AutoHashMapUnmanaged(Key, Pending) = .{},
+        in_flight: std.AutoHashMapUnmanaged(Key, InFlight) = .{},
+        ranked: std.ArrayListUnmanaged(Ranked) = .{},
+        stale: std.ArrayListUnmanaged(Key) = .{},
+        cursor: usize = 0,
+        /// Main-thread time charged to the current frame so far.
+        frame_spent_ns: u64 = 0,
+        /// Timestamp up to which time has been charged to the frame.
+        charged_until_ns: u64 = 0,
+        in_flight_bytes: u64 = 0,
+        deferred: u32 = 0,
+        dispatched_total: u64 = 0,
+        completed_total: u64 = 0,
+        superseded_total: u64 = 0,
+        latencies_ns: [LATENCY_SAMPLES]u64 = undefined,
+        latency_count: usize = 0,
+        latency_head: usize = 0,
+
+        pub fn init(allocator: std.mem.Allocator, budget: Budget) Self {
+            return .{ .allocator = allocator, .budget = budget };
+        }
+
+        pub fn deinit(self: *Self) void {
+            self.pending.deinit(self.allocator);
+            self.in_flight.deinit(self.allocator);
+            self.ranked.deinit(self.allocator);
+            self.stale.deinit(self.allocator);
+        }
+
+        /// Adds or replaces the pending request for `key`. A replaced request keeps its original
+        /// wait time, and so does one that supersedes the job in flight.
+        pub fn request(self: *Self, key: Key, req: Request, now_ns: u64) !void {
+            var since = now_ns;
+            if (self.in_flight.getPtr(key)) |job| {
+                if (job.generation != req.generation and !job.stale) {
+                    try self.stale.append(self.allocator, key);
+                    job.stale = true;
+                    self.superseded_total += 1;
+                }
+                if (job.stale) since = job.since_ns;
+            }
+            const gop = try self.pending.getOrPut(self.allocator, key);
+            if (gop.found_existing) {
+                since = @min(since, gop.value_ptr.since_ns);
+                // A prefetch never demotes a request that is needed now.
+                var merged = req;
+                merged.prefetch = req.prefetch and gop.value_ptr.request.prefetch;
+                gop.value_ptr.* = .{ .request = merged, .since_ns = since };
+            } else {
+                gop.value_ptr.* = .{ .request = req, .since_ns = since };
+            }
+        }
+
+        /// Drops the pending request for `key`, if any.
+        pub fn cancel(self: *Self, key: Key) void {
+            _ = self.pending.remove(key);
+        }
+
+        /// Next key whose job in flight was superseded, for the caller to cancel.
+        pub fn pop_stale(self: *Self) ?Key {
+            while (self.stale.pop()) |key| {
+                const job = self.in_flight.get(key) orelse continue;
+                if (job.stale) return key;
+            }
+            return null;
+        }
+
+        fn priority(self: *const Self, p: Pending, view: View, now_ns: u64) f32 {
+            const r = p.request;
+            const to_predicted = @max(r.center.sub(view.predicted).length() - r.radius, self.near_distance);
+            var dist = to_predicted;
+            if (!r.prefetch) {
+                const to_camera = @max(r.center.sub(view.position).length() - r.radius, self.near_distance);
+                dist = @min(dist, to_camera);
+            }
+            var pixels = r.geometric_error * view.projection_scale / dist;
+            if (r.prefetch) pixels *= self.prefetch_weight;
+            const waited_s = @as(f32, @floatFromInt(now_ns -| p.since_ns)) / 1e9;
+            return (pixels + r.bias) * (1.0 + self.age_weight * waited_s);
+        }
+
+        fn higher_priority(_: void, a: Ranked, b: Ranked) bool {
+            return a.priority > b.priority;
+        }
+
+        /// Starts a new frame's time budget. Call once per frame; every pass until the next call
+        /// draws on the same budget.
+        pub fn start_frame(self: *Self) void {
+            self.frame_spent_ns = 0;
+        }
+
+        /// Ranks the pending requests against `view` for one scheduling pass. `now_ns` should be
+        /// taken before this call so the ranking is charged to the frame budget.
+        pub fn begin_pass(self: *Self, view: View, now_ns: u64) !void {
+            self.ranked.clearRetainingCapacity();
+            self.cursor = 0;
+            self.charged_until_ns = now_ns;
+            self.deferred = 0;
+            try self.in_flight.ensureTotalCapacity(self.allocator, self.budget.max_in_flight);
+            try self.ranked.ensureTotalCapacity(self.allocator, self.pending.count());
+            var it = self.pending.iterator();
+            while (it.next()) |entry| {
+                // One job per key: a superseded job has to finish or be cancelled first.
+                if (self.in_flight.contains(entry.key_ptr.*)) continue;
+                self.ranked.appendAssumeCapacity(.{ .key = entry.key_ptr.*, .priority = self.priority(entry.value_ptr.*, view, now_ns) });
+            }
+            std.sort.pdq(Ranked, self.ranked.items, {}, higher_priority);
+        }
+
+        /// Highest-priority request that fits this frame's budgets, or null once they are spent.
+        /// Time since the previous call (or `begin_pass`) is charged to the frame. The caller
+        /// submits the request and calls `dispatched`, or `cancel` if it could not.
+        pub fn next(self: *Self, now_ns: u64) ?Ticket {
+            self.frame_spent_ns += now_ns -| self.charged_until_ns;
+            self.charged_until_ns = @max(self.charged_until_ns, now_ns);
+            while (self.cursor < self.ranked.items.len) {
+                if (self.frame_spent_ns >= self.budget.frame_time_ns or
+                    self.in_flight.count() >= self.budget.max_in_flight)
+                {
+                    self.deferred += @as(u32, @intCast(self.ranked.items.len - self.cursor));
+                    return null;
+                }
+                const key = self.ranked.items[self.cursor].key;
+                self.cursor += 1;
+                const p = self.pending.get(key) orelse continue;
+                if (self.in_flight.count() > 0 and self.in_flight_bytes + p.request.bytes > self.budget.memory_bytes) {
+                    // Smaller requests further down may still fit.
+                    self.deferred += 1;
+                    continue;
+                }
+                return .{ .key = key, .request = p.request };
+            }
+            return null;
+        }
+
+        /// Moves `key` from pending to in flight after its job was submitted. On error the request
+        /// stays pending and the caller should cancel the job it submitted.
+        pub fn dispatched(self: *Self, key: Key) !void {
+            const p = self.pending.get(key) orelse return;
+            try self.in_flight.put(self.allocator, key, .{
+                .generation = p.request.generation,
+                .bytes = p.request.bytes,
+                .since_ns = p.since_ns,
+            });
+            _ = self.pending.remove(key);
+            self.in_flight_bytes += p.request.bytes;
+            self.dispatched_total += 1;
+        }
+
+        fn release(self: *Self, key: Key) ?InFlight {
+            const job = (self.in_flight.fetchRemove(key) orelse return null).value;
+            self.in_flight_bytes -|= job.bytes;
+            return job;
+        }
+
+        /// The job for `key` landed its result; records the latency since it was first requested.
+        pub fn complete(self: *Self, key: Key, now_ns: u64) void {
+            const job = self.release(key) orelse return;
+            if (job.stale) return;
+            self.latencies_ns[self.latency_head] = now_ns -| job.since_ns;
+            self.latency_head = (self.latency_head + 1) % LATENCY_SAMPLES;
+            self.latency_count = @min(self.latency_count + 1, LATENCY_SAMPLES);
+            self.completed_total += 1;
+        }
+
+        /// The job for `key` was cancelled, failed or had its result dropped.
+        pub fn cancelled(self: *Self, key: Key) void {
+            _ = self.release(key);
+        }
+
+        pub fn is_in_flight(self: *const Self, key: Key) bool {
+            return self.in_flight.contains(key);
+        }
+
+        /// Keys with a job in flight; do not call `complete` or `cancelled` while iterating.
+        pub fn in_flight_keys(self: *const Self) std.AutoHashMapUnmanaged(Key, InFlight).KeyIterator {
+            return self.in_flight.keyIterator();
+        }
+
+        pub fn stats(self: *const Self) Stats {
+            var out = Stats{
+                .queue_depth = @intCast(self.pending.count()),
+                .in_flight = @intCast(self.in_flight.count()),
+                .in_flight_bytes = self.in_flight_bytes,
+                .deferred = self.deferred,
+                .dispatched = self.dispatched_total,
+                .completed = self.completed_total,
+                .superseded = self.superseded_total,
+            };
+            const n = self.latency_count;
+            if (n == 0) return out;
+            var sorted: [LATENCY_SAMPLES]u64 = undefined;
+            @memcpy(sorted[0..n], self.latencies_ns[0..n]);
+            std.mem.sort(u64, sorted[0..n], {}, std.sort.asc(u64));
+            out.latency_p50_ms = percentile_ms(sorted[0..n], 0.50);
+            out.latency_p95_ms = percentile_ms(sorted[0..n], 0.95);
+            out.latency_p99_ms = percentile_ms(sorted[0..n], 0.99);
+            return out;
+        }
+    };
+}
+
+fn percentile_ms(sorted: []const u64, q: f32) f32 {
+    const last: f32 = @floatFromInt(sorted.len - 1);
+    const i: usize = @intFromFloat(@round(q * last));
+    return @as(f32, @floatFromInt(sorted[i])) / 1e6;
+}
+
+const TestQueue = RemeshQueue(u32);
+
+fn test_view() View {
+    return .{ .position = math.Vec3.zero(), .predicted = math.Vec3.zero(), .projection_scale = projection_scale(std.math.pi / 3.0, 1080.0) };
+}
+
+fn at(x: f32) math.Vec3 {
+    return .{ .x = x, .y = 0.0, .z = 0.0 };
+}
+
+test "remesh queue ranks by screen-space error within its budgets" {
+    var queue = TestQueue.init(std.testing.allocator, .{ .max_in_flight = 2, .memory_bytes = 1000 });
+    defer queue.deinit();
+
+    try queue.request(1, .{ .center = at(400.0), .radius = 8.0, .geometric_error = 16.0 }, 0);
+    try queue.request(2, .{ .center = at(40.0), .radius = 8.0, .geometric_error = 16.0, .bytes = 900 }, 0);
+    try queue.request(3, .{ .center = at(40.0), .radius = 8.0, .geometric_error = 16.0, .prefetch = true, .bytes = 200 }, 0);
+    try queue.request(4, .{ .center = at(400.0), .radius = 8.0, .geometric_error = 16.0, .bytes = 50 }, 0);
+
+    queue.start_frame();
+    try queue.begin_pass(test_view(), 0);
+    const first = queue.next(0).?;
+    try std.testing.expectEqual(@as(u32, 2), first.key);
+    try queue.dispatched(first.key);
+    // The prefetch of the same brick is ranked second but does not fit next to the first job.
+    const second = queue.next(0).?;
+    try std.testing.expect(second.key == 1 or second.key == 4);
+    try queue.dispatched(second.key);
+    try std.testing.expect(queue.next(0) == null);
+
+    const s = queue.stats();
+    try std.testing.expectEqual(@as(u32, 2), s.queue_depth);
+    try std.testing.expectEqual(@as(u32, 2), s.in_flight);
+    try std.testing.expect(s.deferred > 0);
+
+    // Out of frame time: nothing more this frame even with room in flight.
+    queue.cancelled(first.key);
+    queue.start_frame();
+    try queue.begin_pass(test_view(), 0);
+    try std.testing.expect(queue.next(queue.budget.frame_time_ns) == null);
+}
+
+test "remesh queue supersedes stale jobs and reports latency from the first request" {
+    var queue = TestQueue.init(std.testing.allocator, .{});
+    defer queue.deinit();
+    const ms = std.time.ns_per_ms;
+
+    try queue.request(7, .{ .center = at(10.0), .radius = 1.0, .geometric_error = 1.0, .generation = 1 }, 0);
+    try queue.begin_pass(test_view(), 0);
+    try std.testing.expectEqual(@as(u32, 7), queue.next(0).?.key);
+    try queue.dispatched(7);
+
+    // An edit lands while the job runs: the job is stale and the key waits until it is gone.
+    try queue.request(7, .{ .center = at(10.0), .radius = 1.0, .geometric_error = 1.0, .generation = 2 }, 5 * ms);
+    try std.testing.expectEqual(@as(?u32, 7), queue.pop_stale());
+    try std.testing.expectEqual(@as(?u32, null), queue.pop_stale());
+    try queue.begin_pass(test_view(), 5 * ms);
+    try std.testing.expect(queue.next(5 * ms) == null);
+
+    queue.complete(7, 8 * ms);
+    try std.testing.expectEqual(@as(u64, 0), queue.stats().completed);
+    try queue.begin_pass(test_view(), 10 * ms);
+    const ticket = queue.next(10 * ms).?;
+    try std.testing.expectEqual(@as(u32, 2), ticket.request.generation);
+    try queue.dispatched(7);
+    queue.complete(7, 20 * ms);
+
+    const s = queue.stats();
+    try std.testing.expectEqual(@as(u64, 1), s.completed);
+    try std.testing.expectEqual(@as(u64, 1), s.superseded);
+    try std.testing.expectEqual(@as(u32, 0), s.queue_depth);
+    try std.testing.expectApproxEqAbs(@as(f32, 20.0), s.latency_p50_ms, 1e-3);
+}
+
+test "camera predictor extrapolates smoothed velocity" {
+    var cam = CameraPredictor{ .smoothing = 1.0 };
+    cam.update(at(0.0), 0);
+    cam.update(at(1.0), 100 * std.time.ns_per_ms);
+    try std.testing.expectApproxEqAbs(@as(f32, 6.0), cam.predict(0.5).x, 1e-3);
+    // A long pause resets the velocity instead of extrapolating across it.
+    cam.update(at(2.0), 2 * std.time.ns_per_s);
+    try std.testing.expectApproxEqAbs(@as(f32, 2.0), cam.predict(0.5).x, 1e-3);
+}
+
+test "remesh queue charges every pass in a frame to one time budget" {
+    var queue = TestQueue.init(std.testing.allocator, .{ .frame_time_ns = 10, .max_in_flight = 16 });
+    defer queue.deinit();
+
+    for (0..4) |i| {
+        try queue.request(@intCast(i), .{ .center = at(10.0 * @as(f32, @floatFromInt(i + 1))), .radius = 1.0, .geometric_error = 1.0 }, 0);
+    }
+
+    queue.start_frame();
+    try queue.begin_pass(test_view(), 0);
+    try std.testing.expectEqual(@as(u32, 0), queue.next(0).?.key);
+    try queue.dispatched(0);
+    try std.testing.expectEqual(@as(u32, 1), queue.next(6).?.key);
+    try queue.dispatched(1);
+
+    // A second pass in the same frame, after unrelated work, only has the remaining 4 ns.
+    try queue.begin_pass(test_view(), 100);
+    try std.testing.expectEqual(@as(u32, 2), queue.next(100).?.key);
+    try queue.dispatched(2);
+    try std.testing.expect(queue.next(104) == null);
+    try std.testing.expectEqual(@as(u32, 1), queue.stats().deferred);
+
+    // The next frame starts over.
+    queue.start_frame();
+    try queue.begin_pass(test_view(), 200);
+    try std.testing.expectEqual(@as(u32, 3), queue.next(200).?.key);
+}
+
+test "remesh queue ages waiting requests and releases cancelled work" {
+    var queue = TestQueue.init(std.testing.allocator, .{ .memory_bytes = 100, .max_in_flight = 4 });
+    defer queue.deinit();
+    queue.age_weight = 10.0;
+    const s = std.time.ns_per_s;
+
+    // The far brick has waited a second longer, which outweighs the near one's larger error.
+    try queue.request(1, .{ .center = at(60.0), .radius = 1.0, .geometric_error = 1.0, .bytes = 60 }, 0);
+    try queue.request(2, .{ .center = at(20.0), .radius = 1.0, .geometric_error = 1.0, .bytes = 60 }, s);
+    queue.start_frame();
+    try queue.begin_pass(test_view(), s);
+    const first = queue.next(s).?;
+    try std.testing.expectEqual(@as(u32, 1), first.key);
+    try queue.dispatched(first.key);
+    // The second job does not fit the memory budget next to the first.
+    try std.testing.expect(queue.next(s) == null);
+    try std.testing.expectEqual(@as(u64, 60), queue.stats().in_flight_bytes);
+
+    // Cancelling the job frees its bytes; cancelling the request drops it from the queue.
+    queue.cancelled(1);
+    try std.testing.expectEqual(@as(u64, 0), queue.stats().in_flight_bytes);
+    try std.testing.expect(!queue.is_in_flight(1));
+    queue.cancel(2);
+    queue.start_frame();
+    try queue.begin_pass(test_view(), 2 * s);
+    try std.testing.expect(queue.next(2 * s) == null);
+    try std.testing.expectEqual(@as(u32, 0), queue.stats().queue_depth);
+    try std.testing.expectEqual(@as(u64, 0), queue.stats().completed);
+}
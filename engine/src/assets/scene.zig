@@ -172,6 +172,36 @@ pub const CardinalMesh = extern struct {
     bounding_box_max: [3]f32,
 };
 
+/// Kind of change recorded for a range of scene meshes.
+pub const CardinalSceneChange = enum(c_int) {
+    /// New meshes/materials/textures were written; GPU data must be uploaded.
+    ADDED = 0,
+    /// Meshes were released; their slots are now empty and hidden.
+    REMOVED = 1,
+    /// Only per-mesh visibility flags changed.
+    VISIBILITY = 2,
+    /// The combined skins were rebuilt; skin and joint bindings of these meshes may have moved.
+    SKINNING = 3,
+    /// CPU-deformed vertices (morph targets) of one mesh changed; only that vertex range is uploaded.
+    VERTICES = 4,
+};
+
+/// A changed range of scene meshes, used to patch renderer-side scene copies in place.
+///
+/// `ADDED` ranges also name the material and texture slots written for the new meshes, and
+/// `VERTICES` ranges name the changed vertices of their single mesh; other changes leave them zero.
+pub const CardinalSceneDirtyRange = extern struct {
+    first_mesh: u32,
+    mesh_count: u32,
+    change: CardinalSceneChange,
+    first_material: u32 = 0,
+    material_count: u32 = 0,
+    first_texture: u32 = 0,
+    texture_count: u32 = 0,
+    first_vertex: u32 = 0,
+    vertex_count: u32 = 0,
+};
+
 /// A transform node in the scene DAG.
 ///
 /// The node owns its child pointer array, mesh index array, and name string.
@@ -11,6 +11,7 @@ const scene_pkg = @import("scene.zig");
 const transform_math = @import("../core/transform.zig");
 const async_loader = @import("../core/async_loader.zig");
 const asset_database = @import("asset_database.zig");
+const memory = @import("../core/memory.zig");
 
 const json = @import("scene_serializer_json.zig");
 const ser_name = @import("scene_serializer_components/name.zig");
@@ -56,14 +57,7 @@ pub const SceneSerializer = struct {
         try json_writer.write(4);
 
         if (self.model_manager) |mgr| {
-            var meta_db: asset_database.AssetDatabase = undefined;
-            var meta_db_ready = false;
-            defer if (meta_db_ready) meta_db.deinit();
-
-            if (asset_database.AssetDatabase.init(self.allocator, root_path orelse "")) |db| {
-                meta_db = db;
-                meta_db_ready = true;
-            } else |_| {}
+            const meta_db = sharedAssetDatabase(root_path);
 
             try json_writer.objectField("models");
             try json_writer.beginArray();
@@ -90,8 +84,8 @@ pub const SceneSerializer = struct {
                     try json_writer.objectField("guid");
                     if (model.file_path) |path| {
                         const path_slice = std.mem.span(path);
-                        if (meta_db_ready) {
-                            if (meta_db.getOrCreateGuidForAsset(path_slice)) |g| {
+                        if (meta_db) |db| {
+                            if (db.getOrCreateGuidForAsset(path_slice)) |g| {
                                 var buf: [32]u8 = undefined;
                                 asset_database.guidToHex(g, &buf);
                                 try json_writer.write(buf[0..]);
@@ -138,7 +132,7 @@ pub const SceneSerializer = struct {
             if (!is_free[i]) {
                 const gen = handle_mgr.generations.items[i];
                 const entity = entity_pkg.Entity.make(i, gen);
-                if (self.registry.get(components.EditorOnly, entity) != null) continue;
+                if (self.registry.get_const(components.EditorOnly, entity) != null) continue;
 
                 try json_writer.beginObject();
 
@@ -148,62 +142,62 @@ pub const SceneSerializer = struct {
                 try json_writer.objectField("components");
                 try json_writer.beginObject();
 
-                if (self.registry.get(components.Name, entity)) |name| {
+                if (self.registry.get_const(components.Name, entity)) |name| {
                     try json_writer.objectField("Name");
                     try ser_name.serialize(&json_writer, name);
                 }
 
-                if (self.registry.get(components.Hierarchy, entity)) |hierarchy| {
+                if (self.registry.get_const(components.Hierarchy, entity)) |hierarchy| {
                     try json_writer.objectField("Hierarchy");
                     try ser_hierarchy.serialize(&json_writer, hierarchy);
                 }
 
-                if (self.registry.get(components.Transform, entity)) |transform| {
+                if (self.registry.get_const(components.Transform, entity)) |transform| {
                     try json_writer.objectField("Transform");
                     try ser_transform.serialize(&json_writer, transform);
                 }
 
-                if (self.registry.get(components.Node, entity)) |node| {
+                if (self.registry.get_const(components.Node, entity)) |node| {
                     try json_writer.objectField("Node");
                     try ser_node.serialize(&json_writer, node);
                 }
 
-                if (self.registry.get(components.MeshRenderer, entity)) |mesh_renderer| {
+                if (self.registry.get_const(components.MeshRenderer, entity)) |mesh_renderer| {
                     try json_writer.objectField("MeshRenderer");
                     try ser_mesh_renderer.serialize(&json_writer, mesh_renderer);
                 }
 
-                if (self.registry.get(components.Terrain, entity)) |terrain| {
+                if (self.registry.get_const(components.Terrain, entity)) |terrain| {
                     try json_writer.objectField("Terrain");
                     try ser_terrain.serialize(&json_writer, terrain);
                 }
 
-                if (self.registry.get(components.VolumetricTerrain, entity)) |vt| {
+                if (self.registry.get_const(components.VolumetricTerrain, entity)) |vt| {
                     try json_writer.objectField("VolumetricTerrain");
                     try ser_volumetric_terrain.serialize(&json_writer, vt);
                 }
 
-                if (self.registry.get(components.Skybox, entity)) |skybox| {
+                if (self.registry.get_const(components.Skybox, entity)) |skybox| {
                     try json_writer.objectField("Skybox");
                     try ser_skybox.serialize(&json_writer, self.allocator, skybox, root_path);
                 }
 
-                if (self.registry.get(components.Light, entity)) |light| {
+                if (self.registry.get_const(components.Light, entity)) |light| {
                     try json_writer.objectField("Light");
                     try ser_light.serialize(&json_writer, light);
                 }
 
-                if (self.registry.get(components.Camera, entity)) |camera| {
+                if (self.registry.get_const(components.Camera, entity)) |camera| {
                     try json_writer.objectField("Camera");
                     try ser_camera.serialize(&json_writer, camera);
                 }
 
-                if (self.registry.get(components.Script, entity)) |script| {
+                if (self.registry.get_const(components.Script, entity)) |script| {
                     try json_writer.objectField("Script");
                     try ser_script.serialize(&json_writer, script);
                 }
 
-                if (self.registry.get(components.EditorGlobals, entity)) |g| {
+                if (self.registry.get_const(components.EditorGlobals, entity)) |g| {
                     try json_writer.objectField("EditorGlobals");
                     try ser_editor_globals.serialize(&json_writer, g);
                 }
@@ -268,9 +262,7 @@ pub const SceneSerializer = struct {
         var total_mesh_count: u32 = 0;
 
         if (self.model_manager) |mgr| {
-            var meta_db: asset_database.AssetDatabase = undefined;
-            var meta_db_ready = false;
-            defer if (meta_db_ready) meta_db.deinit();
+            var meta_db: ?*asset_database.AssetDatabase = null;
 
             var requested_models = std.ArrayListUnmanaged(u32){};
             defer requested_models.deinit(self.allocator);
@@ -290,12 +282,12 @@ pub const SceneSerializer = struct {
                         }
 
                         if (needs_meta_scan) {
-                            meta_db = try asset_database.AssetDatabase.init(self.allocator, root_dir);
-                            meta_db_ready = true;
-                            meta_db.refresh() catch {
-                                meta_db_ready = false;
-                                meta_db.deinit();
-                            };
+                            if (sharedAssetDatabase(root_dir)) |db| {
+                                // Incremental: only directories changed since the last refresh are listed.
+                                if (db.refresh()) |_| {
+                                    meta_db = db;
+                                } else |_| {}
+                            }
                         }
                     }
 
@@ -303,11 +295,11 @@ pub const SceneSerializer = struct {
                         if (model_val != .object) continue;
 
                         var resolved_path: ?[]const u8 = null;
-                        if (meta_db_ready) {
+                        if (meta_db) |db| {
                             if (model_val.object.get("guid")) |guid_val| {
                                 if (guid_val == .string) {
                                     if (asset_database.parseGuidHex(guid_val.string)) |guid| {
-                                        resolved_path = meta_db.resolvePathByGuid(guid);
+                                        resolved_path = db.resolvePathByGuid(guid);
                                     } else |_| {}
                                 }
                             }
@@ -669,11 +661,11 @@ pub const SceneSerializer = struct {
         while (i < entities.len) : (i += 1) {
             const ent = entities[i];
 
-            if (self.registry.get(components.Transform, ent) == null) {
+            if (self.registry.get_const(components.Transform, ent) == null) {
                 self.registry.add(ent, components.Transform{}) catch {};
             }
 
-            if (self.registry.get(components.Hierarchy, ent) == null) {
+            if (self.registry.get_const(components.Hierarchy, ent) == null) {
                 self.registry.add(ent, components.Hierarchy{}) catch {};
             }
 
@@ -687,13 +679,13 @@ pub const SceneSerializer = struct {
                 self.registry.add(ent, components.Node{ .type = inferred }) catch {};
             }
 
-            if (self.registry.get(components.Name, ent) == null) {
+            if (self.registry.get_const(components.Name, ent) == null) {
                 var buf: [64]u8 = undefined;
                 const name = self.suggest_entity_name(ent, i, &buf, &mesh_name_by_index);
                 self.registry.add(ent, components.Name.init(name)) catch {};
             }
 
-            if (combined_scene != null and self.registry.get(components.MeshRenderer, ent) == null) {
+            if (combined_scene != null and self.registry.get_const(components.MeshRenderer, ent) == null) {
                 const name_ptr = self.registry.get(components.Name, ent) orelse continue;
                 const key = name_ptr.slice();
                 if (node_by_name.get(key)) |node| {
@@ -787,30 +779,30 @@ pub const SceneSerializer = struct {
     }
 
     fn infer_node_type(self: *SceneSerializer, entity: entity_pkg.Entity) components.NodeType {
-        if (self.registry.get(components.Skybox, entity) != null) return .Skybox;
-        if (self.registry.get(components.Terrain, entity) != null) return .Terrain3D;
-        if (self.registry.get(components.Light, entity)) |l| {
+        if (self.registry.get_const(components.Skybox, entity) != null) return .Skybox;
+        if (self.registry.get_const(components.Terrain, entity) != null) return .Terrain3D;
+        if (self.registry.get_const(components.Light, entity)) |l| {
             return switch (l.type) {
                 .Directional => .DirectionalLight3D,
                 .Point => .PointLight3D,
                 .Spot => .SpotLight3D,
             };
         }
-        if (self.registry.get(components.Camera, entity)) |c| {
+        if (self.registry.get_const(components.Camera, entity)) |c| {
             return switch (c.type) {
                 .Perspective => .Camera3D,
                 .Orthographic => .Camera2D,
             };
         }
-        if (self.registry.get(components.MeshRenderer, entity) != null) return .MeshInstance3D;
-        if (self.registry.get(components.Transform, entity) != null) return .Node3D;
+        if (self.registry.get_const(components.MeshRenderer, entity) != null) return .MeshInstance3D;
+        if (self.registry.get_const(components.Transform, entity) != null) return .Node3D;
         return .Node;
     }
 
     fn suggest_entity_name(self: *SceneSerializer, entity: entity_pkg.Entity, idx: usize, buf: *[64]u8, mesh_name_by_index: *const std.AutoHashMapUnmanaged(u32, []const u8)) []const u8 {
-        if (self.registry.get(components.Skybox, entity) != null) return "Skybox";
+        if (self.registry.get_const(components.Skybox, entity) != null) return "Skybox";
 
-        if (self.registry.get(components.Light, entity)) |l| {
+        if (self.registry.get_const(components.Light, entity)) |l| {
             return switch (l.type) {
                 .Directional => "Directional Light",
                 .Point => "Point Light",
@@ -818,19 +810,19 @@ pub const SceneSerializer = struct {
             };
         }
 
-        if (self.registry.get(components.Camera, entity)) |c| {
+        if (self.registry.get_const(components.Camera, entity)) |c| {
             return switch (c.type) {
                 .Perspective => "Camera3D",
                 .Orthographic => "Camera2D",
             };
         }
 
-        if (self.registry.get(components.MeshRenderer, entity)) |mr| {
+        if (self.registry.get_const(components.MeshRenderer, entity)) |mr| {
             if (mesh_name_by_index.get(mr.mesh.index)) |name| return name;
             return std.fmt.bufPrint(buf, "Mesh{d}", .{mr.mesh.index}) catch "Mesh";
         }
 
-        if (self.registry.get(components.Script, entity) != null) {
+        if (self.registry.get_const(components.Script, entity) != null) {
             return std.fmt.bufPrint(buf, "Script{d}", .{idx}) catch "Script";
         }
 
@@ -838,6 +830,14 @@ pub const SceneSerializer = struct {
     }
 };
 
+/// Returns the long-lived asset database, opening one at `root_path` if none is open yet.
+fn sharedAssetDatabase(root_path: ?[]const u8) ?*asset_database.AssetDatabase {
+    if (asset_database.getShared()) |db| return db;
+    const root = root_path orelse return null;
+    const allocator = memory.cardinal_get_allocator_for_category(.ASSETS).as_allocator();
+    return asset_database.openShared(allocator, root) catch null;
+}
+
 fn JsonWriter(comptime WriterType: type) type {
     return struct {
         const Scope = struct {
@@ -4,7 +4,7 @@ const components = @import("../../ecs/components.zig");
 const json = @import("../scene_serializer_json.zig");
 
 /// Serializes camera projection parameters.
-pub fn serialize(writer: anytype, c: *components.Camera) !void {
+pub fn serialize(writer: anytype, c: *const components.Camera) !void {
     try writer.beginObject();
     try writer.objectField("type");
     try writer.write(@intFromEnum(c.type));
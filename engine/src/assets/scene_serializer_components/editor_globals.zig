@@ -6,7 +6,7 @@ const std = @import("std");
 const components = @import("../../ecs/components.zig");
 
 /// Serializes `EditorGlobals` into a JSON object.
-pub fn serialize(writer: anytype, g: *components.EditorGlobals) !void {
+pub fn serialize(writer: anytype, g: *const components.EditorGlobals) !void {
     try writer.beginObject();
 
     try writer.objectField("camera_position");
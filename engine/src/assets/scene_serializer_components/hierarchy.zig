@@ -6,7 +6,7 @@ const components = @import("../../ecs/components.zig");
 const serializer_log = std.log.scoped(.scene_serializer);
 
 /// Serializes hierarchy links using entity IDs.
-pub fn serialize(writer: anytype, h: *components.Hierarchy) !void {
+pub fn serialize(writer: anytype, h: *const components.Hierarchy) !void {
     try writer.beginObject();
     try writer.objectField("parent");
     if (h.parent) |p| try writer.write(p.id) else try writer.write(null);
@@ -4,7 +4,7 @@ const components = @import("../../ecs/components.zig");
 const json = @import("../scene_serializer_json.zig");
 
 /// Serializes light parameters and type.
-pub fn serialize(writer: anytype, l: *components.Light) !void {
+pub fn serialize(writer: anytype, l: *const components.Light) !void {
     try writer.beginObject();
     try writer.objectField("type");
     try writer.write(@intFromEnum(l.type));
@@ -3,7 +3,7 @@ const std = @import("std");
 const components = @import("../../ecs/components.zig");
 
 /// Serializes mesh/material handles and visibility flags.
-pub fn serialize(writer: anytype, mr: *components.MeshRenderer) !void {
+pub fn serialize(writer: anytype, mr: *const components.MeshRenderer) !void {
     try writer.beginObject();
     try writer.objectField("mesh_id");
     try writer.write(mr.mesh.index);
@@ -3,7 +3,7 @@ const std = @import("std");
 const components = @import("../../ecs/components.zig");
 
 /// Serializes a name as a JSON string.
-pub fn serialize(writer: anytype, n: *components.Name) !void {
+pub fn serialize(writer: anytype, n: *const components.Name) !void {
     try writer.write(n.slice());
 }
 
@@ -3,7 +3,7 @@ const std = @import("std");
 const components = @import("../../ecs/components.zig");
 
 /// Serializes a node type tag.
-pub fn serialize(writer: anytype, n: *components.Node) !void {
+pub fn serialize(writer: anytype, n: *const components.Node) !void {
     try writer.beginObject();
     try writer.objectField("type");
     try writer.write(@tagName(n.type));
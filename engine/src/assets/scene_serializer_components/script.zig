@@ -3,7 +3,7 @@ const std = @import("std");
 const components = @import("../../ecs/components.zig");
 
 /// Serializes script metadata only.
-pub fn serialize(writer: anytype, s: *components.Script) !void {
+pub fn serialize(writer: anytype, s: *const components.Script) !void {
     try writer.beginObject();
     try writer.objectField("script_id");
     try writer.write(s.script_id);
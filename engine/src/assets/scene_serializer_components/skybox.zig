@@ -3,7 +3,7 @@ const std = @import("std");
 const components = @import("../../ecs/components.zig");
 
 /// Serializes a skybox path, using `root_path` for relative output when possible.
-pub fn serialize(writer: anytype, allocator: std.mem.Allocator, s: *components.Skybox, root_path: ?[]const u8) !void {
+pub fn serialize(writer: anytype, allocator: std.mem.Allocator, s: *const components.Skybox, root_path: ?[]const u8) !void {
     const path_slice = s.slice();
     if (path_slice.len == 0) {
         try writer.write("");
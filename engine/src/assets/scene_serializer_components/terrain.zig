@@ -23,7 +23,7 @@ fn deserializeVec2(val: std.json.Value) !math.Vec2 {
 }
 
 /// Serializes `Terrain` into a JSON object.
-pub fn serialize(writer: anytype, t: *components.Terrain) !void {
+pub fn serialize(writer: anytype, t: *const components.Terrain) !void {
     try writer.beginObject();
     try writer.objectField("size");
     try serializeVec2(writer, t.size);
@@ -4,7 +4,7 @@ const components = @import("../../ecs/components.zig");
 const json = @import("../scene_serializer_json.zig");
 
 /// Serializes `Transform` as `{ position, rotation, scale }`.
-pub fn serialize(writer: anytype, t: *components.Transform) !void {
+pub fn serialize(writer: anytype, t: *const components.Transform) !void {
     try writer.beginObject();
     try writer.objectField("position");
     try json.serializeVec3(writer, t.position);
@@ -18,7 +18,7 @@ fn deserializeVec3(val: std.json.Value) !math.Vec3 {
     };
 }
 
-pub fn serialize(writer: anytype, t: *components.VolumetricTerrain) !void {
+pub fn serialize(writer: anytype, t: *const components.VolumetricTerrain) !void {
     try writer.beginObject();
     try writer.objectField("size");
     try serializeVec3(writer, t.size);
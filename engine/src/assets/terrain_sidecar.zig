@@ -0,0 +1,1207 @@
+//! Chunked terrain sidecar files (`.cts`).
+//!
+//! Stores regular grids of terrain samples (heightfield heights, volumetric density, splat
+//! weights) split into fixed-size chunks so a loader can decode any subset of them, in parallel,
+//! without touching the rest of the file. Layout:
+//!
+//! - `SidecarHeader` at offset 0: grid extent, chunk extent and the channel layout.
+//! - Chunk payloads, in chunk index order.
+//! - The directory: one `ChunkEntry` per chunk, covered by `directory_crc32`.
+//!
+//! A chunk payload holds every channel of the chunk back to back. Samples are decorrelated before
+//! compression: floats are predicted from their already-decoded neighbours (a 2D parallelogram
+//! predictor within each slice), the residual is taken between order-preserving integer images
+//! of the floats and zigzag-folded, and the four bytes of each residual are split into separate
+//! planes so the high bytes form long zero runs. Byte channels are delta-coded per component
+//! against the left/upper neighbour. The result is deflated (miniz; LZ77 plus Huffman coding)
+//! and stored raw when that does not help. Every chunk carries a CRC-32 of its decorrelated bytes.
+//!
+//! Chunks decode independently, so `SidecarFile.read_chunks` fans them out over the job system and
+//! `SidecarFile.chunks_near` picks the ones within a radius of a point for partial streaming loads.
+//! The legacy run-length codec used by older editor terrain files is kept here for reading them
+//! and for comparison benchmarks.
+const std = @import("std");
+const log = @import("../core/log.zig");
+const job_system = @import("../core/job_system.zig");
+
+const c = @cImport({
+    @cInclude("miniz.h");
+});
+
+const sidecar_log = log.ScopedLogger("TERRAIN_SIDECAR");
+
+pub const SIDECAR_MAGIC = [4]u8{ 'C', 'T', 'S', 'C' };
+pub const SIDECAR_VERSION: u32 = 1;
+/// Conventional file extension for terrain sidecars.
+pub const SIDECAR_EXTENSION = ".cts";
+/// Maximum channels per file.
+pub const MAX_CHANNELS: usize = 4;
+
+pub const ChannelKind = enum(u32) {
+    f32 = 0,
+    u8 = 1,
+    /// Four interleaved byte components per sample (splat weights).
+    rgba8 = 2,
+};
+
+/// Bytes per sample of `kind`.
+pub fn sample_size(kind: ChannelKind) usize {
+    return switch (kind) {
+        .f32, .rgba8 => 4,
+        .u8 => 1,
+    };
+}
+
+pub const Compression = enum(u32) {
+    none = 0,
+    /// zlib-wrapped deflate (miniz).
+    deflate = 1,
+};
+
+pub const SidecarHeader = extern struct {
+    magic: [4]u8,
+    version: u32,
+    /// Samples along x, y and z. Samples are stored x-fastest; 2D grids use z = 1.
+    extent: [3]u32,
+    /// Samples per chunk along each axis; edge chunks are clipped to the extent.
+    chunk_extent: [3]u32,
+    channel_count: u32,
+    channel_kinds: [MAX_CHANNELS]u32,
+    chunk_count: u32,
+    flags: u32 = 0,
+    reserved0: u32 = 0,
+    directory_offset: u64,
+    directory_crc32: u32,
+    reserved1: u32 = 0,
+};
+
+pub const ChunkEntry = extern struct {
+    offset: u64,
+    /// Bytes occupied in the file.
+    stored_size: u32,
+    /// Bytes of the decorrelated payload before compression.
+    raw_size: u32,
+    /// CRC-32 of the decorrelated payload.
+    crc32: u32,
+    compression: u32,
+};
+
+/// A channel to write: `data` holds `extent[0] * extent[1] * extent[2]` samples of `kind`.
+pub const ChannelSource = struct {
+    kind: ChannelKind,
+    data: []const u8,
+};
+
+/// A channel to read into; same layout as `ChannelSource`.
+pub const ChannelTarget = struct {
+    kind: ChannelKind,
+    data: []u8,
+};
+
+pub const Box = struct {
+    min: [3]u32,
+    /// Exclusive.
+    max: [3]u32,
+
+    pub fn dims(self: Box) [3]u32 {
+        return .{ self.max[0] - self.min[0], self.max[1] - self.min[1], self.max[2] - self.min[2] };
+    }
+
+    pub fn sample_count(self: Box) usize {
+        const d = self.dims();
+        return @as(usize, d[0]) * d[1] * d[2];
+    }
+};
+
+/// Number of chunks along each axis.
+pub fn chunk_grid(extent: [3]u32, chunk_extent: [3]u32) [3]u32 {
+    var grid: [3]u32 = undefined;
+    for (0..3) |axis| grid[axis] = std.math.divCeil(u32, extent[axis], chunk_extent[axis]) catch unreachable;
+    return grid;
+}
+
+/// Total chunk count of `grid`; fails if it does not fit the header's 32-bit count.
+fn grid_chunk_count(grid: [3]u32) !u32 {
+    const plane = std.math.mul(u32, grid[0], grid[1]) catch return error.InvalidTerrainSidecar;
+    return std.math.mul(u32, plane, grid[2]) catch return error.InvalidTerrainSidecar;
+}
+
+/// Sample bounds of chunk `index` (x-fastest chunk order).
+pub fn chunk_box(extent: [3]u32, chunk_extent: [3]u32, index: u32) Box {
+    const grid = chunk_grid(extent, chunk_extent);
+    const coords = [3]u32{ index % grid[0], (index / grid[0]) % grid[1], index / (grid[0] * grid[1]) };
+    var box: Box = undefined;
+    for (0..3) |axis| {
+        box.min[axis] = coords[axis] * chunk_extent[axis];
+        box.max[axis] = box.min[axis] + @min(chunk_extent[axis], extent[axis] - box.min[axis]);
+    }
+    return box;
+}
+
+fn grid_sample_count(extent: [3]u32) usize {
+    return @as(usize, extent[0]) * extent[1] * extent[2];
+}
+
+fn payload_size(kinds: []const ChannelKind, samples: usize) usize {
+    var size: usize = 0;
+    for (kinds) |kind| size += samples * sample_size(kind);
+    return size;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Sample decorrelation
+// ---------------------------------------------------------------------------------------------
+
+/// Maps float bits to an unsigned integer with the same ordering, so nearby floats of either sign
+/// map to nearby integers.
+fn float_order(bits: u32) u32 {
+    return if (bits & 0x8000_0000 != 0) ~bits else bits | 0x8000_0000;
+}
+
+fn float_unorder(key: u32) u32 {
+    return if (key & 0x8000_0000 != 0) key & 0x7FFF_FFFF else ~key;
+}
+
+fn zigzag(v: u32) u32 {
+    return (v << 1) ^ (0 -% (v >> 31));
+}
+
+fn unzigzag(v: u32) u32 {
+    return (v >> 1) ^ (0 -% (v & 1));
+}
+
+/// Parallelogram prediction within the xy slice, falling back to the nearest decoded neighbour
+/// on the slice edges. `s` holds the chunk's samples up to (not including) `i`. NaN predictions
+/// are replaced by zero because NaN payloads are not portable across CPUs.
+fn predict_f32(s: []const f32, w: usize, h: usize, x: usize, y: usize, z: usize, i: usize) f32 {
+    const pred = if (x > 0 and y > 0)
+        s[i - 1] + s[i - w] - s[i - w - 1]
+    else if (x > 0)
+        s[i - 1]
+    else if (y > 0)
+        s[i - w]
+    else if (z > 0)
+        s[i - w * h]
+    else
+        0.0;
+    return if (std.math.isNan(pred)) 0.0 else pred;
+}
+
+/// Encodes `samples` (a `w x h x d` block) as four residual byte planes in `out`.
+fn encode_f32(samples: []const f32, dims: [3]u32, out: []u8) void {
+    const n = samples.len;
+    const w: usize = dims[0];
+    const h: usize = dims[1];
+    var i: usize = 0;
+    for (0..dims[2]) |z| {
+        for (0..h) |y| {
+            for (0..w) |x| {
+                const pred = predict_f32(samples, w, h, x, y, z, i);
+                const residual = zigzag(float_order(@bitCast(samples[i])) -% float_order(@bitCast(pred)));
+                out[i] = @truncate(residual);
+                out[n + i] = @truncate(residual >> 8);
+                out[2 * n + i] = @truncate(residual >> 16);
+                out[3 * n + i] = @truncate(residual >> 24);
+                i += 1;
+            }
+        }
+    }
+}
+
+fn decode_f32(planes: []const u8, dims: [3]u32, samples: []f32) void {
+    const n = samples.len;
+    const w: usize = dims[0];
+    const h: usize = dims[1];
+    var i: usize = 0;
+    for (0..dims[2]) |z| {
+        for (0..h) |y| {
+            for (0..w) |x| {
+                const residual = @as(u32, planes[i]) |
+                    (@as(u32, planes[n + i]) << 8) |
+                    (@as(u32, planes[2 * n + i]) << 16) |
+                    (@as(u32, planes[3 * n + i]) << 24);
+                const pred = predict_f32(samples, w, h, x, y, z, i);
+                const key = unzigzag(residual) +% float_order(@bitCast(pred));
+                samples[i] = @bitCast(float_unorder(key));
+                i += 1;
+            }
+        }
+    }
+}
+
+/// Left, upper or previous-slice neighbour of byte component `comp` of sample `i`.
+fn predict_byte(s: []const u8, comps: usize, comp: usize, w: usize, h: usize, x: usize, y: usize, z: usize, i: usize) u8 {
+    if (x > 0) return s[(i - 1) * comps + comp];
+    if (y > 0) return s[(i - w) * comps + comp];
+    if (z > 0) return s[(i - w * h) * comps + comp];
+    return 0;
+}
+
+/// Encodes `comps` interleaved byte components per sample as per-component delta planes.
+fn encode_bytes(samples: []const u8, comps: usize, dims: [3]u32, out: []u8) void {
+    const n = samples.len / comps;
+    const w: usize = dims[0];
+    const h: usize = dims[1];
+    var i: usize = 0;
+    for (0..dims[2]) |z| {
+        for (0..h) |y| {
+            for (0..w) |x| {
+                for (0..comps) |comp| {
+                    const pred = predict_byte(samples, comps, comp, w, h, x, y, z, i);
+                    out[comp * n + i] = samples[i * comps + comp] -% pred;
+                }
+                i += 1;
+            }
+        }
+    }
+}
+
+fn decode_bytes(planes: []const u8, comps: usize, dims: [3]u32, samples: []u8) void {
+    const n = samples.len / comps;
+    const w: usize = dims[0];
+    const h: usize = dims[1];
+    var i: usize = 0;
+    for (0..dims[2]) |z| {
+        for (0..h) |y| {
+            for (0..w) |x| {
+                for (0..comps) |comp| {
+                    const pred = predict_byte(samples, comps, comp, w, h, x, y, z, i);
+                    samples[i * comps + comp] = planes[comp * n + i] +% pred;
+                }
+                i += 1;
+            }
+        }
+    }
+}
+
+/// Copies the samples of `box` out of a full grid into a packed block.
+fn gather(grid: []const u8, extent: [3]u32, box: Box, elem: usize, out: []u8) void {
+    const row_bytes = @as(usize, box.max[0] - box.min[0]) * elem;
+    var dst: usize = 0;
+    var z = box.min[2];
+    while (z < box.max[2]) : (z += 1) {
+        var y = box.min[1];
+        while (y < box.max[1]) : (y += 1) {
+            const src = ((@as(usize, z) * extent[1] + y) * extent[0] + box.min[0]) * elem;
+            @memcpy(out[dst .. dst + row_bytes], grid[src .. src + row_bytes]);
+            dst += row_bytes;
+        }
+    }
+}
+
+/// Inverse of `gather`.
+fn scatter(block: []const u8, extent: [3]u32, box: Box, elem: usize, grid: []u8) void {
+    const row_bytes = @as(usize, box.max[0] - box.min[0]) * elem;
+    var src: usize = 0;
+    var z = box.min[2];
+    while (z < box.max[2]) : (z += 1) {
+        var y = box.min[1];
+        while (y < box.max[1]) : (y += 1) {
+            const dst = ((@as(usize, z) * extent[1] + y) * extent[0] + box.min[0]) * elem;
+            @memcpy(grid[dst .. dst + row_bytes], block[src .. src + row_bytes]);
+            src += row_bytes;
+        }
+    }
+}
+
+/// Per-job scratch reused across chunks.
+const Scratch = struct {
+    allocator: std.mem.Allocator,
+    /// Word storage so float blocks are naturally aligned.
+    words: std.ArrayListUnmanaged(u32) = .{},
+    payload: std.ArrayListUnmanaged(u8) = .{},
+    compressed: std.ArrayListUnmanaged(u8) = .{},
+
+    /// Returns a `len`-byte block, valid until the next call.
+    fn block(self: *Scratch, len: usize) ![]align(4) u8 {
+        try self.words.resize(self.allocator, (len + 3) / 4);
+        return std.mem.sliceAsBytes(self.words.items)[0..len];
+    }
+
+    fn deinit(self: *Scratch) void {
+        self.words.deinit(self.allocator);
+        self.payload.deinit(self.allocator);
+        self.compressed.deinit(self.allocator);
+    }
+};
+
+/// Builds the decorrelated payload of one chunk into `scratch.payload`.
+fn build_payload(scratch: *Scratch, extent: [3]u32, box: Box, channels: []const ChannelSource) !void {
+    const samples = box.sample_count();
+    const dims = box.dims();
+    scratch.payload.clearRetainingCapacity();
+    for (channels) |channel| {
+        const elem = sample_size(channel.kind);
+        const block = try scratch.block(samples * elem);
+        gather(channel.data, extent, box, elem, block);
+
+        const start = scratch.payload.items.len;
+        try scratch.payload.resize(scratch.allocator, start + samples * elem);
+        const out = scratch.payload.items[start..];
+        switch (channel.kind) {
+            .f32 => encode_f32(std.mem.bytesAsSlice(f32, block), dims, out),
+            .u8 => encode_bytes(block, 1, dims, out),
+            .rgba8 => encode_bytes(block, 4, dims, out),
+        }
+    }
+}
+
+/// Inverse of `build_payload`: reconstructs every channel of the chunk into the target grids.
+fn apply_payload(scratch: *Scratch, payload: []const u8, extent: [3]u32, box: Box, targets: []const ChannelTarget) !void {
+    const samples = box.sample_count();
+    const dims = box.dims();
+    var off: usize = 0;
+    for (targets) |target| {
+        const elem = sample_size(target.kind);
+        const planes = payload[off .. off + samples * elem];
+        off += samples * elem;
+
+        const block = try scratch.block(samples * elem);
+        switch (target.kind) {
+            .f32 => decode_f32(planes, dims, std.mem.bytesAsSlice(f32, block)),
+            .u8 => decode_bytes(planes, 1, dims, block),
+            .rgba8 => decode_bytes(planes, 4, dims, block),
+        }
+        scatter(block, extent, box, elem, target.data);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// Writing
+// ---------------------------------------------------------------------------------------------
+
+pub const WriteOptions = struct {
+    /// Samples per chunk along each axis. For volumes, match the brick size so a brick's samples
+    /// come from a handful of chunks.
+    chunk_extent: [3]u32 = .{ 32, 32, 32 },
+    /// miniz compression level (0-10).
+    level: c_int = 6,
+};
+
+pub const WriteStats = struct {
+    chunk_count: usize = 0,
+    compressed_count: usize = 0,
+    /// Sample bytes across all channels.
+    input_bytes: u64 = 0,
+    file_bytes: u64 = 0,
+};
+
+/// Chunks handed to one job; each chunk is a few hundred KiB of samples at the default extent.
+const CHUNKS_PER_JOB: u32 = 4;
+
+const EncodedChunk = struct {
+    entry: ChunkEntry = undefined,
+    bytes: ?[]u8 = null,
+    failed: bool = false,
+};
+
+const EncodeBatch = struct {
+    allocator: std.mem.Allocator,
+    extent: [3]u32,
+    options: *const WriteOptions,
+    channels: []const ChannelSource,
+    out: []EncodedChunk,
+    first: u32,
+    end: u32,
+
+    fn run(self: *const EncodeBatch) void {
+        var scratch = Scratch{ .allocator = self.allocator };
+        defer scratch.deinit();
+        var index = self.first;
+        while (index < self.end) : (index += 1) {
+            self.encode_chunk(&scratch, index) catch {
+                self.out[index].failed = true;
+            };
+        }
+    }
+
+    fn encode_chunk(self: *const EncodeBatch, scratch: *Scratch, index: u32) !void {
+        const box = chunk_box(self.extent, self.options.chunk_extent, index);
+        try build_payload(scratch, self.extent, box, self.channels);
+        const raw = scratch.payload.items;
+
+        var entry = ChunkEntry{
+            .offset = 0,
+            .stored_size = @intCast(raw.len),
+            .raw_size = @intCast(raw.len),
+            .crc32 = std.hash.Crc32.hash(raw),
+            .compression = @intFromEnum(Compression.none),
+        };
+
+        var stored: []const u8 = raw;
+        const bound: usize = @intCast(c.mz_compressBound(@intCast(raw.len)));
+        try scratch.compressed.resize(self.allocator, bound);
+        var out_len: c.mz_ulong = @intCast(bound);
+        const status = c.mz_compress2(scratch.compressed.items.ptr, &out_len, raw.ptr, @intCast(raw.len), self.options.level);
+        if (status == c.MZ_OK and out_len < raw.len) {
+            stored = scratch.compressed.items[0..@intCast(out_len)];
+            entry.stored_size = @intCast(out_len);
+            entry.compression = @intFromEnum(Compression.deflate);
+        }
+
+        self.out[index] = .{ .entry = entry, .bytes = try self.allocator.dupe(u8, stored) };
+    }
+};
+
+fn encode_batch_job(data: ?*anyopaque) callconv(.c) i32 {
+    const batch: *const EncodeBatch = @ptrCast(@alignCast(data.?));
+    batch.run();
+    return 0;
+}
+
+/// Runs `batches` on the job system when it is up, inline otherwise.
+fn run_batches(comptime Batch: type, allocator: std.mem.Allocator, batches: []Batch, func: job_system.JobFunc) !void {
+    if (batches.len == 1) {
+        batches[0].run();
+        return;
+    }
+
+    var jobs = std.ArrayListUnmanaged(*job_system.Job){};
+    defer jobs.deinit(allocator);
+    try jobs.ensureTotalCapacity(allocator, batches.len);
+
+    for (batches) |*batch| {
+        const job = job_system.create_job(func, batch, .NORMAL) orelse {
+            batch.run();
+            continue;
+        };
+        job.push_to_completed_queue = false;
+        while (!job_system.submit_job(job)) {
+            std.Thread.yield() catch {};
+        }
+        jobs.appendAssumeCapacity(job);
+    }
+
+    job_system.wait_for_jobs(jobs.items);
+    for (jobs.items) |job| job_system.free_job(job);
+}
+
+fn validate_layout(extent: [3]u32, chunk_extent: [3]u32, channel_count: usize) !void {
+    if (channel_count == 0 or channel_count > MAX_CHANNELS) return error.InvalidTerrainSidecar;
+    for (0..3) |axis| {
+        if (extent[axis] == 0 or chunk_extent[axis] == 0) return error.InvalidTerrainSidecar;
+    }
+    // A chunk's payload size is stored as u32; reject layouts whose largest chunk cannot fit.
+    var chunk_bytes: u64 = MAX_CHANNELS * 4;
+    for (chunk_extent) |e| chunk_bytes = std.math.mul(u64, chunk_bytes, e) catch return error.InvalidTerrainSidecar;
+    if (chunk_bytes > std.math.maxInt(u32)) return error.InvalidTerrainSidecar;
+}
+
+/// Writes `channels` (each a full `extent` grid) to `path`. Chunks are encoded on the job system
+/// when it is up; `allocator` is used from the worker threads. The file is written next to
+/// `path` and renamed into place, so readers never see a partial sidecar.
+pub fn write_file(allocator: std.mem.Allocator, path: []const u8, extent: [3]u32, channels: []const ChannelSource, options: WriteOptions) !WriteStats {
+    try validate_layout(extent, options.chunk_extent, channels.len);
+    const samples = grid_sample_count(extent);
+    for (channels) |channel| {
+        if (channel.data.len != samples * sample_size(channel.kind)) return error.InvalidTerrainSidecar;
+    }
+
+    const grid = chunk_grid(extent, options.chunk_extent);
+    const chunk_count = try grid_chunk_count(grid);
+
+    const encoded = try allocator.alloc(EncodedChunk, chunk_count);
+    defer {
+        for (encoded) |chunk| {
+            if (chunk.bytes) |bytes| allocator.free(bytes);
+        }
+        allocator.free(encoded);
+    }
+    @memset(encoded, .{});
+
+    const batch_count = (chunk_count + CHUNKS_PER_JOB - 1) / CHUNKS_PER_JOB;
+    const batches = try allocator.alloc(EncodeBatch, batch_count);
+    defer allocator.free(batches);
+    for (batches, 0..) |*batch, i| {
+        const first: u32 = @intCast(i * CHUNKS_PER_JOB);
+        batch.* = .{
+            .allocator = allocator,
+            .extent = extent,
+            .options = &options,
+            .channels = channels,
+            .out = encoded,
+            .first = first,
+            .end = @min(first + CHUNKS_PER_JOB, chunk_count),
+        };
+    }
+    try run_batches(EncodeBatch, allocator, batches, encode_batch_job);
+
+    var stats = WriteStats{ .chunk_count = chunk_count };
+    for (channels) |channel| stats.input_bytes += channel.data.len;
+
+    const entries = try allocator.alloc(ChunkEntry, chunk_count);
+    defer allocator.free(entries);
+    var offset: u64 = @sizeOf(SidecarHeader);
+    for (encoded, entries) |*chunk, *entry| {
+        if (chunk.failed) return error.OutOfMemory;
+        entry.* = chunk.entry;
+        entry.offset = offset;
+        offset += chunk.bytes.?.len;
+        if (entry.compression == @intFromEnum(Compression.deflate)) stats.compressed_count += 1;
+    }
+    const directory_offset = std.mem.alignForward(u64, offset, @alignOf(ChunkEntry));
+
+    var header = SidecarHeader{
+        .magic = SIDECAR_MAGIC,
+        .version = SIDECAR_VERSION,
+        .extent = extent,
+        .chunk_extent = options.chunk_extent,
+        .channel_count = @intCast(channels.len),
+        .channel_kinds = .{ 0, 0, 0, 0 },
+        .chunk_count = chunk_count,
+        .directory_offset = directory_offset,
+        .directory_crc32 = std.hash.Crc32.hash(std.mem.sliceAsBytes(entries)),
+    };
+    for (channels, 0..) |channel, i| header.channel_kinds[i] = @intFromEnum(channel.kind);
+
+    const tmp_path = try std.fmt.allocPrint(allocator, "{s}.tmp", .{path});
+    defer allocator.free(tmp_path);
+    {
+        const file = try std.fs.cwd().createFile(tmp_path, .{});
+        errdefer std.fs.cwd().deleteFile(tmp_path) catch {};
+        defer file.close();
+
+        try file.pwriteAll(std.mem.asBytes(&header), 0);
+        for (encoded, entries) |chunk, entry| try file.pwriteAll(chunk.bytes.?, entry.offset);
+        try file.pwriteAll(std.mem.sliceAsBytes(entries), directory_offset);
+    }
+    try std.fs.cwd().rename(tmp_path, path);
+
+    stats.file_bytes = directory_offset + entries.len * @sizeOf(ChunkEntry);
+    return stats;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Reading
+// ---------------------------------------------------------------------------------------------
+
+pub const ReadStats = struct {
+    chunk_count: usize = 0,
+    stored_bytes: u64 = 0,
+};
+
+/// An open sidecar. Chunk reads use positional I/O, so any number of threads may read chunks of
+/// the same file concurrently.
+pub const SidecarFile = struct {
+    allocator: std.mem.Allocator,
+    file: std.fs.File,
+    header: SidecarHeader,
+    entries: []ChunkEntry,
+
+    /// Opens `path` and validates its header and directory.
+    pub fn open(allocator: std.mem.Allocator, path: []const u8) !SidecarFile {
+        const file = try std.fs.cwd().openFile(path, .{});
+        errdefer file.close();
+        const file_size = (try file.stat()).size;
+
+        var header: SidecarHeader = undefined;
+        if (try file.preadAll(std.mem.asBytes(&header), 0) != @sizeOf(SidecarHeader)) return error.InvalidTerrainSidecar;
+        if (!std.mem.eql(u8, &header.magic, &SIDECAR_MAGIC)) return error.InvalidTerrainSidecar;
+        if (header.version != SIDECAR_VERSION) return error.UnsupportedTerrainSidecarVersion;
+        try validate_layout(header.extent, header.chunk_extent, header.channel_count);
+        for (header.channel_kinds[0..header.channel_count]) |kind| {
+            _ = std.meta.intToEnum(ChannelKind, kind) catch return error.InvalidTerrainSidecar;
+        }
+        const grid = chunk_grid(header.extent, header.chunk_extent);
+        if (header.chunk_count != try grid_chunk_count(grid)) return error.InvalidTerrainSidecar;
+
+        const directory_bytes = @as(u64, header.chunk_count) * @sizeOf(ChunkEntry);
+        const directory_end = std.math.add(u64, header.directory_offset, directory_bytes) catch return error.InvalidTerrainSidecar;
+        if (directory_end > file_size) return error.InvalidTerrainSidecar;
+
+        const entries = try allocator.alloc(ChunkEntry, header.chunk_count);
+        errdefer allocator.free(entries);
+        const entry_bytes = std.mem.sliceAsBytes(entries);
+        if (try file.preadAll(entry_bytes, header.directory_offset) != entry_bytes.len) return error.InvalidTerrainSidecar;
+        if (std.hash.Crc32.hash(entry_bytes) != header.directory_crc32) return error.CorruptTerrainSidecar;
+
+        var kinds: [MAX_CHANNELS]ChannelKind = undefined;
+        for (0..header.channel_count) |ch| kinds[ch] = @enumFromInt(header.channel_kinds[ch]);
+        for (entries, 0..) |entry, i| {
+            const box = chunk_box(header.extent, header.chunk_extent, @intCast(i));
+            if (entry.raw_size != payload_size(kinds[0..header.channel_count], box.sample_count())) return error.InvalidTerrainSidecar;
+            const entry_end = std.math.add(u64, entry.offset, entry.stored_size) catch return error.InvalidTerrainSidecar;
+            if (entry_end > header.directory_offset) return error.InvalidTerrainSidecar;
+            _ = std.meta.intToEnum(Compression, entry.compression) catch return error.InvalidTerrainSidecar;
+        }
+
+        return .{ .allocator = allocator, .file = file, .header = header, .entries = entries };
+    }
+
+    pub fn close(self: *SidecarFile) void {
+        self.allocator.free(self.entries);
+        self.file.close();
+    }
+
+    pub fn chunk_count(self: *const SidecarFile) u32 {
+        return self.header.chunk_count;
+    }
+
+    pub fn chunk_bounds(self: *const SidecarFile, index: u32) Box {
+        return chunk_box(self.header.extent, self.header.chunk_extent, index);
+    }
+
+    /// Returns the indices of chunks whose bounds come within `radius` of `center` (both in
+    /// sample units), nearest first. The caller owns the returned slice.
+    pub fn chunks_near(self: *const SidecarFile, allocator: std.mem.Allocator, center: [3]f32, radius: f32) ![]u32 {
+        const Candidate = struct {
+            index: u32,
+            dist2: f32,
+
+            fn less(_: void, a: @This(), b: @This()) bool {
+                return a.dist2 < b.dist2;
+            }
+        };
+
+        var candidates = std.ArrayListUnmanaged(Candidate){};
+        defer candidates.deinit(allocator);
+        var index: u32 = 0;
+        while (index < self.header.chunk_count) : (index += 1) {
+            const box = self.chunk_bounds(index);
+            var d2: f32 = 0.0;
+            for (0..3) |axis| {
+                // Samples sit on integer coordinates, so the last sample of the chunk is max - 1.
+                const lo: f32 = @floatFromInt(box.min[axis]);
+                const hi: f32 = @floatFromInt(box.max[axis] - 1);
+                const d = if (center[axis] < lo) lo - center[axis] else if (center[axis] > hi) center[axis] - hi else 0.0;
+                d2 += d * d;
+            }
+            if (d2 <= radius * radius) try candidates.append(allocator, .{ .index = index, .dist2 = d2 });
+        }
+        std.mem.sort(Candidate, candidates.items, {}, Candidate.less);
+
+        const out = try allocator.alloc(u32, candidates.items.len);
+        for (candidates.items, out) |candidate, *o| o.* = candidate.index;
+        return out;
+    }
+
+    fn validate_targets(self: *const SidecarFile, targets: []const ChannelTarget) !void {
+        if (targets.len != self.header.channel_count) return error.TerrainSidecarLayoutMismatch;
+        const samples = grid_sample_count(self.header.extent);
+        for (targets, 0..) |target, i| {
+            if (@intFromEnum(target.kind) != self.header.channel_kinds[i]) return error.TerrainSidecarLayoutMismatch;
+            if (target.data.len != samples * sample_size(target.kind)) return error.TerrainSidecarLayoutMismatch;
+        }
+    }
+
+    fn read_chunk_with(self: *const SidecarFile, scratch: *Scratch, index: u32, targets: []const ChannelTarget) !void {
+        const entry = self.entries[index];
+        try scratch.compressed.resize(scratch.allocator, entry.stored_size);
+        const stored = scratch.compressed.items;
+        if (try self.file.preadAll(stored, entry.offset) != stored.len) return error.CorruptTerrainSidecar;
+
+        const payload = switch (@as(Compression, @enumFromInt(entry.compression))) {
+            .none => stored,
+            .deflate => blk: {
+                try scratch.payload.resize(scratch.allocator, entry.raw_size);
+                var out_len: c.mz_ulong = entry.raw_size;
+                const status = c.mz_uncompress(scratch.payload.items.ptr, &out_len, stored.ptr, @intCast(stored.len));
+                if (status != c.MZ_OK or out_len != entry.raw_size) return error.CorruptTerrainSidecar;
+                break :blk scratch.payload.items;
+            },
+        };
+        if (payload.len != entry.raw_size or std.hash.Crc32.hash(payload) != entry.crc32) return error.CorruptTerrainSidecar;
+
+        try apply_payload(scratch, payload, self.header.extent, self.chunk_bounds(index), targets);
+    }
+
+    /// Decodes chunk `index` into `targets`, which must match the file's channel layout and hold
+    /// full grids. Only the chunk's samples are written.
+    pub fn read_chunk(self: *const SidecarFile, allocator: std.mem.Allocator, index: u32, targets: []const ChannelTarget) !void {
+        if (index >= self.header.chunk_count) return error.InvalidTerrainSidecar;
+        try self.validate_targets(targets);
+        var scratch = Scratch{ .allocator = allocator };
+        defer scratch.deinit();
+        try self.read_chunk_with(&scratch, index, targets);
+    }
+
+    /// Decodes the chunks in `indices` into `targets` on the job system (inline when it is not
+    /// running). Chunks cover disjoint samples, so the jobs write the targets without locking.
+    /// Fails if any chunk is corrupt; the other chunks are still decoded.
+    pub fn read_chunks(self: *const SidecarFile, allocator: std.mem.Allocator, indices: []const u32, targets: []const ChannelTarget) !ReadStats {
+        try self.validate_targets(targets);
+        var stats = ReadStats{ .chunk_count = indices.len };
+        for (indices) |index| {
+            if (index >= self.header.chunk_count) return error.InvalidTerrainSidecar;
+            stats.stored_bytes += self.entries[index].stored_size;
+        }
+        if (indices.len == 0) return stats;
+
+        var failed = std.atomic.Value(u32).init(0);
+        const batch_count = (indices.len + CHUNKS_PER_JOB - 1) / CHUNKS_PER_JOB;
+        const batches = try allocator.alloc(DecodeBatch, batch_count);
+        defer allocator.free(batches);
+        for (batches, 0..) |*batch, i| {
+            const first = i * CHUNKS_PER_JOB;
+            batch.* = .{
+                .allocator = allocator,
+                .file = self,
+                .indices = indices[first..@min(first + CHUNKS_PER_JOB, indices.len)],
+                .targets = targets,
+                .failed = &failed,
+            };
+        }
+        try run_batches(DecodeBatch, allocator, batches, decode_batch_job);
+
+        const failed_count = failed.load(.acquire);
+        if (failed_count != 0) {
+            sidecar_log.warn("{d} of {d} terrain chunks failed to decode", .{ failed_count, indices.len });
+            return error.CorruptTerrainSidecar;
+        }
+        return stats;
+    }
+
+    /// Decodes every chunk into `targets`.
+    pub fn read_all(self: *const SidecarFile, allocator: std.mem.Allocator, targets: []const ChannelTarget) !ReadStats {
+        const indices = try allocator.alloc(u32, self.header.chunk_count);
+        defer allocator.free(indices);
+        for (indices, 0..) |*index, i| index.* = @intCast(i);
+        return self.read_chunks(allocator, indices, targets);
+    }
+};
+
+const DecodeBatch = struct {
+    allocator: std.mem.Allocator,
+    file: *const SidecarFile,
+    indices: []const u32,
+    targets: []const ChannelTarget,
+    failed: *std.atomic.Value(u32),
+
+    fn run(self: *const DecodeBatch) void {
+        var scratch = Scratch{ .allocator = self.allocator };
+        defer scratch.deinit();
+        for (self.indices) |index| {
+            self.file.read_chunk_with(&scratch, index, self.targets) catch {
+                _ = self.failed.fetchAdd(1, .monotonic);
+            };
+        }
+    }
+};
+
+fn decode_batch_job(data: ?*anyopaque) callconv(.c) i32 {
+    const batch: *const DecodeBatch = @ptrCast(@alignCast(data.?));
+    batch.run();
+    return 0;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Legacy run-length codec (editor terrain files up to version 3)
+// ---------------------------------------------------------------------------------------------
+
+/// Run-length encodes 32-bit words: runs of 4 or more become (1, count, value), everything else
+/// is copied verbatim as (0, count, words...).
+pub fn rle_encode_u32(allocator: std.mem.Allocator, words: []const u32) ?[]u8 {
+    var out: std.ArrayListUnmanaged(u8) = .{};
+    errdefer out.deinit(allocator);
+
+    var i: usize = 0;
+    while (i < words.len) {
+        const v = words[i];
+        var run_len: usize = 1;
+        while (i + run_len < words.len and words[i + run_len] == v) : (run_len += 1) {}
+
+        if (run_len >= 4) {
+            out.append(allocator, 1) catch return null;
+            var buf4: [4]u8 = undefined;
+            std.mem.writeInt(u32, &buf4, @intCast(run_len), .little);
+            out.appendSlice(allocator, &buf4) catch return null;
+            std.mem.writeInt(u32, &buf4, v, .little);
+            out.appendSlice(allocator, &buf4) catch return null;
+            i += run_len;
+            continue;
+        }
+
+        const raw_start = i;
+        i += 1;
+        while (i < words.len) : (i += 1) {
+            const vv = words[i];
+            var next_run: usize = 1;
+            while (i + next_run < words.len and words[i + next_run] == vv) : (next_run += 1) {}
+            if (next_run >= 4) break;
+        }
+        const raw_count: usize = i - raw_start;
+        out.append(allocator, 0) catch return null;
+        var buf4: [4]u8 = undefined;
+        std.mem.writeInt(u32, &buf4, @intCast(raw_count), .little);
+        out.appendSlice(allocator, &buf4) catch return null;
+        const raw_bytes = std.mem.sliceAsBytes(words[raw_start .. raw_start + raw_count]);
+        out.appendSlice(allocator, raw_bytes) catch return null;
+    }
+
+    return out.toOwnedSlice(allocator) catch null;
+}
+
+pub fn rle_decode_u32(encoded: []const u8, out_words: []u32) bool {
+    var off: usize = 0;
+    var out_i: usize = 0;
+    while (off < encoded.len and out_i < out_words.len) {
+        const tag = encoded[off];
+        off += 1;
+        if (off + 4 > encoded.len) return false;
+        const count = std.mem.readInt(u32, encoded[off .. off + 4][0..4], .little);
+        off += 4;
+        if (count == 0) continue;
+        if (tag == 1) {
+            if (off + 4 > encoded.len) return false;
+            const v = std.mem.readInt(u32, encoded[off .. off + 4][0..4], .little);
+            off += 4;
+            if (out_i + count > out_words.len) return false;
+            @memset(out_words[out_i .. out_i + count], v);
+            out_i += count;
+        } else {
+            const bytes_need: usize = @as(usize, count) * 4;
+            if (off + bytes_need > encoded.len) return false;
+            if (out_i + count > out_words.len) return false;
+            @memcpy(std.mem.sliceAsBytes(out_words[out_i .. out_i + count]), encoded[off .. off + bytes_need]);
+            off += bytes_need;
+            out_i += count;
+        }
+    }
+    return out_i == out_words.len;
+}
+
+/// Byte variant of `rle_encode_u32`; runs of 8 or more are collapsed.
+pub fn rle_encode_u8(allocator: std.mem.Allocator, bytes: []const u8) ?[]u8 {
+    var out: std.ArrayListUnmanaged(u8) = .{};
+    errdefer out.deinit(allocator);
+
+    var i: usize = 0;
+    while (i < bytes.len) {
+        const v = bytes[i];
+        var run_len: usize = 1;
+        while (i + run_len < bytes.len and bytes[i + run_len] == v) : (run_len += 1) {}
+
+        if (run_len >= 8) {
+            out.append(allocator, 1) catch return null;
+            var buf4: [4]u8 = undefined;
+            std.mem.writeInt(u32, &buf4, @intCast(run_len), .little);
+            out.appendSlice(allocator, &buf4) catch return null;
+            out.append(allocator, v) catch return null;
+            i += run_len;
+            continue;
+        }
+
+        const raw_start = i;
+        i += 1;
+        while (i < bytes.len) : (i += 1) {
+            const vv = bytes[i];
+            var next_run: usize = 1;
+            while (i + next_run < bytes.len and bytes[i + next_run] == vv) : (next_run += 1) {}
+            if (next_run >= 8) break;
+        }
+        const raw_count: usize = i - raw_start;
+        out.append(allocator, 0) catch return null;
+        var buf4: [4]u8 = undefined;
+        std.mem.writeInt(u32, &buf4, @intCast(raw_count), .little);
+        out.appendSlice(allocator, &buf4) catch return null;
+        out.appendSlice(allocator, bytes[raw_start .. raw_start + raw_count]) catch return null;
+    }
+
+    return out.toOwnedSlice(allocator) catch null;
+}
+
+pub fn rle_decode_u8(encoded: []const u8, out_bytes: []u8) bool {
+    var off: usize = 0;
+    var out_i: usize = 0;
+    while (off < encoded.len and out_i < out_bytes.len) {
+        const tag = encoded[off];
+        off += 1;
+        if (off + 4 > encoded.len) return false;
+        const count = std.mem.readInt(u32, encoded[off .. off + 4][0..4], .little);
+        off += 4;
+        if (count == 0) continue;
+        if (tag == 1) {
+            if (off >= encoded.len) return false;
+            const v = encoded[off];
+            off += 1;
+            if (out_i + count > out_bytes.len) return false;
+            @memset(out_bytes[out_i .. out_i + count], v);
+            out_i += count;
+        } else {
+            if (off + count > encoded.len) return false;
+            if (out_i + count > out_bytes.len) return false;
+            @memcpy(out_bytes[out_i .. out_i + count], encoded[off .. off + count]);
+            off += count;
+            out_i += count;
+        }
+    }
+    return out_i == out_bytes.len;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------------------------
+
+/// Deterministic rolling heightfield used by the tests and the benchmark.
+pub fn synthetic_height(x: f32, z: f32) f32 {
+    return 12.0 * @sin(x * 0.031) * @cos(z * 0.027) + 3.0 * @sin((x + z) * 0.11) + 0.5 * @cos(x * 0.47 - z * 0.39);
+}
+
+fn temp_file_path(allocator: std.mem.Allocator, tmp: *std.testing.TmpDir, name: []const u8) ![]u8 {
+    const dir_path = try tmp.dir.realpathAlloc(allocator, ".");
+    defer allocator.free(dir_path);
+    return std.fs.path.join(allocator, &[_][]const u8{ dir_path, name });
+}
+
+test "float and byte decorrelation round trips exactly" {
+    const dims = [3]u32{ 7, 5, 3 };
+    const n = 7 * 5 * 3;
+    var samples: [n]f32 = undefined;
+    var prng = std.Random.DefaultPrng.init(3);
+    const random = prng.random();
+    for (&samples, 0..) |*s, i| {
+        s.* = switch (i % 5) {
+            0 => random.float(f32) * 2000.0 - 1000.0,
+            1 => -0.0,
+            2 => std.math.inf(f32),
+            3 => std.math.floatMin(f32) * @as(f32, @floatFromInt(i)),
+            else => @as(f32, @floatFromInt(i)) * 0.25 - 3.0,
+        };
+    }
+    samples[17] = std.math.nan(f32);
+
+    var planes: [n * 4]u8 = undefined;
+    encode_f32(&samples, dims, &planes);
+    var decoded: [n]f32 = undefined;
+    decode_f32(&planes, dims, &decoded);
+    try std.testing.expectEqualSlices(u8, std.mem.sliceAsBytes(&samples), std.mem.sliceAsBytes(&decoded));
+
+    var bytes: [n * 4]u8 = undefined;
+    random.bytes(&bytes);
+    var byte_planes: [n * 4]u8 = undefined;
+    encode_bytes(&bytes, 4, dims, &byte_planes);
+    var decoded_bytes: [n * 4]u8 = undefined;
+    decode_bytes(&byte_planes, 4, dims, &decoded_bytes);
+    try std.testing.expectEqualSlices(u8, &bytes, &decoded_bytes);
+}
+
+test "heightfield sidecar round trip beats run-length encoding" {
+    const allocator = std.testing.allocator;
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+    const path = try temp_file_path(allocator, &tmp, "terrain.cts");
+    defer allocator.free(path);
+
+    const dims: u32 = 129;
+    const pix = dims * dims;
+    const height = try allocator.alloc(f32, pix);
+    defer allocator.free(height);
+    const splat = try allocator.alloc(u8, pix * 4);
+    defer allocator.free(splat);
+    const alpha = try allocator.alloc(u8, pix);
+    defer allocator.free(alpha);
+    for (0..dims) |y| {
+        for (0..dims) |x| {
+            const i = y * dims + x;
+            height[i] = synthetic_height(@floatFromInt(x), @floatFromInt(y));
+            const rock: u8 = if (height[i] > 6.0) 200 else 0;
+            splat[i * 4 ..][0..4].* = .{ 255 - rock, rock, 0, 0 };
+            alpha[i] = if (x > 40 and x < 50 and y > 40 and y < 50) 0 else 255;
+        }
+    }
+
+    const sources = [_]ChannelSource{
+        .{ .kind = .f32, .data = std.mem.sliceAsBytes(height) },
+        .{ .kind = .rgba8, .data = splat },
+        .{ .kind = .u8, .data = alpha },
+    };
+    const stats = try write_file(allocator, path, .{ dims, dims, 1 }, &sources, .{ .chunk_extent = .{ 64, 64, 1 } });
+    try std.testing.expectEqual(@as(usize, 9), stats.chunk_count);
+
+    const rle = rle_encode_u32(allocator, std.mem.bytesAsSlice(u32, std.mem.sliceAsBytes(height))).?;
+    defer allocator.free(rle);
+    try std.testing.expect(stats.file_bytes < rle.len);
+
+    var file = try SidecarFile.open(allocator, path);
+    defer file.close();
+
+    const height_out = try allocator.alloc(f32, pix);
+    defer allocator.free(height_out);
+    const splat_out = try allocator.alloc(u8, pix * 4);
+    defer allocator.free(splat_out);
+    const alpha_out = try allocator.alloc(u8, pix);
+    defer allocator.free(alpha_out);
+    const targets = [_]ChannelTarget{
+        .{ .kind = .f32, .data = std.mem.sliceAsBytes(height_out) },
+        .{ .kind = .rgba8, .data = splat_out },
+        .{ .kind = .u8, .data = alpha_out },
+    };
+    _ = try file.read_all(allocator, &targets);
+    try std.testing.expectEqualSlices(u8, std.mem.sliceAsBytes(height), std.mem.sliceAsBytes(height_out));
+    try std.testing.expectEqualSlices(u8, splat, splat_out);
+    try std.testing.expectEqualSlices(u8, alpha, alpha_out);
+
+    const wrong = [_]ChannelTarget{targets[0]};
+    try std.testing.expectError(error.TerrainSidecarLayoutMismatch, file.read_all(allocator, &wrong));
+}
+
+test "volume sidecar partial load only touches nearby chunks" {
+    const allocator = std.testing.allocator;
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+    const path = try temp_file_path(allocator, &tmp, "volume.cts");
+    defer allocator.free(path);
+
+    const dims: u32 = 40;
+    const vox = dims * dims * dims;
+    const density = try allocator.alloc(f32, vox);
+    defer allocator.free(density);
+    const splat = try allocator.alloc(u8, vox * 4);
+    defer allocator.free(splat);
+    for (0..dims) |z| {
+        for (0..dims) |y| {
+            for (0..dims) |x| {
+                const i = (z * dims + y) * dims + x;
+                density[i] = @as(f32, @floatFromInt(y)) - 20.0 - 0.1 * synthetic_height(@floatFromInt(x), @floatFromInt(z));
+                splat[i * 4 ..][0..4].* = .{ 255, 0, @truncate(z), 0 };
+            }
+        }
+    }
+
+    const sources = [_]ChannelSource{
+        .{ .kind = .f32, .data = std.mem.sliceAsBytes(density) },
+        .{ .kind = .rgba8, .data = splat },
+    };
+    const stats = try write_file(allocator, path, .{ dims, dims, dims }, &sources, .{ .chunk_extent = .{ 16, 16, 16 } });
+    try std.testing.expectEqual(@as(usize, 27), stats.chunk_count);
+
+    var file = try SidecarFile.open(allocator, path);
+    defer file.close();
+
+    const near = try file.chunks_near(allocator, .{ 0.0, 0.0, 0.0 }, 4.0);
+    defer allocator.free(near);
+    try std.testing.expectEqualSlices(u32, &[_]u32{0}, near);
+
+    const density_out = try allocator.alloc(f32, vox);
+    defer allocator.free(density_out);
+    const splat_out = try allocator.alloc(u8, vox * 4);
+    defer allocator.free(splat_out);
+    @memset(density_out, 99.0);
+    @memset(splat_out, 0);
+    const targets = [_]ChannelTarget{
+        .{ .kind = .f32, .data = std.mem.sliceAsBytes(density_out) },
+        .{ .kind = .rgba8, .data = splat_out },
+    };
+    _ = try file.read_chunks(allocator, near, &targets);
+
+    for (0..dims) |z| {
+        for (0..dims) |y| {
+            for (0..dims) |x| {
+                const i = (z * dims + y) * dims + x;
+                if (x < 16 and y < 16 and z < 16) {
+                    try std.testing.expectEqual(density[i], density_out[i]);
+                    try std.testing.expectEqualSlices(u8, splat[i * 4 ..][0..4], splat_out[i * 4 ..][0..4]);
+                } else {
+                    try std.testing.expectEqual(@as(f32, 99.0), density_out[i]);
+                }
+            }
+        }
+    }
+
+    // Every chunk is within a radius that spans the whole grid; the edge chunks are clipped.
+    const all = try file.chunks_near(allocator, .{ 20.0, 20.0, 20.0 }, 100.0);
+    defer allocator.free(all);
+    try std.testing.expectEqual(@as(usize, 27), all.len);
+    try std.testing.expectEqual(@as(u32, 13), all[0]);
+    _ = try file.read_chunks(allocator, all, &targets);
+    try std.testing.expectEqualSlices(u8, std.mem.sliceAsBytes(density), std.mem.sliceAsBytes(density_out));
+    try std.testing.expectEqualSlices(u8, splat, splat_out);
+}
+
+test "corrupt chunks are rejected by their checksum" {
+    const allocator = std.testing.allocator;
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+    const path = try temp_file_path(allocator, &tmp, "corrupt.cts");
+    defer allocator.free(path);
+
+    var height: [32 * 32]f32 = undefined;
+    for (&height, 0..) |*h, i| h.* = synthetic_height(@floatFromInt(i % 32), @floatFromInt(i / 32));
+    const sources = [_]ChannelSource{.{ .kind = .f32, .data = std.mem.sliceAsBytes(&height) }};
+    _ = try write_file(allocator, path, .{ 32, 32, 1 }, &sources, .{ .chunk_extent = .{ 16, 16, 1 } });
+
+    var offset: u64 = 0;
+    {
+        var file = try SidecarFile.open(allocator, path);
+        defer file.close();
+        offset = file.entries[2].offset + file.entries[2].stored_size / 2;
+    }
+    {
+        const f = try std.fs.cwd().openFile(path, .{ .mode = .read_write });
+        defer f.close();
+        var byte: [1]u8 = undefined;
+        _ = try f.preadAll(&byte, offset);
+        byte[0] ^= 0x5A;
+        try f.pwriteAll(&byte, offset);
+    }
+
+    var file = try SidecarFile.open(allocator, path);
+    defer file.close();
+    var out: [32 * 32]f32 = undefined;
+    const targets = [_]ChannelTarget{.{ .kind = .f32, .data = std.mem.sliceAsBytes(&out) }};
+    _ = try file.read_chunks(allocator, &[_]u32{ 0, 1, 3 }, &targets);
+    try std.testing.expectError(error.CorruptTerrainSidecar, file.read_chunks(allocator, &[_]u32{2}, &targets));
+}
+
+test "corrupt headers are rejected instead of overflowing" {
+    const allocator = std.testing.allocator;
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+    const path = try temp_file_path(allocator, &tmp, "header.cts");
+    defer allocator.free(path);
+
+    var height: [32 * 32]f32 = undefined;
+    for (&height, 0..) |*h, i| h.* = synthetic_height(@floatFromInt(i % 32), @floatFromInt(i / 32));
+    const sources = [_]ChannelSource{.{ .kind = .f32, .data = std.mem.sliceAsBytes(&height) }};
+    _ = try write_file(allocator, path, .{ 32, 32, 1 }, &sources, .{ .chunk_extent = .{ 16, 16, 1 } });
+
+    var original: SidecarHeader = undefined;
+    {
+        const f = try std.fs.cwd().openFile(path, .{});
+        defer f.close();
+        _ = try f.preadAll(std.mem.asBytes(&original), 0);
+    }
+
+    const Corruption = struct {
+        fn apply(h: *SidecarHeader, which: usize) void {
+            switch (which) {
+                // extent + chunk_extent - 1 would wrap.
+                0 => h.extent = .{ std.math.maxInt(u32), 32, 1 },
+                // The chunk grid product does not fit in u32.
+                1 => {
+                    h.extent = .{ std.math.maxInt(u32), std.math.maxInt(u32), 1 };
+                    h.chunk_extent = .{ 1, 1, 1 };
+                },
+                // directory_offset + directory size wraps.
+                2 => h.directory_offset = std.math.maxInt(u64) - 8,
+                // Chunk payload size cannot be represented.
+                else => h.chunk_extent = .{ 1 << 16, 1 << 16, 1 },
+            }
+        }
+    };
+
+    for (0..4) |which| {
+        var header = original;
+        Corruption.apply(&header, which);
+        {
+            const f = try std.fs.cwd().openFile(path, .{ .mode = .read_write });
+            defer f.close();
+            try f.pwriteAll(std.mem.asBytes(&header), 0);
+        }
+        try std.testing.expectError(error.InvalidTerrainSidecar, SidecarFile.open(allocator, path));
+    }
+
+    // A directory entry whose stored range wraps; the directory CRC is patched to match.
+    {
+        const f = try std.fs.cwd().openFile(path, .{ .mode = .read_write });
+        defer f.close();
+        var entries: [4]ChunkEntry = undefined;
+        _ = try f.preadAll(std.mem.sliceAsBytes(&entries), original.directory_offset);
+        entries[0].offset = std.math.maxInt(u64) - 4;
+        var header = original;
+        header.directory_crc32 = std.hash.Crc32.hash(std.mem.sliceAsBytes(&entries));
+        try f.pwriteAll(std.mem.sliceAsBytes(&entries), original.directory_offset);
+        try f.pwriteAll(std.mem.asBytes(&header), 0);
+    }
+    try std.testing.expectError(error.InvalidTerrainSidecar, SidecarFile.open(allocator, path));
+}
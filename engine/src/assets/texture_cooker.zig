@@ -0,0 +1,1103 @@
+//! Import-time texture cooking.
+//!
+//! Turns decoded RGBA8 images into GPU-ready textures: a full mip chain filtered in linear light
+//! (2x2 box filter on `@Vector(4, f32)`), block-compressed to BC1, BC5 or BC7 with each level
+//! split into bands of block rows on the job system. Results are stored as DX10 DDS files, which
+//! `dds_loader` reads back, in a cache keyed by a hash of the source bytes and the cook settings,
+//! so a texture is only cooked again when its contents or settings change.
+//!
+//! The encoders trade the last fraction of a dB for speed: BC1 fits the principal axis of each
+//! block and refines it with a least-squares pass, BC5 fits each channel's range, and BC7 uses
+//! mode 6 only (one subset, RGBA endpoints with p-bits, 4-bit indices).
+const std = @import("std");
+const log = @import("../core/log.zig");
+const job_system = @import("../core/job_system.zig");
+const texture_types = @import("texture_types.zig");
+const dds_loader = @import("dds_loader.zig");
+const decode_stb = @import("texture_decode_stb.zig");
+const vk_formats = @import("../renderer/vulkan_format_constants.zig");
+
+const cook_log = log.ScopedLogger("TEX_COOK");
+
+/// Bump when encoder output changes so stale cache entries are not reused.
+pub const COOKER_VERSION: u64 = 1;
+
+pub const CookFormat = enum(u8) {
+    /// 4 bpp RGB, opaque.
+    bc1,
+    /// 8 bpp two-channel (RG); for normal maps whose Z is reconstructed in the shader.
+    bc5,
+    /// 8 bpp RGBA.
+    bc7,
+};
+
+pub const CookSettings = struct {
+    format: CookFormat = .bc7,
+    /// Source texels are sRGB-encoded color: mips are filtered in linear light and the texture is
+    /// tagged sRGB. Ignored for BC5.
+    srgb: bool = true,
+    generate_mips: bool = true,
+    /// Source RGB holds tangent-space normals; every mip is renormalized after filtering.
+    normal_map: bool = false,
+
+    fn filters_in_linear_light(self: CookSettings) bool {
+        return self.srgb and self.format != .bc5;
+    }
+};
+
+/// Vulkan format of textures cooked with `settings`.
+pub fn vk_format(settings: CookSettings) u32 {
+    return switch (settings.format) {
+        .bc1 => if (settings.srgb) vk_formats.VK_FORMAT_BC1_RGBA_SRGB_BLOCK else vk_formats.VK_FORMAT_BC1_RGBA_UNORM_BLOCK,
+        .bc5 => vk_formats.VK_FORMAT_BC5_UNORM_BLOCK,
+        .bc7 => if (settings.srgb) vk_formats.VK_FORMAT_BC7_SRGB_BLOCK else vk_formats.VK_FORMAT_BC7_UNORM_BLOCK,
+    };
+}
+
+fn dxgi_format(settings: CookSettings) u32 {
+    return switch (settings.format) {
+        .bc1 => if (settings.srgb) 72 else 71,
+        .bc5 => 83,
+        .bc7 => if (settings.srgb) 99 else 98,
+    };
+}
+
+pub fn block_bytes(format: CookFormat) usize {
+    return switch (format) {
+        .bc1 => 8,
+        .bc5, .bc7 => 16,
+    };
+}
+
+/// Number of levels in a full chain down to 1x1.
+pub fn full_mip_count(width: u32, height: u32) u32 {
+    const largest = @max(width, height, 1);
+    return std.math.log2_int(u32, largest) + 1;
+}
+
+/// A cooked mip chain. Levels are stored largest-first and tightly packed, the layout DDS and the
+/// renderer's upload path expect.
+pub const CookedTexture = struct {
+    allocator: std.mem.Allocator,
+    width: u32,
+    height: u32,
+    mip_count: u32,
+    settings: CookSettings,
+    data: []u8,
+
+    pub fn deinit(self: *CookedTexture) void {
+        self.allocator.free(self.data);
+        self.* = undefined;
+    }
+};
+
+/// Cooks `width` x `height` RGBA8 `pixels` into a block-compressed mip chain.
+pub fn cook(allocator: std.mem.Allocator, pixels: []const u8, width: u32, height: u32, settings: CookSettings) !CookedTexture {
+    if (width == 0 or height == 0) return error.InvalidImage;
+    const texel_count = @as(usize, width) * height;
+    if (pixels.len < texel_count * 4) return error.InvalidImage;
+
+    const format = vk_format(settings);
+    const mip_count = if (settings.generate_mips) full_mip_count(width, height) else 1;
+
+    var total: usize = 0;
+    var w = width;
+    var h = height;
+    for (0..mip_count) |_| {
+        total += @intCast(texture_types.mip_level_size(format, w, h));
+        w = @max(w / 2, 1);
+        h = @max(h / 2, 1);
+    }
+
+    const data = try allocator.alloc(u8, total);
+    errdefer allocator.free(data);
+
+    // Level 0 is encoded straight from the source; lower levels are filtered from a float copy so
+    // rounding does not accumulate down the chain.
+    var offset: usize = @intCast(texture_types.mip_level_size(format, width, height));
+    try encode_level(allocator, settings.format, pixels[0 .. texel_count * 4], width, height, data[0..offset]);
+
+    if (mip_count > 1) {
+        var level = try allocator.alloc(Vec4, texel_count);
+        defer allocator.free(level);
+        to_float(pixels[0 .. texel_count * 4], level, settings.filters_in_linear_light());
+
+        const rgba = try allocator.alloc(u8, @as(usize, @max(width / 2, 1)) * @max(height / 2, 1) * 4);
+        defer allocator.free(rgba);
+
+        w = width;
+        h = height;
+        for (1..mip_count) |_| {
+            const next_w = @max(w / 2, 1);
+            const next_h = @max(h / 2, 1);
+            const next = try allocator.alloc(Vec4, @as(usize, next_w) * next_h);
+            downsample(level, w, h, next, next_w, next_h, settings.normal_map);
+            allocator.free(level);
+            level = next;
+            w = next_w;
+            h = next_h;
+
+            const level_rgba = rgba[0 .. level.len * 4];
+            to_rgba8(level, level_rgba, settings.filters_in_linear_light());
+            const size: usize = @intCast(texture_types.mip_level_size(format, w, h));
+            try encode_level(allocator, settings.format, level_rgba, w, h, data[offset .. offset + size]);
+            offset += size;
+        }
+    }
+
+    return .{
+        .allocator = allocator,
+        .width = width,
+        .height = height,
+        .mip_count = mip_count,
+        .settings = settings,
+        .data = data,
+    };
+}
+
+// ---------------------------------------------------------------------------------------------
+// Mip filtering
+// ---------------------------------------------------------------------------------------------
+
+const Vec4 = @Vector(4, f32);
+
+inline fn splat(v: f32) Vec4 {
+    return @splat(v);
+}
+
+inline fn dot(a: Vec4, b: Vec4) f32 {
+    return @reduce(.Add, a * b);
+}
+
+inline fn clamp_byte_range(v: Vec4) Vec4 {
+    return @min(@max(v, splat(0.0)), splat(255.0));
+}
+
+const srgb_to_linear_table: [256]f32 = blk: {
+    @setEvalBranchQuota(20_000);
+    var table: [256]f32 = undefined;
+    for (&table, 0..) |*entry, i| {
+        const s = @as(f32, @floatFromInt(i)) / 255.0;
+        entry.* = if (s <= 0.04045) s / 12.92 else @exp(2.4 * @log((s + 0.055) / 1.055));
+    }
+    break :blk table;
+};
+
+/// Linear-light midpoints between consecutive sRGB codes; encoding is a search over these, which
+/// picks the code nearest in linear light without a pow per texel.
+const srgb_decision_table: [255]f32 = blk: {
+    var table: [255]f32 = undefined;
+    for (&table, 0..) |*entry, i| entry.* = (srgb_to_linear_table[i] + srgb_to_linear_table[i + 1]) * 0.5;
+    break :blk table;
+};
+
+fn linear_to_srgb8(v: f32) u8 {
+    var lo: usize = 0;
+    var hi: usize = srgb_decision_table.len;
+    while (lo < hi) {
+        const mid = (lo + hi) / 2;
+        if (v > srgb_decision_table[mid]) lo = mid + 1 else hi = mid;
+    }
+    return @intCast(lo);
+}
+
+inline fn unorm8(v: f32) u8 {
+    return @intFromFloat(@round(std.math.clamp(v, 0.0, 1.0) * 255.0));
+}
+
+fn to_float(pixels: []const u8, out: []Vec4, linear_light: bool) void {
+    for (out, 0..) |*texel, i| {
+        const p = pixels[i * 4 ..][0..4];
+        if (linear_light) {
+            texel.* = .{ srgb_to_linear_table[p[0]], srgb_to_linear_table[p[1]], srgb_to_linear_table[p[2]], @as(f32, @floatFromInt(p[3])) / 255.0 };
+        } else {
+            texel.* = Vec4{ @floatFromInt(p[0]), @floatFromInt(p[1]), @floatFromInt(p[2]), @floatFromInt(p[3]) } / splat(255.0);
+        }
+    }
+}
+
+fn to_rgba8(texels: []const Vec4, out: []u8, linear_light: bool) void {
+    for (texels, 0..) |v, i| {
+        const p = out[i * 4 ..][0..4];
+        if (linear_light) {
+            p[0] = linear_to_srgb8(v[0]);
+            p[1] = linear_to_srgb8(v[1]);
+            p[2] = linear_to_srgb8(v[2]);
+        } else {
+            p[0] = unorm8(v[0]);
+            p[1] = unorm8(v[1]);
+            p[2] = unorm8(v[2]);
+        }
+        p[3] = unorm8(v[3]);
+    }
+}
+
+fn renormalize(v: Vec4) Vec4 {
+    var n = v * splat(2.0) - splat(1.0);
+    n[3] = 0.0;
+    const len = @sqrt(dot(n, n));
+    if (len < 1e-6) return v;
+    var out = n / splat(len) * splat(0.5) + splat(0.5);
+    out[3] = v[3];
+    return out;
+}
+
+/// 2x2 box filter. Odd source edges reuse the last row/column.
+fn downsample(src: []const Vec4, src_w: u32, src_h: u32, dst: []Vec4, dst_w: u32, dst_h: u32, normal_map: bool) void {
+    for (0..dst_h) |y| {
+        const y0 = @min(y * 2, src_h - 1);
+        const y1 = @min(y * 2 + 1, src_h - 1);
+        const row0 = src[y0 * src_w ..][0..src_w];
+        const row1 = src[y1 * src_w ..][0..src_w];
+        for (0..dst_w) |x| {
+            const x0 = @min(x * 2, src_w - 1);
+            const x1 = @min(x * 2 + 1, src_w - 1);
+            var v = (row0[x0] + row0[x1] + row1[x0] + row1[x1]) * splat(0.25);
+            if (normal_map) v = renormalize(v);
+            dst[y * dst_w + x] = v;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// Block encoding
+// ---------------------------------------------------------------------------------------------
+
+const rgb_mask = Vec4{ 1, 1, 1, 0 };
+const rgba_mask = Vec4{ 1, 1, 1, 1 };
+
+/// Gathers a 4x4 block in 0..255 units; blocks past the right/bottom edge repeat the edge texels.
+fn load_block(pixels: []const u8, width: u32, height: u32, bx: u32, by: u32, out: *[16]Vec4) void {
+    for (0..4) |y| {
+        const py: usize = @min(by * 4 + @as(u32, @intCast(y)), height - 1);
+        for (0..4) |x| {
+            const px: usize = @min(bx * 4 + @as(u32, @intCast(x)), width - 1);
+            const p = pixels[(py * width + px) * 4 ..][0..4];
+            out[y * 4 + x] = .{ @floatFromInt(p[0]), @floatFromInt(p[1]), @floatFromInt(p[2]), @floatFromInt(p[3]) };
+        }
+    }
+}
+
+fn block_mean(texels: *const [16]Vec4) Vec4 {
+    var sum = splat(0.0);
+    for (texels) |t| sum += t;
+    return sum / splat(16.0);
+}
+
+/// Dominant direction of the block's texel cloud (power iteration on the covariance), restricted
+/// to the channels in `mask`. Returns zero for flat blocks.
+fn principal_axis(texels: *const [16]Vec4, mean: Vec4, mask: Vec4) Vec4 {
+    var cov = [4]Vec4{ splat(0.0), splat(0.0), splat(0.0), splat(0.0) };
+    var lo = splat(std.math.inf(f32));
+    var hi = splat(-std.math.inf(f32));
+    for (texels) |t| {
+        const d = (t - mean) * mask;
+        inline for (0..4) |i| cov[i] += d * splat(d[i]);
+        lo = @min(lo, t);
+        hi = @max(hi, t);
+    }
+
+    var axis = (hi - lo) * mask;
+    if (dot(axis, axis) < 1e-6) return splat(0.0);
+    for (0..8) |_| {
+        const next = cov[0] * splat(axis[0]) + cov[1] * splat(axis[1]) + cov[2] * splat(axis[2]) + cov[3] * splat(axis[3]);
+        const scale = @reduce(.Max, @abs(next));
+        if (scale < 1e-9) break;
+        axis = next / splat(scale);
+    }
+    return axis / splat(@sqrt(dot(axis, axis)));
+}
+
+/// Projects the block onto `axis` and returns the extreme points `{ low, high }` along it.
+fn axis_extents(texels: *const [16]Vec4, mean: Vec4, axis: Vec4) [2]Vec4 {
+    var t_min = std.math.inf(f32);
+    var t_max = -std.math.inf(f32);
+    for (texels) |t| {
+        const s = dot(t - mean, axis);
+        t_min = @min(t_min, s);
+        t_max = @max(t_max, s);
+    }
+    return .{ mean + axis * splat(t_min), mean + axis * splat(t_max) };
+}
+
+/// Least-squares endpoints for fixed per-texel weights (0 selects the first endpoint).
+fn refit_endpoints(texels: *const [16]Vec4, weights: *const [16]f32) ?[2]Vec4 {
+    var aa: f32 = 0;
+    var ab: f32 = 0;
+    var bb: f32 = 0;
+    var ax = splat(0.0);
+    var bx = splat(0.0);
+    for (texels, weights) |t, w| {
+        const a = 1.0 - w;
+        aa += a * a;
+        ab += a * w;
+        bb += w * w;
+        ax += t * splat(a);
+        bx += t * splat(w);
+    }
+    const det = aa * bb - ab * ab;
+    if (@abs(det) < 1e-6) return null;
+    const e0 = (ax * splat(bb) - bx * splat(ab)) / splat(det);
+    const e1 = (bx * splat(aa) - ax * splat(ab)) / splat(det);
+    return .{ clamp_byte_range(e0), clamp_byte_range(e1) };
+}
+
+// BC1 ------------------------------------------------------------------------------------------
+
+/// Interpolation weight of each BC1 index in four-color mode.
+const bc1_weights = [4]f32{ 0.0, 1.0, 1.0 / 3.0, 2.0 / 3.0 };
+
+fn pack565(c: Vec4) u16 {
+    const v = clamp_byte_range(c);
+    const r: u16 = @intFromFloat(@round(v[0] * 31.0 / 255.0));
+    const g: u16 = @intFromFloat(@round(v[1] * 63.0 / 255.0));
+    const b: u16 = @intFromFloat(@round(v[2] * 31.0 / 255.0));
+    return (r << 11) | (g << 5) | b;
+}
+
+fn unpack565(v: u16) Vec4 {
+    const r: u32 = (v >> 11) & 31;
+    const g: u32 = (v >> 5) & 63;
+    const b: u32 = v & 31;
+    return .{ @floatFromInt((r << 3) | (r >> 2)), @floatFromInt((g << 2) | (g >> 4)), @floatFromInt((b << 3) | (b >> 2)), 255.0 };
+}
+
+const Bc1Block = struct {
+    c0: u16,
+    c1: u16,
+    indices: u32,
+    err: f32,
+};
+
+fn bc1_evaluate(texels: *const [16]Vec4, a: Vec4, b: Vec4) Bc1Block {
+    var c0 = pack565(a);
+    var c1 = pack565(b);
+    // Four-color mode requires c0 > c1; equal endpoints fall into three-color mode, where index 0
+    // still selects c0.
+    if (c0 < c1) std.mem.swap(u16, &c0, &c1);
+    const p0 = unpack565(c0);
+    const p1 = unpack565(c1);
+
+    var result = Bc1Block{ .c0 = c0, .c1 = c1, .indices = 0, .err = 0 };
+    if (c0 == c1) {
+        for (texels) |t| {
+            const d = (t - p0) * rgb_mask;
+            result.err += dot(d, d);
+        }
+        return result;
+    }
+
+    const palette = [4]Vec4{ p0, p1, (p0 * splat(2.0) + p1) / splat(3.0), (p0 + p1 * splat(2.0)) / splat(3.0) };
+    for (texels, 0..) |t, i| {
+        var best: u32 = 0;
+        var best_err = std.math.inf(f32);
+        for (palette, 0..) |p, j| {
+            const d = (t - p) * rgb_mask;
+            const e = dot(d, d);
+            if (e < best_err) {
+                best_err = e;
+                best = @intCast(j);
+            }
+        }
+        result.indices |= best << @intCast(i * 2);
+        result.err += best_err;
+    }
+    return result;
+}
+
+fn encode_bc1_block(texels: *const [16]Vec4, out: *[8]u8) void {
+    const mean = block_mean(texels) * rgb_mask;
+    const axis = principal_axis(texels, mean, rgb_mask);
+
+    var best: Bc1Block = undefined;
+    if (dot(axis, axis) == 0) {
+        best = bc1_evaluate(texels, mean, mean);
+    } else {
+        const ends = axis_extents(texels, mean, axis);
+        // Pull the extremes in slightly; outliers rarely survive 565 rounding anyway.
+        const inset = (ends[1] - ends[0]) / splat(16.0);
+        best = bc1_evaluate(texels, ends[1] - inset, ends[0] + inset);
+
+        if (best.c0 != best.c1) {
+            var weights: [16]f32 = undefined;
+            for (&weights, 0..) |*w, i| w.* = bc1_weights[(best.indices >> @intCast(i * 2)) & 3];
+            if (refit_endpoints(texels, &weights)) |refit| {
+                const candidate = bc1_evaluate(texels, refit[0], refit[1]);
+                if (candidate.err < best.err) best = candidate;
+            }
+        }
+    }
+
+    std.mem.writeInt(u16, out[0..2], best.c0, .little);
+    std.mem.writeInt(u16, out[2..4], best.c1, .little);
+    std.mem.writeInt(u32, out[4..8], best.indices, .little);
+}
+
+// BC4 / BC5 ------------------------------------------------------------------------------------
+
+fn bc4_palette(e0: u8, e1: u8) [8]f32 {
+    const a: f32 = @floatFromInt(e0);
+    const b: f32 = @floatFromInt(e1);
+    var palette: [8]f32 = undefined;
+    palette[0] = a;
+    palette[1] = b;
+    if (e0 > e1) {
+        for (2..8) |i| {
+            const k: f32 = @floatFromInt(i);
+            palette[i] = @round(((8.0 - k) * a + (k - 1.0) * b) / 7.0);
+        }
+    } else {
+        for (2..6) |i| {
+            const k: f32 = @floatFromInt(i);
+            palette[i] = @round(((6.0 - k) * a + (k - 1.0) * b) / 5.0);
+        }
+        palette[6] = 0.0;
+        palette[7] = 255.0;
+    }
+    return palette;
+}
+
+fn encode_bc4_block(values: *const [16]f32, out: *[8]u8) void {
+    var lo: f32 = 255.0;
+    var hi: f32 = 0.0;
+    for (values) |v| {
+        lo = @min(lo, v);
+        hi = @max(hi, v);
+    }
+    const e0: u8 = @intFromFloat(@round(hi));
+    const e1: u8 = @intFromFloat(@round(lo));
+    out[0] = e0;
+    out[1] = e1;
+
+    // Equal endpoints select six-value mode, where index 0 is e0: all-zero indices are exact.
+    var bits: u64 = 0;
+    if (e0 > e1) {
+        const palette = bc4_palette(e0, e1);
+        for (values, 0..) |v, i| {
+            var best: u64 = 0;
+            var best_err = std.math.inf(f32);
+            for (palette, 0..) |p, j| {
+                const e = @abs(v - p);
+                if (e < best_err) {
+                    best_err = e;
+                    best = j;
+                }
+            }
+            bits |= best << @intCast(i * 3);
+        }
+    }
+    for (0..6) |k| out[2 + k] = @truncate(bits >> @intCast(k * 8));
+}
+
+fn encode_bc5_block(texels: *const [16]Vec4, out: *[16]u8) void {
+    var red: [16]f32 = undefined;
+    var green: [16]f32 = undefined;
+    for (texels, 0..) |t, i| {
+        red[i] = t[0];
+        green[i] = t[1];
+    }
+    encode_bc4_block(&red, out[0..8]);
+    encode_bc4_block(&green, out[8..16]);
+}
+
+// BC7 mode 6 -----------------------------------------------------------------------------------
+
+const bc7_weights = [16]f32{ 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+/// A mode 6 endpoint: 7 bits per channel plus a shared p-bit as the low bit.
+const Bc7Endpoint = struct {
+    q: [4]u8,
+    p: u1,
+
+    fn value(self: Bc7Endpoint) Vec4 {
+        var v: Vec4 = undefined;
+        inline for (0..4) |c| v[c] = @floatFromInt((@as(u32, self.q[c]) << 1) | self.p);
+        return v;
+    }
+};
+
+/// Picks the p-bit and 7-bit values closest to `v`. Opaque blocks keep p = 1 so alpha stays
+/// exactly 255 instead of trading it for RGB precision.
+fn bc7_quantize(v: Vec4, opaque_block: bool) Bc7Endpoint {
+    var best: Bc7Endpoint = undefined;
+    var best_err = std.math.inf(f32);
+    const p_bits: []const u1 = if (opaque_block) &[_]u1{1} else &[_]u1{ 0, 1 };
+    for (p_bits) |p| {
+        var candidate = Bc7Endpoint{ .q = undefined, .p = p };
+        inline for (0..4) |c| {
+            const q = @round((v[c] - @as(f32, @floatFromInt(p))) / 2.0);
+            candidate.q[c] = @intFromFloat(std.math.clamp(q, 0.0, 127.0));
+        }
+        const d = candidate.value() - v;
+        const e = dot(d, d);
+        if (e < best_err) {
+            best_err = e;
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+fn bc7_palette(e0: Vec4, e1: Vec4) [16]Vec4 {
+    var palette: [16]Vec4 = undefined;
+    for (&palette, bc7_weights) |*p, w| {
+        p.* = @floor((e0 * splat(64.0 - w) + e1 * splat(w) + splat(32.0)) / splat(64.0));
+    }
+    return palette;
+}
+
+const Bc7Block = struct {
+    endpoints: [2]Bc7Endpoint,
+    indices: [16]u4,
+    err: f32,
+};
+
+fn bc7_evaluate(texels: *const [16]Vec4, a: Vec4, b: Vec4, opaque_block: bool) Bc7Block {
+    var result = Bc7Block{ .endpoints = .{ bc7_quantize(a, opaque_block), bc7_quantize(b, opaque_block) }, .indices = undefined, .err = 0 };
+    const palette = bc7_palette(result.endpoints[0].value(), result.endpoints[1].value());
+    for (texels, 0..) |t, i| {
+        var best: u4 = 0;
+        var best_err = std.math.inf(f32);
+        for (palette, 0..) |p, j| {
+            const d = t - p;
+            const e = dot(d, d);
+            if (e < best_err) {
+                best_err = e;
+                best = @intCast(j);
+            }
+        }
+        result.indices[i] = best;
+        result.err += best_err;
+    }
+    return result;
+}
+
+const BitWriter = struct {
+    bits: u128 = 0,
+    pos: u8 = 0,
+
+    fn put(self: *BitWriter, value: u32, count: u8) void {
+        self.bits |= @as(u128, value) << @intCast(self.pos);
+        self.pos += count;
+    }
+};
+
+fn encode_bc7_block(texels: *const [16]Vec4, out: *[16]u8) void {
+    const mean = block_mean(texels);
+    const axis = principal_axis(texels, mean, rgba_mask);
+    var opaque_block = true;
+    for (texels) |t| opaque_block = opaque_block and t[3] == 255.0;
+
+    var best: Bc7Block = undefined;
+    if (dot(axis, axis) == 0) {
+        best = bc7_evaluate(texels, mean, mean, opaque_block);
+    } else {
+        const ends = axis_extents(texels, mean, axis);
+        best = bc7_evaluate(texels, ends[0], ends[1], opaque_block);
+
+        var weights: [16]f32 = undefined;
+        for (&weights, best.indices) |*w, index| w.* = bc7_weights[index] / 64.0;
+        if (refit_endpoints(texels, &weights)) |refit| {
+            const candidate = bc7_evaluate(texels, refit[0], refit[1], opaque_block);
+            if (candidate.err < best.err) best = candidate;
+        }
+    }
+
+    // The anchor index is stored with its top bit implied zero; flip the palette if needed.
+    if (best.indices[0] >= 8) {
+        std.mem.swap(Bc7Endpoint, &best.endpoints[0], &best.endpoints[1]);
+        for (&best.indices) |*index| index.* = 15 - index.*;
+    }
+
+    var writer = BitWriter{};
+    writer.put(1 << 6, 7);
+    inline for (0..4) |c| {
+        writer.put(best.endpoints[0].q[c], 7);
+        writer.put(best.endpoints[1].q[c], 7);
+    }
+    writer.put(best.endpoints[0].p, 1);
+    writer.put(best.endpoints[1].p, 1);
+    writer.put(best.indices[0], 3);
+    for (best.indices[1..]) |index| writer.put(index, 4);
+    std.debug.assert(writer.pos == 128);
+    std.mem.writeInt(u128, out, writer.bits, .little);
+}
+
+// Level encoding on the job system ------------------------------------------------------------
+
+/// Target blocks per job: enough work to amortise scheduling, small enough to balance workers.
+const BLOCKS_PER_JOB: u32 = 1024;
+
+const EncodeBand = struct {
+    format: CookFormat,
+    pixels: []const u8,
+    width: u32,
+    height: u32,
+    out: []u8,
+    first_row: u32,
+    end_row: u32,
+
+    fn run(self: *const EncodeBand) void {
+        const blocks_x = (self.width + 3) / 4;
+        const size = block_bytes(self.format);
+        var texels: [16]Vec4 = undefined;
+        var by = self.first_row;
+        while (by < self.end_row) : (by += 1) {
+            var bx: u32 = 0;
+            while (bx < blocks_x) : (bx += 1) {
+                load_block(self.pixels, self.width, self.height, bx, by, &texels);
+                const block = self.out[(@as(usize, by) * blocks_x + bx) * size ..];
+                switch (self.format) {
+                    .bc1 => encode_bc1_block(&texels, block[0..8]),
+                    .bc5 => encode_bc5_block(&texels, block[0..16]),
+                    .bc7 => encode_bc7_block(&texels, block[0..16]),
+                }
+            }
+        }
+    }
+};
+
+fn encode_band_job(data: ?*anyopaque) callconv(.c) i32 {
+    const band: *const EncodeBand = @ptrCast(@alignCast(data.?));
+    band.run();
+    return 0;
+}
+
+/// Encodes one RGBA8 level into `out`, which must hold exactly one level of `format`. Bands of
+/// block rows run on the job system when it is up, inline otherwise.
+pub fn encode_level(allocator: std.mem.Allocator, format: CookFormat, pixels: []const u8, width: u32, height: u32, out: []u8) !void {
+    const blocks_x = (width + 3) / 4;
+    const blocks_y = (height + 3) / 4;
+    std.debug.assert(out.len == @as(usize, blocks_x) * blocks_y * block_bytes(format));
+
+    const rows_per_band = @max(BLOCKS_PER_JOB / blocks_x, 1);
+    const band_count = (blocks_y + rows_per_band - 1) / rows_per_band;
+    if (band_count <= 1) {
+        const band = EncodeBand{ .format = format, .pixels = pixels, .width = width, .height = height, .out = out, .first_row = 0, .end_row = blocks_y };
+        band.run();
+        return;
+    }
+
+    const bands = try allocator.alloc(EncodeBand, band_count);
+    defer allocator.free(bands);
+    var jobs = std.ArrayListUnmanaged(*job_system.Job){};
+    defer jobs.deinit(allocator);
+    try jobs.ensureTotalCapacity(allocator, band_count);
+
+    for (bands, 0..) |*band, i| {
+        const first_row: u32 = @intCast(i * rows_per_band);
+        band.* = .{
+            .format = format,
+            .pixels = pixels,
+            .width = width,
+            .height = height,
+            .out = out,
+            .first_row = first_row,
+            .end_row = @min(first_row + rows_per_band, blocks_y),
+        };
+        const job = job_system.create_job(encode_band_job, band, .NORMAL) orelse {
+            band.run();
+            continue;
+        };
+        job.push_to_completed_queue = false;
+        while (!job_system.submit_job(job)) {
+            std.Thread.yield() catch {};
+        }
+        jobs.appendAssumeCapacity(job);
+    }
+
+    job_system.wait_for_jobs(jobs.items);
+    for (jobs.items) |job| job_system.free_job(job);
+}
+
+// ---------------------------------------------------------------------------------------------
+// Block decoding (reference decoders for tests and tools)
+// ---------------------------------------------------------------------------------------------
+
+fn decode_bc1_block(block: *const [8]u8, out: *[16][4]u8) void {
+    const c0 = std.mem.readInt(u16, block[0..2], .little);
+    const c1 = std.mem.readInt(u16, block[2..4], .little);
+    const indices = std.mem.readInt(u32, block[4..8], .little);
+    const p0 = unpack565(c0);
+    const p1 = unpack565(c1);
+    const palette = if (c0 > c1)
+        [4]Vec4{ p0, p1, (p0 * splat(2.0) + p1) / splat(3.0), (p0 + p1 * splat(2.0)) / splat(3.0) }
+    else
+        [4]Vec4{ p0, p1, (p0 + p1) / splat(2.0), splat(0.0) };
+    for (out, 0..) |*texel, i| {
+        const p = palette[(indices >> @intCast(i * 2)) & 3];
+        inline for (0..4) |c| texel[c] = @intFromFloat(@round(p[c]));
+    }
+}
+
+fn decode_bc4_block(block: *const [8]u8, out: *[16]u8) void {
+    const palette = bc4_palette(block[0], block[1]);
+    var bits: u64 = 0;
+    for (0..6) |k| bits |= @as(u64, block[2 + k]) << @intCast(k * 8);
+    for (out, 0..) |*v, i| v.* = @intFromFloat(palette[@intCast((bits >> @intCast(i * 3)) & 7)]);
+}
+
+fn decode_bc7_block(block: *const [16]u8, out: *[16][4]u8) !void {
+    const bits = std.mem.readInt(u128, block, .little);
+    if (bits & 0x7f != 0x40) return error.UnsupportedBc7Mode;
+
+    var pos: u8 = 7;
+    const take = struct {
+        fn f(b: u128, p: *u8, count: u8) u32 {
+            const v: u32 = @truncate((b >> @intCast(p.*)) & ((@as(u128, 1) << @intCast(count)) - 1));
+            p.* += count;
+            return v;
+        }
+    }.f;
+
+    var endpoints: [2]Bc7Endpoint = undefined;
+    inline for (0..4) |c| {
+        endpoints[0].q[c] = @intCast(take(bits, &pos, 7));
+        endpoints[1].q[c] = @intCast(take(bits, &pos, 7));
+    }
+    endpoints[0].p = @intCast(take(bits, &pos, 1));
+    endpoints[1].p = @intCast(take(bits, &pos, 1));
+
+    const palette = bc7_palette(endpoints[0].value(), endpoints[1].value());
+    for (out, 0..) |*texel, i| {
+        const index = take(bits, &pos, @as(u8, if (i == 0) 3 else 4));
+        inline for (0..4) |c| texel[c] = @intFromFloat(palette[index][c]);
+    }
+}
+
+/// Decodes one level of `format` blocks back to RGBA8. BC5 decodes to (R, G, 0, 255).
+pub fn decode_level(format: CookFormat, blocks: []const u8, width: u32, height: u32, out_rgba: []u8) !void {
+    const blocks_x = (width + 3) / 4;
+    const blocks_y = (height + 3) / 4;
+    const size = block_bytes(format);
+    if (blocks.len < @as(usize, blocks_x) * blocks_y * size or out_rgba.len < @as(usize, width) * height * 4) return error.BufferTooSmall;
+
+    var texels: [16][4]u8 = undefined;
+    for (0..blocks_y) |by| {
+        for (0..blocks_x) |bx| {
+            const block = blocks[(by * blocks_x + bx) * size ..];
+            switch (format) {
+                .bc1 => decode_bc1_block(block[0..8], &texels),
+                .bc7 => try decode_bc7_block(block[0..16], &texels),
+                .bc5 => {
+                    var red: [16]u8 = undefined;
+                    var green: [16]u8 = undefined;
+                    decode_bc4_block(block[0..8], &red);
+                    decode_bc4_block(block[8..16], &green);
+                    for (&texels, red, green) |*t, r, g| t.* = .{ r, g, 0, 255 };
+                },
+            }
+            for (0..4) |y| {
+                const py = by * 4 + y;
+                if (py >= height) break;
+                for (0..4) |x| {
+                    const px = bx * 4 + x;
+                    if (px >= width) break;
+                    @memcpy(out_rgba[(py * width + px) * 4 ..][0..4], &texels[y * 4 + x]);
+                }
+            }
+        }
+    }
+}
+
+/// Peak signal-to-noise ratio in dB between two RGBA8 images over the first `channels` channels.
+pub fn psnr(a: []const u8, b: []const u8, channels: u32) f64 {
+    var sum: f64 = 0;
+    var count: usize = 0;
+    var i: usize = 0;
+    while (i + 4 <= @min(a.len, b.len)) : (i += 4) {
+        for (0..channels) |c| {
+            const d = @as(f64, @floatFromInt(a[i + c])) - @as(f64, @floatFromInt(b[i + c]));
+            sum += d * d;
+            count += 1;
+        }
+    }
+    if (sum == 0) return std.math.inf(f64);
+    const mse = sum / @as(f64, @floatFromInt(count));
+    return 10.0 * std.math.log10(255.0 * 255.0 / mse);
+}
+
+// ---------------------------------------------------------------------------------------------
+// DDS container
+// ---------------------------------------------------------------------------------------------
+
+/// Magic + DDS_HEADER + DDS_HEADER_DXT10.
+pub const DDS_PREFIX_SIZE: usize = 4 + 124 + 20;
+
+/// Serializes a cooked chain as a DX10 DDS file. The buffer is 4-byte aligned so `dds_loader`
+/// can read the headers in place.
+pub fn write_dds(allocator: std.mem.Allocator, cooked: *const CookedTexture) ![]align(4) u8 {
+    const buf = try allocator.alignedAlloc(u8, .@"4", DDS_PREFIX_SIZE + cooked.data.len);
+    @memset(buf[0..DDS_PREFIX_SIZE], 0);
+    const put = struct {
+        fn f(b: []u8, offset: usize, value: u32) void {
+            std.mem.writeInt(u32, b[offset..][0..4], value, .little);
+        }
+    }.f;
+
+    const DDSD_REQUIRED: u32 = 0x1 | 0x2 | 0x4 | 0x1000; // CAPS | HEIGHT | WIDTH | PIXELFORMAT
+    const DDSD_MIPMAPCOUNT: u32 = 0x20000;
+    const DDSD_LINEARSIZE: u32 = 0x80000;
+    const DDSCAPS_TEXTURE: u32 = 0x1000;
+    const DDSCAPS_COMPLEX_MIPMAP: u32 = 0x8 | 0x400000;
+
+    put(buf, 0, 0x20534444); // "DDS "
+    put(buf, 4, 124);
+    put(buf, 8, DDSD_REQUIRED | DDSD_LINEARSIZE | (if (cooked.mip_count > 1) DDSD_MIPMAPCOUNT else 0));
+    put(buf, 12, cooked.height);
+    put(buf, 16, cooked.width);
+    put(buf, 20, @intCast(texture_types.mip_level_size(vk_format(cooked.settings), cooked.width, cooked.height)));
+    put(buf, 28, cooked.mip_count);
+    // DDS_PIXELFORMAT at 76: size, DDPF_FOURCC, "DX10".
+    put(buf, 76, 32);
+    put(buf, 80, 0x4);
+    put(buf, 84, 0x30315844);
+    put(buf, 108, DDSCAPS_TEXTURE | (if (cooked.mip_count > 1) DDSCAPS_COMPLEX_MIPMAP else 0));
+    // DDS_HEADER_DXT10 at 128: format, TEXTURE2D, misc, array size.
+    put(buf, 128, dxgi_format(cooked.settings));
+    put(buf, 132, 3);
+    put(buf, 140, 1);
+
+    @memcpy(buf[DDS_PREFIX_SIZE..], cooked.data);
+    return buf;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Cache
+// ---------------------------------------------------------------------------------------------
+
+var g_cache_allocator: std.mem.Allocator = undefined;
+var g_cache_dir: ?[]u8 = null;
+
+/// Enables cooking on load with cooked files stored under `cache_dir`. Call before textures start
+/// loading; the directory is not guarded against concurrent reconfiguration.
+pub fn configure(allocator: std.mem.Allocator, cache_dir: []const u8) !void {
+    shutdown();
+    try std.fs.cwd().makePath(cache_dir);
+    g_cache_dir = try allocator.dupe(u8, cache_dir);
+    g_cache_allocator = allocator;
+}
+
+/// Disables cooking on load.
+pub fn shutdown() void {
+    if (g_cache_dir) |dir| g_cache_allocator.free(dir);
+    g_cache_dir = null;
+}
+
+pub fn is_enabled() bool {
+    return g_cache_dir != null;
+}
+
+/// Cache key for `source` cooked with `settings`. Content-addressed, so renamed or duplicated
+/// files share an entry and edited files miss.
+pub fn cache_key(source: []const u8, settings: CookSettings) u64 {
+    var hasher = std.hash.Wyhash.init(COOKER_VERSION);
+    hasher.update(source);
+    hasher.update(&[_]u8{ @intFromEnum(settings.format), @intFromBool(settings.srgb), @intFromBool(settings.generate_mips), @intFromBool(settings.normal_map) });
+    return hasher.final();
+}
+
+/// Default settings for a source file: sRGB BC7 for color, linear BC7 with renormalized mips for
+/// files named like normal maps (`*_n`, `*_nrm`, `*_normal`). BC5 stays opt-in because the PBR
+/// shader reads all three normal channels.
+pub fn settings_for_path(path: []const u8) CookSettings {
+    const stem = std.fs.path.stem(path);
+    for ([_][]const u8{ "_n", "_nrm", "_normal", "_normals" }) |suffix| {
+        if (std.ascii.endsWithIgnoreCase(stem, suffix)) return .{ .format = .bc7, .srgb = false, .normal_map = true };
+    }
+    return .{};
+}
+
+/// True for sources the cooker handles: LDR images stb can decode. DDS is already GPU-ready, and
+/// EXR/HDR would lose range in an 8-bit format.
+fn is_cookable(source: []const u8) bool {
+    if (source.len < 4) return false;
+    if (std.mem.eql(u8, source[0..4], "DDS ")) return false;
+    if (std.mem.eql(u8, source[0..4], &[_]u8{ 0x76, 0x2f, 0x31, 0x01 })) return false;
+    return !decode_stb.source_is_hdr(source);
+}
+
+/// Decodes an encoded image and returns it cooked as a DDS file.
+pub fn cook_source(allocator: std.mem.Allocator, source: []const u8, settings: CookSettings) ![]align(4) u8 {
+    var decoded: texture_types.TextureData = undefined;
+    if (!decode_stb.decode_from_memory(source.ptr, source.len, &decoded)) return error.DecodeFailed;
+    defer decode_stb.free_pixels(decoded.data.?);
+    if (decoded.is_hdr != 0) return error.UnsupportedSource;
+
+    const pixels = decoded.data.?[0 .. @as(usize, decoded.width) * decoded.height * 4];
+    var cooked = try cook(allocator, pixels, decoded.width, decoded.height, settings);
+    defer cooked.deinit();
+    return write_dds(allocator, &cooked);
+}
+
+fn read_cached(allocator: std.mem.Allocator, path: []const u8) ?[]align(4) u8 {
+    const file = std.fs.cwd().openFile(path, .{}) catch return null;
+    defer file.close();
+    const size = file.getEndPos() catch return null;
+    const buf = allocator.alignedAlloc(u8, .@"4", @intCast(size)) catch return null;
+    const read = file.preadAll(buf, 0) catch 0;
+    if (read != buf.len) {
+        allocator.free(buf);
+        return null;
+    }
+    return buf;
+}
+
+fn write_cached(cache_dir: []const u8, name: []const u8, bytes: []const u8) !void {
+    var dir = try std.fs.cwd().makeOpenPath(cache_dir, .{});
+    defer dir.close();
+    var tmp_buf: [64]u8 = undefined;
+    const tmp_name = try std.fmt.bufPrint(&tmp_buf, "{s}.{x}.tmp", .{ name, std.crypto.random.int(u32) });
+    try dir.writeFile(.{ .sub_path = tmp_name, .data = bytes });
+    errdefer dir.deleteFile(tmp_name) catch {};
+    // Concurrent loaders of the same source race benignly: rename is atomic and both write the
+    // same bytes.
+    try dir.rename(tmp_name, name);
+}
+
+/// Loads `source` (the encoded bytes of `path`) as a cooked texture, cooking and caching it on a
+/// miss. Returns false when cooking is disabled or does not apply so the caller can fall back to
+/// a plain decode. On success `out_texture.data` is malloc-owned like any DDS load.
+pub fn load_cooked(allocator: std.mem.Allocator, path: []const u8, source: []const u8, out_texture: *texture_types.TextureData) bool {
+    const cache_dir = g_cache_dir orelse return false;
+    if (!is_cookable(source)) return false;
+
+    const settings = settings_for_path(path);
+    var name_buf: [32]u8 = undefined;
+    const name = std.fmt.bufPrint(&name_buf, "{x:0>16}.dds", .{cache_key(source, settings)}) catch unreachable;
+    const cached_path = std.fs.path.join(allocator, &[_][]const u8{ cache_dir, name }) catch return false;
+    defer allocator.free(cached_path);
+
+    if (read_cached(allocator, cached_path)) |dds| {
+        defer allocator.free(dds);
+        if (dds_loader.load_dds_from_memory(dds, out_texture)) return true;
+        cook_log.warn("Discarding unreadable cooked texture {s}", .{cached_path});
+    }
+
+    var timer = std.time.Timer.start() catch null;
+    const dds = cook_source(allocator, source, settings) catch |err| {
+        cook_log.warn("Failed to cook {s}: {s}", .{ path, @errorName(err) });
+        return false;
+    };
+    defer allocator.free(dds);
+
+    write_cached(cache_dir, name, dds) catch |err| {
+        cook_log.warn("Failed to cache cooked texture {s}: {s}", .{ cached_path, @errorName(err) });
+    };
+    if (!dds_loader.load_dds_from_memory(dds, out_texture)) return false;
+
+    const elapsed_ms = if (timer) |*t| @as(f64, @floatFromInt(t.read())) / 1e6 else 0;
+    cook_log.info("Cooked {s} ({d}x{d} {s}) in {d:.1} ms", .{ path, out_texture.width, out_texture.height, @tagName(settings.format), elapsed_ms });
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------------------------
+
+/// A diagonal color ramp with mild per-texel noise: smooth like most albedo, noisy enough that
+/// blocks are not exactly collinear.
+fn make_test_image(allocator: std.mem.Allocator, width: u32, height: u32) ![]u8 {
+    const pixels = try allocator.alloc(u8, @as(usize, width) * height * 4);
+    var prng = std.Random.DefaultPrng.init(7);
+    const random = prng.random();
+    for (0..height) |y| {
+        for (0..width) |x| {
+            const t = @as(f32, @floatFromInt(x + y)) / @as(f32, @floatFromInt(width + height - 2));
+            const base = [3]f32{ 40 + 180 * t, 200 - 150 * t, 90 + 60 * t };
+            const p = pixels[(y * width + x) * 4 ..][0..4];
+            for (0..3) |c| {
+                const noise = @as(f32, @floatFromInt(random.intRangeAtMost(i32, -4, 4)));
+                p[c] = @intFromFloat(std.math.clamp(base[c] + noise, 0, 255));
+            }
+            p[3] = 255;
+        }
+    }
+    return pixels;
+}
+
+test "texture cooker block encoders meet PSNR targets" {
+    const allocator = std.testing.allocator;
+    const width = 64;
+    const height = 64;
+    const source = try make_test_image(allocator, width, height);
+    defer allocator.free(source);
+    const decoded = try allocator.alloc(u8, source.len);
+    defer allocator.free(decoded);
+
+    var results: [3]f64 = undefined;
+    const cases = [_]struct { format: CookFormat, channels: u32, min_db: f64 }{
+        .{ .format = .bc1, .channels = 3, .min_db = 32.0 },
+        .{ .format = .bc5, .channels = 2, .min_db = 38.0 },
+        .{ .format = .bc7, .channels = 4, .min_db = 36.0 },
+    };
+    for (cases, 0..) |case, i| {
+        const blocks = try allocator.alloc(u8, (width / 4) * (height / 4) * block_bytes(case.format));
+        defer allocator.free(blocks);
+        try encode_level(allocator, case.format, source, width, height, blocks);
+        try decode_level(case.format, blocks, width, height, decoded);
+        results[i] = psnr(source, decoded, case.channels);
+        try std.testing.expect(results[i] >= case.min_db);
+    }
+    // BC7 spends twice the bits of BC1 and should show it.
+    try std.testing.expect(results[2] > results[0]);
+}
+
+test "texture cooker builds gamma-correct mip chains" {
+    const allocator = std.testing.allocator;
+
+    // Black/white checkerboard: averaging in linear light gives 50% intensity, sRGB code ~188,
+    // where a naive average of the codes would give 128.
+    const size = 8;
+    var pixels: [size * size * 4]u8 = undefined;
+    for (0..size) |y| {
+        for (0..size) |x| {
+            const v: u8 = if ((x + y) % 2 == 0) 0 else 255;
+            pixels[(y * size + x) * 4 ..][0..4].* = .{ v, v, v, 255 };
+        }
+    }
+
+    var cooked = try cook(allocator, &pixels, size, size, .{});
+    defer cooked.deinit();
+    try std.testing.expectEqual(@as(u32, 4), cooked.mip_count);
+    try std.testing.expectEqual(cooked.mip_count, texture_types.mip_level_count(vk_format(cooked.settings), size, size, cooked.data.len));
+
+    const level0_size: usize = @intCast(texture_types.mip_level_size(vk_format(cooked.settings), size, size));
+    var level1: [4 * 4 * 4]u8 = undefined;
+    try decode_level(.bc7, cooked.data[level0_size..][0..16], 4, 4, &level1);
+    for (0..16) |i| {
+        try std.testing.expect(level1[i * 4] >= 184 and level1[i * 4] <= 192);
+        try std.testing.expectEqual(@as(u8, 255), level1[i * 4 + 3]);
+    }
+
+    // Non-square chains run down to 1x1 on the longer side.
+    const wide = try make_test_image(allocator, 64, 16);
+    defer allocator.free(wide);
+    var cooked_wide = try cook(allocator, wide, 64, 16, .{ .format = .bc1 });
+    defer cooked_wide.deinit();
+    try std.testing.expectEqual(@as(u32, 7), cooked_wide.mip_count);
+    try std.testing.expectEqual(@as(u32, 7), texture_types.mip_level_count(vk_format(cooked_wide.settings), 64, 16, cooked_wide.data.len));
+}
+
+test "texture cooker DDS output round-trips through the DDS loader" {
+    const allocator = std.testing.allocator;
+    const source = try make_test_image(allocator, 32, 32);
+    defer allocator.free(source);
+
+    var cooked = try cook(allocator, source, 32, 32, .{ .format = .bc7 });
+    defer cooked.deinit();
+    const dds = try write_dds(allocator, &cooked);
+    defer allocator.free(dds);
+
+    var loaded: texture_types.TextureData = undefined;
+    try std.testing.expect(dds_loader.load_dds_from_memory(dds, &loaded));
+    defer if (loaded.data) |data| std.c.free(data);
+    try std.testing.expectEqual(vk_formats.VK_FORMAT_BC7_SRGB_BLOCK, loaded.format);
+    try std.testing.expectEqual(@as(u32, 32), loaded.width);
+    try std.testing.expectEqual(@as(u64, cooked.data.len), loaded.data_size);
+    try std.testing.expectEqualSlices(u8, cooked.data, loaded.data.?[0..cooked.data.len]);
+
+    try std.testing.expect(settings_for_path("textures/brick_Normal.png").normal_map);
+    try std.testing.expect(!settings_for_path("textures/brick_albedo.png").normal_map);
+    try std.testing.expect(cache_key(source, .{}) != cache_key(source, .{ .format = .bc1 }));
+}
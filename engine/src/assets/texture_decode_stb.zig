@@ -20,6 +20,11 @@ pub fn free_pixels(pixels: ?*anyopaque) void {
     stbi_image_free(pixels);
 }
 
+/// Returns true when stb would decode `data` as HDR (Radiance `.hdr`).
+pub fn source_is_hdr(data: []const u8) bool {
+    return stbi_is_hdr_from_memory(data.ptr, @intCast(data.len)) != 0;
+}
+
 /// Decodes an image blob into `out_texture`.
 ///
 /// The returned `out_texture.data` is stb-owned and must be freed with `free_pixels`.
@@ -1,16 +1,19 @@
-//! Texture decoding, ref-counted loading, and LRU caching.
+//! Texture decoding and ref-counted loading.
 //!
 //! Provides synchronous and async-capable texture loading for common formats via stb_image, DDS,
 //! and TinyEXR. Textures are typically backed by a `ref_counting.CardinalRefCountedResource` so
-//! they can be shared across scenes/materials.
+//! they can be shared across scenes/materials. Loaded resources are cached in the asset manager,
+//! which also owns eviction.
 const std = @import("std");
 const memory = @import("../core/memory.zig");
 const log = @import("../core/log.zig");
 const ref_counting = @import("../core/ref_counting.zig");
 const async_loader = @import("../core/async_loader.zig");
 const resource_state = @import("../core/resource_state.zig");
+const vfs = @import("../core/vfs.zig");
 const dds_loader = @import("dds_loader.zig");
 const texture_types = @import("texture_types.zig");
+const texture_cooker = @import("texture_cooker.zig");
 const decode_stb = @import("texture_decode_stb.zig");
 const decode_exr = @import("texture_decode_exr.zig");
 const vk_formats = @import("../renderer/vulkan_format_constants.zig");
@@ -37,32 +40,6 @@ pub const TextureCacheStats = extern struct {
     cache_misses: u32,
 };
 
-const TextureCacheEntry = struct {
-    /// File path slice; allocation includes a trailing 0 byte for C interop.
-    filepath: []const u8,
-    resource: *ref_counting.CardinalRefCountedResource,
-    last_access_time: u64,
-    memory_usage: u64,
-    next: ?*TextureCacheEntry,
-    prev: ?*TextureCacheEntry,
-};
-
-const TextureCache = struct {
-    head: ?*TextureCacheEntry = null,
-    tail: ?*TextureCacheEntry = null,
-    entry_count: u32 = 0,
-    max_entries: u32 = 0,
-    total_memory_usage: u64 = 0,
-    max_memory_usage: u64 = 512 * 1024 * 1024,
-    cache_hits: u32 = 0,
-    cache_misses: u32 = 0,
-    evictions: u32 = 0,
-    mutex: std.Thread.Mutex = .{},
-    initialized: bool = false,
-};
-
-var g_texture_cache: TextureCache = .{};
-
 /// Placeholder texture (1x1 magenta) returned when async loads are pending.
 var g_placeholder_data = [_]u8{ 255, 0, 255, 255 };
 var g_placeholder_texture = TextureData{
@@ -77,7 +54,6 @@ var g_placeholder_texture = TextureData{
 
 /// Looks up `path` in the cache and returns a retained resource if present.
 pub export fn cardinal_texture_check_cache(path: [*:0]const u8) ?*ref_counting.CardinalRefCountedResource {
-    if (!g_texture_cache.initialized) return null;
     const filepath_slice = std.mem.span(path);
     return texture_cache_get(filepath_slice);
 }
@@ -89,35 +65,30 @@ pub export fn cardinal_texture_get_placeholder(out_texture: *TextureData) void {
 
 /// Loads a texture from disk into `out_texture`.
 ///
-/// Uses filesystem APIs that handle Unicode paths on Windows, then delegates to
+/// Reads through the VFS, so mounted packs are searched before loose files; stored pack entries
+/// are decoded straight from the mapping. When texture cooking is enabled, LDR images are served
+/// as mipmapped block-compressed textures from the cooker's cache. Otherwise delegates to
 /// `texture_load_from_memory` for format detection and decode.
 pub export fn texture_load_from_disk(path: [*:0]const u8, out_texture: *TextureData) bool {
     const filename_slice = std.mem.span(path);
 
     const allocator = memory.cardinal_get_allocator_for_category(.ASSETS).as_allocator();
 
-    var file_buffer: []u8 = undefined;
-
-    if (std.fs.path.isAbsolute(filename_slice)) {
-        var file = std.fs.openFileAbsolute(filename_slice, .{}) catch |err| {
-            texture_log.err("Failed to open file '{s}': {s}", .{ filename_slice, @errorName(err) });
-            return false;
-        };
-        defer file.close();
+    var file_data = vfs.read_file(allocator, filename_slice) catch |err| {
+        texture_log.err("Failed to read file '{s}': {s}", .{ filename_slice, @errorName(err) });
+        return false;
+    };
+    defer file_data.deinit();
 
-        file_buffer = file.readToEndAlloc(allocator, 4 * 1024 * 1024 * 1024) catch |err| {
-            texture_log.err("Failed to read file '{s}': {s}", .{ filename_slice, @errorName(err) });
-            return false;
-        };
-    } else {
-        file_buffer = std.fs.cwd().readFileAlloc(allocator, filename_slice, 4 * 1024 * 1024 * 1024) catch |err| {
-            texture_log.err("Failed to read file '{s}': {s}", .{ filename_slice, @errorName(err) });
-            return false;
-        };
-    }
-    defer allocator.free(file_buffer);
+    return texture_load_from_file_bytes(filename_slice, file_data.bytes, out_texture);
+}
 
-    return texture_load_from_memory(file_buffer.ptr, file_buffer.len, out_texture);
+/// Decodes `bytes`, the contents of the file at `path`, the way `texture_load_from_disk` does once
+/// it has read them (including the cooked-texture lookup).
+pub fn texture_load_from_file_bytes(path: []const u8, bytes: []const u8, out_texture: *TextureData) bool {
+    const allocator = memory.cardinal_get_allocator_for_category(.ASSETS).as_allocator();
+    if (texture_cooker.load_cooked(allocator, path, bytes, out_texture)) return true;
+    return texture_load_from_memory(bytes.ptr, bytes.len, out_texture);
 }
 
 /// Loads a texture from a memory buffer into `out_texture`.
@@ -210,7 +181,6 @@ const TextureLoadContext = struct {
 };
 
 fn texture_load_async_func(task: ?*async_loader.CardinalAsyncTask, user_data: ?*anyopaque) callconv(.c) bool {
-    _ = task;
     if (user_data == null) return false;
 
     const context = @as(*TextureLoadContext, @ptrCast(@alignCast(user_data)));
@@ -228,8 +198,14 @@ fn texture_load_async_func(task: ?*async_loader.CardinalAsyncTask, user_data: ?*
 
     texture_log.debug("Async loading texture: {s}", .{std.mem.span(path)});
 
+    // The I/O service normally read the file before this task was queued.
     var tex_data: TextureData = undefined;
-    if (texture_load_from_disk(path, &tex_data)) {
+    const read_ahead = if (task) |t| async_loader.get_file_data(t) else null;
+    const loaded = if (read_ahead) |bytes|
+        texture_load_from_file_bytes(std.mem.span(path), bytes, &tex_data)
+    else
+        texture_load_from_disk(path, &tex_data);
+    if (loaded) {
         texture_log.debug("Async load success: {s} ({d}x{d})", .{ std.mem.span(path), tex_data.width, tex_data.height });
         const existing_data = @as(*TextureData, @ptrCast(@alignCast(resource.resource.?)));
         texture_log.warn("Writing texture data to {*}: Size={d}, Format={d}", .{ existing_data, tex_data.data_size, tex_data.format });
@@ -240,6 +216,8 @@ fn texture_load_async_func(task: ?*async_loader.CardinalAsyncTask, user_data: ?*
     } else {
         texture_log.err("Async load failed: {s}", .{std.mem.span(path)});
         _ = resource_state.cardinal_resource_state_set(resource.identifier.?, .ERROR, loading_thread_id);
+        // Keep the placeholder out of the cache so the next request retries the load.
+        if (asset_manager.is_initialized()) asset_manager.get().forgetTexture(std.mem.span(path));
         return false;
     }
 }
@@ -249,254 +227,59 @@ fn texture_load_task_cleanup(task: ?*async_loader.CardinalAsyncTask, user_data:
     async_loader.cardinal_async_free_task(task);
 }
 
-/// Initializes the global texture LRU cache.
+/// Initializes texture caching.
+///
+/// Cached textures live in the asset manager; `max_entries` is kept for API compatibility, and
+/// residency is bounded by the asset manager's byte budget instead.
 pub export fn texture_cache_initialize(max_entries: u32) bool {
-    if (g_texture_cache.initialized) return true;
-
-    g_texture_cache.head = null;
-    g_texture_cache.tail = null;
-    g_texture_cache.entry_count = 0;
-    g_texture_cache.max_entries = max_entries;
-    g_texture_cache.total_memory_usage = 0;
-    g_texture_cache.max_memory_usage = 512 * 1024 * 1024;
-    g_texture_cache.cache_hits = 0;
-    g_texture_cache.cache_misses = 0;
-    g_texture_cache.evictions = 0;
-    g_texture_cache.initialized = true;
-
-    texture_log.info("LRU texture cache initialized (max_entries={d}, max_memory={d} MB)", .{ max_entries, g_texture_cache.max_memory_usage / (1024 * 1024) });
+    asset_manager.init() catch |err| {
+        texture_log.err("Failed to initialize asset manager for texture caching: {s}", .{@errorName(err)});
+        return false;
+    };
+    texture_log.info("Texture cache initialized (max_entries={d} ignored, budget={d} MB)", .{ max_entries, asset_manager.get().budget_bytes.load(.monotonic) / (1024 * 1024) });
     return true;
 }
 
-/// Shuts down the texture cache and releases all cached resources.
+/// Drops all unreferenced cached textures.
 pub export fn texture_cache_shutdown_system() void {
-    if (!g_texture_cache.initialized) return;
-
-    g_texture_cache.mutex.lock();
-    defer g_texture_cache.mutex.unlock();
-
-    var entry = g_texture_cache.head;
-    const allocator = memory.cardinal_get_allocator_for_category(.ASSETS);
-
-    while (entry) |current| {
-        const next = current.next;
-
-        memory.cardinal_free(allocator, @ptrCast(@constCast(current.filepath.ptr)));
-
-        ref_counting.cardinal_ref_release(current.resource);
-
-        memory.cardinal_free(allocator, current);
-
-        entry = next;
-    }
-
-    g_texture_cache.head = null;
-    g_texture_cache.tail = null;
-    g_texture_cache.entry_count = 0;
-    g_texture_cache.total_memory_usage = 0;
-    g_texture_cache.initialized = false;
-
-    texture_log.info("Thread-safe texture cache shutdown", .{});
+    if (!asset_manager.is_initialized()) return;
+    const removed = asset_manager.get().textures.clear_unreferenced();
+    texture_log.info("Texture cache shutdown ({d} entries released)", .{removed});
 }
 
 /// Returns cache statistics for diagnostics/UI.
 pub export fn texture_cache_get_stats() TextureCacheStats {
-    if (!g_texture_cache.initialized) return std.mem.zeroes(TextureCacheStats);
-
-    g_texture_cache.mutex.lock();
-    defer g_texture_cache.mutex.unlock();
-
+    if (!asset_manager.is_initialized()) return std.mem.zeroes(TextureCacheStats);
+    const textures = &asset_manager.get().textures;
     return .{
-        .entry_count = g_texture_cache.entry_count,
-        .max_entries = g_texture_cache.max_entries,
-        .cache_hits = g_texture_cache.cache_hits,
-        .cache_misses = g_texture_cache.cache_misses,
+        .entry_count = textures.count(),
+        .max_entries = textures.map.capacity(),
+        .cache_hits = textures.cache_hits.load(.monotonic),
+        .cache_misses = textures.cache_misses.load(.monotonic),
     };
 }
 
-/// Clears all cache entries but keeps the cache initialized.
+/// Drops all unreferenced cached textures but keeps caching enabled.
 pub export fn texture_cache_clear() void {
-    if (!g_texture_cache.initialized) return;
-
-    g_texture_cache.mutex.lock();
-    defer g_texture_cache.mutex.unlock();
-
-    var entry = g_texture_cache.head;
-    const allocator = memory.cardinal_get_allocator_for_category(.ASSETS);
-
-    while (entry) |current| {
-        const next = current.next;
-        memory.cardinal_free(allocator, @ptrCast(@constCast(current.filepath.ptr)));
-        ref_counting.cardinal_ref_release(current.resource);
-        memory.cardinal_free(allocator, current);
-        entry = next;
-    }
-
-    g_texture_cache.head = null;
-    g_texture_cache.tail = null;
-    g_texture_cache.entry_count = 0;
-    g_texture_cache.total_memory_usage = 0;
-
+    if (!asset_manager.is_initialized()) return;
+    _ = asset_manager.get().textures.clear_unreferenced();
     texture_log.info("Cache cleared", .{});
 }
 
-/// Returns a wall-clock timestamp in milliseconds.
-fn get_current_time_ms() u64 {
-    return @as(u64, @intCast(std.time.milliTimestamp()));
-}
-
-/// Moves an entry to the LRU head (most recently used).
-fn move_to_head(entry: *TextureCacheEntry) void {
-    if (entry == g_texture_cache.head) return;
-
-    if (entry.prev) |prev| {
-        prev.next = entry.next;
-    }
-    if (entry.next) |next| {
-        next.prev = entry.prev;
-    }
-    if (entry == g_texture_cache.tail) {
-        g_texture_cache.tail = entry.prev;
-    }
-
-    entry.prev = null;
-    entry.next = g_texture_cache.head;
-    if (g_texture_cache.head) |head| {
-        head.prev = entry;
-    }
-    g_texture_cache.head = entry;
-
-    if (g_texture_cache.tail == null) {
-        g_texture_cache.tail = entry;
-    }
-}
-
-/// Detaches an entry from the linked-list without freeing it.
-fn remove_from_list(entry: *TextureCacheEntry) void {
-    if (entry.prev) |prev| {
-        prev.next = entry.next;
-    } else {
-        g_texture_cache.head = entry.next;
-    }
-
-    if (entry.next) |next| {
-        next.prev = entry.prev;
-    } else {
-        g_texture_cache.tail = entry.prev;
-    }
-
-    entry.prev = null;
-    entry.next = null;
-}
-
 const asset_manager = @import("asset_manager.zig");
 
-/// Returns a retained resource from the asset manager or LRU cache.
+/// Returns a retained resource cached under `filepath`. Wait-free on hits.
 fn texture_cache_get(filepath: []const u8) ?*ref_counting.CardinalRefCountedResource {
-    if (asset_manager.get().findTexture(filepath)) |tex| {
-        if (tex.ref_resource) |res| {
-            _ = @atomicRmw(u32, &res.ref_count, .Add, 1, .seq_cst);
-            texture_log.debug("Cache hit from AssetManager for {s}", .{filepath});
-            return res;
-        }
-    }
-
-    if (!g_texture_cache.initialized) return null;
-
-    g_texture_cache.mutex.lock();
-    defer g_texture_cache.mutex.unlock();
-
-    var entry = g_texture_cache.head;
-    while (entry) |current| : (entry = current.next) {
-        if (std.mem.eql(u8, current.filepath, filepath)) {
-            current.last_access_time = get_current_time_ms();
-            move_to_head(current);
-
-            _ = @atomicRmw(u32, &current.resource.ref_count, .Add, 1, .seq_cst);
-            g_texture_cache.cache_hits += 1;
-
-            texture_log.debug("Cache hit for {s} (memory usage: {d} bytes)", .{ filepath, current.memory_usage });
-            return current.resource;
-        }
-    }
-
-    g_texture_cache.cache_misses += 1;
-    return null;
+    if (!asset_manager.is_initialized()) return null;
+    const res = asset_manager.get().acquireTextureResource(filepath) orelse return null;
+    texture_log.debug("Cache hit for {s}", .{filepath});
+    return res;
 }
 
-/// Adds `resource` to the cache, evicting entries as needed.
+/// Caches `resource` under `filepath`; the asset manager handles eviction.
 fn texture_cache_put(filepath: []const u8, resource: *ref_counting.CardinalRefCountedResource) bool {
-    if (!g_texture_cache.initialized) return false;
-
-    const texture_data: *TextureData = @ptrCast(@alignCast(resource.resource.?));
-    const texture_memory: u64 = @as(u64, texture_data.width) * texture_data.height * texture_data.channels;
-
-    g_texture_cache.mutex.lock();
-    defer g_texture_cache.mutex.unlock();
-
-    while ((g_texture_cache.total_memory_usage + texture_memory > g_texture_cache.max_memory_usage or
-        g_texture_cache.entry_count >= g_texture_cache.max_entries) and
-        g_texture_cache.tail != null)
-    {
-        const to_remove = g_texture_cache.tail.?;
-        remove_from_list(to_remove);
-
-        g_texture_cache.total_memory_usage -= to_remove.memory_usage;
-        g_texture_cache.entry_count -= 1;
-        g_texture_cache.evictions += 1;
-
-        texture_log.debug("Evicted {s} (freed {d} bytes, total: {d}/{d} bytes)", .{ to_remove.filepath, to_remove.memory_usage, g_texture_cache.total_memory_usage, g_texture_cache.max_memory_usage });
-
-        const allocator = memory.cardinal_get_allocator_for_category(.ASSETS);
-        memory.cardinal_free(allocator, @ptrCast(@constCast(to_remove.filepath.ptr)));
-        ref_counting.cardinal_ref_release(to_remove.resource);
-        memory.cardinal_free(allocator, to_remove);
-    }
-
-    const allocator = memory.cardinal_get_allocator_for_category(.ASSETS);
-
-    const entry_ptr = memory.cardinal_alloc(allocator, @sizeOf(TextureCacheEntry));
-    if (entry_ptr == null) {
-        texture_log.err("Failed to allocate cache entry for {s}", .{filepath});
-        return false;
-    }
-    const new_entry: *TextureCacheEntry = @ptrCast(@alignCast(entry_ptr));
-
-    const filepath_ptr = memory.cardinal_alloc(allocator, filepath.len + 1);
-    if (filepath_ptr == null) {
-        texture_log.err("Failed to allocate filepath for {s}", .{filepath});
-        memory.cardinal_free(allocator, entry_ptr);
-        return false;
-    }
-    const new_filepath = @as([*]u8, @ptrCast(filepath_ptr))[0 .. filepath.len + 1];
-    @memcpy(new_filepath[0..filepath.len], filepath);
-    new_filepath[filepath.len] = 0;
-
-    new_entry.* = .{
-        .filepath = new_filepath[0..filepath.len],
-        .resource = resource,
-        .last_access_time = get_current_time_ms(),
-        .memory_usage = texture_memory,
-        .next = null,
-        .prev = null,
-    };
-
-    _ = @atomicRmw(u32, &resource.ref_count, .Add, 1, .seq_cst);
-
-    if (g_texture_cache.head) |head| {
-        head.prev = new_entry;
-        new_entry.next = g_texture_cache.head;
-    } else {
-        g_texture_cache.tail = new_entry;
-    }
-    g_texture_cache.head = new_entry;
-
-    g_texture_cache.entry_count += 1;
-    g_texture_cache.total_memory_usage += texture_memory;
-
-    texture_log.debug("Cached {s} ({d} bytes, total: {d}/{d} bytes)", .{ filepath, texture_memory, g_texture_cache.total_memory_usage, g_texture_cache.max_memory_usage });
-
-    return true;
+    if (!asset_manager.is_initialized()) return false;
+    return asset_manager.get().cacheTexture(filepath, resource);
 }
 
 /// Destructor for `TextureData` stored in a ref-counted resource.
@@ -552,7 +335,7 @@ pub export fn texture_load_with_ref_counting(filepath: ?[*]const u8, out_texture
     const filename_c: [*:0]const u8 = @ptrCast(filepath.?);
     const raw_path = std.mem.span(filename_c);
 
-    if (!g_texture_cache.initialized) {
+    if (!asset_manager.is_initialized()) {
         _ = texture_cache_initialize(256);
     }
 
@@ -566,16 +349,18 @@ pub export fn texture_load_with_ref_counting(filepath: ?[*]const u8, out_texture
 
     texture_log.debug("Texture load request: {s} (raw: {s})", .{ path, raw_path });
 
+    // Cached entries are either loaded or still loading (failed loads are dropped from the cache),
+    // so a hit needs no resource-state lookup.
+    if (texture_cache_get(path)) |res| {
+        const existing: *TextureData = @ptrCast(@alignCast(res.resource.?));
+        out_texture.?.* = existing.*;
+        texture_log.debug("Reusing cached texture: {s} (ref_count={d})", .{ path, res.ref_count });
+        return res;
+    }
+
     const state = resource_state.cardinal_resource_state_get(path_c);
 
     if (state == .LOADED) {
-        if (texture_cache_get(path)) |res| {
-            const existing: *TextureData = @ptrCast(@alignCast(res.resource.?));
-            out_texture.?.* = existing.*;
-            texture_log.debug("Reusing loaded texture: {s} (ref_count={d})", .{ path, res.ref_count });
-            return res;
-        }
-
         if (ref_counting.cardinal_ref_acquire(path_c)) |res| {
             const existing: *TextureData = @ptrCast(@alignCast(res.resource.?));
             out_texture.?.* = existing.*;
@@ -586,12 +371,6 @@ pub export fn texture_load_with_ref_counting(filepath: ?[*]const u8, out_texture
     }
 
     if (state == .LOADING) {
-        if (texture_cache_get(path)) |res| {
-            const existing: *TextureData = @ptrCast(@alignCast(res.resource.?));
-            out_texture.?.* = existing.*;
-            return res;
-        }
-
         if (resource_state.cardinal_resource_state_wait_for(path_c, .LOADED, 10)) {
             if (texture_cache_get(path)) |res| {
                 const existing: *TextureData = @ptrCast(@alignCast(res.resource.?));
@@ -638,8 +417,10 @@ pub export fn texture_load_with_ref_counting(filepath: ?[*]const u8, out_texture
 
                 _ = @atomicRmw(u32, &temp_ref.ref_count, .Add, 1, .seq_cst);
 
-                const task = async_loader.cardinal_async_submit_custom_task(texture_load_async_func, ctx, .NORMAL, texture_load_task_cleanup, null);
-                if (task == null) {
+                const task = async_loader.cardinal_async_create_custom_task(texture_load_async_func, ctx, .NORMAL, texture_load_task_cleanup, null);
+                const submitted = task != null and async_loader.cardinal_async_submit_task_with_read(task, path_c);
+                if (!submitted) {
+                    if (task != null) async_loader.cardinal_async_free_task(task);
                     log.cardinal_log_error("[TEXTURE] Failed to submit async task for {s}", .{path});
                     memory.cardinal_free(allocator, ctx);
                     _ = @atomicRmw(u32, &temp_ref.ref_count, .Sub, 1, .seq_cst);
@@ -2,6 +2,7 @@
 //!
 //! These structs are used by the C-facing texture loaders and passed across subsystem
 //! boundaries, so their layout should remain stable.
+const vk_formats = @import("../renderer/vulkan_format_constants.zig");
 
 /// Decoded texture payload with metadata and a raw byte buffer.
 pub const TextureData = extern struct {
@@ -18,3 +19,117 @@ pub const TextureData = extern struct {
     /// Total size in bytes of `data`.
     data_size: u64,
 };
+
+/// Storage granularity of a texel format: `block_dim` x `block_dim` texels per `block_bytes`.
+pub const BlockInfo = struct {
+    block_dim: u32,
+    block_bytes: u32,
+};
+
+/// Returns the block layout of `format`, or null for formats the upload path does not size.
+pub fn format_block_info(format: u32) ?BlockInfo {
+    return switch (format) {
+        vk_formats.VK_FORMAT_R8_UNORM => .{ .block_dim = 1, .block_bytes = 1 },
+        vk_formats.VK_FORMAT_R8G8_UNORM => .{ .block_dim = 1, .block_bytes = 2 },
+        vk_formats.VK_FORMAT_R8G8B8A8_UNORM,
+        vk_formats.VK_FORMAT_R8G8B8A8_SRGB,
+        vk_formats.VK_FORMAT_B8G8R8A8_UNORM,
+        vk_formats.VK_FORMAT_B8G8R8A8_SRGB,
+        vk_formats.VK_FORMAT_R16G16_SFLOAT,
+        => .{ .block_dim = 1, .block_bytes = 4 },
+        vk_formats.VK_FORMAT_R16G16B16A16_SFLOAT => .{ .block_dim = 1, .block_bytes = 8 },
+        vk_formats.VK_FORMAT_R32G32B32A32_SFLOAT => .{ .block_dim = 1, .block_bytes = 16 },
+        vk_formats.VK_FORMAT_BC1_RGB_UNORM_BLOCK,
+        vk_formats.VK_FORMAT_BC1_RGB_SRGB_BLOCK,
+        vk_formats.VK_FORMAT_BC1_RGBA_UNORM_BLOCK,
+        vk_formats.VK_FORMAT_BC1_RGBA_SRGB_BLOCK,
+        vk_formats.VK_FORMAT_BC4_UNORM_BLOCK,
+        vk_formats.VK_FORMAT_BC4_SNORM_BLOCK,
+        => .{ .block_dim = 4, .block_bytes = 8 },
+        vk_formats.VK_FORMAT_BC2_UNORM_BLOCK,
+        vk_formats.VK_FORMAT_BC2_SRGB_BLOCK,
+        vk_formats.VK_FORMAT_BC3_UNORM_BLOCK,
+        vk_formats.VK_FORMAT_BC3_SRGB_BLOCK,
+        vk_formats.VK_FORMAT_BC5_UNORM_BLOCK,
+        vk_formats.VK_FORMAT_BC5_SNORM_BLOCK,
+        vk_formats.VK_FORMAT_BC6H_UFLOAT_BLOCK,
+        vk_formats.VK_FORMAT_BC6H_SFLOAT_BLOCK,
+        vk_formats.VK_FORMAT_BC7_UNORM_BLOCK,
+        vk_formats.VK_FORMAT_BC7_SRGB_BLOCK,
+        => .{ .block_dim = 4, .block_bytes = 16 },
+        else => null,
+    };
+}
+
+/// Size in bytes of one `width` x `height` level of `format` (0 for unsized formats).
+pub fn mip_level_size(format: u32, width: u32, height: u32) u64 {
+    const info = format_block_info(format) orelse return 0;
+    const bw: u64 = (@as(u64, @max(width, 1)) + info.block_dim - 1) / info.block_dim;
+    const bh: u64 = (@as(u64, @max(height, 1)) + info.block_dim - 1) / info.block_dim;
+    return bw * bh * info.block_bytes;
+}
+
+/// Number of complete mip levels packed back to back in a `data_size`-byte buffer.
+///
+/// `TextureData` carries no explicit level count; cooked and DDS payloads store the chain
+/// largest-first, so the count is recovered from the byte size. Always at least 1.
+pub fn mip_level_count(format: u32, width: u32, height: u32, data_size: u64) u32 {
+    var w = @max(width, 1);
+    var h = @max(height, 1);
+    var offset: u64 = 0;
+    var levels: u32 = 0;
+    while (true) {
+        const size = mip_level_size(format, w, h);
+        if (size == 0 or offset + size > data_size) break;
+        offset += size;
+        levels += 1;
+        if (w == 1 and h == 1) break;
+        w = @max(w / 2, 1);
+        h = @max(h / 2, 1);
+    }
+    return @max(levels, 1);
+}
+
+/// Returns the linear (UNORM) variant of an sRGB format; other formats are returned unchanged.
+pub fn linear_format(format: u32) u32 {
+    return switch (format) {
+        vk_formats.VK_FORMAT_R8G8B8A8_SRGB => vk_formats.VK_FORMAT_R8G8B8A8_UNORM,
+        vk_formats.VK_FORMAT_B8G8R8A8_SRGB => vk_formats.VK_FORMAT_B8G8R8A8_UNORM,
+        vk_formats.VK_FORMAT_BC1_RGB_SRGB_BLOCK => vk_formats.VK_FORMAT_BC1_RGB_UNORM_BLOCK,
+        vk_formats.VK_FORMAT_BC1_RGBA_SRGB_BLOCK => vk_formats.VK_FORMAT_BC1_RGBA_UNORM_BLOCK,
+        vk_formats.VK_FORMAT_BC2_SRGB_BLOCK => vk_formats.VK_FORMAT_BC2_UNORM_BLOCK,
+        vk_formats.VK_FORMAT_BC3_SRGB_BLOCK => vk_formats.VK_FORMAT_BC3_UNORM_BLOCK,
+        vk_formats.VK_FORMAT_BC7_SRGB_BLOCK => vk_formats.VK_FORMAT_BC7_UNORM_BLOCK,
+        else => format,
+    };
+}
+
+/// Returns the sRGB variant of a linear color format; other formats are returned unchanged.
+pub fn srgb_format(format: u32) u32 {
+    return switch (format) {
+        vk_formats.VK_FORMAT_R8G8B8A8_UNORM => vk_formats.VK_FORMAT_R8G8B8A8_SRGB,
+        vk_formats.VK_FORMAT_B8G8R8A8_UNORM => vk_formats.VK_FORMAT_B8G8R8A8_SRGB,
+        vk_formats.VK_FORMAT_BC1_RGB_UNORM_BLOCK => vk_formats.VK_FORMAT_BC1_RGB_SRGB_BLOCK,
+        vk_formats.VK_FORMAT_BC1_RGBA_UNORM_BLOCK => vk_formats.VK_FORMAT_BC1_RGBA_SRGB_BLOCK,
+        vk_formats.VK_FORMAT_BC2_UNORM_BLOCK => vk_formats.VK_FORMAT_BC2_SRGB_BLOCK,
+        vk_formats.VK_FORMAT_BC3_UNORM_BLOCK => vk_formats.VK_FORMAT_BC3_SRGB_BLOCK,
+        vk_formats.VK_FORMAT_BC7_UNORM_BLOCK => vk_formats.VK_FORMAT_BC7_SRGB_BLOCK,
+        else => format,
+    };
+}
+
+pub fn is_srgb_format(format: u32) bool {
+    return linear_format(format) != format;
+}
+
+/// Combines a material's requested format with the format of the loaded payload.
+///
+/// Materials request a color space (e.g. UNORM for normal maps) before the payload is known,
+/// while cooked textures arrive block-compressed. The payload decides the layout; the request
+/// only picks the sRGB or UNORM variant of it. Either side may be 0 (unknown).
+pub fn resolve_format(requested: u32, data_format: u32) u32 {
+    if (data_format == 0) return requested;
+    if (requested == 0 or requested == data_format) return data_format;
+    if (format_block_info(requested) == null) return data_format;
+    return if (is_srgb_format(requested)) srgb_format(data_format) else linear_format(data_format);
+}
@@ -2,6 +2,11 @@
 //!
 //! The async loader provides a C-ABI-friendly task API backed by the engine job system.
 //! Tasks can represent built-in operations (textures/scenes/meshes/materials) or custom user jobs.
+//!
+//! Tasks that start by reading a file can have it read by the I/O service (`io_service.zig`)
+//! before their job is queued; the job then decodes from memory and never blocks a worker on the
+//! disk. Scene tasks do this when an in-memory loader is registered, and custom tasks opt in with
+//! `cardinal_async_submit_task_with_read`.
 const std = @import("std");
 const log = @import("log.zig");
 const memory = @import("memory.zig");
@@ -13,6 +18,8 @@ const async_log = log.ScopedLogger("ASYNC");
 const ref_counting = @import("ref_counting.zig");
 const scene = @import("../assets/scene.zig");
 const job_system = @import("job_system.zig");
+const io_service = @import("io_service.zig");
+const profiler = @import("profiler.zig");
 
 pub const Loaders = types.Loaders;
 
@@ -31,6 +38,16 @@ pub export fn cardinal_async_register_ecs_scene_loader(load_fn: *const fn (?[*:0
     Loaders.ecs_scene_load_fn = load_fn;
 }
 
+/// Registers a scene loader that parses file contents read ahead by the I/O service.
+pub export fn cardinal_async_register_scene_memory_loader(load_fn: *const fn (?[*:0]const u8, [*]const u8, usize, ?*scene.CardinalScene) callconv(.c) bool) callconv(.c) void {
+    Loaders.scene_load_memory_fn = load_fn;
+}
+
+/// Registers an ECS scene loader that parses file contents read ahead by the I/O service.
+pub export fn cardinal_async_register_ecs_scene_memory_loader(load_fn: *const fn (?[*:0]const u8, [*]const u8, usize) callconv(.c) ?*anyopaque) callconv(.c) void {
+    Loaders.ecs_scene_load_memory_fn = load_fn;
+}
+
 pub const CardinalAsyncPriority = types.CardinalAsyncPriority;
 pub const CardinalAsyncStatus = types.CardinalAsyncStatus;
 pub const CardinalAsyncTaskType = types.CardinalAsyncTaskType;
@@ -55,6 +72,9 @@ const AsyncLoaderState = struct {
 
     task_pool: std.ArrayListUnmanaged(TaskSlot),
     free_indices: std.ArrayListUnmanaged(u32),
+    /// Jobs of completed reads that did not fit the job queue, in completion order. Retried by
+    /// `cardinal_async_process_completed_tasks` and drained at shutdown.
+    deferred_jobs: std.ArrayListUnmanaged(*job_system.Job),
     allocator: std.mem.Allocator,
 };
 
@@ -68,15 +88,101 @@ fn get_timestamp_ms() u64 {
 fn execute_task_job(data: ?*anyopaque) callconv(.c) i32 {
     if (data) |d| {
         const task = @as(*CardinalAsyncTask, @ptrCast(@alignCast(d)));
-        if (execute_task(task)) {
-            return 0;
-        } else {
-            return -1;
-        }
+        const success = execute_task(task);
+        release_file_data(task);
+        return if (success) 0 else -1;
     }
     return -1;
 }
 
+/// Queues `task`'s job once the I/O service has read `path`, or right away when the service is
+/// not running (the task then reads the file itself).
+fn submit_after_read(task: *CardinalAsyncTask, path: [*:0]const u8) bool {
+    if (io_service.is_running()) {
+        @atomicStore(bool, &task.io_pending, true, .release);
+        if (io_service.submit(std.mem.span(path), on_file_read, task)) return true;
+        @atomicStore(bool, &task.io_pending, false, .release);
+    }
+    const job = @as(*job_system.Job, @ptrCast(task.next));
+    return job_system.submit_job(job);
+}
+
+/// I/O service completion: attaches the contents to the task and queues its job.
+fn on_file_read(request: *io_service.Request) void {
+    const task = @as(*CardinalAsyncTask, @ptrCast(@alignCast(request.user_data.?)));
+
+    g_async_loader.state_mutex.lock();
+    task.io_request = request;
+    const job = @as(*job_system.Job, @ptrCast(task.next));
+    @atomicStore(bool, &task.io_pending, false, .release);
+    const free_pending = task.free_pending;
+    if (free_pending) {
+        // Freed during the read: the job still runs, as a no-op, so its dependents are released.
+        job.data = null;
+        task.next = null;
+    }
+    g_async_loader.state_mutex.unlock();
+
+    if (free_pending) destroy_task(task);
+    submit_or_defer(job);
+}
+
+/// Queues `job` without blocking the I/O completion thread. When the job queue is full the job
+/// waits on `deferred_jobs`; when no worker can run it, it runs here.
+fn submit_or_defer(job: *job_system.Job) void {
+    if (job_system.get_worker_count() == 0) {
+        job_system.run_job_inline(job);
+        return;
+    }
+
+    g_async_loader.state_mutex.lock();
+    // Jobs queued behind deferred ones stay behind them.
+    if (g_async_loader.deferred_jobs.items.len == 0 and job_system.submit_job(job)) {
+        g_async_loader.state_mutex.unlock();
+        return;
+    }
+    g_async_loader.deferred_jobs.append(g_async_loader.allocator, job) catch {
+        g_async_loader.state_mutex.unlock();
+        job_system.run_job_inline(job);
+        return;
+    };
+    g_async_loader.state_mutex.unlock();
+}
+
+/// Moves deferred jobs onto the job queue, in order, while it has room.
+fn flush_deferred_jobs() void {
+    g_async_loader.state_mutex.lock();
+    defer g_async_loader.state_mutex.unlock();
+    const jobs = g_async_loader.deferred_jobs.items;
+    var submitted: usize = 0;
+    while (submitted < jobs.len and job_system.submit_job(jobs[submitted])) submitted += 1;
+    std.mem.copyForwards(*job_system.Job, jobs[0 .. jobs.len - submitted], jobs[submitted..]);
+    g_async_loader.deferred_jobs.shrinkRetainingCapacity(jobs.len - submitted);
+}
+
+fn release_file_data(task: *CardinalAsyncTask) void {
+    if (task.io_request) |request| {
+        io_service.release(@ptrCast(@alignCast(request)));
+        task.io_request = null;
+    }
+}
+
+/// Returns the file contents the I/O service read for `task`, valid while the task runs. Null
+/// when the task was queued without a read or the read failed; loaders then read the file
+/// themselves, which also reports the error.
+pub fn get_file_data(task: *const CardinalAsyncTask) ?[]const u8 {
+    const request = @as(*const io_service.Request, @ptrCast(@alignCast(task.io_request orelse return null)));
+    if (request.err != null) return null;
+    return request.data.bytes;
+}
+
+/// C-ABI form of `get_file_data`; writes the length to `out_size`.
+pub export fn cardinal_async_get_file_data(task: ?*const CardinalAsyncTask, out_size: ?*usize) callconv(.c) ?[*]const u8 {
+    const bytes = get_file_data(task orelse return null) orelse return null;
+    if (out_size) |size| size.* = bytes.len;
+    return bytes.ptr;
+}
+
 fn create_task(task_type: CardinalAsyncTaskType, priority: CardinalAsyncPriority) ?*CardinalAsyncTask {
     const allocator = memory.cardinal_get_allocator_for_category(.ENGINE);
     const ptr = memory.cardinal_alloc(allocator, @sizeOf(CardinalAsyncTask));
@@ -190,7 +296,12 @@ fn execute_scene_load_task(task: *CardinalAsyncTask) bool {
         return false;
     }
 
-    if (!Loaders.scene_load_fn.?(task.file_path.?, scene_obj)) {
+    const read_ahead = if (Loaders.scene_load_memory_fn != null) get_file_data(task) else null;
+    const loaded = if (read_ahead) |bytes|
+        Loaders.scene_load_memory_fn.?(task.file_path.?, bytes.ptr, bytes.len, scene_obj)
+    else
+        Loaders.scene_load_fn.?(task.file_path.?, scene_obj);
+    if (!loaded) {
         memory.cardinal_free(allocator, scene_ptr);
         return false;
     }
@@ -357,7 +468,11 @@ fn execute_ecs_scene_load_task(task: *CardinalAsyncTask) bool {
         return false;
     }
 
-    const result = Loaders.ecs_scene_load_fn.?(task.file_path.?);
+    const read_ahead = if (Loaders.ecs_scene_load_memory_fn != null) get_file_data(task) else null;
+    const result = if (read_ahead) |bytes|
+        Loaders.ecs_scene_load_memory_fn.?(task.file_path.?, bytes.ptr, bytes.len)
+    else
+        Loaders.ecs_scene_load_fn.?(task.file_path.?);
     if (result == null) {
         return false;
     }
@@ -382,6 +497,10 @@ fn mesh_destructor_wrapper(data: ?*anyopaque) callconv(.c) void {
 }
 
 fn execute_task(task: *CardinalAsyncTask) bool {
+    const task_zone = profiler.zone("Loader Task");
+    defer task_zone.end();
+    profiler.count(.loader_tasks, 1);
+
     task.status = .RUNNING;
     var success = false;
 
@@ -427,6 +546,7 @@ pub export fn cardinal_async_loader_init(config: ?*const CardinalAsyncLoaderConf
         .worker_thread_count = g_async_loader.config.worker_thread_count,
         .max_queue_size = g_async_loader.config.max_queue_size,
         .enable_priority_queue = g_async_loader.config.enable_priority_queue,
+        .enable_fibers = g_async_loader.config.enable_fibers,
     };
 
     if (!job_system.init(&job_config)) {
@@ -435,6 +555,10 @@ pub export fn cardinal_async_loader_init(config: ?*const CardinalAsyncLoaderConf
 
     g_async_loader.config.worker_thread_count = job_system.g_job_system.config.worker_thread_count;
 
+    if (!io_service.init(.{})) {
+        async_log.warn("I/O service unavailable, load tasks read files on job workers", .{});
+    }
+
     g_async_loader.state_mutex = .{};
     g_async_loader.next_task_id = 0;
 
@@ -442,6 +566,7 @@ pub export fn cardinal_async_loader_init(config: ?*const CardinalAsyncLoaderConf
     g_async_loader.allocator = allocator.as_allocator();
     g_async_loader.task_pool = .{};
     g_async_loader.free_indices = .{};
+    g_async_loader.deferred_jobs = .{};
 
     g_async_loader.initialized = true;
     std.log.info("Async loader (JobSystem) initialized with {d} worker threads", .{g_async_loader.config.worker_thread_count});
@@ -454,6 +579,12 @@ pub export fn cardinal_async_loader_shutdown() callconv(.c) void {
     std.log.info("Shutting down async loader...", .{});
     g_async_loader.shutting_down = true;
 
+    // Completes outstanding reads, whose tasks still need the job system.
+    io_service.shutdown();
+    // No read completes after this, so the deferred list is ours alone.
+    flush_deferred_jobs();
+    for (g_async_loader.deferred_jobs.items) |job| job_system.run_job_inline(job);
+    g_async_loader.deferred_jobs.deinit(g_async_loader.allocator);
     job_system.shutdown();
 
     g_async_loader.initialized = false;
@@ -540,8 +671,11 @@ pub export fn cardinal_async_load_scene(file_path: ?[*:0]const u8, priority: Car
     task.?.callback = callback;
     task.?.callback_data = user_data;
 
-    const job = @as(*job_system.Job, @ptrCast(task.?.next));
-    if (!job_system.submit_job(job)) {
+    const submitted = if (Loaders.scene_load_memory_fn != null)
+        submit_after_read(task.?, task.?.file_path.?)
+    else
+        job_system.submit_job(@as(*job_system.Job, @ptrCast(task.?.next)));
+    if (!submitted) {
         cardinal_async_free_task(task);
         return null;
     }
@@ -570,8 +704,11 @@ pub export fn cardinal_async_load_ecs_scene(file_path: ?[*:0]const u8, priority:
     task.?.callback = callback;
     task.?.callback_data = user_data;
 
-    const job = @as(*job_system.Job, @ptrCast(task.?.next));
-    if (!job_system.submit_job(job)) {
+    const submitted = if (Loaders.ecs_scene_load_memory_fn != null)
+        submit_after_read(task.?, task.?.file_path.?)
+    else
+        job_system.submit_job(@as(*job_system.Job, @ptrCast(task.?.next)));
+    if (!submitted) {
         cardinal_async_free_task(task);
         return null;
     }
@@ -693,6 +830,14 @@ pub export fn cardinal_async_submit_task(task: ?*CardinalAsyncTask) callconv(.c)
     return job_system.submit_job(job);
 }
 
+/// Submits a task created with `cardinal_async_create_custom_task` once the I/O service has read
+/// `file_path`; the task function gets the contents from `cardinal_async_get_file_data`.
+pub export fn cardinal_async_submit_task_with_read(task: ?*CardinalAsyncTask, file_path: ?[*:0]const u8) callconv(.c) bool {
+    const t = task orelse return false;
+    const path = file_path orelse return cardinal_async_submit_task(t);
+    return submit_after_read(t, path);
+}
+
 pub export fn cardinal_async_submit_custom_task(task_func: CardinalAsyncTaskFunc, custom_data: ?*anyopaque, priority: CardinalAsyncPriority, callback: CardinalAsyncCallback, user_data: ?*anyopaque) callconv(.c) ?*CardinalAsyncTask {
     const task = cardinal_async_create_custom_task(task_func, custom_data, priority, callback, user_data);
     if (task == null) return null;
@@ -762,10 +907,14 @@ extern "kernel32" fn Sleep(dwMilliseconds: u32) callconv(.c) void;
 
 pub export fn cardinal_async_free_task(task: ?*CardinalAsyncTask) callconv(.c) void {
     if (task) |t| {
-        const allocator = memory.cardinal_get_allocator_for_category(.ENGINE);
-
         if (g_async_loader.initialized) {
             g_async_loader.state_mutex.lock();
+            // The I/O service still holds the task; its completion frees it.
+            if (@atomicLoad(bool, &t.io_pending, .acquire)) {
+                t.free_pending = true;
+                g_async_loader.state_mutex.unlock();
+                return;
+            }
             if (t.next) |job_ptr| {
                 const job = @as(*job_system.Job, @ptrCast(job_ptr));
 
@@ -780,34 +929,41 @@ pub export fn cardinal_async_free_task(task: ?*CardinalAsyncTask) callconv(.c) v
             g_async_loader.state_mutex.unlock();
         }
 
-        if (t.result_data) |data| {
-            if (t.type == .SCENE_LOAD) {
-                const scene_ptr = @as(*scene.CardinalScene, @ptrCast(@alignCast(data)));
-                memory.cardinal_free(allocator, scene_ptr);
-            } else if (t.type == .MATERIAL_LOAD) {
-                const mat_ptr = @as(*scene.CardinalMaterial, @ptrCast(@alignCast(data)));
-                memory.cardinal_free(allocator, mat_ptr);
-            }
-        }
+        destroy_task(t);
+    }
+}
 
-        if (t.file_path) |path| {
-            memory.cardinal_free(allocator, path);
-        }
-        if (t.error_message) |msg| {
-            memory.cardinal_free(allocator, msg);
+/// Releases everything `task` owns and recycles its slot. The task must be detached from its job.
+fn destroy_task(t: *CardinalAsyncTask) void {
+    const allocator = memory.cardinal_get_allocator_for_category(.ENGINE);
+    if (t.result_data) |data| {
+        if (t.type == .SCENE_LOAD) {
+            const scene_ptr = @as(*scene.CardinalScene, @ptrCast(@alignCast(data)));
+            memory.cardinal_free(allocator, scene_ptr);
+        } else if (t.type == .MATERIAL_LOAD) {
+            const mat_ptr = @as(*scene.CardinalMaterial, @ptrCast(@alignCast(data)));
+            memory.cardinal_free(allocator, mat_ptr);
         }
+    }
 
-        g_async_loader.state_mutex.lock();
-        if (t.id < g_async_loader.task_pool.items.len) {
-            g_async_loader.task_pool.items[t.id].task = null;
-            g_async_loader.free_indices.append(g_async_loader.allocator, t.id) catch {
-                async_log.err("Failed to recycle task index {d}", .{t.id});
-            };
-        }
-        g_async_loader.state_mutex.unlock();
+    release_file_data(t);
+    if (t.file_path) |path| {
+        memory.cardinal_free(allocator, path);
+    }
+    if (t.error_message) |msg| {
+        memory.cardinal_free(allocator, msg);
+    }
 
-        memory.cardinal_free(allocator, t);
+    g_async_loader.state_mutex.lock();
+    if (t.id < g_async_loader.task_pool.items.len) {
+        g_async_loader.task_pool.items[t.id].task = null;
+        g_async_loader.free_indices.append(g_async_loader.allocator, t.id) catch {
+            async_log.err("Failed to recycle task index {d}", .{t.id});
+        };
     }
+    g_async_loader.state_mutex.unlock();
+
+    memory.cardinal_free(allocator, t);
 }
 
 pub export fn cardinal_async_get_texture_result(task: ?*CardinalAsyncTask, out_texture: ?*anyopaque) callconv(.c) ?*ref_counting.CardinalRefCountedResource {
@@ -895,6 +1051,7 @@ pub export fn cardinal_async_get_worker_thread_count() callconv(.c) u32 {
 
 pub export fn cardinal_async_process_completed_tasks(max_tasks: u32) callconv(.c) u32 {
     if (!g_async_loader.initialized) return 0;
+    flush_deferred_jobs();
 
     var processed: u32 = 0;
 
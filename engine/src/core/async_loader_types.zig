@@ -10,6 +10,10 @@ pub const Loaders = struct {
     pub var texture_load_fn: ?*const fn (file_path: ?[*]const u8, out_texture: ?*anyopaque) callconv(.c) ?*ref_counting.CardinalRefCountedResource = null;
     pub var scene_load_fn: ?*const fn (file_path: ?[*:0]const u8, scene: ?*scene.CardinalScene) callconv(.c) bool = null;
     pub var ecs_scene_load_fn: ?*const fn (file_path: ?[*:0]const u8) callconv(.c) ?*anyopaque = null;
+    /// Variants taking the file contents read ahead by the I/O service. When registered, scene
+    /// tasks read their file before they are queued, so the job only parses.
+    pub var scene_load_memory_fn: ?*const fn (file_path: ?[*:0]const u8, data: [*]const u8, size: usize, scene: ?*scene.CardinalScene) callconv(.c) bool = null;
+    pub var ecs_scene_load_memory_fn: ?*const fn (file_path: ?[*:0]const u8, data: [*]const u8, size: usize) callconv(.c) ?*anyopaque = null;
 };
 
 /// Scheduling priority for async tasks.
@@ -45,6 +49,8 @@ pub const CardinalAsyncLoaderConfig = extern struct {
     worker_thread_count: u32,
     max_queue_size: u32,
     enable_priority_queue: bool,
+    /// Run loader jobs on fibers; see `JobSystemConfig.enable_fibers`.
+    enable_fibers: bool = false,
 };
 
 /// Task execution callback used for CUSTOM tasks.
@@ -74,4 +80,11 @@ pub const CardinalAsyncTask = extern struct {
     /// Stores a pointer to the underlying job (type-punned).
     next: ?*CardinalAsyncTask,
     submit_time: u64,
+
+    /// File contents read ahead for the task (an `io_service.Request`), released after it runs.
+    io_request: ?*anyopaque,
+    /// Set while the task's file is being read; the job has not been queued yet.
+    io_pending: bool,
+    /// Set when the task was freed during its read; the read completion frees it instead.
+    free_pending: bool,
 };
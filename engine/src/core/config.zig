@@ -29,8 +29,17 @@ pub const CardinalEngineConfig = struct {
     async_worker_threads: u32 = 2,
     /// Max number of queued async tasks.
     async_queue_size: u32 = 100,
+    /// Run jobs on fibers so that jobs waiting on other jobs suspend instead of blocking a worker.
+    job_fibers: bool = false,
     /// Max entries for internal caches (textures/meshes).
     cache_size: u32 = 1000,
+    /// Cook LDR source textures into mipmapped BC7 on first load and reuse them from
+    /// `<assets_path>/.cache/textures`.
+    cook_textures: bool = true,
+    /// Overlap ECS simulation of the next frame with rendering of the previous one in
+    /// `CardinalEngine.update_and_render`. Adds one frame of latency; needs two or more
+    /// `async_worker_threads`, or `job_fibers`.
+    pipelined_frames: bool = false,
 
     /// Default assets directory path.
     assets_path: []const u8 = "assets",
@@ -171,6 +180,7 @@ pub const ConfigManager = struct {
             shadow_split_lambda: ?f32 = null,
             shadow_near_clip: ?f32 = null,
             shadow_far_clip: ?f32 = null,
+            shadow_cached_cascades: ?u32 = null,
             prefer_hdr: ?bool = null,
             present_mode: ?c.VkPresentModeKHR = null,
             max_lights: ?u32 = null,
@@ -193,7 +203,10 @@ pub const ConfigManager = struct {
             ref_counting_buckets: ?u32 = null,
             async_worker_threads: ?u32 = null,
             async_queue_size: ?u32 = null,
+            job_fibers: ?bool = null,
             cache_size: ?u32 = null,
+            cook_textures: ?bool = null,
+            pipelined_frames: ?bool = null,
             assets_path: ?[]const u8 = null,
             recent_projects: ?[]const []const u8 = null,
             renderer: ?ParsedRendererConfig = null,
@@ -215,7 +228,10 @@ pub const ConfigManager = struct {
         if (parsed.value.ref_counting_buckets) |val| self.config.ref_counting_buckets = val;
         if (parsed.value.async_worker_threads) |val| self.config.async_worker_threads = val;
         if (parsed.value.async_queue_size) |val| self.config.async_queue_size = val;
+        if (parsed.value.job_fibers) |val| self.config.job_fibers = val;
         if (parsed.value.cache_size) |val| self.config.cache_size = val;
+        if (parsed.value.cook_textures) |val| self.config.cook_textures = val;
+        if (parsed.value.pipelined_frames) |val| self.config.pipelined_frames = val;
         if (parsed.value.assets_path) |val| {
             if (self.assets_path_owned) self.allocator.free(self.config.assets_path);
             self.config.assets_path = try self.allocator.dupe(u8, val);
@@ -256,6 +272,7 @@ pub const ConfigManager = struct {
             if (r.shadow_split_lambda) |v| self.config.renderer.shadow_split_lambda = v;
             if (r.shadow_near_clip) |v| self.config.renderer.shadow_near_clip = v;
             if (r.shadow_far_clip) |v| self.config.renderer.shadow_far_clip = v;
+            if (r.shadow_cached_cascades) |v| self.config.renderer.shadow_cached_cascades = v;
             if (r.prefer_hdr) |v| self.config.renderer.prefer_hdr = v;
             if (r.present_mode) |v| self.config.renderer.present_mode = v;
             if (r.max_lights) |v| self.config.renderer.max_lights = v;
@@ -300,6 +317,7 @@ pub const ConfigManager = struct {
         shadow_split_lambda: f32,
         shadow_near_clip: f32,
         shadow_far_clip: f32,
+        shadow_cached_cascades: u32,
         prefer_hdr: bool,
         present_mode: c.VkPresentModeKHR,
         max_lights: u32,
@@ -323,6 +341,7 @@ pub const ConfigManager = struct {
                 .shadow_split_lambda = cfg.shadow_split_lambda,
                 .shadow_near_clip = cfg.shadow_near_clip,
                 .shadow_far_clip = cfg.shadow_far_clip,
+                .shadow_cached_cascades = cfg.shadow_cached_cascades,
                 .prefer_hdr = cfg.prefer_hdr,
                 .present_mode = cfg.present_mode,
                 .max_lights = cfg.max_lights,
@@ -347,7 +366,10 @@ pub const ConfigManager = struct {
         ref_counting_buckets: u32,
         async_worker_threads: u32,
         async_queue_size: u32,
+        job_fibers: bool,
         cache_size: u32,
+        cook_textures: bool,
+        pipelined_frames: bool,
         assets_path: []const u8,
         recent_projects: []const [:0]u8,
         renderer: SerializableRendererConfig,
@@ -363,7 +385,10 @@ pub const ConfigManager = struct {
                 .ref_counting_buckets = cfg.ref_counting_buckets,
                 .async_worker_threads = cfg.async_worker_threads,
                 .async_queue_size = cfg.async_queue_size,
+                .job_fibers = cfg.job_fibers,
                 .cache_size = cfg.cache_size,
+                .cook_textures = cfg.cook_textures,
+                .pipelined_frames = cfg.pipelined_frames,
                 .assets_path = cfg.assets_path,
                 .recent_projects = cfg.recent_projects,
                 .renderer = SerializableRendererConfig.from(cfg.renderer),
@@ -17,10 +17,16 @@ const platform = @import("platform.zig");
 const events = @import("events.zig");
 const input = @import("input.zig");
 const stack_allocator = @import("stack_allocator.zig");
+const vfs = @import("vfs.zig");
+const frame_pipeline = @import("frame_pipeline.zig");
 const texture_loader = @import("../assets/texture_loader.zig");
+const texture_cooker = @import("../assets/texture_cooker.zig");
+const ibl_cooker = @import("../assets/ibl_cooker.zig");
 const loader_mod = @import("../assets/loader.zig");
 const mesh_loader = @import("../assets/mesh_loader.zig");
+const asset_database = @import("../assets/asset_database.zig");
 const vulkan_renderer = @import("../renderer/vulkan_renderer.zig");
+const vulkan_renderer_frame = @import("../renderer/vulkan_renderer_frame.zig");
 const vulkan_types = @import("../renderer/vulkan_types.zig");
 const ecs_registry = @import("../ecs/registry.zig");
 const ecs_systems = @import("../ecs/systems.zig");
@@ -40,6 +46,8 @@ pub const CardinalEngine = struct {
     config_manager: config_pkg.ConfigManager,
     registry: ecs_registry.Registry,
     scheduler: ecs_scheduler.Scheduler,
+    /// Simulate/extract/render driver behind `update` and `update_and_render`.
+    frame_pipeline: frame_pipeline.FramePipeline,
 
     frame_allocator: stack_allocator.StackAllocator = undefined,
     frame_memory: []u8 = undefined,
@@ -75,6 +83,7 @@ pub const CardinalEngine = struct {
         self.config = config_manager.config;
         self.registry = ecs_registry.Registry.init(allocator);
         self.scheduler = ecs_scheduler.Scheduler.init(allocator, &self.registry);
+        self.frame_pipeline = frame_pipeline.FramePipeline.init(allocator, &self.registry, if (self.config.pipelined_frames) .pipelined else .serial);
         self.last_frame_time = platform.get_time_ns();
         self.memory_initialized = false;
         self.ref_counting_initialized = false;
@@ -101,6 +110,7 @@ pub const CardinalEngine = struct {
     /// Shuts down subsystems in a dependency-safe order.
     pub fn deinit(self: *CardinalEngine) void {
         self.scheduler.deinit();
+        self.frame_pipeline.deinit();
 
         if (self.async_loader_initialized) {
             async_loader.cardinal_async_loader_shutdown();
@@ -113,6 +123,11 @@ pub const CardinalEngine = struct {
             self.caches_initialized = false;
         }
 
+        asset_database.closeShared();
+        texture_cooker.shutdown();
+        ibl_cooker.shutdown();
+        vfs.unmount_all();
+
         self.module_manager.shutdown();
         self.module_manager.deinit();
 
@@ -150,27 +165,73 @@ pub const CardinalEngine = struct {
     }
 
     /// Runs a single frame: polling, ECS, modules, and per-frame allocator reset.
+    ///
+    /// ECS systems run through the frame pipeline without a render stage, so no snapshot is
+    /// extracted. Use this when the caller renders by reading the registry itself (the editor).
     pub fn update(self: *CardinalEngine) !void {
         const zone = tracy.zoneS(@src(), "Engine Update");
         defer zone.end();
 
+        const delta_time = self.begin_frame();
+
+        try self.frame_pipeline.run_frame(delta_time, .{ .ctx = self, .func = simulate_stage }, null);
+        self.sync_skybox_from_ecs();
+
+        try self.module_manager.update(delta_time);
+    }
+
+    /// Runs a single frame and renders it from a render snapshot.
+    ///
+    /// ECS systems and snapshot extraction run as one job while `render` records the previous
+    /// frame's snapshot when `pipelined_frames` is set, or inline before `render` otherwise.
+    /// `render` must only read the snapshot, never the registry; null renders it with the
+    /// engine's Vulkan renderer. Skybox sync and module updates run after the frame, as in `update`.
+    pub fn update_and_render(self: *CardinalEngine, render: ?frame_pipeline.RenderStage) !void {
+        const zone = tracy.zoneS(@src(), "Engine Update And Render");
+        defer zone.end();
+
+        const delta_time = self.begin_frame();
+
+        const stage = render orelse frame_pipeline.RenderStage{ .ctx = self, .func = render_stage };
+        try self.frame_pipeline.run_frame(delta_time, .{ .ctx = self, .func = simulate_stage }, stage);
+        self.sync_skybox_from_ecs();
+
+        try self.module_manager.update(delta_time);
+    }
+
+    /// Timings of the last frame.
+    pub fn frame_stats(self: *const CardinalEngine) frame_pipeline.FrameStats {
+        return self.frame_pipeline.stats;
+    }
+
+    fn simulate_stage(ctx: ?*anyopaque, delta_time: f32) anyerror!void {
+        const self = @as(*CardinalEngine, @ptrCast(@alignCast(ctx)));
+        try self.scheduler.run(delta_time);
+    }
+
+    /// Default render stage: applies the snapshot's camera, lights and transforms, then draws.
+    fn render_stage(ctx: ?*anyopaque, snapshot: *const frame_pipeline.RenderSnapshot) void {
+        const self = @as(*CardinalEngine, @ptrCast(@alignCast(ctx)));
+        if (!self.renderer_initialized) return;
+        vulkan_renderer.cardinal_renderer_apply_snapshot(&self.renderer, snapshot);
+        vulkan_renderer_frame.cardinal_renderer_draw_frame(&self.renderer);
+    }
+
+    /// Computes the frame delta, resets per-frame allocators, and pumps window input.
+    fn begin_frame(self: *CardinalEngine) f32 {
         const current_time = platform.get_time_ns();
         const dt_ns = current_time - self.last_frame_time;
         self.last_frame_time = current_time;
 
-        const delta_time = @as(f32, @floatFromInt(dt_ns)) / 1_000_000_000.0;
-
         self.frame_allocator.reset();
+        memory.cardinal_memory_begin_frame();
 
         if (self.window) |win| {
             window.cardinal_window_poll(win);
             input.update(win);
         }
 
-        try self.scheduler.run(delta_time);
-        self.sync_skybox_from_ecs();
-
-        try self.module_manager.update(delta_time);
+        return @as(f32, @floatFromInt(dt_ns)) / 1_000_000_000.0;
     }
 
     fn sync_skybox_from_ecs(self: *CardinalEngine) void {
@@ -216,6 +277,13 @@ pub const CardinalEngine = struct {
         self.frame_allocator = stack_allocator.StackAllocator.init(self.frame_memory);
         eng_log.info("Frame allocator initialized with {d}MB", .{frame_mem_size / 1024 / 1024});
 
+        // Shipping builds keep assets in packs under `paks/`; development builds read loose files.
+        const pack_count = vfs.mount_pack_directory(self.allocator, "paks", self.config.assets_path) catch |err| blk: {
+            eng_log.warn("Failed to mount asset packs: {}", .{err});
+            break :blk 0;
+        };
+        if (pack_count > 0) eng_log.info("Mounted {d} asset pack(s) at '{s}'", .{ pack_count, self.config.assets_path });
+
         try self.module_manager.register(.{
             .name = "Events",
             .init_fn = initEvents,
@@ -253,6 +321,7 @@ pub const CardinalEngine = struct {
             .worker_thread_count = self.config.async_worker_threads,
             .max_queue_size = self.config.async_queue_size,
             .enable_priority_queue = true,
+            .enable_fibers = self.config.job_fibers,
         };
 
         eng_log.info("About to call cardinal_async_loader_init...", .{});
@@ -264,6 +333,7 @@ pub const CardinalEngine = struct {
         const texture_load_fn: *const fn (?[*]const u8, ?*anyopaque) callconv(.c) ?*ref_counting.CardinalRefCountedResource = @ptrCast(&texture_loader.texture_load_with_ref_counting);
         async_loader.cardinal_async_register_texture_loader(texture_load_fn);
         async_loader.cardinal_async_register_scene_loader(loader_mod.cardinal_scene_load);
+        async_loader.cardinal_async_register_scene_memory_loader(loader_mod.cardinal_scene_load_from_memory);
 
         self.async_loader_initialized = true;
         eng_log.info("Async loader system initialized successfully", .{});
@@ -272,6 +342,21 @@ pub const CardinalEngine = struct {
         _ = mesh_loader.mesh_cache_initialize(self.config.cache_size);
         self.caches_initialized = true;
 
+        if (self.config.cook_textures) {
+            const cook_dir = try std.fs.path.join(self.allocator, &[_][]const u8{ self.config.assets_path, ".cache", "textures" });
+            defer self.allocator.free(cook_dir);
+            texture_cooker.configure(self.allocator, cook_dir) catch |err| {
+                eng_log.warn("Texture cooking disabled, cache '{s}' unavailable: {s}", .{ cook_dir, @errorName(err) });
+            };
+        }
+
+        // Baked by `zig build bake-ibl`; only read here.
+        const ibl_dir = try std.fs.path.join(self.allocator, &[_][]const u8{ self.config.assets_path, ".cache", "ibl" });
+        defer self.allocator.free(ibl_dir);
+        ibl_cooker.configure(self.allocator, ibl_dir) catch |err| {
+            eng_log.warn("Skybox IBL disabled, cache '{s}' unavailable: {s}", .{ ibl_dir, @errorName(err) });
+        };
+
         eng_log.info("Multi-threaded asset caches initialized successfully", .{});
     }
 
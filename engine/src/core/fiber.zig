@@ -0,0 +1,276 @@
+//! Stackful fibers for the job system.
+//!
+//! A fiber is a stack plus a saved register context. `switch_to` saves the callee-saved
+//! registers of the running context and restores another, so a job can park itself mid-call
+//! and be resumed later on any thread. On x86_64 and aarch64 ELF targets the switch is a few
+//! lines of assembly; Windows uses the kernel32 fiber API. Elsewhere `supported` is false and
+//! the job system keeps running jobs directly on its worker stacks.
+const std = @import("std");
+const builtin = @import("builtin");
+
+const is_windows = builtin.os.tag == .windows;
+
+const AsmTarget = enum { none, x86_64, aarch64 };
+
+const asm_target: AsmTarget = if (is_windows or builtin.object_format != .elf)
+    .none
+else switch (builtin.cpu.arch) {
+    .x86_64 => .x86_64,
+    .aarch64 => .aarch64,
+    else => .none,
+};
+
+/// True when fibers can be created on this target.
+pub const supported = is_windows or asm_target != .none;
+
+/// Fiber entrypoint. It must never return; a finished fiber switches away instead.
+pub const EntryFn = *const fn (arg: *anyopaque) callconv(.c) noreturn;
+
+/// Saved execution state of a suspended fiber or thread.
+pub const Context = if (is_windows) struct {
+    handle: ?*anyopaque = null,
+} else struct {
+    sp: usize = 0,
+};
+
+// cardinal_fiber_switch(from_sp: *usize, to_sp: usize) pushes the callee-saved registers, stores
+// the stack pointer in `from_sp`, loads `to_sp` and pops the registers saved there.
+// cardinal_fiber_start is where a new fiber's first switch returns to: it calls the entry and
+// argument that `init` placed in callee-saved registers.
+comptime {
+    switch (asm_target) {
+        .x86_64 => asm (
+                \\.text
+                \\.p2align 4
+                \\.globl cardinal_fiber_switch
+                \\.hidden cardinal_fiber_switch
+                \\.type cardinal_fiber_switch, @function
+                \\cardinal_fiber_switch:
+                \\  pushq %rbp
+                \\  pushq %rbx
+                \\  pushq %r12
+                \\  pushq %r13
+                \\  pushq %r14
+                \\  pushq %r15
+                \\  subq $8, %rsp
+                \\  stmxcsr (%rsp)
+                \\  fnstcw 4(%rsp)
+                \\  movq %rsp, (%rdi)
+                \\  movq %rsi, %rsp
+                \\  ldmxcsr (%rsp)
+                \\  fldcw 4(%rsp)
+                \\  addq $8, %rsp
+                \\  popq %r15
+                \\  popq %r14
+                \\  popq %r13
+                \\  popq %r12
+                \\  popq %rbx
+                \\  popq %rbp
+                \\  retq
+                \\
+                \\.p2align 4
+                \\.globl cardinal_fiber_start
+                \\.hidden cardinal_fiber_start
+                \\.type cardinal_fiber_start, @function
+                \\cardinal_fiber_start:
+                \\  movq %r12, %rdi
+                \\  callq *%r13
+                \\  ud2
+            ),
+        .aarch64 => asm (
+                \\.text
+                \\.p2align 4
+                \\.globl cardinal_fiber_switch
+                \\.hidden cardinal_fiber_switch
+                \\.type cardinal_fiber_switch, %function
+                \\cardinal_fiber_switch:
+                \\  sub sp, sp, #176
+                \\  stp x19, x20, [sp, #0]
+                \\  stp x21, x22, [sp, #16]
+                \\  stp x23, x24, [sp, #32]
+                \\  stp x25, x26, [sp, #48]
+                \\  stp x27, x28, [sp, #64]
+                \\  stp x29, x30, [sp, #80]
+                \\  stp d8, d9, [sp, #96]
+                \\  stp d10, d11, [sp, #112]
+                \\  stp d12, d13, [sp, #128]
+                \\  stp d14, d15, [sp, #144]
+                \\  mov x9, sp
+                \\  str x9, [x0]
+                \\  mov sp, x1
+                \\  ldp x19, x20, [sp, #0]
+                \\  ldp x21, x22, [sp, #16]
+                \\  ldp x23, x24, [sp, #32]
+                \\  ldp x25, x26, [sp, #48]
+                \\  ldp x27, x28, [sp, #64]
+                \\  ldp x29, x30, [sp, #80]
+                \\  ldp d8, d9, [sp, #96]
+                \\  ldp d10, d11, [sp, #112]
+                \\  ldp d12, d13, [sp, #128]
+                \\  ldp d14, d15, [sp, #144]
+                \\  add sp, sp, #176
+                \\  ret
+                \\
+                \\.p2align 4
+                \\.globl cardinal_fiber_start
+                \\.hidden cardinal_fiber_start
+                \\.type cardinal_fiber_start, %function
+                \\cardinal_fiber_start:
+                \\  mov x0, x19
+                \\  blr x20
+                \\  brk #0
+            ),
+        .none => {},
+    }
+}
+
+extern fn cardinal_fiber_switch(from_sp: *usize, to_sp: usize) callconv(.c) void;
+extern fn cardinal_fiber_start() callconv(.c) void;
+
+extern "kernel32" fn ConvertThreadToFiber(lpParameter: ?*anyopaque) callconv(.c) ?*anyopaque;
+extern "kernel32" fn ConvertFiberToThread() callconv(.c) c_int;
+extern "kernel32" fn CreateFiber(dwStackSize: usize, lpStartAddress: *const fn (?*anyopaque) callconv(.c) void, lpParameter: ?*anyopaque) callconv(.c) ?*anyopaque;
+extern "kernel32" fn DeleteFiber(lpFiber: ?*anyopaque) callconv(.c) void;
+extern "kernel32" fn SwitchToFiber(lpFiber: ?*anyopaque) callconv(.c) void;
+
+/// A fiber with its own stack. Must not move after `init`.
+pub const Fiber = struct {
+    context: Context = .{},
+    /// Mapped stack including the guard page at its low end (non-Windows).
+    stack: ?[]align(std.heap.page_size_min) u8 = null,
+    entry: ?EntryFn = null,
+    arg: ?*anyopaque = null,
+
+    /// Creates the stack and prepares the context so that the first `switch_to` into it calls
+    /// `entry(arg)`.
+    pub fn init(self: *Fiber, stack_size: usize, entry: EntryFn, arg: *anyopaque) !void {
+        if (!supported) return error.Unsupported;
+        self.* = .{ .entry = entry, .arg = arg };
+
+        if (is_windows) {
+            self.context.handle = CreateFiber(stack_size, windows_start, self) orelse return error.FiberCreateFailed;
+        } else {
+            try self.init_stack(stack_size, entry, arg);
+        }
+    }
+
+    fn init_stack(self: *Fiber, stack_size: usize, entry: EntryFn, arg: *anyopaque) !void {
+        const page = std.heap.pageSize();
+        const usable = std.mem.alignForward(usize, @max(stack_size, 4 * page), page);
+        const stack = try std.posix.mmap(
+            null,
+            usable + page,
+            std.posix.PROT.READ | std.posix.PROT.WRITE,
+            .{ .TYPE = .PRIVATE, .ANONYMOUS = true },
+            -1,
+            0,
+        );
+        errdefer std.posix.munmap(stack);
+        // An overflow faults on the guard page instead of corrupting whatever is mapped below.
+        try std.posix.mprotect(stack[0..page], std.posix.PROT.NONE);
+        self.stack = stack;
+
+        const top = std.mem.alignBackward(usize, @intFromPtr(stack.ptr) + stack.len, 16);
+        switch (asm_target) {
+            .x86_64 => {
+                // Popped by cardinal_fiber_switch: MXCSR and x87 control word, r15, r14, r13, r12,
+                // rbx, rbp, then the return address. The start stub runs with rsp 16-byte aligned.
+                const frame: [*]usize = @ptrFromInt(top - 80);
+                frame[0] = 0x1F80 | (@as(usize, 0x037F) << 32);
+                frame[1] = 0;
+                frame[2] = 0;
+                frame[3] = @intFromPtr(entry);
+                frame[4] = @intFromPtr(arg);
+                frame[5] = 0;
+                frame[6] = 0;
+                frame[7] = @intFromPtr(&cardinal_fiber_start);
+                self.context.sp = top - 80;
+            },
+            .aarch64 => {
+                // x19..x28, x29, x30 (the return address), d8..d15, padding.
+                const frame: [*]usize = @ptrFromInt(top - 176);
+                @memset(frame[0..22], 0);
+                frame[0] = @intFromPtr(arg);
+                frame[1] = @intFromPtr(entry);
+                frame[11] = @intFromPtr(&cardinal_fiber_start);
+                self.context.sp = top - 176;
+            },
+            .none => unreachable,
+        }
+    }
+
+    pub fn deinit(self: *Fiber) void {
+        if (is_windows) {
+            if (self.context.handle) |handle| DeleteFiber(handle);
+        } else if (self.stack) |stack| {
+            std.posix.munmap(stack);
+        }
+        self.* = .{};
+    }
+
+    fn windows_start(param: ?*anyopaque) callconv(.c) void {
+        const self: *Fiber = @ptrCast(@alignCast(param.?));
+        self.entry.?(self.arg.?);
+    }
+};
+
+/// Prepares the calling thread to switch to fibers; `context` becomes the thread's own context
+/// to switch back to. Pair with `leave_thread`.
+pub fn enter_thread(context: *Context) bool {
+    if (!supported) return false;
+    if (is_windows) {
+        context.handle = ConvertThreadToFiber(null);
+        return context.handle != null;
+    }
+    context.* = .{};
+    return true;
+}
+
+pub fn leave_thread(context: *Context) void {
+    if (is_windows and context.handle != null) _ = ConvertFiberToThread();
+    context.* = .{};
+}
+
+/// Suspends the running context into `from` and resumes `to`. Returns when something switches
+/// back to `from`, possibly on another thread.
+pub fn switch_to(from: *Context, to: *const Context) void {
+    if (is_windows) {
+        SwitchToFiber(to.handle);
+    } else if (asm_target != .none) {
+        cardinal_fiber_switch(&from.sp, to.sp);
+    } else {
+        unreachable;
+    }
+}
+
+const TestPingPong = struct {
+    main: Context = .{},
+    fiber: Fiber = .{},
+    steps: [4]u32 = undefined,
+    len: usize = 0,
+
+    fn entry(arg: *anyopaque) callconv(.c) noreturn {
+        const self: *TestPingPong = @ptrCast(@alignCast(arg));
+        var local: u32 = 10;
+        while (true) {
+            self.steps[self.len] = local;
+            self.len += 1;
+            local += 1;
+            switch_to(&self.fiber.context, &self.main);
+        }
+    }
+};
+
+test "fiber switches keep the fiber's stack between resumes" {
+    if (!supported) return error.SkipZigTest;
+
+    var state = TestPingPong{};
+    try std.testing.expect(enter_thread(&state.main));
+    defer leave_thread(&state.main);
+    try state.fiber.init(64 * 1024, TestPingPong.entry, &state);
+    defer state.fiber.deinit();
+
+    for (0..3) |_| switch_to(&state.main, &state.fiber.context);
+    try std.testing.expectEqual(@as(usize, 3), state.len);
+    try std.testing.expectEqualSlices(u32, &.{ 10, 11, 12 }, state.steps[0..3]);
+}
@@ -0,0 +1,340 @@
+//! Pipelined frame execution.
+//!
+//! A frame is split into three stages: simulate (ECS systems mutate the registry), extract
+//! (render-relevant state is copied into a `RenderSnapshot`), and render (the renderer records
+//! a snapshot). Snapshots are double-buffered: in pipelined mode simulation and extraction of
+//! frame N+1 run on the job system while the calling thread renders the snapshot of frame N, so
+//! a frame costs roughly `max(simulate + extract, render)` instead of their sum, at the price of
+//! one frame of extra latency. Serial mode runs the stages back to back and renders the frame
+//! it just simulated.
+//!
+//! `run_frame` always joins the simulation job before returning, so the registry is safe to
+//! touch from the calling thread between frames. The render stage must only read the snapshot it
+//! is handed; the registry is being written concurrently while it runs. Without a render stage
+//! the frame only simulates: extraction is skipped and the snapshots are left as they were.
+const std = @import("std");
+const job_system = @import("job_system.zig");
+const platform = @import("platform.zig");
+const tracy = @import("tracy.zig");
+const math = @import("math.zig");
+const memory = @import("memory.zig");
+const registry_pkg = @import("../ecs/registry.zig");
+const components = @import("../ecs/components.zig");
+const pbr = @import("../renderer/vulkan_types_pbr.zig");
+const render_snapshot = @import("../ecs/render_snapshot.zig");
+
+pub const RenderSnapshot = render_snapshot.RenderSnapshot;
+
+pub const Mode = enum {
+    /// Simulate, extract and render one after another on the calling thread.
+    serial,
+    /// Overlap simulation of the next frame with rendering of the previous snapshot.
+    pipelined,
+};
+
+/// Simulation stage callback; runs on a job worker in pipelined mode.
+pub const SimulateStage = struct {
+    ctx: ?*anyopaque = null,
+    func: *const fn (ctx: ?*anyopaque, delta_time: f32) anyerror!void,
+};
+
+/// Render stage callback; always runs on the thread calling `run_frame`.
+pub const RenderStage = struct {
+    ctx: ?*anyopaque = null,
+    func: *const fn (ctx: ?*anyopaque, snapshot: *const RenderSnapshot) void,
+};
+
+/// Timings of the most recent frame, in nanoseconds.
+pub const FrameStats = struct {
+    simulate_ns: u64 = 0,
+    extract_ns: u64 = 0,
+    render_ns: u64 = 0,
+    /// Wall time of `run_frame`.
+    frame_ns: u64 = 0,
+    /// Time from the start of simulating the rendered snapshot to the end of its render stage.
+    latency_ns: u64 = 0,
+    /// Frame index of the snapshot handed to the render stage (0 when nothing was rendered).
+    rendered_frame: u64 = 0,
+    /// True when simulation ran on the job system concurrently with rendering.
+    overlapped: bool = false,
+};
+
+/// Drives simulate/extract/render for one registry with double-buffered snapshots.
+pub const FramePipeline = struct {
+    allocator: std.mem.Allocator,
+    registry: *registry_pkg.Registry,
+    mode: Mode,
+
+    snapshots: [2]RenderSnapshot = .{ .{}, .{} },
+    /// Index of the snapshot the render stage reads; the other one receives the next extraction.
+    front: u1 = 0,
+    frame_index: u64 = 0,
+    stats: FrameStats = .{},
+
+    /// State handed to the simulation job; lives here so it outlives the job.
+    sim: SimulationJob = undefined,
+
+    const SimulationJob = struct {
+        pipeline: *FramePipeline,
+        stage: SimulateStage,
+        delta_time: f32,
+        /// False when no render stage consumes the snapshot this frame.
+        extract: bool,
+        result: anyerror!void,
+    };
+
+    pub fn init(allocator: std.mem.Allocator, registry: *registry_pkg.Registry, mode: Mode) FramePipeline {
+        return .{
+            .allocator = allocator,
+            .registry = registry,
+            .mode = mode,
+        };
+    }
+
+    pub fn deinit(self: *FramePipeline) void {
+        for (&self.snapshots) |*s| s.deinit(self.allocator);
+    }
+
+    /// Snapshot the next render stage will read (the most recently completed extraction).
+    pub fn front_snapshot(self: *const FramePipeline) *const RenderSnapshot {
+        return &self.snapshots[self.front];
+    }
+
+    /// True when this frame can overlap simulation with rendering.
+    ///
+    /// The simulation job runs `Scheduler.run`, which blocks its worker while the systems execute
+    /// on the others, so at least two workers are required unless jobs run on fibers, where the
+    /// wait suspends the simulation job instead.
+    pub fn can_overlap(self: *const FramePipeline) bool {
+        if (self.mode != .pipelined) return false;
+        return job_system.get_worker_count() >= 2 or job_system.fibers_enabled();
+    }
+
+    /// Runs one frame. See the module docs for how the stages are ordered in each mode.
+    pub fn run_frame(self: *FramePipeline, delta_time: f32, simulate: SimulateStage, render_stage: ?RenderStage) !void {
+        const zone = tracy.zoneS(@src(), "Frame Pipeline");
+        defer zone.end();
+
+        const frame_start = platform.get_time_ns();
+        self.stats = .{};
+        self.frame_index += 1;
+
+        self.sim = .{ .pipeline = self, .stage = simulate, .delta_time = delta_time, .extract = render_stage != null, .result = {} };
+
+        // Nothing to overlap with: simulate inline and keep the last extracted snapshot.
+        const render = render_stage orelse {
+            run_simulation(&self.sim);
+            self.stats.frame_ns = platform.get_time_ns() - frame_start;
+            return self.sim.result;
+        };
+
+        const job = if (self.can_overlap()) job_system.create_job(simulation_job, &self.sim, .HIGH) else null;
+        if (job) |j| {
+            j.push_to_completed_queue = false;
+            while (!job_system.submit_job(j)) {
+                std.Thread.yield() catch {};
+            }
+            self.stats.overlapped = true;
+
+            // The first pipelined frame has nothing extracted yet.
+            if (self.snapshots[self.front].frame_index != 0) self.render_front(render);
+
+            job_system.wait_for_jobs(&.{j});
+            job_system.free_job(j);
+            try self.sim.result;
+            self.front ^= 1;
+        } else {
+            run_simulation(&self.sim);
+            try self.sim.result;
+            self.front ^= 1;
+            self.render_front(render);
+        }
+
+        self.stats.frame_ns = platform.get_time_ns() - frame_start;
+    }
+
+    fn render_front(self: *FramePipeline, render: RenderStage) void {
+        const snapshot = &self.snapshots[self.front];
+        const start = platform.get_time_ns();
+        render.func(render.ctx, snapshot);
+        const end = platform.get_time_ns();
+        self.stats.render_ns = end - start;
+        self.stats.rendered_frame = snapshot.frame_index;
+        self.stats.latency_ns = end -| snapshot.simulate_start_ns;
+    }
+
+    fn simulation_job(data: ?*anyopaque) callconv(.c) i32 {
+        const sim: *SimulationJob = @ptrCast(@alignCast(data));
+        run_simulation(sim);
+        return 0;
+    }
+
+    /// Simulates into the back snapshot. Errors are stored and rethrown by `run_frame`.
+    fn run_simulation(sim: *SimulationJob) void {
+        const self = sim.pipeline;
+        const back = &self.snapshots[self.front ^ 1];
+
+        const start = platform.get_time_ns();
+        sim.stage.func(sim.stage.ctx, sim.delta_time) catch |err| {
+            sim.result = err;
+            return;
+        };
+        const simulated = platform.get_time_ns();
+        self.stats.simulate_ns = simulated - start;
+        if (!sim.extract) return;
+
+        render_snapshot.extract(self.allocator, back, self.registry) catch |err| {
+            back.clear();
+            sim.result = err;
+            return;
+        };
+        back.frame_index = self.frame_index;
+        back.delta_time = sim.delta_time;
+        back.simulate_start_ns = start;
+
+        self.stats.extract_ns = platform.get_time_ns() - simulated;
+    }
+};
+
+/// Render backend that records snapshots on the CPU only.
+///
+/// Stands in for the Vulkan renderer when measuring or testing the frame pipeline without a GPU:
+/// it frustum-culls every instance's bounds against the snapshot camera and packs the lights,
+/// which is the per-draw CPU work a real backend performs before recording commands.
+pub const HeadlessRenderer = struct {
+    /// Object-space bounds assumed for every mesh instance.
+    local_bounds: math.AABB = .{
+        .min = .{ .x = -0.5, .y = -0.5, .z = -0.5 },
+        .max = .{ .x = 0.5, .y = 0.5, .z = 0.5 },
+    },
+    frames_rendered: u64 = 0,
+    last_frame_index: u64 = 0,
+    visible_count: u32 = 0,
+    light_count: u32 = 0,
+
+    pub fn stage(self: *HeadlessRenderer) RenderStage {
+        return .{ .ctx = self, .func = render };
+    }
+
+    fn render(ctx: ?*anyopaque, snapshot: *const RenderSnapshot) void {
+        const self: *HeadlessRenderer = @ptrCast(@alignCast(ctx));
+
+        var visible: u32 = 0;
+        if (snapshot.camera) |cam| {
+            const frustum = math.Frustum.fromMatrix(cam.view_projection);
+            for (snapshot.meshes.items) |inst| {
+                if (math.aabbIntersectsFrustum(self.local_bounds.transformFast(inst.world), frustum)) visible += 1;
+            }
+        }
+
+        // Sized to the snapshot rather than MAX_LIGHTS, which would put 256 KB on the stack.
+        const scratch = memory.scratch_begin() orelse return;
+        defer scratch.end();
+        const light_slots = @min(snapshot.lights.items.len, pbr.MAX_LIGHTS);
+        const lights = scratch.allocator().alloc(pbr.PBRLight, light_slots) catch return;
+        self.light_count = snapshot.to_pbr_lights(lights);
+        self.visible_count = visible;
+        self.last_frame_index = snapshot.frame_index;
+        self.frames_rendered += 1;
+    }
+};
+
+const TestWorld = struct {
+    registry: *registry_pkg.Registry,
+    mover: registry_pkg.Entity,
+
+    fn simulate(ctx: ?*anyopaque, delta_time: f32) anyerror!void {
+        _ = delta_time;
+        const self: *TestWorld = @ptrCast(@alignCast(ctx));
+        const t = self.registry.get(components.Transform, self.mover).?;
+        t.position.x += 1.0;
+        t.dirty = true;
+    }
+
+    const Recorder = struct {
+        frames: [8]u64 = undefined,
+        positions: [8]f32 = undefined,
+        count: usize = 0,
+
+        fn render(ctx: ?*anyopaque, snapshot: *const RenderSnapshot) void {
+            const self: *Recorder = @ptrCast(@alignCast(ctx));
+            self.frames[self.count] = snapshot.frame_index;
+            self.positions[self.count] = snapshot.meshes.items[0].world.data[12];
+            self.count += 1;
+        }
+    };
+};
+
+fn run_test_frames(mode: Mode, recorder: *TestWorld.Recorder) !bool {
+    const allocator = std.testing.allocator;
+    var registry = registry_pkg.Registry.init(allocator);
+    defer registry.deinit();
+
+    const mover = try registry.create();
+    try registry.add(mover, components.Transform{});
+    try registry.add(mover, components.MeshRenderer{ .mesh = .{ .index = 0, .generation = 1 }, .material = .{ .index = 0, .generation = 1 } });
+    var world = TestWorld{ .registry = &registry, .mover = mover };
+
+    var pipeline = FramePipeline.init(allocator, &registry, mode);
+    defer pipeline.deinit();
+
+    var overlapped = false;
+    for (0..4) |_| {
+        try pipeline.run_frame(1.0 / 60.0, .{ .ctx = &world, .func = TestWorld.simulate }, .{ .ctx = recorder, .func = TestWorld.Recorder.render });
+        overlapped = overlapped or pipeline.stats.overlapped;
+    }
+    try std.testing.expectEqual(@as(u64, 4), pipeline.front_snapshot().frame_index);
+    return overlapped;
+}
+
+test "frame pipeline renders the current frame serially and the previous frame when pipelined" {
+    memory.cardinal_memory_init(1024 * 1024);
+    defer memory.cardinal_memory_shutdown();
+
+    const job_config = job_system.JobSystemConfig{
+        .worker_thread_count = 2,
+        .max_queue_size = 100,
+        .enable_priority_queue = true,
+    };
+    if (!job_system.init(&job_config)) return error.JobSystemInitFailed;
+    defer job_system.shutdown();
+
+    var serial = TestWorld.Recorder{};
+    try std.testing.expect(!try run_test_frames(.serial, &serial));
+    try std.testing.expectEqual(@as(usize, 4), serial.count);
+    for (0..4) |i| {
+        try std.testing.expectEqual(@as(u64, i + 1), serial.frames[i]);
+        try std.testing.expectApproxEqAbs(@as(f32, @floatFromInt(i + 1)), serial.positions[i], 1e-5);
+    }
+
+    // Frame 1 has no snapshot to render yet; each later frame renders its predecessor.
+    var pipelined = TestWorld.Recorder{};
+    try std.testing.expect(try run_test_frames(.pipelined, &pipelined));
+    try std.testing.expectEqual(@as(usize, 3), pipelined.count);
+    for (0..3) |i| {
+        try std.testing.expectEqual(@as(u64, i + 1), pipelined.frames[i]);
+        try std.testing.expectApproxEqAbs(@as(f32, @floatFromInt(i + 1)), pipelined.positions[i], 1e-5);
+    }
+}
+
+test "frame pipeline without a render stage simulates and skips extraction" {
+    const allocator = std.testing.allocator;
+    var registry = registry_pkg.Registry.init(allocator);
+    defer registry.deinit();
+
+    const mover = try registry.create();
+    try registry.add(mover, components.Transform{});
+    try registry.add(mover, components.MeshRenderer{ .mesh = .{ .index = 0, .generation = 1 }, .material = .{ .index = 0, .generation = 1 } });
+    var world = TestWorld{ .registry = &registry, .mover = mover };
+
+    var pipeline = FramePipeline.init(allocator, &registry, .pipelined);
+    defer pipeline.deinit();
+
+    try pipeline.run_frame(1.0 / 60.0, .{ .ctx = &world, .func = TestWorld.simulate }, null);
+    try pipeline.run_frame(1.0 / 60.0, .{ .ctx = &world, .func = TestWorld.simulate }, null);
+
+    try std.testing.expect(!pipeline.stats.overlapped);
+    try std.testing.expectEqual(@as(u64, 0), pipeline.front_snapshot().frame_index);
+    try std.testing.expectEqual(@as(usize, 0), pipeline.front_snapshot().meshes.items.len);
+    try std.testing.expectApproxEqAbs(@as(f32, 2.0), registry.get_const(components.Transform, mover).?.position.x, 1e-5);
+}
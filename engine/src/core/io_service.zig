@@ -0,0 +1,690 @@
+//! Asynchronous whole-file reads for the asset loaders.
+//!
+//! `submit` queues a path; the service reads the file into a buffer sized from the file's length
+//! and then calls the request's completion function, which normally hands the bytes to a decode
+//! job. Job workers therefore only pick up loads whose bytes are already in memory and never wait
+//! on the disk.
+//!
+//! On Linux one I/O thread drives an io_uring: the open and statx of every queued request go out
+//! in a single submission, reads follow as sizes arrive, and files that fit are read into
+//! registered buffers with `read_fixed`, which skips pinning the destination pages on every read.
+//! Elsewhere, or when the kernel refuses to create a ring, a small thread pool performs the same
+//! pre-sized reads with blocking calls. Paths resolve through the VFS; entries served by mounted
+//! packs are already mapped and complete without a read.
+//!
+//! Completion functions run on I/O threads and must not block.
+const std = @import("std");
+const builtin = @import("builtin");
+const log = @import("log.zig");
+const memory = @import("memory.zig");
+const profiler = @import("profiler.zig");
+const vfs = @import("vfs.zig");
+
+const io_log = log.ScopedLogger("IO");
+
+const has_io_uring = builtin.os.tag == .linux;
+const linux = std.os.linux;
+
+pub const Backend = enum { io_uring, thread_pool };
+
+pub const Config = struct {
+    /// Null picks io_uring where the kernel provides it and the thread pool otherwise.
+    backend: ?Backend = null,
+    /// Files the ring reads concurrently.
+    queue_depth: u16 = 64,
+    /// Threads of the thread-pool backend.
+    thread_count: u32 = 2,
+    /// Files up to this size are read through one of `fixed_buffer_count` registered buffers.
+    fixed_buffer_size: u32 = 64 * 1024,
+    fixed_buffer_count: u16 = 32,
+    /// Owns requests and file contents; defaults to the asset allocator. Must be thread-safe.
+    allocator: ?std.mem.Allocator = null,
+};
+
+/// Called on an I/O thread when a request finishes, successfully or not.
+pub const CompletionFn = *const fn (request: *Request) void;
+
+/// A whole-file read. Owned by the service until its completion function runs, then by the
+/// caller, who returns it with `release`.
+pub const Request = struct {
+    /// Path as submitted.
+    path: [:0]u8,
+    /// File contents; empty when `err` is set.
+    data: vfs.FileData = .{ .bytes = &.{} },
+    err: ?anyerror = null,
+    user_data: ?*anyopaque,
+    on_complete: CompletionFn,
+
+    next: ?*Request = null,
+
+    // io_uring state.
+    host_path: ?[:0]u8 = null,
+    fd: i32 = -1,
+    pending_ops: u8 = 0,
+    size: u64 = 0,
+    offset: u64 = 0,
+    buffer: []u8 = &.{},
+    fixed_slot: ?u16 = null,
+    iov: std.posix.iovec = undefined,
+    statx: Statx = undefined,
+};
+
+const Statx = if (has_io_uring) linux.Statx else void;
+
+pub const Stats = struct {
+    backend: ?Backend = null,
+    completed: u64 = 0,
+    failed: u64 = 0,
+    bytes: u64 = 0,
+    /// Reads that went through a registered buffer.
+    fixed_reads: u64 = 0,
+    /// Ring submissions; each carries the operations of every request ready at the time.
+    submissions: u64 = 0,
+};
+
+/// Ring operations, stored in the low bits of an SQE's user data next to the request pointer.
+const Op = enum(u2) { open, stat, read, close };
+
+/// User data of the eventfd read that wakes the ring thread for new requests.
+const WAKE_USER_DATA: u64 = 0;
+
+const Ring = if (has_io_uring) struct {
+    ring: linux.IoUring,
+    wake_fd: i32,
+    wake_value: u64 = 0,
+    /// Backing memory of the registered buffers; empty when registration failed.
+    fixed: []u8 = &.{},
+    free_slots: std.ArrayListUnmanaged(u16) = .{},
+    in_flight: u32 = 0,
+} else void;
+
+const Service = struct {
+    allocator: std.mem.Allocator,
+    config: Config,
+    backend: Backend,
+
+    mutex: std.Thread.Mutex = .{},
+    condition: std.Thread.Condition = .{},
+    head: ?*Request = null,
+    tail: ?*Request = null,
+    stopping: bool = false,
+
+    threads: []std.Thread = &.{},
+    ring: Ring = undefined,
+
+    completed: std.atomic.Value(u64) = .init(0),
+    failed: std.atomic.Value(u64) = .init(0),
+    bytes: std.atomic.Value(u64) = .init(0),
+    fixed_reads: std.atomic.Value(u64) = .init(0),
+    submissions: std.atomic.Value(u64) = .init(0),
+
+    fn push(self: *Service, request: *Request) bool {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+        if (self.stopping) return false;
+        if (self.tail) |tail| {
+            tail.next = request;
+        } else {
+            self.head = request;
+        }
+        self.tail = request;
+        self.condition.signal();
+        return true;
+    }
+
+    /// Pops the oldest queued request. With `wait`, blocks until one arrives and returns null only
+    /// once the service is stopping and the queue has drained.
+    fn pop(self: *Service, wait: bool) ?*Request {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+        while (self.head == null and wait and !self.stopping) self.condition.wait(&self.mutex);
+        const request = self.head orelse return null;
+        self.head = request.next;
+        if (self.head == null) self.tail = null;
+        request.next = null;
+        return request;
+    }
+
+    fn drained(self: *Service) bool {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+        return self.stopping and self.head == null;
+    }
+
+    fn finish(self: *Service, request: *Request) void {
+        if (request.err != null) {
+            _ = self.failed.fetchAdd(1, .monotonic);
+        } else {
+            _ = self.completed.fetchAdd(1, .monotonic);
+            _ = self.bytes.fetchAdd(request.data.bytes.len, .monotonic);
+        }
+        request.on_complete(request);
+    }
+};
+
+var g_service: Service = undefined;
+var g_running: bool = false;
+
+/// Starts the I/O threads. Returns true if the service is running.
+pub fn init(config: Config) bool {
+    if (g_running) return true;
+
+    const allocator = config.allocator orelse memory.cardinal_get_allocator_for_category(.ASSETS).as_allocator();
+    g_service = .{ .allocator = allocator, .config = config, .backend = .thread_pool };
+    const service = &g_service;
+    service.config.queue_depth = std.math.clamp(config.queue_depth, 1, 4096);
+
+    if ((config.backend orelse .io_uring) == .io_uring) {
+        if (comptime has_io_uring) {
+            if (ring_init(service)) {
+                service.backend = .io_uring;
+            } else |err| {
+                io_log.info("io_uring unavailable ({s}), reading on a thread pool", .{@errorName(err)});
+            }
+        } else if (config.backend != null) {
+            io_log.info("io_uring is Linux-only, reading on a thread pool", .{});
+        }
+    }
+
+    const thread_count: usize = if (service.backend == .io_uring) 1 else @max(config.thread_count, 1);
+    service.threads = allocator.alloc(std.Thread, thread_count) catch {
+        release_backend(service);
+        return false;
+    };
+
+    var spawned: usize = 0;
+    while (spawned < thread_count) : (spawned += 1) {
+        const thread = switch (service.backend) {
+            .io_uring => if (comptime has_io_uring) std.Thread.spawn(.{}, ring_thread, .{service}) else unreachable,
+            .thread_pool => std.Thread.spawn(.{}, pool_thread, .{service}),
+        } catch |err| {
+            io_log.err("Failed to start I/O thread: {s}", .{@errorName(err)});
+            stop_threads(service, service.threads[0..spawned]);
+            allocator.free(service.threads);
+            release_backend(service);
+            return false;
+        };
+        service.threads[spawned] = thread;
+    }
+
+    g_running = true;
+    io_log.info("I/O service started ({s}, {d} thread(s))", .{ @tagName(service.backend), thread_count });
+    return true;
+}
+
+/// Completes every queued request, then stops the I/O threads.
+pub fn shutdown() void {
+    if (!g_running) return;
+    const service = &g_service;
+    stop_threads(service, service.threads);
+    service.allocator.free(service.threads);
+    service.threads = &.{};
+    release_backend(service);
+    g_running = false;
+}
+
+pub fn is_running() bool {
+    return g_running;
+}
+
+pub fn get_backend() ?Backend {
+    return if (g_running) g_service.backend else null;
+}
+
+pub fn get_stats() Stats {
+    if (!g_running) return .{};
+    return .{
+        .backend = g_service.backend,
+        .completed = g_service.completed.load(.monotonic),
+        .failed = g_service.failed.load(.monotonic),
+        .bytes = g_service.bytes.load(.monotonic),
+        .fixed_reads = g_service.fixed_reads.load(.monotonic),
+        .submissions = g_service.submissions.load(.monotonic),
+    };
+}
+
+/// Queues a read of the whole file at `path` (resolved through the VFS). `on_complete` receives
+/// the request on an I/O thread. Returns false if the service is not running or out of memory,
+/// in which case `on_complete` is never called.
+pub fn submit(path: []const u8, on_complete: CompletionFn, user_data: ?*anyopaque) bool {
+    if (!g_running) return false;
+    const service = &g_service;
+
+    const request = service.allocator.create(Request) catch return false;
+    const owned_path = service.allocator.dupeZ(u8, path) catch {
+        service.allocator.destroy(request);
+        return false;
+    };
+    request.* = .{ .path = owned_path, .user_data = user_data, .on_complete = on_complete };
+
+    if (!service.push(request)) {
+        service.allocator.free(owned_path);
+        service.allocator.destroy(request);
+        return false;
+    }
+    if (comptime has_io_uring) {
+        if (service.backend == .io_uring) ring_wake(service);
+    }
+    return true;
+}
+
+/// Frees a completed request and its contents.
+pub fn release(request: *Request) void {
+    const allocator = g_service.allocator;
+    request.data.deinit();
+    allocator.free(request.path);
+    allocator.destroy(request);
+}
+
+fn stop_threads(service: *Service, threads: []const std.Thread) void {
+    service.mutex.lock();
+    service.stopping = true;
+    service.condition.broadcast();
+    service.mutex.unlock();
+    if (comptime has_io_uring) {
+        if (service.backend == .io_uring) ring_wake(service);
+    }
+    for (threads) |thread| thread.join();
+}
+
+fn release_backend(service: *Service) void {
+    if (comptime has_io_uring) {
+        if (service.backend == .io_uring) ring_deinit(service);
+    }
+}
+
+// Thread pool backend.
+
+fn pool_thread(service: *Service) void {
+    profiler.set_thread_name("I/O Worker");
+    memory.cardinal_memory_enable_thread_cache();
+    while (service.pop(true)) |request| {
+        read_blocking(service.allocator, request);
+        service.finish(request);
+    }
+    memory.cardinal_memory_flush_thread_cache();
+}
+
+fn read_blocking(allocator: std.mem.Allocator, request: *Request) void {
+    var path_buf: [std.fs.max_path_bytes]u8 = undefined;
+    const host = vfs.host_path(request.path, &path_buf) orelse {
+        request.data = vfs.read_file(allocator, request.path) catch |err| {
+            request.err = err;
+            return;
+        };
+        return;
+    };
+    request.data = read_sized(allocator, host) catch |err| {
+        request.err = err;
+        return;
+    };
+}
+
+/// Reads a host file into a buffer allocated once from its size, where `readToEndAlloc` grows
+/// one as it goes.
+fn read_sized(allocator: std.mem.Allocator, path: []const u8) !vfs.FileData {
+    const file = try std.fs.cwd().openFile(path, .{});
+    defer file.close();
+
+    const size = std.math.cast(usize, (try file.stat()).size) orelse return error.FileTooBig;
+    var buffer = try allocator.alloc(u8, size);
+    errdefer allocator.free(buffer);
+    const read = try file.preadAll(buffer, 0);
+    // The file shrank since the stat.
+    if (read < buffer.len) buffer = try allocator.realloc(buffer, read);
+    return .{ .bytes = buffer, .allocator = allocator };
+}
+
+// io_uring backend.
+
+fn ring_init(service: *Service) !void {
+    const config = service.config;
+    // Each request has at most two operations in flight (open and statx), plus the wake read.
+    const entries = try std.math.ceilPowerOfTwo(u16, config.queue_depth * 2 + 1);
+
+    const wake_fd = try std.posix.eventfd(0, linux.EFD.CLOEXEC);
+    errdefer std.posix.close(wake_fd);
+    service.ring = .{ .ring = try linux.IoUring.init(entries, 0), .wake_fd = wake_fd };
+    errdefer service.ring.ring.deinit();
+
+    const fixed_bytes = @as(usize, config.fixed_buffer_size) * config.fixed_buffer_count;
+    if (fixed_bytes == 0) return;
+    ring_register_buffers(service, fixed_bytes) catch |err| {
+        // Usually RLIMIT_MEMLOCK; reads fall back to plain heap buffers.
+        io_log.debug("Registered I/O buffers unavailable: {s}", .{@errorName(err)});
+        if (service.ring.fixed.len > 0) std.heap.page_allocator.free(service.ring.fixed);
+        service.ring.fixed = &.{};
+        service.ring.free_slots.deinit(service.allocator);
+        service.ring.free_slots = .{};
+    };
+}
+
+fn ring_register_buffers(service: *Service, fixed_bytes: usize) !void {
+    const r = &service.ring;
+    const count = service.config.fixed_buffer_count;
+    const slot_size = service.config.fixed_buffer_size;
+
+    try r.free_slots.ensureTotalCapacity(service.allocator, count);
+    r.fixed = try std.heap.page_allocator.alloc(u8, fixed_bytes);
+    const iovecs = try service.allocator.alloc(std.posix.iovec, count);
+    defer service.allocator.free(iovecs);
+    for (iovecs, 0..) |*iov, i| iov.* = .{ .base = r.fixed[i * slot_size ..].ptr, .len = slot_size };
+    try r.ring.register_buffers(iovecs);
+
+    var slot = count;
+    while (slot > 0) {
+        slot -= 1;
+        r.free_slots.appendAssumeCapacity(slot);
+    }
+}
+
+fn ring_deinit(service: *Service) void {
+    const r = &service.ring;
+    r.ring.deinit();
+    std.posix.close(r.wake_fd);
+    if (r.fixed.len > 0) std.heap.page_allocator.free(r.fixed);
+    r.free_slots.deinit(service.allocator);
+}
+
+fn ring_wake(service: *Service) void {
+    const one: u64 = 1;
+    _ = std.posix.write(service.ring.wake_fd, std.mem.asBytes(&one)) catch {};
+}
+
+/// Keeps a read of the wake eventfd in flight so `submit` can interrupt the ring wait.
+fn ring_arm_wake(r: *Ring) void {
+    const buffer = std.mem.asBytes(&r.wake_value);
+    _ = r.ring.read(WAKE_USER_DATA, r.wake_fd, .{ .buffer = buffer }, 0) catch {
+        _ = r.ring.submit() catch {};
+        _ = r.ring.read(WAKE_USER_DATA, r.wake_fd, .{ .buffer = buffer }, 0) catch |err| {
+            io_log.err("Failed to arm the I/O wake event: {s}", .{@errorName(err)});
+        };
+    };
+}
+
+fn ring_user_data(request: *Request, op: Op) u64 {
+    return @intFromPtr(request) | @intFromEnum(op);
+}
+
+fn ring_thread(service: *Service) void {
+    profiler.set_thread_name("I/O Ring");
+    memory.cardinal_memory_enable_thread_cache();
+    const r = &service.ring;
+    var cqes: [64]linux.io_uring_cqe = undefined;
+
+    ring_arm_wake(r);
+    while (true) {
+        while (r.in_flight < service.config.queue_depth) {
+            const request = service.pop(false) orelse break;
+            ring_start(service, request);
+        }
+        if (r.in_flight == 0 and service.drained()) break;
+
+        _ = r.ring.submit_and_wait(1) catch |err| switch (err) {
+            error.SignalInterrupt => continue,
+            else => {
+                io_log.warn("io_uring submit failed: {s}", .{@errorName(err)});
+                std.Thread.sleep(std.time.ns_per_ms);
+                continue;
+            },
+        };
+        _ = service.submissions.fetchAdd(1, .monotonic);
+
+        const count = r.ring.copy_cqes(&cqes, 0) catch continue;
+        for (cqes[0..count]) |cqe| {
+            if (cqe.user_data == WAKE_USER_DATA) {
+                ring_arm_wake(r);
+                continue;
+            }
+            const request: *Request = @ptrFromInt(cqe.user_data & ~@as(u64, 3));
+            ring_complete_op(service, request, @enumFromInt(@as(u2, @truncate(cqe.user_data))), cqe);
+        }
+    }
+    memory.cardinal_memory_flush_thread_cache();
+}
+
+/// Queues the open and statx of `request`.
+fn ring_start(service: *Service, request: *Request) void {
+    const r = &service.ring;
+    var path_buf: [std.fs.max_path_bytes]u8 = undefined;
+    const host = vfs.host_path(request.path, &path_buf) orelse {
+        // Pack entries are mapped (or inflated from the mapping); there is nothing to read.
+        read_blocking(service.allocator, request);
+        service.finish(request);
+        return;
+    };
+    const owned_host = service.allocator.dupeZ(u8, host) catch {
+        request.err = error.OutOfMemory;
+        service.finish(request);
+        return;
+    };
+    request.host_path = owned_host;
+
+    // Queue sizing leaves room for both operations; flush anything still pending to be safe.
+    if (r.ring.sq.sqes.len - r.ring.sq_ready() < 2) _ = r.ring.submit() catch {};
+    r.in_flight += 1;
+    _ = r.ring.openat(ring_user_data(request, .open), linux.AT.FDCWD, owned_host.ptr, .{ .ACCMODE = .RDONLY, .CLOEXEC = true }, 0) catch |err| {
+        request.err = err;
+        ring_finish(service, request);
+        return;
+    };
+    request.pending_ops = 1;
+    if (r.ring.statx(ring_user_data(request, .stat), linux.AT.FDCWD, owned_host, 0, linux.STATX_SIZE, &request.statx)) |_| {
+        request.pending_ops = 2;
+    } else |err| {
+        // The open still completes; the error closes the file then.
+        request.err = err;
+    }
+}
+
+fn ring_complete_op(service: *Service, request: *Request, op: Op, cqe: linux.io_uring_cqe) void {
+    switch (op) {
+        .open, .stat => {
+            if (cqe.res < 0) {
+                ring_set_error(request, cqe.err());
+            } else if (op == .open) {
+                request.fd = cqe.res;
+            } else {
+                request.size = request.statx.size;
+            }
+            request.pending_ops -= 1;
+            if (request.pending_ops == 0) ring_start_read(service, request);
+        },
+        .read => {
+            if (cqe.res < 0) {
+                const e = cqe.err();
+                if (e == .INTR or e == .AGAIN) return ring_queue_read(service, request);
+                ring_set_error(request, e);
+                return ring_queue_close(service, request);
+            }
+            const read: u64 = @intCast(cqe.res);
+            request.offset += read;
+            // A zero-length read means the file shrank since the statx.
+            if (read == 0 or request.offset >= request.size) return ring_queue_close(service, request);
+            ring_queue_read(service, request);
+        },
+        .close => ring_finish(service, request),
+    }
+}
+
+fn ring_set_error(request: *Request, e: linux.E) void {
+    if (request.err != null) return;
+    request.err = switch (e) {
+        .NOENT => error.FileNotFound,
+        .ACCES, .PERM => error.AccessDenied,
+        .ISDIR => error.IsDir,
+        .NOMEM => error.SystemResources,
+        .MFILE, .NFILE => error.ProcessFdQuotaExceeded,
+        else => error.Unexpected,
+    };
+}
+
+/// Picks the read destination once both the open and the size are known.
+fn ring_start_read(service: *Service, request: *Request) void {
+    if (request.err != null) return ring_queue_close(service, request);
+    const size = std.math.cast(usize, request.size) orelse {
+        request.err = error.FileTooBig;
+        return ring_queue_close(service, request);
+    };
+    if (size == 0) return ring_queue_close(service, request);
+
+    const r = &service.ring;
+    if (size <= service.config.fixed_buffer_size) {
+        if (r.free_slots.pop()) |slot| {
+            request.fixed_slot = slot;
+            request.buffer = r.fixed[@as(usize, slot) * service.config.fixed_buffer_size ..][0..size];
+        }
+    }
+    if (request.fixed_slot == null) {
+        request.buffer = service.allocator.alloc(u8, size) catch {
+            request.err = error.OutOfMemory;
+            return ring_queue_close(service, request);
+        };
+    }
+    ring_queue_read(service, request);
+}
+
+fn ring_queue_read(service: *Service, request: *Request) void {
+    const r = &service.ring;
+    const remaining = request.buffer[@intCast(request.offset)..];
+    const user_data = ring_user_data(request, .read);
+    const queued = if (request.fixed_slot) |slot| blk: {
+        request.iov = .{ .base = remaining.ptr, .len = remaining.len };
+        break :blk r.ring.read_fixed(user_data, request.fd, &request.iov, request.offset, slot);
+    } else r.ring.read(user_data, request.fd, .{ .buffer = remaining }, request.offset);
+    if (queued) |_| {} else |err| {
+        if (request.err == null) request.err = err;
+        ring_queue_close(service, request);
+    }
+}
+
+fn ring_queue_close(service: *Service, request: *Request) void {
+    if (request.fd < 0) return ring_finish(service, request);
+    _ = service.ring.ring.close(ring_user_data(request, .close), request.fd) catch {
+        std.posix.close(request.fd);
+        return ring_finish(service, request);
+    };
+}
+
+/// Moves the contents into `request.data` and runs the completion.
+fn ring_finish(service: *Service, request: *Request) void {
+    const r = &service.ring;
+    const allocator = service.allocator;
+    r.in_flight -= 1;
+    request.fd = -1;
+
+    const len: usize = @intCast(request.offset);
+    if (request.fixed_slot) |slot| {
+        // Registered buffers go straight back to the ring; the caller gets an exact-size copy.
+        if (request.err == null) {
+            if (allocator.dupe(u8, request.buffer[0..len])) |copy| {
+                request.data = .{ .bytes = copy, .allocator = allocator };
+                _ = service.fixed_reads.fetchAdd(1, .monotonic);
+            } else |_| {
+                request.err = error.OutOfMemory;
+            }
+        }
+        r.free_slots.appendAssumeCapacity(slot);
+        request.fixed_slot = null;
+    } else if (request.buffer.len > 0) {
+        var buffer = request.buffer;
+        if (request.err == null and len < buffer.len) {
+            if (allocator.realloc(buffer, len)) |shrunk| buffer = shrunk else |_| request.err = error.OutOfMemory;
+        }
+        if (request.err != null) {
+            allocator.free(buffer);
+        } else {
+            request.data = .{ .bytes = buffer, .allocator = allocator };
+        }
+    }
+    request.buffer = &.{};
+
+    if (request.host_path) |host| allocator.free(host);
+    request.host_path = null;
+    service.finish(request);
+}
+
+const TestReads = struct {
+    mutex: std.Thread.Mutex = .{},
+    done: std.ArrayListUnmanaged(*Request) = .{},
+
+    fn on_complete(request: *Request) void {
+        const self: *TestReads = @ptrCast(@alignCast(request.user_data.?));
+        self.mutex.lock();
+        defer self.mutex.unlock();
+        self.done.append(std.testing.allocator, request) catch @panic("OOM");
+    }
+
+    fn wait(self: *TestReads, count: usize) !void {
+        var waited: usize = 0;
+        while (waited < 5000) : (waited += 1) {
+            self.mutex.lock();
+            const len = self.done.items.len;
+            self.mutex.unlock();
+            if (len >= count) return;
+            std.Thread.sleep(std.time.ns_per_ms);
+        }
+        return error.Timeout;
+    }
+};
+
+fn test_backend(backend: Backend) !void {
+    const allocator = std.testing.allocator;
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+
+    // One file per path through the ring: registered buffer, heap buffer, empty, missing.
+    const small = "small file contents";
+    const large = try allocator.alloc(u8, 200 * 1024);
+    defer allocator.free(large);
+    for (large, 0..) |*b, i| b.* = @truncate(i *% 31);
+    try tmp.dir.writeFile(.{ .sub_path = "small.bin", .data = small });
+    try tmp.dir.writeFile(.{ .sub_path = "large.bin", .data = large });
+    try tmp.dir.writeFile(.{ .sub_path = "empty.bin", .data = "" });
+
+    const root = try tmp.dir.realpathAlloc(allocator, ".");
+    defer allocator.free(root);
+
+    if (!init(.{ .backend = backend, .allocator = allocator, .queue_depth = 2 })) return error.InitFailed;
+    defer shutdown();
+    if (get_backend() != backend) return error.SkipZigTest;
+
+    var reads = TestReads{};
+    defer {
+        for (reads.done.items) |request| release(request);
+        reads.done.deinit(allocator);
+    }
+
+    const names = [_][]const u8{ "small.bin", "large.bin", "empty.bin", "missing.bin", "small.bin" };
+    for (names) |name| {
+        const path = try std.fs.path.join(allocator, &.{ root, name });
+        defer allocator.free(path);
+        try std.testing.expect(submit(path, TestReads.on_complete, &reads));
+    }
+    try reads.wait(names.len);
+
+    for (reads.done.items) |request| {
+        const name = std.fs.path.basename(request.path);
+        if (std.mem.eql(u8, name, "missing.bin")) {
+            try std.testing.expectEqual(@as(?anyerror, error.FileNotFound), request.err);
+            continue;
+        }
+        try std.testing.expectEqual(@as(?anyerror, null), request.err);
+        const expected: []const u8 = if (std.mem.eql(u8, name, "small.bin")) small else if (std.mem.eql(u8, name, "large.bin")) large else "";
+        try std.testing.expectEqualSlices(u8, expected, request.data.bytes);
+    }
+
+    const stats = get_stats();
+    try std.testing.expectEqual(@as(u64, 4), stats.completed);
+    try std.testing.expectEqual(@as(u64, 1), stats.failed);
+    try std.testing.expectEqual(@as(u64, small.len * 2 + large.len), stats.bytes);
+}
+
+test "io service thread pool reads whole files and reports missing ones" {
+    try test_backend(.thread_pool);
+}
+
+test "io service io_uring reads whole files and reports missing ones" {
+    if (!has_io_uring) return error.SkipZigTest;
+    try test_backend(.io_uring);
+}
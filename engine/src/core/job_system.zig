@@ -2,10 +2,19 @@
 //!
 //! Jobs are allocated from pools and scheduled on worker threads. The API is C-ABI-friendly
 //! and exposes optional dependency tracking.
+//!
+//! With `enable_fibers`, workers run each job on a pooled fiber stack. A job that calls
+//! `wait_for_jobs` or `await_counter` then parks its fiber and the worker moves on to other
+//! work; the fiber is resumed on whichever worker is free once the wait is satisfied. Nested
+//! waits therefore no longer tie up a worker each, and cannot deadlock the pool by all waiting
+//! at once. Job code that awaits must not hold thread-local state (or a lock) across the await,
+//! since it may come back on another thread.
 const std = @import("std");
+const fiber = @import("fiber.zig");
 const log = @import("log.zig");
 const memory = @import("memory.zig");
 const pool_allocator = @import("pool_allocator.zig");
+const profiler = @import("profiler.zig");
 
 const job_log = log.ScopedLogger("JOB_SYSTEM");
 
@@ -30,9 +39,11 @@ pub const JobFunc = ?*const fn (data: ?*anyopaque) callconv(.c) i32;
 /// Optional error callback invoked when a job returns a non-zero error code.
 pub const JobErrorFunc = ?*const fn (data: ?*anyopaque, error_code: i32) callconv(.c) void;
 
-/// Intrusive linked list node for dependency fan-out.
+/// Intrusive linked list node for dependency fan-out. Holds either a dependent `job`, released
+/// when the owning job completes, or the `waiter` of a suspended fiber.
 pub const DependencyNode = struct {
-    job: *Job,
+    job: ?*Job = null,
+    waiter: ?*Waiter = null,
     next: ?*DependencyNode,
 };
 
@@ -57,8 +68,110 @@ pub const JobSystemConfig = extern struct {
     worker_thread_count: u32,
     max_queue_size: u32,
     enable_priority_queue: bool,
+    /// Run jobs on pooled fibers so that waiting inside a job suspends it instead of blocking its
+    /// worker. Ignored where `fiber.supported` is false.
+    enable_fibers: bool = false,
+    /// Stack size of each fiber in bytes; 0 selects `DEFAULT_FIBER_STACK_SIZE`.
+    fiber_stack_size: u32 = 0,
+    /// Number of fibers in the pool; 0 selects `DEFAULT_FIBER_COUNT`. While every fiber is in use,
+    /// workers run new jobs on their own stacks, where waits block as without fibers.
+    fiber_count: u32 = 0,
 };
 
+pub const DEFAULT_FIBER_STACK_SIZE: u32 = 256 * 1024;
+pub const DEFAULT_FIBER_COUNT: u32 = 128;
+
+/// Countdown that jobs can await. Call `add` before handing out work and `done` as each piece
+/// finishes; `await_counter` returns once the count is back to zero. The counter must stay alive
+/// until every `done` call has returned.
+pub const Counter = struct {
+    value: std.atomic.Value(u32) = .init(0),
+    waiters: ?*DependencyNode = null,
+
+    pub fn add(self: *Counter, n: u32) void {
+        _ = self.value.fetchAdd(n, .monotonic);
+    }
+
+    pub fn done(self: *Counter) void {
+        if (!g_job_system.initialized) {
+            _ = self.value.fetchSub(1, .acq_rel);
+            return;
+        }
+        var current = self.value.load(.monotonic);
+        while (current > 1) {
+            current = self.value.cmpxchgWeak(current, current - 1, .release, .monotonic) orelse return;
+        }
+
+        // The last decrement happens under `state_mutex`, which awaiters check the count under,
+        // so nobody can see zero and free the counter while this still touches it.
+        g_job_system.state_mutex.lock();
+        defer g_job_system.state_mutex.unlock();
+        _ = self.value.fetchSub(1, .acq_rel);
+        var node = self.waiters;
+        self.waiters = null;
+        while (node) |n| {
+            node = n.next;
+            wake_waiter(n.waiter.?);
+        }
+        g_job_system.completion_condition.broadcast();
+    }
+
+    pub fn is_done(self: *const Counter) bool {
+        return self.value.load(.acquire) == 0;
+    }
+};
+
+/// Wake-up record of a suspended fiber, on that fiber's stack. `remaining` counts the awaited
+/// completions plus one reference the fiber holds until it has switched off its stack, so a
+/// completion racing with the suspend cannot resume it early.
+pub const Waiter = struct {
+    fiber: *JobFiber,
+    remaining: std.atomic.Value(u32),
+};
+
+/// Time and profiler zone of the stretch of a job running on one worker. A fiber job that
+/// suspends closes its slice and opens a new one when it resumes, possibly on another thread.
+const JobSlice = struct {
+    zone: profiler.Zone = .{},
+    start_ns: i128 = 0,
+
+    fn begin() JobSlice {
+        return .{ .zone = profiler.zone("Job"), .start_ns = std.time.nanoTimestamp() };
+    }
+
+    fn end(self: JobSlice) void {
+        _ = g_job_system.busy_ns.fetchAdd(@intCast(@max(std.time.nanoTimestamp() - self.start_ns, 0)), .monotonic);
+        self.zone.end();
+    }
+};
+
+const JobOutcome = struct {
+    status: JobStatus = .COMPLETED,
+    error_code: i32 = 0,
+};
+
+/// A pooled fiber and the job it is running.
+const JobFiber = struct {
+    fiber: fiber.Fiber = .{},
+    created: bool = false,
+    job: ?*Job = null,
+    slice: JobSlice = .{},
+    outcome: JobOutcome = .{},
+    /// Why the fiber last switched back to its worker.
+    yield: enum { finished, waiting } = .finished,
+    waiter: ?*Waiter = null,
+    /// Free list or ready list link.
+    next: ?*JobFiber = null,
+};
+
+/// Per-worker fiber scheduling state.
+const WorkerFibers = struct {
+    context: fiber.Context = .{},
+    current: ?*JobFiber = null,
+};
+
+threadlocal var tls_worker_fibers: ?*WorkerFibers = null;
+
 /// Atomically reads `job.status`.
 pub inline fn get_status(job: *const Job) JobStatus {
     return @atomicLoad(JobStatus, &job.status, .acquire);
@@ -113,6 +226,18 @@ const JobSystemState = struct {
     allocator: std.mem.Allocator,
     job_pool: pool_allocator.PoolAllocator(Job),
     dependency_pool: pool_allocator.PoolAllocator(DependencyNode),
+
+    /// Nanoseconds workers have spent inside job functions since `init`.
+    busy_ns: std.atomic.Value(u64),
+
+    fibers_enabled: bool,
+    fiber_stack_size: usize,
+    fibers: []JobFiber,
+    free_fibers: ?*JobFiber,
+    fiber_mutex: std.Thread.Mutex,
+    /// Resumable fibers, guarded by `pending_queue.mutex` and preferred over new jobs.
+    ready_head: ?*JobFiber,
+    ready_tail: ?*JobFiber,
 };
 
 pub var g_job_system: JobSystemState = undefined;
@@ -201,6 +326,11 @@ fn job_queue_pop(queue: *JobQueue, wait: bool) ?*Job {
         queue.condition.wait(&queue.mutex);
     }
 
+    return job_queue_take(queue);
+}
+
+/// Pops the next job; the caller holds `queue.mutex`.
+fn job_queue_take(queue: *JobQueue) ?*Job {
     switch (queue.mode) {
         .fifo => {
             if (queue.head) |job| {
@@ -330,77 +460,313 @@ fn job_queue_remove(queue: *JobQueue, job: *Job) bool {
     return false;
 }
 
+/// Runs `job.func` and reports how it ended. `slice` is where the running stretch is tracked,
+/// so a fiber can close and reopen it around a suspend.
+fn execute_job(job: *Job, slice: *JobSlice) JobOutcome {
+    const f = job.func orelse return .{};
+    slice.* = JobSlice.begin();
+    const result = f(job.data);
+    slice.end();
+    profiler.count(.jobs, 1);
+    if (result == 0) return .{};
+    if (job.error_func) |ef| {
+        ef(job.data, result);
+    }
+    return .{ .status = .FAILED, .error_code = result };
+}
+
+/// Publishes a finished job: releases its dependents and waiters and queues it as completed.
+fn finish_job(job: *Job, outcome: JobOutcome) void {
+    // Read before publishing the status: a job that is not queued as completed may be freed by
+    // whoever polls it the moment it reads as finished.
+    const push_to_completed_queue = job.push_to_completed_queue;
+    g_job_system.state_mutex.lock();
+
+    if (outcome.status == .FAILED) job.error_code = outcome.error_code;
+    set_status(job, outcome.status);
+
+    var node = job.dependents_head;
+    while (node) |n| {
+        // Waiter nodes live on the waiting fiber's stack and are gone once it resumes.
+        const next = n.next;
+        if (n.waiter) |waiter| {
+            wake_waiter(waiter);
+            node = next;
+            continue;
+        }
+        const dependent = n.job.?;
+        if (dependent.dependency_count > 0) {
+            dependent.dependency_count -= 1;
+            if (dependent.dependency_count == 0) {
+                if (job_queue_remove(&g_job_system.waiting_queue, dependent)) {
+                    _ = job_queue_push(&g_job_system.pending_queue, dependent);
+                }
+            }
+        }
+        g_job_system.dependency_pool.destroy(n);
+        node = next;
+    }
+    job.dependents_head = null;
+    g_job_system.completion_condition.broadcast();
+    g_job_system.state_mutex.unlock();
+
+    if (push_to_completed_queue) {
+        g_job_system.completed_queue.mutex.lock();
+        defer g_job_system.completed_queue.mutex.unlock();
+
+        const queue = &g_job_system.completed_queue;
+
+        job.next = null;
+        if (queue.tail) |tail| {
+            tail.next = job;
+        } else {
+            queue.head = job;
+        }
+        queue.tail = job;
+        queue.count += 1;
+        queue.condition.signal();
+    }
+}
+
+/// Handles a job that was cancelled after being popped.
+fn finish_cancelled_job(job: *Job) void {
+    _ = job_queue_push(&g_job_system.completed_queue, job);
+    g_job_system.state_mutex.lock();
+    wake_job_waiters(job);
+    g_job_system.completion_condition.broadcast();
+    g_job_system.state_mutex.unlock();
+}
+
 /// Worker thread entrypoint: executes jobs and releases dependent jobs.
 fn worker_thread_func(worker: *WorkerThread) void {
-    while (!worker.should_exit and !g_job_system.shutting_down) {
-        const job_opt = job_queue_pop(&g_job_system.pending_queue, true);
+    profiler.set_thread_name("Job Worker");
+    memory.cardinal_memory_enable_thread_cache();
+    if (g_job_system.fibers_enabled) {
+        fiber_worker_loop(worker);
+    } else {
+        worker_loop(worker);
+    }
+    memory.cardinal_memory_flush_thread_cache();
+}
 
-        if (job_opt == null) continue;
-        const job = job_opt.?;
+fn worker_loop(worker: *WorkerThread) void {
+    while (!worker.should_exit and !g_job_system.shutting_down) {
+        const job = job_queue_pop(&g_job_system.pending_queue, true) orelse continue;
 
         if (get_status(job) == .CANCELLED) {
-            _ = job_queue_push(&g_job_system.completed_queue, job);
-            g_job_system.state_mutex.lock();
-            g_job_system.completion_condition.broadcast();
-            g_job_system.state_mutex.unlock();
+            finish_cancelled_job(job);
             continue;
         }
 
         set_status(job, .RUNNING);
-        var new_status: JobStatus = .COMPLETED;
-        var error_code: i32 = 0;
-
-        if (job.func) |f| {
-            const result = f(job.data);
-            if (result != 0) {
-                new_status = .FAILED;
-                error_code = result;
-                if (job.error_func) |ef| {
-                    ef(job.data, result);
+        var slice = JobSlice{};
+        finish_job(job, execute_job(job, &slice));
+    }
+}
+
+/// Work a fiber-mode worker picks up next.
+const FiberWork = union(enum) {
+    job: *Job,
+    resume_fiber: *JobFiber,
+};
+
+fn next_fiber_work() ?FiberWork {
+    const queue = &g_job_system.pending_queue;
+    queue.mutex.lock();
+    defer queue.mutex.unlock();
+
+    while (queue.count == 0 and g_job_system.ready_head == null and !g_job_system.shutting_down) {
+        queue.condition.wait(&queue.mutex);
+    }
+
+    // Resumed fibers first: they already hold a stack, and their callers are waiting on them.
+    if (g_job_system.ready_head) |f| {
+        g_job_system.ready_head = f.next;
+        if (g_job_system.ready_head == null) g_job_system.ready_tail = null;
+        f.next = null;
+        return .{ .resume_fiber = f };
+    }
+    const job = job_queue_take(queue) orelse return null;
+    return .{ .job = job };
+}
+
+fn fiber_worker_loop(worker: *WorkerThread) void {
+    var state = WorkerFibers{};
+    if (!fiber.enter_thread(&state.context)) {
+        job_log.warn("Worker {d} could not enter fiber mode; running jobs on its own stack", .{worker.thread_id});
+        worker_loop(worker);
+        return;
+    }
+    tls_worker_fibers = &state;
+    defer {
+        tls_worker_fibers = null;
+        fiber.leave_thread(&state.context);
+    }
+
+    while (!worker.should_exit and !g_job_system.shutting_down) {
+        switch (next_fiber_work() orelse continue) {
+            .resume_fiber => |f| run_fiber(&state, f),
+            .job => |job| {
+                if (get_status(job) == .CANCELLED) {
+                    finish_cancelled_job(job);
+                    continue;
                 }
-            }
+
+                set_status(job, .RUNNING);
+                if (acquire_fiber()) |f| {
+                    f.job = job;
+                    run_fiber(&state, f);
+                } else {
+                    var slice = JobSlice{};
+                    finish_job(job, execute_job(job, &slice));
+                }
+            },
         }
+    }
+}
 
-        g_job_system.state_mutex.lock();
+/// Switches into `f` until it finishes its job or suspends.
+fn run_fiber(state: *WorkerFibers, f: *JobFiber) void {
+    state.current = f;
+    fiber.switch_to(&state.context, &f.fiber.context);
+    state.current = null;
+
+    switch (f.yield) {
+        .finished => {
+            const job = f.job.?;
+            f.job = null;
+            finish_job(job, f.outcome);
+            release_fiber(f);
+        },
+        // The fiber is off its stack now, so its own reference can go. After this it may already
+        // be running elsewhere.
+        .waiting => wake_waiter(f.waiter.?),
+    }
+}
 
-        if (new_status == .FAILED) job.error_code = error_code;
-        set_status(job, new_status);
+fn fiber_main(arg: *anyopaque) callconv(.c) noreturn {
+    const f: *JobFiber = @ptrCast(@alignCast(arg));
+    while (true) {
+        f.outcome = execute_job(f.job.?, &f.slice);
+        f.yield = .finished;
+        fiber.switch_to(&f.fiber.context, &current_worker_fibers().?.context);
+    }
+}
 
-        var node = job.dependents_head;
-        while (node) |n| {
-            const dependent = n.job;
-            if (dependent.dependency_count > 0) {
-                dependent.dependency_count -= 1;
-                if (dependent.dependency_count == 0) {
-                    if (job_queue_remove(&g_job_system.waiting_queue, dependent)) {
-                        _ = job_queue_push(&g_job_system.pending_queue, dependent);
-                    }
-                }
-            }
-            const next = n.next;
-            g_job_system.dependency_pool.destroy(n);
-            node = next;
+/// Not inlined so every call re-reads the thread-local: a fiber can resume on another worker,
+/// and a thread-local address computed before a switch would still point at the old one.
+noinline fn current_worker_fibers() ?*WorkerFibers {
+    return tls_worker_fibers;
+}
+
+fn current_fiber() ?*JobFiber {
+    const state = current_worker_fibers() orelse return null;
+    return state.current;
+}
+
+fn acquire_fiber() ?*JobFiber {
+    const f = blk: {
+        g_job_system.fiber_mutex.lock();
+        defer g_job_system.fiber_mutex.unlock();
+        const f = g_job_system.free_fibers orelse return null;
+        g_job_system.free_fibers = f.next;
+        f.next = null;
+        break :blk f;
+    };
+
+    if (!f.created) {
+        f.fiber.init(g_job_system.fiber_stack_size, fiber_main, f) catch |err| {
+            job_log.warn("Failed to create job fiber: {s}", .{@errorName(err)});
+            release_fiber(f);
+            return null;
+        };
+        f.created = true;
+    }
+    return f;
+}
+
+fn release_fiber(f: *JobFiber) void {
+    g_job_system.fiber_mutex.lock();
+    defer g_job_system.fiber_mutex.unlock();
+    f.next = g_job_system.free_fibers;
+    g_job_system.free_fibers = f;
+}
+
+/// Drops one reference from `waiter`, queueing its fiber to resume when it was the last.
+fn wake_waiter(waiter: *Waiter) void {
+    const f = waiter.fiber;
+    if (waiter.remaining.fetchSub(1, .acq_rel) != 1) return;
+
+    const queue = &g_job_system.pending_queue;
+    queue.mutex.lock();
+    defer queue.mutex.unlock();
+    f.next = null;
+    if (g_job_system.ready_tail) |tail| {
+        tail.next = f;
+    } else {
+        g_job_system.ready_head = f;
+    }
+    g_job_system.ready_tail = f;
+    queue.condition.signal();
+}
+
+/// Unlinks and wakes the fiber waiters of `job`, keeping dependent-job nodes. Caller holds
+/// `state_mutex`.
+fn wake_job_waiters(job: *Job) void {
+    var link = &job.dependents_head;
+    while (link.*) |n| {
+        if (n.waiter) |waiter| {
+            link.* = n.next;
+            wake_waiter(waiter);
+        } else {
+            link = &n.next;
         }
-        job.dependents_head = null;
-        g_job_system.completion_condition.broadcast();
-        g_job_system.state_mutex.unlock();
+    }
+}
 
-        if (job.push_to_completed_queue) {
-            g_job_system.completed_queue.mutex.lock();
-            defer g_job_system.completed_queue.mutex.unlock();
+/// Parks the running fiber until `waiter` is woken. `waiter.remaining` must already include the
+/// fiber's own reference.
+///
+/// The fiber may resume on another worker. Open scratch scopes are a bug in debug builds; in
+/// release builds their arena is handed to the resuming thread instead of being left on this
+/// one. The size-class thread cache holds no state across calls and needs no handoff.
+fn suspend_fiber(f: *JobFiber, waiter: *Waiter) void {
+    const scratch = memory.scratch_suspend();
+    std.debug.assert(scratch.depth == 0); // ScratchScope held across a job wait
+    f.slice.end();
+    f.waiter = waiter;
+    f.yield = .waiting;
+    fiber.switch_to(&f.fiber.context, &current_worker_fibers().?.context);
+    f.waiter = null;
+    f.slice = JobSlice.begin();
+    memory.scratch_resume(scratch);
+}
 
-            const queue = &g_job_system.completed_queue;
+fn is_finished(status: JobStatus) bool {
+    return status == .COMPLETED or status == .FAILED or status == .CANCELLED;
+}
 
-            job.next = null;
-            if (queue.tail) |tail| {
-                tail.next = job;
-            } else {
-                queue.head = job;
-            }
-            queue.tail = job;
-            queue.count += 1;
-            queue.condition.signal();
+/// `wait_for_jobs` from inside a fiber: registers on the unfinished jobs a batch at a time, with
+/// the list nodes on this fiber's stack, and suspends until each batch is done.
+fn fiber_wait_for_jobs(f: *JobFiber, jobs: []const *Job) void {
+    var nodes: [16]DependencyNode = undefined;
+    var index: usize = 0;
+    while (index < jobs.len) {
+        var waiter = Waiter{ .fiber = f, .remaining = .init(1) };
+        var used: u32 = 0;
+
+        g_job_system.state_mutex.lock();
+        while (index < jobs.len and used < nodes.len) : (index += 1) {
+            const job = jobs[index];
+            if (is_finished(get_status(job))) continue;
+            nodes[used] = .{ .waiter = &waiter, .next = job.dependents_head };
+            job.dependents_head = &nodes[used];
+            used += 1;
         }
+        _ = waiter.remaining.fetchAdd(used, .monotonic);
+        g_job_system.state_mutex.unlock();
+
+        if (used > 0) suspend_fiber(f, &waiter);
     }
 }
 
@@ -428,6 +794,13 @@ pub fn init(config: ?*const JobSystemConfig) bool {
 
     g_job_system.state_mutex = .{};
     g_job_system.next_job_id = 0;
+    g_job_system.busy_ns = .init(0);
+    g_job_system.fibers_enabled = false;
+    g_job_system.fibers = &.{};
+    g_job_system.free_fibers = null;
+    g_job_system.fiber_mutex = .{};
+    g_job_system.ready_head = null;
+    g_job_system.ready_tail = null;
 
     const allocator = memory.cardinal_get_allocator_for_category(.ENGINE);
     g_job_system.allocator = allocator.as_allocator();
@@ -439,6 +812,14 @@ pub fn init(config: ?*const JobSystemConfig) bool {
     job_queue_init(&g_job_system.waiting_queue, .fifo, g_job_system.config.max_queue_size);
     job_queue_init(&g_job_system.completed_queue, .fifo, g_job_system.config.max_queue_size);
 
+    if (g_job_system.config.enable_fibers) {
+        if (fiber.supported) {
+            init_fiber_pool();
+        } else {
+            job_log.warn("Fibers are not supported on this target; jobs will block while waiting", .{});
+        }
+    }
+
     const workers = memory.cardinal_alloc(allocator, @sizeOf(WorkerThread) * g_job_system.config.worker_thread_count);
     if (workers == null) return false;
 
@@ -455,10 +836,31 @@ pub fn init(config: ?*const JobSystemConfig) bool {
     }
 
     g_job_system.initialized = true;
-    job_log.info("Job System initialized with {d} threads", .{g_job_system.config.worker_thread_count});
+    job_log.info("Job System initialized with {d} threads{s}", .{
+        g_job_system.config.worker_thread_count,
+        if (g_job_system.fibers_enabled) " (fibers)" else "",
+    });
     return true;
 }
 
+/// Allocates the fiber records; stacks are created on first use.
+fn init_fiber_pool() void {
+    const count = if (g_job_system.config.fiber_count == 0) DEFAULT_FIBER_COUNT else g_job_system.config.fiber_count;
+    const stack_size = if (g_job_system.config.fiber_stack_size == 0) DEFAULT_FIBER_STACK_SIZE else g_job_system.config.fiber_stack_size;
+
+    const fibers = g_job_system.allocator.alloc(JobFiber, count) catch {
+        job_log.warn("Failed to allocate {d} job fibers; jobs will block while waiting", .{count});
+        return;
+    };
+    for (fibers, 0..) |*f, i| {
+        f.* = .{ .next = if (i + 1 < fibers.len) &fibers[i + 1] else null };
+    }
+    g_job_system.fibers = fibers;
+    g_job_system.free_fibers = &fibers[0];
+    g_job_system.fiber_stack_size = stack_size;
+    g_job_system.fibers_enabled = true;
+}
+
 /// Signals worker threads to exit and frees job system state.
 pub fn shutdown() void {
     if (!g_job_system.initialized) return;
@@ -489,6 +891,15 @@ pub fn shutdown() void {
     job_queue_deinit(&g_job_system.waiting_queue);
     job_queue_deinit(&g_job_system.completed_queue);
 
+    // Fibers still suspended here were waiting on work that will never finish; their jobs are
+    // abandoned along with their stacks.
+    for (g_job_system.fibers) |*f| {
+        if (f.created) f.fiber.deinit();
+    }
+    if (g_job_system.fibers.len > 0) g_job_system.allocator.free(g_job_system.fibers);
+    g_job_system.fibers = &.{};
+    g_job_system.fibers_enabled = false;
+
     g_job_system.job_pool.deinit();
     g_job_system.dependency_pool.deinit();
 
@@ -536,6 +947,14 @@ pub fn submit_job(job: *Job) bool {
     return job_queue_push(&g_job_system.pending_queue, job);
 }
 
+/// Runs a job with no unmet dependencies on the calling thread and publishes it as a worker
+/// would. For callers that cannot queue it, e.g. because no worker is running.
+pub fn run_job_inline(job: *Job) void {
+    set_status(job, .RUNNING);
+    var slice = JobSlice{};
+    finish_job(job, execute_job(job, &slice));
+}
+
 /// Attempts to cancel a job that has not started running yet.
 pub fn cancel_job(job: *Job) bool {
     if (!g_job_system.initialized) return false;
@@ -545,11 +964,7 @@ pub fn cancel_job(job: *Job) bool {
     if (!removed) return false;
 
     set_status(job, .CANCELLED);
-    _ = job_queue_push(&g_job_system.completed_queue, job);
-
-    g_job_system.state_mutex.lock();
-    g_job_system.completion_condition.broadcast();
-    g_job_system.state_mutex.unlock();
+    finish_cancelled_job(job);
 
     return true;
 }
@@ -578,8 +993,7 @@ pub fn add_dependency(dependent: *Job, dependency: *Job) bool {
     }
 
     const node = g_job_system.dependency_pool.create() catch return false;
-    node.job = dependent;
-    node.next = dependency.dependents_head;
+    node.* = .{ .job = dependent, .next = dependency.dependents_head };
     dependency.dependents_head = node;
 
     dependent.dependency_count += 1;
@@ -587,9 +1001,11 @@ pub fn add_dependency(dependent: *Job, dependency: *Job) bool {
     return true;
 }
 
-/// Blocks the caller until every job in `jobs` reaches a terminal status.
+/// Waits until every job in `jobs` reaches a terminal status. Called from a job running on a
+/// fiber, this suspends the job and frees its worker; anywhere else it blocks the caller.
 pub fn wait_for_jobs(jobs: []const *Job) void {
     if (!g_job_system.initialized) return;
+    if (current_fiber()) |f| return fiber_wait_for_jobs(f, jobs);
 
     g_job_system.state_mutex.lock();
     defer g_job_system.state_mutex.unlock();
@@ -597,8 +1013,7 @@ pub fn wait_for_jobs(jobs: []const *Job) void {
     while (!g_job_system.shutting_down) {
         var all_done = true;
         for (jobs) |job| {
-            const status = get_status(job);
-            if (status != .COMPLETED and status != .FAILED and status != .CANCELLED) {
+            if (!is_finished(get_status(job))) {
                 all_done = false;
                 break;
             }
@@ -609,6 +1024,40 @@ pub fn wait_for_jobs(jobs: []const *Job) void {
     }
 }
 
+/// Waits until `counter` reaches zero, suspending like `wait_for_jobs` when on a fiber.
+pub fn await_counter(counter: *Counter) void {
+    if (!g_job_system.initialized) return;
+
+    g_job_system.state_mutex.lock();
+    if (current_fiber()) |f| {
+        if (counter.value.load(.acquire) == 0) {
+            g_job_system.state_mutex.unlock();
+            return;
+        }
+        var waiter = Waiter{ .fiber = f, .remaining = .init(2) };
+        var node = DependencyNode{ .waiter = &waiter, .next = counter.waiters };
+        counter.waiters = &node;
+        g_job_system.state_mutex.unlock();
+        suspend_fiber(f, &waiter);
+        return;
+    }
+
+    defer g_job_system.state_mutex.unlock();
+    while (counter.value.load(.acquire) != 0 and !g_job_system.shutting_down) {
+        g_job_system.completion_condition.wait(&g_job_system.state_mutex);
+    }
+}
+
+/// True when the job system runs jobs on fibers.
+pub fn fibers_enabled() bool {
+    return g_job_system.initialized and g_job_system.fibers_enabled;
+}
+
+/// True when called from a job running on a fiber, where waits suspend instead of blocking.
+pub fn in_fiber() bool {
+    return current_fiber() != null;
+}
+
 /// Drains up to `max_jobs` from the completed queue and returns the number drained.
 ///
 /// Completion bookkeeping does not free jobs; callers must release jobs they own.
@@ -643,6 +1092,19 @@ pub fn get_completed_job() ?*Job {
     return null;
 }
 
+/// Returns the number of worker threads, or 0 when the job system is not running.
+pub fn get_worker_count() u32 {
+    if (!g_job_system.initialized) return 0;
+    return g_job_system.config.worker_thread_count;
+}
+
+/// Returns the time workers have spent running jobs since `init`, summed over all workers.
+/// Divided by worker count times wall time, it is the workers' utilization.
+pub fn get_busy_time_ns() u64 {
+    if (!g_job_system.initialized) return 0;
+    return g_job_system.busy_ns.load(.monotonic);
+}
+
 pub fn get_pending_job_count() u32 {
     if (!g_job_system.initialized) return 0;
 
@@ -651,3 +1113,115 @@ pub fn get_pending_job_count() u32 {
 
     return g_job_system.pending_queue.count;
 }
+
+const TestTree = struct {
+    depth: u32,
+    leaves: *std.atomic.Value(u32),
+    max_running: *std.atomic.Value(u32),
+    running: *std.atomic.Value(u32),
+
+    /// Spawns two children and waits for them inside the job.
+    fn run(data: ?*anyopaque) callconv(.c) i32 {
+        const self: *TestTree = @ptrCast(@alignCast(data.?));
+        const now = self.running.fetchAdd(1, .monotonic) + 1;
+        _ = self.max_running.fetchMax(now, .monotonic);
+        defer _ = self.running.fetchSub(1, .monotonic);
+
+        if (self.depth == 0) {
+            _ = self.leaves.fetchAdd(1, .monotonic);
+            return 0;
+        }
+
+        var children: [2]TestTree = undefined;
+        var jobs: [2]*Job = undefined;
+        for (&children, &jobs) |*child, *job| {
+            child.* = self.*;
+            child.depth = self.depth - 1;
+            job.* = create_job(run, child, .NORMAL) orelse return -1;
+            job.*.push_to_completed_queue = false;
+            while (!submit_job(job.*)) std.Thread.yield() catch {};
+        }
+        wait_for_jobs(&jobs);
+        for (jobs) |job| free_job(job);
+        return 0;
+    }
+};
+
+test "fiber jobs wait on nested jobs without holding their worker" {
+    if (!fiber.supported) return error.SkipZigTest;
+    memory.cardinal_memory_init(1024 * 1024);
+    defer memory.cardinal_memory_shutdown();
+
+    // Each waiting level would pin a worker if waits blocked; one worker cannot get past the root.
+    const config = JobSystemConfig{
+        .worker_thread_count = 1,
+        .max_queue_size = 256,
+        .enable_priority_queue = false,
+        .enable_fibers = true,
+        .fiber_stack_size = 64 * 1024,
+        .fiber_count = 32,
+    };
+    try std.testing.expect(init(&config));
+    defer shutdown();
+    try std.testing.expect(fibers_enabled());
+
+    var leaves = std.atomic.Value(u32).init(0);
+    var running = std.atomic.Value(u32).init(0);
+    var max_running = std.atomic.Value(u32).init(0);
+    var root = TestTree{ .depth = 4, .leaves = &leaves, .max_running = &max_running, .running = &running };
+    const job = create_job(TestTree.run, &root, .NORMAL).?;
+    job.push_to_completed_queue = false;
+    try std.testing.expect(submit_job(job));
+    wait_for_jobs(&.{job});
+
+    try std.testing.expectEqual(JobStatus.COMPLETED, get_status(job));
+    free_job(job);
+    try std.testing.expectEqual(@as(u32, 16), leaves.load(.monotonic));
+    // Every level was in flight at once on the single worker.
+    try std.testing.expect(max_running.load(.monotonic) >= 5);
+}
+
+const TestCounterJob = struct {
+    counter: *Counter,
+    sum: *std.atomic.Value(u32),
+    value: u32,
+
+    fn run(data: ?*anyopaque) callconv(.c) i32 {
+        const self: *TestCounterJob = @ptrCast(@alignCast(data.?));
+        _ = self.sum.fetchAdd(self.value, .monotonic);
+        self.counter.done();
+        return 0;
+    }
+};
+
+test "await_counter returns once every piece is done" {
+    memory.cardinal_memory_init(1024 * 1024);
+    defer memory.cardinal_memory_shutdown();
+
+    const config = JobSystemConfig{
+        .worker_thread_count = 2,
+        .max_queue_size = 64,
+        .enable_priority_queue = false,
+        .enable_fibers = fiber.supported,
+    };
+    try std.testing.expect(init(&config));
+    defer shutdown();
+
+    var counter = Counter{};
+    var sum = std.atomic.Value(u32).init(0);
+    var pieces: [8]TestCounterJob = undefined;
+    var jobs: [8]*Job = undefined;
+    counter.add(pieces.len);
+    for (&pieces, &jobs, 0..) |*piece, *job, i| {
+        piece.* = .{ .counter = &counter, .sum = &sum, .value = @intCast(i + 1) };
+        job.* = create_job(TestCounterJob.run, piece, .NORMAL).?;
+        job.*.push_to_completed_queue = false;
+        try std.testing.expect(submit_job(job.*));
+    }
+    await_counter(&counter);
+
+    try std.testing.expect(counter.is_done());
+    try std.testing.expectEqual(@as(u32, 36), sum.load(.monotonic));
+    wait_for_jobs(&jobs);
+    for (jobs) |job| free_job(job);
+}
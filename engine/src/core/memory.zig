@@ -26,6 +26,10 @@ const ArenaState = extern struct {
     backing: *CardinalAllocator,
     current_block: ?*ArenaBlock,
     default_block_size: usize,
+    /// Allocations served since the last reset/rewind.
+    allocation_count: usize,
+    /// Bytes handed out since the last reset/rewind (excluding alignment padding).
+    allocated_bytes: usize,
 };
 
 const ArenaBlock = extern struct {
@@ -56,6 +60,24 @@ pub const CardinalGlobalMemoryStats = extern struct {
     total: CardinalMemoryStats,
 };
 
+/// Allocation activity of the most recently completed frame (see `cardinal_memory_begin_frame`).
+pub const CardinalFrameMemoryStats = extern struct {
+    /// Index of the frame these numbers describe.
+    frame_index: u64,
+    /// Tracked (general-heap) allocations made during the frame, across all categories.
+    heap_allocation_count: usize,
+    /// Bytes requested from tracked allocators during the frame.
+    heap_allocated_bytes: usize,
+    /// Tracked frees made during the frame.
+    heap_free_count: usize,
+    /// Allocations served by the frame arena.
+    frame_arena_allocation_count: usize,
+    /// Bytes served by the frame arena.
+    frame_arena_bytes: usize,
+    /// Bytes currently reserved by the frame arena's blocks.
+    frame_arena_capacity: usize,
+};
+
 /// C-ABI allocator interface used across the engine.
 pub const CardinalAllocator = extern struct {
     type: CardinalAllocatorType,
@@ -99,16 +121,18 @@ pub const CardinalAllocator = extern struct {
             .DYNAMIC => {
                 const max_align = @alignOf(c_longdouble);
                 if (alignment <= max_align) {
-                    if (find_alloc(buf.ptr)) |info| {
-                        if (info.is_aligned) return false;
-
-                        if (platform.expand(buf.ptr, new_len)) |_| {
-                            const old_size = info.size;
-                            if (update_tracked_alloc_size(buf.ptr, new_len)) {
-                                stats_on_resize(self.category, old_size, new_len);
-                            }
-                            return true;
-                        }
+                    const ptr: *anyopaque = @ptrCast(buf.ptr);
+                    const header = block_header(ptr);
+                    if (header.is_aligned) return false;
+                    if (header.size_class != NO_SIZE_CLASS) {
+                        return resize_in_size_class(ptr, self.category, new_len);
+                    }
+
+                    if (platform.expand(block_base(ptr), BLOCK_HEADER_SIZE + new_len)) |_| {
+                        const old_size = header.size;
+                        set_block_size(ptr, new_len);
+                        stats_on_resize(self.category, old_size, new_len);
+                        return true;
                     }
                 }
                 return false;
@@ -129,6 +153,29 @@ pub const CardinalAllocator = extern struct {
                 }
                 return false;
             },
+            .ARENA => {
+                const st: *ArenaState = @ptrCast(@alignCast(self.state));
+                const block = st.current_block orelse return false;
+                const buf_end = @intFromPtr(buf.ptr) + buf.len;
+                const top = @intFromPtr(block.data) + block.offset;
+
+                if (buf_end == top) {
+                    const start = @intFromPtr(buf.ptr) - @intFromPtr(block.data);
+                    if (start + new_len <= block.capacity) {
+                        block.offset = start + new_len;
+                        return true;
+                    }
+                } else if (new_len <= buf.len) {
+                    return true;
+                }
+                return false;
+            },
+            .TRACKED => {
+                const ts: *TrackedState = @ptrCast(@alignCast(self.state));
+                const max_align = @alignOf(c_longdouble);
+                if (ts.backing.type != .DYNAMIC or alignment > max_align) return false;
+                return resize_in_size_class(@ptrCast(buf.ptr), ts.category, new_len);
+            },
             else => return false,
         }
     }
@@ -168,24 +215,111 @@ const TrackedState = extern struct {
     category: CardinalMemoryCategory,
 };
 
+/// Sentinel `AllocInfo.size_class` value for blocks that bypass the thread-local cache.
+const NO_SIZE_CLASS: u8 = 0xFF;
+
+/// Prefix stored in front of every dynamic-allocator block.
+///
+/// It carries everything `free`/`realloc` need, so size-class blocks never touch the
+/// live-allocation map. Only blocks served by malloc directly, and size-class blocks whose stack
+/// was sampled, are recorded there (`in_map`) for leak reports.
+const BlockHeader = extern struct {
+    /// Requested size in bytes.
+    size: usize,
+    /// Distance from the underlying malloc/aligned_alloc pointer to the user pointer.
+    offset: u32,
+    size_class: u8,
+    is_aligned: bool,
+    in_map: bool,
+    reserved: u8 = 0,
+};
+
+/// Bytes reserved in front of each dynamic block; keeps the user pointer at natural alignment.
+const BLOCK_HEADER_SIZE: usize = std.mem.alignForward(usize, @sizeOf(BlockHeader), @alignOf(c_longdouble));
+
+/// Sampled allocation call stack (only captured when stack sampling is enabled).
+const StackSample = struct {
+    addresses: [16]usize,
+    depth: usize,
+};
+
 /// Per-allocation tracking record (debugging/statistics).
 const AllocInfo = struct {
     ptr: ?*anyopaque,
     size: usize,
     is_aligned: bool,
-    in_use: bool,
-    stack_addresses: [16]usize,
-    stack_depth: usize,
+    size_class: u8,
+    stack: ?*StackSample,
+};
+
+/// Number of independently locked allocation-map shards (power of two).
+const ALLOC_MAP_SHARD_COUNT: usize = 64;
+
+/// One slice of the live-allocation map; shards are selected by address hash.
+const AllocMapShard = struct {
+    lock: std.Thread.Mutex align(std.atomic.cache_line) = .{},
+    map: std.AutoHashMapUnmanaged(usize, AllocInfo) = .{},
+};
+
+/// Number of statistics shards; threads are assigned round-robin on first use.
+const STAT_SHARD_COUNT: usize = 32;
+
+/// Monotonic per-category counters; current usage is `allocated_bytes - freed_bytes`.
+const StatCounters = struct {
+    allocated_bytes: std.atomic.Value(usize) = std.atomic.Value(usize).init(0),
+    freed_bytes: std.atomic.Value(usize) = std.atomic.Value(usize).init(0),
+    allocation_count: std.atomic.Value(usize) = std.atomic.Value(usize).init(0),
+    free_count: std.atomic.Value(usize) = std.atomic.Value(usize).init(0),
+};
+
+const StatShard = struct {
+    categories: [CATEGORY_SLOT_COUNT]StatCounters align(std.atomic.cache_line) = [_]StatCounters{.{}} ** CATEGORY_SLOT_COUNT,
+};
+
+/// Allocations per shard between peak-usage refreshes on the allocating thread.
+const PEAK_REFRESH_INTERVAL: usize = 1024;
+
+/// Smallest cached size class in bytes; classes double up to `SIZE_CLASS_MAX_BYTES`.
+const SIZE_CLASS_MIN_BYTES: usize = 16;
+const SIZE_CLASS_MAX_BYTES: usize = 2048;
+const SIZE_CLASS_COUNT: usize = 8;
+/// Maximum number of blocks retained per size class per thread.
+const SIZE_CLASS_CACHE_DEPTH: u32 = 128;
+
+const CachedBlock = struct {
+    next: ?*CachedBlock,
+};
+
+/// Per-thread free lists for small dynamic allocations.
+///
+/// Only threads that opt in with `cardinal_memory_enable_thread_cache` (and therefore promise to
+/// call `cardinal_memory_flush_thread_cache` before exiting) cache blocks; every other thread
+/// allocates and frees size-class blocks straight through malloc, so nothing is stranded when it
+/// exits.
+const ThreadCache = struct {
+    enabled: bool = false,
+    heads: [SIZE_CLASS_COUNT]?*CachedBlock = [_]?*CachedBlock{null} ** SIZE_CLASS_COUNT,
+    counts: [SIZE_CLASS_COUNT]u32 = [_]u32{0} ** SIZE_CLASS_COUNT,
 };
 
 /// Global memory statistics and allocator state.
-var g_stats: CardinalGlobalMemoryStats = std.mem.zeroes(CardinalGlobalMemoryStats);
-var g_alloc_map: std.AutoHashMap(usize, AllocInfo) = undefined;
-var g_alloc_map_lock: std.Thread.RwLock = .{};
-var g_alloc_map_init: bool = false;
-var g_active_allocs: usize = 0;
+var g_stat_shards: [STAT_SHARD_COUNT]StatShard = [_]StatShard{.{}} ** STAT_SHARD_COUNT;
+/// Peak usage per category; the extra trailing slot holds the total.
+var g_peak_usage: [CATEGORY_SLOT_COUNT + 1]std.atomic.Value(usize) = [_]std.atomic.Value(usize){std.atomic.Value(usize).init(0)} ** (CATEGORY_SLOT_COUNT + 1);
+var g_next_stat_shard = std.atomic.Value(u32).init(0);
+threadlocal var t_stat_shard_index: u32 = std.math.maxInt(u32);
+
+var g_alloc_shards: [ALLOC_MAP_SHARD_COUNT]AllocMapShard = [_]AllocMapShard{.{}} ** ALLOC_MAP_SHARD_COUNT;
 var g_initialized: bool = false;
 
+/// Stack sampling configuration: capture every Nth allocation (0 = off) and/or any allocation
+/// of at least `g_stack_sample_min_size` bytes (0 = off).
+var g_stack_sample_interval = std.atomic.Value(u32).init(0);
+var g_stack_sample_min_size = std.atomic.Value(usize).init(0);
+threadlocal var t_stack_sample_countdown: u32 = 0;
+
+threadlocal var t_thread_cache: ThreadCache = .{};
+
 var g_dynamic_state: DynamicState = .{ .placeholder = 0 };
 var g_linear_state: LinearState = undefined;
 var g_arena_state: ArenaState = undefined;
@@ -196,150 +330,215 @@ var g_linear: CardinalAllocator = undefined;
 var g_arena: CardinalAllocator = undefined;
 var g_tracked: [CATEGORY_SLOT_COUNT]CardinalAllocator = undefined;
 
-/// Updates stats on allocation.
-fn stats_on_alloc(cat: CardinalMemoryCategory, size: usize) void {
-    var category = cat;
-    if (@intFromEnum(category) >= @intFromEnum(CardinalMemoryCategory.MAX)) {
-        category = .UNKNOWN;
-    }
-
-    const cat_idx = @as(usize, @intCast(@intFromEnum(category)));
-    g_stats.categories[cat_idx].total_allocated += size;
-    g_stats.categories[cat_idx].current_usage += size;
-    if (g_stats.categories[cat_idx].current_usage > g_stats.categories[cat_idx].peak_usage) {
-        g_stats.categories[cat_idx].peak_usage = g_stats.categories[cat_idx].current_usage;
+/// Number of per-frame arenas; allocations stay valid for one extra frame.
+pub const FRAME_ARENA_COUNT: usize = 2;
+/// Initial block size for per-frame and per-thread scratch arenas.
+const FRAME_ARENA_BLOCK_SIZE: usize = 1024 * 1024;
+const SCRATCH_ARENA_BLOCK_SIZE: usize = 256 * 1024;
+
+var g_frame_arena_state: [FRAME_ARENA_COUNT]ArenaState = undefined;
+var g_frame_arenas: [FRAME_ARENA_COUNT]CardinalAllocator = undefined;
+var g_frame_index: u64 = 0;
+var g_frame_stats: CardinalFrameMemoryStats = std.mem.zeroes(CardinalFrameMemoryStats);
+/// Aggregated (allocation_count, total_allocated, free_count) at the start of the current frame.
+var g_frame_heap_baseline: [3]usize = .{ 0, 0, 0 };
+
+threadlocal var t_scratch_arena: ?*CardinalAllocator = null;
+threadlocal var t_scratch_depth: u32 = 0;
+
+fn category_index(cat: CardinalMemoryCategory) usize {
+    if (@intFromEnum(cat) < 0 or @intFromEnum(cat) >= @intFromEnum(CardinalMemoryCategory.MAX)) {
+        return @as(usize, @intCast(@intFromEnum(CardinalMemoryCategory.UNKNOWN)));
     }
-    g_stats.categories[cat_idx].allocation_count += 1;
+    return @as(usize, @intCast(@intFromEnum(cat)));
+}
 
-    g_stats.total.total_allocated += size;
-    g_stats.total.current_usage += size;
-    if (g_stats.total.current_usage > g_stats.total.peak_usage) {
-        g_stats.total.peak_usage = g_stats.total.current_usage;
+/// Returns the statistics shard owned by the calling thread.
+fn current_stat_shard() *StatShard {
+    if (t_stat_shard_index == std.math.maxInt(u32)) {
+        t_stat_shard_index = g_next_stat_shard.fetchAdd(1, .monotonic) % @as(u32, STAT_SHARD_COUNT);
     }
-    g_stats.total.allocation_count += 1;
+    return &g_stat_shards[t_stat_shard_index];
 }
 
-fn stats_on_free(cat: CardinalMemoryCategory, size: usize) void {
-    var category = cat;
-    if (@intFromEnum(category) >= @intFromEnum(CardinalMemoryCategory.MAX)) {
-        category = .UNKNOWN;
+/// Sums one category across all shards.
+fn aggregate_category(cat_idx: usize) CardinalMemoryStats {
+    var out = std.mem.zeroes(CardinalMemoryStats);
+    var freed: usize = 0;
+    for (&g_stat_shards) |*shard| {
+        const counters = &shard.categories[cat_idx];
+        // Read frees before allocations so a concurrent alloc/free pair cannot underflow.
+        freed += counters.freed_bytes.load(.monotonic);
+        out.free_count += counters.free_count.load(.monotonic);
+        out.total_allocated += counters.allocated_bytes.load(.monotonic);
+        out.allocation_count += counters.allocation_count.load(.monotonic);
     }
+    out.current_usage = out.total_allocated -| freed;
+    return out;
+}
 
-    const cat_idx = @as(usize, @intCast(@intFromEnum(category)));
-    if (g_stats.categories[cat_idx].current_usage >= size) {
-        g_stats.categories[cat_idx].current_usage -= size;
-    } else {
-        g_stats.categories[cat_idx].current_usage = 0;
-    }
-    g_stats.categories[cat_idx].free_count += 1;
+/// Folds current usage of `cat_idx` and of the total into the peak trackers.
+fn refresh_peak(cat_idx: usize) void {
+    const cat_usage = aggregate_category(cat_idx).current_usage;
+    _ = g_peak_usage[cat_idx].fetchMax(cat_usage, .monotonic);
 
-    if (g_stats.total.current_usage >= size) {
-        g_stats.total.current_usage -= size;
-    } else {
-        g_stats.total.current_usage = 0;
+    var total_usage: usize = 0;
+    var i: usize = 0;
+    while (i < CATEGORY_SLOT_COUNT) : (i += 1) {
+        total_usage += aggregate_category(i).current_usage;
     }
-    g_stats.total.free_count += 1;
+    _ = g_peak_usage[CATEGORY_SLOT_COUNT].fetchMax(total_usage, .monotonic);
 }
 
-fn stats_on_resize(cat: CardinalMemoryCategory, old_size: usize, new_size: usize) void {
-    var category = cat;
-    if (@intFromEnum(category) >= @intFromEnum(CardinalMemoryCategory.MAX)) {
-        category = .UNKNOWN;
+/// Updates stats on allocation.
+///
+/// Counters live in the calling thread's shard; peak usage is refreshed every
+/// `PEAK_REFRESH_INTERVAL` allocations and whenever stats are read.
+fn stats_on_alloc(cat: CardinalMemoryCategory, size: usize) void {
+    const cat_idx = category_index(cat);
+    const counters = &current_stat_shard().categories[cat_idx];
+    _ = counters.allocated_bytes.fetchAdd(size, .monotonic);
+    const count = counters.allocation_count.fetchAdd(1, .monotonic);
+    if (count % PEAK_REFRESH_INTERVAL == 0) {
+        refresh_peak(cat_idx);
     }
+}
 
-    const cat_idx = @as(usize, @intCast(@intFromEnum(category)));
+fn stats_on_free(cat: CardinalMemoryCategory, size: usize) void {
+    const counters = &current_stat_shard().categories[category_index(cat)];
+    _ = counters.freed_bytes.fetchAdd(size, .monotonic);
+    _ = counters.free_count.fetchAdd(1, .monotonic);
+}
 
+fn stats_on_resize(cat: CardinalMemoryCategory, old_size: usize, new_size: usize) void {
+    const counters = &current_stat_shard().categories[category_index(cat)];
     if (new_size > old_size) {
-        const diff = new_size - old_size;
-        g_stats.categories[cat_idx].total_allocated += diff;
-        g_stats.categories[cat_idx].current_usage += diff;
-        if (g_stats.categories[cat_idx].current_usage > g_stats.categories[cat_idx].peak_usage) {
-            g_stats.categories[cat_idx].peak_usage = g_stats.categories[cat_idx].current_usage;
-        }
-
-        g_stats.total.total_allocated += diff;
-        g_stats.total.current_usage += diff;
-        if (g_stats.total.current_usage > g_stats.total.peak_usage) {
-            g_stats.total.peak_usage = g_stats.total.current_usage;
-        }
+        _ = counters.allocated_bytes.fetchAdd(new_size - old_size, .monotonic);
     } else if (old_size > new_size) {
-        const diff = old_size - new_size;
-        if (g_stats.categories[cat_idx].current_usage >= diff) {
-            g_stats.categories[cat_idx].current_usage -= diff;
-        } else {
-            g_stats.categories[cat_idx].current_usage = 0;
-        }
-        if (g_stats.total.current_usage >= diff) {
-            g_stats.total.current_usage -= diff;
-        } else {
-            g_stats.total.current_usage = 0;
-        }
+        _ = counters.freed_bytes.fetchAdd(old_size - new_size, .monotonic);
     }
 }
 
 /// Copies current memory statistics into `out_stats` (no-op if null).
+///
+/// Aggregates all per-thread shards; concurrent allocations may be partially reflected.
 pub export fn cardinal_memory_get_stats(out_stats: ?*CardinalGlobalMemoryStats) void {
     if (out_stats) |s| {
-        s.* = g_stats;
+        s.* = std.mem.zeroes(CardinalGlobalMemoryStats);
+        var i: usize = 0;
+        while (i < CATEGORY_SLOT_COUNT) : (i += 1) {
+            var cat = aggregate_category(i);
+            _ = g_peak_usage[i].fetchMax(cat.current_usage, .monotonic);
+            cat.peak_usage = g_peak_usage[i].load(.monotonic);
+            s.categories[i] = cat;
+
+            s.total.total_allocated += cat.total_allocated;
+            s.total.current_usage += cat.current_usage;
+            s.total.allocation_count += cat.allocation_count;
+            s.total.free_count += cat.free_count;
+        }
+        _ = g_peak_usage[CATEGORY_SLOT_COUNT].fetchMax(s.total.current_usage, .monotonic);
+        s.total.peak_usage = g_peak_usage[CATEGORY_SLOT_COUNT].load(.monotonic);
     }
 }
 
 /// Resets global memory statistics counters.
 pub export fn cardinal_memory_reset_stats() void {
-    g_stats = std.mem.zeroes(CardinalGlobalMemoryStats);
+    for (&g_stat_shards) |*shard| {
+        for (&shard.categories) |*counters| {
+            counters.allocated_bytes.store(0, .monotonic);
+            counters.freed_bytes.store(0, .monotonic);
+            counters.allocation_count.store(0, .monotonic);
+            counters.free_count.store(0, .monotonic);
+        }
+    }
+    for (&g_peak_usage) |*peak| {
+        peak.store(0, .monotonic);
+    }
+}
+
+/// Configures sampled stack capture for live-allocation records.
+///
+/// `interval` captures every Nth allocation per thread and `min_size` captures every allocation
+/// of at least that many bytes; zero disables the respective trigger.
+pub export fn cardinal_memory_set_stack_sampling(interval: u32, min_size: usize) void {
+    g_stack_sample_interval.store(interval, .monotonic);
+    g_stack_sample_min_size.store(min_size, .monotonic);
 }
 
-/// Internal allocation tracking map initialization.
-fn ensure_alloc_map() void {
-    if (!g_alloc_map_init) {
-        g_alloc_map = std.AutoHashMap(usize, AllocInfo).init(std.heap.c_allocator);
-        g_alloc_map_init = true;
+fn should_sample_stack(size: usize) bool {
+    const min_size = g_stack_sample_min_size.load(.monotonic);
+    if (min_size > 0 and size >= min_size) return true;
+
+    const interval = g_stack_sample_interval.load(.monotonic);
+    if (interval == 0) return false;
+    if (t_stack_sample_countdown == 0 or t_stack_sample_countdown > interval) {
+        t_stack_sample_countdown = interval;
     }
+    t_stack_sample_countdown -= 1;
+    return t_stack_sample_countdown == 0;
+}
+
+fn capture_stack_sample() ?*StackSample {
+    const raw = c.malloc(@sizeOf(StackSample)) orelse return null;
+    const sample: *StackSample = @ptrCast(@alignCast(raw));
+    @memset(&sample.addresses, 0);
+
+    var stack: [16]?*anyopaque = undefined;
+    const count = platform.capture_stack_back_trace(0, 16, &stack, null);
+    if (count > 0) {
+        var i: usize = 0;
+        while (i < count) : (i += 1) {
+            sample.addresses[i] = @intFromPtr(stack[i]);
+        }
+        sample.depth = count;
+    } else {
+        sample.addresses[0] = @returnAddress();
+        sample.depth = 1;
+    }
+    return sample;
+}
+
+fn release_stack_sample(sample: ?*StackSample) void {
+    if (sample) |s| c.free(s);
+}
+
+fn alloc_shard(addr: usize) *AllocMapShard {
+    // Allocations are at least 16-byte aligned; mix higher bits so neighbours spread out.
+    const h = (addr >> 4) ^ (addr >> 12) ^ (addr >> 20);
+    return &g_alloc_shards[h & (ALLOC_MAP_SHARD_COUNT - 1)];
 }
 
 /// Tracks a live allocation for debugging and per-category statistics.
 ///
-/// Stack trace capture is intentionally disabled by default for performance.
-fn track_alloc(ptr: ?*anyopaque, size: usize, is_aligned: bool) void {
+/// Stack traces are only captured for sampled allocations (see
+/// `cardinal_memory_set_stack_sampling`).
+fn track_alloc(ptr: ?*anyopaque, size: usize, is_aligned: bool, size_class: u8) void {
     if (ptr == null) return;
+    track_alloc_with_stack(ptr, size, is_aligned, size_class, if (should_sample_stack(size)) capture_stack_sample() else null);
+}
 
-    g_alloc_map_lock.lock();
-    defer g_alloc_map_lock.unlock();
-
-    ensure_alloc_map();
-
-    const addr = @intFromPtr(ptr);
-    var info = AllocInfo{
+fn track_alloc_with_stack(ptr: ?*anyopaque, size: usize, is_aligned: bool, size_class: u8, stack: ?*StackSample) void {
+    const info = AllocInfo{
         .ptr = ptr,
         .size = size,
         .is_aligned = is_aligned,
-        .in_use = true,
-        .stack_addresses = undefined,
-        .stack_depth = 0,
+        .size_class = size_class,
+        .stack = stack,
     };
-    @memset(&info.stack_addresses, 0);
 
-    const enable_stack_trace = false;
-    if (builtin.mode == .Debug and enable_stack_trace) {
-        var stack: [16]?*anyopaque = undefined;
-        const count = platform.capture_stack_back_trace(0, 16, &stack, null);
-
-        if (count > 0) {
-            var i: usize = 0;
-            while (i < count) : (i += 1) {
-                info.stack_addresses[i] = @intFromPtr(stack[i]);
-            }
-            info.stack_depth = count;
-        } else {
-            info.stack_addresses[0] = @returnAddress();
-            info.stack_depth = 1;
-        }
-    }
+    const addr = @intFromPtr(ptr);
+    const shard = alloc_shard(addr);
+    shard.lock.lock();
+    defer shard.lock.unlock();
 
-    g_alloc_map.put(addr, info) catch |err| {
+    const gop = shard.map.getOrPut(std.heap.c_allocator, addr) catch |err| {
         _ = c.printf("Cardinal Memory Error: Failed to track allocation (OOM?): %s\n", @errorName(err).ptr);
+        release_stack_sample(info.stack);
+        return;
     };
-    g_active_allocs = g_alloc_map.count();
+    if (gop.found_existing) release_stack_sample(gop.value_ptr.stack);
+    gop.value_ptr.* = info;
 }
 
 /// Prints captured stack addresses in a stable format for external symbolization.
@@ -354,124 +553,242 @@ fn print_stack_trace(addresses: []const usize, depth: usize) void {
 fn find_alloc(ptr: ?*anyopaque) ?AllocInfo {
     if (ptr == null) return null;
 
-    g_alloc_map_lock.lockShared();
-    defer g_alloc_map_lock.unlockShared();
+    const addr = @intFromPtr(ptr);
+    const shard = alloc_shard(addr);
+    shard.lock.lock();
+    defer shard.lock.unlock();
+
+    return shard.map.get(addr);
+}
 
-    if (!g_alloc_map_init) return null;
+/// Removes the tracking record for `ptr` and returns it (stack sample already released).
+fn untrack_alloc(ptr: ?*anyopaque) ?AllocInfo {
+    if (ptr == null) return null;
 
     const addr = @intFromPtr(ptr);
-    return g_alloc_map.get(addr);
+    const shard = alloc_shard(addr);
+    shard.lock.lock();
+    const removed = shard.map.fetchRemove(addr);
+    shard.lock.unlock();
+
+    if (removed) |kv| {
+        var info = kv.value;
+        release_stack_sample(info.stack);
+        info.stack = null;
+        return info;
+    }
+    return null;
 }
 
-fn untrack_alloc(ptr: ?*anyopaque, out_size: ?*usize, out_is_aligned: ?*bool) bool {
+fn update_tracked_alloc_size(ptr: ?*anyopaque, new_size: usize) bool {
     if (ptr == null) return false;
 
-    g_alloc_map_lock.lock();
-    defer g_alloc_map_lock.unlock();
+    const addr = @intFromPtr(ptr);
+    const shard = alloc_shard(addr);
+    shard.lock.lock();
+    defer shard.lock.unlock();
 
-    if (!g_alloc_map_init) return false;
+    const info = shard.map.getPtr(addr) orelse return false;
+    info.size = new_size;
+    return true;
+}
 
-    const addr = @intFromPtr(ptr);
-    if (g_alloc_map.fetchRemove(addr)) |kv| {
-        if (out_size) |s| s.* = kv.value.size;
-        if (out_is_aligned) |a| a.* = kv.value.is_aligned;
-        g_active_allocs = g_alloc_map.count();
-        return true;
+/// Maps a request size to a cached size class, or null if it is served by malloc directly.
+fn size_class_index(size: usize) ?u8 {
+    if (size == 0 or size > SIZE_CLASS_MAX_BYTES) return null;
+    const rounded = @max(size, SIZE_CLASS_MIN_BYTES);
+    const log2 = std.math.log2_int_ceil(usize, rounded);
+    return @intCast(log2 - std.math.log2_int(usize, SIZE_CLASS_MIN_BYTES));
+}
+
+fn size_class_bytes(class: u8) usize {
+    return SIZE_CLASS_MIN_BYTES << @intCast(class);
+}
+
+fn thread_cache_pop(class: u8) ?*anyopaque {
+    if (!t_thread_cache.enabled) return null;
+    const head = t_thread_cache.heads[class] orelse return null;
+    t_thread_cache.heads[class] = head.next;
+    t_thread_cache.counts[class] -= 1;
+    return head;
+}
+
+fn thread_cache_push(class: u8, ptr: *anyopaque) void {
+    if (!t_thread_cache.enabled or t_thread_cache.counts[class] >= SIZE_CLASS_CACHE_DEPTH) {
+        c.free(ptr);
+        return;
     }
-    return false;
+    const block: *CachedBlock = @ptrCast(@alignCast(ptr));
+    block.next = t_thread_cache.heads[class];
+    t_thread_cache.heads[class] = block;
+    t_thread_cache.counts[class] += 1;
 }
 
-fn update_tracked_alloc_size(ptr: ?*anyopaque, new_size: usize) bool {
-    if (ptr == null) return false;
+/// Lets the calling thread keep freed size-class blocks in its own free lists.
+///
+/// The caller must call `cardinal_memory_flush_thread_cache` before the thread exits. The job
+/// system and I/O service workers do this; `cardinal_memory_init` enables it for the init thread,
+/// whose cache `cardinal_memory_shutdown` flushes.
+pub export fn cardinal_memory_enable_thread_cache() void {
+    t_thread_cache.enabled = true;
+}
+
+/// Returns every block cached by the calling thread (size-class lists and scratch arena) and
+/// disables its size-class cache until it is enabled again.
+///
+/// Threads that enabled the cache call this before exiting; cached blocks are otherwise retained
+/// for reuse.
+pub export fn cardinal_memory_flush_thread_cache() void {
+    if (t_scratch_arena) |scratch| {
+        std.debug.assert(t_scratch_depth == 0);
+        cardinal_arena_destroy(scratch);
+        t_scratch_arena = null;
+    }
 
-    g_alloc_map_lock.lock();
-    defer g_alloc_map_lock.unlock();
+    var class: usize = 0;
+    while (class < SIZE_CLASS_COUNT) : (class += 1) {
+        var curr = t_thread_cache.heads[class];
+        while (curr) |block| {
+            curr = block.next;
+            c.free(block);
+        }
+        t_thread_cache.heads[class] = null;
+        t_thread_cache.counts[class] = 0;
+    }
+    t_thread_cache.enabled = false;
+}
 
-    if (!g_alloc_map_init) return false;
+fn block_header(ptr: *anyopaque) *BlockHeader {
+    return @ptrFromInt(@intFromPtr(ptr) - BLOCK_HEADER_SIZE);
+}
 
-    const addr = @intFromPtr(ptr);
-    const info = g_alloc_map.getPtr(addr) orelse return false;
-    info.size = new_size;
+fn block_base(ptr: *anyopaque) *anyopaque {
+    return @ptrFromInt(@intFromPtr(ptr) - block_header(ptr).offset);
+}
+
+/// Writes the header for a freshly obtained block and returns the user pointer.
+///
+/// Size-class blocks are only entered into the live-allocation map when their stack is sampled,
+/// which keeps the cache-hit path free of shard locks.
+fn place_block(base: *anyopaque, header: BlockHeader) *anyopaque {
+    const ptr: *anyopaque = @ptrFromInt(@intFromPtr(base) + header.offset);
+    const h = block_header(ptr);
+    h.* = header;
+
+    const stack = if (should_sample_stack(header.size)) capture_stack_sample() else null;
+    h.in_map = header.size_class == NO_SIZE_CLASS or stack != null;
+    if (h.in_map) track_alloc_with_stack(ptr, header.size, header.is_aligned, header.size_class, stack);
+    return ptr;
+}
+
+fn set_block_size(ptr: *anyopaque, new_size: usize) void {
+    const header = block_header(ptr);
+    header.size = new_size;
+    if (header.in_map) _ = update_tracked_alloc_size(ptr, new_size);
+}
+
+/// Attempts to grow or shrink a size-class block in place, updating stats for `cat`.
+fn resize_in_size_class(ptr: *anyopaque, cat: ?CardinalMemoryCategory, new_len: usize) bool {
+    const header = block_header(ptr);
+    if (header.size_class == NO_SIZE_CLASS) return false;
+    if (new_len == 0 or new_len > size_class_bytes(header.size_class)) return false;
+    const old_size = header.size;
+    set_block_size(ptr, new_len);
+    if (cat) |category| stats_on_resize(category, old_size, new_len);
     return true;
 }
 
 /// Dynamic allocator implementation.
+///
+/// Small, naturally aligned requests are rounded to a size class and served from the calling
+/// thread's cache before falling back to malloc. Every block carries a `BlockHeader`.
 fn dyn_alloc(_: *CardinalAllocator, size: usize, alignment: usize) callconv(.c) ?*anyopaque {
-    var ptr: ?*anyopaque = null;
-    var is_aligned = false;
+    var header = BlockHeader{
+        .size = size,
+        .offset = BLOCK_HEADER_SIZE,
+        .size_class = NO_SIZE_CLASS,
+        .is_aligned = false,
+        .in_map = false,
+    };
+    var base: ?*anyopaque = null;
 
     const max_align = @alignOf(c_longdouble);
 
     if (alignment > 0 and alignment > max_align) {
-        is_aligned = true;
-        ptr = platform.aligned_alloc(size, alignment);
+        // The user pointer sits one alignment unit into the block, leaving room for the header.
+        header.is_aligned = true;
+        header.offset = @intCast(alignment);
+        base = platform.aligned_alloc(size + alignment, alignment);
+    } else if (size_class_index(size)) |class| {
+        header.size_class = class;
+        base = thread_cache_pop(class) orelse c.malloc(BLOCK_HEADER_SIZE + size_class_bytes(class));
     } else {
-        ptr = c.malloc(size);
+        base = c.malloc(BLOCK_HEADER_SIZE + size);
     }
 
-    if (ptr != null) {
-        track_alloc(ptr, size, is_aligned);
-    }
-    return ptr;
+    return place_block(base orelse return null, header);
 }
 
-fn dyn_realloc(self: *CardinalAllocator, ptr: ?*anyopaque, old_size: usize, new_size: usize, alignment: usize) callconv(.c) ?*anyopaque {
-    if (ptr == null) {
-        return dyn_alloc(self, new_size, alignment);
-    }
-
-    var tracked_old_size: usize = 0;
-    var is_aligned = false;
-    const was_tracked = untrack_alloc(ptr, &tracked_old_size, &is_aligned);
+/// Realloc for the dynamic allocator; reports the tracked old size through `out_old_size`.
+fn dyn_realloc_sized(self: *CardinalAllocator, ptr: ?*anyopaque, old_size: usize, new_size: usize, alignment: usize, out_old_size: *usize) ?*anyopaque {
+    _ = old_size;
+    out_old_size.* = 0;
+    const old_ptr = ptr orelse return dyn_alloc(self, new_size, alignment);
 
-    const actual_old_size = if (was_tracked) tracked_old_size else old_size;
+    const old = block_header(old_ptr).*;
+    out_old_size.* = old.size;
     const max_align = @alignOf(c_longdouble);
 
-    var new_ptr: ?*anyopaque = null;
-    if (is_aligned or (alignment > 0 and alignment > max_align)) {
-        new_ptr = dyn_alloc(self, new_size, alignment);
-        if (new_ptr != null) {
-            if (actual_old_size > 0) {
-                const copy_size = if (actual_old_size < new_size) actual_old_size else new_size;
-                _ = c.memcpy(new_ptr, ptr, copy_size);
-            }
+    if (old.size_class != NO_SIZE_CLASS and new_size > 0 and new_size <= size_class_bytes(old.size_class) and alignment <= max_align) {
+        set_block_size(old_ptr, new_size);
+        return old_ptr;
+    }
 
-            if (is_aligned) {
-                platform.aligned_free(ptr);
-            } else {
-                c.free(ptr);
-            }
-        } else {
-            if (was_tracked) {
-                track_alloc(ptr, actual_old_size, is_aligned);
-            }
-        }
-    } else {
-        new_ptr = c.realloc(ptr, new_size);
-        if (new_ptr != null) {
-            track_alloc(new_ptr, new_size, false);
-        } else {
-            if (was_tracked) {
-                track_alloc(ptr, actual_old_size, is_aligned);
-            }
-        }
+    if (old.is_aligned or old.size_class != NO_SIZE_CLASS or (alignment > 0 and alignment > max_align)) {
+        const new_ptr = dyn_alloc(self, new_size, alignment) orelse return null;
+        const copy_size = @min(old.size, new_size);
+        if (copy_size > 0) _ = c.memcpy(new_ptr, old_ptr, copy_size);
+        _ = dyn_release(old_ptr);
+        return new_ptr;
     }
 
+    // Drop the record before realloc so a concurrent allocation reusing the old address cannot
+    // have its record removed afterwards.
+    if (old.in_map) _ = untrack_alloc(old_ptr);
+    const new_base = c.realloc(block_base(old_ptr), BLOCK_HEADER_SIZE + new_size) orelse {
+        if (old.in_map) track_alloc(old_ptr, old.size, false, NO_SIZE_CLASS);
+        return null;
+    };
+    const new_ptr: *anyopaque = @ptrFromInt(@intFromPtr(new_base) + BLOCK_HEADER_SIZE);
+    block_header(new_ptr).size = new_size;
+    if (old.in_map) track_alloc(new_ptr, new_size, false, NO_SIZE_CLASS);
     return new_ptr;
 }
 
-fn dyn_free(_: *CardinalAllocator, ptr: ?*anyopaque) callconv(.c) void {
-    if (ptr == null) return;
-
-    var size: usize = 0;
-    var is_aligned = false;
-    const was_tracked = untrack_alloc(ptr, &size, &is_aligned);
+fn dyn_realloc(self: *CardinalAllocator, ptr: ?*anyopaque, old_size: usize, new_size: usize, alignment: usize) callconv(.c) ?*anyopaque {
+    var tracked_old_size: usize = 0;
+    return dyn_realloc_sized(self, ptr, old_size, new_size, alignment, &tracked_old_size);
+}
 
-    if (was_tracked and is_aligned) {
-        platform.aligned_free(ptr);
+/// Frees a dynamic allocation and returns its requested size.
+fn dyn_release(ptr: ?*anyopaque) usize {
+    const p = ptr orelse return 0;
+    const header = block_header(p).*;
+    if (header.in_map) _ = untrack_alloc(p);
+
+    const base = block_base(p);
+    if (header.is_aligned) {
+        platform.aligned_free(base);
+    } else if (header.size_class != NO_SIZE_CLASS) {
+        thread_cache_push(header.size_class, base);
     } else {
-        c.free(ptr);
+        c.free(base);
     }
+    return header.size;
+}
+
+fn dyn_free(_: *CardinalAllocator, ptr: ?*anyopaque) callconv(.c) void {
+    _ = dyn_release(ptr);
 }
 
 /// Linear bump allocator implementation.
@@ -542,6 +859,9 @@ fn arena_alloc(self: *CardinalAllocator, size: usize, alignment: usize) callconv
     const st: *ArenaState = @ptrCast(@alignCast(self.state));
     const align_val = if (alignment > 0) alignment else @sizeOf(?*anyopaque);
 
+    st.allocation_count += 1;
+    st.allocated_bytes += size;
+
     if (st.current_block) |block| {
         if (arena_alloc_from_block(block, size, align_val)) |p| return p;
     }
@@ -612,9 +932,50 @@ fn arena_reset(self: *CardinalAllocator) callconv(.c) void {
         curr = next;
     }
     st.current_block = null;
+    st.allocation_count = 0;
+    st.allocated_bytes = 0;
+}
+
+/// Rewinds an arena for reuse without returning its memory to the backing allocator.
+///
+/// When the previous cycle spilled into several blocks they are coalesced into one block of the
+/// combined size, so a steady-state workload settles into a single block and stops allocating.
+fn arena_rewind(self: *CardinalAllocator) void {
+    const st: *ArenaState = @ptrCast(@alignCast(self.state));
+    st.allocation_count = 0;
+    st.allocated_bytes = 0;
+
+    const head = st.current_block orelse return;
+    if (head.next == null) {
+        head.offset = 0;
+        return;
+    }
+
+    var total_capacity: usize = 0;
+    var curr: ?*ArenaBlock = head;
+    while (curr) |block| {
+        const next = block.next;
+        total_capacity += block.capacity;
+        st.backing.free(st.backing, block);
+        curr = next;
+    }
+    st.current_block = arena_create_block(st.backing, total_capacity);
+}
+
+fn arena_capacity(st: *const ArenaState) usize {
+    var total: usize = 0;
+    var curr = st.current_block;
+    while (curr) |block| {
+        total += block.capacity;
+        curr = block.next;
+    }
+    return total;
 }
 
 /// Tracked allocator wrapper that updates per-category statistics.
+///
+/// When backed by the dynamic allocator the backing's block header is reused, so size-class
+/// allocations never touch the live-allocation map.
 fn tracked_alloc(self: *CardinalAllocator, size: usize, alignment: usize) callconv(.c) ?*anyopaque {
     const ts: *TrackedState = @ptrCast(@alignCast(self.state));
     const backing = ts.backing;
@@ -622,25 +983,31 @@ fn tracked_alloc(self: *CardinalAllocator, size: usize, alignment: usize) callco
 
     if (p != null and size > 0) {
         stats_on_alloc(ts.category, size);
-        const max_align = @alignOf(c_longdouble);
-        track_alloc(p, size, alignment > 0 and alignment > max_align);
+        if (backing.type != .DYNAMIC) {
+            const max_align = @alignOf(c_longdouble);
+            track_alloc(p, size, alignment > 0 and alignment > max_align, NO_SIZE_CLASS);
+        }
     }
     return p;
 }
 
 fn tracked_realloc(self: *CardinalAllocator, ptr: ?*anyopaque, old_size: usize, new_size: usize, alignment: usize) callconv(.c) ?*anyopaque {
     const ts: *TrackedState = @ptrCast(@alignCast(self.state));
+    const backing = ts.backing;
 
     var actual_old_size = old_size;
-    if (ptr != null) {
-        if (find_alloc(ptr)) |info| {
-            actual_old_size = info.size;
+    var p: ?*anyopaque = null;
+    if (backing.type == .DYNAMIC) {
+        p = dyn_realloc_sized(backing, ptr, old_size, new_size, alignment, &actual_old_size);
+    } else {
+        if (ptr != null) {
+            if (find_alloc(ptr)) |info| {
+                actual_old_size = info.size;
+            }
         }
+        p = backing.realloc(backing, ptr, actual_old_size, new_size, alignment);
     }
 
-    const backing = ts.backing;
-    const p = backing.realloc(backing, ptr, actual_old_size, new_size, alignment);
-
     if (p != null) {
         if (new_size > actual_old_size) {
             stats_on_alloc(ts.category, new_size - actual_old_size);
@@ -648,22 +1015,29 @@ fn tracked_realloc(self: *CardinalAllocator, ptr: ?*anyopaque, old_size: usize,
             stats_on_free(ts.category, actual_old_size - new_size);
         }
 
-        const max_align = @alignOf(c_longdouble);
-        track_alloc(p, new_size, alignment > 0 and alignment > max_align);
+        if (backing.type != .DYNAMIC) {
+            if (ptr != null and p != ptr) _ = untrack_alloc(ptr);
+            const max_align = @alignOf(c_longdouble);
+            track_alloc(p, new_size, alignment > 0 and alignment > max_align, NO_SIZE_CLASS);
+        }
     }
     return p;
 }
 
 fn tracked_free(self: *CardinalAllocator, ptr: ?*anyopaque) callconv(.c) void {
     const ts: *TrackedState = @ptrCast(@alignCast(self.state));
-    if (ptr != null) {
-        var size: usize = 0;
-        var is_aligned = false;
-        if (untrack_alloc(ptr, &size, &is_aligned)) {
-            stats_on_free(ts.category, size);
-        }
-    }
+    if (ptr == null) return;
+
     const backing = ts.backing;
+    if (backing.type == .DYNAMIC) {
+        const size = dyn_release(ptr);
+        if (size > 0) stats_on_free(ts.category, size);
+        return;
+    }
+
+    if (untrack_alloc(ptr)) |info| {
+        stats_on_free(ts.category, info.size);
+    }
     backing.free(backing, ptr);
 }
 
@@ -678,6 +1052,7 @@ fn tracked_reset(self: *CardinalAllocator) callconv(.c) void {
 /// Initializes global allocators and per-category tracked allocators.
 pub export fn cardinal_memory_init(default_linear_capacity: usize) void {
     cardinal_memory_reset_stats();
+    cardinal_memory_enable_thread_cache();
 
     g_dynamic = .{
         .type = .DYNAMIC,
@@ -716,6 +1091,8 @@ pub export fn cardinal_memory_init(default_linear_capacity: usize) void {
         .backing = &g_dynamic,
         .current_block = null,
         .default_block_size = 4 * 1024 * 1024,
+        .allocation_count = 0,
+        .allocated_bytes = 0,
     };
     g_arena = .{
         .type = .ARENA,
@@ -745,6 +1122,30 @@ pub export fn cardinal_memory_init(default_linear_capacity: usize) void {
             .reset = tracked_reset,
         };
     }
+
+    for (&g_frame_arena_state, &g_frame_arenas) |*st, *arena| {
+        st.* = .{
+            .backing = &g_tracked[@as(usize, @intCast(@intFromEnum(CardinalMemoryCategory.TEMPORARY)))],
+            .current_block = null,
+            .default_block_size = FRAME_ARENA_BLOCK_SIZE,
+            .allocation_count = 0,
+            .allocated_bytes = 0,
+        };
+        arena.* = .{
+            .type = .ARENA,
+            .name = "frame_arena",
+            .category = .TEMPORARY,
+            .state = st,
+            .alloc = arena_alloc,
+            .realloc = arena_realloc,
+            .free = arena_free,
+            .reset = arena_reset,
+        };
+    }
+    g_frame_index = 0;
+    g_frame_stats = std.mem.zeroes(CardinalFrameMemoryStats);
+    g_frame_heap_baseline = .{ 0, 0, 0 };
+    g_initialized = true;
 }
 
 /// Shuts down the memory subsystem and releases allocator backing storage.
@@ -753,6 +1154,9 @@ pub export fn cardinal_memory_shutdown() void {
     g_initialized = false;
 
     arena_reset(&g_arena);
+    for (&g_frame_arenas) |*arena| {
+        arena_reset(arena);
+    }
 
     if (g_linear_state.capacity > 0) {
         if (g_linear_state.buffer) |b| {
@@ -763,32 +1167,162 @@ pub export fn cardinal_memory_shutdown() void {
         g_linear_state.offset = 0;
     }
 
-    g_alloc_map_lock.lock();
-    defer g_alloc_map_lock.unlock();
+    cardinal_memory_flush_thread_cache();
 
-    if (g_alloc_map_init) {
-        if (g_alloc_map.count() > 0) {
-            _ = c.printf("[Memory] Warning: %d allocations leaked at shutdown.\n", g_alloc_map.count());
+    var leaked: usize = 0;
+    for (&g_alloc_shards) |*shard| {
+        shard.lock.lock();
+        defer shard.lock.unlock();
+        leaked += shard.map.count();
+    }
 
-            if (builtin.mode == .Debug) {
-                var it = g_alloc_map.iterator();
-                while (it.next()) |entry| {
-                    const info = entry.value_ptr;
-                    _ = c.printf("  Leak: %p, Size: %zu\n", info.ptr, info.size);
+    // Tests share the process-wide map across modules, so leftovers there are not leaks.
+    if (leaked > 0 and !builtin.is_test) {
+        _ = c.printf("[Memory] Warning: %zu allocations leaked at shutdown.\n", leaked);
+    }
 
-                    if (info.stack_depth > 0) {
-                        _ = c.printf("    Stack Trace:\n");
-                        print_stack_trace(&info.stack_addresses, info.stack_depth);
-                    }
+    for (&g_alloc_shards) |*shard| {
+        shard.lock.lock();
+        defer shard.lock.unlock();
+
+        var it = shard.map.iterator();
+        while (it.next()) |entry| {
+            const info = entry.value_ptr;
+            if (builtin.mode == .Debug and !builtin.is_test) {
+                _ = c.printf("  Leak: %p, Size: %zu\n", info.ptr, info.size);
+
+                if (info.stack) |sample| {
+                    _ = c.printf("    Stack Trace:\n");
+                    print_stack_trace(&sample.addresses, sample.depth);
                 }
             }
+            release_stack_sample(info.stack);
         }
-        g_alloc_map.deinit();
-        g_alloc_map_init = false;
-        g_active_allocs = 0;
+        shard.map.deinit(std.heap.c_allocator);
+        shard.map = .{};
+    }
+}
+
+/// Marks a frame boundary: records the finished frame's allocation activity and rewinds the
+/// frame arena that becomes current.
+///
+/// Must be called from the main thread, once per frame, before any frame-arena allocation.
+pub export fn cardinal_memory_begin_frame() void {
+    var heap_allocs: usize = 0;
+    var heap_bytes: usize = 0;
+    var heap_frees: usize = 0;
+    var i: usize = 0;
+    while (i < CATEGORY_SLOT_COUNT) : (i += 1) {
+        const cat = aggregate_category(i);
+        heap_allocs += cat.allocation_count;
+        heap_bytes += cat.total_allocated;
+        heap_frees += cat.free_count;
+    }
+
+    const finished: *ArenaState = &g_frame_arena_state[g_frame_index % FRAME_ARENA_COUNT];
+    g_frame_stats = .{
+        .frame_index = g_frame_index,
+        .heap_allocation_count = heap_allocs -| g_frame_heap_baseline[0],
+        .heap_allocated_bytes = heap_bytes -| g_frame_heap_baseline[1],
+        .heap_free_count = heap_frees -| g_frame_heap_baseline[2],
+        .frame_arena_allocation_count = finished.allocation_count,
+        .frame_arena_bytes = finished.allocated_bytes,
+        .frame_arena_capacity = arena_capacity(finished),
+    };
+
+    g_frame_index += 1;
+    arena_rewind(&g_frame_arenas[g_frame_index % FRAME_ARENA_COUNT]);
+
+    // Baseline after the rewind so arena coalescing is charged to the frame that caused it.
+    heap_allocs = 0;
+    heap_bytes = 0;
+    heap_frees = 0;
+    i = 0;
+    while (i < CATEGORY_SLOT_COUNT) : (i += 1) {
+        const cat = aggregate_category(i);
+        heap_allocs += cat.allocation_count;
+        heap_bytes += cat.total_allocated;
+        heap_frees += cat.free_count;
+    }
+    g_frame_heap_baseline = .{ heap_allocs, heap_bytes, heap_frees };
+}
+
+/// Copies the previous frame's allocation statistics into `out_stats` (no-op if null).
+pub export fn cardinal_memory_get_frame_stats(out_stats: ?*CardinalFrameMemoryStats) void {
+    if (out_stats) |s| {
+        s.* = g_frame_stats;
     }
 }
 
+/// Returns the current frame's arena allocator (main thread only).
+///
+/// Individual frees are ignored. Memory remains valid until `cardinal_memory_begin_frame` has
+/// been called `FRAME_ARENA_COUNT` times, so data may be handed to the next frame.
+pub export fn cardinal_get_frame_allocator() *CardinalAllocator {
+    return &g_frame_arenas[g_frame_index % FRAME_ARENA_COUNT];
+}
+
+/// A nested use of the calling thread's scratch arena.
+///
+/// The arena is rewound when the outermost scope on the thread ends; memory from a scope must
+/// not outlive it.
+pub const ScratchScope = struct {
+    arena: *CardinalAllocator,
+
+    pub fn allocator(self: ScratchScope) std.mem.Allocator {
+        return self.arena.as_allocator();
+    }
+
+    pub fn end(self: ScratchScope) void {
+        std.debug.assert(t_scratch_depth > 0);
+        t_scratch_depth -= 1;
+        if (t_scratch_depth == 0) {
+            arena_rewind(self.arena);
+        }
+    }
+};
+
+/// Opens a scratch scope on the calling thread, creating its arena on first use.
+///
+/// Returns null only if the arena could not be created.
+pub fn scratch_begin() ?ScratchScope {
+    if (t_scratch_arena == null) {
+        t_scratch_arena = cardinal_arena_create(&g_tracked[@as(usize, @intCast(@intFromEnum(CardinalMemoryCategory.TEMPORARY)))], SCRATCH_ARENA_BLOCK_SIZE);
+    }
+    const arena = t_scratch_arena orelse return null;
+    t_scratch_depth += 1;
+    return .{ .arena = arena };
+}
+
+/// Scratch arena state of a suspended job fiber, carried to whichever thread resumes it.
+pub const ScratchHandoff = struct {
+    arena: ?*CardinalAllocator = null,
+    depth: u32 = 0,
+};
+
+/// Detaches the calling thread's scratch arena if scopes are open on it, so a fiber that waits
+/// while holding a `ScratchScope` can take the arena to the thread it resumes on. The thread
+/// creates a fresh arena on its next `scratch_begin`.
+///
+/// Not inlined so the thread-local is read on the thread that is actually suspending.
+pub noinline fn scratch_suspend() ScratchHandoff {
+    if (t_scratch_depth == 0) return .{};
+    const handoff = ScratchHandoff{ .arena = t_scratch_arena, .depth = t_scratch_depth };
+    t_scratch_arena = null;
+    t_scratch_depth = 0;
+    return handoff;
+}
+
+/// Installs a handoff from `scratch_suspend` on the calling thread, which must have no scratch
+/// scope open. The thread's own idle arena, if any, is released in favour of the carried one.
+pub noinline fn scratch_resume(handoff: ScratchHandoff) void {
+    const arena = handoff.arena orelse return;
+    std.debug.assert(t_scratch_depth == 0);
+    if (t_scratch_arena) |own| cardinal_arena_destroy(own);
+    t_scratch_arena = arena;
+    t_scratch_depth = handoff.depth;
+}
+
 export fn cardinal_get_dynamic_allocator() *CardinalAllocator {
     return &g_dynamic;
 }
@@ -905,6 +1439,8 @@ pub export fn cardinal_arena_create(backing_allocator: ?*CardinalAllocator, defa
     state.backing = backing;
     state.current_block = null;
     state.default_block_size = if (default_block_size > 0) default_block_size else 4096;
+    state.allocation_count = 0;
+    state.allocated_bytes = 0;
 
     const alloc_ptr = backing.alloc(backing, @sizeOf(CardinalAllocator), @alignOf(CardinalAllocator));
     if (alloc_ptr == null) {
@@ -946,3 +1482,160 @@ pub export fn cardinal_arena_destroy(allocator: ?*CardinalAllocator) void {
         backing.free(backing, a);
     }
 }
+
+test "tracked allocator stats and size-class reuse" {
+    cardinal_memory_init(64 * 1024);
+    defer cardinal_memory_shutdown();
+
+    var before: CardinalGlobalMemoryStats = undefined;
+    cardinal_memory_get_stats(&before);
+
+    const allocator = cardinal_get_allocator_for_category(.ASSETS);
+    const a = cardinal_alloc(allocator, 40) orelse return error.OutOfMemory;
+
+    var mid: CardinalGlobalMemoryStats = undefined;
+    cardinal_memory_get_stats(&mid);
+    const cat = @as(usize, @intCast(@intFromEnum(CardinalMemoryCategory.ASSETS)));
+    try std.testing.expectEqual(before.categories[cat].current_usage + 40, mid.categories[cat].current_usage);
+    try std.testing.expectEqual(before.categories[cat].allocation_count + 1, mid.categories[cat].allocation_count);
+
+    // 40 bytes rounds up to the 64-byte class, so growing to 60 stays in place.
+    const grown = cardinal_realloc(allocator, a, 60) orelse return error.OutOfMemory;
+    try std.testing.expectEqual(a, grown);
+
+    cardinal_free(allocator, grown);
+    const b = cardinal_alloc(allocator, 50) orelse return error.OutOfMemory;
+    try std.testing.expectEqual(grown, b);
+    cardinal_free(allocator, b);
+
+    var after: CardinalGlobalMemoryStats = undefined;
+    cardinal_memory_get_stats(&after);
+    try std.testing.expectEqual(before.categories[cat].current_usage, after.categories[cat].current_usage);
+    try std.testing.expect(after.categories[cat].peak_usage >= mid.categories[cat].current_usage);
+}
+
+test "size-class blocks stay out of the live-allocation map" {
+    cardinal_memory_init(64 * 1024);
+    defer cardinal_memory_shutdown();
+
+    const allocator = cardinal_get_allocator_for_category(.ASSETS);
+    const small = cardinal_alloc(allocator, 40) orelse return error.OutOfMemory;
+    const large = cardinal_alloc(allocator, 64 * 1024) orelse return error.OutOfMemory;
+    try std.testing.expect(find_alloc(small) == null);
+    try std.testing.expect(find_alloc(large) != null);
+    try std.testing.expectEqual(@as(usize, 40), block_header(small).size);
+
+    // Spilling out of the size class moves the block under map tracking.
+    const moved = cardinal_realloc(allocator, small, 4096) orelse return error.OutOfMemory;
+    try std.testing.expect(find_alloc(moved) != null);
+
+    const aligned = allocator.alloc(allocator, 100, 64) orelse return error.OutOfMemory;
+    try std.testing.expectEqual(@as(usize, 0), @intFromPtr(aligned) % 64);
+
+    allocator.free(allocator, aligned);
+    cardinal_free(allocator, moved);
+    cardinal_free(allocator, large);
+    try std.testing.expect(find_alloc(moved) == null);
+    try std.testing.expect(g_initialized);
+}
+
+test "size-class blocks bypass the cache on threads that did not opt in" {
+    cardinal_memory_init(64 * 1024);
+    defer cardinal_memory_shutdown();
+
+    const Worker = struct {
+        fn run(out_reused: *bool) void {
+            const allocator = cardinal_get_allocator_for_category(.ASSETS);
+            const a = cardinal_alloc(allocator, 40);
+            cardinal_free(allocator, a);
+            out_reused.* = t_thread_cache.counts[size_class_index(40).?] != 0;
+        }
+    };
+
+    var cached_on_worker = true;
+    const thread = try std.Thread.spawn(.{}, Worker.run, .{&cached_on_worker});
+    thread.join();
+    try std.testing.expect(!cached_on_worker);
+
+    const class = size_class_index(40).?;
+    const allocator = cardinal_get_allocator_for_category(.ASSETS);
+    const a = cardinal_alloc(allocator, 40) orelse return error.OutOfMemory;
+    const cached_before = t_thread_cache.counts[class];
+    cardinal_free(allocator, a);
+    try std.testing.expectEqual(cached_before + 1, t_thread_cache.counts[class]);
+}
+
+test "frame arenas rewind and report per-frame activity" {
+    cardinal_memory_init(64 * 1024);
+    defer cardinal_memory_shutdown();
+
+    cardinal_memory_begin_frame();
+    const frame_alloc = cardinal_get_frame_allocator().as_allocator();
+    const a = try frame_alloc.alloc(u8, 3000);
+    const b = try frame_alloc.alloc(u64, 16);
+    _ = b;
+
+    const heap = cardinal_get_allocator_for_category(.ENGINE);
+    const p = cardinal_alloc(heap, 100);
+    cardinal_free(heap, p);
+
+    cardinal_memory_begin_frame();
+    var stats: CardinalFrameMemoryStats = undefined;
+    cardinal_memory_get_frame_stats(&stats);
+    try std.testing.expectEqual(@as(usize, 2), stats.frame_arena_allocation_count);
+    try std.testing.expect(stats.frame_arena_bytes >= 3000 + 16 * @sizeOf(u64));
+    try std.testing.expect(stats.heap_allocation_count >= 1);
+    try std.testing.expect(stats.heap_free_count >= 1);
+
+    // Two frame boundaries later the first arena is current again and reuses its block.
+    cardinal_memory_begin_frame();
+    const c_again = try cardinal_get_frame_allocator().as_allocator().alloc(u8, 3000);
+    try std.testing.expectEqual(a.ptr, c_again.ptr);
+
+    {
+        const outer = scratch_begin() orelse return error.OutOfMemory;
+        defer outer.end();
+        const first = try outer.allocator().alloc(u32, 64);
+        {
+            const inner = scratch_begin() orelse return error.OutOfMemory;
+            defer inner.end();
+            const second = try inner.allocator().alloc(u32, 64);
+            try std.testing.expect(first.ptr != second.ptr);
+        }
+    }
+    try std.testing.expectEqual(@as(u32, 0), t_scratch_depth);
+}
+
+test "scratch scopes follow a suspended fiber to another thread" {
+    cardinal_memory_init(64 * 1024);
+    defer cardinal_memory_shutdown();
+
+    const scope = scratch_begin() orelse return error.OutOfMemory;
+    const held = try scope.allocator().alloc(u32, 16);
+    @memset(held, 0xC0FFEE);
+
+    const handoff = scratch_suspend();
+    try std.testing.expectEqual(@as(u32, 1), handoff.depth);
+    try std.testing.expectEqual(@as(u32, 0), t_scratch_depth);
+
+    // The suspending thread keeps working with a fresh arena that does not alias the held data.
+    {
+        const other = scratch_begin() orelse return error.OutOfMemory;
+        defer other.end();
+        try std.testing.expect(other.arena != scope.arena);
+    }
+
+    const Resumer = struct {
+        fn run(h: ScratchHandoff, s: ScratchScope, data: []u32, ok: *bool) void {
+            scratch_resume(h);
+            ok.* = t_scratch_depth == 1 and t_scratch_arena == s.arena and data[15] == 0xC0FFEE;
+            s.end();
+            ok.* = ok.* and t_scratch_depth == 0;
+            cardinal_memory_flush_thread_cache();
+        }
+    };
+    var ok = false;
+    const thread = try std.Thread.spawn(.{}, Resumer.run, .{ handoff, scope, held, &ok });
+    thread.join();
+    try std.testing.expect(ok);
+}
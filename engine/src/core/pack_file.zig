@@ -0,0 +1,533 @@
+//! Packed asset archives (`.cpak`).
+//!
+//! A pack is a single file holding many assets, so a shipping build opens one file instead of
+//! tens of thousands. Layout:
+//!
+//! - `PackHeader` at offset 0.
+//! - Entry data from `DATA_ALIGNMENT` onwards. Stored (uncompressed) entries start on a
+//!   `DATA_ALIGNMENT` boundary so a memory-mapped pack hands them out as page-aligned slices
+//!   without copying. Deflated entries are packed at `COMPRESSED_ALIGNMENT`.
+//! - The directory: `PackEntry` records sorted by path hash, then by name.
+//! - The name blob referenced by the directory.
+//!
+//! Entry names are relative paths with `/` separators. `PackFile` is the reader and is reference
+//! counted so borrowed entry slices stay valid after the pack is unmounted from the VFS.
+//! `PackBuilder` writes packs and is used by the `cardinal_packer` tool.
+const std = @import("std");
+const builtin = @import("builtin");
+const log = @import("log.zig");
+const name_hash = @import("name_hash.zig");
+
+const c = @cImport({
+    @cInclude("miniz.h");
+});
+
+const pack_log = log.ScopedLogger("PACK");
+
+pub const PACK_MAGIC = [4]u8{ 'C', 'P', 'A', 'K' };
+pub const PACK_VERSION: u32 = 1;
+/// Conventional file extension for packs.
+pub const PACK_EXTENSION = ".cpak";
+
+/// Alignment of stored entries and of the data region; matches the smallest common page size.
+pub const DATA_ALIGNMENT: u64 = 4096;
+/// Alignment of compressed entries, the directory and the name blob.
+pub const COMPRESSED_ALIGNMENT: u64 = 16;
+
+pub const Compression = enum(u32) {
+    none = 0,
+    /// zlib-wrapped deflate (miniz).
+    deflate = 1,
+};
+
+pub const PackHeader = extern struct {
+    magic: [4]u8,
+    version: u32,
+    entry_count: u32,
+    flags: u32 = 0,
+    directory_offset: u64,
+    names_offset: u64,
+    names_size: u64,
+    data_offset: u64,
+};
+
+pub const PackEntry = extern struct {
+    /// `hash_path` of the entry name; the directory is sorted on it.
+    path_hash: u64,
+    offset: u64,
+    /// Bytes occupied in the pack.
+    stored_size: u64,
+    /// Bytes after decompression.
+    size: u64,
+    name_offset: u32,
+    name_len: u32,
+    compression: u32,
+    /// CRC-32 of the uncompressed bytes.
+    crc32: u32,
+};
+
+const MappedBytes = []align(std.heap.page_size_min) const u8;
+
+/// Normalizes `path` into `buf`: `\` becomes `/`, and leading `./` and `/` are dropped.
+pub fn normalize_path(buf: []u8, path: []const u8) ![]const u8 {
+    var start: usize = 0;
+    while (start < path.len) {
+        if (path[start] == '/' or path[start] == '\\') {
+            start += 1;
+        } else if (path.len - start >= 2 and path[start] == '.' and (path[start + 1] == '/' or path[start + 1] == '\\')) {
+            start += 2;
+        } else break;
+    }
+    const trimmed = path[start..];
+    if (trimmed.len > buf.len) return error.NameTooLong;
+    for (trimmed, 0..) |ch, i| buf[i] = if (ch == '\\') '/' else ch;
+    return buf[0..trimmed.len];
+}
+
+/// Hash used for the pack directory; `path` must already be normalized.
+pub fn hash_path(path: []const u8) u64 {
+    return name_hash.hash_u64_wyhash(path);
+}
+
+fn entry_less_than(names: []const u8, a: PackEntry, b: PackEntry) bool {
+    if (a.path_hash != b.path_hash) return a.path_hash < b.path_hash;
+    return std.mem.lessThan(u8, names[a.name_offset..][0..a.name_len], names[b.name_offset..][0..b.name_len]);
+}
+
+/// Read-only view of a pack file. Create with `open`, drop with `release`.
+pub const PackFile = struct {
+    allocator: std.mem.Allocator,
+    path: []u8,
+    bytes: MappedBytes,
+    entries: []const PackEntry,
+    names: []const u8,
+    /// Modification time of the pack in nanoseconds; reported for every entry.
+    mtime_ns: u64,
+    refs: std.atomic.Value(u32) = .init(1),
+
+    /// Maps the pack at `path` and validates its header and directory.
+    pub fn open(allocator: std.mem.Allocator, path: []const u8) !*PackFile {
+        const file = try std.fs.cwd().openFile(path, .{});
+        defer file.close();
+
+        const stat = try file.stat();
+        const size: usize = @intCast(stat.size);
+        if (size < @sizeOf(PackHeader)) return error.InvalidPack;
+
+        const bytes = try map_file(allocator, file, size);
+        errdefer unmap_file(allocator, bytes);
+
+        const header = std.mem.bytesToValue(PackHeader, bytes[0..@sizeOf(PackHeader)]);
+        if (!std.mem.eql(u8, &header.magic, &PACK_MAGIC)) return error.InvalidPack;
+        if (header.version != PACK_VERSION) return error.UnsupportedPackVersion;
+
+        const dir_size = @as(u64, header.entry_count) * @sizeOf(PackEntry);
+        if (header.directory_offset % @alignOf(PackEntry) != 0) return error.InvalidPack;
+        const dir_end = std.math.add(u64, header.directory_offset, dir_size) catch return error.InvalidPack;
+        if (dir_end > size) return error.InvalidPack;
+        const names_end = std.math.add(u64, header.names_offset, header.names_size) catch return error.InvalidPack;
+        if (names_end > size) return error.InvalidPack;
+
+        const dir_start: usize = @intCast(header.directory_offset);
+        const dir_bytes: []align(8) const u8 = @alignCast(bytes[dir_start..][0..@intCast(dir_size)]);
+        const entries = std.mem.bytesAsSlice(PackEntry, dir_bytes);
+        const names = bytes[@intCast(header.names_offset)..][0..@intCast(header.names_size)];
+
+        for (entries) |entry| {
+            if (@as(u64, entry.name_offset) + entry.name_len > names.len) return error.InvalidPack;
+            const entry_end = std.math.add(u64, entry.offset, entry.stored_size) catch return error.InvalidPack;
+            if (entry_end > size) return error.InvalidPack;
+            _ = std.meta.intToEnum(Compression, entry.compression) catch return error.InvalidPack;
+        }
+
+        const self = try allocator.create(PackFile);
+        errdefer allocator.destroy(self);
+        self.* = .{
+            .allocator = allocator,
+            .path = try allocator.dupe(u8, path),
+            .bytes = bytes,
+            .entries = entries,
+            .names = names,
+            .mtime_ns = @intCast(@max(stat.mtime, 0)),
+        };
+        return self;
+    }
+
+    pub fn retain(self: *PackFile) void {
+        _ = self.refs.fetchAdd(1, .monotonic);
+    }
+
+    /// Drops a reference; the mapping is released with the last one.
+    pub fn release(self: *PackFile) void {
+        if (self.refs.fetchSub(1, .acq_rel) != 1) return;
+        const allocator = self.allocator;
+        unmap_file(allocator, self.bytes);
+        allocator.free(self.path);
+        allocator.destroy(self);
+    }
+
+    /// Returns the entry for `path` (normalized internally), or null if the pack lacks it.
+    pub fn find(self: *const PackFile, path: []const u8) ?*const PackEntry {
+        var buf: [std.fs.max_path_bytes]u8 = undefined;
+        const name = normalize_path(&buf, path) catch return null;
+        const hash = hash_path(name);
+
+        // Lower bound on the hash, then compare names across the (rare) collisions.
+        var lo: usize = 0;
+        var hi: usize = self.entries.len;
+        while (lo < hi) {
+            const mid = lo + (hi - lo) / 2;
+            if (self.entries[mid].path_hash < hash) lo = mid + 1 else hi = mid;
+        }
+        while (lo < self.entries.len and self.entries[lo].path_hash == hash) : (lo += 1) {
+            const entry = &self.entries[lo];
+            if (std.mem.eql(u8, self.entry_name(entry), name)) return entry;
+        }
+        return null;
+    }
+
+    pub fn entry_name(self: *const PackFile, entry: *const PackEntry) []const u8 {
+        return self.names[entry.name_offset..][0..entry.name_len];
+    }
+
+    /// Raw bytes of `entry` as stored in the pack.
+    pub fn stored_bytes(self: *const PackFile, entry: *const PackEntry) []const u8 {
+        return self.bytes[@intCast(entry.offset)..][0..@intCast(entry.stored_size)];
+    }
+
+    /// Returns the contents of a stored entry without copying, or null if it is compressed.
+    /// The slice is valid while the caller holds a reference to the pack.
+    pub fn borrow(self: *const PackFile, entry: *const PackEntry) ?[]const u8 {
+        if (entry.compression != @intFromEnum(Compression.none)) return null;
+        return self.stored_bytes(entry);
+    }
+
+    /// Decompresses (or copies) `entry` into a new buffer owned by the caller.
+    pub fn read_alloc(self: *const PackFile, allocator: std.mem.Allocator, entry: *const PackEntry) ![]u8 {
+        const stored = self.stored_bytes(entry);
+        const out = try allocator.alloc(u8, @intCast(entry.size));
+        errdefer allocator.free(out);
+
+        switch (@as(Compression, @enumFromInt(entry.compression))) {
+            .none => @memcpy(out, stored),
+            .deflate => {
+                var out_len: c.mz_ulong = @intCast(out.len);
+                const status = c.mz_uncompress(out.ptr, &out_len, stored.ptr, @intCast(stored.len));
+                if (status != c.MZ_OK or out_len != out.len) return error.CorruptPackEntry;
+                if (std.hash.Crc32.hash(out) != entry.crc32) return error.CorruptPackEntry;
+            },
+        }
+        return out;
+    }
+};
+
+fn map_file(allocator: std.mem.Allocator, file: std.fs.File, size: usize) !MappedBytes {
+    if (builtin.os.tag == .windows) {
+        const buf = try allocator.alignedAlloc(u8, .fromByteUnits(std.heap.page_size_min), size);
+        errdefer allocator.free(buf);
+        if (try file.readAll(buf) != size) return error.InvalidPack;
+        return buf;
+    }
+    return std.posix.mmap(null, size, std.posix.PROT.READ, .{ .TYPE = .PRIVATE }, file.handle, 0);
+}
+
+fn unmap_file(allocator: std.mem.Allocator, bytes: MappedBytes) void {
+    if (builtin.os.tag == .windows) {
+        allocator.free(bytes);
+    } else {
+        std.posix.munmap(bytes);
+    }
+}
+
+/// Options for `PackBuilder.write`.
+pub const WriteOptions = struct {
+    compress: bool = true,
+    /// miniz compression level (0-10).
+    level: c_int = 6,
+    /// Entries smaller than this are always stored.
+    min_compress_size: usize = 512,
+    /// A compressed entry is kept only if it is at most this fraction of the original size.
+    max_compressed_ratio: f32 = 0.9,
+};
+
+pub const WriteStats = struct {
+    entry_count: usize = 0,
+    compressed_count: usize = 0,
+    input_bytes: u64 = 0,
+    pack_bytes: u64 = 0,
+};
+
+/// Collects files and writes them into a pack.
+pub const PackBuilder = struct {
+    allocator: std.mem.Allocator,
+    inputs: std.ArrayListUnmanaged(Input) = .{},
+
+    const Input = struct {
+        name: []u8,
+        source: union(enum) {
+            path: []u8,
+            bytes: []const u8,
+        },
+    };
+
+    pub fn init(allocator: std.mem.Allocator) PackBuilder {
+        return .{ .allocator = allocator };
+    }
+
+    pub fn deinit(self: *PackBuilder) void {
+        for (self.inputs.items) |input| {
+            self.allocator.free(input.name);
+            switch (input.source) {
+                .path => |p| self.allocator.free(p),
+                .bytes => {},
+            }
+        }
+        self.inputs.deinit(self.allocator);
+    }
+
+    /// Adds the file at `source_path` under the pack name `name`.
+    pub fn add_file(self: *PackBuilder, name: []const u8, source_path: []const u8) !void {
+        const owned_name = try self.dupe_name(name);
+        errdefer self.allocator.free(owned_name);
+        const owned_path = try self.allocator.dupe(u8, source_path);
+        errdefer self.allocator.free(owned_path);
+        try self.inputs.append(self.allocator, .{ .name = owned_name, .source = .{ .path = owned_path } });
+    }
+
+    /// Adds in-memory contents under `name`. `bytes` must outlive `write`.
+    pub fn add_bytes(self: *PackBuilder, name: []const u8, bytes: []const u8) !void {
+        const owned_name = try self.dupe_name(name);
+        errdefer self.allocator.free(owned_name);
+        try self.inputs.append(self.allocator, .{ .name = owned_name, .source = .{ .bytes = bytes } });
+    }
+
+    /// Adds every file below `dir_path`, named by its path relative to `dir_path`. Hidden entries
+    /// (names starting with `.`) and `.meta` sidecars are skipped.
+    pub fn add_directory(self: *PackBuilder, dir_path: []const u8) !void {
+        var dir = try std.fs.cwd().openDir(dir_path, .{ .iterate = true });
+        defer dir.close();
+
+        var walker = try dir.walk(self.allocator);
+        defer walker.deinit();
+        while (try walker.next()) |entry| {
+            if (entry.kind != .file) continue;
+            if (is_hidden(entry.path) or std.mem.endsWith(u8, entry.basename, ".meta")) continue;
+            const source = try std.fs.path.join(self.allocator, &[_][]const u8{ dir_path, entry.path });
+            defer self.allocator.free(source);
+            try self.add_file(entry.path, source);
+        }
+    }
+
+    fn dupe_name(self: *PackBuilder, name: []const u8) ![]u8 {
+        var buf: [std.fs.max_path_bytes]u8 = undefined;
+        const normalized = try normalize_path(&buf, name);
+        if (normalized.len == 0) return error.InvalidPackName;
+        return self.allocator.dupe(u8, normalized);
+    }
+
+    /// Writes all inputs to `out_path`, replacing any existing file.
+    pub fn write(self: *PackBuilder, out_path: []const u8, options: WriteOptions) !WriteStats {
+        const allocator = self.allocator;
+
+        // Deterministic output: data is laid out in name order.
+        std.mem.sort(Input, self.inputs.items, {}, struct {
+            fn less(_: void, a: Input, b: Input) bool {
+                return std.mem.lessThan(u8, a.name, b.name);
+            }
+        }.less);
+        if (self.inputs.items.len > 1) {
+            for (self.inputs.items[1..], self.inputs.items[0 .. self.inputs.items.len - 1]) |input, prev| {
+                if (std.mem.eql(u8, input.name, prev.name)) {
+                    pack_log.err("Duplicate pack entry '{s}'", .{input.name});
+                    return error.DuplicatePackEntry;
+                }
+            }
+        }
+
+        var names = std.ArrayListUnmanaged(u8){};
+        defer names.deinit(allocator);
+        var entries = try std.ArrayListUnmanaged(PackEntry).initCapacity(allocator, self.inputs.items.len);
+        defer entries.deinit(allocator);
+        var scratch = std.ArrayListUnmanaged(u8){};
+        defer scratch.deinit(allocator);
+
+        const file = try std.fs.cwd().createFile(out_path, .{ .truncate = true });
+        defer file.close();
+
+        var stats = WriteStats{};
+        var offset: u64 = DATA_ALIGNMENT;
+        for (self.inputs.items) |input| {
+            const owned: ?[]u8 = switch (input.source) {
+                .path => |p| try std.fs.cwd().readFileAlloc(allocator, p, std.math.maxInt(u32)),
+                .bytes => null,
+            };
+            defer if (owned) |o| allocator.free(o);
+            const data: []const u8 = owned orelse input.source.bytes;
+
+            var entry = PackEntry{
+                .path_hash = hash_path(input.name),
+                .offset = 0,
+                .stored_size = data.len,
+                .size = data.len,
+                .name_offset = @intCast(names.items.len),
+                .name_len = @intCast(input.name.len),
+                .compression = @intFromEnum(Compression.none),
+                .crc32 = std.hash.Crc32.hash(data),
+            };
+            try names.appendSlice(allocator, input.name);
+
+            var payload = data;
+            if (options.compress and data.len >= options.min_compress_size and !is_precompressed(input.name)) {
+                const bound: usize = @intCast(c.mz_compressBound(@intCast(data.len)));
+                try scratch.resize(allocator, bound);
+                var out_len: c.mz_ulong = @intCast(bound);
+                const status = c.mz_compress2(scratch.items.ptr, &out_len, data.ptr, @intCast(data.len), options.level);
+                const limit = @as(f32, @floatFromInt(data.len)) * options.max_compressed_ratio;
+                if (status == c.MZ_OK and @as(f32, @floatFromInt(out_len)) <= limit) {
+                    payload = scratch.items[0..@intCast(out_len)];
+                    entry.compression = @intFromEnum(Compression.deflate);
+                    entry.stored_size = payload.len;
+                    stats.compressed_count += 1;
+                }
+            }
+
+            const alignment = if (entry.compression == @intFromEnum(Compression.none)) DATA_ALIGNMENT else COMPRESSED_ALIGNMENT;
+            offset = std.mem.alignForward(u64, offset, alignment);
+            entry.offset = offset;
+            try file.pwriteAll(payload, offset);
+            offset += payload.len;
+
+            entries.appendAssumeCapacity(entry);
+            stats.input_bytes += data.len;
+        }
+
+        std.mem.sort(PackEntry, entries.items, @as([]const u8, names.items), entry_less_than);
+
+        const directory_offset = std.mem.alignForward(u64, offset, COMPRESSED_ALIGNMENT);
+        try file.pwriteAll(std.mem.sliceAsBytes(entries.items), directory_offset);
+        const names_offset = directory_offset + entries.items.len * @sizeOf(PackEntry);
+        try file.pwriteAll(names.items, names_offset);
+
+        const header = PackHeader{
+            .magic = PACK_MAGIC,
+            .version = PACK_VERSION,
+            .entry_count = @intCast(entries.items.len),
+            .directory_offset = directory_offset,
+            .names_offset = names_offset,
+            .names_size = names.items.len,
+            .data_offset = DATA_ALIGNMENT,
+        };
+        try file.pwriteAll(std.mem.asBytes(&header), 0);
+
+        stats.entry_count = entries.items.len;
+        stats.pack_bytes = names_offset + names.items.len;
+        return stats;
+    }
+};
+
+fn is_hidden(rel_path: []const u8) bool {
+    var it = std.mem.tokenizeAny(u8, rel_path, "/\\");
+    while (it.next()) |part| {
+        if (part.len > 0 and part[0] == '.') return true;
+    }
+    return false;
+}
+
+/// Formats that are already entropy coded; deflating them wastes pack time and load time.
+fn is_precompressed(name: []const u8) bool {
+    const ext = std.fs.path.extension(name);
+    const exts = [_][]const u8{ ".png", ".jpg", ".jpeg", ".ogg", ".mp3", ".zip", ".cpak", ".ktx2" };
+    for (exts) |e| {
+        if (std.ascii.eqlIgnoreCase(ext, e)) return true;
+    }
+    return false;
+}
+
+test "pack round trip with stored and deflated entries" {
+    const allocator = std.testing.allocator;
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+
+    const pack_path = try tmp.dir.realpathAlloc(allocator, ".");
+    defer allocator.free(pack_path);
+    const out_path = try std.fs.path.join(allocator, &[_][]const u8{ pack_path, "test.cpak" });
+    defer allocator.free(out_path);
+
+    const repetitive = "cardinal " ** 200;
+    const small = "tiny";
+    var noise: [4000]u8 = undefined;
+    var prng = std.Random.DefaultPrng.init(7);
+    prng.random().bytes(&noise);
+
+    var builder = PackBuilder.init(allocator);
+    defer builder.deinit();
+    try builder.add_bytes("textures/repetitive.txt", repetitive);
+    try builder.add_bytes("./small.bin", small);
+    try builder.add_bytes("textures\\noise.bin", &noise);
+    const stats = try builder.write(out_path, .{});
+    try std.testing.expectEqual(@as(usize, 3), stats.entry_count);
+    try std.testing.expectEqual(@as(usize, 1), stats.compressed_count);
+
+    const pack = try PackFile.open(allocator, out_path);
+    defer pack.release();
+
+    const rep = pack.find("textures/repetitive.txt").?;
+    try std.testing.expectEqual(@as(u32, @intFromEnum(Compression.deflate)), rep.compression);
+    try std.testing.expect(pack.borrow(rep) == null);
+    const rep_bytes = try pack.read_alloc(allocator, rep);
+    defer allocator.free(rep_bytes);
+    try std.testing.expectEqualStrings(repetitive, rep_bytes);
+
+    const noise_entry = pack.find("textures/noise.bin").?;
+    const borrowed = pack.borrow(noise_entry).?;
+    try std.testing.expectEqualSlices(u8, &noise, borrowed);
+    try std.testing.expectEqual(@as(usize, 0), @intFromPtr(borrowed.ptr) % DATA_ALIGNMENT);
+
+    try std.testing.expectEqualStrings(small, pack.borrow(pack.find("/small.bin").?).?);
+    try std.testing.expect(pack.find("missing.bin") == null);
+}
+
+test "pack open rejects overflowing directory and entry ranges" {
+    const allocator = std.testing.allocator;
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+
+    const dir_path = try tmp.dir.realpathAlloc(allocator, ".");
+    defer allocator.free(dir_path);
+    const out_path = try std.fs.path.join(allocator, &[_][]const u8{ dir_path, "bad.cpak" });
+    defer allocator.free(out_path);
+
+    var builder = PackBuilder.init(allocator);
+    defer builder.deinit();
+    try builder.add_bytes("a.bin", "payload");
+    _ = try builder.write(out_path, .{ .compress = false });
+
+    const original = try tmp.dir.readFileAlloc(allocator, "bad.cpak", 1 << 20);
+    defer allocator.free(original);
+    const bytes = try allocator.dupe(u8, original);
+    defer allocator.free(bytes);
+    const header = std.mem.bytesToValue(PackHeader, bytes[0..@sizeOf(PackHeader)]);
+
+    // Directory offset near the top of the address space.
+    var bad_header = header;
+    bad_header.directory_offset = std.math.maxInt(u64) - 7;
+    @memcpy(bytes[0..@sizeOf(PackHeader)], std.mem.asBytes(&bad_header));
+    try tmp.dir.writeFile(.{ .sub_path = "bad.cpak", .data = bytes });
+    try std.testing.expectError(error.InvalidPack, PackFile.open(allocator, out_path));
+
+    // Names range that wraps.
+    bad_header = header;
+    bad_header.names_size = std.math.maxInt(u64);
+    @memcpy(bytes[0..@sizeOf(PackHeader)], std.mem.asBytes(&bad_header));
+    try tmp.dir.writeFile(.{ .sub_path = "bad.cpak", .data = bytes });
+    try std.testing.expectError(error.InvalidPack, PackFile.open(allocator, out_path));
+
+    // Entry whose stored range wraps.
+    @memcpy(bytes, original);
+    const dir_start: usize = @intCast(header.directory_offset);
+    var entry = std.mem.bytesToValue(PackEntry, bytes[dir_start..][0..@sizeOf(PackEntry)]);
+    entry.stored_size = std.math.maxInt(u64);
+    @memcpy(bytes[dir_start..][0..@sizeOf(PackEntry)], std.mem.asBytes(&entry));
+    try tmp.dir.writeFile(.{ .sub_path = "bad.cpak", .data = bytes });
+    try std.testing.expectError(error.InvalidPack, PackFile.open(allocator, out_path));
+}
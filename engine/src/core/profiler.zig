@@ -0,0 +1,568 @@
+//! Built-in frame profiler.
+//!
+//! Always compiled in and independent of Tracy, so builds without it can still diagnose frame
+//! spikes. Scoped zones and counter samples are written to per-thread ring buffers that only the
+//! owning thread writes, so recording takes no locks; while recording is off a zone costs one
+//! relaxed load. `frame_mark` closes a frame and folds the global counters (jobs, loader tasks,
+//! uploads) and the memory system's per-frame allocation stats into a `FrameStats` record.
+//!
+//! `capture` copies a time range out of the rings into a `Capture`, which can be saved in a
+//! compact binary form (`.cprof`) and exported as Chrome trace JSON for chrome://tracing or
+//! Perfetto. Tracy zones (`tracy.zoneS`) also record here.
+const std = @import("std");
+const platform = @import("platform.zig");
+const memory = @import("memory.zig");
+const vfs = @import("vfs.zig");
+
+/// Events kept per thread; older events are overwritten.
+pub const RING_CAPACITY: usize = 1 << 14;
+/// Threads that can record; later threads are ignored.
+pub const MAX_THREADS: usize = 128;
+/// Frames kept in the `frame_history` ring.
+pub const FRAME_HISTORY: usize = 256;
+
+const RING_MASK = RING_CAPACITY - 1;
+const THREAD_NAME_MAX = 31;
+
+pub const EventKind = enum(u8) {
+    /// Zone start; `value` is unused.
+    begin,
+    /// Zone end; matches the innermost open `begin` on the same thread.
+    end,
+    /// Counter sample; `value` is the counter value.
+    counter,
+    /// Frame boundary; `value` is the frame index.
+    frame,
+};
+
+pub const Event = extern struct {
+    timestamp_ns: u64,
+    name: [*:0]const u8,
+    value: i64,
+    kind: EventKind,
+};
+
+/// Per-frame totals; counters are summed over all threads.
+pub const FrameStats = extern struct {
+    index: u64 = 0,
+    start_ns: u64 = 0,
+    end_ns: u64 = 0,
+    jobs: u64 = 0,
+    loader_tasks: u64 = 0,
+    uploads: u64 = 0,
+    upload_bytes: u64 = 0,
+    allocations: u64 = 0,
+    allocated_bytes: u64 = 0,
+    frees: u64 = 0,
+
+    pub fn duration_ms(self: FrameStats) f64 {
+        return @as(f64, @floatFromInt(self.end_ns -| self.start_ns)) / 1e6;
+    }
+};
+
+/// Counters accumulated between `frame_mark` calls.
+pub const Counter = enum(u8) {
+    jobs,
+    loader_tasks,
+    uploads,
+    upload_bytes,
+};
+
+const ThreadRing = struct {
+    events: [RING_CAPACITY]Event,
+    /// Total events ever written; only the owning thread stores it.
+    head: std.atomic.Value(usize),
+    /// Registration order, starting at 1; used as the Chrome trace `tid`.
+    thread_id: u32,
+    name: [THREAD_NAME_MAX + 1]u8,
+};
+
+var g_recording = std.atomic.Value(bool).init(false);
+var g_rings: [MAX_THREADS]std.atomic.Value(?*ThreadRing) = [_]std.atomic.Value(?*ThreadRing){std.atomic.Value(?*ThreadRing).init(null)} ** MAX_THREADS;
+var g_ring_count = std.atomic.Value(usize).init(0);
+var g_counters: [std.meta.fields(Counter).len]std.atomic.Value(u64) = [_]std.atomic.Value(u64){std.atomic.Value(u64).init(0)} ** std.meta.fields(Counter).len;
+
+// Frame history is written by `frame_mark` and read by the UI, both on the main thread.
+var g_frames: [FRAME_HISTORY]FrameStats = [_]FrameStats{.{}} ** FRAME_HISTORY;
+var g_frame_count: u64 = 0;
+var g_frame_start_ns: u64 = 0;
+
+threadlocal var t_ring: ?*ThreadRing = null;
+threadlocal var t_ring_unavailable: bool = false;
+threadlocal var t_thread_name: [THREAD_NAME_MAX + 1]u8 = [_]u8{0} ** (THREAD_NAME_MAX + 1);
+
+/// Starts or stops recording on every thread.
+pub fn set_recording(enabled: bool) void {
+    if (enabled and !g_recording.load(.monotonic)) {
+        for (&g_counters) |*counter| counter.store(0, .monotonic);
+        g_frame_start_ns = platform.get_time_ns();
+    }
+    g_recording.store(enabled, .release);
+}
+
+pub inline fn is_recording() bool {
+    return g_recording.load(.monotonic);
+}
+
+/// Names the calling thread in captures. Cheap; can be called before recording starts.
+pub fn set_thread_name(name: []const u8) void {
+    const len = @min(name.len, THREAD_NAME_MAX);
+    @memcpy(t_thread_name[0..len], name[0..len]);
+    t_thread_name[len] = 0;
+    if (t_ring) |ring| ring.name = t_thread_name;
+}
+
+/// Rings are allocated from the page allocator so recording never re-enters the tracked
+/// allocators it reports on. They live for the rest of the process.
+fn register_thread() ?*ThreadRing {
+    if (t_ring_unavailable) return null;
+    t_ring_unavailable = true;
+
+    const index = g_ring_count.fetchAdd(1, .monotonic);
+    if (index >= MAX_THREADS) return null;
+    const ring = std.heap.page_allocator.create(ThreadRing) catch return null;
+    ring.head = std.atomic.Value(usize).init(0);
+    ring.thread_id = @intCast(index + 1);
+    ring.name = t_thread_name;
+    g_rings[index].store(ring, .release);
+
+    t_ring = ring;
+    t_ring_unavailable = false;
+    return ring;
+}
+
+inline fn emit(kind: EventKind, name: [*:0]const u8, value: i64) void {
+    const ring = t_ring orelse register_thread() orelse return;
+    const head = ring.head.load(.monotonic);
+    ring.events[head & RING_MASK] = .{ .timestamp_ns = platform.get_time_ns(), .name = name, .value = value, .kind = kind };
+    ring.head.store(head + 1, .release);
+}
+
+/// A scoped zone; `end` it on the thread that began it.
+pub const Zone = struct {
+    name: ?[*:0]const u8 = null,
+
+    pub fn end(self: Zone) void {
+        if (self.name) |name| emit(.end, name, 0);
+    }
+};
+
+/// Begins a zone named `name` (which must outlive any capture, e.g. a string literal).
+pub inline fn zone(name: [:0]const u8) Zone {
+    if (!is_recording()) return .{};
+    emit(.begin, name.ptr, 0);
+    return .{ .name = name.ptr };
+}
+
+/// Records a sample of a named counter on the calling thread's track.
+pub inline fn plot(name: [:0]const u8, value: i64) void {
+    if (!is_recording()) return;
+    emit(.counter, name.ptr, value);
+}
+
+/// Adds to one of the per-frame counters.
+pub inline fn count(counter: Counter, amount: u64) void {
+    if (!is_recording()) return;
+    _ = g_counters[@intFromEnum(counter)].fetchAdd(amount, .monotonic);
+}
+
+/// Ends the current frame. Call once per frame on the main thread, after presenting.
+pub fn frame_mark() void {
+    const now = platform.get_time_ns();
+    defer g_frame_start_ns = now;
+    if (!is_recording()) return;
+
+    var mem_stats: memory.CardinalFrameMemoryStats = undefined;
+    memory.cardinal_memory_get_frame_stats(&mem_stats);
+
+    const stats = FrameStats{
+        .index = g_frame_count,
+        .start_ns = g_frame_start_ns,
+        .end_ns = now,
+        .jobs = g_counters[@intFromEnum(Counter.jobs)].swap(0, .monotonic),
+        .loader_tasks = g_counters[@intFromEnum(Counter.loader_tasks)].swap(0, .monotonic),
+        .uploads = g_counters[@intFromEnum(Counter.uploads)].swap(0, .monotonic),
+        .upload_bytes = g_counters[@intFromEnum(Counter.upload_bytes)].swap(0, .monotonic),
+        .allocations = mem_stats.heap_allocation_count,
+        .allocated_bytes = mem_stats.heap_allocated_bytes,
+        .frees = mem_stats.heap_free_count,
+    };
+    g_frames[g_frame_count % FRAME_HISTORY] = stats;
+    g_frame_count += 1;
+
+    if (t_thread_name[0] == 0) set_thread_name("Main");
+    emit(.frame, "Frame", @intCast(stats.index));
+    emit(.counter, "Jobs", @intCast(stats.jobs));
+    emit(.counter, "Loader Tasks", @intCast(stats.loader_tasks));
+    emit(.counter, "Upload Bytes", @intCast(stats.upload_bytes));
+    emit(.counter, "Allocations", @intCast(stats.allocations));
+}
+
+/// Recorded frames, oldest first. Main thread only; the slice is reused by the next call.
+pub fn frame_history(out: *[FRAME_HISTORY]FrameStats) []const FrameStats {
+    const n: usize = @intCast(@min(g_frame_count, FRAME_HISTORY));
+    const first = g_frame_count - n;
+    for (out[0..n], 0..) |*frame, i| frame.* = g_frames[@intCast((first + i) % FRAME_HISTORY)];
+    return out[0..n];
+}
+
+// ---------------------------------------------------------------------------------------------
+// Captures
+// ---------------------------------------------------------------------------------------------
+
+pub const ThreadTrack = struct {
+    thread_id: u32,
+    name: []const u8,
+    events: []const Event,
+};
+
+/// Events of every thread in a time range, plus the frames that ended in it.
+pub const Capture = struct {
+    arena: std.heap.ArenaAllocator,
+    start_ns: u64,
+    end_ns: u64,
+    threads: []const ThreadTrack,
+    frames: []const FrameStats,
+
+    pub fn deinit(self: *Capture) void {
+        self.arena.deinit();
+    }
+
+    pub fn event_count(self: *const Capture) usize {
+        var total: usize = 0;
+        for (self.threads) |track| total += track.events.len;
+        return total;
+    }
+
+    /// Writes the capture in the binary `.cprof` format: a header, an interned name table, raw
+    /// frame records, then per-thread events as varints (timestamps delta-encoded).
+    pub fn write_binary(self: *const Capture, allocator: std.mem.Allocator, writer: anytype) !void {
+        var names = std.StringArrayHashMapUnmanaged(void){};
+        defer names.deinit(allocator);
+        for (self.threads) |track| {
+            for (track.events) |event| try names.put(allocator, std.mem.span(event.name), {});
+        }
+
+        try writer.writeInt(u32, CAPTURE_MAGIC, .little);
+        try writer.writeInt(u32, CAPTURE_VERSION, .little);
+        try writer.writeInt(u64, self.start_ns, .little);
+        try writer.writeInt(u64, self.end_ns, .little);
+        try writer.writeInt(u32, @intCast(names.count()), .little);
+        try writer.writeInt(u32, @intCast(self.frames.len), .little);
+        try writer.writeInt(u32, @intCast(self.threads.len), .little);
+
+        for (names.keys()) |name| {
+            try write_varint(writer, name.len);
+            try writer.writeAll(name);
+        }
+        for (self.frames) |frame| {
+            inline for (std.meta.fields(FrameStats)) |field| try writer.writeInt(u64, @field(frame, field.name), .little);
+        }
+        for (self.threads) |track| {
+            try writer.writeInt(u32, track.thread_id, .little);
+            try write_varint(writer, track.name.len);
+            try writer.writeAll(track.name);
+            try write_varint(writer, track.events.len);
+            var prev = self.start_ns;
+            for (track.events) |event| {
+                try writer.writeByte(@intFromEnum(event.kind));
+                try write_varint(writer, names.getIndex(std.mem.span(event.name)).?);
+                try write_varint(writer, event.timestamp_ns -| prev);
+                prev = @max(prev, event.timestamp_ns);
+                if (event.kind == .counter or event.kind == .frame) try write_varint(writer, zigzag(event.value));
+            }
+        }
+    }
+
+    /// Reads a capture written by `write_binary`.
+    pub fn read_binary(allocator: std.mem.Allocator, bytes: []const u8) !Capture {
+        var arena = std.heap.ArenaAllocator.init(allocator);
+        errdefer arena.deinit();
+        const a = arena.allocator();
+
+        var reader = ByteReader{ .data = bytes };
+        if ((try reader.int(u32)) != CAPTURE_MAGIC) return error.InvalidCapture;
+        if ((try reader.int(u32)) != CAPTURE_VERSION) return error.UnsupportedCaptureVersion;
+        const start_ns = try reader.int(u64);
+        const end_ns = try reader.int(u64);
+        const name_count = try reader.int(u32);
+        const frame_count = try reader.int(u32);
+        const thread_count = try reader.int(u32);
+
+        const names = try a.alloc([*:0]const u8, name_count);
+        for (names) |*name| {
+            name.* = (try a.dupeZ(u8, try reader.take(try reader.varint()))).ptr;
+        }
+        const frames = try a.alloc(FrameStats, frame_count);
+        for (frames) |*frame| {
+            inline for (std.meta.fields(FrameStats)) |field| @field(frame, field.name) = try reader.int(u64);
+        }
+        const threads = try a.alloc(ThreadTrack, thread_count);
+        for (threads) |*track| {
+            track.thread_id = try reader.int(u32);
+            track.name = try a.dupe(u8, try reader.take(try reader.varint()));
+            const event_total = try reader.varint();
+            // Every event takes at least three bytes.
+            if (event_total > (bytes.len - reader.pos) / 3) return error.InvalidCapture;
+            const events = try a.alloc(Event, @intCast(event_total));
+            var timestamp = start_ns;
+            for (events) |*event| {
+                const kind = std.meta.intToEnum(EventKind, try reader.byte()) catch return error.InvalidCapture;
+                const name_index = try reader.varint();
+                if (name_index >= names.len) return error.InvalidCapture;
+                timestamp += try reader.varint();
+                const value = if (kind == .counter or kind == .frame) unzigzag(try reader.varint()) else 0;
+                event.* = .{ .timestamp_ns = timestamp, .name = names[@intCast(name_index)], .value = value, .kind = kind };
+            }
+            track.events = events;
+        }
+        return .{ .arena = arena, .start_ns = start_ns, .end_ns = end_ns, .threads = threads, .frames = frames };
+    }
+
+    /// Writes Chrome trace event JSON (the "JSON Object Format").
+    pub fn write_chrome_trace(self: *const Capture, writer: anytype) !void {
+        try writer.writeAll("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        try writer.writeAll("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Cardinal\"}}");
+        for (self.threads) |track| {
+            try writer.print(",\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{d},\"args\":{{\"name\":", .{track.thread_id});
+            if (track.name.len > 0) {
+                try write_json_string(writer, track.name);
+            } else {
+                try writer.print("\"Thread {d}\"", .{track.thread_id});
+            }
+            try writer.writeAll("}}");
+
+            var depth: usize = 0;
+            for (track.events) |event| {
+                const ts_us = @as(f64, @floatFromInt(event.timestamp_ns -| self.start_ns)) / 1e3;
+                switch (event.kind) {
+                    .begin => depth += 1,
+                    // Zones that were already open when the capture started have no begin.
+                    .end => {
+                        if (depth == 0) continue;
+                        depth -= 1;
+                    },
+                    else => {},
+                }
+                try writer.writeAll(",\n{\"name\":");
+                try write_json_string(writer, std.mem.span(event.name));
+                switch (event.kind) {
+                    .begin => try writer.print(",\"ph\":\"B\",\"ts\":{d:.3},\"pid\":1,\"tid\":{d}}}", .{ ts_us, track.thread_id }),
+                    .end => try writer.print(",\"ph\":\"E\",\"ts\":{d:.3},\"pid\":1,\"tid\":{d}}}", .{ ts_us, track.thread_id }),
+                    .counter => try writer.print(",\"ph\":\"C\",\"ts\":{d:.3},\"pid\":1,\"tid\":{d},\"args\":{{\"value\":{d}}}}}", .{ ts_us, track.thread_id, event.value }),
+                    .frame => try writer.print(",\"ph\":\"i\",\"s\":\"g\",\"ts\":{d:.3},\"pid\":1,\"tid\":{d},\"args\":{{\"frame\":{d}}}}}", .{ ts_us, track.thread_id, event.value }),
+                }
+            }
+        }
+        try writer.writeAll("\n]}\n");
+    }
+
+    /// Saves the binary form to `path`.
+    pub fn save(self: *const Capture, allocator: std.mem.Allocator, path: []const u8) !void {
+        var out = std.ArrayListUnmanaged(u8){};
+        defer out.deinit(allocator);
+        try self.write_binary(allocator, out.writer(allocator));
+        try vfs.write_file_all(path, out.items);
+    }
+
+    /// Saves Chrome trace JSON to `path`.
+    pub fn export_chrome_trace(self: *const Capture, allocator: std.mem.Allocator, path: []const u8) !void {
+        var out = std.ArrayListUnmanaged(u8){};
+        defer out.deinit(allocator);
+        try self.write_chrome_trace(out.writer(allocator));
+        try vfs.write_file_all(path, out.items);
+    }
+};
+
+/// Binary capture magic ("CPRF").
+const CAPTURE_MAGIC: u32 = 0x43505246;
+const CAPTURE_VERSION: u32 = 1;
+
+/// Copies the events recorded in `[start_ns, end_ns]` from every thread. Safe to call while
+/// other threads record: events overwritten during the copy are dropped rather than torn.
+pub fn capture(allocator: std.mem.Allocator, start_ns: u64, end_ns: u64) !Capture {
+    var arena = std.heap.ArenaAllocator.init(allocator);
+    errdefer arena.deinit();
+    const a = arena.allocator();
+
+    var tracks = std.ArrayListUnmanaged(ThreadTrack){};
+    const ring_count = @min(g_ring_count.load(.acquire), MAX_THREADS);
+    for (g_rings[0..ring_count]) |*slot| {
+        const ring = slot.load(.acquire) orelse continue;
+        const head = ring.head.load(.acquire);
+        const oldest = head -| RING_CAPACITY;
+
+        // Walk back to the first event in range; timestamps only grow along a ring.
+        var first = head;
+        while (first > oldest and ring.events[(first - 1) & RING_MASK].timestamp_ns >= start_ns) first -= 1;
+        var last = first;
+        while (last < head and ring.events[last & RING_MASK].timestamp_ns <= end_ns) last += 1;
+        if (last == first) continue;
+
+        const events = try a.alloc(Event, last - first);
+        for (events, first..) |*event, i| event.* = ring.events[i & RING_MASK];
+
+        // Anything the writer lapped while we copied may be torn.
+        const lapped = ring.head.load(.acquire) -| RING_CAPACITY;
+        const skip = @min(lapped -| first, events.len);
+        if (skip == events.len) continue;
+
+        try tracks.append(a, .{
+            .thread_id = ring.thread_id,
+            .name = try a.dupe(u8, std.mem.sliceTo(&ring.name, 0)),
+            .events = events[skip..],
+        });
+    }
+
+    var frames = std.ArrayListUnmanaged(FrameStats){};
+    var history: [FRAME_HISTORY]FrameStats = undefined;
+    for (frame_history(&history)) |frame| {
+        if (frame.end_ns >= start_ns and frame.end_ns <= end_ns) try frames.append(a, frame);
+    }
+
+    return .{ .arena = arena, .start_ns = start_ns, .end_ns = end_ns, .threads = tracks.items, .frames = frames.items };
+}
+
+fn write_varint(writer: anytype, value: u64) !void {
+    var v = value;
+    while (v >= 0x80) : (v >>= 7) try writer.writeByte(@as(u8, @truncate(v)) | 0x80);
+    try writer.writeByte(@truncate(v));
+}
+
+fn zigzag(value: i64) u64 {
+    const bits: u64 = @bitCast(value);
+    return (bits << 1) ^ @as(u64, @bitCast(value >> 63));
+}
+
+fn unzigzag(value: u64) i64 {
+    return @as(i64, @bitCast(value >> 1)) ^ -@as(i64, @bitCast(value & 1));
+}
+
+fn write_json_string(writer: anytype, text: []const u8) !void {
+    try writer.writeByte('"');
+    for (text) |ch| {
+        switch (ch) {
+            '"' => try writer.writeAll("\\\""),
+            '\\' => try writer.writeAll("\\\\"),
+            0...0x1f => try writer.print("\\u{x:0>4}", .{ch}),
+            else => try writer.writeByte(ch),
+        }
+    }
+    try writer.writeByte('"');
+}
+
+const ByteReader = struct {
+    data: []const u8,
+    pos: usize = 0,
+
+    fn take(self: *ByteReader, n: u64) ![]const u8 {
+        if (n > self.data.len - self.pos) return error.InvalidCapture;
+        const len: usize = @intCast(n);
+        defer self.pos += len;
+        return self.data[self.pos..][0..len];
+    }
+
+    fn byte(self: *ByteReader) !u8 {
+        return (try self.take(1))[0];
+    }
+
+    fn int(self: *ByteReader, comptime T: type) !T {
+        return std.mem.readInt(T, (try self.take(@sizeOf(T)))[0..@sizeOf(T)], .little);
+    }
+
+    fn varint(self: *ByteReader) !u64 {
+        var result: u64 = 0;
+        var shift: u32 = 0;
+        while (shift < 64) : (shift += 7) {
+            const b = try self.byte();
+            result |= @as(u64, b & 0x7f) << @intCast(shift);
+            if (b & 0x80 == 0) return result;
+        }
+        return error.InvalidCapture;
+    }
+};
+
+fn record_worker_zones(done: *std.atomic.Value(bool)) void {
+    set_thread_name("Test Worker");
+    for (0..3) |_| {
+        const z = zone("Worker Zone");
+        plot("Worker Counter", -7);
+        z.end();
+    }
+    done.store(true, .release);
+}
+
+test "zones, counters and frames round-trip through binary and chrome trace" {
+    memory.cardinal_memory_init(1024 * 1024);
+    defer memory.cardinal_memory_shutdown();
+
+    const allocator = std.testing.allocator;
+    const start = platform.get_time_ns();
+    set_recording(true);
+    {
+        const outer = zone("Outer");
+        defer outer.end();
+        const inner = zone("Inner \"quoted\"");
+        count(.jobs, 3);
+        count(.upload_bytes, 4096);
+        inner.end();
+    }
+    var done = std.atomic.Value(bool).init(false);
+    const thread = try std.Thread.spawn(.{}, record_worker_zones, .{&done});
+    thread.join();
+    try std.testing.expect(done.load(.acquire));
+    frame_mark();
+    set_recording(false);
+    const ignored = zone("Not Recorded");
+    ignored.end();
+
+    var cap = try capture(allocator, start, platform.get_time_ns());
+    defer cap.deinit();
+
+    try std.testing.expectEqual(@as(usize, 1), cap.frames.len);
+    try std.testing.expectEqual(@as(u64, 3), cap.frames[0].jobs);
+    try std.testing.expectEqual(@as(u64, 4096), cap.frames[0].upload_bytes);
+
+    var main_track: ?ThreadTrack = null;
+    var worker_track: ?ThreadTrack = null;
+    for (cap.threads) |track| {
+        if (std.mem.eql(u8, track.name, "Main")) main_track = track;
+        if (std.mem.eql(u8, track.name, "Test Worker")) worker_track = track;
+    }
+    // Outer/Inner begin+end, the frame and its four counters.
+    try std.testing.expectEqual(@as(usize, 9), main_track.?.events.len);
+    try std.testing.expectEqual(EventKind.begin, main_track.?.events[1].kind);
+    try std.testing.expectEqualStrings("Inner \"quoted\"", std.mem.span(main_track.?.events[1].name));
+    try std.testing.expectEqual(@as(usize, 9), worker_track.?.events.len);
+    try std.testing.expectEqual(@as(i64, -7), worker_track.?.events[1].value);
+
+    var bytes = std.ArrayListUnmanaged(u8){};
+    defer bytes.deinit(allocator);
+    try cap.write_binary(allocator, bytes.writer(allocator));
+    try std.testing.expect(bytes.items.len < cap.event_count() * @sizeOf(Event));
+
+    var loaded = try Capture.read_binary(allocator, bytes.items);
+    defer loaded.deinit();
+    try std.testing.expectEqual(cap.threads.len, loaded.threads.len);
+    try std.testing.expectEqual(cap.frames[0], loaded.frames[0]);
+    for (cap.threads, loaded.threads) |a, b| {
+        try std.testing.expectEqualStrings(a.name, b.name);
+        try std.testing.expectEqual(a.events.len, b.events.len);
+        for (a.events, b.events) |ea, eb| {
+            try std.testing.expectEqual(ea.kind, eb.kind);
+            try std.testing.expectEqual(ea.timestamp_ns, eb.timestamp_ns);
+            try std.testing.expectEqual(ea.value, eb.value);
+            try std.testing.expectEqualStrings(std.mem.span(ea.name), std.mem.span(eb.name));
+        }
+    }
+
+    var json = std.ArrayListUnmanaged(u8){};
+    defer json.deinit(allocator);
+    try loaded.write_chrome_trace(json.writer(allocator));
+    try std.testing.expect(std.mem.indexOf(u8, json.items, "\"name\":\"Inner \\\"quoted\\\"\",\"ph\":\"B\"") != null);
+    try std.testing.expect(std.mem.indexOf(u8, json.items, "\"args\":{\"name\":\"Test Worker\"}") != null);
+    try std.testing.expect(std.mem.indexOf(u8, json.items, "\"name\":\"Jobs\",\"ph\":\"C\"") != null);
+    try std.testing.expect(std.mem.indexOf(u8, json.items, "Not Recorded") == null);
+    const parsed = try std.json.parseFromSlice(std.json.Value, allocator, json.items, .{});
+    defer parsed.deinit();
+}
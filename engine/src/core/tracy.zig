@@ -1,11 +1,12 @@
 //! Tracy profiling integration.
 //!
-//! Exposes minimal wrappers around Tracy's C API. When Tracy is disabled at build time, all
-//! functions compile to no-ops.
+//! Exposes minimal wrappers around Tracy's C API. When Tracy is disabled at build time, the Tracy
+//! calls compile to no-ops; zones still feed the built-in profiler (`profiler.zig`).
 //!
 //! TODO: Add scoped allocator tags for long-lived allocations when Tracy is enabled.
 const std = @import("std");
 const build_options = @import("build_options");
+const profiler = @import("profiler.zig");
 
 pub const c = @cImport({
     if (build_options.enable_tracy) {
@@ -19,19 +20,25 @@ pub const enabled = build_options.enable_tracy;
 /// A scoped Tracy zone (RAII-style `end`).
 pub const Zone = if (enabled) struct {
     ctx: c.TracyCZoneCtx,
+    builtin_zone: profiler.Zone = .{},
 
     /// Ends the zone.
     pub fn end(self: Zone) void {
+        self.builtin_zone.end();
         c.___tracy_emit_zone_end(self.ctx);
     }
 } else struct {
-    /// Ends the zone (no-op when Tracy is disabled).
-    pub fn end(_: Zone) void {}
+    builtin_zone: profiler.Zone = .{},
+
+    /// Ends the zone (only the built-in profiler records when Tracy is disabled).
+    pub fn end(self: Zone) void {
+        self.builtin_zone.end();
+    }
 };
 
 /// Creates a named zone with unknown file/function metadata.
 pub fn zone(comptime name: [:0]const u8) Zone {
-    if (!enabled) return .{};
+    if (!enabled) return .{ .builtin_zone = profiler.zone(name) };
 
     const S = struct {
         var loc: c.___tracy_source_location_data = undefined;
@@ -47,12 +54,13 @@ pub fn zone(comptime name: [:0]const u8) Zone {
         S.initialized = true;
     }
 
-    return Zone{ .ctx = c.___tracy_emit_zone_begin(&S.loc, 1) };
+    return Zone{ .ctx = c.___tracy_emit_zone_begin(&S.loc, 1), .builtin_zone = profiler.zone(name) };
 }
 
 /// Creates a zone using compile-time source location metadata.
 pub fn zoneS(comptime src: std.builtin.SourceLocation, comptime name: ?[:0]const u8) Zone {
-    if (!enabled) return .{};
+    const label: [:0]const u8 = comptime name orelse src.fn_name;
+    if (!enabled) return .{ .builtin_zone = profiler.zone(label) };
 
     const S = struct {
         var loc: c.___tracy_source_location_data = undefined;
@@ -70,7 +78,7 @@ pub fn zoneS(comptime src: std.builtin.SourceLocation, comptime name: ?[:0]const
         S.initialized = true;
     }
 
-    return Zone{ .ctx = c.___tracy_emit_zone_begin(&S.loc, 1) };
+    return Zone{ .ctx = c.___tracy_emit_zone_begin(&S.loc, 1), .builtin_zone = profiler.zone(label) };
 }
 
 /// Emits a global frame marker.
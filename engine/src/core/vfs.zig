@@ -1,42 +1,290 @@
 //! Virtual filesystem facade.
 //!
-//! Provides a central place to route file reads/writes. The current implementation uses the
-//! process working directory, but call sites should prefer this module over `std.fs.cwd()`.
+//! Routes file reads through an ordered list of mount points. A mount is either a directory or a
+//! pack file (`pack_file.zig`) attached at a virtual prefix such as `assets`. Relative paths are
+//! resolved against mounts from the most recently mounted to the oldest, so patch packs mounted
+//! later override earlier content. Paths no mount provides, and absolute paths, fall back to the
+//! process working directory, which keeps loose-file development builds working unchanged.
 //!
-//! TODO: Add mount points and asset root resolution.
+//! `read_file` returns borrowed slices for stored pack entries; prefer it over `read_file_alloc`
+//! when the caller only needs the bytes for the duration of a load.
 
 const std = @import("std");
+const pack_file = @import("pack_file.zig");
+const log = @import("log.zig");
+
+const vfs_log = log.ScopedLogger("VFS");
+
+pub const MountKind = enum { directory, pack };
+
+const Mount = struct {
+    kind: MountKind,
+    /// Normalized virtual prefix without trailing `/`; empty mounts at the root.
+    prefix: []u8,
+    /// Directory path, or the pack's path for pack mounts.
+    source: []u8,
+    pack: ?*pack_file.PackFile = null,
+};
+
+var g_allocator: std.mem.Allocator = undefined;
+var g_mounts: std.ArrayListUnmanaged(Mount) = .{};
+var g_mounts_lock: std.Thread.RwLock = .{};
+
+/// File contents returned by `read_file`. Either owned by `allocator` or borrowed from a mapped
+/// pack, which stays alive until `deinit` even if it is unmounted meanwhile.
+pub const FileData = struct {
+    bytes: []const u8,
+    allocator: ?std.mem.Allocator = null,
+    pack: ?*pack_file.PackFile = null,
+
+    pub fn is_borrowed(self: *const FileData) bool {
+        return self.pack != null;
+    }
+
+    pub fn deinit(self: *FileData) void {
+        if (self.allocator) |allocator| allocator.free(self.bytes);
+        if (self.pack) |pack| pack.release();
+        self.* = .{ .bytes = &.{} };
+    }
+};
+
+/// Mounts the directory `dir_path` at the virtual prefix `mount_point`.
+pub fn mount_directory(allocator: std.mem.Allocator, dir_path: []const u8, mount_point: []const u8) !void {
+    var dir = try std.fs.cwd().openDir(dir_path, .{});
+    dir.close();
+    try add_mount(allocator, .directory, dir_path, mount_point, null);
+    vfs_log.info("Mounted directory '{s}' at '{s}'", .{ dir_path, mount_point });
+}
+
+/// Maps the pack at `pack_path` and mounts its entries below `mount_point`.
+pub fn mount_pack(allocator: std.mem.Allocator, pack_path: []const u8, mount_point: []const u8) !void {
+    const pack = try pack_file.PackFile.open(allocator, pack_path);
+    errdefer pack.release();
+    try add_mount(allocator, .pack, pack_path, mount_point, pack);
+    vfs_log.info("Mounted pack '{s}' ({d} entries) at '{s}'", .{ pack_path, pack.entries.len, mount_point });
+}
+
+/// Mounts every pack in `dir_path` at `mount_point`, in file name order so later names override
+/// earlier ones. Returns the number of packs mounted; a missing directory mounts nothing.
+pub fn mount_pack_directory(allocator: std.mem.Allocator, dir_path: []const u8, mount_point: []const u8) !usize {
+    var dir = std.fs.cwd().openDir(dir_path, .{ .iterate = true }) catch |err| switch (err) {
+        error.FileNotFound => return 0,
+        else => return err,
+    };
+    defer dir.close();
+
+    var names = std.ArrayListUnmanaged([]u8){};
+    defer {
+        for (names.items) |name| allocator.free(name);
+        names.deinit(allocator);
+    }
+
+    var it = dir.iterate();
+    while (try it.next()) |entry| {
+        if (entry.kind != .file or !std.mem.endsWith(u8, entry.name, pack_file.PACK_EXTENSION)) continue;
+        const name = try allocator.dupe(u8, entry.name);
+        names.append(allocator, name) catch |err| {
+            allocator.free(name);
+            return err;
+        };
+    }
+    std.mem.sort([]u8, names.items, {}, struct {
+        fn less(_: void, a: []u8, b: []u8) bool {
+            return std.mem.lessThan(u8, a, b);
+        }
+    }.less);
+
+    var mounted: usize = 0;
+    for (names.items) |name| {
+        const path = try std.fs.path.join(allocator, &[_][]const u8{ dir_path, name });
+        defer allocator.free(path);
+        mount_pack(allocator, path, mount_point) catch |err| {
+            vfs_log.err("Failed to mount pack '{s}': {s}", .{ path, @errorName(err) });
+            continue;
+        };
+        mounted += 1;
+    }
+    return mounted;
+}
+
+fn add_mount(allocator: std.mem.Allocator, kind: MountKind, source: []const u8, mount_point: []const u8, pack: ?*pack_file.PackFile) !void {
+    var buf: [std.fs.max_path_bytes]u8 = undefined;
+    const prefix = std.mem.trimRight(u8, try pack_file.normalize_path(&buf, mount_point), "/");
+
+    const owned_prefix = try allocator.dupe(u8, prefix);
+    errdefer allocator.free(owned_prefix);
+    const owned_source = try allocator.dupe(u8, source);
+    errdefer allocator.free(owned_source);
+
+    g_mounts_lock.lock();
+    defer g_mounts_lock.unlock();
+    if (g_mounts.items.len == 0) {
+        g_allocator = allocator;
+    } else if (g_allocator.ptr != allocator.ptr) {
+        return error.MountAllocatorMismatch;
+    }
+    try g_mounts.append(g_allocator, .{ .kind = kind, .prefix = owned_prefix, .source = owned_source, .pack = pack });
+}
+
+/// Removes the most recent mount whose source is `source`. Returns false if none matched.
+pub fn unmount(source: []const u8) bool {
+    g_mounts_lock.lock();
+    defer g_mounts_lock.unlock();
+
+    var i = g_mounts.items.len;
+    while (i > 0) {
+        i -= 1;
+        if (!std.mem.eql(u8, g_mounts.items[i].source, source)) continue;
+        const mount = g_mounts.orderedRemove(i);
+        free_mount(mount);
+        return true;
+    }
+    return false;
+}
+
+/// Removes all mounts. Borrowed `FileData` keeps its pack alive until released.
+pub fn unmount_all() void {
+    g_mounts_lock.lock();
+    defer g_mounts_lock.unlock();
+
+    for (g_mounts.items) |mount| free_mount(mount);
+    if (g_mounts.capacity > 0) g_mounts.deinit(g_allocator);
+    g_mounts = .{};
+}
+
+fn free_mount(mount: Mount) void {
+    if (mount.pack) |pack| pack.release();
+    g_allocator.free(mount.prefix);
+    g_allocator.free(mount.source);
+}
+
+/// Returns the path below `prefix`, or null when `path` lies outside it.
+fn strip_prefix(path: []const u8, prefix: []const u8) ?[]const u8 {
+    if (prefix.len == 0) return path;
+    if (!std.mem.startsWith(u8, path, prefix)) return null;
+    if (path.len == prefix.len) return "";
+    if (path[prefix.len] != '/') return null;
+    return path[prefix.len + 1 ..];
+}
+
+const Resolved = union(enum) {
+    pack: struct { pack: *pack_file.PackFile, entry: *const pack_file.PackEntry },
+    /// Host filesystem path, either below a directory mount or cwd-relative.
+    file: []const u8,
+};
+
+/// Resolves `path` against the mounts. Pack results are retained; host paths are written to
+/// `path_buf` unless `path` is used directly.
+fn resolve(path: []const u8, path_buf: *[std.fs.max_path_bytes]u8) Resolved {
+    if (std.fs.path.isAbsolute(path)) return .{ .file = path };
+
+    var norm_buf: [std.fs.max_path_bytes]u8 = undefined;
+    const normalized = pack_file.normalize_path(&norm_buf, path) catch return .{ .file = path };
+
+    g_mounts_lock.lockShared();
+    defer g_mounts_lock.unlockShared();
+
+    var i = g_mounts.items.len;
+    while (i > 0) {
+        i -= 1;
+        const mount = &g_mounts.items[i];
+        const rel = strip_prefix(normalized, mount.prefix) orelse continue;
+        switch (mount.kind) {
+            .pack => {
+                const pack = mount.pack.?;
+                const entry = pack.find(rel) orelse continue;
+                pack.retain();
+                return .{ .pack = .{ .pack = pack, .entry = entry } };
+            },
+            .directory => {
+                const host = std.fmt.bufPrint(path_buf, "{s}/{s}", .{ mount.source, rel }) catch continue;
+                std.fs.cwd().access(host, .{}) catch continue;
+                return .{ .file = host };
+            },
+        }
+    }
+    return .{ .file = path };
+}
+
+/// Reads the file at `path`. Stored pack entries are borrowed without copying; compressed
+/// entries and loose files are read into memory owned by `allocator`.
+pub fn read_file(allocator: std.mem.Allocator, path: []const u8) !FileData {
+    var path_buf: [std.fs.max_path_bytes]u8 = undefined;
+    switch (resolve(path, &path_buf)) {
+        .pack => |r| {
+            if (r.pack.borrow(r.entry)) |bytes| return .{ .bytes = bytes, .pack = r.pack };
+            defer r.pack.release();
+            return .{ .bytes = try r.pack.read_alloc(allocator, r.entry), .allocator = allocator };
+        },
+        .file => |host| {
+            const file = try std.fs.cwd().openFile(host, .{});
+            defer file.close();
+            return .{ .bytes = try file.readToEndAlloc(allocator, std.math.maxInt(usize)), .allocator = allocator };
+        },
+    }
+}
+
+/// Returns the host filesystem path `path` resolves to, or null when a mounted pack provides it.
+/// The result is either `path` itself or written to `path_buf`.
+pub fn host_path(path: []const u8, path_buf: *[std.fs.max_path_bytes]u8) ?[]const u8 {
+    switch (resolve(path, path_buf)) {
+        .pack => |r| {
+            r.pack.release();
+            return null;
+        },
+        .file => |host| return host,
+    }
+}
+
+/// Returns true if `path` resolves to a mounted entry or an existing host file.
+pub fn exists(path: []const u8) bool {
+    var path_buf: [std.fs.max_path_bytes]u8 = undefined;
+    switch (resolve(path, &path_buf)) {
+        .pack => |r| {
+            r.pack.release();
+            return true;
+        },
+        .file => |host| {
+            std.fs.cwd().access(host, .{}) catch return false;
+            return true;
+        },
+    }
+}
 
 /// Reads the entire file at `path` into an owned buffer.
 pub fn read_file_alloc(allocator: std.mem.Allocator, path: []const u8) ![]u8 {
-    const file = try std.fs.cwd().openFile(path, .{});
-    defer file.close();
-    return try file.readToEndAlloc(allocator, std.math.maxInt(usize));
+    var data = try read_file(allocator, path);
+    if (!data.is_borrowed()) return @constCast(data.bytes);
+    defer data.deinit();
+    return allocator.dupe(u8, data.bytes);
 }
 
 /// Reads a file into an owned `[]u32` slice, requiring 4-byte alignment.
 pub fn read_file_u32(allocator: std.mem.Allocator, path: []const u8) ![]u32 {
-    const file = try std.fs.cwd().openFile(path, .{});
-    defer file.close();
-
-    const stat = try file.stat();
-    if (stat.size == 0) return error.EmptyFile;
-    if (stat.size % 4 != 0) return error.InvalidWordAlignment;
-
-    const buffer = try allocator.alloc(u32, stat.size / 4);
-    errdefer allocator.free(buffer);
+    var data = try read_file(allocator, path);
+    defer data.deinit();
 
-    const bytes = std.mem.sliceAsBytes(buffer);
-    const read = try file.readAll(bytes);
-    if (read != stat.size) return error.IncompleteRead;
+    if (data.bytes.len == 0) return error.EmptyFile;
+    if (data.bytes.len % 4 != 0) return error.InvalidWordAlignment;
 
+    const buffer = try allocator.alloc(u32, data.bytes.len / 4);
+    @memcpy(std.mem.sliceAsBytes(buffer), data.bytes);
     return buffer;
 }
 
-/// Returns the file modification time in nanoseconds.
+/// Returns the file modification time in nanoseconds. Pack entries report the pack's mtime.
 pub fn get_mtime_ns(path: []const u8) !u64 {
-    const stat = try std.fs.cwd().statFile(path);
-    return @intCast(@max(stat.mtime, 0));
+    var path_buf: [std.fs.max_path_bytes]u8 = undefined;
+    switch (resolve(path, &path_buf)) {
+        .pack => |r| {
+            defer r.pack.release();
+            return r.pack.mtime_ns;
+        },
+        .file => |host| {
+            const stat = try std.fs.cwd().statFile(host);
+            return @intCast(@max(stat.mtime, 0));
+        },
+    }
 }
 
 /// Writes `data` to `path`, truncating or creating the file.
@@ -53,3 +301,49 @@ pub fn write_file_parts(path: []const u8, header: []const u8, body: []const u8)
     try file.writeAll(header);
     try file.writeAll(body);
 }
+
+test "vfs mounts override in mount order and borrow stored pack entries" {
+    const allocator = std.testing.allocator;
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+
+    const root = try tmp.dir.realpathAlloc(allocator, ".");
+    defer allocator.free(root);
+
+    try tmp.dir.makePath("loose/textures");
+    try tmp.dir.writeFile(.{ .sub_path = "loose/textures/a.txt", .data = "loose a" });
+    try tmp.dir.writeFile(.{ .sub_path = "loose/textures/b.txt", .data = "loose b" });
+
+    const pack_path = try std.fs.path.join(allocator, &[_][]const u8{ root, "patch.cpak" });
+    defer allocator.free(pack_path);
+    {
+        var builder = pack_file.PackBuilder.init(allocator);
+        defer builder.deinit();
+        try builder.add_bytes("textures/a.txt", "packed a");
+        _ = try builder.write(pack_path, .{});
+    }
+
+    const loose_path = try std.fs.path.join(allocator, &[_][]const u8{ root, "loose" });
+    defer allocator.free(loose_path);
+    try mount_directory(allocator, loose_path, "game");
+    try mount_pack(allocator, pack_path, "game/");
+    defer unmount_all();
+
+    var a = try read_file(allocator, "game/textures/a.txt");
+    try std.testing.expect(a.is_borrowed());
+    try std.testing.expectEqualStrings("packed a", a.bytes);
+
+    // The borrowed slice outlives the mount.
+    try std.testing.expect(unmount(pack_path));
+    try std.testing.expectEqualStrings("packed a", a.bytes);
+    a.deinit();
+
+    const b = try read_file_alloc(allocator, "./game\\textures/b.txt");
+    defer allocator.free(b);
+    try std.testing.expectEqualStrings("loose b", b);
+
+    const a_loose = try read_file_alloc(allocator, "game/textures/a.txt");
+    defer allocator.free(a_loose);
+    try std.testing.expectEqualStrings("loose a", a_loose);
+    try std.testing.expect(!exists("game/textures/missing.txt"));
+}
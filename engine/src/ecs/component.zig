@@ -2,19 +2,33 @@
 //!
 //! Components are stored in per-type sparse sets. This file provides a type-erased storage
 //! interface and a generic `SparseSet(T)` implementation.
+//!
+//! Every dense entry also records the change tick at which it was added and last changed, and
+//! every run of `change_chunk_size` entries keeps the newest of those ticks, so "what changed
+//! since tick N" skips untouched chunks without reading their entries.
 const std = @import("std");
 const entity_pkg = @import("entity.zig");
 const Entity = entity_pkg.Entity;
 
+const change_chunk_shift: comptime_int = 6;
+/// Dense entries per change summary chunk.
+pub const change_chunk_size: usize = 1 << change_chunk_shift;
+
 /// Type-erased interface for component storages.
 pub const StorageInterface = struct {
     ptr: *anyopaque,
     remove_fn: *const fn (ptr: *anyopaque, entity: Entity) void,
+    set_tick_fn: *const fn (ptr: *anyopaque, tick: u32) void,
 
     /// Removes all data for `entity` from the underlying storage.
     pub fn remove(self: StorageInterface, entity: Entity) void {
         self.remove_fn(self.ptr, entity);
     }
+
+    /// Sets the tick stamped on later additions and changes.
+    pub fn set_tick(self: StorageInterface, tick: u32) void {
+        self.set_tick_fn(self.ptr, tick);
+    }
 };
 
 /// Sparse-set storage for a component type `T`.
@@ -30,6 +44,24 @@ pub fn SparseSet(comptime T: type) type {
         /// Dense component storage parallel to `packed_entities`.
         components: std.ArrayListUnmanaged(T),
 
+        /// Tick at which each dense entry was added, parallel to `packed_entities`.
+        added_ticks: std.ArrayListUnmanaged(u32),
+        /// Tick at which each dense entry was last added or changed.
+        changed_ticks: std.ArrayListUnmanaged(u32),
+        /// Newest `added_ticks` entry per `change_chunk_size` dense entries. May be newer than
+        /// any entry left in the chunk after removals.
+        chunk_added: std.ArrayListUnmanaged(u32),
+        /// Newest `changed_ticks` entry per chunk, with the same slack.
+        chunk_changed: std.ArrayListUnmanaged(u32),
+        /// Newest tick stamped on anything in the set.
+        last_added: u32,
+        last_changed: u32,
+        /// Tick of the newest removal. Removed entries leave no per-entry trace, so consumers
+        /// that mirror the set fall back to a full pass when this moves.
+        last_removed: u32,
+        /// Stamped on additions and changes; kept current by the owning registry.
+        tick: u32,
+
         allocator: std.mem.Allocator,
 
         const empty_dense_index = std.math.maxInt(u32);
@@ -44,6 +76,14 @@ pub fn SparseSet(comptime T: type) type {
                 .sparse_chunks = .{},
                 .packed_entities = .{},
                 .components = .{},
+                .added_ticks = .{},
+                .changed_ticks = .{},
+                .chunk_added = .{},
+                .chunk_changed = .{},
+                .last_added = 0,
+                .last_changed = 0,
+                .last_removed = 0,
+                .tick = 1,
                 .allocator = allocator,
             };
         }
@@ -58,6 +98,10 @@ pub fn SparseSet(comptime T: type) type {
             self.sparse_chunks.deinit(self.allocator);
             self.packed_entities.deinit(self.allocator);
             self.components.deinit(self.allocator);
+            self.added_ticks.deinit(self.allocator);
+            self.changed_ticks.deinit(self.allocator);
+            self.chunk_added.deinit(self.allocator);
+            self.chunk_changed.deinit(self.allocator);
         }
 
         fn assure_chunk(self: *Self, chunk_index: usize) !*SparseChunk {
@@ -100,26 +144,90 @@ pub fn SparseSet(comptime T: type) type {
 
             if (dense_idx != empty_dense_index and dense_idx < self.packed_entities.items.len) {
                 self.components.items[dense_idx] = component;
+                // A stale slot reused by a new generation is a new component, not a change.
+                if (self.packed_entities.items[dense_idx].id != entity.id) self.stamp_added(dense_idx);
                 self.packed_entities.items[dense_idx] = entity;
+                self.stamp_changed(dense_idx);
             } else {
                 const new_dense_idx = @as(u32, @intCast(self.packed_entities.items.len));
-                try self.packed_entities.append(self.allocator, entity);
-                try self.components.append(self.allocator, component);
+                const chunk_count = (self.packed_entities.items.len >> change_chunk_shift) + 1;
+                try self.packed_entities.ensureUnusedCapacity(self.allocator, 1);
+                try self.components.ensureUnusedCapacity(self.allocator, 1);
+                try self.added_ticks.ensureUnusedCapacity(self.allocator, 1);
+                try self.changed_ticks.ensureUnusedCapacity(self.allocator, 1);
+                try self.chunk_added.ensureTotalCapacity(self.allocator, chunk_count);
+                try self.chunk_changed.ensureTotalCapacity(self.allocator, chunk_count);
+
+                self.packed_entities.appendAssumeCapacity(entity);
+                self.components.appendAssumeCapacity(component);
+                self.added_ticks.appendAssumeCapacity(0);
+                self.changed_ticks.appendAssumeCapacity(0);
+                if (self.chunk_added.items.len < chunk_count) {
+                    self.chunk_added.appendAssumeCapacity(0);
+                    self.chunk_changed.appendAssumeCapacity(0);
+                }
+                self.stamp_added(new_dense_idx);
+                self.stamp_changed(new_dense_idx);
                 slot.* = new_dense_idx;
             }
         }
 
-        /// Returns a mutable pointer to `T` for `entity` if present and generation matches.
-        pub fn get(self: *Self, entity: Entity) ?*T {
-            const slot = self.get_slot_ptr(entity.index()) orelse return null;
-            const dense_idx = slot.*;
+        fn dense_index_of(self: *const Self, entity: Entity) ?u32 {
+            const idx: usize = @intCast(entity.index());
+            const chunk_index = idx >> sparse_chunk_shift;
+            if (chunk_index >= self.sparse_chunks.items.len) return null;
+            const chunk = self.sparse_chunks.items[chunk_index] orelse return null;
+            const dense_idx = chunk[idx & sparse_chunk_mask];
             if (dense_idx == empty_dense_index) return null;
             if (dense_idx >= self.packed_entities.items.len) return null;
             if (self.packed_entities.items[dense_idx].id != entity.id) return null;
+            return dense_idx;
+        }
+
+        fn stamp_added(self: *Self, dense_idx: u32) void {
+            self.added_ticks.items[dense_idx] = self.tick;
+            self.chunk_added.items[dense_idx >> change_chunk_shift] = self.tick;
+            self.last_added = self.tick;
+        }
+
+        fn stamp_changed(self: *Self, dense_idx: u32) void {
+            self.changed_ticks.items[dense_idx] = self.tick;
+            self.chunk_changed.items[dense_idx >> change_chunk_shift] = self.tick;
+            self.last_changed = self.tick;
+        }
 
+        /// Returns a mutable pointer to `T` for `entity` if present and generation matches, and
+        /// marks it changed.
+        pub fn get(self: *Self, entity: Entity) ?*T {
+            const dense_idx = self.dense_index_of(entity) orelse return null;
+            self.stamp_changed(dense_idx);
             return &self.components.items[dense_idx];
         }
 
+        /// Like `get` for reading: does not mark the component changed.
+        pub fn get_const(self: *const Self, entity: Entity) ?*const T {
+            const dense_idx = self.dense_index_of(entity) orelse return null;
+            return &self.components.items[dense_idx];
+        }
+
+        /// Like `get` without marking the component changed. For callers that only sometimes
+        /// write and call `mark_changed` when they do.
+        pub fn get_untracked(self: *Self, entity: Entity) ?*T {
+            const dense_idx = self.dense_index_of(entity) orelse return null;
+            return &self.components.items[dense_idx];
+        }
+
+        /// Marks the component of `entity` changed at the current tick.
+        pub fn mark_changed(self: *Self, entity: Entity) void {
+            const dense_idx = self.dense_index_of(entity) orelse return;
+            self.stamp_changed(dense_idx);
+        }
+
+        /// Marks the dense entry at `dense_idx` changed; for iterators handing out `*T`.
+        pub fn mark_changed_at(self: *Self, dense_idx: usize) void {
+            self.stamp_changed(@intCast(dense_idx));
+        }
+
         /// Removes `entity` from the set if present.
         pub fn remove(self: *Self, entity: Entity) void {
             const slot = self.get_slot_ptr(entity.index()) orelse return;
@@ -134,6 +242,15 @@ pub fn SparseSet(comptime T: type) type {
             self.packed_entities.items[dense_idx] = last_entity;
             self.components.items[dense_idx] = self.components.items[last_idx];
 
+            // The moved entry keeps its ticks; its new chunk's summary must cover them.
+            const added = self.added_ticks.items[last_idx];
+            const changed = self.changed_ticks.items[last_idx];
+            self.added_ticks.items[dense_idx] = added;
+            self.changed_ticks.items[dense_idx] = changed;
+            const chunk = dense_idx >> change_chunk_shift;
+            self.chunk_added.items[chunk] = @max(self.chunk_added.items[chunk], added);
+            self.chunk_changed.items[chunk] = @max(self.chunk_changed.items[chunk], changed);
+
             if (self.get_slot_ptr(last_entity.index())) |moved_slot| {
                 moved_slot.* = @intCast(dense_idx);
             }
@@ -142,6 +259,13 @@ pub fn SparseSet(comptime T: type) type {
 
             _ = self.packed_entities.pop();
             _ = self.components.pop();
+            _ = self.added_ticks.pop();
+            _ = self.changed_ticks.pop();
+            if (last_idx & (change_chunk_size - 1) == 0) {
+                _ = self.chunk_added.pop();
+                _ = self.chunk_changed.pop();
+            }
+            self.last_removed = self.tick;
         }
 
         /// Returns true if `entity` exists in the set and generation matches.
@@ -155,8 +279,13 @@ pub fn SparseSet(comptime T: type) type {
 
         /// Removes all entities and components, retaining capacity.
         pub fn clear(self: *Self) void {
+            if (self.packed_entities.items.len > 0) self.last_removed = self.tick;
             self.packed_entities.clearRetainingCapacity();
             self.components.clearRetainingCapacity();
+            self.added_ticks.clearRetainingCapacity();
+            self.changed_ticks.clearRetainingCapacity();
+            self.chunk_added.clearRetainingCapacity();
+            self.chunk_changed.clearRetainingCapacity();
             for (self.sparse_chunks.items) |chunk_opt| {
                 if (chunk_opt) |chunk| {
                     @memset(chunk, empty_dense_index);
@@ -164,16 +293,65 @@ pub fn SparseSet(comptime T: type) type {
             }
         }
 
+        /// Iterator over the entries added (`added` = true) or changed after a tick.
+        pub const ChangeIterator = struct {
+            storage: ?*const Self,
+            since: u32,
+            added: bool,
+            index: usize = 0,
+
+            /// Returns the next dense index whose tick is newer than `since`.
+            pub fn next_index(self: *ChangeIterator) ?usize {
+                const s = self.storage orelse return null;
+                const ticks = if (self.added) s.added_ticks.items else s.changed_ticks.items;
+                const summary = if (self.added) s.chunk_added.items else s.chunk_changed.items;
+                while (self.index < ticks.len) {
+                    const chunk = self.index >> change_chunk_shift;
+                    if (summary[chunk] <= self.since) {
+                        self.index = (chunk + 1) << change_chunk_shift;
+                        continue;
+                    }
+                    const i = self.index;
+                    self.index += 1;
+                    if (ticks[i] > self.since) return i;
+                }
+                return null;
+            }
+
+            /// Returns the next touched entity and its component, read-only.
+            pub fn next(self: *ChangeIterator) ?struct { entity: Entity, component: *const T } {
+                const i = self.next_index() orelse return null;
+                const s = self.storage.?;
+                return .{ .entity = s.packed_entities.items[i], .component = &s.components.items[i] };
+            }
+        };
+
+        /// Entries changed (including added) after tick `since`.
+        pub fn changed_since(self: *const Self, since: u32) ChangeIterator {
+            return .{ .storage = self, .since = since, .added = false };
+        }
+
+        /// Entries added after tick `since`.
+        pub fn added_since(self: *const Self, since: u32) ChangeIterator {
+            return .{ .storage = self, .since = since, .added = true };
+        }
+
         fn remove_wrapper(ptr: *anyopaque, entity: Entity) void {
             const self: *Self = @ptrCast(@alignCast(ptr));
             self.remove(entity);
         }
 
+        fn set_tick_wrapper(ptr: *anyopaque, tick: u32) void {
+            const self: *Self = @ptrCast(@alignCast(ptr));
+            self.tick = tick;
+        }
+
         /// Returns a type-erased interface for the storage.
         pub fn interface(self: *Self) StorageInterface {
             return .{
                 .ptr = self,
                 .remove_fn = remove_wrapper,
+                .set_tick_fn = set_tick_wrapper,
             };
         }
     };
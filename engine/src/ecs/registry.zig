@@ -2,6 +2,11 @@
 //!
 //! `Registry` owns entity creation and type-erased component storages. It also provides
 //! lightweight view iterators over one or more component types.
+//!
+//! Storages record the registry's change tick when a component is added or handed out mutably
+//! (`get`, mutable view iteration), so `view_changed`/`view_added` can visit just what was touched
+//! since a consumer last looked. Read-only paths (`get_const`, `const_iterator`) leave ticks alone;
+//! code that reads every frame should use them or it will report everything as changed.
 const std = @import("std");
 const entity_pkg = @import("entity.zig");
 const component_pkg = @import("component.zig");
@@ -10,12 +15,19 @@ const archetype_pkg = @import("archetype.zig");
 /// ECS entity handle type.
 pub const Entity = entity_pkg.Entity;
 
+/// Source of `Registry.epoch`, so cursors notice a registry that was replaced in place.
+var next_epoch = std.atomic.Value(u64).init(1);
+
 /// Stores entities and per-component sparse-set storages.
 pub const Registry = struct {
     entity_manager: entity_pkg.EntityManager,
     /// Maps component type IDs to a type-erased storage interface and its deinit function.
     storages: std.AutoHashMapUnmanaged(u64, StorageEntry),
     archetypes: archetype_pkg.ArchetypeStorage,
+    /// Stamped on component additions and changes; see `advance_tick`.
+    change_tick: u32,
+    /// Unique per `init`, for `ChangeCursor`.
+    epoch: u64,
 
     allocator: std.mem.Allocator,
 
@@ -30,6 +42,8 @@ pub const Registry = struct {
             .entity_manager = entity_pkg.EntityManager.init(allocator),
             .storages = .{},
             .archetypes = archetype_pkg.ArchetypeStorage.init(allocator),
+            .change_tick = 1,
+            .epoch = next_epoch.fetchAdd(1, .monotonic),
             .allocator = allocator,
         };
     }
@@ -85,6 +99,7 @@ pub const Registry = struct {
 
         const storage = try self.allocator.create(component_pkg.SparseSet(T));
         storage.* = component_pkg.SparseSet(T).init(self.allocator);
+        storage.tick = self.change_tick;
 
         try self.storages.put(self.allocator, id, .{
             .interface = storage.interface(),
@@ -109,24 +124,84 @@ pub const Registry = struct {
         }
     }
 
-    /// Returns a mutable pointer to `T` for `entity` if present.
+    fn find_storage(self: *const Registry, comptime T: type) ?*component_pkg.SparseSet(T) {
+        const entry = self.storages.get(get_type_id(T)) orelse return null;
+        return @ptrCast(@alignCast(entry.interface.ptr));
+    }
+
+    /// Returns a mutable pointer to `T` for `entity` if present, marking it changed.
     pub fn get(self: *Registry, comptime T: type, entity: Entity) ?*T {
-        const id = get_type_id(T);
-        if (self.storages.get(id)) |entry| {
-            const storage: *component_pkg.SparseSet(T) = @ptrCast(@alignCast(entry.interface.ptr));
-            return storage.get(entity);
-        }
-        return null;
+        const storage = self.find_storage(T) orelse return null;
+        return storage.get(entity);
+    }
+
+    /// Returns `T` for `entity` if present, for reading; does not mark it changed.
+    pub fn get_const(self: *const Registry, comptime T: type, entity: Entity) ?*const T {
+        const storage = self.find_storage(T) orelse return null;
+        return storage.get_const(entity);
+    }
+
+    /// Returns a mutable pointer to `T` without marking it changed. Call `mark_changed` after
+    /// actually writing through it.
+    pub fn get_untracked(self: *Registry, comptime T: type, entity: Entity) ?*T {
+        const storage = self.find_storage(T) orelse return null;
+        return storage.get_untracked(entity);
+    }
+
+    /// Marks the `T` component of `entity` changed at the current tick.
+    pub fn mark_changed(self: *Registry, comptime T: type, entity: Entity) void {
+        const storage = self.find_storage(T) orelse return;
+        storage.mark_changed(entity);
+    }
+
+    /// The tick stamped on additions and changes right now.
+    pub fn current_tick(self: *const Registry) u32 {
+        return self.change_tick;
+    }
+
+    /// Ends the current tick and returns it. Everything stamped so far is at or below the returned
+    /// value and everything stamped later is above it, so a consumer that has just read the
+    /// changes passes the returned value as `since` next time (see `ChangeCursor`).
+    pub fn advance_tick(self: *Registry) u32 {
+        const ended = self.change_tick;
+        self.change_tick += 1;
+        var it = self.storages.valueIterator();
+        while (it.next()) |entry| entry.interface.set_tick(self.change_tick);
+        return ended;
+    }
+
+    /// Whether any `T` was added or changed after tick `since`. O(1).
+    pub fn any_changed(self: *const Registry, comptime T: type, since: u32) bool {
+        const storage = self.find_storage(T) orelse return false;
+        return storage.last_changed > since;
+    }
+
+    /// Whether any `T` was added after tick `since`. O(1).
+    pub fn any_added(self: *const Registry, comptime T: type, since: u32) bool {
+        const storage = self.find_storage(T) orelse return false;
+        return storage.last_added > since;
+    }
+
+    /// Whether any `T` was removed after tick `since`. O(1).
+    pub fn any_removed(self: *const Registry, comptime T: type, since: u32) bool {
+        const storage = self.find_storage(T) orelse return false;
+        return storage.last_removed > since;
+    }
+
+    /// Read-only view over the `T` components added or changed after tick `since`. Skips chunks
+    /// of untouched entries, so the cost follows the number of changes rather than of entities.
+    pub fn view_changed(self: *const Registry, comptime T: type, since: u32) ChangeView(T) {
+        return .{ .storage = self.find_storage(T), .since = since, .added = false };
+    }
+
+    /// Read-only view over the `T` components added after tick `since`.
+    pub fn view_added(self: *const Registry, comptime T: type, since: u32) ChangeView(T) {
+        return .{ .storage = self.find_storage(T), .since = since, .added = true };
     }
 
     /// Returns a single-component view over `T`.
     pub fn view(self: *Registry, comptime T: type) View(T) {
-        const id = get_type_id(T);
-        if (self.storages.get(id)) |entry| {
-            const storage: *component_pkg.SparseSet(T) = @ptrCast(@alignCast(entry.interface.ptr));
-            return View(T){ .storage = storage };
-        }
-        return View(T){ .storage = null };
+        return View(T){ .storage = self.find_storage(T) };
     }
 
     /// Returns a multi-component view over the types in `types_tuple` (e.g. `.{ A, B, C }`).
@@ -146,12 +221,51 @@ pub const Registry = struct {
     }
 };
 
+/// Tracks how far a consumer has read a registry's changes.
+///
+///     const since = cursor.begin(&registry);
+///     var it = registry.view_changed(Transform, since).iterator();
+///     while (it.next()) |entry| { ... }
+///     cursor.end(&registry);
+pub const ChangeCursor = struct {
+    epoch: u64 = 0,
+    tick: u32 = 0,
+
+    /// The tick to pass as `since`. 0, which reports everything, on first use or when the
+    /// registry was re-initialized since the last `end`.
+    pub fn begin(self: *const ChangeCursor, registry: *const Registry) u32 {
+        return if (self.epoch == registry.epoch) self.tick else 0;
+    }
+
+    /// Records that everything up to now has been read. Writes the consumer made while reading
+    /// are included, so it does not see its own writes again.
+    pub fn end(self: *ChangeCursor, registry: *Registry) void {
+        self.epoch = registry.epoch;
+        self.tick = registry.advance_tick();
+    }
+};
+
+/// Read-only view over the components of one type added or changed after a tick.
+pub fn ChangeView(comptime T: type) type {
+    return struct {
+        storage: ?*const component_pkg.SparseSet(T),
+        since: u32,
+        added: bool,
+
+        pub const Iterator = component_pkg.SparseSet(T).ChangeIterator;
+
+        pub fn iterator(self: @This()) Iterator {
+            return .{ .storage = self.storage, .since = self.since, .added = self.added };
+        }
+    };
+}
+
 /// A single-component view with a simple iterator.
 pub fn View(comptime T: type) type {
     return struct {
         storage: ?*component_pkg.SparseSet(T),
 
-        /// Iterator over `(entity, component)` pairs.
+        /// Iterator over `(entity, component)` pairs. Handing out `*T` marks each entry changed.
         pub const Iterator = struct {
             storage: ?*component_pkg.SparseSet(T),
             index: usize,
@@ -162,6 +276,7 @@ pub fn View(comptime T: type) type {
                     if (self.index >= s.packed_entities.items.len) return null;
                     const i = self.index;
                     self.index += 1;
+                    s.mark_changed_at(i);
                     return .{
                         .entity = s.packed_entities.items[i],
                         .component = &s.components.items[i],
@@ -171,15 +286,39 @@ pub fn View(comptime T: type) type {
             }
         };
 
+        /// Iterator over `(entity, component)` pairs for reading; leaves change ticks alone.
+        pub const ConstIterator = struct {
+            storage: ?*const component_pkg.SparseSet(T),
+            index: usize,
+
+            /// Returns the next entry, or null when finished.
+            pub fn next(self: *ConstIterator) ?struct { entity: Entity, component: *const T } {
+                const s = self.storage orelse return null;
+                if (self.index >= s.packed_entities.items.len) return null;
+                const i = self.index;
+                self.index += 1;
+                return .{
+                    .entity = s.packed_entities.items[i],
+                    .component = &s.components.items[i],
+                };
+            }
+        };
+
         /// Returns an iterator starting at the beginning of the view.
         pub fn iterator(self: @This()) Iterator {
             return .{ .storage = self.storage, .index = 0 };
         }
 
+        /// Returns a read-only iterator starting at the beginning of the view.
+        pub fn const_iterator(self: @This()) ConstIterator {
+            return .{ .storage = self.storage, .index = 0 };
+        }
+
         /// Iterates all entries and calls `callback(context, entity, component)`.
         pub fn each(self: @This(), context: anytype, callback: fn (@TypeOf(context), Entity, *T) void) void {
             if (self.storage) |s| {
-                for (s.packed_entities.items, s.components.items) |e, *c| {
+                for (s.packed_entities.items, s.components.items, 0..) |e, *c, i| {
+                    s.mark_changed_at(i);
                     callback(context, e, c);
                 }
             }
@@ -207,50 +346,75 @@ pub fn MultiView(comptime types_tuple: anytype) type {
         break :blk std.meta.Tuple(&types);
     };
 
+    const ConstComponentsTuple = blk: {
+        var types: [Count]type = undefined;
+        inline for (types_tuple, 0..) |T, i| {
+            types[i] = *const T;
+        }
+        break :blk std.meta.Tuple(&types);
+    };
+
     return struct {
         storages: [Count]?*anyopaque,
 
-        /// Iterator over `(entity, tuple(*T0, *T1, ...))` entries.
-        pub const Iterator = struct {
-            storages: [Count]?*anyopaque,
-            entities: []const Entity,
-            index: usize,
-
-            /// Returns the next matching entity and its component pointers.
-            pub fn next(self: *Iterator) ?struct { entity: Entity, components: ComponentsTuple } {
-                while (self.index < self.entities.len) {
-                    const entity = self.entities[self.index];
-                    self.index += 1;
-
-                    var all_present = true;
-                    inline for (types_tuple, 0..) |T, i| {
-                        if (self.storages[i]) |ptr| {
-                            const storage: *component_pkg.SparseSet(T) = @ptrCast(@alignCast(ptr));
-                            if (!storage.has(entity)) {
+        /// Iterator over `(entity, tuple(*T0, *T1, ...))` entries. Marks every component it hands
+        /// out as changed.
+        pub const Iterator = IteratorImpl(true);
+        /// Iterator over `(entity, tuple(*const T0, ...))` entries; leaves change ticks alone.
+        pub const ConstIterator = IteratorImpl(false);
+
+        fn IteratorImpl(comptime mutable: bool) type {
+            const Tuple = if (mutable) ComponentsTuple else ConstComponentsTuple;
+            return struct {
+                storages: [Count]?*anyopaque,
+                entities: []const Entity,
+                index: usize,
+
+                /// Returns the next matching entity and its component pointers.
+                pub fn next(self: *@This()) ?struct { entity: Entity, components: Tuple } {
+                    while (self.index < self.entities.len) {
+                        const entity = self.entities[self.index];
+                        self.index += 1;
+
+                        var all_present = true;
+                        inline for (types_tuple, 0..) |T, i| {
+                            if (self.storages[i]) |ptr| {
+                                const storage: *component_pkg.SparseSet(T) = @ptrCast(@alignCast(ptr));
+                                if (!storage.has(entity)) {
+                                    all_present = false;
+                                }
+                            } else {
                                 all_present = false;
                             }
-                        } else {
-                            all_present = false;
                         }
-                    }
 
-                    if (!all_present) continue;
+                        if (!all_present) continue;
 
-                    var components: ComponentsTuple = undefined;
-                    inline for (types_tuple, 0..) |T, i| {
-                        if (self.storages[i]) |ptr| {
-                            const storage: *component_pkg.SparseSet(T) = @ptrCast(@alignCast(ptr));
-                            components[i] = storage.get(entity).?;
+                        var components: Tuple = undefined;
+                        inline for (types_tuple, 0..) |T, i| {
+                            if (self.storages[i]) |ptr| {
+                                const storage: *component_pkg.SparseSet(T) = @ptrCast(@alignCast(ptr));
+                                components[i] = if (mutable) storage.get(entity).? else storage.get_const(entity).?;
+                            }
                         }
+                        return .{ .entity = entity, .components = components };
                     }
-                    return .{ .entity = entity, .components = components };
+                    return null;
                 }
-                return null;
-            }
-        };
+            };
+        }
 
         /// Chooses a base storage and returns an iterator over matching entities.
         pub fn iterator(self: @This()) Iterator {
+            return self.iterator_impl(Iterator);
+        }
+
+        /// Like `iterator`, yielding `*const` components.
+        pub fn const_iterator(self: @This()) ConstIterator {
+            return self.iterator_impl(ConstIterator);
+        }
+
+        fn iterator_impl(self: @This(), comptime It: type) It {
             var min_count: usize = std.math.maxInt(usize);
             var best_index: usize = 0;
             var any_missing = false;
@@ -269,7 +433,7 @@ pub fn MultiView(comptime types_tuple: anytype) type {
             }
 
             if (any_missing) {
-                return Iterator{
+                return It{
                     .storages = self.storages,
                     .entities = &.{},
                     .index = 0,
@@ -284,7 +448,7 @@ pub fn MultiView(comptime types_tuple: anytype) type {
                 }
             }
 
-            return Iterator{
+            return It{
                 .storages = self.storages,
                 .entities = entities,
                 .index = 0,
@@ -374,3 +538,58 @@ test "MultiView iteration" {
     }
     try std.testing.expectEqual(@as(usize, 1), count_abc);
 }
+
+test "changed-only views follow change ticks" {
+    const allocator = std.testing.allocator;
+    var registry = Registry.init(allocator);
+    defer registry.deinit();
+
+    const Pos = struct { x: f32 };
+
+    var entities: [200]Entity = undefined;
+    for (&entities, 0..) |*e, i| {
+        e.* = try registry.create();
+        try registry.add(e.*, Pos{ .x = @floatFromInt(i) });
+    }
+
+    var cursor = ChangeCursor{};
+    var count: usize = 0;
+    var it = registry.view_changed(Pos, cursor.begin(&registry)).iterator();
+    while (it.next()) |_| count += 1;
+    try std.testing.expectEqual(@as(usize, 200), count);
+    cursor.end(&registry);
+
+    // Reads do not count as changes.
+    _ = registry.get_const(Pos, entities[3]);
+    var read_it = registry.view(Pos).const_iterator();
+    while (read_it.next()) |_| {}
+    try std.testing.expect(!registry.any_changed(Pos, cursor.begin(&registry)));
+
+    registry.get(Pos, entities[150]).?.x = -1.0;
+    registry.get_untracked(Pos, entities[10]).?.x = -2.0;
+    registry.mark_changed(Pos, entities[10]);
+    // Swap-removal moves the last entry into slot 0; it keeps its old ticks.
+    registry.remove(Pos, entities[0]);
+
+    var changed: [4]u32 = undefined;
+    count = 0;
+    it = registry.view_changed(Pos, cursor.begin(&registry)).iterator();
+    while (it.next()) |entry| : (count += 1) changed[count] = entry.entity.index();
+    try std.testing.expectEqual(@as(usize, 2), count);
+    try std.testing.expectEqual(entities[10].index(), changed[0]);
+    try std.testing.expectEqual(entities[150].index(), changed[1]);
+
+    const late = try registry.create();
+    try registry.add(late, Pos{ .x = 0.0 });
+    count = 0;
+    var added_it = registry.view_added(Pos, cursor.begin(&registry)).iterator();
+    while (added_it.next()) |entry| : (count += 1) try std.testing.expectEqual(late.id, entry.entity.id);
+    try std.testing.expectEqual(@as(usize, 1), count);
+    cursor.end(&registry);
+    try std.testing.expect(!registry.any_changed(Pos, cursor.begin(&registry)));
+
+    // A re-initialized registry reports everything to an old cursor.
+    registry.deinit();
+    registry = Registry.init(allocator);
+    try std.testing.expectEqual(@as(u32, 0), cursor.begin(&registry));
+}
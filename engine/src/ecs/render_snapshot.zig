@@ -0,0 +1,236 @@
+//! Render snapshots: the extract stage between ECS simulation and rendering.
+//!
+//! `extract` copies everything the renderer consumes (mesh instances with world matrices, lights,
+//! and the active camera) out of the registry into plain arrays. Once extracted, a snapshot is
+//! immutable and self-contained, so the renderer can record it while simulation keeps mutating
+//! the registry for the next frame.
+const std = @import("std");
+const registry_pkg = @import("registry.zig");
+const components = @import("components.zig");
+const entity_pkg = @import("entity.zig");
+const handles = @import("../core/handles.zig");
+const math = @import("../core/math.zig");
+const pbr = @import("../renderer/vulkan_types_pbr.zig");
+
+/// Active camera state resolved at extraction time.
+pub const CameraView = struct {
+    entity: entity_pkg.Entity,
+    view: math.Mat4,
+    projection: math.Mat4,
+    view_projection: math.Mat4,
+    position: math.Vec3,
+    near_plane: f32,
+    far_plane: f32,
+};
+
+/// One visible mesh draw.
+pub const MeshInstance = struct {
+    entity: entity_pkg.Entity,
+    mesh: handles.MeshHandle,
+    material: handles.MaterialHandle,
+    world: math.Mat4,
+    cast_shadows: bool,
+    receive_shadows: bool,
+};
+
+/// One light with its world placement resolved.
+pub const LightInstance = struct {
+    entity: entity_pkg.Entity,
+    light: components.Light,
+    position: math.Vec3,
+    /// Forward axis (-Z) of the light's world matrix.
+    direction: math.Vec3,
+};
+
+/// Render-relevant copy of one simulated frame.
+pub const RenderSnapshot = struct {
+    /// Frame counter of the simulation step this snapshot was extracted from; 0 means empty.
+    frame_index: u64 = 0,
+    delta_time: f32 = 0.0,
+    /// `platform.get_time_ns` when simulation of this frame started, for latency measurement.
+    simulate_start_ns: u64 = 0,
+
+    camera: ?CameraView = null,
+    meshes: std.ArrayListUnmanaged(MeshInstance) = .{},
+    lights: std.ArrayListUnmanaged(LightInstance) = .{},
+
+    pub fn deinit(self: *RenderSnapshot, allocator: std.mem.Allocator) void {
+        self.meshes.deinit(allocator);
+        self.lights.deinit(allocator);
+        self.* = .{};
+    }
+
+    /// Drops the contents but keeps capacity so steady-state extraction does not allocate.
+    pub fn clear(self: *RenderSnapshot) void {
+        self.frame_index = 0;
+        self.delta_time = 0.0;
+        self.simulate_start_ns = 0;
+        self.camera = null;
+        self.meshes.clearRetainingCapacity();
+        self.lights.clearRetainingCapacity();
+    }
+
+    /// Converts lights into the renderer's packed layout, matching the editor's conversion.
+    ///
+    /// Returns the number of entries written; lights beyond `out.len` are dropped.
+    pub fn to_pbr_lights(self: *const RenderSnapshot, out: []pbr.PBRLight) u32 {
+        const count = @min(self.lights.items.len, out.len);
+        for (self.lights.items[0..count], out[0..count]) |l, *dst| {
+            var intensity = l.light.intensity;
+            if (intensity < 100.0) intensity *= 100.0;
+
+            dst.* = std.mem.zeroes(pbr.PBRLight);
+            dst.lightDirection = .{ l.direction.x, l.direction.y, l.direction.z, @floatFromInt(@intFromEnum(l.light.type)) };
+            dst.lightPosition = .{ l.position.x, l.position.y, l.position.z, 0.0 };
+            dst.lightColor = .{ l.light.color.x, l.light.color.y, l.light.color.z, intensity };
+            dst.params = .{ l.light.range, @cos(l.light.inner_cone_angle), @cos(l.light.outer_cone_angle), 0.0 };
+        }
+        return @intCast(count);
+    }
+};
+
+fn world_of(transform: *const components.Transform) math.Mat4 {
+    // TransformSystem has already resolved hierarchies; a dirty root transform was edited after it
+    // ran, so rebuild from TRS without writing back (extraction must not mutate the registry).
+    if (transform.dirty) return math.Mat4.fromTRS(transform.position, transform.rotation, transform.scale);
+    return transform.world_matrix;
+}
+
+/// Picks the active camera with the same rule as `RenderSystem`: an entity named "MainCamera" or
+/// "Main Camera" wins, otherwise the first camera in the view.
+fn select_camera(registry: *registry_pkg.Registry) ?struct { entity: entity_pkg.Entity, camera: *const components.Camera } {
+    var view = registry.view(components.Camera);
+    var it = view.const_iterator();
+    var active: ?entity_pkg.Entity = null;
+    var active_camera: ?*const components.Camera = null;
+
+    while (it.next()) |entry| {
+        if (registry.get_const(components.Name, entry.entity)) |n| {
+            const s = n.slice();
+            if (std.mem.eql(u8, s, "MainCamera") or std.mem.eql(u8, s, "Main Camera")) {
+                return .{ .entity = entry.entity, .camera = entry.component };
+            }
+        }
+        if (active == null) {
+            active = entry.entity;
+            active_camera = entry.component;
+        }
+    }
+
+    if (active) |e| return .{ .entity = e, .camera = active_camera.? };
+    return null;
+}
+
+fn resolve_camera(registry: *registry_pkg.Registry) ?CameraView {
+    const selected = select_camera(registry) orelse return null;
+    const cam = selected.camera;
+
+    var view = cam.view_matrix;
+    var projection = cam.projection_matrix;
+    var position = math.Vec3.zero();
+
+    // Camera entities with a transform derive their matrices here; otherwise the cached ones set
+    // by whoever drives the camera are used as-is.
+    if (registry.get_const(components.Transform, selected.entity)) |t| {
+        const world = world_of(t);
+        position = .{ .x = world.data[12], .y = world.data[13], .z = world.data[14] };
+        view = world.invert() orelse math.Mat4.identity();
+        projection = switch (cam.type) {
+            .Perspective => math.Mat4.perspective(std.math.degreesToRadians(cam.fov), cam.aspect_ratio, cam.near_plane, cam.far_plane),
+            .Orthographic => blk: {
+                const half_h = cam.ortho_size * 0.5;
+                const half_w = half_h * cam.aspect_ratio;
+                break :blk math.Mat4.ortho(-half_w, half_w, -half_h, half_h, cam.near_plane, cam.far_plane);
+            },
+        };
+    }
+
+    return .{
+        .entity = selected.entity,
+        .view = view,
+        .projection = projection,
+        .view_projection = projection.mul(view),
+        .position = position,
+        .near_plane = cam.near_plane,
+        .far_plane = cam.far_plane,
+    };
+}
+
+/// Copies the render-relevant state of `registry` into `snapshot`, replacing its contents.
+///
+/// Only reads component data. Must not run concurrently with systems that write `Transform`,
+/// `MeshRenderer`, `Light` or `Camera`.
+pub fn extract(allocator: std.mem.Allocator, snapshot: *RenderSnapshot, registry: *registry_pkg.Registry) !void {
+    snapshot.meshes.clearRetainingCapacity();
+    snapshot.lights.clearRetainingCapacity();
+    snapshot.camera = resolve_camera(registry);
+
+    var mesh_view = registry.multi_view(.{ components.MeshRenderer, components.Transform });
+    var mesh_it = mesh_view.const_iterator();
+    while (mesh_it.next()) |entry| {
+        const renderer = entry.components[0];
+        if (!renderer.visible) continue;
+        try snapshot.meshes.append(allocator, .{
+            .entity = entry.entity,
+            .mesh = renderer.mesh,
+            .material = renderer.material,
+            .world = world_of(entry.components[1]),
+            .cast_shadows = renderer.cast_shadows,
+            .receive_shadows = renderer.receive_shadows,
+        });
+    }
+
+    var light_view = registry.view(components.Light);
+    var light_it = light_view.const_iterator();
+    while (light_it.next()) |entry| {
+        const world = if (registry.get_const(components.Transform, entry.entity)) |t| world_of(t) else math.Mat4.identity();
+        try snapshot.lights.append(allocator, .{
+            .entity = entry.entity,
+            .light = entry.component.*,
+            .position = .{ .x = world.data[12], .y = world.data[13], .z = world.data[14] },
+            .direction = .{ .x = -world.data[8], .y = -world.data[9], .z = -world.data[10] },
+        });
+    }
+}
+
+test "extract copies visible meshes, lights and the named camera" {
+    const allocator = std.testing.allocator;
+    var registry = registry_pkg.Registry.init(allocator);
+    defer registry.deinit();
+
+    const cam_a = try registry.create();
+    try registry.add(cam_a, components.Camera{ .type = .Perspective });
+    const cam_b = try registry.create();
+    try registry.add(cam_b, components.Camera{ .type = .Perspective });
+    try registry.add(cam_b, components.Name.init("MainCamera"));
+    try registry.add(cam_b, components.Transform{ .position = .{ .x = 0, .y = 2, .z = 5 } });
+
+    const visible = try registry.create();
+    try registry.add(visible, components.Transform{ .position = .{ .x = 1, .y = 0, .z = 0 } });
+    try registry.add(visible, components.MeshRenderer{ .mesh = .{ .index = 3, .generation = 1 }, .material = .{ .index = 0, .generation = 1 } });
+    const hidden = try registry.create();
+    try registry.add(hidden, components.Transform{});
+    try registry.add(hidden, components.MeshRenderer{ .mesh = .{ .index = 4, .generation = 1 }, .material = .{ .index = 0, .generation = 1 }, .visible = false });
+
+    const sun = try registry.create();
+    try registry.add(sun, components.Light{ .type = .Directional, .intensity = 2.0 });
+
+    var snapshot = RenderSnapshot{};
+    defer snapshot.deinit(allocator);
+    try extract(allocator, &snapshot, &registry);
+
+    try std.testing.expect(snapshot.camera != null);
+    try std.testing.expectEqual(cam_b.id, snapshot.camera.?.entity.id);
+    try std.testing.expectApproxEqAbs(@as(f32, 2.0), snapshot.camera.?.position.y, 1e-5);
+
+    try std.testing.expectEqual(@as(usize, 1), snapshot.meshes.items.len);
+    try std.testing.expectEqual(@as(u32, 3), snapshot.meshes.items[0].mesh.index);
+    try std.testing.expectApproxEqAbs(@as(f32, 1.0), snapshot.meshes.items[0].world.data[12], 1e-5);
+    // Extraction must leave the registry untouched, including lazily cached matrices.
+    try std.testing.expect(registry.get_const(components.Transform, visible).?.dirty);
+
+    var packed_lights: [4]pbr.PBRLight = undefined;
+    try std.testing.expectEqual(@as(u32, 1), snapshot.to_pbr_lights(&packed_lights));
+    try std.testing.expectApproxEqAbs(@as(f32, 200.0), packed_lights[0].lightColor[3], 1e-3);
+    try std.testing.expectApproxEqAbs(@as(f32, -1.0), packed_lights[0].lightDirection[2], 1e-5);
+}
@@ -0,0 +1,756 @@
+//! Spatial index over entity bounds for box, sphere, ray and nearest-neighbour queries.
+//!
+//! A hashed uniform grid: every entity's world AABB is listed in each cell it overlaps, and only
+//! occupied cells exist, so the grid has no fixed extent. Entities overlapping more than
+//! `MAX_CELLS_PER_ITEM` cells go to an overflow list that every query tests directly instead, so
+//! one huge box cannot fill thousands of cells. An entity seen through several cells is reported
+//! once per query (per-item query stamps).
+//!
+//! `sync` keeps the index current from a registry's change ticks: only entities whose indexed
+//! component or `Transform` changed since the previous sync are re-inserted, and removals rebuild
+//! the index. Queries update the stamps, so neither queries nor syncs may run concurrently.
+const std = @import("std");
+const math = @import("../core/math.zig");
+const entity_pkg = @import("entity.zig");
+const registry_pkg = @import("registry.zig");
+const components = @import("components.zig");
+
+const Entity = entity_pkg.Entity;
+const Registry = registry_pkg.Registry;
+
+/// Cells an entity may overlap before it moves to the overflow list.
+pub const MAX_CELLS_PER_ITEM: u64 = 64;
+/// Smallest cell edge; also used when the automatic size has nothing to go on.
+pub const MIN_CELL_SIZE: f32 = 0.001;
+
+/// Keeps cell coordinates well inside `i32` for any finite input.
+const MAX_CELL_COORD: f32 = 1.0e9;
+
+/// Nearest hit of `SpatialIndex.raycast`.
+pub const RayHit = struct {
+    entity: Entity,
+    /// Distance along the ray to where it enters the entity's bounds; 0 when it starts inside.
+    t: f32,
+};
+
+/// One result of `SpatialIndex.nearest`.
+pub const Neighbor = struct {
+    entity: Entity,
+    /// Distance from the query point to the entity's bounds; 0 when the point is inside.
+    distance: f32,
+};
+
+/// True when the sphere at `center` overlaps `box`.
+pub fn sphere_intersects_aabb(center: math.Vec3, radius: f32, box: math.AABB) bool {
+    return point_aabb_distance_sq(center, box) <= radius * radius;
+}
+
+fn point_aabb_distance_sq(p: math.Vec3, box: math.AABB) f32 {
+    const dx = p.x - std.math.clamp(p.x, box.min.x, box.max.x);
+    const dy = p.y - std.math.clamp(p.y, box.min.y, box.max.y);
+    const dz = p.z - std.math.clamp(p.z, box.min.z, box.max.z);
+    return dx * dx + dy * dy + dz * dz;
+}
+
+fn overlaps(a: math.AABB, b: math.AABB) bool {
+    return a.min.x <= b.max.x and a.max.x >= b.min.x and
+        a.min.y <= b.max.y and a.max.y >= b.min.y and
+        a.min.z <= b.max.z and a.max.z >= b.min.z;
+}
+
+fn to_array(v: math.Vec3) [3]f32 {
+    return .{ v.x, v.y, v.z };
+}
+
+/// Reciprocal that stays finite for axis-parallel rays, so slab tests never compute 0 * inf.
+fn safe_inverse(d: f32) f32 {
+    if (@abs(d) < 1.0e-12) return if (d < 0.0) -1.0e30 else 1.0e30;
+    return 1.0 / d;
+}
+
+/// Where a ray enters `box` within [`t_min`, `t_max`], clamped to `t_min`; null if it misses.
+fn ray_entry(origin: [3]f32, inv_dir: [3]f32, box: math.AABB, t_min: f32, t_max: f32) ?f32 {
+    const lo = to_array(box.min);
+    const hi = to_array(box.max);
+    var t0 = t_min;
+    var t1 = t_max;
+    for (0..3) |i| {
+        const a = (lo[i] - origin[i]) * inv_dir[i];
+        const b = (hi[i] - origin[i]) * inv_dir[i];
+        t0 = @max(t0, @min(a, b));
+        t1 = @min(t1, @max(a, b));
+    }
+    return if (t0 <= t1) t0 else null;
+}
+
+const CellKey = struct {
+    x: i32,
+    y: i32,
+    z: i32,
+};
+
+/// Inclusive range of cell coordinates.
+const CellRange = struct {
+    min: [3]i32,
+    max: [3]i32,
+
+    fn count(self: CellRange) u64 {
+        var n: u64 = 1;
+        for (0..3) |i| {
+            if (self.max[i] < self.min[i]) return 0;
+            n *|= @as(u64, @intCast(@as(i64, self.max[i]) - self.min[i] + 1));
+        }
+        return n;
+    }
+
+    fn contains(self: CellRange, key: CellKey) bool {
+        return key.x >= self.min[0] and key.x <= self.max[0] and
+            key.y >= self.min[1] and key.y <= self.max[1] and
+            key.z >= self.min[2] and key.z <= self.max[2];
+    }
+
+    fn merge(self: CellRange, other: CellRange) CellRange {
+        var out = self;
+        for (0..3) |i| {
+            out.min[i] = @min(self.min[i], other.min[i]);
+            out.max[i] = @max(self.max[i], other.max[i]);
+        }
+        return out;
+    }
+
+    fn intersect(self: CellRange, other: CellRange) CellRange {
+        var out = self;
+        for (0..3) |i| {
+            out.min[i] = @max(self.min[i], other.min[i]);
+            out.max[i] = @min(self.max[i], other.max[i]);
+        }
+        return out;
+    }
+};
+
+const Item = struct {
+    entity: Entity,
+    bounds: math.AABB,
+    range: CellRange,
+    overflow: bool,
+    live: bool,
+    /// Last query that reported or tested this item.
+    stamp: u32,
+};
+
+const CellList = std.ArrayListUnmanaged(u32);
+
+/// Hashed-grid index of entity bounds. Query results replace the contents of `out`.
+pub const SpatialIndex = struct {
+    allocator: std.mem.Allocator,
+    cell_size: f32,
+    inv_cell_size: f32,
+    /// Re-pick `cell_size` from the indexed bounds on every full rebuild in `sync`.
+    auto_cell_size: bool,
+
+    /// Item slots per occupied cell.
+    cells: std.AutoHashMapUnmanaged(CellKey, CellList),
+    items: std.ArrayListUnmanaged(Item),
+    free_items: std.ArrayListUnmanaged(u32),
+    item_by_entity: std.AutoHashMapUnmanaged(u64, u32),
+    overflow: std.ArrayListUnmanaged(u32),
+    /// Covers every cell that has been occupied since the last `clear`; never shrinks before then.
+    occupied: ?CellRange,
+    stamp: u32,
+    /// Registry position of the last `sync`.
+    cursor: registry_pkg.ChangeCursor,
+
+    /// Creates an empty index. A `cell_size` of 0 sizes cells automatically on each full rebuild
+    /// in `sync` (the mean largest extent of the indexed bounds); a good fixed size is about the
+    /// typical entity extent.
+    pub fn init(allocator: std.mem.Allocator, cell_size: f32) SpatialIndex {
+        const size = @max(cell_size, MIN_CELL_SIZE);
+        return .{
+            .allocator = allocator,
+            .cell_size = size,
+            .inv_cell_size = 1.0 / size,
+            .auto_cell_size = cell_size <= 0.0,
+            .cells = .{},
+            .items = .{},
+            .free_items = .{},
+            .item_by_entity = .{},
+            .overflow = .{},
+            .occupied = null,
+            .stamp = 0,
+            .cursor = .{},
+        };
+    }
+
+    pub fn deinit(self: *SpatialIndex) void {
+        var it = self.cells.valueIterator();
+        while (it.next()) |list| list.deinit(self.allocator);
+        self.cells.deinit(self.allocator);
+        self.items.deinit(self.allocator);
+        self.free_items.deinit(self.allocator);
+        self.item_by_entity.deinit(self.allocator);
+        self.overflow.deinit(self.allocator);
+    }
+
+    /// Removes every entity, keeping allocations. The next `sync` rebuilds from scratch.
+    pub fn clear(self: *SpatialIndex) void {
+        var it = self.cells.valueIterator();
+        while (it.next()) |list| list.deinit(self.allocator);
+        self.cells.clearRetainingCapacity();
+        self.items.clearRetainingCapacity();
+        self.free_items.clearRetainingCapacity();
+        self.item_by_entity.clearRetainingCapacity();
+        self.overflow.clearRetainingCapacity();
+        self.occupied = null;
+        self.cursor = .{};
+    }
+
+    /// Number of indexed entities.
+    pub fn count(self: *const SpatialIndex) usize {
+        return self.item_by_entity.count();
+    }
+
+    /// Changes the cell edge length. Only valid while the index is empty.
+    pub fn set_cell_size(self: *SpatialIndex, cell_size: f32) void {
+        std.debug.assert(self.count() == 0);
+        self.cell_size = @max(cell_size, MIN_CELL_SIZE);
+        self.inv_cell_size = 1.0 / self.cell_size;
+    }
+
+    /// The indexed bounds of `entity`, if it is in the index.
+    pub fn bounds_of(self: *const SpatialIndex, entity: Entity) ?math.AABB {
+        const slot = self.item_by_entity.get(entity.id) orelse return null;
+        return self.items.items[slot].bounds;
+    }
+
+    fn cell_coord(self: *const SpatialIndex, v: f32) i32 {
+        return @intFromFloat(std.math.clamp(@floor(v * self.inv_cell_size), -MAX_CELL_COORD, MAX_CELL_COORD));
+    }
+
+    fn range_of(self: *const SpatialIndex, box: math.AABB) CellRange {
+        return .{
+            .min = .{ self.cell_coord(box.min.x), self.cell_coord(box.min.y), self.cell_coord(box.min.z) },
+            .max = .{ self.cell_coord(box.max.x), self.cell_coord(box.max.y), self.cell_coord(box.max.z) },
+        };
+    }
+
+    /// Inserts `entity` or moves it to new `bounds`. On allocation failure the index is cleared
+    /// (and the next `sync` rebuilds it) rather than left half-linked.
+    pub fn insert(self: *SpatialIndex, entity: Entity, bounds: math.AABB) !void {
+        errdefer self.clear();
+        const range = self.range_of(bounds);
+
+        if (self.item_by_entity.get(entity.id)) |slot| {
+            const item = &self.items.items[slot];
+            if (std.meta.eql(item.range, range)) {
+                item.bounds = bounds;
+                return;
+            }
+            self.unlink(slot);
+            try self.link(slot, entity, bounds, range);
+            return;
+        }
+
+        try self.item_by_entity.ensureUnusedCapacity(self.allocator, 1);
+        const slot: u32 = if (self.free_items.pop()) |free| free else blk: {
+            try self.items.append(self.allocator, undefined);
+            break :blk @intCast(self.items.items.len - 1);
+        };
+        self.items.items[slot].live = false;
+        self.item_by_entity.putAssumeCapacity(entity.id, slot);
+        try self.link(slot, entity, bounds, range);
+    }
+
+    /// Removes `entity` if it is indexed.
+    pub fn remove(self: *SpatialIndex, entity: Entity) void {
+        const kv = self.item_by_entity.fetchRemove(entity.id) orelse return;
+        self.unlink(kv.value);
+        // Capacity was reserved when the slot was created, except after a failed append.
+        self.free_items.append(self.allocator, kv.value) catch {};
+    }
+
+    fn link(self: *SpatialIndex, slot: u32, entity: Entity, bounds: math.AABB, range: CellRange) !void {
+        const overflow = range.count() > MAX_CELLS_PER_ITEM;
+        self.items.items[slot] = .{
+            .entity = entity,
+            .bounds = bounds,
+            .range = range,
+            .overflow = overflow,
+            .live = true,
+            .stamp = 0,
+        };
+        try self.free_items.ensureTotalCapacity(self.allocator, self.items.items.len);
+
+        if (overflow) {
+            try self.overflow.append(self.allocator, slot);
+        } else {
+            var z = range.min[2];
+            while (z <= range.max[2]) : (z += 1) {
+                var y = range.min[1];
+                while (y <= range.max[1]) : (y += 1) {
+                    var x = range.min[0];
+                    while (x <= range.max[0]) : (x += 1) {
+                        const gop = try self.cells.getOrPut(self.allocator, .{ .x = x, .y = y, .z = z });
+                        if (!gop.found_existing) gop.value_ptr.* = .{};
+                        try gop.value_ptr.append(self.allocator, slot);
+                    }
+                }
+            }
+        }
+        self.occupied = if (self.occupied) |occ| occ.merge(range) else range;
+    }
+
+    fn unlink(self: *SpatialIndex, slot: u32) void {
+        const item = &self.items.items[slot];
+        if (!item.live) return;
+        item.live = false;
+
+        if (item.overflow) {
+            const idx = std.mem.indexOfScalar(u32, self.overflow.items, slot) orelse return;
+            _ = self.overflow.swapRemove(idx);
+            return;
+        }
+        var z = item.range.min[2];
+        while (z <= item.range.max[2]) : (z += 1) {
+            var y = item.range.min[1];
+            while (y <= item.range.max[1]) : (y += 1) {
+                var x = item.range.min[0];
+                while (x <= item.range.max[0]) : (x += 1) {
+                    const key = CellKey{ .x = x, .y = y, .z = z };
+                    const list = self.cells.getPtr(key) orelse continue;
+                    if (std.mem.indexOfScalar(u32, list.items, slot)) |idx| _ = list.swapRemove(idx);
+                    if (list.items.len == 0) {
+                        list.deinit(self.allocator);
+                        _ = self.cells.remove(key);
+                    }
+                }
+            }
+        }
+    }
+
+    fn next_stamp(self: *SpatialIndex) u32 {
+        self.stamp +%= 1;
+        if (self.stamp == 0) {
+            for (self.items.items) |*item| item.stamp = 0;
+            self.stamp = 1;
+        }
+        return self.stamp;
+    }
+
+    /// True the first time a query with `stamp` reaches `slot`.
+    fn first_visit(self: *SpatialIndex, slot: u32, stamp: u32) bool {
+        const item = &self.items.items[slot];
+        if (item.stamp == stamp) return false;
+        item.stamp = stamp;
+        return true;
+    }
+
+    const Shape = union(enum) {
+        box: math.AABB,
+        sphere: struct { center: math.Vec3, radius: f32 },
+
+        fn hits(self: Shape, bounds: math.AABB) bool {
+            return switch (self) {
+                .box => |b| overlaps(b, bounds),
+                .sphere => |s| sphere_intersects_aabb(s.center, s.radius, bounds),
+            };
+        }
+    };
+
+    fn collect(self: *SpatialIndex, shape: Shape, box: math.AABB, allocator: std.mem.Allocator, out: *std.ArrayListUnmanaged(Entity)) !void {
+        out.clearRetainingCapacity();
+        const stamp = self.next_stamp();
+        for (self.overflow.items) |slot| {
+            const item = &self.items.items[slot];
+            if (shape.hits(item.bounds)) try out.append(allocator, item.entity);
+        }
+
+        const occupied = self.occupied orelse return;
+        const range = self.range_of(box).intersect(occupied);
+        const cells = range.count();
+        if (cells == 0) return;
+
+        if (cells > self.cells.count()) {
+            // Walking the occupied cells is cheaper than probing the range.
+            var it = self.cells.iterator();
+            while (it.next()) |kv| {
+                if (!range.contains(kv.key_ptr.*)) continue;
+                try self.collect_list(kv.value_ptr.items, shape, stamp, allocator, out);
+            }
+            return;
+        }
+        var z = range.min[2];
+        while (z <= range.max[2]) : (z += 1) {
+            var y = range.min[1];
+            while (y <= range.max[1]) : (y += 1) {
+                var x = range.min[0];
+                while (x <= range.max[0]) : (x += 1) {
+                    const list = self.cells.getPtr(.{ .x = x, .y = y, .z = z }) orelse continue;
+                    try self.collect_list(list.items, shape, stamp, allocator, out);
+                }
+            }
+        }
+    }
+
+    fn collect_list(self: *SpatialIndex, slots: []const u32, shape: Shape, stamp: u32, allocator: std.mem.Allocator, out: *std.ArrayListUnmanaged(Entity)) !void {
+        for (slots) |slot| {
+            if (!self.first_visit(slot, stamp)) continue;
+            const item = &self.items.items[slot];
+            if (shape.hits(item.bounds)) try out.append(allocator, item.entity);
+        }
+    }
+
+    /// Entities whose bounds overlap `box` (touching counts).
+    pub fn query_box(self: *SpatialIndex, box: math.AABB, allocator: std.mem.Allocator, out: *std.ArrayListUnmanaged(Entity)) !void {
+        try self.collect(.{ .box = box }, box, allocator, out);
+    }
+
+    /// Entities whose bounds overlap the sphere.
+    pub fn query_sphere(self: *SpatialIndex, center: math.Vec3, radius: f32, allocator: std.mem.Allocator, out: *std.ArrayListUnmanaged(Entity)) !void {
+        const r = math.Vec3{ .x = radius, .y = radius, .z = radius };
+        const box = math.AABB{ .min = center.sub(r), .max = center.add(r) };
+        try self.collect(.{ .sphere = .{ .center = center, .radius = radius } }, box, allocator, out);
+    }
+
+    /// The entity whose bounds `ray` enters first within `max_t`. Walks the grid cells along the
+    /// ray (3D DDA) and stops once the next cell starts beyond the best hit.
+    pub fn raycast(self: *SpatialIndex, ray: math.Ray, max_t: f32) ?RayHit {
+        const origin = to_array(ray.origin);
+        const dir = to_array(ray.direction);
+        const inv_dir = [3]f32{ safe_inverse(dir[0]), safe_inverse(dir[1]), safe_inverse(dir[2]) };
+        const stamp = self.next_stamp();
+
+        var best: ?RayHit = null;
+        var best_t = max_t;
+        for (self.overflow.items) |slot| {
+            const item = &self.items.items[slot];
+            if (ray_entry(origin, inv_dir, item.bounds, 0.0, best_t)) |t| {
+                best = .{ .entity = item.entity, .t = t };
+                best_t = t;
+            }
+        }
+
+        const occupied = self.occupied orelse return best;
+        const cs = self.cell_size;
+        const world = math.AABB{
+            .min = .{
+                .x = @as(f32, @floatFromInt(occupied.min[0])) * cs,
+                .y = @as(f32, @floatFromInt(occupied.min[1])) * cs,
+                .z = @as(f32, @floatFromInt(occupied.min[2])) * cs,
+            },
+            .max = .{
+                .x = @as(f32, @floatFromInt(occupied.max[0] + 1)) * cs,
+                .y = @as(f32, @floatFromInt(occupied.max[1] + 1)) * cs,
+                .z = @as(f32, @floatFromInt(occupied.max[2] + 1)) * cs,
+            },
+        };
+        const t_enter = ray_entry(origin, inv_dir, world, 0.0, best_t) orelse return best;
+
+        var cell: [3]i32 = undefined;
+        var step: [3]i32 = undefined;
+        var t_next: [3]f32 = undefined;
+        var t_delta: [3]f32 = undefined;
+        for (0..3) |i| {
+            const p = origin[i] + dir[i] * t_enter;
+            cell[i] = std.math.clamp(self.cell_coord(p), occupied.min[i], occupied.max[i]);
+            if (dir[i] > 0.0) {
+                step[i] = 1;
+                t_next[i] = (@as(f32, @floatFromInt(cell[i] + 1)) * cs - origin[i]) * inv_dir[i];
+                t_delta[i] = cs * inv_dir[i];
+            } else if (dir[i] < 0.0) {
+                step[i] = -1;
+                t_next[i] = (@as(f32, @floatFromInt(cell[i])) * cs - origin[i]) * inv_dir[i];
+                t_delta[i] = -cs * inv_dir[i];
+            } else {
+                step[i] = 0;
+                t_next[i] = std.math.inf(f32);
+                t_delta[i] = std.math.inf(f32);
+            }
+        }
+
+        while (true) {
+            if (self.cells.getPtr(.{ .x = cell[0], .y = cell[1], .z = cell[2] })) |list| {
+                for (list.items) |slot| {
+                    if (!self.first_visit(slot, stamp)) continue;
+                    const item = &self.items.items[slot];
+                    if (ray_entry(origin, inv_dir, item.bounds, 0.0, best_t)) |t| {
+                        best = .{ .entity = item.entity, .t = t };
+                        best_t = t;
+                    }
+                }
+            }
+
+            var axis: usize = 0;
+            if (t_next[1] < t_next[axis]) axis = 1;
+            if (t_next[2] < t_next[axis]) axis = 2;
+            if (t_next[axis] > best_t or step[axis] == 0) break;
+            cell[axis] += step[axis];
+            if (cell[axis] < occupied.min[axis] or cell[axis] > occupied.max[axis]) break;
+            t_next[axis] += t_delta[axis];
+        }
+        return best;
+    }
+
+    /// Up to `k` entities nearest to `point` (distance to their bounds), nearest first. Searches
+    /// rings of cells outward from the point's cell and stops once the next ring cannot hold
+    /// anything closer than the current k-th result.
+    pub fn nearest(self: *SpatialIndex, point: math.Vec3, k: usize, allocator: std.mem.Allocator, out: *std.ArrayListUnmanaged(Neighbor)) !void {
+        out.clearRetainingCapacity();
+        if (k == 0) return;
+        const stamp = self.next_stamp();
+        for (self.overflow.items) |slot| try self.consider(slot, point, allocator, out);
+
+        if (self.occupied) |occupied| {
+            const center = [3]i32{ self.cell_coord(point.x), self.cell_coord(point.y), self.cell_coord(point.z) };
+            var max_ring: i64 = 0;
+            for (0..3) |i| {
+                max_ring = @max(max_ring, @as(i64, center[i]) - occupied.min[i]);
+                max_ring = @max(max_ring, @as(i64, occupied.max[i]) - center[i]);
+            }
+
+            var ring: i32 = 0;
+            while (ring <= max_ring) : (ring += 1) {
+                // The point can sit anywhere in its cell, so ring r is at least r - 1 cells away.
+                if (out.items.len >= k and ring > 0) {
+                    const reach = @as(f32, @floatFromInt(ring - 1)) * self.cell_size;
+                    if (out.items[k - 1].distance <= reach) break;
+                }
+                const side: u64 = @intCast(2 * @as(i64, ring) + 1);
+                if (side * side * side > self.cells.count()) {
+                    // The rings now cover more cells than exist: finish with the occupied cells.
+                    var it = self.cells.valueIterator();
+                    while (it.next()) |list| {
+                        for (list.items) |slot| {
+                            if (self.first_visit(slot, stamp)) try self.consider(slot, point, allocator, out);
+                        }
+                    }
+                    sort_and_truncate(out, k);
+                    break;
+                }
+                try self.visit_ring(center, ring, point, stamp, allocator, out);
+                sort_and_truncate(out, k);
+            }
+        }
+        sort_and_truncate(out, k);
+    }
+
+    fn visit_ring(self: *SpatialIndex, center: [3]i32, ring: i32, point: math.Vec3, stamp: u32, allocator: std.mem.Allocator, out: *std.ArrayListUnmanaged(Neighbor)) !void {
+        var dz: i32 = -ring;
+        while (dz <= ring) : (dz += 1) {
+            var dy: i32 = -ring;
+            while (dy <= ring) : (dy += 1) {
+                const on_face = dz == -ring or dz == ring or dy == -ring or dy == ring;
+                var dx: i32 = -ring;
+                while (dx <= ring) : (dx += if (on_face or ring == 0) 1 else 2 * ring) {
+                    const key = CellKey{ .x = center[0] +| dx, .y = center[1] +| dy, .z = center[2] +| dz };
+                    const list = self.cells.getPtr(key) orelse continue;
+                    for (list.items) |slot| {
+                        if (self.first_visit(slot, stamp)) try self.consider(slot, point, allocator, out);
+                    }
+                }
+            }
+        }
+    }
+
+    fn consider(self: *SpatialIndex, slot: u32, point: math.Vec3, allocator: std.mem.Allocator, out: *std.ArrayListUnmanaged(Neighbor)) !void {
+        const item = &self.items.items[slot];
+        try out.append(allocator, .{ .entity = item.entity, .distance = @sqrt(point_aabb_distance_sq(point, item.bounds)) });
+    }
+
+    fn sort_and_truncate(out: *std.ArrayListUnmanaged(Neighbor), k: usize) void {
+        std.mem.sort(Neighbor, out.items, {}, struct {
+            fn less(_: void, a: Neighbor, b: Neighbor) bool {
+                return a.distance < b.distance;
+            }
+        }.less);
+        if (out.items.len > k) out.shrinkRetainingCapacity(k);
+    }
+
+    /// Brings the index up to date with the entities of `registry` that have both `T` and a
+    /// `Transform`; `bounds_fn` gives their world bounds (null leaves an entity out). Only entities
+    /// whose `T` or `Transform` changed since the previous sync are re-inserted. The first sync, a
+    /// re-initialized registry or a removal of either component rebuilds the index.
+    pub fn sync(
+        self: *SpatialIndex,
+        registry: *Registry,
+        comptime T: type,
+        comptime bounds_fn: fn (*const T, *const components.Transform) ?math.AABB,
+    ) !void {
+        const Transform = components.Transform;
+        errdefer self.clear();
+
+        const since = self.cursor.begin(registry);
+        const rebuild = since == 0 or registry.any_removed(T, since) or registry.any_removed(Transform, since);
+        if (rebuild) {
+            self.clear();
+            if (self.auto_cell_size) {
+                var extent_sum: f64 = 0.0;
+                var extent_count: usize = 0;
+                var it = registry.view(T).const_iterator();
+                while (it.next()) |entry| {
+                    const tr = registry.get_const(Transform, entry.entity) orelse continue;
+                    const b = bounds_fn(entry.component, tr) orelse continue;
+                    const s = b.size();
+                    extent_sum += @max(s.x, @max(s.y, s.z));
+                    extent_count += 1;
+                }
+                if (extent_count > 0) self.set_cell_size(@floatCast(extent_sum / @as(f64, @floatFromInt(extent_count))));
+            }
+            var it = registry.view(T).const_iterator();
+            while (it.next()) |entry| try self.sync_entity(registry, T, bounds_fn, entry.entity);
+        } else {
+            if (!registry.any_changed(T, since) and !registry.any_changed(Transform, since)) return;
+            var it = registry.view_changed(T, since).iterator();
+            while (it.next()) |entry| try self.sync_entity(registry, T, bounds_fn, entry.entity);
+            var tr_it = registry.view_changed(Transform, since).iterator();
+            while (tr_it.next()) |entry| try self.sync_entity(registry, T, bounds_fn, entry.entity);
+        }
+        self.cursor.end(registry);
+    }
+
+    fn sync_entity(
+        self: *SpatialIndex,
+        registry: *const Registry,
+        comptime T: type,
+        comptime bounds_fn: fn (*const T, *const components.Transform) ?math.AABB,
+        entity: Entity,
+    ) !void {
+        const c = registry.get_const(T, entity) orelse return self.remove(entity);
+        const tr = registry.get_const(components.Transform, entity) orelse return self.remove(entity);
+        const bounds = bounds_fn(c, tr) orelse return self.remove(entity);
+        try self.insert(entity, bounds);
+    }
+};
+
+const testing = std.testing;
+
+fn test_box(x: f32, y: f32, z: f32, half: f32) math.AABB {
+    const h = math.Vec3{ .x = half, .y = half, .z = half };
+    const c = math.Vec3{ .x = x, .y = y, .z = z };
+    return .{ .min = c.sub(h), .max = c.add(h) };
+}
+
+fn contains_entity(list: []const Entity, e: Entity) bool {
+    for (list) |x| {
+        if (x.id == e.id) return true;
+    }
+    return false;
+}
+
+test "spatial index queries agree with a linear scan" {
+    const allocator = testing.allocator;
+    var index = SpatialIndex.init(allocator, 4.0);
+    defer index.deinit();
+
+    var prng = std.Random.DefaultPrng.init(49);
+    const rng = prng.random();
+    var boxes: [300]math.AABB = undefined;
+    for (&boxes, 0..) |*b, i| {
+        const half: f32 = if (i % 50 == 0) 40.0 else 0.2 + rng.float(f32) * 3.0;
+        b.* = test_box(rng.float(f32) * 100.0 - 50.0, rng.float(f32) * 20.0, rng.float(f32) * 100.0 - 50.0, half);
+        try index.insert(Entity.make(@intCast(i), 1), b.*);
+    }
+    // Move some, drop some.
+    for (0..30) |i| {
+        boxes[i] = test_box(rng.float(f32) * 100.0 - 50.0, 5.0, rng.float(f32) * 100.0 - 50.0, 1.0);
+        try index.insert(Entity.make(@intCast(i), 1), boxes[i]);
+    }
+    for (30..40) |i| index.remove(Entity.make(@intCast(i), 1));
+    try testing.expectEqual(@as(usize, 290), index.count());
+
+    var found: std.ArrayListUnmanaged(Entity) = .{};
+    defer found.deinit(allocator);
+    var neighbors: std.ArrayListUnmanaged(Neighbor) = .{};
+    defer neighbors.deinit(allocator);
+
+    for (0..40) |q| {
+        const p = math.Vec3{ .x = rng.float(f32) * 120.0 - 60.0, .y = rng.float(f32) * 20.0, .z = rng.float(f32) * 120.0 - 60.0 };
+        const radius: f32 = 1.0 + @as(f32, @floatFromInt(q % 8));
+
+        try index.query_sphere(p, radius, allocator, &found);
+        var expected: usize = 0;
+        for (boxes, 0..) |b, i| {
+            if (i >= 30 and i < 40) continue;
+            if (!sphere_intersects_aabb(p, radius, b)) continue;
+            expected += 1;
+            try testing.expect(contains_entity(found.items, Entity.make(@intCast(i), 1)));
+        }
+        try testing.expectEqual(expected, found.items.len);
+
+        try index.nearest(p, 5, allocator, &neighbors);
+        var dists: [300]f32 = undefined;
+        var n: usize = 0;
+        for (boxes, 0..) |b, i| {
+            if (i >= 30 and i < 40) continue;
+            dists[n] = @sqrt(point_aabb_distance_sq(p, b));
+            n += 1;
+        }
+        std.mem.sort(f32, dists[0..n], {}, std.sort.asc(f32));
+        try testing.expectEqual(@as(usize, 5), neighbors.items.len);
+        for (neighbors.items, 0..) |nb, i| try testing.expectApproxEqAbs(dists[i], nb.distance, 1e-4);
+
+        const dir = (math.Vec3{ .x = rng.float(f32) - 0.5, .y = rng.float(f32) - 0.5, .z = rng.float(f32) - 0.5 }).normalize();
+        const ray = math.Ray{ .origin = p, .direction = dir };
+        const origin = to_array(ray.origin);
+        const inv = [3]f32{ safe_inverse(dir.x), safe_inverse(dir.y), safe_inverse(dir.z) };
+        var best_t: f32 = 200.0;
+        var any = false;
+        for (boxes, 0..) |b, i| {
+            if (i >= 30 and i < 40) continue;
+            if (ray_entry(origin, inv, b, 0.0, best_t)) |t| {
+                best_t = t;
+                any = true;
+            }
+        }
+        const hit = index.raycast(ray, 200.0);
+        try testing.expectEqual(any, hit != null);
+        if (hit) |h| try testing.expectApproxEqAbs(best_t, h.t, 1e-4);
+    }
+}
+
+const TestVolume = struct {
+    half: f32,
+};
+
+fn test_volume_bounds(v: *const TestVolume, tr: *const components.Transform) ?math.AABB {
+    return test_box(tr.position.x, tr.position.y, tr.position.z, v.half);
+}
+
+test "spatial index sync follows registry changes" {
+    const allocator = testing.allocator;
+    var registry = Registry.init(allocator);
+    defer registry.deinit();
+    var index = SpatialIndex.init(allocator, 0.0);
+    defer index.deinit();
+
+    var entities: [64]Entity = undefined;
+    for (&entities, 0..) |*e, i| {
+        e.* = try registry.create();
+        try registry.add(e.*, components.Transform{ .position = .{ .x = @floatFromInt(i * 4), .y = 0.0, .z = 0.0 } });
+        try registry.add(e.*, TestVolume{ .half = 1.0 });
+    }
+    try index.sync(&registry, TestVolume, test_volume_bounds);
+    try testing.expectEqual(@as(usize, 64), index.count());
+    try testing.expectApproxEqAbs(@as(f32, 2.0), index.cell_size, 1e-5);
+
+    var found: std.ArrayListUnmanaged(Entity) = .{};
+    defer found.deinit(allocator);
+
+    // A moved entity is found at its new place only.
+    registry.get(components.Transform, entities[3]).?.position.z = 50.0;
+    try index.sync(&registry, TestVolume, test_volume_bounds);
+    try index.query_box(test_box(12.0, 0.0, 0.0, 0.5), allocator, &found);
+    try testing.expectEqual(@as(usize, 0), found.items.len);
+    try index.query_box(test_box(12.0, 0.0, 50.0, 0.5), allocator, &found);
+    try testing.expectEqual(@as(usize, 1), found.items.len);
+    try testing.expectEqual(entities[3].id, found.items[0].id);
+
+    // Removing the component drops the entity.
+    registry.remove(TestVolume, entities[5]);
+    try index.sync(&registry, TestVolume, test_volume_bounds);
+    try testing.expectEqual(@as(usize, 63), index.count());
+    try testing.expect(index.bounds_of(entities[5]) == null);
+
+    const hit = index.raycast(.{ .origin = .{ .x = -10.0, .y = 0.0, .z = 0.0 }, .direction = .{ .x = 1.0, .y = 0.0, .z = 0.0 } }, 1000.0).?;
+    try testing.expectEqual(entities[0].id, hit.entity.id);
+    try testing.expectApproxEqAbs(@as(f32, 9.0), hit.t, 1e-4);
+}
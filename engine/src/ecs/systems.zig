@@ -65,13 +65,13 @@ pub const RenderSystem = struct {
         _ = delta_time;
         _ = ecb;
         var camera_view = registry.view(components.Camera);
-        var active_camera: ?*components.Camera = null;
+        var active_camera: ?*const components.Camera = null;
         var best_name_match = false;
 
-        var cam_it = camera_view.iterator();
+        var cam_it = camera_view.const_iterator();
         while (cam_it.next()) |entry| {
             if (!best_name_match) {
-                if (registry.get(components.Name, entry.entity)) |n| {
+                if (registry.get_const(components.Name, entry.entity)) |n| {
                     const s = n.slice();
                     if (std.mem.eql(u8, s, "MainCamera") or std.mem.eql(u8, s, "Main Camera")) {
                         active_camera = entry.component;
@@ -91,7 +91,9 @@ pub const RenderSystem = struct {
         }
 
         var mesh_view = registry.multi_view(.{ components.MeshRenderer, components.Transform });
-        var mesh_it = mesh_view.iterator();
+        // Read-only: the system only declares reads, and handing out mutable pointers would mark
+        // every renderable changed each frame.
+        var mesh_it = mesh_view.const_iterator();
 
         var draw_count: usize = 0;
 
@@ -102,7 +104,7 @@ pub const RenderSystem = struct {
 
             if (!renderer.visible) continue;
 
-            _ = transform.get_matrix();
+            _ = transform.world_matrix;
             draw_count += 1;
         }
     }
@@ -137,11 +139,13 @@ pub const ScriptSystem = struct {
 /// Propagates transforms through the hierarchy to compute world matrices.
 pub const TransformSystem = struct {
     fn update_node(registry: *registry_pkg.Registry, entity: registry_pkg.Entity, parent_world: ?math.Mat4, parent_dirty: bool) void {
-        const transform_opt = registry.get(components.Transform, entity);
+        // Only transforms whose world matrix is recomputed count as changed.
+        const transform_opt = registry.get_untracked(components.Transform, entity);
         if (transform_opt == null) return;
         const transform = transform_opt.?;
 
         const world_dirty = transform.dirty or parent_dirty;
+        if (world_dirty) registry.mark_changed(components.Transform, entity);
 
         if (parent_world) |pw| {
             if (world_dirty) {
@@ -159,12 +163,12 @@ pub const TransformSystem = struct {
 
         const current_world = transform.world_matrix;
 
-        if (registry.get(components.Hierarchy, entity)) |hierarchy| {
+        if (registry.get_const(components.Hierarchy, entity)) |hierarchy| {
             if (hierarchy.first_child) |child_entity| {
                 var c = child_entity;
                 while (true) {
                     update_node(registry, c, current_world, world_dirty);
-                    const child_h_opt = registry.get(components.Hierarchy, c);
+                    const child_h_opt = registry.get_const(components.Hierarchy, c);
                     if (child_h_opt == null or child_h_opt.?.next_sibling == null) {
                         break;
                     }
@@ -179,11 +183,11 @@ pub const TransformSystem = struct {
         _ = delta_time;
 
         var view = registry.view(components.Transform);
-        var it = view.iterator();
+        var it = view.const_iterator();
 
         while (it.next()) |entry| {
             const entity = entry.entity;
-            const hierarchy = registry.get(components.Hierarchy, entity);
+            const hierarchy = registry.get_const(components.Hierarchy, entity);
             if (hierarchy) |h| {
                 if (h.parent != null) {
                     continue;
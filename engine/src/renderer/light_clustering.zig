@@ -0,0 +1,645 @@
+//! Clustered light binning for the PBR path.
+//!
+//! The view frustum is split into `GRID_X` x `GRID_Y` screen tiles and `GRID_Z` depth slices
+//! spaced exponentially between the projection's near and far planes. `Clusterer.build`
+//! transforms every bounded light (points, and spots as the bounding sphere of their cone) into
+//! view space and tests it against the view-space bounds of the clusters in the slices it spans,
+//! `BATCH` clusters per vector operation. Slices are binned independently, on the job system when
+//! there are enough lights. Directional lights and lights without a range reach every fragment
+//! and go into a global list instead.
+//!
+//! `Clusterer.write` lays the result out as the `LightClusterBuffer` storage buffer read by
+//! pbr.frag: a `GpuHeader`, an (offset, count) range per cluster, then the light indices, global
+//! lights first. Light spheres are grown by a small margin so that rounding in the shader's
+//! cluster lookup never misses a light that reaches the fragment.
+const std = @import("std");
+const math = @import("../core/math.zig");
+const job_system = @import("../core/job_system.zig");
+const pbr = @import("vulkan_types_pbr.zig");
+
+pub const GRID_X: u32 = 16;
+pub const GRID_Y: u32 = 9;
+pub const GRID_Z: u32 = 24;
+pub const CLUSTER_COUNT: u32 = GRID_X * GRID_Y * GRID_Z;
+/// Lights listed per cluster; further lights touching it are dropped and counted.
+pub const MAX_LIGHTS_PER_CLUSTER: u32 = 256;
+/// Capacity of the index list shared by the global lights and all clusters.
+pub const MAX_INDICES: u32 = 256 * 1024;
+/// Clusters tested per vector operation.
+pub const BATCH = 8;
+/// Bounded lights below which all slices are binned on the calling thread.
+pub const MIN_JOB_LIGHTS: usize = 256;
+
+/// Size of the storage buffer `Clusterer.write` fills.
+pub const BUFFER_SIZE: usize = @sizeOf(GpuHeader) + CLUSTER_COUNT * @sizeOf(GpuRange) + MAX_INDICES * @sizeOf(u32);
+
+const SLICE_CLUSTERS: usize = GRID_X * GRID_Y;
+const SLICE_BATCHES: usize = SLICE_CLUSTERS / BATCH;
+const GRID_X_F: f32 = @floatFromInt(GRID_X);
+const GRID_Y_F: f32 = @floatFromInt(GRID_Y);
+const GRID_Z_F: f32 = @floatFromInt(GRID_Z);
+/// Absolute and relative growth of light radii, in view-space units.
+const RADIUS_MARGIN: f32 = 1e-3;
+const RADIUS_MARGIN_REL: f32 = 1e-4;
+/// Above this cone half-angle a spot's bounding sphere is centred on the cap, not the axis midpoint.
+const WIDE_CONE_COS: f32 = std.math.sqrt1_2;
+
+const Lanes = @Vector(BATCH, f32);
+const LANE_BITS = @Vector(BATCH, u8){ 1, 2, 4, 8, 16, 32, 64, 128 };
+
+comptime {
+    if (SLICE_CLUSTERS % BATCH != 0) @compileError("clusters per slice must be a multiple of BATCH");
+}
+
+/// Header of the cluster buffer; mirrors `LightClusterBuffer` in pbr.frag.
+pub const GpuHeader = extern struct {
+    /// Cluster counts along x, y and z; w is 1 when clustering is enabled.
+    grid: [4]u32,
+    /// Tile width and height in pixels, then the depth slice scale and bias:
+    /// `slice = floor(log(view_depth) * scale + bias)`.
+    tile_depth: [4]f32,
+    /// Offset and count of the global lights, indices written, lights dropped.
+    globals: [4]u32,
+};
+
+/// Where a cluster's lights start in the index list, and how many there are.
+pub const GpuRange = extern struct {
+    offset: u32,
+    count: u32,
+};
+
+/// Camera state the grid is built for.
+pub const View = struct {
+    view: math.Mat4,
+    /// Perspective projection from `Mat4.perspective` (off-centre terms are honoured). Any
+    /// other projection disables clustering and the shader walks every light.
+    proj: math.Mat4,
+    width: u32,
+    height: u32,
+};
+
+pub const Options = struct {
+    /// Bin slices on the job system (runs inline when it is not running).
+    use_jobs: bool = true,
+};
+
+pub const Stats = struct {
+    lights: usize = 0,
+    /// Directional and unbounded lights, applied in every cluster.
+    global: usize = 0,
+    /// Bounded lights that intersect the depth range and were binned.
+    binned: usize = 0,
+    /// Indices written, global ones included.
+    indices: usize = 0,
+    /// Cluster entries lost to `MAX_LIGHTS_PER_CLUSTER` or `MAX_INDICES`.
+    dropped: usize = 0,
+    max_per_cluster: u32 = 0,
+};
+
+const Sphere = struct {
+    x: f32,
+    y: f32,
+    /// Distance in front of the camera (view-space -z).
+    depth: f32,
+    radius: f32,
+    light: u32,
+    first_slice: u32,
+    last_slice: u32,
+};
+
+const Slice = struct {
+    owner: *const Clusterer = undefined,
+    z: u32 = 0,
+    candidates: std.ArrayListUnmanaged(u32) = .{},
+    masks: std.ArrayListUnmanaged(u8) = .{},
+    indices: std.ArrayListUnmanaged(u32) = .{},
+    /// Cluster ranges relative to `indices`.
+    ranges: [SLICE_CLUSTERS]GpuRange = undefined,
+    dropped: usize = 0,
+    /// Start of this slice's indices in the written index list, and how many fit.
+    base: u32 = 0,
+    written: u32 = 0,
+
+    fn deinit(self: *Slice, allocator: std.mem.Allocator) void {
+        self.candidates.deinit(allocator);
+        self.masks.deinit(allocator);
+        self.indices.deinit(allocator);
+    }
+
+    fn run(data: ?*anyopaque) callconv(.c) i32 {
+        const self: *Slice = @ptrCast(@alignCast(data.?));
+        self.owner.bin_slice(self);
+        return 0;
+    }
+};
+
+const Projection = struct {
+    scale_x: f32,
+    scale_y: f32,
+    offset_x: f32,
+    offset_y: f32,
+    near: f32,
+    far: f32,
+    width: u32,
+    height: u32,
+
+    fn from(view: View) ?Projection {
+        const p = view.proj.data;
+        if (p[11] != -1.0 or p[15] != 0.0 or p[0] == 0.0 or p[5] == 0.0) return null;
+        if (view.width == 0 or view.height == 0) return null;
+        const near = p[14] / p[10];
+        const far = p[14] / (p[10] + 1.0);
+        if (!std.math.isFinite(near) or !std.math.isFinite(far) or !(near > 0.0) or !(far > near)) return null;
+        return .{
+            .scale_x = p[0],
+            .scale_y = p[5],
+            .offset_x = p[8],
+            .offset_y = p[9],
+            .near = near,
+            .far = far,
+            .width = view.width,
+            .height = view.height,
+        };
+    }
+
+    fn eql(a: Projection, b: Projection) bool {
+        return std.meta.eql(a, b);
+    }
+};
+
+/// Per-frame light binning with retained scratch memory. Not thread-safe; build one grid at a time.
+pub const Clusterer = struct {
+    projection: ?Projection = null,
+    /// View depth of each slice boundary.
+    slice_depth: [GRID_Z + 1]f32 = undefined,
+    log_scale: f32 = 0,
+    min_x: [CLUSTER_COUNT]f32 = undefined,
+    max_x: [CLUSTER_COUNT]f32 = undefined,
+    min_y: [CLUSTER_COUNT]f32 = undefined,
+    max_y: [CLUSTER_COUNT]f32 = undefined,
+
+    enabled: bool = false,
+    header: GpuHeader = std.mem.zeroes(GpuHeader),
+    ranges: [CLUSTER_COUNT]GpuRange = undefined,
+    globals: std.ArrayListUnmanaged(u32) = .{},
+    spheres: std.ArrayListUnmanaged(Sphere) = .{},
+    slices: [GRID_Z]Slice = [_]Slice{.{}} ** GRID_Z,
+    jobs: std.ArrayListUnmanaged(*job_system.Job) = .{},
+    stats: Stats = .{},
+
+    pub fn deinit(self: *Clusterer, allocator: std.mem.Allocator) void {
+        self.globals.deinit(allocator);
+        self.spheres.deinit(allocator);
+        for (&self.slices) |*slice| slice.deinit(allocator);
+        self.jobs.deinit(allocator);
+        self.* = .{};
+    }
+
+    /// Bins `lights` for `view`; cluster lists hold indices into `lights`. Leaves clustering
+    /// disabled for projections it cannot slice.
+    pub fn build(self: *Clusterer, allocator: std.mem.Allocator, lights: []const pbr.PBRLight, view: View, options: Options) !void {
+        self.enabled = false;
+        self.header = std.mem.zeroes(GpuHeader);
+        self.stats = .{ .lights = lights.len };
+        self.globals.clearRetainingCapacity();
+        self.spheres.clearRetainingCapacity();
+
+        const proj = Projection.from(view) orelse {
+            self.projection = null;
+            return;
+        };
+        if (self.projection == null or !self.projection.?.eql(proj)) self.update_bounds(proj);
+
+        try self.collect_lights(allocator, lights, view.view, proj);
+        try self.bin(allocator, options);
+        self.assign_offsets();
+
+        self.header = .{
+            .grid = .{ GRID_X, GRID_Y, GRID_Z, 1 },
+            .tile_depth = .{
+                @as(f32, @floatFromInt(proj.width)) / GRID_X_F,
+                @as(f32, @floatFromInt(proj.height)) / GRID_Y_F,
+                self.log_scale,
+                -@log(proj.near) * self.log_scale,
+            },
+            .globals = .{ 0, @intCast(self.globals.items.len), @intCast(self.stats.indices), @intCast(@min(self.stats.dropped, std.math.maxInt(u32))) },
+        };
+        self.enabled = true;
+    }
+
+    /// Bytes `write` needs for the current result.
+    pub fn bytes_needed(self: *const Clusterer) usize {
+        if (!self.enabled) return @sizeOf(GpuHeader);
+        return @sizeOf(GpuHeader) + CLUSTER_COUNT * @sizeOf(GpuRange) + self.stats.indices * @sizeOf(u32);
+    }
+
+    /// Writes the buffer layout described in the module comment into `dst`, which must hold
+    /// `bytes_needed()` bytes. When clustering is disabled only the header is written.
+    pub fn write(self: *const Clusterer, dst: []u8) void {
+        std.debug.assert(dst.len >= self.bytes_needed());
+        @memcpy(dst[0..@sizeOf(GpuHeader)], std.mem.asBytes(&self.header));
+        if (!self.enabled) return;
+
+        var at: usize = @sizeOf(GpuHeader);
+        const range_bytes = std.mem.sliceAsBytes(self.ranges[0..]);
+        @memcpy(dst[at..][0..range_bytes.len], range_bytes);
+        at += range_bytes.len;
+
+        const global_bytes = std.mem.sliceAsBytes(self.globals.items);
+        @memcpy(dst[at..][0..global_bytes.len], global_bytes);
+        at += global_bytes.len;
+
+        for (&self.slices) |*slice| {
+            const bytes = std.mem.sliceAsBytes(slice.indices.items[0..slice.written]);
+            @memcpy(dst[at..][0..bytes.len], bytes);
+            at += bytes.len;
+        }
+    }
+
+    /// Lights reaching every fragment.
+    pub fn global_lights(self: *const Clusterer) []const u32 {
+        return self.globals.items;
+    }
+
+    /// Bounded lights listed for `cluster`.
+    pub fn cluster_lights(self: *const Clusterer, cluster: u32) []const u32 {
+        if (!self.enabled) return &[_]u32{};
+        const slice = &self.slices[cluster / SLICE_CLUSTERS];
+        const range = self.ranges[cluster];
+        if (range.count == 0) return &[_]u32{};
+        return slice.indices.items[range.offset - slice.base ..][0..range.count];
+    }
+
+    /// Cluster a fragment at pixel (`pixel_x`, `pixel_y`) and `view_depth` falls in, computed
+    /// exactly as pbr.frag does. Null when clustering is disabled.
+    pub fn cluster_at(self: *const Clusterer, pixel_x: f32, pixel_y: f32, view_depth: f32) ?u32 {
+        if (!self.enabled) return null;
+        const h = self.header.tile_depth;
+        const x: u32 = @min(@as(u32, @intFromFloat(@max(pixel_x / h[0], 0.0))), GRID_X - 1);
+        const y: u32 = @min(@as(u32, @intFromFloat(@max(pixel_y / h[1], 0.0))), GRID_Y - 1);
+        const z: u32 = @min(@as(u32, @intFromFloat(@max(@log(@max(view_depth, 1e-4)) * h[2] + h[3], 0.0))), GRID_Z - 1);
+        return (z * GRID_Y + y) * GRID_X + x;
+    }
+
+    fn update_bounds(self: *Clusterer, proj: Projection) void {
+        self.projection = proj;
+        const ratio = proj.far / proj.near;
+        self.log_scale = GRID_Z_F / @log(ratio);
+        for (&self.slice_depth, 0..) |*d, k| {
+            d.* = proj.near * std.math.pow(f32, ratio, @as(f32, @floatFromInt(k)) / GRID_Z_F);
+        }
+
+        for (0..GRID_Z) |z| {
+            const d0 = self.slice_depth[z];
+            const d1 = self.slice_depth[z + 1];
+            for (0..GRID_Y) |y| {
+                const y0 = -1.0 + 2.0 * @as(f32, @floatFromInt(y)) / GRID_Y_F + proj.offset_y;
+                const y1 = -1.0 + 2.0 * @as(f32, @floatFromInt(y + 1)) / GRID_Y_F + proj.offset_y;
+                for (0..GRID_X) |x| {
+                    const x0 = -1.0 + 2.0 * @as(f32, @floatFromInt(x)) / GRID_X_F + proj.offset_x;
+                    const x1 = -1.0 + 2.0 * @as(f32, @floatFromInt(x + 1)) / GRID_X_F + proj.offset_x;
+                    const i = (z * GRID_Y + y) * GRID_X + x;
+                    // View-space extent is linear in depth, so the slice's corners bound it.
+                    const xs = [4]f32{ x0 * d0, x0 * d1, x1 * d0, x1 * d1 };
+                    const ys = [4]f32{ y0 * d0, y0 * d1, y1 * d0, y1 * d1 };
+                    self.min_x[i] = @reduce(.Min, @as(@Vector(4, f32), xs)) / proj.scale_x;
+                    self.max_x[i] = @reduce(.Max, @as(@Vector(4, f32), xs)) / proj.scale_x;
+                    self.min_y[i] = @reduce(.Min, @as(@Vector(4, f32), ys)) / proj.scale_y;
+                    self.max_y[i] = @reduce(.Max, @as(@Vector(4, f32), ys)) / proj.scale_y;
+                    if (self.min_x[i] > self.max_x[i]) std.mem.swap(f32, &self.min_x[i], &self.max_x[i]);
+                    if (self.min_y[i] > self.max_y[i]) std.mem.swap(f32, &self.min_y[i], &self.max_y[i]);
+                }
+            }
+        }
+    }
+
+    fn slice_of(self: *const Clusterer, depth: f32, near: f32) u32 {
+        if (depth <= near) return 0;
+        const k = @log(depth / near) * self.log_scale;
+        return @min(@as(u32, @intFromFloat(k)), GRID_Z - 1);
+    }
+
+    fn collect_lights(self: *Clusterer, allocator: std.mem.Allocator, lights: []const pbr.PBRLight, view: math.Mat4, proj: Projection) !void {
+        try self.spheres.ensureTotalCapacity(allocator, lights.len);
+        const max_globals = @min(lights.len, MAX_INDICES);
+        try self.globals.ensureTotalCapacity(allocator, max_globals);
+
+        for (lights, 0..) |light, i| {
+            const kind = light.lightDirection[3];
+            const range = light.params[0];
+            if (kind < 0.5 or !(range > 0.0)) {
+                if (self.globals.items.len < max_globals) {
+                    self.globals.appendAssumeCapacity(@intCast(i));
+                } else {
+                    self.stats.dropped += 1;
+                }
+                continue;
+            }
+
+            var center = math.Vec3{ .x = light.lightPosition[0], .y = light.lightPosition[1], .z = light.lightPosition[2] };
+            var radius = range;
+            const axis = math.Vec3{ .x = light.lightDirection[0], .y = light.lightDirection[1], .z = light.lightDirection[2] };
+            const axis_len = @sqrt(axis.dot(axis));
+            const cos_outer = light.params[2];
+            if (kind > 1.5 and axis_len > 0.0 and cos_outer > 0.0) {
+                // Bounding sphere of the cone: around the cap for wide cones, else through apex and rim.
+                const dir = axis.mul(1.0 / axis_len);
+                if (cos_outer < WIDE_CONE_COS) {
+                    center = center.add(dir.mul(range * cos_outer));
+                    radius = range * @sqrt(1.0 - cos_outer * cos_outer);
+                } else {
+                    radius = range / (2.0 * cos_outer);
+                    center = center.add(dir.mul(radius));
+                }
+            }
+
+            radius = radius * (1.0 + RADIUS_MARGIN_REL) + RADIUS_MARGIN;
+            const p = view.transformPoint(center);
+            const depth = -p.z;
+            if (depth + radius < proj.near or depth - radius > proj.far) continue;
+            self.spheres.appendAssumeCapacity(.{
+                .x = p.x,
+                .y = p.y,
+                .depth = depth,
+                .radius = radius,
+                .light = @intCast(i),
+                .first_slice = self.slice_of(depth - radius, proj.near),
+                .last_slice = self.slice_of(depth + radius, proj.near),
+            });
+        }
+        self.stats.global = self.globals.items.len;
+        self.stats.binned = self.spheres.items.len;
+    }
+
+    fn bin(self: *Clusterer, allocator: std.mem.Allocator, options: Options) !void {
+        var counts = [_]usize{0} ** GRID_Z;
+        for (self.spheres.items) |s| {
+            for (s.first_slice..s.last_slice + 1) |z| counts[z] += 1;
+        }
+        // Reserve everything up front; jobs only append within capacity.
+        for (&self.slices, counts, 0..) |*slice, count, z| {
+            slice.owner = self;
+            slice.z = @intCast(z);
+            try slice.candidates.ensureTotalCapacity(allocator, count);
+            try slice.masks.ensureTotalCapacity(allocator, count);
+            try slice.indices.ensureTotalCapacity(allocator, @min(count * SLICE_CLUSTERS, SLICE_CLUSTERS * MAX_LIGHTS_PER_CLUSTER));
+        }
+
+        if (!options.use_jobs or self.spheres.items.len < MIN_JOB_LIGHTS) {
+            for (&self.slices) |*slice| self.bin_slice(slice);
+            return;
+        }
+
+        self.jobs.clearRetainingCapacity();
+        try self.jobs.ensureTotalCapacity(allocator, GRID_Z);
+        // Keep the first slice for this thread.
+        for (self.slices[1..]) |*slice| {
+            const job = job_system.create_job(Slice.run, slice, .HIGH) orelse {
+                self.bin_slice(slice);
+                continue;
+            };
+            job.push_to_completed_queue = false;
+            while (!job_system.submit_job(job)) {
+                std.Thread.yield() catch {};
+            }
+            self.jobs.appendAssumeCapacity(job);
+        }
+        self.bin_slice(&self.slices[0]);
+        job_system.wait_for_jobs(self.jobs.items);
+        for (self.jobs.items) |job| job_system.free_job(job);
+        self.jobs.clearRetainingCapacity();
+    }
+
+    fn bin_slice(self: *const Clusterer, slice: *Slice) void {
+        const z = slice.z;
+        slice.candidates.clearRetainingCapacity();
+        slice.indices.clearRetainingCapacity();
+        slice.dropped = 0;
+        for (self.spheres.items, 0..) |s, i| {
+            if (s.first_slice <= z and z <= s.last_slice) slice.candidates.appendAssumeCapacity(@intCast(i));
+        }
+        slice.masks.items.len = slice.candidates.items.len;
+
+        const d0 = self.slice_depth[z];
+        const d1 = self.slice_depth[z + 1];
+        const zero: Lanes = @splat(0.0);
+        const none: @Vector(BATCH, u8) = @splat(0);
+
+        for (0..SLICE_BATCHES) |b| {
+            const first = z * SLICE_CLUSTERS + b * BATCH;
+            const min_x: Lanes = self.min_x[first..][0..BATCH].*;
+            const max_x: Lanes = self.max_x[first..][0..BATCH].*;
+            const min_y: Lanes = self.min_y[first..][0..BATCH].*;
+            const max_y: Lanes = self.max_y[first..][0..BATCH].*;
+
+            for (slice.candidates.items, slice.masks.items) |ci, *mask| {
+                const s = self.spheres.items[ci];
+                const dz = @max(@max(d0 - s.depth, s.depth - d1), 0.0);
+                const cx: Lanes = @splat(s.x);
+                const cy: Lanes = @splat(s.y);
+                const dx = @max(@max(min_x - cx, cx - max_x), zero);
+                const dy = @max(@max(min_y - cy, cy - max_y), zero);
+                const dist = dx * dx + dy * dy + @as(Lanes, @splat(dz * dz));
+                const hit = dist <= @as(Lanes, @splat(s.radius * s.radius));
+                mask.* = @reduce(.Or, @select(u8, hit, LANE_BITS, none));
+            }
+
+            // Lane-major pass so each cluster's lights are contiguous.
+            for (0..BATCH) |lane| {
+                const bit = @as(u8, 1) << @intCast(lane);
+                const offset = slice.indices.items.len;
+                var count: u32 = 0;
+                for (slice.candidates.items, slice.masks.items) |ci, mask| {
+                    if (mask & bit == 0) continue;
+                    if (count == MAX_LIGHTS_PER_CLUSTER) {
+                        slice.dropped += 1;
+                        continue;
+                    }
+                    slice.indices.appendAssumeCapacity(self.spheres.items[ci].light);
+                    count += 1;
+                }
+                slice.ranges[b * BATCH + lane] = .{ .offset = @intCast(offset), .count = count };
+            }
+        }
+    }
+
+    /// Places the slices after the global lights and clips what exceeds `MAX_INDICES`.
+    fn assign_offsets(self: *Clusterer) void {
+        var offset: u32 = @intCast(self.globals.items.len);
+        var dropped = self.stats.dropped;
+        var max_count: u32 = 0;
+        for (&self.slices, 0..) |*slice, z| {
+            dropped += slice.dropped;
+            slice.base = offset;
+            slice.written = @intCast(@min(slice.indices.items.len, MAX_INDICES - offset));
+            for (slice.ranges, 0..) |local, i| {
+                const end = @min(local.offset + local.count, slice.written);
+                const count = if (end > local.offset) end - local.offset else 0;
+                dropped += local.count - count;
+                max_count = @max(max_count, count);
+                self.ranges[z * SLICE_CLUSTERS + i] = .{ .offset = offset + local.offset, .count = count };
+            }
+            offset += slice.written;
+        }
+        self.stats.indices = offset;
+        self.stats.dropped = dropped;
+        self.stats.max_per_cluster = max_count;
+    }
+};
+
+/// Fills `out` with point and spot lights scattered through a 200 x 20 x 200 m volume around the
+/// origin, 2-12 m in range; used by tests and benchmarks.
+pub fn synthetic_lights(out: []pbr.PBRLight, seed: u64) void {
+    var prng = std.Random.DefaultPrng.init(seed);
+    const random = prng.random();
+    for (out) |*light| {
+        const spot = random.boolean();
+        const dir = math.Vec3{ .x = random.float(f32) - 0.5, .y = -1.0, .z = random.float(f32) - 0.5 }.normalize();
+        const outer = std.math.degreesToRadians(15.0 + random.float(f32) * 60.0);
+        light.* = .{
+            .lightDirection = .{ dir.x, dir.y, dir.z, if (spot) 2.0 else 1.0 },
+            .lightColor = .{ random.float(f32), random.float(f32), random.float(f32), 100.0 },
+            .params = .{ 2.0 + random.float(f32) * 10.0, @cos(outer * 0.8), @cos(outer), 0.0 },
+            .lightPosition = .{ (random.float(f32) - 0.5) * 200.0, random.float(f32) * 20.0, (random.float(f32) - 0.5) * 200.0, 0.0 },
+        };
+    }
+}
+
+fn test_view(width: u32, height: u32) View {
+    const eye = math.Vec3{ .x = 10.0, .y = 5.0, .z = 60.0 };
+    return .{
+        .view = math.Mat4.lookAt(eye, .{ .x = -20.0, .y = 2.0, .z = 0.0 }, .{ .x = 0.0, .y = 1.0, .z = 0.0 }),
+        .proj = math.Mat4.perspective(std.math.degreesToRadians(70.0), @as(f32, @floatFromInt(width)) / @as(f32, @floatFromInt(height)), 0.1, 200.0),
+        .width = width,
+        .height = height,
+    };
+}
+
+fn light_reaches(light: pbr.PBRLight, point: math.Vec3) bool {
+    const pos = math.Vec3{ .x = light.lightPosition[0], .y = light.lightPosition[1], .z = light.lightPosition[2] };
+    const to_point = point.sub(pos);
+    const dist = @sqrt(to_point.dot(to_point));
+    // Stay clear of the boundaries, where the light contributes nothing anyway.
+    if (dist >= light.params[0] * 0.999) return false;
+    if (light.lightDirection[3] < 1.5 or dist == 0.0) return true;
+    const axis = math.Vec3{ .x = light.lightDirection[0], .y = light.lightDirection[1], .z = light.lightDirection[2] }.normalize();
+    return to_point.dot(axis) / dist > light.params[2] + 1e-3;
+}
+
+test "every light reaching a fragment is listed in its cluster" {
+    const allocator = std.testing.allocator;
+    var lights: [1024]pbr.PBRLight = undefined;
+    synthetic_lights(&lights, 0x11c);
+
+    const view = test_view(1280, 720);
+    const clusterer = try allocator.create(Clusterer);
+    defer allocator.destroy(clusterer);
+    clusterer.* = .{};
+    defer clusterer.deinit(allocator);
+    try clusterer.build(allocator, &lights, view, .{ .use_jobs = false });
+    try std.testing.expect(clusterer.enabled);
+    try std.testing.expectEqual(@as(usize, 0), clusterer.stats.dropped);
+    try std.testing.expect(clusterer.stats.binned > 0 and clusterer.stats.binned < lights.len);
+
+    var prng = std.Random.DefaultPrng.init(7);
+    const random = prng.random();
+    var checked: usize = 0;
+    var listed: usize = 0;
+    for (0..4000) |_| {
+        // Sample near a light so most samples are lit by something.
+        const near_light = lights[random.uintLessThan(usize, lights.len)];
+        const point = math.Vec3{
+            .x = near_light.lightPosition[0] + (random.float(f32) - 0.5) * 16.0,
+            .y = near_light.lightPosition[1] + (random.float(f32) - 0.5) * 16.0,
+            .z = near_light.lightPosition[2] + (random.float(f32) - 0.5) * 16.0,
+        };
+        const clip = view.proj.mulVec4(math.Vec4.fromVec3(view.view.transformPoint(point), 1.0));
+        if (clip.w <= 0.1 or clip.w >= 200.0) continue;
+        const ndc_x = clip.x / clip.w;
+        const ndc_y = clip.y / clip.w;
+        if (@abs(ndc_x) >= 1.0 or @abs(ndc_y) >= 1.0) continue;
+        const px = (ndc_x * 0.5 + 0.5) * 1280.0;
+        const py = (ndc_y * 0.5 + 0.5) * 720.0;
+        const cluster = clusterer.cluster_at(px, py, clip.w).?;
+        const list = clusterer.cluster_lights(cluster);
+
+        for (lights, 0..) |light, i| {
+            if (!light_reaches(light, point)) continue;
+            checked += 1;
+            const index: u32 = @intCast(i);
+            if (std.mem.indexOfScalar(u32, list, index) != null) listed += 1;
+        }
+    }
+    try std.testing.expect(checked > 100);
+    try std.testing.expectEqual(checked, listed);
+}
+
+test "directional and unbounded lights are global; other projections disable clustering" {
+    const allocator = std.testing.allocator;
+    var lights = [_]pbr.PBRLight{std.mem.zeroes(pbr.PBRLight)} ** 3;
+    lights[0].lightDirection = .{ 0.0, -1.0, 0.0, 0.0 };
+    lights[1].lightDirection = .{ 0.0, -1.0, 0.0, 1.0 };
+    lights[1].params = .{ 0.0, 0.0, 0.0, 0.0 };
+    lights[2].lightDirection = .{ 0.0, -1.0, 0.0, 1.0 };
+    lights[2].lightPosition = .{ 0.0, 0.0, -10.0, 0.0 };
+    lights[2].params = .{ 1.0, 0.0, 0.0, 0.0 };
+
+    const clusterer = try allocator.create(Clusterer);
+    defer allocator.destroy(clusterer);
+    clusterer.* = .{};
+    defer clusterer.deinit(allocator);
+
+    var view = View{
+        .view = math.Mat4.identity(),
+        .proj = math.Mat4.perspective(std.math.degreesToRadians(60.0), 16.0 / 9.0, 0.5, 100.0),
+        .width = 1600,
+        .height = 900,
+    };
+    try clusterer.build(allocator, &lights, view, .{});
+    try std.testing.expectEqualSlices(u32, &.{ 0, 1 }, clusterer.global_lights());
+    const centre = clusterer.cluster_at(800.0, 450.0, 10.0).?;
+    try std.testing.expectEqualSlices(u32, &.{2}, clusterer.cluster_lights(centre));
+    try std.testing.expectEqual(@as(u32, 1), clusterer.header.grid[3]);
+
+    const words = try allocator.alloc(u32, clusterer.bytes_needed() / @sizeOf(u32));
+    defer allocator.free(words);
+    const buffer = std.mem.sliceAsBytes(words);
+    clusterer.write(buffer);
+    const ranges = std.mem.bytesAsSlice(GpuRange, buffer[@sizeOf(GpuHeader)..][0 .. CLUSTER_COUNT * @sizeOf(GpuRange)]);
+    const indices = std.mem.bytesAsSlice(u32, buffer[@sizeOf(GpuHeader) + CLUSTER_COUNT * @sizeOf(GpuRange) ..][0 .. clusterer.stats.indices * @sizeOf(u32)]);
+    try std.testing.expectEqual(@as(u32, 2), indices[ranges[centre].offset]);
+
+    view.proj = math.Mat4.ortho(-10.0, 10.0, -10.0, 10.0, 0.1, 100.0);
+    try clusterer.build(allocator, &lights, view, .{});
+    try std.testing.expect(!clusterer.enabled);
+    try std.testing.expectEqual(@as(u32, 0), clusterer.header.grid[3]);
+    try std.testing.expectEqual(@as(usize, @sizeOf(GpuHeader)), clusterer.bytes_needed());
+}
+
+test "clusters keep at most MAX_LIGHTS_PER_CLUSTER lights and count the rest" {
+    const allocator = std.testing.allocator;
+    var lights: [MAX_LIGHTS_PER_CLUSTER + 40]pbr.PBRLight = undefined;
+    for (&lights) |*light| {
+        light.* = std.mem.zeroes(pbr.PBRLight);
+        light.lightDirection = .{ 0.0, -1.0, 0.0, 1.0 };
+        light.lightPosition = .{ 0.0, 0.0, -20.0, 0.0 };
+        light.params = .{ 2.0, 0.0, 0.0, 0.0 };
+    }
+
+    const clusterer = try allocator.create(Clusterer);
+    defer allocator.destroy(clusterer);
+    clusterer.* = .{};
+    defer clusterer.deinit(allocator);
+
+    const view = View{
+        .view = math.Mat4.identity(),
+        .proj = math.Mat4.perspective(std.math.degreesToRadians(60.0), 1.0, 0.1, 100.0),
+        .width = 512,
+        .height = 512,
+    };
+    try clusterer.build(allocator, &lights, view, .{ .use_jobs = false });
+    const centre = clusterer.cluster_at(256.0, 256.0, 20.0).?;
+    try std.testing.expectEqual(@as(usize, MAX_LIGHTS_PER_CLUSTER), clusterer.cluster_lights(centre).len);
+    try std.testing.expectEqual(MAX_LIGHTS_PER_CLUSTER, clusterer.stats.max_per_cluster);
+    try std.testing.expect(clusterer.stats.dropped >= 40);
+}
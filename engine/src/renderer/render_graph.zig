@@ -3,11 +3,21 @@
 //! Tracks resource lifetimes and required barriers between passes, and supports transient
 //! resource allocation through VMA. Intended to keep per-frame rendering orchestration explicit.
 //!
+//! `compile()` turns the declared passes into a `CompiledPlan` on the CPU: it builds a dependency
+//! DAG from read/write hazards, orders the active passes, optionally moves independent
+//! compute-only passes to the async compute queue, and precomputes every transition. All
+//! transitions a pass needs are recorded as one batched barrier; transitions whose producer ran
+//! two or more passes earlier on the same queue become split barriers (an event set after the
+//! producer and waited on before the consumer), and transitions between queues become
+//! release/acquire pairs ordered by per-queue timeline values. `dump()` prints the plan, so it
+//! can be checked without a device.
+//!
 //! TODO: Add pass dependency visualization export for debugging (e.g. GraphViz).
 const std = @import("std");
 const c = @import("vulkan_c.zig").c;
 const types = @import("vulkan_types.zig");
 const log = @import("../core/log.zig");
+const memory = @import("../core/memory.zig");
 const vk_allocator = @import("vulkan_allocator.zig");
 
 const rg_log = log.ScopedLogger("RENDER_GRAPH");
@@ -90,9 +100,10 @@ pub const ResourceState = struct {
     queue_family: u32 = c.VK_QUEUE_FAMILY_IGNORED,
 };
 
+/// First and last position in `CompiledPlan.steps` that touch a resource.
 const ResourceLifetime = struct {
-    first_pass: usize,
-    last_pass: usize,
+    first_step: usize,
+    last_step: usize,
 };
 
 /// Declares how a pass reads or writes a resource.
@@ -115,13 +126,40 @@ pub const ResourceAccess = struct {
 
 pub const RenderPassCallback = *const fn (cmd: c.VkCommandBuffer, state: *types.VulkanState) void;
 
+/// Hardware queue a compiled pass is recorded on.
+pub const Queue = enum {
+    graphics,
+    compute,
+
+    pub fn other(self: Queue) Queue {
+        return if (self == .graphics) .compute else .graphics;
+    }
+};
+
+/// Queue preference declared by a pass.
+pub const QueueAffinity = enum {
+    /// Graphics, unless the graph compiles with `async_compute` and the pass only touches
+    /// resources from compute/transfer stages and can overlap graphics work.
+    auto,
+    graphics,
+    /// Always the compute queue when `async_compute` is enabled.
+    compute,
+};
+
+/// Stages a pass may use and still run on a compute-only queue.
+const COMPUTE_QUEUE_STAGES: c.VkPipelineStageFlags2 = c.VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT |
+    c.VK_PIPELINE_STAGE_2_TRANSFER_BIT |
+    c.VK_PIPELINE_STAGE_2_COPY_BIT |
+    c.VK_PIPELINE_STAGE_2_CLEAR_BIT |
+    c.VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT;
+
 pub const RenderPass = struct {
     name: []const u8,
     execute_fn: RenderPassCallback,
     inputs: std.ArrayListUnmanaged(ResourceAccess),
     outputs: std.ArrayListUnmanaged(ResourceAccess),
 
-    queue_family: u32 = c.VK_QUEUE_FAMILY_IGNORED,
+    queue_affinity: QueueAffinity = .auto,
 
     is_active: bool = true,
     /// When false, `compile()` always marks the pass active.
@@ -152,12 +190,460 @@ pub const RenderPass = struct {
         try self.outputs.append(allocator, access);
     }
 
-    pub fn use_graphics_queue(self: *RenderPass, state: *types.VulkanState) void {
-        self.queue_family = state.context.graphics_queue_family;
+    pub fn use_graphics_queue(self: *RenderPass) void {
+        self.queue_affinity = .graphics;
+    }
+
+    pub fn use_compute_queue(self: *RenderPass) void {
+        self.queue_affinity = .compute;
+    }
+
+    /// True when every declared access happens in stages a compute queue supports.
+    fn is_compute_only(self: *const RenderPass) bool {
+        if (self.inputs.items.len == 0 and self.outputs.items.len == 0) return false;
+        for (self.inputs.items) |a| {
+            if (a.is_present or a.stage_mask & ~COMPUTE_QUEUE_STAGES != 0) return false;
+        }
+        for (self.outputs.items) |a| {
+            if (a.is_present or a.stage_mask & ~COMPUTE_QUEUE_STAGES != 0) return false;
+        }
+        return true;
+    }
+};
+
+/// Contiguous range into one of the `CompiledPlan` arrays.
+pub const Span = struct {
+    start: u32 = 0,
+    len: u32 = 0,
+
+    fn slice(self: Span, comptime T: type, items: []T) []T {
+        return items[self.start..][0..self.len];
+    }
+};
+
+pub const BarrierKind = enum {
+    /// Part of the consumer's batched pipeline barrier.
+    immediate,
+    /// Event set after the producer and waited on before the consumer.
+    split,
+    /// Released on the producer's queue and acquired on the consumer's, after a timeline wait.
+    queue_transfer,
+};
+
+/// One resource transition computed by `compile()`.
+pub const PlannedBarrier = struct {
+    /// Destination access: stages, access mask, layout and subresource range.
+    access: ResourceAccess,
+    /// Source state. Null for the first access in the frame, which is resolved against
+    /// `resource_states` at execution time.
+    src: ?ResourceState,
+    src_queue: Queue,
+    dst_queue: Queue,
+    kind: BarrierKind,
+    /// Step that last touched the resource (valid when `src` is set).
+    producer_step: u32 = 0,
+    consumer_step: u32,
+    /// Event slot for split barriers.
+    event: u32 = 0,
+};
+
+/// One active pass in execution order.
+pub const CompiledStep = struct {
+    pass_index: u32,
+    queue: Queue,
+    /// Barriers recorded before the pass, as a span of `CompiledPlan.barriers`.
+    before: Span = .{},
+    /// Barriers whose first half (event set or queue release) is recorded after the pass, as a
+    /// span of `CompiledPlan.after`.
+    after: Span = .{},
+    /// Index into `CompiledPlan.submits`.
+    submit: u32 = 0,
+};
+
+/// Dependency between two passes (pass indices).
+pub const Edge = struct {
+    from: u32,
+    to: u32,
+};
+
+/// One queue submission. Timeline values are per queue and relative to the frame: the
+/// submitter adds its own base value for each queue.
+pub const SubmitBatch = struct {
+    queue: Queue,
+    /// Span of `CompiledPlan.submit_steps`.
+    steps: Span,
+    /// Value of the other queue's timeline to wait for; 0 when the batch waits for nothing.
+    wait_value: u64 = 0,
+    wait_stage_mask: c.VkPipelineStageFlags2 = c.VK_PIPELINE_STAGE_2_NONE,
+    signal_value: u64 = 0,
+};
+
+/// Execution plan produced by `RenderGraph.compile()`.
+pub const CompiledPlan = struct {
+    steps: std.ArrayListUnmanaged(CompiledStep) = .{},
+    /// Transitions grouped by consumer step.
+    barriers: std.ArrayListUnmanaged(PlannedBarrier) = .{},
+    /// Indices into `barriers` of split and queue-transfer barriers, grouped by producer step.
+    after: std.ArrayListUnmanaged(u32) = .{},
+    submits: std.ArrayListUnmanaged(SubmitBatch) = .{},
+    /// Step indices of every submit batch, grouped by batch.
+    submit_steps: std.ArrayListUnmanaged(u32) = .{},
+    edges: std.ArrayListUnmanaged(Edge) = .{},
+    event_count: u32 = 0,
+
+    pub fn deinit(self: *CompiledPlan, allocator: std.mem.Allocator) void {
+        self.steps.deinit(allocator);
+        self.barriers.deinit(allocator);
+        self.after.deinit(allocator);
+        self.submits.deinit(allocator);
+        self.submit_steps.deinit(allocator);
+        self.edges.deinit(allocator);
+        self.* = .{};
+    }
+
+    fn clear(self: *CompiledPlan) void {
+        self.steps.clearRetainingCapacity();
+        self.barriers.clearRetainingCapacity();
+        self.after.clearRetainingCapacity();
+        self.submits.clearRetainingCapacity();
+        self.submit_steps.clearRetainingCapacity();
+        self.edges.clearRetainingCapacity();
+        self.event_count = 0;
     }
 
-    pub fn use_compute_queue(self: *RenderPass, state: *types.VulkanState) void {
-        self.queue_family = state.context.compute_queue_family;
+    /// Number of steps scheduled on the compute queue.
+    pub fn async_step_count(self: *const CompiledPlan) u32 {
+        var count: u32 = 0;
+        for (self.steps.items) |step| {
+            if (step.queue == .compute) count += 1;
+        }
+        return count;
+    }
+
+    /// Number of `vkCmdPipelineBarrier2` calls one single-queue execution records at most: one
+    /// per step with consumer-side transitions (split waits use `vkCmdWaitEvents2` instead).
+    pub fn pipeline_barrier_count(self: *const CompiledPlan) u32 {
+        var count: u32 = 0;
+        for (self.steps.items) |step| {
+            for (step.before.slice(PlannedBarrier, self.barriers.items)) |b| {
+                if (b.kind != .split) {
+                    count += 1;
+                    break;
+                }
+            }
+        }
+        return count;
+    }
+};
+
+/// Timeline wait attached to an async submission.
+pub const TimelineWait = struct {
+    queue: Queue,
+    value: u64,
+    stage_mask: c.VkPipelineStageFlags2,
+};
+
+/// Callbacks `RenderGraph.execute_async` uses to obtain and submit command buffers.
+pub const QueueSubmitter = struct {
+    ctx: ?*anyopaque = null,
+    /// Returns a command buffer in the recording state for the next batch on `queue`.
+    begin: *const fn (ctx: ?*anyopaque, queue: Queue) ?c.VkCommandBuffer,
+    /// Ends and submits `cmd` on `queue`. Signals the queue's timeline at `signal_value` (plus
+    /// the submitter's frame base) after optionally waiting on the other queue's timeline.
+    submit: *const fn (ctx: ?*anyopaque, queue: Queue, cmd: c.VkCommandBuffer, wait: ?TimelineWait, signal_value: u64) bool,
+};
+
+/// A pass's inputs and outputs folded into one access per resource.
+const MergedAccess = struct {
+    access: ResourceAccess,
+    writes: bool,
+};
+
+fn merge_accesses(allocator: std.mem.Allocator, pass: *const RenderPass) ![]const MergedAccess {
+    var list = std.ArrayListUnmanaged(MergedAccess){};
+    for (pass.inputs.items) |access| try merge_access(allocator, &list, access, false);
+    for (pass.outputs.items) |access| try merge_access(allocator, &list, access, true);
+    return list.items;
+}
+
+/// Accesses in the same layout combine their masks. An output in a different layout (a present
+/// transition, say) replaces the input, since the pass leaves the resource in that state.
+fn merge_access(allocator: std.mem.Allocator, list: *std.ArrayListUnmanaged(MergedAccess), access: ResourceAccess, writes: bool) !void {
+    for (list.items) |*merged| {
+        if (merged.access.id != access.id) continue;
+        if (merged.access.type == .Image and merged.access.layout != access.layout) {
+            merged.access = access;
+        } else {
+            merged.access.access_mask |= access.access_mask;
+            merged.access.stage_mask |= access.stage_mask;
+            merged.access.is_present = merged.access.is_present or access.is_present;
+        }
+        merged.writes = merged.writes or writes;
+        return;
+    }
+    try list.append(allocator, .{ .access = access, .writes = writes });
+}
+
+/// Predecessor sets from read-after-write, write-after-read and write-after-write hazards, in
+/// declaration order. A pass without accesses depends on everything before it and everything
+/// after it depends on it.
+fn build_dependencies(allocator: std.mem.Allocator, accesses: []const []const MergedAccess) ![]std.DynamicBitSetUnmanaged {
+    const n = accesses.len;
+    const preds = try allocator.alloc(std.DynamicBitSetUnmanaged, n);
+    for (preds) |*p| p.* = try std.DynamicBitSetUnmanaged.initEmpty(allocator, n);
+
+    const Hazards = struct {
+        last_writer: ?usize = null,
+        readers: std.ArrayListUnmanaged(usize) = .{},
+    };
+    var hazards = std.AutoHashMapUnmanaged(ResourceId, Hazards){};
+    var last_fence: ?usize = null;
+
+    for (accesses, 0..) |list, a| {
+        if (list.len == 0) {
+            for (0..a) |b| preds[a].set(b);
+            last_fence = a;
+            continue;
+        }
+        if (last_fence) |f| preds[a].set(f);
+
+        for (list) |merged| {
+            const gop = try hazards.getOrPut(allocator, merged.access.id);
+            if (!gop.found_existing) gop.value_ptr.* = .{};
+            const h = gop.value_ptr;
+            if (h.last_writer) |w| preds[a].set(w);
+            if (merged.writes) {
+                for (h.readers.items) |r| preds[a].set(r);
+                h.readers.clearRetainingCapacity();
+                h.last_writer = a;
+            } else {
+                try h.readers.append(allocator, a);
+            }
+        }
+    }
+    return preds;
+}
+
+fn all_placed(preds: std.DynamicBitSetUnmanaged, placed: std.DynamicBitSetUnmanaged) bool {
+    var it = preds.iterator(.{});
+    while (it.next()) |p| {
+        if (!placed.isSet(p)) return false;
+    }
+    return true;
+}
+
+/// Async compute passes go first, then graphics passes feeding async compute, then the rest, so
+/// compute work is submitted as early as its inputs allow.
+fn schedule_rank(queues: []const Queue, descendants: std.DynamicBitSetUnmanaged, a: usize) u8 {
+    if (queues[a] == .compute) return 0;
+    var it = descendants.iterator(.{});
+    while (it.next()) |d| {
+        if (queues[d] == .compute) return 1;
+    }
+    return 2;
+}
+
+fn state_differs(resource_type: ResourceType, old: ResourceState, new: ResourceState) bool {
+    if (old.access_mask != new.access_mask or old.stage_mask != new.stage_mask) return true;
+    return resource_type == .Image and (old.layout != new.layout or old.layout == c.VK_IMAGE_LAYOUT_UNDEFINED);
+}
+
+/// Splits the steps into per-queue submit batches. A batch ends after a step that releases a
+/// resource to the other queue, so the release can be signalled, and a step that acquires one
+/// starts a new batch unless the open batch already waits for a late enough value.
+fn plan_submits(plan: *CompiledPlan, allocator: std.mem.Allocator) !void {
+    var open = [2]?u32{ null, null };
+    var signal_counts = [2]u64{ 0, 0 };
+
+    for (plan.steps.items) |*step| {
+        const q = @intFromEnum(step.queue);
+        var wait_value: u64 = 0;
+        var wait_stages: c.VkPipelineStageFlags2 = c.VK_PIPELINE_STAGE_2_NONE;
+        for (step.before.slice(PlannedBarrier, plan.barriers.items)) |b| {
+            if (b.kind != .queue_transfer) continue;
+            const producer = plan.steps.items[b.producer_step];
+            wait_value = @max(wait_value, plan.submits.items[producer.submit].signal_value);
+            wait_stages |= b.access.stage_mask;
+        }
+
+        if (open[q]) |bi| {
+            if (wait_value > plan.submits.items[bi].wait_value) {
+                signal_counts[q] += 1;
+                plan.submits.items[bi].signal_value = signal_counts[q];
+                open[q] = null;
+            }
+        }
+        if (open[q] == null) {
+            try plan.submits.append(allocator, .{ .queue = step.queue, .steps = .{}, .wait_value = wait_value });
+            open[q] = @intCast(plan.submits.items.len - 1);
+        }
+        const bi = open[q].?;
+        plan.submits.items[bi].wait_stage_mask |= wait_stages;
+        step.submit = bi;
+
+        const releases = for (step.after.slice(u32, plan.after.items)) |ai| {
+            if (plan.barriers.items[ai].kind == .queue_transfer) break true;
+        } else false;
+        if (releases) {
+            signal_counts[q] += 1;
+            plan.submits.items[bi].signal_value = signal_counts[q];
+            open[q] = null;
+        }
+    }
+    for (open, 0..) |maybe_bi, q| {
+        if (maybe_bi) |bi| {
+            signal_counts[q] += 1;
+            plan.submits.items[bi].signal_value = signal_counts[q];
+        }
+    }
+
+    for (plan.submits.items, 0..) |*batch, bi| {
+        batch.steps.start = @intCast(plan.submit_steps.items.len);
+        for (plan.steps.items, 0..) |step, pos| {
+            if (step.submit == bi) try plan.submit_steps.append(allocator, @intCast(pos));
+        }
+        batch.steps.len = @as(u32, @intCast(plan.submit_steps.items.len)) - batch.steps.start;
+    }
+}
+
+/// Image and buffer barriers recorded as one `VkDependencyInfo`.
+const BarrierBatch = struct {
+    images: std.ArrayListUnmanaged(c.VkImageMemoryBarrier2) = .{},
+    buffers: std.ArrayListUnmanaged(c.VkBufferMemoryBarrier2) = .{},
+
+    const Transition = struct {
+        src_stage: c.VkPipelineStageFlags2,
+        src_access: c.VkAccessFlags2,
+        dst_stage: c.VkPipelineStageFlags2,
+        dst_access: c.VkAccessFlags2,
+        old_layout: c.VkImageLayout,
+        new_layout: c.VkImageLayout,
+        src_family: u32 = c.VK_QUEUE_FAMILY_IGNORED,
+        dst_family: u32 = c.VK_QUEUE_FAMILY_IGNORED,
+    };
+
+    fn add(self: *BarrierBatch, allocator: std.mem.Allocator, handle: ResourceHandle, access: ResourceAccess, t: Transition) !void {
+        switch (handle) {
+            .Image => |image| {
+                var barrier = std.mem.zeroes(c.VkImageMemoryBarrier2);
+                barrier.sType = c.VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+                barrier.srcStageMask = t.src_stage;
+                barrier.srcAccessMask = t.src_access;
+                barrier.dstStageMask = t.dst_stage;
+                barrier.dstAccessMask = t.dst_access;
+                barrier.oldLayout = t.old_layout;
+                barrier.newLayout = t.new_layout;
+                barrier.srcQueueFamilyIndex = t.src_family;
+                barrier.dstQueueFamilyIndex = t.dst_family;
+                barrier.image = image;
+                barrier.subresourceRange.aspectMask = access.aspect_mask;
+                barrier.subresourceRange.baseMipLevel = access.base_mip_level;
+                barrier.subresourceRange.levelCount = access.level_count;
+                barrier.subresourceRange.baseArrayLayer = access.base_array_layer;
+                barrier.subresourceRange.layerCount = access.layer_count;
+                try self.images.append(allocator, barrier);
+            },
+            .Buffer => |buffer| {
+                var barrier = std.mem.zeroes(c.VkBufferMemoryBarrier2);
+                barrier.sType = c.VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+                barrier.srcStageMask = t.src_stage;
+                barrier.srcAccessMask = t.src_access;
+                barrier.dstStageMask = t.dst_stage;
+                barrier.dstAccessMask = t.dst_access;
+                barrier.srcQueueFamilyIndex = t.src_family;
+                barrier.dstQueueFamilyIndex = t.dst_family;
+                barrier.buffer = buffer;
+                barrier.offset = 0;
+                barrier.size = c.VK_WHOLE_SIZE;
+                try self.buffers.append(allocator, barrier);
+            },
+        }
+    }
+
+    fn is_empty(self: *const BarrierBatch) bool {
+        return self.images.items.len == 0 and self.buffers.items.len == 0;
+    }
+
+    fn dst_stage_mask(self: *const BarrierBatch) c.VkPipelineStageFlags2 {
+        var mask: c.VkPipelineStageFlags2 = c.VK_PIPELINE_STAGE_2_NONE;
+        for (self.images.items) |b| mask |= b.dstStageMask;
+        for (self.buffers.items) |b| mask |= b.dstStageMask;
+        return mask;
+    }
+
+    fn dependency(self: *const BarrierBatch) c.VkDependencyInfo {
+        var info = std.mem.zeroes(c.VkDependencyInfo);
+        info.sType = c.VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        info.imageMemoryBarrierCount = @intCast(self.images.items.len);
+        info.pImageMemoryBarriers = self.images.items.ptr;
+        info.bufferMemoryBarrierCount = @intCast(self.buffers.items.len);
+        info.pBufferMemoryBarriers = self.buffers.items.ptr;
+        return info;
+    }
+
+    fn record(self: *const BarrierBatch, cmd: c.VkCommandBuffer, state: *types.VulkanState) void {
+        if (self.is_empty()) return;
+        const info = self.dependency();
+        if (state.context.vkCmdPipelineBarrier2) |func| {
+            func(cmd, &info);
+        } else {
+            c.vkCmdPipelineBarrier2(cmd, &info);
+        }
+    }
+};
+
+/// Full transition from a planned source state.
+fn planned_transition(src: ResourceState, access: ResourceAccess) BarrierBatch.Transition {
+    return .{
+        .src_stage = src.stage_mask,
+        .src_access = src.access_mask,
+        .dst_stage = access.stage_mask,
+        .dst_access = access.access_mask,
+        .old_layout = src.layout,
+        .new_layout = access.layout,
+    };
+}
+
+/// Transition for a resource's first access in the frame, from its tracked runtime state. Null
+/// when the resource is already in the requested state.
+fn initial_transition(current: ResourceState, access: ResourceAccess, dst_family: u32) ?BarrierBatch.Transition {
+    const queue_changed = current.queue_family != c.VK_QUEUE_FAMILY_IGNORED and
+        dst_family != c.VK_QUEUE_FAMILY_IGNORED and
+        current.queue_family != dst_family;
+    const redundant = !queue_changed and
+        current.access_mask == access.access_mask and
+        current.stage_mask == access.stage_mask and
+        (access.type == .Buffer or (current.layout == access.layout and current.layout != c.VK_IMAGE_LAYOUT_UNDEFINED));
+    if (redundant) return null;
+
+    var t = planned_transition(current, access);
+    if (queue_changed) {
+        t.src_family = current.queue_family;
+        t.dst_family = dst_family;
+    }
+    return t;
+}
+
+/// Per-execution settings shared by every recorded step.
+const ExecContext = struct {
+    state: *types.VulkanState,
+    /// Queue family per `Queue`.
+    families: [2]u32,
+    /// Every step goes to one command buffer, so queue transfers collapse to plain barriers.
+    single_queue: bool,
+    /// Split-barrier events for this frame; empty when they could not be created.
+    events: []const c.VkEvent,
+
+    fn family(self: *const ExecContext, queue: Queue) u32 {
+        return self.families[@intFromEnum(queue)];
+    }
+
+    fn transfers_ownership(self: *const ExecContext, b: *const PlannedBarrier) bool {
+        return !self.single_queue and b.kind == .queue_transfer and self.family(b.src_queue) != self.family(b.dst_queue);
+    }
+
+    fn uses_event(self: *const ExecContext, b: *const PlannedBarrier) bool {
+        return b.kind == .split and b.event < self.events.len;
     }
 };
 
@@ -169,13 +655,21 @@ pub const RenderGraph = struct {
     resources: std.AutoHashMapUnmanaged(ResourceId, RenderGraphResource),
     /// Current per-resource state used for barrier generation during execution.
     resource_states: std.AutoHashMapUnmanaged(ResourceId, ResourceState),
-    /// Resource lifetimes (first/last pass) computed by `compile()` for aliasing.
+    /// Resource lifetimes (first/last step) computed by `compile()` for aliasing.
     resource_lifetimes: std.AutoHashMapUnmanaged(ResourceId, ResourceLifetime),
 
     /// Transient resource pools for per-frame reuse.
     image_pool: std.ArrayListUnmanaged(PooledImage),
     buffer_pool: std.ArrayListUnmanaged(PooledBuffer),
 
+    /// Execution order, barriers and submissions computed by `compile()`.
+    plan: CompiledPlan = .{},
+    /// When set, `compile()` schedules independent compute-only passes on the compute queue.
+    /// They only run there through `execute_async`; `execute` records everything on one queue.
+    async_compute: bool = false,
+    /// Split-barrier events, one set per frame in flight so frames never share an event.
+    events: [types.MAX_FRAMES_IN_FLIGHT]std.ArrayListUnmanaged(c.VkEvent) = [_]std.ArrayListUnmanaged(c.VkEvent){.{}} ** types.MAX_FRAMES_IN_FLIGHT,
+
     pub fn init(allocator: std.mem.Allocator) RenderGraph {
         return .{
             .passes = .{},
@@ -198,6 +692,8 @@ pub const RenderGraph = struct {
         self.resource_lifetimes.deinit(self.allocator);
         self.image_pool.deinit(self.allocator);
         self.buffer_pool.deinit(self.allocator);
+        self.plan.deinit(self.allocator);
+        for (&self.events) |*list| list.deinit(self.allocator);
     }
 
     /// Registers an externally-owned image into the graph under `id`.
@@ -405,6 +901,11 @@ pub const RenderGraph = struct {
             }
         }
         self.buffer_pool.clearRetainingCapacity();
+
+        for (&self.events) |*list| {
+            for (list.items) |event| c.vkDestroyEvent(state.context.device, event, null);
+            list.clearRetainingCapacity();
+        }
     }
 
     pub fn set_resource_state(self: *RenderGraph, id: ResourceId, state: ResourceState) !void {
@@ -422,16 +923,21 @@ pub const RenderGraph = struct {
         self.passes.clearRetainingCapacity();
     }
 
-    /// Marks active passes and computes transient resource lifetimes for aliasing.
+    /// Marks active passes and builds the execution plan.
     ///
     /// A pass starts active when `can_be_culled` is false or when it declares a present output.
+    /// Active passes that declare no resources act as ordering fences: everything declared
+    /// before them runs before, everything declared after runs after.
     pub fn compile(self: *RenderGraph) !void {
         for (self.passes.items) |*pass| {
             pass.is_active = !pass.can_be_culled;
         }
 
+        const scratch = memory.scratch_begin() orelse return error.OutOfMemory;
+        defer scratch.end();
+        const scratch_alloc = scratch.allocator();
+
         var queue = std.ArrayListUnmanaged(usize){};
-        defer queue.deinit(self.allocator);
 
         for (self.passes.items, 0..) |*pass, i| {
             var has_present_output = false;
@@ -444,7 +950,7 @@ pub const RenderGraph = struct {
 
             if (pass.is_active or has_present_output) {
                 pass.is_active = true;
-                try queue.append(self.allocator, i);
+                try queue.append(scratch_alloc, i);
             }
         }
 
@@ -470,7 +976,7 @@ pub const RenderGraph = struct {
                     if (produces) {
                         if (!self.passes.items[i].is_active) {
                             self.passes.items[i].is_active = true;
-                            try queue.append(self.allocator, i);
+                            try queue.append(scratch_alloc, i);
                         }
                         break;
                     }
@@ -478,132 +984,205 @@ pub const RenderGraph = struct {
             }
         }
 
+        try self.build_plan(scratch_alloc);
+
+        rg_log.debug("RG compile: {d} steps ({d} async), {d} barriers in {d} batches, {d} events, {d} submits, {d} tracked resources", .{
+            self.plan.steps.items.len,
+            self.plan.async_step_count(),
+            self.plan.barriers.items.len,
+            self.plan.pipeline_barrier_count(),
+            self.plan.event_count,
+            self.plan.submits.items.len,
+            self.resource_lifetimes.count(),
+        });
+    }
+
+    /// Orders the active passes, assigns queues and precomputes barriers, submissions and
+    /// resource lifetimes.
+    fn build_plan(self: *RenderGraph, scratch_alloc: std.mem.Allocator) !void {
+        const plan = &self.plan;
+        plan.clear();
         self.resource_lifetimes.clearRetainingCapacity();
+
+        var active = std.ArrayListUnmanaged(u32){};
         for (self.passes.items, 0..) |pass, i| {
-            if (!pass.is_active) continue;
-            for (pass.inputs.items) |input| {
-                if (self.resource_lifetimes.getPtr(input.id)) |life| {
-                    if (i < life.first_pass) life.first_pass = i;
-                    if (i > life.last_pass) life.last_pass = i;
-                } else {
-                    self.resource_lifetimes.put(self.allocator, input.id, .{ .first_pass = i, .last_pass = i }) catch {};
-                }
+            if (pass.is_active) try active.append(scratch_alloc, @intCast(i));
+        }
+        const n = active.items.len;
+
+        const accesses = try scratch_alloc.alloc([]const MergedAccess, n);
+        for (active.items, accesses) |pass_index, *list| {
+            list.* = try merge_accesses(scratch_alloc, &self.passes.items[pass_index]);
+        }
+
+        const preds = try build_dependencies(scratch_alloc, accesses);
+        for (preds, 0..) |p, a| {
+            var it = p.iterator(.{});
+            while (it.next()) |b| {
+                try plan.edges.append(self.allocator, .{ .from = active.items[b], .to = active.items[a] });
             }
-            for (pass.outputs.items) |output| {
-                if (self.resource_lifetimes.getPtr(output.id)) |life| {
-                    if (i < life.first_pass) life.first_pass = i;
-                    if (i > life.last_pass) life.last_pass = i;
-                } else {
-                    self.resource_lifetimes.put(self.allocator, output.id, .{ .first_pass = i, .last_pass = i }) catch {};
+        }
+
+        // Dependencies only point backwards in declaration order, so one reverse sweep yields
+        // every pass's transitive descendants.
+        const descendants = try scratch_alloc.alloc(std.DynamicBitSetUnmanaged, n);
+        var d = n;
+        while (d > 0) {
+            d -= 1;
+            descendants[d] = try std.DynamicBitSetUnmanaged.initEmpty(scratch_alloc, n);
+            for (d + 1..n) |later| {
+                if (preds[later].isSet(d)) {
+                    descendants[d].set(later);
+                    descendants[d].setUnion(descendants[later]);
                 }
             }
         }
 
-        var active_count: usize = 0;
-        for (self.passes.items) |pass| {
-            if (pass.is_active) active_count += 1;
+        const queues = try scratch_alloc.alloc(Queue, n);
+        @memset(queues, .graphics);
+        if (self.async_compute) {
+            for (active.items, 0..) |pass_index, a| {
+                const pass = &self.passes.items[pass_index];
+                queues[a] = switch (pass.queue_affinity) {
+                    .graphics => .graphics,
+                    .compute => .compute,
+                    .auto => if (pass.is_compute_only() and self.overlaps_graphics(active.items, descendants, a)) .compute else .graphics,
+                };
+            }
         }
-        rg_log.debug("RG compile: {d} active passes, {d} tracked resources", .{ active_count, self.resource_lifetimes.count() });
-    }
 
-    /// Inserts a barrier transitioning `handle` from `old_state` to `new_access`.
-    fn insert_barrier(cmd: c.VkCommandBuffer, handle: ResourceHandle, old_state: ResourceState, new_access: ResourceAccess, state: *types.VulkanState) void {
-        switch (handle) {
-            .Image => |image| {
-                const queue_changed = (old_state.queue_family != c.VK_QUEUE_FAMILY_IGNORED and
-                    new_access.queue_family != c.VK_QUEUE_FAMILY_IGNORED and
-                    old_state.queue_family != new_access.queue_family);
-
-                if (!queue_changed and
-                    old_state.layout == new_access.layout and
-                    old_state.access_mask == new_access.access_mask and
-                    old_state.stage_mask == new_access.stage_mask and
-                    old_state.layout != c.VK_IMAGE_LAYOUT_UNDEFINED)
-                {
-                    return;
+        // Topological order; among ready passes the lowest rank wins, then declaration order.
+        const order = try scratch_alloc.alloc(u32, n);
+        var placed = try std.DynamicBitSetUnmanaged.initEmpty(scratch_alloc, n);
+        for (order) |*slot| {
+            var best: ?usize = null;
+            var best_rank: u8 = 0;
+            for (0..n) |a| {
+                if (placed.isSet(a) or !all_placed(preds[a], placed)) continue;
+                const rank = schedule_rank(queues, descendants[a], a);
+                if (best == null or rank < best_rank) {
+                    best = a;
+                    best_rank = rank;
                 }
+            }
+            // Never null: edges only point backwards, so the graph is acyclic.
+            const chosen = best.?;
+            placed.set(chosen);
+            slot.* = @intCast(chosen);
+        }
 
-                var barrier = std.mem.zeroes(c.VkImageMemoryBarrier2);
-                barrier.sType = c.VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
-                barrier.srcStageMask = old_state.stage_mask;
-                barrier.srcAccessMask = old_state.access_mask;
-                barrier.dstStageMask = new_access.stage_mask;
-                barrier.dstAccessMask = new_access.access_mask;
-                barrier.oldLayout = old_state.layout;
-                barrier.newLayout = new_access.layout;
-
-                if (queue_changed) {
-                    barrier.srcQueueFamilyIndex = old_state.queue_family;
-                    barrier.dstQueueFamilyIndex = new_access.queue_family;
-                } else {
-                    barrier.srcQueueFamilyIndex = c.VK_QUEUE_FAMILY_IGNORED;
-                    barrier.dstQueueFamilyIndex = c.VK_QUEUE_FAMILY_IGNORED;
-                }
+        const queue_pos = try scratch_alloc.alloc(u32, n);
+        var queue_counts = [2]u32{ 0, 0 };
+        for (order, queue_pos) |a, *qp| {
+            const q = @intFromEnum(queues[a]);
+            qp.* = queue_counts[q];
+            queue_counts[q] += 1;
+            try plan.steps.append(self.allocator, .{ .pass_index = active.items[a], .queue = queues[a] });
+        }
 
-                barrier.image = image;
-                barrier.subresourceRange.aspectMask = new_access.aspect_mask;
-                barrier.subresourceRange.baseMipLevel = new_access.base_mip_level;
-                barrier.subresourceRange.levelCount = new_access.level_count;
-                barrier.subresourceRange.baseArrayLayer = new_access.base_array_layer;
-                barrier.subresourceRange.layerCount = new_access.layer_count;
-
-                var dependency = std.mem.zeroes(c.VkDependencyInfo);
-                dependency.sType = c.VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
-                dependency.dependencyFlags = 0;
-                dependency.imageMemoryBarrierCount = 1;
-                dependency.pImageMemoryBarriers = &barrier;
-
-                if (state.context.vkCmdPipelineBarrier2) |func| {
-                    rg_log.debug("Inserting Image Barrier: {any} -> {any} (Layout: {any} -> {any})", .{ old_state.stage_mask, new_access.stage_mask, old_state.layout, new_access.layout });
-                    func(cmd, &dependency);
+        try self.plan_barriers(scratch_alloc, order, accesses, queue_pos);
+        try plan_submits(plan, self.allocator);
+    }
+
+    /// Computes every transition in step order, plus resource lifetimes and split-barrier events.
+    fn plan_barriers(self: *RenderGraph, scratch_alloc: std.mem.Allocator, order: []const u32, accesses: []const []const MergedAccess, queue_pos: []const u32) !void {
+        const plan = &self.plan;
+        const Track = struct {
+            state: ResourceState,
+            queue: Queue,
+            step: u32,
+        };
+        const EventKey = struct {
+            producer: u32,
+            consumer: u32,
+        };
+        var tracks = std.AutoHashMapUnmanaged(ResourceId, Track){};
+        var event_keys = std.ArrayListUnmanaged(EventKey){};
+
+        for (plan.steps.items, order, 0..) |*step, a, pos_usize| {
+            const pos: u32 = @intCast(pos_usize);
+            step.before.start = @intCast(plan.barriers.items.len);
+
+            for (accesses[a]) |merged| {
+                const access = merged.access;
+                const dst = ResourceState{
+                    .layout = if (access.type == .Image) access.layout else c.VK_IMAGE_LAYOUT_UNDEFINED,
+                    .access_mask = access.access_mask,
+                    .stage_mask = access.stage_mask,
+                };
+
+                const gop = try tracks.getOrPut(scratch_alloc, access.id);
+                if (!gop.found_existing) {
+                    try plan.barriers.append(self.allocator, .{
+                        .access = access,
+                        .src = null,
+                        .src_queue = step.queue,
+                        .dst_queue = step.queue,
+                        .kind = .immediate,
+                        .consumer_step = pos,
+                    });
                 } else {
-                    rg_log.err("vkCmdPipelineBarrier2 function pointer is NULL!", .{});
-                }
-            },
-            .Buffer => |buffer| {
-                const queue_changed = (old_state.queue_family != c.VK_QUEUE_FAMILY_IGNORED and
-                    new_access.queue_family != c.VK_QUEUE_FAMILY_IGNORED and
-                    old_state.queue_family != new_access.queue_family);
-
-                if (!queue_changed and
-                    old_state.access_mask == new_access.access_mask and
-                    old_state.stage_mask == new_access.stage_mask)
-                {
-                    return;
+                    const prev = gop.value_ptr.*;
+                    if (prev.queue != step.queue or state_differs(access.type, prev.state, dst)) {
+                        var kind: BarrierKind = .immediate;
+                        var event: u32 = 0;
+                        if (prev.queue != step.queue) {
+                            kind = .queue_transfer;
+                        } else if (queue_pos[pos] - queue_pos[prev.step] >= 2) {
+                            kind = .split;
+                            const key = EventKey{ .producer = prev.step, .consumer = pos };
+                            event = for (event_keys.items, 0..) |k, e| {
+                                if (k.producer == key.producer and k.consumer == key.consumer) break @intCast(e);
+                            } else blk: {
+                                try event_keys.append(scratch_alloc, key);
+                                break :blk @intCast(event_keys.items.len - 1);
+                            };
+                        }
+                        try plan.barriers.append(self.allocator, .{
+                            .access = access,
+                            .src = prev.state,
+                            .src_queue = prev.queue,
+                            .dst_queue = step.queue,
+                            .kind = kind,
+                            .producer_step = prev.step,
+                            .consumer_step = pos,
+                            .event = event,
+                        });
+                    }
                 }
+                gop.value_ptr.* = .{ .state = dst, .queue = step.queue, .step = pos };
 
-                var barrier = std.mem.zeroes(c.VkBufferMemoryBarrier2);
-                barrier.sType = c.VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
-                barrier.srcStageMask = old_state.stage_mask;
-                barrier.srcAccessMask = old_state.access_mask;
-                barrier.dstStageMask = new_access.stage_mask;
-                barrier.dstAccessMask = new_access.access_mask;
-
-                if (queue_changed) {
-                    barrier.srcQueueFamilyIndex = old_state.queue_family;
-                    barrier.dstQueueFamilyIndex = new_access.queue_family;
+                if (self.resource_lifetimes.getPtr(access.id)) |life| {
+                    life.last_step = pos;
                 } else {
-                    barrier.srcQueueFamilyIndex = c.VK_QUEUE_FAMILY_IGNORED;
-                    barrier.dstQueueFamilyIndex = c.VK_QUEUE_FAMILY_IGNORED;
+                    try self.resource_lifetimes.put(self.allocator, access.id, .{ .first_step = pos, .last_step = pos });
                 }
+            }
 
-                barrier.buffer = buffer;
-                barrier.offset = 0;
-                barrier.size = c.VK_WHOLE_SIZE;
+            step.before.len = @as(u32, @intCast(plan.barriers.items.len)) - step.before.start;
+        }
+        plan.event_count = @intCast(event_keys.items.len);
 
-                var dependency = std.mem.zeroes(c.VkDependencyInfo);
-                dependency.sType = c.VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
-                dependency.dependencyFlags = 0;
-                dependency.bufferMemoryBarrierCount = 1;
-                dependency.pBufferMemoryBarriers = &barrier;
+        for (plan.steps.items, 0..) |*step, pos| {
+            step.after.start = @intCast(plan.after.items.len);
+            for (plan.barriers.items, 0..) |b, bi| {
+                if (b.kind != .immediate and b.producer_step == pos) try plan.after.append(self.allocator, @intCast(bi));
+            }
+            step.after.len = @as(u32, @intCast(plan.after.items.len)) - step.after.start;
+        }
+    }
 
-                if (state.context.vkCmdPipelineBarrier2) |func| {
-                    func(cmd, &dependency);
-                } else {
-                    rg_log.err("vkCmdPipelineBarrier2 function pointer is NULL!", .{});
-                }
-            },
+    /// True when some graphics-bound pass is neither an ancestor nor a descendant of active pass
+    /// `a`, so moving `a` to the compute queue lets the two overlap.
+    fn overlaps_graphics(self: *const RenderGraph, active: []const u32, descendants: []const std.DynamicBitSetUnmanaged, a: usize) bool {
+        for (active, 0..) |pass_index, b| {
+            if (b == a) continue;
+            const pass = &self.passes.items[pass_index];
+            const graphics_bound = pass.queue_affinity == .graphics or (pass.queue_affinity == .auto and !pass.is_compute_only());
+            if (!graphics_bound) continue;
+            if (!descendants[a].isSet(b) and !descendants[b].isSet(a)) return true;
         }
+        return false;
     }
 
     /// Allocates a transient resource the first time it is referenced.
@@ -695,14 +1274,143 @@ pub const RenderGraph = struct {
             },
         }
     }
-    /// Returns transient resources to pools after their last active pass.
-    fn release_resources_after_pass(self: *RenderGraph, pass_index: usize, state: *types.VulkanState) void {
+    /// Split-barrier events for the current frame in flight, created on first use. Returns an
+    /// empty slice if creation fails, in which case split barriers become ordinary barriers.
+    fn frame_events(self: *RenderGraph, state: *types.VulkanState) []const c.VkEvent {
+        const list = &self.events[state.sync.current_frame % types.MAX_FRAMES_IN_FLIGHT];
+        while (list.items.len < self.plan.event_count) {
+            var info = std.mem.zeroes(c.VkEventCreateInfo);
+            info.sType = c.VK_STRUCTURE_TYPE_EVENT_CREATE_INFO;
+            info.flags = c.VK_EVENT_CREATE_DEVICE_ONLY_BIT;
+            var event: c.VkEvent = null;
+            if (c.vkCreateEvent(state.context.device, &info, null, &event) != c.VK_SUCCESS) {
+                rg_log.warn("Failed to create split-barrier event; using pipeline barriers", .{});
+                return &.{};
+            }
+            list.append(self.allocator, event) catch {
+                c.vkDestroyEvent(state.context.device, event, null);
+                return &.{};
+            };
+        }
+        return list.items[0..self.plan.event_count];
+    }
+
+    fn handle_of(self: *const RenderGraph, id: ResourceId) ?ResourceHandle {
+        const res = self.resources.get(id) orelse return null;
+        return res.handle;
+    }
+
+    /// Every transition signalled through `event`. Built identically for the set and the wait,
+    /// as Vulkan requires matching dependency infos.
+    fn event_batch(self: *const RenderGraph, event: u32, allocator: std.mem.Allocator) BarrierBatch {
+        var batch = BarrierBatch{};
+        for (self.plan.barriers.items) |b| {
+            if (b.kind != .split or b.event != event) continue;
+            const handle = self.handle_of(b.access.id) orelse continue;
+            batch.add(allocator, handle, b.access, planned_transition(b.src.?, b.access)) catch {};
+        }
+        return batch;
+    }
+
+    /// Records one compiled step: event waits and the batched barrier, the pass callback, then
+    /// event signals and queue releases for later consumers.
+    fn record_step(self: *RenderGraph, ctx: *const ExecContext, cmd: c.VkCommandBuffer, pos: usize, allocator: std.mem.Allocator) void {
+        const plan = &self.plan;
+        const step = plan.steps.items[pos];
+        const pass = &self.passes.items[step.pass_index];
+
+        for (pass.inputs.items) |input| {
+            if (self.resources.getPtr(input.id)) |res| self.ensure_transient_allocated(res, ctx.state);
+        }
+        for (pass.outputs.items) |output| {
+            if (self.resources.getPtr(output.id)) |res| self.ensure_transient_allocated(res, ctx.state);
+        }
+
+        var batch = BarrierBatch{};
+        var waits = std.ArrayListUnmanaged(u32){};
+        for (step.before.slice(PlannedBarrier, plan.barriers.items)) |*b| {
+            const current = self.resource_states.get(b.access.id) orelse ResourceState{};
+            const dst_family = if (b.access.queue_family != c.VK_QUEUE_FAMILY_IGNORED) b.access.queue_family else ctx.family(b.dst_queue);
+
+            if (self.handle_of(b.access.id)) |handle| {
+                if (b.src) |src| {
+                    if (ctx.transfers_ownership(b)) {
+                        // Acquire half; the release was recorded after the producer and the
+                        // submission waited on the producer's timeline value.
+                        var t = planned_transition(src, b.access);
+                        t.src_stage = b.access.stage_mask;
+                        t.src_access = c.VK_ACCESS_2_NONE;
+                        t.src_family = ctx.family(b.src_queue);
+                        t.dst_family = dst_family;
+                        batch.add(allocator, handle, b.access, t) catch {};
+                    } else if (ctx.uses_event(b)) {
+                        if (std.mem.indexOfScalar(u32, waits.items, b.event) == null) waits.append(allocator, b.event) catch {};
+                    } else {
+                        batch.add(allocator, handle, b.access, planned_transition(src, b.access)) catch {};
+                    }
+                } else if (initial_transition(current, b.access, dst_family)) |t| {
+                    batch.add(allocator, handle, b.access, t) catch {};
+                }
+            }
+
+            var next = current;
+            next.access_mask = b.access.access_mask;
+            next.stage_mask = b.access.stage_mask;
+            next.queue_family = dst_family;
+            if (b.access.type == .Image) next.layout = b.access.layout;
+            self.resource_states.put(self.allocator, b.access.id, next) catch {};
+        }
+
+        if (waits.items.len > 0) wait: {
+            const events = allocator.alloc(c.VkEvent, waits.items.len) catch break :wait;
+            const infos = allocator.alloc(c.VkDependencyInfo, waits.items.len) catch break :wait;
+            var reset_stages: c.VkPipelineStageFlags2 = c.VK_PIPELINE_STAGE_2_NONE;
+            for (waits.items, events, infos) |e, *event, *info| {
+                const signalled = self.event_batch(e, allocator);
+                event.* = ctx.events[e];
+                info.* = signalled.dependency();
+                reset_stages |= signalled.dst_stage_mask();
+            }
+            c.vkCmdWaitEvents2(cmd, @intCast(events.len), events.ptr, infos.ptr);
+            for (events) |event| c.vkCmdResetEvent2(cmd, event, reset_stages);
+        }
+        batch.record(cmd, ctx.state);
+
+        pass.execute_fn(cmd, ctx.state);
+
+        var releases = BarrierBatch{};
+        var signals = std.ArrayListUnmanaged(u32){};
+        for (step.after.slice(u32, plan.after.items)) |bi| {
+            const b = &plan.barriers.items[bi];
+            if (ctx.uses_event(b)) {
+                if (std.mem.indexOfScalar(u32, signals.items, b.event) == null) signals.append(allocator, b.event) catch {};
+            } else if (ctx.transfers_ownership(b)) {
+                const handle = self.handle_of(b.access.id) orelse continue;
+                var t = planned_transition(b.src.?, b.access);
+                t.dst_stage = c.VK_PIPELINE_STAGE_2_NONE;
+                t.dst_access = c.VK_ACCESS_2_NONE;
+                t.src_family = ctx.family(b.src_queue);
+                t.dst_family = ctx.family(b.dst_queue);
+                releases.add(allocator, handle, b.access, t) catch {};
+            }
+        }
+        for (signals.items) |e| {
+            const signalled = self.event_batch(e, allocator);
+            if (signalled.is_empty()) continue;
+            const info = signalled.dependency();
+            c.vkCmdSetEvent2(cmd, ctx.events[e], &info);
+        }
+        releases.record(cmd, ctx.state);
+    }
+
+    /// Returns transient resources to pools after the last step that uses them.
+    fn release_resources_after_step(self: *RenderGraph, step_pos: usize, state: *types.VulkanState) void {
         var it = self.resources.iterator();
         while (it.next()) |entry| {
             var res = entry.value_ptr;
             if (res.lifecycle != .Transient or res.handle == null) continue;
             if (self.resource_lifetimes.get(res.id)) |life| {
-                if (life.last_pass == pass_index) {
+                if (life.last_step == step_pos) {
                     switch (res.handle.?) {
                         .Image => |image| {
                             if (res.desc) |d| {
@@ -759,116 +1467,323 @@ pub const RenderGraph = struct {
                         res_state.stage_mask = c.VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT;
                         res_state.queue_family = c.VK_QUEUE_FAMILY_IGNORED;
                     }
-                    rg_log.debug("RG aliasing: released transient resource {d} after pass {d}", .{ res.id, pass_index });
+                    rg_log.debug("RG aliasing: released transient resource {d} after step {d}", .{ res.id, step_pos });
                 }
             }
         }
     }
 
-    /// Executes all active passes and emits barriers before callbacks.
-    pub fn execute(self: *RenderGraph, graphics_cmd: c.VkCommandBuffer, compute_cmd: c.VkCommandBuffer, state: *types.VulkanState) void {
-        for (self.passes.items, 0..) |pass, pass_index| {
-            if (!pass.is_active) continue;
+    /// Records the compiled plan on one command buffer. Steps scheduled for the compute queue
+    /// run inline and queue transfers collapse into ordinary barriers.
+    pub fn execute(self: *RenderGraph, cmd: c.VkCommandBuffer, state: *types.VulkanState) void {
+        const scratch = memory.scratch_begin() orelse {
+            rg_log.err("No scratch memory for render graph execution", .{});
+            return;
+        };
+        defer scratch.end();
+
+        const family = state.context.graphics_queue_family;
+        const ctx = ExecContext{
+            .state = state,
+            .families = .{ family, family },
+            .single_queue = true,
+            .events = self.frame_events(state),
+        };
+        for (0..self.plan.steps.items.len) |pos| {
+            self.record_step(&ctx, cmd, pos, scratch.allocator());
+            self.release_resources_after_step(pos, state);
+        }
+    }
 
-            for (pass.inputs.items) |input| {
-                if (self.resources.getPtr(input.id)) |res_in| {
-                    ensure_transient_allocated(self, res_in, state);
-                }
-            }
-            for (pass.outputs.items) |output| {
-                if (self.resources.getPtr(output.id)) |res_out| {
-                    ensure_transient_allocated(self, res_out, state);
-                }
+    /// Records each submit batch of the compiled plan into its own command buffer and submits it
+    /// through `submitter`, waiting on the other queue's timeline where the plan requires it.
+    /// Returns false if a command buffer could not be obtained or submitted.
+    pub fn execute_async(self: *RenderGraph, submitter: QueueSubmitter, state: *types.VulkanState) bool {
+        const scratch = memory.scratch_begin() orelse {
+            rg_log.err("No scratch memory for render graph execution", .{});
+            return false;
+        };
+        defer scratch.end();
+
+        const ctx = ExecContext{
+            .state = state,
+            .families = .{ state.context.graphics_queue_family, state.context.compute_queue_family },
+            .single_queue = false,
+            .events = self.frame_events(state),
+        };
+        for (self.plan.submits.items) |batch| {
+            const cmd = submitter.begin(submitter.ctx, batch.queue) orelse return false;
+            for (batch.steps.slice(u32, self.plan.submit_steps.items)) |pos| {
+                self.record_step(&ctx, cmd, pos, scratch.allocator());
             }
+            const wait: ?TimelineWait = if (batch.wait_value != 0) .{
+                .queue = batch.queue.other(),
+                .value = batch.wait_value,
+                .stage_mask = batch.wait_stage_mask,
+            } else null;
+            if (!submitter.submit(submitter.ctx, batch.queue, cmd, wait, batch.signal_value)) return false;
+        }
 
-            const requested_queue_family: u32 = if (pass.queue_family != c.VK_QUEUE_FAMILY_IGNORED) pass.queue_family else c.VK_QUEUE_FAMILY_IGNORED;
+        // Pooled memory could be reused by a pass on the other queue while this one still runs,
+        // so transients are only recycled once the whole frame is recorded.
+        for (0..self.plan.steps.items.len) |pos| self.release_resources_after_step(pos, state);
+        return true;
+    }
 
-            const use_compute = (compute_cmd != null and
-                requested_queue_family != c.VK_QUEUE_FAMILY_IGNORED and
-                requested_queue_family == state.context.compute_queue_family);
+    /// True when every planned step that reads or writes `id` is recorded in submit batch `batch`.
+    pub fn resource_confined_to_submit(self: *const RenderGraph, id: ResourceId, batch: u32) bool {
+        for (self.plan.steps.items) |step| {
+            if (step.submit == batch) continue;
+            const pass = &self.passes.items[step.pass_index];
+            for (pass.inputs.items) |a| {
+                if (a.id == id) return false;
+            }
+            for (pass.outputs.items) |a| {
+                if (a.id == id) return false;
+            }
+        }
+        return true;
+    }
 
-            const cmd = if (use_compute) compute_cmd else graphics_cmd;
-            const cmd_queue_family: u32 = if (use_compute) state.context.compute_queue_family else state.context.graphics_queue_family;
+    /// Writes a text listing of the compiled plan: steps with their barriers, event signals and
+    /// queue releases, dependency edges, and submit batches.
+    pub fn dump(self: *const RenderGraph, writer: anytype) !void {
+        const plan = &self.plan;
+        try writer.print("render graph: {d} steps, {d} barriers, {d} events, {d} submits\n", .{
+            plan.steps.items.len,
+            plan.barriers.items.len,
+            plan.event_count,
+            plan.submits.items.len,
+        });
 
-            for (pass.inputs.items) |input| {
-                if (self.resources.get(input.id)) |res| {
-                    if (res.handle) |handle| {
-                        if (self.resource_states.get(input.id)) |current_state| {
-                            var eff_input = input;
-                            if (eff_input.queue_family == c.VK_QUEUE_FAMILY_IGNORED) {
-                                eff_input.queue_family = cmd_queue_family;
-                            }
-                            insert_barrier(cmd, handle, current_state, eff_input, state);
-
-                            var new_state = current_state;
-                            new_state.access_mask = eff_input.access_mask;
-                            new_state.stage_mask = eff_input.stage_mask;
-                            new_state.queue_family = eff_input.queue_family;
-                            if (eff_input.type == .Image) {
-                                new_state.layout = eff_input.layout;
-                            }
-                            self.resource_states.put(self.allocator, eff_input.id, new_state) catch {};
-                        }
-                    }
+        for (plan.steps.items, 0..) |step, pos| {
+            try writer.print("step {d} [{s}] {s} (pass {d})\n", .{ pos, @tagName(step.queue), self.passes.items[step.pass_index].name, step.pass_index });
+            for (step.before.slice(PlannedBarrier, plan.barriers.items)) |b| {
+                try writer.print("  {s} {d}", .{ @tagName(b.kind), b.access.id });
+                if (b.src) |src| {
+                    try writer.print(" from step {d} stage 0x{x} access 0x{x} layout {d}", .{ b.producer_step, src.stage_mask, src.access_mask, src.layout });
+                } else {
+                    try writer.writeAll(" from frame state");
+                }
+                try writer.print(" -> stage 0x{x} access 0x{x} layout {d}", .{ b.access.stage_mask, b.access.access_mask, b.access.layout });
+                switch (b.kind) {
+                    .immediate => {},
+                    .split => try writer.print(" event {d}", .{b.event}),
+                    .queue_transfer => try writer.print(" {s}->{s}", .{ @tagName(b.src_queue), @tagName(b.dst_queue) }),
                 }
+                try writer.writeByte('\n');
             }
-
-            for (pass.outputs.items) |output| {
-                if (self.resources.get(output.id)) |res| {
-                    if (res.handle) |handle| {
-                        if (self.resource_states.get(output.id)) |current_state| {
-                            var eff_output = output;
-                            if (eff_output.queue_family == c.VK_QUEUE_FAMILY_IGNORED) {
-                                eff_output.queue_family = cmd_queue_family;
-                            }
-
-                            const queue_changed = (current_state.queue_family != c.VK_QUEUE_FAMILY_IGNORED and
-                                eff_output.queue_family != c.VK_QUEUE_FAMILY_IGNORED and
-                                current_state.queue_family != eff_output.queue_family);
-
-                            const redundant = switch (eff_output.type) {
-                                .Image => (!queue_changed and
-                                    current_state.layout == eff_output.layout and
-                                    current_state.access_mask == eff_output.access_mask and
-                                    current_state.stage_mask == eff_output.stage_mask and
-                                    current_state.layout != c.VK_IMAGE_LAYOUT_UNDEFINED),
-                                .Buffer => (!queue_changed and
-                                    current_state.access_mask == eff_output.access_mask and
-                                    current_state.stage_mask == eff_output.stage_mask),
-                            };
-
-                            if (!redundant) {
-                                insert_barrier(cmd, handle, current_state, eff_output, state);
-                            }
-
-                            var new_state = current_state;
-                            new_state.access_mask = eff_output.access_mask;
-                            new_state.stage_mask = eff_output.stage_mask;
-                            new_state.queue_family = eff_output.queue_family;
-                            if (eff_output.type == .Image) {
-                                new_state.layout = eff_output.layout;
-                            }
-
-                            const state_changed = switch (eff_output.type) {
-                                .Image => (new_state.queue_family != current_state.queue_family or
-                                    new_state.stage_mask != current_state.stage_mask or
-                                    new_state.access_mask != current_state.access_mask or
-                                    new_state.layout != current_state.layout),
-                                .Buffer => (new_state.queue_family != current_state.queue_family or
-                                    new_state.stage_mask != current_state.stage_mask or
-                                    new_state.access_mask != current_state.access_mask),
-                            };
-                            if (state_changed) {
-                                self.resource_states.put(self.allocator, eff_output.id, new_state) catch {};
-                            }
-                        }
-                    }
+            for (step.after.slice(u32, plan.after.items)) |bi| {
+                const b = plan.barriers.items[bi];
+                switch (b.kind) {
+                    .immediate => {},
+                    .split => try writer.print("  signal event {d} for step {d}\n", .{ b.event, b.consumer_step }),
+                    .queue_transfer => try writer.print("  release {d} to {s} for step {d}\n", .{ b.access.id, @tagName(b.dst_queue), b.consumer_step }),
                 }
             }
+        }
 
-            pass.execute_fn(cmd, state);
+        for (plan.edges.items) |edge| {
+            try writer.print("edge {s} -> {s}\n", .{ self.passes.items[edge.from].name, self.passes.items[edge.to].name });
+        }
 
-            release_resources_after_pass(self, pass_index, state);
+        for (plan.submits.items, 0..) |batch, bi| {
+            try writer.print("submit {d} {s} steps [", .{ bi, @tagName(batch.queue) });
+            for (batch.steps.slice(u32, plan.submit_steps.items), 0..) |pos, i| {
+                if (i != 0) try writer.writeByte(' ');
+                try writer.print("{d}", .{pos});
+            }
+            try writer.writeByte(']');
+            if (batch.wait_value != 0) {
+                try writer.print(" wait {s}>={d} stage 0x{x}", .{ @tagName(batch.queue.other()), batch.wait_value, batch.wait_stage_mask });
+            }
+            try writer.print(" signal {d}\n", .{batch.signal_value});
         }
     }
 };
+
+fn test_noop_pass(cmd: c.VkCommandBuffer, state: *types.VulkanState) void {
+    _ = cmd;
+    _ = state;
+}
+
+fn test_image(id: ResourceId, stage: c.VkPipelineStageFlags2, access: c.VkAccessFlags2, layout: c.VkImageLayout) ResourceAccess {
+    return .{ .id = id, .type = .Image, .stage_mask = stage, .access_mask = access, .layout = layout };
+}
+
+fn test_buffer(id: ResourceId, stage: c.VkPipelineStageFlags2, access: c.VkAccessFlags2) ResourceAccess {
+    return .{ .id = id, .type = .Buffer, .stage_mask = stage, .access_mask = access };
+}
+
+fn test_pass(allocator: std.mem.Allocator, name: []const u8, inputs: []const ResourceAccess, outputs: []const ResourceAccess) !RenderPass {
+    var pass = RenderPass.init(allocator, name, test_noop_pass);
+    errdefer pass.deinit(allocator);
+    for (inputs) |access| try pass.add_input(allocator, access);
+    for (outputs) |access| try pass.add_output(allocator, access);
+    return pass;
+}
+
+test "render graph batches transitions and splits distant ones" {
+    memory.cardinal_memory_init(1024 * 1024);
+    defer memory.cardinal_memory_shutdown();
+    const allocator = std.testing.allocator;
+
+    const FRAG = c.VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+    const COLOR = c.VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+    const CS = c.VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    const SHADER_READ = c.VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    const ATTACHMENT = c.VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    var graph = RenderGraph.init(allocator);
+    defer graph.deinit();
+
+    try graph.add_pass(try test_pass(allocator, "A", &.{}, &.{
+        test_image(1, COLOR, c.VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, ATTACHMENT),
+        test_buffer(3, CS, c.VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT),
+    }));
+    try graph.add_pass(try test_pass(allocator, "B", &.{}, &.{
+        test_image(2, COLOR, c.VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, ATTACHMENT),
+    }));
+    var consumer = try test_pass(allocator, "C", &.{
+        test_image(1, FRAG, c.VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, SHADER_READ),
+        test_image(2, FRAG, c.VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, SHADER_READ),
+        test_buffer(3, FRAG, c.VK_ACCESS_2_SHADER_STORAGE_READ_BIT),
+    }, &.{});
+    consumer.can_be_culled = false;
+    try graph.add_pass(consumer);
+
+    try graph.compile();
+    const plan = &graph.plan;
+
+    try std.testing.expectEqual(@as(usize, 3), plan.steps.items.len);
+    try std.testing.expectEqual(@as(u32, 1), plan.event_count);
+    try std.testing.expectEqual(@as(u32, 3), plan.pipeline_barrier_count());
+    try std.testing.expectEqual(@as(usize, 1), plan.submits.items.len);
+
+    // C: one immediate transition for B's image, one event covering A's image and buffer.
+    const c_step = plan.steps.items[2];
+    var split: u32 = 0;
+    var immediate: u32 = 0;
+    for (c_step.before.slice(PlannedBarrier, plan.barriers.items)) |b| {
+        switch (b.kind) {
+            .split => {
+                split += 1;
+                try std.testing.expectEqual(@as(u32, 0), b.producer_step);
+            },
+            .immediate => {
+                immediate += 1;
+                try std.testing.expectEqual(@as(ResourceId, 2), b.access.id);
+            },
+            .queue_transfer => return error.TestUnexpectedResult,
+        }
+    }
+    try std.testing.expectEqual(@as(u32, 2), split);
+    try std.testing.expectEqual(@as(u32, 1), immediate);
+    try std.testing.expectEqual(@as(u32, 2), plan.steps.items[0].after.len);
+
+    try std.testing.expectEqual(@as(usize, 2), plan.edges.items.len);
+    try std.testing.expectEqual(@as(usize, 2), graph.resource_lifetimes.get(1).?.last_step);
+}
+
+test "render graph schedules independent compute on the async queue" {
+    memory.cardinal_memory_init(1024 * 1024);
+    defer memory.cardinal_memory_shutdown();
+    const allocator = std.testing.allocator;
+
+    const CS = c.VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    const FRAG = c.VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+    const DEPTH = c.VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | c.VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+    const COLOR = c.VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+    const READ = c.VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+    const SHADER_READ = c.VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    const DEPTH_WRITE = c.VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    const DEPTH_READ = c.VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+    const GENERAL = c.VK_IMAGE_LAYOUT_GENERAL;
+    const ATTACHMENT = c.VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    var graph = RenderGraph.init(allocator);
+    defer graph.deinit();
+    graph.async_compute = true;
+
+    try graph.add_pass(try test_pass(allocator, "Depth", &.{}, &.{
+        test_image(1, DEPTH, c.VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, DEPTH_WRITE),
+    }));
+    try graph.add_pass(try test_pass(allocator, "SSAO", &.{
+        test_image(1, CS, READ, DEPTH_READ),
+    }, &.{
+        test_image(2, CS, c.VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, GENERAL),
+    }));
+    try graph.add_pass(try test_pass(allocator, "Shadow", &.{}, &.{
+        test_image(3, DEPTH, c.VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, DEPTH_WRITE),
+    }));
+    try graph.add_pass(try test_pass(allocator, "PBR", &.{
+        test_image(1, DEPTH, c.VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT, DEPTH_READ),
+        test_image(2, FRAG, READ, SHADER_READ),
+        test_image(3, FRAG, READ, SHADER_READ),
+    }, &.{
+        test_image(4, COLOR, c.VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, ATTACHMENT),
+    }));
+    try graph.add_pass(try test_pass(allocator, "Bloom", &.{
+        test_image(4, CS, READ, SHADER_READ),
+    }, &.{
+        test_image(5, CS, c.VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, GENERAL),
+    }));
+    var composite = try test_pass(allocator, "Composite", &.{
+        test_image(4, FRAG, READ, SHADER_READ),
+        test_image(5, FRAG, READ, SHADER_READ),
+    }, &.{});
+    composite.can_be_culled = false;
+    try graph.add_pass(composite);
+
+    try graph.compile();
+    const plan = &graph.plan;
+
+    // SSAO overlaps Shadow and moves to the compute queue; Bloom sits between graphics passes
+    // it depends on and feeds, so it stays on graphics.
+    const expected_order = [_]u32{ 0, 1, 2, 3, 4, 5 };
+    try std.testing.expectEqual(expected_order.len, plan.steps.items.len);
+    for (plan.steps.items, expected_order) |step, pass_index| {
+        try std.testing.expectEqual(pass_index, step.pass_index);
+        try std.testing.expectEqual(if (pass_index == 1) Queue.compute else Queue.graphics, step.queue);
+    }
+    try std.testing.expectEqual(@as(u32, 1), plan.async_step_count());
+
+    var transfers: u32 = 0;
+    for (plan.barriers.items) |b| {
+        if (b.kind == .queue_transfer) transfers += 1;
+    }
+    // Depth to SSAO, then depth and the SSAO result back to PBR.
+    try std.testing.expectEqual(@as(u32, 3), transfers);
+
+    const Expected = struct { queue: Queue, steps: []const u32, wait: u64, signal: u64 };
+    const expected_submits = [_]Expected{
+        .{ .queue = .graphics, .steps = &.{0}, .wait = 0, .signal = 1 },
+        .{ .queue = .compute, .steps = &.{1}, .wait = 1, .signal = 1 },
+        .{ .queue = .graphics, .steps = &.{2}, .wait = 0, .signal = 2 },
+        .{ .queue = .graphics, .steps = &.{ 3, 4, 5 }, .wait = 1, .signal = 3 },
+    };
+    try std.testing.expectEqual(expected_submits.len, plan.submits.items.len);
+    for (plan.submits.items, expected_submits) |batch, expected| {
+        try std.testing.expectEqual(expected.queue, batch.queue);
+        try std.testing.expectEqualSlices(u32, expected.steps, batch.steps.slice(u32, plan.submit_steps.items));
+        try std.testing.expectEqual(expected.wait, batch.wait_value);
+        try std.testing.expectEqual(expected.signal, batch.signal_value);
+    }
+    try std.testing.expect(graph.resource_confined_to_submit(4, 3));
+    try std.testing.expect(!graph.resource_confined_to_submit(1, 3));
+
+    var buf: [8192]u8 = undefined;
+    var stream = std.io.fixedBufferStream(&buf);
+    try graph.dump(stream.writer());
+    const text = stream.getWritten();
+    try std.testing.expect(std.mem.indexOf(u8, text, "step 1 [compute] SSAO (pass 1)") != null);
+    try std.testing.expect(std.mem.indexOf(u8, text, "release 1 to compute for step 1") != null);
+    try std.testing.expect(std.mem.indexOf(u8, text, "edge Depth -> SSAO") != null);
+    try std.testing.expect(std.mem.indexOf(u8, text, "submit 3 graphics steps [3 4 5] wait compute>=1") != null);
+
+    // Without async compute the same graph runs in declaration order on one queue.
+    graph.async_compute = false;
+    try graph.compile();
+    try std.testing.expectEqual(@as(u32, 0), graph.plan.async_step_count());
+    try std.testing.expectEqual(@as(usize, 1), graph.plan.submits.items.len);
+}
@@ -0,0 +1,243 @@
+//! Per-cascade shadow caster culling and cascade caching.
+//!
+//! A caster can only shadow a cascade if its bounds overlap the cascade's light-space rectangle
+//! and it is not entirely behind (further from the light than) everything the cascade receives.
+//! Toward the light the volume is extruded to the shadow pass's depth range, so casters far
+//! outside the view frustum still cast into it. `caster_volume` builds that box as a matrix, and
+//! `CasterCuller.update` culls every caster against it for each cascade with
+//! `visibility_culling.Culler`, producing per-cascade draw lists with opaque casters first.
+//!
+//! Cacheable cascades are only redrawn when their light-space matrix changes (the cascade
+//! matrices are texel-snapped, so a moving camera changes them in discrete steps) or the
+//! signature of the casters inside them changes. Cascades with dynamic casters (skinned or morphed
+//! meshes, whose shape changes without their state changing) are redrawn every frame.
+const std = @import("std");
+const math = @import("../core/math.zig");
+const visibility_culling = @import("visibility_culling.zig");
+
+/// Cascades a `CasterCuller` tracks; matches `MAX_SHADOW_CASCADES`.
+pub const MAX_CASCADES = 4;
+
+/// Culling matrix for a cascade: the light-view rectangle [`min_x`, `max_x`] x [`min_y`, `max_y`],
+/// from light-view z `light_z` (toward the light) down to `receiver_far_z`, the far end of
+/// everything the cascade receives. Arguments are light-view coordinates, as for the cascade's
+/// own `Mat4.ortho`.
+pub fn caster_volume(light_view: math.Mat4, min_x: f32, max_x: f32, min_y: f32, max_y: f32, light_z: f32, receiver_far_z: f32) math.Mat4 {
+    return math.Mat4.ortho(min_x, max_x, min_y, max_y, light_z, receiver_far_z).mul(light_view);
+}
+
+/// A mesh that may cast shadows.
+pub const Caster = struct {
+    bounds: math.AABB,
+    /// Drawn with the alpha-tested shadow pipeline, after the opaque casters.
+    alpha_tested: bool = false,
+    /// Shape changes every frame (skinning, morph targets); cascades containing it are not cached.
+    dynamic: bool = false,
+    /// Hash of everything that affects the caster's shadow (transform, material, geometry range).
+    state_hash: u64 = 0,
+};
+
+pub const Cascade = struct {
+    /// Light-space matrix the cascade is rendered with; part of the cache key.
+    light_space: math.Mat4,
+    /// From `caster_volume`.
+    volume: math.Mat4,
+    /// May be kept from an earlier frame.
+    cacheable: bool = false,
+};
+
+pub const CascadeDraws = struct {
+    /// Indices into the caster slice; opaque casters, then alpha-tested ones from `alpha_start`.
+    casters: []const u32 = &[_]u32{},
+    alpha_start: usize = 0,
+    /// False when the cascade's previous contents are still valid and must not be redrawn.
+    render: bool = true,
+};
+
+pub const Options = struct {
+    /// Split culling across the job system for large scenes.
+    use_jobs: bool = true,
+};
+
+pub const Stats = struct {
+    casters: usize = 0,
+    /// Caster draws across all cascades that are rendered this frame.
+    drawn: usize = 0,
+    /// Caster draws that skipping every caster in every cascade would have needed.
+    unculled: usize = 0,
+    cached_cascades: u32 = 0,
+};
+
+const CacheEntry = struct {
+    valid: bool = false,
+    light_space: [16]f32 = undefined,
+    signature: u64 = 0,
+};
+
+/// Reusable per-frame caster culling state with the cascade cache.
+pub const CasterCuller = struct {
+    set: visibility_culling.CullSet = .{},
+    culler: visibility_culling.Culler = .{},
+    lists: [MAX_CASCADES]std.ArrayListUnmanaged(u32) = [_]std.ArrayListUnmanaged(u32){.{}} ** MAX_CASCADES,
+    draws: [MAX_CASCADES]CascadeDraws = [_]CascadeDraws{.{}} ** MAX_CASCADES,
+    cache: [MAX_CASCADES]CacheEntry = [_]CacheEntry{.{}} ** MAX_CASCADES,
+    stats: Stats = .{},
+
+    pub fn deinit(self: *CasterCuller, allocator: std.mem.Allocator) void {
+        self.set.deinit(allocator);
+        self.culler.deinit(allocator);
+        for (&self.lists) |*list| list.deinit(allocator);
+        self.* = .{};
+    }
+
+    /// Forgets every cached cascade, e.g. when the shadow map was recreated or a cascade was
+    /// left partially drawn.
+    pub fn invalidate(self: *CasterCuller) void {
+        for (&self.cache) |*entry| entry.valid = false;
+    }
+
+    pub fn invalidate_cascade(self: *CasterCuller, cascade: usize) void {
+        if (cascade < MAX_CASCADES) self.cache[cascade].valid = false;
+    }
+
+    /// True when some cascade holds contents from an earlier frame that a later frame may reuse.
+    pub fn has_cached(self: *const CasterCuller) bool {
+        for (self.cache) |entry| {
+            if (entry.valid) return true;
+        }
+        return false;
+    }
+
+    /// Culls `casters` for each cascade and decides which cascades must be redrawn. `salt` is mixed
+    /// into every signature; change it to invalidate all cascades (e.g. new geometry buffers).
+    /// A cascade reported with `render = true` is assumed drawn; call `invalidate_cascade` if it
+    /// was not. The result stays valid until the next call.
+    pub fn update(self: *CasterCuller, allocator: std.mem.Allocator, casters: []const Caster, cascades: []const Cascade, salt: u64, options: Options) ![]const CascadeDraws {
+        std.debug.assert(cascades.len <= MAX_CASCADES);
+        self.stats = .{ .casters = casters.len };
+
+        self.set.clear();
+        try self.set.ensure_capacity(allocator, casters.len);
+        for (casters, 0..) |caster, i| {
+            _ = try self.set.append(allocator, caster.bounds, visibility_culling.sort_key(@intFromBool(caster.alpha_tested), @intCast(i)));
+        }
+
+        for (cascades, 0..) |cascade, j| {
+            const visible = try self.culler.cull(allocator, &self.set, cascade.volume, .{ .use_jobs = options.use_jobs });
+            const list = &self.lists[j];
+            list.clearRetainingCapacity();
+            try list.ensureTotalCapacity(allocator, visible.len);
+
+            var hasher = std.hash.Wyhash.init(salt);
+            var dynamic = false;
+            var alpha_start: usize = visible.len;
+            for (visible, 0..) |draw, k| {
+                const caster = casters[draw.index];
+                if (caster.alpha_tested and alpha_start == visible.len) alpha_start = k;
+                dynamic = dynamic or caster.dynamic;
+                hasher.update(std.mem.asBytes(&draw.index));
+                hasher.update(std.mem.asBytes(&caster.state_hash));
+                list.appendAssumeCapacity(draw.index);
+            }
+            const signature = hasher.final();
+
+            const entry = &self.cache[j];
+            var render = true;
+            if (!cascade.cacheable or dynamic) {
+                entry.valid = false;
+            } else if (entry.valid and entry.signature == signature and std.mem.eql(f32, &entry.light_space, &cascade.light_space.data)) {
+                render = false;
+            } else {
+                entry.* = .{ .valid = true, .light_space = cascade.light_space.data, .signature = signature };
+            }
+
+            self.draws[j] = .{ .casters = list.items, .alpha_start = alpha_start, .render = render };
+            self.stats.unculled += casters.len;
+            if (render) {
+                self.stats.drawn += visible.len;
+            } else {
+                self.stats.cached_cascades += 1;
+            }
+        }
+        for (cascades.len..MAX_CASCADES) |j| self.cache[j].valid = false;
+        return self.draws[0..cascades.len];
+    }
+};
+
+fn box(min: [3]f32, max: [3]f32) math.AABB {
+    return .{ .min = math.Vec3.fromArray(min), .max = math.Vec3.fromArray(max) };
+}
+
+/// Light looking down -z from the origin: world and light-view space coincide.
+fn test_cascade(cacheable: bool) Cascade {
+    const light_view = math.Mat4.identity();
+    return .{
+        .light_space = math.Mat4.ortho(-10.0, 10.0, -10.0, 10.0, 1000.0, -1000.0),
+        .volume = caster_volume(light_view, -10.0, 10.0, -10.0, 10.0, 1000.0, -50.0),
+        .cacheable = cacheable,
+    };
+}
+
+test "casters are culled against the cascade rectangle and receiver depth, extruded toward the light" {
+    const allocator = std.testing.allocator;
+    const casters = [_]Caster{
+        .{ .bounds = box(.{ -1, -1, -20 }, .{ 1, 1, -18 }) }, // inside
+        .{ .bounds = box(.{ -1, -1, -80 }, .{ 1, 1, -60 }) }, // behind every receiver
+        .{ .bounds = box(.{ 12, -1, -20 }, .{ 14, 1, -18 }) }, // beside the rectangle
+        .{ .bounds = box(.{ -1, -1, 400 }, .{ 1, 1, 410 }) }, // far toward the light
+        .{ .bounds = box(.{ 9, 9, -55 }, .{ 11, 11, -45 }) }, // straddles the corner and far end
+        .{ .bounds = box(.{ -3, -3, -10 }, .{ 3, 3, -5 }), .alpha_tested = true },
+    };
+
+    var culler = CasterCuller{};
+    defer culler.deinit(allocator);
+    const draws = try culler.update(allocator, &casters, &.{test_cascade(false)}, 0, .{ .use_jobs = false });
+    try std.testing.expectEqual(@as(usize, 1), draws.len);
+    try std.testing.expectEqualSlices(u32, &.{ 0, 3, 4, 5 }, draws[0].casters);
+    try std.testing.expectEqual(@as(usize, 3), draws[0].alpha_start);
+    try std.testing.expect(draws[0].render);
+    try std.testing.expectEqual(@as(usize, 4), culler.stats.drawn);
+    try std.testing.expectEqual(@as(usize, 6), culler.stats.unculled);
+}
+
+test "cached cascades are redrawn only when their matrix or casters change" {
+    const allocator = std.testing.allocator;
+    var casters = [_]Caster{
+        .{ .bounds = box(.{ -1, -1, -20 }, .{ 1, 1, -18 }), .state_hash = 1 },
+        .{ .bounds = box(.{ 30, 30, -20 }, .{ 31, 31, -18 }), .state_hash = 2 },
+    };
+
+    var culler = CasterCuller{};
+    defer culler.deinit(allocator);
+    const cached = test_cascade(true);
+
+    try std.testing.expect((try culler.update(allocator, &casters, &.{cached}, 0, .{}))[0].render);
+    try std.testing.expect(!(try culler.update(allocator, &casters, &.{cached}, 0, .{}))[0].render);
+    try std.testing.expect(culler.has_cached());
+    try std.testing.expectEqual(@as(u32, 1), culler.stats.cached_cascades);
+
+    // A caster outside the cascade changing does not matter; one inside does.
+    casters[1].state_hash = 3;
+    try std.testing.expect(!(try culler.update(allocator, &casters, &.{cached}, 0, .{}))[0].render);
+    casters[0].state_hash = 4;
+    try std.testing.expect((try culler.update(allocator, &casters, &.{cached}, 0, .{}))[0].render);
+    try std.testing.expect(!(try culler.update(allocator, &casters, &.{cached}, 0, .{}))[0].render);
+
+    // The camera crossed a snapping step.
+    var moved = cached;
+    moved.light_space.data[12] += 0.25;
+    try std.testing.expect((try culler.update(allocator, &casters, &.{moved}, 0, .{}))[0].render);
+    try std.testing.expect(!(try culler.update(allocator, &casters, &.{moved}, 0, .{}))[0].render);
+
+    // New geometry, explicit invalidation, dynamic casters and uncached cascades all redraw.
+    try std.testing.expect((try culler.update(allocator, &casters, &.{moved}, 1, .{}))[0].render);
+    culler.invalidate();
+    try std.testing.expect(!culler.has_cached());
+    try std.testing.expect((try culler.update(allocator, &casters, &.{moved}, 1, .{}))[0].render);
+    casters[0].dynamic = true;
+    try std.testing.expect((try culler.update(allocator, &casters, &.{moved}, 1, .{}))[0].render);
+    try std.testing.expect((try culler.update(allocator, &casters, &.{moved}, 1, .{}))[0].render);
+    casters[0].dynamic = false;
+    try std.testing.expect((try culler.update(allocator, &casters, &.{test_cascade(false)}, 1, .{}))[0].render);
+    try std.testing.expect((try culler.update(allocator, &casters, &.{test_cascade(false)}, 1, .{}))[0].render);
+}
@@ -0,0 +1,687 @@
+//! Persistent cache of shader reflection results and parsed pipeline descriptors.
+//!
+//! Entries are keyed by a hash of the SPIR-V words or the JSON text, so editing a shader or a
+//! descriptor simply misses and re-populates its entry. Reflection is cached without the stage it
+//! was requested for (the stage only tags the result), so every stage using a module shares one
+//! entry. The cache lives in memory behind a mutex and is persisted as a single file next to the
+//! Vulkan pipeline cache; its header carries a format version and a fingerprint of the cached
+//! types, so a build that changes them ignores old files instead of misreading them.
+const std = @import("std");
+const c = @import("../vulkan_c.zig").c;
+const log = @import("../../core/log.zig");
+const memory = @import("../../core/memory.zig");
+const job_system = @import("../../core/job_system.zig");
+const vfs = @import("../../core/vfs.zig");
+const file_io = @import("../../assets/file_io.zig");
+const reflection = @import("vulkan_shader_reflection.zig");
+const vk_pso = @import("../vulkan_pso.zig");
+
+const cache_log = log.ScopedLogger("REFLECT_CACHE");
+
+/// Default cache file, written next to `pipeline_cache.bin`.
+pub const CACHE_FILE_NAME = "reflection_cache.bin";
+
+/// Cache file header magic ("CRFL").
+const CACHE_FILE_MAGIC: u32 = 0x4352464C;
+/// Bumped when the entry encoding changes; type changes are caught by `SCHEMA_FINGERPRINT`.
+const CACHE_FILE_VERSION: u32 = 1;
+
+/// Largest pipeline descriptor `PipelineBuilder.load_from_json` accepts.
+const MAX_DESCRIPTOR_BYTES = 1024 * 1024;
+
+const CacheFileHeader = extern struct {
+    magic: u32,
+    version: u32,
+    schema: u64,
+    entry_count: u32,
+    reserved: u32 = 0,
+    data_size: u64,
+    checksum: u64,
+};
+
+const Kind = enum(u8) { reflection, pipeline_descriptor };
+
+/// Stage-independent part of a `ShaderReflection`.
+const CachedReflection = struct {
+    resources: []const CachedResource,
+    push_constant_size: u32,
+    has_push_constants: bool,
+    constants: []const CachedConstant,
+};
+
+const CachedResource = struct {
+    set: u32,
+    binding: u32,
+    type: c.VkDescriptorType,
+    count: u32,
+    is_runtime_array: bool,
+};
+
+const CachedConstant = struct {
+    id: u32,
+    value: u32,
+};
+
+/// Hash of the shape of every cached type: adding, renaming or retyping a field in
+/// `PipelineDescriptor` (or anything it contains) invalidates existing cache files.
+const SCHEMA_FINGERPRINT: u64 = blk: {
+    @setEvalBranchQuota(200_000);
+    break :blk std.hash.Wyhash.hash(CACHE_FILE_VERSION, type_signature(CachedReflection) ++ type_signature(vk_pso.PipelineDescriptor));
+};
+
+fn type_signature(comptime T: type) []const u8 {
+    return switch (@typeInfo(T)) {
+        .optional => |info| "?" ++ type_signature(info.child),
+        .pointer => |info| "[]" ++ type_signature(info.child),
+        .array => |info| std.fmt.comptimePrint("[{d}]", .{info.len}) ++ type_signature(info.child),
+        .@"struct" => |info| blk: {
+            var sig: []const u8 = "{";
+            for (info.fields) |field| sig = sig ++ field.name ++ ":" ++ type_signature(field.type) ++ ",";
+            break :blk sig ++ "}";
+        },
+        .@"enum" => |info| blk: {
+            var sig: []const u8 = "enum{";
+            for (info.fields) |field| sig = sig ++ field.name ++ ",";
+            break :blk sig ++ "}";
+        },
+        else => @typeName(T),
+    };
+}
+
+/// Hit/miss counters since the cache was last cleared.
+pub const Stats = struct {
+    entries: usize = 0,
+    hits: u64 = 0,
+    misses: u64 = 0,
+};
+
+var g_entries: std.AutoHashMapUnmanaged(u64, []u8) = .{};
+var g_mutex: std.Thread.Mutex = .{};
+var g_dirty: bool = false;
+var g_hits: u64 = 0;
+var g_misses: u64 = 0;
+
+fn cache_allocator() std.mem.Allocator {
+    return memory.cardinal_get_allocator_for_category(.SHADERS).as_allocator();
+}
+
+// ---------------------------------------------------------------------------------------------
+// Encoding
+// ---------------------------------------------------------------------------------------------
+
+const Writer = struct {
+    allocator: std.mem.Allocator,
+    bytes: std.ArrayListUnmanaged(u8) = .{},
+
+    fn deinit(self: *Writer) void {
+        self.bytes.deinit(self.allocator);
+    }
+
+    fn raw(self: *Writer, data: []const u8) !void {
+        try self.bytes.appendSlice(self.allocator, data);
+    }
+
+    fn int(self: *Writer, comptime T: type, v: T) !void {
+        var buf: [@sizeOf(T)]u8 = undefined;
+        std.mem.writeInt(T, &buf, v, .little);
+        try self.raw(&buf);
+    }
+
+    /// Writes `value` field by field; slices are length-prefixed, optionals carry a tag byte.
+    fn value(self: *Writer, comptime T: type, v: T) !void {
+        switch (@typeInfo(T)) {
+            .bool => try self.int(u8, @intFromBool(v)),
+            .int => try self.int(T, v),
+            .float => |info| try self.int(std.meta.Int(.unsigned, info.bits), @bitCast(v)),
+            .@"enum" => try self.int(u32, @intFromEnum(v)),
+            .optional => |info| {
+                if (v) |inner| {
+                    try self.int(u8, 1);
+                    try self.value(info.child, inner);
+                } else {
+                    try self.int(u8, 0);
+                }
+            },
+            .pointer => |info| {
+                comptime std.debug.assert(info.size == .slice);
+                try self.int(u32, @intCast(v.len));
+                if (info.child == u8) {
+                    try self.raw(v);
+                } else {
+                    for (v) |item| try self.value(info.child, item);
+                }
+            },
+            .array => |info| {
+                for (v) |item| try self.value(info.child, item);
+            },
+            .@"struct" => |info| {
+                inline for (info.fields) |field| try self.value(field.type, @field(v, field.name));
+            },
+            else => @compileError("reflection cache cannot encode " ++ @typeName(T)),
+        }
+    }
+};
+
+const Reader = struct {
+    data: []const u8,
+    pos: usize = 0,
+
+    fn take(self: *Reader, n: usize) ![]const u8 {
+        if (self.data.len - self.pos < n) return error.CorruptCache;
+        const out = self.data[self.pos..][0..n];
+        self.pos += n;
+        return out;
+    }
+
+    fn int(self: *Reader, comptime T: type) !T {
+        const bytes = try self.take(@sizeOf(T));
+        return std.mem.readInt(T, bytes[0..@sizeOf(T)], .little);
+    }
+
+    /// Reads a `T` written by `Writer.value`; slices are allocated from `allocator`.
+    fn value(self: *Reader, allocator: std.mem.Allocator, comptime T: type) !T {
+        switch (@typeInfo(T)) {
+            .bool => return (try self.int(u8)) != 0,
+            .int => return self.int(T),
+            .float => |info| return @bitCast(try self.int(std.meta.Int(.unsigned, info.bits))),
+            .@"enum" => return std.meta.intToEnum(T, try self.int(u32)) catch error.CorruptCache,
+            .optional => |info| {
+                if ((try self.int(u8)) == 0) return null;
+                return try self.value(allocator, info.child);
+            },
+            .pointer => |info| {
+                comptime std.debug.assert(info.size == .slice);
+                const len = try self.int(u32);
+                if (len > self.data.len - self.pos) return error.CorruptCache;
+                if (info.child == u8) return allocator.dupe(u8, try self.take(len));
+                const items = try allocator.alloc(info.child, len);
+                for (items) |*item| item.* = try self.value(allocator, info.child);
+                return items;
+            },
+            .array => |info| {
+                var out: T = undefined;
+                for (&out) |*item| item.* = try self.value(allocator, info.child);
+                return out;
+            },
+            .@"struct" => |info| {
+                var out: T = undefined;
+                inline for (info.fields) |field| {
+                    @field(out, field.name) = try self.value(allocator, field.type);
+                }
+                return out;
+            },
+            else => @compileError("reflection cache cannot decode " ++ @typeName(T)),
+        }
+    }
+};
+
+fn content_key(kind: Kind, content: []const u8, salt: u64) u64 {
+    var hasher = std.hash.Wyhash.init(SCHEMA_FINGERPRINT);
+    hasher.update(&[_]u8{@intFromEnum(kind)});
+    hasher.update(std.mem.asBytes(&salt));
+    hasher.update(content);
+    return hasher.final();
+}
+
+fn options_salt(options: reflection.ShaderReflectionOptions) u64 {
+    return (@as(u64, options.runtime_array_max_count) << 32) | options.fallback_push_constant_size;
+}
+
+/// Stores an encoded `T` under `key`. Failures only cost a future miss, so they are not reported.
+fn store(comptime T: type, key: u64, v: T) void {
+    const alloc = cache_allocator();
+    var writer = Writer{ .allocator = alloc };
+    defer writer.deinit();
+    writer.value(T, v) catch return;
+
+    g_mutex.lock();
+    defer g_mutex.unlock();
+    const gop = g_entries.getOrPut(alloc, key) catch return;
+    if (gop.found_existing) return;
+    gop.value_ptr.* = writer.bytes.toOwnedSlice(alloc) catch {
+        _ = g_entries.remove(key);
+        return;
+    };
+    g_dirty = true;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Lookups
+// ---------------------------------------------------------------------------------------------
+
+/// `reflect_shader_with_options`, served from the cache when `code` was reflected before.
+pub fn reflect(allocator: std.mem.Allocator, code: []const u32, stage: c.VkShaderStageFlags, options: reflection.ShaderReflectionOptions) !reflection.ShaderReflection {
+    const key = content_key(.reflection, std.mem.sliceAsBytes(code), options_salt(options));
+    if (try lookup_reflection(allocator, key, stage)) |cached| return cached;
+
+    var result = try reflection.reflect_shader_with_options(allocator, code, stage, options);
+    errdefer result.deinit();
+    store_reflection(key, &result);
+    return result;
+}
+
+fn lookup_reflection(allocator: std.mem.Allocator, key: u64, stage: c.VkShaderStageFlags) !?reflection.ShaderReflection {
+    var arena = std.heap.ArenaAllocator.init(allocator);
+    defer arena.deinit();
+
+    const cached = blk: {
+        g_mutex.lock();
+        defer g_mutex.unlock();
+        const bytes = g_entries.get(key) orelse {
+            g_misses += 1;
+            return null;
+        };
+        var reader = Reader{ .data = bytes };
+        const decoded = reader.value(arena.allocator(), CachedReflection) catch |err| switch (err) {
+            error.OutOfMemory => return error.OutOfMemory,
+            else => {
+                g_misses += 1;
+                return null;
+            },
+        };
+        g_hits += 1;
+        break :blk decoded;
+    };
+
+    var result = reflection.ShaderReflection.init(allocator);
+    errdefer result.deinit();
+    try result.resources.ensureTotalCapacity(allocator, cached.resources.len);
+    for (cached.resources) |res| {
+        result.resources.appendAssumeCapacity(.{
+            .set = res.set,
+            .binding = res.binding,
+            .type = res.type,
+            .count = res.count,
+            .stage_flags = stage,
+            .name = "",
+            .is_runtime_array = res.is_runtime_array,
+        });
+    }
+    try result.constants.ensureTotalCapacity(allocator, @intCast(cached.constants.len));
+    for (cached.constants) |constant| result.constants.putAssumeCapacity(constant.id, constant.value);
+    result.push_constant_size = cached.push_constant_size;
+    if (cached.has_push_constants) result.push_constant_stages = stage;
+    return result;
+}
+
+fn store_reflection(key: u64, result: *const reflection.ShaderReflection) void {
+    const alloc = cache_allocator();
+    const resources = alloc.alloc(CachedResource, result.resources.items.len) catch return;
+    defer alloc.free(resources);
+    for (result.resources.items, resources) |res, *out| {
+        out.* = .{ .set = res.set, .binding = res.binding, .type = res.type, .count = res.count, .is_runtime_array = res.is_runtime_array };
+    }
+
+    const constants = alloc.alloc(CachedConstant, result.constants.count()) catch return;
+    defer alloc.free(constants);
+    var it = result.constants.iterator();
+    var i: usize = 0;
+    while (it.next()) |entry| : (i += 1) {
+        constants[i] = .{ .id = entry.key_ptr.*, .value = entry.value_ptr.* };
+    }
+
+    store(CachedReflection, key, .{
+        .resources = resources,
+        .push_constant_size = result.push_constant_size,
+        .has_push_constants = result.push_constant_stages != 0 or result.push_constant_size != 0,
+        .constants = constants,
+    });
+}
+
+/// Parses pipeline descriptor JSON, or decodes the cached result for identical text. The value
+/// never points into `content`.
+pub fn parse_pipeline_descriptor(allocator: std.mem.Allocator, content: []const u8) !std.json.Parsed(vk_pso.PipelineDescriptor) {
+    const key = content_key(.pipeline_descriptor, content, 0);
+    if (try lookup_descriptor(allocator, key)) |cached| return cached;
+
+    const parsed = try std.json.parseFromSlice(vk_pso.PipelineDescriptor, allocator, content, .{
+        .ignore_unknown_fields = true,
+        .allocate = .alloc_always,
+    });
+    store(vk_pso.PipelineDescriptor, key, parsed.value);
+    return parsed;
+}
+
+fn lookup_descriptor(allocator: std.mem.Allocator, key: u64) !?std.json.Parsed(vk_pso.PipelineDescriptor) {
+    const arena = try allocator.create(std.heap.ArenaAllocator);
+    errdefer allocator.destroy(arena);
+    arena.* = std.heap.ArenaAllocator.init(allocator);
+    errdefer arena.deinit();
+
+    g_mutex.lock();
+    defer g_mutex.unlock();
+    const bytes = g_entries.get(key) orelse {
+        g_misses += 1;
+        arena.deinit();
+        allocator.destroy(arena);
+        return null;
+    };
+    var reader = Reader{ .data = bytes };
+    const decoded = reader.value(arena.allocator(), vk_pso.PipelineDescriptor) catch |err| switch (err) {
+        error.OutOfMemory => return error.OutOfMemory,
+        else => {
+            g_misses += 1;
+            arena.deinit();
+            allocator.destroy(arena);
+            return null;
+        },
+    };
+    g_hits += 1;
+    return .{ .arena = arena, .value = decoded };
+}
+
+// ---------------------------------------------------------------------------------------------
+// Persistence
+// ---------------------------------------------------------------------------------------------
+
+/// Merges the entries of a serialized cache into memory and returns how many were added. Data
+/// from another format version or schema, or with a bad checksum, is ignored.
+pub fn load_bytes(bytes: []const u8) usize {
+    if (bytes.len < @sizeOf(CacheFileHeader)) return 0;
+    const header = std.mem.bytesToValue(CacheFileHeader, bytes[0..@sizeOf(CacheFileHeader)]);
+    if (header.magic != CACHE_FILE_MAGIC) return 0;
+    if (header.version != CACHE_FILE_VERSION or header.schema != SCHEMA_FINGERPRINT) {
+        cache_log.info("Ignoring reflection cache from another build (version {d})", .{header.version});
+        return 0;
+    }
+    const body = bytes[@sizeOf(CacheFileHeader)..];
+    if (body.len != header.data_size or std.hash.Wyhash.hash(0, body) != header.checksum) {
+        cache_log.warn("Reflection cache checksum mismatch, ignoring it", .{});
+        return 0;
+    }
+
+    const alloc = cache_allocator();
+    var reader = Reader{ .data = body };
+    var added: usize = 0;
+
+    g_mutex.lock();
+    defer g_mutex.unlock();
+    for (0..header.entry_count) |_| {
+        const key = reader.int(u64) catch break;
+        const size = reader.int(u32) catch break;
+        const data = reader.take(size) catch break;
+        const gop = g_entries.getOrPut(alloc, key) catch break;
+        if (gop.found_existing) continue;
+        gop.value_ptr.* = alloc.dupe(u8, data) catch {
+            _ = g_entries.remove(key);
+            break;
+        };
+        added += 1;
+    }
+    return added;
+}
+
+/// Serializes every entry, header included. Caller owns the returned bytes.
+pub fn save_bytes(allocator: std.mem.Allocator) ![]u8 {
+    var writer = Writer{ .allocator = allocator };
+    errdefer writer.deinit();
+    try writer.raw(std.mem.asBytes(&std.mem.zeroes(CacheFileHeader)));
+
+    g_mutex.lock();
+    defer g_mutex.unlock();
+    var it = g_entries.iterator();
+    while (it.next()) |entry| {
+        try writer.int(u64, entry.key_ptr.*);
+        try writer.int(u32, @intCast(entry.value_ptr.len));
+        try writer.raw(entry.value_ptr.*);
+    }
+
+    const body = writer.bytes.items[@sizeOf(CacheFileHeader)..];
+    const header = CacheFileHeader{
+        .magic = CACHE_FILE_MAGIC,
+        .version = CACHE_FILE_VERSION,
+        .schema = SCHEMA_FINGERPRINT,
+        .entry_count = @intCast(g_entries.count()),
+        .data_size = body.len,
+        .checksum = std.hash.Wyhash.hash(0, body),
+    };
+    @memcpy(writer.bytes.items[0..@sizeOf(CacheFileHeader)], std.mem.asBytes(&header));
+    return writer.bytes.toOwnedSlice(allocator);
+}
+
+/// Loads the cache file at `path` if there is one.
+pub fn load_file(path: []const u8) void {
+    const alloc = cache_allocator();
+    const bytes = vfs.read_file_alloc(alloc, path) catch return;
+    defer alloc.free(bytes);
+
+    const start = std.time.nanoTimestamp();
+    const added = load_bytes(bytes);
+    const elapsed_us = @divTrunc(std.time.nanoTimestamp() - start, std.time.ns_per_us);
+    cache_log.info("Loaded {d} reflection cache entries ({d} bytes) in {d} us", .{ added, bytes.len, elapsed_us });
+}
+
+/// Writes the cache to `path` if anything was added since it was last loaded or saved.
+pub fn save_file(path: []const u8) void {
+    {
+        g_mutex.lock();
+        defer g_mutex.unlock();
+        if (!g_dirty) return;
+    }
+
+    const alloc = cache_allocator();
+    const bytes = save_bytes(alloc) catch |err| {
+        cache_log.warn("Failed to serialize reflection cache: {s}", .{@errorName(err)});
+        return;
+    };
+    defer alloc.free(bytes);
+    vfs.write_file_parts(path, bytes[0..@sizeOf(CacheFileHeader)], bytes[@sizeOf(CacheFileHeader)..]) catch |err| {
+        cache_log.warn("Failed to write reflection cache '{s}': {s}", .{ path, @errorName(err) });
+        return;
+    };
+
+    g_mutex.lock();
+    defer g_mutex.unlock();
+    g_dirty = false;
+}
+
+/// Drops every entry and resets the counters.
+pub fn clear() void {
+    const alloc = cache_allocator();
+    g_mutex.lock();
+    defer g_mutex.unlock();
+    var it = g_entries.valueIterator();
+    while (it.next()) |bytes| alloc.free(bytes.*);
+    g_entries.deinit(alloc);
+    g_entries = .{};
+    g_dirty = false;
+    g_hits = 0;
+    g_misses = 0;
+}
+
+pub fn stats() Stats {
+    g_mutex.lock();
+    defer g_mutex.unlock();
+    return .{ .entries = g_entries.count(), .hits = g_hits, .misses = g_misses };
+}
+
+// ---------------------------------------------------------------------------------------------
+// Prewarming
+// ---------------------------------------------------------------------------------------------
+
+/// Result of `prewarm`.
+pub const PrewarmResult = struct {
+    shaders: u32 = 0,
+    pipelines: u32 = 0,
+    failed: u32 = 0,
+};
+
+const PrewarmItem = struct {
+    path: []const u8,
+    kind: Kind,
+    ok: bool = false,
+
+    fn run(self: *PrewarmItem) void {
+        const alloc = cache_allocator();
+        switch (self.kind) {
+            .reflection => {
+                const code = file_io.read_file_u32(alloc, self.path) catch return;
+                defer alloc.free(code);
+                var result = reflect(alloc, code, c.VK_SHADER_STAGE_ALL, .{}) catch return;
+                result.deinit();
+            },
+            .pipeline_descriptor => {
+                const content = std.fs.cwd().readFileAlloc(alloc, self.path, MAX_DESCRIPTOR_BYTES) catch return;
+                defer alloc.free(content);
+                const parsed = parse_pipeline_descriptor(alloc, content) catch return;
+                parsed.deinit();
+            },
+        }
+        self.ok = true;
+    }
+};
+
+fn prewarm_job(data: ?*anyopaque) callconv(.c) i32 {
+    const item: *PrewarmItem = @ptrCast(@alignCast(data.?));
+    item.run();
+    return if (item.ok) 0 else -1;
+}
+
+fn collect(arena: std.mem.Allocator, items: *std.ArrayListUnmanaged(PrewarmItem), dir_path: []const u8, extension: []const u8, kind: Kind) !void {
+    var dir = std.fs.cwd().openDir(dir_path, .{ .iterate = true }) catch return;
+    defer dir.close();
+    var it = dir.iterate();
+    while (try it.next()) |entry| {
+        if (entry.kind != .file or !std.mem.endsWith(u8, entry.name, extension)) continue;
+        try items.append(arena, .{ .path = try std.fs.path.join(arena, &.{ dir_path, entry.name }), .kind = kind });
+    }
+}
+
+/// Reflects every `.spv` module in `shader_dir` and parses every `.json` descriptor in
+/// `pipeline_dir` into the cache, one job per file (inline when the job system is down). Cached
+/// files cost one read and one hash, so this is cheap to call on every start-up.
+pub fn prewarm(allocator: std.mem.Allocator, shader_dir: []const u8, pipeline_dir: []const u8) !PrewarmResult {
+    var arena = std.heap.ArenaAllocator.init(allocator);
+    defer arena.deinit();
+    const arena_alloc = arena.allocator();
+
+    var items = std.ArrayListUnmanaged(PrewarmItem){};
+    try collect(arena_alloc, &items, shader_dir, ".spv", .reflection);
+    try collect(arena_alloc, &items, pipeline_dir, ".json", .pipeline_descriptor);
+
+    var jobs = std.ArrayListUnmanaged(*job_system.Job){};
+    defer jobs.deinit(allocator);
+    try jobs.ensureTotalCapacity(allocator, items.items.len);
+
+    for (items.items) |*item| {
+        const job = job_system.create_job(prewarm_job, item, .NORMAL) orelse {
+            item.run();
+            continue;
+        };
+        job.push_to_completed_queue = false;
+        while (!job_system.submit_job(job)) {
+            std.Thread.yield() catch {};
+        }
+        jobs.appendAssumeCapacity(job);
+    }
+    job_system.wait_for_jobs(jobs.items);
+    for (jobs.items) |job| job_system.free_job(job);
+
+    var result = PrewarmResult{};
+    for (items.items) |item| {
+        if (!item.ok) {
+            result.failed += 1;
+        } else switch (item.kind) {
+            .reflection => result.shaders += 1,
+            .pipeline_descriptor => result.pipelines += 1,
+        }
+    }
+    return result;
+}
+
+/// Minimal module: a sampler at set 1 binding 2, a u32 push constant and one constant.
+const test_spirv = [_]u32{
+    0x07230203, 0x00010000, 0, 8, 0,
+    // OpDecorate %3 DescriptorSet 1, OpDecorate %3 Binding 2
+    (4 << 16) | 71, 3, 34, 1,
+    (4 << 16) | 71, 3, 33, 2,
+    // %1 = OpTypeSampler, %4 = OpTypeInt 32 0
+    (2 << 16) | 26, 1,
+    (4 << 16) | 21, 4, 32, 0,
+    // %2 = OpTypePointer UniformConstant %1, %5 = OpTypePointer PushConstant %4
+    (4 << 16) | 32, 2, 0, 1,
+    (4 << 16) | 32, 5, 9, 4,
+    // %7 = OpConstant %4 42
+    (4 << 16) | 43, 4, 7, 42,
+    // %3 = OpVariable %2 UniformConstant, %6 = OpVariable %5 PushConstant
+    (4 << 16) | 59, 2, 3, 0,
+    (4 << 16) | 59, 5, 6, 9,
+};
+
+test "reflection is cached per module and retagged per stage" {
+    memory.cardinal_memory_init(1024 * 1024);
+    defer memory.cardinal_memory_shutdown();
+    clear();
+    defer clear();
+
+    const allocator = std.testing.allocator;
+    var first = try reflect(allocator, &test_spirv, c.VK_SHADER_STAGE_FRAGMENT_BIT, .{});
+    defer first.deinit();
+    var second = try reflect(allocator, &test_spirv, c.VK_SHADER_STAGE_VERTEX_BIT, .{});
+    defer second.deinit();
+
+    const s = stats();
+    try std.testing.expectEqual(@as(u64, 1), s.hits);
+    try std.testing.expectEqual(@as(u64, 1), s.misses);
+
+    try std.testing.expectEqual(first.resources.items.len, second.resources.items.len);
+    const res = second.resources.items[0];
+    try std.testing.expectEqual(@as(u32, 1), res.set);
+    try std.testing.expectEqual(@as(u32, 2), res.binding);
+    try std.testing.expectEqual(@as(c.VkDescriptorType, c.VK_DESCRIPTOR_TYPE_SAMPLER), res.type);
+    try std.testing.expectEqual(@as(c.VkShaderStageFlags, c.VK_SHADER_STAGE_VERTEX_BIT), res.stage_flags);
+    try std.testing.expectEqual(first.push_constant_size, second.push_constant_size);
+    try std.testing.expectEqual(@as(c.VkShaderStageFlags, c.VK_SHADER_STAGE_VERTEX_BIT), second.push_constant_stages);
+    try std.testing.expectEqual(@as(?u32, 42), second.constants.get(7));
+
+    // A different reflection option is a different entry.
+    var third = try reflect(allocator, &test_spirv, c.VK_SHADER_STAGE_VERTEX_BIT, .{ .fallback_push_constant_size = 128 });
+    defer third.deinit();
+    try std.testing.expectEqual(@as(u64, 2), stats().misses);
+}
+
+test "pipeline descriptors survive a save/load roundtrip" {
+    memory.cardinal_memory_init(1024 * 1024);
+    defer memory.cardinal_memory_shutdown();
+    clear();
+    defer clear();
+
+    const json =
+        \\{ "name": "cached", "vertex_shader": { "path": "a.vert.spv", "stage": 1 },
+        \\  "rasterization": { "cull_mode": "none", "line_width": 2.5 },
+        \\  "color_blend": { "attachments": [ { "blend_enable": true } ], "blend_constants": [1, 2, 3, 4] },
+        \\  "rendering": { "color_formats": [ 37, 44 ], "depth_format": 126 } }
+    ;
+    const allocator = std.testing.allocator;
+    const parsed = try parse_pipeline_descriptor(allocator, json);
+    defer parsed.deinit();
+
+    const blob = try save_bytes(allocator);
+    defer allocator.free(blob);
+    clear();
+    try std.testing.expectEqual(@as(usize, 1), load_bytes(blob));
+
+    const cached = try parse_pipeline_descriptor(allocator, json);
+    defer cached.deinit();
+    try std.testing.expectEqual(@as(u64, 1), stats().hits);
+
+    const a = parsed.value;
+    const b = cached.value;
+    try std.testing.expectEqualStrings(a.name, b.name);
+    try std.testing.expectEqualStrings(a.vertex_shader.?.path, b.vertex_shader.?.path);
+    try std.testing.expectEqualStrings("main", b.vertex_shader.?.entry_point);
+    try std.testing.expect(b.fragment_shader == null);
+    try std.testing.expectEqual(a.rasterization.cull_mode, b.rasterization.cull_mode);
+    try std.testing.expectEqual(@as(f32, 2.5), b.rasterization.line_width);
+    try std.testing.expect(b.color_blend.attachments[0].blend_enable);
+    try std.testing.expectEqual(a.color_blend.blend_constants, b.color_blend.blend_constants);
+    try std.testing.expectEqualSlices(c.VkFormat, a.rendering.color_formats, b.rendering.color_formats);
+    try std.testing.expectEqualSlices(c.VkDynamicState, a.dynamic_states, b.dynamic_states);
+
+    // A blob from another schema is ignored.
+    clear();
+    const stale = try allocator.dupe(u8, blob);
+    defer allocator.free(stale);
+    stale[8] ^= 0xff;
+    try std.testing.expectEqual(@as(usize, 0), load_bytes(stale));
+}
@@ -5,6 +5,7 @@
 const std = @import("std");
 const log = @import("../../core/log.zig");
 pub const reflection = @import("vulkan_shader_reflection.zig");
+pub const reflection_cache = @import("vulkan_reflection_cache.zig");
 const file_io = @import("../../assets/file_io.zig");
 const memory = @import("../../core/memory.zig");
 
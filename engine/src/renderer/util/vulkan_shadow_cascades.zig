@@ -6,6 +6,10 @@
 const std = @import("std");
 const types = @import("../vulkan_types.zig");
 const math = @import("../../core/math.zig");
+const caster_culling = @import("../shadow_caster_culling.zig");
+
+/// Half of each cascade's depth window around its centre, in light-view units.
+pub const DEPTH_HALF_RANGE: f32 = 4000.0;
 
 fn mat4_ortho(left: f32, right: f32, bottom: f32, top: f32, zNear: f32, zFar: f32) math.Mat4 {
     return math.Mat4.ortho(left, right, bottom, top, zNear, zFar);
@@ -40,11 +44,16 @@ fn corners_at_dist(dist: f32, c_pos: math.Vec3, c_fwd: math.Vec3, c_right: math.
 
 /// Builds cascade split depths and corresponding light-space matrices.
 ///
-/// `out_splits` and `out_light_space` must have length >= `cascade_count`.
-pub fn build_shadow_cascades(config: *const types.RendererConfig, ubo: *const types.PBRUniformBufferObject, light_dir_in: math.Vec3, cascade_count: usize, out_splits: []f32, out_light_space: []math.Mat4) void {
+/// `out_splits` and `out_light_space` must have length >= `cascade_count`. When given,
+/// `out_caster_volumes` receives each cascade's `shadow_caster_culling.caster_volume`, which holds
+/// every caster that can shadow the cascade for any camera position producing the same matrix.
+pub fn build_shadow_cascades(config: *const types.RendererConfig, ubo: *const types.PBRUniformBufferObject, light_dir_in: math.Vec3, cascade_count: usize, out_splits: []f32, out_light_space: []math.Mat4, out_caster_volumes: ?[]math.Mat4) void {
     if (cascade_count == 0) return;
     if (cascade_count > out_splits.len) return;
     if (cascade_count > out_light_space.len) return;
+    if (out_caster_volumes) |volumes| {
+        if (cascade_count > volumes.len) return;
+    }
 
     const view = math.Mat4.fromArray(ubo.view);
     const proj = math.Mat4.fromArray(ubo.proj);
@@ -127,18 +136,23 @@ pub fn build_shadow_cascades(config: *const types.RendererConfig, ubo: *const ty
 
         center_ls.x = @floor((center_ls.x - radius) / world_units_per_texel) * world_units_per_texel + radius;
         center_ls.y = @floor((center_ls.y - radius) / world_units_per_texel) * world_units_per_texel + radius;
+        // Snap the depth window as well, so the matrix only changes in steps as the camera moves.
+        // The receivers then lie within [center - radius, center + 2 * radius] along z.
+        center_ls.z = @floor(center_ls.z / radius) * radius;
 
         const minX = center_ls.x - radius;
         const maxX = center_ls.x + radius;
         const minY = center_ls.y - radius;
         const maxY = center_ls.y + radius;
 
-        const z_range = 4000.0;
-        const minZ_ortho = center_ls.z - z_range;
-        const maxZ_ortho = center_ls.z + z_range;
+        const minZ_ortho = center_ls.z - DEPTH_HALF_RANGE;
+        const maxZ_ortho = center_ls.z + DEPTH_HALF_RANGE;
 
         const light_proj = mat4_ortho(minX, maxX, minY, maxY, maxZ_ortho, minZ_ortho);
         out_light_space[j] = light_proj.mul(base_light_view);
+        if (out_caster_volumes) |volumes| {
+            volumes[j] = caster_culling.caster_volume(base_light_view, minX, maxX, minY, maxY, maxZ_ortho, center_ls.z - radius);
+        }
 
         last_split_dist = d;
     }
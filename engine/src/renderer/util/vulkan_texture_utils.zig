@@ -8,6 +8,7 @@ const builtin = @import("builtin");
 const log = @import("../../core/log.zig");
 const platform = @import("../../core/platform.zig");
 const mem_utils = @import("../../core/memory.zig");
+const profiler = @import("../../core/profiler.zig");
 const types = @import("../vulkan_types.zig");
 
 const tex_utils_log = log.ScopedLogger("TEX_UTILS");
@@ -15,7 +16,9 @@ const tex_utils_log = log.ScopedLogger("TEX_UTILS");
 const buffer_mgr = @import("../vulkan_buffer_manager.zig");
 const vk_sync_manager = @import("../vulkan_sync_manager.zig");
 const vk_allocator = @import("../vulkan_allocator.zig");
+const vk_staging_ring = @import("../vulkan_staging_ring.zig");
 const scene = @import("../../assets/scene.zig");
+const texture_types = @import("../../assets/texture_types.zig");
 
 const c = @import("../vulkan_c.zig").c;
 
@@ -361,20 +364,35 @@ pub fn shutdown_staging_buffer_cleanups(allocator: *types.VulkanAllocator) void
     g_cleanup_system_initialized = false;
 }
 
+/// Byte counts of a texture payload: what is copied from `texture.data` and the zero-padded
+/// size staged for the GPU.
+const StagingSize = struct {
+    copy: usize,
+    staged: c.VkDeviceSize,
+};
+
+fn staging_size(texture: *const scene.CardinalTexture) StagingSize {
+    const pixel_size: u64 = if (texture.is_hdr != 0) 16 else 4;
+    const copy_size: c.VkDeviceSize = if (texture.data_size > 0) texture.data_size else @as(c.VkDeviceSize, texture.width) * texture.height * pixel_size;
+    return .{ .copy = @intCast(copy_size), .staged = @max(copy_size, 4) };
+}
+
 /// Creates a staging buffer and copies texture bytes into it.
 pub fn create_staging_buffer_with_data(allocator: ?*types.VulkanAllocator, device: c.VkDevice, texture: *const scene.CardinalTexture, outBuffer: *c.VkBuffer, outMemory: *c.VkDeviceMemory, outAllocation: *c.VmaAllocation) bool {
     _ = device;
 
     if (texture.data == null) return false;
 
-    const pixel_size: u64 = if (texture.is_hdr != 0) 16 else 4;
-    const copy_size_vk: c.VkDeviceSize = if (texture.data_size > 0) texture.data_size else @as(c.VkDeviceSize, texture.width) * texture.height * pixel_size;
-    const imageSize: c.VkDeviceSize = @max(copy_size_vk, 4);
-    const copy_size: usize = @intCast(copy_size_vk);
+    const sizes = staging_size(texture);
+    const src_data = @as([*]const u8, @ptrCast(texture.data));
+    return create_staging_buffer_from_bytes(allocator, src_data[0..sizes.copy], sizes.staged, outBuffer, outMemory, outAllocation);
+}
 
+/// Creates a `staged_size`-byte staging buffer holding `bytes`, zero-padded.
+fn create_staging_buffer_from_bytes(allocator: ?*types.VulkanAllocator, bytes: []const u8, staged_size: c.VkDeviceSize, outBuffer: *c.VkBuffer, outMemory: *c.VkDeviceMemory, outAllocation: *c.VmaAllocation) bool {
     var bufferInfo = std.mem.zeroes(c.VkBufferCreateInfo);
     bufferInfo.sType = c.VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = imageSize;
+    bufferInfo.size = staged_size;
     bufferInfo.usage = c.VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
     bufferInfo.sharingMode = c.VK_SHARING_MODE_EXCLUSIVE;
 
@@ -390,33 +408,60 @@ pub fn create_staging_buffer_with_data(allocator: ?*types.VulkanAllocator, devic
         return false;
     }
 
-    const src_data = @as([*]const u8, @ptrCast(texture.data));
-    const dst = @as([*]u8, @ptrCast(data.?))[0..@as(usize, @intCast(imageSize))];
+    const dst = @as([*]u8, @ptrCast(data.?))[0..@as(usize, @intCast(staged_size))];
     @memset(dst, 0);
-    @memcpy(dst[0..copy_size], src_data[0..copy_size]);
+    @memcpy(dst[0..bytes.len], bytes);
 
     vk_allocator.unmap_memory(allocator, outAllocation.*);
+    profiler.count(.uploads, 1);
+    profiler.count(.upload_bytes, bytes.len);
     return true;
 }
 
-/// Allocates a 2D sampled image and its backing memory via VMA.
-pub fn create_image_and_memory(allocator: ?*types.VulkanAllocator, device: c.VkDevice, width: u32, height: u32, format: c.VkFormat, outImage: *c.VkImage, outMemory: *c.VkDeviceMemory, outAllocation: *c.VmaAllocation) bool {
+/// Number of mip levels stored in `texture`'s payload when uploaded as `format`.
+///
+/// Cooked and DDS textures carry their full chain back to back; decoded images carry one level.
+pub fn texture_mip_levels(texture: *const scene.CardinalTexture, format: c.VkFormat) u32 {
+    return texture_types.mip_level_count(@intCast(format), texture.width, texture.height, texture.data_size);
+}
+
+/// Allocates a 2D sampled image with `mip_levels` levels and its backing memory via VMA.
+pub fn create_image_and_memory(allocator: ?*types.VulkanAllocator, device: c.VkDevice, width: u32, height: u32, format: c.VkFormat, mip_levels: u32, outImage: *c.VkImage, outMemory: *c.VkDeviceMemory, outAllocation: *c.VmaAllocation) bool {
+    return create_image_and_memory_shared(allocator, device, width, height, format, mip_levels, &.{}, outImage, outMemory, outAllocation);
+}
+
+/// `create_image_and_memory` with concurrent sharing across `queue_families` when it names more
+/// than one family.
+pub fn create_image_and_memory_shared(allocator: ?*types.VulkanAllocator, device: c.VkDevice, width: u32, height: u32, format: c.VkFormat, mip_levels: u32, queue_families: []const u32, outImage: *c.VkImage, outMemory: *c.VkDeviceMemory, outAllocation: *c.VmaAllocation) bool {
     _ = device;
+    return create_layered_image_and_memory(allocator, width, height, format, mip_levels, 1, false, queue_families, outImage, outMemory, outAllocation);
+}
+
+/// Allocates a sampled image with `layer_count` array layers; `cube` makes it cube-compatible
+/// (`layer_count` must then be a multiple of six).
+fn create_layered_image_and_memory(allocator: ?*types.VulkanAllocator, width: u32, height: u32, format: c.VkFormat, mip_levels: u32, layer_count: u32, cube: bool, queue_families: []const u32, outImage: *c.VkImage, outMemory: *c.VkDeviceMemory, outAllocation: *c.VmaAllocation) bool {
     var imageInfo = std.mem.zeroes(c.VkImageCreateInfo);
     imageInfo.sType = c.VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    if (cube) imageInfo.flags = c.VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
     imageInfo.imageType = c.VK_IMAGE_TYPE_2D;
     imageInfo.extent.width = width;
     imageInfo.extent.height = height;
     imageInfo.extent.depth = 1;
-    imageInfo.mipLevels = 1;
-    imageInfo.arrayLayers = 1;
+    imageInfo.mipLevels = @max(mip_levels, 1);
+    imageInfo.arrayLayers = @max(layer_count, 1);
     imageInfo.format = format;
     if (imageInfo.format == c.VK_FORMAT_UNDEFINED) return false;
     imageInfo.tiling = c.VK_IMAGE_TILING_OPTIMAL;
     imageInfo.initialLayout = c.VK_IMAGE_LAYOUT_UNDEFINED;
     imageInfo.usage = c.VK_IMAGE_USAGE_TRANSFER_DST_BIT | c.VK_IMAGE_USAGE_SAMPLED_BIT;
     imageInfo.samples = c.VK_SAMPLE_COUNT_1_BIT;
-    imageInfo.sharingMode = c.VK_SHARING_MODE_EXCLUSIVE;
+    if (queue_families.len > 1) {
+        imageInfo.sharingMode = c.VK_SHARING_MODE_CONCURRENT;
+        imageInfo.queueFamilyIndexCount = @intCast(queue_families.len);
+        imageInfo.pQueueFamilyIndices = queue_families.ptr;
+    } else {
+        imageInfo.sharingMode = c.VK_SHARING_MODE_EXCLUSIVE;
+    }
 
     if (!vk_allocator.allocate_image(allocator, &imageInfo, outImage, outMemory, outAllocation, c.VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) {
         tex_utils_log.err("Failed to allocate texture image with VMA", .{});
@@ -426,8 +471,26 @@ pub fn create_image_and_memory(allocator: ?*types.VulkanAllocator, device: c.VkD
     return true;
 }
 
-/// Records barriers and a buffer-to-image copy for a texture upload.
-pub fn record_texture_copy_commands(commandBuffer: c.VkCommandBuffer, stagingBuffer: c.VkBuffer, textureImage: c.VkImage, width: u32, height: u32) void {
+/// Records barriers and buffer-to-image copies for a texture upload.
+///
+/// The staging buffer holds `mip_levels` levels of `format` packed largest-first; each level is
+/// copied with its own region.
+pub fn record_texture_copy_commands(commandBuffer: c.VkCommandBuffer, stagingBuffer: c.VkBuffer, textureImage: c.VkImage, width: u32, height: u32, format: c.VkFormat, mip_levels: u32) void {
+    record_texture_copy_commands_at(commandBuffer, stagingBuffer, 0, textureImage, width, height, format, mip_levels, c.VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, c.VK_ACCESS_2_SHADER_READ_BIT);
+}
+
+/// `record_texture_copy_commands` for a mip chain starting at `staging_offset`, with the final
+/// transition to SHADER_READ_ONLY_OPTIMAL made visible to `dst_stage`/`dst_access`.
+pub fn record_texture_copy_commands_at(commandBuffer: c.VkCommandBuffer, stagingBuffer: c.VkBuffer, staging_offset: c.VkDeviceSize, textureImage: c.VkImage, width: u32, height: u32, format: c.VkFormat, mip_levels: u32, dst_stage: c.VkPipelineStageFlags2, dst_access: c.VkAccessFlags2) void {
+    record_layered_copy_commands(commandBuffer, stagingBuffer, staging_offset, textureImage, width, height, format, mip_levels, 1, dst_stage, dst_access);
+}
+
+/// `record_texture_copy_commands_at` for an image with `layer_count` layers; each mip level in
+/// the staging buffer holds its layers back to back.
+fn record_layered_copy_commands(commandBuffer: c.VkCommandBuffer, stagingBuffer: c.VkBuffer, staging_offset: c.VkDeviceSize, textureImage: c.VkImage, width: u32, height: u32, format: c.VkFormat, mip_levels: u32, layer_count: u32, dst_stage: c.VkPipelineStageFlags2, dst_access: c.VkAccessFlags2) void {
+    const level_count = @max(mip_levels, 1);
+    const layers = @max(layer_count, 1);
+
     var barrier = std.mem.zeroes(c.VkImageMemoryBarrier2);
     barrier.sType = c.VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
     barrier.srcStageMask = c.VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT;
@@ -441,9 +504,9 @@ pub fn record_texture_copy_commands(commandBuffer: c.VkCommandBuffer, stagingBuf
     barrier.image = textureImage;
     barrier.subresourceRange.aspectMask = c.VK_IMAGE_ASPECT_COLOR_BIT;
     barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.levelCount = level_count;
     barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
+    barrier.subresourceRange.layerCount = layers;
 
     var dependencyInfo = std.mem.zeroes(c.VkDependencyInfo);
     dependencyInfo.sType = c.VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
@@ -459,23 +522,36 @@ pub fn record_texture_copy_commands(commandBuffer: c.VkCommandBuffer, stagingBuf
 
     c.vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
 
-    var region = std.mem.zeroes(c.VkBufferImageCopy);
-    region.bufferOffset = 0;
-    region.bufferRowLength = 0;
-    region.bufferImageHeight = 0;
-    region.imageSubresource.aspectMask = c.VK_IMAGE_ASPECT_COLOR_BIT;
-    region.imageSubresource.mipLevel = 0;
-    region.imageSubresource.baseArrayLayer = 0;
-    region.imageSubresource.layerCount = 1;
-    region.imageOffset = .{ .x = 0, .y = 0, .z = 0 };
-    region.imageExtent = .{ .width = width, .height = height, .depth = 1 };
-
-    c.vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, textureImage, c.VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    // texture_types.mip_level_count never reports more levels than a full chain, so 16 covers
+    // every image up to 32768 texels wide.
+    var regions: [16]c.VkBufferImageCopy = undefined;
+    const region_count = @min(level_count, regions.len);
+    var offset: u64 = staging_offset;
+    var level_width = width;
+    var level_height = height;
+    for (regions[0..region_count], 0..) |*region, level| {
+        region.* = std.mem.zeroes(c.VkBufferImageCopy);
+        region.bufferOffset = offset;
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+        region.imageSubresource.aspectMask = c.VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = @intCast(level);
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = layers;
+        region.imageOffset = .{ .x = 0, .y = 0, .z = 0 };
+        region.imageExtent = .{ .width = level_width, .height = level_height, .depth = 1 };
+
+        offset += texture_types.mip_level_size(@intCast(format), level_width, level_height) * layers;
+        level_width = @max(level_width / 2, 1);
+        level_height = @max(level_height / 2, 1);
+    }
+
+    c.vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, textureImage, c.VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, @intCast(region_count), regions[0..region_count].ptr);
 
     barrier.srcStageMask = c.VK_PIPELINE_STAGE_2_TRANSFER_BIT;
     barrier.srcAccessMask = c.VK_ACCESS_2_TRANSFER_WRITE_BIT;
-    barrier.dstStageMask = c.VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
-    barrier.dstAccessMask = c.VK_ACCESS_2_SHADER_READ_BIT;
+    barrier.dstStageMask = dst_stage;
+    barrier.dstAccessMask = dst_access;
     barrier.oldLayout = c.VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
     barrier.newLayout = c.VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
@@ -523,19 +599,24 @@ fn submit_texture_upload(device: c.VkDevice, graphicsQueue: c.VkQueue, commandBu
 }
 
 pub fn create_texture_image_view(device: c.VkDevice, image: c.VkImage, outView: *c.VkImageView, format: c.VkFormat) bool {
+    return create_layered_image_view(device, image, outView, format, 1, false);
+}
+
+/// Views all mips of `layer_count` layers, as a cube when `cube` is set.
+fn create_layered_image_view(device: c.VkDevice, image: c.VkImage, outView: *c.VkImageView, format: c.VkFormat, layer_count: u32, cube: bool) bool {
     var viewInfo = std.mem.zeroes(c.VkImageViewCreateInfo);
     viewInfo.sType = c.VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     viewInfo.image = image;
-    viewInfo.viewType = c.VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.viewType = if (cube) c.VK_IMAGE_VIEW_TYPE_CUBE else c.VK_IMAGE_VIEW_TYPE_2D;
     viewInfo.format = format;
     if (viewInfo.format == c.VK_FORMAT_UNDEFINED) {
         viewInfo.format = c.VK_FORMAT_R8G8B8A8_SRGB;
     }
     viewInfo.subresourceRange.aspectMask = c.VK_IMAGE_ASPECT_COLOR_BIT;
     viewInfo.subresourceRange.baseMipLevel = 0;
-    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.levelCount = c.VK_REMAINING_MIP_LEVELS;
     viewInfo.subresourceRange.baseArrayLayer = 0;
-    viewInfo.subresourceRange.layerCount = 1;
+    viewInfo.subresourceRange.layerCount = @max(layer_count, 1);
 
     if (c.vkCreateImageView(device, &viewInfo, null, outView) != c.VK_SUCCESS) {
         tex_utils_log.err("Failed to create texture image view", .{});
@@ -550,6 +631,18 @@ pub export fn vk_texture_create_from_data(allocator: ?*types.VulkanAllocator, de
         return false;
     }
 
+    var format: c.VkFormat = if (texture.?.format != 0) @intCast(texture.?.format) else c.VK_FORMAT_UNDEFINED;
+    if (format == c.VK_FORMAT_UNDEFINED) {
+        format = if (texture.?.is_hdr != 0) c.VK_FORMAT_R32G32B32A32_SFLOAT else c.VK_FORMAT_R8G8B8A8_SRGB;
+    }
+    const mip_levels = texture_mip_levels(texture.?, format);
+
+    if (vk_staging_ring.active()) |ring| {
+        if (ring.fits_image(staging_size(texture.?).staged)) {
+            return create_texture_from_ring(ring, allocator, device, texture.?, format, mip_levels, textureImage.?, textureImageMemory.?, textureImageView.?, textureAllocation.?, outTimelineValue);
+        }
+    }
+
     var stagingBuffer: c.VkBuffer = null;
     var stagingBufferMemory: c.VkDeviceMemory = null;
     var stagingBufferAllocation: c.VmaAllocation = null;
@@ -557,12 +650,7 @@ pub export fn vk_texture_create_from_data(allocator: ?*types.VulkanAllocator, de
         return false;
     }
 
-    var format: c.VkFormat = if (texture.?.format != 0) @intCast(texture.?.format) else c.VK_FORMAT_UNDEFINED;
-    if (format == c.VK_FORMAT_UNDEFINED) {
-        format = if (texture.?.is_hdr != 0) c.VK_FORMAT_R32G32B32A32_SFLOAT else c.VK_FORMAT_R8G8B8A8_SRGB;
-    }
-
-    if (!create_image_and_memory(allocator, device, texture.?.width, texture.?.height, format, textureImage.?, textureImageMemory.?, textureAllocation.?)) {
+    if (!create_image_and_memory(allocator, device, texture.?.width, texture.?.height, format, mip_levels, textureImage.?, textureImageMemory.?, textureAllocation.?)) {
         vk_allocator.free_buffer(allocator, stagingBuffer, stagingBufferAllocation);
         return false;
     }
@@ -574,7 +662,7 @@ pub export fn vk_texture_create_from_data(allocator: ?*types.VulkanAllocator, de
         return false;
     }
 
-    record_texture_copy_commands(commandBuffer, stagingBuffer, textureImage.?.*, texture.?.width, texture.?.height);
+    record_texture_copy_commands(commandBuffer, stagingBuffer, textureImage.?.*, texture.?.width, texture.?.height, format, mip_levels);
 
     if (c.vkEndCommandBuffer(commandBuffer) != c.VK_SUCCESS) {
         c.vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
@@ -608,6 +696,84 @@ pub export fn vk_texture_create_from_data(allocator: ?*types.VulkanAllocator, de
     return true;
 }
 
+/// Creates a sampled image with `layer_count` layers from `pixels` (mips largest first, the layers
+/// of each mip back to back) and waits for the upload. `cube` makes it a cube with a cube view.
+///
+/// Goes through a one-shot staging buffer; the staging ring only uploads single-layer images.
+pub fn create_layered_texture(allocator: ?*types.VulkanAllocator, device: c.VkDevice, commandPool: c.VkCommandPool, graphicsQueue: c.VkQueue, sync_manager: ?*types.VulkanSyncManager, pixels: []const u8, width: u32, height: u32, format: c.VkFormat, mip_levels: u32, layer_count: u32, cube: bool, textureImage: *c.VkImage, textureImageMemory: *c.VkDeviceMemory, textureImageView: *c.VkImageView, textureAllocation: *c.VmaAllocation) bool {
+    if (pixels.len == 0 or width == 0 or height == 0) return false;
+
+    var stagingBuffer: c.VkBuffer = null;
+    var stagingBufferMemory: c.VkDeviceMemory = null;
+    var stagingBufferAllocation: c.VmaAllocation = null;
+    if (!create_staging_buffer_from_bytes(allocator, pixels, @max(pixels.len, 4), &stagingBuffer, &stagingBufferMemory, &stagingBufferAllocation)) {
+        return false;
+    }
+
+    if (!create_layered_image_and_memory(allocator, width, height, format, mip_levels, layer_count, cube, &.{}, textureImage, textureImageMemory, textureAllocation)) {
+        vk_allocator.free_buffer(allocator, stagingBuffer, stagingBufferAllocation);
+        return false;
+    }
+
+    const commandBuffer = buffer_mgr.begin_single_time_commands(device, commandPool);
+    if (commandBuffer == null) {
+        vk_allocator.free_buffer(allocator, stagingBuffer, stagingBufferAllocation);
+        vk_allocator.free_image(allocator, textureImage.*, textureAllocation.*);
+        return false;
+    }
+
+    record_layered_copy_commands(commandBuffer, stagingBuffer, 0, textureImage.*, width, height, format, mip_levels, layer_count, c.VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, c.VK_ACCESS_2_SHADER_READ_BIT);
+
+    var timeline_value: u64 = 0;
+    if (c.vkEndCommandBuffer(commandBuffer) != c.VK_SUCCESS or !submit_texture_upload(device, graphicsQueue, commandBuffer, sync_manager, &timeline_value)) {
+        tex_utils_log.err("Failed to submit layered texture upload", .{});
+        c.vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+        vk_allocator.free_buffer(allocator, stagingBuffer, stagingBufferAllocation);
+        vk_allocator.free_image(allocator, textureImage.*, textureAllocation.*);
+        return false;
+    }
+
+    // submit_texture_upload waited for the copy, so the staging buffer is free to go.
+    c.vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+    vk_allocator.free_buffer(allocator, stagingBuffer, stagingBufferAllocation);
+
+    if (!create_layered_image_view(device, textureImage.*, textureImageView, format, layer_count, cube)) {
+        vk_allocator.free_image(allocator, textureImage.*, textureAllocation.*);
+        return false;
+    }
+    return true;
+}
+
+/// Creates a texture whose pixels go through the persistent staging ring instead of a one-shot
+/// staging buffer and command buffer.
+///
+/// Outside a ring batch the copy has completed on return; inside one it is ordered before the
+/// next frame submit. Either way there is no sync manager value to wait for, so
+/// `outTimelineValue` is set to 0.
+fn create_texture_from_ring(ring: *vk_staging_ring.StagingRing, allocator: ?*types.VulkanAllocator, device: c.VkDevice, texture: *const scene.CardinalTexture, format: c.VkFormat, mip_levels: u32, textureImage: *c.VkImage, textureImageMemory: *c.VkDeviceMemory, textureImageView: *c.VkImageView, textureAllocation: *c.VmaAllocation, outTimelineValue: ?*u64) bool {
+    if (!create_image_and_memory_shared(allocator, device, texture.width, texture.height, format, mip_levels, ring.queue_families(false), textureImage, textureImageMemory, textureAllocation)) {
+        return false;
+    }
+
+    const sizes = staging_size(texture);
+    const pixels = texture.data.?[0..sizes.copy];
+    if (!ring.upload_image(textureImage.*, texture.width, texture.height, format, mip_levels, pixels, sizes.staged)) {
+        tex_utils_log.err("Failed to stage texture upload", .{});
+        ring.wait_idle();
+        vk_allocator.free_image(allocator, textureImage.*, textureAllocation.*);
+        return false;
+    }
+
+    if (!create_texture_image_view(device, textureImage.*, textureImageView, format)) {
+        ring.wait_idle();
+        vk_allocator.free_image(allocator, textureImage.*, textureAllocation.*);
+        return false;
+    }
+
+    if (outTimelineValue) |out| out.* = 0;
+    return true;
+}
+
 fn submit_one_shot(device: c.VkDevice, queue: c.VkQueue, cmd: c.VkCommandBuffer, sync_manager: ?*types.VulkanSyncManager) bool {
     if (device == null or queue == null or cmd == null) return false;
     return submit_texture_upload(device, queue, cmd, sync_manager, null);
@@ -754,7 +920,7 @@ pub export fn vk_texture_create_sampler(device: c.VkDevice, physicalDevice: c.Vk
     samplerInfo.mipmapMode = c.VK_SAMPLER_MIPMAP_MODE_LINEAR;
     samplerInfo.mipLodBias = 0.0;
     samplerInfo.minLod = 0.0;
-    samplerInfo.maxLod = 0.0;
+    samplerInfo.maxLod = c.VK_LOD_CLAMP_NONE;
 
     if (c.vkCreateSampler(device, &samplerInfo, null, sampler) != c.VK_SUCCESS) {
         tex_utils_log.err("Failed to create texture sampler", .{});
@@ -0,0 +1,540 @@
+//! CPU visibility culling.
+//!
+//! A `CullSet` keeps world-space bounds structure-of-arrays (one array per min/max component) so
+//! `Culler.cull` can test `BATCH` boxes against the six frustum planes with one vector operation
+//! per plane. Large sets are split into chunks tested on the job system. Optionally, the largest
+//! visible occluders are rasterized into a small software depth buffer and the remaining
+//! candidates are tested against it. The result is a compact list of visible draws sorted by
+//! `sort_key` (pipeline, then material), so the renderer can record it with minimal state
+//! changes.
+//!
+//! Occlusion is conservative: an occluder is rasterized at its farthest depth, and an occludee's
+//! screen rectangle is widened by a pixel before it is tested, so objects are only rejected when
+//! the occluders cover them completely.
+const std = @import("std");
+const math = @import("../core/math.zig");
+const job_system = @import("../core/job_system.zig");
+
+/// Boxes tested per vector operation.
+pub const BATCH = 8;
+/// Boxes per culling job; a multiple of `BATCH`.
+pub const JOB_CHUNK: usize = 4096;
+/// Software depth buffer resolution used for occlusion culling.
+pub const DEPTH_WIDTH: usize = 256;
+pub const DEPTH_HEIGHT: usize = 128;
+
+const DEPTH_WIDTH_F: f32 = @floatFromInt(DEPTH_WIDTH);
+const DEPTH_HEIGHT_F: f32 = @floatFromInt(DEPTH_HEIGHT);
+
+const Lanes = @Vector(BATCH, f32);
+const LANE_BITS = @Vector(BATCH, u8){ 1, 2, 4, 8, 16, 32, 64, 128 };
+/// Clip-space `w` below which a corner counts as behind the camera.
+const NEAR_W: f32 = 1e-4;
+
+/// Packs a draw's pipeline and material into a key; visible draws are sorted by it.
+pub fn sort_key(pipeline: u32, material: u32) u64 {
+    return (@as(u64, pipeline) << 32) | material;
+}
+
+/// World-space bounds and sort keys of every cullable object. Indices are stable until `clear`.
+pub const CullSet = struct {
+    min_x: std.ArrayListUnmanaged(f32) = .{},
+    min_y: std.ArrayListUnmanaged(f32) = .{},
+    min_z: std.ArrayListUnmanaged(f32) = .{},
+    max_x: std.ArrayListUnmanaged(f32) = .{},
+    max_y: std.ArrayListUnmanaged(f32) = .{},
+    max_z: std.ArrayListUnmanaged(f32) = .{},
+    keys: std.ArrayListUnmanaged(u64) = .{},
+    /// Objects that may be rasterized as occluders.
+    occluders: std.ArrayListUnmanaged(u32) = .{},
+
+    pub fn deinit(self: *CullSet, allocator: std.mem.Allocator) void {
+        inline for (.{ "min_x", "min_y", "min_z", "max_x", "max_y", "max_z" }) |field| @field(self, field).deinit(allocator);
+        self.keys.deinit(allocator);
+        self.occluders.deinit(allocator);
+        self.* = .{};
+    }
+
+    /// Drops every object but keeps capacity.
+    pub fn clear(self: *CullSet) void {
+        inline for (.{ "min_x", "min_y", "min_z", "max_x", "max_y", "max_z" }) |field| @field(self, field).clearRetainingCapacity();
+        self.keys.clearRetainingCapacity();
+        self.occluders.clearRetainingCapacity();
+    }
+
+    pub fn ensure_capacity(self: *CullSet, allocator: std.mem.Allocator, count: usize) !void {
+        inline for (.{ "min_x", "min_y", "min_z", "max_x", "max_y", "max_z" }) |field| try @field(self, field).ensureTotalCapacity(allocator, count);
+        try self.keys.ensureTotalCapacity(allocator, count);
+    }
+
+    pub fn len(self: *const CullSet) usize {
+        return self.keys.items.len;
+    }
+
+    /// Adds an object and returns its index.
+    pub fn append(self: *CullSet, allocator: std.mem.Allocator, aabb: math.AABB, key: u64) !u32 {
+        try self.ensure_capacity(allocator, self.len() + 1);
+        const index: u32 = @intCast(self.len());
+        self.min_x.appendAssumeCapacity(aabb.min.x);
+        self.min_y.appendAssumeCapacity(aabb.min.y);
+        self.min_z.appendAssumeCapacity(aabb.min.z);
+        self.max_x.appendAssumeCapacity(aabb.max.x);
+        self.max_y.appendAssumeCapacity(aabb.max.y);
+        self.max_z.appendAssumeCapacity(aabb.max.z);
+        self.keys.appendAssumeCapacity(key);
+        return index;
+    }
+
+    /// Lets `index` occlude other objects. Its bounds should be mostly solid (walls, buildings,
+    /// terrain blocks); the whole box is treated as opaque.
+    pub fn mark_occluder(self: *CullSet, allocator: std.mem.Allocator, index: u32) !void {
+        try self.occluders.append(allocator, index);
+    }
+
+    pub fn set_bounds(self: *CullSet, index: u32, aabb: math.AABB) void {
+        self.min_x.items[index] = aabb.min.x;
+        self.min_y.items[index] = aabb.min.y;
+        self.min_z.items[index] = aabb.min.z;
+        self.max_x.items[index] = aabb.max.x;
+        self.max_y.items[index] = aabb.max.y;
+        self.max_z.items[index] = aabb.max.z;
+    }
+
+    pub fn bounds(self: *const CullSet, index: u32) math.AABB {
+        return .{
+            .min = .{ .x = self.min_x.items[index], .y = self.min_y.items[index], .z = self.min_z.items[index] },
+            .max = .{ .x = self.max_x.items[index], .y = self.max_y.items[index], .z = self.max_z.items[index] },
+        };
+    }
+};
+
+/// One visible object: its index in the `CullSet` and its sort key.
+pub const VisibleDraw = struct {
+    key: u64,
+    index: u32,
+
+    fn less_than(_: void, a: VisibleDraw, b: VisibleDraw) bool {
+        if (a.key != b.key) return a.key < b.key;
+        return a.index < b.index;
+    }
+};
+
+pub const Options = struct {
+    /// Test frustum-visible objects against a software depth buffer of the set's occluders.
+    occlusion: bool = false,
+    /// Split large sets across the job system (runs inline when it is not running).
+    use_jobs: bool = true,
+    /// Occluders rasterized per frame, largest on screen first.
+    max_occluders: usize = 64,
+};
+
+pub const Stats = struct {
+    tested: usize = 0,
+    frustum_visible: usize = 0,
+    occluders_drawn: usize = 0,
+    occluded: usize = 0,
+    visible: usize = 0,
+};
+
+/// Reusable culling state; keep one per view so steady-state culling does not allocate.
+pub const Culler = struct {
+    /// One byte per batch; bit `i` set when box `batch * BATCH + i` passed the frustum test.
+    mask: std.ArrayListUnmanaged(u8) = .{},
+    visible: std.ArrayListUnmanaged(VisibleDraw) = .{},
+    occluder_candidates: std.ArrayListUnmanaged(OccluderCandidate) = .{},
+    depth: []f32 = @as([]f32, &[_]f32{}),
+    stats: Stats = .{},
+
+    pub fn deinit(self: *Culler, allocator: std.mem.Allocator) void {
+        self.mask.deinit(allocator);
+        self.visible.deinit(allocator);
+        self.occluder_candidates.deinit(allocator);
+        if (self.depth.len > 0) allocator.free(self.depth);
+        self.* = .{};
+    }
+
+    /// Culls `set` against `view_proj` and returns the visible draws sorted by key, then index.
+    /// The slice stays valid until the next call.
+    pub fn cull(self: *Culler, allocator: std.mem.Allocator, set: *const CullSet, view_proj: math.Mat4, options: Options) ![]const VisibleDraw {
+        const count = set.len();
+        const batch_count = (count + BATCH - 1) / BATCH;
+        try self.mask.resize(allocator, batch_count);
+        try self.visible.ensureTotalCapacity(allocator, count);
+        self.visible.clearRetainingCapacity();
+        self.stats = .{ .tested = count };
+
+        const frustum = math.Frustum.fromMatrix(view_proj);
+        try frustum_pass(allocator, set, &frustum.planes, self.mask.items, options.use_jobs);
+
+        var occlusion = options.occlusion and set.occluders.items.len > 0;
+        if (occlusion) occlusion = try self.draw_occluders(allocator, set, view_proj, options.max_occluders);
+
+        for (self.mask.items, 0..) |batch_mask, batch| {
+            var bits = batch_mask;
+            while (bits != 0) : (bits &= bits - 1) {
+                const index: u32 = @intCast(batch * BATCH + @ctz(bits));
+                self.stats.frustum_visible += 1;
+                if (occlusion and self.is_occluded(set.bounds(index), view_proj)) {
+                    self.stats.occluded += 1;
+                    continue;
+                }
+                self.visible.appendAssumeCapacity(.{ .key = set.keys.items[index], .index = index });
+            }
+        }
+
+        std.sort.pdq(VisibleDraw, self.visible.items, {}, VisibleDraw.less_than);
+        self.stats.visible = self.visible.items.len;
+        return self.visible.items;
+    }
+
+    /// Rasterizes the largest frustum-visible occluders. Returns false when none were drawn.
+    fn draw_occluders(self: *Culler, allocator: std.mem.Allocator, set: *const CullSet, view_proj: math.Mat4, max_occluders: usize) !bool {
+        if (self.depth.len == 0) self.depth = try allocator.alloc(f32, DEPTH_WIDTH * DEPTH_HEIGHT);
+
+        self.occluder_candidates.clearRetainingCapacity();
+        for (set.occluders.items) |index| {
+            if (self.mask.items[index / BATCH] & (@as(u8, 1) << @intCast(index % BATCH)) == 0) continue;
+            const projected = ProjectedBox.init(set.bounds(index), view_proj) orelse continue;
+            try self.occluder_candidates.append(allocator, .{ .box = projected, .area = projected.screen_area() });
+        }
+        if (self.occluder_candidates.items.len == 0) return false;
+        std.sort.pdq(OccluderCandidate, self.occluder_candidates.items, {}, OccluderCandidate.larger);
+
+        @memset(self.depth, std.math.inf(f32));
+        const drawn = @min(self.occluder_candidates.items.len, max_occluders);
+        for (self.occluder_candidates.items[0..drawn]) |candidate| self.raster_box(&candidate.box);
+        self.stats.occluders_drawn = drawn;
+        return drawn > 0;
+    }
+
+    fn raster_box(self: *Culler, box: *const ProjectedBox) void {
+        // Corner `i` has max x/y/z where bits 0/1/2 of `i` are set. Every face as two triangles;
+        // together they cover the box's silhouette.
+        const faces = [6][4]u3{
+            .{ 0, 2, 6, 4 }, .{ 1, 3, 7, 5 },
+            .{ 0, 1, 5, 4 }, .{ 2, 3, 7, 6 },
+            .{ 0, 1, 3, 2 }, .{ 4, 5, 7, 6 },
+        };
+        for (faces) |f| {
+            self.raster_triangle(box.screen[f[0]], box.screen[f[1]], box.screen[f[2]], box.max_depth);
+            self.raster_triangle(box.screen[f[0]], box.screen[f[2]], box.screen[f[3]], box.max_depth);
+        }
+    }
+
+    /// Writes `depth` to every pixel whose centre the triangle covers, keeping the nearest.
+    fn raster_triangle(self: *Culler, a: [2]f32, b_in: [2]f32, c_in: [2]f32, depth: f32) void {
+        var b = b_in;
+        var c = c_in;
+        const area = edge(a, b, c);
+        if (area == 0.0) return;
+        if (area < 0.0) std.mem.swap([2]f32, &b, &c);
+
+        const x0 = pixel_floor(@min(a[0], @min(b[0], c[0])), DEPTH_WIDTH);
+        const x1 = pixel_floor(@max(a[0], @max(b[0], c[0])), DEPTH_WIDTH);
+        const y0 = pixel_floor(@min(a[1], @min(b[1], c[1])), DEPTH_HEIGHT);
+        const y1 = pixel_floor(@max(a[1], @max(b[1], c[1])), DEPTH_HEIGHT);
+
+        var y = y0;
+        while (y <= y1) : (y += 1) {
+            const py = @as(f32, @floatFromInt(y)) + 0.5;
+            const row = self.depth[y * DEPTH_WIDTH ..][0..DEPTH_WIDTH];
+            var x = x0;
+            while (x <= x1) : (x += 1) {
+                const p = [2]f32{ @as(f32, @floatFromInt(x)) + 0.5, py };
+                if (edge(a, b, p) >= 0.0 and edge(b, c, p) >= 0.0 and edge(c, a, p) >= 0.0) {
+                    row[x] = @min(row[x], depth);
+                }
+            }
+        }
+    }
+
+    fn is_occluded(self: *const Culler, bounds: math.AABB, view_proj: math.Mat4) bool {
+        const box = ProjectedBox.init(bounds, view_proj) orelse return false;
+        const x0 = pixel_floor(box.rect_min[0] - 1.0, DEPTH_WIDTH);
+        const x1 = pixel_floor(box.rect_max[0] + 1.0, DEPTH_WIDTH);
+        const y0 = pixel_floor(box.rect_min[1] - 1.0, DEPTH_HEIGHT);
+        const y1 = pixel_floor(box.rect_max[1] + 1.0, DEPTH_HEIGHT);
+
+        var y = y0;
+        while (y <= y1) : (y += 1) {
+            const row = self.depth[y * DEPTH_WIDTH ..][0..DEPTH_WIDTH];
+            for (row[x0 .. x1 + 1]) |occluder_depth| {
+                if (occluder_depth >= box.min_depth) return false;
+            }
+        }
+        return true;
+    }
+};
+
+const OccluderCandidate = struct {
+    box: ProjectedBox,
+    area: f32,
+
+    fn larger(_: void, a: OccluderCandidate, b: OccluderCandidate) bool {
+        return a.area > b.area;
+    }
+};
+
+/// A box projected into depth-buffer pixels.
+const ProjectedBox = struct {
+    screen: [8][2]f32,
+    rect_min: [2]f32,
+    rect_max: [2]f32,
+    /// Nearest and farthest normalized depth of the corners.
+    min_depth: f32,
+    max_depth: f32,
+
+    /// Returns null when part of the box is behind the camera.
+    fn init(bounds: math.AABB, view_proj: math.Mat4) ?ProjectedBox {
+        var box = ProjectedBox{
+            .screen = undefined,
+            .rect_min = .{ std.math.inf(f32), std.math.inf(f32) },
+            .rect_max = .{ -std.math.inf(f32), -std.math.inf(f32) },
+            .min_depth = std.math.inf(f32),
+            .max_depth = -std.math.inf(f32),
+        };
+        for (&box.screen, 0..) |*screen, i| {
+            const corner = math.Vec4{
+                .x = if (i & 1 != 0) bounds.max.x else bounds.min.x,
+                .y = if (i & 2 != 0) bounds.max.y else bounds.min.y,
+                .z = if (i & 4 != 0) bounds.max.z else bounds.min.z,
+                .w = 1.0,
+            };
+            const clip = view_proj.mulVec4(corner);
+            if (clip.w <= NEAR_W) return null;
+            const inv_w = 1.0 / clip.w;
+            screen.* = .{
+                (clip.x * inv_w * 0.5 + 0.5) * DEPTH_WIDTH_F,
+                (clip.y * inv_w * 0.5 + 0.5) * DEPTH_HEIGHT_F,
+            };
+            const depth = clip.z * inv_w;
+            box.rect_min = .{ @min(box.rect_min[0], screen[0]), @min(box.rect_min[1], screen[1]) };
+            box.rect_max = .{ @max(box.rect_max[0], screen[0]), @max(box.rect_max[1], screen[1]) };
+            box.min_depth = @min(box.min_depth, depth);
+            box.max_depth = @max(box.max_depth, depth);
+        }
+        return box;
+    }
+
+    fn screen_area(self: *const ProjectedBox) f32 {
+        const w = std.math.clamp(self.rect_max[0], 0.0, DEPTH_WIDTH_F) - std.math.clamp(self.rect_min[0], 0.0, DEPTH_WIDTH_F);
+        const h = std.math.clamp(self.rect_max[1], 0.0, DEPTH_HEIGHT_F) - std.math.clamp(self.rect_min[1], 0.0, DEPTH_HEIGHT_F);
+        return w * h;
+    }
+};
+
+fn edge(a: [2]f32, b: [2]f32, p: [2]f32) f32 {
+    return (b[0] - a[0]) * (p[1] - a[1]) - (b[1] - a[1]) * (p[0] - a[0]);
+}
+
+/// Pixel containing coordinate `v`, clamped to `[0, size - 1]`.
+fn pixel_floor(v: f32, comptime size: usize) usize {
+    const clamped = std.math.clamp(v, 0.0, @as(f32, @floatFromInt(size - 1)));
+    return @intFromFloat(@floor(clamped));
+}
+
+inline fn load_lanes(values: []const f32, first: usize) Lanes {
+    if (first + BATCH <= values.len) return values[first..][0..BATCH].*;
+    var tail = [_]f32{0.0} ** BATCH;
+    @memcpy(tail[0 .. values.len - first], values[first..]);
+    return tail;
+}
+
+/// Frustum-tests batches `[first_batch, first_batch + mask.len)` and writes one mask byte each.
+fn cull_batches(set: *const CullSet, planes: *const [6]math.Plane, first_batch: usize, mask: []u8) void {
+    const count = set.len();
+    const zero: Lanes = @splat(0.0);
+    const none: @Vector(BATCH, u8) = @splat(0);
+    for (mask, first_batch..) |*out, batch| {
+        const first = batch * BATCH;
+        const min_x = load_lanes(set.min_x.items, first);
+        const min_y = load_lanes(set.min_y.items, first);
+        const min_z = load_lanes(set.min_z.items, first);
+        const max_x = load_lanes(set.max_x.items, first);
+        const max_y = load_lanes(set.max_y.items, first);
+        const max_z = load_lanes(set.max_z.items, first);
+
+        var inside: @Vector(BATCH, bool) = @splat(true);
+        for (planes) |p| {
+            // The corner farthest along the plane normal decides; it is the same for every box.
+            const px = if (p.n.x >= 0.0) max_x else min_x;
+            const py = if (p.n.y >= 0.0) max_y else min_y;
+            const pz = if (p.n.z >= 0.0) max_z else min_z;
+            const dist = px * @as(Lanes, @splat(p.n.x)) + py * @as(Lanes, @splat(p.n.y)) + pz * @as(Lanes, @splat(p.n.z)) + @as(Lanes, @splat(p.d));
+            inside = @select(bool, dist >= zero, inside, @as(@Vector(BATCH, bool), @splat(false)));
+        }
+
+        var bits = @reduce(.Or, @select(u8, inside, LANE_BITS, none));
+        if (count - first < BATCH) bits &= @as(u8, @truncate((@as(u16, 1) << @intCast(count - first)) - 1));
+        out.* = bits;
+    }
+}
+
+const CullJob = struct {
+    set: *const CullSet,
+    planes: *const [6]math.Plane,
+    first_batch: usize,
+    mask: []u8,
+
+    fn run(data: ?*anyopaque) callconv(.c) i32 {
+        const self: *CullJob = @ptrCast(@alignCast(data.?));
+        cull_batches(self.set, self.planes, self.first_batch, self.mask);
+        return 0;
+    }
+};
+
+fn frustum_pass(allocator: std.mem.Allocator, set: *const CullSet, planes: *const [6]math.Plane, mask: []u8, use_jobs: bool) !void {
+    const batches_per_job = JOB_CHUNK / BATCH;
+    const job_count = (mask.len + batches_per_job - 1) / batches_per_job;
+    if (!use_jobs or job_count < 2) {
+        cull_batches(set, planes, 0, mask);
+        return;
+    }
+
+    const work = try allocator.alloc(CullJob, job_count);
+    defer allocator.free(work);
+    var jobs = std.ArrayListUnmanaged(*job_system.Job){};
+    defer jobs.deinit(allocator);
+    try jobs.ensureTotalCapacity(allocator, job_count);
+
+    for (work, 0..) |*w, i| {
+        const first = i * batches_per_job;
+        w.* = .{ .set = set, .planes = planes, .first_batch = first, .mask = mask[first..@min(first + batches_per_job, mask.len)] };
+    }
+    // Keep the first chunk for this thread.
+    for (work[1..]) |*w| {
+        const job = job_system.create_job(CullJob.run, w, .HIGH) orelse {
+            _ = CullJob.run(w);
+            continue;
+        };
+        job.push_to_completed_queue = false;
+        while (!job_system.submit_job(job)) {
+            std.Thread.yield() catch {};
+        }
+        jobs.appendAssumeCapacity(job);
+    }
+    _ = CullJob.run(&work[0]);
+    job_system.wait_for_jobs(jobs.items);
+    for (jobs.items) |job| job_system.free_job(job);
+}
+
+/// Buildings on a grid with small props scattered between them; used by tests and benchmarks.
+pub const SyntheticCity = struct {
+    set: CullSet = .{},
+    buildings: usize = 0,
+
+    /// `blocks` x `blocks` buildings 8 m apart, each with `props_per_block` props around it.
+    /// Buildings are occluders; keys spread objects over four pipelines and 32 materials.
+    pub fn init(allocator: std.mem.Allocator, blocks: usize, props_per_block: usize, seed: u64) !SyntheticCity {
+        var city = SyntheticCity{};
+        errdefer city.set.deinit(allocator);
+        try city.set.ensure_capacity(allocator, blocks * blocks * (1 + props_per_block));
+
+        var prng = std.Random.DefaultPrng.init(seed);
+        const random = prng.random();
+        const half = @as(f32, @floatFromInt(blocks)) * 4.0;
+        for (0..blocks) |bz| {
+            for (0..blocks) |bx| {
+                const cx = @as(f32, @floatFromInt(bx)) * 8.0 - half;
+                const cz = @as(f32, @floatFromInt(bz)) * 8.0 - half;
+                const height = 6.0 + random.float(f32) * 30.0;
+                const building = try city.set.append(allocator, .{
+                    .min = .{ .x = cx - 2.5, .y = 0.0, .z = cz - 2.5 },
+                    .max = .{ .x = cx + 2.5, .y = height, .z = cz + 2.5 },
+                }, sort_key(0, random.uintLessThan(u32, 32)));
+                try city.set.mark_occluder(allocator, building);
+                city.buildings += 1;
+
+                for (0..props_per_block) |_| {
+                    const px = cx + (random.float(f32) - 0.5) * 7.5;
+                    const pz = cz + (random.float(f32) - 0.5) * 7.5;
+                    const size = 0.2 + random.float(f32) * 0.6;
+                    _ = try city.set.append(allocator, .{
+                        .min = .{ .x = px - size, .y = 0.0, .z = pz - size },
+                        .max = .{ .x = px + size, .y = size * 2.0, .z = pz + size },
+                    }, sort_key(1 + random.uintLessThan(u32, 3), random.uintLessThan(u32, 32)));
+                }
+            }
+        }
+        return city;
+    }
+
+    pub fn deinit(self: *SyntheticCity, allocator: std.mem.Allocator) void {
+        self.set.deinit(allocator);
+    }
+
+    /// A street-level camera looking along +X down the city.
+    pub fn street_view_projection() math.Mat4 {
+        const view = math.Mat4.lookAt(.{ .x = -200.0, .y = 1.7, .z = 4.0 }, .{ .x = 0.0, .y = 1.7, .z = 4.0 }, .{ .x = 0.0, .y = 1.0, .z = 0.0 });
+        const proj = math.Mat4.perspective(std.math.degreesToRadians(70.0), 16.0 / 9.0, 0.1, 1000.0);
+        return proj.mul(view);
+    }
+};
+
+fn reference_visible(set: *const CullSet, frustum: math.Frustum, index: u32) bool {
+    const b = set.bounds(index);
+    for (frustum.planes) |p| {
+        const px = if (p.n.x >= 0.0) b.max.x else b.min.x;
+        const py = if (p.n.y >= 0.0) b.max.y else b.min.y;
+        const pz = if (p.n.z >= 0.0) b.max.z else b.min.z;
+        if (px * p.n.x + py * p.n.y + pz * p.n.z + p.d < 0.0) return false;
+    }
+    return true;
+}
+
+test "batched frustum culling matches the scalar test and sorts by key" {
+    const allocator = std.testing.allocator;
+    var city = try SyntheticCity.init(allocator, 24, 5, 42);
+    defer city.deinit(allocator);
+    // Not a multiple of BATCH, so the tail batch is exercised.
+    _ = try city.set.append(allocator, .{ .min = .{ .x = -190.0, .y = 0.0, .z = 3.0 }, .max = .{ .x = -189.0, .y = 1.0, .z = 5.0 } }, sort_key(4, 0));
+
+    const view_proj = SyntheticCity.street_view_projection();
+    const frustum = math.Frustum.fromMatrix(view_proj);
+
+    var culler = Culler{};
+    defer culler.deinit(allocator);
+    const visible = try culler.cull(allocator, &city.set, view_proj, .{ .use_jobs = false });
+
+    var expected: usize = 0;
+    for (0..city.set.len()) |i| {
+        if (reference_visible(&city.set, frustum, @intCast(i))) expected += 1;
+    }
+    try std.testing.expectEqual(expected, visible.len);
+    try std.testing.expect(visible.len > 0 and visible.len < city.set.len());
+    for (visible) |draw| try std.testing.expect(reference_visible(&city.set, frustum, draw.index));
+    for (visible[1..], visible[0 .. visible.len - 1]) |b, a| try std.testing.expect(!VisibleDraw.less_than({}, b, a));
+    try std.testing.expectEqual(city.set.len() - 1, visible[visible.len - 1].index);
+}
+
+test "occlusion culling rejects only fully hidden objects" {
+    const allocator = std.testing.allocator;
+    var set = CullSet{};
+    defer set.deinit(allocator);
+
+    // Camera at the origin looking down -Z; a wall at z = -10 hides what is straight behind it.
+    const wall = try set.append(allocator, .{ .min = .{ .x = -5.0, .y = -5.0, .z = -11.0 }, .max = .{ .x = 5.0, .y = 5.0, .z = -10.0 } }, sort_key(0, 0));
+    try set.mark_occluder(allocator, wall);
+    const hidden = try set.append(allocator, .{ .min = .{ .x = -1.0, .y = -1.0, .z = -31.0 }, .max = .{ .x = 1.0, .y = 1.0, .z = -30.0 } }, sort_key(0, 1));
+    const beside = try set.append(allocator, .{ .min = .{ .x = 20.0, .y = -1.0, .z = -31.0 }, .max = .{ .x = 22.0, .y = 1.0, .z = -30.0 } }, sort_key(0, 1));
+    const in_front = try set.append(allocator, .{ .min = .{ .x = -0.5, .y = -0.5, .z = -6.0 }, .max = .{ .x = 0.5, .y = 0.5, .z = -5.0 } }, sort_key(0, 1));
+    // Straddles the wall's silhouette, so part of it shows.
+    const peeking = try set.append(allocator, .{ .min = .{ .x = 3.0, .y = -1.0, .z = -31.0 }, .max = .{ .x = 30.0, .y = 1.0, .z = -30.0 } }, sort_key(0, 1));
+
+    const view = math.Mat4.lookAt(math.Vec3.zero(), .{ .x = 0.0, .y = 0.0, .z = -1.0 }, .{ .x = 0.0, .y = 1.0, .z = 0.0 });
+    const proj = math.Mat4.perspective(std.math.degreesToRadians(90.0), 2.0, 0.1, 100.0);
+    const view_proj = proj.mul(view);
+
+    var culler = Culler{};
+    defer culler.deinit(allocator);
+    const without = try culler.cull(allocator, &set, view_proj, .{});
+    try std.testing.expectEqual(@as(usize, 5), without.len);
+
+    const with = try culler.cull(allocator, &set, view_proj, .{ .occlusion = true });
+    try std.testing.expectEqual(@as(usize, 1), culler.stats.occluders_drawn);
+    try std.testing.expectEqual(@as(usize, 1), culler.stats.occluded);
+    for (with) |draw| try std.testing.expect(draw.index != hidden);
+    var found = [_]bool{false} ** 5;
+    for (with) |draw| found[draw.index] = true;
+    try std.testing.expect(found[wall] and found[beside] and found[in_front] and found[peeking]);
+}
@@ -1,13 +1,17 @@
 //! Vulkan buffer lifecycle helpers.
 //!
 //! Provides utilities for creating, uploading to, and destroying Vulkan buffers using VMA and
-//! timeline-semaphore synchronization via the centralized sync manager.
+//! timeline-semaphore synchronization via the centralized sync manager. Device-local uploads go
+//! through the persistent staging ring when one is active and fall back to a one-shot staging
+//! buffer otherwise.
 const std = @import("std");
 const builtin = @import("builtin");
 const log = @import("../core/log.zig");
 const types = @import("vulkan_types.zig");
 const vk_allocator = @import("vulkan_allocator.zig");
 const vk_sync_manager = @import("vulkan_sync_manager.zig");
+const profiler = @import("../core/profiler.zig");
+const vk_staging_ring = @import("vulkan_staging_ring.zig");
 
 const buf_log = log.ScopedLogger("BUF_MGR");
 
@@ -88,10 +92,12 @@ pub export fn vk_buffer_create(buffer_ptr: ?*VulkanBuffer, device: c.VkDevice, a
         return false;
     }
 
-    const buffer = buffer_ptr.?;
-    const allocator = allocator_ptr.?;
-    const createInfo = createInfo_ptr.?;
+    return create_buffer(buffer_ptr.?, allocator_ptr.?, createInfo_ptr.?, &.{});
+}
 
+/// Body of `vk_buffer_create`. Naming more than one family in `queue_families` creates the buffer
+/// with concurrent sharing between them.
+fn create_buffer(buffer: *VulkanBuffer, allocator: *types.VulkanAllocator, createInfo: *const VulkanBufferCreateInfo, queue_families: []const u32) bool {
     if (createInfo.size == 0) {
         buf_log.err("Buffer size cannot be zero", .{});
         return false;
@@ -103,7 +109,13 @@ pub export fn vk_buffer_create(buffer_ptr: ?*VulkanBuffer, device: c.VkDevice, a
     bufferInfo.sType = c.VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size = createInfo.size;
     bufferInfo.usage = createInfo.usage;
-    bufferInfo.sharingMode = c.VK_SHARING_MODE_EXCLUSIVE;
+    if (queue_families.len > 1) {
+        bufferInfo.sharingMode = c.VK_SHARING_MODE_CONCURRENT;
+        bufferInfo.queueFamilyIndexCount = @intCast(queue_families.len);
+        bufferInfo.pQueueFamilyIndices = queue_families.ptr;
+    } else {
+        bufferInfo.sharingMode = c.VK_SHARING_MODE_EXCLUSIVE;
+    }
 
     if (!vk_allocator.allocate_buffer(allocator, &bufferInfo, &buffer.handle, &buffer.memory, &buffer.allocation, createInfo.properties, createInfo.persistentlyMapped, &buffer.mapped)) {
         buf_log.err("Failed to create and allocate buffer", .{});
@@ -277,6 +289,8 @@ pub export fn vk_buffer_upload_data(buffer_ptr: ?*VulkanBuffer, device: c.VkDevi
         }
     }
 
+    profiler.count(.uploads, 1);
+    profiler.count(.upload_bytes, size);
     return true;
 }
 
@@ -334,6 +348,10 @@ pub export fn vk_buffer_create_device_local(buffer_ptr: ?*VulkanBuffer, device:
     const buffer = buffer_ptr.?;
     const allocator = allocator_ptr.?; // Assuming allocator is required here as we use it
 
+    if (vk_staging_ring.active()) |ring| {
+        return create_device_local_from_ring(ring, buffer, device, allocator, data.?, size, usage);
+    }
+
     var stagingInfo = std.mem.zeroes(VulkanBufferCreateInfo);
     stagingInfo.size = size;
     stagingInfo.usage = c.VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
@@ -376,6 +394,32 @@ pub export fn vk_buffer_create_device_local(buffer_ptr: ?*VulkanBuffer, device:
     return true;
 }
 
+/// Creates the device-local buffer and records its upload into the staging ring; see
+/// `StagingRing.upload_buffer` for when the copy is submitted.
+fn create_device_local_from_ring(ring: *vk_staging_ring.StagingRing, buffer: *VulkanBuffer, device: c.VkDevice, allocator: *types.VulkanAllocator, data: *const anyopaque, size: c.VkDeviceSize, usage: c.VkBufferUsageFlags) bool {
+    var deviceBufferInfo = std.mem.zeroes(VulkanBufferCreateInfo);
+    deviceBufferInfo.size = size;
+    deviceBufferInfo.usage = @as(c.VkBufferUsageFlags, c.VK_BUFFER_USAGE_TRANSFER_DST_BIT) | usage;
+    deviceBufferInfo.properties = c.VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    deviceBufferInfo.persistentlyMapped = false;
+
+    const compute_access = (usage & c.VK_BUFFER_USAGE_STORAGE_BUFFER_BIT) != 0;
+    if (!create_buffer(buffer, allocator, &deviceBufferInfo, ring.queue_families(compute_access))) {
+        buf_log.err("Failed to create device local buffer", .{});
+        return false;
+    }
+
+    const bytes = @as([*]const u8, @ptrCast(data))[0..@intCast(size)];
+    if (!ring.upload_buffer(buffer.handle, 0, bytes)) {
+        buf_log.err("Failed to stage device local buffer upload", .{});
+        ring.wait_idle();
+        vk_buffer_destroy_immediate(buffer, device, allocator);
+        return false;
+    }
+
+    return true;
+}
+
 pub export fn vk_buffer_create_vertex(buffer: ?*VulkanBuffer, device: c.VkDevice, allocator: ?*types.VulkanAllocator, commandPool: c.VkCommandPool, queue: c.VkQueue, vertices: ?*const anyopaque, vertexSize: c.VkDeviceSize, vulkan_state: ?*types.VulkanState) callconv(.c) bool {
     if (vertices == null or vertexSize == 0) {
         buf_log.err("Invalid vertex data for buffer creation", .{});
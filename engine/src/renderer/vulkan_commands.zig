@@ -19,6 +19,7 @@ const vk_mesh_shader = @import("vulkan_mesh_shader.zig");
 const vk_simple_pipelines = @import("vulkan_simple_pipelines.zig");
 const vk_sync_manager = @import("vulkan_sync_manager.zig");
 const render_graph = @import("render_graph.zig");
+const vk_graph_submit = @import("vulkan_graph_submit.zig");
 const vk_shadows = @import("vulkan_shadows.zig");
 const vk_ssao = @import("vulkan_ssao.zig");
 const stack_allocator = @import("../core/stack_allocator.zig");
@@ -468,6 +469,24 @@ fn end_recording(s: *types.VulkanState, cmd: c.VkCommandBuffer, image_index: u32
 /// Updates per-frame uniform state for the active rendering mode.
 fn vk_update_frame_uniforms(s: *types.VulkanState) void {
     if (s.pipelines.use_pbr_pipeline and s.pipelines.pbr_pipeline.initialized) {
+        // The skybox's baked irradiance replaces the flat ambient color when there is one, and its
+        // prefiltered specular chain adds the split-sum reflection term.
+        const skybox = &s.pipelines.skybox_pipeline;
+        const pbr = &s.pipelines.pbr_pipeline;
+        const ubo = &pbr.current_ubo;
+        const baked = s.pipelines.use_skybox_pipeline and skybox.initialized and skybox.hasEnvironmentSH;
+        vk_pbr.vk_pbr_update_environment(pbr, s.context.device, &s.allocator, s.commands.pools.?[0], s.context.graphics_queue, s.sync_manager, if (baked) skybox.environmentKey else 0, s.sync.current_frame);
+        if (baked) {
+            ubo.environmentParams = .{ 1.0, 0.0, 0.0, 0.0 };
+            ubo.environmentSH = skybox.environmentSH;
+        } else {
+            ubo.environmentParams = .{ 0.0, 0.0, 0.0, 0.0 };
+        }
+        if (pbr.iblSpecularBaked) {
+            ubo.environmentParams[1] = 1.0;
+            ubo.environmentParams[2] = @floatFromInt(pbr.iblSpecular.mip_levels - 1);
+        }
+
         vk_pbr.vk_pbr_update_uniforms(&s.pipelines.pbr_pipeline, &s.pipelines.pbr_pipeline.current_ubo, &s.pipelines.pbr_pipeline.current_lighting, s.sync.current_frame);
 
         if (s.current_rendering_mode == .UV or s.current_rendering_mode == .WIREFRAME) {
@@ -646,6 +665,7 @@ pub export fn vk_create_commands_sync(s: ?*types.VulkanState) callconv(.c) bool
     }
 
     if (!create_sync_objects(vs)) return false;
+    vk_graph_submit.init(vs);
 
     vs.sync.current_frame_value = 0;
     vs.sync.image_available_value = 1;
@@ -697,6 +717,7 @@ pub export fn vk_destroy_commands_sync(s: ?*types.VulkanState) callconv(.c) void
     if (vs.context.device != null) {
         _ = c.vkDeviceWaitIdle(vs.context.device);
     }
+    vk_graph_submit.deinit(vs);
 
     if (vs.sync.timeline_semaphore != null) {
         c.vkDestroySemaphore(vs.context.device, vs.sync.timeline_semaphore, null);
@@ -813,6 +834,7 @@ pub export fn vk_record_cmd(s: ?*types.VulkanState, image_index: u32) callconv(.
     const vs = s.?;
 
     vs.current_image_index = image_index;
+    vk_graph_submit.reset();
 
     vk_update_frame_uniforms(vs);
 
@@ -918,7 +940,9 @@ pub export fn vk_record_cmd(s: ?*types.VulkanState, image_index: u32) callconv(.
             };
         }
 
-        if (vs.pipelines.use_pbr_pipeline and vs.pipelines.pbr_pipeline.shadowMapImage != null) {
+        // Cached shadow cascades are reused from earlier frames, so keep the tracked layout
+        // instead of discarding the contents.
+        if (vs.pipelines.use_pbr_pipeline and vs.pipelines.pbr_pipeline.shadowMapImage != null and !vk_shadows.shadow_map_preserved()) {
             const shadow_state = render_graph.ResourceState{
                 .access_mask = 0,
                 .stage_mask = c.VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
@@ -929,7 +953,7 @@ pub export fn vk_record_cmd(s: ?*types.VulkanState, image_index: u32) callconv(.
             };
         }
 
-        rg.execute(cmd, null, vs);
+        if (!vk_graph_submit.record(vs, rg, cmd)) rg.execute(cmd, vs);
     } else {
         cmd_log.err("RenderGraph is null! Cannot record scene.", .{});
     }
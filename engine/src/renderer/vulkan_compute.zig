@@ -155,7 +155,7 @@ fn create_compute_shader_module_and_reflect(vs: *types.VulkanState, cfg: *const
         return false;
     }
 
-    const reflect = shader_utils.reflection.reflect_shader(alloc, code, c.VK_SHADER_STAGE_COMPUTE_BIT) catch |err| {
+    const reflect = shader_utils.reflection_cache.reflect(alloc, code, c.VK_SHADER_STAGE_COMPUTE_BIT, .{}) catch |err| {
         compute_log.err("Failed to reflect shader: {s}", .{@errorName(err)});
         c.vkDestroyShaderModule(vs.context.device, out_shader.*, null);
         out_shader.* = null;
@@ -19,6 +19,7 @@ const vk_mesh_shader = @import("vulkan_mesh_shader.zig");
 const vk_simple_pipelines = @import("vulkan_simple_pipelines.zig");
 const vk_post_process = @import("vulkan_post_process.zig");
 const vk_renderer = @import("vulkan_renderer.zig");
+const vk_staging_ring = @import("vulkan_staging_ring.zig");
 
 const FailurePoint = enum {
     device,
@@ -103,6 +104,7 @@ pub fn recover_from_device_loss(s: *types.VulkanState) bool {
     vk_post_process.vk_post_process_destroy(s);
     vk_pipeline.vk_destroy_pipeline(s);
 
+    vk_staging_ring.uninstall();
     vk_commands.vk_destroy_commands_sync(@ptrCast(s));
 
     vk_swapchain.vk_destroy_swapchain(s);
@@ -130,6 +132,10 @@ pub fn recover_from_device_loss(s: *types.VulkanState) bool {
         success = false;
     }
 
+    if (success) {
+        _ = vk_staging_ring.install(s);
+    }
+
     if (success and !vk_simple_pipelines.vk_create_simple_pipelines(s, null)) {
         failure_point = .simple_pipelines;
         success = false;
@@ -27,3 +27,5 @@ pub const VK_FORMAT_BC6H_SFLOAT_BLOCK: u32 = @intCast(c.VK_FORMAT_BC6H_SFLOAT_BL
 pub const VK_FORMAT_BC7_UNORM_BLOCK: u32 = @intCast(c.VK_FORMAT_BC7_UNORM_BLOCK);
 pub const VK_FORMAT_BC7_SRGB_BLOCK: u32 = @intCast(c.VK_FORMAT_BC7_SRGB_BLOCK);
 pub const VK_FORMAT_R32G32B32A32_SFLOAT: u32 = @intCast(c.VK_FORMAT_R32G32B32A32_SFLOAT);
+pub const VK_FORMAT_R16G16B16A16_SFLOAT: u32 = @intCast(c.VK_FORMAT_R16G16B16A16_SFLOAT);
+pub const VK_FORMAT_R16G16_SFLOAT: u32 = @intCast(c.VK_FORMAT_R16G16_SFLOAT);
@@ -0,0 +1,257 @@
+//! Multi-queue submission of the render graph.
+//!
+//! When the graph is compiled with `async_compute` and the device has a compute queue separate
+//! from the graphics queue, `record` runs `RenderGraph.execute_async` instead of `execute`. Each
+//! submit batch of the plan gets its own command buffer, except the last graphics batch, which is
+//! recorded into the frame's primary command buffer. Submission is deferred: the frame submits
+//! the `pending` batches once its uploads are flushed, then adds `final_waits` and `final_signal`
+//! to its own submit, so the acquire semaphore, present semaphore and in-flight fence stay on
+//! one submission.
+//!
+//! Each queue signals its own timeline semaphore. Plan values are relative to the frame; a
+//! per-queue base that every recorded frame advances turns them into absolute values.
+const std = @import("std");
+const log = @import("../core/log.zig");
+const types = @import("vulkan_types.zig");
+const render_graph = @import("render_graph.zig");
+
+const c = @import("vulkan_c.zig").c;
+
+const submit_log = log.ScopedLogger("GRAPH_SUBMIT");
+
+/// Command buffers per queue and frame in flight. Plans with more batches run on one queue.
+const MAX_BATCHES: u32 = 4;
+const MAX_FRAMES: u32 = 3;
+
+/// One recorded batch waiting to be submitted, with absolute timeline values.
+pub const Batch = struct {
+    queue: render_graph.Queue,
+    cmd: c.VkCommandBuffer,
+    wait: ?render_graph.TimelineWait,
+    signal_value: u64,
+};
+
+const State = struct {
+    device: c.VkDevice = null,
+    /// Graphics and compute timelines, indexed by `render_graph.Queue`.
+    timelines: [2]c.VkSemaphore = .{ null, null },
+    /// Last value reserved on each timeline.
+    values: [2]u64 = .{ 0, 0 },
+    buffers: [2][MAX_FRAMES][MAX_BATCHES]c.VkCommandBuffer = std.mem.zeroes([2][MAX_FRAMES][MAX_BATCHES]c.VkCommandBuffer),
+
+    // Current frame.
+    active: bool = false,
+    frame: u32 = 0,
+    frame_cmd: c.VkCommandBuffer = null,
+    base: [2]u64 = .{ 0, 0 },
+    used: [2]u32 = .{ 0, 0 },
+    graphics_left: u32 = 0,
+    pending: [2 * MAX_BATCHES]Batch = undefined,
+    pending_count: u32 = 0,
+    final_wait: ?render_graph.TimelineWait = null,
+    final_signal: u64 = 0,
+    /// Value the compute timeline reaches once this frame's compute batches finish; 0 if none.
+    compute_tail: u64 = 0,
+};
+
+var g_state: State = .{};
+
+/// Creates the timelines and per-frame command buffers. Leaves multi-queue submission off when
+/// the device shares one queue for graphics and compute.
+pub fn init(s: *types.VulkanState) void {
+    deinit(s);
+    if (s.context.compute_queue == null or s.context.compute_queue == s.context.graphics_queue) return;
+    if (s.commands.pools == null or s.commands.compute_transient_pools == null) return;
+    if (s.sync.max_frames_in_flight > MAX_FRAMES) return;
+
+    var timeline_type_info = std.mem.zeroes(c.VkSemaphoreTypeCreateInfo);
+    timeline_type_info.sType = c.VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    timeline_type_info.semaphoreType = c.VK_SEMAPHORE_TYPE_TIMELINE;
+    timeline_type_info.initialValue = 0;
+
+    var create_info = std.mem.zeroes(c.VkSemaphoreCreateInfo);
+    create_info.sType = c.VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    create_info.pNext = &timeline_type_info;
+
+    for (&g_state.timelines) |*sem| {
+        if (c.vkCreateSemaphore(s.context.device, &create_info, null, sem) != c.VK_SUCCESS) {
+            submit_log.warn("Failed to create render graph timeline; async compute disabled", .{});
+            destroy_timelines(s.context.device);
+            return;
+        }
+    }
+
+    var f: u32 = 0;
+    while (f < s.sync.max_frames_in_flight) : (f += 1) {
+        const pools = [2]c.VkCommandPool{ s.commands.pools.?[f], s.commands.compute_transient_pools.?[f] };
+        for (pools, 0..) |pool, q| {
+            var ai = std.mem.zeroes(c.VkCommandBufferAllocateInfo);
+            ai.sType = c.VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            ai.commandPool = pool;
+            ai.level = c.VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            ai.commandBufferCount = MAX_BATCHES;
+            if (c.vkAllocateCommandBuffers(s.context.device, &ai, &g_state.buffers[q][f]) != c.VK_SUCCESS) {
+                submit_log.warn("Failed to allocate render graph batch buffers; async compute disabled", .{});
+                destroy_timelines(s.context.device);
+                return;
+            }
+        }
+    }
+
+    g_state.device = s.context.device;
+    submit_log.info("Render graph async compute enabled ({d} batches per queue)", .{MAX_BATCHES});
+}
+
+/// Destroys the timelines. The batch command buffers are freed with their pools.
+pub fn deinit(s: *types.VulkanState) void {
+    if (g_state.device != null) destroy_timelines(s.context.device);
+    g_state = .{};
+}
+
+fn destroy_timelines(device: c.VkDevice) void {
+    for (&g_state.timelines) |*sem| {
+        if (sem.* != null) c.vkDestroySemaphore(device, sem.*, null);
+        sem.* = null;
+    }
+}
+
+/// Forgets the previous frame's batches; called before every frame is recorded.
+pub fn reset() void {
+    g_state.active = false;
+    g_state.pending_count = 0;
+}
+
+/// True when this frame's plan can run on both queues: it has compute batches, ends with a
+/// graphics batch, fits the per-frame buffers, and only touches the backbuffer in its last batch
+/// (the one that waits on the swapchain acquire).
+fn usable(s: *types.VulkanState, rg: *const render_graph.RenderGraph) bool {
+    if (!rg.async_compute or g_state.device == null or g_state.device != s.context.device) return false;
+    if (s.sync.current_frame >= MAX_FRAMES) return false;
+
+    const submits = rg.plan.submits.items;
+    if (submits.len == 0 or rg.plan.async_step_count() == 0) return false;
+    const last: u32 = @intCast(submits.len - 1);
+    if (submits[last].queue != .graphics) return false;
+
+    var counts = [2]u32{ 0, 0 };
+    for (submits) |batch| counts[@intFromEnum(batch.queue)] += 1;
+    if (counts[0] > MAX_BATCHES or counts[1] > MAX_BATCHES) return false;
+
+    return rg.resource_confined_to_submit(types.RESOURCE_ID_BACKBUFFER, last);
+}
+
+/// Records the compiled plan across both queues. Returns false, having recorded nothing, when the
+/// plan should instead run through `RenderGraph.execute` on `frame_cmd`.
+pub fn record(s: *types.VulkanState, rg: *render_graph.RenderGraph, frame_cmd: c.VkCommandBuffer) bool {
+    reset();
+    if (!usable(s, rg)) return false;
+
+    var frame_signals = [2]u64{ 0, 0 };
+    var graphics_batches: u32 = 0;
+    for (rg.plan.submits.items) |batch| {
+        const q = @intFromEnum(batch.queue);
+        frame_signals[q] = @max(frame_signals[q], batch.signal_value);
+        if (batch.queue == .graphics) graphics_batches += 1;
+    }
+
+    // Values are reserved even if recording fails, so the timelines only ever move forward.
+    g_state.base = g_state.values;
+    g_state.values[0] += frame_signals[0];
+    g_state.values[1] += frame_signals[1];
+    g_state.frame = s.sync.current_frame;
+    g_state.frame_cmd = frame_cmd;
+    g_state.used = .{ 0, 0 };
+    g_state.graphics_left = graphics_batches;
+    g_state.final_wait = null;
+    g_state.final_signal = 0;
+    g_state.compute_tail = if (frame_signals[1] > 0) g_state.values[1] else 0;
+
+    if (!rg.execute_async(.{ .begin = begin_batch, .submit = submit_batch }, s)) {
+        // Nothing is submitted, so the frame submit must not wait on these batches.
+        submit_log.err("Frame {d}: failed to record render graph batches", .{s.sync.current_frame});
+        g_state.pending_count = 0;
+        return true;
+    }
+    g_state.active = true;
+    return true;
+}
+
+fn begin_batch(ctx: ?*anyopaque, queue: render_graph.Queue) ?c.VkCommandBuffer {
+    _ = ctx;
+    if (queue == .graphics) {
+        g_state.graphics_left -= 1;
+        if (g_state.graphics_left == 0) return g_state.frame_cmd;
+    }
+
+    const q = @intFromEnum(queue);
+    const cmd = g_state.buffers[q][g_state.frame][g_state.used[q]];
+    g_state.used[q] += 1;
+
+    var bi = std.mem.zeroes(c.VkCommandBufferBeginInfo);
+    bi.sType = c.VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    bi.flags = c.VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    if (c.vkBeginCommandBuffer(cmd, &bi) != c.VK_SUCCESS) return null;
+    return cmd;
+}
+
+fn submit_batch(ctx: ?*anyopaque, queue: render_graph.Queue, cmd: c.VkCommandBuffer, wait: ?render_graph.TimelineWait, signal_value: u64) bool {
+    _ = ctx;
+    var absolute_wait = wait;
+    if (absolute_wait) |*w| w.value += g_state.base[@intFromEnum(w.queue)];
+    const signal = g_state.base[@intFromEnum(queue)] + signal_value;
+
+    // The frame command buffer is ended and submitted by the frame loop.
+    if (cmd == g_state.frame_cmd) {
+        g_state.final_wait = absolute_wait;
+        g_state.final_signal = signal;
+        return true;
+    }
+
+    if (c.vkEndCommandBuffer(cmd) != c.VK_SUCCESS) return false;
+    g_state.pending[g_state.pending_count] = .{ .queue = queue, .cmd = cmd, .wait = absolute_wait, .signal_value = signal };
+    g_state.pending_count += 1;
+    return true;
+}
+
+/// Batches recorded this frame that must be submitted, in order, before the frame submit.
+pub fn pending() []const Batch {
+    return g_state.pending[0..g_state.pending_count];
+}
+
+/// Timeline semaphore of `queue`.
+pub fn timeline(queue: render_graph.Queue) c.VkSemaphore {
+    return g_state.timelines[@intFromEnum(queue)];
+}
+
+/// Waits the frame submit adds: its cross-queue acquire and the end of this frame's compute
+/// work, so the in-flight fence also covers the compute queue. Returns the number written.
+pub fn final_waits(out: *[2]c.VkSemaphoreSubmitInfo) u32 {
+    if (!g_state.active) return 0;
+    var count: u32 = 0;
+    if (g_state.final_wait) |w| {
+        out[count] = semaphore_info(w.queue, w.value, w.stage_mask);
+        count += 1;
+    }
+    if (g_state.compute_tail != 0) {
+        out[count] = semaphore_info(.compute, g_state.compute_tail, c.VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+        count += 1;
+    }
+    return count;
+}
+
+/// Graphics timeline signal the frame submit adds, or null when the frame ran on one queue.
+pub fn final_signal() ?c.VkSemaphoreSubmitInfo {
+    if (!g_state.active or g_state.final_signal == 0) return null;
+    return semaphore_info(.graphics, g_state.final_signal, c.VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+}
+
+fn semaphore_info(queue: render_graph.Queue, value: u64, stage_mask: c.VkPipelineStageFlags2) c.VkSemaphoreSubmitInfo {
+    return .{
+        .sType = c.VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+        .pNext = null,
+        .semaphore = timeline(queue),
+        .value = value,
+        .stageMask = stage_mask,
+        .deviceIndex = 0,
+    };
+}
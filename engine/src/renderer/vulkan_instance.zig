@@ -274,6 +274,18 @@ pub export fn vk_create_device(s: ?*types.VulkanState) callconv(.c) bool {
     }
     vk_log.info("[DEVICE] Selected compute family: {d}", .{vs.context.compute_queue_family});
 
+    // Prefer a family that can only transfer; those map to the copy engines.
+    vs.context.transfer_queue_family = vs.context.graphics_queue_family;
+    i = 0;
+    while (i < qf_count) : (i += 1) {
+        const flags = qfp_ptr[i].queueFlags;
+        if ((flags & c.VK_QUEUE_TRANSFER_BIT) != 0 and (flags & (c.VK_QUEUE_GRAPHICS_BIT | c.VK_QUEUE_COMPUTE_BIT)) == 0) {
+            vs.context.transfer_queue_family = i;
+            break;
+        }
+    }
+    vk_log.info("[DEVICE] Selected transfer family: {d}", .{vs.context.transfer_queue_family});
+
     var qci_graphics = std.mem.zeroes(c.VkDeviceQueueCreateInfo);
     qci_graphics.sType = c.VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
     qci_graphics.queueFamilyIndex = vs.context.graphics_queue_family;
@@ -286,6 +298,12 @@ pub export fn vk_create_device(s: ?*types.VulkanState) callconv(.c) bool {
     qci_compute.queueCount = 1;
     qci_compute.pQueuePriorities = &prio;
 
+    var qci_transfer = std.mem.zeroes(c.VkDeviceQueueCreateInfo);
+    qci_transfer.sType = c.VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    qci_transfer.queueFamilyIndex = vs.context.transfer_queue_family;
+    qci_transfer.queueCount = 1;
+    qci_transfer.pQueuePriorities = &prio;
+
     var physicalDeviceProperties: c.VkPhysicalDeviceProperties = undefined;
     c.vkGetPhysicalDeviceProperties(vs.context.physical_device, &physicalDeviceProperties);
     const apiVersion = physicalDeviceProperties.apiVersion;
@@ -557,10 +575,20 @@ pub export fn vk_create_device(s: ?*types.VulkanState) callconv(.c) bool {
 
     var dci = std.mem.zeroes(c.VkDeviceCreateInfo);
     dci.sType = c.VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    const two_queues = vs.context.compute_queue_family != vs.context.graphics_queue_family;
-    var qcis: [2]c.VkDeviceQueueCreateInfo = .{ qci_graphics, qci_compute };
-    dci.queueCreateInfoCount = if (two_queues) 2 else 1;
-    dci.pQueueCreateInfos = if (two_queues) &qcis else &qci_graphics;
+    var qcis: [3]c.VkDeviceQueueCreateInfo = undefined;
+    var qci_count: u32 = 0;
+    qcis[qci_count] = qci_graphics;
+    qci_count += 1;
+    if (vs.context.compute_queue_family != vs.context.graphics_queue_family) {
+        qcis[qci_count] = qci_compute;
+        qci_count += 1;
+    }
+    if (vs.context.transfer_queue_family != vs.context.graphics_queue_family) {
+        qcis[qci_count] = qci_transfer;
+        qci_count += 1;
+    }
+    dci.queueCreateInfoCount = qci_count;
+    dci.pQueueCreateInfos = &qcis;
     dci.enabledExtensionCount = enabled_extension_count;
     dci.ppEnabledExtensionNames = &device_extensions;
     dci.pNext = &deviceFeatures2;
@@ -580,6 +608,7 @@ pub export fn vk_create_device(s: ?*types.VulkanState) callconv(.c) bool {
 
     c.vkGetDeviceQueue(vs.context.device, vs.context.graphics_queue_family, 0, &vs.context.graphics_queue);
     c.vkGetDeviceQueue(vs.context.device, vs.context.compute_queue_family, 0, &vs.context.compute_queue);
+    c.vkGetDeviceQueue(vs.context.device, vs.context.transfer_queue_family, 0, &vs.context.transfer_queue);
     vs.context.present_queue_family = vs.context.graphics_queue_family;
     vs.context.present_queue = vs.context.graphics_queue;
 
@@ -148,10 +148,11 @@ pub export fn vk_mesh_shader_create_pipeline(s: ?*types.VulkanState, config: ?*c
                 return false;
             }
 
-            const reflect = shader_utils.reflection.reflect_shader(alloc, code, stage) catch |err| {
+            var reflect = shader_utils.reflection_cache.reflect(alloc, code, stage, .{}) catch |err| {
                 mesh_shader_log.err("Failed to reflect shader {s}: {s}", .{ path, @errorName(err) });
                 return false;
             };
+            defer reflect.deinit();
 
             if (reflect.push_constant_size > 0) {
                 pc.stageFlags |= reflect.push_constant_stages;
@@ -23,6 +23,10 @@ const vk_descriptor_indexing = @import("vulkan_descriptor_indexing.zig");
 const wrappers = @import("vulkan_wrappers.zig");
 const vk_pso = @import("vulkan_pso.zig");
 const pbr_init = @import("util/vulkan_pbr_init.zig");
+const visibility_culling = @import("visibility_culling.zig");
+const light_clustering = @import("light_clustering.zig");
+const ibl_cooker = @import("../assets/ibl_cooker.zig");
+const vk_shadows = @import("vulkan_shadows.zig");
 const scene = @import("../assets/scene.zig");
 const animation = @import("../assets/animation.zig");
 
@@ -35,16 +39,16 @@ const SceneCullCache = struct {
     meshes_ptr: ?[*]scene.CardinalMesh = null,
     mesh_count: u32 = 0,
     index_offsets: []u32 = @as([]u32, &[_]u32{}),
-    mesh_aabbs: []math.AABB = @as([]math.AABB, &[_]math.AABB{}),
-    bvh: math.BVH = .{},
+    cull_set: visibility_culling.CullSet = .{},
+    culler: visibility_culling.Culler = .{},
     visible: std.ArrayListUnmanaged(u32) = .{},
     allocator: ?std.mem.Allocator = null,
 
     fn deinit(self: *SceneCullCache) void {
         if (self.allocator) |a| {
             if (self.index_offsets.len > 0) a.free(self.index_offsets);
-            if (self.mesh_aabbs.len > 0) a.free(self.mesh_aabbs);
-            self.bvh.deinit(a);
+            self.cull_set.deinit(a);
+            self.culler.deinit(a);
             self.visible.deinit(a);
         }
         self.* = .{};
@@ -53,6 +57,10 @@ const SceneCullCache = struct {
 
 var g_scene_cull_cache: SceneCullCache = .{};
 
+/// Light binning for binding 11, rebuilt every frame by `vk_pbr_update_light_clusters`.
+var g_light_clusters: light_clustering.Clusterer = .{};
+var g_flat_light_cap_warned = false;
+
 fn ensure_visible_meshes(scn: *const scene.CardinalScene, view: math.Mat4, proj: math.Mat4) []const u32 {
     if (scn.mesh_count == 0 or scn.meshes == null) return &[_]u32{};
 
@@ -70,10 +78,6 @@ fn ensure_visible_meshes(scn: *const scene.CardinalScene, view: math.Mat4, proj:
             if (g_scene_cull_cache.index_offsets.len > 0) allocator.free(g_scene_cull_cache.index_offsets);
             g_scene_cull_cache.index_offsets = allocator.alloc(u32, mesh_count) catch return &[_]u32{};
         }
-        if (g_scene_cull_cache.mesh_aabbs.len < mesh_count) {
-            if (g_scene_cull_cache.mesh_aabbs.len > 0) allocator.free(g_scene_cull_cache.mesh_aabbs);
-            g_scene_cull_cache.mesh_aabbs = allocator.alloc(math.AABB, mesh_count) catch return &[_]u32{};
-        }
 
         var offset: u32 = 0;
         var i: usize = 0;
@@ -86,6 +90,11 @@ fn ensure_visible_meshes(scn: *const scene.CardinalScene, view: math.Mat4, proj:
         g_scene_cull_cache.visible.ensureTotalCapacity(allocator, mesh_count) catch {};
     }
 
+    // Bounds and keys are rebuilt every frame: transforms, visibility and materials can change
+    // without the mesh array changing. Keys group draws by alpha mode (pipeline), then material.
+    const cull_set = &g_scene_cull_cache.cull_set;
+    cull_set.clear();
+    cull_set.ensure_capacity(allocator, mesh_count) catch return &[_]u32{};
     var i: usize = 0;
     while (i < mesh_count) : (i += 1) {
         const mesh = &scn.meshes.?[@intCast(i)];
@@ -94,18 +103,17 @@ fn ensure_visible_meshes(scn: *const scene.CardinalScene, view: math.Mat4, proj:
             .max = math.Vec3.fromArray(mesh.bounding_box_max),
         };
         const m = math.Mat4.fromArray(mesh.transform);
-        g_scene_cull_cache.mesh_aabbs[i] = local.transformFast(m);
-    }
-
-    if (scene_changed) {
-        g_scene_cull_cache.bvh.build(allocator, g_scene_cull_cache.mesh_aabbs[0..mesh_count]) catch return &[_]u32{};
-    } else {
-        g_scene_cull_cache.bvh.refit(g_scene_cull_cache.mesh_aabbs[0..mesh_count]);
+        var pipeline_key: u32 = 0;
+        if (mesh.material_index < scn.material_count) {
+            pipeline_key = @intCast(@intFromEnum(scn.materials.?[mesh.material_index].alpha_mode));
+        }
+        _ = cull_set.append(allocator, local.transformFast(m), visibility_culling.sort_key(pipeline_key, mesh.material_index)) catch return &[_]u32{};
     }
 
-    const frustum = math.Frustum.fromMatrix(proj.mul(view));
+    const draws = g_scene_cull_cache.culler.cull(allocator, cull_set, proj.mul(view), .{}) catch return &[_]u32{};
     g_scene_cull_cache.visible.clearRetainingCapacity();
-    g_scene_cull_cache.bvh.queryFrustum(frustum, g_scene_cull_cache.mesh_aabbs[0..mesh_count], &g_scene_cull_cache.visible, allocator);
+    g_scene_cull_cache.visible.ensureTotalCapacity(allocator, draws.len) catch return &[_]u32{};
+    for (draws) |draw| g_scene_cull_cache.visible.appendAssumeCapacity(draw.index);
 
     return g_scene_cull_cache.visible.items;
 }
@@ -252,6 +260,28 @@ fn create_pbr_uniform_buffers(pipeline: *types.VulkanPBRPipeline, device: c.VkDe
         pipeline.boneMatricesBuffersMemory[i] = boneBuffer.memory;
         pipeline.boneMatricesBuffersAllocation[i] = boneBuffer.allocation;
         pipeline.boneMatricesBuffersMapped[i] = boneBuffer.mapped;
+
+        if (pipeline.clusteredLighting) {
+            var clusterInfo = std.mem.zeroes(buffer_mgr.VulkanBufferCreateInfo);
+            clusterInfo.size = light_clustering.BUFFER_SIZE;
+            clusterInfo.usage = c.VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | c.VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+            clusterInfo.properties = c.VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | c.VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+            clusterInfo.persistentlyMapped = true;
+
+            var clusterBuffer: buffer_mgr.VulkanBuffer = undefined;
+            if (!buffer_mgr.vk_buffer_create(&clusterBuffer, device, allocator, &clusterInfo)) {
+                buffer_mgr.vk_buffer_destroy(&boneBuffer, device, allocator, null);
+                buffer_mgr.vk_buffer_destroy(&lightBuffer, device, allocator, null);
+                buffer_mgr.vk_buffer_destroy(&uboBuffer, device, allocator, null);
+                return false;
+            }
+            pipeline.lightClusterBuffers[i] = clusterBuffer.handle;
+            pipeline.lightClusterBuffersMemory[i] = clusterBuffer.memory;
+            pipeline.lightClusterBuffersAllocation[i] = clusterBuffer.allocation;
+            pipeline.lightClusterBuffersMapped[i] = clusterBuffer.mapped;
+            // A zeroed header has clustering disabled: the shader walks every light until the first build.
+            @memset(@as([*]u8, @ptrCast(clusterBuffer.mapped))[0..@sizeOf(light_clustering.GpuHeader)], 0);
+        }
         const boneMatrices = @as([*]f32, @ptrCast(@alignCast(pipeline.boneMatricesBuffersMapped[i])));
         var b: u32 = 0;
         while (b < pipeline.maxBones) : (b += 1) {
@@ -267,16 +297,16 @@ fn create_pbr_uniform_buffers(pipeline: *types.VulkanPBRPipeline, device: c.VkDe
 }
 
 fn initialize_pbr_defaults(pipeline: *types.VulkanPBRPipeline, config: *const types.RendererConfig) void {
-    var defaultLighting = std.mem.zeroes(types.PBRLightingBuffer);
-    defaultLighting.count = 1;
-    defaultLighting.lights[0].lightDirection = config.pbr_default_light_direction;
-    defaultLighting.lights[0].lightColor = config.pbr_default_light_color;
-    defaultLighting.lights[0].params[0] = config.pbr_ambient_color[3];
-
+    // Filled in place: a PBRLightingBuffer holds MAX_LIGHTS entries and is too large for the stack.
     var i: u32 = 0;
     while (i < types.MAX_FRAMES_IN_FLIGHT) : (i += 1) {
         if (pipeline.lightingBuffersMapped[i]) |ptr| {
-            @memcpy(@as([*]u8, @ptrCast(ptr))[0..@sizeOf(types.PBRLightingBuffer)], @as([*]const u8, @ptrCast(&defaultLighting))[0..@sizeOf(types.PBRLightingBuffer)]);
+            const lighting: *types.PBRLightingBuffer = @ptrCast(@alignCast(ptr));
+            @memset(@as([*]u8, @ptrCast(lighting))[0..@sizeOf(types.PBRLightingBuffer)], 0);
+            lighting.count = 1;
+            lighting.lights[0].lightDirection = config.pbr_default_light_direction;
+            lighting.lights[0].lightColor = config.pbr_default_light_color;
+            lighting.lights[0].params[0] = config.pbr_ambient_color[3];
         }
     }
 }
@@ -366,7 +396,7 @@ fn create_pbr_mesh_buffers(pipeline: *types.VulkanPBRPipeline, device: c.VkDevic
     var vertexBufferObj = std.mem.zeroes(buffer_mgr.VulkanBuffer);
     var vertexInfo = std.mem.zeroes(buffer_mgr.VulkanBufferCreateInfo);
     vertexInfo.size = vertexBufferSize;
-    vertexInfo.usage = c.VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | c.VK_BUFFER_USAGE_TRANSFER_DST_BIT | c.VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+    vertexInfo.usage = c.VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | c.VK_BUFFER_USAGE_TRANSFER_SRC_BIT | c.VK_BUFFER_USAGE_TRANSFER_DST_BIT | c.VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
     vertexInfo.properties = c.VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
     if (!buffer_mgr.vk_buffer_create(&vertexBufferObj, device, @ptrCast(allocator), &vertexInfo)) {
@@ -376,13 +406,14 @@ fn create_pbr_mesh_buffers(pipeline: *types.VulkanPBRPipeline, device: c.VkDevic
     pipeline.vertexBuffer = vertexBufferObj.handle;
     pipeline.vertexBufferMemory = vertexBufferObj.memory;
     pipeline.vertexBufferAllocation = vertexBufferObj.allocation;
+    pipeline.totalVertexCount = totalVertices;
 
     // Create Device Local Index Buffer (if needed)
     var indexBufferObj = std.mem.zeroes(buffer_mgr.VulkanBuffer);
     if (totalIndices > 0) {
         var indexInfo = std.mem.zeroes(buffer_mgr.VulkanBufferCreateInfo);
         indexInfo.size = indexBufferSize;
-        indexInfo.usage = c.VK_BUFFER_USAGE_INDEX_BUFFER_BIT | c.VK_BUFFER_USAGE_TRANSFER_DST_BIT | c.VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+        indexInfo.usage = c.VK_BUFFER_USAGE_INDEX_BUFFER_BIT | c.VK_BUFFER_USAGE_TRANSFER_SRC_BIT | c.VK_BUFFER_USAGE_TRANSFER_DST_BIT | c.VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
         indexInfo.properties = c.VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
         if (!buffer_mgr.vk_buffer_create(&indexBufferObj, device, @ptrCast(allocator), &indexInfo)) {
@@ -524,6 +555,206 @@ fn create_pbr_mesh_buffers(pipeline: *types.VulkanPBRPipeline, device: c.VkDevic
     return true;
 }
 
+/// Ends, submits and waits for a one-off command buffer on `queue`, then frees it.
+fn submit_and_wait(device: c.VkDevice, commandPool: c.VkCommandPool, queue: c.VkQueue, commandBuffer: c.VkCommandBuffer) bool {
+    var cmd = commandBuffer;
+    var submitted = c.vkEndCommandBuffer(cmd) == c.VK_SUCCESS;
+    if (submitted) {
+        var submitInfo = std.mem.zeroes(c.VkSubmitInfo);
+        submitInfo.sType = c.VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &cmd;
+        submitted = c.vkQueueSubmit(queue, 1, &submitInfo, null) == c.VK_SUCCESS;
+    }
+    if (submitted) _ = c.vkQueueWaitIdle(queue);
+    c.vkFreeCommandBuffers(device, commandPool, 1, &cmd);
+    return submitted;
+}
+
+/// Appends the geometry of meshes `[first_mesh, scene_data.mesh_count)` behind the data already in
+/// the vertex and index buffers.
+///
+/// Earlier meshes keep their offsets: the current buffer contents are copied GPU-side into buffers
+/// sized for the new totals and only the new meshes pass through staging. Like the full upload it
+/// waits for the graphics queue, after which the old buffers are released.
+pub fn vk_pbr_append_mesh_range(pipeline: *types.VulkanPBRPipeline, device: c.VkDevice, allocator: *types.VulkanAllocator, commandPool: c.VkCommandPool, graphicsQueue: c.VkQueue, scene_data: *const scene.CardinalScene, first_mesh: u32) bool {
+    if (first_mesh > scene_data.mesh_count or scene_data.meshes == null) return false;
+
+    var addedVertices: u32 = 0;
+    var addedIndices: u32 = 0;
+    var i: u32 = first_mesh;
+    while (i < scene_data.mesh_count) : (i += 1) {
+        addedVertices += scene_data.meshes.?[i].vertex_count;
+        addedIndices += scene_data.meshes.?[i].index_count;
+    }
+    if (addedVertices == 0 and addedIndices == 0) return true;
+
+    const oldVertexBytes: c.VkDeviceSize = @as(c.VkDeviceSize, pipeline.totalVertexCount) * @sizeOf(scene.CardinalVertex);
+    const oldIndexBytes: c.VkDeviceSize = @as(c.VkDeviceSize, pipeline.totalIndexCount) * @sizeOf(u32);
+    const addedVertexBytes: c.VkDeviceSize = @as(c.VkDeviceSize, addedVertices) * @sizeOf(scene.CardinalVertex);
+    const addedIndexBytes: c.VkDeviceSize = @as(c.VkDeviceSize, addedIndices) * @sizeOf(u32);
+    const vertexStagingSize = (addedVertexBytes + 15) & ~@as(c.VkDeviceSize, 15);
+
+    var stagingBuffer = std.mem.zeroes(buffer_mgr.VulkanBuffer);
+    var stagingInfo = std.mem.zeroes(buffer_mgr.VulkanBufferCreateInfo);
+    stagingInfo.size = vertexStagingSize + addedIndexBytes;
+    stagingInfo.usage = c.VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    stagingInfo.properties = c.VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | c.VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    stagingInfo.persistentlyMapped = true;
+
+    if (!buffer_mgr.vk_buffer_create(&stagingBuffer, device, @ptrCast(allocator), &stagingInfo)) {
+        pbr_log.err("Failed to create staging buffer for appended meshes", .{});
+        return false;
+    }
+    defer buffer_mgr.vk_buffer_destroy_immediate(&stagingBuffer, device, @ptrCast(allocator));
+
+    const stagingBytes = @as([*]u8, @ptrCast(stagingBuffer.mapped orelse {
+        pbr_log.err("Staging buffer not mapped", .{});
+        return false;
+    }));
+    const vertices = @as([*]scene.CardinalVertex, @ptrCast(@alignCast(stagingBytes)));
+    const indices = @as([*]u32, @ptrCast(@alignCast(stagingBytes + vertexStagingSize)));
+
+    // Indices are absolute, so the new meshes are re-based onto the end of the existing vertices.
+    var vertexOffset: u32 = 0;
+    var indexOffset: u32 = 0;
+    i = first_mesh;
+    while (i < scene_data.mesh_count) : (i += 1) {
+        const mesh = &scene_data.meshes.?[i];
+        if (mesh.vertices != null and mesh.vertex_count > 0) {
+            @memcpy(vertices[vertexOffset .. vertexOffset + mesh.vertex_count], mesh.vertices.?[0..mesh.vertex_count]);
+        }
+        if (mesh.indices != null and mesh.index_count > 0) {
+            const base = pipeline.totalVertexCount + vertexOffset;
+            var j: u32 = 0;
+            while (j < mesh.index_count) : (j += 1) {
+                indices[indexOffset + j] = mesh.indices.?[j] + base;
+            }
+        }
+        vertexOffset += mesh.vertex_count;
+        indexOffset += mesh.index_count;
+    }
+
+    var vertexBufferObj = std.mem.zeroes(buffer_mgr.VulkanBuffer);
+    var vertexInfo = std.mem.zeroes(buffer_mgr.VulkanBufferCreateInfo);
+    vertexInfo.size = oldVertexBytes + addedVertexBytes;
+    vertexInfo.usage = c.VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | c.VK_BUFFER_USAGE_TRANSFER_SRC_BIT | c.VK_BUFFER_USAGE_TRANSFER_DST_BIT | c.VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+    vertexInfo.properties = c.VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    if (!buffer_mgr.vk_buffer_create(&vertexBufferObj, device, @ptrCast(allocator), &vertexInfo)) {
+        pbr_log.err("Failed to grow vertex buffer", .{});
+        return false;
+    }
+
+    var indexBufferObj = std.mem.zeroes(buffer_mgr.VulkanBuffer);
+    const newIndexBytes = oldIndexBytes + addedIndexBytes;
+    if (newIndexBytes > 0) {
+        var indexInfo = std.mem.zeroes(buffer_mgr.VulkanBufferCreateInfo);
+        indexInfo.size = newIndexBytes;
+        indexInfo.usage = c.VK_BUFFER_USAGE_INDEX_BUFFER_BIT | c.VK_BUFFER_USAGE_TRANSFER_SRC_BIT | c.VK_BUFFER_USAGE_TRANSFER_DST_BIT | c.VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+        indexInfo.properties = c.VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        if (!buffer_mgr.vk_buffer_create(&indexBufferObj, device, @ptrCast(allocator), &indexInfo)) {
+            pbr_log.err("Failed to grow index buffer", .{});
+            buffer_mgr.vk_buffer_destroy_immediate(&vertexBufferObj, device, @ptrCast(allocator));
+            return false;
+        }
+    }
+
+    const commandBuffer = buffer_mgr.begin_single_time_commands(device, commandPool);
+    if (commandBuffer == null) {
+        buffer_mgr.vk_buffer_destroy_immediate(&vertexBufferObj, device, @ptrCast(allocator));
+        if (newIndexBytes > 0) buffer_mgr.vk_buffer_destroy_immediate(&indexBufferObj, device, @ptrCast(allocator));
+        return false;
+    }
+
+    var copy = std.mem.zeroes(c.VkBufferCopy);
+    if (oldVertexBytes > 0 and pipeline.vertexBuffer != null) {
+        copy = .{ .srcOffset = 0, .dstOffset = 0, .size = oldVertexBytes };
+        c.vkCmdCopyBuffer(commandBuffer, pipeline.vertexBuffer, vertexBufferObj.handle, 1, &copy);
+    }
+    if (addedVertexBytes > 0) {
+        copy = .{ .srcOffset = 0, .dstOffset = oldVertexBytes, .size = addedVertexBytes };
+        c.vkCmdCopyBuffer(commandBuffer, stagingBuffer.handle, vertexBufferObj.handle, 1, &copy);
+    }
+    if (oldIndexBytes > 0 and pipeline.indexBuffer != null) {
+        copy = .{ .srcOffset = 0, .dstOffset = 0, .size = oldIndexBytes };
+        c.vkCmdCopyBuffer(commandBuffer, pipeline.indexBuffer, indexBufferObj.handle, 1, &copy);
+    }
+    if (addedIndexBytes > 0) {
+        copy = .{ .srcOffset = vertexStagingSize, .dstOffset = oldIndexBytes, .size = addedIndexBytes };
+        c.vkCmdCopyBuffer(commandBuffer, stagingBuffer.handle, indexBufferObj.handle, 1, &copy);
+    }
+
+    // Waiting for the queue also retires every frame still reading the old buffers.
+    if (!submit_and_wait(device, commandPool, graphicsQueue, commandBuffer)) {
+        buffer_mgr.vk_buffer_destroy_immediate(&vertexBufferObj, device, @ptrCast(allocator));
+        if (newIndexBytes > 0) buffer_mgr.vk_buffer_destroy_immediate(&indexBufferObj, device, @ptrCast(allocator));
+        return false;
+    }
+
+    if (pipeline.vertexBuffer != null) vk_allocator.free_buffer(allocator, pipeline.vertexBuffer, pipeline.vertexBufferAllocation);
+    if (pipeline.indexBuffer != null) vk_allocator.free_buffer(allocator, pipeline.indexBuffer, pipeline.indexBufferAllocation);
+
+    pipeline.vertexBuffer = vertexBufferObj.handle;
+    pipeline.vertexBufferMemory = vertexBufferObj.memory;
+    pipeline.vertexBufferAllocation = vertexBufferObj.allocation;
+    pipeline.indexBuffer = indexBufferObj.handle;
+    pipeline.indexBufferMemory = indexBufferObj.memory;
+    pipeline.indexBufferAllocation = indexBufferObj.allocation;
+    pipeline.totalVertexCount += addedVertices;
+    pipeline.totalIndexCount += addedIndices;
+
+    pbr_log.debug("Appended {d} meshes: {d} vertices, {d} indices", .{ scene_data.mesh_count - first_mesh, addedVertices, addedIndices });
+    return true;
+}
+
+/// Overwrites `vertices.len` vertices of the combined vertex buffer starting at `first_vertex`.
+///
+/// Used for CPU-deformed (morph target) meshes. The copy waits on earlier work in the graphics
+/// queue, which still reads the buffer, and blocks until it lands.
+pub fn vk_pbr_update_vertex_range(pipeline: *types.VulkanPBRPipeline, device: c.VkDevice, allocator: *types.VulkanAllocator, commandPool: c.VkCommandPool, graphicsQueue: c.VkQueue, first_vertex: u32, vertices: []const scene.CardinalVertex) bool {
+    if (vertices.len == 0) return true;
+    if (pipeline.vertexBuffer == null or @as(usize, first_vertex) + vertices.len > pipeline.totalVertexCount) return false;
+
+    const bytes = std.mem.sliceAsBytes(vertices);
+    var stagingBuffer = std.mem.zeroes(buffer_mgr.VulkanBuffer);
+    var stagingInfo = std.mem.zeroes(buffer_mgr.VulkanBufferCreateInfo);
+    stagingInfo.size = bytes.len;
+    stagingInfo.usage = c.VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    stagingInfo.properties = c.VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | c.VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    stagingInfo.persistentlyMapped = true;
+
+    if (!buffer_mgr.vk_buffer_create(&stagingBuffer, device, @ptrCast(allocator), &stagingInfo)) {
+        pbr_log.err("Failed to create staging buffer for vertex update", .{});
+        return false;
+    }
+    defer buffer_mgr.vk_buffer_destroy_immediate(&stagingBuffer, device, @ptrCast(allocator));
+
+    const mapped = @as([*]u8, @ptrCast(stagingBuffer.mapped orelse return false));
+    @memcpy(mapped[0..bytes.len], bytes);
+
+    const commandBuffer = buffer_mgr.begin_single_time_commands(device, commandPool);
+    if (commandBuffer == null) return false;
+
+    // Earlier frames may still be reading these vertices.
+    var barrier = std.mem.zeroes(c.VkMemoryBarrier2);
+    barrier.sType = c.VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    barrier.srcStageMask = c.VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+    barrier.srcAccessMask = c.VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT | c.VK_ACCESS_2_SHADER_READ_BIT;
+    barrier.dstStageMask = c.VK_PIPELINE_STAGE_2_COPY_BIT;
+    barrier.dstAccessMask = c.VK_ACCESS_2_TRANSFER_WRITE_BIT;
+
+    var dep = std.mem.zeroes(c.VkDependencyInfo);
+    dep.sType = c.VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dep.memoryBarrierCount = 1;
+    dep.pMemoryBarriers = &barrier;
+    c.vkCmdPipelineBarrier2(commandBuffer, &dep);
+
+    const copy = c.VkBufferCopy{ .srcOffset = 0, .dstOffset = @as(c.VkDeviceSize, first_vertex) * @sizeOf(scene.CardinalVertex), .size = bytes.len };
+    c.vkCmdCopyBuffer(commandBuffer, stagingBuffer.handle, pipeline.vertexBuffer, 1, &copy);
+
+    return submit_and_wait(device, commandPool, graphicsQueue, commandBuffer);
+}
+
 fn update_pbr_descriptor_sets(pipeline: *types.VulkanPBRPipeline, vulkan_state: ?*types.VulkanState) bool {
     const dm = @as(*types.VulkanDescriptorManager, @ptrCast(@alignCast(pipeline.descriptorManager)));
 
@@ -577,6 +808,20 @@ fn update_pbr_descriptor_sets(pipeline: *types.VulkanPBRPipeline, vulkan_state:
             return false;
         }
 
+        // Update light clusters (binding 11)
+        if (pipeline.clusteredLighting) {
+            if (!descriptor_mgr.vk_descriptor_manager_update_buffer(dm, set, 11, pipeline.lightClusterBuffers[i], 0, light_clustering.BUFFER_SIZE)) {
+                pbr_log.err("Failed to update light cluster buffer descriptor", .{});
+                return false;
+            }
+        }
+
+        // Update specular IBL (Bindings 12 and 13)
+        if (pipeline.imageBasedLighting) {
+            if (!write_environment_descriptors(pipeline, dm, set)) return false;
+            pipeline.iblBoundGeneration[i] = pipeline.iblGeneration;
+        }
+
         // Update Shadow Map (Binding 7)
         if (pipeline.shadowMapView != null) {
             if (!descriptor_mgr.vk_descriptor_manager_update_image(dm, set, 7, pipeline.shadowMapView, pipeline.shadowMapSampler, c.VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL)) {
@@ -657,6 +902,8 @@ pub export fn vk_pbr_load_scene(pipeline: ?*types.VulkanPBRPipeline, device: c.V
         pipe.indexBufferMemory = null;
         pipe.indexBufferAllocation = null;
     }
+    pipe.totalVertexCount = 0;
+    pipe.totalIndexCount = 0;
 
     if (scene_data == null) {
         return true;
@@ -1013,10 +1260,11 @@ pub export fn vk_pbr_pipeline_create(pipeline: ?*types.VulkanPBRPipeline, device
                 return false;
             }
 
-            const reflect = shader_utils.reflection.reflect_shader(allocator_ref, code, stage) catch |err| {
+            var reflect = shader_utils.reflection_cache.reflect(allocator_ref, code, stage, .{}) catch |err| {
                 pbr_log.err("Failed to reflect shader {s}: {s}", .{ path_slice, @errorName(err) });
                 return false;
             };
+            defer reflect.deinit();
 
             if (reflect.push_constant_size > 0) {
                 pc.stageFlags |= reflect.push_constant_stages;
@@ -1073,6 +1321,13 @@ pub export fn vk_pbr_pipeline_create(pipeline: ?*types.VulkanPBRPipeline, device
     if (!create_pbr_descriptor_manager(pipe, device, alloc, vulkan_state, &set0_bindings)) {
         return false;
     }
+    // Shaders compiled before clustered lighting lack binding 11 and loop over every light.
+    pipe.clusteredLighting = set0_bindings.contains(11);
+    // Likewise bindings 12 and 13 for the skybox's specular IBL.
+    pipe.imageBasedLighting = set0_bindings.contains(12) and set0_bindings.contains(13);
+    if (!pipe.clusteredLighting or !pipe.imageBasedLighting) {
+        pbr_log.warn("pbr.frag.spv is older than pbr.frag (clustered lights: {}, IBL: {}); run scripts/compile-shaders.ps1", .{ pipe.clusteredLighting, pipe.imageBasedLighting });
+    }
     pbr_log.debug("Descriptor manager created successfully", .{});
 
     // Cache descriptor buffer binding info if using buffers
@@ -1150,6 +1405,12 @@ pub export fn vk_pbr_pipeline_create(pipeline: ?*types.VulkanPBRPipeline, device
 
     initialize_pbr_defaults(pipe, &vulkan_state.?.config);
 
+    if (pipe.imageBasedLighting and !create_environment_resources(pipe, device, alloc, commandPool, graphicsQueue, vulkan_state.?.sync_manager)) {
+        pbr_log.err("Failed to create IBL resources", .{});
+        vk_pbr_pipeline_destroy(pipeline, device, allocator);
+        return false;
+    }
+
     pipe.initialized = true;
     pbr_log.info("PBR pipeline created successfully", .{});
     return true;
@@ -1168,6 +1429,8 @@ pub export fn vk_pbr_pipeline_destroy(pipeline: ?*types.VulkanPBRPipeline, devic
     const alloc = allocator.?;
 
     g_scene_cull_cache.deinit();
+    g_light_clusters.deinit(memory.cardinal_get_allocator_for_category(.RENDERER).as_allocator());
+    vk_shadows.release_caster_cache();
 
     pbr_log.debug("vk_pbr_pipeline_destroy: start", .{});
 
@@ -1202,6 +1465,11 @@ pub export fn vk_pbr_pipeline_destroy(pipeline: ?*types.VulkanPBRPipeline, devic
             vk_allocator.free_buffer(alloc, pipe.lightingBuffers[frame_idx], pipe.lightingBuffersAllocation[frame_idx]);
         }
 
+        if (pipe.lightClusterBuffers[frame_idx] != null or pipe.lightClusterBuffersMemory[frame_idx] != null) {
+            pipe.lightClusterBuffersMapped[frame_idx] = null;
+            vk_allocator.free_buffer(alloc, pipe.lightClusterBuffers[frame_idx], pipe.lightClusterBuffersAllocation[frame_idx]);
+        }
+
         if (pipe.boneMatricesBuffers[frame_idx] != null or pipe.boneMatricesBuffersMemory[frame_idx] != null) {
             if (pipe.boneMatricesBuffersMapped[frame_idx] != null) {
                 pipe.boneMatricesBuffersMapped[frame_idx] = null;
@@ -1217,6 +1485,8 @@ pub export fn vk_pbr_pipeline_destroy(pipeline: ?*types.VulkanPBRPipeline, devic
         }
     }
 
+    destroy_environment_resources(pipe, device, alloc);
+
     if (pipe.descriptorManager != null) {
         const mem_alloc = memory.cardinal_get_allocator_for_category(.RENDERER);
         descriptor_mgr.vk_descriptor_manager_destroy(@ptrCast(pipe.descriptorManager));
@@ -1272,6 +1542,130 @@ pub export fn vk_pbr_pipeline_destroy(pipeline: ?*types.VulkanPBRPipeline, devic
     pbr_log.info("PBR pipeline destroyed", .{});
 }
 
+/// Creates the IBL sampler and binds 1x1 black stand-ins until a baked skybox shows up.
+fn create_environment_resources(pipe: *types.VulkanPBRPipeline, device: c.VkDevice, allocator: *types.VulkanAllocator, commandPool: c.VkCommandPool, graphicsQueue: c.VkQueue, sync_manager: ?*types.VulkanSyncManager) bool {
+    var samplerInfo = std.mem.zeroes(c.VkSamplerCreateInfo);
+    samplerInfo.sType = c.VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = c.VK_FILTER_LINEAR;
+    samplerInfo.minFilter = c.VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = c.VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.addressModeU = c.VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = c.VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = c.VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.maxLod = c.VK_LOD_CLAMP_NONE;
+    samplerInfo.borderColor = c.VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
+    if (c.vkCreateSampler(device, &samplerInfo, null, &pipe.iblSampler) != c.VK_SUCCESS) {
+        pbr_log.err("Failed to create IBL sampler", .{});
+        return false;
+    }
+    return upload_environment(pipe, device, allocator, commandPool, graphicsQueue, sync_manager, null);
+}
+
+/// Replaces the IBL images with `cooked`'s specular chain and BRDF LUT, or with 1x1 black
+/// stand-ins when it is null. The old images are released once the current frame retires.
+fn upload_environment(pipe: *types.VulkanPBRPipeline, device: c.VkDevice, allocator: *types.VulkanAllocator, commandPool: c.VkCommandPool, graphicsQueue: c.VkQueue, sync_manager: ?*types.VulkanSyncManager, cooked: ?*const ibl_cooker.Cooked) bool {
+    const black_cube = [_]f16{0} ** (ibl_cooker.FACE_COUNT * 4);
+    const black_lut = [_]f16{0} ** 2;
+
+    var specular = std.mem.zeroes(types.VulkanManagedTexture);
+    specular.width = if (cooked) |ck| ck.face_size else 1;
+    specular.height = specular.width;
+    specular.mip_levels = if (cooked) |ck| ck.mip_count else 1;
+    specular.layer_count = ibl_cooker.FACE_COUNT;
+    specular.format = c.VK_FORMAT_R16G16B16A16_SFLOAT;
+    specular.is_hdr = true;
+    const specular_texels: []const f16 = if (cooked) |ck| ck.specular else &black_cube;
+    if (!texture_utils.create_layered_texture(allocator, device, commandPool, graphicsQueue, sync_manager, std.mem.sliceAsBytes(specular_texels), specular.width, specular.height, specular.format, specular.mip_levels, specular.layer_count, true, &specular.image, &specular.memory, &specular.view, &specular.allocation)) {
+        pbr_log.err("Failed to upload prefiltered environment", .{});
+        return false;
+    }
+    specular.is_allocated = true;
+
+    var lut = std.mem.zeroes(types.VulkanManagedTexture);
+    lut.width = if (cooked) |ck| ck.lut_size else 1;
+    lut.height = lut.width;
+    lut.mip_levels = 1;
+    lut.layer_count = 1;
+    lut.format = c.VK_FORMAT_R16G16_SFLOAT;
+    const lut_texels: []const f16 = if (cooked) |ck| ck.lut else &black_lut;
+    if (!texture_utils.create_layered_texture(allocator, device, commandPool, graphicsQueue, sync_manager, std.mem.sliceAsBytes(lut_texels), lut.width, lut.height, lut.format, 1, 1, false, &lut.image, &lut.memory, &lut.view, &lut.allocation)) {
+        pbr_log.err("Failed to upload BRDF LUT", .{});
+        c.vkDestroyImageView(device, specular.view, null);
+        vk_allocator.free_image(allocator, specular.image, specular.allocation);
+        return false;
+    }
+    lut.is_allocated = true;
+
+    const retire_value: u64 = if (sync_manager != null and sync_manager.?.initialized) sync_manager.?.current_frame_value else 0;
+    for ([_]*types.VulkanManagedTexture{ &pipe.iblSpecular, &pipe.iblBrdfLut }) |old| {
+        if (!old.is_allocated) continue;
+        texture_utils.add_image_view_cleanup(device, old.view, retire_value);
+        texture_utils.add_image_cleanup(allocator, old.image, old.allocation, retire_value);
+    }
+
+    pipe.iblSpecular = specular;
+    pipe.iblBrdfLut = lut;
+    pipe.iblSpecularBaked = cooked != null;
+    pipe.iblGeneration +%= 1;
+    return true;
+}
+
+fn destroy_environment_resources(pipe: *types.VulkanPBRPipeline, device: c.VkDevice, allocator: *types.VulkanAllocator) void {
+    for ([_]*types.VulkanManagedTexture{ &pipe.iblSpecular, &pipe.iblBrdfLut }) |t| {
+        if (!t.is_allocated) continue;
+        c.vkDestroyImageView(device, t.view, null);
+        vk_allocator.free_image(allocator, t.image, t.allocation);
+        t.is_allocated = false;
+    }
+    if (pipe.iblSampler != null) {
+        c.vkDestroySampler(device, pipe.iblSampler, null);
+        pipe.iblSampler = null;
+    }
+}
+
+fn write_environment_descriptors(pipe: *types.VulkanPBRPipeline, dm: *types.VulkanDescriptorManager, set: c.VkDescriptorSet) bool {
+    if (!descriptor_mgr.vk_descriptor_manager_update_image(dm, set, 12, pipe.iblSpecular.view, pipe.iblSampler, c.VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) or
+        !descriptor_mgr.vk_descriptor_manager_update_image(dm, set, 13, pipe.iblBrdfLut.view, pipe.iblSampler, c.VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL))
+    {
+        pbr_log.err("Failed to update IBL descriptors", .{});
+        return false;
+    }
+    return true;
+}
+
+/// Switches the specular IBL to the skybox's baked entry `environment_key` (0 for none) and
+/// rebinds it in `frame_index`'s set. Call before the frame's commands are recorded.
+///
+/// The cache entry is read and uploaded once per change; a missing or unreadable entry leaves
+/// the black stand-ins bound.
+pub export fn vk_pbr_update_environment(pipeline: ?*types.VulkanPBRPipeline, device: c.VkDevice, allocator: ?*types.VulkanAllocator, commandPool: c.VkCommandPool, graphicsQueue: c.VkQueue, sync_manager: ?*types.VulkanSyncManager, environment_key: u64, frame_index: u32) callconv(.c) void {
+    if (pipeline == null or allocator == null or !pipeline.?.initialized or !pipeline.?.imageBasedLighting) return;
+    const pipe = pipeline.?;
+
+    if (environment_key != pipe.iblKey) {
+        // Recorded up front so a bad entry is not re-read every frame.
+        pipe.iblKey = environment_key;
+        const renderer_allocator = memory.cardinal_get_allocator_for_category(.RENDERER).as_allocator();
+        var cooked: ?ibl_cooker.Cooked = if (environment_key != 0) ibl_cooker.load_cached(renderer_allocator, environment_key) else null;
+        defer if (cooked) |*ck| ck.deinit();
+
+        if (cooked != null or pipe.iblSpecularBaked) {
+            _ = upload_environment(pipe, device, allocator.?, commandPool, graphicsQueue, sync_manager, if (cooked) |*ck| ck else null);
+        }
+    }
+
+    const frame = if (frame_index >= types.MAX_FRAMES_IN_FLIGHT) 0 else frame_index;
+    if (pipe.iblBoundGeneration[frame] == pipe.iblGeneration) return;
+    const dm = pipe.descriptorManager orelse return;
+    const set: c.VkDescriptorSet = if (dm.useDescriptorBuffers)
+        @ptrFromInt(frame + 1)
+    else if (dm.descriptorSets) |sets|
+        sets[frame]
+    else
+        return;
+    if (write_environment_descriptors(pipe, dm, set)) pipe.iblBoundGeneration[frame] = pipe.iblGeneration;
+}
+
 pub export fn vk_pbr_update_uniforms(pipeline: ?*types.VulkanPBRPipeline, ubo: ?*const types.PBRUniformBufferObject, lighting: ?*const types.PBRLightingBuffer, frame_index: u32) callconv(.c) void {
     if (pipeline == null or !pipeline.?.initialized) return;
     const pipe = pipeline.?;
@@ -1282,10 +1676,50 @@ pub export fn vk_pbr_update_uniforms(pipeline: ?*types.VulkanPBRPipeline, ubo: ?
     }
 
     if (lighting != null and pipe.lightingBuffersMapped[frame] != null) {
-        @memcpy(@as([*]u8, @ptrCast(pipe.lightingBuffersMapped[frame]))[0..@sizeOf(types.PBRLightingBuffer)], @as([*]const u8, @ptrCast(lighting))[0..@sizeOf(types.PBRLightingBuffer)]);
+        // Only the live lights; the full array is MAX_LIGHTS entries.
+        const count = uploaded_light_count(lighting.?.count, pipe.clusteredLighting);
+        const size = @offsetOf(types.PBRLightingBuffer, "lights") + @as(usize, count) * @sizeOf(types.PBRLight);
+        const dst: *types.PBRLightingBuffer = @ptrCast(@alignCast(pipe.lightingBuffersMapped[frame]));
+        @memcpy(@as([*]u8, @ptrCast(dst))[0..size], @as([*]const u8, @ptrCast(lighting))[0..size]);
+        dst.count = count;
     }
 }
 
+/// Number of lights the shader will see. Shaders built without clustering (no binding 11) walk
+/// every light per fragment, so they keep the old flat-loop cap.
+fn uploaded_light_count(count: u32, clustered: bool) u32 {
+    const limit: u32 = if (clustered) types.MAX_LIGHTS else types.FLAT_MAX_LIGHTS;
+    if (!clustered and count > limit and !g_flat_light_cap_warned) {
+        g_flat_light_cap_warned = true;
+        pbr_log.warn("pbr.frag.spv has no light clusters; shading {d} of {d} lights. Recompile the shaders.", .{ limit, count });
+    }
+    return @min(count, limit);
+}
+
+/// Bins `pipeline.current_lighting` into view clusters for `current_ubo`'s camera and writes the
+/// lists to the frame's cluster buffer. Without clustered shaders, or when binning fails, the
+/// header is left disabled and the shader loops over every light.
+pub export fn vk_pbr_update_light_clusters(pipeline: ?*types.VulkanPBRPipeline, width: u32, height: u32, frame_index: u32) callconv(.c) void {
+    if (pipeline == null or !pipeline.?.initialized or !pipeline.?.clusteredLighting) return;
+    const pipe = pipeline.?;
+    const frame = if (frame_index >= types.MAX_FRAMES_IN_FLIGHT) 0 else frame_index;
+    const mapped = pipe.lightClusterBuffersMapped[frame] orelse return;
+
+    const lighting = &pipe.current_lighting;
+    const view = light_clustering.View{
+        .view = math.Mat4.fromArray(pipe.current_ubo.view),
+        .proj = math.Mat4.fromArray(pipe.current_ubo.proj),
+        .width = width,
+        .height = height,
+    };
+    const allocator = memory.cardinal_get_allocator_for_category(.RENDERER).as_allocator();
+    // A failed build leaves the header disabled, so the frame still lights correctly.
+    g_light_clusters.build(allocator, lighting.lights[0..@min(lighting.count, types.MAX_LIGHTS)], view, .{}) catch |err| {
+        pbr_log.warn("Light clustering failed: {s}", .{@errorName(err)});
+    };
+    g_light_clusters.write(@as([*]u8, @ptrCast(mapped))[0..light_clustering.BUFFER_SIZE]);
+}
+
 const SortItem = struct {
     index: u32,
     distSq: f32,
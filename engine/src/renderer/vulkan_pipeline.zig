@@ -9,6 +9,7 @@ const vk_allocator = @import("vulkan_allocator.zig");
 const c = @import("vulkan_c.zig").c;
 const memory = @import("../core/memory.zig");
 const pipeline_cache_io = @import("util/vulkan_pipeline_cache_io.zig");
+const reflection_cache = @import("util/vulkan_reflection_cache.zig");
 
 const pipe_log = log.ScopedLogger("PIPELINE");
 
@@ -116,6 +117,7 @@ fn create_pipeline_cache(s: *types.VulkanState) bool {
         pipe_log.err("Failed to create pipeline cache", .{});
         return false;
     }
+    reflection_cache.load_file(reflection_cache.CACHE_FILE_NAME);
     return true;
 }
 
@@ -123,6 +125,8 @@ fn destroy_pipeline_cache(s: *types.VulkanState) void {
     if (s.pipelines.pipeline_cache != null) {
         const alloc = memory.cardinal_get_allocator_for_category(.RENDERER).as_allocator();
         pipeline_cache_io.save_cache_file(alloc, s.context.device, s.pipelines.pipeline_cache, PIPELINE_CACHE_FILE_NAME);
+        reflection_cache.save_file(reflection_cache.CACHE_FILE_NAME);
+        reflection_cache.clear();
 
         c.vkDestroyPipelineCache(s.context.device, s.pipelines.pipeline_cache, null);
         s.pipelines.pipeline_cache = null;
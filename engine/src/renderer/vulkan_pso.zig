@@ -7,6 +7,7 @@ const types = @import("vulkan_types.zig");
 const log = @import("../core/log.zig");
 const pso_log = log.ScopedLogger("PSO");
 const shader_utils = @import("util/vulkan_shader_utils.zig");
+const reflection_cache = @import("util/vulkan_reflection_cache.zig");
 const wrappers = @import("vulkan_wrappers.zig");
 
 /// Cached shader modules keyed by file path.
@@ -402,6 +403,8 @@ pub const PipelineBuilder = struct {
         };
     }
 
+    /// Loads a pipeline descriptor from disk. Parsing is skipped when the reflection cache has
+    /// seen identical JSON before.
     pub fn load_from_json(allocator: std.mem.Allocator, path: []const u8) !ParsedPipelineDescriptor {
         const file = try std.fs.cwd().openFile(path, .{});
         defer file.close();
@@ -409,7 +412,7 @@ pub const PipelineBuilder = struct {
         const content = try file.readToEndAlloc(allocator, 1024 * 1024);
         errdefer allocator.free(content);
 
-        const parsed = try std.json.parseFromSlice(PipelineDescriptor, allocator, content, .{ .ignore_unknown_fields = true });
+        const parsed = try reflection_cache.parse_pipeline_descriptor(allocator, content);
         return .{
             .parsed = parsed,
             .content = content,
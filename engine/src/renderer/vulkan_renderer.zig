@@ -24,6 +24,7 @@ const vk_ssao = @import("vulkan_ssao.zig");
 const vk_skybox = @import("vulkan_skybox.zig");
 const vk_mesh_shader = @import("vulkan_mesh_shader.zig");
 const vk_compute = @import("vulkan_compute.zig");
+const reflection_cache = @import("util/vulkan_reflection_cache.zig");
 const texture_loader = @import("../assets/texture_loader.zig");
 const assets_scene = @import("../assets/scene.zig");
 const animation = @import("../assets/animation.zig");
@@ -31,6 +32,7 @@ const vk_simple_pipelines = @import("vulkan_simple_pipelines.zig");
 const vk_allocator = @import("vulkan_allocator.zig");
 const buffer_mgr = @import("vulkan_buffer_manager.zig");
 const vk_texture_utils = @import("util/vulkan_texture_utils.zig");
+const vk_staging_ring = @import("vulkan_staging_ring.zig");
 const vk_barrier_validation = @import("vulkan_barrier_validation.zig");
 const ref_counting = @import("../core/ref_counting.zig");
 const asset_manager = @import("../assets/asset_manager.zig");
@@ -41,6 +43,7 @@ const vk_texture_manager = @import("vulkan_texture_manager.zig");
 const vk_descriptor_indexing = @import("vulkan_descriptor_indexing.zig");
 const vk_shadows = @import("vulkan_shadows.zig");
 const pass_callbacks = @import("vulkan_render_pass_callbacks.zig");
+const render_snapshot = @import("../ecs/render_snapshot.zig");
 
 /// Casts an opaque renderer handle into the backing `VulkanState`.
 fn get_state(renderer: ?*types.CardinalRenderer) ?*types.VulkanState {
@@ -48,6 +51,67 @@ fn get_state(renderer: ?*types.CardinalRenderer) ?*types.VulkanState {
     return @ptrCast(@alignCast(renderer.?._opaque));
 }
 
+fn free_scene_copy_skins(scn: *types.CardinalScene) void {
+    const mem_alloc = memory.cardinal_get_allocator_for_category(.RENDERER);
+    if (scn.skins != null and scn.skin_count > 0) {
+        const skins = @as([*]animation.CardinalSkin, @ptrCast(@alignCast(scn.skins.?)));
+        var i: u32 = 0;
+        while (i < scn.skin_count) : (i += 1) {
+            if (skins[i].mesh_indices) |indices| {
+                memory.cardinal_free(mem_alloc, @ptrCast(indices));
+            }
+        }
+        memory.cardinal_free(mem_alloc, scn.skins.?);
+    }
+    scn.skins = null;
+    scn.skin_count = 0;
+    scn.animation_system = null;
+}
+
+/// Copies skin mesh bindings from `src` into the renderer's scene copy.
+///
+/// Only the fields the skinning draw path reads are kept; `animation_system` is set to a
+/// non-null sentinel so skinned meshes take the skinning path.
+fn copy_scene_skins(dst: *types.CardinalScene, src: *const types.CardinalScene) bool {
+    if (src.skin_count == 0 or src.skins == null) return true;
+
+    const mem_alloc = memory.cardinal_get_allocator_for_category(.RENDERER);
+    const skin_bytes = @as(usize, @intCast(src.skin_count)) * @sizeOf(animation.CardinalSkin);
+    const skins_ptr = memory.cardinal_calloc(mem_alloc, 1, skin_bytes) orelse {
+        renderer_log.err("Failed to allocate skins for scene copy", .{});
+        return false;
+    };
+    const dst_skins = @as([*]animation.CardinalSkin, @ptrCast(@alignCast(skins_ptr)));
+    const src_skins = @as([*]animation.CardinalSkin, @ptrCast(@alignCast(src.skins.?)));
+    var i: u32 = 0;
+    while (i < src.skin_count) : (i += 1) {
+        dst_skins[i] = std.mem.zeroes(animation.CardinalSkin);
+        dst_skins[i].mesh_count = src_skins[i].mesh_count;
+        dst_skins[i].root_bone_index = src_skins[i].root_bone_index;
+
+        if (src_skins[i].mesh_count > 0 and src_skins[i].mesh_indices != null) {
+            const idx_bytes = @as(usize, @intCast(src_skins[i].mesh_count)) * @sizeOf(u32);
+            const idx_ptr = memory.cardinal_alloc(mem_alloc, idx_bytes) orelse {
+                var j: u32 = 0;
+                while (j < i) : (j += 1) {
+                    if (dst_skins[j].mesh_indices) |p| memory.cardinal_free(mem_alloc, @ptrCast(p));
+                }
+                memory.cardinal_free(mem_alloc, skins_ptr);
+                renderer_log.err("Failed to allocate mesh indices for skin copy", .{});
+                return false;
+            };
+            const dst_indices = @as([*]u32, @ptrCast(@alignCast(idx_ptr)));
+            @memcpy(dst_indices[0..src_skins[i].mesh_count], src_skins[i].mesh_indices.?[0..src_skins[i].mesh_count]);
+            dst_skins[i].mesh_indices = dst_indices;
+        }
+    }
+
+    dst.skins = skins_ptr;
+    dst.skin_count = src.skin_count;
+    dst.animation_system = @ptrFromInt(1);
+    return true;
+}
+
 fn free_current_scene_copy(s: *types.VulkanState) void {
     if (s.current_scene == null) return;
     const mem_alloc = memory.cardinal_get_allocator_for_category(.RENDERER);
@@ -55,16 +119,7 @@ fn free_current_scene_copy(s: *types.VulkanState) void {
     if (s.current_scene_owned) {
         const scn = s.current_scene.?;
 
-        if (scn.skins != null and scn.skin_count > 0) {
-            const skins = @as([*]animation.CardinalSkin, @ptrCast(@alignCast(scn.skins.?)));
-            var i: u32 = 0;
-            while (i < scn.skin_count) : (i += 1) {
-                if (skins[i].mesh_indices) |indices| {
-                    memory.cardinal_free(mem_alloc, @ptrCast(indices));
-                }
-            }
-            memory.cardinal_free(mem_alloc, scn.skins.?);
-        }
+        free_scene_copy_skins(scn);
 
         if (scn.materials) |mats| {
             memory.cardinal_free(mem_alloc, @ptrCast(mats));
@@ -124,46 +179,11 @@ fn set_renderer_scene_copy(s: *types.VulkanState, src: *const types.CardinalScen
         dst.material_count = src.material_count;
     }
 
-    if (src.skin_count > 0 and src.skins != null) {
-        const skin_bytes = @as(usize, @intCast(src.skin_count)) * @sizeOf(animation.CardinalSkin);
-        const skins_ptr = memory.cardinal_calloc(mem_alloc, 1, skin_bytes) orelse {
-            if (dst.materials) |m| memory.cardinal_free(mem_alloc, @ptrCast(m));
-            if (dst.meshes) |m| memory.cardinal_free(mem_alloc, @ptrCast(m));
-            memory.cardinal_free(mem_alloc, new_scene_ptr);
-            renderer_log.err("Failed to allocate skins for scene copy", .{});
-            return;
-        };
-        const dst_skins = @as([*]animation.CardinalSkin, @ptrCast(@alignCast(skins_ptr)));
-        const src_skins = @as([*]animation.CardinalSkin, @ptrCast(@alignCast(src.skins.?)));
-        var i: u32 = 0;
-        while (i < src.skin_count) : (i += 1) {
-            dst_skins[i] = std.mem.zeroes(animation.CardinalSkin);
-            dst_skins[i].mesh_count = src_skins[i].mesh_count;
-            dst_skins[i].root_bone_index = src_skins[i].root_bone_index;
-
-            if (src_skins[i].mesh_count > 0 and src_skins[i].mesh_indices != null) {
-                const idx_bytes = @as(usize, @intCast(src_skins[i].mesh_count)) * @sizeOf(u32);
-                const idx_ptr = memory.cardinal_alloc(mem_alloc, idx_bytes) orelse {
-                    var j: u32 = 0;
-                    while (j < i) : (j += 1) {
-                        if (dst_skins[j].mesh_indices) |p| memory.cardinal_free(mem_alloc, @ptrCast(p));
-                    }
-                    memory.cardinal_free(mem_alloc, skins_ptr);
-                    if (dst.materials) |m| memory.cardinal_free(mem_alloc, @ptrCast(m));
-                    if (dst.meshes) |m| memory.cardinal_free(mem_alloc, @ptrCast(m));
-                    memory.cardinal_free(mem_alloc, new_scene_ptr);
-                    renderer_log.err("Failed to allocate mesh indices for skin copy", .{});
-                    return;
-                };
-                const dst_indices = @as([*]u32, @ptrCast(@alignCast(idx_ptr)));
-                @memcpy(dst_indices[0..src_skins[i].mesh_count], src_skins[i].mesh_indices.?[0..src_skins[i].mesh_count]);
-                dst_skins[i].mesh_indices = dst_indices;
-            }
-        }
-
-        dst.skins = skins_ptr;
-        dst.skin_count = src.skin_count;
-        dst.animation_system = @ptrFromInt(1);
+    if (!copy_scene_skins(dst, src)) {
+        if (dst.materials) |m| memory.cardinal_free(mem_alloc, @ptrCast(m));
+        if (dst.meshes) |m| memory.cardinal_free(mem_alloc, @ptrCast(m));
+        memory.cardinal_free(mem_alloc, new_scene_ptr);
+        return;
     }
 
     s.current_scene = dst;
@@ -414,7 +434,28 @@ fn init_skybox_pipeline_helper(s: *types.VulkanState) void {
     log_pipeline_init_result(initialized, "renderer_create: Skybox pipeline", "vk_skybox_pipeline_init failed");
 }
 
+/// Reflects every shader and parses every pipeline descriptor on the job system up front, so the
+/// pipeline helpers below hit the reflection cache and only pay for Vulkan object creation.
+fn prewarm_pipeline_assets(s: *types.VulkanState) void {
+    var shaders_dir: []const u8 = std.mem.span(@as([*:0]const u8, @ptrCast(&s.config.shader_dir)));
+    const env_dir_c = c.getenv("CARDINAL_SHADERS_DIR");
+    if (env_dir_c != null) {
+        shaders_dir = std.mem.span(env_dir_c);
+    }
+    const pipeline_dir = std.mem.span(@as([*:0]const u8, @ptrCast(&s.config.pipeline_dir)));
+
+    const start = std.time.nanoTimestamp();
+    const alloc = memory.cardinal_get_allocator_for_category(.RENDERER).as_allocator();
+    const result = reflection_cache.prewarm(alloc, shaders_dir, pipeline_dir) catch |err| {
+        renderer_log.warn("Pipeline asset prewarm failed: {s}", .{@errorName(err)});
+        return;
+    };
+    const elapsed_ms = @as(f64, @floatFromInt(std.time.nanoTimestamp() - start)) / 1e6;
+    renderer_log.info("Prewarmed {d} shaders and {d} pipeline descriptors in {d:.2} ms ({d} failed)", .{ result.shaders, result.pipelines, elapsed_ms, result.failed });
+}
+
 fn init_pipelines(s: *types.VulkanState) bool {
+    prewarm_pipeline_assets(s);
     init_pbr_pipeline_helper(s);
     init_mesh_shader_pipeline_helper(s);
     init_compute_pipeline_helper(s);
@@ -460,6 +501,8 @@ pub export fn cardinal_renderer_create(out_renderer: ?*types.CardinalRenderer, w
         const rg = @as(*render_graph.RenderGraph, @ptrCast(@alignCast(rg_ptr)));
         const renderer_alloc = memory.cardinal_get_allocator_for_category(.RENDERER).as_allocator();
         rg.* = render_graph.RenderGraph.init(renderer_alloc);
+        // Devices without a separate compute queue fall back to `execute` at record time.
+        rg.async_compute = s.config.enable_async_compute;
 
         const mesh_prep_pass = render_graph.RenderPass.init(renderer_alloc, "MeshShader Prep", (struct {
             fn cb(cmd: c.VkCommandBuffer, vs: *types.VulkanState) void {
@@ -470,7 +513,7 @@ pub export fn cardinal_renderer_create(out_renderer: ?*types.CardinalRenderer, w
         rg.add_pass(mesh_prep_pass) catch {};
 
         var shadow_pass = render_graph.RenderPass.init(renderer_alloc, "Shadow Pass", pass_callbacks.shadow_pass_callback);
-        shadow_pass.use_graphics_queue(s);
+        shadow_pass.use_graphics_queue();
         shadow_pass.can_be_culled = false;
         shadow_pass.add_output(renderer_alloc, .{
             .id = types.RESOURCE_ID_SHADOW_MAP,
@@ -556,7 +599,7 @@ pub export fn cardinal_renderer_create(out_renderer: ?*types.CardinalRenderer, w
             .aspect_mask = c.VK_IMAGE_ASPECT_COLOR_BIT,
         }) catch {};
 
-        pass.use_graphics_queue(s);
+        pass.use_graphics_queue();
         rg.add_pass(pass) catch {
             renderer_log.err("Failed to add PBR pass", .{});
         };
@@ -614,7 +657,7 @@ pub export fn cardinal_renderer_create(out_renderer: ?*types.CardinalRenderer, w
             renderer_log.err("Failed to add PostProcess pass output: {s}", .{@errorName(err)});
         };
 
-        pp_pass.use_graphics_queue(s);
+        pp_pass.use_graphics_queue();
         rg.add_pass(pp_pass) catch {
             renderer_log.err("Failed to add PostProcess pass", .{});
         };
@@ -636,7 +679,7 @@ pub export fn cardinal_renderer_create(out_renderer: ?*types.CardinalRenderer, w
             .layout = c.VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
             .aspect_mask = c.VK_IMAGE_ASPECT_COLOR_BIT,
         }) catch {};
-        skybox_pass.use_graphics_queue(s);
+        skybox_pass.use_graphics_queue();
         rg.add_pass(skybox_pass) catch {};
 
         var ui_pass = render_graph.RenderPass.init(renderer_alloc, "UI Pass", pass_callbacks.ui_pass_callback);
@@ -656,7 +699,7 @@ pub export fn cardinal_renderer_create(out_renderer: ?*types.CardinalRenderer, w
             .layout = c.VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
             .aspect_mask = c.VK_IMAGE_ASPECT_COLOR_BIT,
         }) catch {};
-        ui_pass.use_graphics_queue(s);
+        ui_pass.use_graphics_queue();
         rg.add_pass(ui_pass) catch {};
 
         var present_pass = render_graph.RenderPass.init(renderer_alloc, "Present Pass", pass_callbacks.present_pass_callback);
@@ -677,7 +720,7 @@ pub export fn cardinal_renderer_create(out_renderer: ?*types.CardinalRenderer, w
             .aspect_mask = c.VK_IMAGE_ASPECT_COLOR_BIT,
             .is_present = true,
         }) catch {};
-        present_pass.use_graphics_queue(s);
+        present_pass.use_graphics_queue();
         rg.add_pass(present_pass) catch {};
 
         rg.compile() catch {
@@ -751,6 +794,9 @@ pub export fn cardinal_renderer_create(out_renderer: ?*types.CardinalRenderer, w
 
     if (!init_sync_manager(s))
         return false;
+    if (vk_staging_ring.install(s)) {
+        renderer_log.info("renderer_create: staging ring", .{});
+    }
     if (!init_pipelines(s))
         return false;
 
@@ -790,6 +836,8 @@ pub export fn cardinal_renderer_create_headless(out_renderer: ?*types.CardinalRe
         const rg = @as(*render_graph.RenderGraph, @ptrCast(@alignCast(rg_ptr)));
         const renderer_alloc = memory.cardinal_get_allocator_for_category(.RENDERER).as_allocator();
         rg.* = render_graph.RenderGraph.init(renderer_alloc);
+        // Devices without a separate compute queue fall back to `execute` at record time.
+        rg.async_compute = s.config.enable_async_compute;
 
         var pass = render_graph.RenderPass.init(renderer_alloc, "PBR Pass", pass_callbacks.pbr_pass_callback);
 
@@ -1041,6 +1089,8 @@ pub export fn cardinal_renderer_destroy(renderer: ?*types.CardinalRenderer) call
 
     vk_texture_utils.shutdown_staging_buffer_cleanups(&s.allocator);
 
+    vk_staging_ring.uninstall();
+
     vk_allocator.shutdown(&s.allocator);
 
     vk_commands.vk_destroy_commands_sync(@ptrCast(s));
@@ -1149,17 +1199,12 @@ pub export fn cardinal_renderer_set_lights(renderer: ?*types.CardinalRenderer, l
 
     if (!s.pipelines.use_pbr_pipeline) return;
 
-    var lighting = std.mem.zeroes(types.PBRLightingBuffer);
-    lighting.count = if (count > types.MAX_LIGHTS) types.MAX_LIGHTS else count;
-
-    if (lights != null and count > 0) {
-        var i: u32 = 0;
-        while (i < lighting.count) : (i += 1) {
-            lighting.lights[i] = lights.?[i];
-        }
+    // Written in place: the buffer holds MAX_LIGHTS entries and only `count` are read.
+    const lighting = &s.pipelines.pbr_pipeline.current_lighting;
+    lighting.count = if (lights == null) 0 else @min(count, types.MAX_LIGHTS);
+    if (lighting.count > 0) {
+        @memcpy(lighting.lights[0..lighting.count], lights.?[0..lighting.count]);
     }
-
-    s.pipelines.pbr_pipeline.current_lighting = lighting;
 }
 
 /// Updates the first light from the simpler `CardinalLight` struct.
@@ -1170,7 +1215,7 @@ pub export fn cardinal_renderer_set_lighting(renderer: ?*types.CardinalRenderer,
 
     if (!s.pipelines.use_pbr_pipeline) return;
 
-    var lighting = std.mem.zeroes(types.PBRLightingBuffer);
+    const lighting = &s.pipelines.pbr_pipeline.current_lighting;
     lighting.count = 1;
 
     lighting.lights[0].lightDirection[0] = l.direction.x;
@@ -1192,8 +1237,6 @@ pub export fn cardinal_renderer_set_lighting(renderer: ?*types.CardinalRenderer,
     lighting.lights[0].params[1] = @cos(l.inner_cone);
     lighting.lights[0].params[2] = @cos(l.outer_cone);
     lighting.lights[0].params[3] = 0.0;
-
-    s.pipelines.pbr_pipeline.current_lighting = lighting;
 }
 
 pub export fn cardinal_renderer_update_bone_matrices(renderer: ?*types.CardinalRenderer, bone_matrices: ?[*]const f32, count: u32) callconv(.c) void {
@@ -1216,6 +1259,155 @@ pub export fn cardinal_renderer_update_mesh_transform(renderer: ?*types.Cardinal
     return true;
 }
 
+/// Applies an extracted render snapshot: camera uniforms, lights and each visible mesh's world matrix.
+///
+/// `MeshInstance.mesh.index` is the mesh's index in the uploaded scene; instances past the end of
+/// it (a snapshot taken before the scene finished uploading) are skipped.
+pub fn cardinal_renderer_apply_snapshot(renderer: ?*types.CardinalRenderer, snapshot: *const render_snapshot.RenderSnapshot) void {
+    const s = get_state(renderer) orelse return;
+
+    if (s.pipelines.use_pbr_pipeline) {
+        if (snapshot.camera) |cam| {
+            const ubo = &s.pipelines.pbr_pipeline.current_ubo;
+            ubo.view = cam.view.data;
+            ubo.proj = cam.projection.data;
+            ubo.viewPos = .{ cam.position.x, cam.position.y, cam.position.z };
+        }
+
+        var lights: [types.MAX_LIGHTS]types.PBRLight = undefined;
+        const light_count = snapshot.to_pbr_lights(&lights);
+        cardinal_renderer_set_lights(renderer, &lights, light_count);
+    }
+
+    for (snapshot.meshes.items) |instance| {
+        _ = cardinal_renderer_update_mesh_transform(renderer, instance.mesh.index, &instance.world.data);
+    }
+}
+
+/// Grows one array of the renderer's scene copy to `new_count` elements, copying the new tail from `src`.
+fn grow_scene_copy_array(comptime T: type, dst: *?[*]T, old_count: u32, src: ?[*]T, new_count: u32) bool {
+    if (new_count <= old_count) return true;
+    const source = src orelse return false;
+    const mem_alloc = memory.cardinal_get_allocator_for_category(.RENDERER);
+    const ptr = memory.cardinal_realloc(mem_alloc, if (dst.*) |d| @ptrCast(d) else null, @as(usize, new_count) * @sizeOf(T)) orelse return false;
+    const items = @as([*]T, @ptrCast(@alignCast(ptr)));
+    @memcpy(items[old_count..new_count], source[old_count..new_count]);
+    dst.* = items;
+    return true;
+}
+
+/// Returns true when an ADDED range only covers slots past everything the renderer already holds.
+fn is_tail_append(dst: *const types.CardinalScene, src: *const types.CardinalScene, resident_textures: u32, range: assets_scene.CardinalSceneDirtyRange) bool {
+    if (range.mesh_count > 0 and (range.first_mesh < dst.mesh_count or range.first_mesh + range.mesh_count > src.mesh_count)) return false;
+    if (range.material_count > 0 and (range.first_material < dst.material_count or range.first_material + range.material_count > src.material_count)) return false;
+    if (range.texture_count > 0 and (range.first_texture < resident_textures or range.first_texture + range.texture_count > src.texture_count)) return false;
+    return true;
+}
+
+/// Uploads the changed vertices of one CPU-deformed mesh into the combined PBR vertex buffer.
+fn upload_mesh_vertex_range(s: *types.VulkanState, dst: *const types.CardinalScene, src: *const types.CardinalScene, range: assets_scene.CardinalSceneDirtyRange) bool {
+    const mesh = &src.meshes.?[range.first_mesh];
+    if (mesh.vertices == null or mesh.vertex_count != dst.meshes.?[range.first_mesh].vertex_count) return false;
+    if (range.first_vertex + range.vertex_count > mesh.vertex_count) return false;
+
+    // Vertices are packed in mesh order, matching create_pbr_mesh_buffers.
+    var base: u32 = 0;
+    for (dst.meshes.?[0..range.first_mesh]) |m| base += m.vertex_count;
+
+    const vertices = mesh.vertices.?[range.first_vertex .. range.first_vertex + range.vertex_count];
+    return vk_pbr.vk_pbr_update_vertex_range(&s.pipelines.pbr_pipeline, s.context.device, &s.allocator, s.commands.pools.?[0], s.context.graphics_queue, base + range.first_vertex, vertices);
+}
+
+/// Applies changed scene ranges to the renderer without re-uploading the whole scene.
+///
+/// Removals and visibility changes patch the scene copy in place. Added ranges that land past the
+/// end of the resident meshes, materials and textures are appended to the PBR buffers and texture
+/// slots, and `VERTICES` ranges overwrite just the deformed vertices. Skins are re-copied whenever
+/// models enter or leave. Returns false when a range refills
+/// slots in the middle or the scene layout no longer matches, in which case the caller must upload
+/// the scene.
+pub export fn cardinal_renderer_update_scene_ranges(renderer: ?*types.CardinalRenderer, scene: ?*const types.CardinalScene, ranges: ?[*]const assets_scene.CardinalSceneDirtyRange, range_count: u32) callconv(.c) bool {
+    const s = get_state(renderer) orelse return false;
+    const src = scene orelse return false;
+    if (s.scene_upload_pending) return false;
+    const dst = s.current_scene orelse return false;
+    if (!s.current_scene_owned or dst.meshes == null or src.meshes == null) return false;
+    if (range_count == 0) return true;
+    const list = ranges orelse return false;
+
+    const texture_manager = s.pipelines.pbr_pipeline.textureManager;
+    const resident_textures: u32 = if (texture_manager) |tm| tm.textureCount -| 1 else 0;
+
+    var appends = false;
+    var skins_changed = false;
+    for (list[0..range_count]) |range| {
+        switch (range.change) {
+            .ADDED => {
+                if (!s.pipelines.use_pbr_pipeline or !is_tail_append(dst, src, resident_textures, range)) return false;
+                if (range.texture_count > 0 and texture_manager == null) return false;
+                appends = true;
+                skins_changed = true;
+            },
+            .REMOVED, .SKINNING => skins_changed = true,
+            .VERTICES => if (!s.pipelines.use_pbr_pipeline or range.mesh_count != 1) return false,
+            else => {},
+        }
+    }
+    if (appends) {
+        if (src.mesh_count < dst.mesh_count or src.material_count < dst.material_count) return false;
+    } else if (dst.mesh_count != src.mesh_count) {
+        return false;
+    }
+    for (list[0..range_count]) |range| {
+        if (range.first_mesh + range.mesh_count > src.mesh_count) return false;
+    }
+
+    if (appends) {
+        const old_mesh_count = dst.mesh_count;
+        if (texture_manager) |tm| {
+            if (src.texture_count > resident_textures and
+                !vk_texture_manager.vk_texture_manager_append_scene_textures(tm, src, resident_textures)) return false;
+        }
+        if (!vk_pbr.vk_pbr_append_mesh_range(&s.pipelines.pbr_pipeline, s.context.device, &s.allocator, s.commands.pools.?[0], s.context.graphics_queue, src, old_mesh_count)) {
+            return false;
+        }
+        if (!grow_scene_copy_array(assets_scene.CardinalMesh, &dst.meshes, old_mesh_count, src.meshes, src.mesh_count)) return false;
+        var i = old_mesh_count;
+        while (i < src.mesh_count) : (i += 1) {
+            dst.meshes.?[i].vertices = null;
+            dst.meshes.?[i].indices = null;
+        }
+        dst.mesh_count = src.mesh_count;
+        if (!grow_scene_copy_array(assets_scene.CardinalMaterial, &dst.materials, dst.material_count, src.materials, src.material_count)) return false;
+        dst.material_count = @max(dst.material_count, src.material_count);
+    }
+
+    if (skins_changed) {
+        free_scene_copy_skins(dst);
+        if (!copy_scene_skins(dst, src)) return false;
+    }
+
+    for (list[0..range_count]) |range| {
+        if (range.change == .ADDED) continue;
+        if (range.change == .VERTICES) {
+            if (!upload_mesh_vertex_range(s, dst, src, range)) return false;
+            continue;
+        }
+        var i = range.first_mesh;
+        while (i < range.first_mesh + range.mesh_count) : (i += 1) {
+            const dst_mesh = &dst.meshes.?[i];
+            const src_mesh = &src.meshes.?[i];
+            dst_mesh.visible = src_mesh.visible;
+            if (range.change == .VISIBILITY) {
+                @memcpy(dst_mesh.transform[0..16], src_mesh.transform[0..16]);
+            }
+        }
+    }
+
+    renderer_log.debug("Applied {d} scene ranges without a full upload", .{range_count});
+    return true;
+}
+
 pub export fn cardinal_renderer_set_skybox_from_data(renderer: ?*types.CardinalRenderer, data: ?*texture_loader.TextureData) callconv(.c) bool {
     if (renderer == null or data == null) return false;
     const s = get_state(renderer) orelse return false;
@@ -1225,7 +1417,10 @@ pub export fn cardinal_renderer_set_skybox_from_data(renderer: ?*types.CardinalR
         return false;
     }
 
-    return vk_skybox.vk_skybox_load_from_data(@ptrCast(&s.pipelines.skybox_pipeline), s.context.device, @ptrCast(&s.allocator), s.commands.pools.?[0], s.context.graphics_queue, s.sync_manager, data.?.*);
+    if (!vk_skybox.vk_skybox_load_from_data(@ptrCast(&s.pipelines.skybox_pipeline), s.context.device, @ptrCast(&s.allocator), s.commands.pools.?[0], s.context.graphics_queue, s.sync_manager, data.?.*)) return false;
+    // Baked IBL is keyed by source file, which decoded data does not have.
+    vk_skybox.vk_skybox_clear_environment(@ptrCast(&s.pipelines.skybox_pipeline));
+    return true;
 }
 
 pub export fn cardinal_renderer_set_skybox(renderer: ?*types.CardinalRenderer, path: ?[*:0]const u8) callconv(.c) bool {
@@ -1735,7 +1930,7 @@ pub export fn cardinal_renderer_runtime_texture_allocate(renderer: ?*types.Cardi
     tex.bindless_index = c.UINT32_MAX;
     tex.resource = null;
 
-    if (!vk_texture_utils.create_image_and_memory(mgr.allocator, s.context.device, width, height, format, &tex.image, &tex.memory, &tex.allocation)) {
+    if (!vk_texture_utils.create_image_and_memory(mgr.allocator, s.context.device, width, height, format, 1, &tex.image, &tex.memory, &tex.allocation)) {
         return false;
     }
     if (!vk_texture_utils.create_texture_image_view(s.context.device, tex.image, &tex.view, format)) {
@@ -2135,6 +2330,11 @@ pub export fn cardinal_renderer_upload_scene(renderer: ?*types.CardinalRenderer,
         return;
     }
 
+    // Every mesh and texture upload below lands in one ring submission.
+    const ring = vk_staging_ring.active();
+    if (ring) |r| r.begin_batch();
+    defer if (ring) |r| r.end_batch();
+
     if (s.context.vkGetSemaphoreCounterValue != null and s.sync.timeline_semaphore != null) {
         var sem_val: u64 = 0;
         const sem_res = s.context.vkGetSemaphoreCounterValue.?(s.context.device, s.sync.timeline_semaphore, &sem_val);
@@ -18,6 +18,8 @@ const vk_mesh_shader = @import("vulkan_mesh_shader.zig");
 const vk_ssao = @import("vulkan_ssao.zig");
 const vk_texture_manager = @import("vulkan_texture_manager.zig");
 const vk_texture_utils = @import("util/vulkan_texture_utils.zig");
+const vk_staging_ring = @import("vulkan_staging_ring.zig");
+const vk_graph_submit = @import("vulkan_graph_submit.zig");
 const vk_renderer = @import("vulkan_renderer.zig");
 const vk_mt = @import("vulkan_mt.zig");
 const window = @import("../core/window.zig");
@@ -240,7 +242,7 @@ fn acquire_next_image(s: *types.VulkanState, out_image_index: *u32) bool {
     return true;
 }
 
-fn submit_command_buffer(s: *types.VulkanState, cmd: c.VkCommandBuffer, acquire_sem: c.VkSemaphore, wait_timeline_value: ?u64, image_index: u32, signal_timeline_value: u64) bool {
+fn submit_command_buffer(s: *types.VulkanState, cmd: c.VkCommandBuffer, acquire_sem: c.VkSemaphore, wait_timeline_value: ?u64, upload_wait: ?vk_staging_ring.Wait, image_index: u32, signal_timeline_value: u64) bool {
     const zone = tracy.zoneS(@src(), "Submit Command Buffer");
     defer zone.end();
 
@@ -265,7 +267,29 @@ fn submit_command_buffer(s: *types.VulkanState, cmd: c.VkCommandBuffer, acquire_
         .deviceIndex = 0,
     };
 
-    var wait_infos = [2]c.VkSemaphoreSubmitInfo{ wait_info, timeline_wait_info };
+    var wait_infos: [5]c.VkSemaphoreSubmitInfo = undefined;
+    var wait_count: u32 = 0;
+    wait_infos[wait_count] = wait_info;
+    wait_count += 1;
+    if (has_timeline_wait) {
+        wait_infos[wait_count] = timeline_wait_info;
+        wait_count += 1;
+    }
+    if (upload_wait) |upload| {
+        wait_infos[wait_count] = .{
+            .sType = c.VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+            .pNext = null,
+            .semaphore = upload.semaphore,
+            .value = upload.value,
+            .stageMask = c.VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            .deviceIndex = 0,
+        };
+        wait_count += 1;
+    }
+    var graph_waits: [2]c.VkSemaphoreSubmitInfo = undefined;
+    const graph_wait_count = vk_graph_submit.final_waits(&graph_waits);
+    @memcpy(wait_infos[wait_count..][0..graph_wait_count], graph_waits[0..graph_wait_count]);
+    wait_count += graph_wait_count;
 
     const binary_signal_info = c.VkSemaphoreSubmitInfo{
         .sType = c.VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
@@ -291,7 +315,18 @@ fn submit_command_buffer(s: *types.VulkanState, cmd: c.VkCommandBuffer, acquire_
         .deviceIndex = 0,
     };
 
-    var signal_infos = [2]c.VkSemaphoreSubmitInfo{ binary_signal_info, timeline_signal_info };
+    var signal_infos: [3]c.VkSemaphoreSubmitInfo = undefined;
+    var signal_count: u32 = 0;
+    signal_infos[signal_count] = binary_signal_info;
+    signal_count += 1;
+    if (has_timeline_signal) {
+        signal_infos[signal_count] = timeline_signal_info;
+        signal_count += 1;
+    }
+    if (vk_graph_submit.final_signal()) |graph_signal| {
+        signal_infos[signal_count] = graph_signal;
+        signal_count += 1;
+    }
 
     var cmd_info = c.VkCommandBufferSubmitInfo{
         .sType = c.VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
@@ -304,11 +339,11 @@ fn submit_command_buffer(s: *types.VulkanState, cmd: c.VkCommandBuffer, acquire_
         .sType = c.VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
         .pNext = null,
         .flags = 0,
-        .waitSemaphoreInfoCount = if (has_timeline_wait) 2 else 1,
+        .waitSemaphoreInfoCount = wait_count,
         .pWaitSemaphoreInfos = &wait_infos[0],
         .commandBufferInfoCount = 1,
         .pCommandBufferInfos = &cmd_info,
-        .signalSemaphoreInfoCount = if (has_timeline_signal) 2 else 1,
+        .signalSemaphoreInfoCount = signal_count,
         .pSignalSemaphoreInfos = &signal_infos[0],
     };
 
@@ -328,59 +363,93 @@ fn submit_command_buffer(s: *types.VulkanState, cmd: c.VkCommandBuffer, acquire_
     return true;
 }
 
-fn submit_compute_command_buffer(s: *types.VulkanState, cmd: c.VkCommandBuffer, signal_value: u64, wait_timeline_value: ?u64) bool {
-    const zone = tracy.zoneS(@src(), "Submit Compute Command Buffer");
-    defer zone.end();
+/// Submits the render graph batches recorded for the other queue and for earlier graphics work.
+///
+/// Each batch waits on the frame's texture and staging-ring uploads as well as its cross-queue
+/// dependency, and signals its queue's graph timeline.
+fn submit_graph_batches(s: *types.VulkanState, wait_timeline_value: ?u64, upload_wait: ?vk_staging_ring.Wait) bool {
+    const batches = vk_graph_submit.pending();
+    if (batches.len == 0) return true;
 
-    const timeline_wait_info = c.VkSemaphoreSubmitInfo{
-        .sType = c.VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
-        .pNext = null,
-        .semaphore = s.sync.timeline_semaphore,
-        .value = if (wait_timeline_value) |v| v else 0,
-        .stageMask = c.VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
-        .deviceIndex = 0,
-    };
-
-    var wait_infos = [1]c.VkSemaphoreSubmitInfo{timeline_wait_info};
-
-    var signal_infos = [1]c.VkSemaphoreSubmitInfo{.{
-        .sType = c.VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
-        .pNext = null,
-        .semaphore = s.sync.timeline_semaphore,
-        .value = signal_value,
-        .stageMask = c.VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
-        .deviceIndex = 0,
-    }};
-
-    var cmd_info = c.VkCommandBufferSubmitInfo{
-        .sType = c.VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
-        .pNext = null,
-        .commandBuffer = cmd,
-        .deviceMask = 0,
-    };
+    const zone = tracy.zoneS(@src(), "Submit Graph Batches");
+    defer zone.end();
 
-    var submit_info = c.VkSubmitInfo2{
-        .sType = c.VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
-        .pNext = null,
-        .flags = 0,
-        .waitSemaphoreInfoCount = if (wait_timeline_value != null) 1 else 0,
-        .pWaitSemaphoreInfos = if (wait_timeline_value != null) &wait_infos[0] else null,
-        .commandBufferInfoCount = 1,
-        .pCommandBufferInfos = &cmd_info,
-        .signalSemaphoreInfoCount = 1,
-        .pSignalSemaphoreInfos = &signal_infos[0],
-    };
+    for (batches) |batch| {
+        var wait_infos: [3]c.VkSemaphoreSubmitInfo = undefined;
+        var wait_count: u32 = 0;
+        if (batch.wait) |w| {
+            wait_infos[wait_count] = .{
+                .sType = c.VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+                .pNext = null,
+                .semaphore = vk_graph_submit.timeline(w.queue),
+                .value = w.value,
+                .stageMask = w.stage_mask,
+                .deviceIndex = 0,
+            };
+            wait_count += 1;
+        }
+        if (wait_timeline_value != null and s.sync.timeline_semaphore != null) {
+            wait_infos[wait_count] = .{
+                .sType = c.VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+                .pNext = null,
+                .semaphore = s.sync.timeline_semaphore,
+                .value = wait_timeline_value.?,
+                .stageMask = c.VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                .deviceIndex = 0,
+            };
+            wait_count += 1;
+        }
+        if (upload_wait) |upload| {
+            wait_infos[wait_count] = .{
+                .sType = c.VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+                .pNext = null,
+                .semaphore = upload.semaphore,
+                .value = upload.value,
+                .stageMask = c.VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+                .deviceIndex = 0,
+            };
+            wait_count += 1;
+        }
 
-    var res: c.VkResult = c.VK_SUCCESS;
-    res = vk_sync_manager.vulkan_sync_manager_submit_queue2(s.context.compute_queue, 1, @ptrCast(&submit_info), null, s.context.vkQueueSubmit2);
-    if (res == c.VK_ERROR_DEVICE_LOST) {
-        s.recovery.device_lost = true;
-        if (s.recovery.attempt_count < s.recovery.max_attempts)
-            _ = vk_device_loss_recovery.recover_from_device_loss(s);
-        return false;
-    } else if (res != c.VK_SUCCESS) {
-        frame_log.err("Compute queue submit failed: {d}", .{res});
-        return false;
+        const signal_info = c.VkSemaphoreSubmitInfo{
+            .sType = c.VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+            .pNext = null,
+            .semaphore = vk_graph_submit.timeline(batch.queue),
+            .value = batch.signal_value,
+            .stageMask = c.VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            .deviceIndex = 0,
+        };
+
+        var cmd_info = c.VkCommandBufferSubmitInfo{
+            .sType = c.VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+            .pNext = null,
+            .commandBuffer = batch.cmd,
+            .deviceMask = 0,
+        };
+
+        var submit_info = c.VkSubmitInfo2{
+            .sType = c.VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+            .pNext = null,
+            .flags = 0,
+            .waitSemaphoreInfoCount = wait_count,
+            .pWaitSemaphoreInfos = if (wait_count > 0) &wait_infos[0] else null,
+            .commandBufferInfoCount = 1,
+            .pCommandBufferInfos = &cmd_info,
+            .signalSemaphoreInfoCount = 1,
+            .pSignalSemaphoreInfos = &signal_info,
+        };
+
+        const queue = if (batch.queue == .compute) s.context.compute_queue else s.context.graphics_queue;
+        const res = vk_sync_manager.vulkan_sync_manager_submit_queue2(queue, 1, @ptrCast(&submit_info), null, s.context.vkQueueSubmit2);
+        if (res == c.VK_ERROR_DEVICE_LOST) {
+            s.recovery.device_lost = true;
+            if (s.recovery.attempt_count < s.recovery.max_attempts)
+                _ = vk_device_loss_recovery.recover_from_device_loss(s);
+            return false;
+        } else if (res != c.VK_SUCCESS) {
+            frame_log.err("Render graph {s} batch submit failed: {d}", .{ @tagName(batch.queue), res });
+            return false;
+        }
     }
     return true;
 }
@@ -454,6 +523,12 @@ pub export fn cardinal_renderer_draw_frame(renderer: ?*types.CardinalRenderer) c
         return;
     }
 
+    // Uploads made while this frame is prepared share one ring submission, which the frame's
+    // submit waits on; anything still open on an early return is submitted and waited here.
+    const staging_ring = vk_staging_ring.active();
+    if (staging_ring) |ring| ring.begin_batch();
+    defer if (staging_ring) |ring| ring.end_batch();
+
     vk_mt.cardinal_mt_process_completed_tasks(128);
 
     vk_mesh_shader.vk_mesh_shader_process_pending_cleanup(s);
@@ -470,6 +545,7 @@ pub export fn cardinal_renderer_draw_frame(renderer: ?*types.CardinalRenderer) c
 
     if (s.pipelines.use_pbr_pipeline) {
         vk_pbr.vk_pbr_update_uniforms(@ptrCast(&s.pipelines.pbr_pipeline), @ptrCast(&s.pipelines.pbr_pipeline.current_ubo), @ptrCast(&s.pipelines.pbr_pipeline.current_lighting), s.sync.current_frame);
+        vk_pbr.vk_pbr_update_light_clusters(@ptrCast(&s.pipelines.pbr_pipeline), s.swapchain.extent.width, s.swapchain.extent.height, s.sync.current_frame);
     }
 
     if (s.pipelines.use_ssao and s.pipelines.ssao_pipeline.initialized) {
@@ -527,11 +603,17 @@ pub export fn cardinal_renderer_draw_frame(renderer: ?*types.CardinalRenderer) c
     if (cmd_buf == null)
         return;
 
+    const upload_wait = if (staging_ring) |ring| ring.flush() else null;
+
+    if (!submit_graph_batches(s, texture_upload_signal, upload_wait))
+        return;
+
     if (!submit_command_buffer(
         s,
         cmd_buf,
         s.sync.image_acquired_semaphores.?[s.sync.current_frame],
         texture_upload_signal,
+        upload_wait,
         image_index,
         signal_after_render,
     ))
@@ -1,7 +1,9 @@
 //! Cascaded shadow mapping for the PBR pipeline.
 //!
 //! Computes cascade splits from the active camera, builds light-space matrices for a chosen
-//! directional light, and records the shadow render pass.
+//! directional light, and records the shadow render pass. Each cascade draws only the casters
+//! that `shadow_caster_culling` finds inside its extruded light-space volume, and the far
+//! cascades (`shadow_cached_cascades`) keep last frame's depth while nothing in them changed.
 const std = @import("std");
 const c = @import("vulkan_c.zig").c;
 const types = @import("vulkan_types.zig");
@@ -15,6 +17,8 @@ const vk_pso = @import("vulkan_pso.zig");
 const material_utils = @import("util/vulkan_material_utils.zig");
 const descriptor_mgr = @import("vulkan_descriptor_manager.zig");
 const cascade_math = @import("util/vulkan_shadow_cascades.zig");
+const caster_culling = @import("shadow_caster_culling.zig");
+const memory = @import("../core/memory.zig");
 
 const shadows_log = log.ScopedLogger("SHADOWS");
 
@@ -22,6 +26,150 @@ var last_no_lights_log_ms: i64 = -10_000;
 var last_no_directional_log_ms: i64 = -10_000;
 var last_using_directional_log_ms: i64 = -10_000;
 
+/// What a shadow draw needs besides its cascade.
+const CasterDraw = extern struct {
+    transform: [16]f32,
+    first_index: u32,
+    index_count: u32,
+    packed_info: u32,
+    texture_index: u32,
+    alpha_cutoff: f32,
+};
+
+const SKINNED_FLAG: u32 = 4 << 16;
+
+const CasterCache = struct {
+    culler: caster_culling.CasterCuller = .{},
+    casters: std.ArrayListUnmanaged(caster_culling.Caster) = .{},
+    draws: std.ArrayListUnmanaged(CasterDraw) = .{},
+    skinned: std.ArrayListUnmanaged(bool) = .{},
+    /// Shadow map the cached cascades live in; a new image drops them.
+    image: c.VkImage = null,
+    allocator: ?std.mem.Allocator = null,
+
+    fn deinit(self: *CasterCache) void {
+        if (self.allocator) |a| {
+            self.culler.deinit(a);
+            self.casters.deinit(a);
+            self.draws.deinit(a);
+            self.skinned.deinit(a);
+        }
+        self.* = .{};
+    }
+};
+
+var g_caster_cache: CasterCache = .{};
+
+/// Frees caster culling state and forgets cached cascades; called when the PBR pipeline goes away.
+pub fn release_caster_cache() void {
+    g_caster_cache.deinit();
+}
+
+/// True when the shadow map holds cascades a later frame may reuse, so its contents (and layout)
+/// must carry over between frames instead of being discarded.
+pub fn shadow_map_preserved() bool {
+    return g_caster_cache.culler.has_cached();
+}
+
+/// Caster culling counters from the last shadow pass.
+pub fn caster_stats() caster_culling.Stats {
+    return g_caster_cache.culler.stats;
+}
+
+/// Marks meshes deformed by a skin; they are drawn with the skinning flag and never cached.
+fn mark_skinned(scn: *const scene.CardinalScene, skinned: []bool) void {
+    @memset(skinned, false);
+    if (scn.animation_system == null or scn.skin_count == 0) return;
+    if (scn.skin_count >= 100) {
+        shadows_log.err("Suspicious skin count: {d}", .{scn.skin_count});
+        return;
+    }
+    const skins = @as([*]animation.CardinalSkin, @ptrCast(@alignCast(scn.skins orelse return)));
+    var skin_idx: u32 = 0;
+    while (skin_idx < scn.skin_count) : (skin_idx += 1) {
+        const skin = &skins[skin_idx];
+        if (skin.mesh_count > 1000) {
+            shadows_log.warn("Skin {d} has suspicious mesh_count: {d}", .{ skin_idx, skin.mesh_count });
+            break;
+        }
+        const indices = skin.mesh_indices orelse continue;
+        var mesh_idx: u32 = 0;
+        while (mesh_idx < skin.mesh_count) : (mesh_idx += 1) {
+            if (indices[mesh_idx] < skinned.len) skinned[indices[mesh_idx]] = true;
+        }
+    }
+}
+
+/// Gathers every mesh that can cast a shadow with its world bounds and draw parameters.
+fn collect_casters(cache: *CasterCache, allocator: std.mem.Allocator, pipe: *const types.VulkanPBRPipeline, scn: *const scene.CardinalScene) !void {
+    cache.casters.clearRetainingCapacity();
+    cache.draws.clearRetainingCapacity();
+    const meshes = scn.meshes orelse return;
+    const mesh_count: usize = @intCast(scn.mesh_count);
+    try cache.skinned.resize(allocator, mesh_count);
+    mark_skinned(scn, cache.skinned.items);
+    try cache.casters.ensureTotalCapacity(allocator, mesh_count);
+    try cache.draws.ensureTotalCapacity(allocator, mesh_count);
+
+    var index_offset: u64 = 0;
+    for (0..mesh_count) |m_i| {
+        const mesh = &meshes[m_i];
+        if (mesh.index_count == 0) continue;
+        const first_index = index_offset;
+        index_offset += mesh.index_count;
+        if (index_offset > @as(u64, pipe.totalIndexCount)) break;
+        if (mesh.vertex_count == 0 or !mesh.visible) continue;
+
+        var alpha_tested = false;
+        var texture_idx: u32 = 0;
+        var alpha_cutoff: f32 = 0.0;
+        if (mesh.material_index < scn.material_count) {
+            if (scn.materials) |mats| {
+                const mat = &mats[mesh.material_index];
+                if (mat.alpha_mode == scene.CardinalAlphaMode.MASK) {
+                    alpha_tested = true;
+                    texture_idx = mat.albedo_texture.index;
+                    alpha_cutoff = mat.alpha_cutoff;
+                }
+            }
+        }
+        if (alpha_tested and pipe.shadowAlphaPipeline == null) continue;
+
+        const skinned = cache.skinned.items[m_i];
+        const draw = CasterDraw{
+            .transform = mesh.transform,
+            .first_index = @intCast(first_index),
+            .index_count = mesh.index_count,
+            .packed_info = if (skinned) SKINNED_FLAG else 0,
+            .texture_index = texture_idx,
+            .alpha_cutoff = alpha_cutoff,
+        };
+        const local = math.AABB{
+            .min = math.Vec3.fromArray(mesh.bounding_box_min),
+            .max = math.Vec3.fromArray(mesh.bounding_box_max),
+        };
+        cache.casters.appendAssumeCapacity(.{
+            .bounds = local.transformFast(math.Mat4.fromArray(mesh.transform)),
+            .alpha_tested = alpha_tested,
+            .dynamic = skinned or mesh.morph_target_count > 0,
+            .state_hash = std.hash.Wyhash.hash(0, std.mem.asBytes(&draw)),
+        });
+        cache.draws.appendAssumeCapacity(draw);
+    }
+}
+
+fn draw_caster(cmd: c.VkCommandBuffer, pipe: *const types.VulkanPBRPipeline, draw: *const CasterDraw, cascade: u32) void {
+    var push = std.mem.zeroes(types.ShadowPushConstants);
+    push.model = draw.transform;
+    push.texture_index = draw.texture_index;
+    push.alpha_cutoff = draw.alpha_cutoff;
+    push.packed_info = draw.packed_info;
+    push.cascade_index = cascade;
+
+    c.vkCmdPushConstants(cmd, pipe.shadowPipelineLayout, c.VK_SHADER_STAGE_VERTEX_BIT | c.VK_SHADER_STAGE_FRAGMENT_BIT, 0, @intCast(@sizeOf(types.ShadowPushConstants)), &push);
+    c.vkCmdDrawIndexed(cmd, draw.index_count, 1, draw.first_index, 0, 0);
+}
+
 /// Records the shadow pass for the current frame when the PBR pipeline is active.
 ///
 /// TODO: Tune depth bias per scene to reduce acne/peter-panning.
@@ -105,9 +253,10 @@ pub fn vk_shadow_render(s: *types.VulkanState, cmd: c.VkCommandBuffer) void {
 
     var cascadeSplits = [_]f32{0} ** types.MAX_SHADOW_CASCADES;
     var lightSpaceMatrices = [_]math.Mat4{math.Mat4.identity()} ** types.MAX_SHADOW_CASCADES;
+    var casterVolumes = [_]math.Mat4{math.Mat4.identity()} ** types.MAX_SHADOW_CASCADES;
     const cascade_count_u32: u32 = @min(s.config.shadow_cascade_count, @as(u32, pipe.shadowCascadeViews.len));
     const cascade_count: usize = @intCast(cascade_count_u32);
-    cascade_math.build_shadow_cascades(&s.config, ubo, lightDir, cascade_count, cascadeSplits[0..cascade_count], lightSpaceMatrices[0..cascade_count]);
+    cascade_math.build_shadow_cascades(&s.config, ubo, lightDir, cascade_count, cascadeSplits[0..cascade_count], lightSpaceMatrices[0..cascade_count], casterVolumes[0..cascade_count]);
 
     const frame = if (s.sync.current_frame >= types.MAX_FRAMES_IN_FLIGHT) 0 else s.sync.current_frame;
     if (pipe.shadowUBOsMapped[frame]) |ptr| {
@@ -135,9 +284,41 @@ pub fn vk_shadow_render(s: *types.VulkanState, cmd: c.VkCommandBuffer) void {
         return;
     }
 
-    var j_layer: u32 = 0;
-    while (j_layer < cascade_count_u32) : (j_layer += 1) {
-        var indexOffset: u32 = 0;
+    const cache = &g_caster_cache;
+    const allocator = memory.cardinal_get_allocator_for_category(.RENDERER).as_allocator();
+    if (cache.allocator == null) cache.allocator = allocator;
+    if (cache.image != pipe.shadowMapImage) {
+        cache.culler.invalidate();
+        cache.image = pipe.shadowMapImage;
+    }
+
+    var cascades: [types.MAX_SHADOW_CASCADES]caster_culling.Cascade = undefined;
+    const first_cached = cascade_count -| @as(usize, s.config.shadow_cached_cascades);
+    for (cascades[0..cascade_count], 0..) |*cascade, j| {
+        cascade.* = .{ .light_space = lightSpaceMatrices[j], .volume = casterVolumes[j], .cacheable = j >= first_cached };
+    }
+    // Anything that moves geometry around in the shared buffers invalidates every cascade.
+    const geometry = [_]u64{ @intFromPtr(pipe.vertexBuffer), @intFromPtr(pipe.indexBuffer), pipe.totalIndexCount, s.config.shadow_map_size };
+    const salt = std.hash.Wyhash.hash(0, std.mem.sliceAsBytes(&geometry));
+
+    collect_casters(cache, allocator, pipe, scn) catch |err| {
+        shadows_log.err("Failed to collect shadow casters: {s}", .{@errorName(err)});
+        cache.culler.invalidate();
+        return;
+    };
+    const cascade_draws = cache.culler.update(allocator, cache.casters.items, cascades[0..cascade_count], salt, .{}) catch |err| {
+        shadows_log.err("Failed to cull shadow casters: {s}", .{@errorName(err)});
+        cache.culler.invalidate();
+        return;
+    };
+
+    for (cascade_draws, 0..) |draws, j| {
+        const j_layer: u32 = @intCast(j);
+        if (!draws.render) {
+            shadows_log.debug("Cascade {d}: cached", .{j_layer});
+            continue;
+        }
+        shadows_log.debug("Cascade {d}: {d} of {d} casters", .{ j_layer, draws.casters.len, cache.casters.items.len });
 
         var renderingInfo = std.mem.zeroes(c.VkRenderingInfo);
         renderingInfo.sType = c.VK_STRUCTURE_TYPE_RENDERING_INFO;
@@ -188,6 +369,8 @@ pub fn vk_shadow_render(s: *types.VulkanState, cmd: c.VkCommandBuffer) void {
             if (s.context.vkCmdEndRendering) |func| {
                 func(cmd);
             }
+            // Cleared but not drawn.
+            cache.culler.invalidate_cascade(j);
             continue;
         }
 
@@ -199,191 +382,14 @@ pub fn vk_shadow_render(s: *types.VulkanState, cmd: c.VkCommandBuffer) void {
             c.vkCmdBindIndexBuffer(cmd, pipe.indexBuffer, 0, c.VK_INDEX_TYPE_UINT32);
         }
 
-        shadows_log.debug("Cascade {d}: Starting Pass 1 (Opaque)", .{j_layer});
-        var m_i: u32 = 0;
-        var drawn_count: u32 = 0;
-        var candidate_count: u32 = 0;
-        while (m_i < scn.mesh_count) : (m_i += 1) {
-            shadows_log.debug("Pass 1: Mesh {d}", .{m_i});
-            if (scn.meshes == null) {
-                shadows_log.err("scn.meshes is null!", .{});
-                break;
-            }
-            const mesh = &scn.meshes.?[m_i];
-
-            if (mesh.index_count == 0) {
-                continue;
-            }
-
-            var is_alpha_tested = false;
-            if (mesh.material_index < scn.material_count) {
-                shadows_log.debug("Checking material {d}", .{mesh.material_index});
-                if (scn.materials) |mats| {
-                    const mat = &mats[mesh.material_index];
-                    if (mat.alpha_mode == scene.CardinalAlphaMode.MASK) {
-                        is_alpha_tested = true;
-                    }
-                }
-            }
-
-            if (is_alpha_tested) {
-                if (pipe.shadowAlphaPipeline != null and mesh.vertex_count > 0 and mesh.visible) {
-                    candidate_count += 1;
-                }
-                const next_offset: u64 = @as(u64, indexOffset) + @as(u64, mesh.index_count);
-                if (next_offset > @as(u64, pipe.totalIndexCount)) break;
-                indexOffset = @intCast(next_offset);
-                continue;
-            }
-
-            if (mesh.vertex_count == 0 or !mesh.visible) {
-                const next_offset: u64 = @as(u64, indexOffset) + @as(u64, mesh.index_count);
-                if (next_offset > @as(u64, pipe.totalIndexCount)) break;
-                indexOffset = @intCast(next_offset);
-                continue;
-            }
-
-            candidate_count += 1;
-            drawn_count += 1;
-
-            var packedInfo: u32 = 0;
-            if (scn.animation_system != null and scn.skin_count > 0) {
-                shadows_log.debug("Checking skins for mesh {d}. Skin count: {d}", .{ m_i, scn.skin_count });
-                if (scn.skin_count < 100) {
-                    if (scn.skins) |skins_ptr| {
-                        const skins = @as([*]animation.CardinalSkin, @ptrCast(@alignCast(skins_ptr)));
-                        var skin_idx: u32 = 0;
-                        while (skin_idx < scn.skin_count) : (skin_idx += 1) {
-                            const skin = &skins[skin_idx];
-                            if (skin.mesh_count > 1000) {
-                                shadows_log.warn("Skin {d} has suspicious mesh_count: {d}", .{ skin_idx, skin.mesh_count });
-                                break;
-                            }
-                            if (skin.mesh_indices) |indices| {
-                                var mesh_idx: u32 = 0;
-                                while (mesh_idx < skin.mesh_count) : (mesh_idx += 1) {
-                                    if (indices[mesh_idx] == m_i) {
-                                        packedInfo |= (4 << 16);
-                                        break;
-                                    }
-                                }
-                            }
-                            if ((packedInfo & (4 << 16)) != 0) break;
-                        }
-                    }
-                } else {
-                    shadows_log.err("Suspicious skin count: {d}", .{scn.skin_count});
-                }
-            }
-
-            const cascadeIdx = @as(u32, @intCast(j_layer));
-            var push = std.mem.zeroes(types.ShadowPushConstants);
-            push.model = mesh.transform;
-            push.packed_info = packedInfo;
-            push.cascade_index = cascadeIdx;
-
-            c.vkCmdPushConstants(cmd, pipe.shadowPipelineLayout, c.VK_SHADER_STAGE_VERTEX_BIT | c.VK_SHADER_STAGE_FRAGMENT_BIT, 0, @intCast(@sizeOf(types.ShadowPushConstants)), &push);
-
-            if (@as(u64, indexOffset) + @as(u64, mesh.index_count) > @as(u64, pipe.totalIndexCount)) {
-                break;
-            }
-
-            c.vkCmdDrawIndexed(cmd, mesh.index_count, 1, indexOffset, 0, 0);
-
-            const next_offset: u64 = @as(u64, indexOffset) + @as(u64, mesh.index_count);
-            if (next_offset > @as(u64, pipe.totalIndexCount)) break;
-            indexOffset = @intCast(next_offset);
+        for (draws.casters[0..draws.alpha_start]) |caster| {
+            draw_caster(cmd, pipe, &cache.draws.items[caster], j_layer);
         }
 
-        if (pipe.shadowAlphaPipeline != null) {
+        if (draws.alpha_start < draws.casters.len) {
             c.vkCmdBindPipeline(cmd, c.VK_PIPELINE_BIND_POINT_GRAPHICS, pipe.shadowAlphaPipeline);
-
-            indexOffset = 0;
-            m_i = 0;
-            while (m_i < scn.mesh_count) : (m_i += 1) {
-                if (scn.meshes == null) break;
-                const mesh = &scn.meshes.?[m_i];
-
-                if (mesh.index_count == 0) {
-                    continue;
-                }
-
-                var is_alpha_tested = false;
-                var texture_idx: u32 = 0;
-                var alpha_cutoff: f32 = 0.5;
-
-                if (mesh.material_index < scn.material_count and scn.materials != null) {
-                    const mat = &scn.materials.?[mesh.material_index];
-                    if (mat.alpha_mode == scene.CardinalAlphaMode.MASK) {
-                        is_alpha_tested = true;
-                        texture_idx = mat.albedo_texture.index;
-                        alpha_cutoff = mat.alpha_cutoff;
-                    }
-                }
-
-                if (!is_alpha_tested) {
-                    const next_offset: u64 = @as(u64, indexOffset) + @as(u64, mesh.index_count);
-                    if (next_offset > @as(u64, pipe.totalIndexCount)) break;
-                    indexOffset = @intCast(next_offset);
-                    continue;
-                }
-
-                if (mesh.vertex_count == 0 or !mesh.visible) {
-                    const next_offset: u64 = @as(u64, indexOffset) + @as(u64, mesh.index_count);
-                    if (next_offset > @as(u64, pipe.totalIndexCount)) break;
-                    indexOffset = @intCast(next_offset);
-                    continue;
-                }
-
-                drawn_count += 1;
-
-                var packedInfo: u32 = 0;
-                if (scn.animation_system != null and scn.skin_count > 0) {
-                    if (scn.skin_count < 100 and scn.skins != null) {
-                        const skins = @as([*]animation.CardinalSkin, @ptrCast(@alignCast(scn.skins.?)));
-                        var skin_idx: u32 = 0;
-                        while (skin_idx < scn.skin_count) : (skin_idx += 1) {
-                            const skin = &skins[skin_idx];
-                            if (skin.mesh_count > 1000) break;
-                            if (skin.mesh_indices) |indices| {
-                                var mesh_idx: u32 = 0;
-                                while (mesh_idx < skin.mesh_count) : (mesh_idx += 1) {
-                                    if (indices[mesh_idx] == m_i) {
-                                        packedInfo |= (4 << 16);
-                                        break;
-                                    }
-                                }
-                            }
-                            if ((packedInfo & (4 << 16)) != 0) break;
-                        }
-                    }
-                }
-
-                const cascadeIdx = @as(u32, @intCast(j_layer));
-                var push = std.mem.zeroes(types.ShadowPushConstants);
-                push.model = mesh.transform;
-                push.texture_index = texture_idx;
-                push.alpha_cutoff = alpha_cutoff;
-                push.packed_info = packedInfo;
-                push.cascade_index = cascadeIdx;
-
-                c.vkCmdPushConstants(cmd, pipe.shadowPipelineLayout, c.VK_SHADER_STAGE_VERTEX_BIT | c.VK_SHADER_STAGE_FRAGMENT_BIT, 0, @intCast(@sizeOf(types.ShadowPushConstants)), &push);
-
-                if (@as(u64, indexOffset) + @as(u64, mesh.index_count) > @as(u64, pipe.totalIndexCount)) {
-                    break;
-                }
-
-                c.vkCmdDrawIndexed(cmd, mesh.index_count, 1, indexOffset, 0, 0);
-
-                const next_offset: u64 = @as(u64, indexOffset) + @as(u64, mesh.index_count);
-                if (next_offset > @as(u64, pipe.totalIndexCount)) break;
-                indexOffset = @intCast(next_offset);
-            }
-        }
-
-        if (scn.mesh_count > 0 and j_layer == 0 and drawn_count == 0) {
-            if (candidate_count > 0) {
-                shadows_log.warn("No meshes drawn for cascade 0! Total meshes: {d}", .{scn.mesh_count});
+            for (draws.casters[draws.alpha_start..]) |caster| {
+                draw_caster(cmd, pipe, &cache.draws.items[caster], j_layer);
             }
         }
 
@@ -1,6 +1,7 @@
 //! Skybox pipeline and texture management.
 //!
 //! Loads an equirectangular skybox texture, uploads it to the GPU, and renders a background pass.
+//! HDR skyboxes baked with `zig build bake-ibl` also provide irradiance SH for the PBR ambient term.
 const std = @import("std");
 const memory = @import("../core/memory.zig");
 const descriptor_mgr = @import("vulkan_descriptor_manager.zig");
@@ -18,6 +19,8 @@ const scene = @import("../assets/scene.zig");
 const ref_counting = @import("../core/ref_counting.zig");
 const resource_state = @import("../core/resource_state.zig");
 const pipeline_json = @import("util/vulkan_pipeline_json.zig");
+const ibl_cooker = @import("../assets/ibl_cooker.zig");
+const vfs = @import("../core/vfs.zig");
 
 const skybox_log = log.ScopedLogger("SKYBOX");
 
@@ -30,6 +33,7 @@ pub const SkyboxPushConstants = extern struct {
 /// Initializes the skybox pipeline (descriptor set + graphics pipeline).
 pub fn vk_skybox_pipeline_init(pipeline: *types.SkyboxPipeline, device: c.VkDevice, format: c.VkFormat, depthFormat: c.VkFormat, allocator: *types.VulkanAllocator, vulkan_state: ?*types.VulkanState) bool {
     pipeline.initialized = false;
+    vk_skybox_clear_environment(pipeline);
     pipeline.descriptorSets = std.mem.zeroes([types.MAX_FRAMES_IN_FLIGHT]c.VkDescriptorSet);
 
     const renderer_allocator = memory.cardinal_get_allocator_for_category(.RENDERER).as_allocator();
@@ -107,9 +111,36 @@ pub fn vk_skybox_pipeline_destroy(pipeline: *types.SkyboxPipeline, device: c.VkD
     c.vkDestroyPipeline(device, pipeline.pipeline, null);
     c.vkDestroyPipelineLayout(device, pipeline.pipelineLayout, null);
 
+    vk_skybox_clear_environment(pipeline);
     pipeline.initialized = false;
 }
 
+/// Picks up the baked IBL of the skybox file at `path`, if `bake-ibl` has cooked it. Only the SH
+/// header is read here; the PBR pipeline uploads the specular chain and LUT of `environmentKey`.
+fn load_environment(pipeline: *types.SkyboxPipeline, path: []const u8) void {
+    vk_skybox_clear_environment(pipeline);
+    if (!ibl_cooker.is_enabled()) return;
+
+    // Skyboxes read from packs have no host file to key the cache by.
+    var path_buf: [std.fs.max_path_bytes]u8 = undefined;
+    const host = vfs.host_path(path, &path_buf) orelse return;
+    const key = ibl_cooker.file_key(host) catch return;
+    if (ibl_cooker.load_cached_sh(key)) |sh| {
+        pipeline.environmentSH = sh;
+        pipeline.environmentKey = key;
+        pipeline.hasEnvironmentSH = true;
+        skybox_log.info("Using baked skybox IBL {x:0>16}", .{key});
+    } else {
+        skybox_log.info("No baked IBL for '{s}' ({x:0>16}); run `zig build bake-ibl -- <skybox>` to light the scene with it", .{ path, key });
+    }
+}
+
+/// Drops the baked IBL, e.g. for a skybox set from decoded data with no file behind it.
+pub fn vk_skybox_clear_environment(pipeline: *types.SkyboxPipeline) void {
+    pipeline.hasEnvironmentSH = false;
+    pipeline.environmentKey = 0;
+}
+
 /// Uploads a skybox texture from already-decoded data and updates descriptors.
 /// Keeps the previous skybox GPU resources alive until the shared timeline semaphore advances.
 pub fn vk_skybox_load_from_data(pipeline: *types.SkyboxPipeline, device: c.VkDevice, allocator: *types.VulkanAllocator, commandPool: c.VkCommandPool, graphicsQueue: c.VkQueue, sync_manager: ?*types.VulkanSyncManager, textureData: texture_loader.TextureData) bool {
@@ -212,6 +243,7 @@ pub fn vk_skybox_load(pipeline: *types.SkyboxPipeline, device: c.VkDevice, alloc
 
     if (vk_skybox_load_from_data(pipeline, device, allocator, commandPool, graphicsQueue, sync_manager, textureData)) {
         pipeline.texture.resource = res;
+        load_environment(pipeline, path);
 
         const state = resource_state.cardinal_resource_state_get(res.?.identifier.?);
         pipeline.texture.isPlaceholder = (state == .LOADING);
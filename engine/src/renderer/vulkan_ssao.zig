@@ -378,7 +378,7 @@ fn create_noise_and_kernel(s: *types.VulkanState) bool {
         vk_allocator.unmap_memory(&s.allocator, staging_alloc);
     }
 
-    if (!vk_texture_utils.create_image_and_memory(&s.allocator, s.context.device, 4, 4, c.VK_FORMAT_R32G32B32A32_SFLOAT, &s.pipelines.ssao_pipeline.noise_texture.image, &s.pipelines.ssao_pipeline.noise_texture.memory, &s.pipelines.ssao_pipeline.noise_texture.allocation)) {
+    if (!vk_texture_utils.create_image_and_memory(&s.allocator, s.context.device, 4, 4, c.VK_FORMAT_R32G32B32A32_SFLOAT, 1, &s.pipelines.ssao_pipeline.noise_texture.image, &s.pipelines.ssao_pipeline.noise_texture.memory, &s.pipelines.ssao_pipeline.noise_texture.allocation)) {
         vk_allocator.free_buffer(&s.allocator, staging_buffer, staging_alloc);
         vk_allocator.free_buffer(&s.allocator, s.pipelines.ssao_pipeline.kernel_buffer, s.pipelines.ssao_pipeline.kernel_allocation);
         return false;
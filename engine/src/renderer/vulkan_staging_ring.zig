@@ -0,0 +1,628 @@
+//! Persistent staging ring for buffer and texture uploads.
+//!
+//! One host-visible, persistently mapped buffer is handed out front to back in aligned slices.
+//! Copies are recorded into a single open command buffer and submitted together, on the dedicated
+//! transfer queue when the device exposes one, signalling the ring's own timeline semaphore. Every
+//! submission remembers how far the ring head had advanced, so once the semaphore reaches its value
+//! everything before that point can be reused; nothing is allocated or freed per upload.
+//!
+//! Outside a batch each upload is submitted and waited on before returning, which keeps the
+//! synchronous contract of `vk_buffer_create_device_local`. Inside `begin_batch`/`end_batch`
+//! (scene loads) uploads coalesce into one submission and one wait. Batches belong to the calling
+//! thread: an open batch on the render thread does not defer uploads made by loader threads.
+//! During a frame the renderer calls `flush` before its main submit and has the GPU wait on the
+//! returned value instead.
+//!
+//! When the transfer queue belongs to its own family, resources written through the ring are
+//! created with concurrent sharing between the transfer and graphics families (plus compute for
+//! storage resources), so no ownership transfer barriers are needed. Everything else stays
+//! exclusive.
+const std = @import("std");
+const log = @import("../core/log.zig");
+const memory = @import("../core/memory.zig");
+const profiler = @import("../core/profiler.zig");
+const types = @import("vulkan_types.zig");
+const buffer_mgr = @import("vulkan_buffer_manager.zig");
+const vk_sync_manager = @import("vulkan_sync_manager.zig");
+const vk_texture_utils = @import("util/vulkan_texture_utils.zig");
+
+const c = @import("vulkan_c.zig").c;
+
+const ring_log = log.ScopedLogger("STAGING_RING");
+
+/// Ring size used by the renderer.
+pub const DEFAULT_CAPACITY: u64 = 64 * 1024 * 1024;
+/// Submissions that may be in flight before another submit waits for the oldest.
+const MAX_IN_FLIGHT: usize = 16;
+/// Minimum slice alignment; covers every texel block size the texture paths upload.
+const MIN_ALIGNMENT: u64 = 16;
+const WAIT_TIMEOUT_NS: u64 = 10_000_000_000;
+/// Window over which `Stats.bytes_per_second` is averaged.
+const RATE_WINDOW_NS: i128 = 500_000_000;
+
+/// A semaphore value a consumer submit has to wait for.
+pub const Wait = struct {
+    semaphore: c.VkSemaphore,
+    value: u64,
+};
+
+/// Cumulative upload counters.
+pub const Stats = struct {
+    bytes: u64 = 0,
+    copies: u64 = 0,
+    submits: u64 = 0,
+    /// Uploads that had to wait for the GPU to release ring space.
+    stalls: u64 = 0,
+    /// Images too large for the ring, left to the one-shot staging path.
+    oversized: u64 = 0,
+    /// Upload bandwidth over the last completed averaging window.
+    bytes_per_second: f64 = 0,
+};
+
+const InFlight = struct {
+    value: u64,
+    head: u64,
+    cmd: c.VkCommandBuffer,
+};
+
+pub const StagingRing = struct {
+    device: c.VkDevice,
+    vma: *types.VulkanAllocator,
+    buffer: types.VulkanBuffer,
+    mapped: [*]u8,
+    capacity: u64,
+    alignment: u64,
+    /// Monotonic write position; the byte offset in `buffer` is `head % capacity`.
+    head: u64 = 0,
+    /// Monotonic position of the oldest byte the GPU may still read.
+    tail: u64 = 0,
+
+    queue: c.VkQueue,
+    queue_family: u32,
+    shared_families: [3]u32 = undefined,
+    shared_family_count: u32 = 0,
+    /// Number of leading `shared_families` entries that exclude the compute family.
+    graphics_family_count: u32 = 0,
+    pool: c.VkCommandPool = null,
+    semaphore: c.VkSemaphore = null,
+    submit_fn: c.PFN_vkQueueSubmit2,
+    wait_fn: c.PFN_vkWaitSemaphores,
+    counter_fn: c.PFN_vkGetSemaphoreCounterValue,
+
+    recording: c.VkCommandBuffer = null,
+    next_value: u64 = 1,
+    last_submitted: u64 = 0,
+    completed: u64 = 0,
+    /// Newest submission a consumer has been told to wait on through `flush`.
+    handed_off: u64 = 0,
+    in_flight: [MAX_IN_FLIGHT]InFlight = undefined,
+    in_flight_start: usize = 0,
+    in_flight_count: usize = 0,
+    spare_cmds: [MAX_IN_FLIGHT]c.VkCommandBuffer = undefined,
+    spare_count: usize = 0,
+
+    mutex: std.Thread.Mutex = .{},
+    stats: Stats = .{},
+    window_start_ns: i128 = 0,
+    window_bytes: u64 = 0,
+
+    /// Creates a ring of `capacity` bytes on the device owned by `s`, which must have its VMA
+    /// allocator initialized.
+    pub fn create(allocator: std.mem.Allocator, s: *types.VulkanState, capacity: u64) !*StagingRing {
+        const ring = try allocator.create(StagingRing);
+        errdefer allocator.destroy(ring);
+        try ring.init(s, capacity);
+        return ring;
+    }
+
+    fn init(self: *StagingRing, s: *types.VulkanState, capacity: u64) !void {
+        if (s.context.device == null or s.allocator.handle == null) return error.DeviceNotReady;
+
+        const dedicated = s.context.transfer_queue != null and s.context.transfer_queue_family != s.context.graphics_queue_family;
+        var props: c.VkPhysicalDeviceProperties = undefined;
+        c.vkGetPhysicalDeviceProperties(s.context.physical_device, &props);
+
+        self.* = .{
+            .device = s.context.device,
+            .vma = &s.allocator,
+            .buffer = std.mem.zeroes(types.VulkanBuffer),
+            .mapped = undefined,
+            .capacity = capacity,
+            .alignment = @max(MIN_ALIGNMENT, props.limits.optimalBufferCopyOffsetAlignment),
+            .queue = if (dedicated) s.context.transfer_queue else s.context.graphics_queue,
+            .queue_family = if (dedicated) s.context.transfer_queue_family else s.context.graphics_queue_family,
+            .submit_fn = s.context.vkQueueSubmit2,
+            .wait_fn = s.context.vkWaitSemaphores,
+            .counter_fn = s.context.vkGetSemaphoreCounterValue,
+            .window_start_ns = std.time.nanoTimestamp(),
+        };
+        errdefer self.release();
+
+        if (dedicated) {
+            self.add_shared_family(s.context.graphics_queue_family);
+            self.add_shared_family(self.queue_family);
+            self.graphics_family_count = self.shared_family_count;
+            self.add_shared_family(s.context.compute_queue_family);
+        }
+
+        var info = std.mem.zeroes(buffer_mgr.VulkanBufferCreateInfo);
+        info.size = capacity;
+        info.usage = c.VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        info.properties = c.VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | c.VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        info.persistentlyMapped = true;
+        if (!buffer_mgr.vk_buffer_create(&self.buffer, self.device, self.vma, &info)) return error.StagingBufferCreateFailed;
+        self.mapped = @ptrCast(self.buffer.mapped.?);
+
+        var pool_info = std.mem.zeroes(c.VkCommandPoolCreateInfo);
+        pool_info.sType = c.VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        pool_info.flags = c.VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | c.VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        pool_info.queueFamilyIndex = self.queue_family;
+        if (c.vkCreateCommandPool(self.device, &pool_info, null, &self.pool) != c.VK_SUCCESS) return error.CommandPoolCreateFailed;
+
+        var type_info = std.mem.zeroes(c.VkSemaphoreTypeCreateInfo);
+        type_info.sType = c.VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        type_info.semaphoreType = c.VK_SEMAPHORE_TYPE_TIMELINE;
+        type_info.initialValue = 0;
+        var sem_info = std.mem.zeroes(c.VkSemaphoreCreateInfo);
+        sem_info.sType = c.VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        sem_info.pNext = &type_info;
+        if (c.vkCreateSemaphore(self.device, &sem_info, null, &self.semaphore) != c.VK_SUCCESS) return error.SemaphoreCreateFailed;
+
+        ring_log.info("Staging ring: {d} MB on queue family {d} ({s})", .{ capacity / (1024 * 1024), self.queue_family, if (dedicated) "dedicated transfer" else "graphics" });
+    }
+
+    /// Submits outstanding copies, waits for them and releases the ring.
+    pub fn destroy(self: *StagingRing, allocator: std.mem.Allocator) void {
+        self.mutex.lock();
+        _ = self.submit_and_wait_locked();
+        self.release();
+        self.mutex.unlock();
+        allocator.destroy(self);
+    }
+
+    fn release(self: *StagingRing) void {
+        // Destroying the pool frees every command buffer allocated from it.
+        if (self.pool != null) {
+            c.vkDestroyCommandPool(self.device, self.pool, null);
+            self.pool = null;
+        }
+        if (self.semaphore != null) {
+            c.vkDestroySemaphore(self.device, self.semaphore, null);
+            self.semaphore = null;
+        }
+        if (self.buffer.handle != null) {
+            buffer_mgr.vk_buffer_destroy_immediate(&self.buffer, self.device, self.vma);
+        }
+        self.recording = null;
+        self.in_flight_count = 0;
+        self.spare_count = 0;
+    }
+
+    fn add_shared_family(self: *StagingRing, family: u32) void {
+        for (self.shared_families[0..self.shared_family_count]) |f| {
+            if (f == family) return;
+        }
+        self.shared_families[self.shared_family_count] = family;
+        self.shared_family_count += 1;
+    }
+
+    /// Queue families that must share a resource written through the ring. Empty when the ring
+    /// runs on the graphics queue and exclusive ownership is enough. `compute_access` adds the
+    /// compute family for resources that compute passes also read or write.
+    pub fn queue_families(self: *const StagingRing, compute_access: bool) []const u32 {
+        const count = if (compute_access) self.shared_family_count else self.graphics_family_count;
+        return self.shared_families[0..count];
+    }
+
+    /// Whether an image payload of `size` bytes can go through the ring in one piece.
+    pub fn fits_image(self: *const StagingRing, size: u64) bool {
+        return size <= self.capacity / 2;
+    }
+
+    /// Opens a batch on the calling thread: its uploads until the matching `end_batch` are
+    /// submitted together. Uploads from other threads keep their synchronous behaviour.
+    pub fn begin_batch(self: *StagingRing) void {
+        _ = self;
+        t_batch_depth += 1;
+    }
+
+    /// Closes the calling thread's batch. The outermost close submits the thread's last copy if
+    /// it is still recorded and waits for it, unless `flush` already handed that submission to a
+    /// GPU-side consumer.
+    pub fn end_batch(self: *StagingRing) void {
+        if (t_batch_depth == 0) return;
+        t_batch_depth -= 1;
+        if (t_batch_depth > 0) return;
+
+        const value = t_batch_value;
+        t_batch_value = 0;
+        if (value == 0) return;
+
+        self.mutex.lock();
+        defer self.mutex.unlock();
+        if (value <= self.handed_off) return;
+        if (value == self.next_value and !self.submit_locked()) return;
+        _ = self.wait_locked(value);
+    }
+
+    /// Submits everything recorded so far without waiting. Returns the value the consuming
+    /// submit must wait for, or null when no upload is outstanding.
+    pub fn flush(self: *StagingRing) ?Wait {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+        _ = self.submit_locked();
+        self.handed_off = self.last_submitted;
+        self.poll_locked();
+        if (self.last_submitted <= self.completed) return null;
+        return .{ .semaphore = self.semaphore, .value = self.last_submitted };
+    }
+
+    /// Submits everything recorded so far and blocks until the GPU has consumed it.
+    pub fn wait_idle(self: *StagingRing) void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+        _ = self.submit_and_wait_locked();
+    }
+
+    /// Copies `data` into `dst` at `dst_offset`, splitting it into slices of at most a quarter
+    /// of the ring. Outside a batch this submits and waits before returning.
+    pub fn upload_buffer(self: *StagingRing, dst: c.VkBuffer, dst_offset: u64, data: []const u8) bool {
+        if (dst == null or data.len == 0) return false;
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        const chunk_limit = self.capacity / 4;
+        const total: u64 = data.len;
+        var done: u64 = 0;
+        var copies: u64 = 0;
+        while (done < total) {
+            const n = @min(total - done, chunk_limit);
+            const offset = self.reserve_locked(n) orelse return false;
+            const cmd = self.begin_recording_locked();
+            if (cmd == null) return false;
+
+            const src_start: usize = @intCast(done);
+            const len: usize = @intCast(n);
+            @memcpy(self.mapped[@intCast(offset)..][0..len], data[src_start..][0..len]);
+
+            const region = c.VkBufferCopy{ .srcOffset = offset, .dstOffset = dst_offset + done, .size = n };
+            c.vkCmdCopyBuffer(cmd, self.buffer.handle, dst, 1, &region);
+            done += n;
+            copies += 1;
+        }
+
+        self.account(total, copies);
+        return self.finish_upload_locked();
+    }
+
+    /// Uploads a tightly packed mip chain into `image`, zero-padding it to `size` bytes, and
+    /// leaves the image in SHADER_READ_ONLY_OPTIMAL. Outside a batch this submits and waits.
+    /// Returns false without recording anything when `fits_image(size)` is false.
+    pub fn upload_image(self: *StagingRing, image: c.VkImage, width: u32, height: u32, format: c.VkFormat, mip_levels: u32, data: []const u8, size: u64) bool {
+        if (image == null or size < data.len) return false;
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        if (!self.fits_image(size)) {
+            self.stats.oversized += 1;
+            return false;
+        }
+
+        const offset = self.reserve_locked(size) orelse return false;
+        const cmd = self.begin_recording_locked();
+        if (cmd == null) return false;
+
+        const dst = self.mapped[@intCast(offset)..][0..@intCast(size)];
+        @memcpy(dst[0..data.len], data);
+        @memset(dst[data.len..], 0);
+
+        // A transfer-only queue cannot name shader stages; the consumer's semaphore wait orders
+        // the first sample after the copy instead.
+        const dedicated = self.shared_family_count > 0;
+        const final_stage: c.VkPipelineStageFlags2 = if (dedicated) c.VK_PIPELINE_STAGE_2_NONE else c.VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+        const final_access: c.VkAccessFlags2 = if (dedicated) c.VK_ACCESS_2_NONE else c.VK_ACCESS_2_SHADER_READ_BIT;
+        vk_texture_utils.record_texture_copy_commands_at(cmd, self.buffer.handle, offset, image, width, height, format, mip_levels, final_stage, final_access);
+
+        self.account(data.len, @max(mip_levels, 1));
+        return self.finish_upload_locked();
+    }
+
+    /// Defers the submit when the calling thread has a batch open, otherwise submits and waits.
+    fn finish_upload_locked(self: *StagingRing) bool {
+        if (t_batch_depth > 0) {
+            // The copies sit in the open command buffer, which is submitted with this value.
+            t_batch_value = self.next_value;
+            return true;
+        }
+        return self.submit_and_wait_locked();
+    }
+
+    /// Returns a snapshot of the upload counters.
+    pub fn get_stats(self: *StagingRing) Stats {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+        self.roll_window(std.time.nanoTimestamp());
+        return self.stats;
+    }
+
+    fn account(self: *StagingRing, bytes: u64, copies: u64) void {
+        self.stats.bytes += bytes;
+        self.stats.copies += copies;
+        self.window_bytes += bytes;
+        self.roll_window(std.time.nanoTimestamp());
+        profiler.count(.uploads, copies);
+        profiler.count(.upload_bytes, bytes);
+    }
+
+    fn roll_window(self: *StagingRing, now: i128) void {
+        const elapsed = now - self.window_start_ns;
+        if (elapsed < RATE_WINDOW_NS) return;
+        self.stats.bytes_per_second = @as(f64, @floatFromInt(self.window_bytes)) * 1e9 / @as(f64, @floatFromInt(elapsed));
+        self.window_bytes = 0;
+        self.window_start_ns = now;
+    }
+
+    /// Returns the buffer offset of `size` free bytes, submitting and waiting when the ring is full.
+    fn reserve_locked(self: *StagingRing, size: u64) ?u64 {
+        if (size > self.capacity) return null;
+        while (true) {
+            const start = slice_start(self.head, size, self.capacity, self.alignment);
+            if (slice_fits(start, size, self.tail, self.capacity)) {
+                self.head = start + size;
+                return start % self.capacity;
+            }
+
+            self.poll_locked();
+            if (slice_fits(start, size, self.tail, self.capacity)) continue;
+
+            self.stats.stalls += 1;
+            if (self.in_flight_count == 0) {
+                // Only the open command buffer holds the space; submit it so it can be retired.
+                if (self.recording == null or !self.submit_locked()) return null;
+            }
+            if (!self.wait_locked(self.in_flight[self.in_flight_start].value)) return null;
+        }
+    }
+
+    fn begin_recording_locked(self: *StagingRing) c.VkCommandBuffer {
+        if (self.recording != null) return self.recording;
+
+        var cmd: c.VkCommandBuffer = null;
+        if (self.spare_count > 0) {
+            self.spare_count -= 1;
+            cmd = self.spare_cmds[self.spare_count];
+        } else {
+            var alloc_info = std.mem.zeroes(c.VkCommandBufferAllocateInfo);
+            alloc_info.sType = c.VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            alloc_info.level = c.VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            alloc_info.commandPool = self.pool;
+            alloc_info.commandBufferCount = 1;
+            if (c.vkAllocateCommandBuffers(self.device, &alloc_info, &cmd) != c.VK_SUCCESS or cmd == null) {
+                ring_log.err("Failed to allocate upload command buffer", .{});
+                return null;
+            }
+        }
+
+        var begin_info = std.mem.zeroes(c.VkCommandBufferBeginInfo);
+        begin_info.sType = c.VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags = c.VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        if (c.vkBeginCommandBuffer(cmd, &begin_info) != c.VK_SUCCESS) {
+            ring_log.err("Failed to begin upload command buffer", .{});
+            c.vkFreeCommandBuffers(self.device, self.pool, 1, &cmd);
+            return null;
+        }
+        self.recording = cmd;
+        return cmd;
+    }
+
+    fn submit_locked(self: *StagingRing) bool {
+        const cmd = self.recording;
+        if (cmd == null) return true;
+        self.recording = null;
+
+        // Make the copies visible to later work on this queue; other queues get the same
+        // guarantee from waiting on the ring semaphore.
+        var barrier = std.mem.zeroes(c.VkMemoryBarrier2);
+        barrier.sType = c.VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+        barrier.srcStageMask = c.VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+        barrier.srcAccessMask = c.VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        barrier.dstStageMask = c.VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        barrier.dstAccessMask = c.VK_ACCESS_2_MEMORY_READ_BIT | c.VK_ACCESS_2_MEMORY_WRITE_BIT;
+        var dep = std.mem.zeroes(c.VkDependencyInfo);
+        dep.sType = c.VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        dep.memoryBarrierCount = 1;
+        dep.pMemoryBarriers = &barrier;
+        c.vkCmdPipelineBarrier2(cmd, &dep);
+
+        if (c.vkEndCommandBuffer(cmd) != c.VK_SUCCESS) {
+            ring_log.err("Failed to end upload command buffer", .{});
+            c.vkFreeCommandBuffers(self.device, self.pool, 1, &cmd);
+            return false;
+        }
+
+        if (self.in_flight_count == MAX_IN_FLIGHT) {
+            if (!self.wait_locked(self.in_flight[self.in_flight_start].value)) {
+                c.vkFreeCommandBuffers(self.device, self.pool, 1, &cmd);
+                return false;
+            }
+        }
+
+        const value = self.next_value;
+        var signal_info = std.mem.zeroes(c.VkSemaphoreSubmitInfo);
+        signal_info.sType = c.VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+        signal_info.semaphore = self.semaphore;
+        signal_info.value = value;
+        signal_info.stageMask = c.VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+        var cmd_info = std.mem.zeroes(c.VkCommandBufferSubmitInfo);
+        cmd_info.sType = c.VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+        cmd_info.commandBuffer = cmd;
+
+        var submit_info = std.mem.zeroes(c.VkSubmitInfo2);
+        submit_info.sType = c.VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+        submit_info.commandBufferInfoCount = 1;
+        submit_info.pCommandBufferInfos = &cmd_info;
+        submit_info.signalSemaphoreInfoCount = 1;
+        submit_info.pSignalSemaphoreInfos = &signal_info;
+
+        const res = vk_sync_manager.vulkan_sync_manager_submit_queue2(self.queue, 1, @ptrCast(&submit_info), null, self.submit_fn);
+        if (res != c.VK_SUCCESS) {
+            ring_log.err("Upload submit failed: {d}", .{res});
+            ring_log.warn("CMD_LEAK_WARNING: Upload command buffer {any} may leak due to submit failure", .{cmd});
+            return false;
+        }
+
+        self.next_value += 1;
+        self.last_submitted = value;
+        const slot = (self.in_flight_start + self.in_flight_count) % MAX_IN_FLIGHT;
+        self.in_flight[slot] = .{ .value = value, .head = self.head, .cmd = cmd };
+        self.in_flight_count += 1;
+        self.stats.submits += 1;
+        return true;
+    }
+
+    fn submit_and_wait_locked(self: *StagingRing) bool {
+        if (!self.submit_locked()) return false;
+        if (self.last_submitted == 0) return true;
+        return self.wait_locked(self.last_submitted);
+    }
+
+    fn wait_locked(self: *StagingRing, value: u64) bool {
+        if (value > self.completed) {
+            var wait_info = std.mem.zeroes(c.VkSemaphoreWaitInfo);
+            wait_info.sType = c.VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+            wait_info.semaphoreCount = 1;
+            wait_info.pSemaphores = &self.semaphore;
+            wait_info.pValues = &value;
+            const res = if (self.wait_fn) |wait| wait(self.device, &wait_info, WAIT_TIMEOUT_NS) else c.vkWaitSemaphores(self.device, &wait_info, WAIT_TIMEOUT_NS);
+            if (res != c.VK_SUCCESS) {
+                ring_log.err("Wait for upload {d} failed: {d}", .{ value, res });
+                return false;
+            }
+            self.completed = value;
+        }
+        self.retire_locked();
+        return true;
+    }
+
+    fn poll_locked(self: *StagingRing) void {
+        var value: u64 = 0;
+        const res = if (self.counter_fn) |counter| counter(self.device, self.semaphore, &value) else c.vkGetSemaphoreCounterValue(self.device, self.semaphore, &value);
+        if (res == c.VK_SUCCESS and value > self.completed) self.completed = value;
+        self.retire_locked();
+    }
+
+    /// Releases ring space and command buffers of every submission the GPU has finished.
+    fn retire_locked(self: *StagingRing) void {
+        while (self.in_flight_count > 0) {
+            const entry = self.in_flight[self.in_flight_start];
+            if (entry.value > self.completed) break;
+            self.tail = entry.head;
+            if (self.spare_count < self.spare_cmds.len and c.vkResetCommandBuffer(entry.cmd, 0) == c.VK_SUCCESS) {
+                self.spare_cmds[self.spare_count] = entry.cmd;
+                self.spare_count += 1;
+            } else {
+                c.vkFreeCommandBuffers(self.device, self.pool, 1, &entry.cmd);
+            }
+            self.in_flight_start = (self.in_flight_start + 1) % MAX_IN_FLIGHT;
+            self.in_flight_count -= 1;
+        }
+        if (self.in_flight_count == 0 and self.recording == null) self.tail = self.head;
+    }
+};
+
+/// Monotonic start of a `size`-byte slice placed at or after `head`. Slices never wrap; one that
+/// would cross the end of the buffer skips to its start instead.
+fn slice_start(head: u64, size: u64, capacity: u64, alignment: u64) u64 {
+    var start = std.mem.alignForward(u64, head, alignment);
+    const offset = start % capacity;
+    if (offset + size > capacity) start += capacity - offset;
+    return start;
+}
+
+/// Whether a slice starting at `start` stays within one capacity of the oldest live byte.
+fn slice_fits(start: u64, size: u64, tail: u64, capacity: u64) bool {
+    return start + size - tail <= capacity;
+}
+
+/// Batch nesting of the calling thread on the active ring.
+threadlocal var t_batch_depth: u32 = 0;
+/// Ring submission value that carries the calling thread's latest batched copy; 0 when none.
+threadlocal var t_batch_value: u64 = 0;
+
+var g_active: ?*StagingRing = null;
+
+/// The ring buffer and texture uploads go through, if the renderer installed one.
+pub fn active() ?*StagingRing {
+    return g_active;
+}
+
+/// Replaces the active ring and returns the previous one. The caller keeps ownership of both.
+pub fn set_active(ring: ?*StagingRing) ?*StagingRing {
+    const previous = g_active;
+    g_active = ring;
+    return previous;
+}
+
+/// Creates the renderer's ring and makes it active. Uploads fall back to one-shot staging
+/// buffers when this fails.
+pub fn install(s: *types.VulkanState) bool {
+    if (g_active != null) return true;
+    const allocator = memory.cardinal_get_allocator_for_category(.RENDERER).as_allocator();
+    g_active = StagingRing.create(allocator, s, DEFAULT_CAPACITY) catch |err| {
+        ring_log.warn("Staging ring unavailable, using one-shot uploads: {s}", .{@errorName(err)});
+        return false;
+    };
+    return true;
+}
+
+/// Destroys the ring created by `install`.
+pub fn uninstall() void {
+    const ring = g_active orelse return;
+    g_active = null;
+    ring.destroy(memory.cardinal_get_allocator_for_category(.RENDERER).as_allocator());
+}
+
+test "ring slices are aligned and skip to the start instead of wrapping" {
+    const capacity: u64 = 1024;
+    try std.testing.expectEqual(@as(u64, 0), slice_start(0, 100, capacity, 16));
+    try std.testing.expectEqual(@as(u64, 112), slice_start(100, 100, capacity, 16));
+    // 900 + 200 would cross the end, so the slice moves to offset 0 of the next lap.
+    const start = slice_start(900, 200, capacity, 16);
+    try std.testing.expectEqual(@as(u64, 1024), start);
+    try std.testing.expectEqual(@as(u64, 0), start % capacity);
+    // An exact fit up to the end stays in place.
+    try std.testing.expectEqual(@as(u64, 768), slice_start(760, 256, capacity, 16));
+    // Later laps keep the same offsets.
+    try std.testing.expectEqual(@as(u64, 3 * capacity + 112), slice_start(3 * capacity + 100, 100, capacity, 16));
+}
+
+test "ring space is reclaimed when the tail advances" {
+    const capacity: u64 = 1024;
+    var head: u64 = 0;
+    var tail: u64 = 0;
+
+    // Fill most of the ring: two submissions ending at 512 and 960.
+    var start = slice_start(head, 512, capacity, 16);
+    try std.testing.expect(slice_fits(start, 512, tail, capacity));
+    head = start + 512;
+    const first_head = head;
+    start = slice_start(head, 448, capacity, 16);
+    try std.testing.expect(slice_fits(start, 448, tail, capacity));
+    head = start + 448;
+
+    // A 256-byte slice has to wrap and would overwrite the first submission's bytes.
+    start = slice_start(head, 256, capacity, 16);
+    try std.testing.expectEqual(capacity, start);
+    try std.testing.expect(!slice_fits(start, 256, tail, capacity));
+
+    // Retiring the first submission moves the tail to its head and frees the front of the ring.
+    tail = first_head;
+    try std.testing.expect(slice_fits(start, 256, tail, capacity));
+    // But not more than the retired span.
+    try std.testing.expect(!slice_fits(start, 600, tail, capacity));
+
+    // With everything retired, a full-capacity slice fits again.
+    tail = head;
+    try std.testing.expect(slice_fits(slice_start(head, capacity, capacity, 16), capacity, tail, capacity));
+}
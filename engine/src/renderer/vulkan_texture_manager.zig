@@ -22,6 +22,7 @@ const handles = @import("../core/handles.zig");
 const ref_counting = @import("../core/ref_counting.zig");
 const resource_state = @import("../core/resource_state.zig");
 const texture_loader = @import("../assets/texture_loader.zig");
+const texture_types = @import("../assets/texture_types.zig");
 const asset_manager = @import("../assets/asset_manager.zig");
 
 /// Per-task context for uploading decoded texture bytes into an existing managed texture.
@@ -54,6 +55,7 @@ const AsyncTextureUpdateContext = struct {
     new_view: c.VkImageView,
     new_allocation: c.VmaAllocation,
     new_sampler: c.VkSampler,
+    new_mip_levels: u32,
 
     secondary_context: types.CardinalSecondaryCommandContext,
 
@@ -65,7 +67,7 @@ const AsyncTextureUpdateContext = struct {
     next: ?*AsyncTextureUpdateContext,
 };
 
-fn record_copy_secondary(pool: *types.CardinalThreadCommandPool, secondary_context: *types.CardinalSecondaryCommandContext, staging_buffer: c.VkBuffer, dst_image: c.VkImage, width: u32, height: u32) bool {
+fn record_copy_secondary(pool: *types.CardinalThreadCommandPool, secondary_context: *types.CardinalSecondaryCommandContext, staging_buffer: c.VkBuffer, dst_image: c.VkImage, width: u32, height: u32, format: c.VkFormat, mip_levels: u32) bool {
     vk_mt.cardinal_mt_lock_secondary_recording();
     defer vk_mt.cardinal_mt_unlock_secondary_recording();
 
@@ -85,7 +87,7 @@ fn record_copy_secondary(pool: *types.CardinalThreadCommandPool, secondary_conte
         return false;
     }
 
-    vk_texture_utils.record_texture_copy_commands(secondary_context.command_buffer, staging_buffer, dst_image, width, height);
+    vk_texture_utils.record_texture_copy_commands(secondary_context.command_buffer, staging_buffer, dst_image, width, height, format, mip_levels);
 
     if (c.vkEndCommandBuffer(secondary_context.command_buffer) != c.VK_SUCCESS) {
         return false;
@@ -112,8 +114,9 @@ fn update_texture_task(data: ?*anyopaque) callconv(.c) void {
         format = if (ctx.texture_data.is_hdr != 0) c.VK_FORMAT_R32G32B32A32_SFLOAT else c.VK_FORMAT_R8G8B8A8_SRGB;
     }
     ctx.texture_data.format = @intCast(format);
+    ctx.new_mip_levels = vk_texture_utils.texture_mip_levels(&ctx.texture_data, format);
 
-    if (!vk_texture_utils.create_image_and_memory(ctx.allocator, ctx.device, ctx.texture_data.width, ctx.texture_data.height, format, &ctx.new_image, &ctx.new_memory, &ctx.new_allocation)) {
+    if (!vk_texture_utils.create_image_and_memory(ctx.allocator, ctx.device, ctx.texture_data.width, ctx.texture_data.height, format, ctx.new_mip_levels, &ctx.new_image, &ctx.new_memory, &ctx.new_allocation)) {
         tex_mgr_log.err("Failed to create new image for update: {d}x{d} fmt={d}", .{ ctx.texture_data.width, ctx.texture_data.height, format });
         ctx.finished.store(true, .release);
         return;
@@ -132,7 +135,7 @@ fn update_texture_task(data: ?*anyopaque) callconv(.c) void {
         return;
     }
 
-    if (!record_copy_secondary(pool.?, &ctx.secondary_context, ctx.staging_buffer, ctx.new_image, ctx.texture_data.width, ctx.texture_data.height)) {
+    if (!record_copy_secondary(pool.?, &ctx.secondary_context, ctx.staging_buffer, ctx.new_image, ctx.texture_data.width, ctx.texture_data.height, format, ctx.new_mip_levels)) {
         tex_mgr_log.err("Failed to record secondary command buffer for update", .{});
         ctx.finished.store(true, .release);
         return;
@@ -161,7 +164,7 @@ fn upload_texture_task(data: ?*anyopaque) callconv(.c) void {
         return;
     }
 
-    if (!record_copy_secondary(pool.?, &ctx.secondary_context, ctx.staging_buffer, ctx.managed_texture.image, ctx.texture.width, ctx.texture.height)) {
+    if (!record_copy_secondary(pool.?, &ctx.secondary_context, ctx.staging_buffer, ctx.managed_texture.image, ctx.texture.width, ctx.texture.height, ctx.managed_texture.format, ctx.managed_texture.mip_levels)) {
         tex_mgr_log.err("Failed to record secondary command buffer", .{});
         ctx.finished.store(true, .release);
         return;
@@ -553,6 +556,142 @@ fn reset_bindless_pool_and_placeholder(manager: *types.VulkanTextureManager) boo
     return true;
 }
 
+/// Initializes managed texture slot `1 + index` for a scene texture and queues its async upload.
+///
+/// The slot starts out as a placeholder view; returns true when an upload task was submitted.
+fn init_scene_texture_slot(manager: *types.VulkanTextureManager, texture: *const scene.CardinalTexture, index: u32) bool {
+    const allocator = memory.cardinal_get_allocator_for_category(.RENDERER);
+    const placeholder = &manager.textures.?[0];
+    const slot_index = 1 + index;
+    var submitted = false;
+
+    var tex = &manager.textures.?[slot_index];
+    @memset(@as([*]u8, @ptrCast(tex))[0..@sizeOf(types.VulkanManagedTexture)], 0);
+
+    tex.width = placeholder.width;
+    tex.height = placeholder.height;
+    tex.channels = placeholder.channels;
+    tex.format = placeholder.format;
+    tex.isPlaceholder = true;
+    tex.is_allocated = false;
+    tex.path = texture.path;
+    tex.resource = null;
+
+    if (!vk_texture_utils.create_texture_image_view(manager.device, placeholder.image, &tex.view, placeholder.format)) {
+        tex_mgr_log.err("Failed to create fallback view for texture {d}", .{index});
+        tex.view = null;
+    }
+
+    var sampler_config = std.mem.zeroes(scene.CardinalSampler);
+    sampler_config.wrap_s = c.VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    sampler_config.wrap_t = c.VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    sampler_config.min_filter = c.VK_FILTER_LINEAR;
+    sampler_config.mag_filter = c.VK_FILTER_LINEAR;
+    tex.sampler = create_sampler_from_config(manager.device, &sampler_config);
+
+    if (tex.sampler == null) {
+        tex_mgr_log.err("Failed to create sampler for texture {d}", .{index});
+    }
+
+    var is_loading_resource = false;
+    var ref_res = texture.ref_resource;
+
+    if (ref_res == null and texture.path != null) {
+        const path_span = std.mem.span(texture.path.?);
+        if (asset_manager.get().loadTexture(path_span)) |handle| {
+            if (asset_manager.get().getTexture(handle)) |loaded_tex| {
+                ref_res = loaded_tex.ref_resource;
+                tex_mgr_log.info("Auto-loaded texture from path: {s}", .{path_span});
+            }
+        } else |err| {
+            tex_mgr_log.err("Failed to auto-load texture from path: {s} ({})", .{ path_span, err });
+        }
+    }
+
+    if (ref_res) |res| {
+        tex.resource = @ptrCast(res);
+        if (res.identifier) |id| {
+            const state = resource_state.cardinal_resource_state_get(id);
+            if (state != .LOADED) is_loading_resource = true;
+        }
+    }
+
+    if (manager.hasPlaceholder) {
+        var bindless_idx: u32 = 0;
+        if (tex.view != null and tex.sampler != null and manager.bindless_pool.textures != null and
+            vk_descriptor_indexing.vk_bindless_texture_register_existing(&manager.bindless_pool, placeholder.image, tex.view, tex.sampler, &bindless_idx))
+        {
+            tex.bindless_index = bindless_idx;
+        } else {
+            tex_mgr_log.err("Failed to allocate bindless slot for texture {d} (View: {any}, Sampler: {any})", .{ index, tex.view, tex.sampler });
+            tex.bindless_index = c.UINT32_MAX;
+        }
+    } else {
+        tex.bindless_index = c.UINT32_MAX;
+    }
+
+    const has_direct_data = (texture.data != null and texture.width > 0 and texture.height > 0);
+    const has_loaded_res = (ref_res != null and !is_loading_resource);
+
+    if ((has_direct_data or has_loaded_res) and !is_loading_resource) {
+        const ctx_ptr = memory.cardinal_calloc(allocator, 1, @sizeOf(AsyncTextureUpdateContext));
+        if (ctx_ptr) |ptr| {
+            const ctx = @as(*AsyncTextureUpdateContext, @ptrCast(@alignCast(ptr)));
+            ctx.allocator = manager.allocator.?;
+            ctx.device = manager.device;
+            ctx.managed_texture = tex;
+            ctx.texture_data = texture.*;
+
+            if (ref_res != null) {
+                const res = @as(*ref_counting.CardinalRefCountedResource, @ptrCast(@alignCast(ref_res.?)));
+                const res_data = @as(*texture_loader.TextureData, @ptrCast(@alignCast(res.resource.?)));
+
+                ctx.texture_data.data = res_data.data;
+                ctx.texture_data.width = res_data.width;
+                ctx.texture_data.height = res_data.height;
+                ctx.texture_data.channels = res_data.channels;
+                ctx.texture_data.is_hdr = res_data.is_hdr;
+                ctx.texture_data.format = texture_types.resolve_format(ctx.texture_data.format, res_data.format);
+                ctx.texture_data.data_size = res_data.data_size;
+            }
+
+            ctx.next = null;
+            ctx.finished = std.atomic.Value(bool).init(false);
+            ctx.success = false;
+
+            const task_ptr = memory.cardinal_alloc(allocator, @sizeOf(types.CardinalMTTask));
+            if (task_ptr) |tptr| {
+                const task: *types.CardinalMTTask = @ptrCast(@alignCast(tptr));
+                task.type = types.CardinalMTTaskType.CARDINAL_MT_TASK_COMMAND_RECORD;
+                task.data = ctx;
+                task.execute_func = update_texture_task;
+                task.callback_func = null;
+                task.is_completed = false;
+                task.success = false;
+                task.next = null;
+
+                if (vk_mt.cardinal_mt_submit_task(task)) {
+                    tex.is_updating = true;
+                    push_pending_update(manager, ctx);
+                    submitted = true;
+                } else {
+                    tex_mgr_log.err("Failed to submit async texture task for texture {d}", .{index});
+                    memory.cardinal_free(allocator, tptr);
+                    memory.cardinal_free(allocator, ptr);
+                }
+            } else {
+                tex_mgr_log.err("Failed to allocate task for texture {d}", .{index});
+                memory.cardinal_free(allocator, ptr);
+            }
+        } else {
+            tex_mgr_log.err("Failed to allocate context for texture {d}", .{index});
+        }
+    } else if (texture.data == null and ref_res == null) {
+        tex_mgr_log.warn("Texture {d} has no data and no ref_resource (path: {s}), staying as placeholder", .{ index, if (texture.path) |p| std.mem.span(p) else "null" });
+    }
+    return submitted;
+}
+
 /// Initializes per-scene texture slots and queues async updates for ready resources.
 pub fn vk_texture_manager_load_scene_textures(manager: *types.VulkanTextureManager, scene_data: ?*const scene.CardinalScene) bool {
     if (scene_data == null) {
@@ -586,148 +725,52 @@ pub fn vk_texture_manager_load_scene_textures(manager: *types.VulkanTextureManag
 
     tex_mgr_log.info("Queueing {d} textures for async streaming...", .{scene_data.?.texture_count});
 
-    const allocator = memory.cardinal_get_allocator_for_category(.RENDERER);
-    const placeholder = &manager.textures.?[0];
-
     var tasks_submitted: u32 = 0;
     var i: u32 = 0;
     while (i < scene_data.?.texture_count) : (i += 1) {
-        const texture = &scene_data.?.textures.?[i];
-        const slot_index = 1 + i;
-
-        var tex = &manager.textures.?[slot_index];
-        @memset(@as([*]u8, @ptrCast(tex))[0..@sizeOf(types.VulkanManagedTexture)], 0);
-
-        tex.width = placeholder.width;
-        tex.height = placeholder.height;
-        tex.channels = placeholder.channels;
-        tex.format = placeholder.format;
-        tex.isPlaceholder = true;
-        tex.is_allocated = false;
-        tex.path = texture.path;
-        tex.resource = null;
-
-        if (!vk_texture_utils.create_texture_image_view(manager.device, placeholder.image, &tex.view, placeholder.format)) {
-            tex_mgr_log.err("Failed to create fallback view for texture {d}", .{i});
-            tex.view = null;
-        }
-
-        var sampler_config = std.mem.zeroes(scene.CardinalSampler);
-        sampler_config.wrap_s = c.VK_SAMPLER_ADDRESS_MODE_REPEAT;
-        sampler_config.wrap_t = c.VK_SAMPLER_ADDRESS_MODE_REPEAT;
-        sampler_config.min_filter = c.VK_FILTER_LINEAR;
-        sampler_config.mag_filter = c.VK_FILTER_LINEAR;
-        tex.sampler = create_sampler_from_config(manager.device, &sampler_config);
-
-        if (tex.sampler == null) {
-            tex_mgr_log.err("Failed to create sampler for texture {d}", .{i});
-        }
-
-        var is_loading_resource = false;
-        var ref_res = texture.ref_resource;
+        if (init_scene_texture_slot(manager, &scene_data.?.textures.?[i], i)) tasks_submitted += 1;
+    }
 
-        if (ref_res == null and texture.path != null) {
-            const path_span = std.mem.span(texture.path.?);
-            if (asset_manager.get().loadTexture(path_span)) |handle| {
-                if (asset_manager.get().getTexture(handle)) |loaded_tex| {
-                    ref_res = loaded_tex.ref_resource;
-                    tex_mgr_log.info("Auto-loaded texture from path: {s}", .{path_span});
-                }
-            } else |err| {
-                tex_mgr_log.err("Failed to auto-load texture from path: {s} ({})", .{ path_span, err });
-            }
-        }
+    manager.textureCount = scene_data.?.texture_count + 1;
 
-        if (ref_res) |res| {
-            tex.resource = @ptrCast(res);
-            if (res.identifier) |id| {
-                const state = resource_state.cardinal_resource_state_get(id);
-                if (state != .LOADED) is_loading_resource = true;
-            }
-        }
+    if (manager.bindless_pool.textures != null) {
+        _ = vk_descriptor_indexing.vk_bindless_texture_flush_updates(&manager.bindless_pool);
+    }
 
-        if (manager.hasPlaceholder) {
-            var bindless_idx: u32 = 0;
-            if (tex.view != null and tex.sampler != null and manager.bindless_pool.textures != null and
-                vk_descriptor_indexing.vk_bindless_texture_register_existing(&manager.bindless_pool, placeholder.image, tex.view, tex.sampler, &bindless_idx))
-            {
-                tex.bindless_index = bindless_idx;
-            } else {
-                tex_mgr_log.err("Failed to allocate bindless slot for texture {d} (View: {any}, Sampler: {any})", .{ i, tex.view, tex.sampler });
-                tex.bindless_index = c.UINT32_MAX;
-            }
-        } else {
-            tex.bindless_index = c.UINT32_MAX;
-        }
+    tex_mgr_log.info("Queued {d} textures for async upload. Scene ready for rendering (with placeholders).", .{tasks_submitted});
+    return true;
+}
 
-        const has_direct_data = (texture.data != null and texture.width > 0 and texture.height > 0);
-        const has_loaded_res = (ref_res != null and !is_loading_resource);
-
-        if ((has_direct_data or has_loaded_res) and !is_loading_resource) {
-            const ctx_ptr = memory.cardinal_calloc(allocator, 1, @sizeOf(AsyncTextureUpdateContext));
-            if (ctx_ptr) |ptr| {
-                const ctx = @as(*AsyncTextureUpdateContext, @ptrCast(@alignCast(ptr)));
-                ctx.allocator = manager.allocator.?;
-                ctx.device = manager.device;
-                ctx.managed_texture = tex;
-                ctx.texture_data = texture.*;
-
-                if (ref_res != null) {
-                    const res = @as(*ref_counting.CardinalRefCountedResource, @ptrCast(@alignCast(ref_res.?)));
-                    const res_data = @as(*texture_loader.TextureData, @ptrCast(@alignCast(res.resource.?)));
-
-                    ctx.texture_data.data = res_data.data;
-                    ctx.texture_data.width = res_data.width;
-                    ctx.texture_data.height = res_data.height;
-                    ctx.texture_data.channels = res_data.channels;
-                    ctx.texture_data.is_hdr = res_data.is_hdr;
-                    ctx.texture_data.format = if (ctx.texture_data.format != 0) ctx.texture_data.format else res_data.format;
-                    ctx.texture_data.data_size = res_data.data_size;
-                }
+/// Initializes slots for scene textures `[first_texture, texture_count)` without touching earlier slots.
+///
+/// Used when models are appended to a resident scene. Returns false when the manager does not
+/// hold exactly the first `first_texture` scene textures, or when growing the slot array would
+/// move textures that pending async updates still point at; callers fall back to a full load.
+pub fn vk_texture_manager_append_scene_textures(manager: *types.VulkanTextureManager, scene_data: *const scene.CardinalScene, first_texture: u32) bool {
+    if (manager.textureCount != 1 + first_texture or first_texture > scene_data.texture_count) return false;
+    if (first_texture == scene_data.texture_count) return true;
+    if (scene_data.textures == null) return false;
+
+    const required_capacity = 1 + scene_data.texture_count;
+    if (manager.textureCapacity < required_capacity and manager.pending_updates != null) return false;
+    if (!ensure_capacity(manager, required_capacity)) {
+        tex_mgr_log.err("Failed to ensure capacity for {d} textures", .{required_capacity});
+        return false;
+    }
 
-                ctx.next = null;
-                ctx.finished = std.atomic.Value(bool).init(false);
-                ctx.success = false;
-
-                const task_ptr = memory.cardinal_alloc(allocator, @sizeOf(types.CardinalMTTask));
-                if (task_ptr) |tptr| {
-                    const task: *types.CardinalMTTask = @ptrCast(@alignCast(tptr));
-                    task.type = types.CardinalMTTaskType.CARDINAL_MT_TASK_COMMAND_RECORD;
-                    task.data = ctx;
-                    task.execute_func = update_texture_task;
-                    task.callback_func = null;
-                    task.is_completed = false;
-                    task.success = false;
-                    task.next = null;
-
-                    if (vk_mt.cardinal_mt_submit_task(task)) {
-                        tex.is_updating = true;
-                        push_pending_update(manager, ctx);
-                        tasks_submitted += 1;
-                    } else {
-                        tex_mgr_log.err("Failed to submit async texture task for texture {d}", .{i});
-                        memory.cardinal_free(allocator, tptr);
-                        memory.cardinal_free(allocator, ptr);
-                    }
-                } else {
-                    tex_mgr_log.err("Failed to allocate task for texture {d}", .{i});
-                    memory.cardinal_free(allocator, ptr);
-                }
-            } else {
-                tex_mgr_log.err("Failed to allocate context for texture {d}", .{i});
-            }
-        } else if (texture.data == null and ref_res == null) {
-            tex_mgr_log.warn("Texture {d} has no data and no ref_resource (path: {s}), staying as placeholder", .{ i, if (texture.path) |p| std.mem.span(p) else "null" });
-        }
+    var tasks_submitted: u32 = 0;
+    var i: u32 = first_texture;
+    while (i < scene_data.texture_count) : (i += 1) {
+        if (init_scene_texture_slot(manager, &scene_data.textures.?[i], i)) tasks_submitted += 1;
     }
 
-    manager.textureCount = scene_data.?.texture_count + 1;
+    manager.textureCount = scene_data.texture_count + 1;
 
     if (manager.bindless_pool.textures != null) {
         _ = vk_descriptor_indexing.vk_bindless_texture_flush_updates(&manager.bindless_pool);
     }
 
-    tex_mgr_log.info("Queued {d} textures for async upload. Scene ready for rendering (with placeholders).", .{tasks_submitted});
+    tex_mgr_log.info("Queued {d} appended textures for async upload", .{tasks_submitted});
     return true;
 }
 
@@ -749,7 +792,7 @@ fn create_sampler_from_config(device: c.VkDevice, config: *const scene.CardinalS
     samplerInfo.mipmapMode = c.VK_SAMPLER_MIPMAP_MODE_LINEAR;
     samplerInfo.mipLodBias = 0.0;
     samplerInfo.minLod = 0.0;
-    samplerInfo.maxLod = 0.0;
+    samplerInfo.maxLod = c.VK_LOD_CLAMP_NONE;
 
     var sampler: c.VkSampler = null;
     if (c.vkCreateSampler(device, &samplerInfo, null, &sampler) != c.VK_SUCCESS) {
@@ -1075,6 +1118,7 @@ pub fn vk_texture_manager_update_textures(manager: *types.VulkanTextureManager,
                 tex.height = ctx.texture_data.height;
                 tex.channels = ctx.texture_data.channels;
                 tex.format = ctx.texture_data.format;
+                tex.mip_levels = ctx.new_mip_levels;
                 tex.isPlaceholder = false;
                 tex.is_allocated = true;
                 tex.is_updating = false;
@@ -1197,10 +1241,13 @@ pub fn vk_texture_manager_update_textures(manager: *types.VulkanTextureManager,
                     ctx.texture_data.data_size = data.data_size;
 
                     if (tex.path) |path| {
-                        if (asset_manager.get().findTexture(std.mem.span(path))) |scene_tex| {
+                        const assets = asset_manager.get();
+                        if (assets.findTexture(std.mem.span(path))) |scene_handle| {
+                            defer assets.releaseTexture(scene_handle);
+                            const scene_tex = assets.getTexture(scene_handle).?;
                             if (scene_tex.format != 0) {
-                                ctx.texture_data.format = scene_tex.format;
-                                tex_mgr_log.info("Overriding format for texture {s} to {d} (from scene)", .{ std.mem.span(path), scene_tex.format });
+                                ctx.texture_data.format = texture_types.resolve_format(scene_tex.format, ctx.texture_data.format);
+                                tex_mgr_log.info("Overriding format for texture {s} to {d} (from scene)", .{ std.mem.span(path), ctx.texture_data.format });
                             }
                         }
                     }
@@ -221,6 +221,8 @@ pub const VulkanContext = extern struct {
     device: c.VkDevice,
     graphics_queue_family: u32,
     compute_queue_family: u32,
+    /// Dedicated transfer-only family when the device has one, otherwise the graphics family.
+    transfer_queue_family: u32,
     descriptor_buffer_uniform_buffer_size: c.VkDeviceSize,
     descriptor_buffer_storage_buffer_size: c.VkDeviceSize,
     descriptor_buffer_combined_image_sampler_size: c.VkDeviceSize,
@@ -246,6 +248,7 @@ pub const VulkanContext = extern struct {
     present_queue: c.VkQueue,
     graphics_queue: c.VkQueue,
     compute_queue: c.VkQueue,
+    transfer_queue: c.VkQueue,
     vkCmdBeginRendering: c.PFN_vkCmdBeginRendering,
     vkCmdEndRendering: c.PFN_vkCmdEndRendering,
     vkWaitSemaphores: c.PFN_vkWaitSemaphores,
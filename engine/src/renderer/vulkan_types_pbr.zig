@@ -21,6 +21,10 @@ pub const PBRUniformBufferObject = extern struct {
     ambientColor: [4]f32,
     terrainBrushPosRadius: [4]f32,
     terrainBrushParams: [4]f32,
+    /// x = 1 when `environmentSH` holds the skybox's irradiance; otherwise `ambientColor` is used.
+    /// y = 1 when the baked specular cube and BRDF LUT are bound; z = the cube's last mip.
+    environmentParams: [4]f32,
+    environmentSH: [9][4]f32,
 };
 
 /// Light type encoded by shader-friendly values.
@@ -52,10 +56,14 @@ pub const PBRLight = extern struct {
     lightPosition: [4]f32,
 };
 
-/// Maximum number of lights packed into `PBRLightingBuffer`.
-pub const MAX_LIGHTS = 128;
+/// Maximum number of lights packed into `PBRLightingBuffer`. pbr.frag only walks the lights
+/// binned into each fragment's cluster (see light_clustering.zig), so this is a memory bound.
+pub const MAX_LIGHTS = 4096;
 
-/// Fixed-capacity light array used by the PBR pipeline.
+/// Light cap for shaders without clustered lighting, which loop over every light per fragment.
+pub const FLAT_MAX_LIGHTS = 128;
+
+/// Fixed-capacity light array used by the PBR pipeline. Uploads copy only the first `count`.
 pub const PBRLightingBuffer = extern struct {
     count: u32,
     _padding: [3]u32,
@@ -148,6 +148,13 @@ pub const SkyboxPipeline = extern struct {
     descriptorManager: ?*core.VulkanDescriptorManager,
     descriptorSets: [core.MAX_FRAMES_IN_FLIGHT]c.VkDescriptorSet,
     texture: tex.VulkanManagedTexture,
+    /// Baked irradiance SH of the current skybox (see `ibl_cooker.Cooked.sh`), fed to the PBR
+    /// ambient term while `hasEnvironmentSH` is set.
+    environmentSH: [9][4]f32,
+    /// IBL cache key of the baked entry, which the PBR pipeline loads the specular chain from;
+    /// 0 when there is none.
+    environmentKey: u64,
+    hasEnvironmentSH: bool,
     initialized: bool,
 };
 
@@ -267,6 +274,26 @@ pub const VulkanPBRPipeline = extern struct {
     lightingBuffersAllocation: [core.MAX_FRAMES_IN_FLIGHT]c.VmaAllocation,
     lightingBuffersMapped: [core.MAX_FRAMES_IN_FLIGHT]?*anyopaque,
 
+    /// Per-cluster light lists (binding 11), present when the shader declares them.
+    clusteredLighting: bool,
+    lightClusterBuffers: [core.MAX_FRAMES_IN_FLIGHT]c.VkBuffer,
+    lightClusterBuffersMemory: [core.MAX_FRAMES_IN_FLIGHT]c.VkDeviceMemory,
+    lightClusterBuffersAllocation: [core.MAX_FRAMES_IN_FLIGHT]c.VmaAllocation,
+    lightClusterBuffersMapped: [core.MAX_FRAMES_IN_FLIGHT]?*anyopaque,
+
+    /// Split-sum specular IBL: prefiltered cube (binding 12) and BRDF LUT (binding 13), present
+    /// when the shader declares them. Hold the baked entry `iblKey`, or 1x1 black stand-ins at 0.
+    imageBasedLighting: bool,
+    iblSpecular: tex.VulkanManagedTexture,
+    iblBrdfLut: tex.VulkanManagedTexture,
+    iblSampler: c.VkSampler,
+    /// Skybox IBL entry last requested, and whether its specular chain is what is bound.
+    iblKey: u64,
+    iblSpecularBaked: bool,
+    /// Bumped when the IBL images are replaced; a frame's set is rewritten while its entry lags.
+    iblGeneration: u32,
+    iblBoundGeneration: [core.MAX_FRAMES_IN_FLIGHT]u32,
+
     shadowPipeline: c.VkPipeline,
     shadowAlphaPipeline: c.VkPipeline,
     shadowPipelineLayout: c.VkPipelineLayout,
@@ -298,6 +325,7 @@ pub const VulkanPBRPipeline = extern struct {
     indexBufferAllocation: c.VmaAllocation,
 
     totalIndexCount: u32,
+    totalVertexCount: u32,
     initialized: bool,
     supportsDescriptorIndexing: bool,
     pipelineBlend: c.VkPipeline,
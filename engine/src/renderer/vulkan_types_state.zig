@@ -31,6 +31,9 @@ pub const RendererConfig = extern struct {
     shadow_split_lambda: f32 = 0.95,
     shadow_near_clip: f32 = 0.1,
     shadow_far_clip: f32 = 1000.0,
+    /// Far cascades kept between frames while neither their casters nor their snapped
+    /// light-space matrix change; 0 redraws every cascade every frame.
+    shadow_cached_cascades: u32 = 2,
 
     prefer_hdr: bool = false,
 
@@ -6,6 +6,8 @@
 //! TODO: Deduplicate keep-alive references between `comptime` and `test`.
 
 pub const tracy = @import("core/tracy.zig");
+/// Built-in frame profiler with per-thread event rings and trace export.
+pub const profiler = @import("core/profiler.zig");
 /// Logging API and sink infrastructure.
 pub const log = @import("core/log.zig");
 /// Engine error set and helpers.
@@ -27,10 +29,30 @@ pub const transform = @import("core/transform.zig");
 pub const math = @import("core/math.zig");
 pub const animation = @import("assets/animation.zig");
 pub const animation_controller = @import("assets/animation_controller.zig");
+/// Sparse CPU morph-target deformation.
+pub const morph_targets = @import("assets/morph_targets.zig");
+/// Shared string hashing used for animation, parameter and asset names.
+pub const name_hash = @import("core/name_hash.zig");
 pub const ref_counting = @import("core/ref_counting.zig");
 pub const job_system = @import("core/job_system.zig");
+/// Stackful fibers backing the job system's suspendable waits.
+pub const fiber = @import("core/fiber.zig");
+/// Double-buffered simulate/extract/render frame driver.
+pub const frame_pipeline = @import("core/frame_pipeline.zig");
+/// Virtual filesystem with directory and pack mount points.
+pub const vfs = @import("core/vfs.zig");
+/// Packed asset archive reader and writer.
+pub const pack_file = @import("core/pack_file.zig");
 pub const async_loader = @import("core/async_loader.zig");
+/// Asynchronous whole-file reads (io_uring on Linux, thread pool elsewhere) for the loaders.
+pub const io_service = @import("core/io_service.zig");
 pub const texture_loader = @import("assets/texture_loader.zig");
+/// Import-time mip generation and BC1/BC5/BC7 compression with a content-hashed cache.
+pub const texture_cooker = @import("assets/texture_cooker.zig");
+/// Offline skybox IBL precompute (SH irradiance, prefiltered specular, BRDF LUT) and its cache.
+pub const ibl_cooker = @import("assets/ibl_cooker.zig");
+/// Chunked, compressed terrain sample files with partial parallel loads.
+pub const terrain_sidecar = @import("assets/terrain_sidecar.zig");
 pub const material_loader = @import("assets/material_loader.zig");
 pub const asset_database = @import("assets/asset_database.zig");
 pub const asset_manager = @import("assets/asset_manager.zig");
@@ -40,6 +62,10 @@ pub const model_manager = @import("assets/model_manager.zig");
 pub const gltf_loader = @import("assets/gltf_loader.zig");
 pub const nif_loader = @import("assets/nif_loader.zig");
 pub const scene = @import("assets/scene.zig");
+/// Two-level picking BVH: per-mesh triangle BVHs built on job workers under an instance BVH.
+pub const pick_bvh = @import("assets/pick_bvh.zig");
+/// Budgeted, screen-space-error-ranked queue for background mesh rebuilds, with camera prediction.
+pub const remesh_scheduler = @import("assets/remesh_scheduler.zig");
 pub const scene_serializer = @import("assets/scene_serializer.zig");
 pub const vulkan_mt = @import("renderer/vulkan_mt.zig");
 pub const vulkan_timeline_pool = @import("renderer/vulkan_timeline_pool.zig");
@@ -70,6 +96,19 @@ pub const vulkan_material_utils = @import("renderer/util/vulkan_material_utils.z
 pub const vulkan_renderer = @import("renderer/vulkan_renderer.zig");
 pub const vulkan_renderer_frame = @import("renderer/vulkan_renderer_frame.zig");
 pub const vulkan_pipeline_manager = @import("renderer/vulkan_pipeline_manager.zig");
+pub const vulkan_pso = @import("renderer/vulkan_pso.zig");
+/// Persistent shader reflection and pipeline descriptor cache keyed by content hash.
+pub const vulkan_reflection_cache = @import("renderer/util/vulkan_reflection_cache.zig");
+/// Batched SIMD frustum and software occlusion culling producing sorted draw lists.
+pub const visibility_culling = @import("renderer/visibility_culling.zig");
+/// Persistent mapped staging ring for batched buffer and texture uploads.
+pub const vulkan_staging_ring = @import("renderer/vulkan_staging_ring.zig");
+/// Clustered light binning feeding pbr.frag's per-cluster light lists.
+pub const light_clustering = @import("renderer/light_clustering.zig");
+/// Per-cascade shadow caster culling and far-cascade caching.
+pub const shadow_caster_culling = @import("renderer/shadow_caster_culling.zig");
+/// Cascaded shadow pass; exposes caster culling statistics.
+pub const vulkan_shadows = @import("renderer/vulkan_shadows.zig");
 
 pub const ecs_entity = @import("ecs/entity.zig");
 pub const ecs_component = @import("ecs/component.zig");
@@ -78,6 +117,10 @@ pub const ecs_system = @import("ecs/system.zig");
 pub const ecs_components = @import("ecs/components.zig");
 pub const ecs_systems = @import("ecs/systems.zig");
 pub const ecs_scheduler = @import("ecs/scheduler.zig");
+/// Render snapshots extracted from the registry for the renderer.
+pub const ecs_render_snapshot = @import("ecs/render_snapshot.zig");
+/// Hashed-grid spatial index over entity bounds, synced from change ticks.
+pub const ecs_spatial_index = @import("ecs/spatial_index.zig");
 pub const ecs_archetype = @import("ecs/archetype.zig");
 pub const ecs_command_buffer = @import("ecs/command_buffer.zig");
 pub const ecs_node_factory = @import("ecs/node_factory.zig");
@@ -85,11 +128,13 @@ pub const ecs_node_factory = @import("ecs/node_factory.zig");
 comptime {
     _ = log;
     _ = memory;
+    _ = profiler;
     _ = window;
     _ = resource_state;
     _ = transform;
     _ = animation;
     _ = animation_controller;
+    _ = morph_targets;
     _ = ref_counting;
     _ = async_loader;
     _ = texture_loader;
@@ -136,22 +181,32 @@ comptime {
     _ = vulkan_renderer;
     _ = vulkan_renderer_frame;
     _ = vulkan_pipeline_manager;
+    _ = vulkan_pso;
+    _ = vulkan_reflection_cache;
+    _ = visibility_culling;
+    _ = vulkan_staging_ring;
+    _ = light_clustering;
+    _ = shadow_caster_culling;
+    _ = vulkan_shadows;
     _ = ecs_entity;
     _ = ecs_component;
     _ = ecs_registry;
     _ = ecs_system;
     _ = ecs_components;
     _ = ecs_systems;
+    _ = ecs_spatial_index;
 }
 
 test {
     _ = log;
     _ = memory;
+    _ = profiler;
     _ = window;
     _ = resource_state;
     _ = transform;
     _ = animation;
     _ = animation_controller;
+    _ = morph_targets;
     _ = ref_counting;
     _ = async_loader;
     _ = texture_loader;
@@ -169,4 +224,5 @@ test {
     _ = ecs_system;
     _ = ecs_components;
     _ = ecs_systems;
+    _ = ecs_spatial_index;
 }
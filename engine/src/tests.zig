@@ -2,8 +2,36 @@
 
 test {
     _ = @import("assets/scene_serializer.zig");
+    _ = @import("assets/model_manager.zig");
+    _ = @import("assets/asset_slot_map.zig");
+    _ = @import("assets/asset_manager.zig");
+    _ = @import("assets/asset_database.zig");
+    _ = @import("assets/texture_cooker.zig");
+    _ = @import("assets/ibl_cooker.zig");
+    _ = @import("assets/terrain_sidecar.zig");
     _ = @import("assets/animation_sampling.zig");
+    _ = @import("assets/animation_controller.zig");
+    _ = @import("assets/morph_targets.zig");
+    _ = @import("assets/pick_bvh.zig");
+    _ = @import("assets/remesh_scheduler.zig");
     _ = @import("core/handle_manager.zig");
     _ = @import("core/events.zig");
     _ = @import("core/pool_allocator.zig");
+    _ = @import("core/fiber.zig");
+    _ = @import("core/job_system.zig");
+    _ = @import("core/memory.zig");
+    _ = @import("core/profiler.zig");
+    _ = @import("core/pack_file.zig");
+    _ = @import("core/vfs.zig");
+    _ = @import("core/io_service.zig");
+    _ = @import("core/frame_pipeline.zig");
+    _ = @import("renderer/render_graph.zig");
+    _ = @import("renderer/vulkan_staging_ring.zig");
+    _ = @import("renderer/util/vulkan_reflection_cache.zig");
+    _ = @import("renderer/visibility_culling.zig");
+    _ = @import("renderer/light_clustering.zig");
+    _ = @import("renderer/shadow_caster_culling.zig");
+    _ = @import("ecs/registry.zig");
+    _ = @import("ecs/render_snapshot.zig");
+    _ = @import("ecs/spatial_index.zig");
 }
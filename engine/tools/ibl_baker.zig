@@ -0,0 +1,116 @@
+//! Offline IBL baker.
+//!
+//! Cooks HDR skyboxes (EXR or Radiance HDR) into the IBL cache the skybox loader reads:
+//!
+//!     cardinal_ibl_baker <skybox.exr>... [--cache DIR] [--size N] [--samples N]
+//!
+//! `DIR` defaults to `assets/.cache/ibl`, where the engine looks when its assets live under
+//! `assets`. Entries are keyed by the file's absolute path and modification time, so re-baking an
+//! unchanged file is a no-op unless `--force` is given.
+const std = @import("std");
+const engine = @import("cardinal_engine");
+const ibl_cooker = engine.ibl_cooker;
+const texture_loader = engine.texture_loader;
+const job_system = engine.job_system;
+
+fn usage() void {
+    std.debug.print(
+        \\usage: cardinal_ibl_baker <skybox.exr>... [--cache DIR] [--size N] [--samples N] [--force]
+        \\
+    , .{});
+}
+
+pub fn main() !void {
+    var gpa = std.heap.GeneralPurposeAllocator(.{}){};
+    defer _ = gpa.deinit();
+    const allocator = gpa.allocator();
+
+    const args = try std.process.argsAlloc(allocator);
+    defer std.process.argsFree(allocator, args);
+
+    var inputs = std.ArrayListUnmanaged([]const u8){};
+    defer inputs.deinit(allocator);
+    var cache_dir: []const u8 = "assets/.cache/ibl";
+    var settings = ibl_cooker.Settings{};
+    var force = false;
+
+    var i: usize = 1;
+    while (i < args.len) : (i += 1) {
+        const arg = args[i];
+        if (std.mem.eql(u8, arg, "--cache") or std.mem.eql(u8, arg, "--size") or std.mem.eql(u8, arg, "--samples")) {
+            i += 1;
+            if (i >= args.len) return usage();
+            if (std.mem.eql(u8, arg, "--cache")) {
+                cache_dir = args[i];
+            } else if (std.mem.eql(u8, arg, "--size")) {
+                settings.specular_face_size = std.fmt.parseInt(u32, args[i], 10) catch return usage();
+                settings.source_face_size = settings.specular_face_size * 2;
+            } else {
+                settings.specular_samples = std.fmt.parseInt(u32, args[i], 10) catch return usage();
+            }
+        } else if (std.mem.eql(u8, arg, "--force")) {
+            force = true;
+        } else {
+            try inputs.append(allocator, arg);
+        }
+    }
+    if (inputs.items.len == 0) return usage();
+
+    const job_config = job_system.JobSystemConfig{
+        .worker_thread_count = @intCast(@max(std.Thread.getCpuCount() catch 1, 1)),
+        .max_queue_size = 1024,
+        .enable_priority_queue = true,
+    };
+    const jobs_up = job_system.init(&job_config);
+    defer if (jobs_up) job_system.shutdown();
+
+    try ibl_cooker.configure(allocator, cache_dir);
+    defer ibl_cooker.shutdown();
+
+    var failed: usize = 0;
+    for (inputs.items) |path| {
+        bake(allocator, path, cache_dir, settings, force) catch |err| {
+            std.debug.print("{s}: {s}\n", .{ path, @errorName(err) });
+            failed += 1;
+        };
+    }
+    if (failed > 0) std.process.exit(1);
+}
+
+fn bake(allocator: std.mem.Allocator, path: []const u8, cache_dir: []const u8, settings: ibl_cooker.Settings, force: bool) !void {
+    const key = try ibl_cooker.file_key(path);
+    var name_buf: [32]u8 = undefined;
+    const name = ibl_cooker.cache_name(&name_buf, key);
+
+    if (!force and ibl_cooker.load_cached_sh(key) != null) {
+        std.debug.print("{s}: up to date ({s})\n", .{ path, name });
+        return;
+    }
+
+    const source = try std.fs.cwd().readFileAlloc(allocator, path, std.math.maxInt(u32));
+    defer allocator.free(source);
+
+    var decoded = std.mem.zeroes(texture_loader.TextureData);
+    if (!texture_loader.texture_load_from_memory(source.ptr, source.len, &decoded)) return error.DecodeFailed;
+    defer texture_loader.texture_data_free(&decoded);
+    if (decoded.is_hdr == 0 or decoded.channels != 4) return error.NotAnHdrImage;
+
+    const texel_count = @as(usize, decoded.width) * decoded.height;
+    const pixels = @as([*]const f32, @ptrCast(@alignCast(decoded.data.?)))[0 .. texel_count * 4];
+
+    var timer = try std.time.Timer.start();
+    var cooked = try ibl_cooker.cook(allocator, pixels, decoded.width, decoded.height, settings);
+    defer cooked.deinit();
+    try ibl_cooker.store(allocator, cache_dir, key, &cooked);
+
+    std.debug.print("{s}: {d}x{d} -> {s} ({d}^2 x {d} specular mips, {d}^2 LUT) in {d:.1} ms\n", .{
+        path,
+        decoded.width,
+        decoded.height,
+        name,
+        cooked.face_size,
+        cooked.mip_count,
+        cooked.lut_size,
+        @as(f64, @floatFromInt(timer.read())) / 1e6,
+    });
+}
@@ -0,0 +1,79 @@
+//! Asset pack builder.
+//!
+//! Packs a directory tree into a `.cpak` archive that the VFS can mount:
+//!
+//!     cardinal_packer <input_dir> <output.cpak> [--store] [--level N]
+//!     cardinal_packer --list <pack.cpak>
+//!
+//! Entry names are paths relative to `input_dir`; mount the pack at the prefix the loose files
+//! were served from (e.g. `assets`). `--store` disables compression so every entry can be
+//! borrowed zero-copy at runtime.
+const std = @import("std");
+const engine = @import("cardinal_engine");
+const pack_file = engine.pack_file;
+
+fn usage() void {
+    std.debug.print(
+        \\usage: cardinal_packer <input_dir> <output.cpak> [--store] [--level N]
+        \\       cardinal_packer --list <pack.cpak>
+        \\
+    , .{});
+}
+
+pub fn main() !void {
+    var gpa = std.heap.GeneralPurposeAllocator(.{}){};
+    defer _ = gpa.deinit();
+    const allocator = gpa.allocator();
+
+    const args = try std.process.argsAlloc(allocator);
+    defer std.process.argsFree(allocator, args);
+
+    if (args.len == 3 and std.mem.eql(u8, args[1], "--list")) {
+        return list(allocator, args[2]);
+    }
+
+    var positional = std.ArrayListUnmanaged([]const u8){};
+    defer positional.deinit(allocator);
+    var options = pack_file.WriteOptions{};
+
+    var i: usize = 1;
+    while (i < args.len) : (i += 1) {
+        const arg = args[i];
+        if (std.mem.eql(u8, arg, "--store")) {
+            options.compress = false;
+        } else if (std.mem.eql(u8, arg, "--level")) {
+            i += 1;
+            if (i >= args.len) return usage();
+            options.level = std.fmt.parseInt(c_int, args[i], 10) catch return usage();
+        } else {
+            try positional.append(allocator, arg);
+        }
+    }
+    if (positional.items.len != 2) return usage();
+
+    var builder = pack_file.PackBuilder.init(allocator);
+    defer builder.deinit();
+    try builder.add_directory(positional.items[0]);
+
+    var timer = try std.time.Timer.start();
+    const stats = try builder.write(positional.items[1], options);
+    std.debug.print("{s}: {d} entries ({d} compressed), {d:.2} MiB -> {d:.2} MiB in {d:.1} ms\n", .{
+        positional.items[1],
+        stats.entry_count,
+        stats.compressed_count,
+        @as(f64, @floatFromInt(stats.input_bytes)) / (1024.0 * 1024.0),
+        @as(f64, @floatFromInt(stats.pack_bytes)) / (1024.0 * 1024.0),
+        @as(f64, @floatFromInt(timer.read())) / 1e6,
+    });
+}
+
+fn list(allocator: std.mem.Allocator, path: []const u8) !void {
+    const pack = try pack_file.PackFile.open(allocator, path);
+    defer pack.release();
+
+    for (pack.entries) |*entry| {
+        const compression: pack_file.Compression = @enumFromInt(entry.compression);
+        std.debug.print("{s:<8} {d:>12} {d:>12}  {s}\n", .{ @tagName(compression), entry.size, entry.stored_size, pack.entry_name(entry) });
+    }
+    std.debug.print("{d} entries\n", .{pack.entries.len});
+}
@@ -0,0 +1,122 @@
+//! SPIR-V staleness check.
+//!
+//! Every `<name>.spv` in the shader directory is compiled from `<name>`. The manifest
+//! (`spirv_sources.txt`) records the SHA-256 of the source each binary was built from; a source
+//! whose hash no longer matches has been edited since its SPIR-V was last compiled:
+//!
+//!     cardinal_shader_check <shader_dir>            fail if any .spv is stale
+//!     cardinal_shader_check <shader_dir> --update   rewrite the manifest after recompiling
+//!
+//! Hashes ignore carriage returns so checkouts with CRLF line endings agree with LF ones.
+//! `scripts/compile-shaders.ps1` runs `--update` once every shader compiled.
+const std = @import("std");
+
+const manifest_name = "spirv_sources.txt";
+const Sha256 = std.crypto.hash.sha2.Sha256;
+const HashHex = [Sha256.digest_length * 2]u8;
+
+fn usage() void {
+    std.debug.print(
+        \\usage: cardinal_shader_check <shader_dir> [--update]
+        \\
+    , .{});
+}
+
+pub fn main() !void {
+    var gpa = std.heap.GeneralPurposeAllocator(.{}){};
+    defer _ = gpa.deinit();
+    const allocator = gpa.allocator();
+
+    const args = try std.process.argsAlloc(allocator);
+    defer std.process.argsFree(allocator, args);
+
+    if (args.len < 2 or args.len > 3) return usage();
+    const update = args.len == 3 and std.mem.eql(u8, args[2], "--update");
+    if (args.len == 3 and !update) return usage();
+
+    var dir = try std.fs.cwd().openDir(args[1], .{ .iterate = true });
+    defer dir.close();
+
+    var sources = std.ArrayListUnmanaged([]const u8){};
+    defer {
+        for (sources.items) |name| allocator.free(name);
+        sources.deinit(allocator);
+    }
+    var it = dir.iterate();
+    while (try it.next()) |entry| {
+        if (entry.kind != .file or !std.mem.endsWith(u8, entry.name, ".spv")) continue;
+        try sources.append(allocator, try allocator.dupe(u8, entry.name[0 .. entry.name.len - ".spv".len]));
+    }
+    std.mem.sort([]const u8, sources.items, {}, less_than);
+
+    if (update) return write_manifest(allocator, dir, sources.items);
+
+    const manifest = dir.readFileAlloc(allocator, manifest_name, 1 << 20) catch |err| {
+        std.debug.print("{s}/{s}: {s}; run scripts/compile-shaders.ps1\n", .{ args[1], manifest_name, @errorName(err) });
+        return error.MissingManifest;
+    };
+    defer allocator.free(manifest);
+
+    var stale: u32 = 0;
+    for (sources.items) |name| {
+        const current = hash_source(allocator, dir, name) catch |err| {
+            std.debug.print("{s}.spv: source {s} unreadable ({s})\n", .{ name, name, @errorName(err) });
+            stale += 1;
+            continue;
+        };
+        const recorded = find_recorded(manifest, name) orelse {
+            std.debug.print("{s}.spv: not in {s}\n", .{ name, manifest_name });
+            stale += 1;
+            continue;
+        };
+        if (!std.mem.eql(u8, recorded, &current)) {
+            std.debug.print("{s}.spv: stale, {s} changed since it was compiled\n", .{ name, name });
+            stale += 1;
+        }
+    }
+
+    if (stale != 0) {
+        std.debug.print("{d} of {d} SPIR-V binaries are out of date; run scripts/compile-shaders.ps1\n", .{ stale, sources.items.len });
+        return error.StaleShaders;
+    }
+    std.debug.print("{d} SPIR-V binaries up to date\n", .{sources.items.len});
+}
+
+fn less_than(_: void, a: []const u8, b: []const u8) bool {
+    return std.mem.lessThan(u8, a, b);
+}
+
+fn hash_source(allocator: std.mem.Allocator, dir: std.fs.Dir, name: []const u8) !HashHex {
+    const data = try dir.readFileAlloc(allocator, name, 16 << 20);
+    defer allocator.free(data);
+
+    var hasher = Sha256.init(.{});
+    var lines = std.mem.splitScalar(u8, data, '\r');
+    while (lines.next()) |chunk| hasher.update(chunk);
+    return std.fmt.bytesToHex(hasher.finalResult(), .lower);
+}
+
+/// Hash recorded for `name`, from lines of the form `<source> <sha256>`.
+fn find_recorded(manifest: []const u8, name: []const u8) ?[]const u8 {
+    var lines = std.mem.tokenizeAny(u8, manifest, "\r\n");
+    while (lines.next()) |line| {
+        if (line[0] == '#') continue;
+        var fields = std.mem.tokenizeScalar(u8, line, ' ');
+        const source = fields.next() orelse continue;
+        const hash = fields.next() orelse continue;
+        if (std.mem.eql(u8, source, name)) return hash;
+    }
+    return null;
+}
+
+fn write_manifest(allocator: std.mem.Allocator, dir: std.fs.Dir, sources: []const []const u8) !void {
+    var out = std.ArrayListUnmanaged(u8){};
+    defer out.deinit(allocator);
+    try out.appendSlice(allocator, "# SHA-256 of the source each .spv was compiled from. Written by scripts/compile-shaders.ps1.\n");
+    for (sources) |name| {
+        const hash = try hash_source(allocator, dir, name);
+        try out.print(allocator, "{s} {s}\n", .{ name, &hash });
+    }
+    try dir.writeFile(.{ .sub_path = manifest_name, .data = out.items });
+    std.debug.print("{s}: recorded {d} shaders\n", .{ manifest_name, sources.len });
+}
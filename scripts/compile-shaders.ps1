@@ -4,6 +4,8 @@
 $projectRoot = Resolve-Path "$PSScriptRoot\.."
 Write-Host "Compiling shaders..."
 
+$failures = 0
+
 # Set working directory to assets/shaders
 Set-Location "$projectRoot\assets\shaders"
 
@@ -22,6 +24,7 @@ if ($LASTEXITCODE -eq 0) {
     Write-Host "[OK] PBR vertex shader compiled successfully"
 } else {
     Write-Host "[ERROR] Failed to compile PBR vertex shader"
+    $failures++
 }
 
 Write-Host "Compiling PBR fragment shader..."
@@ -30,6 +33,7 @@ if ($LASTEXITCODE -eq 0) {
     Write-Host "[OK] PBR fragment shader compiled successfully"
 } else {
     Write-Host "[ERROR] Failed to compile PBR fragment shader"
+    $failures++
 }
 
 # Compile UV shaders
@@ -39,6 +43,7 @@ if ($LASTEXITCODE -eq 0) {
     Write-Host "[OK] UV vertex shader compiled successfully"
 } else {
     Write-Host "[ERROR] Failed to compile UV vertex shader"
+    $failures++
 }
 
 Write-Host "Compiling UV fragment shader..."
@@ -47,6 +52,7 @@ if ($LASTEXITCODE -eq 0) {
     Write-Host "[OK] UV fragment shader compiled successfully"
 } else {
     Write-Host "[ERROR] Failed to compile UV fragment shader"
+    $failures++
 }
 
 # Compile wireframe shaders
@@ -56,6 +62,7 @@ if ($LASTEXITCODE -eq 0) {
     Write-Host "[OK] Wireframe vertex shader compiled successfully"
 } else {
     Write-Host "[ERROR] Failed to compile wireframe vertex shader"
+    $failures++
 }
 
 Write-Host "Compiling wireframe fragment shader..."
@@ -64,6 +71,7 @@ if ($LASTEXITCODE -eq 0) {
     Write-Host "[OK] Wireframe fragment shader compiled successfully"
 } else {
     Write-Host "[ERROR] Failed to compile wireframe fragment shader"
+    $failures++
 }
 
 # Compile mesh shaders
@@ -73,6 +81,7 @@ if ($LASTEXITCODE -eq 0) {
     Write-Host "[OK] Task shader compiled successfully"
 } else {
     Write-Host "[ERROR] Failed to compile task shader"
+    $failures++
 }
 
 Write-Host "Compiling mesh shader..."
@@ -81,6 +90,7 @@ if ($LASTEXITCODE -eq 0) {
     Write-Host "[OK] Mesh shader compiled successfully"
 } else {
     Write-Host "[ERROR] Failed to compile mesh shader"
+    $failures++
 }
 
 Write-Host "Compiling mesh fragment shader..."
@@ -89,6 +99,7 @@ if ($LASTEXITCODE -eq 0) {
     Write-Host "[OK] Mesh fragment shader compiled successfully"
 } else {
     Write-Host "[ERROR] Failed to compile mesh fragment shader"
+    $failures++
 }
 
 # Compile Shadow shaders
@@ -98,6 +109,7 @@ if ($LASTEXITCODE -eq 0) {
     Write-Host "[OK] Shadow vertex shader compiled successfully"
 } else {
     Write-Host "[ERROR] Failed to compile shadow vertex shader"
+    $failures++
 }
 
 Write-Host "Compiling shadow fragment shader..."
@@ -106,6 +118,7 @@ if ($LASTEXITCODE -eq 0) {
     Write-Host "[OK] Shadow fragment shader compiled successfully"
 } else {
     Write-Host "[ERROR] Failed to compile shadow fragment shader"
+    $failures++
 }
 
 Write-Host "Compiling shadow alpha fragment shader..."
@@ -114,6 +127,7 @@ if ($LASTEXITCODE -eq 0) {
     Write-Host "[OK] Shadow alpha fragment shader compiled successfully"
 } else {
     Write-Host "[ERROR] Failed to compile shadow alpha fragment shader"
+    $failures++
 }
 
 # Compile PostProcess shaders
@@ -123,6 +137,7 @@ if ($LASTEXITCODE -eq 0) {
     Write-Host "[OK] PostProcess vertex shader compiled successfully"
 } else {
     Write-Host "[ERROR] Failed to compile PostProcess vertex shader"
+    $failures++
 }
 
 Write-Host "Compiling PostProcess fragment shader..."
@@ -131,6 +146,7 @@ if ($LASTEXITCODE -eq 0) {
     Write-Host "[OK] PostProcess fragment shader compiled successfully"
 } else {
     Write-Host "[ERROR] Failed to compile PostProcess fragment shader"
+    $failures++
 }
 
 # Compile Bloom shader
@@ -140,6 +156,7 @@ if ($LASTEXITCODE -eq 0) {
     Write-Host "[OK] Bloom compute shader compiled successfully"
 } else {
     Write-Host "[ERROR] Failed to compile Bloom compute shader"
+    $failures++
 }
 
 Write-Host "Compiling skybox vertex shader..."
@@ -148,6 +165,7 @@ if ($LASTEXITCODE -eq 0) {
     Write-Host "[OK] Skybox vertex shader compiled successfully"
 } else {
     Write-Host "[ERROR] Failed to compile skybox vertex shader"
+    $failures++
 }
 
 Write-Host "Compiling skybox fragment shader..."
@@ -156,6 +174,7 @@ if ($LASTEXITCODE -eq 0) {
     Write-Host "[OK] Skybox fragment shader compiled successfully"
 } else {
     Write-Host "[ERROR] Failed to compile skybox fragment shader"
+    $failures++
 }
 
 # Compile SSAO shaders
@@ -165,6 +184,7 @@ if ($LASTEXITCODE -eq 0) {
     Write-Host "[OK] SSAO compute shader compiled successfully"
 } else {
     Write-Host "[ERROR] Failed to compile SSAO compute shader"
+    $failures++
 }
 
 Write-Host "Compiling SSAO Blur compute shader..."
@@ -173,9 +193,18 @@ if ($LASTEXITCODE -eq 0) {
     Write-Host "[OK] SSAO Blur compute shader compiled successfully"
 } else {
     Write-Host "[ERROR] Failed to compile SSAO Blur compute shader"
+    $failures++
 }
 
 Write-Host "Shader compilation complete!"
 
+# Record the sources the binaries were built from; `zig build check-shaders` compares against them
+Set-Location $projectRoot
+if ($failures -eq 0) {
+    zig build check-shaders -- --update
+} else {
+    Write-Host "[ERROR] $failures shader(s) failed; spirv_sources.txt not updated"
+}
+
 # Return to original directory
 Set-Location $projectRoot
\ No newline at end of file